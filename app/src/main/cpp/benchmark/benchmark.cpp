@@ -0,0 +1,206 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2023 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#include <cstdio>
+#include <random>
+#include "benchmark.h"
+
+namespace skyline::benchmark {
+    struct Benchmark {
+        std::string name;
+        Function function;
+    };
+
+    /**
+     * @note This is a function-local static as registrations are constructed during static initialization of other translation units
+     */
+    static std::vector<Benchmark> &GetBenchmarks() {
+        static std::vector<Benchmark> benchmarks;
+        return benchmarks;
+    }
+
+    Registration::Registration(std::string_view name, Function function) {
+        GetBenchmarks().push_back(Benchmark{std::string{name}, function});
+    }
+
+    struct Check {
+        std::string name;
+        CheckFunction function;
+    };
+
+    /**
+     * @note See GetBenchmarks()
+     */
+    static std::vector<Check> &GetChecks() {
+        static std::vector<Check> checks;
+        return checks;
+    }
+
+    CheckRegistration::CheckRegistration(std::string_view name, CheckFunction function) {
+        GetChecks().push_back(Check{std::string{name}, function});
+    }
+
+    std::vector<u8> RandomBytes(size_t size, u32 seed) {
+        std::vector<u8> bytes(size);
+        std::mt19937 generator{seed};
+        for (auto &byte : bytes)
+            byte = static_cast<u8>(generator());
+        return bytes;
+    }
+
+    struct Options {
+        std::string_view filter; //!< Only benchmarks with a name containing this are run
+        i64 minTimeNs{100 * constant::NsInMillisecond}; //!< The minimum time every repetition should run for
+        size_t repetitions{5}; //!< The amount of times every benchmark is measured, the median of these is reported
+        bool check{}; //!< If the correctness checks should be run instead of the benchmarks
+    };
+
+    struct Measurement {
+        std::string_view name;
+        size_t iterations;
+        double medianNs; //!< The median time of an iteration across all repetitions
+        double minNs;
+        double maxNs;
+        u64 bytesPerIteration;
+    };
+
+    static State RunOnce(const Benchmark &benchmark, size_t iterations) {
+        State state{.iterations = iterations};
+        benchmark.function(state);
+        return state;
+    }
+
+    static Measurement RunBenchmark(const Benchmark &benchmark, const Options &options) {
+        // Scale up the amount of iterations till a run takes a significant fraction of the minimum time, so that the final amount can be extrapolated from it reliably
+        size_t iterations{1};
+        while (true) {
+            auto state{RunOnce(benchmark, iterations)};
+            if (state.elapsedNs >= options.minTimeNs / 10 || iterations >= (1ULL << 32))
+                break;
+            iterations = state.elapsedNs > 0 ? std::max(iterations * 2, static_cast<size_t>(static_cast<double>(iterations) * static_cast<double>(options.minTimeNs / 5) / static_cast<double>(state.elapsedNs))) : iterations * 10;
+        }
+        auto calibration{RunOnce(benchmark, iterations)};
+        iterations = std::max<size_t>(1, static_cast<size_t>(static_cast<double>(iterations) * static_cast<double>(options.minTimeNs) / static_cast<double>(std::max<i64>(calibration.elapsedNs, 1))));
+
+        std::vector<double> times;
+        u64 bytesPerIteration{};
+        for (size_t repetition{}; repetition < options.repetitions; repetition++) {
+            auto state{RunOnce(benchmark, iterations)};
+            times.push_back(static_cast<double>(state.elapsedNs) / static_cast<double>(iterations));
+            bytesPerIteration = state.bytesPerIteration;
+        }
+        std::sort(times.begin(), times.end());
+
+        return Measurement{
+            .name = benchmark.name,
+            .iterations = iterations,
+            .medianNs = times[times.size() / 2],
+            .minNs = times.front(),
+            .maxNs = times.back(),
+            .bytesPerIteration = bytesPerIteration,
+        };
+    }
+
+    /**
+     * @brief Writes the results as JSON, benchmarks are always written in the order of their names with a fixed set of keys so the output of runs can be compared directly
+     */
+    static std::string SerializeJson(const std::vector<Measurement> &results) {
+        std::string json{"{\n  \"benchmarks\": ["};
+        for (size_t index{}; index < results.size(); index++) {
+            const auto &result{results[index]};
+            double bytesPerSecond{result.bytesPerIteration ? static_cast<double>(result.bytesPerIteration) * 1e9 / result.medianNs : 0.0};
+            json += util::Format("{}\n    {{\"name\": \"{}\", \"iterations\": {}, \"median_ns\": {:.3f}, \"min_ns\": {:.3f}, \"max_ns\": {:.3f}, \"bytes_per_second\": {:.0f}}}",
+                                 index ? "," : "", result.name, result.iterations, result.medianNs, result.minNs, result.maxNs, bytesPerSecond);
+        }
+        json += "\n  ]\n}\n";
+        return json;
+    }
+
+    /**
+     * @return If all checks with a name containing the filter passed
+     */
+    static bool RunChecks(const Options &options) {
+        auto &checks{GetChecks()};
+        std::sort(checks.begin(), checks.end(), [](const Check &a, const Check &b) { return a.name < b.name; });
+
+        bool passed{true};
+        for (const auto &check : checks) {
+            if (check.name.find(options.filter) == std::string::npos)
+                continue;
+
+            std::fprintf(stderr, "Checking %s\n", check.name.c_str());
+            try {
+                check.function();
+            } catch (const std::exception &e) {
+                std::fprintf(stderr, "Check %s failed: %s\n", check.name.c_str(), e.what());
+                passed = false;
+            }
+        }
+        return passed;
+    }
+}
+
+int main(int argc, char **argv) {
+    using namespace skyline;
+    using namespace skyline::benchmark;
+
+    Options options{};
+    std::string_view outputPath;
+    for (int index{1}; index < argc; index++) {
+        std::string_view argument{argv[index]};
+        auto value{[&](std::string_view prefix) -> std::optional<std::string_view> {
+            if (argument.starts_with(prefix))
+                return argument.substr(prefix.size());
+            return std::nullopt;
+        }};
+
+        if (auto filter{value("--filter=")}) {
+            options.filter = *filter;
+        } else if (auto minTime{value("--min-time-ms=")}) {
+            options.minTimeNs = std::stoll(std::string{*minTime}) * constant::NsInMillisecond;
+        } else if (auto repetitions{value("--repetitions=")}) {
+            options.repetitions = std::max<size_t>(1, std::stoull(std::string{*repetitions}));
+        } else if (auto output{value("--output=")}) {
+            outputPath = *output;
+        } else if (argument == "--check") {
+            options.check = true;
+        } else {
+            std::fprintf(stderr, "Usage: %s [--filter=<substring>] [--min-time-ms=<ms>] [--repetitions=<count>] [--output=<path>] [--check]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if (options.check)
+        return RunChecks(options) ? 0 : 1;
+
+    auto &benchmarks{GetBenchmarks()};
+    std::sort(benchmarks.begin(), benchmarks.end(), [](const Benchmark &a, const Benchmark &b) { return a.name < b.name; });
+
+    std::vector<Measurement> results;
+    for (const auto &benchmark : benchmarks) {
+        if (benchmark.name.find(options.filter) == std::string::npos)
+            continue;
+
+        std::fprintf(stderr, "Running %s\n", benchmark.name.c_str());
+        try {
+            results.push_back(RunBenchmark(benchmark, options));
+        } catch (const std::exception &e) {
+            std::fprintf(stderr, "Benchmark %s failed: %s\n", benchmark.name.c_str(), e.what());
+            return 1;
+        }
+    }
+
+    auto json{SerializeJson(results)};
+    if (outputPath.empty()) {
+        std::fwrite(json.data(), 1, json.size(), stdout);
+    } else {
+        auto file{std::fopen(std::string{outputPath}.c_str(), "w")};
+        if (!file) {
+            std::fprintf(stderr, "Failed to open %.*s: %s\n", static_cast<int>(outputPath.size()), outputPath.data(), std::strerror(errno));
+            return 1;
+        }
+        std::fwrite(json.data(), 1, json.size(), file);
+        std::fclose(file);
+    }
+    return 0;
+}
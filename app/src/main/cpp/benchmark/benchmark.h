@@ -0,0 +1,73 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2023 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#pragma once
+
+#include <common/utils.h>
+#include <common.h>
+
+namespace skyline::benchmark {
+    /**
+     * @brief The state of a single run of a benchmark, every run performs a fixed amount of iterations chosen by the runner
+     */
+    struct State {
+        const size_t iterations; //!< The amount of iterations of the measured operation to perform
+        u64 bytesPerIteration{}; //!< The amount of bytes processed by a single iteration, this is used to report the throughput
+        i64 elapsedNs{}; //!< The time spent in the measured region of the run
+
+        /**
+         * @brief Measures a single call to the supplied function which is expected to perform all iterations itself
+         * @note Any setup performed by the benchmark prior to this isn't measured
+         */
+        template<typename Function>
+        void Measure(Function &&function) {
+            auto start{util::GetTimeNs()};
+            function();
+            elapsedNs = util::GetTimeNs() - start;
+        }
+
+        /**
+         * @brief Measures `iterations` calls to the supplied function
+         */
+        template<typename Function>
+        void Run(Function &&function) {
+            Measure([&]() {
+                for (size_t iteration{}; iteration < iterations; iteration++)
+                    function();
+            });
+        }
+    };
+
+    using Function = void (*)(State &state);
+
+    /**
+     * @brief Registers a benchmark with the runner on construction, instances of this are expected to be static
+     * @param name The name of the benchmark, this is prefixed with the subsystem it belongs to such as "texture/DecodeBc1"
+     */
+    struct Registration {
+        Registration(std::string_view name, Function function);
+    };
+
+    using CheckFunction = void (*)();
+
+    /**
+     * @brief Registers a correctness check with the runner on construction, these are only run with `--check` rather than being measured
+     * @note Checks compare optimized implementations against straightforward reference implementations on randomized inputs, they signal a mismatch by throwing an exception
+     */
+    struct CheckRegistration {
+        CheckRegistration(std::string_view name, CheckFunction function);
+    };
+
+    /**
+     * @brief Stops the compiler from optimizing out the computation of a value as if it would be observed
+     */
+    template<typename Type>
+    inline void DoNotOptimize(const Type &value) {
+        asm volatile("" : : "r,m"(value) : "memory");
+    }
+
+    /**
+     * @return A buffer of the supplied size filled with deterministic pseudo-random bytes, this ensures every run operates on the same data
+     */
+    std::vector<u8> RandomBytes(size_t size, u32 seed = 0x5EED);
+}
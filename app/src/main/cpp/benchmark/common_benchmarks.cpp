@@ -0,0 +1,194 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2023 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#include <random>
+#include <common/circular_queue.h>
+#include <common/dirty_tracking.h>
+#include <common/interval_map.h>
+#include <soc/gm20b/gmmu.h>
+#include "benchmark.h"
+
+namespace skyline::benchmark {
+    namespace {
+        constexpr u64 GmmuBase{0x100000000}; //!< The GPU VA the benchmark mappings are placed at
+        constexpr size_t GmmuMappingSize{0x1000000}; //!< The size of every mapping, this is 16MiB to be well in excess of the caches
+        constexpr size_t GmmuAccessSize{0x1000}; //!< The size of the reads and writes, this corresponds to a page which is the most common size of accesses
+
+        /**
+         * @brief The state shared by the GMMU benchmarks, two adjacent mappings backed by separate host allocations are used so accesses can be made both within a single block and across blocks
+         */
+        struct GmmuFixture {
+            soc::gm20b::GMMU gmmu;
+            std::vector<u8> first, second, buffer;
+
+            GmmuFixture() : first(RandomBytes(GmmuMappingSize)), second(RandomBytes(GmmuMappingSize, 1)), buffer(GmmuAccessSize) {
+                gmmu.Map(GmmuBase, first.data(), GmmuMappingSize);
+                gmmu.Map(GmmuBase + GmmuMappingSize, second.data(), GmmuMappingSize);
+            }
+
+            /**
+             * @return The address of the access of the supplied index, these are spread across the first mapping in a fixed order
+             */
+            static u64 AccessAddress(size_t index) {
+                return GmmuBase + ((index * 0x9E3779B1) % (GmmuMappingSize / GmmuAccessSize)) * GmmuAccessSize;
+            }
+        };
+
+        Registration GmmuRead{"common/FlatMemoryManager::Read", [](State &state) {
+            GmmuFixture fixture;
+            size_t index{};
+            state.bytesPerIteration = GmmuAccessSize;
+            state.Run([&]() {
+                fixture.gmmu.Read(fixture.buffer.data(), GmmuFixture::AccessAddress(index++), GmmuAccessSize);
+                DoNotOptimize(fixture.buffer.front());
+            });
+        }};
+
+        Registration GmmuReadSplit{"common/FlatMemoryManager::ReadSplit", [](State &state) {
+            GmmuFixture fixture;
+            state.bytesPerIteration = GmmuAccessSize;
+            state.Run([&]() {
+                fixture.gmmu.Read(fixture.buffer.data(), GmmuBase + GmmuMappingSize - (GmmuAccessSize / 2), GmmuAccessSize);
+                DoNotOptimize(fixture.buffer.front());
+            });
+        }};
+
+        Registration GmmuWrite{"common/FlatMemoryManager::Write", [](State &state) {
+            GmmuFixture fixture;
+            size_t index{};
+            state.bytesPerIteration = GmmuAccessSize;
+            state.Run([&]() {
+                fixture.gmmu.Write(GmmuFixture::AccessAddress(index++), fixture.buffer.data(), GmmuAccessSize);
+            });
+            DoNotOptimize(fixture.first.front());
+        }};
+
+        Registration GmmuTranslateRange{"common/FlatMemoryManager::TranslateRange", [](State &state) {
+            GmmuFixture fixture;
+            state.Run([&]() {
+                auto ranges{fixture.gmmu.TranslateRange(GmmuBase + GmmuMappingSize - (GmmuAccessSize / 2), GmmuAccessSize)};
+                DoNotOptimize(ranges.front().data());
+            });
+        }};
+
+        constexpr size_t IntervalCount{0x1000}; //!< The amount of intervals in the map, this is in the range of the amount of buffers or textures a title has at once
+        constexpr u64 IntervalSpace{0x40000000}; //!< The size of the address space the intervals are spread across
+
+        /**
+         * @brief Inserts intervals with deterministic pseudo-random positions and sizes from 4KiB to 1MiB, similar to the sizes of guest resources
+         */
+        void FillIntervalMap(IntervalMap<u64, size_t> &map, size_t count) {
+            std::mt19937_64 generator{0x5EED};
+            for (size_t index{}; index < count; index++) {
+                u64 start{util::AlignDown(generator() % IntervalSpace, 0x1000)}, size{(1ULL << (12 + generator() % 9))};
+                map.Insert(start, start + size, index);
+            }
+        }
+
+        Registration IntervalMapInsertRemove{"common/IntervalMap::InsertRemove", [](State &state) {
+            IntervalMap<u64, size_t> map;
+            FillIntervalMap(map, IntervalCount);
+            std::mt19937_64 generator{0x1234};
+            state.Run([&]() {
+                // The interval is removed right after being inserted so every iteration operates on a map of the same size
+                u64 start{util::AlignDown(generator() % IntervalSpace, 0x1000)};
+                map.Remove(map.Insert(start, start + 0x1000, 0));
+            });
+        }};
+
+        Registration IntervalMapGet{"common/IntervalMap::Get", [](State &state) {
+            IntervalMap<u64, size_t> map;
+            FillIntervalMap(map, IntervalCount);
+            std::mt19937_64 generator{0x1234};
+            state.Run([&]() {
+                DoNotOptimize(map.Get(generator() % IntervalSpace));
+            });
+        }};
+
+        Registration IntervalMapGetRange{"common/IntervalMap::GetRange", [](State &state) {
+            IntervalMap<u64, size_t> map;
+            FillIntervalMap(map, IntervalCount);
+            std::mt19937_64 generator{0x1234};
+            state.Run([&]() {
+                u64 start{generator() % IntervalSpace};
+                auto range{map.GetRange({start, start + 0x10000})};
+                DoNotOptimize(range.size());
+            });
+        }};
+
+        Registration CircularQueueTransfer{"common/CircularQueue::PushPop", [](State &state) {
+            CircularQueue<u64> queue{0x400};
+            u64 sum{};
+            state.Measure([&]() {
+                std::thread consumer{[&]() {
+                    for (size_t index{}; index < state.iterations; index++)
+                        sum += queue.Pop();
+                }};
+                for (size_t index{}; index < state.iterations; index++)
+                    queue.Push(index);
+                consumer.join();
+            });
+            DoNotOptimize(sum);
+        }};
+
+        Registration CircularQueueAppend{"common/CircularQueue::AppendPop", [](State &state) {
+            constexpr size_t BatchSize{0x40}; //!< The amount of items appended at once, this is similar to the amount of GpEntries submitted at once
+            CircularQueue<u64> queue{0x400};
+            std::array<u64, BatchSize> batch{};
+            u64 sum{};
+            size_t batches{util::DivideCeil(state.iterations, BatchSize)};
+            state.Measure([&]() {
+                std::thread consumer{[&]() {
+                    for (size_t index{}; index < batches * BatchSize; index++)
+                        sum += queue.Pop();
+                }};
+                for (size_t index{}; index < batches; index++)
+                    queue.Append(span{batch});
+                consumer.join();
+            });
+            DoNotOptimize(sum);
+        }};
+
+        /**
+         * @brief A register block similar in size to the Maxwell 3D registers
+         */
+        struct DirtyRegisters {
+            std::array<u32, 0xE00> raw;
+        };
+
+        constexpr size_t DirtyBindingCount{0x100}; //!< The amount of subresources bound to handles, this is similar to the amount of dirty state in the 3D engine
+
+        /**
+         * @brief The state shared by the dirty tracking benchmarks, handles are bound to every 8th register
+         */
+        struct DirtyFixture {
+            DirtyRegisters registers{};
+            dirty::Manager<sizeof(DirtyRegisters), sizeof(u32)> manager{registers};
+            std::array<bool, DirtyBindingCount> dirty{};
+
+            DirtyFixture() {
+                for (size_t index{}; index < DirtyBindingCount; index++)
+                    manager.Bind(dirty::Handle{&dirty[index]}, registers.raw[index * 8]);
+            }
+        };
+
+        Registration DirtyMarkRegister{"common/dirty::Manager::MarkDirty", [](State &state) {
+            auto fixture{std::make_unique<DirtyFixture>()};
+            size_t index{};
+            state.Run([&]() {
+                fixture->manager.MarkDirty((index++ * 7) % fixture->registers.raw.size());
+            });
+            DoNotOptimize(fixture->dirty);
+        }};
+
+        Registration DirtyMarkRange{"common/dirty::Manager::MarkDirtyRange", [](State &state) {
+            auto fixture{std::make_unique<DirtyFixture>()};
+            size_t index{};
+            state.Run([&]() {
+                // Runs of 64 registers are similar to the batched register writes performed by SendPureBatchInc
+                fixture->manager.MarkDirty((index++ * 64) % (fixture->registers.raw.size() - 64), 64);
+            });
+            DoNotOptimize(fixture->dirty);
+        }};
+    }
+}
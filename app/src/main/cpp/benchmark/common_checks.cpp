@@ -0,0 +1,164 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2023 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#include <random>
+#include <common/interval_map.h>
+#include <common/segment_table.h>
+#include "benchmark.h"
+
+namespace skyline::benchmark {
+    namespace {
+        constexpr size_t CheckIterations{0x800}; //!< The amount of randomized mutations every check performs, the full state is verified after each of them
+        constexpr u64 CheckAlignment{0x1000}; //!< The alignment used for aligned IntervalMap lookups, this corresponds to a page
+
+        /**
+         * @brief A reference model of IntervalMap which stores the intervals of every group and answers all queries by scanning all of them
+         */
+        struct ReferenceIntervalMap {
+            using Interval = IntervalMap<u64, size_t>::Interval;
+
+            struct Group {
+                std::vector<Interval> intervals;
+                size_t value;
+                IntervalMap<u64, size_t>::GroupHandle handle;
+            };
+            std::vector<Group> groups;
+
+            /**
+             * @return The values of all groups overlapping the supplied interval sorted in ascending order
+             */
+            std::vector<size_t> Overlapping(Interval interval) const {
+                std::vector<size_t> values;
+                for (const auto &group : groups)
+                    if (std::any_of(group.intervals.begin(), group.intervals.end(), [&](const Interval &groupInterval) { return groupInterval.start < interval.end && groupInterval.end > interval.start; }))
+                        values.push_back(group.value);
+                std::sort(values.begin(), values.end());
+                return values;
+            }
+        };
+
+        std::vector<size_t> SortedValues(const std::vector<std::reference_wrapper<size_t>> &entries) {
+            std::vector<size_t> values;
+            for (const auto &entry : entries)
+                values.push_back(entry.get());
+            std::sort(values.begin(), values.end());
+            return values;
+        }
+
+        /**
+         * @brief Verifies every query on the map against the reference for a set of random addresses
+         */
+        void VerifyIntervalMap(IntervalMap<u64, size_t> &map, const ReferenceIntervalMap &reference, std::mt19937_64 &generator, u64 space) {
+            using Interval = ReferenceIntervalMap::Interval;
+            for (size_t query{}; query < 0x20; query++) {
+                u64 address{generator() % space};
+
+                auto overlapping{reference.Overlapping(Interval{address, address + 1})};
+                auto value{map.Get(address)};
+                if (overlapping.empty() != !value || (value && !std::binary_search(overlapping.begin(), overlapping.end(), *value)))
+                    throw exception("IntervalMap::Get mismatch at 0x{:X}", address);
+
+                auto alignedOverlapping{reference.Overlapping(Interval{address, address + 1}.Align(CheckAlignment))};
+                auto exclusive{map.GetExclusive<CheckAlignment>(address)};
+                if ((alignedOverlapping.size() == 1) != static_cast<bool>(exclusive) || (exclusive && *exclusive != alignedOverlapping.front()))
+                    throw exception("IntervalMap::GetExclusive mismatch at 0x{:X}", address);
+
+                Interval range{address, address + (generator() % (space / 16)) + 1};
+                if (SortedValues(map.GetRange(range)) != reference.Overlapping(range))
+                    throw exception("IntervalMap::GetRange mismatch at 0x{:X} - 0x{:X}", range.start, range.end);
+
+                // The recursive range depends on the traversal order so only its guarantees are verified: it must cover all directly overlapping entries, and the intervals must be aligned, sorted and coalesced
+                auto [recursiveEntries, intervals]{map.GetAlignedRecursiveRange<CheckAlignment>(address)};
+                auto recursiveValues{SortedValues(recursiveEntries)};
+                if (!std::includes(recursiveValues.begin(), recursiveValues.end(), alignedOverlapping.begin(), alignedOverlapping.end()))
+                    throw exception("IntervalMap::GetAlignedRecursiveRange is missing overlapping entries at 0x{:X}", address);
+
+                for (size_t index{}; index < intervals.size(); index++)
+                    if (intervals[index].start % CheckAlignment || intervals[index].end % CheckAlignment || intervals[index].start >= intervals[index].end || (index && intervals[index - 1].end >= intervals[index].start))
+                        throw exception("IntervalMap::GetAlignedRecursiveRange returned invalid intervals at 0x{:X}", address);
+            }
+        }
+
+        CheckRegistration IntervalMapCheck{"common/IntervalMap", []() {
+            constexpr u64 Space{0x1000000}; // Intervals are packed into a small space so they overlap frequently
+            IntervalMap<u64, size_t> map;
+            ReferenceIntervalMap reference;
+            std::mt19937_64 generator{0x5EED};
+            size_t nextValue{};
+
+            auto randomInterval{[&]() {
+                u64 start{generator() % Space};
+                return ReferenceIntervalMap::Interval{start, start + (generator() % 0x40000) + 1};
+            }};
+
+            for (size_t iteration{}; iteration < CheckIterations; iteration++) {
+                auto operation{generator() % 8};
+                if (operation < 3 || reference.groups.empty()) {
+                    auto interval{randomInterval()};
+                    auto handle{map.Insert(interval.start, interval.end, nextValue)};
+                    reference.groups.push_back({{interval}, nextValue++, handle});
+                } else if (operation < 5) {
+                    std::vector<ReferenceIntervalMap::Interval> intervals;
+                    for (size_t count{(generator() % 4) + 1}; count; count--)
+                        intervals.push_back(randomInterval());
+                    auto handle{map.Insert(span<ReferenceIntervalMap::Interval>{intervals}, nextValue)};
+                    reference.groups.push_back({intervals, nextValue++, handle});
+                } else if (operation < 7) {
+                    auto index{generator() % reference.groups.size()};
+                    map.Remove(reference.groups[index].handle);
+                    reference.groups.erase(reference.groups.begin() + static_cast<ptrdiff_t>(index));
+                } else {
+                    // Multiple groups are removed at once through the batched overload
+                    std::vector<IntervalMap<u64, size_t>::GroupHandle> handles;
+                    for (size_t count{std::min<size_t>((generator() % 4) + 1, reference.groups.size())}; count; count--) {
+                        auto index{generator() % reference.groups.size()};
+                        handles.push_back(reference.groups[index].handle);
+                        reference.groups.erase(reference.groups.begin() + static_cast<ptrdiff_t>(index));
+                    }
+                    map.Remove(span<const IntervalMap<u64, size_t>::GroupHandle>{handles});
+                }
+
+                VerifyIntervalMap(map, reference, generator, Space);
+            }
+        }};
+
+        /**
+         * @brief Applies random L1-aligned ranges to a segment table and verifies every L1 segment against a flat reference array after each of them
+         * @note Ranges alternate between ones within a single L2 segment and ones spanning several, so both splitting and filling L2 entries is covered
+         */
+        template<typename TableType, size_t Size, size_t L1Bits, size_t L2Bits>
+        void CheckSegmentTable(TableType &table, const char *name) {
+            constexpr size_t L1Size{1ULL << L1Bits}, L1Entries{Size >> L1Bits};
+            std::vector<u32> reference(L1Entries);
+            std::mt19937_64 generator{0x5EED};
+
+            for (size_t iteration{}; iteration < CheckIterations; iteration++) {
+                size_t start{generator() % L1Entries};
+                size_t maxLength{(iteration % 2) ? (1ULL << (L2Bits - L1Bits)) : (L1Entries / 4)};
+                size_t end{std::min(start + (generator() % maxLength) + 1, L1Entries)};
+                auto segment{static_cast<u32>(iteration + 1)};
+
+                table.Set(start << L1Bits, end << L1Bits, segment);
+                std::fill(reference.begin() + static_cast<ptrdiff_t>(start), reference.begin() + static_cast<ptrdiff_t>(end), segment);
+
+                for (size_t index{}; index < L1Entries; index++) {
+                    size_t address{(index << L1Bits) + (generator() % L1Size)};
+                    if (table[address] != reference[index])
+                        throw exception("{} mismatch at 0x{:X} after setting 0x{:X} - 0x{:X}: {} != {}", name, address, start << L1Bits, end << L1Bits, static_cast<u32>(table[address]), reference[index]);
+                }
+            }
+        }
+
+        constexpr size_t SegmentTableSize{1 << 24}, SegmentTableL1Bits{12}, SegmentTableL2Bits{16};
+
+        CheckRegistration SegmentTableCheck{"common/SegmentTable", []() {
+            auto table{std::make_unique<SegmentTable<u32, SegmentTableSize, SegmentTableL1Bits, SegmentTableL2Bits>>()};
+            CheckSegmentTable<decltype(table)::element_type, SegmentTableSize, SegmentTableL1Bits, SegmentTableL2Bits>(*table, "SegmentTable");
+        }};
+
+        CheckRegistration ConcurrentSegmentTableCheck{"common/ConcurrentSegmentTable", []() {
+            auto table{std::make_unique<ConcurrentSegmentTable<u32, SegmentTableSize, SegmentTableL1Bits, SegmentTableL2Bits>>()};
+            CheckSegmentTable<decltype(table)::element_type, SegmentTableSize, SegmentTableL1Bits, SegmentTableL2Bits>(*table, "ConcurrentSegmentTable");
+        }};
+    }
+}
@@ -0,0 +1,91 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2023 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#include <audio/resampler.h>
+#include <soc/gm20b/macro/macro_state.h>
+#include <soc/gm20b/engines/engine.h>
+#include "benchmark.h"
+
+namespace skyline::benchmark {
+    namespace {
+        /**
+         * @brief An engine which only accumulates the method calls made by macros, this isolates the cost of the interpreter from that of any engine
+         */
+        struct MacroSinkEngine : soc::gm20b::engine::MacroEngineBase {
+            u32 sum{};
+
+            MacroSinkEngine(soc::gm20b::MacroState &macroState) : MacroEngineBase{macroState} {}
+
+            void CallMethodFromMacro(u32 method, u32 argument) override {
+                sum += method ^ argument;
+            }
+
+            u32 ReadMethodFromMacro(u32 method) override {
+                return method;
+            }
+        };
+
+        /**
+         * @brief Encodes an AddImmediate instruction, the assignment is one of MacroInterpreter::Opcode::AssignmentOperation
+         */
+        constexpr u32 AddImmediate(u32 assignment, u32 dest, u32 srcA, i32 immediate, bool exit = false) {
+            return 1 | (assignment << 4) | (static_cast<u32>(exit) << 7) | (dest << 8) | (srcA << 11) | ((static_cast<u32>(immediate) & 0x3FFFF) << 14);
+        }
+
+        /**
+         * @brief Encodes a branch which is taken if the register is non-zero, the target is relative to the branch
+         */
+        constexpr u32 BranchNonZero(u32 srcA, i32 immediate) {
+            return 7 | (1 << 4) | (srcA << 11) | ((static_cast<u32>(immediate) & 0x3FFFF) << 14);
+        }
+
+        constexpr u32 Move{1}, MoveAndSetMethod{2}, FetchAndSend{3}, MoveAndSend{4};
+
+        /**
+         * @brief A macro which sends the remaining arguments to incrementing methods with the count in the first one, this is the structure of the common register upload macros used by titles
+         */
+        constexpr std::array<u32, 7> UploadMacro{
+            AddImmediate(MoveAndSetMethod, 0, 0, (1 << 12) | 0x8E4), // Set the method to 0x8E4 with an increment of 1
+            AddImmediate(Move, 1, 1, -1), // Decrement the count
+            AddImmediate(FetchAndSend, 2, 2, 0), // Send the previously fetched argument and fetch the next one into r2
+            BranchNonZero(1, -2),
+            AddImmediate(Move, 0, 0, 0), // Delay slot
+            AddImmediate(MoveAndSend, 3, 1, 0, true), // Send the count which is zero and exit
+            AddImmediate(Move, 0, 0, 0), // Delay slot
+        };
+
+        Registration MacroExecute{"soc/MacroInterpreter::Execute", [](State &state) {
+            constexpr size_t ArgumentCount{0x40}; //!< The amount of arguments uploaded by every invocation, this is similar to a constant buffer update
+            auto macroState{std::make_unique<soc::gm20b::MacroState>()};
+            std::copy(UploadMacro.begin(), UploadMacro.end(), macroState->macroCode.begin());
+
+            std::vector<u32> arguments(ArgumentCount + 1, 0x3F800000);
+            arguments[0] = ArgumentCount;
+
+            MacroSinkEngine engine{*macroState};
+            auto &macro{macroState->macroInterpreter.Compile(0)};
+            state.bytesPerIteration = arguments.size() * sizeof(u32);
+            state.Run([&]() {
+                macroState->macroInterpreter.Execute(macro, span{arguments}, &engine);
+            });
+            DoNotOptimize(engine.sum);
+        }};
+
+        /**
+         * @brief Measures resampling a stream of random samples in buffers of 5ms at 48KHz, as the audio renderer does
+         */
+        void ResampleBenchmark(State &state, double ratio, u8 channelCount) {
+            constexpr size_t InputFrames{constant::SampleRate / 200};
+            auto input{RandomBytes(InputFrames * channelCount * sizeof(i16))};
+            std::vector<i16> output(audio::Resampler::GetMaxOutputSize(InputFrames * channelCount, ratio, channelCount));
+            audio::Resampler resampler;
+            state.bytesPerIteration = input.size();
+            state.Run([&]() {
+                DoNotOptimize(resampler.Resample(span{input}.cast<const i16>(), span{output}, ratio, channelCount));
+            });
+        }
+
+        Registration ResampleStereo{"audio/Resampler::Resample/Stereo32KHz", [](State &state) { ResampleBenchmark(state, 32000.0 / 48000.0, constant::StereoChannelCount); }};
+        Registration ResampleSurround{"audio/Resampler::Resample/Surround44KHz", [](State &state) { ResampleBenchmark(state, 44100.0 / 48000.0, constant::SurroundChannelCount); }};
+    }
+}
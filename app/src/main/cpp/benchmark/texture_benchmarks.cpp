@@ -0,0 +1,104 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2023 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#include <gpu/texture/bc_decoder.h>
+#include <gpu/texture/layout.h>
+#include "benchmark.h"
+
+namespace skyline::benchmark {
+    namespace {
+        constexpr size_t DecodeWidth{512}, DecodeHeight{512}; //!< The dimensions of the decoded textures, this is a common size for compressed material textures
+
+        /**
+         * @brief Measures decoding a texture filled with random blocks, this exercises all modes of the formats which have per-block modes
+         * @param blockSize The size of a single 4x4 block of the encoded format
+         * @param outputBpp The size of a decoded pixel
+         */
+        template<typename Decode>
+        void DecodeBenchmark(State &state, size_t blockSize, size_t outputBpp, Decode decode) {
+            auto input{RandomBytes((DecodeWidth / 4) * (DecodeHeight / 4) * blockSize)};
+            std::vector<u8> output(DecodeWidth * DecodeHeight * outputBpp);
+            state.bytesPerIteration = input.size();
+            state.Run([&]() {
+                decode(input.data(), output.data());
+                DoNotOptimize(output.front());
+            });
+        }
+
+        Registration DecodeBc1{"texture/DecodeBc1", [](State &state) {
+            DecodeBenchmark(state, 8, 4, [](const u8 *src, u8 *dst) { bcn::DecodeBc1(src, dst, DecodeWidth, DecodeHeight, true); });
+        }};
+
+        Registration DecodeBc2{"texture/DecodeBc2", [](State &state) {
+            DecodeBenchmark(state, 16, 4, [](const u8 *src, u8 *dst) { bcn::DecodeBc2(src, dst, DecodeWidth, DecodeHeight); });
+        }};
+
+        Registration DecodeBc3{"texture/DecodeBc3", [](State &state) {
+            DecodeBenchmark(state, 16, 4, [](const u8 *src, u8 *dst) { bcn::DecodeBc3(src, dst, DecodeWidth, DecodeHeight); });
+        }};
+
+        Registration DecodeBc4{"texture/DecodeBc4", [](State &state) {
+            DecodeBenchmark(state, 8, 1, [](const u8 *src, u8 *dst) { bcn::DecodeBc4(src, dst, DecodeWidth, DecodeHeight, false); });
+        }};
+
+        Registration DecodeBc5{"texture/DecodeBc5", [](State &state) {
+            DecodeBenchmark(state, 16, 2, [](const u8 *src, u8 *dst) { bcn::DecodeBc5(src, dst, DecodeWidth, DecodeHeight, false); });
+        }};
+
+        Registration DecodeBc6{"texture/DecodeBc6", [](State &state) {
+            DecodeBenchmark(state, 16, 8, [](const u8 *src, u8 *dst) { bcn::DecodeBc6(src, dst, DecodeWidth, DecodeHeight, false); });
+        }};
+
+        Registration DecodeBc7{"texture/DecodeBc7", [](State &state) {
+            DecodeBenchmark(state, 16, 4, [](const u8 *src, u8 *dst) { bcn::DecodeBc7(src, dst, DecodeWidth, DecodeHeight); });
+        }};
+
+        /**
+         * @brief The parameters of a block-linear surface used by the swizzling benchmarks
+         */
+        struct SwizzleSurface {
+            gpu::texture::Dimensions dimensions;
+            size_t formatBlockWidth, formatBlockHeight, formatBpb;
+            size_t gobBlockHeight, gobBlockDepth;
+
+            size_t BlockLinearSize() const {
+                return gpu::texture::GetBlockLinearLayerSize(dimensions, formatBlockWidth, formatBlockHeight, formatBpb, gobBlockHeight, gobBlockDepth);
+            }
+
+            size_t LinearSize() const {
+                return util::DivideCeil<size_t>(dimensions.width, formatBlockWidth) * util::DivideCeil<size_t>(dimensions.height, formatBlockHeight) * dimensions.depth * formatBpb;
+            }
+        };
+
+        constexpr SwizzleSurface ColorSurface{{1920, 1080, 1}, 1, 1, 4, 16, 1}; //!< An RGBA8 render target at 1080p
+        constexpr SwizzleSurface CompressedSurface{{1024, 1024, 1}, 4, 4, 16, 8, 1}; //!< A BC7 texture
+        constexpr SwizzleSurface VolumeSurface{{128, 128, 32}, 1, 1, 4, 4, 4}; //!< An RGBA8 3D texture with multiple GOBs in depth
+
+        void DeswizzleBenchmark(State &state, const SwizzleSurface &surface) {
+            auto blockLinear{RandomBytes(surface.BlockLinearSize())};
+            std::vector<u8> linear(surface.LinearSize());
+            state.bytesPerIteration = linear.size();
+            state.Run([&]() {
+                gpu::texture::CopyBlockLinearToLinear(surface.dimensions, surface.formatBlockWidth, surface.formatBlockHeight, surface.formatBpb, surface.gobBlockHeight, surface.gobBlockDepth, blockLinear.data(), linear.data());
+                DoNotOptimize(linear.front());
+            });
+        }
+
+        void SwizzleBenchmark(State &state, const SwizzleSurface &surface) {
+            auto linear{RandomBytes(surface.LinearSize())};
+            std::vector<u8> blockLinear(surface.BlockLinearSize());
+            state.bytesPerIteration = linear.size();
+            state.Run([&]() {
+                gpu::texture::CopyLinearToBlockLinear(surface.dimensions, surface.formatBlockWidth, surface.formatBlockHeight, surface.formatBpb, surface.gobBlockHeight, surface.gobBlockDepth, linear.data(), blockLinear.data());
+                DoNotOptimize(blockLinear.front());
+            });
+        }
+
+        Registration DeswizzleColor{"texture/CopyBlockLinearToLinear/Rgba8", [](State &state) { DeswizzleBenchmark(state, ColorSurface); }};
+        Registration DeswizzleCompressed{"texture/CopyBlockLinearToLinear/Bc7", [](State &state) { DeswizzleBenchmark(state, CompressedSurface); }};
+        Registration DeswizzleVolume{"texture/CopyBlockLinearToLinear/Rgba8Volume", [](State &state) { DeswizzleBenchmark(state, VolumeSurface); }};
+        Registration SwizzleColor{"texture/CopyLinearToBlockLinear/Rgba8", [](State &state) { SwizzleBenchmark(state, ColorSurface); }};
+        Registration SwizzleCompressed{"texture/CopyLinearToBlockLinear/Bc7", [](State &state) { SwizzleBenchmark(state, CompressedSurface); }};
+        Registration SwizzleVolume{"texture/CopyLinearToBlockLinear/Rgba8Volume", [](State &state) { SwizzleBenchmark(state, VolumeSurface); }};
+    }
+}
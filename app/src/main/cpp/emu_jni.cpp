@@ -10,6 +10,10 @@
 #include "skyline/common/signal.h"
 #include "skyline/common/android_settings.h"
 #include "skyline/common/trace.h"
+#include "skyline/common/performance_statistics.h"
+#include "skyline/common/boot_profile.h"
+#include "skyline/common/frame_telemetry.h"
+#include "skyline/common/memory_accounting.h"
 #include "skyline/loader/loader.h"
 #include "skyline/vfs/android_asset_filesystem.h"
 #include "skyline/os.h"
@@ -18,6 +22,7 @@
 #include "skyline/audio.h"
 #include "skyline/input.h"
 #include "skyline/kernel/types/KProcess.h"
+#include "skyline/nce.h"
 
 jint Fps; //!< An approximation of the amount of frames being submitted every second
 jfloat AverageFrametimeMs; //!< The average time it takes for a frame to be rendered and presented in milliseconds
@@ -91,6 +96,7 @@ extern "C" JNIEXPORT void Java_emu_skyline_EmulationActivity_executeApplication(
     skyline::Logger::EmulationContext.Initialize(publicAppFilesPath + "logs/emulation.sklog");
 
     auto start{std::chrono::steady_clock::now()};
+    skyline::GetBootProfile().Begin();
 
     // Initialize tracing
     perfetto::TracingInitArgs args;
@@ -159,6 +165,25 @@ extern "C" JNIEXPORT jboolean Java_emu_skyline_EmulationActivity_setSurface(JNIE
     return true;
 }
 
+extern "C" JNIEXPORT void Java_emu_skyline_EmulationActivity_suspendEmulation(JNIEnv *, jobject) {
+    auto os{OsWeak.lock()};
+    if (!os || !os->state.process)
+        return;
+    os->state.process->Suspend();
+    os->state.nce->LogTrapStatistics(); // Suspending is the only point at which the statistics can be requested while a title is running
+    skyline::GetMemoryAccounting().Sample(skyline::MemoryCategory::GuestMemory, os->state.process->memory.GetUserMemoryUsage());
+    skyline::GetMemoryAccounting().Log("Suspended");
+
+    if (auto gpu{GpuWeak.lock()})
+        gpu->Trim();
+}
+
+extern "C" JNIEXPORT void Java_emu_skyline_EmulationActivity_resumeEmulation(JNIEnv *, jobject) {
+    auto os{OsWeak.lock()};
+    if (os && os->state.process)
+        os->state.process->Resume();
+}
+
 extern "C" JNIEXPORT void Java_emu_skyline_EmulationActivity_changeAudioStatus(JNIEnv *, jobject, jboolean play) {
     auto audio{AudioWeak.lock()};
     if (audio)
@@ -189,6 +214,14 @@ extern "C" JNIEXPORT void Java_emu_skyline_EmulationActivity_updatePerformanceSt
     env->SetFloatField(thiz, averageFrametimeDeviationField, AverageFrametimeDeviationMs);
 }
 
+extern "C" JNIEXPORT jobject Java_emu_skyline_EmulationActivity_getPerformanceStatisticsBuffer(JNIEnv *env, jobject) {
+    return env->NewDirectByteBuffer(&skyline::GetPerformanceStatistics(), sizeof(skyline::PerformanceStatistics));
+}
+
+extern "C" JNIEXPORT jobject Java_emu_skyline_EmulationActivity_getFrameTelemetryBuffer(JNIEnv *env, jobject) {
+    return env->NewDirectByteBuffer(&skyline::GetFrameTelemetry().ring, sizeof(skyline::FrameRecordRing));
+}
+
 extern "C" JNIEXPORT void JNICALL Java_emu_skyline_input_InputHandler_00024Companion_setController(JNIEnv *, jobject, jint index, jint type, jint partnerIndex) {
     auto input{InputWeak.lock()};
     std::lock_guard guard(input->npad.mutex);
@@ -204,8 +237,10 @@ extern "C" JNIEXPORT void JNICALL Java_emu_skyline_input_InputHandler_00024Compa
     if (!input)
         return; // We don't mind if we miss button updates while input hasn't been initialized
     auto device{input->npad.controllers[static_cast<size_t>(index)].device};
-    if (device)
+    if (device) {
         device->SetButtonState(skyline::input::NpadButton{.raw = static_cast<skyline::u64>(mask)}, pressed);
+        input->RequestUpdate();
+    }
 }
 
 extern "C" JNIEXPORT void JNICALL Java_emu_skyline_input_InputHandler_00024Companion_setAxisValue(JNIEnv *, jobject, jint index, jint axis, jint value) {
@@ -213,8 +248,32 @@ extern "C" JNIEXPORT void JNICALL Java_emu_skyline_input_InputHandler_00024Compa
     if (!input)
         return; // We don't mind if we miss axis updates while input hasn't been initialized
     auto device{input->npad.controllers[static_cast<size_t>(index)].device};
-    if (device)
+    if (device) {
         device->SetAxisValue(static_cast<skyline::input::NpadAxisId>(axis), value);
+        input->RequestUpdate();
+    }
+}
+
+extern "C" JNIEXPORT void JNICALL Java_emu_skyline_input_InputHandler_00024Companion_setInputStates(JNIEnv *env, jobject, jlongArray eventsJni, jint count) {
+    using Event = skyline::input::NpadInputEvent;
+
+    auto input{InputWeak.lock()};
+    if (!input)
+        return; // We don't mind if we miss input updates while input hasn't been initialized
+    jboolean isCopy{false};
+
+    auto events{reinterpret_cast<Event *>(env->GetLongArrayElements(eventsJni, &isCopy))};
+    auto eventCount{std::min(static_cast<size_t>(std::max(count, 0)), static_cast<size_t>(env->GetArrayLength(eventsJni)) / (sizeof(Event) / sizeof(jlong)))};
+    input->npad.ApplyInputEvents(skyline::span<const Event>(events, eventCount));
+    env->ReleaseLongArrayElements(eventsJni, reinterpret_cast<jlong *>(events), JNI_ABORT);
+    input->RequestUpdate();
+}
+
+extern "C" JNIEXPORT void JNICALL Java_emu_skyline_input_InputHandler_00024Companion_setMotionRotation(JNIEnv *, jobject, jint rotation) {
+    auto input{InputWeak.lock()};
+    if (!input)
+        return;
+    input->motion.SetDisplayRotation(rotation);
 }
 
 extern "C" JNIEXPORT void JNICALL Java_emu_skyline_input_InputHandler_00024Companion_setTouchState(JNIEnv *env, jobject, jintArray pointsJni) {
@@ -229,6 +288,7 @@ extern "C" JNIEXPORT void JNICALL Java_emu_skyline_input_InputHandler_00024Compa
                                 static_cast<size_t>(env->GetArrayLength(pointsJni)) / (sizeof(Point) / sizeof(jint)));
     input->touch.SetState(points);
     env->ReleaseIntArrayElements(pointsJni, reinterpret_cast<jint *>(points.data()), JNI_ABORT);
+    input->RequestUpdate();
 }
 
 extern "C" JNIEXPORT void JNICALL Java_emu_skyline_utils_NativeSettings_updateNative(JNIEnv *env, jobject) {
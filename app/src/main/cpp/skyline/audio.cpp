@@ -1,10 +1,12 @@
 // SPDX-License-Identifier: MPL-2.0
 // Copyright © 2020 Skyline Team and Contributors (https://github.com/skyline-emu/)
 
+#include <audio/mixer.h>
+#include <common/performance_statistics.h>
 #include "audio.h"
 
 namespace skyline::audio {
-    Audio::Audio(const DeviceState &state) : oboe::AudioStreamCallback() {
+    Audio::Audio(const DeviceState &state) : oboe::AudioStreamCallback(), trackList{std::make_unique<const TrackList>()}, audioTracks{trackList.get()} {
         settings = std::shared_ptr<Settings>{state.settings};
 
         builder.setChannelCount(constant::StereoChannelCount);
@@ -15,19 +17,66 @@ namespace skyline::audio {
         builder.setSharingMode(oboe::SharingMode::Exclusive);
         builder.setPerformanceMode(oboe::PerformanceMode::LowLatency);
 
-        builder.openManagedStream(outputStream);
+        OpenStream();
+    }
+
+    void Audio::OpenStream() {
+        // AAudio only uses an MMAP stream for low latency exclusive streams, the exclusive request is dropped if the device can't provide one so this needs no fallback
+        if (auto result{builder.openManagedStream(outputStream)}; result != oboe::Result::OK) {
+            Logger::Warn("Failed to open the audio stream: {}", oboe::convertToText(result));
+            return;
+        }
+
+        Logger::Info("Opened {} audio stream with {} sharing, {} frames per burst and a capacity of {} frames", oboe::convertToText(outputStream->getFormat()), oboe::convertToText(outputStream->getSharingMode()), outputStream->getFramesPerBurst(), outputStream->getBufferCapacityInFrames());
+
+        lastXRunCount = 0;
+        stableCallbacks = 0;
+        defaultBufferSize = outputStream->getBufferSizeInFrames();
+        adaptiveLatency = *settings->adaptiveAudioLatency;
+        if (adaptiveLatency)
+            outputStream->setBufferSizeInFrames(outputStream->getFramesPerBurst());
+
         outputStream->requestStart();
     }
 
+    void Audio::TuneBufferSize(oboe::AudioStream *audioStream) {
+        // The setting can change after the stream was opened, such as when the title profile is applied after the audio stream has already been created
+        if (bool adaptive{*settings->adaptiveAudioLatency}; adaptive != adaptiveLatency) {
+            adaptiveLatency = adaptive;
+            stableCallbacks = 0;
+            audioStream->setBufferSizeInFrames(adaptive ? audioStream->getFramesPerBurst() : defaultBufferSize);
+        }
+
+        auto xRunCount{audioStream->getXRunCount()};
+        if (!xRunCount)
+            return; // Underruns can't be detected on OpenSL ES streams, the buffer is left at a single burst there
+
+        i32 burst{audioStream->getFramesPerBurst()}, bufferSize{audioStream->getBufferSizeInFrames()};
+        if (xRunCount.value() != lastXRunCount) {
+            GetPerformanceStatistics().audioUnderruns.fetch_add(static_cast<u64>(xRunCount.value() - lastXRunCount), std::memory_order_relaxed);
+            lastXRunCount = xRunCount.value();
+            stableCallbacks = 0;
+            if (adaptiveLatency && bufferSize + burst <= audioStream->getBufferCapacityInFrames())
+                audioStream->setBufferSizeInFrames(bufferSize + burst);
+        } else if (++stableCallbacks >= StableCallbackCount) {
+            stableCallbacks = 0;
+            if (adaptiveLatency && bufferSize > burst)
+                audioStream->setBufferSizeInFrames(bufferSize - burst);
+        }
+    }
+
     Audio::~Audio() {
-        outputStream->requestStop();
+        if (outputStream)
+            outputStream->requestStop();
     }
 
     std::shared_ptr<AudioTrack> Audio::OpenTrack(u8 channelCount, u32 sampleRate, const std::function<void()> &releaseCallback) {
         std::scoped_lock trackGuard{trackLock};
 
         auto track{std::make_shared<AudioTrack>(channelCount, sampleRate, releaseCallback)};
-        audioTracks.push_back(track);
+        auto tracks{std::make_unique<TrackList>(*trackList)};
+        tracks->push_back(track);
+        PublishTracks(std::move(tracks));
 
         return track;
     }
@@ -35,46 +84,82 @@ namespace skyline::audio {
     void Audio::CloseTrack(std::shared_ptr<AudioTrack> &track) {
         std::scoped_lock trackGuard{trackLock};
 
-        audioTracks.erase(std::remove(audioTracks.begin(), audioTracks.end(), track), audioTracks.end());
+        auto tracks{std::make_unique<TrackList>(*trackList)};
+        tracks->erase(std::remove(tracks->begin(), tracks->end(), track), tracks->end());
+        PublishTracks(std::move(tracks));
+
+        // A running callback may still be using the track, the caller may destroy state its release callback depends on after this returns so the callback has to finish first
+        // This only waits for a single callback which never blocks, so yielding is preferable to the callback having to wake this thread
+        if (u64 sequence{callbackSequence.load()}; sequence & 1)
+            while (callbackSequence.load(std::memory_order_acquire) == sequence)
+                std::this_thread::yield();
+
+        ReclaimTrackLists();
     }
 
-    oboe::DataCallbackResult Audio::onAudioReady(oboe::AudioStream *audioStream, void *audioData, int32_t numFrames) {
-        auto destBuffer{static_cast<i16 *>(audioData)};
-        auto streamSamples{static_cast<size_t>(numFrames) * static_cast<size_t>(audioStream->getChannelCount())};
-        size_t writtenSamples{};
+    void Audio::PublishTracks(std::unique_ptr<const TrackList> tracks) {
+        auto previous{std::exchange(trackList, std::move(tracks))};
+        audioTracks.store(trackList.get());
 
-        {
-            std::scoped_lock trackGuard{trackLock};
+        // If no callback is running then any future callbacks are guaranteed to observe the new list, as the sequence is incremented prior to it being loaded
+        if (u64 sequence{callbackSequence.load()}; sequence & 1)
+            retiredTrackLists.emplace_back(std::move(previous), sequence);
 
-            for (auto &track : audioTracks) {
-                if (track->playbackState == AudioOutState::Stopped)
-                    continue;
+        ReclaimTrackLists();
+    }
 
-                std::scoped_lock bufferGuard{track->bufferLock};
+    void Audio::ReclaimTrackLists() {
+        u64 sequence{callbackSequence.load(std::memory_order_acquire)};
+        std::erase_if(retiredTrackLists, [sequence](const auto &retired) { return retired.second != sequence; });
+    }
 
-                if (!*settings->isAudioOutputDisabled) {
-                    auto trackSamples{track->samples.Read(span(destBuffer, streamSamples), [](i16 *source, i16 *destination) {
-                        *destination = Saturate<i16, i32>(static_cast<u32>(*destination) + static_cast<u32>(*source));
-                    }, static_cast<ssize_t>(writtenSamples))};
+    oboe::DataCallbackResult Audio::onAudioReady(oboe::AudioStream *audioStream, void *audioData, int32_t numFrames) {
+        // The track list must only be loaded after the sequence was incremented, see PublishTracks
+        callbackSequence.fetch_add(1);
+        TuneBufferSize(audioStream);
 
-                    writtenSamples = std::max(trackSamples, writtenSamples);
+        auto streamSamples{static_cast<size_t>(numFrames) * static_cast<size_t>(audioStream->getChannelCount())};
+        bool floatOutput{audioStream->getFormat() == oboe::AudioFormat::Float};
+        bool outputDisabled{*settings->isAudioOutputDisabled};
+
+        // All tracks are mixed into a chunk before moving on to the next one so the samples stay cache-resident till they're written out
+        std::array<float, MixChunkSize> mixBuffer;
+        std::array<i16, MixChunkSize> trackBuffer;
+        const auto &tracks{*audioTracks.load()};
+        for (size_t offset{}; offset < streamSamples; offset += MixChunkSize) {
+            auto chunkSamples{std::min(MixChunkSize, streamSamples - offset)};
+            span mixSamples{span(mixBuffer).first(chunkSamples)};
+            std::fill(mixSamples.begin(), mixSamples.end(), 0.0f);
+
+            for (auto &track : tracks) {
+                if (track->playbackState == AudioOutState::Stopped)
+                    continue;
 
-                    track->sampleCounter += trackSamples;
+                if (outputDisabled) {
+                    // Only the samples which were actually discarded are accounted, buffers would otherwise be released before being played once output is enabled again
+                    track->sampleCounter.fetch_add(track->samples.Discard(chunkSamples), std::memory_order_release);
                 } else {
-                    track->sampleCounter += streamSamples;
+                    size_t count{track->samples.Read(span(trackBuffer).first(chunkSamples))};
+                    AccumulateSamples(mixSamples, span(trackBuffer).first(count), track->volume.load(std::memory_order_relaxed));
+                    track->sampleCounter.fetch_add(count, std::memory_order_release);
                 }
-                track->CheckReleasedBuffers();
             }
+
+            if (floatOutput)
+                ConvertSamples(span(static_cast<float *>(audioData) + offset, chunkSamples), mixSamples);
+            else
+                ConvertSamples(span(static_cast<i16 *>(audioData) + offset, chunkSamples), mixSamples);
         }
 
-        if (streamSamples > writtenSamples)
-            memset(destBuffer + writtenSamples, 0, (streamSamples - writtenSamples) * sizeof(i16));
+        for (auto &track : tracks)
+            if (track->playbackState != AudioOutState::Stopped)
+                track->CheckReleasedBuffers();
 
+        callbackSequence.fetch_add(1, std::memory_order_release);
         return oboe::DataCallbackResult::Continue;
     }
 
     void Audio::onErrorAfterClose(oboe::AudioStream *audioStream, oboe::Result error) {
-        builder.openManagedStream(outputStream);
-        outputStream->requestStart();
+        OpenStream();
     }
 }
@@ -14,21 +14,60 @@ namespace skyline::audio {
       private:
         oboe::AudioStreamBuilder builder;
         oboe::ManagedStream outputStream;
-        std::vector<std::shared_ptr<AudioTrack>> audioTracks;
+        using TrackList = std::vector<std::shared_ptr<AudioTrack>>;
+
+        static constexpr size_t MixChunkSize{0x400}; //!< The amount of samples mixed from all tracks at once, this is small enough for the intermediate buffers to stay in the L1 cache
+
+        std::unique_ptr<const TrackList> trackList; //!< The list of all open tracks, it's immutable once published and is replaced on modification
+        std::atomic<const TrackList *> audioTracks; //!< The published track list which is read by the audio callback, it's a raw pointer so the callback never has to take a lock or free anything
+        std::atomic<u64> callbackSequence{}; //!< Incremented on entering and on leaving the audio callback, it's odd while a callback is running which may still be reading a replaced track list
+        std::vector<std::pair<std::unique_ptr<const TrackList>, u64>> retiredTrackLists; //!< Replaced track lists alongside the callback sequence they were replaced during, they're freed once that callback has returned
         std::mutex trackLock; //!< Synchronizes modifications to the audio tracks
         std::shared_ptr<Settings> settings;
 
+        bool adaptiveLatency{}; //!< The value of the adaptive latency setting that was last applied to the stream, the setting is read on every callback as it may be overridden by a title profile after the stream was opened
+        i32 defaultBufferSize{}; //!< The buffer size the stream was opened with, this is restored when adaptive latency is disabled
+        i32 lastXRunCount{}; //!< The amount of underruns the stream reported during the previous callback
+        u32 stableCallbacks{}; //!< The amount of consecutive callbacks without an underrun since the buffer size was last changed
+        static constexpr u32 StableCallbackCount{0x1000}; //!< The amount of stable callbacks after which the buffer is shrunk by a burst, this is several seconds on most devices so the buffer doesn't oscillate around its limit
+
+        /**
+         * @brief Opens and starts the output stream, the buffer is set to a single burst if adaptive latency is enabled
+         */
+        void OpenStream();
+
+        /**
+         * @brief Accounts any underruns since the last callback in the performance statistics
+         * @note In adaptive mode this also grows the buffer of the stream by a burst when it underran and shrinks it by a burst after it was stable for a while
+         * @note Changes to the adaptive latency setting are applied here, the buffer is reset to a single burst or to its default size
+         */
+        void TuneBufferSize(oboe::AudioStream *audioStream);
+
+        /**
+         * @brief Publishes a new track list to the audio callback and retires the previous one, retired lists are freed once no callback can still be reading them
+         * @note 'trackLock' **must** be locked by the calling thread prior to calling this
+         */
+        void PublishTracks(std::unique_ptr<const TrackList> tracks);
+
+        /**
+         * @brief Frees all retired track lists that are no longer being read by the audio callback, this destroys any tracks that are only referenced by them outside of the callback
+         * @note 'trackLock' **must** be locked by the calling thread prior to calling this
+         */
+        void ReclaimTrackLists();
+
       public:
         Audio(const DeviceState &state);
 
         ~Audio();
 
         void Pause() {
-            outputStream->requestPause();
+            if (outputStream)
+                outputStream->requestPause();
         }
 
         void Resume() {
-            outputStream->requestStart();
+            if (outputStream)
+                outputStream->requestStart();
         }
 
         /**
@@ -42,6 +81,7 @@ namespace skyline::audio {
 
         /**
          * @brief Closes a track and frees its data
+         * @note The audio callback is guaranteed to not access the track anymore once this returns, so its release callback won't be called after this
          */
         void CloseTrack(std::shared_ptr<AudioTrack> &track);
 
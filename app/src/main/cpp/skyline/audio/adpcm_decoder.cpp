@@ -1,52 +1,68 @@
 // SPDX-License-Identifier: MPL-2.0
 // Copyright © 2020 Skyline Team and Contributors (https://github.com/skyline-emu/)
 
+#ifdef __ARM_NEON
+#include <arm_neon.h>
+#endif
 #include "common.h"
 #include "adpcm_decoder.h"
 
 namespace skyline::audio {
     AdpcmDecoder::AdpcmDecoder(std::vector<std::array<i16, 2>> coefficients) : coefficients(std::move(coefficients)) {}
 
-    std::vector<i16> AdpcmDecoder::Decode(span<u8> adpcmData) {
-        constexpr size_t BytesPerFrame{0x8};
-        constexpr size_t SamplesPerFrame{0xE};
+    constexpr size_t BytesPerFrame{0x8};
+    constexpr size_t SamplesPerFrame{0xE};
 
-        size_t remainingSamples{(adpcmData.size() / BytesPerFrame) * SamplesPerFrame};
-
-        std::vector<i16> output;
-        output.reserve(remainingSamples);
-
-        size_t inputOffset{};
-
-        while (inputOffset < adpcmData.size()) {
-            FrameHeader header{adpcmData[inputOffset++]};
-
-            size_t frameSamples{std::min(SamplesPerFrame, remainingSamples)};
-
-            i32 ctx{};
-
-            for (size_t index{}; index < frameSamples; index++) {
-                i32 sample{};
-
-                if (index & 1) {
-                    sample = (ctx << 28) >> 28;
-                } else {
-                    ctx = adpcmData[inputOffset++];
-                    sample = (ctx << 24) >> 28;
-                }
+    /**
+     * @brief Expands the nibbles of a frame into their scaled residuals with the rounding bias of the prediction included
+     * @note Only the prediction depends on previously decoded samples so this is the only part of decoding that can be vectorized
+     */
+    static void ExpandResiduals(const u8 *frame, u8 scale, std::array<i32, 16> &residuals) {
+        i32 multiplier{0x800 << scale};
+        #ifdef __ARM_NEON
+        int8x8_t bytes{vreinterpret_s8_u8(vld1_u8(frame + 1))}; // The final lane reads the header of the next frame and is ignored
+        int8x8x2_t nibbles{vzip_s8(vshr_n_s8(bytes, 4), vshr_n_s8(vshl_n_s8(bytes, 4), 4))};
+        int32x4_t bias{vdupq_n_s32(0x400)};
+        for (size_t half{}; half < 2; half++) {
+            int16x8_t wide{vmovl_s8(nibbles.val[half])};
+            vst1q_s32(residuals.data() + half * 8, vmlaq_n_s32(bias, vmovl_s16(vget_low_s16(wide)), multiplier));
+            vst1q_s32(residuals.data() + half * 8 + 4, vmlaq_n_s32(bias, vmovl_high_s16(wide), multiplier));
+        }
+        #else
+        for (size_t index{}; index < SamplesPerFrame; index++) {
+            i32 ctx{frame[1 + index / 2]};
+            residuals[index] = ((index & 1) ? (ctx << 28) >> 28 : (ctx << 24) >> 28) * multiplier + 0x400;
+        }
+        #endif
+    }
 
-                i32 prediction{history[0] * coefficients[header.coefficientIndex][0] + history[1] * coefficients[header.coefficientIndex][1]};
-                sample = (sample * (0x800 << header.scale) + prediction + 0x400) >> 11;
+    void AdpcmDecoder::Decode(span<const u8> adpcmData, std::vector<i16> &output) {
+        size_t frameCount{adpcmData.size() / BytesPerFrame};
+        output.resize(frameCount * SamplesPerFrame);
 
-                auto saturated{audio::Saturate<i16, i32>(sample)};
-                output.push_back(saturated);
-                history[1] = history[0];
-                history[0] = saturated;
+        auto [history0, history1]{history};
+        std::array<i32, 16> residuals;
+        for (size_t frame{}; frame < frameCount; frame++) {
+            const u8 *frameData{adpcmData.data() + frame * BytesPerFrame};
+            FrameHeader header{frameData[0]};
+            // The NEON expansion loads a byte past the frame, the final frame is expanded from a copy to avoid reading past the buffer
+            if (frame + 1 == frameCount) {
+                std::array<u8, BytesPerFrame + 1> lastFrame{};
+                std::memcpy(lastFrame.data(), frameData, BytesPerFrame);
+                ExpandResiduals(lastFrame.data(), header.scale, residuals);
+            } else {
+                ExpandResiduals(frameData, header.scale, residuals);
             }
 
-            remainingSamples -= frameSamples;
+            auto [coefficient0, coefficient1]{coefficients.at(header.coefficientIndex)};
+            i16 *frameOutput{output.data() + frame * SamplesPerFrame};
+            for (size_t index{}; index < SamplesPerFrame; index++) {
+                auto sample{audio::Saturate<i16, i32>((residuals[index] + history0 * coefficient0 + history1 * coefficient1) >> 11)};
+                frameOutput[index] = sample;
+                history1 = history0;
+                history0 = sample;
+            }
         }
-
-        return output;
+        history = {history0, history1};
     }
 }
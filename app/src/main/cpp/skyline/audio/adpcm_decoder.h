@@ -30,7 +30,9 @@ namespace skyline::audio {
 
         /**
          * @brief Decodes a buffer of ADPCM data into I16 PCM
+         * @param output The buffer to decode into, this is resized to the amount of decoded samples so its capacity can be reused across buffers
+         * @note Any trailing partial frame is ignored
          */
-        std::vector<i16> Decode(span <u8> adpcmData);
+        void Decode(span<const u8> adpcmData, std::vector<i16> &output);
     };
 }
@@ -12,7 +12,7 @@ namespace skyline {
         constexpr u8 StereoChannelCount{2}; //!< Channels to use for stereo audio output
         constexpr u8 SurroundChannelCount{6}; //!< Channels to use for surround audio output (downsampled by backend)
         constexpr u16 MixBufferSize{960}; //!< Default size of the audren mix buffer
-        constexpr auto PcmFormat{oboe::AudioFormat::I16}; //!< PCM data format to use for audio output
+        constexpr auto PcmFormat{oboe::AudioFormat::Float}; //!< PCM data format to request for audio output, floating-point streams have a lower latency on many devices but the mixer also handles 16-bit streams if a device doesn't support them
     }
 
     namespace audio {
@@ -35,7 +35,6 @@ namespace skyline {
         struct BufferIdentifier {
             u64 tag;
             u64 finalSample; //!< The final sample this buffer will be played in, after that the buffer can be safely released
-            bool released; //!< If the buffer has been released (fully played back)
         };
 
         /**
@@ -3,6 +3,9 @@
 
 #pragma once
 
+#ifdef __ARM_NEON
+#include <arm_neon.h>
+#endif
 #include <common.h>
 #include "common.h"
 
@@ -29,29 +32,60 @@ namespace skyline::audio {
 
     /**
      * @brief Downmixes a buffer of 5.1 surround audio to stereo
+     * @param stereoSamples The buffer to write the stereo samples to, this may alias the start of the surround samples to downmix in-place
      */
-    inline std::vector<StereoSample> DownMix(span<Surround51Sample> surroundSamples) {
-        constexpr i16 FixedPointMultiplier{1000}; //!< Avoids using floating point maths
-        constexpr i16 Attenuation3Db{707}; //! 10^(-3/20)
-        constexpr i16 Attenuation6Db{501}; //! 10^(-6/20)
-        constexpr i16 Attenuation12Db{251}; //! 10^(-6/20)
-
-        auto downmixChannel{[](i32 front, i32 centre, i32 lowFrequency, i32 back) {
-            return static_cast<i16>(front +
-                                    (centre * Attenuation3Db +
-                                     lowFrequency * Attenuation12Db +
-                                     back * Attenuation6Db) / FixedPointMultiplier);
+    inline void DownMix(span<Surround51Sample> surroundSamples, span<StereoSample> stereoSamples) {
+        constexpr float Attenuation3Db{0.707f}; //!< 10^(-3/20)
+        constexpr float Attenuation6Db{0.501f}; //!< 10^(-6/20)
+        constexpr float Attenuation12Db{0.251f}; //!< 10^(-12/20)
+
+        size_t index{};
+        #ifdef __ARM_NEON
+        // Loading pairs of channels as 32-bit lanes deinterleaves the samples into front, centre/LFE and back vectors with lanes that line up with the stereo output
+        // The centre/LFE vector is multiplied both as-is and with its halves swapped so that every output lane gets the centre and LFE channels
+        static_assert(sizeof(Surround51Sample) == sizeof(u32) * 3 && sizeof(StereoSample) == sizeof(u32));
+        constexpr std::array<float, 4> CentreCoefficients{Attenuation3Db, Attenuation12Db, Attenuation3Db, Attenuation12Db};
+        constexpr std::array<float, 4> SwappedCentreCoefficients{Attenuation12Db, Attenuation3Db, Attenuation12Db, Attenuation3Db};
+        float32x4_t centreCoefficients{vld1q_f32(CentreCoefficients.data())}, swappedCentreCoefficients{vld1q_f32(SwappedCentreCoefficients.data())};
+
+        auto downmixHalf{[&](int16x4_t front, int16x4_t centre, int16x4_t swappedCentre, int16x4_t back) {
+            float32x4_t value{vcvtq_f32_s32(vmovl_s16(front))};
+            value = vfmaq_f32(value, vcvtq_f32_s32(vmovl_s16(centre)), centreCoefficients);
+            value = vfmaq_f32(value, vcvtq_f32_s32(vmovl_s16(swappedCentre)), swappedCentreCoefficients);
+            value = vfmaq_n_f32(value, vcvtq_f32_s32(vmovl_s16(back)), Attenuation6Db);
+            return vqmovn_s32(vcvtnq_s32_f32(value));
         }};
 
-        std::vector<StereoSample> stereoSamples(surroundSamples.size());
-        for (size_t i{}; i < surroundSamples.size(); i++) {
-            auto &surroundSample = surroundSamples[i];
-            auto &stereoSample = stereoSamples[i];
+        for (; index + 4 <= surroundSamples.size(); index += 4) {
+            int32x4x3_t pairs{vld3q_s32(reinterpret_cast<const i32 *>(surroundSamples.data() + index))};
+            int16x8_t front{vreinterpretq_s16_s32(pairs.val[0])}, centre{vreinterpretq_s16_s32(pairs.val[1])}, back{vreinterpretq_s16_s32(pairs.val[2])};
+            int16x8_t swappedCentre{vrev32q_s16(centre)};
+
+            int16x4_t low{downmixHalf(vget_low_s16(front), vget_low_s16(centre), vget_low_s16(swappedCentre), vget_low_s16(back))};
+            int16x4_t high{downmixHalf(vget_high_s16(front), vget_high_s16(centre), vget_high_s16(swappedCentre), vget_high_s16(back))};
+            vst1q_s16(reinterpret_cast<i16 *>(stereoSamples.data() + index), vcombine_s16(low, high));
+        }
+        #endif
+
+        auto downmixChannel{[](i16 front, i16 centre, i16 lowFrequency, i16 back) {
+            return Saturate<i16, long>(std::lrint(static_cast<float>(front) + static_cast<float>(centre) * Attenuation3Db + static_cast<float>(lowFrequency) * Attenuation12Db + static_cast<float>(back) * Attenuation6Db));
+        }};
 
-            stereoSample.left = downmixChannel(surroundSample.frontLeft, surroundSample.centre, surroundSample.lowFrequency, surroundSample.backLeft);
-            stereoSample.right = downmixChannel(surroundSample.frontRight, surroundSample.centre, surroundSample.lowFrequency, surroundSample.backRight);
+        for (; index < surroundSamples.size(); index++) {
+            auto surroundSample{surroundSamples[index]}; // This must be copied as the stereo sample may alias it
+            stereoSamples[index] = StereoSample{
+                .left = downmixChannel(surroundSample.frontLeft, surroundSample.centre, surroundSample.lowFrequency, surroundSample.backLeft),
+                .right = downmixChannel(surroundSample.frontRight, surroundSample.centre, surroundSample.lowFrequency, surroundSample.backRight),
+            };
         }
+    }
 
+    /**
+     * @brief Downmixes a buffer of 5.1 surround audio to stereo
+     */
+    inline std::vector<StereoSample> DownMix(span<Surround51Sample> surroundSamples) {
+        std::vector<StereoSample> stereoSamples(surroundSamples.size());
+        DownMix(surroundSamples, stereoSamples);
         return stereoSamples;
     }
 }
@@ -0,0 +1,155 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2023 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#pragma once
+
+#ifdef __ARM_NEON
+#include <arm_neon.h>
+#endif
+#include <common.h>
+#include "common.h"
+
+namespace skyline::audio {
+    /**
+     * @brief Deinterleaves stereo 16-bit PCM samples into a pair of planar floating-point buffers while linearly ramping their volume
+     * @param volume The volume of the first stereo frame
+     * @param volumeStep The amount the volume changes by for every subsequent stereo frame
+     * @note Both outputs must contain at least as many samples as there are frames in the input
+     */
+    inline void DeinterleaveSamples(span<const i16> input, span<float> left, span<float> right, float volume, float volumeStep) {
+        size_t frameCount{input.size() / constant::StereoChannelCount}, frame{};
+        #ifdef __ARM_NEON
+        std::array<float, 4> initialVolumes{volume, volume + volumeStep, volume + volumeStep * 2, volume + volumeStep * 3};
+        float32x4_t frameVolumes{vld1q_f32(initialVolumes.data())};
+        float32x4_t volumeIncrement{vdupq_n_f32(volumeStep * 4)};
+        for (; frame + 4 <= frameCount; frame += 4) {
+            int16x4x2_t samples{vld2_s16(input.data() + frame * constant::StereoChannelCount)};
+            vst1q_f32(left.data() + frame, vmulq_f32(vcvtq_f32_s32(vmovl_s16(samples.val[0])), frameVolumes));
+            vst1q_f32(right.data() + frame, vmulq_f32(vcvtq_f32_s32(vmovl_s16(samples.val[1])), frameVolumes));
+            frameVolumes = vaddq_f32(frameVolumes, volumeIncrement);
+        }
+        #endif
+
+        for (; frame < frameCount; frame++) {
+            float frameVolume{volume + volumeStep * static_cast<float>(frame)};
+            left[frame] = static_cast<float>(input[frame * constant::StereoChannelCount]) * frameVolume;
+            right[frame] = static_cast<float>(input[frame * constant::StereoChannelCount + 1]) * frameVolume;
+        }
+    }
+
+    /**
+     * @brief Mixes a planar floating-point buffer into another at a constant volume
+     * @note The output and input must be the same size
+     */
+    inline void MixSamples(span<float> output, span<const float> input, float volume) {
+        size_t index{};
+        #ifdef __ARM_NEON
+        for (; index + 4 <= input.size(); index += 4)
+            vst1q_f32(output.data() + index, vfmaq_n_f32(vld1q_f32(output.data() + index), vld1q_f32(input.data() + index), volume));
+        #endif
+
+        for (; index < input.size(); index++)
+            output[index] += input[index] * volume;
+    }
+
+    /**
+     * @brief Interleaves a pair of planar floating-point buffers into saturated stereo 16-bit PCM samples, rounding to the nearest integer
+     * @param volume A volume applied to all samples during the conversion
+     */
+    inline void InterleaveSamples(span<i16> output, span<const float> left, span<const float> right, float volume) {
+        size_t frameCount{output.size() / constant::StereoChannelCount}, frame{};
+        #ifdef __ARM_NEON
+        for (; frame + 4 <= frameCount; frame += 4) {
+            int16x4x2_t samples{
+                vqmovn_s32(vcvtnq_s32_f32(vmulq_n_f32(vld1q_f32(left.data() + frame), volume))),
+                vqmovn_s32(vcvtnq_s32_f32(vmulq_n_f32(vld1q_f32(right.data() + frame), volume))),
+            };
+            vst2_s16(output.data() + frame * constant::StereoChannelCount, samples);
+        }
+        #endif
+
+        for (; frame < frameCount; frame++) {
+            output[frame * constant::StereoChannelCount] = Saturate<i16, long>(std::lrint(left[frame] * volume));
+            output[frame * constant::StereoChannelCount + 1] = Saturate<i16, long>(std::lrint(right[frame] * volume));
+        }
+    }
+
+    /**
+     * @brief Mixes interleaved 16-bit PCM samples into a floating-point accumulation buffer at a constant volume
+     * @note The output must contain at least as many samples as the input
+     */
+    inline void AccumulateSamples(span<float> output, span<const i16> input, float volume) {
+        size_t index{};
+        #ifdef __ARM_NEON
+        for (; index + 8 <= input.size(); index += 8) {
+            int16x8_t samples{vld1q_s16(input.data() + index)};
+            vst1q_f32(output.data() + index, vfmaq_n_f32(vld1q_f32(output.data() + index), vcvtq_f32_s32(vmovl_s16(vget_low_s16(samples))), volume));
+            vst1q_f32(output.data() + index + 4, vfmaq_n_f32(vld1q_f32(output.data() + index + 4), vcvtq_f32_s32(vmovl_high_s16(samples)), volume));
+        }
+        #endif
+
+        for (; index < input.size(); index++)
+            output[index] += static_cast<float>(input[index]) * volume;
+    }
+
+    /**
+     * @brief Converts floating-point samples in the 16-bit PCM range into saturated 16-bit PCM samples, rounding to the nearest integer
+     * @note The output and input must be the same size
+     */
+    inline void ConvertSamples(span<i16> output, span<const float> input) {
+        size_t index{};
+        #ifdef __ARM_NEON
+        for (; index + 8 <= input.size(); index += 8)
+            vst1q_s16(output.data() + index, vcombine_s16(vqmovn_s32(vcvtnq_s32_f32(vld1q_f32(input.data() + index))), vqmovn_s32(vcvtnq_s32_f32(vld1q_f32(input.data() + index + 4)))));
+        #endif
+
+        for (; index < input.size(); index++)
+            output[index] = Saturate<i16, long>(std::lrint(input[index]));
+    }
+
+    /**
+     * @brief Converts floating-point samples in the 16-bit PCM range into normalized floating-point samples clamped to [-1, 1]
+     * @note The output and input must be the same size
+     */
+    inline void ConvertSamples(span<float> output, span<const float> input) {
+        constexpr float Scale{1.0f / (1 << 15)};
+        size_t index{};
+        #ifdef __ARM_NEON
+        float32x4_t minimum{vdupq_n_f32(-1.0f)}, maximum{vdupq_n_f32(1.0f)};
+        for (; index + 4 <= input.size(); index += 4)
+            vst1q_f32(output.data() + index, vminq_f32(vmaxq_f32(vmulq_n_f32(vld1q_f32(input.data() + index), Scale), minimum), maximum));
+        #endif
+
+        for (; index < input.size(); index++)
+            output[index] = std::clamp(input[index] * Scale, -1.0f, 1.0f);
+    }
+
+    /**
+     * @brief The coefficients of a second-order IIR filter as supplied by the guest in Q2.14 fixed-point, the feedback coefficients are pre-negated
+     */
+    struct BiquadCoefficients {
+        std::array<i16, 3> b; //!< The feedforward coefficients
+        std::array<i16, 2> a; //!< The negated feedback coefficients
+    };
+
+    /**
+     * @brief Applies a biquad filter to a planar buffer using the transposed direct form II structure, a filter is recursive and so this can't be vectorized across samples
+     * @param state The state of the filter carried across buffers, this should be zeroed when the filter is (re)initialized
+     * @note The output may alias the input
+     */
+    inline void ApplyBiquadFilter(span<float> output, span<const float> input, const BiquadCoefficients &coefficients, std::array<float, 2> &state) {
+        constexpr float FixedPointScale{1.0f / (1 << 14)};
+        float b0{coefficients.b[0] * FixedPointScale}, b1{coefficients.b[1] * FixedPointScale}, b2{coefficients.b[2] * FixedPointScale};
+        float a1{coefficients.a[0] * FixedPointScale}, a2{coefficients.a[1] * FixedPointScale};
+
+        auto [s0, s1]{state};
+        for (size_t index{}; index < input.size(); index++) {
+            float sample{input[index]};
+            float filtered{sample * b0 + s0};
+            s0 = sample * b1 + filtered * a1 + s1;
+            s1 = sample * b2 + filtered * a2;
+            output[index] = filtered;
+        }
+        state = {s0, s1};
+    }
+}
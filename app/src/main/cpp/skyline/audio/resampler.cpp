@@ -1,19 +1,16 @@
 // SPDX-License-Identifier: MPL-2.0
 // Copyright © 2020 Skyline Team and Contributors (https://github.com/skyline-emu/)
 
-#include "common.h"
+#ifdef __ARM_NEON
+#include <arm_neon.h>
+#endif
 #include "resampler.h"
 
 namespace skyline::audio {
     /**
-     * @brief The coefficients for each index of a single output frame
+     * @brief The coefficients of a single phase of the filter, these are applied to consecutive input frames in Q1.15 fixed-point
      */
-    struct LutEntry {
-        i32 a;
-        i32 b;
-        i32 c;
-        i32 d;
-    };
+    using LutEntry = std::array<i16, Resampler::TapCount>;
 
     // @fmt:off
     constexpr std::array<LutEntry, 128> CurveLut0{{
@@ -119,40 +116,95 @@ namespace skyline::audio {
         {-42, 3751, 26253, 2811},   {-38, 3608, 26270, 2936},   {-34, 3467, 26281, 3064},   {-32, 3329, 26287, 3195}}};
     // @fmt:on
 
-    std::vector<i16> Resampler::ResampleBuffer(span<i16> inputBuffer, double ratio, u8 channelCount) {
+    constexpr size_t PhaseShift{8}; //!< The amount of bits the Q17.15 fraction is shifted by to get the index of its phase
+    constexpr u32 FractionBits{15};
+    constexpr u32 FractionMask{(1U << FractionBits) - 1};
+
+    static const std::array<LutEntry, 128> &GetLut(u32 step) {
+        if (step > 0xAAAA)
+            return CurveLut0;
+        else if (step <= 0x8000)
+            return CurveLut1;
+        else
+            return CurveLut2;
+    }
+
+    /**
+     * @brief Interpolates a single output frame from TapCount consecutive interleaved input frames
+     */
+    static void InterpolateFrame(const i16 *input, i16 *output, const LutEntry &coefficients, u8 channelCount) {
+        #ifdef __ARM_NEON
+        int16x4_t taps{vld1_s16(coefficients.data())};
+        if (channelCount == constant::StereoChannelCount) {
+            int16x4x2_t frames{vld2_s16(input)};
+            output[0] = Saturate<i16, i64>(vaddlvq_s32(vmull_s16(frames.val[0], taps)) >> FractionBits);
+            output[1] = Saturate<i16, i64>(vaddlvq_s32(vmull_s16(frames.val[1], taps)) >> FractionBits);
+            return;
+        } else if (channelCount == 1) {
+            output[0] = Saturate<i16, i64>(vaddlvq_s32(vmull_s16(vld1_s16(input), taps)) >> FractionBits);
+            return;
+        }
+        #endif
+
+        for (u8 channel{}; channel < channelCount; channel++) {
+            i32 data{};
+            for (size_t tap{}; tap < Resampler::TapCount; tap++)
+                data += input[tap * channelCount + channel] * coefficients[tap];
+            output[channel] = Saturate<i16, i32>(data >> FractionBits);
+        }
+    }
+
+    size_t Resampler::GetMaxOutputSize(size_t inputSize, double ratio, u8 channelCount) {
         auto step{static_cast<u32>(ratio * 0x8000)};
-        auto outputSize{static_cast<size_t>(inputBuffer.size() / ratio)};
-        std::vector<i16> outputBuffer(outputSize);
-
-        const std::array<LutEntry, 128> &lut = [step] {
-            if (step > 0xAAAA)
-                return CurveLut0;
-            else if (step <= 0x8000)
-                return CurveLut1;
-            else
-                return CurveLut2;
-        }();
-
-        for (size_t outIndex{}, inIndex{}; outIndex < outputSize; outIndex += channelCount) {
-            u32 lutIndex{fraction >> 8};
-
-            for (u8 channel{}; channel < channelCount; channel++) {
-                if (((inIndex + 3) * channelCount + channel) >= inputBuffer.size())
-                    continue;
-
-                i32 data{inputBuffer[(inIndex + 0) * channelCount + channel] * lut[lutIndex].a +
-                         inputBuffer[(inIndex + 1) * channelCount + channel] * lut[lutIndex].b +
-                         inputBuffer[(inIndex + 2) * channelCount + channel] * lut[lutIndex].c +
-                         inputBuffer[(inIndex + 3) * channelCount + channel] * lut[lutIndex].d};
-
-                outputBuffer[outIndex + channel] = Saturate<i16, i32>(data >> 15);
-            }
-
-            u32 newOffset{fraction + step};
-            inIndex += newOffset >> 15;
-            fraction = newOffset & 0x7FFF;
+        size_t inputFrames{inputSize / channelCount + HistoryFrames};
+        return (util::DivideCeil<size_t>(inputFrames << FractionBits, step) + 1) * channelCount;
+    }
+
+    void Resampler::Reset() {
+        history = {};
+        position = 0;
+    }
+
+    size_t Resampler::Resample(span<const i16> input, span<i16> output, double ratio, u8 pChannelCount) {
+        if (channelCount != pChannelCount) {
+            Reset();
+            channelCount = pChannelCount;
         }
 
-        return outputBuffer;
+        size_t inputFrames{input.size() / channelCount};
+        if (inputFrames == 0)
+            return 0;
+
+        auto step{static_cast<u32>(ratio * 0x8000)};
+        const auto &lut{GetLut(step)};
+
+        // The input is virtually prefixed by the history, windows overlapping both are interpolated from a bridge buffer so the rest can be read directly from the input
+        std::array<i16, HistoryFrames * 2 * constant::SurroundChannelCount> bridge{};
+        size_t historySamples{HistoryFrames * channelCount};
+        std::copy_n(history.begin(), historySamples, bridge.begin());
+        std::copy_n(input.begin(), std::min(input.size(), historySamples), bridge.begin() + static_cast<ptrdiff_t>(historySamples));
+
+        size_t totalFrames{inputFrames + HistoryFrames}, outIndex{};
+        size_t frame{position >> FractionBits};
+        u32 fraction{position & FractionMask};
+        while (frame + TapCount <= totalFrames && outIndex + channelCount <= output.size()) {
+            const i16 *window{frame < HistoryFrames ? bridge.data() + frame * channelCount : input.data() + (frame - HistoryFrames) * channelCount};
+            InterpolateFrame(window, output.data() + outIndex, lut[fraction >> PhaseShift], channelCount);
+            outIndex += channelCount;
+
+            fraction += step;
+            frame += fraction >> FractionBits;
+            fraction &= FractionMask;
+        }
+
+        // The last frames of the history and input are retained for the following buffer, the window position is rebased accordingly
+        size_t retainedFrames{std::min(inputFrames, HistoryFrames)};
+        std::copy(history.begin() + static_cast<ptrdiff_t>(retainedFrames * channelCount), history.begin() + static_cast<ptrdiff_t>(historySamples), history.begin());
+        std::copy_n(input.end() - static_cast<ptrdiff_t>(retainedFrames * channelCount), retainedFrames * channelCount, history.begin() + static_cast<ptrdiff_t>((HistoryFrames - retainedFrames) * channelCount));
+
+        frame = std::max(frame, totalFrames - TapCount + 1) - inputFrames;
+        position = static_cast<u32>((frame << FractionBits) | fraction);
+
+        return outIndex;
     }
 }
@@ -4,22 +4,42 @@
 #pragma once
 
 #include <common.h>
+#include "common.h"
 
 namespace skyline::audio {
     /**
-     * @brief The Resampler class handles resampling audio PCM data
+     * @brief The Resampler class handles resampling a stream of PCM data using a 4-tap polyphase filter with 128 phases
+     * @note The filter state is carried across calls so consecutive buffers of a stream are resampled as if they were contiguous
      */
     class Resampler {
+      public:
+        static constexpr size_t TapCount{4}; //!< The amount of input frames every output frame is interpolated from
+
       private:
-        u32 fraction{}; //!< The fractional value used for storing the resamplers last frame
+        static constexpr size_t HistoryFrames{TapCount - 1}; //!< The amount of trailing input frames that need to be retained for the filter window of the next buffer
+
+        std::array<i16, HistoryFrames * constant::SurroundChannelCount> history{}; //!< The trailing frames of the previous buffer
+        u32 position{}; //!< The position of the next filter window relative to the start of the history in Q17.15 fixed-point
+        u8 channelCount{};
 
       public:
         /**
-         * @brief Resamples the given sample buffer by the given ratio
-         * @param inputBuffer A buffer containing PCM sample data
-         * @param ratio The conversion ratio needed
-         * @param channelCount The amount of channels the buffer contains
+         * @return The maximum amount of samples that Resample could write for an input of the supplied size
+         */
+        static size_t GetMaxOutputSize(size_t inputSize, double ratio, u8 channelCount);
+
+        /**
+         * @brief Discards the state of the stream, the next buffer is resampled as the start of a new stream
+         */
+        void Reset();
+
+        /**
+         * @brief Resamples the next buffer of the stream into the supplied output
+         * @param ratio The ratio of the input sample rate to the output sample rate
+         * @param channelCount The amount of interleaved channels in the input, the stream is reset if this changes
+         * @return The amount of samples written into the output
+         * @note The output should contain at least GetMaxOutputSize() samples, any frames that don't fit are dropped
          */
-        std::vector<i16> ResampleBuffer(span <i16> inputBuffer, double ratio, u8 channelCount);
+        size_t Resample(span<const i16> input, span<i16> output, double ratio, u8 channelCount);
     };
 }
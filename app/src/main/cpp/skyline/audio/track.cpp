@@ -18,8 +18,8 @@ namespace skyline::audio {
 
     void AudioTrack::Stop() {
         auto allSamplesReleased{[&]() {
-            std::scoped_lock lock{bufferLock};
-            return identifiers.empty() || identifiers.back().released;
+            std::scoped_lock lock{identifierLock};
+            return identifiers.empty() || IsReleased(identifiers.front());
         }};
 
         while (!allSamplesReleased());
@@ -27,12 +27,12 @@ namespace skyline::audio {
     }
 
     bool AudioTrack::ContainsBuffer(u64 tag) {
-        std::scoped_lock lock(bufferLock);
+        std::scoped_lock lock(identifierLock);
 
         // Iterate from front of queue as we don't want released samples
         for (auto identifier{identifiers.crbegin()}; identifier != identifiers.crend(); identifier++) {
-            if (identifier->released)
-                return false;
+            if (IsReleased(*identifier))
+                continue;
 
             if (identifier->tag == tag)
                 return true;
@@ -43,10 +43,10 @@ namespace skyline::audio {
 
     std::vector<u64> AudioTrack::GetReleasedBuffers(u32 max) {
         std::vector<u64> bufferIds;
-        std::scoped_lock lock(bufferLock);
+        std::scoped_lock lock(identifierLock);
 
         for (u32 index{}; index < max; index++) {
-            if (identifiers.empty() || !identifiers.back().released)
+            if (identifiers.empty() || !IsReleased(identifiers.back()))
                 break;
             bufferIds.push_back(identifiers.back().tag);
             identifiers.pop_back();
@@ -56,33 +56,44 @@ namespace skyline::audio {
     }
 
     void AudioTrack::AppendBuffer(u64 tag, span<i16> buffer) {
-        std::scoped_lock lock(bufferLock);
-
-        size_t size{(channelCount == constant::SurroundChannelCount) ? (buffer.size() / sizeof(Surround51Sample)) * sizeof(StereoSample) : buffer.size()};
-        BufferIdentifier identifier{
-            .released = false,
-            .tag = tag,
-            .finalSample = identifiers.empty() ? size : (size + identifiers.front().finalSample)
-        };
-
-        identifiers.push_front(identifier);
+        std::scoped_lock lock(identifierLock);
 
+        // The buffer only spans the samples that fit into the ring, anything past that is dropped so that the buffer is still released once the written samples are played
+        size_t written;
         if (channelCount == constant::SurroundChannelCount) {
             auto stereoBuffer{DownMix(buffer.cast<Surround51Sample>())};
-            samples.Append(span(stereoBuffer).cast<i16>());
+            written = samples.Write(span(stereoBuffer).cast<i16>());
         } else {
-            samples.Append(buffer);
+            written = samples.Write(buffer);
         }
+
+        appendedSamples += written;
+        identifiers.push_front(BufferIdentifier{
+            .tag = tag,
+            .finalSample = appendedSamples,
+        });
+
+        if (!pendingReleases.Write(span<const u64>{&appendedSamples, 1}))
+            Logger::Warn("Too many audio buffers are pending release, the release of buffer 0x{:X} won't be signalled", tag);
     }
 
     void AudioTrack::CheckReleasedBuffers() {
         bool anyReleased{};
-
-        for (auto &identifier : identifiers) {
-            if (identifier.finalSample <= sampleCounter && !identifier.released) {
-                anyReleased = true;
-                identifier.released = true;
+        u64 playedSamples{sampleCounter.load(std::memory_order_relaxed)};
+
+        while (true) {
+            if (!nextRelease) {
+                u64 finalSample;
+                if (!pendingReleases.Read(span<u64>{&finalSample, 1}))
+                    break;
+                nextRelease = finalSample;
             }
+
+            if (*nextRelease > playedSamples)
+                break;
+
+            anyReleased = true;
+            nextRelease.reset();
         }
 
         if (anyReleased)
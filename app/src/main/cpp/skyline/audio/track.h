@@ -5,27 +5,35 @@
 
 #include <deque>
 #include <kernel/types/KEvent.h>
-#include <common/circular_buffer.h>
+#include <common/spsc_ring.h>
 #include "common.h"
 
 namespace skyline::audio {
     /**
      * @brief The AudioTrack class manages the buffers for an audio stream
+     * @note Guest threads are the only producer and the audio callback is the only consumer of the track's rings, so the callback never waits on a guest thread
      */
     class AudioTrack {
       private:
         std::function<void()> releaseCallback; //!< Callback called when a buffer has been played
-        std::deque<BufferIdentifier> identifiers; //!< Queue of all appended buffer identifiers
+        std::deque<BufferIdentifier> identifiers; //!< Queue of all appended buffer identifiers which haven't been retrieved as released, this is only accessed by guest threads
+        std::mutex identifierLock; //!< Synchronizes guest threads accessing the identifiers
+        SpscRing<u64, 0x400> pendingReleases; //!< The final samples of all appended buffers in order, the audio callback uses these to determine when to call the release callback
+        std::optional<u64> nextRelease; //!< The final sample of the next buffer to be released that was already taken from pendingReleases, this is only accessed by the audio callback
+        u64 appendedSamples{}; //!< The total amount of samples appended to the track, this is only accessed by guest threads with identifierLock held
 
         u8 channelCount;
         u32 sampleRate;
 
-      public:
-        CircularBuffer<i16, constant::SampleRate * constant::StereoChannelCount * 10> samples; //!< A circular buffer with all appended audio samples
-        std::mutex bufferLock; //!< Synchronizes appending to audio buffers
+        bool IsReleased(const BufferIdentifier &identifier) const {
+            return identifier.finalSample <= sampleCounter.load(std::memory_order_acquire);
+        }
 
-        AudioOutState playbackState{AudioOutState::Stopped}; //!< The current state of playback
-        u64 sampleCounter{}; //!< A counter used for tracking when buffers have been played and can be released
+      public:
+        SpscRing<i16, constant::SampleRate * constant::StereoChannelCount * 10> samples; //!< A ring with all appended audio samples
+        std::atomic<AudioOutState> playbackState{AudioOutState::Stopped}; //!< The current state of playback
+        std::atomic<u64> sampleCounter{}; //!< The total amount of samples played back, this is only written by the audio callback and used for tracking when buffers have been played and can be released
+        std::atomic<float> volume{1.0f}; //!< The volume the samples of this track are scaled by while being mixed
 
         /**
          * @param channelCount The amount channels that will be present in the track
@@ -69,7 +77,7 @@ namespace skyline::audio {
 
         /**
          * @brief Checks if any buffers have been released and calls the appropriate callback for them
-         * @note bufferLock MUST be locked when calling this
+         * @note This must only be called by the audio callback
          */
         void CheckReleasedBuffers();
     };
@@ -17,6 +17,19 @@ namespace skyline {
 
     struct EmptyStruct {};
 
+    /**
+     * @brief A callback which is invoked with every host span that's accessed by a memory manager operation, this is a template parameter rather than a type-erased function so the callback can be inlined
+     */
+    template<typename Callback>
+    concept CpuAccessCallback = std::invocable<Callback, span<u8>>;
+
+    /**
+     * @brief The default callback for memory manager operations which does nothing and is optimized out entirely
+     */
+    struct NoCpuAccessCallback {
+        constexpr void operator()(span<u8>) const {}
+    };
+
     /**
      * @brief FlatAddressSpaceMap provides a generic VA->PA mapping implementation using a sorted vector
      */
@@ -109,21 +122,58 @@ namespace skyline {
         static constexpr size_t AddressSpaceSize{1ULL << AddressSpaceBits};
         SegmentTable<SegmentTableEntry, AddressSpaceSize, VaGranularityBits, VaL2GranularityBits> blockSegmentTable; //!< A page table of all buffer mappings for O(1) lookups on full matches
 
-        TranslatedAddressRange TranslateRangeImpl(VaType virt, VaType size, std::function<void(span<u8>)> cpuAccessCallback = {});
+        /**
+         * @brief Translates a region in the VA space into a list of host spans in order, unmapped regions are represented by spans with a null pointer and sparse regions by spans into the sparse map
+         * @note blockMutex MUST be locked when calling this
+         */
+        TranslatedAddressRange TranslateRangeImpl(VaType virt, VaType size);
 
-        std::pair<span<u8>, size_t> LookupBlockLocked(VaType virt, std::function<void(span<u8>)> cpuAccessCallback = {}) {
+        /**
+         * @return If the supplied span was returned by TranslateRangeImpl for a sparse mapping
+         */
+        bool IsSparseRange(span<u8> range) {
+            return range.data() == sparseMap;
+        }
+
+        template<CpuAccessCallback Callback>
+        std::pair<span<u8>, size_t> LookupBlockLocked(VaType virt, Callback &&cpuAccessCallback) {
             const auto &blockEntry{this->blockSegmentTable[virt]};
             if (blockEntry.phys == nullptr)
                 return {span<u8>{}, 0};
 
             VaType segmentOffset{virt - blockEntry.virt};
             span<u8> blockSpan{blockEntry.phys, blockEntry.extent};
-            if (cpuAccessCallback)
-                cpuAccessCallback(blockSpan);
+            cpuAccessCallback(blockSpan);
 
             return {blockSpan, segmentOffset};
         }
 
+        /**
+         * @return The segment table entry of the mapping which entirely contains the supplied range or nullptr if it spans multiple mappings or is unmapped
+         * @note This is an O(1) lookup in the segment table as opposed to a binary search of the blocks, it's used as a fast path for accesses within a single mapping which are the vast majority
+         */
+        const SegmentTableEntry *LookupContainingEntryLocked(VaType virt, VaType size) {
+            const auto &blockEntry{this->blockSegmentTable[virt]};
+            if (blockEntry.phys && virt + size <= blockEntry.virt + blockEntry.extent) [[likely]]
+                return &blockEntry;
+            return nullptr;
+        }
+
+        /**
+         * @brief Trims the segment table entries of any mappings which partially overlap the supplied range so that they don't extend into it
+         * @note This must be called prior to setting the range in the segment table, otherwise lookups of the remaining parts of an older overlapping mapping would return an extent that covers the new one
+         */
+        void TrimSegmentEntriesLocked(VaType virt, VaType end) {
+            auto before{blockSegmentTable[virt]};
+            if (before.phys && before.virt < virt)
+                blockSegmentTable.Set(before.virt, virt, {before.virt, before.phys, virt - before.virt, before.extraInfo});
+
+            auto after{blockSegmentTable[end - 1]};
+            VaType afterEnd{after.virt + after.extent};
+            if (after.phys && afterEnd > end)
+                blockSegmentTable.Set(end, afterEnd, {end, after.extraInfo.sparseMapped ? after.phys : after.phys + (end - after.virt), afterEnd - end, after.extraInfo});
+        }
+
       public:
         FlatMemoryManager();
 
@@ -140,15 +190,17 @@ namespace skyline {
          * @brief Looks up the mapped region that contains the given VA
          * @return A span of the mapped region and the offset of the input VA in the region
          */
-        __attribute__((always_inline)) std::pair<span<u8>, VaType> LookupBlock(VaType virt, std::function<void(span<u8>)> cpuAccessCallback = {}) {
+        template<CpuAccessCallback Callback = NoCpuAccessCallback>
+        __attribute__((always_inline)) std::pair<span<u8>, VaType> LookupBlock(VaType virt, Callback &&cpuAccessCallback = {}) {
             std::scoped_lock lock{this->blockMutex};
-            return LookupBlockLocked(virt, cpuAccessCallback);
+            return LookupBlockLocked(virt, std::forward<Callback>(cpuAccessCallback));
         }
 
         /**
          * @brief Translates a region in the VA space to a corresponding set of regions in the PA space
          */
-        TranslatedAddressRange TranslateRange(VaType virt, VaType size, std::function<void(span<u8>)> cpuAccessCallback = {}) {
+        template<CpuAccessCallback Callback = NoCpuAccessCallback>
+        TranslatedAddressRange TranslateRange(VaType virt, VaType size, Callback &&cpuAccessCallback = {}) {
             std::scoped_lock lock{this->blockMutex};
 
             // Fast path for when the range is mapped in a single block
@@ -159,21 +211,57 @@ namespace skyline {
                 return ranges;
             }
 
-            return TranslateRangeImpl(virt, size, cpuAccessCallback);
+            auto ranges{TranslateRangeImpl(virt, size)};
+            for (auto range : ranges)
+                if (range.data())
+                    cpuAccessCallback(range);
+            return ranges;
         }
 
+        /**
+         * @brief Reads the contents of a region in the VA space into the destination buffer
+         * @note Regions spanning multiple blocks are gathered from a single translation of the range rather than looking up every block individually
+         */
+        template<CpuAccessCallback Callback = NoCpuAccessCallback>
+        void Read(u8 *destination, VaType virt, VaType size, Callback &&cpuAccessCallback = {}) {
+            std::scoped_lock lock{this->blockMutex};
+
+            if (auto blockEntry{LookupContainingEntryLocked(virt, size)}) [[likely]] {
+                if (blockEntry->extraInfo.sparseMapped) {
+                    std::memset(destination, 0, size);
+                } else {
+                    u8 *blockPhys{blockEntry->phys + (virt - blockEntry->virt)};
+                    cpuAccessCallback(span<u8>{blockPhys, size});
+                    std::memcpy(destination, blockPhys, size);
+                }
+                return;
+            }
+
+            for (auto range : TranslateRangeImpl(virt, size)) {
+                if (!range.data())
+                    throw exception("Page fault at 0x{:X}", virt);
 
-        void Read(u8 *destination, VaType virt, VaType size, std::function<void(span<u8>)> cpuAccessCallback = {});
+                if (IsSparseRange(range)) { // Sparse mappings read all zeroes
+                    std::memset(destination, 0, range.size());
+                } else {
+                    cpuAccessCallback(range);
+                    std::memcpy(destination, range.data(), range.size());
+                }
 
-        template<typename T>
-        void Read(span <T> destination, VaType virt, std::function<void(span<u8>)> cpuAccessCallback = {}) {
-            Read(reinterpret_cast<u8 *>(destination.data()), virt, destination.size_bytes(), cpuAccessCallback);
+                destination += range.size();
+                virt += range.size();
+            }
+        }
+
+        template<typename T, CpuAccessCallback Callback = NoCpuAccessCallback>
+        void Read(span<T> destination, VaType virt, Callback &&cpuAccessCallback = {}) {
+            Read(reinterpret_cast<u8 *>(destination.data()), virt, destination.size_bytes(), std::forward<Callback>(cpuAccessCallback));
         }
 
-        template<typename T>
-        T Read(VaType virt, std::function<void(span<u8>)> cpuAccessCallback = {}) {
+        template<typename T, CpuAccessCallback Callback = NoCpuAccessCallback>
+        T Read(VaType virt, Callback &&cpuAccessCallback = {}) {
             T obj;
-            Read(reinterpret_cast<u8 *>(&obj), virt, sizeof(T), cpuAccessCallback);
+            Read(reinterpret_cast<u8 *>(&obj), virt, sizeof(T), std::forward<Callback>(cpuAccessCallback));
             return obj;
         }
 
@@ -184,8 +272,8 @@ namespace skyline {
          * @note The function will **NOT** be run on any sparse block
          * @note The function will provide no feedback on if the end has been reached or if there was an early exit
          */
-        template<typename Function, typename Container>
-        span<u8> ReadTill(Container& destination, VaType virt, Function function, std::function<void(span<u8>)> cpuAccessCallback = {}) {
+        template<typename Function, typename Container, CpuAccessCallback Callback = NoCpuAccessCallback>
+        span<u8> ReadTill(Container& destination, VaType virt, Function function, Callback &&cpuAccessCallback = {}) {
             //TRACE_EVENT("containers", "FlatMemoryManager::ReadTill");
 
             std::scoped_lock lock(this->blockMutex);
@@ -210,8 +298,7 @@ namespace skyline {
                         std::memset(pointer, 0, blockReadSize);
                     } else {
                         span<u8> cpuBlock{blockPhys, blockReadSize};
-                        if (cpuAccessCallback)
-                            cpuAccessCallback(cpuBlock);
+                        cpuAccessCallback(cpuBlock);
 
                         auto end{function(cpuBlock)};
                         std::memcpy(pointer, blockPhys, end ? *end : blockReadSize);
@@ -233,30 +320,128 @@ namespace skyline {
             return {destination.data(), destination.size()};
         }
 
-        void Write(VaType virt, u8 *source, VaType size, std::function<void(span<u8>)> cpuAccessCallback = {});
+        /**
+         * @brief Writes the contents of the source buffer into a region in the VA space
+         * @note Regions spanning multiple blocks are scattered into a single translation of the range rather than looking up every block individually
+         */
+        template<CpuAccessCallback Callback = NoCpuAccessCallback>
+        void Write(VaType virt, u8 *source, VaType size, Callback &&cpuAccessCallback = {}) {
+            std::scoped_lock lock{this->blockMutex};
+
+            if (auto blockEntry{LookupContainingEntryLocked(virt, size)}) [[likely]] {
+                if (!blockEntry->extraInfo.sparseMapped) {
+                    u8 *blockPhys{blockEntry->phys + (virt - blockEntry->virt)};
+                    cpuAccessCallback(span<u8>{blockPhys, size});
+                    std::memcpy(blockPhys, source, size);
+                }
+                return;
+            }
+
+            for (auto range : TranslateRangeImpl(virt, size)) {
+                if (!range.data())
+                    throw exception("Page fault at 0x{:X}", virt);
+
+                if (!IsSparseRange(range)) { // Sparse mappings ignore writes
+                    cpuAccessCallback(range);
+                    std::memcpy(range.data(), source, range.size());
+                }
+
+                source += range.size();
+                virt += range.size();
+            }
+        }
 
-        template<typename T>
-        void Write(VaType virt, span<T> source, std::function<void(span<u8>)> cpuAccessCallback = {}) {
-            Write(virt, reinterpret_cast<u8 *>(source.data()), source.size_bytes());
+        template<typename T, CpuAccessCallback Callback = NoCpuAccessCallback>
+        void Write(VaType virt, span<T> source, Callback &&cpuAccessCallback = {}) {
+            Write(virt, reinterpret_cast<u8 *>(source.data()), source.size_bytes(), std::forward<Callback>(cpuAccessCallback));
         }
 
-        void Write(VaType virt, util::TrivialObject auto source, std::function<void(span<u8>)> cpuAccessCallback = {}) {
-            Write(virt, reinterpret_cast<u8 *>(&source), sizeof(source), cpuAccessCallback);
+        template<CpuAccessCallback Callback = NoCpuAccessCallback>
+        void Write(VaType virt, util::TrivialObject auto source, Callback &&cpuAccessCallback = {}) {
+            Write(virt, reinterpret_cast<u8 *>(&source), sizeof(source), std::forward<Callback>(cpuAccessCallback));
         }
 
-        void Copy(VaType dst, VaType src, VaType size, std::function<void(span<u8>)> cpuAccessCallback = {});
+        /**
+         * @brief Copies the contents of a region in the VA space into another region
+         * @note Both regions are translated once up front and then walked in lockstep, copying the largest chunk that's contiguous in both of them at a time
+         */
+        template<CpuAccessCallback Callback = NoCpuAccessCallback>
+        void Copy(VaType dst, VaType src, VaType size, Callback &&cpuAccessCallback = {}) {
+            std::scoped_lock lock{this->blockMutex};
+
+            auto srcRanges{TranslateRangeImpl(src, size)}, dstRanges{TranslateRangeImpl(dst, size)};
+            auto srcRange{srcRanges.begin()}, dstRange{dstRanges.begin()};
+            VaType srcOffset{}, dstOffset{};
+
+            while (size) {
+                if (!srcRange->data())
+                    throw exception("Page fault at 0x{:X}", src);
+                else if (!dstRange->data())
+                    throw exception("Page fault at 0x{:X}", dst);
+
+                VaType copySize{static_cast<VaType>(std::min(srcRange->size() - srcOffset, dstRange->size() - dstOffset))};
+                if (!IsSparseRange(*dstRange)) { // Sparse mappings ignore writes
+                    span<u8> dstChunk{dstRange->subspan(dstOffset, copySize)};
+                    if (IsSparseRange(*srcRange)) {
+                        std::memset(dstChunk.data(), 0, copySize);
+                    } else [[likely]] {
+                        span<u8> srcChunk{srcRange->subspan(srcOffset, copySize)};
+                        cpuAccessCallback(dstChunk);
+                        cpuAccessCallback(srcChunk);
+                        std::memcpy(dstChunk.data(), srcChunk.data(), copySize);
+                    }
+                }
+
+                src += copySize;
+                dst += copySize;
+                size -= copySize;
+
+                if ((srcOffset += copySize) == srcRange->size()) {
+                    srcRange++;
+                    srcOffset = 0;
+                }
+                if ((dstOffset += copySize) == dstRange->size()) {
+                    dstRange++;
+                    dstOffset = 0;
+                }
+            }
+        }
 
         void Map(VaType virt, u8 *phys, VaType size, MemoryManagerBlockInfo extraInfo = {}) {
             std::scoped_lock lock(this->blockMutex);
+            TrimSegmentEntriesLocked(virt, virt + size);
             blockSegmentTable.Set(virt, virt + size, {virt, phys, size, extraInfo});
             this->MapLocked(virt, phys, size, extraInfo);
         }
 
         void Unmap(VaType virt, VaType size) {
             std::scoped_lock lock(this->blockMutex);
+            TrimSegmentEntriesLocked(virt, virt + size);
             blockSegmentTable.Set(virt, virt + size, {});
             this->UnmapLocked(virt, size);
         }
+
+        /**
+         * @brief A single mapping in a batch applied by MapBatch
+         */
+        struct BatchMapping {
+            VaType virt;
+            u8 *phys;
+            VaType size;
+            MemoryManagerBlockInfo extraInfo;
+        };
+
+        /**
+         * @brief Applies a batch of mappings in order with the block mutex only being locked once, lookups from other threads will never observe a partially applied batch
+         */
+        void MapBatch(span<const BatchMapping> mappings) {
+            std::scoped_lock lock(this->blockMutex);
+            for (const auto &mapping : mappings) {
+                TrimSegmentEntriesLocked(mapping.virt, mapping.virt + mapping.size);
+                blockSegmentTable.Set(mapping.virt, mapping.virt + mapping.size, {mapping.virt, mapping.phys, mapping.size, mapping.extraInfo});
+                this->MapLocked(mapping.virt, mapping.phys, mapping.size, mapping.extraInfo);
+            }
+        }
     };
 
     /**
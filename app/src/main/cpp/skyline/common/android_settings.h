@@ -35,14 +35,38 @@ namespace skyline {
             usernameValue = std::move(ktSettings.GetString("usernameValue"));
             systemLanguage = ktSettings.GetInt<skyline::language::SystemLanguage>("systemLanguage");
             systemRegion = ktSettings.GetInt<skyline::region::RegionCode>("systemRegion");
+            preemptionTimeslice = ktSettings.GetInt<u32>("preemptionTimeslice");
+            adaptivePreemption = ktSettings.GetBool("adaptivePreemption");
+            cooperativeYield = ktSettings.GetBool("cooperativeYield");
+            userfaultWriteTracking = ktSettings.GetBool("userfaultWriteTracking");
+            hugePageMemory = ktSettings.GetBool("hugePageMemory");
+            verifyIntegrity = ktSettings.GetBool("verifyIntegrity");
             forceTripleBuffering = ktSettings.GetBool("forceTripleBuffering");
             disableFrameThrottling = ktSettings.GetBool("disableFrameThrottling");
+            framePacing = ktSettings.GetBool("framePacing");
+            lowLatencyPresentation = ktSettings.GetBool("lowLatencyPresentation");
             gpuDriver = ktSettings.GetString("gpuDriver");
             gpuDriverLibraryName = ktSettings.GetString("gpuDriverLibraryName");
             executorSlotCountScale = ktSettings.GetInt<u32>("executorSlotCountScale");
+            asyncPipelineCompilation = ktSettings.GetBool("asyncPipelineCompilation");
+            shaderHashValidation = ktSettings.GetBool("shaderHashValidation");
+            gpuTextureDecoding = ktSettings.GetBool("gpuTextureDecoding");
+            gpuTextureDeswizzling = ktSettings.GetBool("gpuTextureDeswizzling");
+            textureMemoryBudget = ktSettings.GetInt<u32>("textureMemoryBudget");
+            asyncTextureReadback = ktSettings.GetBool("asyncTextureReadback");
+            resolutionScale = ktSettings.GetInt<u32>("resolutionScale");
+            presentUpscaling = ktSettings.GetBool("presentUpscaling");
+            parallelCommandRecording = ktSettings.GetBool("parallelCommandRecording");
             enableFastGpuReadbackHack = ktSettings.GetBool("enableFastGpuReadbackHack");
             isAudioOutputDisabled = ktSettings.GetBool("isAudioOutputDisabled");
+            adaptiveAudioLatency = ktSettings.GetBool("adaptiveAudioLatency");
             validationLayer = ktSettings.GetBool("validationLayer");
+            exportPipelineStatistics = ktSettings.GetBool("exportPipelineStatistics");
+            gpfifoCapture = ktSettings.GetBool("gpfifoCapture");
+            kernelBenchmark = ktSettings.GetBool("kernelBenchmark");
+
+            ApplyTitleProfile();
+            DispatchCallbacks();
         };
     };
 }
@@ -3,13 +3,17 @@
 
 #pragma once
 
+#include <array>
 #include <atomic>
+#include <memory>
 
 namespace skyline {
     /**
      * @brief A singly-linked list with atomic access to allow for lock-free access semantics
+     * @tparam InlineNodeCount The amount of nodes stored inline in the list, these are used by the first appended items to avoid heap allocations for short lists
+     * @note Inline nodes are not reused after being cleared, this is intended for lists which are only cleared once such as at the end of their owner's lifetime
      */
-    template<typename Type>
+    template<typename Type, size_t InlineNodeCount = 0>
     class AtomicForwardList {
       private:
         struct Node {
@@ -18,13 +22,40 @@ namespace skyline {
         };
 
         std::atomic<Node *> head{}; //!< The head of the list
+        std::atomic<size_t> inlineNodeUsage{}; //!< The amount of inline nodes that have been handed out, this may exceed InlineNodeCount
+        struct alignas(Node) InlineNode {
+            std::byte storage[sizeof(Node)];
+        };
+        std::array<InlineNode, InlineNodeCount> inlineNodes;
+
+        bool IsInlineNode(Node *node) {
+            if constexpr (InlineNodeCount == 0)
+                return false;
+            else
+                return reinterpret_cast<InlineNode *>(node) >= inlineNodes.begin() && reinterpret_cast<InlineNode *>(node) < inlineNodes.end();
+        }
+
+        /**
+         * @brief Allocates nodes for the supplied amount of items, any nodes past the end of the inline nodes are allocated on the heap
+         * @param nodes An output array which must fit at least count nodes, the nodes are constructed with a null next pointer
+         */
+        template<typename Iterator>
+        void AllocateNodes(Iterator items, size_t count, Node **nodes) {
+            size_t inlineIndex{InlineNodeCount != 0 ? inlineNodeUsage.fetch_add(count, std::memory_order_relaxed) : InlineNodeCount};
+            for (size_t i{}; i < count; i++, items++) {
+                if (inlineIndex + i < InlineNodeCount)
+                    nodes[i] = new (&inlineNodes[inlineIndex + i]) Node{nullptr, *items};
+                else
+                    nodes[i] = new Node{nullptr, *items};
+            }
+        }
 
       public:
         AtomicForwardList() = default;
 
         AtomicForwardList(const AtomicForwardList &) = delete;
 
-        AtomicForwardList(AtomicForwardList &&other) {
+        AtomicForwardList(AtomicForwardList &&other) requires (InlineNodeCount == 0) {
             head = other.head.load();
             while (!other.head.compare_exchange_strong(head, nullptr, std::memory_order_release, std::memory_order_consume));
         }
@@ -40,7 +71,10 @@ namespace skyline {
             auto current{head.exchange(nullptr, std::memory_order_acquire)};
             while (current) {
                 auto next{current->next};
-                delete current;
+                if (IsInlineNode(current))
+                    std::destroy_at(current);
+                else
+                    delete current;
                 current = next;
             }
         }
@@ -49,7 +83,8 @@ namespace skyline {
          * @brief Appends an item to the start of the list
          */
         void Append(Type item) {
-            auto node{new Node{nullptr, item}};
+            Node *node;
+            AllocateNodes(std::make_move_iterator(&item), 1, &node);
             auto next{head.load(std::memory_order_consume)};
             do {
                 node->next = next;
@@ -63,10 +98,22 @@ namespace skyline {
             if (std::empty(items))
                 return;
 
-            Node* firstNode{new Node{nullptr, *items.begin()}};
-            Node* lastNode{firstNode};
-            for (auto item{items.begin() + 1}; item != items.end(); item++)
-                lastNode = new Node{lastNode, *item};
+            constexpr size_t MaxBatchSize{16};
+            if (items.size() > MaxBatchSize) {
+                for (const auto &item : items)
+                    Append(item);
+                return;
+            }
+
+            std::array<Node *, MaxBatchSize> nodes;
+            AllocateNodes(items.begin(), items.size(), nodes.data());
+
+            Node *firstNode{nodes[0]};
+            Node *lastNode{firstNode};
+            for (size_t i{1}; i < items.size(); i++) {
+                nodes[i]->next = lastNode;
+                lastNode = nodes[i];
+            }
 
             auto next{head.load(std::memory_order_consume)};
             do {
@@ -0,0 +1,75 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2023 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#include <vfs/os_filesystem.h>
+#include "boot_profile.h"
+
+namespace skyline {
+    void BootProfile::Begin() {
+        std::scoped_lock lock{mutex};
+        startNs = util::GetTimeNs();
+        finished = false;
+        phases = {};
+    }
+
+    void BootProfile::Record(Phase phase, i64 phaseStartNs, i64 phaseEndNs) {
+        std::scoped_lock lock{mutex};
+        if (finished)
+            return;
+
+        auto &timing{phases[static_cast<u8>(phase)]};
+        if (timing.firstStartNs < 0)
+            timing.firstStartNs = phaseStartNs - startNs;
+        timing.durationNs += phaseEndNs - phaseStartNs;
+        timing.count++;
+    }
+
+    std::string BootProfile::SerializeJson() {
+        std::string json{"{\n  \"phases\": ["};
+        bool first{true};
+        for (size_t i{}; i < phases.size(); i++) {
+            const auto &timing{phases[i]};
+            if (!timing.count)
+                continue;
+
+            json += util::Format("{}\n    {{\"name\": \"{}\", \"startMs\": {:.3f}, \"durationMs\": {:.3f}, \"count\": {}}}", first ? "" : ",", PhaseNames[i],
+                                 static_cast<double>(timing.firstStartNs) / constant::NsInMillisecond, static_cast<double>(timing.durationNs) / constant::NsInMillisecond, timing.count);
+            first = false;
+        }
+        json += "\n  ]\n}\n";
+        return json;
+    }
+
+    void BootProfile::Finish(const std::string &publicAppFilesPath) {
+        std::string json;
+        {
+            std::scoped_lock lock{mutex};
+            if (finished || !startNs)
+                return;
+
+            i64 now{util::GetTimeNs()};
+            phases[static_cast<u8>(Phase::FirstFrame)] = {.firstStartNs = 0, .durationNs = now - startNs, .count = 1};
+            finished = true;
+
+            for (size_t i{}; i < phases.size(); i++)
+                if (phases[i].count)
+                    Logger::Info("Boot phase {}: {}ms", PhaseNames[i], phases[i].durationNs / constant::NsInMillisecond);
+
+            json = SerializeJson();
+        }
+        TRACE_EVENT_INSTANT("host", "BootComplete");
+
+        try {
+            vfs::OsFileSystem fileSystem{publicAppFilesPath + "logs/"};
+            std::string fileName{"boot_profile.json"};
+            if (!fileSystem.FileExists(fileName) && !fileSystem.CreateFile(fileName, 0))
+                throw exception("Failed to create the file");
+
+            auto backing{fileSystem.OpenFile(fileName, {true, true, false})};
+            backing->Resize(json.size());
+            backing->Write(span{json}.cast<u8>());
+        } catch (const std::exception &e) {
+            Logger::Warn("Failed to export the boot profile: {}", e.what());
+        }
+    }
+}
@@ -0,0 +1,90 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2023 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#pragma once
+
+#include <common/trace.h>
+#include <common.h>
+
+namespace skyline {
+    /**
+     * @brief Timings of the phases of booting a title till its first frame is presented, they're traced with Perfetto and exported as JSON once the boot is complete
+     * @note Phases may be entered multiple times or concurrently (NCE patch analysis runs for every executable on the decoding threads), their durations are summed
+     */
+    class BootProfile {
+      public:
+        enum class Phase : u8 {
+            KeyLoading, //!< Loading keys into crypto::KeyStore
+            ContainerParsing, //!< Parsing the ROM container (NSP/XCI/NCA) during the construction of the loader
+            NsoDecompression, //!< Decoding all NSOs of the ExeFS, this includes their patch analysis as it runs alongside decompression
+            NcePatchAnalysis, //!< Analyzing .text for NCE patching or loading the result from the patch cache
+            MemorySetup, //!< Setting up the heap and TLS of the process
+            VulkanInit, //!< Loading the Vulkan driver and creating the instance and device
+            FirstFrame, //!< The time from the start of the boot till the first frame is presented
+        };
+
+        static constexpr std::array<const char *, 7> PhaseNames{
+            "KeyLoading",
+            "ContainerParsing",
+            "NsoDecompression",
+            "NcePatchAnalysis",
+            "MemorySetup",
+            "VulkanInit",
+            "FirstFrame",
+        };
+
+      private:
+        struct PhaseTiming {
+            i64 firstStartNs{-1}; //!< The time the phase was first entered relative to the start of the boot, -1 if it was never entered
+            i64 durationNs{}; //!< The total time spent in the phase
+            u32 count{}; //!< The amount of times the phase was entered
+        };
+
+        std::mutex mutex;
+        i64 startNs{};
+        bool finished{}; //!< If the first frame has been presented, phases entered after this aren't a part of the boot
+        std::array<PhaseTiming, PhaseNames.size()> phases{};
+
+        std::string SerializeJson();
+
+      public:
+        /**
+         * @brief Resets all timings and starts the boot, this should be called as early as possible when launching a title
+         */
+        void Begin();
+
+        void Record(Phase phase, i64 phaseStartNs, i64 phaseEndNs);
+
+        /**
+         * @brief Records the first frame being presented and writes the profile into the logs directory as JSON, this is a no-op after the first call
+         */
+        void Finish(const std::string &publicAppFilesPath);
+    };
+
+    /**
+     * @return The boot profile of the emulator process
+     */
+    inline BootProfile &GetBootProfile() {
+        static BootProfile profile{};
+        return profile;
+    }
+
+    /**
+     * @brief Records the time spent in the scope as a phase of the boot profile and as a Perfetto slice
+     */
+    class ScopedBootPhase {
+      private:
+        BootProfile::Phase phase;
+        i64 startNs;
+
+      public:
+        ScopedBootPhase(BootProfile::Phase phase) : phase{phase}, startNs{util::GetTimeNs()} {
+            TRACE_EVENT_BEGIN("host", perfetto::StaticString{BootProfile::PhaseNames[static_cast<u8>(phase)]});
+        }
+
+        ~ScopedBootPhase() {
+            TRACE_EVENT_END("host");
+            GetBootProfile().Record(phase, startNs, util::GetTimeNs());
+        }
+    };
+}
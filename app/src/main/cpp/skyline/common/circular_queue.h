@@ -3,120 +3,232 @@
 
 #pragma once
 
+#include <linux/futex.h>
+#include <sys/syscall.h>
 #include <common/trace.h>
 #include <common.h>
 
 namespace skyline {
     /**
-     * @brief An efficient consumer-producer oriented queue with internal synchronization
+     * @brief An efficient, lock-free, bounded consumer-producer oriented queue supporting multiple producers and a single consumer
+     * @note Every slot carries a sequence number which tells producers and the consumer if it's free or populated, so neither side needs a lock
+     * @note Threads only block on a futex when the queue is empty (consumer) or full (producers) and the other side only issues a wake syscall if someone is waiting
      */
     template<typename Type>
     class CircularQueue {
       private:
-        std::vector<u8> vector; //!< The internal vector holding the circular queue's data, we use a byte vector due to the default item construction/destruction semantics not being appropriate for a circular buffer
-        Type *start{reinterpret_cast<Type *>(vector.begin().base())}; //!< The start/oldest element of the queue
-        Type *end{reinterpret_cast<Type *>(vector.begin().base())}; //!< The end/newest element of the queue
-        std::mutex consumptionMutex;
-        std::condition_variable consumeCondition;
-        std::mutex productionMutex;
-        std::condition_variable produceCondition;
+        static constexpr size_t CacheLineSize{0x40}; //!< The indices and signals of either side are kept on separate cache lines so they don't contend on the same line
+
+        struct Slot {
+            std::atomic<size_t> sequence; //!< The position this slot is free for when it's equal to it or one past the position after the item at the position has been written
+            alignas(Type) std::array<u8, sizeof(Type)> storage; //!< The storage for the item, items are constructed in-place when pushed and destroyed after being consumed
+
+            Type *Get() {
+                return std::launder(reinterpret_cast<Type *>(storage.data()));
+            }
+        };
+
+        size_t capacity;
+        std::unique_ptr<Slot[]> slots;
+
+        alignas(CacheLineSize) std::atomic<size_t> writeIndex{}; //!< The position of the next slot to be reserved by a producer
+        std::atomic<u32> writeSignal{}; //!< A futex word which is incremented after items are published while the consumer is waiting
+        std::atomic<u32> consumerWaiting{}; //!< If the consumer is waiting or about to wait on `writeSignal`
+
+        alignas(CacheLineSize) size_t readIndex{}; //!< The position of the next slot to be consumed, this is only accessed by the consumer
+        std::atomic<u32> readSignal{}; //!< A futex word which is incremented after slots are freed while any producers are waiting
+        std::atomic<u32> producersWaiting{}; //!< The amount of producers waiting or about to wait on `readSignal`
+
+        static void FutexWait(std::atomic<u32> &word, u32 expected) {
+            syscall(SYS_futex, reinterpret_cast<u32 *>(&word), FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0);
+        }
+
+        static void FutexWake(std::atomic<u32> &word) {
+            syscall(SYS_futex, reinterpret_cast<u32 *>(&word), FUTEX_WAKE_PRIVATE, std::numeric_limits<i32>::max(), nullptr, nullptr, 0);
+        }
+
+        Slot &GetSlot(size_t position) {
+            return slots[position % capacity];
+        }
 
-      public:
         /**
-         * @note The internal allocation is an item larger as we require a sentinel value
+         * @return If the item at the current read position has been published
          */
-        CircularQueue(size_t size) : vector((size + 1) * sizeof(Type)) {}
+        bool IsReadable() {
+            return GetSlot(readIndex).sequence.load(std::memory_order_acquire) == readIndex + 1;
+        }
 
-        CircularQueue(const CircularQueue &) = delete;
+        /**
+         * @brief Blocks the consumer till the item at the current read position has been published
+         * @param preWait A function that's called prior to blocking, this isn't called if an item is already available
+         */
+        template<typename F>
+        void WaitReadable(F preWait) {
+            if (IsReadable())
+                return;
 
-        CircularQueue &operator=(const CircularQueue &) = delete;
+            preWait();
+            while (true) {
+                u32 signal{writeSignal.load(std::memory_order_acquire)};
+                consumerWaiting.store(1, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_seq_cst); // Pairs with the fence in WakeConsumer so either the producer sees us waiting or we see its item
+                if (IsReadable())
+                    break;
+                FutexWait(writeSignal, signal);
+            }
+            consumerWaiting.store(0, std::memory_order_relaxed);
+        }
 
-        CircularQueue(CircularQueue &&other) : vector(std::move(other.vector)), consumptionMutex(std::move(other.consumptionMutex)), consumeCondition(std::move(other.consumeCondition)), productionMutex(std::move(other.productionMutex)), produceCondition(std::move(other.produceCondition)) {
-            start = other.start;
-            end = other.end;
-            other.start = other.end = nullptr;
+        /**
+         * @brief Destroys the item at the read position and frees its slot for the producers
+         */
+        void Release(Type &item) {
+            std::destroy_at(&item);
+            GetSlot(readIndex).sequence.store(readIndex + capacity, std::memory_order_release);
+            readIndex++;
         }
 
-        ~CircularQueue() {
-            while (start != end) {
-                auto next{start + 1};
-                next = (next == reinterpret_cast<Type *>(vector.end().base())) ? reinterpret_cast<Type *>(vector.begin().base()) : next;
-                std::destroy_at(next);
-                start = next;
+        /**
+         * @brief Wakes any producers waiting for slots to be freed, this should be called after releasing slots
+         */
+        void WakeProducers() {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (producersWaiting.load(std::memory_order_relaxed)) {
+                readSignal.fetch_add(1, std::memory_order_release);
+                FutexWake(readSignal);
+            }
+        }
+
+        /**
+         * @brief Reserves a contiguous range of slots, blocking while the queue doesn't have enough free slots
+         * @param count The amount of slots to reserve, this must not exceed the capacity of the queue
+         * @return The position of the first reserved slot
+         */
+        size_t Reserve(size_t count) {
+            size_t position{writeIndex.load(std::memory_order_relaxed)};
+            while (true) {
+                // The consumer frees slots in order so the last slot of the range being free implies that all prior ones are as well
+                size_t last{position + count - 1};
+                auto difference{static_cast<std::ptrdiff_t>(GetSlot(last).sequence.load(std::memory_order_acquire) - last)};
+                if (difference == 0) {
+                    if (writeIndex.compare_exchange_weak(position, position + count, std::memory_order_relaxed))
+                        return position;
+                } else if (difference < 0) {
+                    TRACE_EVENT("containers", "CircularQueue::WaitFull");
+                    u32 signal{readSignal.load(std::memory_order_acquire)};
+                    producersWaiting.fetch_add(1, std::memory_order_relaxed);
+                    std::atomic_thread_fence(std::memory_order_seq_cst); // Pairs with the fence in WakeProducers
+                    if (static_cast<std::ptrdiff_t>(GetSlot(last).sequence.load(std::memory_order_acquire) - last) < 0)
+                        FutexWait(readSignal, signal);
+                    producersWaiting.fetch_sub(1, std::memory_order_relaxed);
+                    position = writeIndex.load(std::memory_order_relaxed);
+                } else {
+                    position = writeIndex.load(std::memory_order_relaxed); // Another producer reserved the range first
+                }
+            }
+        }
+
+        /**
+         * @brief Constructs an item in a reserved slot and publishes it to the consumer
+         */
+        template<typename... Args>
+        void Emplace(size_t position, Args &&... args) {
+            auto &slot{GetSlot(position)};
+            std::construct_at(slot.Get(), std::forward<Args>(args)...);
+            slot.sequence.store(position + 1, std::memory_order_release);
+        }
+
+        /**
+         * @brief Wakes the consumer if it's waiting for items, this should be called after publishing items
+         */
+        void WakeConsumer() {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (consumerWaiting.load(std::memory_order_relaxed)) {
+                writeSignal.fetch_add(1, std::memory_order_release);
+                FutexWake(writeSignal);
             }
         }
 
+        /**
+         * @brief Appends all items from the range in order, the range is split into reservations of at most the capacity of the queue
+         * @note Items from a single reservation are never interleaved with items from other producers
+         */
+        template<typename Iterator, typename Transformation>
+        void AppendRange(Iterator iterator, size_t count, Transformation transformation) {
+            while (count) {
+                size_t batch{std::min(count, capacity)}, position{Reserve(batch)};
+                for (size_t index{}; index < batch; index++, iterator++)
+                    Emplace(position + index, transformation(*iterator));
+                WakeConsumer();
+                count -= batch;
+            }
+        }
+
+      public:
+        CircularQueue(size_t size) : capacity{std::max<size_t>(size, 1)}, slots{std::make_unique<Slot[]>(capacity)} {
+            for (size_t index{}; index < capacity; index++)
+                slots[index].sequence.store(index, std::memory_order_relaxed);
+        }
+
+        CircularQueue(const CircularQueue &) = delete;
+
+        CircularQueue &operator=(const CircularQueue &) = delete;
+
+        ~CircularQueue() {
+            while (IsReadable())
+                Release(*GetSlot(readIndex).Get());
+        }
+
         /**
          * @brief A blocking for-each that runs on every item and waits till new items to run on them as well
          * @param function A function that is called for each item (with the only parameter as a reference to that item)
          * @param preWait An optional function that's called prior to waiting on more items to be queued
+         * @note This must only be called by the consumer
          */
         template<typename F1, typename F2>
         [[noreturn]] void Process(F1 function, F2 preWait) {
-            TRACE_EVENT_BEGIN("containers", "CircularQueue::Process");
-
             while (true) {
-                if (start == end) {
-                    std::unique_lock lock{consumptionMutex};
+                WaitReadable(preWait);
 
-                    TRACE_EVENT_END("containers");
-                    preWait();
-                    produceCondition.wait(lock, [this]() { return start != end; });
-                    TRACE_EVENT_BEGIN("containers", "CircularQueue::Process");
+                TRACE_EVENT("containers", "CircularQueue::Process");
+                while (IsReadable()) {
+                    auto &item{*GetSlot(readIndex).Get()};
+                    function(item);
+                    Release(item);
                 }
-
-                while (start != end) {
-                    auto next{start + 1};
-                    next = (next == reinterpret_cast<Type *>(vector.end().base())) ? reinterpret_cast<Type *>(vector.begin().base()) : next;
-                    function(*next);
-                    start = next;
-                }
-
-                consumeCondition.notify_one();
+                WakeProducers();
             }
         }
 
-        Type Pop() {
-            std::unique_lock lock(productionMutex);
-            produceCondition.wait(lock, [this]() { return start != end; });
-
-            auto next{start + 1};
-            next = (next == reinterpret_cast<Type *>(vector.end().base())) ? reinterpret_cast<Type *>(vector.begin().base()) : next;
-            Type item{*next};
-            start = next;
+        /**
+         * @return If no items have been queued after the supplied item
+         * @note This must only be called with an item that is currently being processed
+         */
+        bool IsNewest(const Type &item) {
+            return writeIndex.load(std::memory_order_acquire) == readIndex + 1;
+        }
 
-            if (start == end)
-                consumeCondition.notify_one();
+        /**
+         * @brief Blocks till an item is available and removes it from the queue
+         * @note This must only be called by the consumer
+         */
+        Type Pop() {
+            WaitReadable([] {});
 
+            auto &slotItem{*GetSlot(readIndex).Get()};
+            Type item{std::move(slotItem)};
+            Release(slotItem);
+            WakeProducers();
             return item;
         }
 
         void Push(const Type &item) {
-            std::unique_lock lock(productionMutex);
-            auto next{end + 1};
-            next = (next == reinterpret_cast<Type *>(vector.end().base())) ? reinterpret_cast<Type *>(vector.begin().base()) : next;
-            if (next == start) {
-                std::unique_lock consumeLock(consumptionMutex);
-                consumeCondition.wait(consumeLock, [=]() { return next != start; });
-            }
-            *next = item;
-            end = next;
-            produceCondition.notify_one();
+            Emplace(Reserve(1), item);
+            WakeConsumer();
         }
 
         void Append(span <Type> buffer) {
-            std::unique_lock lock(productionMutex);
-            for (const auto &item : buffer) {
-                auto next{end + 1};
-                next = (next == reinterpret_cast<Type *>(vector.end().base())) ? reinterpret_cast<Type *>(vector.begin().base()) : next;
-                if (next == start) {
-                    std::unique_lock consumeLock(consumptionMutex);
-                    consumeCondition.wait(consumeLock, [=]() { return next != start; });
-                }
-                *next = item;
-                end = next++;
-            }
-            produceCondition.notify_one();
+            AppendRange(buffer.begin(), buffer.size(), [](const Type &item) -> const Type & { return item; });
         }
 
         /**
@@ -125,18 +237,7 @@ namespace skyline {
          */
         template<typename TransformedType, typename Transformation>
         void AppendTranform(TransformedType &container, Transformation transformation) {
-            std::unique_lock lock(productionMutex);
-            for (auto &item : container) {
-                auto next{end + 1};
-                next = (next == reinterpret_cast<Type *>(vector.end().base())) ? reinterpret_cast<Type *>(vector.begin().base()) : next;
-                if (next == start) {
-                    std::unique_lock consumeLock(consumptionMutex);
-                    consumeCondition.wait(consumeLock, [=]() { return next != start; });
-                }
-                *next = transformation(item);
-                end = next;
-            }
-            produceCondition.notify_one();
+            AppendRange(std::begin(container), std::size(container), transformation);
         }
     };
 }
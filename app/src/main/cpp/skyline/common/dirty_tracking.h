@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include <bit>
 #include "base.h"
 #include "exception.h"
 #include "logger.h"
@@ -60,10 +61,34 @@ namespace skyline::dirty {
         std::array<bool *, OverlapPoolSize> overlapPool{}; //!< Backing pool for `overlapSpanDirtyPtrs` in entry
         bool **freeOverlapPtr{}; //!< Pointer to the next free entry in `overlapPool`
         
-        std::array<BindingState, ManagedResourceSize / Granularity> states{}; //!< The dirty binding states for the entire managed resource
+        static constexpr size_t SubresourceCount{ManagedResourceSize / Granularity};
+        std::array<BindingState, SubresourceCount> states{}; //!< The dirty binding states for the entire managed resource
+
+        static constexpr size_t WordBits{64}; //!< The amount of bits in a single word of the bitsets
+        static constexpr size_t BoundWordCount{(SubresourceCount + WordBits - 1) / WordBits};
+        std::array<u64, BoundWordCount> boundBits{}; //!< A bitset of all subresources with any handles bound, this allows scanning ranges a word at a time rather than checking every state
+        std::array<u64, (BoundWordCount + WordBits - 1) / WordBits> boundSummaryBits{}; //!< A bitset of all words in `boundBits` which have any bits set, this allows skipping large unbound ranges entirely
 
         uintptr_t managedResourceBaseAddress; //!< The base address of the managed resource
 
+        /**
+         * @brief Marks every subresource with bound handles in the supplied bitset word as dirty
+         * @param mask A mask of the bits in the word that should be considered
+         */
+        void MarkWordDirty(size_t wordIndex, u64 mask) {
+            for (u64 bits{boundBits[wordIndex] & mask}; bits; bits &= bits - 1)
+                MarkStateDirty(states[(wordIndex * WordBits) + static_cast<size_t>(std::countr_zero(bits))]);
+        }
+
+        void MarkStateDirty(BindingState &state) {
+            if (state.type == BindingState::Type::Inline) [[likely]] {
+                *state.inlineDirtyPtr = true;
+            } else if (state.type == BindingState::Type::OverlapSpan) {
+                for (auto &dirtyPtr : state.GetOverlapSpan())
+                    *dirtyPtr = true;
+            }
+        }
+
       public:
         template<typename ManagedResourceType> requires (std::is_standard_layout_v<ManagedResourceType> && sizeof(ManagedResourceType) == ManagedResourceSize)
         Manager(ManagedResourceType &managedResource) : managedResourceBaseAddress{reinterpret_cast<uintptr_t>(&managedResource)}, freeOverlapPtr{overlapPool.data()} {}
@@ -93,7 +118,9 @@ namespace skyline::dirty {
 
             for (size_t i{subresourceIndex}; i < subresourceIndex + subresourceSize; i++) {
                 auto &state{states[i]};
-                
+                boundBits[i / WordBits] |= 1ULL << (i % WordBits);
+                boundSummaryBits[i / (WordBits * WordBits)] |= 1ULL << ((i / WordBits) % WordBits);
+
                 if (state.type == BindingState::Type::None) {
                     state.type = BindingState::Type::Inline;
                     state.inlineDirtyPtr = handle.dirtyPtr;
@@ -149,14 +176,43 @@ namespace skyline::dirty {
          * @note This *MUST NOT* be called after any bound handles have been destroyed
          */
         void MarkDirty(size_t index) {
-            auto &state{states[index]};
-            if (state.type == BindingState::Type::None) [[likely]] {
+            if (!(boundBits[index / WordBits] & (1ULL << (index % WordBits)))) [[likely]]
                 return;
-            } else if (state.type == BindingState::Type::Inline) {
-                *state.inlineDirtyPtr = true;
-            } else if (state.type == BindingState::Type::OverlapSpan) [[unlikely]] {
-                for (auto &dirtyPtr : state.GetOverlapSpan())
-                    *dirtyPtr = true;
+
+            MarkStateDirty(states[index]);
+        }
+
+        /**
+         * @brief Marks a range of the managed resource as dirty
+         * @param index The index of the first subresource in terms of the tracking granularity
+         * @param count The amount of consecutive subresources to mark as dirty
+         * @note Only subresources with bound handles are visited, these are found by scanning the bound bitsets a word at a time
+         */
+        void MarkDirty(size_t index, size_t count) {
+            if (!count)
+                return;
+
+            size_t end{index + count}, firstWord{index / WordBits}, lastWord{(end - 1) / WordBits};
+            auto wordMask{[&](size_t word) {
+                u64 mask{~0ULL};
+                if (word == firstWord)
+                    mask &= ~0ULL << (index % WordBits);
+                if (word == lastWord && end % WordBits)
+                    mask &= ~0ULL >> (WordBits - (end % WordBits));
+                return mask;
+            }};
+
+            for (size_t summaryIndex{firstWord / WordBits}; summaryIndex <= lastWord / WordBits; summaryIndex++) {
+                u64 summary{boundSummaryBits[summaryIndex]};
+                if (summaryIndex == firstWord / WordBits)
+                    summary &= ~0ULL << (firstWord % WordBits);
+                if (summaryIndex == lastWord / WordBits && (lastWord + 1) % WordBits)
+                    summary &= ~0ULL >> (WordBits - ((lastWord + 1) % WordBits));
+
+                for (; summary; summary &= summary - 1) {
+                    size_t word{(summaryIndex * WordBits) + static_cast<size_t>(std::countr_zero(summary))};
+                    MarkWordDirty(word, wordMask(word));
+                }
             }
         }
     };
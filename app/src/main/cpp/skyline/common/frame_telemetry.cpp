@@ -0,0 +1,72 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2023 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#include "trace.h"
+#include "performance_statistics.h"
+#include "frame_telemetry.h"
+
+namespace skyline {
+    void FrameTelemetry::RecordFrame(u64 frameId, i64 frameTimeNs, i64 averageFrameTimeNs, i64 presentLatencyNs) {
+        auto &statistics{GetPerformanceStatistics()};
+        u64 gpuBusyNs{statistics.gpuBusyNs.load(std::memory_order_relaxed)};
+        u64 pipelineCompileCount{statistics.pipelineCompileCount.load(std::memory_order_relaxed)};
+        u64 textureUploadBytes{statistics.textureUploadBytes.load(std::memory_order_relaxed)};
+        u64 bufferSyncBytes{statistics.bufferSyncBytes.load(std::memory_order_relaxed)};
+        u64 trapFaults{statistics.trapFaults.load(std::memory_order_relaxed)};
+
+        u64 index{ring.recordCount.load(std::memory_order_relaxed)};
+        auto &record{ring.records[index % FrameRecordRing::RecordCount]};
+        record.frameId.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release); // Readers must observe the cleared ID prior to any of the new values
+        record.presentTimeNs.store(static_cast<u64>(util::GetTimeNs()), std::memory_order_relaxed);
+        record.frameTimeNs.store(static_cast<u64>(frameTimeNs), std::memory_order_relaxed);
+        record.gpuBusyNs.store(gpuBusyNs - lastGpuBusyNs, std::memory_order_relaxed);
+        record.presentLatencyNs.store(static_cast<u64>(presentLatencyNs), std::memory_order_relaxed);
+        record.pipelineCompileCount.store(pipelineCompileCount - lastPipelineCompileCount, std::memory_order_relaxed);
+        record.textureUploadBytes.store(textureUploadBytes - lastTextureUploadBytes, std::memory_order_relaxed);
+        record.bufferSyncBytes.store(bufferSyncBytes - lastBufferSyncBytes, std::memory_order_relaxed);
+        record.trapFaults.store(trapFaults - lastTrapFaults, std::memory_order_relaxed);
+        record.frameId.store(frameId, std::memory_order_release);
+        ring.recordCount.store(index + 1, std::memory_order_release);
+
+        lastGpuBusyNs = gpuBusyNs;
+        lastPipelineCompileCount = pipelineCompileCount;
+        lastTextureUploadBytes = textureUploadBytes;
+        lastBufferSyncBytes = bufferSyncBytes;
+        lastTrapFaults = trapFaults;
+
+        if (pendingStutterRecord && index + 1 >= pendingStutterRecord + StutterPosteriorFrameCount) {
+            LogStutter(pendingStutterRecord - 1);
+            pendingStutterRecord = 0;
+        }
+
+        if (averageFrameTimeNs && frameTimeNs > StutterMinimumNs && frameTimeNs > averageFrameTimeNs * StutterFactor) {
+            ring.stutterCount.fetch_add(1, std::memory_order_relaxed);
+            TRACE_EVENT_INSTANT("gpu", "Stutter", "FrameId", frameId, "FrameTimeNs", frameTimeNs, "AverageFrameTimeNs", averageFrameTimeNs);
+
+            i64 now{util::GetTimeNs()};
+            if (!pendingStutterRecord && now - lastStutterLogNs >= StutterLogIntervalNs) {
+                pendingStutterRecord = index + 1;
+                lastStutterLogNs = now;
+            }
+        }
+    }
+
+    void FrameTelemetry::LogStutter(u64 stutterIndex) {
+        u64 recordCount{ring.recordCount.load(std::memory_order_relaxed)};
+        u64 firstIndex{std::max(stutterIndex > StutterPriorFrameCount ? stutterIndex - StutterPriorFrameCount : 0, recordCount > FrameRecordRing::RecordCount ? recordCount - FrameRecordRing::RecordCount : 0)};
+
+        auto toMs{[](const std::atomic<u64> &ns) { return static_cast<double>(ns.load(std::memory_order_relaxed)) / constant::NsInMillisecond; }};
+        auto toKib{[](const std::atomic<u64> &bytes) { return bytes.load(std::memory_order_relaxed) / 1024; }};
+        std::string frames;
+        for (u64 index{firstIndex}; index < recordCount; index++) {
+            const auto &record{ring.records[index % FrameRecordRing::RecordCount]};
+            frames += fmt::format("\n{} #{}: {:.1f}ms frame, {:.1f}ms GPU, {:.1f}ms latency, {} pipelines, {}KiB textures, {}KiB buffers, {} trap faults",
+                                  index == stutterIndex ? '>' : '*', record.frameId.load(std::memory_order_relaxed), toMs(record.frameTimeNs), toMs(record.gpuBusyNs), toMs(record.presentLatencyNs),
+                                  record.pipelineCompileCount.load(std::memory_order_relaxed), toKib(record.textureUploadBytes), toKib(record.bufferSyncBytes), record.trapFaults.load(std::memory_order_relaxed));
+        }
+
+        const auto &stutter{ring.records[stutterIndex % FrameRecordRing::RecordCount]};
+        Logger::Info("Stutter of {:.1f}ms in frame #{}:{}", toMs(stutter.frameTimeNs), stutter.frameId.load(std::memory_order_relaxed), frames);
+    }
+}
@@ -0,0 +1,75 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2023 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#pragma once
+
+#include <atomic>
+#include <common.h>
+
+namespace skyline {
+    /**
+     * @brief Performance data about a single presented frame, the costs are the amount accrued since the prior frame was presented
+     * @note Every member is a 64-bit integer so the frontend can read records at fixed offsets, `frameId` is cleared while the record is written so readers can detect torn reads by reading it prior to and after the other members
+     */
+    struct FrameRecord {
+        std::atomic<u64> frameId; //!< The ID of the presented frame, this is 0 while the record is being written
+        std::atomic<u64> presentTimeNs; //!< The time at which the frame was presented
+        std::atomic<u64> frameTimeNs; //!< The time between the presentation of the prior frame and this one
+        std::atomic<u64> gpuBusyNs; //!< The time the host GPU was busy executing work
+        std::atomic<u64> presentLatencyNs; //!< The time from the guest queueing the frame till it was presented
+        std::atomic<u64> pipelineCompileCount;
+        std::atomic<u64> textureUploadBytes;
+        std::atomic<u64> bufferSyncBytes;
+        std::atomic<u64> trapFaults;
+    };
+
+    /**
+     * @brief A ring of records of the most recently presented frames, this is shared with the frontend as a direct ByteBuffer like PerformanceStatistics
+     * @note The layout is mirrored by FrameTelemetry.kt, records are only written by the presentation thread so the ring is lock-free for writers and readers
+     */
+    struct FrameRecordRing {
+        static constexpr size_t RecordCount{256}; //!< The amount of frames retained in the ring
+
+        std::atomic<u64> recordCount; //!< The total amount of records written, the latest record is at `(recordCount - 1) % RecordCount`
+        std::atomic<u64> stutterCount; //!< The total amount of stutters detected
+        std::array<FrameRecord, RecordCount> records;
+    };
+
+    /**
+     * @brief Records every presented frame into a FrameRecordRing alongside detecting stutters
+     * @note When a frame takes considerably longer than the average, a window of records around it is logged once the frames after it have been presented so that the cause can be determined from field logs
+     */
+    class FrameTelemetry {
+      public:
+        static constexpr i64 StutterMinimumNs{constant::NsInSecond / 30}; //!< The minimum frame time for a frame to be considered a stutter
+        static constexpr i64 StutterFactor{3}; //!< The factor of the average frame time that a frame must exceed to be considered a stutter
+        static constexpr size_t StutterPriorFrameCount{24}; //!< The amount of frames prior to a stutter that are logged
+        static constexpr size_t StutterPosteriorFrameCount{8}; //!< The amount of frames after a stutter that are presented before the stutter is logged
+        static constexpr i64 StutterLogIntervalNs{constant::NsInSecond * 5}; //!< The minimum interval between logging stutters, stutters in between are only counted
+
+        FrameRecordRing ring;
+
+      private:
+        u64 lastGpuBusyNs{}, lastPipelineCompileCount{}, lastTextureUploadBytes{}, lastBufferSyncBytes{}, lastTrapFaults{}; //!< The cumulative performance counters when the prior frame was presented
+        u64 pendingStutterRecord{}; //!< The index (in `recordCount` terms) of the record of a stutter that's waiting on posterior frames to be logged, 0 if no stutter is pending
+        i64 lastStutterLogNs{}; //!< The time at which a stutter was last logged
+
+        void LogStutter(u64 stutterIndex);
+
+      public:
+        /**
+         * @brief Records a frame which was just presented, this must only be called from the presentation thread
+         * @param averageFrameTimeNs The average frame time prior to this frame, this is used to detect stutters
+         */
+        void RecordFrame(u64 frameId, i64 frameTimeNs, i64 averageFrameTimeNs, i64 presentLatencyNs);
+    };
+    static_assert(sizeof(FrameRecord) == sizeof(u64) * 9 && std::is_standard_layout_v<FrameRecordRing>, "The frontend reads records as plain 64-bit integers at fixed offsets");
+
+    /**
+     * @return The frame telemetry of the emulator process, this persists across titles as readers only look at the latest records
+     */
+    inline FrameTelemetry &GetFrameTelemetry() {
+        static FrameTelemetry telemetry{};
+        return telemetry;
+    }
+}
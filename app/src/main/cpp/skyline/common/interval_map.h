@@ -3,6 +3,8 @@
 
 #pragma once
 
+#include <bit>
+#include <list>
 #include "utils.h"
 #include "span.h"
 
@@ -45,7 +47,7 @@ namespace skyline {
 
             EntryGroup(Interval interval, EntryType value) : intervals(1, interval), value(std::move(value)) {}
 
-            EntryGroup(span<Interval> intervals, EntryType value) : intervals(intervals), value(std::move(value)) {}
+            EntryGroup(span<Interval> intervals, EntryType value) : intervals(intervals.begin(), intervals.end()), value(std::move(value)) {}
 
             template<typename T>
             EntryGroup(span<span<T>> lIntervals, EntryType value) : value(std::move(value)) {
@@ -85,10 +87,74 @@ namespace skyline {
             return false;
         }
 
-        std::vector<Entry> entries;
+        std::vector<Entry> entries; //!< All entries sorted by their start address
+        std::vector<AddressType> maxEnds; //!< An implicit binary tree over `entries` where every node holds the maximum end address of the entries below it, this allows skipping entire subtrees that end before a lookup
+        size_t leafCount{}; //!< The amount of leaves in `maxEnds`, this is `entries.size()` rounded up to a power of two
+
+        /**
+         * @brief Rebuilds the max-end tree after entries have been modified
+         * @note This is linear in the amount of entries, which is no worse than the vector insertions/erasures that precede it
+         */
+        void RebuildTree() {
+            leafCount = std::bit_ceil(std::max<size_t>(entries.size(), 1));
+            maxEnds.assign(leafCount * 2, AddressType{});
+            for (size_t index{}; index < entries.size(); index++)
+                maxEnds[leafCount + index] = entries[index].end;
+            for (size_t node{leafCount - 1}; node > 0; node--)
+                maxEnds[node] = std::max(maxEnds[node * 2], maxEnds[(node * 2) + 1]);
+        }
+
+        /**
+         * @brief Inserts entries for all the supplied intervals of a group with a single merge rather than an insertion per interval
+         * @note Entries with the same start address are ordered with the most recently inserted one first
+         */
+        template<typename Range, typename Transformation>
+        void InsertEntries(GroupHandle group, const Range &intervals, Transformation transformation) {
+            std::vector<Entry> inserted;
+            for (const auto &interval : intervals) {
+                Interval transformed{transformation(interval)};
+                inserted.emplace_back(transformed.start, transformed.end, group);
+            }
+
+            auto compareStart{[](const Entry &a, const Entry &b) { return a.start < b.start; }};
+            std::reverse(inserted.begin(), inserted.end());
+            std::stable_sort(inserted.begin(), inserted.end(), compareStart);
+
+            std::vector<Entry> merged;
+            merged.reserve(entries.size() + inserted.size());
+            std::merge(inserted.begin(), inserted.end(), entries.begin(), entries.end(), std::back_inserter(merged), compareStart);
+            entries = std::move(merged);
+            RebuildTree();
+        }
+
+        template<typename Function>
+        bool VisitOverlaps(size_t node, size_t nodeStart, size_t nodeSize, size_t entryCount, Interval interval, Function &function) {
+            if (nodeStart >= entryCount || maxEnds[node] <= interval.start)
+                return true;
+
+            if (nodeSize == 1)
+                return function(entries[nodeStart]);
+
+            size_t halfSize{nodeSize / 2};
+            return VisitOverlaps((node * 2) + 1, nodeStart + halfSize, halfSize, entryCount, interval, function) && VisitOverlaps(node * 2, nodeStart, halfSize, entryCount, interval, function);
+        }
+
+        /**
+         * @brief Calls the supplied function on all entries overlapping with the interval in descending order of their start address
+         * @param function A function taking an `Entry &` and returning if any further entries should be visited
+         * @note This is O(log n + k) in the amount of overlapping entries, subtrees with no entries ending after the start of the interval are skipped entirely
+         */
+        template<typename Function>
+        void ForEachOverlap(Interval interval, Function function) {
+            // Only entries starting before the end of the interval can overlap with it, these are all entries prior to the lower bound
+            auto entryCount{static_cast<size_t>(std::lower_bound(entries.begin(), entries.end(), interval.end) - entries.begin())};
+            VisitOverlaps(1, 0, leafCount, entryCount, interval, function);
+        }
 
       public:
-        IntervalMap() = default;
+        IntervalMap() {
+            RebuildTree();
+        }
 
         IntervalMap(const IntervalMap &) = delete;
 
@@ -100,44 +166,72 @@ namespace skyline {
 
         GroupHandle Insert(AddressType start, AddressType end, EntryType value) {
             GroupHandle group{groups.emplace(groups.begin(), Interval{start, end}, value)};
-            entries.emplace(std::lower_bound(entries.begin(), entries.end(), end), start, end, group);
+            InsertEntries(group, group->intervals, [](const Interval &interval) { return interval; });
             return group;
         }
 
         GroupHandle Insert(span<Interval> intervals, EntryType value) {
             GroupHandle group{groups.emplace(groups.begin(), intervals, value)};
-            for (const auto &interval : intervals)
-                entries.emplace(std::lower_bound(entries.begin(), entries.end(), interval.end), interval.start, interval.end, group);
+            InsertEntries(group, intervals, [](const Interval &interval) { return interval; });
             return group;
         }
 
         template<typename T>
         GroupHandle Insert(span<span<T>> intervals, EntryType value) requires std::is_pointer_v<AddressType> {
             GroupHandle group{groups.emplace(groups.begin(), intervals, std::move(value))};
-            for (const auto &interval : intervals)
-                entries.emplace(std::lower_bound(entries.begin(), entries.end(), interval.data()), interval.data(), interval.data() + interval.size(), group);
+            InsertEntries(group, intervals, [](const span<T> &interval) { return Interval{interval.data(), interval.data() + interval.size()}; });
             return group;
         }
 
         void Remove(GroupHandle group) {
-            for (auto it{entries.begin()}; it != entries.end();) {
-                if (it->group == group)
-                    it = entries.erase(it);
-                else
-                    it++;
-            }
+            std::erase(entries, group);
             groups.erase(group);
+            RebuildTree();
+        }
+
+        /**
+         * @brief Removes all the supplied groups with a single pass over the entries
+         */
+        void Remove(span<const GroupHandle> removedGroups) {
+            std::vector<const EntryGroup *> sortedGroups;
+            sortedGroups.reserve(removedGroups.size());
+            for (const auto &group : removedGroups)
+                sortedGroups.push_back(&*group);
+            std::sort(sortedGroups.begin(), sortedGroups.end());
+
+            std::erase_if(entries, [&](const Entry &entry) { return std::binary_search(sortedGroups.begin(), sortedGroups.end(), &*entry.group); });
+            for (const auto &group : removedGroups)
+                groups.erase(group);
+            RebuildTree();
         }
 
         /**
          * @return A nullable pointer to any entry overlapping with the given address
          */
         EntryType *Get(AddressType address) {
-            for (auto entryIt{std::lower_bound(entries.begin(), entries.end(), address)}; entryIt != entries.begin() && (--entryIt)->start <= address;)
-                if (entryIt->end > address)
-                    return &entryIt->group->value;
+            EntryType *result{};
+            ForEachOverlap(Interval{address, address + 1}, [&](Entry &entry) {
+                result = &entry.group->value;
+                return false;
+            });
+            return result;
+        }
 
-            return nullptr;
+        /**
+         * @return A nullable pointer to the entry overlapping with the aligned region around the given address if it's the only entry that overlaps with it
+         */
+        template<size_t Alignment>
+        EntryType *GetExclusive(AddressType address) {
+            GroupHandle group{groups.end()};
+            bool exclusive{true};
+            ForEachOverlap(Interval{address, address + 1}.Align(Alignment), [&](Entry &entry) {
+                if (group != groups.end() && group != entry.group)
+                    return exclusive = false;
+                group = entry.group;
+                return true;
+            });
+
+            return (exclusive && group != groups.end()) ? &group->value : nullptr;
         }
 
         /**
@@ -145,9 +239,11 @@ namespace skyline {
          */
         std::vector<std::reference_wrapper<EntryType>> GetRange(Interval interval) {
             std::vector<std::reference_wrapper<EntryType>> result;
-            for (auto entry{std::lower_bound(entries.begin(), entries.end(), interval.end)}; entry != entries.begin() && (--entry)->start < interval.end;)
-                if (entry->end > interval.start && !IsGroupInEntries(entry->group, result))
-                    result.emplace_back(entry->group->value);
+            ForEachOverlap(interval, [&](Entry &entry) {
+                if (!IsGroupInEntries(entry.group, result))
+                    result.emplace_back(entry.group->value);
+                return true;
+            });
 
             return result;
         }
@@ -163,65 +259,66 @@ namespace skyline {
 
             interval = interval.Align(Alignment);
 
-            auto entry{std::lower_bound(entries.begin(), entries.end(), interval.end)};
-            bool exclusiveEntry{entry == entries.begin() || std::prev(entry) == entries.begin() || std::prev(entry, 2)->start >= interval.end}; //!< If this entry exclusively occupies an aligned region
-            while (entry != entries.begin() && (--entry)->start < interval.end) {
-                if (entry->end > interval.start && !IsGroupInEntries(entry->group, queryEntries)) {
-                    // We found a unique and overlapping entry in the supplied interval
-                    queryEntries.emplace_back(entry->group->value);
-
-                    for (const auto &entryInterval : entry->group->intervals) {
-                        /* We need to find intervals that are covered by this entry and adding which will minimize future calls to this function, these are designed with memory faulting in mind. There's a few cases to consider:
-                         * 1. The entry exclusively occupies the lookup region - Entries are assumed to be rarely accessed in a partial manner, so we want to get add all intervals covered by the entry which includes all entries on those intervals and all exclusive intervals covered by those entries recursively
-                         * 2. The entry doesn't exclusively occupy the lookup region - We want to get all exclusive intervals covered by the entry where the entry is the only entry on those intervals, this is as we don't know what entry will be read in its entirety
-                         * 3. The entry doesn't exclusively occupy the lookup region, but the interval matches the entry's interval - This case is implicitly the same as (1) as we want to add all entries overlapping with the current interval
-                         */
-
-                        auto alignedEntryInterval{entryInterval.Align(Alignment)};
-
-                        if (exclusiveEntry || entryInterval == *entry) {
-                            // Case (1)/(3) - We want to add all entries overlapping with the current interval and their exclusive intervals recursively
-                            for (auto recursedEntry{std::lower_bound(entries.begin(), entries.end(), alignedEntryInterval.end)}; recursedEntry != entries.begin() && (--recursedEntry)->start < alignedEntryInterval.end;) {
-                                if (recursedEntry->end > alignedEntryInterval.start && recursedEntry->group != entry->group && !IsGroupInEntries(recursedEntry->group, queryEntries)) {
-                                    queryEntries.emplace_back(recursedEntry->group->value);
-
-                                    for (const auto &entryInterval2 : recursedEntry->group->intervals) {
-                                        // Similar to case (2) below but for the recursed entry
-                                        bool exclusiveIntervalEntry{true};
-                                        auto alignedEntryInterval2{entryInterval2.Align(Alignment)};
-
-                                        auto recursedEntry2{std::lower_bound(entries.begin(), entries.end(), alignedEntryInterval2.end)};
-                                        for (; recursedEntry2 != entries.begin() && (--recursedEntry2)->start < alignedEntryInterval2.end;) {
-                                            if (recursedEntry2->end > alignedEntryInterval2.start && recursedEntry2->group != recursedEntry->group && recursedEntry2->group != entry->group) {
-                                                exclusiveIntervalEntry = false;
-                                                break;
-                                            }
-                                        }
-
-                                        if (exclusiveIntervalEntry)
-                                            intervals.emplace(std::lower_bound(intervals.begin(), intervals.end(), alignedEntryInterval2.end), alignedEntryInterval2);
-                                    }
-                                }
-                            }
+            auto precedingEntries{std::lower_bound(entries.begin(), entries.end(), interval.end) - entries.begin()};
+            bool exclusiveEntry{precedingEntries < 2}; //!< If this entry exclusively occupies an aligned region
+            ForEachOverlap(interval, [&](Entry &entry) {
+                if (IsGroupInEntries(entry.group, queryEntries))
+                    return true;
 
-                            intervals.emplace(std::lower_bound(intervals.begin(), intervals.end(), alignedEntryInterval.start), alignedEntryInterval);
-                        } else {
-                            // Case (2) - We only want to add this interval if it only contains the entry
-                            bool exclusiveIntervalEntry{true};
-
-                            for (auto recursedEntry{std::lower_bound(entries.begin(), entries.end(), alignedEntryInterval.end)}; recursedEntry != entries.begin() && (--recursedEntry)->start < alignedEntryInterval.end;) {
-                                if (recursedEntry->end > alignedEntryInterval.start && recursedEntry->group != entry->group) {
-                                    exclusiveIntervalEntry = false;
-                                    break;
-                                }
+                // We found a unique and overlapping entry in the supplied interval
+                queryEntries.emplace_back(entry.group->value);
+
+                for (const auto &entryInterval : entry.group->intervals) {
+                    /* We need to find intervals that are covered by this entry and adding which will minimize future calls to this function, these are designed with memory faulting in mind. There's a few cases to consider:
+                     * 1. The entry exclusively occupies the lookup region - Entries are assumed to be rarely accessed in a partial manner, so we want to get add all intervals covered by the entry which includes all entries on those intervals and all exclusive intervals covered by those entries recursively
+                     * 2. The entry doesn't exclusively occupy the lookup region - We want to get all exclusive intervals covered by the entry where the entry is the only entry on those intervals, this is as we don't know what entry will be read in its entirety
+                     * 3. The entry doesn't exclusively occupy the lookup region, but the interval matches the entry's interval - This case is implicitly the same as (1) as we want to add all entries overlapping with the current interval
+                     */
+
+                    auto alignedEntryInterval{entryInterval.Align(Alignment)};
+
+                    if (exclusiveEntry || entryInterval == entry) {
+                        // Case (1)/(3) - We want to add all entries overlapping with the current interval and their exclusive intervals recursively
+                        ForEachOverlap(alignedEntryInterval, [&](Entry &recursedEntry) {
+                            if (recursedEntry.group == entry.group || IsGroupInEntries(recursedEntry.group, queryEntries))
+                                return true;
+
+                            queryEntries.emplace_back(recursedEntry.group->value);
+
+                            for (const auto &entryInterval2 : recursedEntry.group->intervals) {
+                                // Similar to case (2) below but for the recursed entry
+                                bool exclusiveIntervalEntry{true};
+                                auto alignedEntryInterval2{entryInterval2.Align(Alignment)};
+
+                                ForEachOverlap(alignedEntryInterval2, [&](Entry &recursedEntry2) {
+                                    if (recursedEntry2.group != recursedEntry.group && recursedEntry2.group != entry.group)
+                                        return exclusiveIntervalEntry = false;
+                                    return true;
+                                });
+
+                                if (exclusiveIntervalEntry)
+                                    intervals.emplace(std::lower_bound(intervals.begin(), intervals.end(), alignedEntryInterval2.end), alignedEntryInterval2);
                             }
+                            return true;
+                        });
+
+                        intervals.emplace(std::lower_bound(intervals.begin(), intervals.end(), alignedEntryInterval.start), alignedEntryInterval);
+                    } else {
+                        // Case (2) - We only want to add this interval if it only contains the entry
+                        bool exclusiveIntervalEntry{true};
+
+                        ForEachOverlap(alignedEntryInterval, [&](Entry &recursedEntry) {
+                            if (recursedEntry.group != entry.group)
+                                return exclusiveIntervalEntry = false;
+                            return true;
+                        });
 
-                            if (exclusiveIntervalEntry)
-                                intervals.emplace(std::lower_bound(intervals.begin(), intervals.end(), alignedEntryInterval.start), alignedEntryInterval);
-                        }
+                        if (exclusiveIntervalEntry)
+                            intervals.emplace(std::lower_bound(intervals.begin(), intervals.end(), alignedEntryInterval.start), alignedEntryInterval);
                     }
                 }
-            }
+                return true;
+            });
 
             // Coalescing pass for combining all intervals that are adjacent to each other
             for (auto it{intervals.begin()}; it != intervals.end();) {
@@ -0,0 +1,164 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2023 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <utility>
+#include "base.h"
+
+namespace skyline {
+    template<typename T>
+    class IntrusivePtr;
+
+    /**
+     * @brief A base class for objects which hold their own reference count, this avoids the separate control block (and its weak count) of std::shared_ptr
+     * @tparam Allocator The allocator the object was allocated with, it's used to free the object once the last reference to it has been released
+     * @note Objects deriving from this must be created with `AllocateIntrusive`
+     */
+    template<typename Derived, typename Allocator = std::allocator<Derived>>
+    class IntrusiveRefCounted {
+      private:
+        mutable std::atomic<u32> referenceCount{};
+
+        template<typename>
+        friend class IntrusivePtr;
+
+        template<typename T, typename Alloc, typename... Args>
+        friend IntrusivePtr<T> AllocateIntrusive(const Alloc &allocator, Args &&... args);
+
+        void Retain() const {
+            referenceCount.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        void Release() const {
+            // If we hold the only reference then no other thread can be retaining or releasing one concurrently, so the atomic read-modify-write can be skipped
+            if (referenceCount.load(std::memory_order_acquire) == 1 || referenceCount.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                auto object{const_cast<Derived *>(static_cast<const Derived *>(this))};
+                Allocator allocator{};
+                std::allocator_traits<Allocator>::destroy(allocator, object);
+                std::allocator_traits<Allocator>::deallocate(allocator, object, 1);
+            }
+        }
+
+      protected:
+        IntrusiveRefCounted() = default;
+
+        /**
+         * @note References belong to an object rather than its contents, so a copy starts out unreferenced
+         */
+        IntrusiveRefCounted(const IntrusiveRefCounted &) {}
+
+        IntrusiveRefCounted &operator=(const IntrusiveRefCounted &) {
+            return *this;
+        }
+    };
+
+    /**
+     * @brief An owning reference to an object deriving from IntrusiveRefCounted, this is a drop-in replacement for the subset of std::shared_ptr used by the codebase
+     * @note Functions that only use an object for the duration of a call should take a `const IntrusivePtr<T> &` or a raw pointer to borrow it rather than taking ownership, this avoids any reference count traffic
+     */
+    template<typename T>
+    class IntrusivePtr {
+      private:
+        T *object{};
+
+        struct AdoptTag {};
+
+        IntrusivePtr(T *object, AdoptTag) : object{object} {}
+
+        template<typename U, typename Alloc, typename... Args>
+        friend IntrusivePtr<U> AllocateIntrusive(const Alloc &allocator, Args &&... args);
+
+      public:
+        constexpr IntrusivePtr() = default;
+
+        constexpr IntrusivePtr(std::nullptr_t) {}
+
+        /**
+         * @brief Creates an additional reference to an object which is already owned by another IntrusivePtr
+         */
+        explicit IntrusivePtr(T *pObject) : object{pObject} {
+            if (object)
+                object->Retain();
+        }
+
+        IntrusivePtr(const IntrusivePtr &other) : object{other.object} {
+            if (object)
+                object->Retain();
+        }
+
+        IntrusivePtr(IntrusivePtr &&other) noexcept : object{std::exchange(other.object, nullptr)} {}
+
+        ~IntrusivePtr() {
+            if (object)
+                object->Release();
+        }
+
+        IntrusivePtr &operator=(const IntrusivePtr &other) {
+            if (other.object)
+                other.object->Retain();
+            if (object)
+                object->Release();
+            object = other.object;
+            return *this;
+        }
+
+        IntrusivePtr &operator=(IntrusivePtr &&other) noexcept {
+            if (this != &other) {
+                if (object)
+                    object->Release();
+                object = std::exchange(other.object, nullptr);
+            }
+            return *this;
+        }
+
+        void reset() {
+            if (auto released{std::exchange(object, nullptr)})
+                released->Release();
+        }
+
+        T *get() const {
+            return object;
+        }
+
+        T *operator->() const {
+            return object;
+        }
+
+        T &operator*() const {
+            return *object;
+        }
+
+        explicit operator bool() const {
+            return object != nullptr;
+        }
+
+        bool operator==(const IntrusivePtr &other) const {
+            return object == other.object;
+        }
+
+        bool operator==(std::nullptr_t) const {
+            return object == nullptr;
+        }
+    };
+
+    /**
+     * @brief Allocates and constructs an intrusively reference counted object, the initial reference is created without any atomic read-modify-write
+     */
+    template<typename T, typename Alloc, typename... Args>
+    IntrusivePtr<T> AllocateIntrusive(const Alloc &allocator, Args &&... args) {
+        using Traits = std::allocator_traits<Alloc>;
+        Alloc objectAllocator{allocator};
+        T *object{Traits::allocate(objectAllocator, 1)};
+        try {
+            Traits::construct(objectAllocator, object, std::forward<Args>(args)...);
+        } catch (...) {
+            Traits::deallocate(objectAllocator, object, 1);
+            throw;
+        }
+        object->referenceCount.store(1, std::memory_order_relaxed);
+        return IntrusivePtr<T>{object, typename IntrusivePtr<T>::AdoptTag{}};
+    }
+}
@@ -3,27 +3,118 @@
 
 #pragma once
 
+#include <sys/mman.h>
 #include <common.h>
+#include <common/memory_accounting.h>
 
 namespace skyline {
+    /**
+     * @brief A process-wide pool of fixed-size chunks which are recycled between all `LinearAllocatorState` instances with the same chunk size
+     * @note Chunks are carved out of 2MiB aligned slabs which are advised to be backed by transparent huge pages, this cuts down on TLB misses while walking over large node lists
+     */
+    template<size_t ChunkSize>
+    class LinearChunkPool {
+      private:
+        static constexpr size_t HugePageSize{2 * 1024 * 1024};
+        static constexpr size_t SlabSize{std::max(ChunkSize, HugePageSize)};
+        static_assert(SlabSize % ChunkSize == 0 && SlabSize % HugePageSize == 0, "Chunks must evenly divide or be a multiple of the huge page size");
+        static constexpr size_t MaxResidentFreeChunks{16}; //!< The maximum amount of free chunks that have their memory retained, the physical backing of any further freed chunks is released to the kernel
+
+        std::mutex mutex;
+        std::vector<u8 *> freeChunks; //!< A LIFO of free chunks, recently freed chunks are reused first as they're the most likely to be resident and cached
+        size_t residentFreeChunks{}; //!< The amount of chunks at the top of `freeChunks` which haven't had their backing released
+
+        LinearChunkPool() = default;
+
+        void AllocateSlab() {
+            // Over-allocate by a huge page to be able to align the slab and then unmap the excess on either side
+            auto mapping{reinterpret_cast<u8 *>(mmap(nullptr, SlabSize + HugePageSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0))};
+            if (mapping == MAP_FAILED)
+                throw exception("Failed to map linear allocator slab: {}", strerror(errno));
+
+            auto slab{reinterpret_cast<u8 *>(util::AlignUp(reinterpret_cast<uintptr_t>(mapping), HugePageSize))};
+            if (slab != mapping)
+                munmap(mapping, static_cast<size_t>(slab - mapping));
+            if (size_t tailSize{static_cast<size_t>((mapping + SlabSize + HugePageSize) - (slab + SlabSize))})
+                munmap(slab + SlabSize, tailSize);
+
+            madvise(slab, SlabSize, MADV_HUGEPAGE); // This is only a hint, the kernel may not have THP enabled in which case this is a no-op
+
+            for (size_t offset{SlabSize}; offset; offset -= ChunkSize)
+                freeChunks.push_back(slab + offset - ChunkSize);
+            residentFreeChunks += SlabSize / ChunkSize;
+        }
+
+      public:
+        /**
+         * @note The pool is intentionally leaked as allocators with static storage duration may return chunks to it during static destruction
+         */
+        static LinearChunkPool &Get() {
+            static auto *pool{new LinearChunkPool{}};
+            return *pool;
+        }
+
+        u8 *Acquire() {
+            std::scoped_lock lock{mutex};
+            if (freeChunks.empty())
+                AllocateSlab();
+
+            auto chunk{freeChunks.back()};
+            freeChunks.pop_back();
+            if (residentFreeChunks)
+                residentFreeChunks--;
+            GetMemoryAccounting().Allocate(MemoryCategory::LinearAllocator, ChunkSize);
+            return chunk;
+        }
+
+        void Release(u8 *chunk) {
+            std::scoped_lock lock{mutex};
+            GetMemoryAccounting().Free(MemoryCategory::LinearAllocator, ChunkSize);
+            freeChunks.push_back(chunk);
+            if (residentFreeChunks < MaxResidentFreeChunks) {
+                residentFreeChunks++;
+            } else {
+                // The oldest resident chunk gets decommitted rather than this one, so the top of the LIFO stays resident
+                auto &oldestResident{freeChunks[freeChunks.size() - 1 - residentFreeChunks]};
+                madvise(oldestResident, ChunkSize, MADV_DONTNEED);
+            }
+        }
+    };
+
     /**
      * @brief Typeless allocation state holder for LinearAllocator<T>
-     * @tparam NewChunkSize Step size in bytes for overflow chunk allocations
+     * @tparam NewChunkSize The size in bytes of the chunks that allocations are made from, these are shared with other allocators using `LinearChunkPool`
+     * @note Chunks retained from prior resets are reused in order so allocation remains a pointer bump, chunks beyond the peak usage of a recent window of resets are returned to the pool
      */
     template<size_t NewChunkSize = (1024 * 1024)> // Default to 1MB
     class LinearAllocatorState {
       private:
-        std::vector<u8> mainChunk; //!< The primary backing for the allocator, will grow during `Reset` calls if the previous set of allocations overflowed
-        std::list<std::vector<u8>> overflowChunks; //!< Overflow backing chunks used to hold allocations that can't fit in  `mainChunk` until it can be resized
+        static constexpr size_t ShrinkInterval{256}; //!< The amount of `Reset` calls after which any chunks exceeding the peak usage during them are returned to the pool
+
+        std::vector<u8 *> chunks; //!< All chunks owned by this allocator, chunks up to `chunkIndex` are in use by current allocations
+        size_t chunkIndex{}; //!< The index of the chunk `ptr` is in
         u8 *ptr{}; //!< Points to a free region of memory of size `chunkRemainingBytes`
         size_t chunkRemainingBytes{NewChunkSize}; //!< Remaining bytes left in the current chunk
 
         size_t allocCount{}; //!< The number of currently unfreed allocations
 
+        size_t peakChunkCount{}; //!< The highest amount of chunks used at once since the last shrink
+        size_t resetCount{}; //!< The amount of `Reset` calls since the last shrink
+
       public:
         LinearAllocatorState() {
-            mainChunk.reserve(NewChunkSize);
-            ptr = mainChunk.data();
+            chunks.push_back(LinearChunkPool<NewChunkSize>::Get().Acquire());
+            ptr = chunks.front();
+        }
+
+        LinearAllocatorState(const LinearAllocatorState &) = delete;
+
+        LinearAllocatorState &operator=(const LinearAllocatorState &) = delete;
+
+        ~LinearAllocatorState() {
+            auto &pool{LinearChunkPool<NewChunkSize>::Get()};
+            for (auto chunk : chunks)
+                pool.Release(chunk);
         }
 
         /**
@@ -37,11 +128,11 @@ namespace skyline {
             if (size > NewChunkSize)
                 throw std::bad_alloc();
 
-            if (chunkRemainingBytes < size) {
-                // If there is no space left in the current chunk allocate a new overflow one
-                auto &newChunk{overflowChunks.emplace_back()};
-                newChunk.reserve(NewChunkSize);
-                ptr = newChunk.data();
+            if (chunkRemainingBytes < size) [[unlikely]] {
+                // If there is no space left in the current chunk move onto the next retained one or acquire a new one from the pool
+                if (++chunkIndex == chunks.size())
+                    chunks.push_back(LinearChunkPool<NewChunkSize>::Get().Acquire());
+                ptr = chunks[chunkIndex];
                 chunkRemainingBytes = NewChunkSize;
             }
 
@@ -80,7 +171,7 @@ namespace skyline {
         }
 
         /**
-         * @brief Resizes the main chunk to fit any previously needed overflow chunks and allows memory to be reused again for further allocations
+         * @brief Allows memory to be reused again for further allocations, chunks that haven't been needed for a while are returned to the pool
          * @note There **must** be no allocations leftover when this is called
          */
         void Reset() {
@@ -88,14 +179,21 @@ namespace skyline {
                 // If we still have allocations remaining then throw
                 throw std::bad_alloc();
 
-            if (size_t overflowSize{overflowChunks.size() * NewChunkSize}) {
-                // Expand the main chunk so that it can fit any previously needed overflow chunks
-                overflowChunks.clear();
-                mainChunk.reserve(overflowSize + mainChunk.capacity());
+            peakChunkCount = std::max(peakChunkCount, chunkIndex + 1);
+            if (++resetCount == ShrinkInterval) {
+                // Only chunks that went unused for the entire interval are released, this avoids thrashing the pool on frames that periodically spike in usage
+                auto &pool{LinearChunkPool<NewChunkSize>::Get()};
+                while (chunks.size() > peakChunkCount) {
+                    pool.Release(chunks.back());
+                    chunks.pop_back();
+                }
+                peakChunkCount = 0;
+                resetCount = 0;
             }
 
-            ptr = mainChunk.data();
-            chunkRemainingBytes = mainChunk.capacity();
+            chunkIndex = 0;
+            ptr = chunks.front();
+            chunkRemainingBytes = NewChunkSize;
         }
     };
 
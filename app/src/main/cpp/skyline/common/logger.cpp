@@ -2,6 +2,7 @@
 // Copyright © 2021 Skyline Team and Contributors (https://github.com/skyline-emu/)
 
 #include <android/log.h>
+#include "spsc_ring.h"
 #include "utils.h"
 #include "logger.h"
 
@@ -12,17 +13,20 @@ namespace skyline {
     }
 
     void Logger::LoggerContext::Finalize() {
+        DrainDeferred();
         std::scoped_lock lock{mutex};
         logFile.close();
     }
 
     void Logger::LoggerContext::TryFlush() {
+        DrainDeferred(false);
         std::unique_lock lock(mutex, std::try_to_lock);
         if (lock)
             logFile.flush();
     }
 
     void Logger::LoggerContext::Flush() {
+        DrainDeferred();
         std::scoped_lock lock{mutex};
         logFile.flush();
     }
@@ -30,6 +34,44 @@ namespace skyline {
     thread_local static std::string logTag, threadName;
     thread_local static Logger::LoggerContext *context{&Logger::EmulationContext};
 
+    /**
+     * @brief The ring of deferred records logged by a single thread, this is shared with the writer so records can still be drained after the thread has exited
+     */
+    struct DeferredRing {
+        SpscRing<Logger::DeferredRecord, 0x100> records;
+    };
+
+    /**
+     * @brief The state shared between all logging threads and the writer thread
+     * @note This is intentionally leaked as the writer thread is detached and may still be draining during static destruction
+     */
+    struct DeferredState {
+        std::mutex ringMutex; //!< Synchronizes registration of rings with them being iterated over
+        std::vector<std::shared_ptr<DeferredRing>> rings; //!< The rings of all threads that have deferred any logs
+        std::mutex drainMutex; //!< The rings only support a single consumer, this ensures only one thread drains them at a time
+        std::array<Logger::DeferredRecord, 0x40> batch; //!< A buffer which records are read into from the rings
+        std::vector<Logger::DeferredRecord> drained; //!< All records drained from the rings which are yet to be written, this is reused to avoid allocations
+        std::once_flag writerFlag;
+    };
+
+    static DeferredState &GetDeferredState() {
+        static DeferredState *deferred{new DeferredState{}};
+        return *deferred;
+    }
+
+    thread_local static std::shared_ptr<DeferredRing> deferredRing;
+
+    static void DeferredWriterThread() {
+        constexpr auto WriterPeriod{std::chrono::milliseconds(10)}; //!< The interval at which the rings are drained, this bounds how late logs show up
+        if (int result{pthread_setname_np(pthread_self(), "Sky-Logger")})
+            Logger::Warn("Failed to set the thread name: {}", strerror(result));
+
+        while (true) {
+            std::this_thread::sleep_for(WriterPeriod);
+            Logger::DrainDeferred();
+        }
+    }
+
     void Logger::UpdateTag() {
         std::array<char, 16> name;
         if (!pthread_getname_np(pthread_self(), name.data(), name.size()))
@@ -47,21 +89,90 @@ namespace skyline {
         context = pContext;
     }
 
+    constexpr std::array<int, 5> LevelAlog{ANDROID_LOG_ERROR, ANDROID_LOG_WARN, ANDROID_LOG_INFO, ANDROID_LOG_DEBUG, ANDROID_LOG_VERBOSE}; //!< This corresponds to LogLevel and provides its equivalent for NDK Logging
+
     void Logger::WriteAndroid(LogLevel level, const std::string &str) {
-        constexpr std::array<int, 5> levelAlog{ANDROID_LOG_ERROR, ANDROID_LOG_WARN, ANDROID_LOG_INFO, ANDROID_LOG_DEBUG, ANDROID_LOG_VERBOSE}; // This corresponds to LogLevel and provides its equivalent for NDK Logging
         if (logTag.empty())
             UpdateTag();
 
-        __android_log_write(levelAlog[static_cast<u8>(level)], logTag.c_str(), str.c_str());
+        __android_log_write(LevelAlog[static_cast<u8>(level)], logTag.c_str(), str.c_str());
     }
 
-    void Logger::Write(LogLevel level, const std::string &str) {
+    /**
+     * @brief Writes out a formatted log to the supplied context's log file
+     * @param timestamp The time at which the log was written in nanoseconds
+     */
+    static void WriteLogFile(Logger::LoggerContext *context, Logger::LogLevel level, i64 timestamp, std::string_view name, const std::string &str) {
         constexpr std::array<char, 5> levelCharacter{'E', 'W', 'I', 'D', 'V'}; // The LogLevel as written out to a file
-        WriteAndroid(level, str);
-
         if (context)
             // We use RS (\036) and GS (\035) as our delimiters
-            context->Write(fmt::format("\036{}\035{}\035{}\035{}\n", levelCharacter[static_cast<u8>(level)], (util::GetTimeNs() / constant::NsInMillisecond) - context->start, threadName, str));
+            context->Write(fmt::format("\036{}\035{}\035{}\035{}\n", levelCharacter[static_cast<u8>(level)], (timestamp / constant::NsInMillisecond) - context->start, name, str));
+    }
+
+    void Logger::Write(LogLevel level, const std::string &str) {
+        DrainDeferred(); // Any records deferred prior to this need to be written first to retain the order of logs
+        WriteAndroid(level, str);
+        WriteLogFile(context, level, util::GetTimeNs(), threadName, str);
+    }
+
+    bool Logger::PushDeferred(DeferredRecord &record) {
+        if (!deferredRing) [[unlikely]] {
+            auto &deferred{GetDeferredState()};
+            std::scoped_lock lock{deferred.ringMutex};
+            deferredRing = deferred.rings.emplace_back(std::make_shared<DeferredRing>());
+            std::call_once(deferred.writerFlag, [] { std::thread{DeferredWriterThread}.detach(); });
+        }
+
+        if (threadName.empty())
+            UpdateTag();
+
+        record.timestamp = util::GetTimeNs();
+        record.context = context;
+        std::strncpy(record.threadName.data(), threadName.c_str(), record.threadName.size() - 1);
+        return deferredRing->records.Write(span<const DeferredRecord>{&record, 1}) != 0;
+    }
+
+    void Logger::DrainDeferred(bool blocking) {
+        auto &deferred{GetDeferredState()};
+        std::unique_lock drainLock{deferred.drainMutex, std::defer_lock};
+        if (blocking)
+            drainLock.lock();
+        else if (!drainLock.try_lock())
+            return;
+
+        {
+            std::scoped_lock ringLock{deferred.ringMutex};
+            for (auto &ring : deferred.rings) {
+                bool orphaned{ring.use_count() == 1}; // This must be checked prior to draining as the thread could push more records right before exiting
+                while (size_t count{ring->records.Read(span(deferred.batch))})
+                    deferred.drained.insert(deferred.drained.end(), deferred.batch.begin(), deferred.batch.begin() + count);
+                if (orphaned)
+                    ring.reset();
+            }
+            std::erase(deferred.rings, nullptr);
+        }
+
+        if (deferred.drained.empty())
+            return;
+
+        // Records from different threads are interleaved by their timestamps so the log reads in the order it was written in
+        std::stable_sort(deferred.drained.begin(), deferred.drained.end(), [](const DeferredRecord &a, const DeferredRecord &b) { return a.timestamp < b.timestamp; });
+
+        for (const auto &record : deferred.drained) {
+            std::string str;
+            try {
+                str = record.formatFunction(record.format, record.arguments.data());
+            } catch (const std::exception &e) {
+                str = std::string("Failed to format '") + record.format + "': " + e.what();
+            }
+            if (record.function)
+                str = std::string(record.function) + ": " + str;
+
+            std::string_view name{record.threadName.data()};
+            __android_log_write(LevelAlog[static_cast<u8>(record.level)], ("emu-cpp-" + std::string(name)).c_str(), str.c_str());
+            WriteLogFile(record.context, record.level, record.timestamp, name, str);
+        }
+        deferred.drained.clear();
     }
 
     void Logger::LoggerContext::Write(const std::string &str) {
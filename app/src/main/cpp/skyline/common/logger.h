@@ -5,11 +5,13 @@
 
 #include <fstream>
 #include <mutex>
+#include <tuple>
 #include "base.h"
 
 namespace skyline {
     /**
      * @brief A wrapper around writing logs into a log file and logcat using Android Log APIs
+     * @note Info, Debug and Verbose logs with only arithmetic or enum arguments are deferred: the arguments are copied into a lock-free per-thread ring and formatted by a background writer thread
      */
     class Logger {
       private:
@@ -78,6 +80,101 @@ namespace skyline {
             }
         };
 
+        /**
+         * @brief A log record with unformatted arguments, these are formatted on the writer thread
+         */
+        struct DeferredRecord {
+            static constexpr size_t MaxArgumentsSize{0x40}; //!< The maximum combined size of all arguments, logs with larger arguments are formatted immediately
+
+            using FormatFunction = std::string (*)(const char *format, const u8 *arguments);
+
+            FormatFunction formatFunction; //!< A function which unpacks the arguments and formats them with the format string
+            const char *format; //!< The format string, this must have static storage duration
+            const char *function; //!< The name of the function that the log originated from, this is nullptr for logs without a prefix
+            i64 timestamp; //!< The time at which the log was written in nanoseconds
+            LoggerContext *context; //!< The context of the logging thread
+            LogLevel level;
+            std::array<char, 16> threadName; //!< The name of the logging thread, this is copied as the thread may have exited by the time the record is written
+            std::array<u8, MaxArgumentsSize> arguments; //!< All arguments packed back-to-back without padding
+        };
+
+        /**
+         * @brief A wrapper around a string with static storage duration, this allows logs with such strings as arguments to be deferred
+         */
+        struct StaticString {
+            const char *string;
+        };
+
+        /**
+         * @brief If all arguments of a log can be copied and formatted later without referencing any memory the caller owns
+         * @note Strings and pointers to strings aren't deferrable as they would need to be copied or could dangle, strings with static storage duration can be wrapped in StaticString
+         */
+        template<typename... Args>
+        static constexpr bool IsDeferrable{((std::is_arithmetic_v<std::decay_t<decltype(util::FmtCast(std::declval<Args>()))>> || std::is_enum_v<std::decay_t<Args>> || std::is_same_v<std::decay_t<Args>, StaticString>) && ...) &&
+            (sizeof(std::decay_t<decltype(util::FmtCast(std::declval<Args>()))>) + ... + 0) <= DeferredRecord::MaxArgumentsSize};
+
+        /**
+         * @brief Unpacks arguments packed by WriteDeferred and formats them
+         */
+        template<typename... Args>
+        static std::string FormatDeferred(const char *format, const u8 *arguments) {
+            std::tuple<Args...> unpacked;
+            std::apply([&](auto &... args) {
+                ((std::memcpy(&args, arguments, sizeof(args)), arguments += sizeof(args)), ...);
+            }, unpacked);
+            return std::apply([&](auto &... args) {
+                return fmt::format(fmt::runtime(format), args...);
+            }, unpacked);
+        }
+
+        /**
+         * @brief Timestamps a record and pushes it into the calling thread's ring
+         * @return If the record could be pushed, this is false if the ring is full
+         */
+        static bool PushDeferred(DeferredRecord &record);
+
+        /**
+         * @brief Writes out all records pushed to the rings of every thread in the order they were logged in
+         * @param blocking If this should wait for another thread draining the rings rather than returning immediately
+         */
+        static void DrainDeferred(bool blocking = true);
+
+        /**
+         * @brief Logs the supplied format string and arguments, formatting being deferred to the writer thread when possible
+         * @param function The name of the function the log is prefixed with or nullptr for no prefix
+         * @param format A format string with static storage duration
+         */
+        template<typename... Args>
+        static void WriteDeferred(LogLevel level, const char *function, const char *format, Args &&... args) {
+            if constexpr (IsDeferrable<Args...>) {
+                DeferredRecord record{
+                    .formatFunction = &FormatDeferred<std::decay_t<decltype(util::FmtCast(args))>...>,
+                    .format = format,
+                    .function = function,
+                    .level = level,
+                };
+
+                [[maybe_unused]] u8 *arguments{record.arguments.data()};
+                ([&](auto arg) {
+                    std::memcpy(arguments, &arg, sizeof(arg));
+                    arguments += sizeof(arg);
+                }(util::FmtCast(args)), ...);
+
+                if (PushDeferred(record))
+                    return;
+            }
+
+            Write(level, function ? util::Format(std::string(function) + ": " + format, args...) : util::Format(format, args...));
+        }
+
+        template<typename S, typename... Args>
+        static void WriteNoPrefix(LogLevel level, S formatString, Args &&... args) {
+            if constexpr (std::is_same_v<S, const char *>)
+                WriteDeferred(level, nullptr, formatString, std::forward<Args>(args)...);
+            else
+                Write(level, util::Format(formatString, args...));
+        }
+
         template<typename... Args>
         static void Error(FunctionString<const char *> formatString, Args &&... args) {
             if (LogLevel::Error <= configLevel)
@@ -117,7 +214,7 @@ namespace skyline {
         template<typename... Args>
         static void Info(FunctionString<const char *> formatString, Args &&... args) {
             if (LogLevel::Info <= configLevel)
-                Write(LogLevel::Info, util::Format(*formatString, args...));
+                WriteDeferred(LogLevel::Info, formatString.function, formatString.string, std::forward<Args>(args)...);
         }
 
         template<typename... Args>
@@ -129,14 +226,14 @@ namespace skyline {
         template<typename S, typename... Args>
         static void InfoNoPrefix(S formatString, Args &&... args) {
             if (LogLevel::Info <= configLevel)
-                Write(LogLevel::Info, util::Format(formatString, args...));
+                WriteNoPrefix(LogLevel::Info, formatString, std::forward<Args>(args)...);
         }
 
         template<typename... Args>
         static void Debug(FunctionString<const char *> formatString, Args &&... args) {
             #ifndef NDEBUG
             if (LogLevel::Debug <= configLevel)
-                Write(LogLevel::Debug, util::Format(*formatString, args...));
+                WriteDeferred(LogLevel::Debug, formatString.function, formatString.string, std::forward<Args>(args)...);
             #endif
         }
 
@@ -152,7 +249,7 @@ namespace skyline {
         static void DebugNoPrefix(S formatString, Args &&... args) {
             #ifndef NDEBUG
             if (LogLevel::Debug <= configLevel)
-                Write(LogLevel::Debug, util::Format(formatString, args...));
+                WriteNoPrefix(LogLevel::Debug, formatString, std::forward<Args>(args)...);
             #endif
         }
 
@@ -160,7 +257,7 @@ namespace skyline {
         static void Verbose(FunctionString<const char *> formatString, Args &&... args) {
             #ifndef NDEBUG
             if (LogLevel::Verbose <= configLevel)
-                Write(LogLevel::Verbose, util::Format(*formatString, args...));
+                WriteDeferred(LogLevel::Verbose, formatString.function, formatString.string, std::forward<Args>(args)...);
             #endif
         }
 
@@ -176,8 +273,16 @@ namespace skyline {
         static void VerboseNoPrefix(S formatString, Args &&... args) {
             #ifndef NDEBUG
             if (LogLevel::Verbose <= configLevel)
-                Write(LogLevel::Verbose, util::Format(formatString, args...));
+                WriteNoPrefix(LogLevel::Verbose, formatString, std::forward<Args>(args)...);
             #endif
         }
     };
 }
+
+template<>
+struct fmt::formatter<skyline::Logger::StaticString> : formatter<std::string_view> {
+    template<typename FormatContext>
+    constexpr auto format(skyline::Logger::StaticString s, FormatContext &ctx) {
+        return formatter<std::string_view>::format(s.string, ctx);
+    }
+};
@@ -0,0 +1,20 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2023 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#include "memory_accounting.h"
+
+namespace skyline {
+    void MemoryAccounting::Log(std::string_view reason) const {
+        auto toMib{[](u64 bytes) { return static_cast<double>(bytes) / (1024 * 1024); }};
+
+        u64 totalLive{};
+        std::string breakdown;
+        for (size_t category{}; category < MemoryCategoryNames.size(); category++) {
+            u64 live{counters[category].live.load(std::memory_order_relaxed)};
+            totalLive += live;
+            breakdown += fmt::format("\n* {}: {:.1f}MiB live, {:.1f}MiB peak", MemoryCategoryNames[category], toMib(live), toMib(counters[category].peak.load(std::memory_order_relaxed)));
+        }
+
+        Logger::Info("Memory usage ({}): {:.1f}MiB in total{}", reason, toMib(totalLive), breakdown);
+    }
+}
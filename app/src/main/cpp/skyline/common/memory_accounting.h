@@ -0,0 +1,91 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2023 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#pragma once
+
+#include <atomic>
+#include <common.h>
+
+namespace skyline {
+    /**
+     * @brief The subsystems that memory is accounted to
+     */
+    enum class MemoryCategory : u8 {
+        StagingBuffer, //!< Host-visible buffers used to upload or download texture data, this includes free buffers retained by the staging pool
+        Buffer, //!< Host GPU backings of guest buffers and of conversions of them
+        Image, //!< Host GPU images backing guest textures
+        MegaBuffer, //!< The megabuffer ring and any buffers allocated for megabuffer allocations larger than it
+        ShaderModule, //!< SPIR-V of all shader modules created by the shader manager, the driver's compiled representation is likely to be of a similar size
+        LinearAllocator, //!< Chunks used by LinearAllocatorState arenas, this excludes free chunks retained by the pool
+        GuestMemory, //!< Heap, code and main thread stack memory mapped for the guest process, this is sampled when the accounting is logged rather than tracked
+    };
+
+    constexpr std::array<const char *, 7> MemoryCategoryNames{
+        "Staging Buffers",
+        "Buffers",
+        "Images",
+        "Megabuffers",
+        "Shader Modules",
+        "Linear Allocators",
+        "Guest Memory",
+    };
+
+    /**
+     * @brief The live and peak amounts of memory used by every subsystem, these are updated lock-free by the allocators of each subsystem
+     */
+    class MemoryAccounting {
+      private:
+        struct Counter {
+            std::atomic<u64> live; //!< The amount of bytes currently allocated
+            std::atomic<u64> peak; //!< The highest amount of bytes that were allocated at once
+        };
+
+        std::array<Counter, MemoryCategoryNames.size()> counters{};
+
+        static void UpdatePeak(Counter &counter, u64 live) {
+            u64 peak{counter.peak.load(std::memory_order_relaxed)};
+            while (live > peak && !counter.peak.compare_exchange_weak(peak, live, std::memory_order_relaxed));
+        }
+
+      public:
+        void Allocate(MemoryCategory category, u64 size) {
+            auto &counter{counters[static_cast<u8>(category)]};
+            UpdatePeak(counter, counter.live.fetch_add(size, std::memory_order_relaxed) + size);
+        }
+
+        void Free(MemoryCategory category, u64 size) {
+            counters[static_cast<u8>(category)].live.fetch_sub(size, std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Sets the live amount of memory for categories which are sampled rather than tracked
+         */
+        void Sample(MemoryCategory category, u64 size) {
+            auto &counter{counters[static_cast<u8>(category)]};
+            counter.live.store(size, std::memory_order_relaxed);
+            UpdatePeak(counter, size);
+        }
+
+        u64 GetLive(MemoryCategory category) const {
+            return counters[static_cast<u8>(category)].live.load(std::memory_order_relaxed);
+        }
+
+        u64 GetPeak(MemoryCategory category) const {
+            return counters[static_cast<u8>(category)].peak.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Logs the live and peak memory of every subsystem
+         * @param reason A description of why the accounting is being logged
+         */
+        void Log(std::string_view reason) const;
+    };
+
+    /**
+     * @return The memory accounting of the emulator process
+     */
+    inline MemoryAccounting &GetMemoryAccounting() {
+        static MemoryAccounting accounting{};
+        return accounting;
+    }
+}
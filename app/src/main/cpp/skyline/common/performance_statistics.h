@@ -0,0 +1,42 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2023 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#pragma once
+
+#include <atomic>
+#include <common.h>
+
+namespace skyline {
+    /**
+     * @brief Counters describing the performance of every subsystem, these are shared with the frontend as a direct ByteBuffer so it can read them without any JNI calls
+     * @note The layout is mirrored by PerformanceStatistics.kt, every member is a 64-bit integer so it can be read at a fixed offset in native byte order
+     * @note All counters other than the frame statistics are cumulative, readers derive rates from the difference between two reads
+     */
+    struct PerformanceStatistics {
+        static constexpr size_t GuestCoreCount{4}; //!< The amount of guest cores, this matches kernel::constant::CoreCount
+
+        std::atomic<u64> fps; //!< An approximation of the amount of frames being presented every second
+        std::atomic<u64> averageFrametimeNs; //!< The average time between presented frames
+        std::atomic<u64> averageFrametimeDeviationNs; //!< The average deviation of the frametime
+        std::atomic<u64> frameCount; //!< The amount of frames that have been presented
+        std::atomic<u64> gpuBusyNs; //!< The time the host GPU was executing submitted work, this is measured as the time spent waiting on fences which haven't been signalled yet
+        std::array<std::atomic<u64>, GuestCoreCount> guestCoreBusyNs; //!< The time guest threads were running on each guest core
+        std::atomic<u64> gpfifoBusyNs; //!< The time GPFIFO threads spent executing pushbuffers, this is summed across all channels
+        std::atomic<u64> commandRecordBusyNs; //!< The time the command record thread spent recording command buffers
+        std::atomic<u64> pipelineCompileCount; //!< The amount of graphics and compute pipelines which were compiled on a cache miss
+        std::atomic<u64> shaderCompileCount; //!< The amount of shader modules compiled from guest shaders
+        std::atomic<u64> textureUploadBytes; //!< The amount of bytes of guest texture data staged for upload to the host GPU
+        std::atomic<u64> audioUnderruns; //!< The amount of underruns reported by the audio output stream
+        std::atomic<u64> bufferSyncBytes; //!< The amount of bytes of buffer contents copied between guest memory and host buffers in either direction
+        std::atomic<u64> trapFaults; //!< The amount of faults on trapped guest memory handled by NCE
+    };
+    static_assert(std::atomic<u64>::is_always_lock_free && sizeof(std::atomic<u64>) == sizeof(u64), "The frontend reads the counters as plain 64-bit integers");
+
+    /**
+     * @return The statistics of the emulator process, these are never reset as readers only look at differences
+     */
+    inline PerformanceStatistics &GetPerformanceStatistics() {
+        static PerformanceStatistics statistics{};
+        return statistics;
+    }
+}
@@ -0,0 +1,170 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#pragma once
+
+#include <algorithm>
+#include <mutex>
+#include <new>
+#include <vector>
+#include <functional>
+#include <cstring>
+#include "exception.h"
+#include "thread_local.h"
+#include "spin_lock.h"
+
+namespace skyline {
+    /**
+     * @brief A thread-safe free list of fixed-size blocks, freed blocks are retained for reuse rather than being returned to the system allocator
+     * @note Every thread has its own cache of free blocks which are allocated from and freed into without any synchronization, blocks are moved between the caches and a global pool in batches
+     * @note The amount of memory retained is bounded by the peak amount of simultaneously live blocks
+     */
+    template<size_t BlockSize, size_t BlockAlignment>
+    class BlockPool {
+      private:
+        struct FreeBlock {
+            FreeBlock *next;
+        };
+
+        static_assert(BlockSize >= sizeof(FreeBlock) && BlockAlignment >= alignof(FreeBlock));
+
+        static constexpr size_t BatchSize{32}; //!< The amount of blocks moved between a thread cache and the global pool at once
+        static constexpr size_t MaxCachedBlocks{BatchSize * 2}; //!< The amount of blocks a thread can cache before a batch of them is returned to the global pool, this allows threads which only free blocks allocated by other threads to not hoard them
+
+        /**
+         * @brief A chain of free blocks terminated by a null block
+         */
+        struct Batch {
+            FreeBlock *head{};
+            size_t count{};
+        };
+
+        static inline SpinLock lock; //!< Synchronizes accesses to the global pool, this is only held for a handful of instructions
+
+        /**
+         * @return The global pool, a stack of batches returned by threads
+         * @note This is intentionally leaked as blocks may be freed during static destruction
+         */
+        static std::vector<Batch> &GetBatches() {
+            static auto *batches{new std::vector<Batch>{}};
+            return *batches;
+        }
+
+        static void PushBatch(Batch batch) {
+            std::scoped_lock guard{lock};
+            GetBatches().push_back(batch);
+        }
+
+        static Batch PopBatch() {
+            std::scoped_lock guard{lock};
+            auto &batches{GetBatches()};
+            if (batches.empty())
+                return {};
+
+            auto batch{batches.back()};
+            batches.pop_back();
+            return batch;
+        }
+
+        struct ThreadCache {
+            Batch freeBlocks;
+
+            /**
+             * @brief Returns all cached blocks to the global pool, so blocks freed on a thread aren't lost when it exits
+             */
+            ~ThreadCache() {
+                if (freeBlocks.count)
+                    PushBatch(freeBlocks);
+            }
+
+            /**
+             * @brief Splits off the most recently freed blocks into a batch and returns it to the global pool, the older blocks are kept as they're less likely to be in the cache of other cores
+             */
+            void Trim() {
+                Batch batch{freeBlocks.head, BatchSize};
+                auto tail{freeBlocks.head};
+                for (size_t index{1}; index < BatchSize; index++)
+                    tail = tail->next;
+
+                freeBlocks.head = tail->next;
+                freeBlocks.count -= BatchSize;
+                tail->next = nullptr;
+                PushBatch(batch);
+            }
+        };
+
+        /**
+         * @note This is leaked for the same reason as the global pool
+         */
+        static ThreadCache &GetThreadCache() {
+            static auto *caches{new ThreadLocal<ThreadCache>{}};
+            return **caches;
+        }
+
+      public:
+        static void *Allocate() {
+            auto &cache{GetThreadCache()};
+            if (!cache.freeBlocks.head) [[unlikely]]
+                cache.freeBlocks = PopBatch();
+
+            if (auto block{cache.freeBlocks.head}) [[likely]] {
+                cache.freeBlocks.head = block->next;
+                cache.freeBlocks.count--;
+                return block;
+            }
+
+            return ::operator new(BlockSize, std::align_val_t{BlockAlignment});
+        }
+
+        static void Free(void *pointer) noexcept {
+            auto &cache{GetThreadCache()};
+            auto block{static_cast<FreeBlock *>(pointer)};
+            block->next = cache.freeBlocks.head;
+            cache.freeBlocks.head = block;
+            if (++cache.freeBlocks.count > MaxCachedBlocks) [[unlikely]]
+                cache.Trim();
+        }
+    };
+
+    /**
+     * @brief An allocator conforming to the C++ 'Allocator' named requirement which services single-object allocations from a BlockPool, this is intended for std::allocate_shared of frequently recycled objects
+     * @note Array allocations are forwarded to the system allocator
+     */
+    template<typename T>
+    class PoolAllocator {
+      private:
+        static constexpr size_t BlockAlignment{std::max(alignof(T), alignof(void *))};
+        using Pool = BlockPool<std::max(sizeof(T), sizeof(void *)), BlockAlignment>;
+
+      public:
+        using value_type = T;
+
+        PoolAllocator() = default;
+
+        template<typename U>
+        PoolAllocator(const PoolAllocator<U> &) {}
+
+        [[nodiscard]] T *allocate(size_t n) {
+            if (n == 1) [[likely]]
+                return static_cast<T *>(Pool::Allocate());
+            return static_cast<T *>(::operator new(sizeof(T) * n, std::align_val_t{BlockAlignment}));
+        }
+
+        void deallocate(T *obj, size_t n) noexcept {
+            if (n == 1) [[likely]]
+                Pool::Free(obj);
+            else
+                ::operator delete(obj, std::align_val_t{BlockAlignment});
+        }
+
+        template<typename U>
+        bool operator==(const PoolAllocator<U> &) const noexcept {
+            return true;
+        }
+
+        template<typename U>
+        bool operator!=(const PoolAllocator<U> &) const noexcept {
+            return false;
+        }
+    };
+}
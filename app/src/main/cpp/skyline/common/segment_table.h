@@ -4,6 +4,8 @@
 #pragma once
 
 #include <sys/mman.h>
+#include <atomic>
+#include <utility>
 #include "span.h"
 
 namespace skyline {
@@ -30,7 +32,7 @@ namespace skyline {
             SegmentType segment; //!< The segment associated with the entry, this is 0'd out if the entry is unset
         };
 
-        static constexpr size_t L2Size{1 << L2Bits}, L2Entries{util::DivideCeil(Size, L2Size)}, L1inL2Count{L1Size / L2Size};
+        static constexpr size_t L2Size{1 << L2Bits}, L2Entries{util::DivideCeil(Size, L2Size)}, L1inL2Count{L2Size / L1Size};
         span<RangeEntry, L2Entries> level2Table; //!< The second level of the segment table, this is the lowest granularity of the table
 
         template<typename Type, size_t Amount>
@@ -167,4 +169,130 @@ namespace skyline {
             Set(reinterpret_cast<size_t>(span.begin().base()), reinterpret_cast<size_t>(span.end().base()));
         }
     };
+
+    /**
+     * @brief A variant of SegmentTable where all entries are atomic, this allows lock-free lookups concurrently with a writer
+     * @note Lookups observe each segment either before or after a concurrent `Set` on it, the table as a whole isn't updated atomically so different segments may be observed at different points during a `Set`
+     * @note Calls to `Set` must still be serialized with each other externally, only lookups are safe to do concurrently
+     */
+    template<typename SegmentType, size_t Size, size_t L1Bits, size_t L2Bits> requires (std::is_trivial_v<SegmentType> && std::atomic<SegmentType>::is_always_lock_free)
+    class ConcurrentSegmentTable {
+      private:
+        static constexpr size_t L1Size{1 << L1Bits}, L1Entries{util::DivideCeil(Size, L1Size)};
+        span<std::atomic<SegmentType>, L1Entries> level1Table; //!< The first level of the segment table, this is the highest granularity of the table and contains only the segment
+
+        /**
+         * @brief An entry in the L2 table, the segment is always written prior to the entry being marked valid so a lookup which observes it as valid will also observe the segment
+         * @note Segments are stored with release semantics and loaded with acquire semantics, so any writes made to a segment (such as constructing the object it points to) prior to it being set are visible to lookups
+         */
+        struct RangeEntry {
+            std::atomic<SegmentType> segment;
+            std::atomic<bool> valid; //!< If the associated segment is valid, an invalid entry implies going to the L1 table which must be fully populated prior to an entry being invalidated
+        };
+
+        static constexpr size_t L2Size{1 << L2Bits}, L2Entries{util::DivideCeil(Size, L2Size)}, L1inL2Count{L2Size / L1Size};
+        span<RangeEntry, L2Entries> level2Table; //!< The second level of the segment table, this is the lowest granularity of the table
+
+        template<typename Type, size_t Amount>
+        static span<Type, Amount> AllocateTable() {
+            // Zero-filled pages are a valid representation of the atomic types used here, so no construction is required
+            void *ptr{mmap(nullptr, Amount * sizeof(Type), PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE | MAP_NORESERVE, -1, 0)};
+            if (ptr == MAP_FAILED)
+                throw exception{"Failed to allocate 0x{:X} bytes of memory for segment table: {}", Amount * sizeof(Type), strerror(errno)};
+            return span<Type, Amount>(static_cast<Type *>(ptr), Amount);
+        }
+
+        void SetL1(size_t start, size_t end, SegmentType segment) {
+            for (size_t i{start}; i < end; i++)
+                level1Table[i].store(segment, std::memory_order_release);
+        }
+
+        /**
+         * @brief Splits a valid L2 entry into L1 entries and sets a subrange of the L1 entries to the supplied segment
+         * @param l2Index The index of the L2 entry to split
+         * @param start The index of the first L1 entry to set to the segment
+         * @param end The index of the L1 entry after the last one to set to the segment
+         */
+        void SplitL2(size_t l2Index, size_t start, size_t end, SegmentType segment) {
+            auto &l2Entry{level2Table[l2Index]};
+            if (l2Entry.valid.load(std::memory_order_relaxed)) {
+                auto l2Segment{l2Entry.segment.load(std::memory_order_relaxed)};
+                size_t l1L2Start{l2Index << (L2Bits - L1Bits)};
+                SetL1(l1L2Start, start, l2Segment);
+                SetL1(start, end, segment);
+                SetL1(end, l1L2Start + L1inL2Count, l2Segment);
+
+                // The L1 entries must be visible prior to the L2 entry being invalidated as lookups will go to them from then onwards
+                l2Entry.valid.store(false, std::memory_order_release);
+            } else {
+                SetL1(start, end, segment);
+            }
+        }
+
+      public:
+        ConcurrentSegmentTable() : level1Table{AllocateTable<std::atomic<SegmentType>, L1Entries>()}, level2Table{AllocateTable<RangeEntry, L2Entries>()} {}
+
+        ConcurrentSegmentTable(const ConcurrentSegmentTable &) = delete;
+
+        ConcurrentSegmentTable &operator=(const ConcurrentSegmentTable &) = delete;
+
+        ~ConcurrentSegmentTable() {
+            munmap(level1Table.data(), level1Table.size_bytes());
+            munmap(level2Table.data(), level2Table.size_bytes());
+        }
+
+        /**
+         * @return The segment at the given index, this'll return a 0'd out segment if the segment is unset
+         * @note This is safe to call concurrently with `Set`
+         */
+        SegmentType operator[](size_t index) const {
+            auto &l2Entry{level2Table[index >> L2Bits]};
+            if (l2Entry.valid.load(std::memory_order_acquire)) [[likely]]
+                return l2Entry.segment.load(std::memory_order_acquire);
+            else
+                return level1Table[index >> L1Bits].load(std::memory_order_acquire);
+        }
+
+        /**
+         * @brief Sets a segment of segments between the start and end to the supplied value
+         */
+        void Set(size_t start, size_t end, SegmentType segment) {
+            size_t l2AlignedAddress{util::AlignUp(start, L2Size)};
+
+            size_t l1StartPaddingStart{start >> L1Bits};
+            size_t l1StartPaddingEnd{l2AlignedAddress < end ? (l2AlignedAddress >> L1Bits) : (end >> L1Bits)};
+            if (l1StartPaddingStart != l1StartPaddingEnd)
+                SplitL2(start >> L2Bits, l1StartPaddingStart, l1StartPaddingEnd, segment);
+
+            if (end <= l2AlignedAddress)
+                return;
+
+            size_t l2IndexStart{l2AlignedAddress >> L2Bits};
+            size_t l2IndexEnd{end >> L2Bits};
+            for (size_t i{l2IndexStart}; i < l2IndexEnd; i++) {
+                auto &l2Entry{level2Table[i]};
+                l2Entry.segment.store(segment, std::memory_order_release);
+                l2Entry.valid.store(true, std::memory_order_release);
+            }
+
+            size_t l1EndPaddingStart{l2IndexEnd << (L2Bits - L1Bits)};
+            size_t l1EndPaddingEnd{end >> L1Bits};
+            if (l1EndPaddingStart != l1EndPaddingEnd)
+                SplitL2(l2IndexEnd, l1EndPaddingStart, l1EndPaddingEnd, segment);
+        }
+
+        /* Helpers for pointer-based access */
+
+        template<typename T>
+        requires std::is_pointer_v<T>
+        SegmentType operator[](T pointer) const {
+            return (*this)[reinterpret_cast<size_t>(pointer)];
+        }
+
+        template<typename T>
+        requires std::is_pointer_v<T>
+        void Set(T start, T end, SegmentType segment) {
+            Set(reinterpret_cast<size_t>(start), reinterpret_cast<size_t>(end), segment);
+        }
+    };
 }
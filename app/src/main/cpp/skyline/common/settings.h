@@ -6,45 +6,63 @@
 #include "language.h"
 
 namespace skyline {
+    struct TitleProfile;
+
     /**
      * @brief The Settings class provides a simple interface to access user-defined settings, update values and subscribe callbacks to observe changes.
      */
     class Settings {
+        /**
+         * @brief A type-erased interface to a setting which has changed and has callbacks that are yet to be called
+         */
+        class PendingSetting {
+          public:
+            virtual void DispatchCallbacks() = 0;
+        };
+
+        static inline thread_local std::vector<PendingSetting *> pendingSettings; //!< Settings changed on this thread which have callbacks pending, these are dispatched by `DispatchCallbacks`
+
+        /**
+         * @note Reads are wait-free, every value is an immutable allocation which is swapped in atomically so readers never observe a partially written value
+         */
         template<typename T>
-        class Setting {
+        class Setting : PendingSetting {
             using Callback = std::function<void(const T &)>;
+            std::vector<std::unique_ptr<const T>> versions; //!< Every value the setting has held, superseded values are retained as hot paths may still be holding references to them which is bounded by how often the user changes settings
+            std::atomic<const T *> value; //!< The current value of the setting, this always points to the last entry in `versions`
             std::vector<Callback> callbacks; //!< Callbacks to be called when this setting changes
-            T value;
-            std::mutex valueMutex;
-            std::mutex callbackMutex;
+            std::mutex mutex; //!< Synchronizes writers and callbacks, this is never locked by readers
+            bool pending{}; //!< If the value has changed since the callbacks were last called
 
-            /**
-             * @brief Calls all callbacks registered for this setting
-             * @note Locking of the setting value must be handled by the caller
-             */
-            void OnSettingChanged() {
-                std::scoped_lock lock{callbackMutex};
+            void DispatchCallbacks() override {
+                std::scoped_lock lock{mutex};
+                pending = false;
+                const T &current{*value.load(std::memory_order_relaxed)};
                 for (const auto &callback : callbacks)
-                    callback(value);
+                    callback(current);
             }
 
           public:
+            Setting() : value{versions.emplace_back(std::make_unique<const T>()).get()} {}
+
             /**
-             * @return The underlying setting value
+             * @return The underlying setting value, the returned reference remains valid for the lifetime of the setting
              */
-            const T &operator*() {
-                std::scoped_lock lock{valueMutex};
-                return value;
+            const T &operator*() const {
+                return *value.load(std::memory_order_acquire);
             }
 
             /**
-             * @brief Sets the underlying setting value, signalling any callbacks if necessary
+             * @brief Sets the underlying setting value, any callbacks are deferred till `Settings::DispatchCallbacks` is called on this thread
              */
             void operator=(T newValue) {
-                std::scoped_lock lock{valueMutex};
-                if (value != newValue) {
-                    value = std::move(newValue);
-                    OnSettingChanged();
+                std::scoped_lock lock{mutex};
+                if (*value.load(std::memory_order_relaxed) != newValue) {
+                    value.store(versions.emplace_back(std::make_unique<const T>(std::move(newValue))).get(), std::memory_order_release);
+                    if (!callbacks.empty() && !pending) {
+                        pending = true;
+                        pendingSettings.push_back(this);
+                    }
                 }
             }
 
@@ -52,35 +70,75 @@ namespace skyline {
              * @brief Register a callback to be run when this setting changes
              */
             void AddCallback(Callback callback) {
-                std::scoped_lock lock{callbackMutex};
+                std::scoped_lock lock{mutex};
                 callbacks.push_back(std::move(callback));
             }
         };
 
+        std::mutex titleProfileMutex;
+        std::shared_ptr<const TitleProfile> titleProfile; //!< The profile of the running title, this is retained so that it continues to override global settings when they're updated
+
+      protected:
+        /**
+         * @brief Calls the callbacks of all settings that were changed on this thread
+         * @note This should be called once all settings have been updated, so callbacks observe the complete set of new values rather than a partially updated one
+         */
+        static void DispatchCallbacks() {
+            auto settings{std::exchange(pendingSettings, {})};
+            for (auto setting : settings)
+                setting->DispatchCallbacks();
+        }
+
+        /**
+         * @brief Overrides settings with the ones in the title profile if there's one, this should be called by `Update` after reading all global settings and prior to dispatching callbacks
+         */
+        void ApplyTitleProfile();
+
       public:
         // System
         Setting<bool> isDocked; //!< If the emulated Switch should be handheld or docked
         Setting<std::string> usernameValue; //!< The user name to be supplied to the guest
         Setting<language::SystemLanguage> systemLanguage; //!< The system language
         Setting<region::RegionCode> systemRegion; //!< The system region
+        Setting<u32> preemptionTimeslice; //!< The duration in milliseconds that preemptive threads can run for before being yielded in favour of other threads with the same priority
+        Setting<bool> adaptivePreemption; //!< If the preemptive timeslice should be extended while there are no other threads to preempt in favour of and shortened when preemptive threads are starved
+        Setting<bool> cooperativeYield; //!< If guest code should be patched to poll for pending yields at loop back-edges rather than being interrupted by signals, this only takes effect when a title is launched
+        Setting<bool> userfaultWriteTracking; //!< If writes to trapped guest memory should be tracked with userfaultfd write-protection rather than mprotect when the kernel supports it, this only takes effect when a title is launched
+        Setting<bool> hugePageMemory; //!< If the code and heap regions of guest memory should be backed by transparent huge pages when the kernel allows it, this only takes effect when a title is launched
+        Setting<bool> verifyIntegrity; //!< If the hashes of the title's NCAs and executables should be verified on a background thread after it's launched, mismatches are logged without affecting execution
 
         // Display
         Setting<bool> forceTripleBuffering; //!< If the presentation engine should always triple buffer even if the swapchain supports double buffering
         Setting<bool> disableFrameThrottling; //!< Allow the guest to submit frames without any blocking calls
+        Setting<bool> framePacing; //!< If frames should be scheduled to be presented at predicted display refreshes with a constant amount of refreshes between them
+        Setting<bool> lowLatencyPresentation; //!< If presentation should minimize latency by using a non-blocking present mode and dropping frames which have been superseded prior to being presented
 
         // GPU
         Setting<std::string> gpuDriver; //!< The label of the GPU driver to use
         Setting<std::string> gpuDriverLibraryName; //!< The name of the GPU driver library to use
         Setting<u32> executorSlotCountScale; //!< Number of GPU executor slots that can be used concurrently
+        Setting<bool> asyncPipelineCompilation; //!< If pipelines should be compiled asynchronously, draws using a pipeline are skipped until it has been compiled
+        Setting<bool> shaderHashValidation; //!< If modifications to guest shaders should be detected by hashing their memory when they're bound rather than by trapping writes to it
+        Setting<bool> gpuTextureDecoding; //!< If compressed textures which are unsupported by the host GPU should be decoded with a compute shader rather than on the CPU
+        Setting<u32> textureMemoryBudget; //!< The maximum combined size of all guest textures in MiB prior to the least recently used ones being evicted, 0 disables the budget
+        Setting<bool> gpuTextureDeswizzling; //!< If block-linear textures copied through a staging buffer should be deswizzled and swizzled with a compute shader rather than on the CPU
+        Setting<u32> resolutionScale; //!< The percentage that render targets are scaled by relative to their guest dimensions, 100 renders at the native resolution
+        Setting<bool> presentUpscaling; //!< If frames rendered below the native resolution should be upscaled to it with an edge-adaptive spatial filter at presentation rather than by the display compositor
+        Setting<bool> asyncTextureReadback; //!< If textures which are frequently read by the guest should be read back asynchronously at the end of every execution using them, rather than when the guest accesses them
+        Setting<bool> parallelCommandRecording; //!< If large render passes should be split into chunks which are recorded into secondary command buffers on multiple threads
 
         // Hacks
         Setting<bool> enableFastGpuReadbackHack; //!< If the CPU texture readback skipping hack should be used
 
         // Audio
         Setting<bool> isAudioOutputDisabled; //!< Disables audio output
+        Setting<bool> adaptiveAudioLatency; //!< If the size of the audio output buffer should start at a single burst and be adapted to underruns, rather than being left at the device default
 
         // Debug
         Setting<bool> validationLayer; //!< If the vulkan validation layer is enabled
+        Setting<bool> exportPipelineStatistics; //!< If statistics about all pipelines used by the title should be exported as JSON into its cache directory on exit
+        Setting<bool> gpfifoCapture; //!< If all GPU AS mappings and GPFIFO submissions should be captured to files for deterministic replay, this only takes effect for address spaces created after it's enabled
+        Setting<bool> kernelBenchmark; //!< If a synthetic guest measuring SVC and IPC round-trip times should be run instead of the launched title
 
         Settings() = default;
 
@@ -91,5 +149,10 @@ namespace skyline {
          * @note This method is platform-specific and must be overridden
          */
         virtual void Update() = 0;
+
+        /**
+         * @brief Sets the profile of the running title and updates all settings to apply it, nullptr removes any prior profile
+         */
+        void SetTitleProfile(std::shared_ptr<const TitleProfile> profile);
     };
 }
@@ -1,28 +1,61 @@
 // SPDX-License-Identifier: MPL-2.0
 // Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
 
-#include <chrono>
-#include <thread>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include "trace.h"
 #include "spin_lock.h"
 
 namespace skyline {
-    static constexpr size_t LockAttemptsPerYield{256};
-    static constexpr size_t LockAttemptsPerSleep{1024};
-    static constexpr size_t SleepDurationUs{1000};
-
-    void  __attribute__ ((noinline)) SpinLock::LockSlow() {
-        // We need to start with attempt = 1, otherwise
-        // attempt % LockAttemptsPerSleep is zero for the first iteration.
-        size_t attempt{1};
-        while (true) {
-            if (!locked.test_and_set(std::memory_order_acquire))
+    static constexpr size_t SpinIterations{128}; //!< The amount of times the lock is polled before parking, this covers the short critical sections the lock is intended for
+
+    static std::atomic<u64> contendedLocks; //!< The amount of lock acquisitions which had to take the slow path
+    static std::atomic<u64> parkedLocks; //!< The amount of lock acquisitions which had to park the thread on the futex
+
+    /**
+     * @brief Waits for a short while for the supplied word to potentially change from the expected value
+     * @note On AArch64, the word is loaded exclusively to arm the monitor prior to a WFE, any store to it by the lock holder will generate an event which wakes us up immediately
+     */
+    static inline void SpinWait(const std::atomic<u32> &word, u32 expected) {
+        #ifdef __aarch64__
+        u32 value;
+        asm volatile("LDXR %w0, [%1]" : "=&r"(value) : "r"(&word) : "memory");
+        if (value == expected)
+            asm volatile("WFE" ::: "memory");
+        else
+            asm volatile("CLREX" ::: "memory");
+        #elif defined(__x86_64__)
+        __builtin_ia32_pause();
+        #endif
+    }
+
+    void __attribute__ ((noinline)) SpinLock::LockSlow() {
+        TRACE_COUNTER("containers", "SpinLock Contended", contendedLocks.fetch_add(1, std::memory_order_relaxed) + 1);
+
+        for (size_t attempt{}; attempt < SpinIterations; attempt++) {
+            // Only attempt to take the lock when it's observed to be free, this avoids bouncing the cache line between spinning cores
+            State current{state.load(std::memory_order_relaxed)};
+            if (current == State::Unlocked && state.compare_exchange_weak(current, State::Locked, std::memory_order_acquire, std::memory_order_relaxed))
                 return;
+            else if (current == State::Contended)
+                break; // Other threads are already parked, spinning would only steal the lock from them
 
-            if (attempt % LockAttemptsPerSleep == 0)
-                std::this_thread::sleep_for(std::chrono::microseconds(100));
-            else if (attempt % LockAttemptsPerYield == 0)
-                std::this_thread::yield();
+            SpinWait(reinterpret_cast<const std::atomic<u32> &>(state), static_cast<u32>(current));
         }
+
+        // We can't know if other threads are parked after we acquire the lock from here on, so it's always marked as contended to ensure they're woken on unlock
+        if (state.exchange(State::Contended, std::memory_order_acquire) == State::Unlocked)
+            return;
+
+        TRACE_EVENT("containers", "SpinLock::Park");
+        TRACE_COUNTER("containers", "SpinLock Parked", parkedLocks.fetch_add(1, std::memory_order_relaxed) + 1);
+        do {
+            syscall(SYS_futex, reinterpret_cast<u32 *>(&state), FUTEX_WAIT_PRIVATE, static_cast<u32>(State::Contended), nullptr, nullptr, 0);
+        } while (state.exchange(State::Contended, std::memory_order_acquire) != State::Unlocked);
     }
 
+    void __attribute__ ((noinline)) SpinLock::WakeWaiter() {
+        syscall(SYS_futex, reinterpret_cast<u32 *>(&state), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+    }
 }
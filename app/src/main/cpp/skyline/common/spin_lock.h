@@ -9,29 +9,41 @@
 
 namespace skyline {
     /**
-     * @brief A simple spin lock implementation with a yield and sleep fallback
+     * @brief An adaptive lock which spins for a short while when contended before parking the thread on a futex
+     * @note The uncontended paths are a single atomic operation, a syscall is only made on unlock when a thread is parked on the lock
      * @note This should *ONLY* be used in situations where it is provably better than an std::mutex due to spinlocks having worse perfomance under heavy contention
      */
     class SpinLock {
       private:
-        std::atomic_flag locked{};
+        enum class State : u32 {
+            Unlocked,
+            Locked, //!< The lock is held and no threads are parked on it
+            Contended, //!< The lock is held and threads might be parked on it, the holder must wake them on unlock
+        };
+
+        std::atomic<State> state{State::Unlocked};
 
         void LockSlow();
 
+        void WakeWaiter();
+
       public:
         void lock() {
-            if (!locked.test_and_set(std::memory_order_acquire)) [[likely]]
+            State expected{State::Unlocked};
+            if (state.compare_exchange_strong(expected, State::Locked, std::memory_order_acquire, std::memory_order_relaxed)) [[likely]]
                 return;
 
             LockSlow();
         }
 
         bool try_lock() {
-            return !locked.test_and_set(std::memory_order_acquire);
+            State expected{State::Unlocked};
+            return state.compare_exchange_strong(expected, State::Locked, std::memory_order_acquire, std::memory_order_relaxed);
         }
 
         void unlock() {
-            locked.clear(std::memory_order_release);
+            if (state.exchange(State::Unlocked, std::memory_order_release) == State::Contended) [[unlikely]]
+                WakeWaiter();
         }
     };
 
@@ -0,0 +1,75 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2023 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#pragma once
+
+#include <atomic>
+#include <common.h>
+
+namespace skyline {
+    /**
+     * @brief A lock-free ring buffer with a single producer and a single consumer, neither side can ever block the other
+     * @tparam Type The type of elements stored in the ring, this must be trivially copyable
+     * @tparam Size The capacity of the ring in elements
+     * @note Writes to a full ring are truncated rather than overwriting elements the consumer hasn't read yet
+     */
+    template<typename Type, size_t Size>
+    class SpscRing {
+      private:
+        static_assert(std::is_trivially_copyable_v<Type>);
+
+        static constexpr size_t CacheLineSize{0x40}; //!< The indices are kept on separate cache lines so both sides don't contend on the same line
+
+        std::array<Type, Size> array{};
+        alignas(CacheLineSize) std::atomic<size_t> readIndex{}; //!< The total amount of elements read, this is only written by the consumer
+        alignas(CacheLineSize) std::atomic<size_t> writeIndex{}; //!< The total amount of elements written, this is only written by the producer
+
+      public:
+        /**
+         * @brief Appends as many elements from the buffer as there's space for, this must only be called by the producer
+         * @return The amount of elements that were written
+         */
+        size_t Write(span<const Type> buffer) {
+            size_t write{writeIndex.load(std::memory_order_relaxed)};
+            size_t count{std::min(buffer.size(), Size - (write - readIndex.load(std::memory_order_acquire)))};
+            if (!count)
+                return 0;
+
+            size_t position{write % Size}, firstCount{std::min(count, Size - position)};
+            std::memcpy(array.data() + position, buffer.data(), firstCount * sizeof(Type));
+            std::memcpy(array.data(), buffer.data() + firstCount, (count - firstCount) * sizeof(Type));
+
+            writeIndex.store(write + count, std::memory_order_release);
+            return count;
+        }
+
+        /**
+         * @brief Removes elements from the ring and copies them into the buffer, this must only be called by the consumer
+         * @return The amount of elements that were read, this is less than the size of the buffer if the ring didn't contain enough
+         */
+        size_t Read(span<Type> buffer) {
+            size_t read{readIndex.load(std::memory_order_relaxed)};
+            size_t count{std::min(buffer.size(), writeIndex.load(std::memory_order_acquire) - read)};
+            if (!count)
+                return 0;
+
+            size_t position{read % Size}, firstCount{std::min(count, Size - position)};
+            std::memcpy(buffer.data(), array.data() + position, firstCount * sizeof(Type));
+            std::memcpy(buffer.data() + firstCount, array.data(), (count - firstCount) * sizeof(Type));
+
+            readIndex.store(read + count, std::memory_order_release);
+            return count;
+        }
+
+        /**
+         * @brief Removes up to the supplied amount of elements from the ring without reading them, this must only be called by the consumer
+         * @return The amount of elements that were removed
+         */
+        size_t Discard(size_t count) {
+            size_t read{readIndex.load(std::memory_order_relaxed)};
+            count = std::min(count, writeIndex.load(std::memory_order_acquire) - read);
+            readIndex.store(read + count, std::memory_order_release);
+            return count;
+        }
+    };
+}
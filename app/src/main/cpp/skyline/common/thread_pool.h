@@ -0,0 +1,151 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#pragma once
+
+#include <deque>
+#include <common.h>
+
+namespace skyline {
+    /**
+     * @brief A fixed-size pool of worker threads which run submitted tasks in FIFO order
+     * @note All pending tasks are run to completion prior to destruction, tasks may rely on this to safely reference objects that wait on them
+     */
+    class ThreadPool {
+      private:
+        std::vector<std::thread> threads;
+        std::mutex mutex; //!< Synchronizes accesses to the task queue and the stop flag
+        std::condition_variable condition; //!< Signalled when a task is submitted or the pool is being destroyed
+        std::deque<std::function<void()>> tasks;
+        bool stop{}; //!< If the workers should exit once the task queue is empty
+
+        void Worker(std::string name) {
+            if (int result{pthread_setname_np(pthread_self(), name.c_str())})
+                Logger::Warn("Failed to set the thread name: {}", strerror(result));
+
+            while (true) {
+                std::function<void()> task;
+                {
+                    std::unique_lock lock{mutex};
+                    condition.wait(lock, [this] { return stop || !tasks.empty(); });
+                    if (tasks.empty())
+                        return;
+
+                    task = std::move(tasks.front());
+                    tasks.pop_front();
+                }
+
+                try {
+                    task();
+                } catch (const std::exception &e) {
+                    Logger::Error("Exception in {}: {}", name, e.what());
+                }
+            }
+        }
+
+      public:
+        /**
+         * @param threadCount The amount of worker threads, this is clamped to a minimum of one
+         * @param name The name of the pool, worker threads will be named 'Sky-<name>-<index>' and as such this should be kept short
+         */
+        ThreadPool(size_t threadCount, std::string_view name) {
+            threadCount = std::max<size_t>(threadCount, 1);
+            threads.reserve(threadCount);
+            for (size_t i{}; i < threadCount; i++)
+                threads.emplace_back(&ThreadPool::Worker, this, util::Format("Sky-{}-{}", name, i));
+        }
+
+        ThreadPool(const ThreadPool &) = delete;
+
+        ThreadPool &operator=(const ThreadPool &) = delete;
+
+        ~ThreadPool() {
+            {
+                std::scoped_lock lock{mutex};
+                stop = true;
+            }
+            condition.notify_all();
+
+            for (auto &thread : threads)
+                thread.join();
+        }
+
+        /**
+         * @brief Queues a task to be run on one of the worker threads
+         * @note Any exceptions thrown by the task are logged and otherwise ignored
+         */
+        void Submit(std::function<void()> &&task) {
+            {
+                std::scoped_lock lock{mutex};
+                tasks.emplace_back(std::move(task));
+            }
+            condition.notify_one();
+        }
+
+        /**
+         * @brief Runs the supplied function for every index in [0, count) across the worker threads and the calling thread, returning once all invocations have completed
+         * @note The calling thread participates in running invocations so this cannot deadlock if all workers are busy, exceptions thrown by an invocation are rethrown on the calling thread after all invocations have completed
+         */
+        void ParallelFor(size_t count, const std::function<void(size_t)> &function) {
+            if (count <= 1) {
+                for (size_t index{}; index < count; index++)
+                    function(index);
+                return;
+            }
+
+            struct State {
+                const std::function<void(size_t)> *function;
+                size_t count;
+                std::atomic<size_t> nextIndex{};
+                std::atomic<size_t> completedCount{};
+                std::mutex mutex; //!< Synchronizes accesses to the exception and signalling of completion
+                std::condition_variable condition; //!< Signalled when all invocations have completed
+                std::exception_ptr exception; //!< The first exception thrown by any invocation
+
+                /**
+                 * @brief Runs invocations until none are remaining, the function is only dereferenced after an index is acquired which guarantees the caller is still waiting on it
+                 */
+                void Run() {
+                    for (size_t index{nextIndex++}; index < count; index = nextIndex++) {
+                        try {
+                            (*function)(index);
+                        } catch (...) {
+                            std::scoped_lock lock{mutex};
+                            if (!exception)
+                                exception = std::current_exception();
+                        }
+
+                        if (++completedCount == count) {
+                            std::scoped_lock lock{mutex};
+                            condition.notify_all();
+                        }
+                    }
+                }
+            };
+
+            // The state is shared with the helper tasks as they may only be dequeued after all invocations have already completed
+            auto state{std::make_shared<State>()};
+            state->function = &function;
+            state->count = count;
+
+            size_t helperCount{std::min(count - 1, threads.size())};
+            {
+                std::scoped_lock lock{mutex};
+                for (size_t i{}; i < helperCount; i++)
+                    tasks.emplace_back([state] { state->Run(); });
+            }
+            condition.notify_all();
+
+            state->Run();
+
+            std::unique_lock lock{state->mutex};
+            state->condition.wait(lock, [&] { return state->completedCount == count; });
+            if (state->exception)
+                std::rethrow_exception(state->exception);
+        }
+
+        size_t GetThreadCount() const {
+            return threads.size();
+        }
+    };
+}
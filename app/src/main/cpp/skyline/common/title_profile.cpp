@@ -0,0 +1,146 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2023 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#include <charconv>
+#include <variant>
+#include <vfs/os_filesystem.h>
+#include "settings.h"
+#include "title_profile.h"
+
+namespace skyline {
+    namespace {
+        using ProfileField = std::variant<std::optional<u32> TitleProfile::*, std::optional<bool> TitleProfile::*>;
+
+        constexpr std::array<std::pair<std::string_view, ProfileField>, 18> ProfileFields{{
+            {"preemptionTimeslice", &TitleProfile::preemptionTimeslice},
+            {"adaptivePreemption", &TitleProfile::adaptivePreemption},
+            {"forceTripleBuffering", &TitleProfile::forceTripleBuffering},
+            {"disableFrameThrottling", &TitleProfile::disableFrameThrottling},
+            {"framePacing", &TitleProfile::framePacing},
+            {"lowLatencyPresentation", &TitleProfile::lowLatencyPresentation},
+            {"executorSlotCountScale", &TitleProfile::executorSlotCountScale},
+            {"asyncPipelineCompilation", &TitleProfile::asyncPipelineCompilation},
+            {"shaderHashValidation", &TitleProfile::shaderHashValidation},
+            {"gpuTextureDecoding", &TitleProfile::gpuTextureDecoding},
+            {"textureMemoryBudget", &TitleProfile::textureMemoryBudget},
+            {"gpuTextureDeswizzling", &TitleProfile::gpuTextureDeswizzling},
+            {"resolutionScale", &TitleProfile::resolutionScale},
+            {"presentUpscaling", &TitleProfile::presentUpscaling},
+            {"asyncTextureReadback", &TitleProfile::asyncTextureReadback},
+            {"parallelCommandRecording", &TitleProfile::parallelCommandRecording},
+            {"enableFastGpuReadbackHack", &TitleProfile::enableFastGpuReadbackHack},
+            {"adaptiveAudioLatency", &TitleProfile::adaptiveAudioLatency},
+        }};
+
+        std::string_view Trim(std::string_view string) {
+            constexpr std::string_view Whitespace{" \t\r"};
+            auto start{string.find_first_not_of(Whitespace)};
+            if (start == std::string_view::npos)
+                return {};
+            return string.substr(start, string.find_last_not_of(Whitespace) - start + 1);
+        }
+
+        std::optional<bool> ParseValue(std::string_view value, std::optional<bool> *) {
+            if (value == "true" || value == "1")
+                return true;
+            else if (value == "false" || value == "0")
+                return false;
+            return std::nullopt;
+        }
+
+        std::optional<u32> ParseValue(std::string_view value, std::optional<u32> *) {
+            u32 result{};
+            auto [end, error]{std::from_chars(value.data(), value.data() + value.size(), result)};
+            if (error != std::errc{} || end != value.data() + value.size())
+                return std::nullopt;
+            return result;
+        }
+    }
+
+    std::shared_ptr<const TitleProfile> TitleProfile::Load(const std::string &publicAppFilesPath, u64 titleId) {
+        std::vector<char> content;
+        try {
+            vfs::OsFileSystem fileSystem{publicAppFilesPath + "profiles/"};
+            auto fileName{util::Format("{:016X}.conf", titleId)};
+            if (!fileSystem.FileExists(fileName))
+                return nullptr;
+
+            auto backing{fileSystem.OpenFile(fileName)};
+            content.resize(backing->size);
+            backing->Read(span{content}.cast<u8>());
+        } catch (const std::exception &e) {
+            Logger::Warn("Failed to read the profile for {:016X}: {}", titleId, e.what());
+            return nullptr;
+        }
+
+        auto profile{std::make_shared<TitleProfile>()};
+        profile->titleId = titleId;
+
+        std::string_view remaining{content.data(), content.size()};
+        while (!remaining.empty()) {
+            auto lineEnd{remaining.find('\n')};
+            auto line{Trim(remaining.substr(0, lineEnd))};
+            remaining = lineEnd == std::string_view::npos ? std::string_view{} : remaining.substr(lineEnd + 1);
+            if (line.empty() || line.starts_with('#'))
+                continue;
+
+            auto separator{line.find('=')};
+            auto key{Trim(line.substr(0, separator))};
+            auto field{std::find_if(ProfileFields.begin(), ProfileFields.end(), [key](const auto &entry) { return entry.first == key; })};
+            if (separator == std::string_view::npos || field == ProfileFields.end()) {
+                Logger::Warn("Skipping unknown profile line for {:016X}: '{}'", titleId, line);
+                continue;
+            }
+
+            auto value{Trim(line.substr(separator + 1))};
+            std::visit([&](auto member) {
+                auto &option{(*profile).*member};
+                option = ParseValue(value, &option);
+                if (!option)
+                    Logger::Warn("Skipping invalid profile value for {:016X}: '{}'", titleId, line);
+            }, field->second);
+        }
+
+        return profile;
+    }
+
+    void TitleProfile::Apply(Settings &settings) const {
+        auto apply{[](auto &setting, const auto &value) {
+            if (value)
+                setting = *value;
+        }};
+
+        apply(settings.preemptionTimeslice, preemptionTimeslice);
+        apply(settings.adaptivePreemption, adaptivePreemption);
+        apply(settings.forceTripleBuffering, forceTripleBuffering);
+        apply(settings.disableFrameThrottling, disableFrameThrottling);
+        apply(settings.framePacing, framePacing);
+        apply(settings.lowLatencyPresentation, lowLatencyPresentation);
+        apply(settings.executorSlotCountScale, executorSlotCountScale);
+        apply(settings.asyncPipelineCompilation, asyncPipelineCompilation);
+        apply(settings.shaderHashValidation, shaderHashValidation);
+        apply(settings.gpuTextureDecoding, gpuTextureDecoding);
+        apply(settings.textureMemoryBudget, textureMemoryBudget);
+        apply(settings.gpuTextureDeswizzling, gpuTextureDeswizzling);
+        apply(settings.resolutionScale, resolutionScale);
+        apply(settings.presentUpscaling, presentUpscaling);
+        apply(settings.asyncTextureReadback, asyncTextureReadback);
+        apply(settings.parallelCommandRecording, parallelCommandRecording);
+        apply(settings.enableFastGpuReadbackHack, enableFastGpuReadbackHack);
+        apply(settings.adaptiveAudioLatency, adaptiveAudioLatency);
+    }
+
+    void Settings::SetTitleProfile(std::shared_ptr<const TitleProfile> profile) {
+        {
+            std::scoped_lock lock{titleProfileMutex};
+            titleProfile = std::move(profile);
+        }
+        Update();
+    }
+
+    void Settings::ApplyTitleProfile() {
+        std::scoped_lock lock{titleProfileMutex};
+        if (titleProfile)
+            titleProfile->Apply(*this);
+    }
+}
@@ -0,0 +1,57 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2023 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#pragma once
+
+#include <common.h>
+
+namespace skyline {
+    class Settings;
+
+    /**
+     * @brief A bundle of performance settings tuned for a specific title, these override the global settings while the title is running
+     * @note Profiles are read from `profiles/{titleId:016X}.conf` in the public app files directory as `key=value` lines, where lines starting with '#' are ignored and keys are the names of the members below
+     * @note They're applied once the title ID is known after loading the process, settings which are only read prior to that (such as `cooperativeYield` or `hugePageMemory`) can't be a part of a profile
+     */
+    struct TitleProfile {
+        u64 titleId;
+
+        // System
+        std::optional<u32> preemptionTimeslice;
+        std::optional<bool> adaptivePreemption;
+
+        // Display
+        std::optional<bool> forceTripleBuffering;
+        std::optional<bool> disableFrameThrottling;
+        std::optional<bool> framePacing;
+        std::optional<bool> lowLatencyPresentation;
+
+        // GPU
+        std::optional<u32> executorSlotCountScale;
+        std::optional<bool> asyncPipelineCompilation;
+        std::optional<bool> shaderHashValidation;
+        std::optional<bool> gpuTextureDecoding;
+        std::optional<u32> textureMemoryBudget;
+        std::optional<bool> gpuTextureDeswizzling;
+        std::optional<u32> resolutionScale;
+        std::optional<bool> presentUpscaling;
+        std::optional<bool> asyncTextureReadback;
+        std::optional<bool> parallelCommandRecording;
+
+        // Hacks
+        std::optional<bool> enableFastGpuReadbackHack;
+
+        // Audio
+        std::optional<bool> adaptiveAudioLatency;
+
+        /**
+         * @return The profile for the supplied title or nullptr if it doesn't have one, malformed lines are logged and skipped
+         */
+        static std::shared_ptr<const TitleProfile> Load(const std::string &publicAppFilesPath, u64 titleId);
+
+        /**
+         * @brief Overwrites all settings that are a part of this profile, callbacks are not dispatched by this
+         */
+        void Apply(Settings &settings) const;
+    };
+}
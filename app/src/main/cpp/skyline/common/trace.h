@@ -15,6 +15,7 @@ PERFETTO_DEFINE_CATEGORIES(
     perfetto::Category("guest").SetDescription("Events relating to guest code"),
     perfetto::Category("host").SetDescription("Events relating to host code"),
     perfetto::Category("gpu").SetDescription("Events from the emulated GPU"),
+    perfetto::Category("gpu_timestamps").SetDescription("GPU execution times of render passes and commands measured with timestamp queries"),
     perfetto::Category("service").SetDescription("Events from the HLE sysmodule implementations"),
     perfetto::Category("containers").SetDescription("Events from custom container implementations")
 );
@@ -25,5 +26,9 @@ namespace skyline::trace {
      */
     enum class TrackIds : u64 {
         Presentation = std::numeric_limits<u64>::max(),
+        GpuRenderPasses = std::numeric_limits<u64>::max() - 1, //!< The first of the GPU timestamp tracks, one for every gpu::TimestampCategory in order
+        GpuCompute = std::numeric_limits<u64>::max() - 2,
+        GpuBlits = std::numeric_limits<u64>::max() - 3,
+        GpuDma = std::numeric_limits<u64>::max() - 4,
     };
 }
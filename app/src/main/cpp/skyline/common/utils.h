@@ -68,6 +68,14 @@ namespace skyline::util {
         return ticks;
     }
 
+    /**
+     * @brief Converts a duration in ticks of the system counter into nanoseconds
+     */
+    inline i64 TicksToNs(u64 ticks) {
+        u64 frequency{ClockFrequency};
+        return static_cast<i64>(((ticks / frequency) * constant::NsInSecond) + (((ticks % frequency) * constant::NsInSecond + (frequency / 2)) / frequency));
+    }
+
     /**
      * @brief A way to implicitly convert a pointer to uintptr_t and leave it unaffected if it isn't a pointer
      */
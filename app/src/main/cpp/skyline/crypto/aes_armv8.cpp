@@ -0,0 +1,171 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2023 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#include <arm_neon.h>
+#include "aes_armv8.h"
+
+/*
+ * This file is compiled with the AES instructions enabled (see CMakeLists.txt), nothing in it may be called without IsAesSupported() returning true
+ */
+namespace skyline::crypto::armv8 {
+    constexpr size_t BlockSize{sizeof(Block)};
+    constexpr size_t InterleaveCount{4}; //!< The amount of blocks processed in parallel, AESE/AESD have a latency of multiple cycles but can be issued every cycle
+
+    using RoundKeys = std::array<uint8x16_t, 11>;
+    using Blocks = std::array<uint8x16_t, InterleaveCount>;
+
+    bool IsAesSupported() {
+        static bool supported{(getauxval(AT_HWCAP) & HWCAP_AES) != 0};
+        return supported;
+    }
+
+    Aes128KeySchedule::Aes128KeySchedule(span<const u8> key) {
+        if (key.size() != BlockSize)
+            throw exception("Invalid AES-128 key size: 0x{:X}", key.size());
+
+        constexpr std::array<u8, 10> RoundConstants{0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1B, 0x36};
+
+        std::array<u32, 44> words;
+        std::memcpy(words.data(), key.data(), BlockSize);
+        for (size_t i{4}; i < words.size(); i++) {
+            u32 word{words[i - 1]};
+            if (i % 4 == 0) {
+                // AESE with a zero round key is SubBytes(ShiftRows(x)), ShiftRows has no effect when all columns are identical so this is SubWord
+                u32 substituted{vgetq_lane_u32(vreinterpretq_u32_u8(vaeseq_u8(vreinterpretq_u8_u32(vdupq_n_u32(word)), vdupq_n_u8(0))), 0)};
+                word = ((substituted >> 8) | (substituted << 24)) ^ RoundConstants[i / 4 - 1];
+            }
+            words[i] = words[i - 4] ^ word;
+        }
+        std::memcpy(encryptionKeys.data(), words.data(), sizeof(encryptionKeys));
+
+        decryptionKeys.front() = encryptionKeys.back();
+        for (size_t i{1}; i < decryptionKeys.size() - 1; i++)
+            vst1q_u8(decryptionKeys[i].data(), vaesimcq_u8(vld1q_u8(encryptionKeys[encryptionKeys.size() - 1 - i].data())));
+        decryptionKeys.back() = encryptionKeys.front();
+    }
+
+    static RoundKeys LoadRoundKeys(const std::array<Block, 11> &keys) {
+        RoundKeys roundKeys;
+        for (size_t i{}; i < roundKeys.size(); i++)
+            roundKeys[i] = vld1q_u8(keys[i].data());
+        return roundKeys;
+    }
+
+    /**
+     * @note Every round is applied to all blocks before the next round so the instructions of independent blocks are interleaved
+     */
+    template<size_t Count>
+    static void EncryptBlocks(const RoundKeys &keys, std::array<uint8x16_t, Count> &blocks) {
+        for (size_t round{}; round < keys.size() - 2; round++)
+            for (auto &block : blocks)
+                block = vaesmcq_u8(vaeseq_u8(block, keys[round]));
+
+        for (auto &block : blocks)
+            block = veorq_u8(vaeseq_u8(block, keys[keys.size() - 2]), keys.back());
+    }
+
+    template<size_t Count>
+    static void DecryptBlocks(const RoundKeys &keys, std::array<uint8x16_t, Count> &blocks) {
+        for (size_t round{}; round < keys.size() - 2; round++)
+            for (auto &block : blocks)
+                block = vaesimcq_u8(vaesdq_u8(block, keys[round]));
+
+        for (auto &block : blocks)
+            block = veorq_u8(vaesdq_u8(block, keys[keys.size() - 2]), keys.back());
+    }
+
+    void CtrCrypt(const Aes128KeySchedule &key, Block &counter, u8 *destination, const u8 *source, size_t size) {
+        auto keys{LoadRoundKeys(key.encryptionKeys)};
+
+        u64 high, low;
+        std::memcpy(&high, counter.data(), sizeof(u64));
+        std::memcpy(&low, counter.data() + sizeof(u64), sizeof(u64));
+        high = util::SwapEndianness(high);
+        low = util::SwapEndianness(low);
+
+        auto nextCounter{[&]() {
+            uint8x16_t block{vreinterpretq_u8_u64(vcombine_u64(vcreate_u64(util::SwapEndianness(high)), vcreate_u64(util::SwapEndianness(low))))};
+            if (++low == 0)
+                high++;
+            return block;
+        }};
+
+        size_t offset{};
+        for (; offset + InterleaveCount * BlockSize <= size; offset += InterleaveCount * BlockSize) {
+            Blocks keystream;
+            for (auto &block : keystream)
+                block = nextCounter();
+
+            EncryptBlocks(keys, keystream);
+
+            for (size_t i{}; i < InterleaveCount; i++)
+                vst1q_u8(destination + offset + i * BlockSize, veorq_u8(vld1q_u8(source + offset + i * BlockSize), keystream[i]));
+        }
+
+        for (; offset < size; offset += BlockSize) {
+            std::array<uint8x16_t, 1> keystream{nextCounter()};
+            EncryptBlocks(keys, keystream);
+
+            if (size - offset >= BlockSize) {
+                vst1q_u8(destination + offset, veorq_u8(vld1q_u8(source + offset), keystream.front()));
+            } else {
+                Block stream;
+                vst1q_u8(stream.data(), keystream.front());
+                for (size_t i{}; i < size - offset; i++)
+                    destination[offset + i] = source[offset + i] ^ stream[i];
+            }
+        }
+
+        high = util::SwapEndianness(high);
+        low = util::SwapEndianness(low);
+        std::memcpy(counter.data(), &high, sizeof(u64));
+        std::memcpy(counter.data() + sizeof(u64), &low, sizeof(u64));
+    }
+
+    /**
+     * @brief Multiplies an XTS tweak by the primitive element α of GF(2^128) in the little-endian convention of IEEE 1619
+     */
+    static uint8x16_t MultiplyTweak(uint8x16_t tweak) {
+        uint64x2_t value{vreinterpretq_u64_u8(tweak)};
+        u64 low{vgetq_lane_u64(value, 0)}, high{vgetq_lane_u64(value, 1)};
+        u64 carry{high >> 63};
+        high = (high << 1) | (low >> 63);
+        low = (low << 1) ^ (carry * 0x87);
+        return vreinterpretq_u8_u64(vcombine_u64(vcreate_u64(low), vcreate_u64(high)));
+    }
+
+    void XtsDecrypt(const Aes128KeySchedule &dataKey, const Aes128KeySchedule &tweakKey, const Block &tweak, u8 *destination, const u8 *source, size_t size) {
+        if (size % BlockSize)
+            throw exception("XTS data unit size isn't a multiple of the block size: 0x{:X}", size);
+
+        std::array<uint8x16_t, 1> encryptedTweak{vld1q_u8(tweak.data())};
+        EncryptBlocks(LoadRoundKeys(tweakKey.encryptionKeys), encryptedTweak);
+        uint8x16_t currentTweak{encryptedTweak.front()};
+
+        auto keys{LoadRoundKeys(dataKey.decryptionKeys)};
+
+        size_t offset{};
+        for (; offset + InterleaveCount * BlockSize <= size; offset += InterleaveCount * BlockSize) {
+            Blocks tweaks, blocks;
+            for (size_t i{}; i < InterleaveCount; i++) {
+                tweaks[i] = currentTweak;
+                currentTweak = MultiplyTweak(currentTweak);
+                blocks[i] = veorq_u8(vld1q_u8(source + offset + i * BlockSize), tweaks[i]);
+            }
+
+            DecryptBlocks(keys, blocks);
+
+            for (size_t i{}; i < InterleaveCount; i++)
+                vst1q_u8(destination + offset + i * BlockSize, veorq_u8(blocks[i], tweaks[i]));
+        }
+
+        for (; offset < size; offset += BlockSize) {
+            std::array<uint8x16_t, 1> block{veorq_u8(vld1q_u8(source + offset), currentTweak)};
+            DecryptBlocks(keys, block);
+            vst1q_u8(destination + offset, veorq_u8(block.front(), currentTweak));
+            currentTweak = MultiplyTweak(currentTweak);
+        }
+    }
+}
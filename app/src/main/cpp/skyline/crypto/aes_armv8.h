@@ -0,0 +1,41 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2023 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#pragma once
+
+#include <common.h>
+
+namespace skyline::crypto::armv8 {
+    using Block = std::array<u8, 0x10>;
+
+    /**
+     * @return If the host CPU implements the AES instructions from the ARMv8 Cryptography Extension
+     * @note None of the functions below may be called if this returns false as they'll raise SIGILL
+     */
+    bool IsAesSupported();
+
+    /**
+     * @brief The expanded round keys of an AES-128 key for both encryption and decryption
+     */
+    struct Aes128KeySchedule {
+        std::array<Block, 11> encryptionKeys;
+        std::array<Block, 11> decryptionKeys; //!< The round keys of the equivalent inverse cipher in the order they're applied, these are pre-transformed with InvMixColumns for AESD/AESIMC
+
+        explicit Aes128KeySchedule(span<const u8> key);
+    };
+
+    /**
+     * @brief Encrypts or decrypts data with AES-CTR, the keystream of multiple blocks is generated in parallel to hide the latency of the AES instructions
+     * @param counter The big-endian counter of the first block, this is advanced past every block that was used including a trailing partial block
+     * @note The destination and source buffers can be the same
+     */
+    void CtrCrypt(const Aes128KeySchedule &key, Block &counter, u8 *destination, const u8 *source, size_t size);
+
+    /**
+     * @brief Decrypts a single data unit with AES-XTS, multiple blocks are decrypted in parallel
+     * @param tweak The unencrypted tweak of the data unit
+     * @note The size must be a multiple of the block size as ciphertext stealing isn't supported
+     * @note The destination and source buffers can be the same
+     */
+    void XtsDecrypt(const Aes128KeySchedule &dataKey, const Aes128KeySchedule &tweakKey, const Block &tweak, u8 *destination, const u8 *source, size_t size);
+}
@@ -11,18 +11,43 @@ namespace skyline::crypto {
 
         if (mbedtls_cipher_setkey(&decryptContext, key.data(), static_cast<int>(key.size() * 8), MBEDTLS_DECRYPT) != 0)
             throw exception("Failed to set key for decryption context");
+
+        xts = type == MBEDTLS_CIPHER_AES_128_XTS;
+        if ((type == MBEDTLS_CIPHER_AES_128_CTR || xts) && armv8::IsAesSupported()) {
+            if (xts) {
+                // The first half of an XTS key is the data key while the second half is the tweak key
+                hardwareKey.emplace(key.first(key.size() / 2));
+                hardwareTweakKey.emplace(key.subspan(key.size() / 2));
+            } else {
+                hardwareKey.emplace(key);
+            }
+        }
     }
 
     AesCipher::~AesCipher() {
         mbedtls_cipher_free(&decryptContext);
     }
 
-    void AesCipher::SetIV(const std::array<u8, 0x10> &iv) {
-        if (mbedtls_cipher_set_iv(&decryptContext, iv.data(), iv.size()) != 0)
-            throw exception("Failed to set IV for decryption context");
+    void AesCipher::SetIV(const std::array<u8, 0x10> &pIv) {
+        iv = pIv;
+
+        // The mbedtls IV is kept up to date for XTS as it's used as a fallback for data units that need ciphertext stealing
+        if (!hardwareKey || xts)
+            if (mbedtls_cipher_set_iv(&decryptContext, pIv.data(), pIv.size()) != 0)
+                throw exception("Failed to set IV for decryption context");
     }
 
     void AesCipher::Decrypt(u8 *destination, u8 *source, size_t size) {
+        if (hardwareKey) {
+            if (!xts) {
+                armv8::CtrCrypt(*hardwareKey, iv, destination, source, size);
+                return;
+            } else if (size % iv.size() == 0) {
+                armv8::XtsDecrypt(*hardwareKey, *hardwareTweakKey, iv, destination, source, size);
+                return;
+            }
+        }
+
         constexpr size_t maxBufferSize = 1024 * 1024; //!< Buffer shouldn't grow larger than 1 MiB
 
         std::optional<std::vector<u8>> buf{};
@@ -5,16 +5,22 @@
 
 #include <mbedtls/cipher.h>
 #include <common.h>
+#include "aes_armv8.h"
 
 namespace skyline::crypto {
     /**
      * @brief Wrapper for mbedtls for AES decryption using a cipher
+     * @note AES-128-CTR and AES-128-XTS use the ARMv8 AES instructions directly when the host supports them, mbedtls is only used as a fallback for them
      * @note The IV state must be appropriately locked during multi-threaded usage
      */
     class AesCipher {
       private:
         mbedtls_cipher_context_t decryptContext;
         std::vector<u8> buffer; //!< A buffer used to avoid constant memory allocation
+        std::array<u8, 0x10> iv{}; //!< The IV used by the hardware backend, this is the current counter for CTR
+        bool xts{};
+        std::optional<armv8::Aes128KeySchedule> hardwareKey; //!< The key for the hardware backend, this is the data key for XTS
+        std::optional<armv8::Aes128KeySchedule> hardwareTweakKey; //!< The XTS tweak key for the hardware backend
 
         /**
          * @brief Calculates IV for XTS, basically just big to little endian conversion
@@ -34,7 +40,7 @@ namespace skyline::crypto {
         /**
          * @brief Sets the Initialization Vector
          */
-        void SetIV(const std::array<u8, 0x10> &iv);
+        void SetIV(const std::array<u8, 0x10> &pIv);
 
         /**
          * @brief Decrypts the supplied buffer and outputs the result into the destination buffer
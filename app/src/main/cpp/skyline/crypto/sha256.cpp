@@ -0,0 +1,136 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2023 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#include <arm_neon.h>
+#include "sha256.h"
+
+/*
+ * This file is compiled with the SHA2 instructions enabled (see CMakeLists.txt), the intrinsics must only be reached when IsShaSupported() returns true
+ */
+namespace skyline::crypto {
+    static bool IsShaSupported() {
+        static bool supported{(getauxval(AT_HWCAP) & HWCAP_SHA2) != 0};
+        return supported;
+    }
+
+    constexpr std::array<u32, 8> InitialHashState{
+        0x6A09E667, 0xBB67AE85, 0x3C6EF372, 0xA54FF53A, 0x510E527F, 0x9B05688C, 0x1F83D9AB, 0x5BE0CD19,
+    };
+
+    constexpr std::array<u32, 64> RoundConstants{
+        0x428A2F98, 0x71374491, 0xB5C0FBCF, 0xE9B5DBA5, 0x3956C25B, 0x59F111F1, 0x923F82A4, 0xAB1C5ED5,
+        0xD807AA98, 0x12835B01, 0x243185BE, 0x550C7DC3, 0x72BE5D74, 0x80DEB1FE, 0x9BDC06A7, 0xC19BF174,
+        0xE49B69C1, 0xEFBE4786, 0x0FC19DC6, 0x240CA1CC, 0x2DE92C6F, 0x4A7484AA, 0x5CB0A9DC, 0x76F988DA,
+        0x983E5152, 0xA831C66D, 0xB00327C8, 0xBF597FC7, 0xC6E00BF3, 0xD5A79147, 0x06CA6351, 0x14292967,
+        0x27B70A85, 0x2E1B2138, 0x4D2C6DFC, 0x53380D13, 0x650A7354, 0x766A0ABB, 0x81C2C92E, 0x92722C85,
+        0xA2BFE8A1, 0xA81A664B, 0xC24B8B70, 0xC76C51A3, 0xD192E819, 0xD6990624, 0xF40E3585, 0x106AA070,
+        0x19A4C116, 0x1E376C08, 0x2748774C, 0x34B0BCB5, 0x391C0CB3, 0x4ED8AA4A, 0x5B9CCA4F, 0x682E6FF3,
+        0x748F82EE, 0x78A5636F, 0x84C87814, 0x8CC70208, 0x90BEFFFA, 0xA4506CEB, 0xBEF9A3F7, 0xC67178F2,
+    };
+
+    Sha256::Sha256() : hardware{IsShaSupported()}, hashState{InitialHashState} {
+        if (!hardware) {
+            mbedtls_sha256_init(&context);
+            mbedtls_sha256_starts_ret(&context, 0);
+        }
+    }
+
+    Sha256::~Sha256() {
+        if (!hardware)
+            mbedtls_sha256_free(&context);
+    }
+
+    void Sha256::CompressBlocks(const u8 *data, size_t blockCount) {
+        uint32x4_t abcd{vld1q_u32(hashState.data())}, efgh{vld1q_u32(hashState.data() + 4)};
+
+        for (size_t block{}; block < blockCount; block++, data += BlockSize) {
+            std::array<uint32x4_t, 4> schedule;
+            for (size_t i{}; i < schedule.size(); i++)
+                schedule[i] = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(data + i * sizeof(uint32x4_t)))); // The message words are big-endian
+
+            uint32x4_t savedAbcd{abcd}, savedEfgh{efgh};
+            for (size_t quad{}; quad < RoundConstants.size() / 4; quad++) {
+                auto &words{schedule[quad % 4]};
+                uint32x4_t wk{vaddq_u32(words, vld1q_u32(RoundConstants.data() + quad * 4))};
+
+                // The schedule is extended in place, the last 4 quads of rounds only consume words that were already extended
+                if (quad < RoundConstants.size() / 4 - 4)
+                    words = vsha256su1q_u32(vsha256su0q_u32(words, schedule[(quad + 1) % 4]), schedule[(quad + 2) % 4], schedule[(quad + 3) % 4]);
+
+                uint32x4_t previousAbcd{abcd};
+                abcd = vsha256hq_u32(abcd, efgh, wk);
+                efgh = vsha256h2q_u32(efgh, previousAbcd, wk);
+            }
+
+            abcd = vaddq_u32(abcd, savedAbcd);
+            efgh = vaddq_u32(efgh, savedEfgh);
+        }
+
+        vst1q_u32(hashState.data(), abcd);
+        vst1q_u32(hashState.data() + 4, efgh);
+    }
+
+    void Sha256::Update(span<const u8> data) {
+        if (!hardware) {
+            mbedtls_sha256_update_ret(&context, data.data(), data.size());
+            return;
+        }
+
+        length += data.size();
+
+        if (pendingSize) {
+            size_t copySize{std::min(BlockSize - pendingSize, data.size())};
+            std::memcpy(pending.data() + pendingSize, data.data(), copySize);
+            pendingSize += copySize;
+            data = data.subspan(copySize);
+
+            if (pendingSize != BlockSize)
+                return;
+
+            CompressBlocks(pending.data(), 1);
+            pendingSize = 0;
+        }
+
+        size_t blockCount{data.size() / BlockSize};
+        if (blockCount)
+            CompressBlocks(data.data(), blockCount);
+
+        pendingSize = data.size() - blockCount * BlockSize;
+        std::memcpy(pending.data(), data.data() + blockCount * BlockSize, pendingSize);
+    }
+
+    Sha256::Digest Sha256::Finalize() {
+        Digest digest;
+        if (!hardware) {
+            mbedtls_sha256_finish_ret(&context, digest.data());
+            return digest;
+        }
+
+        u64 bitLength{util::SwapEndianness(length * 8)};
+
+        // The message is padded with a single set bit followed by zeroes with the big-endian bit length in the last 8 bytes of the final block
+        pending[pendingSize++] = 0x80;
+        if (pendingSize > BlockSize - sizeof(bitLength)) {
+            std::memset(pending.data() + pendingSize, 0, BlockSize - pendingSize);
+            CompressBlocks(pending.data(), 1);
+            pendingSize = 0;
+        }
+        std::memset(pending.data() + pendingSize, 0, BlockSize - sizeof(bitLength) - pendingSize);
+        std::memcpy(pending.data() + BlockSize - sizeof(bitLength), &bitLength, sizeof(bitLength));
+        CompressBlocks(pending.data(), 1);
+
+        for (size_t i{}; i < hashState.size(); i++) {
+            u32 word{util::SwapEndianness(hashState[i])};
+            std::memcpy(digest.data() + i * sizeof(u32), &word, sizeof(u32));
+        }
+        return digest;
+    }
+
+    Sha256::Digest Sha256::Hash(span<const u8> data) {
+        Sha256 hasher;
+        hasher.Update(data);
+        return hasher.Finalize();
+    }
+}
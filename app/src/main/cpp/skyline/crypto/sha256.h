@@ -0,0 +1,54 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2023 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#pragma once
+
+#include <mbedtls/sha256.h>
+#include <common.h>
+
+namespace skyline::crypto {
+    /**
+     * @brief An incremental SHA-256 hasher which uses the ARMv8 SHA2 instructions when the host supports them and falls back to mbedtls otherwise
+     */
+    class Sha256 {
+      public:
+        using Digest = std::array<u8, 0x20>;
+
+      private:
+        static constexpr size_t BlockSize{0x40};
+
+        bool hardware; //!< If the ARMv8 SHA2 instructions are used, mbedtls is used otherwise
+        std::array<u32, 8> hashState; //!< The intermediate hash of all complete blocks processed by the hardware path
+        std::array<u8, BlockSize> pending; //!< The data of an incomplete block for the hardware path
+        size_t pendingSize{};
+        u64 length{}; //!< The total amount of bytes hashed by the hardware path
+        mbedtls_sha256_context context; //!< The mbedtls state for the software path
+
+        /**
+         * @brief Processes complete blocks with the ARMv8 SHA2 instructions
+         */
+        void CompressBlocks(const u8 *data, size_t blockCount);
+
+      public:
+        Sha256();
+
+        ~Sha256();
+
+        Sha256(const Sha256 &) = delete;
+
+        Sha256 &operator=(const Sha256 &) = delete;
+
+        void Update(span<const u8> data);
+
+        /**
+         * @return The digest of all data supplied so far
+         * @note The hasher must not be used after this has been called
+         */
+        Digest Finalize();
+
+        /**
+         * @return The digest of the supplied data
+         */
+        static Digest Hash(span<const u8> data);
+    };
+}
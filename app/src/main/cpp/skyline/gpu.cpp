@@ -6,10 +6,14 @@
 #include <os.h>
 #include <jvm.h>
 #include <common/settings.h>
+#include <common/boot_profile.h>
+#include <vfs/os_filesystem.h>
+#include <gpu/interconnect/maxwell_3d/pipeline_state_recorder.h>
 #include "gpu.h"
 
 namespace skyline::gpu {
     static vk::raii::Instance CreateInstance(const DeviceState &state, const vk::raii::Context &context) {
+        ScopedBootPhase bootPhase{BootProfile::Phase::VulkanInit};
         vk::ApplicationInfo applicationInfo{
             .pApplicationName = "Skyline",
             .applicationVersion = static_cast<uint32_t>(state.jvm->GetVersionCode()), // Get the application version from JNI
@@ -220,6 +224,7 @@ namespace skyline::gpu {
                                          const vk::raii::PhysicalDevice &physicalDevice,
                                          decltype(vk::DeviceQueueCreateInfo::queueCount) &vkQueueFamilyIndex,
                                          TraitManager &traits) {
+        ScopedBootPhase bootPhase{BootProfile::Phase::VulkanInit};
         auto deviceFeatures2{physicalDevice.getFeatures2<
             vk::PhysicalDeviceFeatures2,
             vk::PhysicalDeviceCustomBorderColorFeaturesEXT,
@@ -235,7 +240,13 @@ namespace skyline::gpu {
             vk::PhysicalDeviceTransformFeedbackFeaturesEXT,
             vk::PhysicalDeviceIndexTypeUint8FeaturesEXT,
             vk::PhysicalDeviceExtendedDynamicStateFeaturesEXT,
-            vk::PhysicalDeviceRobustness2FeaturesEXT>()};
+            vk::PhysicalDeviceExtendedDynamicState2FeaturesEXT,
+            vk::PhysicalDeviceRobustness2FeaturesEXT,
+            vk::PhysicalDeviceGraphicsPipelineLibraryFeaturesEXT,
+            vk::PhysicalDeviceTimelineSemaphoreFeatures,
+            vk::PhysicalDeviceConditionalRenderingFeaturesEXT,
+            vk::PhysicalDeviceDescriptorIndexingFeatures,
+            vk::PhysicalDeviceDynamicRenderingFeatures>()};
         decltype(deviceFeatures2) enabledFeatures2{}; // We only want to enable features we required due to potential overhead from unused features
 
         #define FEAT_REQ(structName, feature)                                            \
@@ -271,7 +282,9 @@ namespace skyline::gpu {
             vk::PhysicalDeviceDriverProperties,
             vk::PhysicalDeviceFloatControlsProperties,
             vk::PhysicalDeviceTransformFeedbackPropertiesEXT,
-            vk::PhysicalDeviceSubgroupProperties>()};
+            vk::PhysicalDeviceSubgroupProperties,
+            vk::PhysicalDeviceGraphicsPipelineLibraryPropertiesEXT,
+            vk::PhysicalDeviceDescriptorIndexingProperties>()};
 
         traits = TraitManager{deviceFeatures2, enabledFeatures2, deviceExtensions, enabledExtensions, deviceProperties2, physicalDevice};
         traits.ApplyDriverPatches(context);
@@ -336,6 +349,7 @@ namespace skyline::gpu {
     }
 
     static PFN_vkGetInstanceProcAddr LoadVulkanDriver(const DeviceState &state) {
+        ScopedBootPhase bootPhase{BootProfile::Phase::VulkanInit};
         void *libvulkanHandle{};
 
         // If the user has selected a custom driver, try to load it
@@ -370,6 +384,7 @@ namespace skyline::gpu {
           vkPhysicalDevice(CreatePhysicalDevice(vkInstance)),
           vkDevice(CreateDevice(vkContext, vkPhysicalDevice, vkQueueFamilyIndex, traits)),
           vkQueue(vkDevice, vkQueueFamilyIndex, 0),
+          timestampProfiler(*this),
           memory(*this),
           scheduler(state, *this),
           presentation(state, *this),
@@ -381,5 +396,44 @@ namespace skyline::gpu {
           helperShaders(*this, state.os->assetFileSystem),
           graphicsPipelineCache(*this),
           renderPassCache(*this),
-          framebufferCache(*this) {}
+          framebufferCache(*this),
+          pipelineCompilePool(std::thread::hardware_concurrency() / 2, "PipeComp"),
+          textureDecodePool(std::thread::hardware_concurrency() / 2, "TexDecode"),
+          commandRecordPool(std::thread::hardware_concurrency() / 2, "CmdRecord"),
+          maxwell3dPipelineRecorder(std::make_unique<interconnect::maxwell3d::PipelineStateRecorder>(*this)) {}
+
+    GPU::~GPU() = default;
+
+    bool GPU::IsAsyncPipelineCompilationEnabled() const {
+        return *state.settings->asyncPipelineCompilation;
+    }
+
+    bool GPU::IsShaderHashValidationEnabled() const {
+        return *state.settings->shaderHashValidation;
+    }
+
+    void GPU::LoadTitleCaches(u64 titleId) {
+        std::shared_ptr<vfs::FileSystem> cacheFileSystem;
+        try {
+            cacheFileSystem = std::make_shared<vfs::OsFileSystem>(util::Format("{}cache/{:016X}/", state.os->publicAppFilesPath, titleId));
+        } catch (const std::exception &e) {
+            Logger::Warn("Failed to open the title cache directory: {}", e.what());
+            return;
+        }
+
+        shader.LoadDiskCache(cacheFileSystem, *state.settings->gpuDriver);
+        graphicsPipelineCache.LoadDiskCache(cacheFileSystem, *state.settings->gpuDriver);
+        maxwell3dPipelineRecorder->Load(cacheFileSystem);
+
+        if (*state.settings->exportPipelineStatistics)
+            pipelineStatistics.EnableExport(cacheFileSystem);
+    }
+
+    void GPU::Trim() {
+        // Channels only touch the texture manager and megabuffer with the global channel lock held, holding it here also stops any further submissions while the queue drains
+        std::scoped_lock channelGuard{channelLock};
+        scheduler.WaitIdle();
+        megaBufferAllocator.Trim();
+        texture.Trim();
+    }
 }
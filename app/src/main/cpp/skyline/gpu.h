@@ -3,9 +3,12 @@
 
 #pragma once
 
+#include <common/thread_pool.h>
 #include "gpu/trait_manager.h"
 #include "gpu/memory_manager.h"
 #include "gpu/command_scheduler.h"
+#include "gpu/timestamp_profiler.h"
+#include "gpu/sync_traffic.h"
 #include "gpu/presentation_engine.h"
 #include "gpu/texture_manager.h"
 #include "gpu/buffer_manager.h"
@@ -13,10 +16,16 @@
 #include "gpu/descriptor_allocator.h"
 #include "gpu/shader_manager.h"
 #include "gpu/shaders/helper_shaders.h"
+#include "gpu/cache/pipeline_statistics.h"
+#include "gpu/cache/shader_compile_statistics.h"
 #include "gpu/cache/graphics_pipeline_cache.h"
 #include "gpu/cache/renderpass_cache.h"
 #include "gpu/cache/framebuffer_cache.h"
 
+namespace skyline::gpu::interconnect::maxwell3d {
+    class PipelineStateRecorder;
+}
+
 namespace skyline::gpu {
     static constexpr u32 VkApiVersion{VK_API_VERSION_1_1}; //!< The version of core Vulkan that we require
 
@@ -39,7 +48,9 @@ namespace skyline::gpu {
         vk::raii::Device vkDevice;
         std::mutex queueMutex; //!< Synchronizes access to the queue as it is externally synchronized
         vk::raii::Queue vkQueue; //!< A Vulkan Queue supporting graphics and compute operations
+        TimestampProfiler timestampProfiler; //!< Profiles GPU execution while tracing, this must be destroyed after the scheduler as it resolves queries in fence cycle callbacks
 
+        SyncTraffic syncTraffic; //!< The CPU <-> GPU transfers of the current frame, this must be destroyed after anything that can record into it
         memory::MemoryManager memory;
         CommandScheduler scheduler;
         PresentationEngine presentation;
@@ -53,12 +64,45 @@ namespace skyline::gpu {
 
         HelperShaders helperShaders;
 
+        cache::PipelineStatistics pipelineStatistics; //!< Statistics about all pipelines used by the title, this must be destroyed after anything that can record into it
+        cache::ShaderCompileStatistics shaderCompileStatistics; //!< The time spent in each phase of shader compilation by guest shader, this must be destroyed after anything that can record into it
         cache::GraphicsPipelineCache graphicsPipelineCache;
         cache::RenderPassCache renderPassCache;
         cache::FramebufferCache framebufferCache;
 
+        ThreadPool pipelineCompilePool; //!< A pool of threads which pipelines are compiled on when asynchronous pipeline compilation is enabled
+        ThreadPool textureDecodePool; //!< A pool of threads which large texture uploads are deswizzled and decoded on in parallel, these are always waited on by the uploading thread
+        ThreadPool commandRecordPool; //!< A pool of threads which chunks of render passes are recorded into secondary command buffers on when parallel command recording is enabled, these are always waited on by the command record thread
+
+        std::unique_ptr<interconnect::maxwell3d::PipelineStateRecorder> maxwell3dPipelineRecorder; //!< Records all Maxwell 3D pipelines and pre-warms them on subsequent boots, this must be destroyed prior to any caches it uses
+
         std::mutex channelLock;
+        std::atomic<u32> channelLockWaiters{}; //!< The amount of channels that are currently blocked on acquiring `channelLock`
 
         GPU(const DeviceState &state);
+
+        ~GPU();
+
+        /**
+         * @return If pipelines should be compiled asynchronously on `pipelineCompilePool` rather than on the thread requiring them
+         */
+        bool IsAsyncPipelineCompilationEnabled() const;
+
+        /**
+         * @return If guest shader modifications should be detected by hashing shader memory rather than by trapping writes to it
+         */
+        bool IsShaderHashValidationEnabled() const;
+
+        /**
+         * @brief Loads all persistent on-disk caches for the supplied title, this should be called once the title's process data has been loaded
+         * @note The caches are stored per-title in the public app files directory under 'cache/'
+         */
+        void LoadTitleCaches(u64 titleId);
+
+        /**
+         * @brief Waits for the GPU to go idle and releases any host memory that can be recreated on demand, this is used when emulation is suspended
+         * @note Guest threads should be paused prior to calling this so no new work is submitted while trimming
+         */
+        void Trim();
     };
 }
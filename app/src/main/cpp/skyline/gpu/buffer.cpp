@@ -6,6 +6,7 @@
 #include <kernel/types/KProcess.h>
 #include <common/trace.h>
 #include <common/settings.h>
+#include <common/performance_statistics.h>
 #include "buffer.h"
 
 namespace skyline::gpu {
@@ -18,6 +19,33 @@ namespace skyline::gpu {
         unifiedMegaBuffer = {};
     }
 
+    void Buffer::MarkCpuDirty(span<u8> guestRange) {
+        u8 *alignedData{util::AlignDown(guest->data(), constant::PageSize)};
+        size_t pageCount{alignedMirror.size() >> constant::PageSizeBits};
+        size_t firstPage{static_cast<size_t>(std::max(guestRange.data(), alignedData) - alignedData) >> constant::PageSizeBits};
+        size_t endPage{std::min(static_cast<size_t>(util::AlignUp(guestRange.data() + guestRange.size(), constant::PageSize) - alignedData) >> constant::PageSizeBits, pageCount)};
+        for (size_t page{firstPage}; page < endPage; page++)
+            cpuDirtyPages[page / 64] |= 1ULL << (page % 64);
+
+        dirtyState = DirtyState::CpuDirty;
+    }
+
+    bool Buffer::TryBindInPlace() {
+        std::scoped_lock lock{stateMutex};
+        if (boundInPlace)
+            return true;
+
+        // The backing can only be written on the CPU if no earlier command in this context uses it in sequence and the GPU has finished using it in prior ones
+        if (everHadInPlaceWriteConflict || backingImmutability != BackingImmutability::None || !PollFence())
+            return false;
+
+        // Pending guest writes are uploaded now rather than on submission and all pages are retrapped, any later guest write then blocks until the context has been submitted so it can't be observed by draws recorded prior to it
+        SynchronizeHost();
+        backingImmutability = BackingImmutability::AllWrites;
+        boundInPlace = true;
+        return true;
+    }
+
     void Buffer::SetupGuestMappings() {
         u8 *alignedData{util::AlignDown(guest->data(), constant::PageSize)};
         size_t alignedSize{static_cast<size_t>(util::AlignUp(guest->data() + guest->size(), constant::PageSize) - alignedData)};
@@ -25,19 +53,27 @@ namespace skyline::gpu {
         alignedMirror = gpu.state.process->memory.CreateMirror(span<u8>{alignedData, alignedSize});
         mirror = alignedMirror.subspan(static_cast<size_t>(guest->data() - alignedData), guest->size());
 
+        // All pages are initially dirty as the backing has never been synchronized with the guest
+        size_t pageCount{alignedSize >> constant::PageSizeBits};
+        cpuDirtyPages.assign(util::DivideCeil<size_t>(pageCount, 64), ~0ULL);
+
         // We can't just capture this in the lambda since the lambda could exceed the lifetime of the buffer
         std::weak_ptr<Buffer> weakThis{shared_from_this()};
-        trapHandle = gpu.state.nce->CreateTrap(*guest, [weakThis] {
+        trapHandle = gpu.state.nce->CreatePageTrap(nce::TrapResource::Buffer, *guest, [weakThis] {
             auto buffer{weakThis.lock()};
             if (!buffer)
                 return;
 
             std::unique_lock stateLock{buffer->stateMutex};
             if (buffer->AllCpuBackingWritesBlocked() || buffer->dirtyState == DirtyState::GpuDirty) {
+                // Binding in place is only beneficial if the guest doesn't write to the buffer while it's in use, it's megabuffered from now on so the guest is only stalled by this once
+                if (buffer->boundInPlace)
+                    buffer->everHadInPlaceWriteConflict = true;
+
                 stateLock.unlock(); // If the lock isn't unlocked, a deadlock from threads waiting on the other lock can occur
 
                 // If this mutex would cause other callbacks to be blocked then we should block on this mutex in advance
-                std::shared_ptr<FenceCycle> waitCycle{};
+                IntrusivePtr<FenceCycle> waitCycle{};
                 do {
                     if (waitCycle) {
                         i64 startNs{buffer->accumulatedGuestWaitCounter > FastReadbackHackWaitCountThreshold ? util::GetTimeNs() : 0};
@@ -80,7 +116,7 @@ namespace skyline::gpu {
 
             buffer->SynchronizeGuest(true); // We can skip trapping since the caller will do it
             return true;
-        }, [weakThis] {
+        }, [weakThis](u8 *page) {
             TRACE_EVENT("gpu", "Buffer::WriteTrap");
 
             auto buffer{weakThis.lock()};
@@ -92,15 +128,16 @@ namespace skyline::gpu {
                 return false;
 
             if (!buffer->AllCpuBackingWritesBlocked() && buffer->dirtyState != DirtyState::GpuDirty) {
-                buffer->dirtyState = DirtyState::CpuDirty;
+                buffer->MarkCpuDirty(span<u8>{page, constant::PageSize});
                 return true;
             }
 
-            if (buffer->accumulatedGuestWaitTime > FastReadbackHackWaitTimeThreshold && *buffer->gpu.state.settings->enableFastGpuReadbackHack) {
+            if (buffer->dirtyState == DirtyState::GpuDirty && buffer->accumulatedGuestWaitTime > FastReadbackHackWaitTimeThreshold && *buffer->gpu.state.settings->enableFastGpuReadbackHack) {
                 // As opposed to skipping readback as we do for textures, with buffers we can still perform the readback but just without syncinc the GPU
                 // While the read data may be invalid it's still better than nothing and works in most cases
+                // Since only this page will be unprotected, the write is tracked so that subsequent writes to other pages don't repeat the readback and overwrite it
                 memcpy(buffer->mirror.data(), buffer->backing.data(), buffer->mirror.size());
-                buffer->dirtyState = DirtyState::Clean;
+                buffer->MarkCpuDirty(span<u8>{page, constant::PageSize});
                 return true;
             }
 
@@ -111,8 +148,8 @@ namespace skyline::gpu {
             if (buffer->cycle)
                 return false;
 
-            buffer->SynchronizeGuest(true); // We need to assume the buffer is dirty since we don't know what the guest is writing
-            buffer->dirtyState = DirtyState::CpuDirty;
+            buffer->SynchronizeGuest(true); // We need to assume the page is dirty since we don't know what the guest is writing
+            buffer->MarkCpuDirty(span<u8>{page, constant::PageSize});
 
             return true;
         });
@@ -203,6 +240,7 @@ namespace skyline::gpu {
 
         TRACE_EVENT("gpu", "Buffer::SynchronizeHost");
 
+        std::vector<u64> dirtyPages;
         {
             std::scoped_lock lock{stateMutex};
             if (dirtyState != DirtyState::CpuDirty)
@@ -213,11 +251,37 @@ namespace skyline::gpu {
 
             AdvanceSequence(); // We are modifying GPU backing contents so advance to the next sequence
 
+            // The dirty pages are consumed prior to trapping, any pages modified during the copy will be marked as dirty again by the trap
+            dirtyPages.resize(cpuDirtyPages.size());
+            std::swap(dirtyPages, cpuDirtyPages);
+
             if (!skipTrap)
                 gpu.state.nce->TrapRegions(*trapHandle, true); // Trap any future CPU writes to this buffer, must be done before the memcpy so that any modifications during the copy are tracked
         }
 
-        std::memcpy(backing.data(), mirror.data(), mirror.size());
+        // Copy every contiguous run of dirty pages from the mirror into the backing, the mirror doesn't necessarily start or end on a page boundary so runs are clamped to it
+        size_t mirrorPageOffset{static_cast<size_t>(mirror.data() - alignedMirror.data())};
+        size_t pageCount{alignedMirror.size() >> constant::PageSizeBits};
+        size_t uploadedBytes{};
+        for (size_t page{}; page < pageCount;) {
+            if (!(dirtyPages[page / 64] & (1ULL << (page % 64)))) {
+                page++;
+                continue;
+            }
+
+            size_t runStart{page};
+            while (page < pageCount && dirtyPages[page / 64] & (1ULL << (page % 64)))
+                page++;
+
+            size_t copyStart{std::max(runStart << constant::PageSizeBits, mirrorPageOffset) - mirrorPageOffset};
+            size_t copyEnd{std::min(page << constant::PageSizeBits, mirrorPageOffset + mirror.size()) - mirrorPageOffset};
+            std::memcpy(backing.data() + copyStart, mirror.data() + copyStart, copyEnd - copyStart);
+            GetPerformanceStatistics().bufferSyncBytes.fetch_add(copyEnd - copyStart, std::memory_order_relaxed);
+            uploadedBytes += copyEnd - copyStart;
+        }
+
+        if (uploadedBytes)
+            gpu.syncTraffic.Record(SyncTrafficSource::BufferUpload, uploadedBytes);
     }
 
     bool Buffer::SynchronizeGuest(bool skipTrap, bool nonBlocking) {
@@ -237,6 +301,8 @@ namespace skyline::gpu {
 
             WaitOnFence();
             std::memcpy(mirror.data(), backing.data(), mirror.size());
+            GetPerformanceStatistics().bufferSyncBytes.fetch_add(mirror.size(), std::memory_order_relaxed);
+            gpu.syncTraffic.Record(SyncTrafficSource::BufferReadback, mirror.size());
 
             dirtyState = DirtyState::Clean;
         }
@@ -283,9 +349,11 @@ namespace skyline::gpu {
 
         std::memcpy(mirror.data() + offset, data.data(), data.size()); // Always copy to mirror since any CPU side reads will need the up-to-date contents
 
-        if (dirtyState == DirtyState::CpuDirty && !SequencedCpuBackingWritesBlocked())
+        if (dirtyState == DirtyState::CpuDirty && !SequencedCpuBackingWritesBlocked()) {
             // Skip updating backing if the changes are gonna be updated later by SynchroniseHost in executor anyway
+            MarkCpuDirty(guest->subspan(offset, data.size()));
             return false;
+        }
 
         if (!SequencedCpuBackingWritesBlocked() && PollFence()) {
             // We can write directly to the backing as long as this resource isn't being actively used by a past workload (in the current context or another)
@@ -315,9 +383,11 @@ namespace skyline::gpu {
         if (dirtyState != DirtyState::GpuDirty && src->dirtyState != DirtyState::GpuDirty) {
             std::memcpy(mirror.data() + dstOffset, src->mirror.data() + srcOffset, size);
 
-            if (dirtyState == DirtyState::CpuDirty && !SequencedCpuBackingWritesBlocked())
+            if (dirtyState == DirtyState::CpuDirty && !SequencedCpuBackingWritesBlocked()) {
                 // Skip updating backing if the changes are gonna be updated later by SynchroniseHost in executor anyway
+                MarkCpuDirty(guest->subspan(dstOffset, size));
                 return;
+            }
 
             if (!SequencedCpuBackingWritesBlocked() && PollFence()) {
                 // We can write directly to the backing as long as this resource isn't being actively used by a past workload (in the current context or another)
@@ -343,9 +413,9 @@ namespace skyline::gpu {
             return {};
     }
 
-    BufferBinding Buffer::TryMegaBufferView(const std::shared_ptr<FenceCycle> &pCycle, MegaBufferAllocator &allocator, u32 executionNumber,
+    BufferBinding Buffer::TryMegaBufferView(const IntrusivePtr<FenceCycle> &pCycle, MegaBufferAllocator &allocator, u32 executionNumber,
                                             vk::DeviceSize offset, vk::DeviceSize size) {
-        if ((!everHadInlineUpdate && sequenceNumber < FrequentlySyncedThreshold) || size >= MegaBufferChunkSize)
+        if ((!everHadInlineUpdate && sequenceNumber < FrequentlySyncedThreshold) || size >= MegaBufferMaxAllocationSize)
             // Don't megabuffer buffers that have never had inline updates and are not frequently synced since performance is only going to be harmed as a result of the constant copying and there wont be any benefit since there are no GPU inline updates that would be avoided
             return {};
 
@@ -354,6 +424,10 @@ namespace skyline::gpu {
             // Bail out if buffer cannot be synced, we don't know the contents ahead of time so the sequence is indeterminate
             return {};
 
+        if (!everHadInlineUpdate && TryBindInPlace())
+            // Buffers that are only written by the guest CPU are used in place when possible, rather than the view being copied into the megabuffer for every context they are used in
+            return {};
+
         // If the active execution has changed all previous allocations are now invalid
         if (executionNumber != lastExecutionNumber) [[unlikely]] {
             ResetMegabufferState();
@@ -361,7 +435,7 @@ namespace skyline::gpu {
         }
 
         // If more than half the buffer has been megabuffered in chunks within the same execution assume this will generally be the case for this buffer and just megabuffer the whole thing without chunking
-        if (unifiedMegaBufferEnabled || (megaBufferViewAccumulatedSize > (backing.size() / 2) && backing.size() < MegaBufferChunkSize)) {
+        if (unifiedMegaBufferEnabled || (megaBufferViewAccumulatedSize > (backing.size() / 2) && backing.size() < MegaBufferMaxAllocationSize)) {
             if (!unifiedMegaBuffer) {
                 unifiedMegaBuffer = allocator.Push(pCycle, mirror, true);
                 unifiedMegaBufferEnabled = true;
@@ -489,7 +563,7 @@ namespace skyline::gpu {
         return GetBuffer()->Write(data, writeOffset + GetOffset(), gpuCopyCallback);
     }
 
-    BufferBinding BufferView::TryMegaBuffer(const std::shared_ptr<FenceCycle> &pCycle, MegaBufferAllocator &allocator, u32 executionNumber, size_t sizeOverride) const {
+    BufferBinding BufferView::TryMegaBuffer(const IntrusivePtr<FenceCycle> &pCycle, MegaBufferAllocator &allocator, u32 executionNumber, size_t sizeOverride) const {
         return GetBuffer()->TryMegaBufferView(pCycle, allocator, executionNumber, GetOffset(), sizeOverride ? sizeOverride : size);
     }
 
@@ -34,6 +34,8 @@ namespace skyline::gpu {
         operator bool() const {
             return buffer;
         }
+
+        bool operator==(const BufferBinding &) const = default;
     };
 
     /**
@@ -47,7 +49,7 @@ namespace skyline::gpu {
         std::atomic<ContextTag> tag{}; //!< The tag associated with the last lock call
         memory::Buffer backing;
         std::optional<GuestBuffer> guest;
-        std::shared_ptr<FenceCycle> cycle{}; //!< A fence cycle for when any host operation mutating the buffer has completed, it must be waited on prior to any mutations to the backing
+        IntrusivePtr<FenceCycle> cycle{}; //!< A fence cycle for when any host operation mutating the buffer has completed, it must be waited on prior to any mutations to the backing
         size_t id;
 
         span<u8> mirror{}; //!< A contiguous mirror of all the guest mappings to allow linear access on the CPU
@@ -59,6 +61,7 @@ namespace skyline::gpu {
             CpuDirty, //!< The CPU mappings have been modified but the GPU buffer is not up to date
             GpuDirty, //!< The GPU buffer has been modified but the CPU mappings have not been updated
         } dirtyState{DirtyState::CpuDirty}; //!< The state of the CPU mappings with respect to the GPU buffer
+        std::vector<u64> cpuDirtyPages; //!< A bitmap of all guest pages that have been modified on the CPU since the last SynchronizeHost, only pages which are set are uploaded when the buffer is CpuDirty
 
         enum class BackingImmutability {
             None, //!< Backing can be freely written to and read from
@@ -81,9 +84,13 @@ namespace skyline::gpu {
         bool megaBufferTableUsed{}; //!< If the megabuffer table has been used at all since the last time it was cleared
         bool unifiedMegaBufferEnabled{}; //!< If the unified megabuffer is enabled for this buffer and should be used instead of the table
         bool everHadInlineUpdate{}; //!< Whether the buffer has ever had an inline update since it was created, if this is set then megabuffering will be attempted by views to avoid the cost of inline GPU updates
+        bool boundInPlace{}; //!< If the backing is bound directly instead of a megabuffer copy in the current context, all CPU writes to the backing are blocked while this is set so draws recorded prior to a guest write can't observe it
+        bool everHadInPlaceWriteConflict{}; //!< Whether a guest write was ever blocked due to the buffer being bound in place, such buffers are always megabuffered from then on to avoid repeatedly stalling the guest
 
         u32 lastExecutionNumber{}; //!< The execution number of the last time megabuffer data was updated
 
+        u32 recreationCount{}; //!< The amount of times the guest region of this buffer has been recreated due to coalescing, this is inherited by the buffer it's coalesced into
+
         size_t megaBufferViewAccumulatedSize{};
         MegaBufferAllocator::Allocation unifiedMegaBuffer{}; //!< An optional full-size mirror of the buffer in the megabuffer for use when the buffer is frequently updated and *all* of the buffer is frequently used. Replaces all uses of the table when active
 
@@ -100,6 +107,19 @@ namespace skyline::gpu {
          */
         void ResetMegabufferState();
 
+        /**
+         * @brief Marks all guest pages overlapping the supplied range as modified on the CPU and transitions the buffer to being CpuDirty
+         * @note The state mutex **must** be locked prior to calling this
+         */
+        void MarkCpuDirty(span<u8> guestRange);
+
+        /**
+         * @brief Attempts to bind the backing directly for the rest of the current context rather than copying views of it into the megabuffer, this uploads any pending guest writes and blocks all further CPU writes to the backing until the context ends
+         * @return If the backing can be bound in place
+         * @note The buffer **must** be locked prior to calling this
+         */
+        bool TryBindInPlace();
+
       private:
         BufferDelegate *delegate;
 
@@ -112,7 +132,7 @@ namespace skyline::gpu {
         void SetupGuestMappings();
 
       public:
-        void UpdateCycle(const std::shared_ptr<FenceCycle> &newCycle) {
+        void UpdateCycle(const IntrusivePtr<FenceCycle> &newCycle) {
             newCycle->ChainCycle(cycle);
             cycle = newCycle;
         }
@@ -121,6 +141,13 @@ namespace skyline::gpu {
             return backing.vkBuffer;
         }
 
+        /**
+         * @return The guest mapping of this buffer, this is empty for host-only buffers
+         */
+        const std::optional<GuestBuffer> &GetGuest() const {
+            return guest;
+        }
+
         /**
          * @return A span over the backing of this buffer
          * @note This operation **must** be performed only on host-only buffers since synchronization is handled internally for guest-backed buffers
@@ -200,6 +227,7 @@ namespace skyline::gpu {
         void AllowAllBackingWrites() {
             std::scoped_lock lock{stateMutex};
             backingImmutability = BackingImmutability::None;
+            boundInPlace = false;
         }
 
         /**
@@ -220,6 +248,39 @@ namespace skyline::gpu {
             return backingImmutability == BackingImmutability::AllWrites;
         }
 
+        /**
+         * @return An ID that is unique to this buffer, unlike the address of the buffer this is never reused after the buffer is destroyed
+         */
+        size_t GetId() const {
+            return id;
+        }
+
+        /**
+         * @return The current sequence number of the buffer, this is only meaningful while the buffer isn't GPU dirty as the GPU can modify the backing without advancing it
+         * @note The buffer **must** be locked prior to calling this
+         */
+        u32 GetSequenceNumber() const {
+            return sequenceNumber;
+        }
+
+        /**
+         * @return If the backing has been written to on the GPU and the guest mirror hasn't been synchronized with it yet
+         * @note The buffer **must** be locked prior to calling this
+         */
+        bool IsGpuDirty() {
+            std::scoped_lock lock{stateMutex};
+            return dirtyState == DirtyState::GpuDirty;
+        }
+
+        /**
+         * @return If the guest mirror and the backing are in sync, any subsequent CPU or GPU write to the buffer will transition it out of this state
+         * @note The buffer **must** be locked prior to calling this
+         */
+        bool IsClean() {
+            std::scoped_lock lock{stateMutex};
+            return dirtyState == DirtyState::Clean;
+        }
+
         /**
          * @return If the cycle needs to be attached to the buffer before ending the current context
          * @note This is an alias for `SequencedCpuBackingWritesBlocked()` since this is only ever set when the backing is accessed on the GPU in some form
@@ -314,10 +375,10 @@ namespace skyline::gpu {
 
         /*
          * @brief If megabuffering is determined to be beneficial for this buffer, allocates and copies the given view of buffer into the megabuffer (in case of cache miss), returning a binding of the allocated megabuffer region
-         * @return A binding to the megabuffer allocation for the view, may be invalid if megabuffering is not beneficial
+         * @return A binding to the megabuffer allocation for the view, may be invalid if megabuffering is not beneficial or the buffer was bound in place instead (see TryBindInPlace)
          * @note The buffer **must** be locked prior to calling this
          */
-        BufferBinding TryMegaBufferView(const std::shared_ptr<FenceCycle> &pCycle, MegaBufferAllocator &allocator, u32 executionNumber,
+        BufferBinding TryMegaBufferView(const IntrusivePtr<FenceCycle> &pCycle, MegaBufferAllocator &allocator, u32 executionNumber,
                                         vk::DeviceSize offset, vk::DeviceSize size);
 
         /**
@@ -451,7 +512,7 @@ namespace skyline::gpu {
          * @note The view **must** be locked prior to calling this
          * @note See Buffer::TryMegaBufferView
          */
-        BufferBinding TryMegaBuffer(const std::shared_ptr<FenceCycle> &pCycle, MegaBufferAllocator &allocator, u32 executionNumber, size_t sizeOverride = 0) const;
+        BufferBinding TryMegaBuffer(const IntrusivePtr<FenceCycle> &pCycle, MegaBufferAllocator &allocator, u32 executionNumber, size_t sizeOverride = 0) const;
 
         /**
          * @return A span of the backing buffer contents
@@ -470,5 +531,10 @@ namespace skyline::gpu {
         constexpr operator bool() {
             return delegate != nullptr;
         }
+
+        /**
+         * @note Views are only equal if they share a delegate, as delegates are resolved on their usage this guarantees that both views resolve to the same buffer and offset when used at the same point in time
+         */
+        bool operator==(const BufferView &) const = default;
     };
 }
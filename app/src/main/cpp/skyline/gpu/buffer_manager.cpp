@@ -2,11 +2,26 @@
 // Copyright © 2021 Skyline Team and Contributors (https://github.com/skyline-emu/)
 
 #include <gpu.h>
+#include <kernel/memory.h>
+#include <kernel/types/KProcess.h>
+#include <common/trace.h>
 #include "buffer_manager.h"
 
 namespace skyline::gpu {
     BufferManager::BufferManager(GPU &gpu) : gpu{gpu} {}
 
+    void BufferManager::lock() {
+        mutex.lock();
+    }
+
+    void BufferManager::unlock() {
+        mutex.unlock();
+    }
+
+    bool BufferManager::try_lock() {
+        return mutex.try_lock();
+    }
+
     bool BufferManager::BufferLessThan(const std::shared_ptr<Buffer> &it, u8 *pointer) {
         return it->guest->begin().base() < pointer;
     }
@@ -42,17 +57,115 @@ namespace skyline::gpu {
 
     void BufferManager::InsertBuffer(std::shared_ptr<Buffer> buffer) {
         auto bufferStart{buffer->guest->begin().base()}, bufferEnd{buffer->guest->end().base()};
-        bufferTable.Set(bufferStart, bufferEnd, buffer.get());
+        SetBufferTable(bufferStart, bufferEnd, buffer.get());
+        liveBufferBytes += buffer->guest->size();
         bufferMappings.insert(std::lower_bound(bufferMappings.begin(), bufferMappings.end(), bufferEnd, BufferLessThan), std::move(buffer));
+
+        TRACE_COUNTER("gpu", "Buffer Live Bytes", liveBufferBytes);
     }
 
     void BufferManager::DeleteBuffer(const std::shared_ptr<Buffer> &buffer) {
-        bufferTable.Set(buffer->guest->begin().base(), buffer->guest->end().base(), nullptr);
-        bufferMappings.erase(std::find(bufferMappings.begin(), bufferMappings.end(), buffer));
+        SetBufferTable(buffer->guest->begin().base(), buffer->guest->end().base(), nullptr);
+        liveBufferBytes -= buffer->guest->size();
+
+        // The buffer may still be accessed by lock-free lookups that started prior to it being removed from the table, so it's retired rather than destroyed
+        auto mapping{std::find(bufferMappings.begin(), bufferMappings.end(), buffer)};
+        ReclaimRetiredBuffers();
+        retiredBuffers.emplace_back(globalEpoch.fetch_add(1), std::move(*mapping));
+        bufferMappings.erase(mapping);
+
+        TRACE_COUNTER("gpu", "Buffer Live Bytes", liveBufferBytes);
+    }
+
+    void BufferManager::SetBufferTable(u8 *start, u8 *end, Buffer *buffer) {
+        bufferTableVersion.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        bufferTable.Set(start, end, buffer);
+        bufferTableVersion.fetch_add(1, std::memory_order_release);
+    }
+
+    void BufferManager::ReclaimRetiredBuffers() {
+        if (retiredBuffers.empty())
+            return;
+
+        u64 oldestEpoch{std::numeric_limits<u64>::max()};
+        for (const auto &epoch : readerEpochs)
+            if (u64 readerEpoch{epoch.load()}; readerEpoch)
+                oldestEpoch = std::min(oldestEpoch, readerEpoch);
+
+        // Any lookups that started in an epoch after a buffer was retired cannot have observed it in the table
+        std::erase_if(retiredBuffers, [oldestEpoch](const auto &retired) { return retired.first < oldestEpoch; });
+    }
+
+    BufferManager::ReaderSlot::ReaderSlot() {
+        u32 mask{readerSlotMask.load(std::memory_order_relaxed)};
+        while (mask != std::numeric_limits<u32>::max()) {
+            auto freeIndex{static_cast<size_t>(std::countr_one(mask))};
+            if (readerSlotMask.compare_exchange_weak(mask, mask | (1U << freeIndex), std::memory_order_acquire, std::memory_order_relaxed)) {
+                index = freeIndex;
+                break;
+            }
+        }
+    }
+
+    BufferManager::ReaderSlot::~ReaderSlot() {
+        // Lookups always clear their epoch prior to returning, so the slot is idle in every manager by the time the thread exits
+        if (index < ReaderSlotCount)
+            readerSlotMask.fetch_and(~(1U << index), std::memory_order_release);
+    }
+
+    BufferView BufferManager::TryFindView(GuestBuffer guestMapping) {
+        static thread_local ReaderSlot readerSlot;
+        if (readerSlot.index >= ReaderSlotCount) [[unlikely]]
+            return {};
+
+        // Announce the epoch this lookup started in, this must be visible before the table is read so that any buffer observed in the table can't be destroyed during the lookup
+        auto &readerEpoch{readerEpochs[readerSlot.index]};
+        readerEpoch.store(globalEpoch.load());
+
+        Buffer *buffer;
+        std::optional<GuestBuffer> bufferGuest;
+        u32 version;
+        do {
+            version = bufferTableVersion.load(std::memory_order_acquire);
+            buffer = bufferTable[guestMapping.begin().base()];
+            if (buffer)
+                bufferGuest = buffer->guest; // Buffers are only invalidated after being removed from the table, the version check will catch any such cases
+            std::atomic_thread_fence(std::memory_order_acquire);
+        } while ((version & 1) || bufferTableVersion.load(std::memory_order_relaxed) != version);
+
+        BufferView view{};
+        if (buffer && bufferGuest && bufferGuest->contains(guestMapping))
+            view = buffer->GetView(static_cast<vk::DeviceSize>(guestMapping.begin() - bufferGuest->begin()), guestMapping.size());
+
+        readerEpoch.store(0, std::memory_order_release);
+        return view;
+    }
+
+    u8 *BufferManager::GetCoalesceEnd(u8 *end, size_t size, u32 recreationCount) {
+        if (recreationCount < CoalesceHeadroomThreshold)
+            return end;
+
+        // The headroom doubles for every recreation past the threshold, regions that keep on thrashing will quickly be covered by a single buffer
+        size_t headroom{std::min(util::AlignUp(size / 4, constant::PageSize) << std::min(recreationCount - CoalesceHeadroomThreshold, 3U), MaxCoalesceHeadroom)};
+        u8 *headroomEnd{end + headroom};
+
+        // Headroom must be backed by mapped guest memory, we avoid crossing into any other chunk as its mapping may change independently of this one
+        auto chunk{gpu.state.process->memory.Get(end - 1)};
+        if (!chunk || chunk->state == memory::states::Unmapped)
+            return end;
+        headroomEnd = std::min(headroomEnd, chunk->ptr + chunk->size);
+
+        // Extending into another buffer would require coalescing it as well, this is avoided so that unrelated buffers don't get merged
+        auto nextBuffer{std::lower_bound(bufferMappings.begin(), bufferMappings.end(), end, BufferLessThan)};
+        if (nextBuffer != bufferMappings.end())
+            headroomEnd = std::min(headroomEnd, (*nextBuffer)->guest->begin().base());
+
+        return std::max(util::AlignDown(headroomEnd, constant::PageSize), end);
     }
 
     BufferManager::LockedBuffer BufferManager::CoalesceBuffers(span<u8> range, const LockedBuffers &srcBuffers, ContextTag tag) {
-        std::shared_ptr<FenceCycle> newBufferCycle{};
+        IntrusivePtr<FenceCycle> newBufferCycle{};
         for (auto &srcBuffer : srcBuffers) {
             // Wait on all source buffers before we lock the recreation mutex as locking it may prevent submissions of the cycles and introduce a deadlock
             // We can't chain cycles here as that may also introduce a deadlock since we have no way to determine what order to chain them in right now
@@ -67,6 +180,8 @@ namespace skyline::gpu {
             range = span<u8>{srcBuffers.front().buffer->guest->begin(), srcBuffers.back().buffer->guest->end()};
 
         auto lowestAddress{range.begin().base()}, highestAddress{range.end().base()};
+        u32 recreationCount{};
+        size_t srcBufferBytes{};
         for (const auto &srcBuffer : srcBuffers) {
             // Find the extents of the new buffer we want to create that can hold all overlapping buffers
             auto mapping{*srcBuffer->guest};
@@ -74,10 +189,22 @@ namespace skyline::gpu {
                 lowestAddress = mapping.begin().base();
             if (mapping.end().base() > highestAddress)
                 highestAddress = mapping.end().base();
+
+            recreationCount = std::max(recreationCount, srcBuffer->recreationCount);
+            srcBufferBytes += mapping.size();
         }
 
+        recreationCount++;
+        highestAddress = GetCoalesceEnd(highestAddress, static_cast<size_t>(highestAddress - lowestAddress), recreationCount);
+
+        coalesceCount++;
+        recreatedBytes += srcBufferBytes;
+        TRACE_COUNTER("gpu", "Buffer Coalesces", coalesceCount);
+        TRACE_COUNTER("gpu", "Buffer Recreated Bytes", recreatedBytes);
+
         LockedBuffer newBuffer{std::make_shared<Buffer>(delegateAllocatorState, gpu, span<u8>{lowestAddress, highestAddress}, nextBufferId++), tag}; // If we don't lock the buffer prior to trapping it during synchronization, a race could occur with a guest trap acquiring the lock before we do and mutating the buffer prior to it being ready
 
+        newBuffer->recreationCount = recreationCount;
         newBuffer->SetupGuestMappings();
         newBuffer->SynchronizeHost(false); // Overlaps don't necessarily fully cover the buffer so we have to perform a sync here to prevent any gaps
         newBuffer->cycle = newBufferCycle;
@@ -102,6 +229,8 @@ namespace skyline::gpu {
                 newBuffer->backingImmutability = Buffer::BackingImmutability::AllWrites;
 
             newBuffer->everHadInlineUpdate |= srcBuffer->everHadInlineUpdate;
+            newBuffer->boundInPlace |= srcBuffer->boundInPlace;
+            newBuffer->everHadInPlaceWriteConflict |= srcBuffer->everHadInPlaceWriteConflict;
 
             if (srcBuffer->dirtyState == Buffer::DirtyState::GpuDirty) {
                 if (srcBuffer.lock.IsFirstUsage() && newBuffer->dirtyState != Buffer::DirtyState::GpuDirty)
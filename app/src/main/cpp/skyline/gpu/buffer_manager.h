@@ -19,8 +19,36 @@ namespace skyline::gpu {
         LinearAllocatorState<> delegateAllocatorState; //!< Linear allocator used to allocate buffer delegates
         size_t nextBufferId{}; //!< The next unique buffer id to be assigned
 
+        std::mutex mutex; //!< Synchronizes all mutations of the buffer mappings and table, lookups into the table are lock-free and don't require this
+
         static constexpr size_t L2EntryGranularity{19}; //!< The amount of AS (in bytes) a single L2 PTE covers (512 KiB == 1 << 19)
-        SegmentTable<Buffer *, constant::AddressSpaceSize, constant::PageSizeBits, L2EntryGranularity> bufferTable; //!< A page table of all buffer mappings for O(1) lookups on full matches
+        ConcurrentSegmentTable<Buffer *, constant::AddressSpaceSize, constant::PageSizeBits, L2EntryGranularity> bufferTable; //!< A page table of all buffer mappings for O(1) lookups on full matches, this can be read without holding `mutex`
+        std::atomic<u32> bufferTableVersion{}; //!< A sequence counter for the buffer table which is odd while it's being modified, lock-free lookups retry if it changes during the lookup
+
+        static constexpr size_t ReaderSlotCount{32}; //!< The maximum amount of threads that can perform lock-free lookups, any threads beyond this will fall back to locking
+        std::array<std::atomic<u64>, ReaderSlotCount> readerEpochs{}; //!< The epoch each thread observed when starting a lock-free lookup or 0 if it isn't doing one
+        std::atomic<u64> globalEpoch{1}; //!< The current epoch, this is advanced whenever a buffer is retired
+        std::vector<std::pair<u64, std::shared_ptr<Buffer>>> retiredBuffers; //!< Buffers that have been removed from the table alongside the epoch they were retired in, they are kept alive until no lock-free lookup could still be accessing them
+        static inline std::atomic<u32> readerSlotMask{}; //!< A bitmask of the reader slots currently owned by a thread
+        static_assert(ReaderSlotCount == std::numeric_limits<u32>::digits);
+
+        /**
+         * @brief An RAII owner of a reader slot for a single thread, it's held in thread-local storage so the slot is released for reuse when the thread exits
+         */
+        struct ReaderSlot {
+            size_t index{ReaderSlotCount}; //!< The index of the owned slot, this is ReaderSlotCount if all slots were owned by other threads
+
+            ReaderSlot();
+
+            ~ReaderSlot();
+        };
+
+        static constexpr u32 CoalesceHeadroomThreshold{2}; //!< The amount of times a region must have been recreated before headroom is added to it, this avoids inflating buffers that are only coalesced once
+        static constexpr size_t MaxCoalesceHeadroom{16 * 1024 * 1024}; //!< The maximum amount of headroom (in bytes) that will be added past the end of a coalesced buffer (16MiB)
+
+        size_t coalesceCount{}; //!< The total amount of times buffers have been coalesced
+        size_t recreatedBytes{}; //!< The total size of all source buffers which have been recreated due to coalescing
+        size_t liveBufferBytes{}; //!< The combined size of all buffers currently in the map
 
         /**
          * @brief A wrapper around a Buffer which locks it with the specified ContextTag
@@ -51,11 +79,33 @@ namespace skyline::gpu {
         void InsertBuffer(std::shared_ptr<Buffer> buffer);
 
         /**
-         * @brief Deletes the supplied buffer from the map, the lifetime of the buffer will no longer be extended by the map
+         * @brief Deletes the supplied buffer from the map, the lifetime of the buffer will no longer be extended by the map after all concurrent lock-free lookups have completed
          * @note The supplied buffer **must** have a valid guest mapping
          */
         void DeleteBuffer(const std::shared_ptr<Buffer> &buffer);
 
+        /**
+         * @brief Sets the buffer table entries for the supplied range while bumping the table version so that concurrent lock-free lookups are retried
+         */
+        void SetBufferTable(u8 *start, u8 *end, Buffer *buffer);
+
+        /**
+         * @brief Destroys all retired buffers which cannot be accessed by any in-flight lock-free lookups
+         */
+        void ReclaimRetiredBuffers();
+
+        /**
+         * @brief Looks up a view for the supplied mapping in the buffer table without locking the buffer manager
+         * @return A view into a buffer which fully contains the mapping or an empty view if there's no such buffer or the lookup couldn't be done lock-free
+         */
+        BufferView TryFindView(GuestBuffer guestMapping);
+
+        /**
+         * @return The end address of a coalesced buffer ending at the supplied address after headroom has been added to it, the headroom is limited to the containing guest memory chunk and will not overlap any other buffer
+         * @note Streaming heaps are commonly accessed in an ascending manner with each access slightly past the previous, headroom allows these to be served by a single buffer rather than recreating it on every access
+         */
+        u8 *GetCoalesceEnd(u8 *end, size_t size, u32 recreationCount);
+
         /**
          * @brief Coalesce the supplied buffers into a single buffer encompassing the specified range and locks it with the supplied tag
          * @param range The range of memory that the newly created buffer will cover, this will be extended to cover the entirety of the supplied buffers automatically and can be null
@@ -98,12 +148,15 @@ namespace skyline::gpu {
          */
         BufferView FindOrCreateImpl(GuestBuffer guestMapping, ContextTag tag, const std::function<void(std::shared_ptr<Buffer>, ContextLock<Buffer> &&)> &attachBuffer);
 
+        /**
+         * @return A pre-existing or newly created Buffer object which covers the supplied mappings
+         * @note Lookups of pre-existing buffers are lock-free, the buffer manager is only locked when a buffer needs to be created
+         */
         BufferView FindOrCreate(GuestBuffer guestMapping, ContextTag tag = {}, const std::function<void(std::shared_ptr<Buffer>, ContextLock<Buffer> &&)> &attachBuffer = {}) {
-            auto lookupBuffer{bufferTable[guestMapping.begin().base()]};
-            if (lookupBuffer != nullptr)
-                if (auto view{lookupBuffer->TryGetView(guestMapping)}; view)
-                    return view;
+            if (auto view{TryFindView(guestMapping)}; view)
+                return view;
 
+            std::scoped_lock lock{*this};
             return FindOrCreateImpl(guestMapping, tag, attachBuffer);
         }
     };
@@ -10,10 +10,11 @@ namespace skyline::gpu::cache {
 
     FramebufferCache::FramebufferImagelessAttachment::FramebufferImagelessAttachment(const vk::FramebufferAttachmentImageInfo &info) : flags(info.flags), usage(info.usage), width(info.width), height(info.height), layers(info.layerCount), format(*info.pViewFormats) {}
 
-    FramebufferCache::FramebufferCacheKey::FramebufferCacheKey(const FramebufferCreateInfo &createInfo) {
+    FramebufferCache::FramebufferCacheKey::FramebufferCacheKey(const FramebufferLookup &lookup) {
+        auto &createInfo{lookup.createInfo};
         auto &info{createInfo.get<vk::FramebufferCreateInfo>()};
         flags = info.flags;
-        renderPass = info.renderPass;
+        renderPassCompatibilityId = lookup.renderPassCompatibilityId;
         width = info.width;
         height = info.height;
         layers = info.layers;
@@ -40,7 +41,7 @@ namespace skyline::gpu::cache {
         size_t hash{};
 
         HASH(static_cast<VkFramebufferCreateFlags>(key.flags));
-        HASH(static_cast<VkRenderPass>(key.renderPass));
+        HASH(key.renderPassCompatibilityId);
         HASH(key.width);
         HASH(key.height);
         HASH(key.layers);
@@ -67,19 +68,20 @@ namespace skyline::gpu::cache {
         return hash;
     }
 
-    size_t FramebufferCache::FramebufferHash::operator()(const FramebufferCreateInfo &key) const {
+    size_t FramebufferCache::FramebufferHash::operator()(const FramebufferLookup &key) const {
         size_t hash{};
 
-        auto &info{key.get<vk::FramebufferCreateInfo>()};
+        auto &info{key.createInfo.get<vk::FramebufferCreateInfo>()};
 
         HASH(static_cast<VkFramebufferCreateFlags>(info.flags));
-        HASH(static_cast<VkRenderPass>(info.renderPass));
+        HASH(key.renderPassCompatibilityId);
         HASH(info.width);
         HASH(info.height);
         HASH(info.layers);
 
         if (info.flags & vk::FramebufferCreateFlagBits::eImageless) {
-            auto &attachmentInfo{key.get<vk::FramebufferAttachmentsCreateInfo>()};
+            auto &attachmentInfo{key.createInfo.get<vk::FramebufferAttachmentsCreateInfo>()};
+            HASH(static_cast<size_t>(attachmentInfo.attachmentImageInfoCount)); // This must match the key hash for lookups to hit
             for (const vk::FramebufferAttachmentImageInfo &image : span<const vk::FramebufferAttachmentImageInfo>(attachmentInfo.pAttachmentImageInfos, attachmentInfo.attachmentImageInfoCount)) {
                 HASH(static_cast<VkImageCreateFlags>(image.flags));
                 HASH(static_cast<VkImageUsageFlags>(image.usage));
@@ -89,7 +91,7 @@ namespace skyline::gpu::cache {
                 HASH(*image.pViewFormats);
             }
         } else {
-            HASH(info.attachmentCount);
+            HASH(static_cast<size_t>(info.attachmentCount));
             for (const auto &view : span<const vk::ImageView>(info.pAttachments, info.attachmentCount))
                 HASH(static_cast<VkImageView>(view));
         }
@@ -103,13 +105,14 @@ namespace skyline::gpu::cache {
         return lhs == rhs;
     }
 
-    bool FramebufferCache::FramebufferEqual::operator()(const FramebufferCacheKey &lhs, const FramebufferCreateInfo &rhs) const {
+    bool FramebufferCache::FramebufferEqual::operator()(const FramebufferCacheKey &lhs, const FramebufferLookup &rhsLookup) const {
         #define RETF(condition) if (condition) { return false; }
 
+        auto &rhs{rhsLookup.createInfo};
         auto &rhsInfo{rhs.get<vk::FramebufferCreateInfo>()};
 
         RETF(lhs.flags != rhsInfo.flags)
-        RETF(lhs.renderPass != rhsInfo.renderPass)
+        RETF(lhs.renderPassCompatibilityId != rhsLookup.renderPassCompatibilityId)
         RETF(lhs.width != rhsInfo.width)
         RETF(lhs.height != rhsInfo.height)
         RETF(lhs.layers != rhsInfo.layers)
@@ -140,13 +143,35 @@ namespace skyline::gpu::cache {
         return true;
     }
 
-    vk::Framebuffer FramebufferCache::GetFramebuffer(const FramebufferCreateInfo &createInfo) {
+    vk::Framebuffer FramebufferCache::GetFramebuffer(const FramebufferCreateInfo &createInfo, u64 renderPassCompatibilityId, const IntrusivePtr<FenceCycle> &cycle) {
         std::scoped_lock lock{mutex};
-        auto it{framebufferCache.find(createInfo)};
-        if (it != framebufferCache.end())
-            return *it->second;
+        FramebufferLookup lookup{createInfo, renderPassCompatibilityId};
+        auto it{framebufferCache.find(lookup)};
+        if (it != framebufferCache.end()) {
+            auto &entry{it->second};
+            lru.splice(lru.begin(), lru, entry.lruIterator);
+            entry.cycle = cycle;
+            return *entry.framebuffer;
+        }
+
+        if (framebufferCache.size() >= MaxEntryCount) {
+            auto evictIt{framebufferCache.find(*lru.back())};
+            lru.pop_back();
+
+            // Destruction is deferred till the last cycle that used the framebuffer is signalled, this is immediate if it already has been
+            auto &evicted{evictIt->second};
+            if (evicted.cycle)
+                evicted.cycle->AttachObject(std::make_shared<vk::raii::Framebuffer>(std::move(evicted.framebuffer)));
+            framebufferCache.erase(evictIt);
+        }
+
+        auto entryIt{framebufferCache.try_emplace(FramebufferCacheKey{lookup}, FramebufferEntry{
+            .framebuffer = vk::raii::Framebuffer{gpu.vkDevice, createInfo.get<vk::FramebufferCreateInfo>()},
+            .cycle = cycle,
+        }).first};
 
-        auto entryIt{framebufferCache.try_emplace(FramebufferCacheKey{createInfo}, gpu.vkDevice, createInfo.get<vk::FramebufferCreateInfo>())};
-        return *entryIt.first->second;
+        lru.push_front(&entryIt->first);
+        entryIt->second.lruIterator = lru.begin();
+        return *entryIt->second.framebuffer;
     }
 }
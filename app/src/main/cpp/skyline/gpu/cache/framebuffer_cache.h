@@ -5,6 +5,7 @@
 
 #include <vulkan/vulkan_raii.hpp>
 #include <common.h>
+#include <gpu/fence_cycle.h>
 
 namespace skyline::gpu::cache {
     using FramebufferCreateInfo = vk::StructureChain<vk::FramebufferCreateInfo, vk::FramebufferAttachmentsCreateInfo>;
@@ -12,9 +13,12 @@ namespace skyline::gpu::cache {
     /**
      * @brief A cache for Vulkan framebuffers to avoid unnecessary recreation, optimized for both fixed image and imageless attachments
      * @note It is generally expensive to create a framebuffer on TBDRs since it involves calculating tiling memory allocations and in the case of Adreno's proprietary driver involves several kernel calls for mapping and allocating the corresponding framebuffer memory
+     * @note Framebuffers are keyed on the compatibility class of their render pass rather than its handle, so a single framebuffer is shared by all render passes that only differ in their load/store operations or layouts
      */
     class FramebufferCache {
       private:
+        static constexpr size_t MaxEntryCount{256}; //!< The maximum amount of framebuffers retained prior to the least recently used ones being evicted, this bounds the amount of framebuffers referencing image views which have since been destroyed
+
         GPU &gpu;
         std::mutex mutex; //!< Synchronizes access to the cache
 
@@ -36,15 +40,23 @@ namespace skyline::gpu::cache {
             bool operator==(const FramebufferImagelessAttachment &other) const = default;
         };
 
+        /**
+         * @brief The parameters of a framebuffer lookup, this avoids constructing a key for lookups that hit
+         */
+        struct FramebufferLookup {
+            const FramebufferCreateInfo &createInfo;
+            u64 renderPassCompatibilityId;
+        };
+
         struct FramebufferCacheKey {
             vk::FramebufferCreateFlags flags;
-            vk::RenderPass renderPass;
+            u64 renderPassCompatibilityId; //!< The compatibility ID of the render pass (RenderPassCache::CachedRenderPass::compatibilityId)
             u32 width;
             u32 height;
             u32 layers;
             std::variant<std::vector<vk::ImageView>, std::vector<FramebufferImagelessAttachment>> attachments;
 
-            FramebufferCacheKey(const FramebufferCreateInfo &createInfo);
+            FramebufferCacheKey(const FramebufferLookup &lookup);
 
             bool operator==(const FramebufferCacheKey &other) const = default;
         };
@@ -54,7 +66,7 @@ namespace skyline::gpu::cache {
 
             size_t operator()(const FramebufferCacheKey &key) const;
 
-            size_t operator()(const FramebufferCreateInfo &key) const;
+            size_t operator()(const FramebufferLookup &key) const;
         };
 
         struct FramebufferEqual {
@@ -62,10 +74,17 @@ namespace skyline::gpu::cache {
 
             bool operator()(const FramebufferCacheKey &lhs, const FramebufferCacheKey &rhs) const;
 
-            bool operator()(const FramebufferCacheKey &lhs, const FramebufferCreateInfo &rhs) const;
+            bool operator()(const FramebufferCacheKey &lhs, const FramebufferLookup &rhs) const;
+        };
+
+        struct FramebufferEntry {
+            vk::raii::Framebuffer framebuffer;
+            IntrusivePtr<FenceCycle> cycle; //!< The latest cycle that the framebuffer was used in, it must not be destroyed till this is signalled
+            std::list<const FramebufferCacheKey *>::iterator lruIterator;
         };
 
-        std::unordered_map<FramebufferCacheKey, vk::raii::Framebuffer, FramebufferHash, FramebufferEqual> framebufferCache;
+        std::unordered_map<FramebufferCacheKey, FramebufferEntry, FramebufferHash, FramebufferEqual> framebufferCache;
+        std::list<const FramebufferCacheKey *> lru; //!< The keys of all cached framebuffers ordered from most to least recently used
 
       public:
         FramebufferCache(GPU &gpu);
@@ -73,7 +92,9 @@ namespace skyline::gpu::cache {
         /**
          * @note When using imageless framebuffer attachments, VkFramebufferAttachmentImageInfo **must** have a single view format
          * @note When using image framebuffer attachments, it is expected that the supplied image handle will remain stable for the cache to function
+         * @param renderPassCompatibilityId The compatibility ID of the render pass in the create info
+         * @param cycle The cycle the framebuffer will be used in, the framebuffer is kept alive till it is signalled even if it's evicted prior to that
          */
-        vk::Framebuffer GetFramebuffer(const FramebufferCreateInfo &createInfo);
+        vk::Framebuffer GetFramebuffer(const FramebufferCreateInfo &createInfo, u64 renderPassCompatibilityId, const IntrusivePtr<FenceCycle> &cycle);
     };
 }
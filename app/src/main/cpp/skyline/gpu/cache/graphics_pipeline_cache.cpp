@@ -3,13 +3,102 @@
 
 #include <boost/functional/hash.hpp>
 #include <gpu.h>
+#include <common/trace.h>
+#include <common/performance_statistics.h>
 #include "graphics_pipeline_cache.h"
 
 namespace skyline::gpu::cache {
+    constexpr std::string_view DiskCacheFileName{"vulkan/pipeline_cache.bin"}; //!< The path of the file in the cache filesystem that holds the Vulkan pipeline cache
+
     GraphicsPipelineCache::GraphicsPipelineCache(GPU &gpu) : gpu(gpu), vkPipelineCache(gpu.vkDevice, vk::PipelineCacheCreateInfo{}) {}
 
+    GraphicsPipelineCache::~GraphicsPipelineCache() {
+        if (diskCacheThread.joinable())
+            diskCacheThread.join();
+
+        if (diskCacheFileSystem && diskCacheDirtyCount) {
+            try {
+                SerializeDiskCache();
+            } catch (const std::exception &e) {
+                Logger::Warn("Failed to serialize pipeline cache: {}", e.what());
+            }
+        }
+    }
+
+    void GraphicsPipelineCache::LoadDiskCache(std::shared_ptr<vfs::FileSystem> cacheFileSystem, std::string_view driverLabel) {
+        auto properties{gpu.vkPhysicalDevice.getProperties()};
+        diskCacheHeader.vendorId = properties.vendorID;
+        diskCacheHeader.deviceId = properties.deviceID;
+        diskCacheHeader.driverVersion = properties.driverVersion;
+        std::copy(properties.pipelineCacheUUID.begin(), properties.pipelineCacheUUID.end(), diskCacheHeader.pipelineCacheUuid.begin());
+        diskCacheHeader.driverLabelHash = XXH64(driverLabel.data(), driverLabel.size(), 0);
+
+        diskCacheFileSystem = std::move(cacheFileSystem);
+        if (!diskCacheFileSystem->FileExists(std::string{DiskCacheFileName}))
+            return;
+
+        try {
+            auto backing{diskCacheFileSystem->OpenFile(std::string{DiskCacheFileName})};
+            if (backing->size < sizeof(DiskCacheHeader))
+                throw exception("File is too small to contain a header: 0x{:X} bytes", backing->size);
+
+            auto header{backing->Read<DiskCacheHeader>()};
+            if (header.magic != DiskCacheHeader::Magic || header.version != DiskCacheHeader::Version) {
+                Logger::Info("Discarding pipeline cache with an unsupported format (Magic: 0x{:X}, Version: {})", header.magic, header.version);
+                return;
+            }
+
+            DiskCacheHeader expectedHeader{diskCacheHeader};
+            expectedHeader.dataSize = header.dataSize;
+            expectedHeader.dataHash = header.dataHash;
+            if (header != expectedHeader) {
+                Logger::Info("Discarding pipeline cache from a different driver (Vendor: 0x{:X}, Device: 0x{:X}, Driver Version: 0x{:X})", header.vendorId, header.deviceId, header.driverVersion);
+                return;
+            }
+
+            if (backing->size - sizeof(DiskCacheHeader) < header.dataSize)
+                throw exception("File is truncated: 0x{:X}/0x{:X} bytes", backing->size - sizeof(DiskCacheHeader), header.dataSize);
+
+            std::vector<u8> data(header.dataSize);
+            backing->Read(span{data}, sizeof(DiskCacheHeader));
+            if (XXH64(data.data(), data.size(), 0) != header.dataHash)
+                throw exception("Data hash mismatch");
+
+            vk::raii::PipelineCache diskPipelineCache{gpu.vkDevice, vk::PipelineCacheCreateInfo{
+                .initialDataSize = data.size(),
+                .pInitialData = data.data(),
+            }};
+
+            std::scoped_lock lock{mutex};
+            vkPipelineCache.merge(*diskPipelineCache);
+            Logger::Info("Loaded pipeline cache with 0x{:X} bytes of data", data.size());
+        } catch (const std::exception &e) {
+            Logger::Warn("Discarding invalid pipeline cache: {}", e.what());
+        }
+    }
+
+    void GraphicsPipelineCache::SerializeDiskCache() {
+        auto data{vkPipelineCache.getData()};
+
+        DiskCacheHeader header{diskCacheHeader};
+        header.dataSize = data.size();
+        header.dataHash = XXH64(data.data(), data.size(), 0);
+
+        // The file is resized prior to writing out the data, a partially written file will be rejected on load due to the hash mismatch
+        std::string fileName{DiskCacheFileName};
+        if (!diskCacheFileSystem->FileExists(fileName) && !diskCacheFileSystem->CreateFile(fileName, 0))
+            throw exception("Failed to create pipeline cache file");
+
+        auto backing{diskCacheFileSystem->OpenFile(fileName, {true, true, false})};
+        backing->Resize(sizeof(DiskCacheHeader) + data.size());
+        backing->Write(span<DiskCacheHeader>{header}.cast<u8>());
+        backing->Write(span{data}, sizeof(DiskCacheHeader));
+    }
+
     #define VEC_CPY(pointer, size) state.pointer, state.pointer + state.size
 
+    GraphicsPipelineCache::AttachmentMetadata::AttachmentMetadata(TextureView *view) : format{view ? view->format->vkFormat : vk::Format::eUndefined}, sampleCount{view ? view->texture->sampleCount : vk::SampleCountFlagBits::e1} {}
+
     GraphicsPipelineCache::PipelineCacheKey::PipelineCacheKey(const GraphicsPipelineCache::PipelineState &state)
         : shaderStages(state.shaderStages.begin(), state.shaderStages.end()),
           vertexState(state.vertexState),
@@ -25,7 +114,9 @@ namespace skyline::gpu::cache {
           multisampleState(state.multisampleState),
           depthStencilState(state.depthStencilState),
           colorBlendState(state.colorBlendState),
-          colorBlendAttachments(VEC_CPY(colorBlendState.pAttachments, colorBlendState.attachmentCount)) {
+          colorBlendAttachments(VEC_CPY(colorBlendState.pAttachments, colorBlendState.attachmentCount)),
+          colorAttachments(state.colorAttachments.begin(), state.colorAttachments.end()),
+          depthStencilAttachment(state.depthStencilAttachment) {
         auto &vertexInputState{vertexState.get<vk::PipelineVertexInputStateCreateInfo>()};
         vertexInputState.pVertexBindingDescriptions = vertexBindings.data();
         vertexInputState.pVertexAttributeDescriptions = vertexAttributes.data();
@@ -36,15 +127,6 @@ namespace skyline::gpu::cache {
 
         colorBlendState.pAttachments = colorBlendAttachments.data();
 
-        for (auto &colorAttachment : state.colorAttachments) {
-            if (colorAttachment)
-                colorAttachments.emplace_back(AttachmentMetadata{colorAttachment->format->vkFormat, colorAttachment->texture->sampleCount});
-            else
-                colorAttachments.emplace_back(AttachmentMetadata{vk::Format::eUndefined, vk::SampleCountFlagBits::e1});
-        }
-
-        if (state.depthStencilAttachment)
-            depthStencilAttachment.emplace(AttachmentMetadata{state.depthStencilAttachment->format->vkFormat, state.depthStencilAttachment->texture->sampleCount});
     }
 
     #undef VEC_CPY
@@ -168,32 +250,6 @@ namespace skyline::gpu::cache {
             HASH(static_cast<VkBlendFactor>(attachment.srcColorBlendFactor));
         }
 
-        return hash;
-    }
-
-    size_t GraphicsPipelineCache::PipelineStateHash::operator()(const GraphicsPipelineCache::PipelineState &key) const {
-        size_t hash{HashCommonPipelineState(key)};
-
-        HASH(key.colorAttachments.size());
-        for (const auto &attachment : key.colorAttachments) {
-            if (attachment) {
-                HASH(attachment->format->vkFormat);
-                HASH(attachment->texture->sampleCount);
-            }
-        }
-
-        HASH(key.depthStencilAttachment != nullptr);
-        if (key.depthStencilAttachment != nullptr) {
-            HASH(key.depthStencilAttachment->format->vkFormat);
-            HASH(key.depthStencilAttachment->texture->sampleCount);
-        }
-
-        return hash;
-    }
-
-    size_t GraphicsPipelineCache::PipelineStateHash::operator()(const GraphicsPipelineCache::PipelineCacheKey &key) const {
-        size_t hash{HashCommonPipelineState(key)};
-
         HASH(key.colorAttachments.size());
         for (const auto &attachment : key.colorAttachments) {
             HASH(attachment.format);
@@ -209,6 +265,18 @@ namespace skyline::gpu::cache {
         return hash;
     }
 
+    size_t GraphicsPipelineCache::PipelineStateHash::operator()(const GraphicsPipelineCache::PipelineState &key) const {
+        return HashCommonPipelineState(key);
+    }
+
+    size_t GraphicsPipelineCache::PipelineStateHash::operator()(const GraphicsPipelineCache::HashedPipelineState &key) const {
+        return key.hash;
+    }
+
+    size_t GraphicsPipelineCache::PipelineStateHash::operator()(const GraphicsPipelineCache::PipelineCacheKey &key) const {
+        return HashCommonPipelineState(key);
+    }
+
     #undef HASH
 
     bool GraphicsPipelineCache::PipelineCacheEqual::operator()(const GraphicsPipelineCache::PipelineCacheKey &lhs, const GraphicsPipelineCache::PipelineState &rhs) const {
@@ -296,16 +364,9 @@ namespace skyline::gpu::cache {
             KEYNEQ(colorBlendState.blendConstants)
         )
 
-        RETF(CARREQ(colorAttachments.begin(), colorAttachments.size(), {
-            return lhs.format == rhs->format->vkFormat && lhs.sampleCount == rhs->texture->sampleCount;
-        }))
+        RETF(ARREQ(colorAttachments.begin(), colorAttachments.size()))
 
-        RETF(lhs.depthStencilAttachment.has_value() != (rhs.depthStencilAttachment != nullptr) ||
-            (lhs.depthStencilAttachment.has_value() &&
-                lhs.depthStencilAttachment->format != rhs.depthStencilAttachment->format->vkFormat &&
-                lhs.depthStencilAttachment->sampleCount != rhs.depthStencilAttachment->texture->sampleCount
-            )
-        )
+        RETF(KEYNEQ(depthStencilAttachment))
 
         #undef ARREQ
         #undef CARREQ
@@ -316,6 +377,10 @@ namespace skyline::gpu::cache {
         return true;
     }
 
+    bool GraphicsPipelineCache::PipelineCacheEqual::operator()(const PipelineCacheKey &lhs, const HashedPipelineState &rhs) const {
+        return (*this)(lhs, rhs.state);
+    }
+
     bool GraphicsPipelineCache::PipelineCacheEqual::operator()(const PipelineCacheKey &lhs, const PipelineCacheKey &rhs) const {
         return lhs == rhs;
     }
@@ -324,47 +389,178 @@ namespace skyline::gpu::cache {
 
     GraphicsPipelineCache::CompiledPipeline::CompiledPipeline(const PipelineCacheEntry &entry) : descriptorSetLayout(*entry.descriptorSetLayout), pipelineLayout(*entry.pipelineLayout), pipeline(*entry.pipeline) {}
 
-    GraphicsPipelineCache::CompiledPipeline GraphicsPipelineCache::GetCompiledPipeline(const PipelineState &state, span<const vk::DescriptorSetLayoutBinding> layoutBindings, span<const vk::PushConstantRange> pushConstantRanges, bool noPushDescriptors) {
-        std::unique_lock lock(mutex);
+    size_t GraphicsPipelineCache::LibraryKeyHash::operator()(const LibraryKey &key) const {
+        return XXH64(key.data(), key.size(), 0);
+    }
 
-        auto it{pipelineCache.find(state)};
-        if (it != pipelineCache.end())
-            return CompiledPipeline{it->second};
+    GraphicsPipelineCache::LibraryKey GraphicsPipelineCache::MakeLibraryKey(LibraryPart part, const PipelineState &state, span<const vk::DescriptorSetLayoutBinding> layoutBindings, span<const vk::PushConstantRange> pushConstantRanges, bool usePushDescriptors) {
+        LibraryKey key;
+        auto write{[&key](const auto &value) {
+            static_assert(std::is_trivially_copyable_v<std::remove_cvref_t<decltype(value)>>);
+            auto bytes{reinterpret_cast<const u8 *>(&value)};
+            key.insert(key.end(), bytes, bytes + sizeof(value));
+        }};
+        auto writeArray{[&](const auto *pointer, u32 count) {
+            write(count);
+            for (u32 i{}; i < count; i++)
+                write(pointer[i]);
+        }};
 
-        lock.unlock();
+        auto writeShaderStages{[&](bool fragment) {
+            for (const auto &stage : state.shaderStages) {
+                if ((stage.stage == vk::ShaderStageFlagBits::eFragment) != fragment)
+                    continue;
 
-        vk::raii::DescriptorSetLayout descriptorSetLayout{gpu.vkDevice, vk::DescriptorSetLayoutCreateInfo{
-            .flags = vk::DescriptorSetLayoutCreateFlags{(!noPushDescriptors && gpu.traits.supportsPushDescriptors) ? vk::DescriptorSetLayoutCreateFlagBits::ePushDescriptorKHR : vk::DescriptorSetLayoutCreateFlags{}},
-            .pBindings = layoutBindings.data(),
-            .bindingCount = static_cast<u32>(layoutBindings.size()),
+                write(stage.flags);
+                write(stage.stage);
+                write(static_cast<VkShaderModule>(stage.module));
+                key.insert(key.end(), stage.pName, stage.pName + std::strlen(stage.pName) + 1);
+                // Note: We intentionally ignore specialization constants here
+            }
         }};
 
-        vk::raii::PipelineLayout pipelineLayout{gpu.vkDevice, vk::PipelineLayoutCreateInfo{
-            .pSetLayouts = &*descriptorSetLayout,
-            .setLayoutCount = 1,
-            .pPushConstantRanges = pushConstantRanges.data(),
-            .pushConstantRangeCount = static_cast<u32>(pushConstantRanges.size()),
+        auto writeLayout{[&]() {
+            write(static_cast<u32>(layoutBindings.size()));
+            for (const auto &binding : layoutBindings) {
+                write(binding.binding);
+                write(binding.descriptorType);
+                write(binding.descriptorCount);
+                write(binding.stageFlags);
+            }
+
+            writeArray(pushConstantRanges.data(), static_cast<u32>(pushConstantRanges.size()));
+            write(usePushDescriptors);
         }};
 
+        auto writeMultisampleState{[&]() {
+            const auto &multisampleState{state.multisampleState};
+            write(multisampleState.flags);
+            write(multisampleState.rasterizationSamples);
+            write(multisampleState.sampleShadingEnable);
+            write(multisampleState.minSampleShading);
+            write(multisampleState.alphaToCoverageEnable);
+            write(multisampleState.alphaToOneEnable);
+        }};
+
+        // All libraries need to have been created with compatible render passes for them to be linked together
+        auto writeAttachments{[&]() {
+            writeArray(state.colorAttachments.data(), static_cast<u32>(state.colorAttachments.size()));
+            write(state.depthStencilAttachment.has_value());
+            if (state.depthStencilAttachment)
+                write(*state.depthStencilAttachment);
+        }};
+
+        write(part);
+        writeArray(state.dynamicState.pDynamicStates, state.dynamicState.dynamicStateCount);
+
+        switch (part) {
+            case LibraryPart::VertexInput: {
+                const auto &vertexInputState{state.VertexInputState()};
+                write(vertexInputState.flags);
+                writeArray(vertexInputState.pVertexBindingDescriptions, vertexInputState.vertexBindingDescriptionCount);
+                writeArray(vertexInputState.pVertexAttributeDescriptions, vertexInputState.vertexAttributeDescriptionCount);
+
+                bool hasDivisors{state.vertexState.isLinked<vk::PipelineVertexInputDivisorStateCreateInfoEXT>()};
+                write(hasDivisors);
+                if (hasDivisors)
+                    writeArray(state.VertexDivisorState().pVertexBindingDivisors, state.VertexDivisorState().vertexBindingDivisorCount);
+
+                write(state.inputAssemblyState.flags);
+                write(state.inputAssemblyState.topology);
+                write(state.inputAssemblyState.primitiveRestartEnable);
+                break;
+            }
+
+            case LibraryPart::PreRasterization: {
+                writeShaderStages(false);
+                writeLayout();
+                writeAttachments();
+
+                write(state.tessellationState.flags);
+                write(state.tessellationState.patchControlPoints);
+
+                write(state.viewportState.flags);
+                writeArray(state.viewportState.pViewports, state.viewportState.viewportCount);
+                writeArray(state.viewportState.pScissors, state.viewportState.scissorCount);
+
+                const auto &rasterizationState{state.RasterizationState()};
+                write(rasterizationState.flags);
+                write(rasterizationState.depthClampEnable);
+                write(rasterizationState.rasterizerDiscardEnable);
+                write(rasterizationState.polygonMode);
+                write(rasterizationState.cullMode);
+                write(rasterizationState.frontFace);
+                write(rasterizationState.depthBiasEnable);
+                write(rasterizationState.depthBiasConstantFactor);
+                write(rasterizationState.depthBiasClamp);
+                write(rasterizationState.depthBiasSlopeFactor);
+                write(rasterizationState.lineWidth);
+
+                bool hasProvokingVertex{state.rasterizationState.isLinked<vk::PipelineRasterizationProvokingVertexStateCreateInfoEXT>()};
+                write(hasProvokingVertex);
+                if (hasProvokingVertex)
+                    write(state.ProvokingVertexState().provokingVertexMode);
+                break;
+            }
+
+            case LibraryPart::FragmentShader: {
+                writeShaderStages(true);
+                writeLayout();
+                writeAttachments();
+                writeMultisampleState();
+
+                const auto &depthStencilState{state.depthStencilState};
+                write(depthStencilState.flags);
+                write(depthStencilState.depthTestEnable);
+                write(depthStencilState.depthWriteEnable);
+                write(depthStencilState.depthCompareOp);
+                write(depthStencilState.depthBoundsTestEnable);
+                write(depthStencilState.stencilTestEnable);
+                write(depthStencilState.front);
+                write(depthStencilState.back);
+                write(depthStencilState.minDepthBounds);
+                write(depthStencilState.maxDepthBounds);
+                break;
+            }
+
+            case LibraryPart::FragmentOutput: {
+                writeAttachments();
+                writeMultisampleState();
+
+                const auto &colorBlendState{state.colorBlendState};
+                write(colorBlendState.flags);
+                write(colorBlendState.logicOpEnable);
+                write(colorBlendState.logicOp);
+                writeArray(colorBlendState.pAttachments, colorBlendState.attachmentCount);
+                write(colorBlendState.blendConstants);
+                break;
+            }
+        }
+
+        return key;
+    }
+
+    vk::raii::RenderPass GraphicsPipelineCache::CreateRenderPass(const PipelineState &state) {
         boost::container::small_vector<vk::AttachmentDescription, 8> attachmentDescriptions;
         boost::container::small_vector<vk::AttachmentReference, 8> attachmentReferences;
 
-        auto pushAttachment{[&](TextureView *view) {
-            if (view) {
+        // Image layouts aren't a part of render pass compatibility, so any layout may be used here regardless of the layout of the attachments during rendering
+        auto pushAttachment{[&](const AttachmentMetadata &attachment) {
+            if (attachment.format != vk::Format::eUndefined) {
                 attachmentDescriptions.push_back(vk::AttachmentDescription{
-                    .format = view->format->vkFormat,
-                    .samples = view->texture->sampleCount,
+                    .format = attachment.format,
+                    .samples = attachment.sampleCount,
                     .loadOp = vk::AttachmentLoadOp::eLoad,
                     .storeOp = vk::AttachmentStoreOp::eStore,
                     .stencilLoadOp = vk::AttachmentLoadOp::eLoad,
                     .stencilStoreOp = vk::AttachmentStoreOp::eStore,
-                    .initialLayout = view->texture->layout,
-                    .finalLayout = view->texture->layout,
+                    .initialLayout = vk::ImageLayout::eGeneral,
+                    .finalLayout = vk::ImageLayout::eGeneral,
                     .flags = vk::AttachmentDescriptionFlagBits::eMayAlias
                 });
                 attachmentReferences.push_back(vk::AttachmentReference{
                     .attachment = static_cast<u32>(attachmentDescriptions.size() - 1),
-                    .layout = view->texture->layout,
+                    .layout = vk::ImageLayout::eGeneral,
                 });
             } else {
                 attachmentReferences.push_back(vk::AttachmentReference{
@@ -382,7 +578,7 @@ namespace skyline::gpu::cache {
             pushAttachment(colorAttachment);
 
         if (state.depthStencilAttachment) {
-            pushAttachment(state.depthStencilAttachment);
+            pushAttachment(*state.depthStencilAttachment);
 
             subpassDescription.pColorAttachments = attachmentReferences.data();
             subpassDescription.colorAttachmentCount = static_cast<u32>(attachmentReferences.size() - 1);
@@ -392,32 +588,243 @@ namespace skyline::gpu::cache {
             subpassDescription.colorAttachmentCount = static_cast<u32>(attachmentReferences.size());
         }
 
-        vk::raii::RenderPass renderPass{gpu.vkDevice, vk::RenderPassCreateInfo{
+        return vk::raii::RenderPass{gpu.vkDevice, vk::RenderPassCreateInfo{
             .attachmentCount = static_cast<u32>(attachmentDescriptions.size()),
             .pAttachments = attachmentDescriptions.data(),
             .subpassCount = 1,
             .pSubpasses = &subpassDescription,
         }};
+    }
 
-        auto pipeline{gpu.vkDevice.createGraphicsPipeline(vkPipelineCache, vk::GraphicsPipelineCreateInfo{
-            .pStages = state.shaderStages.data(),
-            .stageCount = static_cast<u32>(state.shaderStages.size()),
-            .pVertexInputState = &state.vertexState.get<vk::PipelineVertexInputStateCreateInfo>(),
-            .pInputAssemblyState = &state.inputAssemblyState,
-            .pViewportState = &state.viewportState,
-            .pRasterizationState = &state.rasterizationState.get<vk::PipelineRasterizationStateCreateInfo>(),
-            .pMultisampleState = &state.multisampleState,
-            .pDepthStencilState = &state.depthStencilState,
-            .pColorBlendState = &state.colorBlendState,
+    GraphicsPipelineCache::RenderingFormats::RenderingFormats(const PipelineState &state) {
+        // Unused color attachments have an undefined format which is treated the same as VK_ATTACHMENT_UNUSED by dynamic rendering
+        colorFormats.reserve(state.colorAttachments.size());
+        for (const auto &colorAttachment : state.colorAttachments)
+            colorFormats.push_back(colorAttachment.format);
+
+        createInfo = vk::PipelineRenderingCreateInfo{
+            .colorAttachmentCount = static_cast<u32>(colorFormats.size()),
+            .pColorAttachmentFormats = colorFormats.data(),
+        };
+
+        if (state.depthStencilAttachment) {
+            auto format{state.depthStencilAttachment->format};
+            switch (format) {
+                case vk::Format::eD16Unorm:
+                case vk::Format::eX8D24UnormPack32:
+                case vk::Format::eD32Sfloat:
+                    createInfo.depthAttachmentFormat = format;
+                    break;
+
+                case vk::Format::eS8Uint:
+                    createInfo.stencilAttachmentFormat = format;
+                    break;
+
+                case vk::Format::eD16UnormS8Uint:
+                case vk::Format::eD24UnormS8Uint:
+                case vk::Format::eD32SfloatS8Uint:
+                    createInfo.depthAttachmentFormat = format;
+                    createInfo.stencilAttachmentFormat = format;
+                    break;
+
+                default:
+                    break;
+            }
+        }
+    }
+
+    vk::raii::Pipeline GraphicsPipelineCache::CreatePipelineLibrary(LibraryPart part, const PipelineState &state, vk::PipelineLayout pipelineLayout, vk::RenderPass renderPass, const RenderingFormats *renderingFormats) {
+        vk::GraphicsPipelineLibraryCreateInfoEXT libraryCreateInfo{
+            .pNext = renderingFormats && part != LibraryPart::VertexInput ? &renderingFormats->createInfo : nullptr,
+        };
+        vk::GraphicsPipelineCreateInfo createInfo{
+            .pNext = &libraryCreateInfo,
+            .flags = vk::PipelineCreateFlagBits::eLibraryKHR,
             .pDynamicState = &state.dynamicState,
-            .layout = *pipelineLayout,
-            .renderPass = *renderPass,
-            .subpass = 0,
-        })};
+        };
+
+        boost::container::static_vector<vk::PipelineShaderStageCreateInfo, 5> shaderStages;
+        auto setShaderStages{[&](bool fragment) {
+            for (const auto &stage : state.shaderStages)
+                if ((stage.stage == vk::ShaderStageFlagBits::eFragment) == fragment)
+                    shaderStages.push_back(stage);
+
+            createInfo.pStages = shaderStages.data();
+            createInfo.stageCount = static_cast<u32>(shaderStages.size());
+        }};
+
+        switch (part) {
+            case LibraryPart::VertexInput:
+                libraryCreateInfo.flags = vk::GraphicsPipelineLibraryFlagBitsEXT::eVertexInputInterface;
+                createInfo.pVertexInputState = &state.VertexInputState();
+                createInfo.pInputAssemblyState = &state.inputAssemblyState;
+                break;
+
+            case LibraryPart::PreRasterization:
+                libraryCreateInfo.flags = vk::GraphicsPipelineLibraryFlagBitsEXT::ePreRasterizationShaders;
+                setShaderStages(false);
+                createInfo.pTessellationState = &state.tessellationState;
+                createInfo.pViewportState = &state.viewportState;
+                createInfo.pRasterizationState = &state.RasterizationState();
+                createInfo.layout = pipelineLayout;
+                createInfo.renderPass = renderPass;
+                break;
+
+            case LibraryPart::FragmentShader:
+                libraryCreateInfo.flags = vk::GraphicsPipelineLibraryFlagBitsEXT::eFragmentShader;
+                setShaderStages(true);
+                createInfo.pMultisampleState = &state.multisampleState;
+                createInfo.pDepthStencilState = &state.depthStencilState;
+                createInfo.layout = pipelineLayout;
+                createInfo.renderPass = renderPass;
+                break;
+
+            case LibraryPart::FragmentOutput:
+                libraryCreateInfo.flags = vk::GraphicsPipelineLibraryFlagBitsEXT::eFragmentOutputInterface;
+                createInfo.pMultisampleState = &state.multisampleState;
+                createInfo.pColorBlendState = &state.colorBlendState;
+                createInfo.renderPass = renderPass;
+                break;
+        }
+
+        return gpu.vkDevice.createGraphicsPipeline(vkPipelineCache, createInfo);
+    }
+
+    vk::raii::Pipeline GraphicsPipelineCache::LinkPipelineLibraries(const PipelineState &state, span<const vk::DescriptorSetLayoutBinding> layoutBindings, span<const vk::PushConstantRange> pushConstantRanges, bool usePushDescriptors, vk::PipelineLayout pipelineLayout) {
+        std::optional<vk::raii::RenderPass> renderPass; // The render pass is only required for compiling libraries, so it is lazily created when a library part isn't cached
+        std::optional<RenderingFormats> renderingFormats; // This replaces the render pass with dynamic rendering
+        std::array<vk::Pipeline, LibraryPartCount> libraries{};
+
+        for (size_t i{}; i < LibraryPartCount; i++) {
+            auto part{static_cast<LibraryPart>(i)};
+            auto key{MakeLibraryKey(part, state, layoutBindings, pushConstantRanges, usePushDescriptors)};
+
+            {
+                std::scoped_lock lock{mutex};
+                auto it{libraryCache[i].find(key)};
+                if (it != libraryCache[i].end()) {
+                    libraries[i] = *it->second;
+                    continue;
+                }
+            }
 
-        lock.lock();
+            if (part != LibraryPart::VertexInput) {
+                if (gpu.traits.supportsDynamicRendering) {
+                    if (!renderingFormats)
+                        renderingFormats.emplace(state);
+                } else if (!renderPass) {
+                    renderPass.emplace(CreateRenderPass(state));
+                }
+            }
+
+            auto library{CreatePipelineLibrary(part, state, pipelineLayout, renderPass ? **renderPass : vk::RenderPass{}, renderingFormats ? &*renderingFormats : nullptr)};
+
+            // Another thread may have compiled the same library concurrently, this is benign as either library can be used
+            std::scoped_lock lock{mutex};
+            libraries[i] = *libraryCache[i].try_emplace(std::move(key), std::move(library)).first->second;
+        }
+
+        vk::PipelineLibraryCreateInfoKHR libraryInfo{
+            .libraryCount = static_cast<u32>(libraries.size()),
+            .pLibraries = libraries.data(),
+        };
+
+        return gpu.vkDevice.createGraphicsPipeline(vkPipelineCache, vk::GraphicsPipelineCreateInfo{
+            .pNext = &libraryInfo,
+            .layout = pipelineLayout,
+        });
+    }
+
+    GraphicsPipelineCache::CompiledPipeline GraphicsPipelineCache::GetCompiledPipeline(const PipelineState &state, span<const vk::DescriptorSetLayoutBinding> layoutBindings, span<const vk::PushConstantRange> pushConstantRanges, bool noPushDescriptors) {
+        HashedPipelineState hashedState{state, HashCommonPipelineState(state)};
+        auto &shard{pipelineCacheShards[hashedState.hash & (PipelineCacheShardCount - 1)]};
+
+        {
+            std::shared_lock lock{shard.mutex};
+            auto it{shard.map.find(hashedState)};
+            if (it != shard.map.end()) {
+                TRACE_COUNTER("gpu", "Pipeline Cache Hits", ++pipelineCacheHits);
+                gpu.pipelineStatistics.RecordLookup(PipelineStatistics::LookupSource::VulkanGraphics, true);
+                return CompiledPipeline{it->second};
+            }
+        }
+
+        TRACE_COUNTER("gpu", "Pipeline Cache Misses", ++pipelineCacheMisses);
+        GetPerformanceStatistics().pipelineCompileCount.fetch_add(1, std::memory_order_relaxed);
+        gpu.pipelineStatistics.RecordLookup(PipelineStatistics::LookupSource::VulkanGraphics, false);
+
+        bool usePushDescriptors{!noPushDescriptors && gpu.traits.supportsPushDescriptors};
+        vk::raii::DescriptorSetLayout descriptorSetLayout{gpu.vkDevice, vk::DescriptorSetLayoutCreateInfo{
+            .flags = vk::DescriptorSetLayoutCreateFlags{usePushDescriptors ? vk::DescriptorSetLayoutCreateFlagBits::ePushDescriptorKHR : vk::DescriptorSetLayoutCreateFlags{}},
+            .pBindings = layoutBindings.data(),
+            .bindingCount = static_cast<u32>(layoutBindings.size()),
+        }};
+
+        vk::raii::PipelineLayout pipelineLayout{gpu.vkDevice, vk::PipelineLayoutCreateInfo{
+            .pSetLayouts = &*descriptorSetLayout,
+            .setLayoutCount = 1,
+            .pPushConstantRanges = pushConstantRanges.data(),
+            .pushConstantRangeCount = static_cast<u32>(pushConstantRanges.size()),
+        }};
+
+        vk::raii::Pipeline pipeline{nullptr};
+        if (gpu.traits.supportsGraphicsPipelineLibrary) {
+            // Pipelines are linked from independently cached libraries, pipelines which only differ in the state of a few library parts can reuse all other parts
+            pipeline = LinkPipelineLibraries(state, layoutBindings, pushConstantRanges, usePushDescriptors, *pipelineLayout);
+        } else {
+            vk::GraphicsPipelineCreateInfo createInfo{
+                .pStages = state.shaderStages.data(),
+                .stageCount = static_cast<u32>(state.shaderStages.size()),
+                .pVertexInputState = &state.vertexState.get<vk::PipelineVertexInputStateCreateInfo>(),
+                .pInputAssemblyState = &state.inputAssemblyState,
+                .pViewportState = &state.viewportState,
+                .pRasterizationState = &state.rasterizationState.get<vk::PipelineRasterizationStateCreateInfo>(),
+                .pMultisampleState = &state.multisampleState,
+                .pDepthStencilState = &state.depthStencilState,
+                .pColorBlendState = &state.colorBlendState,
+                .pDynamicState = &state.dynamicState,
+                .layout = *pipelineLayout,
+                .subpass = 0,
+            };
+
+            // Pipelines only depend on the attachment formats with dynamic rendering, so no render pass is created for them
+            std::optional<vk::raii::RenderPass> renderPass;
+            std::optional<RenderingFormats> renderingFormats;
+            if (gpu.traits.supportsDynamicRendering)
+                createInfo.pNext = &renderingFormats.emplace(state).createInfo;
+            else
+                createInfo.renderPass = *renderPass.emplace(CreateRenderPass(state));
+
+            pipeline = gpu.vkDevice.createGraphicsPipeline(vkPipelineCache, createInfo);
+        }
+
+        CompiledPipeline compiledPipeline;
+        {
+            // If another thread inserted an identical pipeline while this one was being compiled, the existing pipeline is used and this one is discarded
+            std::unique_lock lock{shard.mutex};
+            compiledPipeline = CompiledPipeline{shard.map.try_emplace(PipelineCacheKey{state}, std::move(descriptorSetLayout), std::move(pipelineLayout), std::move(pipeline)).first->second};
+        }
+
+        std::scoped_lock lock{mutex};
+        if (diskCacheFileSystem && ++diskCacheDirtyCount >= DiskCacheSerializeThreshold && !diskCacheThreadRunning.test_and_set()) {
+            // Serialization is done on a separate thread as retrieving the pipeline cache data and writing it out can take a significant amount of time
+            diskCacheDirtyCount = 0;
+            if (diskCacheThread.joinable())
+                diskCacheThread.join();
+
+            diskCacheThread = std::thread([this]() {
+                if (int result{pthread_setname_np(pthread_self(), "Sky-PipeCache")})
+                    Logger::Warn("Failed to set the thread name: {}", strerror(result));
+
+                try {
+                    SerializeDiskCache();
+                } catch (const std::exception &e) {
+                    Logger::Warn("Failed to serialize pipeline cache: {}", e.what());
+                }
+                diskCacheThreadRunning.clear();
+            });
+        }
 
-        auto pipelineEntryIt{pipelineCache.try_emplace(PipelineCacheKey{state}, std::move(descriptorSetLayout), std::move(pipelineLayout), std::move(pipeline))};
-        return CompiledPipeline{pipelineEntryIt.first->second};
+        return compiledPipeline;
     }
 }
@@ -4,6 +4,7 @@
 #pragma once
 
 #include <vulkan/vulkan_raii.hpp>
+#include <vfs/filesystem.h>
 
 namespace skyline::gpu {
     class TextureView;
@@ -16,6 +17,26 @@ namespace skyline::gpu::cache {
      */
     class GraphicsPipelineCache {
       public:
+        /**
+         * @brief All unique metadata in a single attachment for a compatible render pass according to Render Pass Compatibility clause in the Vulkan specification
+         * @note An attachment with an undefined format is treated as unused
+         * @url https://www.khronos.org/registry/vulkan/specs/1.3-extensions/html/vkspec.html#renderpass-compatibility
+         * @url https://www.khronos.org/registry/vulkan/specs/1.3-extensions/man/html/VkAttachmentDescription.html
+         */
+        struct AttachmentMetadata {
+            vk::Format format;
+            vk::SampleCountFlagBits sampleCount;
+
+            constexpr AttachmentMetadata(vk::Format format = vk::Format::eUndefined, vk::SampleCountFlagBits sampleCount = vk::SampleCountFlagBits::e1) : format(format), sampleCount(sampleCount) {}
+
+            /**
+             * @param view A nullable pointer to the view to retrieve the metadata from, a null view results in an unused attachment
+             */
+            AttachmentMetadata(TextureView *view);
+
+            bool operator==(const AttachmentMetadata &rhs) const = default;
+        };
+
         /**
          * @brief All unique state required to compile a graphics pipeline as references
          */
@@ -31,8 +52,8 @@ namespace skyline::gpu::cache {
             const vk::PipelineColorBlendStateCreateInfo &colorBlendState;
             const vk::PipelineDynamicStateCreateInfo &dynamicState;
 
-            span<TextureView *> colorAttachments; //!< All color attachments in the subpass of this pipeline
-            TextureView *depthStencilAttachment; //!< A nullable pointer to the depth/stencil attachment in the subpass of this pipeline
+            span<const AttachmentMetadata> colorAttachments; //!< All color attachments in the subpass of this pipeline
+            std::optional<AttachmentMetadata> depthStencilAttachment; //!< The depth/stencil attachment in the subpass of this pipeline, if any
 
             constexpr const vk::PipelineVertexInputStateCreateInfo &VertexInputState() const {
                 return vertexState.get<vk::PipelineVertexInputStateCreateInfo>();
@@ -53,22 +74,44 @@ namespace skyline::gpu::cache {
 
       private:
         GPU &gpu;
-        std::mutex mutex; //!< Synchronizes accesses to the pipeline cache
+        std::mutex mutex; //!< Synchronizes accesses to the pipeline library cache and the disk cache state
         vk::raii::PipelineCache vkPipelineCache; //!< A Vulkan Pipeline Cache which stores all unique graphics pipelines
 
         /**
-         * @brief All unique metadata in a single attachment for a compatible render pass according to Render Pass Compatibility clause in the Vulkan specification
-         * @url https://www.khronos.org/registry/vulkan/specs/1.3-extensions/html/vkspec.html#renderpass-compatibility
-         * @url https://www.khronos.org/registry/vulkan/specs/1.3-extensions/man/html/VkAttachmentDescription.html
+         * @brief The header prepended to the Vulkan pipeline cache data when it is stored on disk, it is used to reject data from other drivers or data which was partially written
+         * @note While the Vulkan pipeline cache data has its own header, certain drivers (especially custom ones loaded via adrenotools) do not validate it correctly
          */
-        struct AttachmentMetadata {
-            vk::Format format;
-            vk::SampleCountFlagBits sampleCount;
+        struct DiskCacheHeader {
+            static constexpr u32 Magic{util::MakeMagic<u32>("SVPC")}; //!< "Skyline Vulkan Pipeline Cache"
+            static constexpr u32 Version{2}; //!< The version of the disk cache format, this must be incremented when the format changes
+
+            u32 magic{Magic};
+            u32 version{Version};
+            u32 vendorId;
+            u32 deviceId;
+            u32 driverVersion;
+            std::array<u8, VK_UUID_SIZE> pipelineCacheUuid;
+            u32 _pad_{}; //!< Explicit padding so that no uninitialized bytes are written to disk
+            u64 driverLabelHash; //!< A hash of the label of the custom GPU driver in use or of an empty string for the system driver
+            u64 dataSize; //!< The size of the pipeline cache data following the header
+            u64 dataHash; //!< An XXH64 hash of the pipeline cache data following the header
+
+            bool operator==(const DiskCacheHeader &) const = default;
+        };
+        static_assert(sizeof(DiskCacheHeader) == 0x40);
 
-            constexpr AttachmentMetadata(vk::Format format, vk::SampleCountFlagBits sampleCount) : format(format), sampleCount(sampleCount) {}
+        static constexpr size_t DiskCacheSerializeThreshold{32}; //!< The amount of newly compiled pipelines after which the pipeline cache is serialized to disk
 
-            bool operator==(const AttachmentMetadata &rhs) const = default;
-        };
+        std::shared_ptr<vfs::FileSystem> diskCacheFileSystem; //!< The filesystem containing the on-disk cache, this is null if no disk cache is in use
+        DiskCacheHeader diskCacheHeader{}; //!< A template header for the on-disk cache with everything but the data fields filled in
+        size_t diskCacheDirtyCount{}; //!< The amount of pipelines compiled since the last serialization of the pipeline cache
+        std::thread diskCacheThread; //!< A thread which serializes the pipeline cache to disk in the background
+        std::atomic_flag diskCacheThreadRunning{}; //!< If the serialization thread is currently running
+
+        /**
+         * @brief Writes the contents of the Vulkan pipeline cache to disk alongside a header
+         */
+        void SerializeDiskCache();
 
         /**
          * @brief All data in PipelineState in value form to allow cheap heterogenous lookups with reference types while still storing a value-based key in the map
@@ -115,11 +158,21 @@ namespace skyline::gpu::cache {
             }
         };
 
+        /**
+         * @brief A pipeline state alongside its precomputed hash, this allows the hash to be used for selecting a shard and for the lookup within it without being recomputed
+         */
+        struct HashedPipelineState {
+            const PipelineState &state;
+            size_t hash;
+        };
+
         struct PipelineStateHash {
             using is_transparent = std::true_type;
 
             size_t operator()(const PipelineState &key) const;
 
+            size_t operator()(const HashedPipelineState &key) const;
+
             size_t operator()(const PipelineCacheKey &key) const;
         };
 
@@ -128,6 +181,8 @@ namespace skyline::gpu::cache {
 
             bool operator()(const PipelineCacheKey &lhs, const PipelineState &rhs) const;
 
+            bool operator()(const PipelineCacheKey &lhs, const HashedPipelineState &rhs) const;
+
             bool operator()(const PipelineCacheKey &lhs, const PipelineCacheKey &rhs) const;
         };
 
@@ -139,21 +194,100 @@ namespace skyline::gpu::cache {
             PipelineCacheEntry(vk::raii::DescriptorSetLayout&& descriptorSetLayout, vk::raii::PipelineLayout &&layout, vk::raii::Pipeline &&pipeline);
         };
 
-        std::unordered_map<PipelineCacheKey, PipelineCacheEntry, PipelineStateHash, PipelineCacheEqual> pipelineCache;
+        /**
+         * @brief A single shard of the pipeline cache, pipelines are distributed across shards based on their hash
+         * @note Lookups only lock a shard in shared mode so they never contend with each other and only briefly contend with insertions into the same shard, compilation is always done without any lock held
+         */
+        struct PipelineCacheShard {
+            std::shared_mutex mutex; //!< Locked in shared mode for lookups and in exclusive mode for insertions
+            std::unordered_map<PipelineCacheKey, PipelineCacheEntry, PipelineStateHash, PipelineCacheEqual> map;
+        };
+
+        static constexpr size_t PipelineCacheShardCount{16}; //!< The amount of shards in the pipeline cache, this must be a power of two
+
+        std::array<PipelineCacheShard, PipelineCacheShardCount> pipelineCacheShards;
+        std::atomic<u64> pipelineCacheHits{}; //!< The amount of lookups which found an existing pipeline, this is reported as a trace counter
+        std::atomic<u64> pipelineCacheMisses{}; //!< The amount of lookups which required compiling a new pipeline, this is reported as a trace counter
+
+        /**
+         * @brief The subsets of pipeline state which are compiled into independent pipeline libraries with VK_EXT_graphics_pipeline_library
+         */
+        enum class LibraryPart : u8 {
+            VertexInput, //!< The vertex input and input assembly state
+            PreRasterization, //!< All shader stages prior to the fragment shader alongside the tessellation, viewport and rasterization state
+            FragmentShader, //!< The fragment shader alongside the multisample and depth/stencil state
+            FragmentOutput, //!< The color blend and multisample state
+        };
+        static constexpr size_t LibraryPartCount{4};
+
+        /**
+         * @brief A flat serialization of all state that a single pipeline library depends on, it is directly compared and hashed
+         * @note Library state is spread across a large amount of structures, serializing only the relevant parts avoids needing dedicated key types for every library part
+         */
+        using LibraryKey = std::vector<u8>;
+
+        struct LibraryKeyHash {
+            size_t operator()(const LibraryKey &key) const;
+        };
+
+        std::array<std::unordered_map<LibraryKey, vk::raii::Pipeline, LibraryKeyHash>, LibraryPartCount> libraryCache; //!< Pipeline libraries for each library part which can be shared between any pipelines with matching state in that part
+
+        static LibraryKey MakeLibraryKey(LibraryPart part, const PipelineState &state, span<const vk::DescriptorSetLayoutBinding> layoutBindings, span<const vk::PushConstantRange> pushConstantRanges, bool usePushDescriptors);
+
+        /**
+         * @return A render pass which is compatible with the attachments of the supplied pipeline state
+         */
+        vk::raii::RenderPass CreateRenderPass(const PipelineState &state);
+
+        /**
+         * @brief The attachment formats of a pipeline state for creating pipelines without a render pass using dynamic rendering
+         */
+        struct RenderingFormats {
+            std::vector<vk::Format> colorFormats;
+            vk::PipelineRenderingCreateInfo createInfo; //!< The create info to chain into the pipeline create info, it points into `colorFormats`
+
+            RenderingFormats(const PipelineState &state);
+
+            RenderingFormats(const RenderingFormats &) = delete;
+
+            RenderingFormats &operator=(const RenderingFormats &) = delete;
+        };
+
+        /**
+         * @param renderPass The render pass to create the library against, this must be null with dynamic rendering
+         * @param renderingFormats The attachment formats to create the library against with dynamic rendering, this is nullable
+         */
+        vk::raii::Pipeline CreatePipelineLibrary(LibraryPart part, const PipelineState &state, vk::PipelineLayout pipelineLayout, vk::RenderPass renderPass, const RenderingFormats *renderingFormats);
+
+        /**
+         * @brief Links a pipeline from pipeline libraries for every library part, any libraries which aren't cached are compiled and inserted into the library cache
+         * @note The mutex must not be locked by the calling thread
+         */
+        vk::raii::Pipeline LinkPipelineLibraries(const PipelineState &state, span<const vk::DescriptorSetLayoutBinding> layoutBindings, span<const vk::PushConstantRange> pushConstantRanges, bool usePushDescriptors, vk::PipelineLayout pipelineLayout);
 
       public:
         GraphicsPipelineCache(GPU &gpu);
 
+        ~GraphicsPipelineCache();
+
+        /**
+         * @brief Loads the on-disk pipeline cache from the supplied filesystem and merges it into the Vulkan pipeline cache, it'll also be periodically serialized to the filesystem from this point onwards
+         * @param driverLabel The label of the custom GPU driver in use, this should be empty for the system driver
+         * @note Any on-disk cache not matching the current driver will be discarded and overwritten
+         */
+        void LoadDiskCache(std::shared_ptr<vfs::FileSystem> cacheFileSystem, std::string_view driverLabel);
+
         struct CompiledPipeline {
             vk::DescriptorSetLayout descriptorSetLayout;
             vk::PipelineLayout pipelineLayout;
             vk::Pipeline pipeline;
 
+            CompiledPipeline() = default;
+
             CompiledPipeline(const PipelineCacheEntry &entry);
         };
 
         /**
-         * @note All attachments in the PipelineState **must** be locked prior to calling this function
          * @note Shader specializiation constants are **not** supported and will result in UB
          * @note Input/Resolve attachments are **not** supported and using them with the supplied pipeline will result in UB
          */
@@ -0,0 +1,103 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#include <bit>
+#include <common/trace.h>
+#include "pipeline_statistics.h"
+
+namespace skyline::gpu::cache {
+    static constexpr std::array<std::string_view, PipelineStatistics::LookupSourceCount> LookupSourceNames{"maxwell3d", "keplerCompute", "vulkanGraphics"};
+
+    PipelineStatistics::~PipelineStatistics() {
+        try {
+            Export();
+        } catch (const std::exception &e) {
+            Logger::Warn("Failed to export pipeline statistics: {}", e.what());
+        }
+    }
+
+    size_t PipelineStatistics::GetCompileTimeBucket(u64 compileTimeNs) {
+        u64 compileTimeMs{compileTimeNs / constant::NsInMillisecond};
+        return std::min<size_t>(static_cast<size_t>(std::bit_width(compileTimeMs)), CompileTimeBucketCount - 1);
+    }
+
+    void PipelineStatistics::EnableExport(std::shared_ptr<vfs::FileSystem> cacheFileSystem) {
+        std::scoped_lock lock{mutex};
+        exportFileSystem = std::move(cacheFileSystem);
+    }
+
+    void PipelineStatistics::RecordLookup(LookupSource source, bool hit) {
+        auto index{static_cast<size_t>(source)};
+        if (hit)
+            lookupHits[index].fetch_add(1, std::memory_order_relaxed);
+        else
+            lookupMisses[index].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void PipelineStatistics::RecordPipeline(const PipelineRecord &record) {
+        size_t pipelineCount;
+        {
+            std::scoped_lock lock{mutex};
+            records.push_back(record);
+            compileTimeHistogram[GetCompileTimeBucket(record.compileTimeNs)]++;
+            totalCompileTimeNs += record.compileTimeNs;
+            pipelineCount = records.size();
+        }
+
+        TRACE_COUNTER("gpu", "Pipeline Count", pipelineCount);
+        TRACE_COUNTER("gpu", "Pipeline Compile Time (us)", record.compileTimeNs / 1000);
+    }
+
+    std::string PipelineStatistics::SerializeJson() {
+        std::scoped_lock lock{mutex};
+
+        std::string json{"{\n  \"lookups\": {"};
+        for (size_t i{}; i < LookupSourceCount; i++) {
+            u64 hits{lookupHits[i].load(std::memory_order_relaxed)}, misses{lookupMisses[i].load(std::memory_order_relaxed)};
+            double hitRate{(hits + misses) ? static_cast<double>(hits) / static_cast<double>(hits + misses) : 0.0};
+            json += util::Format("{}\n    \"{}\": {{\"hits\": {}, \"misses\": {}, \"hitRate\": {:.4f}}}", i ? "," : "", LookupSourceNames[i], hits, misses, hitRate);
+        }
+
+        json += util::Format("\n  }},\n  \"pipelineCount\": {},\n  \"totalCompileTimeMs\": {:.3f},\n  \"compileTimeHistogramMs\": [", records.size(), static_cast<double>(totalCompileTimeNs) / constant::NsInMillisecond);
+        for (size_t i{}; i < CompileTimeBucketCount; i++) {
+            // Each bucket is serialized with its exclusive upper bound in milliseconds, the last bucket is unbounded
+            if (i == CompileTimeBucketCount - 1)
+                json += util::Format("{}\n    {{\"belowMs\": null, \"count\": {}}}", i ? "," : "", compileTimeHistogram[i]);
+            else
+                json += util::Format("{}\n    {{\"belowMs\": {}, \"count\": {}}}", i ? "," : "", 1ULL << i, compileTimeHistogram[i]);
+        }
+
+        json += "\n  ],\n  \"pipelines\": [";
+        for (size_t i{}; i < records.size(); i++) {
+            const auto &record{records[i]};
+            json += util::Format("{}\n    {{\"type\": \"{}\", \"stateHash\": \"{:016X}\", \"shaderCount\": {}, \"guestShaderSize\": {}, \"firstRequestedFrame\": {}, \"compileTimeUs\": {}}}",
+                                 i ? "," : "", record.type == PipelineType::Graphics ? "graphics" : "compute", record.stateHash, record.shaderCount, record.guestShaderSize, record.firstRequestedFrame, record.compileTimeNs / 1000);
+        }
+        json += "\n  ]\n}\n";
+
+        return json;
+    }
+
+    void PipelineStatistics::Export() {
+        std::shared_ptr<vfs::FileSystem> fileSystem;
+        size_t pipelineCount;
+        {
+            std::scoped_lock lock{mutex};
+            if (!exportFileSystem || records.empty())
+                return;
+            fileSystem = exportFileSystem;
+            pipelineCount = records.size();
+        }
+
+        auto json{SerializeJson()};
+
+        std::string fileName{ExportFileName};
+        if (!fileSystem->FileExists(fileName) && !fileSystem->CreateFile(fileName, 0))
+            throw exception("Failed to create pipeline statistics file");
+
+        auto backing{fileSystem->OpenFile(fileName, {true, true, false})};
+        backing->Resize(json.size());
+        backing->Write(span{json}.cast<u8>());
+        Logger::Info("Exported statistics for {} pipelines", pipelineCount);
+    }
+}
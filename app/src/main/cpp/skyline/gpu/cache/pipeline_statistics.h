@@ -0,0 +1,87 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#pragma once
+
+#include <vfs/filesystem.h>
+
+namespace skyline::gpu::cache {
+    /**
+     * @brief Collects statistics about all pipelines used by a title, these are reported as trace counters during emulation and can be exported as JSON into the title's cache directory on exit
+     * @note This is used to quantify pipeline compilation stutter on a per-title basis and to determine which titles benefit the most from pre-warmed caches
+     */
+    class PipelineStatistics {
+      public:
+        enum class PipelineType : u8 {
+            Graphics, //!< A Maxwell 3D graphics pipeline
+            Compute, //!< A Kepler compute pipeline
+        };
+
+        /**
+         * @brief A source of pipeline lookups which have their hit rate tracked independently
+         */
+        enum class LookupSource : u8 {
+            Maxwell3D, //!< The Maxwell 3D pipeline manager, a miss results in shader translation and pipeline compilation
+            KeplerCompute, //!< The Kepler compute pipeline manager, a miss results in shader translation and pipeline compilation
+            VulkanGraphics, //!< The Vulkan graphics pipeline cache, a miss results in a Vulkan pipeline being compiled
+        };
+        static constexpr size_t LookupSourceCount{3};
+
+        /**
+         * @brief The statistics of a single pipeline created by the title
+         */
+        struct PipelineRecord {
+            PipelineType type;
+            u64 stateHash; //!< A hash of the packed state the pipeline was created from, this identifies the pipeline across boots
+            u32 shaderCount; //!< The amount of shader stages in the pipeline
+            u32 guestShaderSize; //!< The combined size of all guest shader binaries of the pipeline in bytes
+            size_t firstRequestedFrame; //!< The ID of the frame being rendered when the pipeline was first requested
+            u64 compileTimeNs; //!< The time spent translating shaders and compiling the pipeline, this excludes any time spent waiting to be compiled
+        };
+
+        static constexpr size_t CompileTimeBucketCount{12}; //!< The amount of buckets in the compile time histogram, bucket N contains compile times below 2^N ms with the last bucket containing all remaining times
+
+      private:
+        static constexpr std::string_view ExportFileName{"pipelines/statistics.json"}; //!< The path of the exported statistics relative to the title's cache directory
+
+        std::mutex mutex; //!< Synchronizes accesses to the pipeline records, the histogram and the export filesystem
+        std::vector<PipelineRecord> records;
+        std::array<u64, CompileTimeBucketCount> compileTimeHistogram{};
+        u64 totalCompileTimeNs{};
+        std::array<std::atomic<u64>, LookupSourceCount> lookupHits{};
+        std::array<std::atomic<u64>, LookupSourceCount> lookupMisses{};
+        std::shared_ptr<vfs::FileSystem> exportFileSystem; //!< The filesystem the statistics are exported into on destruction, this is null if exporting is disabled
+
+        static size_t GetCompileTimeBucket(u64 compileTimeNs);
+
+      public:
+        ~PipelineStatistics();
+
+        /**
+         * @brief Enables exporting the statistics into the supplied filesystem when this object is destroyed
+         */
+        void EnableExport(std::shared_ptr<vfs::FileSystem> cacheFileSystem);
+
+        /**
+         * @brief Records the result of a single pipeline lookup
+         * @note This is lock-free as it is called on every pipeline lookup
+         */
+        void RecordLookup(LookupSource source, bool hit);
+
+        /**
+         * @brief Records a newly created pipeline after it has been compiled
+         * @note This is thread-safe and may be called from pipeline compilation threads
+         */
+        void RecordPipeline(const PipelineRecord &record);
+
+        /**
+         * @return A JSON document containing a summary of all statistics alongside every recorded pipeline
+         */
+        std::string SerializeJson();
+
+        /**
+         * @brief Writes the JSON serialization of the statistics into the export filesystem, this is a no-op if exporting isn't enabled
+         */
+        void Export();
+    };
+}
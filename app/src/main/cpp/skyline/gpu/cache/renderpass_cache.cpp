@@ -25,6 +25,33 @@ namespace skyline::gpu::cache {
         : attachments{createInfo.pAttachments, createInfo.pAttachments + createInfo.attachmentCount},
           subpasses{createInfo.pSubpasses, createInfo.pSubpasses + createInfo.subpassCount} {}
 
+    RenderPassCache::RenderPassMetadata RenderPassCache::RenderPassMetadata::Canonicalize() const {
+        RenderPassMetadata canonical{*this};
+        for (auto &attachment : canonical.attachments) {
+            attachment.loadOp = vk::AttachmentLoadOp::eDontCare;
+            attachment.storeOp = vk::AttachmentStoreOp::eDontCare;
+            attachment.stencilLoadOp = vk::AttachmentLoadOp::eDontCare;
+            attachment.stencilStoreOp = vk::AttachmentStoreOp::eDontCare;
+            attachment.initialLayout = vk::ImageLayout::eUndefined;
+            attachment.finalLayout = vk::ImageLayout::eUndefined;
+        }
+
+        auto canonicalizeReferences{[](auto &references) {
+            for (auto &reference : references)
+                reference.layout = vk::ImageLayout::eUndefined;
+        }};
+
+        for (auto &subpass : canonical.subpasses) {
+            canonicalizeReferences(subpass.inputAttachments);
+            canonicalizeReferences(subpass.colorAttachments);
+            canonicalizeReferences(subpass.resolveAttachments);
+            if (subpass.depthStencilAttachment)
+                subpass.depthStencilAttachment->layout = vk::ImageLayout::eUndefined;
+        }
+
+        return canonical;
+    }
+
     #define HASH(x) boost::hash_combine(hash, x)
 
     size_t RenderPassCache::RenderPassHash::operator()(const RenderPassMetadata &key) const {
@@ -149,7 +176,7 @@ namespace skyline::gpu::cache {
 
             RETF(subpass.depthStencilAttachment.has_value() != (vkSubpass->pDepthStencilAttachment != nullptr))
             if (subpass.depthStencilAttachment)
-                RETF(subpass.depthStencilAttachment->attachment != vkSubpass->pDepthStencilAttachment->attachment &&
+                RETF(subpass.depthStencilAttachment->attachment != vkSubpass->pDepthStencilAttachment->attachment ||
                     subpass.depthStencilAttachment->layout != vkSubpass->pDepthStencilAttachment->layout)
 
             RETARRNEQ(subpass.preserveAttachments, vkSubpass->pPreserveAttachments, vkSubpass->preserveAttachmentCount)
@@ -162,13 +189,50 @@ namespace skyline::gpu::cache {
         return true;
     }
 
-    vk::RenderPass RenderPassCache::GetRenderPass(const vk::RenderPassCreateInfo &createInfo) {
+    void RenderPassCache::EvictLeastRecentlyUsed() {
+        auto it{renderPassCache.find(*lru.back())};
+        lru.pop_back();
+
+        auto &entry{it->second};
+        auto compatibilityIt{compatibilityClasses.find(*entry.compatibilityKey)};
+        if (--compatibilityIt->second.renderPassCount == 0)
+            compatibilityClasses.erase(compatibilityIt);
+
+        // The cycle drops the render pass immediately if it has already been signalled
+        if (entry.cycle)
+            entry.cycle->AttachObject(std::make_shared<vk::raii::RenderPass>(std::move(entry.renderPass)));
+        renderPassCache.erase(it);
+    }
+
+    RenderPassCache::CachedRenderPass RenderPassCache::GetRenderPass(const vk::RenderPassCreateInfo &createInfo, const IntrusivePtr<FenceCycle> &cycle) {
         std::scoped_lock lock{mutex};
         auto it{renderPassCache.find(createInfo)};
-        if (it != renderPassCache.end())
-            return *it->second;
+        if (it != renderPassCache.end()) {
+            auto &entry{it->second};
+            lru.splice(lru.begin(), lru, entry.lruIterator);
+            entry.cycle = cycle;
+            return {*entry.renderPass, entry.compatibilityId};
+        }
 
-        auto entryIt{renderPassCache.try_emplace(RenderPassMetadata{createInfo}, gpu.vkDevice, createInfo)};
-        return *entryIt.first->second;
+        if (renderPassCache.size() >= MaxEntryCount)
+            EvictLeastRecentlyUsed();
+
+        vk::raii::RenderPass renderPass{gpu.vkDevice, createInfo};
+        RenderPassMetadata metadata{createInfo};
+        auto [compatibilityIt, newClass]{compatibilityClasses.try_emplace(metadata.Canonicalize(), CompatibilityClass{.id = nextCompatibilityId})};
+        if (newClass)
+            nextCompatibilityId++;
+        compatibilityIt->second.renderPassCount++;
+
+        auto entryIt{renderPassCache.try_emplace(std::move(metadata), RenderPassEntry{
+            .renderPass = std::move(renderPass),
+            .compatibilityKey = &compatibilityIt->first,
+            .compatibilityId = compatibilityIt->second.id,
+            .cycle = cycle,
+        }).first};
+
+        lru.push_front(&entryIt->first);
+        entryIt->second.lruIterator = lru.begin();
+        return {*entryIt->second.renderPass, entryIt->second.compatibilityId};
     }
 }
@@ -5,13 +5,26 @@
 
 #include <vulkan/vulkan_raii.hpp>
 #include <common.h>
+#include <gpu/fence_cycle.h>
 
 namespace skyline::gpu::cache {
     /**
-     * @brief A cache for Vulkan render passes to avoid unnecessary recreation and attain stability in handles for subsequent caches
+     * @brief A size-bounded LRU cache for Vulkan render passes to avoid unnecessary recreation and attain stability in handles for subsequent caches
+     * @details Every render pass is assigned the ID of its compatibility class, passes which only differ in their load/store operations and layouts are compatible and share the same ID so that objects which only depend on compatibility (framebuffers) can be shared between them
      */
     class RenderPassCache {
+      public:
+        /**
+         * @brief A render pass alongside the ID of the class of render passes it is compatible with
+         */
+        struct CachedRenderPass {
+            vk::RenderPass renderPass;
+            u64 compatibilityId; //!< A unique ID of the compatibility class of the render pass, this is never reused even after all passes of the class are evicted
+        };
+
       private:
+        static constexpr size_t MaxEntryCount{256}; //!< The maximum amount of render passes retained prior to the least recently used ones being evicted
+
         GPU &gpu;
         std::mutex mutex; //!< Synchronizes access to the cache
 
@@ -41,6 +54,12 @@ namespace skyline::gpu::cache {
 
             RenderPassMetadata(const vk::RenderPassCreateInfo &createInfo);
 
+            /**
+             * @return A copy of the metadata with all state that doesn't affect render pass compatibility reset, compatible render passes have identical canonical metadata
+             * @url https://registry.khronos.org/vulkan/specs/1.3-extensions/html/vkspec.html#renderpass-compatibility
+             */
+            RenderPassMetadata Canonicalize() const;
+
             bool operator==(const RenderPassMetadata &other) const = default;
         };
 
@@ -60,11 +79,35 @@ namespace skyline::gpu::cache {
             bool operator()(const RenderPassMetadata &lhs, const vk::RenderPassCreateInfo &rhs) const;
         };
 
-        std::unordered_map<RenderPassMetadata, vk::raii::RenderPass, RenderPassHash, RenderPassEqual> renderPassCache;
+        struct CompatibilityClass {
+            u64 id;
+            size_t renderPassCount; //!< The amount of cached render passes in this class, the class is removed once this reaches zero
+        };
+
+        struct RenderPassEntry {
+            vk::raii::RenderPass renderPass;
+            const RenderPassMetadata *compatibilityKey; //!< The key of the compatibility class of the render pass in `compatibilityClasses`
+            u64 compatibilityId;
+            IntrusivePtr<FenceCycle> cycle; //!< The latest cycle that the render pass was used in, it must not be destroyed till this is signalled
+            std::list<const RenderPassMetadata *>::iterator lruIterator;
+        };
+
+        std::unordered_map<RenderPassMetadata, RenderPassEntry, RenderPassHash, RenderPassEqual> renderPassCache;
+        std::list<const RenderPassMetadata *> lru; //!< The keys of all cached render passes ordered from most to least recently used
+        std::unordered_map<RenderPassMetadata, CompatibilityClass, RenderPassHash, RenderPassEqual> compatibilityClasses; //!< A map from canonical metadata to the compatibility class of all render passes with it
+        u64 nextCompatibilityId{1};
+
+        /**
+         * @brief Evicts the least recently used render pass, its destruction is deferred till the last cycle it was used in has been signalled
+         */
+        void EvictLeastRecentlyUsed();
 
       public:
         RenderPassCache(GPU &gpu);
 
-        vk::RenderPass GetRenderPass(const vk::RenderPassCreateInfo &createInfo);
+        /**
+         * @param cycle The cycle the render pass will be used in, the render pass is kept alive till it is signalled even if it's evicted prior to that
+         */
+        CachedRenderPass GetRenderPass(const vk::RenderPassCreateInfo &createInfo, const IntrusivePtr<FenceCycle> &cycle);
     };
 }
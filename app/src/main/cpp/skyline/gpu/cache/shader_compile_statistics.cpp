@@ -0,0 +1,76 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2023 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#include "shader_compile_statistics.h"
+
+namespace skyline::gpu::cache {
+    static constexpr std::array<std::string_view, ShaderCompileStatistics::PhaseCount> PhaseNames{"Decode", "Translate", "Emit", "Module", "Pipeline"};
+
+    ShaderCompileStatistics::~ShaderCompileStatistics() {
+        Log();
+    }
+
+    void ShaderCompileStatistics::RecordPhase(u64 shaderHash, Phase phase, u64 durationNs) {
+        auto index{static_cast<size_t>(phase)};
+        std::scoped_lock lock{mutex};
+        totals[index].count++;
+        totals[index].timeNs += durationNs;
+
+        if (shaderHash) {
+            auto &record{shaders[shaderHash][index]};
+            record.count++;
+            record.timeNs += durationNs;
+        }
+    }
+
+    void ShaderCompileStatistics::RecordPipeline(span<const u64> shaderHashes, u64 durationNs) {
+        auto index{static_cast<size_t>(Phase::Pipeline)};
+        std::scoped_lock lock{mutex};
+        totals[index].count++;
+        totals[index].timeNs += durationNs;
+
+        for (u64 shaderHash : shaderHashes) {
+            if (shaderHash) {
+                auto &record{shaders[shaderHash][index]};
+                record.count++;
+                record.timeNs += durationNs;
+            }
+        }
+    }
+
+    void ShaderCompileStatistics::Log() {
+        std::scoped_lock lock{mutex};
+        if (shaders.empty())
+            return;
+
+        auto totalTime{[](const ShaderRecord &record) {
+            u64 timeNs{};
+            for (const auto &phase : record)
+                timeNs += phase.timeNs;
+            return timeNs;
+        }};
+        auto formatPhases{[](const ShaderRecord &record) {
+            std::string phases;
+            for (size_t i{}; i < PhaseCount; i++)
+                if (record[i].count)
+                    phases += fmt::format("{}{}: {:.2f}ms ({})", phases.empty() ? "" : ", ", PhaseNames[i], static_cast<double>(record[i].timeNs) / constant::NsInMillisecond, record[i].count);
+            return phases;
+        }};
+
+        std::vector<std::pair<u64, const ShaderRecord *>> sorted;
+        sorted.reserve(shaders.size());
+        for (const auto &[hash, record] : shaders)
+            sorted.emplace_back(hash, &record);
+
+        auto reportedCount{std::min(sorted.size(), ReportedShaderCount)};
+        std::partial_sort(sorted.begin(), sorted.begin() + static_cast<ptrdiff_t>(reportedCount), sorted.end(), [&](const auto &a, const auto &b) {
+            return totalTime(*a.second) > totalTime(*b.second);
+        });
+
+        std::string report;
+        for (size_t i{}; i < reportedCount; i++)
+            report += fmt::format("\n* 0x{:016X}: {:.2f}ms in total, {}", sorted[i].first, static_cast<double>(totalTime(*sorted[i].second)) / constant::NsInMillisecond, formatPhases(*sorted[i].second));
+
+        Logger::Info("Shader compilation of {} shaders took {:.2f}ms in total, {}\nMost expensive shaders:{}", shaders.size(), static_cast<double>(totalTime(totals)) / constant::NsInMillisecond, formatPhases(totals), report);
+    }
+}
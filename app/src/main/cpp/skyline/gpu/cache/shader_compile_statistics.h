@@ -0,0 +1,78 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2023 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#pragma once
+
+#include <tsl/robin_map.h>
+#include <common.h>
+
+namespace skyline::gpu::cache {
+    /**
+     * @brief Aggregates the time spent in each phase of compiling guest shaders by the hash of the guest shader binary, this is logged on destruction
+     * @note This is used to determine if IR, SPIR-V or pipeline caching would be the most beneficial for a title
+     */
+    class ShaderCompileStatistics {
+      public:
+        enum class Phase : u8 {
+            Decode, //!< Decoding the Maxwell instructions of a guest shader into a control flow graph
+            Translate, //!< Constructing IR from the control flow graph and running all optimization passes over it, these are done together by the shader compiler
+            Emit, //!< Lowering legacy attributes and emitting SPIR-V for the IR
+            Module, //!< Creating a Vulkan shader module from the SPIR-V, this is skipped for SPIR-V that already has a module
+            Pipeline, //!< Creating the Vulkan pipeline that the shader is a part of, this is attributed to every shader of the pipeline
+        };
+        static constexpr size_t PhaseCount{5};
+
+        /**
+         * @brief Records the duration of a phase from construction till destruction
+         */
+        class ScopedPhase {
+          private:
+            ShaderCompileStatistics &statistics;
+            u64 shaderHash;
+            Phase phase;
+            i64 startTime;
+
+          public:
+            ScopedPhase(ShaderCompileStatistics &statistics, u64 shaderHash, Phase phase) : statistics{statistics}, shaderHash{shaderHash}, phase{phase}, startTime{util::GetTimeNs()} {}
+
+            ~ScopedPhase() {
+                statistics.RecordPhase(shaderHash, phase, static_cast<u64>(util::GetTimeNs() - startTime));
+            }
+        };
+
+      private:
+        static constexpr size_t ReportedShaderCount{16}; //!< The amount of the most expensive shaders that are logged individually
+
+        struct PhaseRecord {
+            u64 count; //!< The amount of times the phase was run
+            u64 timeNs; //!< The total time spent in the phase
+        };
+
+        using ShaderRecord = std::array<PhaseRecord, PhaseCount>;
+
+        std::mutex mutex; //!< Synchronizes access to all records, phases are only recorded on cache misses so contention is negligible
+        tsl::robin_map<u64, ShaderRecord> shaders;
+        ShaderRecord totals{}; //!< The sum of all phases, pipelines are only counted once here regardless of the amount of shaders in them
+
+      public:
+        ~ShaderCompileStatistics();
+
+        /**
+         * @brief Records the duration of a single run of a shader compilation phase
+         * @param shaderHash The hash of the guest shader binary, a hash of 0 is only counted in the totals
+         * @note This is thread-safe and may be called from pipeline compilation threads
+         */
+        void RecordPhase(u64 shaderHash, Phase phase, u64 durationNs);
+
+        /**
+         * @brief Records the creation of a pipeline and attributes it to all shaders that were a part of it
+         * @param shaderHashes The guest shader hashes of all stages of the pipeline, any hashes of 0 are ignored
+         */
+        void RecordPipeline(span<const u64> shaderHashes, u64 durationNs);
+
+        /**
+         * @brief Logs the totals of all phases alongside a breakdown of the most expensive shaders
+         */
+        void Log();
+    };
+}
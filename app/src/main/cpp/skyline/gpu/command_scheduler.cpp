@@ -3,6 +3,8 @@
 
 #include <gpu.h>
 #include <loader/loader.h>
+#include <common/trace.h>
+#include <common/performance_statistics.h>
 #include "command_scheduler.h"
 
 namespace skyline::gpu {
@@ -13,8 +15,11 @@ namespace skyline::gpu {
         try {
             signal::SetSignalHandler({SIGINT, SIGILL, SIGTRAP, SIGBUS, SIGFPE, SIGSEGV}, signal::ExceptionalSignalHandler);
 
-            cycleQueue.Process([](const std::shared_ptr<FenceCycle> &cycle) {
+            // Cycles on a timeline share a counter which is cached after every wait, so a single wait here can retire all subsequently queued cycles without further driver calls
+            cycleQueue.Process([](const IntrusivePtr<FenceCycle> &cycle) {
+                auto waitStart{util::GetTimeNs()};
                 cycle->Wait(true);
+                GetPerformanceStatistics().gpuBusyNs.fetch_add(static_cast<u64>(util::GetTimeNs() - waitStart), std::memory_order_relaxed);
             }, [] {});
         } catch (const signal::SignalException &e) {
             Logger::Error("{}\nStack Trace:{}", e.what(), state.loader->GetStackTrace(e.frames));
@@ -31,16 +36,17 @@ namespace skyline::gpu {
         }
     }
 
-    CommandScheduler::CommandBufferSlot::CommandBufferSlot(vk::raii::Device &device, vk::CommandBuffer commandBuffer, vk::raii::CommandPool &pool)
+    CommandScheduler::CommandBufferSlot::CommandBufferSlot(vk::raii::Device &device, vk::CommandBuffer commandBuffer, vk::raii::CommandPool &pool, FenceTimeline *timeline)
         : device{device},
           commandBuffer{device, static_cast<VkCommandBuffer>(commandBuffer), static_cast<VkCommandPool>(*pool)},
-          fence{device, vk::FenceCreateInfo{}},
-          semaphore{device, vk::SemaphoreCreateInfo{}},
-          cycle{std::make_shared<FenceCycle>(device, *fence, *semaphore)} {}
+          fence{timeline ? vk::raii::Fence{nullptr} : vk::raii::Fence{device, vk::FenceCreateInfo{}}},
+          semaphore{timeline ? vk::raii::Semaphore{nullptr} : vk::raii::Semaphore{device, vk::SemaphoreCreateInfo{}}},
+          cycle{timeline ? FenceCycle::Create(*timeline) : FenceCycle::Create(device, *fence, *semaphore)} {}
 
     CommandScheduler::CommandScheduler(const DeviceState &state, GPU &pGpu)
         : state{state},
           gpu{pGpu},
+          timeline{pGpu.traits.supportsTimelineSemaphores ? std::optional<FenceTimeline>{std::in_place, pGpu.vkDevice} : std::nullopt},
           waiterThread{&CommandScheduler::WaiterThread, this},
           pool{std::ref(pGpu.vkDevice), vk::CommandPoolCreateInfo{
               .flags = vk::CommandPoolCreateFlagBits::eTransient | vk::CommandPoolCreateFlagBits::eResetCommandBuffer,
@@ -56,7 +62,7 @@ namespace skyline::gpu {
             if (!slot.active.test_and_set(std::memory_order_acq_rel)) {
                 if (slot.cycle->Poll()) {
                     slot.commandBuffer.reset();
-                    slot.cycle = std::make_shared<FenceCycle>(*slot.cycle);
+                    slot.cycle = FenceCycle::Create(*slot.cycle);
                     return {slot};
                 } else {
                     slot.active.clear(std::memory_order_release);
@@ -74,10 +80,61 @@ namespace skyline::gpu {
         auto result{(*gpu.vkDevice).allocateCommandBuffers(&commandBufferAllocateInfo, &commandBuffer, *gpu.vkDevice.getDispatcher())};
         if (result != vk::Result::eSuccess)
             vk::throwResultException(result, __builtin_FUNCTION());
-        return {pool->buffers.emplace_back(gpu.vkDevice, commandBuffer, pool->vkCommandPool)};
+        return {pool->buffers.emplace_back(gpu.vkDevice, commandBuffer, pool->vkCommandPool, timeline ? &*timeline : nullptr)};
     }
 
-    void CommandScheduler::SubmitCommandBuffer(const vk::raii::CommandBuffer &commandBuffer, std::shared_ptr<FenceCycle> cycle, span<vk::Semaphore> waitSemaphores, span<vk::Semaphore> signalSemaphores) {
+    void CommandScheduler::WaitIdle() {
+        TRACE_EVENT("gpu", "CommandScheduler::WaitIdle");
+        std::scoped_lock lock{gpu.queueMutex};
+        gpu.vkQueue.waitIdle();
+    }
+
+    IntrusivePtr<FenceCycle> CommandScheduler::CreateSlotCycle(vk::Fence fence, vk::Semaphore semaphore, bool signalled) {
+        if (timeline)
+            return FenceCycle::Create(*timeline, signalled);
+        else
+            return FenceCycle::Create(gpu.vkDevice, fence, semaphore, signalled);
+    }
+
+    void CommandScheduler::SubmitCommandBuffer(const vk::raii::CommandBuffer &commandBuffer, const IntrusivePtr<FenceCycle> &cycle, span<vk::Semaphore> waitSemaphores, span<vk::Semaphore> signalSemaphores, span<u64> waitSemaphoreValues) {
+        if (cycle->timeline) {
+            boost::container::small_vector<vk::PipelineStageFlags, 3> waitStages{waitSemaphores.size(), vk::PipelineStageFlagBits::eAllCommands};
+            boost::container::small_vector<u64, 3> waitValues(waitSemaphores.size()); // Binary semaphores ignore their values so these can be left as 0
+            std::copy_n(waitSemaphoreValues.begin(), std::min(waitSemaphoreValues.size(), waitSemaphores.size()), waitValues.begin());
+
+            boost::container::small_vector<vk::Semaphore, 2> fullSignalSemaphores{signalSemaphores.begin(), signalSemaphores.end()};
+            fullSignalSemaphores.push_back(*cycle->timeline->semaphore);
+            boost::container::small_vector<u64, 2> signalValues(fullSignalSemaphores.size());
+
+            {
+                std::scoped_lock lock{gpu.queueMutex};
+                // Values must be assigned in submission order as a timeline semaphore must be signalled with strictly increasing values
+                cycle->timelineValue = signalValues.back() = ++cycle->timeline->lastSubmittedValue;
+
+                vk::TimelineSemaphoreSubmitInfo timelineSubmitInfo{
+                    .waitSemaphoreValueCount = static_cast<u32>(waitValues.size()),
+                    .pWaitSemaphoreValues = waitValues.data(),
+                    .signalSemaphoreValueCount = static_cast<u32>(signalValues.size()),
+                    .pSignalSemaphoreValues = signalValues.data(),
+                };
+
+                gpu.vkQueue.submit(vk::SubmitInfo{
+                    .pNext = &timelineSubmitInfo,
+                    .waitSemaphoreCount = static_cast<u32>(waitSemaphores.size()),
+                    .pWaitSemaphores = waitSemaphores.data(),
+                    .pWaitDstStageMask = waitStages.data(),
+                    .commandBufferCount = 1,
+                    .pCommandBuffers = &*commandBuffer,
+                    .signalSemaphoreCount = static_cast<u32>(fullSignalSemaphores.size()),
+                    .pSignalSemaphores = fullSignalSemaphores.data(),
+                });
+            }
+
+            cycle->NotifySubmitted();
+            cycleQueue.Push(cycle);
+            return;
+        }
+
         boost::container::small_vector<vk::Semaphore, 3> fullWaitSemaphores{waitSemaphores.begin(), waitSemaphores.end()};
         boost::container::small_vector<vk::PipelineStageFlags, 3> fullWaitStages{waitSemaphores.size(), vk::PipelineStageFlagBits::eAllCommands};
 
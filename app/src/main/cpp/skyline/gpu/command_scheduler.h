@@ -20,11 +20,11 @@ namespace skyline::gpu {
             std::atomic_flag active{true}; //!< If the command buffer is currently being recorded to
             const vk::raii::Device &device;
             vk::raii::CommandBuffer commandBuffer;
-            vk::raii::Fence fence; //!< A fence used for tracking all submits of a buffer
-            vk::raii::Semaphore semaphore; //!< A semaphore used for tracking work status on the GPU
-            std::shared_ptr<FenceCycle> cycle; //!< The latest cycle on the fence, all waits must be performed through this
+            vk::raii::Fence fence; //!< A fence used for tracking all submits of a buffer, this is null when cycles are tracked on a timeline
+            vk::raii::Semaphore semaphore; //!< A semaphore used for tracking work status on the GPU, this is null when cycles are tracked on a timeline
+            IntrusivePtr<FenceCycle> cycle; //!< The latest cycle on the fence, all waits must be performed through this
 
-            CommandBufferSlot(vk::raii::Device &device, vk::CommandBuffer commandBuffer, vk::raii::CommandPool &pool);
+            CommandBufferSlot(vk::raii::Device &device, vk::CommandBuffer commandBuffer, vk::raii::CommandPool &pool, FenceTimeline *timeline);
         };
 
         const DeviceState &state;
@@ -43,9 +43,13 @@ namespace skyline::gpu {
         };
         ThreadLocal<CommandPool> pool;
 
+      public:
+        std::optional<FenceTimeline> timeline; //!< The timeline all cycles are tracked on if timeline semaphores are supported, otherwise every cycle uses its own fence and binary semaphore
+
+      private:
         std::thread waiterThread; //!< A thread that waits on and signals FenceCycle(s) then clears any associated resources
         static constexpr size_t FenceCycleWaitCount{256}; //!< The amount of fence cycles the cycle queue can hold
-        CircularQueue<std::shared_ptr<FenceCycle>> cycleQueue{FenceCycleWaitCount}; //!< A circular queue containing all the active cycles that can be waited on
+        CircularQueue<IntrusivePtr<FenceCycle>> cycleQueue{FenceCycleWaitCount}; //!< A circular queue containing all the active cycles that can be waited on
 
         void WaiterThread();
 
@@ -77,7 +81,7 @@ namespace skyline::gpu {
                 return *slot->fence;
             }
 
-            std::shared_ptr<FenceCycle> GetFenceCycle() {
+            IntrusivePtr<FenceCycle> GetFenceCycle() {
                 return slot->cycle;
             }
 
@@ -93,9 +97,9 @@ namespace skyline::gpu {
              * @brief Resets the state of the command buffer with a new FenceCycle
              * @note This should be used when a single allocated command buffer is used for all submissions from a component
              */
-            std::shared_ptr<FenceCycle> Reset() {
+            IntrusivePtr<FenceCycle> Reset() {
                 slot->cycle->Wait();
-                slot->cycle = std::make_shared<FenceCycle>(*slot->cycle);
+                slot->cycle = FenceCycle::Create(*slot->cycle);
                 slot->commandBuffer.reset();
                 return slot->cycle;
             }
@@ -110,20 +114,33 @@ namespace skyline::gpu {
          */
         ActiveCommandBuffer AllocateCommandBuffer();
 
+        /**
+         * @brief Creates a cycle for a command buffer slot which owns the supplied fence and semaphore, these are null and unused if cycles are tracked on a timeline
+         */
+        IntrusivePtr<FenceCycle> CreateSlotCycle(vk::Fence fence, vk::Semaphore semaphore, bool signalled = false);
+
         /**
          * @brief Submits a single command buffer to the GPU queue while queuing it up to be waited on
+         * @param waitSemaphoreValues The values to wait on for any timeline semaphores in waitSemaphores, entries for binary semaphores are ignored and this may be empty if there are no timeline semaphores
          * @note The supplied command buffer and cycle **must** be from AllocateCommandBuffer()
          * @note Any cycle submitted via this method does not need to destroy dependencies manually, the waiter thread will handle this
          */
-        void SubmitCommandBuffer(const vk::raii::CommandBuffer &commandBuffer, std::shared_ptr<FenceCycle> cycle, span<vk::Semaphore> waitSemaphores = {}, span<vk::Semaphore> signalSemaphore = {});
+        void SubmitCommandBuffer(const vk::raii::CommandBuffer &commandBuffer, const IntrusivePtr<FenceCycle> &cycle, span<vk::Semaphore> waitSemaphores = {}, span<vk::Semaphore> signalSemaphore = {}, span<u64> waitSemaphoreValues = {});
+
+        /**
+         * @brief Blocks till all work submitted to the GPU queue has completed
+         * @note Cycles are still retired asynchronously by the waiter thread, their dependencies can be destroyed early by polling them
+         */
+        void WaitIdle();
 
         /**
          * @brief Submits a command buffer recorded with the supplied function synchronously
          * @param waitSemaphores A span of all (excl fence cycle) semaphores that should be waited on by the GPU before executing the command buffer
          * @param signalSemaphore A span of all semaphores that should be signalled by the GPU after executing the command buffer
+         * @param waitSemaphoreValues The values to wait on for any timeline semaphores in waitSemaphores
          */
         template<typename RecordFunction>
-        std::shared_ptr<FenceCycle> Submit(RecordFunction recordFunction, span<vk::Semaphore> waitSemaphores = {}, span<vk::Semaphore> signalSemaphores = {}) {
+        IntrusivePtr<FenceCycle> Submit(RecordFunction recordFunction, span<vk::Semaphore> waitSemaphores = {}, span<vk::Semaphore> signalSemaphores = {}, span<u64> waitSemaphoreValues = {}) {
             auto commandBuffer{AllocateCommandBuffer()};
             try {
                 commandBuffer->begin(vk::CommandBufferBeginInfo{
@@ -133,7 +150,7 @@ namespace skyline::gpu {
                 commandBuffer->end();
 
                 auto cycle{commandBuffer.GetFenceCycle()};
-                SubmitCommandBuffer(*commandBuffer, cycle, waitSemaphores, signalSemaphores);
+                SubmitCommandBuffer(*commandBuffer, cycle, waitSemaphores, signalSemaphores, waitSemaphoreValues);
                 return cycle;
             } catch (...) {
                 commandBuffer.GetFenceCycle()->Cancel();
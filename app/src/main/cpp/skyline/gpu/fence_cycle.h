@@ -7,16 +7,93 @@
 #include <vulkan/vulkan_raii.hpp>
 #include <common.h>
 #include <common/atomic_forward_list.h>
+#include <common/intrusive_ptr.h>
+#include <common/pool_allocator.h>
 
 namespace skyline::gpu {
     class CommandScheduler;
 
+    /**
+     * @brief A timeline semaphore which is signalled with a monotonically increasing value by every submission to a queue, this allows cycles to be tracked without any per-cycle fences or binary semaphores
+     * @note The counter value is cached so that checking if a value has been reached usually doesn't require any calls into the driver
+     */
+    struct FenceTimeline {
+        const vk::raii::Device &device;
+        vk::raii::Semaphore semaphore;
+        u64 lastSubmittedValue{}; //!< The value signalled by the latest submission on the timeline, this must only be accessed while holding the queue mutex
+        std::atomic<u64> completedValue{}; //!< The highest value the semaphore is known to have been signalled with
+
+        static vk::raii::Semaphore CreateSemaphore(const vk::raii::Device &device) {
+            vk::SemaphoreTypeCreateInfo semaphoreTypeCreateInfo{
+                .semaphoreType = vk::SemaphoreType::eTimeline,
+                .initialValue = 0,
+            };
+            return vk::raii::Semaphore{device, vk::SemaphoreCreateInfo{
+                .pNext = &semaphoreTypeCreateInfo,
+            }};
+        }
+
+        FenceTimeline(const vk::raii::Device &device) : device{device}, semaphore{CreateSemaphore(device)} {}
+
+        /**
+         * @brief Reads the current counter value of the semaphore from the driver and updates the cached value with it
+         * @return The highest value the semaphore is known to have been signalled with
+         */
+        u64 Update() {
+            u64 value{};
+            auto result{(*device).getSemaphoreCounterValueKHR(*semaphore, &value, *device.getDispatcher())};
+            if (result != vk::Result::eSuccess)
+                throw exception("An error occurred while reading the value of timeline semaphore 0x{:X}: {}", static_cast<VkSemaphore>(*semaphore), vk::to_string(result));
+
+            u64 completed{completedValue.load(std::memory_order_relaxed)};
+            while (completed < value && !completedValue.compare_exchange_weak(completed, value, std::memory_order_release, std::memory_order_relaxed));
+            return std::max(completed, value);
+        }
+
+        /**
+         * @param quick Skips reading the counter value from the driver, just checking the cached value
+         * @return If the semaphore has been signalled with a value equal to or above the supplied value
+         */
+        bool Poll(u64 value, bool quick = false) {
+            if (completedValue.load(std::memory_order_acquire) >= value)
+                return true;
+            return !quick && Update() >= value;
+        }
+
+        /**
+         * @brief Blocks till the semaphore has been signalled with a value equal to or above the supplied value
+         * @note Any later values that have been reached by the time this returns are cached, this lets a single wait cover subsequent cycles
+         */
+        void Wait(u64 value) {
+            if (Poll(value, true))
+                return;
+
+            vk::SemaphoreWaitInfo waitInfo{
+                .semaphoreCount = 1,
+                .pSemaphores = &*semaphore,
+                .pValues = &value,
+            };
+
+            vk::Result waitResult;
+            while ((waitResult = (*device).waitSemaphoresKHR(&waitInfo, std::numeric_limits<u64>::max(), *device.getDispatcher())) != vk::Result::eSuccess) {
+                if (waitResult == vk::Result::eTimeout || waitResult == vk::Result::eErrorInitializationFailed)
+                    // See FenceCycle::Wait for why eErrorInitializationFailed is retried
+                    continue;
+
+                throw exception("An error occurred while waiting for timeline semaphore 0x{:X}: {}", static_cast<VkSemaphore>(*semaphore), vk::to_string(waitResult));
+            }
+
+            Update();
+        }
+    };
+
     /**
      * @brief A wrapper around a Vulkan Fence which only tracks a single reset -> signal cycle with the ability to attach lifetimes of objects to it
      * @note This provides the guarantee that the fence must be signalled prior to destruction when objects are to be destroyed
      * @note All waits to the fence **must** be done through the same instance of this, the state of the fence changing externally will lead to UB
+     * @note If the cycle is on a timeline, it's tracked by the value the timeline semaphore is signalled with by its submission rather than by a fence and binary semaphore
      */
-    struct FenceCycle {
+    struct FenceCycle : IntrusiveRefCounted<FenceCycle, PoolAllocator<FenceCycle>> {
       private:
         std::atomic_flag signalled{}; //!< If the underlying fence has been signalled since the creation of this FenceCycle, this doesn't necessarily mean the dependencies have been destroyed
         std::atomic_flag alreadyDestroyed{}; //!< If the cycle's dependencies are already destroyed, this prevents multiple destructions
@@ -28,12 +105,17 @@ namespace skyline::gpu {
         vk::Semaphore semaphore; //!< Semaphore that will be signalled upon GPU completion of the fence
         bool semaphoreSubmitWait{}; //!< If the semaphore needs to be waited on (on GPU) before the fence's command buffer begins. Used to ensure fences that wouldn't otherwise be unsignalled are unsignalled
         bool nextSemaphoreSubmitWait{true}; //!< If the next fence cycle created from this one after it's signalled should wait on the semaphore to unsignal it
-        std::shared_ptr<FenceCycle> semaphoreUnsignalCycle{}; //!< If the semaphore is used on the GPU, the cycle for the submission that uses it, so it can be waited on before the fence is signalled to ensure the semaphore is unsignalled
+        IntrusivePtr<FenceCycle> semaphoreUnsignalCycle{}; //!< If the semaphore is used on the GPU, the cycle for the submission that uses it, so it can be waited on before the fence is signalled to ensure the semaphore is unsignalled
+        FenceTimeline *timeline{}; //!< The timeline this cycle is tracked on, if this is null then the cycle uses the fence and semaphore
+        u64 timelineValue{}; //!< The value the timeline semaphore will be signalled with upon GPU completion, this is assigned on submission
 
         friend CommandScheduler;
 
-        AtomicForwardList<std::shared_ptr<void>> dependencies; //!< A list of all dependencies on this fence cycle
-        AtomicForwardList<std::shared_ptr<FenceCycle>> chainedCycles; //!< A list of all chained FenceCycles, this is used to express multi-fence dependencies
+        static constexpr size_t InlineDependencyCount{32}; //!< The amount of dependencies that can be attached without any heap allocations, this covers the majority of submissions
+        static constexpr size_t InlineChainedCycleCount{4}; //!< The amount of cycles that can be chained without any heap allocations
+
+        AtomicForwardList<std::shared_ptr<void>, InlineDependencyCount> dependencies; //!< A list of all dependencies on this fence cycle
+        AtomicForwardList<IntrusivePtr<FenceCycle>, InlineChainedCycleCount> chainedCycles; //!< A list of all chained FenceCycles, this is used to express multi-fence dependencies
 
         /**
          * @brief Destroy all the dependencies of this cycle
@@ -50,14 +132,26 @@ namespace skyline::gpu {
                 device.resetFences(fence);
         }
 
-        explicit FenceCycle(const FenceCycle &cycle) : signalled{false}, device{cycle.device}, fence{cycle.fence}, semaphore{cycle.semaphore}, semaphoreSubmitWait{cycle.nextSemaphoreSubmitWait} {
-            device.resetFences(fence);
+        FenceCycle(FenceTimeline &timeline, bool signalled = false) : signalled{signalled}, device{timeline.device}, nextSemaphoreSubmitWait{false}, timeline{&timeline} {}
+
+        explicit FenceCycle(const FenceCycle &cycle) : signalled{false}, device{cycle.device}, fence{cycle.fence}, semaphore{cycle.semaphore}, semaphoreSubmitWait{cycle.nextSemaphoreSubmitWait}, nextSemaphoreSubmitWait{!cycle.timeline}, timeline{cycle.timeline} {
+            if (!timeline)
+                device.resetFences(fence);
         }
 
         ~FenceCycle() {
             Wait();
         }
 
+        /**
+         * @brief Creates a cycle with the supplied constructor arguments, the storage for it is pooled to avoid a heap allocation for every submission
+         * @note Cycles are intrusively reference counted as they're copied into every resource and chained cycle list that's used by a submission
+         */
+        template<typename... Args>
+        static IntrusivePtr<FenceCycle> Create(Args &&... args) {
+            return AllocateIntrusive<FenceCycle>(PoolAllocator<FenceCycle>{}, std::forward<Args>(args)...);
+        }
+
         /**
          * @brief Signals this fence regardless of if the underlying fence has been signalled or not
          */
@@ -68,11 +162,19 @@ namespace skyline::gpu {
 
         /**
          * @brief Executes a function with the fence locked to record a usage of its semaphore, if no semaphore can be provided then a CPU-side wait will be performed instead
+         * @note The value supplied alongside the semaphore is the value that must be waited on if it is a timeline semaphore, it is 0 for binary semaphores
          */
-        std::shared_ptr<FenceCycle> RecordSemaphoreWaitUsage(std::function<std::shared_ptr<FenceCycle>(vk::Semaphore sema)> &&func) {
+        IntrusivePtr<FenceCycle> RecordSemaphoreWaitUsage(std::function<IntrusivePtr<FenceCycle>(vk::Semaphore sema, u64 semaValue)> &&func) {
             // We can't submit any semaphore waits until the signal has been submitted, so do that first
             WaitSubmit();
 
+            if (timeline) {
+                // Timeline semaphores aren't unsignalled by waits so any amount of usages can be recorded
+                if (Poll(false))
+                    return func({}, 0);
+                return func(*timeline->semaphore, timelineValue);
+            }
+
             std::unique_lock lock{mutex};
 
             // If we already have a semaphore usage, just wait on the fence since we can't wait on it twice and have no way to add one after the fact
@@ -81,14 +183,14 @@ namespace skyline::gpu {
                 lock.unlock();
 
                 Wait();
-                return func({});
+                return func({}, 0);
             }
 
             // If we're already signalled then there's no need to wait on the semaphore
             if (signalled.test(std::memory_order_relaxed))
-                return func({});
+                return func({}, 0);
 
-            semaphoreUnsignalCycle = func(semaphore);
+            semaphoreUnsignalCycle = func(semaphore, 0);
             nextSemaphoreSubmitWait = false; // We don't need a semaphore wait on the next fence cycle to unsignal the semaphore anymore as the usage will do that
             return semaphoreUnsignalCycle;
         }
@@ -141,6 +243,15 @@ namespace skyline::gpu {
                 return;
             }
 
+            if (timeline) {
+                timeline->Wait(timelineValue);
+
+                signalled.test_and_set(std::memory_order_relaxed);
+                if (shouldDestroy)
+                    DestroyDependencies();
+                return;
+            }
+
             vk::Result waitResult;
             while ((waitResult = (*device).waitForFences(1, &fence, false, std::numeric_limits<u64>::max(), *device.getDispatcher())) != vk::Result::eSuccess) {
                 if (waitResult == vk::Result::eTimeout)
@@ -192,6 +303,16 @@ namespace skyline::gpu {
             if (!submitted)
                 return false;
 
+            if (timeline) {
+                if (!timeline->Poll(timelineValue))
+                    return false;
+
+                signalled.test_and_set(std::memory_order_relaxed);
+                if (shouldDestroy)
+                    DestroyDependencies();
+                return true;
+            }
+
             auto status{(*device).getFenceStatus(fence, *device.getDispatcher())};
             if (status == vk::Result::eSuccess) {
                 if (semaphoreUnsignalCycle && !semaphoreUnsignalCycle->Poll())
@@ -223,11 +344,34 @@ namespace skyline::gpu {
                 dependencies.Append(pDependencies...);
         }
 
+        /**
+         * @brief Runs a callback after the fence has been signalled, this is done when the dependencies of the cycle are destroyed which is usually on the cycle waiter thread
+         * @note The callback is run immediately if the cycle has already been signalled
+         * @note The callback must not block on anything that could be waiting on this cycle, any exceptions thrown by it are logged and otherwise ignored
+         */
+        void AttachCallback(std::function<void()> &&callback) {
+            struct Callback {
+                std::function<void()> function;
+
+                Callback(std::function<void()> &&function) : function{std::move(function)} {}
+
+                ~Callback() {
+                    try {
+                        function();
+                    } catch (const std::exception &e) {
+                        Logger::Error("Exception in fence cycle callback: {}", e.what());
+                    }
+                }
+            };
+
+            AttachObject(std::allocate_shared<Callback>(PoolAllocator<Callback>{}, std::move(callback)));
+        }
+
         /**
          * @brief Chains another cycle to this cycle, this cycle will not be signalled till the supplied cycle is signalled
          * @param cycle The cycle to chain to this one, this is nullable and this function will be a no-op if this is nullptr
          */
-        void ChainCycle(const std::shared_ptr<FenceCycle> &cycle) {
+        void ChainCycle(const IntrusivePtr<FenceCycle> &cycle) {
             if (cycle && !signalled.test(std::memory_order_consume) && cycle.get() != this && !cycle->Poll())
                 chainedCycles.Append(cycle); // If the cycle isn't the current cycle or already signalled, we need to chain it
         }
@@ -0,0 +1,85 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2023 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#include <gpu/buffer.h>
+#include "barrier_tracker.h"
+
+namespace skyline::gpu::interconnect {
+    ResourceAccess ResourceAccess::Of(const BufferView &view, bool write, vk::DeviceSize offset, vk::DeviceSize size) {
+        auto buffer{view.GetBuffer()};
+        const auto &guest{buffer->GetGuest()};
+        auto base{guest ? reinterpret_cast<uintptr_t>(guest->data()) : reinterpret_cast<uintptr_t>(buffer)};
+        auto begin{base + view.GetOffset() + offset};
+        return {begin, begin + (size ? size : view.size - offset), write};
+    }
+
+    bool BarrierTracker::RequiresBarrier(span<const ResourceAccess> accesses) const {
+        if (workStages || transferAccesses.size() + accesses.size() > MaxTrackedAccesses)
+            return true;
+
+        return std::any_of(accesses.begin(), accesses.end(), [&](const ResourceAccess &access) {
+            return std::any_of(transferAccesses.begin(), transferAccesses.end(), [&](const ResourceAccess &prior) {
+                return (access.write || prior.write) && access.Overlaps(prior);
+            });
+        });
+    }
+
+    PipelineBarrier BarrierTracker::TrackTransfer(span<const ResourceAccess> accesses) {
+        PipelineBarrier barrier{};
+        if (workStages) {
+            // The work may have accessed any resource, its stages are waited on as a whole
+            barrier.srcStages = workStages;
+            barrier.srcAccess = vk::AccessFlagBits::eMemoryWrite;
+            workStages = {};
+        }
+
+        if (RequiresBarrier(accesses)) {
+            // Only overlapping transfers are hazards but a barrier orders all prior transfers, so none of them need to be tracked after it
+            if (!transferAccesses.empty()) {
+                barrier.srcStages |= vk::PipelineStageFlagBits::eTransfer;
+                if (transferWrites)
+                    barrier.srcAccess |= vk::AccessFlagBits::eTransferWrite;
+            }
+            transferAccesses.clear();
+            transferWrites = false;
+        }
+
+        if (barrier) {
+            barrier.dstStages = vk::PipelineStageFlagBits::eTransfer;
+            barrier.dstAccess = vk::AccessFlagBits::eTransferRead | vk::AccessFlagBits::eTransferWrite;
+        }
+
+        for (const auto &access : accesses) {
+            if (transferAccesses.size() == MaxTrackedAccesses)
+                break; // RequiresBarrier will conservatively synchronize the next transfer with this one
+            transferAccesses.push_back(access);
+            transferWrites |= access.write;
+        }
+
+        return barrier;
+    }
+
+    PipelineBarrier BarrierTracker::TrackWork(vk::PipelineStageFlags stages) {
+        PipelineBarrier barrier{};
+        if (!transferAccesses.empty()) {
+            // Later transfers are included in the destination so they're ordered after the pending transfers without tracking them any further
+            barrier = {
+                .srcStages = vk::PipelineStageFlagBits::eTransfer,
+                .dstStages = stages | vk::PipelineStageFlagBits::eTransfer,
+                .srcAccess = transferWrites ? vk::AccessFlagBits::eTransferWrite : vk::AccessFlags{},
+                .dstAccess = vk::AccessFlagBits::eMemoryRead | vk::AccessFlagBits::eMemoryWrite,
+            };
+            transferAccesses.clear();
+            transferWrites = false;
+        }
+
+        workStages |= stages;
+        return barrier;
+    }
+
+    void BarrierTracker::Reset() {
+        workStages = {};
+        transferAccesses.clear();
+        transferWrites = false;
+    }
+}
@@ -0,0 +1,92 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2023 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#pragma once
+
+#include <boost/container/small_vector.hpp>
+#include <vulkan/vulkan_raii.hpp>
+#include <common.h>
+
+namespace skyline::gpu {
+    class BufferView;
+}
+
+namespace skyline::gpu::interconnect {
+    /**
+     * @brief A range of a resource that's accessed by a transfer command, buffers are identified by their guest mappings so that accesses are comparable regardless of buffer recreation while other resources are identified by their address
+     */
+    struct ResourceAccess {
+        uintptr_t begin;
+        uintptr_t end;
+        bool write;
+
+        /**
+         * @note The view **must** be locked prior to calling this
+         */
+        static ResourceAccess Of(const BufferView &view, bool write, vk::DeviceSize offset = 0, vk::DeviceSize size = 0);
+
+        static ResourceAccess Of(const void *resource, bool write) {
+            auto address{reinterpret_cast<uintptr_t>(resource)};
+            return {address, address + 1, write};
+        }
+
+        bool Overlaps(const ResourceAccess &other) const {
+            return begin < other.end && other.begin < end;
+        }
+    };
+
+    /**
+     * @brief A pipeline barrier with a single global memory barrier, this is empty if no barrier is required
+     */
+    struct PipelineBarrier {
+        vk::PipelineStageFlags srcStages;
+        vk::PipelineStageFlags dstStages;
+        vk::AccessFlags srcAccess;
+        vk::AccessFlags dstAccess;
+
+        explicit operator bool() const {
+            return static_cast<bool>(srcStages);
+        }
+
+        void Record(vk::raii::CommandBuffer &commandBuffer) const {
+            commandBuffer.pipelineBarrier(srcStages, dstStages, {}, vk::MemoryBarrier{
+                .srcAccessMask = srcAccess,
+                .dstAccessMask = dstAccess,
+            }, {}, {});
+        }
+    };
+
+    /**
+     * @brief Tracks the accesses of the commands in an execution in their recording order to determine the minimal barriers required between them
+     * @details Transfers (DMA, inline uploads, copies) are tracked per resource range, they're only synchronized with each other when they access overlapping ranges and at least one of them writes. Other work (render passes and compute) is only tracked by the pipeline stages it uses, any transfer after such work waits on those stages and the writes of all pending transfers are made visible with a single barrier prior to the next work
+     * @note The start of every execution is fully synchronized with prior executions, so the tracker is reset for each one
+     */
+    class BarrierTracker {
+      private:
+        static constexpr size_t MaxTrackedAccesses{64}; //!< The maximum amount of transfer accesses tracked between barriers, transfers beyond this are conservatively synchronized with all prior ones
+
+        vk::PipelineStageFlags workStages{}; //!< The stages of all work since the last barrier that transfers were synchronized with
+        boost::container::small_vector<ResourceAccess, MaxTrackedAccesses> transferAccesses; //!< All transfer accesses since the last barrier that synchronized them with later work
+        bool transferWrites{}; //!< If any of the transfer accesses are writes
+
+      public:
+        /**
+         * @return If a transfer with the supplied accesses would require a barrier prior to it
+         */
+        bool RequiresBarrier(span<const ResourceAccess> accesses) const;
+
+        /**
+         * @brief Tracks a transfer with the supplied accesses
+         * @return The barrier that must be recorded prior to the transfer
+         */
+        PipelineBarrier TrackTransfer(span<const ResourceAccess> accesses);
+
+        /**
+         * @brief Tracks non-transfer work which uses the supplied stages
+         * @return The barrier that must be recorded prior to the work
+         */
+        PipelineBarrier TrackWork(vk::PipelineStageFlags stages);
+
+        void Reset();
+    };
+}
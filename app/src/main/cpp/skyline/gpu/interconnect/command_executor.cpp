@@ -3,6 +3,7 @@
 
 #include <range/v3/view.hpp>
 #include <common/settings.h>
+#include <common/performance_statistics.h>
 #include <loader/loader.h>
 #include <gpu.h>
 #include <dlfcn.h>
@@ -22,16 +23,25 @@ namespace skyline::gpu::interconnect {
         slot.Begin();
     }
 
-    static vk::raii::CommandBuffer AllocateRaiiCommandBuffer(GPU &gpu, vk::raii::CommandPool &pool) {
+    static vk::raii::CommandBuffer AllocateRaiiCommandBuffer(GPU &gpu, vk::raii::CommandPool &pool, vk::CommandBufferLevel level = vk::CommandBufferLevel::ePrimary) {
         return {gpu.vkDevice, (*gpu.vkDevice).allocateCommandBuffers(
                     {
                         .commandPool = *pool,
-                        .level = vk::CommandBufferLevel::ePrimary,
+                        .level = level,
                         .commandBufferCount = 1
                     }, *gpu.vkDevice.getDispatcher()).front(),
                 *pool};
     }
 
+    CommandRecordThread::Slot::SecondaryCommandBuffer::SecondaryCommandBuffer(GPU &gpu)
+        : commandPool{gpu.vkDevice,
+                      vk::CommandPoolCreateInfo{
+                          .flags = vk::CommandPoolCreateFlagBits::eResetCommandBuffer | vk::CommandPoolCreateFlagBits::eTransient,
+                          .queueFamilyIndex = gpu.vkQueueFamilyIndex
+                      }
+          },
+          commandBuffer{AllocateRaiiCommandBuffer(gpu, commandPool, vk::CommandBufferLevel::eSecondary)} {}
+
     CommandRecordThread::Slot::Slot(GPU &gpu)
         : commandPool{gpu.vkDevice,
                       vk::CommandPoolCreateInfo{
@@ -40,27 +50,30 @@ namespace skyline::gpu::interconnect {
                       }
           },
           commandBuffer{AllocateRaiiCommandBuffer(gpu, commandPool)},
-          fence{gpu.vkDevice, vk::FenceCreateInfo{ .flags = vk::FenceCreateFlagBits::eSignaled }},
-          semaphore{gpu.vkDevice, vk::SemaphoreCreateInfo{}},
-          cycle{std::make_shared<FenceCycle>(gpu.vkDevice, *fence, *semaphore, true)} {
+          fence{gpu.scheduler.timeline ? vk::raii::Fence{nullptr} : vk::raii::Fence{gpu.vkDevice, vk::FenceCreateInfo{ .flags = vk::FenceCreateFlagBits::eSignaled }}},
+          semaphore{gpu.scheduler.timeline ? vk::raii::Semaphore{nullptr} : vk::raii::Semaphore{gpu.vkDevice, vk::SemaphoreCreateInfo{}}},
+          cycle{gpu.scheduler.CreateSlotCycle(*fence, *semaphore, true)} {
         Begin();
     }
 
     CommandRecordThread::Slot::Slot(Slot &&other)
         : commandPool{std::move(other.commandPool)},
           commandBuffer{std::move(other.commandBuffer)},
+          secondaryCommandBuffers{std::move(other.secondaryCommandBuffers)},
           fence{std::move(other.fence)},
           semaphore{std::move(other.semaphore)},
           cycle{std::move(other.cycle)},
           ready{other.ready} {}
 
-    std::shared_ptr<FenceCycle> CommandRecordThread::Slot::Reset(GPU &gpu) {
+    IntrusivePtr<FenceCycle> CommandRecordThread::Slot::Reset(GPU &gpu) {
         auto startTime{util::GetTimeNs()};
 
         cycle->Wait();
-        cycle = std::make_shared<FenceCycle>(*cycle);
-        if (util::GetTimeNs() - startTime > GrowThresholdNs)
+        cycle = FenceCycle::Create(*cycle);
+        if (auto endTime{util::GetTimeNs()}; endTime - startTime > GrowThresholdNs) {
             didWait = true;
+            latencyNs = endTime - releaseTime; // As the GPU work only just completed, this is an accurate measure of the latency from the slot's release
+        }
 
         // Command buffer doesn't need to be reset since that's done implicitly by begin
         return cycle;
@@ -81,16 +94,95 @@ namespace skyline::gpu::interconnect {
         beginCondition.notify_all();
     }
 
+    bool CommandRecordThread::RecordRenderPassChunks(Slot *slot, node::RenderPassNode &renderPassNode, NodeIterator &it, size_t &secondaryIndex) {
+        using namespace node;
+
+        // Split the render pass into chunks at every boundary, any node other than a subpass function implies multiple subpasses which can't be recorded into secondary command buffers
+        boost::container::small_vector<std::pair<NodeIterator, NodeIterator>, 8> chunks;
+        auto chunkBegin{std::next(it)}, end{chunkBegin};
+        for (; end != slot->nodes.end() && !std::holds_alternative<RenderPassEndNode>(*end); ++end) {
+            if (std::holds_alternative<SubpassChunkBoundaryNode>(*end)) {
+                if (chunkBegin != end)
+                    chunks.emplace_back(chunkBegin, end);
+                chunkBegin = std::next(end);
+            } else if (!std::holds_alternative<SubpassFunctionNode>(*end)) {
+                return false;
+            }
+        }
+
+        if (end == slot->nodes.end())
+            return false;
+
+        if (chunkBegin != end)
+            chunks.emplace_back(chunkBegin, end);
+
+        if (chunks.size() < MinParallelChunkCount)
+            return false;
+
+        TRACE_EVENT("gpu", "CommandRecordThread::RecordRenderPassChunks", "chunks", chunks.size());
+        auto &gpu{*state.gpu};
+        vk::RenderPass lRenderPass{renderPassNode(slot->commandBuffer, slot->cycle, gpu, vk::SubpassContents::eSecondaryCommandBuffers)};
+
+        while (slot->secondaryCommandBuffers.size() < secondaryIndex + chunks.size())
+            slot->secondaryCommandBuffers.emplace_back(gpu);
+
+        gpu.commandRecordPool.ParallelFor(chunks.size(), [&](size_t index) {
+            auto &commandBuffer{slot->secondaryCommandBuffers[secondaryIndex + index].commandBuffer};
+            vk::CommandBufferInheritanceInfo inheritanceInfo{
+                .pNext = gpu.traits.supportsDynamicRendering ? &renderPassNode.inheritanceRenderingInfo : nullptr,
+                .renderPass = lRenderPass,
+                .subpass = 0,
+                .occlusionQueryEnable = gpu.traits.supportsInheritedQueries,
+                .pipelineStatistics = gpu.traits.supportsInheritedQueries && gpu.traits.supportsPipelineStatisticsQuery ? vk::QueryPipelineStatisticFlagBits::eClippingInvocations : vk::QueryPipelineStatisticFlags{},
+            };
+            commandBuffer.begin(vk::CommandBufferBeginInfo{
+                .flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit | vk::CommandBufferUsageFlagBits::eRenderPassContinue,
+                .pInheritanceInfo = &inheritanceInfo,
+            });
+
+            for (auto node{chunks[index].first}; node != chunks[index].second; ++node)
+                std::get<SubpassFunctionNode>(*node)(commandBuffer, slot->cycle, gpu, lRenderPass, 0);
+
+            commandBuffer.end();
+        });
+
+        boost::container::small_vector<vk::CommandBuffer, 8> commandBuffers;
+        for (size_t index{}; index < chunks.size(); index++)
+            commandBuffers.push_back(*slot->secondaryCommandBuffers[secondaryIndex + index].commandBuffer);
+        slot->commandBuffer.executeCommands(commandBuffers);
+
+        secondaryIndex += chunks.size();
+        it = end;
+        return true;
+    }
+
     void CommandRecordThread::ProcessSlot(Slot *slot) {
         TRACE_EVENT_FMT("gpu", "ProcessSlot: 0x{:X}, execution: {}", slot, slot->executionNumber);
         auto &gpu{*state.gpu};
 
         vk::RenderPass lRenderPass;
         u32 subpassIndex;
+        size_t secondaryIndex{};
+
+        std::unique_ptr<TimestampProfiler::Batch> timestamps;
+        if (gpu.timestampProfiler.IsEnabled())
+            timestamps = gpu.timestampProfiler.AcquireBatch(slot->commandBuffer);
 
         std::scoped_lock bufferLock{gpu.buffer.recreationMutex};
         using namespace node;
-        for (NodeVariant &node : slot->nodes) {
+        for (auto it{slot->nodes.begin()}; it != slot->nodes.end(); ++it) {
+            // Render passes are profiled from their beginning till their end node, this has to be written prior to them potentially being recorded in parallel
+            if (timestamps) {
+                if (std::holds_alternative<RenderPassNode>(*it))
+                    gpu.timestampProfiler.BeginRegion(*timestamps, slot->commandBuffer, TimestampCategory::RenderPass);
+                else if (auto functionNode{std::get_if<FunctionNode>(&*it)}; functionNode && functionNode->category != TimestampCategory::None)
+                    gpu.timestampProfiler.BeginRegion(*timestamps, slot->commandBuffer, functionNode->category);
+            }
+
+            // Large render passes are recorded in parallel, after which the iterator points to the render pass end node which is recorded inline
+            if (auto renderPassNode{std::get_if<RenderPassNode>(&*it)}; renderPassNode && renderPassNode->secondaryRecordable)
+                RecordRenderPassChunks(slot, *renderPassNode, it, secondaryIndex);
+
             #define NODE(name) [&](name& node) { node(slot->commandBuffer, slot->cycle, gpu); }
             std::visit(VariantVisitor{
                 NODE(FunctionNode),
@@ -108,19 +200,57 @@ namespace skyline::gpu::interconnect {
                 [&](NextSubpassFunctionNode &node) { node(slot->commandBuffer, slot->cycle, gpu, lRenderPass, ++subpassIndex); },
 
                 NODE(RenderPassEndNode),
-            }, node);
+                NODE(SubpassChunkBoundaryNode),
+            }, *it);
             #undef NODE
+
+            if (timestamps && (std::holds_alternative<RenderPassEndNode>(*it) || std::holds_alternative<FunctionNode>(*it)))
+                gpu.timestampProfiler.EndRegion(*timestamps, slot->commandBuffer);
         }
 
         slot->commandBuffer.end();
         slot->ready = false;
 
         gpu.scheduler.SubmitCommandBuffer(slot->commandBuffer, slot->cycle);
+        if (timestamps)
+            gpu.timestampProfiler.Submit(std::move(timestamps), slot->cycle, slot->executionNumber);
 
         slot->nodes.clear();
         slot->allocator.Reset();
     }
 
+    bool CommandRecordThread::UpdateSlotCount(Slot *slot) {
+        size_t activeSlotCount{slots.size() - parkedSlots.size()};
+        bool park{};
+        if (slot->didWait) {
+            quietSlotCount = 0;
+            if (slot->latencyNs > TargetLatencyNs) {
+                // The GPU is the bottleneck and work is queued for too long, additional slots would only increase latency further
+                park = activeSlotCount > MinActiveSlotCount;
+            } else if (activeSlotCount < (1U << *state.settings->executorSlotCountScale)) {
+                if (!parkedSlots.empty()) {
+                    outgoing.Push(parkedSlots.back());
+                    parkedSlots.pop_back();
+                } else {
+                    outgoing.Push(&slots.emplace_back(*state.gpu));
+                }
+            }
+
+            slot->didWait = false;
+            slot->latencyNs = 0;
+        } else if (++quietSlotCount >= ShrinkWindowSlotCount) {
+            // Slots have been consistently available, so some of them are surplus
+            quietSlotCount = 0;
+            park = activeSlotCount > MinActiveSlotCount;
+        }
+
+        if (park)
+            parkedSlots.push_back(slot);
+
+        TRACE_COUNTER("gpu", "Executor Slots", slots.size() - parkedSlots.size());
+        return park;
+    }
+
     void CommandRecordThread::Run() {
         auto &gpu{*state.gpu};
 
@@ -144,18 +274,16 @@ namespace skyline::gpu::interconnect {
                 if (renderDocApi && slot->capture)
                     renderDocApi->StartFrameCapture(RENDERDOC_DEVICEPOINTER_FROM_VKINSTANCE(instance), nullptr);
 
+                auto recordStart{util::GetTimeNs()};
                 ProcessSlot(slot);
+                GetPerformanceStatistics().commandRecordBusyNs.fetch_add(static_cast<u64>(util::GetTimeNs() - recordStart), std::memory_order_relaxed);
 
                 if (renderDocApi && slot->capture)
                     renderDocApi->EndFrameCapture(RENDERDOC_DEVICEPOINTER_FROM_VKINSTANCE(instance), nullptr);
                 slot->capture = false;
 
-                if (slot->didWait && slots.size() < (1U << *state.settings->executorSlotCountScale)) {
-                    outgoing.Push(&slots.emplace_back(gpu));
-                    slot->didWait = false;
-                }
-
-                outgoing.Push(slot);
+                if (!UpdateSlotCount(slot))
+                    outgoing.Push(slot);
             }, [] {});
         } catch (const signal::SignalException &e) {
             Logger::Error("{}\nStack Trace:{}", e.what(), state.loader->GetStackTrace(e.frames));
@@ -182,6 +310,7 @@ namespace skyline::gpu::interconnect {
     }
 
     void CommandRecordThread::ReleaseSlot(Slot *slot) {
+        slot->releaseTime = util::GetTimeNs();
         incoming.Push(slot);
     }
 
@@ -200,6 +329,7 @@ namespace skyline::gpu::interconnect {
     void CommandExecutor::RotateRecordSlot() {
         if (slot) {
             slot->capture = captureNextExecution;
+            lastSubmittedCycle = cycle;
             recordThread.ReleaseSlot(slot);
         }
 
@@ -239,11 +369,25 @@ namespace skyline::gpu::interconnect {
                               ranges::equal(lastSubpassColorAttachments, colorAttachments) &&
                               lastSubpassDepthStencilAttachment == depthStencilAttachment};
 
-        bool splitRenderPass{renderPass == nullptr || renderPass->renderArea != renderArea ||
-            ((noSubpassCreation || subpassCount >= gpu.traits.quirks.maxSubpassCount) && !attachmentsMatch) ||
+        // Dynamic rendering has no subpasses, so any change in attachments requires a new render pass
+        bool splitRenderPass{renderPass == nullptr ||
+            ((noSubpassCreation || gpu.traits.supportsDynamicRendering || subpassCount >= gpu.traits.quirks.maxSubpassCount) && !attachmentsMatch) ||
             !ranges::all_of(outputAttachmentViews, [this] (auto view) { return !view || view->texture->ValidateRenderPassUsage(renderPassIndex, texture::RenderPassUsage::RenderTarget); }) ||
             !ranges::all_of(sampledImages, [this] (auto view) { return view->texture->ValidateRenderPassUsage(renderPassIndex, texture::RenderPassUsage::Sampled); })};
 
+        if (!splitRenderPass && renderPass->renderArea != renderArea) {
+            // Rather than splitting the render pass for differing render areas, merge them by expanding the render area to cover both when all attachments are large enough
+            vk::Extent2D maxExtent{std::numeric_limits<u32>::max(), std::numeric_limits<u32>::max()};
+            for (auto view : ranges::views::concat(inputAttachments, outputAttachmentViews)) {
+                if (view) {
+                    maxExtent.width = std::min(maxExtent.width, view->texture->dimensions.width);
+                    maxExtent.height = std::min(maxExtent.height, view->texture->dimensions.height);
+                }
+            }
+
+            splitRenderPass = !renderPass->ExpandRenderArea(renderArea, maxExtent);
+        }
+
         bool gotoNext{};
         if (splitRenderPass) {
             // We need to create a render pass if one doesn't already exist or the current one isn't compatible
@@ -251,7 +395,11 @@ namespace skyline::gpu::interconnect {
                 slot->nodes.emplace_back(std::in_place_type_t<node::RenderPassEndNode>());
                 renderPassIndex++;
             }
+            AddBarrierNode(barrierTracker.TrackWork(vk::PipelineStageFlagBits::eAllGraphics));
             renderPass = &std::get<node::RenderPassNode>(slot->nodes.emplace_back(std::in_place_type_t<node::RenderPassNode>(), renderArea));
+            renderPasses.push_back(renderPass);
+            renderPass->secondaryRecordable = recordStateInvalidated && (!queryActive || gpu.traits.supportsInheritedQueries);
+            chunkSubpassFunctionCount = 0;
             addSubpass();
             subpassCount = 1;
         } else if (!attachmentsMatch) {
@@ -259,6 +407,7 @@ namespace skyline::gpu::interconnect {
             addSubpass();
             subpassCount++;
             gotoNext = true;
+            renderPass->secondaryRecordable = false; // Secondary command buffers are only used for render passes with a single subpass
         }
 
         for (auto view : outputAttachmentViews)
@@ -278,11 +427,15 @@ namespace skyline::gpu::interconnect {
 
             renderPass = nullptr;
             subpassCount = 0;
+            chunkSubpassFunctionCount = 0;
 
             lastSubpassAttachments.clear();
             lastSubpassInputAttachments = nullptr;
             lastSubpassColorAttachments = nullptr;
             lastSubpassDepthStencilAttachment = nullptr;
+
+            if (*state.settings->parallelCommandRecording)
+                NotifyPipelineChange(); // Invalidate all state so the next render pass can be recorded into secondary command buffers
         }
     }
 
@@ -300,7 +453,10 @@ namespace skyline::gpu::interconnect {
     }
 
     bool CommandExecutor::AttachTexture(TextureView *view) {
+        gpu.texture.MarkUsed(*view->texture);
+        view->texture->RecordAttachment();
         bool didLock{view->LockWithTag(tag)};
+        view->texture->InvalidateReadback(); // Any pending readback would be stale after this execution, a new one is scheduled at submission if required
         if (didLock) {
             // TODO: fixup remaining bugs with this and add better heuristics to avoid pauses
             // if (view->texture->FrequentlyLocked())
@@ -360,19 +516,64 @@ namespace skyline::gpu::interconnect {
         cycle->AttachObject(dependency);
     }
 
-    void CommandExecutor::AddSubpass(std::function<void(vk::raii::CommandBuffer &, const std::shared_ptr<FenceCycle> &, GPU &, vk::RenderPass, u32)> &&function, vk::Rect2D renderArea, span<TextureView *> sampledImages, span<TextureView *> inputAttachments, span<TextureView *> colorAttachments, TextureView *depthStencilAttachment, bool noSubpassCreation) {
+    void CommandExecutor::AddSubpass(std::function<void(vk::raii::CommandBuffer &, const IntrusivePtr<FenceCycle> &, GPU &, vk::RenderPass, u32)> &&function, vk::Rect2D renderArea, span<TextureView *> sampledImages, span<TextureView *> inputAttachments, span<TextureView *> colorAttachments, TextureView *depthStencilAttachment, bool noSubpassCreation, bool overwritesColorAttachments) {
         bool gotoNext{CreateRenderPassWithSubpass(renderArea, sampledImages, inputAttachments, colorAttachments, depthStencilAttachment ? &*depthStencilAttachment : nullptr, noSubpassCreation)};
+        if (overwritesColorAttachments && renderPass->renderArea == renderArea && renderArea.offset == vk::Offset2D{})
+            // The prior contents of attachments can only be discarded if the render area, which may have been expanded by prior commands, covers them entirely
+            for (u32 i{}; i < colorAttachments.size(); i++)
+                if (colorAttachments[i] && renderArea.extent == vk::Extent2D{colorAttachments[i]->texture->dimensions})
+                    renderPass->DiscardColorAttachmentLoad(i);
+
         if (gotoNext)
             slot->nodes.emplace_back(std::in_place_type_t<node::NextSubpassFunctionNode>(), std::forward<decltype(function)>(function));
         else
             slot->nodes.emplace_back(std::in_place_type_t<node::SubpassFunctionNode>(), std::forward<decltype(function)>(function));
+
+        renderPass->MarkSubpassAttachmentsUsed();
+        recordStateInvalidated = false;
+        if (*state.settings->parallelCommandRecording && renderPass->secondaryRecordable && ++chunkSubpassFunctionCount >= SubpassChunkSize) {
+            // Invalidate all state so that the first subpass function of the next chunk records all state it uses, this is done after the current function was added as its state has already been built
+            NotifyPipelineChange();
+            slot->nodes.emplace_back(std::in_place_type_t<node::SubpassChunkBoundaryNode>());
+            chunkSubpassFunctionCount = 0;
+        }
+    }
+
+    void CommandExecutor::AddOutsideRpCommand(std::function<void(vk::raii::CommandBuffer &, const IntrusivePtr<FenceCycle> &, GPU &)> &&function, TimestampCategory category) {
+        if (renderPass)
+            FinishRenderPass();
+
+        // The stages used by arbitrary commands aren't known, only compute dispatches can be assumed to be restricted to their stage
+        AddBarrierNode(barrierTracker.TrackWork(category == TimestampCategory::Compute ? vk::PipelineStageFlagBits::eComputeShader : vk::PipelineStageFlagBits::eAllCommands));
+        slot->nodes.emplace_back(std::in_place_type_t<node::FunctionNode>(), std::forward<decltype(function)>(function), category);
     }
 
-    void CommandExecutor::AddOutsideRpCommand(std::function<void(vk::raii::CommandBuffer &, const std::shared_ptr<FenceCycle> &, GPU &)> &&function) {
+    void CommandExecutor::AddTransferCommand(std::function<void(vk::raii::CommandBuffer &, const IntrusivePtr<FenceCycle> &, GPU &)> &&function, std::initializer_list<ResourceAccess> accesses, TimestampCategory category) {
         if (renderPass)
             FinishRenderPass();
 
-        slot->nodes.emplace_back(std::in_place_type_t<node::FunctionNode>(), std::forward<decltype(function)>(function));
+        AddBarrierNode(barrierTracker.TrackTransfer(span<const ResourceAccess>{accesses.begin(), accesses.size()}));
+        slot->nodes.emplace_back(std::in_place_type_t<node::FunctionNode>(), std::forward<decltype(function)>(function), category);
+    }
+
+    bool CommandExecutor::TryExtendTransfer(std::initializer_list<ResourceAccess> accesses) {
+        span<const ResourceAccess> accessSpan{accesses.begin(), accesses.size()};
+        if (renderPass || barrierTracker.RequiresBarrier(accessSpan))
+            return false;
+
+        barrierTracker.TrackTransfer(accessSpan);
+        return true;
+    }
+
+    void CommandExecutor::AddBarrierNode(const PipelineBarrier &barrier) {
+        if (barrier)
+            slot->nodes.emplace_back(std::in_place_type_t<node::FunctionNode>(), [barrier](vk::raii::CommandBuffer &commandBuffer, const IntrusivePtr<FenceCycle> &, GPU &) {
+                barrier.Record(commandBuffer);
+            });
+    }
+
+    size_t CommandExecutor::GetNodeCount() const {
+        return slot->nodes.size();
     }
 
     void CommandExecutor::AddClearColorSubpass(TextureView *attachment, const vk::ClearColorValue &value) {
@@ -381,7 +582,7 @@ namespace skyline::gpu::interconnect {
             if (gotoNext)
                 slot->nodes.emplace_back(std::in_place_type_t<node::NextSubpassNode>());
         } else {
-            auto function{[scissor = attachment->texture->dimensions, value](vk::raii::CommandBuffer &commandBuffer, const std::shared_ptr<FenceCycle> &, GPU &, vk::RenderPass, u32) {
+            auto function{[scissor = attachment->texture->dimensions, value](vk::raii::CommandBuffer &commandBuffer, const IntrusivePtr<FenceCycle> &, GPU &, vk::RenderPass, u32) {
                 commandBuffer.clearAttachments(vk::ClearAttachment{
                     .aspectMask = vk::ImageAspectFlagBits::eColor,
                     .colorAttachment = 0,
@@ -397,16 +598,23 @@ namespace skyline::gpu::interconnect {
                 slot->nodes.emplace_back(std::in_place_type_t<node::NextSubpassFunctionNode>(), function);
             else
                 slot->nodes.emplace_back(std::in_place_type_t<node::SubpassFunctionNode>(), function);
+
+            renderPass->MarkSubpassAttachmentsUsed();
         }
     }
 
     void CommandExecutor::AddClearDepthStencilSubpass(TextureView *attachment, const vk::ClearDepthStencilValue &value) {
+        auto overwrittenRenderPass{attachment->texture->GetOverwrittenRenderPass()}; // This must be queried prior to the render pass usage being updated
         bool gotoNext{CreateRenderPassWithSubpass(vk::Rect2D{.extent = attachment->texture->dimensions}, {}, {}, {}, attachment)};
         if (renderPass->ClearDepthStencilAttachment(value, gpu)) {
+            // The depth/stencil contents written by the last render pass using the attachment are never read as they're cleared here, so they don't need to be stored to memory
+            if (overwrittenRenderPass && *overwrittenRenderPass < renderPassIndex)
+                renderPasses[*overwrittenRenderPass]->DiscardAttachmentStore(attachment);
+
             if (gotoNext)
                 slot->nodes.emplace_back(std::in_place_type_t<node::NextSubpassNode>());
         } else {
-            auto function{[aspect = attachment->format->vkAspect, extent = attachment->texture->dimensions, value](vk::raii::CommandBuffer &commandBuffer, const std::shared_ptr<FenceCycle> &, GPU &, vk::RenderPass, u32) {
+            auto function{[aspect = attachment->format->vkAspect, extent = attachment->texture->dimensions, value](vk::raii::CommandBuffer &commandBuffer, const IntrusivePtr<FenceCycle> &, GPU &, vk::RenderPass, u32) {
                 commandBuffer.clearAttachments(vk::ClearAttachment{
                     .aspectMask = aspect,
                     .clearValue = value,
@@ -421,6 +629,8 @@ namespace skyline::gpu::interconnect {
                 slot->nodes.emplace_back(std::in_place_type_t<node::NextSubpassFunctionNode>(), function);
             else
                 slot->nodes.emplace_back(std::in_place_type_t<node::SubpassFunctionNode>(), function);
+
+            renderPass->MarkSubpassAttachmentsUsed();
         }
     }
 
@@ -435,6 +645,8 @@ namespace skyline::gpu::interconnect {
     void CommandExecutor::NotifyPipelineChange() {
         for (auto &callback : pipelineChangeCallbacks)
             callback();
+
+        recordStateInvalidated = true;
     }
 
     void CommandExecutor::SubmitInternal() {
@@ -464,6 +676,16 @@ namespace skyline::gpu::interconnect {
                 texture->cycle = cycle;
                 texture->UpdateRenderPassUsage(0, texture::RenderPassUsage::None);
             }
+
+            // Textures that are frequently read back by the guest are copied into staging buffers after all other commands, so that guest accesses don't need to wait on a separate submission
+            if (*state.settings->asyncTextureReadback)
+                for (const auto &texture : ranges::views::concat(attachedTextures, preserveAttachedTextures))
+                    if (auto readback{texture->ScheduleReadback(cycle)}) {
+                        AddBarrierNode(barrierTracker.TrackWork(vk::PipelineStageFlagBits::eAllCommands));
+                        slot->nodes.emplace_back(std::in_place_type_t<node::FunctionNode>(), [readback = std::move(readback)](vk::raii::CommandBuffer &commandBuffer, const IntrusivePtr<FenceCycle> &, GPU &) {
+                            readback(commandBuffer);
+                        });
+                    }
         }
 
         for (const auto &attachedBuffer : ranges::views::concat(attachedBuffers, preserveAttachedBuffers)) {
@@ -482,7 +704,9 @@ namespace skyline::gpu::interconnect {
         attachedTextures.clear();
         attachedBuffers.clear();
         allocator->Reset();
+        barrierTracker.Reset();
         renderPassIndex = 0;
+        renderPasses.clear();
 
         // Periodically clear preserve attachments just in case there are new waiters which would otherwise end up waiting forever
         if ((submissionNumber % (2U << *state.settings->executorSlotCountScale)) == 0) {
@@ -492,10 +716,13 @@ namespace skyline::gpu::interconnect {
     }
 
     void CommandExecutor::Submit() {
+        nce::NCE::ScopedTrapBatch trapBatch{*state.nce}; // Resources are untrapped in bulk when they're released at the end of a submission
         for (const auto &callback : flushCallbacks)
             callback();
 
+        recordStateInvalidated = true; // All state is marked dirty by the flush callbacks and isn't inherited by the next command buffer
         executionNumber++;
+        gpu.texture.OnExecutionSubmitted();
 
         if (!slot->nodes.empty()) {
             TRACE_EVENT("gpu", "CommandExecutor::Submit");
@@ -506,6 +733,18 @@ namespace skyline::gpu::interconnect {
         ResetInternal();
     }
 
+    void CommandExecutor::SubmitIfIdle() {
+        if (slot->nodes.size() < EarlySubmitNodeThreshold)
+            return;
+
+        // A full poll is only done once enough work has accumulated to be worth submitting, the cycle is only signalled once its work has been recorded and completed on the GPU
+        if (lastSubmittedCycle && !lastSubmittedCycle->Poll(false))
+            return;
+
+        TRACE_EVENT("gpu", "CommandExecutor::SubmitIfIdle");
+        Submit();
+    }
+
     void CommandExecutor::LockPreserve() {
         if (!preserveLocked) {
             preserveLocked = true;
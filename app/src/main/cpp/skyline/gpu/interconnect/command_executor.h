@@ -7,6 +7,7 @@
 #include <renderdoc_app.h>
 #include <common/linear_allocator.h>
 #include <gpu/megabuffer.h>
+#include "barrier_tracker.h"
 #include "command_nodes.h"
 
 namespace skyline::gpu::interconnect {
@@ -30,11 +31,22 @@ namespace skyline::gpu::interconnect {
                 ~ScopedBegin();
             };
 
+            /**
+             * @brief A secondary command buffer which a single chunk of a render pass is recorded into
+             */
+            struct SecondaryCommandBuffer {
+                vk::raii::CommandPool commandPool; //!< Every secondary command buffer has its own pool as they're recorded into on multiple threads at the same time
+                vk::raii::CommandBuffer commandBuffer;
+
+                SecondaryCommandBuffer(GPU &gpu);
+            };
+
             vk::raii::CommandPool commandPool; //!< Use one command pool per slot since command buffers from different slots may be recorded into on multiple threads at the same time
             vk::raii::CommandBuffer commandBuffer;
+            std::vector<SecondaryCommandBuffer> secondaryCommandBuffers; //!< Secondary command buffers used for parallel recording of render pass chunks, these are lazily allocated and reused across executions of the slot
             vk::raii::Fence fence;
             vk::raii::Semaphore semaphore;
-            std::shared_ptr<FenceCycle> cycle;
+            IntrusivePtr<FenceCycle> cycle;
             boost::container::stable_vector<node::NodeVariant> nodes;
             LinearAllocatorState<> allocator;
             std::mutex beginLock;
@@ -43,6 +55,8 @@ namespace skyline::gpu::interconnect {
             bool ready{}; //!< If this slot's command buffer has had 'beginCommandBuffer' called and is ready to have commands recorded into it
             bool capture{}; //!< If this slot's Vulkan commands should be captured using the renderdoc API
             bool didWait{}; //!< If a wait of time longer than GrowThresholdNs occured when this slot was acquired
+            u64 releaseTime{}; //!< The time at which this slot was last released for recording
+            u64 latencyNs{}; //!< If the GPU was waited on when this slot was acquired, the time from its last release till its GPU work completed, this is 0 if the latency wasn't measured
 
             Slot(GPU &gpu);
 
@@ -52,7 +66,7 @@ namespace skyline::gpu::interconnect {
              * @brief Waits on the fence and resets the command buffer
              * @note A new fence cycle for the reset command buffer
              */
-            std::shared_ptr<FenceCycle> Reset(GPU &gpu);
+            IntrusivePtr<FenceCycle> Reset(GPU &gpu);
 
             /**
              * @brief Waits for the command buffer to be began so it can be recorded into
@@ -64,15 +78,37 @@ namespace skyline::gpu::interconnect {
 
       private:
         static constexpr size_t GrowThresholdNs{constant::NsInMillisecond / 4}; //!< The wait time threshold at which the slot count will be increased
+        static constexpr u64 TargetLatencyNs{constant::NsInSecond / 30}; //!< The maximum latency from a slot being released till its GPU work completing before the slot count is reduced rather than increased on waits, this is two frames at 60 FPS
+        static constexpr size_t ShrinkWindowSlotCount{256}; //!< The amount of consecutive slots acquired without waiting after which the slot count will be decreased
+        static constexpr size_t MinActiveSlotCount{2}; //!< The minimum amount of active slots that shrinking will retain, this ensures the CPU and GPU can always overlap
+        static constexpr size_t MinParallelChunkCount{2}; //!< The minimum amount of chunks in a render pass for them to be recorded into secondary command buffers in parallel
         const DeviceState &state;
         CircularQueue<Slot *> incoming; //!< Slots pending recording
         CircularQueue<Slot *> outgoing; //!< Slots that have been submitted, may still be active on the GPU
         std::list<Slot> slots;
+        std::vector<Slot *> parkedSlots; //!< Slots which were retired by the slot count controller, these are reused prior to allocating new slots when the slot count is increased
+        size_t quietSlotCount{}; //!< The amount of consecutive slots that were acquired without any waits
 
         std::thread thread;
 
+        using NodeIterator = boost::container::stable_vector<node::NodeVariant>::iterator;
+
+        /**
+         * @brief Begins the render pass at the supplied node and records all of its chunks into secondary command buffers in parallel, if possible
+         * @param it An iterator to the render pass node, this is advanced to the corresponding render pass end node if the render pass was recorded
+         * @param secondaryIndex The index of the first unused secondary command buffer in the slot, this is advanced past all secondary command buffers used
+         * @return If the render pass was recorded, if not then it must be recorded inline
+         */
+        bool RecordRenderPassChunks(Slot *slot, node::RenderPassNode &renderPassNode, NodeIterator &it, size_t &secondaryIndex);
+
         void ProcessSlot(Slot *slot);
 
+        /**
+         * @brief Adjusts the amount of active slots based on the waits and GPU latency observed when the supplied slot was acquired
+         * @return If the slot was parked and must not be returned to the outgoing queue
+         */
+        bool UpdateSlotCount(Slot *slot);
+
         void Run();
 
       public:
@@ -102,8 +138,13 @@ namespace skyline::gpu::interconnect {
         node::RenderPassNode *renderPass{};
         size_t subpassCount{}; //!< The number of subpasses in the current render pass
         u32 renderPassIndex{};
+        std::vector<node::RenderPassNode *> renderPasses; //!< All render passes in the current execution indexed by their render pass index, these are used to retroactively discard stores to attachments
         bool preserveLocked{};
 
+        static constexpr size_t SubpassChunkSize{128}; //!< The amount of subpass functions in a chunk of a render pass recorded into a single secondary command buffer
+        bool recordStateInvalidated{true}; //!< If all state has been invalidated since the last subpass function, such that the next one will record all state it uses, this is required for a render pass chunk to be recorded independently
+        size_t chunkSubpassFunctionCount{}; //!< The number of subpass functions in the current chunk of the current render pass
+
         /**
          * @brief A wrapper of a Texture object that has been locked beforehand and must be unlocked afterwards
          */
@@ -150,11 +191,21 @@ namespace skyline::gpu::interconnect {
         span<TextureView *> lastSubpassColorAttachments; //!< The set of color attachments used in the last subpass
         TextureView *lastSubpassDepthStencilAttachment{}; //!< The depth stencil attachment used in the last subpass
 
+        static constexpr size_t EarlySubmitNodeThreshold{64}; //!< The minimum amount of nodes in a slot for it to be submitted early while the GPU is idle
+        IntrusivePtr<FenceCycle> lastSubmittedCycle; //!< The fence cycle of the last submitted slot, this is used to determine if the GPU is idle
+
+        BarrierTracker barrierTracker; //!< Determines the barriers between transfers and other work in the current execution, these are recorded as separate nodes in the order they're required
+
         std::vector<std::function<void()>> flushCallbacks; //!< Set of persistent callbacks that will be called at the start of Execute in order to flush data required for recording
         std::vector<std::function<void()>> pipelineChangeCallbacks; //!< Set of persistent callbacks that will be called after any non-Maxwell 3D engine changes the active pipeline
 
         void RotateRecordSlot();
 
+        /**
+         * @brief Adds a node recording the supplied barrier if it isn't empty
+         */
+        void AddBarrierNode(const PipelineBarrier &barrier);
+
         /**
          * @brief Create a new render pass and subpass with the specified attachments, if one doesn't already exist or the current one isn't compatible
          * @param noSubpassCreation Forces creation of a renderpass when a new subpass would otherwise be created
@@ -182,12 +233,13 @@ namespace skyline::gpu::interconnect {
         void AttachBufferBase(std::shared_ptr<Buffer> buffer);
 
       public:
-        std::shared_ptr<FenceCycle> cycle; //!< The fence cycle that this command executor uses to wait for the GPU to finish executing commands
+        IntrusivePtr<FenceCycle> cycle; //!< The fence cycle that this command executor uses to wait for the GPU to finish executing commands
         LinearAllocatorState<> *allocator;
         ContextTag tag; //!< The tag associated with this command executor, any tagged resource locking must utilize this tag
         size_t submissionNumber{};
         u32 executionNumber{};
         bool captureNextExecution{};
+        bool queryActive{}; //!< If any query begun outside of a render pass is currently active, render passes will only be recorded into secondary command buffers if queries can be inherited by them
 
         CommandExecutor(const DeviceState &state);
 
@@ -233,9 +285,10 @@ namespace skyline::gpu::interconnect {
         /**
          * @brief Adds a command that needs to be executed inside a subpass configured with certain attachments
          * @param exclusiveSubpass If this subpass should be the only subpass in a render pass
+         * @param overwritesColorAttachments If the function overwrites the entire render area of all color attachments without reading them, their prior contents are discarded if the render area covers them entirely
          * @note Any supplied texture should be attached prior and not undergo any persistent layout transitions till execution
          */
-        void AddSubpass(std::function<void(vk::raii::CommandBuffer &, const std::shared_ptr<FenceCycle> &, GPU &, vk::RenderPass, u32)> &&function, vk::Rect2D renderArea, span<TextureView *> sampledImages, span<TextureView *> inputAttachments = {}, span<TextureView *> colorAttachments = {}, TextureView *depthStencilAttachment = {}, bool noSubpassCreation = false);
+        void AddSubpass(std::function<void(vk::raii::CommandBuffer &, const IntrusivePtr<FenceCycle> &, GPU &, vk::RenderPass, u32)> &&function, vk::Rect2D renderArea, span<TextureView *> sampledImages, span<TextureView *> inputAttachments = {}, span<TextureView *> colorAttachments = {}, TextureView *depthStencilAttachment = {}, bool noSubpassCreation = false, bool overwritesColorAttachments = false);
 
         /**
          * @brief Adds a subpass that clears the entirety of the specified attachment with a color value, it may utilize VK_ATTACHMENT_LOAD_OP_CLEAR for a more efficient clear when possible
@@ -251,8 +304,27 @@ namespace skyline::gpu::interconnect {
 
         /**
          * @brief Adds a command that needs to be executed outside the scope of a render pass
+         * @param category The category the GPU work of the command is profiled under, commands which aren't separately interesting shouldn't be profiled
          */
-        void AddOutsideRpCommand(std::function<void(vk::raii::CommandBuffer &, const std::shared_ptr<FenceCycle> &, GPU &)> &&function);
+        void AddOutsideRpCommand(std::function<void(vk::raii::CommandBuffer &, const IntrusivePtr<FenceCycle> &, GPU &)> &&function, TimestampCategory category = TimestampCategory::None);
+
+        /**
+         * @return The amount of nodes recorded in the current execution, if this is unchanged since a command was added then no commands have been recorded after it
+         */
+        size_t GetNodeCount() const;
+
+        /**
+         * @brief Adds a transfer command that needs to be executed outside the scope of a render pass, it's only synchronized with the commands prior to it that it has hazards with
+         * @param accesses All resource ranges the command accesses except for host-written staging data, the command itself must not record any barriers for these
+         */
+        void AddTransferCommand(std::function<void(vk::raii::CommandBuffer &, const IntrusivePtr<FenceCycle> &, GPU &)> &&function, std::initializer_list<ResourceAccess> accesses, TimestampCategory category = TimestampCategory::None);
+
+        /**
+         * @brief Tracks additional accesses for the last transfer command, this is used to extend the command after it was added
+         * @return If the accesses were tracked, this fails if they would require a barrier prior to the command or if it's no longer the last one
+         * @note The caller is responsible for ensuring the last command is the transfer that's being extended
+         */
+        bool TryExtendTransfer(std::initializer_list<ResourceAccess> accesses);
 
         /**
          * @brief Adds a persistent callback that will be called at the start of Execute in order to flush data required for recording
@@ -274,6 +346,26 @@ namespace skyline::gpu::interconnect {
          */
         void Submit();
 
+        /**
+         * @brief Submits the current slot early if it contains a sizeable amount of work and the GPU has finished all prior work, trading CPU/GPU overlap for latency only when the GPU would otherwise be idle
+         * @note This must only be called between GPFIFO entries where no engine is in the middle of recording a command
+         */
+        void SubmitIfIdle();
+
+        /**
+         * @return If the current execution has no recorded work, such as immediately after a submission
+         */
+        bool IsExecutionEmpty() const {
+            return slot->nodes.empty();
+        }
+
+        /**
+         * @return The amount of nodes recorded in the current execution, this can be used to detect if any work was recorded after a specific node
+         */
+        size_t GetNodeCount() const {
+            return slot->nodes.size();
+        }
+
         /**
          * @brief Locks all preserve attached buffers/textures
          * @note This **MUST** be called before attaching any buffers/textures to an execution
@@ -1,6 +1,7 @@
 // SPDX-License-Identifier: MPL-2.0
 // Copyright © 2021 Skyline Team and Contributors (https://github.com/skyline-emu/)
 
+#include <boost/container/small_vector.hpp>
 #include "command_nodes.h"
 
 namespace skyline::gpu::interconnect::node {
@@ -25,7 +26,7 @@ namespace skyline::gpu::interconnect::node {
             // If we cannot find any matches for the specified attachment, we add it as a new one
             attachments.push_back(vkView);
 
-            if (gpu.traits.supportsImagelessFramebuffers)
+            if (gpu.traits.supportsImagelessFramebuffers && !gpu.traits.supportsDynamicRendering)
                 attachmentInfo.push_back(vk::FramebufferAttachmentImageInfo{
                     .flags = view->texture->flags,
                     .usage = view->texture->usage,
@@ -42,6 +43,10 @@ namespace skyline::gpu::interconnect::node {
                 .finalLayout = view->texture->layout,
                 .flags = vk::AttachmentDescriptionFlagBits::eMayAlias
             });
+            attachmentUsed.push_back(false);
+
+            attachmentExtent.width = std::min(attachmentExtent.width, view->texture->dimensions.width);
+            attachmentExtent.height = std::min(attachmentExtent.height, view->texture->dimensions.height);
             return static_cast<u32>(attachments.size() - 1);
         } else {
             // If we've got a match from a previous subpass, we need to preserve the attachment till the current subpass
@@ -147,6 +152,7 @@ namespace skyline::gpu::interconnect::node {
                 .attachment = AddAttachment(depthStencilAttachment, gpu),
                 .layout = depthStencilAttachment->texture->layout,
             });
+            depthStencilAspect = depthStencilAttachment->format->vkAspect;
         }
 
         preserveAttachmentReferences.emplace_back(); // We need to create storage for any attachments that might need to preserved by this pass
@@ -162,6 +168,32 @@ namespace skyline::gpu::interconnect::node {
         });
     }
 
+    void RenderPassNode::MarkSubpassAttachmentsUsed() {
+        const auto &subpassDescription{subpassDescriptions.back()};
+        auto referenceIt{RebasePointer(attachmentReferences, subpassDescription.pInputAttachments)};
+        auto referenceEnd{referenceIt + subpassDescription.inputAttachmentCount + subpassDescription.colorAttachmentCount}; // See AddAttachment(...) for the contiguity assumption
+        if (reinterpret_cast<uintptr_t>(subpassDescription.pDepthStencilAttachment) != NoDepthStencil)
+            referenceEnd++;
+
+        for (; referenceIt != referenceEnd; referenceIt++)
+            if (referenceIt->attachment != VK_ATTACHMENT_UNUSED)
+                attachmentUsed[referenceIt->attachment] = true;
+    }
+
+    bool RenderPassNode::ExpandRenderArea(vk::Rect2D area, vk::Extent2D maxExtent) {
+        i32 beginX{std::min(renderArea.offset.x, area.offset.x)}, beginY{std::min(renderArea.offset.y, area.offset.y)};
+        i64 endX{std::max<i64>(renderArea.offset.x + static_cast<i64>(renderArea.extent.width), area.offset.x + static_cast<i64>(area.extent.width))};
+        i64 endY{std::max<i64>(renderArea.offset.y + static_cast<i64>(renderArea.extent.height), area.offset.y + static_cast<i64>(area.extent.height))};
+        if (beginX < 0 || beginY < 0 || endX > std::min(attachmentExtent.width, maxExtent.width) || endY > std::min(attachmentExtent.height, maxExtent.height))
+            return false;
+
+        renderArea = vk::Rect2D{
+            .offset = {beginX, beginY},
+            .extent = {static_cast<u32>(endX - beginX), static_cast<u32>(endY - beginY)},
+        };
+        return true;
+    }
+
     bool RenderPassNode::ClearColorAttachment(u32 colorAttachment, const vk::ClearColorValue &value, GPU& gpu) {
         auto attachmentReference{RebasePointer(attachmentReferences, subpassDescriptions.back().pColorAttachments) + colorAttachment};
         auto attachmentIndex{attachmentReference->attachment};
@@ -170,19 +202,41 @@ namespace skyline::gpu::interconnect::node {
             if (reference.attachment == attachmentIndex && &reference != attachmentReference)
                 return false;
 
-        auto &attachmentDescription{attachmentDescriptions.at(attachmentIndex)};
-        if (attachmentDescription.loadOp == vk::AttachmentLoadOp::eLoad) {
-            attachmentDescription.loadOp = vk::AttachmentLoadOp::eClear;
+        // A load op clear happens prior to any commands in the render pass, so it can only be used if no commands have used the attachment yet
+        if (attachmentUsed[attachmentIndex])
+            return false;
 
-            clearValues.resize(attachmentIndex + 1);
-            clearValues[attachmentIndex].color = value;
+        attachmentDescriptions.at(attachmentIndex).loadOp = vk::AttachmentLoadOp::eClear;
+        clearValues.resize(std::max<size_t>(clearValues.size(), attachmentIndex + 1));
+        clearValues[attachmentIndex].color = value;
+        return true;
+    }
 
-            return true;
-        } else if (attachmentDescription.loadOp == vk::AttachmentLoadOp::eClear && clearValues[attachmentIndex].color.uint32 == value.uint32) {
-            return true;
-        }
+    bool RenderPassNode::DiscardColorAttachmentLoad(u32 colorAttachment) {
+        auto attachmentReference{RebasePointer(attachmentReferences, subpassDescriptions.back().pColorAttachments) + colorAttachment};
+        auto attachmentIndex{attachmentReference->attachment};
+        if (attachmentIndex == VK_ATTACHMENT_UNUSED)
+            return false;
+
+        for (const auto &reference : attachmentReferences)
+            if (reference.attachment == attachmentIndex && &reference != attachmentReference)
+                return false;
 
-        return false;
+        if (attachmentUsed[attachmentIndex])
+            return false; // See ClearColorAttachment(...)
+
+        attachmentDescriptions.at(attachmentIndex).loadOp = vk::AttachmentLoadOp::eDontCare;
+        return true;
+    }
+
+    void RenderPassNode::DiscardAttachmentStore(TextureView *view) {
+        auto attachment{std::find(attachments.begin(), attachments.end(), view->GetView())};
+        if (attachment == attachments.end())
+            return;
+
+        auto &attachmentDescription{attachmentDescriptions[static_cast<size_t>(std::distance(attachments.begin(), attachment))]};
+        attachmentDescription.storeOp = vk::AttachmentStoreOp::eDontCare;
+        attachmentDescription.stencilStoreOp = vk::AttachmentStoreOp::eDontCare;
     }
 
     bool RenderPassNode::ClearDepthStencilAttachment(const vk::ClearDepthStencilValue &value, GPU& gpu) {
@@ -193,22 +247,81 @@ namespace skyline::gpu::interconnect::node {
             if (reference.attachment == attachmentIndex && &reference != attachmentReference)
                 return false;
 
+        if (attachmentUsed[attachmentIndex])
+            return false; // See ClearColorAttachment(...)
+
         auto &attachmentDescription{attachmentDescriptions.at(attachmentIndex)};
-        if (attachmentDescription.loadOp == vk::AttachmentLoadOp::eLoad) {
-            attachmentDescription.loadOp = vk::AttachmentLoadOp::eClear;
+        attachmentDescription.loadOp = vk::AttachmentLoadOp::eClear;
+        attachmentDescription.stencilLoadOp = vk::AttachmentLoadOp::eClear; // Depth/stencil clears always write all aspects of the attachment
+        clearValues.resize(std::max<size_t>(clearValues.size(), attachmentIndex + 1));
+        clearValues[attachmentIndex].depthStencil = value;
+        return true;
+    }
+
+    void RenderPassNode::BeginRendering(vk::raii::CommandBuffer &commandBuffer, vk::SubpassContents contents) {
+        // There are no subpass dependencies with dynamic rendering, so the external dependency that the render pass would have had is recorded as a barrier
+        const auto &externalDependency{subpassDependencies.front()};
+        commandBuffer.pipelineBarrier(externalDependency.srcStageMask, externalDependency.dstStageMask, {}, vk::MemoryBarrier{
+            .srcAccessMask = externalDependency.srcAccessMask,
+            .dstAccessMask = externalDependency.dstAccessMask,
+        }, {}, {});
+
+        auto getAttachmentInfo{[this](const vk::AttachmentReference &reference, bool stencil) {
+            if (reference.attachment == VK_ATTACHMENT_UNUSED)
+                return vk::RenderingAttachmentInfo{};
+
+            const auto &description{attachmentDescriptions[reference.attachment]};
+            return vk::RenderingAttachmentInfo{
+                .imageView = attachments[reference.attachment],
+                .imageLayout = reference.layout,
+                .loadOp = stencil ? description.stencilLoadOp : description.loadOp,
+                .storeOp = stencil ? description.stencilStoreOp : description.storeOp,
+                .clearValue = reference.attachment < clearValues.size() ? clearValues[reference.attachment] : vk::ClearValue{},
+            };
+        }};
+
+        const auto &subpassDescription{subpassDescriptions.front()};
+        boost::container::small_vector<vk::RenderingAttachmentInfo, 8> colorAttachmentInfos;
+        colorAttachmentFormats.clear();
+        for (const auto &reference : span<const vk::AttachmentReference>{subpassDescription.pColorAttachments, subpassDescription.colorAttachmentCount}) {
+            colorAttachmentInfos.push_back(getAttachmentInfo(reference, false));
+            colorAttachmentFormats.push_back(reference.attachment != VK_ATTACHMENT_UNUSED ? attachmentDescriptions[reference.attachment].format : vk::Format::eUndefined);
+        }
 
-            clearValues.resize(attachmentIndex + 1);
-            clearValues[attachmentIndex].depthStencil = value;
+        vk::RenderingAttachmentInfo depthAttachmentInfo{}, stencilAttachmentInfo{};
+        vk::Format depthAttachmentFormat{}, stencilAttachmentFormat{};
+        if (auto reference{subpassDescription.pDepthStencilAttachment}) {
+            if (depthStencilAspect & vk::ImageAspectFlagBits::eDepth) {
+                depthAttachmentInfo = getAttachmentInfo(*reference, false);
+                depthAttachmentFormat = attachmentDescriptions[reference->attachment].format;
+            }
 
-            return true;
-        } else if (attachmentDescription.loadOp == vk::AttachmentLoadOp::eClear && clearValues[attachmentIndex].depthStencil == value) {
-            return true;
+            if (depthStencilAspect & vk::ImageAspectFlagBits::eStencil) {
+                stencilAttachmentInfo = getAttachmentInfo(*reference, true);
+                stencilAttachmentFormat = attachmentDescriptions[reference->attachment].format;
+            }
         }
 
-        return false;
+        inheritanceRenderingInfo = vk::CommandBufferInheritanceRenderingInfo{
+            .colorAttachmentCount = static_cast<u32>(colorAttachmentFormats.size()),
+            .pColorAttachmentFormats = colorAttachmentFormats.data(),
+            .depthAttachmentFormat = depthAttachmentFormat,
+            .stencilAttachmentFormat = stencilAttachmentFormat,
+            .rasterizationSamples = attachmentDescriptions.empty() ? vk::SampleCountFlagBits::e1 : attachmentDescriptions.front().samples,
+        };
+
+        commandBuffer.beginRenderingKHR(vk::RenderingInfo{
+            .flags = contents == vk::SubpassContents::eSecondaryCommandBuffers ? vk::RenderingFlagBits::eContentsSecondaryCommandBuffers : vk::RenderingFlags{},
+            .renderArea = renderArea,
+            .layerCount = 1,
+            .colorAttachmentCount = static_cast<u32>(colorAttachmentInfos.size()),
+            .pColorAttachments = colorAttachmentInfos.data(),
+            .pDepthAttachment = depthAttachmentFormat != vk::Format::eUndefined ? &depthAttachmentInfo : nullptr,
+            .pStencilAttachment = stencilAttachmentFormat != vk::Format::eUndefined ? &stencilAttachmentInfo : nullptr,
+        });
     }
 
-    vk::RenderPass RenderPassNode::operator()(vk::raii::CommandBuffer &commandBuffer, const std::shared_ptr<FenceCycle> &cycle, GPU &gpu) {
+    vk::RenderPass RenderPassNode::operator()(vk::raii::CommandBuffer &commandBuffer, const IntrusivePtr<FenceCycle> &cycle, GPU &gpu, vk::SubpassContents contents) {
         auto preserveAttachmentIt{preserveAttachmentReferences.begin()};
         for (auto &subpassDescription : subpassDescriptions) {
             subpassDescription.pInputAttachments = RebasePointer(attachmentReferences, subpassDescription.pInputAttachments);
@@ -225,14 +338,19 @@ namespace skyline::gpu::interconnect::node {
             preserveAttachmentIt++;
         }
 
-        auto renderPass{gpu.renderPassCache.GetRenderPass(vk::RenderPassCreateInfo{
+        if (gpu.traits.supportsDynamicRendering) {
+            BeginRendering(commandBuffer, contents);
+            return {};
+        }
+
+        auto [renderPass, renderPassCompatibilityId]{gpu.renderPassCache.GetRenderPass(vk::RenderPassCreateInfo{
             .attachmentCount = static_cast<u32>(attachmentDescriptions.size()),
             .pAttachments = attachmentDescriptions.data(),
             .subpassCount = static_cast<u32>(subpassDescriptions.size()),
             .pSubpasses = subpassDescriptions.data(),
             .dependencyCount = static_cast<u32>(subpassDependencies.size()),
             .pDependencies = subpassDependencies.data(),
-        })};
+        }, cycle)};
 
         auto useImagelessFramebuffer{gpu.traits.supportsImagelessFramebuffers};
         cache::FramebufferCreateInfo framebufferCreateInfo{
@@ -254,7 +372,7 @@ namespace skyline::gpu::interconnect::node {
         if (!useImagelessFramebuffer)
             framebufferCreateInfo.unlink<vk::FramebufferAttachmentsCreateInfo>();
 
-        auto framebuffer{gpu.framebufferCache.GetFramebuffer(framebufferCreateInfo)};
+        auto framebuffer{gpu.framebufferCache.GetFramebuffer(framebufferCreateInfo, renderPassCompatibilityId, cycle)};
 
         vk::StructureChain<vk::RenderPassBeginInfo, vk::RenderPassAttachmentBeginInfo> renderPassBeginInfo{
             vk::RenderPassBeginInfo{
@@ -273,7 +391,7 @@ namespace skyline::gpu::interconnect::node {
         if (!useImagelessFramebuffer)
             renderPassBeginInfo.unlink<vk::RenderPassAttachmentBeginInfo>();
 
-        commandBuffer.beginRenderPass(renderPassBeginInfo.get<vk::RenderPassBeginInfo>(), vk::SubpassContents::eInline);
+        commandBuffer.beginRenderPass(renderPassBeginInfo.get<vk::RenderPassBeginInfo>(), contents);
 
         return renderPass;
     }
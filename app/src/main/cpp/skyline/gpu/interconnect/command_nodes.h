@@ -9,7 +9,7 @@ namespace skyline::gpu::interconnect::node {
     /**
      * @brief A generic node for simply executing a function
      */
-    template<typename FunctionSignature = void(vk::raii::CommandBuffer &, const std::shared_ptr<FenceCycle> &, GPU &)>
+    template<typename FunctionSignature = void(vk::raii::CommandBuffer &, const IntrusivePtr<FenceCycle> &, GPU &)>
     struct FunctionNodeBase {
         std::function<FunctionSignature> function;
 
@@ -21,21 +21,34 @@ namespace skyline::gpu::interconnect::node {
         }
     };
 
-    using FunctionNode = FunctionNodeBase<>;
+    /**
+     * @brief A FunctionNode for commands outside of a render pass, the GPU work of these can be profiled separately
+     */
+    struct FunctionNode : FunctionNodeBase<> {
+        TimestampCategory category; //!< The category the GPU work of this node is profiled under
+
+        FunctionNode(std::function<void(vk::raii::CommandBuffer &, const IntrusivePtr<FenceCycle> &, GPU &)> &&function, TimestampCategory category = TimestampCategory::None) : FunctionNodeBase{std::move(function)}, category{category} {}
+    };
 
     /**
      * @brief Creates and begins a VkRenderPass alongside managing all resources bound to it and to the subpasses inside it
+     * @note When dynamic rendering is supported, the render pass is begun with vkCmdBeginRenderingKHR instead which avoids any render pass or framebuffer objects, render passes are limited to a single subpass in this case
      */
     struct RenderPassNode {
       private:
         std::vector<vk::ImageView> attachments;
         std::vector<vk::FramebufferAttachmentImageInfo> attachmentInfo;
         std::vector<vk::AttachmentDescription> attachmentDescriptions;
+        std::vector<bool> attachmentUsed; //!< If each attachment has been used by any commands in the render pass, after which it can no longer be cleared with a load op
+        vk::Extent2D attachmentExtent{std::numeric_limits<u32>::max(), std::numeric_limits<u32>::max()}; //!< The minimum dimensions of all attachments, the render area must stay within these
 
         std::vector<vk::AttachmentReference> attachmentReferences;
         std::vector<std::vector<u32>> preserveAttachmentReferences; //!< Any attachment that must be preserved to be utilized by a future subpass, these are stored per-subpass to ensure contiguity
 
         constexpr static uintptr_t NoDepthStencil{std::numeric_limits<uintptr_t>::max()}; //!< A sentinel value to denote the lack of a depth stencil attachment in a VkSubpassDescription
+        vk::ImageAspectFlags depthStencilAspect; //!< The aspects of the depth/stencil attachment of the latest subpass, this determines the attachments it is bound to with dynamic rendering
+
+        std::vector<vk::Format> colorAttachmentFormats; //!< The formats of all color attachments with dynamic rendering, this backs `inheritanceRenderingInfo`
 
         /**
          * @brief Rebases a pointer containing an offset relative to the beginning of a container
@@ -45,12 +58,20 @@ namespace skyline::gpu::interconnect::node {
             return reinterpret_cast<T *>(reinterpret_cast<uintptr_t>(container.data()) + reinterpret_cast<uintptr_t>(offset));
         }
 
+        /**
+         * @brief Begins the render pass with dynamic rendering using the attachments and operations of its only subpass
+         * @note The subpass descriptions **must** have been rebased prior to calling this
+         */
+        void BeginRendering(vk::raii::CommandBuffer &commandBuffer, vk::SubpassContents contents);
+
       public:
         std::vector<vk::SubpassDescription> subpassDescriptions;
         std::vector<vk::SubpassDependency> subpassDependencies;
 
         vk::Rect2D renderArea;
         std::vector<vk::ClearValue> clearValues;
+        bool secondaryRecordable{}; //!< If all state used by the subpass functions in this render pass is fully recorded at the start of every chunk, allowing chunks to be recorded into secondary command buffers in parallel
+        vk::CommandBufferInheritanceRenderingInfo inheritanceRenderingInfo{}; //!< The attachment formats that secondary command buffers must inherit with dynamic rendering, this is only valid after the render pass has been begun
 
         RenderPassNode(vk::Rect2D renderArea);
 
@@ -65,11 +86,24 @@ namespace skyline::gpu::interconnect::node {
          */
         void AddSubpass(span<TextureView *> inputAttachments, span<TextureView *> colorAttachments, TextureView *depthStencilAttachment, GPU& gpu);
 
+        /**
+         * @brief Marks all attachments bound to the current subpass as used by a command, this must be called for every command recorded in the render pass that accesses them
+         */
+        void MarkSubpassAttachmentsUsed();
+
+        /**
+         * @brief Expands the render area to the bounding rectangle of itself and the supplied area, so that commands with differing render areas can share a render pass
+         * @param maxExtent The minimum dimensions of any attachments which will be bound alongside the supplied render area
+         * @return If the render area could be expanded without exceeding the dimensions of any attachment
+         */
+        bool ExpandRenderArea(vk::Rect2D area, vk::Extent2D maxExtent);
+
         /**
          * @brief Clears a color attachment in the current subpass with VK_ATTACHMENT_LOAD_OP_CLEAR
          * @param colorAttachment The index of the attachment in the attachments bound to the current subpass
          * @return If the attachment could be cleared or not due to conflicts with other operations
          * @note We require a subpass to be attached during this as the clear will not take place unless it's referenced by a subpass
+         * @note Any prior clear of the attachment that hasn't been used by any commands is superseded by this clear
          */
         bool ClearColorAttachment(u32 colorAttachment, const vk::ClearColorValue &value, GPU& gpu);
 
@@ -77,22 +111,41 @@ namespace skyline::gpu::interconnect::node {
          * @brief Clears the depth/stencil attachment in the current subpass with VK_ATTACHMENT_LOAD_OP_CLEAR
          * @return If the attachment could be cleared or not due to conflicts with other operations
          * @note We require a subpass to be attached during this as the clear will not take place unless it's referenced by a subpass
+         * @note Any prior clear of the attachment that hasn't been used by any commands is superseded by this clear
          */
         bool ClearDepthStencilAttachment(const vk::ClearDepthStencilValue &value, GPU& gpu);
 
-        vk::RenderPass operator()(vk::raii::CommandBuffer &commandBuffer, const std::shared_ptr<FenceCycle> &cycle, GPU &gpu);
+        /**
+         * @brief Discards the prior contents of a color attachment in the current subpass with VK_ATTACHMENT_LOAD_OP_DONT_CARE
+         * @param colorAttachment The index of the attachment in the attachments bound to the current subpass
+         * @return If the contents could be discarded or not due to conflicts with other operations
+         * @note This must only be used if the entire render area of the attachment will be overwritten without being read
+         */
+        bool DiscardColorAttachmentLoad(u32 colorAttachment);
+
+        /**
+         * @brief Discards the contents written to the supplied attachment with VK_ATTACHMENT_STORE_OP_DONT_CARE, this is a no-op if it isn't bound to the render pass
+         * @note This must only be used if the contents of the attachment will be fully overwritten prior to being read after the render pass
+         */
+        void DiscardAttachmentStore(TextureView *view);
+
+        /**
+         * @param contents If the contents of the first subpass are recorded inline or executed from secondary command buffers
+         * @return The render pass that was begun, this is a null handle with dynamic rendering
+         */
+        vk::RenderPass operator()(vk::raii::CommandBuffer &commandBuffer, const IntrusivePtr<FenceCycle> &cycle, GPU &gpu, vk::SubpassContents contents = vk::SubpassContents::eInline);
     };
 
     /**
      * @brief A node which progresses to the next subpass during a render pass
      */
     struct NextSubpassNode {
-        void operator()(vk::raii::CommandBuffer &commandBuffer, const std::shared_ptr<FenceCycle> &cycle, GPU &gpu) {
+        void operator()(vk::raii::CommandBuffer &commandBuffer, const IntrusivePtr<FenceCycle> &cycle, GPU &gpu) {
             commandBuffer.nextSubpass(vk::SubpassContents::eInline);
         }
     };
 
-    using SubpassFunctionNode = FunctionNodeBase<void(vk::raii::CommandBuffer &, const std::shared_ptr<FenceCycle> &, GPU &, vk::RenderPass, u32)>;
+    using SubpassFunctionNode = FunctionNodeBase<void(vk::raii::CommandBuffer &, const IntrusivePtr<FenceCycle> &, GPU &, vk::RenderPass, u32)>;
 
     /**
      * @brief A FunctionNode which progresses to the next subpass prior to calling the function
@@ -100,7 +153,7 @@ namespace skyline::gpu::interconnect::node {
     struct NextSubpassFunctionNode : private SubpassFunctionNode {
         using SubpassFunctionNode::SubpassFunctionNode;
 
-        void operator()(vk::raii::CommandBuffer &commandBuffer, const std::shared_ptr<FenceCycle> &cycle, GPU &gpu, vk::RenderPass renderPass, u32 subpassIndex) {
+        void operator()(vk::raii::CommandBuffer &commandBuffer, const IntrusivePtr<FenceCycle> &cycle, GPU &gpu, vk::RenderPass renderPass, u32 subpassIndex) {
             commandBuffer.nextSubpass(vk::SubpassContents::eInline);
             SubpassFunctionNode::operator()(commandBuffer, cycle, gpu, renderPass, subpassIndex);
         }
@@ -110,10 +163,21 @@ namespace skyline::gpu::interconnect::node {
      * @brief Ends a VkRenderPass that would be created prior with RenderPassNode
      */
     struct RenderPassEndNode {
-        void operator()(vk::raii::CommandBuffer &commandBuffer, const std::shared_ptr<FenceCycle> &cycle, GPU &gpu) {
-            commandBuffer.endRenderPass();
+        void operator()(vk::raii::CommandBuffer &commandBuffer, const IntrusivePtr<FenceCycle> &cycle, GPU &gpu) {
+            if (gpu.traits.supportsDynamicRendering)
+                commandBuffer.endRenderingKHR();
+            else
+                commandBuffer.endRenderPass();
         }
     };
 
-    using NodeVariant = std::variant<FunctionNode, RenderPassNode, NextSubpassNode, SubpassFunctionNode, NextSubpassFunctionNode, RenderPassEndNode>; //!< A variant encompassing all command nodes types
+    /**
+     * @brief Marks the boundary between two chunks of subpass functions inside a render pass which may be recorded into separate secondary command buffers
+     * @note This is a no-op when the render pass is recorded inline
+     */
+    struct SubpassChunkBoundaryNode {
+        void operator()(vk::raii::CommandBuffer &commandBuffer, const IntrusivePtr<FenceCycle> &cycle, GPU &gpu) {}
+    };
+
+    using NodeVariant = std::variant<FunctionNode, RenderPassNode, NextSubpassNode, SubpassFunctionNode, NextSubpassFunctionNode, RenderPassEndNode, SubpassChunkBoundaryNode>; //!< A variant encompassing all command nodes types
 }
@@ -56,4 +56,46 @@ namespace skyline::gpu::interconnect {
         ContextLock lock{executor.tag, view};
         view.Read(lock.IsFirstUsage(), FlushHostCallback, dstBuffer, srcOffset);
     }
+
+    /**
+     * @return The buffer, offset and size that a dynamic binding currently resolves to
+     */
+    static std::tuple<vk::Buffer, vk::DeviceSize, vk::DeviceSize> ResolveDynamicBinding(const DynamicBufferBinding &dynamicBinding) {
+        if (auto view{std::get_if<BufferView>(&dynamicBinding)})
+            return {view->GetBuffer()->GetBacking(), view->GetOffset(), view->size};
+
+        const auto &binding{std::get<BufferBinding>(dynamicBinding)};
+        return {binding.buffer, binding.offset, binding.size};
+    }
+
+    bool DescriptorUpdateInfo::WritesEqual(const DescriptorUpdateInfo &other) const {
+        if (descriptorSetLayout != other.descriptorSetLayout || !copies.empty() || !other.copies.empty() || writes.size() != other.writes.size())
+            return false;
+
+        if (!std::equal(bufferDescDynamicBindings.begin(), bufferDescDynamicBindings.end(), other.bufferDescDynamicBindings.begin(), other.bufferDescDynamicBindings.end(), [](const DynamicBufferBinding &a, const DynamicBufferBinding &b) {
+            return ResolveDynamicBinding(a) == ResolveDynamicBinding(b);
+        }))
+            return false;
+
+        return std::equal(imageDescs.begin(), imageDescs.end(), other.imageDescs.begin(), other.imageDescs.end(), [](const vk::DescriptorImageInfo &a, const vk::DescriptorImageInfo &b) {
+            return a.sampler == b.sampler && a.imageView == b.imageView && a.imageLayout == b.imageLayout;
+        });
+    }
+
+    u64 DescriptorUpdateInfo::HashWrites() const {
+        u64 hash{XXH64(&descriptorSetLayout, sizeof(descriptorSetLayout), 0)};
+
+        for (const auto &dynamicBinding : bufferDescDynamicBindings) {
+            auto [buffer, offset, size]{ResolveDynamicBinding(dynamicBinding)};
+            std::array<u64, 3> values{reinterpret_cast<u64>(static_cast<VkBuffer>(buffer)), offset, size};
+            hash = XXH64(values.data(), sizeof(values), hash);
+        }
+
+        for (const auto &imageDesc : imageDescs) {
+            std::array<u64, 3> values{reinterpret_cast<u64>(static_cast<VkSampler>(imageDesc.sampler)), reinterpret_cast<u64>(static_cast<VkImageView>(imageDesc.imageView)), static_cast<u64>(imageDesc.imageLayout)};
+            hash = XXH64(values.data(), sizeof(values), hash);
+        }
+
+        return hash;
+    }
 }
@@ -94,9 +94,42 @@ namespace skyline::gpu::interconnect {
         span<vk::WriteDescriptorSet> writes;
         span<vk::DescriptorBufferInfo> bufferDescs;
         span<DynamicBufferBinding> bufferDescDynamicBindings;
+        span<vk::DescriptorImageInfo> imageDescs;
         vk::PipelineLayout pipelineLayout;
         vk::DescriptorSetLayout descriptorSetLayout;
         vk::PipelineBindPoint bindPoint;
         u32 descriptorSetIndex;
+        vk::DescriptorUpdateTemplate updateTemplate{}; //!< If non-null, the writes are performed with this template rather than individually, it is only used for updates without any copies
+        const void *templateData{}; //!< The data supplied to `updateTemplate`, `bufferDescs` and `imageDescs` are located at fixed offsets within it
+
+        /**
+         * @return If both updates would write identical descriptors into a set with the same layout
+         * @note Buffer views are compared by their current underlying buffer and offset, as views are only resolved during recording this is accurate for the entire execution
+         */
+        bool WritesEqual(const DescriptorUpdateInfo &other) const;
+
+        /**
+         * @return A hash of the descriptors that would be written by the update, this is consistent with `WritesEqual`
+         */
+        u64 HashWrites() const;
     };
+
+    /**
+     * @return The supplied rectangle in guest coordinates scaled into the host coordinates of a render target with the supplied resolution scale
+     */
+    inline vk::Rect2D ScaleRect(vk::Rect2D rect, float scale) {
+        if (scale == 1.0f)
+            return rect;
+
+        return vk::Rect2D{
+            .offset = {
+                .x = static_cast<i32>(std::lround(static_cast<float>(rect.offset.x) * scale)),
+                .y = static_cast<i32>(std::lround(static_cast<float>(rect.offset.y) * scale)),
+            },
+            .extent = {
+                .width = static_cast<u32>(std::lround(static_cast<float>(rect.extent.width) * scale)),
+                .height = static_cast<u32>(std::lround(static_cast<float>(rect.extent.height) * scale)),
+            },
+        };
+    }
 }
@@ -37,7 +37,7 @@ namespace skyline::gpu::interconnect {
 
     void Samplers::MarkAllDirty() {
         samplerPool.MarkDirty(true);
-        std::fill(texSamplerCache.begin(), texSamplerCache.end(), nullptr);
+        cacheGeneration++;
     }
 
     static vk::Filter ConvertSamplerFilter(TextureSamplerControl::Filter filter) {
@@ -154,9 +154,16 @@ namespace skyline::gpu::interconnect {
         auto texSamplers{samplerPoolObj.texSamplers};
         if (texSamplers.size() != texSamplerCache.size()) {
             texSamplerCache.resize(texSamplers.size());
-            std::fill(texSamplerCache.begin(), texSamplerCache.end(), nullptr);
-        } else if (texSamplerCache[index]) {
-            return texSamplerCache[index];
+            cacheGeneration++;
+        } else if (auto &cached{texSamplerCache[index]}; cached.sampler && cached.generation == cacheGeneration) {
+            // Similar to textures, the TSC is only compared against the pool once per execution
+            if (cached.executionNumber == ctx.executor.executionNumber)
+                return cached.sampler;
+
+            if (cached.tsc == texSamplers[index]) {
+                cached.executionNumber = ctx.executor.executionNumber;
+                return cached.sampler;
+            }
         }
 
         TextureSamplerControl &texSampler{texSamplers[index]};
@@ -212,7 +219,7 @@ namespace skyline::gpu::interconnect {
             sampler = std::make_unique<vk::raii::Sampler>(ctx.gpu.vkDevice, samplerInfo.get<vk::SamplerCreateInfo>());
         }
 
-        texSamplerCache[index] = sampler.get();
+        texSamplerCache[index] = {texSampler, sampler.get(), ctx.executor.executionNumber, cacheGeneration};
         return sampler.get();
     }
 
@@ -38,7 +38,15 @@ namespace skyline::gpu::interconnect {
         dirty::ManualDirtyState<SamplerPoolState> samplerPool;
 
         tsl::robin_map<TextureSamplerControl, std::unique_ptr<vk::raii::Sampler>, util::ObjectHash<TextureSamplerControl>> texSamplerStore;
-        std::vector<vk::raii::Sampler *> texSamplerCache;
+
+        struct CacheEntry {
+            TextureSamplerControl tsc;
+            vk::raii::Sampler *sampler;
+            u32 executionNumber;
+            u32 generation; //!< The cache generation this entry was filled in, entries from prior generations are treated as empty
+        };
+        std::vector<CacheEntry> texSamplerCache; //!< A per-index cache of resolved samplers, checked against the raw TSC to skip the hashed store lookup and translation
+        u32 cacheGeneration{1}; //!< Bumped to invalidate all cache entries at once rather than clearing thousands of them individually
 
       public:
         Samplers(DirtyManager &manager, const SamplerPoolState::EngineRegisters &engine);
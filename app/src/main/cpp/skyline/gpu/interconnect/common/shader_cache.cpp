@@ -12,12 +12,41 @@
 
 namespace skyline::gpu::interconnect {
     /* Pipeline Stage */
+    ShaderCache::MirrorEntry::CachedBinary ShaderCache::ParseBinary(span<u8> blockMappingMirror, size_t blockOffset, u32 programOffset, size_t sequenceNumber) {
+        MirrorEntry::CachedBinary cached{};
+        span<u8> mapping{blockMappingMirror.subspan(blockOffset)};
+
+        // We attempt to find the shader size by looking for "BRA $" (Infinite Loop) which is used as padding at the end of the shader
+        // UAM Shader Compiler Reference: https://github.com/devkitPro/uam/blob/5a5afc2bae8b55409ab36ba45be63fcb73f68993/source/compiler_iface.cpp#L319-L351
+        constexpr u64 BraSelf1{0xE2400FFFFF87000F}, BraSelf2{0xE2400FFFFF07000F};
+
+        cached.binary.binary = mapping;
+        cached.fingerprintRegion = mapping;
+        span<u64> shaderInstructions{mapping.cast<u64, std::dynamic_extent, true>()};
+        for (auto it{shaderInstructions.begin()}; it != shaderInstructions.end(); it++) {
+            auto instruction{*it};
+            if (instruction == BraSelf1 || instruction == BraSelf2) [[unlikely]] {
+                // It is far more likely that the instruction doesn't match so this is an unlikely case
+                cached.binary.binary = span{shaderInstructions.begin(), it}.cast<u8>();
+                cached.fingerprintRegion = span{shaderInstructions.begin(), std::next(it)}.cast<u8>();
+                break;
+            }
+        }
+
+        cached.binary.baseOffset = programOffset;
+        cached.binary.hash = XXH64(cached.binary.binary.data(), cached.binary.binary.size_bytes(), 0);
+        cached.fingerprint = XXH64(cached.fingerprintRegion.data(), cached.fingerprintRegion.size_bytes(), 0);
+        cached.validatedSequenceNumber = sequenceNumber;
+        return cached;
+    }
+
     ShaderBinary ShaderCache::Lookup(InterconnectContext &ctx, u64 programBase, u32 programOffset) {
         lastProgramBase = programBase;
         lastProgramOffset = programOffset;
         auto[blockMapping, blockOffset]{ctx.channelCtx.asCtx->gmmu.LookupBlock(programBase + programOffset)};
 
-        if (!trapExecutionLock)
+        bool hashValidation{ctx.gpu.IsShaderHashValidationEnabled()};
+        if (!hashValidation && !trapExecutionLock)
             trapExecutionLock.emplace(trapMutex);
 
         // Skip looking up the mirror if it is the same as the one used for the previous update
@@ -26,26 +55,28 @@ namespace skyline::gpu::interconnect {
             if (mirrorIt == mirrorMap.end()) {
                 // Allocate a host mirror for the mapping and trap the guest region
                 auto newIt{mirrorMap.emplace(blockMapping.data(), std::make_unique<MirrorEntry>(ctx.memory.CreateMirror(blockMapping)))};
-
-                // We need to create the trap after allocating the entry so that we have an `invalid` pointer we can pass in
-                auto trapHandle{ctx.nce.CreateTrap(blockMapping, [mutex = &trapMutex]() {
-                    std::scoped_lock lock{*mutex};
-                    return;
-                }, []() { return true; }, [entry = newIt.first->second.get(), mutex = &trapMutex]() {
-                    std::unique_lock lock{*mutex, std::try_to_lock};
-                    if (!lock)
-                        return false;
-
-                    if (++entry->trapCount <= MirrorEntry::SkipTrapThreshold)
-                        entry->dirty = true;
-                    return true;
-                })};
-
-                // Write only trap
-                ctx.nce.TrapRegions(trapHandle, true);
-
                 entry = newIt.first->second.get();
-                entry->trap = trapHandle;
+
+                if (!hashValidation) {
+                    // We need to create the trap after allocating the entry so that we have an `invalid` pointer we can pass in
+                    auto trapHandle{ctx.nce.CreateTrap(nce::TrapResource::Shader, blockMapping, [mutex = &trapMutex]() {
+                        std::scoped_lock lock{*mutex};
+                        return;
+                    }, []() { return true; }, [entry = entry, mutex = &trapMutex]() {
+                        std::unique_lock lock{*mutex, std::try_to_lock};
+                        if (!lock)
+                            return false;
+
+                        if (++entry->trapCount <= MirrorEntry::SkipTrapThreshold)
+                            entry->dirty = true;
+                        return true;
+                    })};
+
+                    // Write only trap
+                    ctx.nce.TrapRegions(trapHandle, true);
+
+                    entry->trap = trapHandle;
+                }
             } else {
                 entry = mirrorIt->second.get();
             }
@@ -53,8 +84,29 @@ namespace skyline::gpu::interconnect {
             mirrorBlock = blockMapping;
         }
 
-        if (entry->trapCount > MirrorEntry::SkipTrapThreshold && entry->channelSequenceNumber != ctx.channelCtx.channelSequenceNumber) {
-            entry->channelSequenceNumber = ctx.channelCtx.channelSequenceNumber;
+        // entry->mirror may not be a direct mirror of blockMapping and may just contain it as a subregion, so we need to explicitly calculate the offset
+        span<u8> blockMappingMirror{blockMapping.data() - mirrorBlock.data() + entry->mirror.data(), blockMapping.size()};
+        size_t sequenceNumber{ctx.channelCtx.channelSequenceNumber};
+
+        if (hashValidation) {
+            // Only the looked up binary is validated rather than the entire mirror, writes to any other data in the same pages don't affect it
+            lastValidatedSequenceNumber = sequenceNumber;
+            auto it{entry->cache.find(blockMapping.data() + blockOffset)};
+            if (it != entry->cache.end()) {
+                auto &cached{it->second};
+                if (cached.validatedSequenceNumber == sequenceNumber || XXH64(cached.fingerprintRegion.data(), cached.fingerprintRegion.size_bytes(), 0) == cached.fingerprint) {
+                    cached.validatedSequenceNumber = sequenceNumber;
+                    return cached.binary;
+                }
+            }
+
+            auto cached{ParseBinary(blockMappingMirror, blockOffset, programOffset, sequenceNumber)};
+            entry->cache.insert_or_assign(blockMapping.data() + blockOffset, cached);
+            return cached.binary;
+        }
+
+        if (entry->trapCount > MirrorEntry::SkipTrapThreshold && entry->channelSequenceNumber != sequenceNumber) {
+            entry->channelSequenceNumber = sequenceNumber;
             entry->dirty = true;
         }
 
@@ -66,45 +118,26 @@ namespace skyline::gpu::interconnect {
             if (entry->trapCount <= MirrorEntry::SkipTrapThreshold)
                 ctx.nce.TrapRegions(*entry->trap, true);
         } else if (auto it{entry->cache.find(blockMapping.data() + blockOffset)}; it != entry->cache.end()) {
-            return it->second;
+            return it->second.binary;
         }
 
-        // entry->mirror may not be a direct mirror of blockMapping and may just contain it as a subregion, so we need to explicitly calculate the offset
-        span<u8> blockMappingMirror{blockMapping.data() - mirrorBlock.data() + entry->mirror.data(), blockMapping.size()};
-
-        ShaderBinary binary{};
-        // If nothing was in the cache then do a full shader parse
-        binary.binary = [](span<u8> mapping) {
-            // We attempt to find the shader size by looking for "BRA $" (Infinite Loop) which is used as padding at the end of the shader
-            // UAM Shader Compiler Reference: https://github.com/devkitPro/uam/blob/5a5afc2bae8b55409ab36ba45be63fcb73f68993/source/compiler_iface.cpp#L319-L351
-            constexpr u64 BraSelf1{0xE2400FFFFF87000F}, BraSelf2{0xE2400FFFFF07000F};
-
-            span<u64> shaderInstructions{mapping.cast<u64, std::dynamic_extent, true>()};
-            for (auto it{shaderInstructions.begin()}; it != shaderInstructions.end(); it++) {
-                auto instruction{*it};
-                if (instruction == BraSelf1 || instruction == BraSelf2) [[unlikely]]
-                    // It is far more likely that the instruction doesn't match so this is an unlikely case
-                    return span{shaderInstructions.begin(), it}.cast<u8>();
-            }
-
-            return mapping;
-        }(blockMappingMirror.subspan(blockOffset));
+        auto cached{ParseBinary(blockMappingMirror, blockOffset, programOffset, sequenceNumber)};
+        entry->cache.insert({blockMapping.data() + blockOffset, cached});
 
-        binary.baseOffset = programOffset;
-        binary.hash = XXH64(binary.binary.data(), binary.binary.size_bytes(), 0);
-
-        entry->cache.insert({blockMapping.data() + blockOffset, binary});
-
-        return binary;
+        return cached.binary;
     }
 
     bool ShaderCache::Refresh(InterconnectContext &ctx, u64 programBase, u32 programOffset) {
-        if (!trapExecutionLock)
+        bool hashValidation{ctx.gpu.IsShaderHashValidationEnabled()};
+        if (!hashValidation && !trapExecutionLock)
             trapExecutionLock.emplace(trapMutex);
 
         if (programBase != lastProgramBase || programOffset != lastProgramOffset)
             return true;
 
+        if (hashValidation)
+            return lastValidatedSequenceNumber != ctx.channelCtx.channelSequenceNumber;
+
         if (entry && entry->trapCount > MirrorEntry::SkipTrapThreshold && entry->channelSequenceNumber != ctx.channelCtx.channelSequenceNumber)
             return true;
         else if (entry && entry->dirty)
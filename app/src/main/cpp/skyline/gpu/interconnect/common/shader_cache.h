@@ -13,9 +13,19 @@ namespace skyline::gpu::interconnect {
          * @brief Holds mirror state for a single GPU mapped block
          */
         struct MirrorEntry {
+            /**
+             * @brief A shader binary alongside a fingerprint of its memory, the fingerprint is used to validate the binary when write traps aren't used
+             */
+            struct CachedBinary {
+                ShaderBinary binary;
+                span<u8> fingerprintRegion; //!< The binary alongside its terminating instruction (if any), this needs to be included as overwriting it changes the extent of the binary
+                u64 fingerprint; //!< An XXH64 hash of `fingerprintRegion`
+                size_t validatedSequenceNumber; //!< The channel sequence number at which the binary was last validated against its fingerprint
+            };
+
             span<u8> mirror;
-            tsl::robin_map<u8 *, ShaderBinary> cache;
-            std::optional<nce::NCE::TrapHandle> trap;
+            tsl::robin_map<u8 *, CachedBinary> cache;
+            std::optional<nce::NCE::TrapHandle> trap; //!< A write trap over the mirrored region, this isn't created when hash validation is used
 
             static constexpr u32 SkipTrapThreshold{20}; //!< Threshold for the number of times a mirror trap needs to be hit before we fallback to always hashing
             u32 trapCount{}; //!< The number of times the trap has been hit, used to avoid trapping in cases where the constant retraps would harm performance
@@ -32,10 +42,22 @@ namespace skyline::gpu::interconnect {
         span<u8> mirrorBlock{}; //!< Guest mapped memory block corresponding to `entry`
         u64 lastProgramBase{};
         u32 lastProgramOffset{};
+        size_t lastValidatedSequenceNumber{}; //!< The channel sequence number at which the last looked up binary was validated, this is only used with hash validation
+
+        /**
+         * @brief Parses the shader binary at the supplied offset of a mirrored mapping
+         */
+        static MirrorEntry::CachedBinary ParseBinary(span<u8> blockMappingMirror, size_t blockOffset, u32 programOffset, size_t sequenceNumber);
 
       public:
+        /**
+         * @note If hash validation is enabled, cached binaries are only trusted for the channel sequence number they were validated at and are rehashed on the first lookup after it changes, this avoids trapping guest writes to shader memory entirely
+         */
         ShaderBinary Lookup(InterconnectContext &ctx, u64 programBase, u32 programOffset);
 
+        /**
+         * @return If the shader binary returned by the last lookup may have changed and a new lookup is required
+         */
         bool Refresh(InterconnectContext &ctx, u64 programBase, u32 programOffset);
 
         void PurgeCaches();
@@ -199,6 +199,52 @@ namespace skyline::gpu::interconnect {
     };
     using SetBaseStencilStateCmd = CmdHolder<SetBaseStencilStateCmdImpl>;
 
+    /**
+     * @brief Pipeline state which is set dynamically with VK_EXT_extended_dynamic_state(2) rather than being baked into the pipeline
+     */
+    struct ExtendedDynamicState {
+        vk::CullModeFlags cullMode;
+        vk::FrontFace frontFace;
+        bool depthTestEnable;
+        bool depthWriteEnable;
+        vk::CompareOp depthCompareOp;
+        bool depthBoundsTestEnable;
+        bool stencilTestEnable;
+        vk::StencilOpState stencilFront; //!< Only the operations and compare function are used, the masks and reference are set separately
+        vk::StencilOpState stencilBack; //!< Only the operations and compare function are used, the masks and reference are set separately
+
+        // VK_EXT_extended_dynamic_state2
+        bool depthBiasEnable;
+        bool primitiveRestartEnable;
+        bool rasterizerDiscardEnable;
+
+        bool operator==(const ExtendedDynamicState &) const = default;
+    };
+
+    struct SetExtendedDynamicStateCmdImpl {
+        void Record(GPU &gpu, vk::raii::CommandBuffer &commandBuffer) {
+            commandBuffer.setCullModeEXT(state.cullMode);
+            commandBuffer.setFrontFaceEXT(state.frontFace);
+            commandBuffer.setDepthTestEnableEXT(state.depthTestEnable);
+            commandBuffer.setDepthWriteEnableEXT(state.depthWriteEnable);
+            commandBuffer.setDepthCompareOpEXT(state.depthCompareOp);
+            commandBuffer.setDepthBoundsTestEnableEXT(state.depthBoundsTestEnable);
+            commandBuffer.setStencilTestEnableEXT(state.stencilTestEnable);
+            commandBuffer.setStencilOpEXT(vk::StencilFaceFlagBits::eFront, state.stencilFront.failOp, state.stencilFront.passOp, state.stencilFront.depthFailOp, state.stencilFront.compareOp);
+            commandBuffer.setStencilOpEXT(vk::StencilFaceFlagBits::eBack, state.stencilBack.failOp, state.stencilBack.passOp, state.stencilBack.depthFailOp, state.stencilBack.compareOp);
+
+            if (extendedDynamicState2) {
+                commandBuffer.setDepthBiasEnableEXT(state.depthBiasEnable);
+                commandBuffer.setPrimitiveRestartEnableEXT(state.primitiveRestartEnable);
+                commandBuffer.setRasterizerDiscardEnableEXT(state.rasterizerDiscardEnable);
+            }
+        }
+
+        ExtendedDynamicState state;
+        bool extendedDynamicState2; //!< If the state from VK_EXT_extended_dynamic_state2 should be set
+    };
+    using SetExtendedDynamicStateCmd = CmdHolder<SetExtendedDynamicStateCmdImpl>;
+
     template<bool PushDescriptor>
     struct SetDescriptorSetCmdImpl {
         void Record(GPU &gpu, vk::raii::CommandBuffer &commandBuffer) {
@@ -221,7 +267,13 @@ namespace skyline::gpu::interconnect {
             }
 
             if constexpr (PushDescriptor) {
-                commandBuffer.pushDescriptorSetKHR(updateInfo->bindPoint, updateInfo->pipelineLayout, updateInfo->descriptorSetIndex, updateInfo->writes);
+                if (updateInfo->updateTemplate)
+                    commandBuffer.getDispatcher()->vkCmdPushDescriptorSetWithTemplateKHR(*commandBuffer, updateInfo->updateTemplate, updateInfo->pipelineLayout, updateInfo->descriptorSetIndex, updateInfo->templateData);
+                else
+                    commandBuffer.pushDescriptorSetKHR(updateInfo->bindPoint, updateInfo->pipelineLayout, updateInfo->descriptorSetIndex, updateInfo->writes);
+            } else if (updateInfo->updateTemplate && updateInfo->copies.empty()) {
+                gpu.vkDevice.getDispatcher()->vkUpdateDescriptorSetWithTemplate(*gpu.vkDevice, **dstSet, updateInfo->updateTemplate, updateInfo->templateData);
+                commandBuffer.bindDescriptorSets(updateInfo->bindPoint, updateInfo->pipelineLayout, updateInfo->descriptorSetIndex, **dstSet, {});
             } else {
                 // Set the destination/(source) descriptor set(s) for all writes/(copies)
                 for (auto &write : updateInfo->writes)
@@ -251,6 +303,19 @@ namespace skyline::gpu::interconnect {
     using SetDescriptorSetWithUpdateCmd = CmdHolder<SetDescriptorSetCmdImpl<false>>;
     using SetDescriptorSetWithPushCmd = CmdHolder<SetDescriptorSetCmdImpl<true>>;
 
+    /**
+     * @brief Binds a descriptor set that has already been written by a prior update with identical descriptors
+     */
+    struct BindDescriptorSetCmdImpl {
+        void Record(GPU &gpu, vk::raii::CommandBuffer &commandBuffer) {
+            commandBuffer.bindDescriptorSets(updateInfo->bindPoint, updateInfo->pipelineLayout, updateInfo->descriptorSetIndex, **set, {});
+        }
+
+        DescriptorUpdateInfo *updateInfo;
+        DescriptorAllocator::ActiveDescriptorSet *set;
+    };
+    using BindDescriptorSetCmd = CmdHolder<BindDescriptorSetCmdImpl>;
+
     struct SetPipelineCmdImpl {
         void Record(GPU &gpu, vk::raii::CommandBuffer &commandBuffer) {
             commandBuffer.bindPipeline(bindPoint, pipeline);
@@ -261,6 +326,60 @@ namespace skyline::gpu::interconnect {
     };
     using SetPipelineCmd = CmdHolder<SetPipelineCmdImpl>;
 
+    /**
+     * @brief The state that was last set by state updates in the command buffer they're recorded into, this allows for redundant state updates to be elided while they're being built
+     * @note This must be reset whenever the state in the command buffer is invalidated by anything other than state updates or a new command buffer is begun, any state updates that were built with it must be recorded in the same order
+     */
+    struct RecordedState {
+        struct VertexBuffer {
+            std::variant<std::monostate, BufferBinding, BufferView> buffer;
+            vk::DeviceSize stride;
+            bool ext;
+
+            bool operator==(const VertexBuffer &) const = default;
+        };
+        std::array<VertexBuffer, MaxVertexBufferCount> vertexBuffers{};
+
+        struct IndexBuffer {
+            std::variant<std::monostate, BufferBinding, BufferView> buffer;
+            vk::IndexType indexType;
+
+            bool operator==(const IndexBuffer &) const = default;
+        };
+        IndexBuffer indexBuffer{};
+
+        static constexpr size_t MaxViewportCount{16};
+        std::array<std::optional<vk::Viewport>, MaxViewportCount> viewports;
+        std::array<std::optional<vk::Rect2D>, MaxViewportCount> scissors;
+        std::optional<float> lineWidth;
+        std::optional<std::array<float, 3>> depthBias;
+        std::optional<std::array<float, 4>> blendConstants;
+        std::optional<std::array<float, 2>> depthBounds;
+        std::optional<std::array<u32, 3>> frontStencil; //!< The reference, compare mask and write mask of front-facing stencil state
+        std::optional<std::array<u32, 3>> backStencil; //!< The reference, compare mask and write mask of back-facing stencil state
+        std::optional<std::pair<ExtendedDynamicState, bool>> extendedDynamicState; //!< The extended dynamic state alongside if VK_EXT_extended_dynamic_state2 state was set with it
+
+        /**
+         * @brief Invalidates all recorded state, the next update of any state will always be emitted
+         */
+        void Reset() {
+            *this = {};
+        }
+
+        /**
+         * @brief Records the supplied value as the current state
+         * @return If the state was already set to the value and the update can be elided
+         */
+        template<typename T, typename U>
+        static bool Update(T &state, const U &value) {
+            if (state == value)
+                return true;
+
+            state = value;
+            return false;
+        }
+    };
+
     /**
      * @brief Single-use helper for recording a batch of state updates into a command buffer
      */
@@ -286,6 +405,7 @@ namespace skyline::gpu::interconnect {
     class StateUpdateBuilder {
       private:
         LinearAllocatorState<> &allocator;
+        RecordedState *recordedState; //!< If non-null, state updates which are redundant with the recorded state are elided
         u32 vertexBatchBindNextBinding{};
         SetVertexBuffersDynamicCmd *vertexBatchBind{};
         StateUpdateCmdHeader *head{};
@@ -315,7 +435,7 @@ namespace skyline::gpu::interconnect {
         }
 
       public:
-        StateUpdateBuilder(LinearAllocatorState<> &allocator) : allocator{allocator} {
+        StateUpdateBuilder(LinearAllocatorState<> &allocator, RecordedState *recordedState = nullptr) : allocator{allocator}, recordedState{recordedState} {
             vertexBatchBind = allocator.EmplaceUntracked<SetVertexBuffersDynamicCmd>();
         }
 
@@ -325,6 +445,9 @@ namespace skyline::gpu::interconnect {
         }
 
         void SetVertexBuffer(u32 index, const BufferBinding &binding, bool ext = false, vk::DeviceSize stride = 0) {
+            if (recordedState && RecordedState::Update(recordedState->vertexBuffers[index], RecordedState::VertexBuffer{binding, stride, ext}))
+                return;
+
             if (index != vertexBatchBindNextBinding || vertexBatchBind->header.record != &SetVertexBuffersCmd::Record || vertexBatchBind->cmd.base.ext != ext) {
                 FlushVertexBatchBind();
                 vertexBatchBind->header.record = &SetVertexBuffersCmd::Record;
@@ -344,6 +467,9 @@ namespace skyline::gpu::interconnect {
         void SetVertexBuffer(u32 index, BufferView view, bool ext = false, vk::DeviceSize stride = 0) {
             view.GetBuffer()->BlockSequencedCpuBackingWrites();
 
+            if (recordedState && RecordedState::Update(recordedState->vertexBuffers[index], RecordedState::VertexBuffer{view, stride, ext}))
+                return;
+
             if (index != vertexBatchBindNextBinding || vertexBatchBind->header.record != &SetVertexBuffersDynamicCmd::Record || vertexBatchBind->cmd.base.ext != ext) {
                 FlushVertexBatchBind();
                 vertexBatchBind->header.record = &SetVertexBuffersDynamicCmd::Record;
@@ -359,6 +485,9 @@ namespace skyline::gpu::interconnect {
         }
 
         void SetIndexBuffer(const BufferBinding &binding, vk::IndexType indexType) {
+            if (recordedState && RecordedState::Update(recordedState->indexBuffer, RecordedState::IndexBuffer{binding, indexType}))
+                return;
+
             AppendCmd<SetIndexBufferCmd>(
                 {
                     .indexType = indexType,
@@ -370,6 +499,9 @@ namespace skyline::gpu::interconnect {
         void SetIndexBuffer(BufferView view, vk::IndexType indexType) {
             view.GetBuffer()->BlockSequencedCpuBackingWrites();
 
+            if (recordedState && RecordedState::Update(recordedState->indexBuffer, RecordedState::IndexBuffer{view, indexType}))
+                return;
+
             AppendCmd<SetIndexBufferDynamicCmd>(
                 {
                     .base.indexType = indexType,
@@ -398,6 +530,9 @@ namespace skyline::gpu::interconnect {
         }
 
         void SetViewport(u32 index, const vk::Viewport &viewport) {
+            if (recordedState && RecordedState::Update(recordedState->viewports[index], viewport))
+                return;
+
             AppendCmd<SetViewportCmd>(
                 {
                     .index = index,
@@ -406,6 +541,9 @@ namespace skyline::gpu::interconnect {
         }
 
         void SetScissor(u32 index, const vk::Rect2D &scissor) {
+            if (recordedState && RecordedState::Update(recordedState->scissors[index], scissor))
+                return;
+
             AppendCmd<SetScissorCmd>(
                 {
                     .index = index,
@@ -414,6 +552,9 @@ namespace skyline::gpu::interconnect {
         }
 
         void SetLineWidth(float lineWidth) {
+            if (recordedState && RecordedState::Update(recordedState->lineWidth, lineWidth))
+                return;
+
             AppendCmd<SetLineWidthCmd>(
                 {
                     .lineWidth = lineWidth,
@@ -421,6 +562,9 @@ namespace skyline::gpu::interconnect {
         }
 
         void SetDepthBias(float depthBiasConstantFactor, float depthBiasClamp, float depthBiasSlopeFactor) {
+            if (recordedState && RecordedState::Update(recordedState->depthBias, std::array<float, 3>{depthBiasConstantFactor, depthBiasClamp, depthBiasSlopeFactor}))
+                return;
+
             AppendCmd<SetDepthBiasCmd>(
                 {
                     .depthBiasConstantFactor = depthBiasConstantFactor,
@@ -430,6 +574,9 @@ namespace skyline::gpu::interconnect {
         }
 
         void SetBlendConstants(const std::array<float, 4> &blendConstants) {
+            if (recordedState && RecordedState::Update(recordedState->blendConstants, blendConstants))
+                return;
+
             AppendCmd<SetBlendConstantsCmd>(
                 {
                     .blendConstants = blendConstants,
@@ -437,6 +584,9 @@ namespace skyline::gpu::interconnect {
         }
 
         void SetDepthBounds(float minDepthBounds, float maxDepthBounds) {
+            if (recordedState && RecordedState::Update(recordedState->depthBounds, std::array<float, 2>{minDepthBounds, maxDepthBounds}))
+                return;
+
             AppendCmd<SetDepthBoundsCmd>(
                 {
                     .minDepthBounds = minDepthBounds,
@@ -445,6 +595,15 @@ namespace skyline::gpu::interconnect {
         }
 
         void SetBaseStencilState(vk::StencilFaceFlags flags, u32 funcRef, u32 funcMask, u32 mask) {
+            if (recordedState) {
+                // The recorded state of every face covered by the update is updated, the update can only be elided if it's redundant for all of them
+                std::array<u32, 3> stencil{funcRef, funcMask, mask};
+                bool frontRedundant{!(flags & vk::StencilFaceFlagBits::eFront) || RecordedState::Update(recordedState->frontStencil, stencil)};
+                bool backRedundant{!(flags & vk::StencilFaceFlagBits::eBack) || RecordedState::Update(recordedState->backStencil, stencil)};
+                if (frontRedundant && backRedundant)
+                    return;
+            }
+
             AppendCmd<SetBaseStencilStateCmd>(
                 {
                     .flags = flags,
@@ -454,6 +613,17 @@ namespace skyline::gpu::interconnect {
                 });
         }
 
+        void SetExtendedDynamicState(const ExtendedDynamicState &state, bool extendedDynamicState2) {
+            if (recordedState && RecordedState::Update(recordedState->extendedDynamicState, std::pair{state, extendedDynamicState2}))
+                return;
+
+            AppendCmd<SetExtendedDynamicStateCmd>(
+                {
+                    .state = state,
+                    .extendedDynamicState2 = extendedDynamicState2,
+                });
+        }
+
         void SetDescriptorSetWithUpdate(DescriptorUpdateInfo *updateInfo, DescriptorAllocator::ActiveDescriptorSet *dstSet, DescriptorAllocator::ActiveDescriptorSet *srcSet) {
             AppendCmd<SetDescriptorSetWithUpdateCmd>(
                 {
@@ -463,6 +633,14 @@ namespace skyline::gpu::interconnect {
                 });
         }
 
+        void BindDescriptorSet(DescriptorUpdateInfo *updateInfo, DescriptorAllocator::ActiveDescriptorSet *set) {
+            AppendCmd<BindDescriptorSetCmd>(
+                {
+                    .updateInfo = updateInfo,
+                    .set = set,
+                });
+        }
+
         void SetPipeline(vk::Pipeline pipeline, vk::PipelineBindPoint bindPoint) {
             AppendCmd<SetPipelineCmd>(
                 {
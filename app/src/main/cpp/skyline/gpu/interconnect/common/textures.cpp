@@ -184,16 +184,29 @@ namespace skyline::gpu::interconnect {
     }
 
     TextureView *Textures::GetTexture(InterconnectContext &ctx, u32 index, Shader::TextureType shaderType) {
+        if (u32 generation{ctx.gpu.texture.GetEvictionGeneration()}; generation != evictionGeneration) [[unlikely]] {
+            // The store would otherwise keep evicted textures alive indefinitely, cached views are raw pointers into the store so the cache must be cleared alongside
+            evictionGeneration = generation;
+            for (auto it{textureHeaderStore.begin()}; it != textureHeaderStore.end();) {
+                if (it->second && it->second->texture->evicted)
+                    it = textureHeaderStore.erase(it);
+                else
+                    ++it;
+            }
+            cacheGeneration++;
+        }
+
         auto textureHeaders{texturePool.UpdateGet(ctx).textureHeaders};
         if (textureHeaderCache.size() != textureHeaders.size()) {
             textureHeaderCache.resize(textureHeaders.size());
-            std::fill(textureHeaderCache.begin(), textureHeaderCache.end(), CacheEntry{});
-        } else if (auto &cached{textureHeaderCache[index]}; cached.view) {
+            cacheGeneration++;
+        } else if (auto &cached{textureHeaderCache[index]}; cached.view && cached.generation == cacheGeneration) {
             if (cached.executionNumber == ctx.executor.executionNumber)
                 return cached.view;
 
             if (cached.tic == textureHeaders[index] && !cached.view->texture->replaced) {
                 cached.executionNumber = ctx.executor.executionNumber;
+                ctx.gpu.texture.MarkUsed(*cached.view->texture); // Textures must be marked as used prior to being attached to avoid them being evicted by a lookup for a subsequent texture
                 return cached.view;
             }
         }
@@ -321,7 +334,8 @@ namespace skyline::gpu::interconnect {
             texture = ctx.gpu.texture.FindOrCreate(guest, ctx.executor.tag);
         }
 
-        textureHeaderCache[index] = {textureHeader, texture.get(), ctx.executor.executionNumber};
+        ctx.gpu.texture.MarkUsed(*texture->texture);
+        textureHeaderCache[index] = {textureHeader, texture.get(), ctx.executor.executionNumber, cacheGeneration};
         return texture.get();
     }
 
@@ -42,8 +42,11 @@ namespace skyline::gpu::interconnect {
             TextureImageControl tic;
             TextureView *view;
             u32 executionNumber;
+            u32 generation; //!< The cache generation this entry was filled in, entries from prior generations are treated as empty
         };
-        std::vector<CacheEntry> textureHeaderCache;
+        std::vector<CacheEntry> textureHeaderCache; //!< A per-index cache of resolved views, checked against the raw TIC to skip the hashed store lookup and translation
+        u32 cacheGeneration{1}; //!< Bumped to invalidate all cache entries at once rather than clearing thousands of them individually
+        u32 evictionGeneration{}; //!< The texture manager's eviction generation when evicted textures were last dropped from the store
 
       public:
         Textures(DirtyManager &manager, const TexturePoolState::EngineRegisters &engine);
@@ -0,0 +1,12 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#include "indices.h"
+
+namespace skyline::gpu::interconnect::conversion::indices {
+    void WidenUint8Indices(u16 *__restrict__ dest, const u8 *__restrict__ source, u32 indexCount) {
+        #pragma clang loop vectorize(enable) interleave(enable) unroll(enable)
+        for (u32 i{}; i < indexCount; i++)
+            dest[i] = source[i];
+    }
+}
@@ -0,0 +1,14 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#pragma once
+
+#include <common/base.h>
+
+namespace skyline::gpu::interconnect::conversion::indices {
+    /**
+     * @brief Widens 8-bit indices into 16-bit indices for hosts that lack support for 8-bit index buffers
+     * @note The destination buffer should be at least twice the size of the source
+     */
+    void WidenUint8Indices(u16 *dest, const u8 *source, u32 indexCount);
+}
@@ -111,6 +111,53 @@ namespace skyline::gpu::interconnect {
           channelCtx{channelCtx},
           executor{channelCtx.executor} {}
 
+    bool Fermi2D::TryCopy(const std::shared_ptr<TextureView> &srcView, const std::shared_ptr<TextureView> &dstView, float srcRectX, float srcRectY, u32 dstRectWidth, u32 dstRectHeight, u32 dstRectX, u32 dstRectY, float duDx, float dvDy) {
+        // Only unscaled blits from integer coordinates sample texels 1:1 so that filtering has no effect on the result
+        if (duDx != 1.0f || dvDy != 1.0f || srcRectX < 0.0f || srcRectY < 0.0f || std::trunc(srcRectX) != srcRectX || std::trunc(srcRectY) != srcRectY)
+            return false;
+
+        auto &srcTexture{*srcView->texture}, &dstTexture{*dstView->texture};
+        if (&srcTexture == &dstTexture || srcTexture.IsScaled() || dstTexture.IsScaled())
+            return false;
+
+        // A blit converts between the view formats while a copy is of the raw texels in the image format, so they must all be the same for the results to match
+        if (srcView->format != srcTexture.format || dstView->format != dstTexture.format || srcTexture.format->vkFormat != dstTexture.format->vkFormat ||
+            srcTexture.format->vkAspect != vk::ImageAspectFlagBits::eColor || srcTexture.sampleCount != dstTexture.sampleCount)
+            return false;
+
+        auto srcX{static_cast<u32>(srcRectX)}, srcY{static_cast<u32>(srcRectY)};
+        auto srcLevel{srcView->range.baseMipLevel}, dstLevel{dstView->range.baseMipLevel};
+        auto srcWidth{std::max(srcTexture.dimensions.width >> srcLevel, 1U)}, srcHeight{std::max(srcTexture.dimensions.height >> srcLevel, 1U)};
+        auto dstWidth{std::max(dstTexture.dimensions.width >> dstLevel, 1U)}, dstHeight{std::max(dstTexture.dimensions.height >> dstLevel, 1U)};
+        if (srcX + dstRectWidth > srcWidth || srcY + dstRectHeight > srcHeight || dstRectX + dstRectWidth > dstWidth || dstRectY + dstRectHeight > dstHeight)
+            return false; // Out of bounds blits are clamped by the sampler which a copy can't emulate
+
+        vk::ImageCopy region{
+            .srcSubresource = {
+                .aspectMask = vk::ImageAspectFlagBits::eColor,
+                .mipLevel = srcLevel,
+                .baseArrayLayer = srcView->range.baseArrayLayer,
+                .layerCount = 1,
+            },
+            .srcOffset = {static_cast<i32>(srcX), static_cast<i32>(srcY), 0},
+            .dstSubresource = {
+                .aspectMask = vk::ImageAspectFlagBits::eColor,
+                .mipLevel = dstLevel,
+                .baseArrayLayer = dstView->range.baseArrayLayer,
+                .layerCount = 1,
+            },
+            .dstOffset = {static_cast<i32>(dstRectX), static_cast<i32>(dstRectY), 0},
+            .extent = {dstRectWidth, dstRectHeight, 1},
+        };
+
+        executor.AddTransferCommand([srcView, dstView, region](vk::raii::CommandBuffer &commandBuffer, const IntrusivePtr<FenceCycle> &, GPU &) {
+            // All attached textures are kept in the general layout during executions
+            commandBuffer.copyImage(srcView->texture->GetBacking(), vk::ImageLayout::eGeneral, dstView->texture->GetBacking(), vk::ImageLayout::eGeneral, region);
+        }, {ResourceAccess::Of(srcView->texture.get(), false), ResourceAccess::Of(dstView->texture.get(), true)}, TimestampCategory::Blit);
+
+        return true;
+    }
+
     void Fermi2D::Blit(const Surface &srcSurface, const Surface &dstSurface, float srcRectX, float srcRectY, u32 dstRectWidth, u32 dstRectHeight, u32 dstRectX, u32 dstRectY, float duDx, float dvDy, SampleModeOrigin sampleOrigin, bool resolve, SampleModeFilter filter) {
         // TODO: When we support MSAA perform a resolve operation rather than blit when the `resolve` flag is set.
         auto srcGuestTexture{GetGuestTexture(srcSurface)};
@@ -124,6 +171,9 @@ namespace skyline::gpu::interconnect {
         executor.AttachDependency(dstTextureView);
         executor.AttachTexture(dstTextureView.get());
 
+        if (TryCopy(srcTextureView, dstTextureView, srcRectX, srcRectY, dstRectWidth, dstRectHeight, dstRectX, dstRectY, duDx, dvDy))
+            return;
+
         // Blit shader always samples from centre so adjust if necessary
         float centredSrcRectX{sampleOrigin == SampleModeOrigin::Corner ? srcRectX - 0.5f : srcRectX};
         float centredSrcRectY{sampleOrigin == SampleModeOrigin::Corner ? srcRectY - 0.5f : srcRectY};
@@ -149,7 +199,9 @@ namespace skyline::gpu::interconnect {
             [=](auto &&executionCallback) {
                 auto dst{dstTextureView.get()};
                 std::array<TextureView *, 1> sampledImages{srcTextureView.get()};
-                executor.AddSubpass(std::move(executionCallback), {{static_cast<i32>(dstRectX), static_cast<i32>(dstRectY)}, {dstRectWidth, dstRectHeight} }, sampledImages, {}, {dst});
+                // The blit writes all components without blending, so the prior contents of the destination aren't required unless they are also the source
+                bool overwritesDst{srcTextureView->texture != dstTextureView->texture};
+                executor.AddSubpass(std::move(executionCallback), ScaleRect({{static_cast<i32>(dstRectX), static_cast<i32>(dstRectY)}, {dstRectWidth, dstRectHeight}}, dst->texture->resolutionScale), sampledImages, {}, {dst}, {}, false, overwritesDst);
             }
         );
 
@@ -35,6 +35,12 @@ namespace skyline::gpu::interconnect {
 
         gpu::GuestTexture GetGuestTexture(const Surface &surface);
 
+        /**
+         * @brief Records a blit as an image copy if it is a 1:1 copy of texels between equally formatted textures, this avoids the overhead of a render pass and a helper shader draw
+         * @return If the blit was recorded as a copy
+         */
+        bool TryCopy(const std::shared_ptr<TextureView> &srcView, const std::shared_ptr<TextureView> &dstView, float srcRectX, float srcRectY, u32 dstRectWidth, u32 dstRectHeight, u32 dstRectX, u32 dstRectY, float duDx, float dvDy);
+
       public:
         Fermi2D(GPU &gpu, soc::gm20b::ChannelContext &channelCtx);
 
@@ -13,7 +13,71 @@ namespace skyline::gpu::interconnect {
     Inline2Memory::Inline2Memory(GPU &gpu, soc::gm20b::ChannelContext &channelCtx)
         : gpu{gpu},
           channelCtx{channelCtx},
-          executor{channelCtx.executor} {}
+          executor{channelCtx.executor} {
+        executor.AddFlushCallback([this] {
+            FlushPendingCopy();
+        });
+    }
+
+    void Inline2Memory::FlushPendingCopy() {
+        if (!pendingCopy)
+            return;
+
+        pendingCopy->allocation = gpu.megaBufferAllocator.Push(executor.cycle, pendingCopy->staging);
+        pendingCopy.reset();
+    }
+
+    bool Inline2Memory::CanCoalesce(Buffer *buffer, vk::DeviceSize dstOffset, vk::DeviceSize size) {
+        // Any work recorded after the pending copy may depend on its contents so it can only be extended while it's the last node
+        if (!pendingCopy || pendingExecutionNumber != executor.executionNumber || pendingNodeCount != executor.GetNodeCount())
+            return false;
+
+        if (pendingCopy->staging.size() + size > MaxCoalescedSize || pendingCopy->regions.front().view.GetBuffer() != buffer)
+            return false;
+
+        // Regions of a single copy command must not overlap as the order they're written in is undefined
+        return std::none_of(pendingCopy->regions.begin(), pendingCopy->regions.end(), [&](const CopyRegion &region) {
+            auto regionOffset{region.view.GetOffset()};
+            return dstOffset < regionOffset + region.size && regionOffset < dstOffset + size;
+        });
+    }
+
+    void Inline2Memory::UploadGpu(BufferView dstBuf, span<u8> src) {
+        auto buffer{dstBuf.GetBuffer()};
+        auto dstOffset{dstBuf.GetOffset()};
+        if (CanCoalesce(buffer, dstOffset, src.size_bytes()) && executor.TryExtendTransfer({ResourceAccess::Of(dstBuf, true)})) {
+            auto stagingOffset{pendingCopy->staging.size()};
+            pendingCopy->staging.insert(pendingCopy->staging.end(), src.begin(), src.end());
+
+            auto &lastRegion{pendingCopy->regions.back()};
+            if (lastRegion.view.GetOffset() + lastRegion.size == dstOffset && lastRegion.stagingOffset + lastRegion.size == stagingOffset)
+                lastRegion.size += src.size_bytes(); // Sequential uploads are merged into a single region
+            else
+                pendingCopy->regions.push_back(CopyRegion{dstBuf, stagingOffset, src.size_bytes()});
+            return;
+        }
+
+        FlushPendingCopy();
+
+        pendingCopy = std::make_shared<CoalescedCopy>();
+        pendingCopy->staging.assign(src.begin(), src.end());
+        pendingCopy->regions.push_back(CopyRegion{dstBuf, 0, src.size_bytes()});
+
+        executor.AddTransferCommand([copy = pendingCopy](vk::raii::CommandBuffer &commandBuffer, const IntrusivePtr<FenceCycle> &, GPU &) {
+            boost::container::small_vector<vk::BufferCopy, 4> copyRegions;
+            for (const auto &region : copy->regions)
+                copyRegions.push_back(vk::BufferCopy{
+                    .size = region.size,
+                    .srcOffset = copy->allocation.offset + region.stagingOffset,
+                    .dstOffset = region.view.GetOffset()
+                });
+
+            commandBuffer.copyBuffer(copy->allocation.buffer, copy->regions.front().view.GetBuffer()->GetBacking(), vk::ArrayProxy<const vk::BufferCopy>{static_cast<u32>(copyRegions.size()), copyRegions.data()});
+        }, {ResourceAccess::Of(dstBuf, true)});
+
+        pendingExecutionNumber = executor.executionNumber;
+        pendingNodeCount = executor.GetNodeCount();
+    }
 
     void Inline2Memory::UploadSingleMapping(span<u8> dst, span<u8> src) {
         auto dstBuf{gpu.buffer.FindOrCreate(dst, executor.tag, [this](std::shared_ptr<Buffer> buffer, ContextLock<Buffer> &&lock) {
@@ -27,19 +91,7 @@ namespace skyline::gpu::interconnect {
             // This will prevent any CPU accesses to backing for the duration of the usage
             dstBuf.GetBuffer()->BlockAllCpuBackingWrites();
 
-            auto srcGpuAllocation{gpu.megaBufferAllocator.Push(executor.cycle, src)};
-            executor.AddOutsideRpCommand([srcGpuAllocation, dstBuf, src](vk::raii::CommandBuffer &commandBuffer, const std::shared_ptr<FenceCycle> &, GPU &) {
-                vk::BufferCopy copyRegion{
-                    .size = src.size_bytes(),
-                    .srcOffset = srcGpuAllocation.offset,
-                    .dstOffset = dstBuf.GetOffset()
-                };
-                commandBuffer.copyBuffer(srcGpuAllocation.buffer, dstBuf.GetBuffer()->GetBacking(), copyRegion);
-                commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eAllCommands, {}, vk::MemoryBarrier{
-                    .srcAccessMask = vk::AccessFlagBits::eTransferWrite,
-                    .dstAccessMask = vk::AccessFlagBits::eMemoryRead | vk::AccessFlagBits::eMemoryWrite
-                }, {}, {});
-            });
+            UploadGpu(dstBuf, src);
         });
     }
 
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <gpu/buffer.h>
 #include <soc/gm20b/gmmu.h>
 
 namespace skyline::gpu {
@@ -24,9 +25,47 @@ namespace skyline::gpu::interconnect {
       private:
         using IOVA = soc::gm20b::IOVA;
 
+        static constexpr size_t MaxCoalescedSize{0x10000}; //!< The maximum amount of bytes that will be coalesced into a single copy, this bounds the size of the staging data
+
+        /**
+         * @brief A region of a coalesced copy which targets a single view
+         */
+        struct CopyRegion {
+            BufferView view;
+            vk::DeviceSize stagingOffset; //!< The offset of the region's data in the staging data
+            vk::DeviceSize size;
+        };
+
+        /**
+         * @brief A set of GPU-side uploads to a single buffer which are all performed by a single copy command
+         */
+        struct CoalescedCopy {
+            std::vector<u8> staging; //!< The data for all regions, this is pushed to the megabuffer once no more regions can be added
+            std::vector<CopyRegion> regions; //!< Non-overlapping regions of the buffer that are written to
+            MegaBufferAllocator::Allocation allocation; //!< The megabuffer allocation holding the staging data
+        };
+
         GPU &gpu;
         soc::gm20b::ChannelContext &channelCtx;
         gpu::interconnect::CommandExecutor &executor;
+        std::shared_ptr<CoalescedCopy> pendingCopy; //!< The copy that uploads may be coalesced into, this is only valid while it's the last node in the executor
+        u32 pendingExecutionNumber{}; //!< The executor execution that the pending copy was recorded in
+        size_t pendingNodeCount{}; //!< The amount of nodes in the executor after the pending copy was recorded
+
+        /**
+         * @brief Pushes the staging data of the pending copy to the megabuffer, any further uploads will use a new copy
+         */
+        void FlushPendingCopy();
+
+        /**
+         * @return If the supplied upload can be appended to the pending copy without altering the ordering of GPU operations
+         */
+        bool CanCoalesce(Buffer *buffer, vk::DeviceSize dstOffset, vk::DeviceSize size);
+
+        /**
+         * @brief Records a GPU-side upload into the buffer, coalescing it into the pending copy when possible
+         */
+        void UploadGpu(BufferView dstBuf, span<u8> src);
 
         void UploadSingleMapping(span<u8> dst, span<u8> src);
 
@@ -9,6 +9,18 @@
 #include "kepler_compute.h"
 
 namespace skyline::gpu::interconnect::kepler_compute {
+    struct BatchedDispatch {
+        std::array<u32, 3> dimensions;
+        BatchedDispatch *next;
+    };
+
+    struct KeplerCompute::DispatchBatch {
+        StateUpdater stateUpdater;
+        bool barrierBetweenDispatches; //!< If a barrier is required between the dispatches as they may consume the output of prior ones
+        BatchedDispatch *first;
+        BatchedDispatch *last;
+    };
+
     KeplerCompute::KeplerCompute(GPU &gpu,
                                  soc::gm20b::ChannelContext &channelCtx,
                                  nce::NCE &nce,
@@ -24,9 +36,49 @@ namespace skyline::gpu::interconnect::kepler_compute {
             constantBuffers.MarkAllDirty();
             samplers.MarkAllDirty();
             textures.MarkAllDirty();
+
+            activeBatch = nullptr;
+            activeBatchPipeline = nullptr;
+            activeBatchDescriptors = nullptr;
+            descriptorSetCache.fill({});
         });
     }
 
+    bool KeplerCompute::CanAppendToBatch(Pipeline *pipeline, DescriptorUpdateInfo *descUpdateInfo) const {
+        if (!activeBatch || activeBatchPipeline != pipeline || ctx.executor.GetNodeCount() != activeBatchNodeCount)
+            return false;
+
+        if (!descUpdateInfo || !activeBatchDescriptors)
+            return descUpdateInfo == activeBatchDescriptors;
+
+        return descUpdateInfo->WritesEqual(*activeBatchDescriptors);
+    }
+
+    void KeplerCompute::BindDescriptors(StateUpdateBuilder &builder, DescriptorUpdateInfo *descUpdateInfo) {
+        if (ctx.gpu.traits.supportsPushDescriptors) {
+            builder.SetDescriptorSetWithPush(descUpdateInfo);
+            return;
+        }
+
+        // Compute updates are always full updates so any set written with identical descriptors earlier in the execution can be bound as-is
+        u64 hash{descUpdateInfo->HashWrites()};
+        auto cachedSet{std::find_if(descriptorSetCache.begin(), descriptorSetCache.end(), [&](const CachedDescriptorSet &entry) {
+            return entry.updateInfo && entry.hash == hash && entry.updateInfo->WritesEqual(*descUpdateInfo);
+        })};
+
+        if (cachedSet != descriptorSetCache.end()) {
+            builder.BindDescriptorSet(descUpdateInfo, cachedSet->set);
+        } else {
+            auto set{std::make_shared<DescriptorAllocator::ActiveDescriptorSet>(ctx.gpu.descriptor.AllocateSet(descUpdateInfo->descriptorSetLayout))};
+
+            builder.SetDescriptorSetWithUpdate(descUpdateInfo, set.get(), nullptr);
+            ctx.executor.AttachDependency(set);
+
+            descriptorSetCache[descriptorSetCacheNextIdx] = {hash, descUpdateInfo, set.get()};
+            descriptorSetCacheNextIdx = (descriptorSetCacheNextIdx + 1) % DescriptorSetCacheSize;
+        }
+    }
+
     void KeplerCompute::Dispatch(const QMD &qmd) {
         if (ctx.gpu.traits.quirks.brokenComputeShaders)
             return;
@@ -38,33 +90,39 @@ namespace skyline::gpu::interconnect::kepler_compute {
         auto *pipeline{pipelineState.Update(ctx, builder, textures, constantBuffers.boundConstantBuffers, qmd)};
 
         auto *descUpdateInfo{pipeline->SyncDescriptors(ctx, constantBuffers.boundConstantBuffers, samplers, textures)};
-        builder.SetPipeline(*pipeline->compiledPipeline.pipeline, vk::PipelineBindPoint::eCompute);
 
-        if (ctx.gpu.traits.supportsPushDescriptors) {
-            builder.SetDescriptorSetWithPush(descUpdateInfo);
-        } else {
-            auto set{std::make_shared<DescriptorAllocator::ActiveDescriptorSet>(ctx.gpu.descriptor.AllocateSet(descUpdateInfo->descriptorSetLayout))};
+        auto *dispatch{ctx.executor.allocator->EmplaceUntracked<BatchedDispatch>(BatchedDispatch{{qmd.ctaRasterWidth, qmd.ctaRasterHeight, qmd.ctaRasterDepth}, nullptr})};
 
-            builder.SetDescriptorSetWithUpdate(descUpdateInfo, set.get(), nullptr);
-            ctx.executor.AttachDependency(set);
+        // Consecutive dispatches with identical state are recorded into the same command, this avoids rebinding the pipeline and descriptors for every dispatch of workloads that split their work over many small dispatches
+        if (CanAppendToBatch(pipeline, descUpdateInfo)) {
+            activeBatch->last->next = dispatch;
+            activeBatch->last = dispatch;
+            return;
         }
 
-        auto stateUpdater{builder.Build()};
+        builder.SetPipeline(*pipeline->compiledPipeline.pipeline, vk::PipelineBindPoint::eCompute);
+        BindDescriptors(builder, descUpdateInfo);
+
+        // The batch is linearly allocated to avoid a dynamic allocation with lambda captures
+        auto *batch{ctx.executor.allocator->EmplaceUntracked<DispatchBatch>(DispatchBatch{builder.Build(), pipeline->writesMemory, dispatch, dispatch})};
 
-        /**
-         * @brief Struct that can be linearly allocated, holding all state for the draw to avoid a dynamic allocation with lambda captures
-         */
-        struct DrawParams {
-            StateUpdater stateUpdater;
-            std::array<u32, 3> dimensions;
-        };
-        auto *drawParams{ctx.executor.allocator->EmplaceUntracked<DrawParams>(DrawParams{stateUpdater, {qmd.ctaRasterWidth, qmd.ctaRasterHeight, qmd.ctaRasterDepth}})};
+        ctx.executor.AddOutsideRpCommand([batch](vk::raii::CommandBuffer &commandBuffer, const IntrusivePtr<FenceCycle> &, GPU &gpu) {
+            batch->stateUpdater.RecordAll(gpu, commandBuffer);
 
+            for (auto *dispatch{batch->first}; dispatch; dispatch = dispatch->next) {
+                if (batch->barrierBetweenDispatches && dispatch != batch->first)
+                    commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eComputeShader, {}, vk::MemoryBarrier{
+                        .srcAccessMask = vk::AccessFlagBits::eShaderWrite,
+                        .dstAccessMask = vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite
+                    }, {}, {});
 
-        ctx.executor.AddOutsideRpCommand([drawParams](vk::raii::CommandBuffer &commandBuffer, const std::shared_ptr<FenceCycle> &, GPU &gpu) {
-            drawParams->stateUpdater.RecordAll(gpu, commandBuffer);
+                commandBuffer.dispatch(dispatch->dimensions[0], dispatch->dimensions[1], dispatch->dimensions[2]);
+            }
+        }, TimestampCategory::Compute);
 
-            commandBuffer.dispatch(drawParams->dimensions[0], drawParams->dimensions[1], drawParams->dimensions[2]);
-        });
+        activeBatch = batch;
+        activeBatchPipeline = pipeline;
+        activeBatchDescriptors = descUpdateInfo;
+        activeBatchNodeCount = ctx.executor.GetNodeCount();
     }
-}
\ No newline at end of file
+}
@@ -31,6 +31,32 @@ namespace skyline::gpu::interconnect::kepler_compute {
         Samplers samplers;
         Textures textures;
 
+        struct DispatchBatch; //!< A run of consecutive dispatches with identical pipelines and descriptors that are recorded as a single command, so that the state is only bound once
+
+        DispatchBatch *activeBatch{}; //!< The batch that was last recorded, this is only appended to while no other commands have been recorded after it
+        Pipeline *activeBatchPipeline{};
+        DescriptorUpdateInfo *activeBatchDescriptors{};
+        size_t activeBatchNodeCount{}; //!< The node count of the executor after the active batch was recorded
+
+        struct CachedDescriptorSet {
+            u64 hash; //!< The value of `DescriptorUpdateInfo::HashWrites` for the update that wrote the set
+            DescriptorUpdateInfo *updateInfo; //!< The update that wrote the set, this is null for unused entries
+            DescriptorAllocator::ActiveDescriptorSet *set;
+        };
+        static constexpr size_t DescriptorSetCacheSize{8};
+        std::array<CachedDescriptorSet, DescriptorSetCacheSize> descriptorSetCache{}; //!< Sets written earlier in the execution which are reused by dispatches with identical descriptors
+        size_t descriptorSetCacheNextIdx{};
+
+        /**
+         * @return If the supplied dispatch state matches the active batch and no commands have been recorded since it, in which case the dispatch can be appended to it
+         */
+        bool CanAppendToBatch(Pipeline *pipeline, DescriptorUpdateInfo *descUpdateInfo) const;
+
+        /**
+         * @brief Binds the descriptors of a dispatch, reusing a set written with identical descriptors earlier in the execution if there is one
+         */
+        void BindDescriptors(StateUpdateBuilder &builder, DescriptorUpdateInfo *descUpdateInfo);
+
       public:
         KeplerCompute(GPU &gpu,
                       soc::gm20b::ChannelContext &channelCtx,
@@ -1,6 +1,7 @@
 // SPDX-License-Identifier: MPL-2.0
 // Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
 
+#include <common/performance_statistics.h>
 #include <gpu/texture/texture.h>
 #include <gpu/interconnect/command_executor.h>
 #include <gpu/interconnect/common/pipeline.inc>
@@ -10,10 +11,10 @@
 
 namespace skyline::gpu::interconnect::kepler_compute {
     static Pipeline::ShaderStage MakePipelineShader(InterconnectContext &ctx, Textures &textures, ConstantBufferSet &constantBuffers, const PackedPipelineState &packedState, const ShaderBinary &shaderBinary) {
-        ctx.gpu.shader.ResetPools();
-
+        auto pools{ctx.gpu.shader.AcquirePools()};
         auto program{ctx.gpu.shader.ParseComputeShader(
-            shaderBinary.binary, shaderBinary.baseOffset,
+            *pools,
+            shaderBinary.binary, shaderBinary.hash, shaderBinary.baseOffset,
             packedState.bindlessTextureConstantBufferSlotSelect,
             packedState.localMemorySize, packedState.sharedMemorySize,
             packedState.dimensions,
@@ -25,7 +26,7 @@ namespace skyline::gpu::interconnect::kepler_compute {
 
         Shader::Backend::Bindings bindings{};
 
-        return {ctx.gpu.shader.CompileShader({}, program, bindings), program.info};
+        return {ctx.gpu.shader.CompileShader({}, program, bindings, shaderBinary.hash), program.info};
     }
 
     static Pipeline::DescriptorInfo MakePipelineDescriptorInfo(const Pipeline::ShaderStage &stage) {
@@ -67,6 +68,7 @@ namespace skyline::gpu::interconnect::kepler_compute {
     static Pipeline::CompiledPipeline MakeCompiledPipeline(InterconnectContext &ctx,
                                                                                const PackedPipelineState &packedState,
                                                                                const Pipeline::ShaderStage &shaderStage,
+                                                                               u64 shaderHash,
                                                                                span<vk::DescriptorSetLayoutBinding> layoutBindings) {
         vk::raii::DescriptorSetLayout descriptorSetLayout{ctx.gpu.vkDevice, vk::DescriptorSetLayoutCreateInfo{
             .flags = vk::DescriptorSetLayoutCreateFlags{ctx.gpu.traits.supportsPushDescriptors ? vk::DescriptorSetLayoutCreateFlagBits::ePushDescriptorKHR : vk::DescriptorSetLayoutCreateFlags{}},
@@ -90,7 +92,10 @@ namespace skyline::gpu::interconnect::kepler_compute {
             .layout = *pipelineLayout,
         };
 
+        i64 pipelineStartTime{util::GetTimeNs()};
         vk::raii::Pipeline pipeline{ctx.gpu.vkDevice, nullptr, pipelineInfo};
+        ctx.gpu.shaderCompileStatistics.RecordPipeline({&shaderHash, 1}, static_cast<u64>(util::GetTimeNs() - pipelineStartTime));
+        GetPerformanceStatistics().pipelineCompileCount.fetch_add(1, std::memory_order_relaxed);
 
         return Pipeline::CompiledPipeline{
             .pipeline = std::move(pipeline),
@@ -102,9 +107,31 @@ namespace skyline::gpu::interconnect::kepler_compute {
     Pipeline::Pipeline(InterconnectContext &ctx, Textures &textures, ConstantBufferSet &constantBuffers, const PackedPipelineState &packedState, const ShaderBinary &shaderBinary)
         : shaderStage{MakePipelineShader(ctx, textures, constantBuffers, packedState, shaderBinary)},
           descriptorInfo{MakePipelineDescriptorInfo(shaderStage)},
-          compiledPipeline{MakeCompiledPipeline(ctx, packedState, shaderStage, descriptorInfo.descriptorSetLayoutBindings)},
+          compiledPipeline{MakeCompiledPipeline(ctx, packedState, shaderStage, shaderBinary.hash, descriptorInfo.descriptorSetLayoutBindings)},
           sourcePackedState{packedState} {
         storageBufferViews.resize(shaderStage.info.storage_buffers_descriptors.size());
+        writesMemory = std::any_of(shaderStage.info.storage_buffers_descriptors.begin(), shaderStage.info.storage_buffers_descriptors.end(), [](const auto &desc) { return desc.is_written; }) ||
+                       std::any_of(shaderStage.info.image_descriptors.begin(), shaderStage.info.image_descriptors.end(), [](const auto &desc) { return desc.is_written; });
+    }
+
+    Pipeline *PipelineManager::FindOrCreate(InterconnectContext &ctx, Textures &textures, ConstantBufferSet &constantBuffers, const PackedPipelineState &packedState, const ShaderBinary &shaderBinary) {
+        auto it{map.find(packedState)};
+        ctx.gpu.pipelineStatistics.RecordLookup(cache::PipelineStatistics::LookupSource::KeplerCompute, it != map.end());
+        if (it != map.end())
+            return it->second.get();
+
+        // Compute pipelines are always compiled synchronously so the entire construction is timed
+        i64 compileStartTime{util::GetTimeNs()};
+        auto pipeline{map.emplace(packedState, std::make_unique<Pipeline>(ctx, textures, constantBuffers, packedState, shaderBinary)).first->second.get()};
+        ctx.gpu.pipelineStatistics.RecordPipeline({
+            .type = cache::PipelineStatistics::PipelineType::Compute,
+            .stateHash = util::ObjectHash<PackedPipelineState>{}(packedState),
+            .shaderCount = 1,
+            .guestShaderSize = static_cast<u32>(shaderBinary.binary.size()),
+            .firstRequestedFrame = ctx.gpu.presentation.GetFrameId(),
+            .compileTimeNs = static_cast<u64>(util::GetTimeNs() - compileStartTime),
+        });
+        return pipeline;
     }
 
     void Pipeline::SyncCachedStorageBufferViews(u32 executionNumber) {
@@ -50,6 +50,7 @@ namespace skyline::gpu::interconnect::kepler_compute {
         CompiledPipeline compiledPipeline;
 
         PackedPipelineState sourcePackedState;
+        bool writesMemory{}; //!< If the shader writes to any storage buffers or images, consecutive dispatches of it need a barrier between them as they may depend on each other's output
 
         Pipeline(InterconnectContext &ctx, Textures &textures, ConstantBufferSet &constantBuffers, const PackedPipelineState &packedState, const ShaderBinary &shaderBinary);
 
@@ -64,12 +65,6 @@ namespace skyline::gpu::interconnect::kepler_compute {
         tsl::robin_map<PackedPipelineState, std::unique_ptr<Pipeline>, util::ObjectHash<PackedPipelineState>> map;
 
       public:
-        Pipeline *FindOrCreate(InterconnectContext &ctx, Textures &textures, ConstantBufferSet &constantBuffers, const PackedPipelineState &packedState, const ShaderBinary &shaderBinary) {
-            auto it{map.find(packedState)};
-            if (it != map.end())
-                return it->second.get();
-
-            return map.emplace(packedState, std::make_unique<Pipeline>(ctx, textures, constantBuffers, packedState, shaderBinary)).first->second.get();
-        }
+        Pipeline *FindOrCreate(InterconnectContext &ctx, Textures &textures, ConstantBufferSet &constantBuffers, const PackedPipelineState &packedState, const ShaderBinary &shaderBinary);
     };
 }
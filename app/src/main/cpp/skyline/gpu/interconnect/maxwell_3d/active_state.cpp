@@ -9,6 +9,7 @@
 #include <gpu/buffer_manager.h>
 #include <gpu/interconnect/command_executor.h>
 #include <gpu/interconnect/conversion/quads.h>
+#include <gpu/interconnect/conversion/indices.h>
 #include <gpu/interconnect/common/state_updater.h>
 #include "common.h"
 #include "active_state.h"
@@ -95,19 +96,101 @@ namespace skyline::gpu::interconnect::maxwell3d {
         }
     }
 
-    static BufferBinding GenerateQuadConversionIndexBuffer(InterconnectContext &ctx, engine::IndexBuffer::IndexSize indexType, BufferView &view, u32 firstIndex, u32 elementCount) {
-        auto viewSpan{view.GetReadOnlyBackingSpan(false /* We attach above so always false */, []() {
-            // TODO: see Read()
-            Logger::Error("Dirty index buffer reads for attached buffers are unimplemented");
-        })};
+    constexpr static u32 GpuQuadConversionThreshold{0x3000}; //!< The minimum amount of indices in a quad draw for them to be converted on the GPU, smaller draws are converted on the CPU as the conversion needs to be recorded outside of the render pass
 
-        size_t indexSize{1U << static_cast<u32>(indexType)};
-        vk::DeviceSize indexBufferSize{conversion::quads::GetRequiredBufferSize(elementCount, indexSize)};
-        auto quadConversionAllocation{ctx.gpu.megaBufferAllocator.Allocate(ctx.executor.cycle, indexBufferSize)};
+    /* Index Buffer Conversion Cache */
+    BufferBinding IndexConversionCache::Convert(InterconnectContext &ctx, BufferView &view, engine::IndexBuffer::IndexSize indexSize, u32 firstIndex, u32 elementCount, bool quadConversion, vk::IndexType &convertedIndexType) {
+        if (!quadConversion) {
+            // Widened indices are used with the original first index of the draw so all indices prior to it need to be converted as well
+            elementCount += firstIndex;
+            firstIndex = 0;
+        }
+
+        auto buffer{view.GetBuffer()};
+        u32 indexBytes{1U << static_cast<u32>(indexSize)};
+        bool gpuDirty{buffer->IsGpuDirty()};
 
-        conversion::quads::GenerateIndexedQuadConversionBuffer(quadConversionAllocation.region.data(), viewSpan.subspan(GetIndexBufferSize(indexType, firstIndex)).data(), elementCount, ConvertIndexType(indexType));
+        // Dirty buffers can't be read on the CPU without waiting on the GPU and hosts without 8-bit index support require them to be widened, both of which are handled by the GPU conversion
+        bool useGpu{quadConversion && (gpuDirty || elementCount >= GpuQuadConversionThreshold || (indexSize == engine::IndexBuffer::IndexSize::OneByte && !ctx.gpu.traits.supportsUint8Indices))};
 
-        return {quadConversionAllocation.buffer, quadConversionAllocation.offset, indexBufferSize};
+        vk::DeviceSize convertedSize;
+        if (useGpu) {
+            convertedIndexType = QuadConversionHelperShader::GetOutputIndexType(indexBytes);
+            convertedSize = QuadConversionHelperShader::GetOutputSize(indexBytes, elementCount);
+        } else if (quadConversion) {
+            convertedIndexType = ConvertIndexType(indexSize);
+            convertedSize = conversion::quads::GetRequiredBufferSize(elementCount, indexBytes);
+        } else {
+            convertedIndexType = vk::IndexType::eUint16;
+            convertedSize = elementCount * sizeof(u16);
+        }
+
+        vk::DeviceSize sourceOffset{GetIndexBufferSize(indexSize, firstIndex)};
+        auto convert{[&](vk::Buffer destination, vk::DeviceSize destinationOffset, span<u8> destinationRegion) {
+            if (useGpu) {
+                auto job{ctx.gpu.helperShaders.quadConversionHelperShader.Prepare(ctx.gpu)};
+                ctx.executor.cycle->AttachObject(job);
+                ctx.executor.AddOutsideRpCommand([job = job.get(), view, sourceOffset, indexBytes, elementCount, destination, destinationOffset](vk::raii::CommandBuffer &commandBuffer, const IntrusivePtr<FenceCycle> &, GPU &gpu) {
+                    gpu.helperShaders.quadConversionHelperShader.Record(gpu, commandBuffer, *job, view.GetBuffer()->GetBacking(), view.GetOffset() + sourceOffset, indexBytes, elementCount, destination, destinationOffset);
+                });
+                return;
+            }
+
+            auto viewSpan{view.GetReadOnlyBackingSpan(false /* We attach above so always false */, []() {
+                // TODO: see Read()
+                Logger::Error("Dirty index buffer reads for attached buffers are unimplemented");
+            }).subspan(sourceOffset)};
+
+            if (quadConversion)
+                conversion::quads::GenerateIndexedQuadConversionBuffer(destinationRegion.data(), viewSpan.data(), elementCount, convertedIndexType);
+            else
+                conversion::indices::WidenUint8Indices(destinationRegion.cast<u16>().data(), viewSpan.data(), elementCount);
+        }};
+
+        auto convertIntoMegaBuffer{[&]() -> BufferBinding {
+            auto allocation{ctx.gpu.megaBufferAllocator.Allocate(ctx.executor.cycle, convertedSize + QuadConversionHelperShader::OutputAlignment - 1)};
+            vk::DeviceSize offset{util::AlignUp(allocation.offset, QuadConversionHelperShader::OutputAlignment)};
+            convert(allocation.buffer, offset, allocation.region.subspan(offset - allocation.offset, convertedSize));
+            return {allocation.buffer, offset, convertedSize};
+        }};
+
+        // The GPU can modify dirty buffers without advancing their sequence number so their contents can't be identified
+        if (gpuDirty || !convertedSize)
+            return convertIntoMegaBuffer();
+
+        Key key{buffer->GetId(), view.GetOffset() + sourceOffset, elementCount, indexSize, quadConversion};
+        u32 sequenceNumber{buffer->GetSequenceNumber()};
+
+        auto entry{std::find_if(entries.begin(), entries.end(), [&](const Entry &candidate) { return candidate.key == key; })};
+        if (entry == entries.end()) {
+            if (entries.size() < MaxEntryCount)
+                entry = entries.insert(entries.end(), Entry{.key = key});
+            else
+                *(entry = std::min_element(entries.begin(), entries.end(), [](const Entry &a, const Entry &b) { return a.lastUse < b.lastUse; })) = Entry{.key = key};
+        } else if (entry->sequenceNumber != sequenceNumber && ++entry->staleCount >= StreamingStaleThreshold) {
+            // Sources that are rewritten every few draws would require a new buffer for every conversion, the megabuffer is far cheaper for these
+            entry->lastUse = ++useCounter;
+            return convertIntoMegaBuffer();
+        }
+
+        entry->lastUse = ++useCounter;
+        if (!entry->buffer || entry->sequenceNumber != sequenceNumber) {
+            // A new buffer is used for every conversion as the prior one may still be in use by the GPU
+            entry->buffer = std::make_shared<memory::Buffer>(ctx.gpu.memory.AllocateBuffer(convertedSize));
+            entry->sequenceNumber = sequenceNumber;
+            entry->size = convertedSize;
+            entry->indexType = convertedIndexType;
+            convert(entry->buffer->vkBuffer, 0, *entry->buffer);
+
+            ctx.executor.AttachDependency(entry->buffer);
+            entry->executionNumber = ctx.executor.executionNumber;
+        } else if (entry->executionNumber != ctx.executor.executionNumber) {
+            ctx.executor.AttachDependency(entry->buffer);
+            entry->executionNumber = ctx.executor.executionNumber;
+        }
+
+        convertedIndexType = entry->indexType;
+        return {entry->buffer->vkBuffer, 0, entry->size};
     }
 
     /* Index Buffer */
@@ -133,8 +216,9 @@ namespace skyline::gpu::interconnect::maxwell3d {
 
         indexType = ConvertIndexType(engine->indexBuffer.indexSize);
 
-        if (quadConversion)
-            megaBufferBinding = GenerateQuadConversionIndexBuffer(ctx, engine->indexBuffer.indexSize, *view, firstIndex, elementCount);
+        usedConversion = quadConversion || (engine->indexBuffer.indexSize == engine::IndexBuffer::IndexSize::OneByte && !ctx.gpu.traits.supportsUint8Indices);
+        if (usedConversion)
+            megaBufferBinding = conversionCache.Convert(ctx, *view, engine->indexBuffer.indexSize, firstIndex, elementCount, quadConversion, indexType);
         else
             megaBufferBinding = view->TryMegaBuffer(ctx.executor.cycle, ctx.gpu.megaBufferAllocator, ctx.executor.executionNumber);
 
@@ -154,10 +238,16 @@ namespace skyline::gpu::interconnect::maxwell3d {
         if (quadConversion != usedQuadConversion)
             return true;
 
-        // TODO: optimise this to use buffer sequencing to avoid needing to regenerate the quad buffer every time. We can't use as it is rn though because sequences aren't globally unique and may conflict after buffer recreation
-        if (usedQuadConversion) {
-            megaBufferBinding = GenerateQuadConversionIndexBuffer(ctx, engine->indexBuffer.indexSize, *view, firstIndex, elementCount);
-            builder.SetIndexBuffer(megaBufferBinding, indexType);
+        // The conversion cache reuses the prior conversion if the indices haven't been modified since, in which case the binding remains the same
+        if (usedConversion) {
+            vk::IndexType newIndexType{};
+            if (auto newMegaBufferBinding{conversionCache.Convert(ctx, *view, engine->indexBuffer.indexSize, firstIndex, elementCount, quadConversion, newIndexType)};
+                newMegaBufferBinding != megaBufferBinding || newIndexType != indexType) {
+
+                megaBufferBinding = newMegaBufferBinding;
+                indexType = newIndexType;
+                builder.SetIndexBuffer(megaBufferBinding, indexType);
+            }
         } else if (megaBufferBinding) {
             if (auto newMegaBufferBinding{view->TryMegaBuffer(ctx.executor.cycle, ctx.gpu.megaBufferAllocator, ctx.executor.executionNumber)};
                 newMegaBufferBinding != megaBufferBinding) {
@@ -224,7 +314,7 @@ namespace skyline::gpu::interconnect::maxwell3d {
 
     ViewportState::ViewportState(dirty::Handle dirtyHandle, DirtyManager &manager, const EngineRegisters &engine, u32 index) : engine{manager, dirtyHandle, engine}, index{index} {}
 
-    static vk::Viewport ConvertViewport(const engine::Viewport &viewport, const engine::ViewportClip &viewportClip, const engine::WindowOrigin &windowOrigin, bool viewportScaleOffsetEnable) {
+    static vk::Viewport ConvertViewport(const engine::Viewport &viewport, const engine::ViewportClip &viewportClip, const engine::WindowOrigin &windowOrigin, bool viewportScaleOffsetEnable, float renderTargetScale) {
         vk::Viewport vkViewport{};
 
         vkViewport.x = viewport.offsetX - viewport.scaleX; // Counteract the addition of the half of the width (o_x) to the host translation
@@ -250,28 +340,33 @@ namespace skyline::gpu::interconnect::maxwell3d {
         }
 
         // Clamp since we don't yet use VK_EXT_unrestricted_depth_range
+        vkViewport.x *= renderTargetScale;
+        vkViewport.y *= renderTargetScale;
+        vkViewport.width *= renderTargetScale;
+        vkViewport.height *= renderTargetScale;
+
         vkViewport.minDepth = std::clamp(viewportClip.minZ, 0.0f, 1.0f);
         vkViewport.maxDepth = std::clamp(viewportClip.maxZ, 0.0f, 1.0f);
         return vkViewport;
     }
 
-    void ViewportState::Flush(InterconnectContext &ctx, StateUpdateBuilder &builder) {
+    void ViewportState::Flush(InterconnectContext &ctx, StateUpdateBuilder &builder, float renderTargetScale) {
         if (index != 0 && !ctx.gpu.traits.supportsMultipleViewports)
             return;
 
         if (!engine->viewportScaleOffsetEnable) {
             builder.SetViewport(index, vk::Viewport{
-                .x = static_cast<float>(engine->surfaceClip.horizontal.x),
-                .y = static_cast<float>(engine->surfaceClip.vertical.y),
-                .width = engine->surfaceClip.horizontal.width ? static_cast<float>(engine->surfaceClip.horizontal.width) : 1.0f,
-                .height = engine->surfaceClip.vertical.height ? static_cast<float>(engine->surfaceClip.vertical.height) : 1.0f,
+                .x = static_cast<float>(engine->surfaceClip.horizontal.x) * renderTargetScale,
+                .y = static_cast<float>(engine->surfaceClip.vertical.y) * renderTargetScale,
+                .width = (engine->surfaceClip.horizontal.width ? static_cast<float>(engine->surfaceClip.horizontal.width) : 1.0f) * renderTargetScale,
+                .height = (engine->surfaceClip.vertical.height ? static_cast<float>(engine->surfaceClip.vertical.height) : 1.0f) * renderTargetScale,
                 .minDepth = 0.0f,
                 .maxDepth = 1.0f,
             });
         } else if (engine->viewport.scaleX == 0.0f || engine->viewport.scaleY == 0.0f) {
-            builder.SetViewport(index, ConvertViewport(engine->viewport0, engine->viewportClip0, engine->windowOrigin, engine->viewportScaleOffsetEnable));
+            builder.SetViewport(index, ConvertViewport(engine->viewport0, engine->viewportClip0, engine->windowOrigin, engine->viewportScaleOffsetEnable, renderTargetScale));
         } else {
-            builder.SetViewport(index, ConvertViewport(engine->viewport, engine->viewportClip, engine->windowOrigin, engine->viewportScaleOffsetEnable));
+            builder.SetViewport(index, ConvertViewport(engine->viewport, engine->viewportClip, engine->windowOrigin, engine->viewportScaleOffsetEnable, renderTargetScale));
         }
     }
 
@@ -282,7 +377,7 @@ namespace skyline::gpu::interconnect::maxwell3d {
 
     ScissorState::ScissorState(dirty::Handle dirtyHandle, DirtyManager &manager, const EngineRegisters &engine, u32 index) : engine{manager, dirtyHandle, engine}, index{index} {}
 
-    void ScissorState::Flush(InterconnectContext &ctx, StateUpdateBuilder &builder) {
+    void ScissorState::Flush(InterconnectContext &ctx, StateUpdateBuilder &builder, float renderTargetScale) {
         if (index != 0 && !ctx.gpu.traits.supportsMultipleViewports)
             return;
 
@@ -291,7 +386,7 @@ namespace skyline::gpu::interconnect::maxwell3d {
                 const auto &vertical{engine->scissor.vertical};
                 const auto &horizontal{engine->scissor.horizontal};
 
-                return vk::Rect2D{
+                return ScaleRect(vk::Rect2D{
                     .offset = {
                         .y = vertical.yMin,
                         .x = horizontal.xMin
@@ -300,7 +395,7 @@ namespace skyline::gpu::interconnect::maxwell3d {
                         .height = static_cast<uint32_t>(vertical.yMax - vertical.yMin),
                         .width = static_cast<uint32_t>(horizontal.xMax - horizontal.xMin)
                     }
-                };
+                }, renderTargetScale);
             } else {
                 return vk::Rect2D{
                     .extent.height = std::numeric_limits<i32>::max(),
@@ -411,12 +506,21 @@ namespace skyline::gpu::interconnect::maxwell3d {
 
         auto updateFunc{[&](auto &stateElem, auto &&... args) { stateElem.Update(ctx, builder, args...); }};
         pipeline.Update(ctx, textures, constantBuffers, builder);
+
+        // Viewports and scissors are specified in guest coordinates so they need to be flushed again whenever the scale of the bound render targets changes
+        if (float scale{GetRenderTargetScale()}; scale != renderTargetScale) {
+            renderTargetScale = scale;
+            auto dirtyFunc{[](auto &stateElem) { stateElem.MarkDirty(false); }};
+            ranges::for_each(viewports, dirtyFunc);
+            ranges::for_each(scissors, dirtyFunc);
+        }
+
         ranges::for_each(vertexBuffers, updateFunc);
         if (indexed)
             updateFunc(indexBuffer, directState.inputAssembly.NeedsQuadConversion(), drawFirstIndex, drawElementCount);
         ranges::for_each(transformFeedbackBuffers, updateFunc);
-        ranges::for_each(viewports, updateFunc);
-        ranges::for_each(scissors, updateFunc);
+        ranges::for_each(viewports, [&](auto &viewport) { updateFunc(viewport, renderTargetScale); });
+        ranges::for_each(scissors, [&](auto &scissor) { updateFunc(scissor, renderTargetScale); });
         updateFunc(lineWidth);
         updateFunc(depthBias);
         updateFunc(blendConstants);
@@ -436,6 +540,18 @@ namespace skyline::gpu::interconnect::maxwell3d {
         return pipeline.Get().depthAttachment;
     }
 
+    float ActiveState::GetRenderTargetScale() {
+        std::optional<float> scale;
+        auto applyAttachment{[&](TextureView *attachment) {
+            if (attachment)
+                scale = std::min(scale.value_or(attachment->texture->resolutionScale), attachment->texture->resolutionScale);
+        }};
+
+        ranges::for_each(GetColorAttachments(), applyAttachment);
+        applyAttachment(GetDepthAttachment());
+        return scale.value_or(1.0f);
+    }
+
     std::shared_ptr<TextureView> ActiveState::GetColorRenderTargetForClear(InterconnectContext &ctx, size_t index) {
         return pipeline.Get().GetColorRenderTargetForClear(ctx, index);
     }
@@ -34,6 +34,50 @@ namespace skyline::gpu::interconnect::maxwell3d {
         void PurgeCaches();
     };
 
+    /**
+     * @brief A cache of converted index buffers keyed by the contents of their source, allowing converted indices to be reused across draws and executions until the source is modified
+     * @note Conversions of GPU dirty sources or of sources that are frequently modified are done into the megabuffer rather than being cached
+     */
+    class IndexConversionCache {
+      private:
+        /**
+         * @brief The location and format of a range of source indices, their contents are identified by the sequence number of the source buffer
+         */
+        struct Key {
+            size_t bufferId;
+            vk::DeviceSize offset; //!< The offset of the first source index in the buffer
+            u32 elementCount;
+            engine::IndexBuffer::IndexSize indexSize;
+            bool quadConversion;
+
+            bool operator==(const Key &) const = default;
+        };
+
+        struct Entry {
+            Key key;
+            u32 sequenceNumber; //!< The sequence number of the source buffer when the indices were converted
+            std::shared_ptr<memory::Buffer> buffer; //!< A dedicated buffer holding the converted indices, this is never modified after the conversion
+            vk::DeviceSize size; //!< The size of the converted indices in the buffer
+            vk::IndexType indexType; //!< The type of the converted indices
+            u32 executionNumber{}; //!< The executor execution that the buffer was last attached to
+            u32 staleCount{}; //!< The amount of times the source has been found to be modified since the entry was created
+            u64 lastUse; //!< The value of `useCounter` when the entry was last used, for LRU eviction
+        };
+
+        static constexpr size_t MaxEntryCount{32};
+        static constexpr u32 StreamingStaleThreshold{4}; //!< The amount of times an entry's source can be modified before it's treated as streamed and converted into the megabuffer instead
+        std::vector<Entry> entries;
+        u64 useCounter{};
+
+      public:
+        /**
+         * @brief Converts the supplied indices for use as a host index buffer either by quad conversion or widening 8-bit indices, reusing a prior conversion if the source hasn't been modified since
+         * @param convertedIndexType The type of the converted indices
+         * @note The view **must** be attached to the executor prior to calling this
+         */
+        BufferBinding Convert(InterconnectContext &ctx, BufferView &view, engine::IndexBuffer::IndexSize indexSize, u32 firstIndex, u32 elementCount, bool quadConversion, vk::IndexType &convertedIndexType);
+    };
+
     class IndexBufferState : dirty::RefreshableManualDirty, dirty::CachedManualDirty {
       public:
         struct EngineRegisters {
@@ -50,6 +94,8 @@ namespace skyline::gpu::interconnect::maxwell3d {
         u32 usedElementCount{};
         u32 usedFirstIndex{};
         bool usedQuadConversion{};
+        bool usedConversion{}; //!< If the bound indices were converted by `conversionCache` rather than being used directly
+        IndexConversionCache conversionCache;
 
       public:
         IndexBufferState(dirty::Handle dirtyHandle, DirtyManager &manager, const EngineRegisters &engine);
@@ -104,7 +150,10 @@ namespace skyline::gpu::interconnect::maxwell3d {
       public:
         ViewportState(dirty::Handle dirtyHandle, DirtyManager &manager, const EngineRegisters &engine, u32 index);
 
-        void Flush(InterconnectContext &ctx, StateUpdateBuilder &builder);
+        /**
+         * @param renderTargetScale The resolution scale of the bound render targets, the viewport is scaled by this
+         */
+        void Flush(InterconnectContext &ctx, StateUpdateBuilder &builder, float renderTargetScale);
     };
 
     class ScissorState : dirty::ManualDirty {
@@ -122,7 +171,10 @@ namespace skyline::gpu::interconnect::maxwell3d {
       public:
         ScissorState(dirty::Handle dirtyHandle, DirtyManager &manager, const EngineRegisters &engine, u32 index);
 
-        void Flush(InterconnectContext &ctx, StateUpdateBuilder &builder);
+        /**
+         * @param renderTargetScale The resolution scale of the bound render targets, the scissor is scaled by this
+         */
+        void Flush(InterconnectContext &ctx, StateUpdateBuilder &builder, float renderTargetScale);
     };
 
     struct LineWidthState : dirty::ManualDirty {
@@ -233,6 +285,7 @@ namespace skyline::gpu::interconnect::maxwell3d {
         dirty::ManualDirtyState<BlendConstantsState> blendConstants;
         dirty::ManualDirtyState<DepthBoundsState> depthBounds;
         dirty::ManualDirtyState<StencilValuesState> stencilValues;
+        float renderTargetScale{1.0f}; //!< The resolution scale that viewports and scissors were last flushed with
 
       public:
         struct EngineRegisters {
@@ -266,6 +319,11 @@ namespace skyline::gpu::interconnect::maxwell3d {
 
         TextureView *GetDepthAttachment();
 
+        /**
+         * @return The resolution scale of the bound render targets, if they differ then the smallest scale is used so that rendering never exceeds the bounds of any attachment
+         */
+        float GetRenderTargetScale();
+
         std::shared_ptr<TextureView> GetColorRenderTargetForClear(InterconnectContext &ctx, size_t index);
 
         std::shared_ptr<TextureView> GetDepthRenderTargetForClear(InterconnectContext &ctx);
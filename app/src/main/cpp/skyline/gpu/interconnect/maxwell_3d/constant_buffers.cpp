@@ -33,13 +33,22 @@ namespace skyline::gpu::interconnect::maxwell3d {
         view.PurgeCaches();
     }
 
-    ConstantBuffers::ConstantBuffers(DirtyManager &manager, const ConstantBufferSelectorState::EngineRegisters &constantBufferSelectorRegisters) : selectorState{manager, constantBufferSelectorRegisters} {}
+    ConstantBuffers::ConstantBuffers(DirtyManager &manager, const ConstantBufferSelectorState::EngineRegisters &constantBufferSelectorRegisters) : selectorState{manager, constantBufferSelectorRegisters}, selector{constantBufferSelectorRegisters.constantBufferSelector} {}
 
     void ConstantBuffers::MarkAllDirty() {
         selectorState.MarkDirty(true);
     }
 
     void ConstantBuffers::Load(InterconnectContext &ctx, span<u32> data, u32 offset) {
+        if (quickBindEnabled) {
+            // Any bindings of the written range need their descriptors updated as they may have been copied into the megabuffer or contain bindless handles
+            u64 loadStart{selector.address + offset}, loadEnd{loadStart + data.size_bytes()};
+            for (size_t stage{}; stage < engine::ShaderStageCount; stage++)
+                for (size_t index{}; index < engine::ShaderStageConstantBufferCount; index++)
+                    if (const auto &range{boundRanges[stage][index]}; range.size && range.address < loadEnd && loadStart < range.address + range.size)
+                        quickBind.Mark(static_cast<engine::ShaderStage>(stage), index);
+        }
+
         auto &view{*selectorState.UpdateGet(ctx, data.size_bytes()).view};
         auto srcCpuBuf{data.cast<u8>()};
 
@@ -62,18 +71,14 @@ namespace skyline::gpu::interconnect::maxwell3d {
                 callbackData.view.GetBuffer()->BlockAllCpuBackingWrites();
 
                 auto srcGpuAllocation{callbackData.ctx.gpu.megaBufferAllocator.Push(callbackData.ctx.executor.cycle, callbackData.srcCpuBuf)};
-                callbackData.ctx.executor.AddOutsideRpCommand([=, srcCpuBuf = callbackData.srcCpuBuf, view = callbackData.view, offset = callbackData.offset](vk::raii::CommandBuffer &commandBuffer, const std::shared_ptr<FenceCycle> &, GPU &) {
+                callbackData.ctx.executor.AddTransferCommand([=, srcCpuBuf = callbackData.srcCpuBuf, view = callbackData.view, offset = callbackData.offset](vk::raii::CommandBuffer &commandBuffer, const IntrusivePtr<FenceCycle> &, GPU &) {
                     vk::BufferCopy copyRegion{
                         .size = srcCpuBuf.size_bytes(),
                         .srcOffset = srcGpuAllocation.offset,
                         .dstOffset = view.GetOffset() + offset
                     };
                     commandBuffer.copyBuffer(srcGpuAllocation.buffer, view.GetBuffer()->GetBacking(), copyRegion);
-                    commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eAllCommands, {}, vk::MemoryBarrier{
-                        .srcAccessMask = vk::AccessFlagBits::eTransferWrite,
-                        .dstAccessMask = vk::AccessFlagBits::eMemoryRead | vk::AccessFlagBits::eMemoryWrite
-                    }, {}, {});
-                });
+                }, {ResourceAccess::Of(callbackData.view, true, callbackData.offset, callbackData.srcCpuBuf.size_bytes())});
             });
         }
     }
@@ -84,24 +89,24 @@ namespace skyline::gpu::interconnect::maxwell3d {
             throw exception("Constant buffer selector is not mapped");
 
         boundConstantBuffers[static_cast<size_t>(stage)][index] = {view};
+        boundRanges[static_cast<size_t>(stage)][index] = {selector.address, static_cast<u32>(view.size)};
 
-        if (quickBindEnabled && quickBind)
-            DisableQuickBind(); // We can only quick bind one buffer per draw
-        else if (quickBindEnabled)
-            quickBind = QuickBind{index, stage};
+        if (quickBindEnabled)
+            quickBind.Mark(stage, index);
     }
 
     void ConstantBuffers::Unbind(engine::ShaderStage stage, size_t index) {
         boundConstantBuffers[static_cast<size_t>(stage)][index] = {};
+        boundRanges[static_cast<size_t>(stage)][index] = {};
     }
 
     void ConstantBuffers::ResetQuickBind() {
         quickBindEnabled = true;
-        quickBind.reset();
+        quickBind = {};
     }
 
     void ConstantBuffers::DisableQuickBind() {
         quickBindEnabled = false;
-        quickBind.reset();
+        quickBind = {};
     }
 }
\ No newline at end of file
@@ -37,24 +37,47 @@ namespace skyline::gpu::interconnect::maxwell3d {
     class ConstantBuffers {
       private:
         dirty::ManualDirtyState <ConstantBufferSelectorState> selectorState;
+        const engine::ConstantBufferSelector &selector;
+
+        /**
+         * @brief The guest GPU address range of a bound constant buffer, this is used to determine which bindings are affected by a load
+         */
+        struct BoundRange {
+            u64 address;
+            u32 size; //!< The size of the range in bytes, this is zero for unbound constant buffers
+        };
+        std::array<std::array<BoundRange, engine::ShaderStageConstantBufferCount>, engine::ShaderStageCount> boundRanges{};
 
       public:
         ConstantBufferSet boundConstantBuffers;
 
         /**
-         * @brief Allows for a single constant buffer to be bound between two draws without requiring a full descriptor sync
+         * @brief Tracks all constant buffers that were rebound or loaded into between two draws, allowing for only their descriptors to be updated rather than requiring a full descriptor sync
          */
         struct QuickBind {
-            size_t index; //!< The index of the constant buffer to bind
-            engine::ShaderStage stage; //!< The shader stage to bind the constant buffer to
+            std::array<u32, engine::ShaderStageCount> stageMasks{}; //!< A bitmask of the constant buffer indices that need their descriptors updated for each shader stage
+
+            void Mark(engine::ShaderStage stage, size_t index) {
+                stageMasks[static_cast<size_t>(stage)] |= 1U << index;
+            }
+
+            bool Empty() const {
+                return std::all_of(stageMasks.begin(), stageMasks.end(), [](u32 mask) { return mask == 0; });
+            }
         };
-        std::optional<QuickBind> quickBind;
-        bool quickBindEnabled{}; //!< If quick binding can occur, if multiple bindings, constant buffer loads or other engines have been used since the last draw this is disabled
+        static_assert(engine::ShaderStageConstantBufferCount <= sizeof(u32) * 8);
+
+        QuickBind quickBind;
+        bool quickBindEnabled{}; //!< If quick binding can occur, if other engines have been used or state that affects descriptors other than constant buffers has changed since the last draw this is disabled
 
         ConstantBuffers(DirtyManager &manager, const ConstantBufferSelectorState::EngineRegisters &constantBufferSelectorRegisters);
 
         void MarkAllDirty();
 
+        /**
+         * @brief Loads data into the buffer pointed to by the selector, any bound constant buffers overlapping the written range are marked for quick binding
+         * @note Aliases of the same memory at different guest GPU addresses aren't detected, these would only be an issue for titles that load into a constant buffer through one mapping while it's bound through another
+         */
         void Load(InterconnectContext &ctx, span <u32> data, u32 offset);
 
         void Bind(InterconnectContext &ctx, engine::ShaderStage stage, size_t index);
@@ -62,12 +85,12 @@ namespace skyline::gpu::interconnect::maxwell3d {
         void Unbind(engine::ShaderStage stage, size_t index);
 
         /**
-         * @brief Resets quick binding state to be ready store a new bind, this should be called after every draw
+         * @brief Resets quick binding state to be ready to accumulate new binds, this should be called after every draw
          */
         void ResetQuickBind();
 
         /**
-         * @brief Diables quick binding, this should be called before any operation that could impact contents of bound constant buffers
+         * @brief Disables quick binding, this should be called before any operation that could impact descriptors in a way which isn't tracked by quick binding
          */
         void DisableQuickBind();
     };
@@ -24,6 +24,8 @@ namespace skyline::gpu::interconnect::maxwell3d {
           samplers{manager, registerBundle.samplerPoolRegisters},
           samplerBinding{registerBundle.samplerBinding},
           textures{manager, registerBundle.texturePoolRegisters},
+          queries{gpu},
+          renderEnable{registerBundle.renderEnable},
           directState{activeState.directState} {
         ctx.executor.AddFlushCallback([this] {
             if (attachedDescriptorSets) {
@@ -32,27 +34,37 @@ namespace skyline::gpu::interconnect::maxwell3d {
                 activeDescriptorSet = nullptr;
             }
 
+            // Both the sets and the updates are only valid for the execution they were created in
+            descriptorSetCache.fill({});
+
             activeState.MarkAllDirty();
+            recordedState.Reset();
             constantBuffers.MarkAllDirty();
             samplers.MarkAllDirty();
             textures.MarkAllDirty();
             quadConversionBufferAttached = false;
+            transformFeedbackCounterBufferAttached = false;
+            transformFeedbackCountersPending = false; // Executions are fully synchronized with prior ones
             constantBuffers.DisableQuickBind();
         });
 
         ctx.executor.AddPipelineChangeCallback([this] {
             activeState.MarkAllDirty();
+            recordedState.Reset();
             activeDescriptorSet = nullptr;
         });
     }
 
-    vk::DeviceSize Maxwell3D::UpdateQuadConversionBuffer(u32 count, u32 firstVertex) {
-        vk::DeviceSize offset{conversion::quads::GetRequiredBufferSize(firstVertex, sizeof(u32))};
-        vk::DeviceSize size{conversion::quads::GetRequiredBufferSize(count, sizeof(u32)) + offset};
+    void Maxwell3D::UpdateQuadConversionBuffer(u32 vertexCount) {
+        vk::DeviceSize size{conversion::quads::GetRequiredBufferSize(vertexCount, sizeof(u32))};
 
         if (!quadConversionBuffer || quadConversionBuffer->size_bytes() < size) {
-            quadConversionBuffer = std::make_shared<memory::Buffer>(ctx.gpu.memory.AllocateBuffer(util::AlignUp(size, PAGE_SIZE)));
-            conversion::quads::GenerateQuadListConversionBuffer(quadConversionBuffer->cast<u32>().data(), firstVertex + count);
+            // The buffer is grown geometrically and filled for its entire capacity so that it rarely needs to be regenerated
+            vk::DeviceSize capacity{util::AlignUp(std::max(size, quadConversionBuffer ? quadConversionBuffer->size_bytes() * 2 : 0), PAGE_SIZE)};
+            quadConversionBuffer = std::make_shared<memory::Buffer>(ctx.gpu.memory.AllocateBuffer(capacity));
+
+            u32 capacityQuadCount{static_cast<u32>(capacity / conversion::quads::GetRequiredBufferSize(conversion::quads::QuadVertexCount, sizeof(u32)))};
+            conversion::quads::GenerateQuadListConversionBuffer(quadConversionBuffer->cast<u32>().data(), capacityQuadCount * conversion::quads::QuadVertexCount);
             quadConversionBufferAttached = false;
         }
 
@@ -60,8 +72,30 @@ namespace skyline::gpu::interconnect::maxwell3d {
             ctx.executor.AttachDependency(quadConversionBuffer);
             quadConversionBufferAttached = true;
         }
+    }
+
+    vk::Buffer Maxwell3D::GetTransformFeedbackCounterBuffer() {
+        if (!transformFeedbackCounterBuffer) {
+            transformFeedbackCounterBuffer = std::make_shared<memory::Buffer>(ctx.gpu.memory.AllocateBuffer(engine::StreamOutBufferCount * sizeof(u32)));
+            std::memset(transformFeedbackCounterBuffer->data(), 0, transformFeedbackCounterBuffer->size_bytes());
+        }
+
+        if (!transformFeedbackCounterBufferAttached) {
+            ctx.executor.AttachDependency(transformFeedbackCounterBuffer);
+            transformFeedbackCounterBufferAttached = true;
+        }
+
+        return transformFeedbackCounterBuffer->vkBuffer;
+    }
 
-        return offset;
+    /**
+     * @brief Ends transform feedback and writes the amount of bytes written to each stream out buffer into the counter buffer
+     */
+    static void EndTransformFeedback(vk::raii::CommandBuffer &commandBuffer, vk::Buffer counterBuffer) {
+        constexpr std::array<vk::DeviceSize, engine::StreamOutBufferCount> CounterOffsets{0, sizeof(u32), sizeof(u32) * 2, sizeof(u32) * 3};
+        std::array<vk::Buffer, engine::StreamOutBufferCount> counterBuffers;
+        counterBuffers.fill(counterBuffer);
+        commandBuffer.endTransformFeedbackEXT(0, counterBuffers, CounterOffsets);
     }
 
     vk::Rect2D Maxwell3D::GetClearScissor() {
@@ -128,13 +162,18 @@ namespace skyline::gpu::interconnect::maxwell3d {
     }
 
     void Maxwell3D::Clear(engine::ClearSurface &clearSurface) {
+        // Clears are only skipped when rendering is unconditionally disabled as they can't be predicated on the GPU
+        if (renderEnable.mode == engine::RenderEnable::Mode::False)
+            return;
+
         auto scissor{GetClearScissor()};
         if (scissor.extent.width == 0 || scissor.extent.height == 0)
             return;
 
         auto needsAttachmentClearCmd{[&](auto &view) {
-            return scissor.offset.x != 0 || scissor.offset.y != 0 ||
-                scissor.extent != vk::Extent2D{view->texture->dimensions} ||
+            auto scaledScissor{ScaleRect(scissor, view->texture->resolutionScale)};
+            return scaledScissor.offset.x != 0 || scaledScissor.offset.y != 0 ||
+                scaledScissor.extent != vk::Extent2D{view->texture->dimensions} ||
                 view->range.layerCount != 1 || view->range.baseArrayLayer != 0 || clearSurface.rtArrayIndex != 0;
         }};
 
@@ -142,7 +181,6 @@ namespace skyline::gpu::interconnect::maxwell3d {
         const auto &surfaceClip{clearEngineRegisters.surfaceClip};
         vk::Rect2D renderArea{{surfaceClip.horizontal.x, surfaceClip.vertical.y}, {surfaceClip.horizontal.width, surfaceClip.vertical.height}};
 
-        auto clearRects{util::MakeFilledArray<vk::ClearRect, 2>(vk::ClearRect{.rect = scissor, .baseArrayLayer = clearSurface.rtArrayIndex, .layerCount = 1})};
         boost::container::small_vector<vk::ClearAttachment, 2> clearAttachments;
 
         std::shared_ptr<TextureView> colorView{};
@@ -165,7 +203,7 @@ namespace skyline::gpu::interconnect::maxwell3d {
                                                                   (clearSurface.aEnable ? vk::ColorComponentFlagBits::eA : vk::ColorComponentFlags{}),
                                                                   {clearEngineRegisters.colorClearValue}, &*view, [=](auto &&executionCallback) {
                         auto dst{view.get()};
-                        ctx.executor.AddSubpass(std::move(executionCallback), renderArea, {}, {}, span<TextureView *>{dst}, nullptr);
+                        ctx.executor.AddSubpass(std::move(executionCallback), ScaleRect(renderArea, dst->texture->resolutionScale), {}, {}, span<TextureView *>{dst}, nullptr);
                     });
                     ctx.executor.NotifyPipelineChange();
                 } else if (needsAttachmentClearCmd(view)) {
@@ -204,39 +242,41 @@ namespace skyline::gpu::interconnect::maxwell3d {
         if (clearAttachments.empty())
             return;
 
+        // If the attachments have differing resolution scales then the smallest one is used to stay within the bounds of both, matching the behaviour of draws
+        float scale{std::min(colorView ? colorView->texture->resolutionScale : depthStencilView->texture->resolutionScale, depthStencilView ? depthStencilView->texture->resolutionScale : colorView->texture->resolutionScale)};
+        auto clearRects{util::MakeFilledArray<vk::ClearRect, 2>(vk::ClearRect{.rect = ScaleRect(scissor, scale), .baseArrayLayer = clearSurface.rtArrayIndex, .layerCount = 1})};
+
         std::array<TextureView *, 1> colorAttachments{colorView ? &*colorView : nullptr};
-        ctx.executor.AddSubpass([clearAttachments, clearRects](vk::raii::CommandBuffer &commandBuffer, const std::shared_ptr<FenceCycle> &, GPU &, vk::RenderPass, u32) {
+        ctx.executor.AddSubpass([clearAttachments, clearRects](vk::raii::CommandBuffer &commandBuffer, const IntrusivePtr<FenceCycle> &, GPU &, vk::RenderPass, u32) {
             commandBuffer.clearAttachments(clearAttachments, span(clearRects).first(clearAttachments.size()));
-        }, renderArea, {}, {}, colorView ? colorAttachments : span<TextureView *>{}, depthStencilView ? &*depthStencilView : nullptr);
+        }, ScaleRect(renderArea, scale), {}, {}, colorView ? colorAttachments : span<TextureView *>{}, depthStencilView ? &*depthStencilView : nullptr);
     }
 
-    void Maxwell3D::Draw(engine::DrawTopology topology, bool transformFeedbackEnable, bool indexed, u32 count, u32 first, u32 instanceCount, u32 vertexOffset, u32 firstInstance) {
-        StateUpdateBuilder builder{*ctx.executor.allocator};
-
-        Pipeline *oldPipeline{activeState.GetPipeline()};
+    bool Maxwell3D::PrepareDraw(StateUpdateBuilder &builder, engine::DrawTopology topology, bool indexed, u32 first, u32 count) {
+        queries.PrepareDraw(ctx);
         samplers.Update(ctx, samplerBinding.value == engine::SamplerBinding::Value::ViaHeaderBinding);
         activeState.Update(ctx, textures, constantBuffers.boundConstantBuffers, builder, indexed, topology, first, count);
-        if (directState.inputAssembly.NeedsQuadConversion()) {
-            count = conversion::quads::GetIndexCount(count);
-            first = 0;
-
-            if (!indexed) {
-                // Use an index buffer to emulate quad lists with a triangle list input topology
-                vk::DeviceSize offset{UpdateQuadConversionBuffer(count, first)};
-                builder.SetIndexBuffer(BufferBinding{quadConversionBuffer->vkBuffer, offset}, vk::IndexType::eUint32);
-                indexed = true;
-            }
+        if (!activeState.GetPipeline()->IsCompiled()) [[unlikely]] {
+            // The pipeline is still being compiled asynchronously (or failed to compile) so the draw is skipped rather than stalling on it, all state needs to be marked dirty as any state updates in the builder are discarded alongside the draw
+            activeState.MarkAllDirty();
+            recordedState.Reset(); // The discarded state updates were already applied to the recorded state
+            constantBuffers.ResetQuickBind();
+            return false;
         }
 
+        return true;
+    }
+
+    StateUpdater Maxwell3D::BuildDrawState(StateUpdateBuilder &builder, Pipeline *oldPipeline) {
         Pipeline *pipeline{activeState.GetPipeline()};
         activeDescriptorSetSampledImages.resize(pipeline->GetTotalSampledImageCount());
 
         auto *descUpdateInfo{[&]() -> DescriptorUpdateInfo * {
             if (((oldPipeline == pipeline) || (oldPipeline && oldPipeline->CheckBindingMatch(pipeline))) && constantBuffers.quickBindEnabled) {
-                // If bindings between the old and new pipelines are the same we can reuse the descriptor sets given that quick bind is enabled (meaning that no buffer updates or calls to non-graphics engines have occurred that could invalidate them)
-                if (constantBuffers.quickBind)
-                    // If only a single constant buffer has been rebound between draws we can perform a partial descriptor update
-                    return pipeline->SyncDescriptorsQuickBind(ctx, constantBuffers.boundConstantBuffers, samplers, textures, *constantBuffers.quickBind, activeDescriptorSetSampledImages);
+                // If bindings between the old and new pipelines are the same we can reuse the descriptor sets given that quick bind is enabled (meaning that no calls to non-graphics engines have occurred that could invalidate them)
+                if (!constantBuffers.quickBind.Empty())
+                    // If constant buffers have been rebound or loaded into between draws we can perform a partial descriptor update covering only their descriptors
+                    return pipeline->SyncDescriptorsQuickBind(ctx, constantBuffers.boundConstantBuffers, samplers, textures, constantBuffers.quickBind, activeDescriptorSetSampledImages);
                 else
                     return nullptr;
             } else {
@@ -253,23 +293,159 @@ namespace skyline::gpu::interconnect::maxwell3d {
             if (ctx.gpu.traits.supportsPushDescriptors) {
                 builder.SetDescriptorSetWithPush(descUpdateInfo);
             } else {
-                if (!attachedDescriptorSets)
-                    attachedDescriptorSets = std::make_shared<boost::container::static_vector<DescriptorAllocator::ActiveDescriptorSet, DescriptorBatchSize>>();
+                // Full updates can reuse any set written with identical descriptors earlier in the execution, partial updates depend on the prior set and can't
+                bool fullUpdate{descUpdateInfo->copies.empty()};
+                u64 hash{fullUpdate ? descUpdateInfo->HashWrites() : 0};
+                auto cachedSet{fullUpdate ? std::find_if(descriptorSetCache.begin(), descriptorSetCache.end(), [&](const CachedDescriptorSet &entry) {
+                    return entry.updateInfo && entry.hash == hash && entry.updateInfo->WritesEqual(*descUpdateInfo);
+                }) : descriptorSetCache.end()};
+
+                if (cachedSet != descriptorSetCache.end()) {
+                    activeDescriptorSet = cachedSet->set;
+                    builder.BindDescriptorSet(descUpdateInfo, activeDescriptorSet);
+                } else {
+                    if (!attachedDescriptorSets)
+                        attachedDescriptorSets = std::make_shared<boost::container::static_vector<DescriptorAllocator::ActiveDescriptorSet, DescriptorBatchSize>>();
+
+                    auto newSet{&attachedDescriptorSets->emplace_back(ctx.gpu.descriptor.AllocateSet(descUpdateInfo->descriptorSetLayout))};
+                    auto *oldSet{activeDescriptorSet};
+                    activeDescriptorSet = newSet;
 
-                auto newSet{&attachedDescriptorSets->emplace_back(ctx.gpu.descriptor.AllocateSet(descUpdateInfo->descriptorSetLayout))};
-                auto *oldSet{activeDescriptorSet};
-                activeDescriptorSet = newSet;
+                    builder.SetDescriptorSetWithUpdate(descUpdateInfo, activeDescriptorSet, oldSet);
 
-                builder.SetDescriptorSetWithUpdate(descUpdateInfo, activeDescriptorSet, oldSet);
+                    if (fullUpdate) {
+                        descriptorSetCache[descriptorSetCacheNextIdx] = {hash, descUpdateInfo, activeDescriptorSet};
+                        descriptorSetCacheNextIdx = (descriptorSetCacheNextIdx + 1) % DescriptorSetCacheSize;
+                    }
 
-                if (attachedDescriptorSets->size() == DescriptorBatchSize) {
-                    ctx.executor.AttachDependency(attachedDescriptorSets);
-                    attachedDescriptorSets.reset();
+                    if (attachedDescriptorSets->size() == DescriptorBatchSize) {
+                        ctx.executor.AttachDependency(attachedDescriptorSets);
+                        attachedDescriptorSets.reset();
+                    }
                 }
             }
         }
 
-        auto stateUpdater{builder.Build()};
+        return builder.Build();
+    }
+
+    bool Maxwell3D::UpdateRenderEnable() {
+        conditionalRenderingActive = false;
+
+        switch (renderEnable.mode) {
+            case engine::RenderEnable::Mode::True:
+                return true;
+
+            case engine::RenderEnable::Mode::False:
+                return false;
+
+            case engine::RenderEnable::Mode::Conditional:
+                // The predicate is only the lower word of the semaphore value, this won't match if the value is an exact multiple of 2^32 but such a count is implausible
+                if (ctx.gpu.traits.supportsConditionalRendering) {
+                    renderEnableView.Update(ctx, renderEnable.address, sizeof(u32));
+                    if (*renderEnableView) {
+                        ctx.executor.AttachBuffer(*renderEnableView);
+                        renderEnableView->GetBuffer()->BlockSequencedCpuBackingWrites();
+                        conditionalRenderingActive = true;
+                        return true;
+                    }
+                }
+
+                [[fallthrough]];
+
+            case engine::RenderEnable::Mode::IfEqual:
+            case engine::RenderEnable::Mode::IfNotEqual: {
+                bool conditional{renderEnable.mode == engine::RenderEnable::Mode::Conditional};
+                std::array<u64, 3> values{}; // The second semaphore is at an offset of 0x10 from the first
+                auto semaphores{span{values}.cast<u8>().first(conditional ? sizeof(u64) : sizeof(values))};
+                renderEnableView.Update(ctx, renderEnable.address, semaphores.size());
+                if (!*renderEnableView || renderEnableView->size < semaphores.size()) {
+                    Logger::Warn("Unmapped render enable semaphore: 0x{:X}", static_cast<u64>(renderEnable.address));
+                    return true;
+                }
+
+                ContextLock lock{ctx.executor.tag, *renderEnableView};
+                auto buffer{renderEnableView->GetBuffer()};
+
+                // The semaphores can only have changed if the buffer was written to since they were last read, this avoids a flush for every predicated draw
+                if (renderEnableCache.valid && renderEnableCache.mode == renderEnable.mode && renderEnableCache.address == renderEnable.address && renderEnableCache.bufferId == buffer->GetId() && renderEnableCache.sequenceNumber == buffer->GetSequenceNumber() && buffer->IsClean())
+                    return renderEnableCache.enabled;
+
+                // The semaphore values may be written by prior GPU work (such as query results) so it must be completed and synchronised to the guest before they can be read
+                renderEnableView->Read(lock.IsFirstUsage(), [&]() {
+                    ctx.executor.Submit();
+                    lock = ContextLock{ctx.executor.tag, *renderEnableView}; // The executor releases its lock on submission so the buffer needs to be relocked for the synchronisation
+                }, semaphores, 0);
+
+                bool enabled{conditional ? values[0] != 0 : ((values[0] == values[2]) == (renderEnable.mode == engine::RenderEnable::Mode::IfEqual))};
+                renderEnableCache = {
+                    .valid = true,
+                    .enabled = enabled,
+                    .mode = renderEnable.mode,
+                    .address = renderEnable.address,
+                    .bufferId = buffer->GetId(),
+                    .sequenceNumber = buffer->GetSequenceNumber(),
+                };
+                return enabled;
+            }
+
+            default:
+                Logger::Warn("Unknown render enable mode: {}", static_cast<u32>(renderEnable.mode));
+                return true;
+        }
+    }
+
+    void Maxwell3D::AddDrawSubpass(std::function<void(vk::raii::CommandBuffer &, const IntrusivePtr<FenceCycle> &, GPU &, vk::RenderPass, u32)> &&function) {
+        if (conditionalRenderingActive) {
+            function = [drawFunction = std::move(function), predicate = *renderEnableView](vk::raii::CommandBuffer &commandBuffer, const IntrusivePtr<FenceCycle> &cycle, GPU &gpu, vk::RenderPass renderPass, u32 subpassIndex) {
+                commandBuffer.beginConditionalRenderingEXT(vk::ConditionalRenderingBeginInfoEXT{
+                    .buffer = predicate.GetBuffer()->GetBacking(),
+                    .offset = predicate.GetOffset(),
+                });
+                drawFunction(commandBuffer, cycle, gpu, renderPass, subpassIndex);
+                commandBuffer.endConditionalRenderingEXT();
+            };
+        }
+
+        const auto &surfaceClip{clearEngineRegisters.surfaceClip};
+        vk::Rect2D scissor{
+            {surfaceClip.horizontal.x, surfaceClip.vertical.y},
+            {surfaceClip.horizontal.width, surfaceClip.vertical.height}
+        };
+
+        ctx.executor.AddSubpass(std::move(function), ScaleRect(scissor, activeState.GetRenderTargetScale()), activeDescriptorSetSampledImages, {}, activeState.GetColorAttachments(), activeState.GetDepthAttachment(), !ctx.gpu.traits.quirks.relaxedRenderPassCompatibility);
+
+        constantBuffers.ResetQuickBind();
+    }
+
+    void Maxwell3D::Draw(engine::DrawTopology topology, bool transformFeedbackEnable, bool indexed, u32 count, u32 first, u32 instanceCount, u32 vertexOffset, u32 firstInstance) {
+        if (!UpdateRenderEnable())
+            return;
+
+        StateUpdateBuilder builder{*ctx.executor.allocator, &recordedState};
+
+        Pipeline *oldPipeline{activeState.GetPipeline()};
+        if (!PrepareDraw(builder, topology, indexed, first, count))
+            return;
+
+        if (directState.inputAssembly.NeedsQuadConversion()) {
+            if (!indexed) {
+                // Use an index buffer to emulate quad lists with a triangle list input topology, the first vertex is applied as the vertex offset so the same conversion buffer can be used for all draws regardless of it
+                UpdateQuadConversionBuffer(count);
+                builder.SetIndexBuffer(BufferBinding{quadConversionBuffer->vkBuffer}, vk::IndexType::eUint32);
+                vertexOffset = first;
+                indexed = true;
+            }
+
+            count = conversion::quads::GetIndexCount(count);
+            first = 0;
+        }
+
+        auto stateUpdater{BuildDrawState(builder, oldPipeline)};
+
+        transformFeedbackEnable &= ctx.gpu.traits.supportsTransformFeedback;
+        vk::Buffer counterBuffer{transformFeedbackEnable ? GetTransformFeedbackCounterBuffer() : vk::Buffer{}};
+        transformFeedbackCountersPending |= transformFeedbackEnable;
 
         /**
          * @brief Struct that can be linearly allocated, holding all state for the draw to avoid a dynamic allocation with lambda captures
@@ -283,18 +459,13 @@ namespace skyline::gpu::interconnect::maxwell3d {
             u32 firstInstance;
             bool indexed;
             bool transformFeedbackEnable;
+            vk::Buffer transformFeedbackCounterBuffer;
         };
         auto *drawParams{ctx.executor.allocator->EmplaceUntracked<DrawParams>(DrawParams{stateUpdater,
                                                                                          count, first, instanceCount, vertexOffset, firstInstance, indexed,
-                                                                                         ctx.gpu.traits.supportsTransformFeedback ? transformFeedbackEnable : false})};
-
-        const auto &surfaceClip{clearEngineRegisters.surfaceClip};
-        vk::Rect2D scissor{
-            {surfaceClip.horizontal.x, surfaceClip.vertical.y},
-            {surfaceClip.horizontal.width, surfaceClip.vertical.height}
-        };
+                                                                                         transformFeedbackEnable, counterBuffer})};
 
-        ctx.executor.AddSubpass([drawParams](vk::raii::CommandBuffer &commandBuffer, const std::shared_ptr<FenceCycle> &, GPU &gpu, vk::RenderPass, u32) {
+        AddDrawSubpass([drawParams](vk::raii::CommandBuffer &commandBuffer, const IntrusivePtr<FenceCycle> &, GPU &gpu, vk::RenderPass, u32) {
             drawParams->stateUpdater.RecordAll(gpu, commandBuffer);
 
             if (drawParams->transformFeedbackEnable)
@@ -306,9 +477,165 @@ namespace skyline::gpu::interconnect::maxwell3d {
                 commandBuffer.draw(drawParams->count, drawParams->instanceCount, drawParams->first, drawParams->firstInstance);
 
             if (drawParams->transformFeedbackEnable)
-                commandBuffer.endTransformFeedbackEXT(0, {}, {});
-        }, scissor, activeDescriptorSetSampledImages, {}, activeState.GetColorAttachments(), activeState.GetDepthAttachment(), !ctx.gpu.traits.quirks.relaxedRenderPassCompatibility);
+                EndTransformFeedback(commandBuffer, drawParams->transformFeedbackCounterBuffer);
+        });
+    }
 
-        constantBuffers.ResetQuickBind();
+    bool Maxwell3D::DrawIndirect(engine::DrawTopology topology, bool transformFeedbackEnable, bool indexed, u64 indirectBufferAddress, u32 drawCount, u32 stride, u32 indexBufferCapacity) {
+        // Quad conversion requires the vertex count on the CPU and a non-zero first instance can only be passed through with the drawIndirectFirstInstance feature
+        if (topology == engine::DrawTopology::Quads || !ctx.gpu.traits.supportsDrawIndirectFirstInstance || !drawCount)
+            return false;
+
+        u32 commandSize{static_cast<u32>(indexed ? sizeof(vk::DrawIndexedIndirectCommand) : sizeof(vk::DrawIndirectCommand))};
+        if (stride < commandSize || stride % sizeof(u32))
+            return false;
+
+        indirectBufferView.Update(ctx, indirectBufferAddress, static_cast<u64>(drawCount - 1) * stride + commandSize);
+        if (!*indirectBufferView) {
+            Logger::Warn("Unmapped indirect draw buffer: 0x{:X}", indirectBufferAddress);
+            return false;
+        }
+
+        if (!UpdateRenderEnable())
+            return true;
+
+        StateUpdateBuilder builder{*ctx.executor.allocator, &recordedState};
+
+        Pipeline *oldPipeline{activeState.GetPipeline()};
+        // As the index range being drawn is only known on the GPU, the entire bound index buffer is used
+        if (!PrepareDraw(builder, topology, indexed, 0, indexed ? indexBufferCapacity : 0))
+            return true;
+
+        ctx.executor.AttachBuffer(*indirectBufferView);
+        indirectBufferView->GetBuffer()->BlockSequencedCpuBackingWrites();
+
+        auto stateUpdater{BuildDrawState(builder, oldPipeline)};
+
+        transformFeedbackEnable &= ctx.gpu.traits.supportsTransformFeedback;
+        vk::Buffer counterBuffer{transformFeedbackEnable ? GetTransformFeedbackCounterBuffer() : vk::Buffer{}};
+        transformFeedbackCountersPending |= transformFeedbackEnable;
+
+        struct DrawIndirectParams {
+            StateUpdater stateUpdater;
+            BufferView indirectBuffer;
+            u32 drawCount;
+            u32 stride;
+            bool indexed;
+            bool transformFeedbackEnable;
+            bool multiDrawIndirect;
+            vk::Buffer transformFeedbackCounterBuffer;
+        };
+        auto *drawParams{ctx.executor.allocator->EmplaceUntracked<DrawIndirectParams>(DrawIndirectParams{stateUpdater, *indirectBufferView, drawCount, stride, indexed,
+                                                                                                         transformFeedbackEnable, ctx.gpu.traits.supportsMultiDrawIndirect, counterBuffer})};
+
+        AddDrawSubpass([drawParams](vk::raii::CommandBuffer &commandBuffer, const IntrusivePtr<FenceCycle> &, GPU &gpu, vk::RenderPass, u32) {
+            drawParams->stateUpdater.RecordAll(gpu, commandBuffer);
+
+            if (drawParams->transformFeedbackEnable)
+                commandBuffer.beginTransformFeedbackEXT(0, {}, {});
+
+            vk::Buffer buffer{drawParams->indirectBuffer.GetBuffer()->GetBacking()};
+            vk::DeviceSize offset{drawParams->indirectBuffer.GetOffset()};
+
+            // Without multiDrawIndirect only a single draw can be performed per command so they're split up
+            u32 commandCount{drawParams->multiDrawIndirect ? 1 : drawParams->drawCount};
+            u32 commandDrawCount{drawParams->multiDrawIndirect ? drawParams->drawCount : 1};
+            for (u32 i{}; i < commandCount; i++, offset += drawParams->stride) {
+                if (drawParams->indexed)
+                    commandBuffer.drawIndexedIndirect(buffer, offset, commandDrawCount, drawParams->stride);
+                else
+                    commandBuffer.drawIndirect(buffer, offset, commandDrawCount, drawParams->stride);
+            }
+
+            if (drawParams->transformFeedbackEnable)
+                EndTransformFeedback(commandBuffer, drawParams->transformFeedbackCounterBuffer);
+        });
+
+        return true;
+    }
+
+    bool Maxwell3D::DrawTransformFeedback(engine::DrawTopology topology, bool transformFeedbackEnable, u32 bufferIndex, u32 stride, u32 instanceCount, u32 firstInstance) {
+        // Quad conversion requires the vertex count on the CPU
+        if (!ctx.gpu.traits.supportsTransformFeedback || topology == engine::DrawTopology::Quads || bufferIndex >= engine::StreamOutBufferCount || !stride)
+            return false;
+
+        if (!UpdateRenderEnable())
+            return true;
+
+        if (transformFeedbackCountersPending) {
+            // Render passes have no dependencies between their draws, so the transform feedback output is made visible to the draw outside of one
+            ctx.executor.AddOutsideRpCommand([](vk::raii::CommandBuffer &commandBuffer, const IntrusivePtr<FenceCycle> &, GPU &) {
+                commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransformFeedbackEXT, vk::PipelineStageFlagBits::eDrawIndirect | vk::PipelineStageFlagBits::eVertexInput | vk::PipelineStageFlagBits::eTransformFeedbackEXT, {}, vk::MemoryBarrier{
+                    .srcAccessMask = vk::AccessFlagBits::eTransformFeedbackWriteEXT | vk::AccessFlagBits::eTransformFeedbackCounterWriteEXT,
+                    .dstAccessMask = vk::AccessFlagBits::eTransformFeedbackCounterReadEXT | vk::AccessFlagBits::eVertexAttributeRead | vk::AccessFlagBits::eTransformFeedbackWriteEXT,
+                }, {}, {});
+            });
+            transformFeedbackCountersPending = false;
+        }
+
+        StateUpdateBuilder builder{*ctx.executor.allocator, &recordedState};
+
+        Pipeline *oldPipeline{activeState.GetPipeline()};
+        if (!PrepareDraw(builder, topology, false, 0, 0))
+            return true;
+
+        auto stateUpdater{BuildDrawState(builder, oldPipeline)};
+
+        vk::Buffer counterBuffer{GetTransformFeedbackCounterBuffer()};
+        transformFeedbackCountersPending |= transformFeedbackEnable;
+
+        struct DrawTransformFeedbackParams {
+            StateUpdater stateUpdater;
+            vk::Buffer counterBuffer;
+            u32 bufferIndex;
+            u32 stride;
+            u32 instanceCount;
+            u32 firstInstance;
+            bool transformFeedbackEnable;
+        };
+        auto *drawParams{ctx.executor.allocator->EmplaceUntracked<DrawTransformFeedbackParams>(DrawTransformFeedbackParams{stateUpdater, counterBuffer, bufferIndex, stride, instanceCount, firstInstance, transformFeedbackEnable})};
+
+        AddDrawSubpass([drawParams](vk::raii::CommandBuffer &commandBuffer, const IntrusivePtr<FenceCycle> &, GPU &gpu, vk::RenderPass, u32) {
+            drawParams->stateUpdater.RecordAll(gpu, commandBuffer);
+
+            if (drawParams->transformFeedbackEnable)
+                commandBuffer.beginTransformFeedbackEXT(0, {}, {});
+
+            commandBuffer.drawIndirectByteCountEXT(drawParams->instanceCount, drawParams->firstInstance, drawParams->counterBuffer, drawParams->bufferIndex * sizeof(u32), 0, drawParams->stride);
+
+            if (drawParams->transformFeedbackEnable)
+                EndTransformFeedback(commandBuffer, drawParams->counterBuffer);
+        });
+
+        return true;
+    }
+
+    bool Maxwell3D::IsCounterSupported(Queries::Counter counter) {
+        return queries.IsSupported(counter);
+    }
+
+    void Maxwell3D::ResetCounter(Queries::Counter counter) {
+        queries.Reset(ctx, counter);
+    }
+
+    void Maxwell3D::SetCounterEnabled(Queries::Counter counter, bool enabled) {
+        queries.SetEnabled(ctx, counter, enabled);
+    }
+
+    void Maxwell3D::ReportCounter(Queries::Counter counter, u64 address, bool fourWords, u64 timestamp) {
+        if (queries.Report(ctx, counter, address, fourWords, timestamp))
+            return;
+
+        u64 value{queries.Resolve(ctx, counter)};
+        if (fourWords) {
+            ctx.channelCtx.asCtx->gmmu.Write(address + 8, timestamp);
+            ctx.channelCtx.asCtx->gmmu.Write(address, value);
+        } else {
+            ctx.channelCtx.asCtx->gmmu.Write(address, static_cast<u32>(value));
+        }
+    }
+
+    void Maxwell3D::EndQueries() {
+        queries.EndExecution(ctx);
     }
-}
\ No newline at end of file
+}
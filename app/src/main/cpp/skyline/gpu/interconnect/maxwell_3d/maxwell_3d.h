@@ -9,6 +9,7 @@
 #include "common.h"
 #include "active_state.h"
 #include "constant_buffers.h"
+#include "queries.h"
 
 namespace skyline::gpu::interconnect::maxwell3d {
     /**
@@ -37,6 +38,7 @@ namespace skyline::gpu::interconnect::maxwell3d {
             SamplerPoolState::EngineRegisters samplerPoolRegisters;
             const engine::SamplerBinding &samplerBinding;
             TexturePoolState::EngineRegisters texturePoolRegisters;
+            const engine::RenderEnable &renderEnable;
         };
 
       private:
@@ -47,18 +49,82 @@ namespace skyline::gpu::interconnect::maxwell3d {
         Samplers samplers;
         const engine::SamplerBinding &samplerBinding;
         Textures textures;
+        Queries queries;
         std::shared_ptr<memory::Buffer> quadConversionBuffer{};
         bool quadConversionBufferAttached{};
+        std::shared_ptr<memory::Buffer> transformFeedbackCounterBuffer{}; //!< The byte counts written by the last transform feedback draw to each stream out buffer, these are consumed by draws with an automatic vertex count without being read on the CPU
+        bool transformFeedbackCounterBufferAttached{};
+        bool transformFeedbackCountersPending{}; //!< If transform feedback was written in the current execution after the last barrier that made its output and counters visible to draws
 
         static constexpr size_t DescriptorBatchSize{0x100};
         std::shared_ptr<boost::container::static_vector<DescriptorAllocator::ActiveDescriptorSet, DescriptorBatchSize>> attachedDescriptorSets;
         DescriptorAllocator::ActiveDescriptorSet *activeDescriptorSet{};
+
+        /**
+         * @brief A descriptor set fully written earlier in the current execution, draws with identical descriptors can rebind it without allocating or writing a new set
+         */
+        struct CachedDescriptorSet {
+            u64 hash; //!< The value of `DescriptorUpdateInfo::HashWrites` for the update that wrote the set
+            DescriptorUpdateInfo *updateInfo; //!< The update that wrote the set, this is null for unused entries
+            DescriptorAllocator::ActiveDescriptorSet *set;
+        };
+        static constexpr size_t DescriptorSetCacheSize{8};
+        std::array<CachedDescriptorSet, DescriptorSetCacheSize> descriptorSetCache{};
+        size_t descriptorSetCacheNextIdx{};
         std::vector<TextureView *> activeDescriptorSetSampledImages{};
+        RecordedState recordedState; //!< The state set by the state updates of all prior draws in the command buffer, this is reset alongside all state being marked dirty
+        CachedMappedBufferView indirectBufferView; //!< The view of the guest buffer containing the arguments of the current indirect draw
+        const engine::RenderEnable &renderEnable;
+        CachedMappedBufferView renderEnableView; //!< The view of the guest semaphore that draws are predicated on
+        bool conditionalRenderingActive{}; //!< If the current draw should be predicated on the value in `renderEnableView` on the GPU
+
+        /**
+         * @brief The result of the last evaluation of the render enable state on the CPU, this is reused while neither the registers nor the semaphore buffer have changed
+         */
+        struct RenderEnableCache {
+            bool valid;
+            bool enabled;
+            engine::RenderEnable::Mode mode;
+            u64 address;
+            size_t bufferId; //!< The ID of the buffer the semaphores were read from
+            u32 sequenceNumber; //!< The sequence number of the buffer when the semaphores were read, the buffer must also have been clean since then for the result to be reused
+        } renderEnableCache{};
+
+        /**
+         * @brief Ensures the cached non-indexed quad conversion buffer covers at least the supplied amount of vertices and is attached to the current execution
+         */
+        void UpdateQuadConversionBuffer(u32 vertexCount);
 
-        size_t UpdateQuadConversionBuffer(u32 count, u32 firstVertex);
+        /**
+         * @return The transform feedback counter buffer after ensuring it's attached to the current execution
+         */
+        vk::Buffer GetTransformFeedbackCounterBuffer();
 
         vk::Rect2D GetClearScissor();
 
+        /**
+         * @brief Evaluates the render enable state for the current draw, predicating it on the GPU when possible and otherwise reading the semaphore values on the CPU
+         * @return If the draw should be recorded
+         */
+        bool UpdateRenderEnable();
+
+        /**
+         * @brief Updates all active state for a draw, this must be called prior to any draw-specific state being added to the builder
+         * @return If the draw should be performed, this is false if the pipeline isn't ready yet
+         */
+        bool PrepareDraw(StateUpdateBuilder &builder, engine::DrawTopology topology, bool indexed, u32 first, u32 count);
+
+        /**
+         * @brief Synchronizes the descriptors and pipeline of the draw and builds the final state updater
+         * @param oldPipeline The pipeline that was active prior to PrepareDraw being called
+         */
+        StateUpdater BuildDrawState(StateUpdateBuilder &builder, Pipeline *oldPipeline);
+
+        /**
+         * @brief Adds a subpass recording a draw into the bound render targets
+         */
+        void AddDrawSubpass(std::function<void(vk::raii::CommandBuffer &, const IntrusivePtr<FenceCycle> &, GPU &, vk::RenderPass, u32)> &&function);
+
       public:
         DirectPipelineState &directState;
 
@@ -87,5 +153,47 @@ namespace skyline::gpu::interconnect::maxwell3d {
         void Clear(engine::ClearSurface &clearSurface);
 
         void Draw(engine::DrawTopology topology, bool transformFeedbackEnable, bool indexed, u32 count, u32 first, u32 instanceCount, u32 vertexOffset, u32 firstInstance);
+
+        /**
+         * @brief Performs draws with their arguments sourced directly from a guest buffer on the GPU, this avoids synchronizing the buffer with the CPU when its contents are written by the GPU
+         * @param indirectBufferAddress The GPU address of the first draw command, these have the same layout as VkDrawIndirectCommand and VkDrawIndexedIndirectCommand
+         * @param indexBufferCapacity The amount of indices in the bound index buffer, as the range of indices used by the draws is only known on the GPU the entire index buffer is bound
+         * @return If the draws could be handled, the arguments must be read on the CPU and passed to Draw if this is false
+         */
+        bool DrawIndirect(engine::DrawTopology topology, bool transformFeedbackEnable, bool indexed, u64 indirectBufferAddress, u32 drawCount, u32 stride, u32 indexBufferCapacity);
+
+        /**
+         * @brief Performs a non-indexed draw of the vertices written to a stream out buffer by the last transform feedback draw, the vertex count is derived from the byte count on the GPU
+         * @param bufferIndex The index of the stream out buffer that the byte count is taken from
+         * @param stride The stride of a single vertex in the stream out buffer
+         * @return If the draw could be handled, this is false if transform feedback isn't supported on the host
+         */
+        bool DrawTransformFeedback(engine::DrawTopology topology, bool transformFeedbackEnable, u32 bufferIndex, u32 stride, u32 instanceCount, u32 firstInstance);
+
+        /**
+         * @return If the counter is emulated on the host GPU, the value of unsupported counters must be supplied by the CPU
+         */
+        bool IsCounterSupported(Queries::Counter counter);
+
+        /**
+         * @note See Queries::Reset
+         */
+        void ResetCounter(Queries::Counter counter);
+
+        /**
+         * @note See Queries::SetEnabled
+         */
+        void SetCounterEnabled(Queries::Counter counter, bool enabled);
+
+        /**
+         * @brief Writes the value of the counter into guest memory in the Maxwell semaphore layout, this is done on the GPU when possible and otherwise waits on the value on the CPU
+         * @param timestamp The timestamp to write alongside the value for four word semaphores
+         */
+        void ReportCounter(Queries::Counter counter, u64 address, bool fourWords, u64 timestamp);
+
+        /**
+         * @note See Queries::EndExecution
+         */
+        void EndQueries();
     };
 }
@@ -58,7 +58,8 @@ namespace skyline::gpu::interconnect::maxwell3d {
             u8 alphaFunc : 3; //!< Use {Set,Get}AlphaFunc
             bool alphaTestEnable : 1;
             bool depthClampEnable : 1; // Use SetDepthClampEnable
-            bool dynamicStateActive : 1;
+            bool dynamicStateActive : 1; //!< If VK_EXT_extended_dynamic_state is used, all state covered by it is excluded from the packed state and set dynamically
+            bool dynamicState2Active : 1; //!< If VK_EXT_extended_dynamic_state2 is used, all state covered by it is excluded from the packed state and set dynamically
             bool viewportTransformEnable : 1;
         };
 
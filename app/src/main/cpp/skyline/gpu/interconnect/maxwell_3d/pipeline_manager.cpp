@@ -1,6 +1,7 @@
 // SPDX-License-Identifier: MPL-2.0
 // Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
 
+#include <boost/functional/hash.hpp>
 #include <gpu/texture/texture.h>
 #include <gpu/interconnect/command_executor.h>
 #include <gpu/interconnect/common/pipeline.inc>
@@ -8,6 +9,7 @@
 #include <gpu/shader_manager.h>
 #include <gpu.h>
 #include "pipeline_manager.h"
+#include "pipeline_state_recorder.h"
 
 namespace skyline::gpu::interconnect::maxwell3d {
     static constexpr Shader::Stage ConvertCompilerShaderStage(engine::Pipeline::Shader::Type stage) {
@@ -173,56 +175,161 @@ namespace skyline::gpu::interconnect::maxwell3d {
         return info;
     }
 
-    static std::array<Pipeline::ShaderStage, engine::ShaderStageCount> MakePipelineShaders(InterconnectContext &ctx, Textures &textures, ConstantBufferSet &constantBuffers, const PackedPipelineState &packedState, const std::array<ShaderBinary, engine::PipelineCount> &shaderBinaries) {
-        ctx.gpu.shader.ResetPools();
+    /**
+     * @note State which only affects codegen in some configurations is only hashed in those, the viewport transform state is always hashed as it's read for every stage that writes the position
+     */
+    u64 HashShaderCompilationState(const PackedPipelineState &packedState) {
+        size_t hash{util::Hash("Maxwell3D")};
+        #define HASH(x) boost::hash_combine(hash, x)
+
+        for (auto shaderHash : packedState.shaderHashes)
+            HASH(shaderHash);
+
+        bool hasGeometry{packedState.shaderHashes[static_cast<u8>(engine::Pipeline::Shader::Type::Geometry)] != 0};
+        if (hasGeometry) // The skip mask is only used for geometry passthrough
+            for (auto mask : packedState.postVtgShaderAttributeSkipMask)
+                HASH(mask);
+
+        HASH(static_cast<u32>(packedState.bindlessTextureConstantBufferSlotSelect));
+        HASH(static_cast<bool>(packedState.viewportTransformEnable));
+        HASH(static_cast<u32>(packedState.topology));
+        if (hasGeometry || packedState.topology == engine::DrawTopology::Points) // See MakeRuntimeInfo
+            HASH(packedState.pointSize);
+        HASH(static_cast<bool>(packedState.openGlNdc));
+        HASH(static_cast<u32>(packedState.outputPrimitives));
+        HASH(static_cast<u32>(packedState.domainType));
+        HASH(static_cast<u32>(packedState.spacing));
+        HASH(static_cast<bool>(packedState.apiMandatedEarlyZ));
+        HASH(static_cast<bool>(packedState.flipYEnable));
+
+        HASH(static_cast<bool>(packedState.alphaTestEnable));
+        if (packedState.alphaTestEnable) {
+            HASH(static_cast<u32>(packedState.alphaFunc));
+            HASH(packedState.alphaRef);
+        }
 
-        using PipelineStage = engine::Pipeline::Shader::Type;
-        auto pipelineStage{[](size_t i) { return static_cast<PipelineStage>(i); }};
-        auto stageIdx{[](PipelineStage stage) { return static_cast<u8>(stage); }};
+        HASH(static_cast<bool>(packedState.transformFeedbackEnable));
+        if (packedState.transformFeedbackEnable)
+            HASH(XXH64(packedState.transformFeedbackVaryings.data(), sizeof(packedState.transformFeedbackVaryings), 0));
+
+        for (const auto &attribute : packedState.vertexAttributes)
+            HASH(static_cast<u32>(ConvertShaderAttributeType(attribute)));
+
+        #undef HASH
+        return hash;
+    }
+
+    static ShaderManager::ConstantBufferRead MakeConstantBufferRead(InterconnectContext &ctx, ConstantBufferSet &constantBuffers, size_t pipelineStage) {
+        return [&ctx, &constantBuffers, pipelineStage](u32 index, u32 offset) {
+            size_t shaderStage{pipelineStage > 0 ? (pipelineStage - 1) : 0};
+            return constantBuffers[shaderStage][index].Read<int>(ctx.executor, offset);
+        };
+    }
+
+    static ShaderManager::GetTextureType MakeGetTextureType(InterconnectContext &ctx, Textures &textures) {
+        return [&ctx, &textures](u32 index) {
+            return textures.GetTextureType(ctx, BindlessHandle{ .raw = index }.textureIndex);
+        };
+    }
 
+    /**
+     * @return If all guest state that was read during the translation of a set of shaders is unchanged, shaders can only be reused when this is the case
+     */
+    static bool EnvironmentMatches(InterconnectContext &ctx, Textures &textures, ConstantBufferSet &constantBuffers, const PackedPipelineState &packedState, const ShaderManager::EnvironmentRecord &environment) {
+        if (environment.viewportTransformState != ShaderManager::EnvironmentRecord::UnreadViewportTransformState && environment.viewportTransformState != (packedState.viewportTransformEnable ? 1U : 0U))
+            return false;
+
+        auto getTextureType{MakeGetTextureType(ctx, textures)};
+        return std::all_of(environment.constantBufferReads.begin(), environment.constantBufferReads.end(), [&](const auto &read) {
+            return static_cast<u32>(MakeConstantBufferRead(ctx, constantBuffers, read.stage)(read.index, read.offset)) == read.value;
+        }) && std::all_of(environment.textureTypes.begin(), environment.textureTypes.end(), [&](const auto &type) {
+            return getTextureType(type.handle) == type.type;
+        });
+    }
+
+    static std::array<Pipeline::ShaderStage, engine::ShaderStageCount> MakeCachedPipelineShaders(GPU &gpu, const PackedPipelineState &packedState, const ShaderManager::CachedShaders &cachedShaders) {
+        std::array<Pipeline::ShaderStage, engine::ShaderStageCount> shaderStages{};
+        for (const auto &stage : cachedShaders.stages)
+            shaderStages[stage.stage - (stage.stage >= 1 ? 1 : 0)] = {ConvertVkShaderStage(static_cast<engine::Pipeline::Shader::Type>(stage.stage)), gpu.shader.CreateShaderModule(stage.spirv, packedState.shaderHashes[stage.stage]), stage.info};
+        return shaderStages;
+    }
+
+    /**
+     * @brief Guest shaders of a pipeline which have been translated to IR but not yet emitted as SPIR-V
+     * @note Translation requires access to guest state and must be done on the thread recording the pipeline, emission doesn't and can be done on any thread
+     */
+    struct TranslatedPipelineShaders {
+        std::shared_ptr<ShaderManager::Pools> pools; //!< The pools backing the IR of the programs, this must be destroyed after them
         std::array<Shader::IR::Program, engine::PipelineCount> programs;
         bool ignoreVertexCullBeforeFetch{};
+        u64 cacheKey;
+        ShaderManager::EnvironmentRecord environment;
+    };
 
+    static std::shared_ptr<TranslatedPipelineShaders> TranslatePipelineShaders(InterconnectContext &ctx, Textures &textures, ConstantBufferSet &constantBuffers, const PackedPipelineState &packedState, const std::array<ShaderBinary, engine::PipelineCount> &shaderBinaries, u64 cacheKey) {
+        using PipelineStage = engine::Pipeline::Shader::Type;
+        auto stageIdx{[](PipelineStage stage) { return static_cast<u8>(stage); }};
+
+        auto translated{std::make_shared<TranslatedPipelineShaders>()};
+        translated->pools = ctx.gpu.shader.AcquirePools();
+        translated->cacheKey = cacheKey;
+
+        auto &programs{translated->programs};
         for (size_t i{}; i < engine::PipelineCount; i++) {
             if (!packedState.shaderHashes[i])
                 continue;
 
             auto program{ctx.gpu.shader.ParseGraphicsShader(
+                *translated->pools,
                 packedState.postVtgShaderAttributeSkipMask,
                 ConvertCompilerShaderStage(static_cast<PipelineStage>(i)),
-                shaderBinaries[i].binary, shaderBinaries[i].baseOffset,
+                shaderBinaries[i].binary, shaderBinaries[i].hash, shaderBinaries[i].baseOffset,
                 packedState.bindlessTextureConstantBufferSlotSelect,
-                packedState.viewportTransformEnable,
-                [&](u32 index, u32 offset) {
-                    size_t shaderStage{i > 0 ? (i - 1) : 0};
-                    return constantBuffers[shaderStage][index].Read<int>(ctx.executor, offset);
-                }, [&](u32 index) {
-                    return textures.GetTextureType(ctx, BindlessHandle{ .raw = index }.textureIndex);
-                })};
+                translated->environment.Record(ShaderManager::GetViewportTransformState{[&packedState]() -> u32 { return packedState.viewportTransformEnable ? 1 : 0; }}),
+                translated->environment.Record(static_cast<u32>(i), MakeConstantBufferRead(ctx, constantBuffers, i)),
+                translated->environment.Record(static_cast<u32>(i), MakeGetTextureType(ctx, textures)))};
             if (i == stageIdx(PipelineStage::Vertex) && packedState.shaderHashes[stageIdx(PipelineStage::VertexCullBeforeFetch)]) {
-                ignoreVertexCullBeforeFetch = true;
-                programs[i] = ctx.gpu.shader.CombineVertexShaders(programs[stageIdx(PipelineStage::VertexCullBeforeFetch)], program, shaderBinaries[i].binary);
+                translated->ignoreVertexCullBeforeFetch = true;
+                programs[i] = ctx.gpu.shader.CombineVertexShaders(programs[stageIdx(PipelineStage::VertexCullBeforeFetch)], program, shaderBinaries[i].binary, shaderBinaries[i].hash);
             } else {
                 programs[i] = program;
             }
         }
 
+        return translated;
+    }
+
+    /**
+     * @brief Emits SPIR-V for all translated shaders of a pipeline and stores them in the shader cache
+     * @note Stages are emitted sequentially as the bindings and runtime info of each stage depend on the previous stage
+     */
+    static std::array<Pipeline::ShaderStage, engine::ShaderStageCount> EmitPipelineShaders(GPU &gpu, TranslatedPipelineShaders &translated, const PackedPipelineState &packedState) {
+        using PipelineStage = engine::Pipeline::Shader::Type;
+        auto pipelineStage{[](size_t i) { return static_cast<PipelineStage>(i); }};
+        auto stageIdx{[](PipelineStage stage) { return static_cast<u8>(stage); }};
+
+        auto &programs{translated.programs};
         bool hasGeometry{packedState.shaderHashes[stageIdx(PipelineStage::Geometry)] && programs[stageIdx(PipelineStage::Geometry)].is_geometry_passthrough};
         Shader::Backend::Bindings bindings{};
         Shader::IR::Program *lastProgram{};
 
         std::array<Pipeline::ShaderStage, engine::ShaderStageCount> shaderStages{};
+        ShaderManager::CachedShaders cacheEntry{.environment = std::move(translated.environment)};
 
-        for (size_t i{stageIdx(ignoreVertexCullBeforeFetch ? PipelineStage::Vertex : PipelineStage::VertexCullBeforeFetch)}; i < engine::PipelineCount; i++) {
+        for (size_t i{stageIdx(translated.ignoreVertexCullBeforeFetch ? PipelineStage::Vertex : PipelineStage::VertexCullBeforeFetch)}; i < engine::PipelineCount; i++) {
             if (!packedState.shaderHashes[i])
                 continue;
 
             auto runtimeInfo{MakeRuntimeInfo(packedState, programs[i], lastProgram, hasGeometry)};
-            shaderStages[i - (i >= 1 ? 1 : 0)] = {ConvertVkShaderStage(pipelineStage(i)), ctx.gpu.shader.CompileShader(runtimeInfo, programs[i], bindings), programs[i].info};
+            auto spirv{gpu.shader.EmitShader(runtimeInfo, programs[i], bindings, packedState.shaderHashes[i])};
+            shaderStages[i - (i >= 1 ? 1 : 0)] = {ConvertVkShaderStage(pipelineStage(i)), gpu.shader.CreateShaderModule(spirv, packedState.shaderHashes[i]), programs[i].info};
+            cacheEntry.stages.push_back({static_cast<u32>(i), std::move(spirv), programs[i].info});
 
             lastProgram = &programs[i];
         }
 
+        gpu.shader.StoreCachedShaders(translated.cacheKey, std::move(cacheEntry));
+
         return shaderStages;
     }
 
@@ -421,11 +528,12 @@ namespace skyline::gpu::interconnect::maxwell3d {
         }
     }
 
-    static cache::GraphicsPipelineCache::CompiledPipeline MakeCompiledPipeline(InterconnectContext &ctx,
+    static cache::GraphicsPipelineCache::CompiledPipeline MakeCompiledPipeline(GPU &gpu,
                                                                                const PackedPipelineState &packedState,
                                                                                const std::array<Pipeline::ShaderStage, engine::ShaderStageCount> &shaderStages,
                                                                                span<vk::DescriptorSetLayoutBinding> layoutBindings,
-                                                                               span<TextureView *> colorAttachments, TextureView *depthAttachment) {
+                                                                               span<const cache::GraphicsPipelineCache::AttachmentMetadata> colorAttachments,
+                                                                               std::optional<cache::GraphicsPipelineCache::AttachmentMetadata> depthAttachment) {
         boost::container::static_vector<vk::PipelineShaderStageCreateInfo, engine::ShaderStageCount> shaderStageInfos;
         for (const auto &stage : shaderStages)
             if (stage.module)
@@ -448,10 +556,10 @@ namespace skyline::gpu::interconnect::maxwell3d {
                                    });
 
             if (binding.GetInputRate() == vk::VertexInputRate::eInstance) {
-                if (!ctx.gpu.traits.supportsVertexAttributeDivisor)
+                if (!gpu.traits.supportsVertexAttributeDivisor)
                     [[unlikely]]
                         Logger::Warn("Vertex attribute divisor used on guest without host support");
-                else if (!ctx.gpu.traits.supportsVertexAttributeZeroDivisor && binding.divisor == 0)
+                else if (!gpu.traits.supportsVertexAttributeZeroDivisor && binding.divisor == 0)
                     [[unlikely]]
                         Logger::Warn("Vertex attribute zero divisor used on guest without host support");
                 else
@@ -507,7 +615,7 @@ namespace skyline::gpu::interconnect::maxwell3d {
         rasterizationCreateInfo.frontFace = packedState.frontFaceClockwise ? vk::FrontFace::eClockwise : vk::FrontFace::eCounterClockwise;
         rasterizationCreateInfo.depthBiasEnable = packedState.depthBiasEnable;
         rasterizationCreateInfo.depthClampEnable = packedState.depthClampEnable;
-        if (!ctx.gpu.traits.supportsDepthClamp)
+        if (!gpu.traits.supportsDepthClamp)
             Logger::Warn("Depth clamp used on guest without host support");
         rasterizationState.get<vk::PipelineRasterizationProvokingVertexStateCreateInfoEXT>().provokingVertexMode = ConvertProvokingVertex(packedState.provokingVertex);
 
@@ -536,7 +644,7 @@ namespace skyline::gpu::interconnect::maxwell3d {
             .pAttachments = attachmentBlendStates.data()
         };
 
-        constexpr std::array<vk::DynamicState, 10> dynamicStates{
+        constexpr std::array<vk::DynamicState, 21> dynamicStates{
             vk::DynamicState::eViewport,
             vk::DynamicState::eScissor,
             vk::DynamicState::eLineWidth,
@@ -547,14 +655,28 @@ namespace skyline::gpu::interconnect::maxwell3d {
             vk::DynamicState::eStencilWriteMask,
             vk::DynamicState::eStencilReference,
             // VK_EXT_dynamic_state starts here
-            vk::DynamicState::eVertexInputBindingStrideEXT
+            vk::DynamicState::eVertexInputBindingStrideEXT,
+            vk::DynamicState::eCullModeEXT,
+            vk::DynamicState::eFrontFaceEXT,
+            vk::DynamicState::eDepthTestEnableEXT,
+            vk::DynamicState::eDepthWriteEnableEXT,
+            vk::DynamicState::eDepthCompareOpEXT,
+            vk::DynamicState::eDepthBoundsTestEnableEXT,
+            vk::DynamicState::eStencilTestEnableEXT,
+            vk::DynamicState::eStencilOpEXT,
+            // VK_EXT_dynamic_state2 starts here
+            vk::DynamicState::eDepthBiasEnableEXT,
+            vk::DynamicState::ePrimitiveRestartEnableEXT,
+            vk::DynamicState::eRasterizerDiscardEnableEXT,
         };
 
         static constexpr u32 BaseDynamicStateCount{9};
-        static constexpr u32 ExtendedDynamicStateCount{BaseDynamicStateCount + 1};
+        static constexpr u32 ExtendedDynamicStateCount{BaseDynamicStateCount + 9};
+        static constexpr u32 ExtendedDynamicState2Count{ExtendedDynamicStateCount + 3};
 
+        // The packed state is used rather than the device traits as it determines which state was excluded from the pipeline key
         vk::PipelineDynamicStateCreateInfo dynamicState{
-            .dynamicStateCount = ctx.gpu.traits.supportsExtendedDynamicState ? ExtendedDynamicStateCount : BaseDynamicStateCount,
+            .dynamicStateCount = packedState.dynamicStateActive ? (packedState.dynamicState2Active ? ExtendedDynamicState2Count : ExtendedDynamicStateCount) : BaseDynamicStateCount,
             .pDynamicStates = dynamicStates.data()
         };
 
@@ -563,13 +685,13 @@ namespace skyline::gpu::interconnect::maxwell3d {
         std::array<vk::Viewport, engine::ViewportCount> emptyViewports{};
 
         vk::PipelineViewportStateCreateInfo viewportState{
-            .viewportCount = static_cast<u32>(ctx.gpu.traits.supportsMultipleViewports ? engine::ViewportCount : 1),
+            .viewportCount = static_cast<u32>(gpu.traits.supportsMultipleViewports ? engine::ViewportCount : 1),
             .pViewports = emptyViewports.data(),
-            .scissorCount = static_cast<u32>(ctx.gpu.traits.supportsMultipleViewports ? engine::ViewportCount : 1),
+            .scissorCount = static_cast<u32>(gpu.traits.supportsMultipleViewports ? engine::ViewportCount : 1),
             .pScissors = emptyScissors.data(),
         };
 
-        return ctx.gpu.graphicsPipelineCache.GetCompiledPipeline(cache::GraphicsPipelineCache::PipelineState{
+        return gpu.graphicsPipelineCache.GetCompiledPipeline(cache::GraphicsPipelineCache::PipelineState{
             .shaderStages = shaderStageInfos,
             .vertexState = vertexInputState,
             .inputAssemblyState = inputAssemblyState,
@@ -586,11 +708,97 @@ namespace skyline::gpu::interconnect::maxwell3d {
     }
 
     Pipeline::Pipeline(InterconnectContext &ctx, Textures &textures, ConstantBufferSet &constantBuffers, const PackedPipelineState &packedState, const std::array<ShaderBinary, engine::PipelineCount> &shaderBinaries, span<TextureView *> colorAttachments, TextureView *depthAttachment)
-        : shaderStages{MakePipelineShaders(ctx, textures, constantBuffers, packedState, shaderBinaries)},
-          descriptorInfo{MakePipelineDescriptorInfo(shaderStages, ctx.gpu.traits.quirks.needsIndividualTextureBindingWrites)},
-          compiledPipeline{MakeCompiledPipeline(ctx, packedState, shaderStages, descriptorInfo.descriptorSetLayoutBindings, colorAttachments, depthAttachment)},
+        : sourcePackedState{packedState} {
+        cache::PipelineStatistics::PipelineRecord statisticsRecord{
+            .type = cache::PipelineStatistics::PipelineType::Graphics,
+            .stateHash = PackedPipelineStateHash{}(packedState),
+            .firstRequestedFrame = ctx.gpu.presentation.GetFrameId(),
+        };
+        for (const auto &binary : shaderBinaries) {
+            if (!binary.binary.empty()) {
+                statisticsRecord.shaderCount++;
+                statisticsRecord.guestShaderSize += static_cast<u32>(binary.binary.size());
+            }
+        }
+
+        i64 translationStartTime{util::GetTimeNs()};
+        std::shared_ptr<TranslatedPipelineShaders> translated;
+        u64 cacheKey{HashShaderCompilationState(packedState)};
+        if (auto cached{ctx.gpu.shader.LookupCachedShaders(cacheKey)}; cached && EnvironmentMatches(ctx, textures, constantBuffers, packedState, cached->environment))
+            shaderStages = MakeCachedPipelineShaders(ctx.gpu, packedState, *cached);
+        else
+            translated = TranslatePipelineShaders(ctx, textures, constantBuffers, packedState, shaderBinaries, cacheKey);
+        statisticsRecord.compileTimeNs = static_cast<u64>(util::GetTimeNs() - translationStartTime);
+
+        using AttachmentMetadata = cache::GraphicsPipelineCache::AttachmentMetadata;
+        boost::container::static_vector<AttachmentMetadata, engine::ColorTargetCount> colorAttachmentMetadata(colorAttachments.begin(), colorAttachments.end());
+        std::optional<AttachmentMetadata> depthAttachmentMetadata{depthAttachment ? std::optional<AttachmentMetadata>{depthAttachment} : std::nullopt};
+
+        // Everything past translation only depends on state owned by this object and can be done on another thread
+        auto compile{[this, &gpu = ctx.gpu, translated, colorAttachmentMetadata, depthAttachmentMetadata, statisticsRecord]() {
+            i64 compileStartTime{util::GetTimeNs()};
+            if (translated)
+                shaderStages = EmitPipelineShaders(gpu, *translated, sourcePackedState);
+
+            descriptorInfo = MakePipelineDescriptorInfo(shaderStages, gpu.traits.quirks.needsIndividualTextureBindingWrites);
+            storageBufferViews.resize(descriptorInfo.totalStorageBufferCount);
+            i64 pipelineStartTime{util::GetTimeNs()};
+            compiledPipeline = MakeCompiledPipeline(gpu, sourcePackedState, shaderStages, descriptorInfo.descriptorSetLayoutBindings, colorAttachmentMetadata, depthAttachmentMetadata);
+            gpu.shaderCompileStatistics.RecordPipeline(sourcePackedState.shaderHashes, static_cast<u64>(util::GetTimeNs() - pipelineStartTime));
+
+            // Time spent queued for asynchronous compilation is excluded as it doesn't reflect the cost of the pipeline itself
+            auto record{statisticsRecord};
+            record.compileTimeNs += static_cast<u64>(util::GetTimeNs() - compileStartTime);
+            gpu.pipelineStatistics.RecordPipeline(record);
+        }};
+
+        if (!ctx.gpu.IsAsyncPipelineCompilationEnabled()) {
+            compile();
+            compiled.store(true, std::memory_order_release);
+            return;
+        }
+
+        ctx.gpu.pipelineCompilePool.Submit([this, compile = std::move(compile)]() {
+            try {
+                compile();
+            } catch (const std::exception &e) {
+                Logger::Error("Failed to compile pipeline asynchronously, draws using it will be skipped: {}", e.what());
+                compileFailed.store(true, std::memory_order_relaxed); // Ordered by the release store to `compiled` below
+            }
+
+            std::scoped_lock lock{compileMutex};
+            compiled.store(true, std::memory_order_release);
+            compileCondition.notify_all();
+        });
+    }
+
+    Pipeline::Pipeline(GPU &gpu, const PackedPipelineState &packedState, const ShaderManager::CachedShaders &cachedShaders, span<const cache::GraphicsPipelineCache::AttachmentMetadata> colorAttachments, std::optional<cache::GraphicsPipelineCache::AttachmentMetadata> depthAttachment)
+        : shaderStages{MakeCachedPipelineShaders(gpu, packedState, cachedShaders)},
+          descriptorInfo{MakePipelineDescriptorInfo(shaderStages, gpu.traits.quirks.needsIndividualTextureBindingWrites)},
+          compiledPipeline{MakeCompiledPipeline(gpu, packedState, shaderStages, descriptorInfo.descriptorSetLayoutBindings, colorAttachments, depthAttachment)},
           sourcePackedState{packedState} {
         storageBufferViews.resize(descriptorInfo.totalStorageBufferCount);
+        compiled.store(true, std::memory_order_release);
+    }
+
+    Pipeline::~Pipeline() {
+        std::unique_lock lock{compileMutex};
+        compileCondition.wait(lock, [this] { return compiled.load(std::memory_order_acquire); });
+    }
+
+    Pipeline *PipelineManager::FindOrCreate(InterconnectContext &ctx, Textures &textures, ConstantBufferSet &constantBuffers, const PackedPipelineState &packedState, const std::array<ShaderBinary, engine::PipelineCount> &shaderBinaries, span<TextureView *> colorAttachments, TextureView *depthAttachment) {
+        auto it{map.find(packedState)};
+        ctx.gpu.pipelineStatistics.RecordLookup(cache::PipelineStatistics::LookupSource::Maxwell3D, it != map.end());
+        if (it != map.end())
+            return it->second.get();
+
+        auto &recorder{*ctx.gpu.maxwell3dPipelineRecorder};
+        if (auto prewarmed{recorder.Take(packedState)}; prewarmed.pipeline && EnvironmentMatches(ctx, textures, constantBuffers, packedState, prewarmed.environment))
+            return map.emplace(packedState, std::move(prewarmed.pipeline)).first->second.get();
+
+        auto pipeline{map.emplace(packedState, std::make_unique<Pipeline>(ctx, textures, constantBuffers, packedState, shaderBinaries, colorAttachments, depthAttachment)).first->second.get()};
+        recorder.Record(packedState, colorAttachments, depthAttachment);
+        return pipeline;
     }
 
     void Pipeline::SyncCachedStorageBufferViews(u32 executionNumber) {
@@ -648,11 +856,15 @@ namespace skyline::gpu::interconnect::maxwell3d {
         u32 writeIdx{};
         auto writes{ctx.executor.allocator->AllocateUntracked<vk::WriteDescriptorSet>(descriptorInfo.totalWriteDescCount)};
 
+        // Buffer and image descriptors are allocated contiguously so that they can be used directly as the data of the descriptor update template
+        static_assert(sizeof(vk::DescriptorBufferInfo) % alignof(vk::DescriptorImageInfo) == 0);
+        u8 *templateData{ctx.executor.allocator->Allocate(sizeof(vk::DescriptorBufferInfo) * descriptorInfo.totalBufferDescCount + sizeof(vk::DescriptorImageInfo) * descriptorInfo.totalImageDescCount, false)};
+
         u32 bufferIdx{};
-        auto bufferDescs{ctx.executor.allocator->AllocateUntracked<vk::DescriptorBufferInfo>(descriptorInfo.totalBufferDescCount)};
+        span<vk::DescriptorBufferInfo> bufferDescs{reinterpret_cast<vk::DescriptorBufferInfo *>(templateData), descriptorInfo.totalBufferDescCount};
         auto bufferDescDynamicBindings{ctx.executor.allocator->AllocateUntracked<DynamicBufferBinding>(descriptorInfo.totalBufferDescCount)};
         u32 imageIdx{};
-        auto imageDescs{ctx.executor.allocator->AllocateUntracked<vk::DescriptorImageInfo>(descriptorInfo.totalImageDescCount)};
+        span<vk::DescriptorImageInfo> imageDescs{reinterpret_cast<vk::DescriptorImageInfo *>(templateData + bufferDescs.size_bytes()), descriptorInfo.totalImageDescCount};
 
         u32 storageBufferIdx{}; // Need to keep track of this to index into the cached view array
         u32 combinedImageSamplerIdx{}; // Need to keep track of this to index into the sampled image array
@@ -740,87 +952,141 @@ namespace skyline::gpu::interconnect::maxwell3d {
         if (!writeIdx)
             return nullptr;
 
+        // The layout of the writes is identical for every full update of the pipeline so the template can be created from the first one
+        if (!descriptorUpdateTemplate) {
+            boost::container::small_vector<vk::DescriptorUpdateTemplateEntry, 0x20> entries;
+            for (const auto &write : writes.first(writeIdx)) {
+                auto info{write.pBufferInfo ? static_cast<const void *>(write.pBufferInfo) : static_cast<const void *>(write.pImageInfo)};
+                entries.push_back(vk::DescriptorUpdateTemplateEntry{
+                    .dstBinding = write.dstBinding,
+                    .dstArrayElement = write.dstArrayElement,
+                    .descriptorCount = write.descriptorCount,
+                    .descriptorType = write.descriptorType,
+                    .offset = static_cast<size_t>(static_cast<const u8 *>(info) - templateData),
+                    .stride = write.pBufferInfo ? sizeof(vk::DescriptorBufferInfo) : sizeof(vk::DescriptorImageInfo),
+                });
+            }
+
+            descriptorUpdateTemplate.emplace(ctx.gpu.vkDevice, vk::DescriptorUpdateTemplateCreateInfo{
+                .descriptorUpdateEntryCount = static_cast<u32>(entries.size()),
+                .pDescriptorUpdateEntries = entries.data(),
+                .templateType = ctx.gpu.traits.supportsPushDescriptors ? vk::DescriptorUpdateTemplateType::ePushDescriptorsKHR : vk::DescriptorUpdateTemplateType::eDescriptorSet,
+                .descriptorSetLayout = compiledPipeline.descriptorSetLayout,
+                .pipelineBindPoint = vk::PipelineBindPoint::eGraphics,
+                .pipelineLayout = compiledPipeline.pipelineLayout,
+                .set = 0,
+            });
+        }
+
         return ctx.executor.allocator->EmplaceUntracked<DescriptorUpdateInfo>(DescriptorUpdateInfo{
             .writes = writes.first(writeIdx),
             .bufferDescs = bufferDescs.first(bufferIdx),
             .bufferDescDynamicBindings = bufferDescDynamicBindings.first(bufferIdx),
+            .imageDescs = imageDescs.first(imageIdx),
             .pipelineLayout = compiledPipeline.pipelineLayout,
             .descriptorSetLayout = compiledPipeline.descriptorSetLayout,
             .bindPoint = vk::PipelineBindPoint::eGraphics,
             .descriptorSetIndex = 0,
+            .updateTemplate = **descriptorUpdateTemplate,
+            .templateData = templateData,
         });
     }
 
-    DescriptorUpdateInfo *Pipeline::SyncDescriptorsQuickBind(InterconnectContext &ctx, ConstantBufferSet &constantBuffers, Samplers &samplers, Textures &textures, ConstantBuffers::QuickBind quickBind, span<TextureView *> sampledImages) {
+    DescriptorUpdateInfo *Pipeline::SyncDescriptorsQuickBind(InterconnectContext &ctx, ConstantBufferSet &constantBuffers, Samplers &samplers, Textures &textures, const ConstantBuffers::QuickBind &quickBind, span<TextureView *> sampledImages) {
         SyncCachedStorageBufferViews(ctx.executor.executionNumber);
 
-        size_t stageIndex{static_cast<size_t>(quickBind.stage)};
-        const auto &stageDescInfo{descriptorInfo.stages[stageIndex]};
-        const auto &cbufUsageInfo{stageDescInfo.cbufUsages[quickBind.index]};
-        if (!cbufUsageInfo.writeDescCount)
-            return nullptr;
+        // The usages of all quick bound constant buffers are summed to allocate for all their writes at once, descriptors shared between multiple of them are only written once so this is an upper bound
+        u32 writeDescCount{}, totalBufferDescCount{}, totalImageDescCount{};
+        for (size_t stageIndex{}; stageIndex < engine::ShaderStageCount; stageIndex++) {
+            for (u32 mask{quickBind.stageMasks[stageIndex]}; mask; mask &= mask - 1) {
+                const auto &cbufUsageInfo{descriptorInfo.stages[stageIndex].cbufUsages[std::countr_zero(mask)]};
+                writeDescCount += cbufUsageInfo.writeDescCount;
+                totalBufferDescCount += cbufUsageInfo.totalBufferDescCount;
+                totalImageDescCount += cbufUsageInfo.totalImageDescCount;
+            }
+        }
 
-        const auto &shaderInfo{shaderStages[stageIndex].info};
-        auto &stageConstantBuffers{constantBuffers[stageIndex]};
+        if (!writeDescCount)
+            return nullptr;
 
         u32 writeIdx{};
-        auto writes{ctx.executor.allocator->AllocateUntracked<vk::WriteDescriptorSet>(cbufUsageInfo.writeDescCount)};
+        auto writes{ctx.executor.allocator->AllocateUntracked<vk::WriteDescriptorSet>(writeDescCount)};
 
         u32 bufferIdx{};
-        auto bufferDescs{ctx.executor.allocator->AllocateUntracked<vk::DescriptorBufferInfo>(cbufUsageInfo.totalBufferDescCount)};
-        auto bufferDescDynamicBindings{ctx.executor.allocator->AllocateUntracked<DynamicBufferBinding>(cbufUsageInfo.totalBufferDescCount)};
+        auto bufferDescs{ctx.executor.allocator->AllocateUntracked<vk::DescriptorBufferInfo>(totalBufferDescCount)};
+        auto bufferDescDynamicBindings{ctx.executor.allocator->AllocateUntracked<DynamicBufferBinding>(totalBufferDescCount)};
 
         u32 imageIdx{};
-        auto imageDescs{ctx.executor.allocator->AllocateUntracked<vk::DescriptorImageInfo>(cbufUsageInfo.totalImageDescCount)};
+        auto imageDescs{ctx.executor.allocator->AllocateUntracked<vk::DescriptorImageInfo>(totalImageDescCount)};
 
-        /**
-         * @brief Unified function to add descriptor set writes for any descriptor type
-         * @note Since quick bind always results in one write per buffer, `needsIndividualTextureBindingWrites` is implicit
-         */
-        auto writeDescs{[&]<bool ImageDesc, bool BufferDesc>(vk::DescriptorType type, const auto &usages, const auto &descs, auto getBindingCb) {
-            for (const auto &usage : usages) {
-                const auto &shaderDesc{descs[usage.shaderDescIdx]};
-
-                writes[writeIdx] = {
-                    .dstBinding = usage.binding,
-                    .descriptorCount = shaderDesc.count,
-                    .descriptorType = type,
-                };
-
-                if constexpr (ImageDesc)
-                    writes[writeIdx].pImageInfo = &imageDescs[imageIdx];
-                else if constexpr (BufferDesc)
-                    writes[writeIdx].pBufferInfo = &bufferDescs[bufferIdx];
+        for (size_t stageIndex{}; stageIndex < engine::ShaderStageCount; stageIndex++) {
+            u32 stageMask{quickBind.stageMasks[stageIndex]};
+            if (!stageMask)
+                continue;
 
-                writeIdx++;
+            const auto &stageDescInfo{descriptorInfo.stages[stageIndex]};
+            const auto &shaderInfo{shaderStages[stageIndex].info};
+            auto &stageConstantBuffers{constantBuffers[stageIndex]};
+            // Bindings are unique to a stage so only writes from the current stage need to be checked for duplicates
+            u32 stageWriteStartIdx{writeIdx};
+
+            /**
+             * @brief Unified function to add descriptor set writes for any descriptor type
+             * @note Since quick bind always results in one write per buffer, `needsIndividualTextureBindingWrites` is implicit
+             */
+            auto writeDescs{[&]<bool ImageDesc, bool BufferDesc>(vk::DescriptorType type, const auto &usages, const auto &descs, auto getBindingCb) {
+                for (const auto &usage : usages) {
+                    // Array uniform buffers and textures with a secondary handle are used by multiple constant buffers, these may have already been written for another constant buffer
+                    if (std::any_of(writes.begin() + stageWriteStartIdx, writes.begin() + writeIdx, [&](const vk::WriteDescriptorSet &write) { return write.dstBinding == usage.binding; }))
+                        continue;
+
+                    const auto &shaderDesc{descs[usage.shaderDescIdx]};
+
+                    writes[writeIdx] = {
+                        .dstBinding = usage.binding,
+                        .descriptorCount = shaderDesc.count,
+                        .descriptorType = type,
+                    };
 
-                for (size_t i{}; i < shaderDesc.count; i++) {
                     if constexpr (ImageDesc)
-                        imageDescs[imageIdx++] = getBindingCb(usage, shaderDesc, i);
+                        writes[writeIdx].pImageInfo = &imageDescs[imageIdx];
                     else if constexpr (BufferDesc)
-                        bufferDescDynamicBindings[bufferIdx++] = getBindingCb(usage, shaderDesc, i);
+                        writes[writeIdx].pBufferInfo = &bufferDescs[bufferIdx];
+
+                    writeIdx++;
+
+                    for (size_t i{}; i < shaderDesc.count; i++) {
+                        if constexpr (ImageDesc)
+                            imageDescs[imageIdx++] = getBindingCb(usage, shaderDesc, i);
+                        else if constexpr (BufferDesc)
+                            bufferDescDynamicBindings[bufferIdx++] = getBindingCb(usage, shaderDesc, i);
+                    }
                 }
-            }
-        }};
+            }};
 
-        writeDescs.operator()<false, true>(vk::DescriptorType::eUniformBuffer, cbufUsageInfo.uniformBuffers, shaderInfo.constant_buffer_descriptors,
-                                           [&](auto usage, const Shader::ConstantBufferDescriptor &desc, size_t arrayIdx) -> DynamicBufferBinding {
-                                               size_t cbufIdx{desc.index + arrayIdx};
-                                               return GetConstantBufferBinding(ctx, shaderInfo, stageConstantBuffers[cbufIdx].view, cbufIdx);
-                                           });
-
-        writeDescs.operator()<false, true>(vk::DescriptorType::eStorageBuffer, cbufUsageInfo.storageBuffers, shaderInfo.storage_buffers_descriptors,
-                                           [&](auto usage, const Shader::StorageBufferDescriptor &desc, size_t arrayIdx) {
-                                               return GetStorageBufferBinding(ctx, desc, stageConstantBuffers[desc.cbuf_index], storageBufferViews[usage.entirePipelineIdx + arrayIdx]);
-                                           });
-
-        writeDescs.operator()<true, false>(vk::DescriptorType::eCombinedImageSampler, cbufUsageInfo.combinedImageSamplers, shaderInfo.texture_descriptors,
-                                           [&](auto usage, const Shader::TextureDescriptor &desc, size_t arrayIdx) {
-                                               BindlessHandle handle{ReadBindlessHandle(ctx, stageConstantBuffers, desc, arrayIdx)};
-                                               auto binding{GetTextureBinding(ctx, desc, samplers, textures, handle)};
-                                               sampledImages[usage.entirePipelineIdx + arrayIdx] = binding.second;
-                                               return binding.first;
-                                           });
+            for (u32 mask{stageMask}; mask; mask &= mask - 1) {
+                const auto &cbufUsageInfo{stageDescInfo.cbufUsages[std::countr_zero(mask)]};
+
+                writeDescs.operator()<false, true>(vk::DescriptorType::eUniformBuffer, cbufUsageInfo.uniformBuffers, shaderInfo.constant_buffer_descriptors,
+                                                   [&](auto usage, const Shader::ConstantBufferDescriptor &desc, size_t arrayIdx) -> DynamicBufferBinding {
+                                                       size_t cbufIdx{desc.index + arrayIdx};
+                                                       return GetConstantBufferBinding(ctx, shaderInfo, stageConstantBuffers[cbufIdx].view, cbufIdx);
+                                                   });
+
+                writeDescs.operator()<false, true>(vk::DescriptorType::eStorageBuffer, cbufUsageInfo.storageBuffers, shaderInfo.storage_buffers_descriptors,
+                                                   [&](auto usage, const Shader::StorageBufferDescriptor &desc, size_t arrayIdx) {
+                                                       return GetStorageBufferBinding(ctx, desc, stageConstantBuffers[desc.cbuf_index], storageBufferViews[usage.entirePipelineIdx + arrayIdx]);
+                                                   });
+
+                writeDescs.operator()<true, false>(vk::DescriptorType::eCombinedImageSampler, cbufUsageInfo.combinedImageSamplers, shaderInfo.texture_descriptors,
+                                                   [&](auto usage, const Shader::TextureDescriptor &desc, size_t arrayIdx) {
+                                                       BindlessHandle handle{ReadBindlessHandle(ctx, stageConstantBuffers, desc, arrayIdx)};
+                                                       auto binding{GetTextureBinding(ctx, desc, samplers, textures, handle)};
+                                                       sampledImages[usage.entirePipelineIdx + arrayIdx] = binding.second;
+                                                       return binding.first;
+                                                   });
+            }
+        }
 
         // Since we don't implement all descriptor types the number of writes might not match what's expected
         if (!writeIdx)
@@ -831,6 +1097,7 @@ namespace skyline::gpu::interconnect::maxwell3d {
             .writes = writes.first(writeIdx),
             .bufferDescs = bufferDescs.first(bufferIdx),
             .bufferDescDynamicBindings = bufferDescDynamicBindings.first(bufferIdx),
+            .imageDescs = imageDescs.first(imageIdx),
             .pipelineLayout = compiledPipeline.pipelineLayout,
             .descriptorSetLayout = compiledPipeline.descriptorSetLayout,
             .bindPoint = vk::PipelineBindPoint::eGraphics,
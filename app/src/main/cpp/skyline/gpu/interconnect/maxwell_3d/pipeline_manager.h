@@ -6,6 +6,7 @@
 #include <tsl/robin_map.h>
 #include <shader_compiler/frontend/ir/program.h>
 #include <gpu/cache/graphics_pipeline_cache.h>
+#include <gpu/shader_manager.h>
 #include <gpu/interconnect/common/samplers.h>
 #include <gpu/interconnect/common/textures.h>
 #include "common.h"
@@ -17,6 +18,11 @@ namespace skyline::gpu {
 }
 
 namespace skyline::gpu::interconnect::maxwell3d {
+    /**
+     * @return A hash of all pipeline state that affects the code generated for the pipeline's shaders, this is used as the key for the on-disk shader cache
+     */
+    u64 HashShaderCompilationState(const PackedPipelineState &packedState);
+
     class Pipeline {
       public:
         struct ShaderStage {
@@ -92,6 +98,13 @@ namespace skyline::gpu::interconnect::maxwell3d {
 
         tsl::robin_map<Pipeline *, bool> bindingMatchCache; //!< Cache of which pipelines have bindings that match this pipeline
 
+        std::optional<vk::raii::DescriptorUpdateTemplate> descriptorUpdateTemplate; //!< The template used for full descriptor updates of the pipeline, this is created on the first full update
+
+        std::atomic<bool> compiled{}; //!< If compilation has completed, this is only false while the pipeline is being compiled asynchronously
+        std::atomic<bool> compileFailed{}; //!< If asynchronous compilation threw, `compiledPipeline` is left invalid and the pipeline must never be used for draws
+        std::mutex compileMutex; //!< Synchronizes waiting on asynchronous compilation to complete
+        std::condition_variable compileCondition; //!< Signalled when asynchronous compilation completes
+
         void SyncCachedStorageBufferViews(u32 executionNumber);
 
       public:
@@ -102,6 +115,25 @@ namespace skyline::gpu::interconnect::maxwell3d {
 
         Pipeline(InterconnectContext &ctx, Textures &textures, ConstantBufferSet &constantBuffers, const PackedPipelineState &packedState, const std::array<ShaderBinary, engine::PipelineCount> &shaderBinaries, span<TextureView *> colorAttachments, TextureView *depthAttachment);
 
+        /**
+         * @brief Creates a pipeline entirely from previously translated shaders without requiring any guest state, this is used to build pipelines ahead of time
+         * @note The environment of the cached shaders **must** be validated against the guest state before the pipeline is used
+         */
+        Pipeline(GPU &gpu, const PackedPipelineState &packedState, const ShaderManager::CachedShaders &cachedShaders, span<const cache::GraphicsPipelineCache::AttachmentMetadata> colorAttachments, std::optional<cache::GraphicsPipelineCache::AttachmentMetadata> depthAttachment);
+
+        /**
+         * @note This will block until any asynchronous compilation of the pipeline has completed
+         */
+        ~Pipeline();
+
+        /**
+         * @return If the pipeline has been compiled and `compiledPipeline` can be used, this is always true unless asynchronous pipeline compilation is enabled
+         * @note This is permanently false for pipelines that failed to compile asynchronously, draws using them are skipped
+         */
+        bool IsCompiled() const {
+            return compiled.load(std::memory_order_acquire) && !compileFailed.load(std::memory_order_relaxed);
+        }
+
         Pipeline *LookupNext(const PackedPipelineState &packedState);
 
         void AddTransition(Pipeline *next);
@@ -117,10 +149,10 @@ namespace skyline::gpu::interconnect::maxwell3d {
         DescriptorUpdateInfo *SyncDescriptors(InterconnectContext &ctx, ConstantBufferSet &constantBuffers, Samplers &samplers, Textures &textures, span<TextureView *> sampledImages);
 
         /**
-         * @brief Creates a partial descriptor set update from the current GPU state for only the subset of descriptors changed by the quick bind constant buffer
+         * @brief Creates a partial descriptor set update from the current GPU state for only the subset of descriptors changed by the quick bound constant buffers
          * @param sampledImages A span of size `GetTotalSampledImageCount()` in which texture view pointers for each sampled image will be written
          */
-        DescriptorUpdateInfo *SyncDescriptorsQuickBind(InterconnectContext &ctx, ConstantBufferSet &constantBuffers, Samplers &samplers, Textures &textures, ConstantBuffers::QuickBind quickBind, span<TextureView *> sampledImages);
+        DescriptorUpdateInfo *SyncDescriptorsQuickBind(InterconnectContext &ctx, ConstantBufferSet &constantBuffers, Samplers &samplers, Textures &textures, const ConstantBuffers::QuickBind &quickBind, span<TextureView *> sampledImages);
     };
 
     class PipelineManager {
@@ -128,12 +160,9 @@ namespace skyline::gpu::interconnect::maxwell3d {
         tsl::robin_map<PackedPipelineState, std::unique_ptr<Pipeline>, PackedPipelineStateHash> map;
 
       public:
-        Pipeline *FindOrCreate(InterconnectContext &ctx, Textures &textures, ConstantBufferSet &constantBuffers, const PackedPipelineState &packedState, const std::array<ShaderBinary, engine::PipelineCount> &shaderBinaries, span<TextureView *> colorAttachments, TextureView *depthAttachment) {
-            auto it{map.find(packedState)};
-            if (it != map.end())
-                return it->second.get();
-
-            return map.emplace(packedState, std::make_unique<Pipeline>(ctx, textures, constantBuffers, packedState, shaderBinaries, colorAttachments, depthAttachment)).first->second.get();
-        }
+        /**
+         * @brief Finds a pipeline matching the supplied state, if there's no such pipeline then one prebuilt during pre-warming will be used or a new one will be created and recorded for future pre-warming
+         */
+        Pipeline *FindOrCreate(InterconnectContext &ctx, Textures &textures, ConstantBufferSet &constantBuffers, const PackedPipelineState &packedState, const std::array<ShaderBinary, engine::PipelineCount> &shaderBinaries, span<TextureView *> colorAttachments, TextureView *depthAttachment);
     };
 }
@@ -165,7 +165,7 @@ namespace skyline::gpu::interconnect::maxwell3d {
             if (guest.tileConfig.mode == gpu::texture::TileMode::Block)
                 DetermineRenderTargetDimensions(guest, engine->surfaceClip);
 
-            view = ctx.gpu.texture.FindOrCreate(guest, ctx.executor.tag);
+            view = ctx.gpu.texture.FindOrCreate(guest, ctx.executor.tag, true);
         } else {
             view = {};
         }
@@ -236,7 +236,7 @@ namespace skyline::gpu::interconnect::maxwell3d {
             if (guest.tileConfig.mode == gpu::texture::TileMode::Block)
                 DetermineRenderTargetDimensions(guest, engine->surfaceClip);
 
-            view = ctx.gpu.texture.FindOrCreate(guest, ctx.executor.tag);
+            view = ctx.gpu.texture.FindOrCreate(guest, ctx.executor.tag, true);
         } else {
             view = {};
         }
@@ -301,9 +301,14 @@ namespace skyline::gpu::interconnect::maxwell3d {
 
     InputAssemblyState::InputAssemblyState(const EngineRegisters &engine) : engine{engine} {}
 
-    void InputAssemblyState::Update(PackedPipelineState &packedState) {
+    void InputAssemblyState::Update(PackedPipelineState &packedState, ExtendedDynamicState &dynamicState) {
         packedState.topology = currentEngineTopology;
-        packedState.primitiveRestartEnabled = engine.primitiveRestartEnable & 1;
+        if (packedState.dynamicState2Active) {
+            dynamicState.primitiveRestartEnable = engine.primitiveRestartEnable & 1;
+            packedState.primitiveRestartEnabled = false;
+        } else {
+            packedState.primitiveRestartEnabled = engine.primitiveRestartEnable & 1;
+        }
     }
 
     void InputAssemblyState::SetPrimitiveTopology(engine::DrawTopology topology) {
@@ -350,7 +355,7 @@ namespace skyline::gpu::interconnect::maxwell3d {
         }
     }
 
-    void RasterizationState::Flush(PackedPipelineState &packedState) {
+    void RasterizationState::Flush(PackedPipelineState &packedState, ExtendedDynamicState &dynamicState) {
         packedState.rasterizerDiscardEnable = !engine->rasterEnable;
         packedState.SetPolygonMode(engine->frontPolygonMode);
         if (engine->backPolygonMode != engine->frontPolygonMode)
@@ -367,6 +372,21 @@ namespace skyline::gpu::interconnect::maxwell3d {
         packedState.pointSize = engine->pointSize;
         packedState.openGlNdc = engine->zClipRange == engine::ZClipRange::NegativeWToPositiveW;
         packedState.SetDepthClampEnable(engine->viewportClipControl.geometryClip);
+
+        // Any dynamic state is moved out of the packed state so that pipelines only differing in it can be shared
+        if (packedState.dynamicStateActive) {
+            dynamicState.cullMode = vk::CullModeFlags{packedState.cullMode};
+            dynamicState.frontFace = packedState.frontFaceClockwise ? vk::FrontFace::eClockwise : vk::FrontFace::eCounterClockwise;
+            packedState.cullMode = {};
+            packedState.frontFaceClockwise = false;
+        }
+
+        if (packedState.dynamicState2Active) {
+            dynamicState.rasterizerDiscardEnable = packedState.rasterizerDiscardEnable;
+            dynamicState.depthBiasEnable = packedState.depthBiasEnable;
+            packedState.rasterizerDiscardEnable = false;
+            packedState.depthBiasEnable = false;
+        }
     }
 
     /* Depth Stencil State */
@@ -376,7 +396,7 @@ namespace skyline::gpu::interconnect::maxwell3d {
 
     DepthStencilState::DepthStencilState(dirty::Handle dirtyHandle, DirtyManager &manager, const EngineRegisters &engine) : engine{manager, dirtyHandle, engine} {}
 
-    void DepthStencilState::Flush(PackedPipelineState &packedState) {
+    void DepthStencilState::Flush(PackedPipelineState &packedState, ExtendedDynamicState &dynamicState) {
         packedState.depthTestEnable = engine->depthTestEnable;
         packedState.depthWriteEnable = engine->depthWriteEnable;
         packedState.SetDepthFunc(engine->depthTestEnable ? engine->depthFunc : engine::CompareFunc::OglAlways);
@@ -393,6 +413,25 @@ namespace skyline::gpu::interconnect::maxwell3d {
         packedState.alphaTestEnable = engine->alphaTestEnable;
         packedState.SetAlphaFunc(engine->alphaTestEnable ? engine->alphaFunc : engine::CompareFunc::OglAlways);
         packedState.alphaRef = engine->alphaTestEnable ? engine->alphaRef : 0;
+
+        if (packedState.dynamicStateActive) {
+            dynamicState.depthTestEnable = packedState.depthTestEnable;
+            dynamicState.depthWriteEnable = packedState.depthWriteEnable;
+            dynamicState.depthCompareOp = packedState.GetDepthFunc();
+            dynamicState.depthBoundsTestEnable = packedState.depthBoundsTestEnable;
+            dynamicState.stencilTestEnable = packedState.stencilTestEnable;
+            auto stencilOps{packedState.GetStencilOpsState()};
+            dynamicState.stencilFront = stencilOps[0];
+            dynamicState.stencilBack = stencilOps[1];
+
+            packedState.depthTestEnable = false;
+            packedState.depthWriteEnable = false;
+            packedState.depthFunc = 0;
+            packedState.depthBoundsTestEnable = false;
+            packedState.stencilTestEnable = false;
+            packedState.stencilFront = {};
+            packedState.stencilBack = {};
+        }
     };
 
     /* Color Blend State */
@@ -491,6 +530,7 @@ namespace skyline::gpu::interconnect::maxwell3d {
 
     void PipelineState::Flush(InterconnectContext &ctx, Textures &textures, ConstantBufferSet &constantBuffers, StateUpdateBuilder &builder) {
         packedState.dynamicStateActive = ctx.gpu.traits.supportsExtendedDynamicState;
+        packedState.dynamicState2Active = ctx.gpu.traits.supportsExtendedDynamicState2;
 
         std::array<ShaderBinary, engine::PipelineCount> shaderBinaries;
         for (size_t i{}; i < engine::PipelineCount; i++) {
@@ -515,14 +555,18 @@ namespace skyline::gpu::interconnect::maxwell3d {
             ctx.executor.AttachTexture(depthAttachment);
 
         vertexInput.Update(packedState);
-        directState.inputAssembly.Update(packedState);
+        directState.inputAssembly.Update(packedState, dynamicState);
         tessellation.Update(packedState);
-        rasterization.Update(packedState);
-        depthStencil.Update(packedState);
+        rasterization.Update(packedState, dynamicState);
+        depthStencil.Update(packedState, dynamicState);
         colorBlend.Update(packedState);
         transformFeedback.Update(packedState);
         globalShaderConfig.Update(packedState);
 
+        // Dynamic state is set every time the pipeline state is flushed as the pipeline state is always flushed after any state changes or command buffer boundaries
+        if (packedState.dynamicStateActive)
+            builder.SetExtendedDynamicState(dynamicState, packedState.dynamicState2Active);
+
         if (pipeline) {
             if (auto newPipeline{pipeline->LookupNext(packedState)}) {
                 pipeline = newPipeline;
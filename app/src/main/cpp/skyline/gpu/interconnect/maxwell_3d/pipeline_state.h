@@ -6,6 +6,7 @@
 #include <boost/container/static_vector.hpp>
 #include <gpu/texture/texture.h>
 #include <gpu/interconnect/common/shader_cache.h>
+#include <gpu/interconnect/common/state_updater.h>
 #include "common.h"
 #include "packed_pipeline_state.h"
 #include "pipeline_manager.h"
@@ -120,7 +121,7 @@ namespace skyline::gpu::interconnect::maxwell3d {
       public:
         InputAssemblyState(const EngineRegisters &engine);
 
-        void Update(PackedPipelineState &packedState);
+        void Update(PackedPipelineState &packedState, ExtendedDynamicState &dynamicState);
 
         void SetPrimitiveTopology(engine::DrawTopology topology);
 
@@ -181,7 +182,7 @@ namespace skyline::gpu::interconnect::maxwell3d {
 
         RasterizationState(dirty::Handle dirtyHandle, DirtyManager &manager, const EngineRegisters &engine);
 
-        void Flush(PackedPipelineState &packedState);
+        void Flush(PackedPipelineState &packedState, ExtendedDynamicState &dynamicState);
     };
 
     class DepthStencilState : dirty::ManualDirty {
@@ -208,7 +209,7 @@ namespace skyline::gpu::interconnect::maxwell3d {
       public:
         DepthStencilState(dirty::Handle dirtyHandle, DirtyManager &manager, const EngineRegisters &engine);
 
-        void Flush(PackedPipelineState &packedState);
+        void Flush(PackedPipelineState &packedState, ExtendedDynamicState &dynamicState);
     };
 
     class ColorBlendState : dirty::ManualDirty {
@@ -298,6 +299,7 @@ namespace skyline::gpu::interconnect::maxwell3d {
         PipelineManager pipelineManager{};
 
         PackedPipelineState packedState{};
+        ExtendedDynamicState dynamicState{}; //!< All pipeline state which is set dynamically rather than being a part of `packedState`
 
         dirty::BoundSubresource<EngineRegisters> engine;
 
@@ -0,0 +1,146 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#include <gpu.h>
+#include "pipeline_state_recorder.h"
+
+namespace skyline::gpu::interconnect::maxwell3d {
+    static constexpr std::string_view RecordingFileName{"pipelines/maxwell_3d.bin"}; //!< The path of the recording file relative to the title's cache directory
+
+    PipelineStateRecorder::PipelineStateRecorder(GPU &gpu) : gpu{gpu} {}
+
+    PipelineStateRecorder::~PipelineStateRecorder() {
+        prewarmStop = true;
+        for (auto &worker : prewarmWorkers)
+            if (worker.joinable())
+                worker.join();
+    }
+
+    void PipelineStateRecorder::PrewarmWorker(size_t workerIndex) {
+        if (int result{pthread_setname_np(pthread_self(), util::Format("Sky-PipeWarm-{}", workerIndex).c_str())})
+            Logger::Warn("Failed to set the thread name: {}", strerror(result));
+
+        for (size_t index{prewarmNextIndex++}; index < prewarmQueue.size() && !prewarmStop; index = prewarmNextIndex++) {
+            const auto &record{prewarmQueue[index]};
+            try {
+                if (auto cachedShaders{gpu.shader.LookupCachedShaders(HashShaderCompilationState(record.packedState))}) {
+                    std::optional<AttachmentMetadata> depthAttachment;
+                    if (record.depthAttachment.format != vk::Format::eUndefined)
+                        depthAttachment = record.depthAttachment;
+
+                    PrewarmedPipeline prewarmed{
+                        .pipeline = std::make_unique<Pipeline>(gpu, record.packedState, *cachedShaders, span{record.colorAttachments}.first(record.colorAttachmentCount), depthAttachment),
+                        .environment = cachedShaders->environment,
+                    };
+
+                    std::scoped_lock lock{prewarmMutex};
+                    prewarmedPipelines.try_emplace(record.packedState, std::move(prewarmed));
+                }
+            } catch (const std::exception &e) {
+                Logger::Warn("Failed to pre-warm pipeline: {}", e.what());
+            }
+
+            size_t completed{++prewarmCompletedCount};
+            if (completed == prewarmQueue.size()) {
+                std::scoped_lock lock{prewarmMutex};
+                Logger::Info("Finished pre-warming {} pipelines out of {} recorded", prewarmedPipelines.size(), prewarmQueue.size());
+            } else if (completed % 100 == 0) {
+                Logger::Info("Pre-warming pipelines: {}/{}", completed, prewarmQueue.size());
+            }
+        }
+    }
+
+    void PipelineStateRecorder::Load(const std::shared_ptr<vfs::FileSystem> &cacheFileSystem) {
+        RecordingHeader expectedHeader{};
+
+        {
+            std::scoped_lock lock{recordingMutex};
+            std::string fileName{RecordingFileName};
+            try {
+                if (!cacheFileSystem->FileExists(fileName) && !cacheFileSystem->CreateFile(fileName, 0))
+                    throw exception("Failed to create pipeline state recording file");
+
+                recordingBacking = cacheFileSystem->OpenFile(fileName, {true, true, true});
+
+                size_t validSize{};
+                if (recordingBacking->size >= sizeof(RecordingHeader) && recordingBacking->Read<RecordingHeader>() == expectedHeader) {
+                    size_t recordCount{(recordingBacking->size - sizeof(RecordingHeader)) / sizeof(RecordedPipeline)};
+                    prewarmQueue.resize(recordCount);
+                    recordingBacking->Read(span{prewarmQueue}.cast<u8>(), sizeof(RecordingHeader));
+
+                    // Records are used until the first invalid one, anything after it is likely from an interrupted write and is discarded
+                    auto firstInvalid{std::find_if(prewarmQueue.begin(), prewarmQueue.end(), [](const RecordedPipeline &record) {
+                        return record.colorAttachmentCount > engine::ColorTargetCount || XXH64(&record, offsetof(RecordedPipeline, hash), 0) != record.hash;
+                    })};
+                    prewarmQueue.erase(firstInvalid, prewarmQueue.end());
+
+                    for (const auto &record : prewarmQueue)
+                        recordedHashes.insert(record.hash);
+
+                    validSize = sizeof(RecordingHeader) + (prewarmQueue.size() * sizeof(RecordedPipeline));
+                    Logger::Info("Loaded {} recorded pipelines", prewarmQueue.size());
+                }
+
+                if (validSize != recordingBacking->size) {
+                    if (!validSize) {
+                        recordingBacking->Resize(0);
+                        recordingBacking->Write(span<RecordingHeader>{expectedHeader}.cast<u8>());
+                    } else {
+                        recordingBacking->Resize(validSize);
+                    }
+                }
+            } catch (const std::exception &e) {
+                Logger::Warn("Failed to load pipeline state recording: {}", e.what());
+                prewarmQueue.clear();
+                recordedHashes.clear();
+                recordingBacking = nullptr;
+            }
+        }
+
+        if (prewarmQueue.empty())
+            return;
+
+        // Only half of the cores are used for pre-warming as the title is running concurrently and shouldn't be starved of CPU time
+        size_t workerCount{std::min<size_t>(std::max(std::thread::hardware_concurrency() / 2, 1U), prewarmQueue.size())};
+        for (size_t i{}; i < workerCount; i++)
+            prewarmWorkers.emplace_back(&PipelineStateRecorder::PrewarmWorker, this, i);
+    }
+
+    void PipelineStateRecorder::Record(const PackedPipelineState &packedState, span<TextureView *> colorAttachments, TextureView *depthAttachment) {
+        std::scoped_lock lock{recordingMutex};
+        if (!recordingBacking)
+            return;
+
+        RecordedPipeline record{};
+        std::memcpy(&record.packedState, &packedState, sizeof(PackedPipelineState));
+        std::copy(colorAttachments.begin(), colorAttachments.end(), record.colorAttachments.begin());
+        record.depthAttachment = AttachmentMetadata{depthAttachment};
+        record.colorAttachmentCount = static_cast<u32>(colorAttachments.size());
+        record.hash = XXH64(&record, offsetof(RecordedPipeline, hash), 0);
+
+        if (!recordedHashes.insert(record.hash).second)
+            return;
+
+        try {
+            recordingBacking->Write(span<RecordedPipeline>{record}.cast<u8>(), recordingBacking->size);
+        } catch (const std::exception &e) {
+            Logger::Warn("Failed to write to pipeline state recording, disabling it: {}", e.what());
+            recordingBacking = nullptr;
+        }
+    }
+
+    PipelineStateRecorder::PrewarmedPipeline PipelineStateRecorder::Take(const PackedPipelineState &packedState) {
+        std::scoped_lock lock{prewarmMutex};
+        auto it{prewarmedPipelines.find(packedState)};
+        if (it == prewarmedPipelines.end())
+            return {};
+
+        auto prewarmed{std::move(it.value())};
+        prewarmedPipelines.erase(it);
+        return prewarmed;
+    }
+
+    std::pair<size_t, size_t> PipelineStateRecorder::GetPrewarmProgress() const {
+        return {prewarmCompletedCount.load(), prewarmQueue.size()};
+    }
+}
@@ -0,0 +1,100 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#pragma once
+
+#include <unordered_set>
+#include <tsl/robin_map.h>
+#include <vfs/filesystem.h>
+#include "pipeline_manager.h"
+
+namespace skyline::gpu::interconnect::maxwell3d {
+    /**
+     * @brief Records the state of every pipeline created by a title to disk and replays the recorded states on subsequent boots to build pipelines on background threads before the title requires them
+     * @note Pipelines can only be pre-warmed if their shaders are present in the on-disk shader cache as the guest shader binaries aren't recorded
+     */
+    class PipelineStateRecorder {
+      public:
+        using AttachmentMetadata = cache::GraphicsPipelineCache::AttachmentMetadata;
+
+        /**
+         * @brief A pipeline which was built during pre-warming and hasn't been used by the title yet
+         */
+        struct PrewarmedPipeline {
+            std::unique_ptr<Pipeline> pipeline;
+            ShaderManager::EnvironmentRecord environment; //!< The guest state the pipeline's shaders were translated with, this must be validated before the pipeline is used
+        };
+
+      private:
+        /**
+         * @brief The header at the start of the recording file, it is used to reject recordings with an incompatible layout
+         */
+        struct RecordingHeader {
+            static constexpr u32 Magic{util::MakeMagic<u32>("SPSR")}; //!< "Skyline Pipeline State Recording"
+            static constexpr u32 Version{2}; //!< The version of the recording format, this must be incremented when the format changes
+
+            u32 magic{Magic};
+            u32 version{Version};
+            u32 packedStateSize{sizeof(PackedPipelineState)}; //!< The size of the packed pipeline state, this catches any layout changes which weren't accompanied by a version bump
+            u32 _pad_{};
+
+            bool operator==(const RecordingHeader &) const = default;
+        };
+
+        /**
+         * @brief A single recorded pipeline, these are appended to the recording file back-to-back after the header
+         */
+        struct RecordedPipeline {
+            PackedPipelineState packedState;
+            std::array<AttachmentMetadata, engine::ColorTargetCount> colorAttachments;
+            AttachmentMetadata depthAttachment; //!< The depth/stencil attachment of the pipeline, this has an undefined format if there is none
+            u32 colorAttachmentCount;
+            u32 _pad_;
+            u64 hash; //!< An XXH64 hash of all fields prior to this one, it is used to detect partially written records
+        };
+
+        GPU &gpu;
+
+        std::mutex recordingMutex; //!< Synchronizes all accesses to the recording file and the set of recorded pipelines
+        std::shared_ptr<vfs::Backing> recordingBacking; //!< The backing of the recording file, this is null if no recording is in use
+        std::unordered_set<u64> recordedHashes; //!< The hashes of all recorded pipelines, this avoids recording the same pipeline multiple times
+
+        std::mutex prewarmMutex; //!< Synchronizes all accesses to the prewarmed pipeline map
+        tsl::robin_map<PackedPipelineState, PrewarmedPipeline, PackedPipelineStateHash> prewarmedPipelines;
+
+        std::vector<RecordedPipeline> prewarmQueue; //!< All recorded pipelines that are pending pre-warming, this is immutable while the workers are running
+        std::atomic<size_t> prewarmNextIndex{}; //!< The index of the next pipeline in the queue to be pre-warmed
+        std::atomic<size_t> prewarmCompletedCount{}; //!< The amount of pipelines in the queue that have been processed
+        std::atomic<bool> prewarmStop{}; //!< If the workers should stop pre-warming as soon as possible
+        std::vector<std::thread> prewarmWorkers;
+
+        void PrewarmWorker(size_t workerIndex);
+
+      public:
+        PipelineStateRecorder(GPU &gpu);
+
+        ~PipelineStateRecorder();
+
+        /**
+         * @brief Loads the recording from the supplied filesystem and starts pre-warming all recorded pipelines in the background, any new pipelines will be appended to the recording from this point onwards
+         * @note The on-disk shader cache must be loaded prior to calling this for any pipelines to be pre-warmed
+         */
+        void Load(const std::shared_ptr<vfs::FileSystem> &cacheFileSystem);
+
+        /**
+         * @brief Records a newly created pipeline for pre-warming on subsequent boots
+         */
+        void Record(const PackedPipelineState &packedState, span<TextureView *> colorAttachments, TextureView *depthAttachment);
+
+        /**
+         * @brief Transfers ownership of a pre-warmed pipeline matching the supplied state to the caller, if one exists
+         * @return The pre-warmed pipeline alongside the environment that must be validated prior to its use, the pipeline is null if no matching pipeline has been pre-warmed
+         */
+        PrewarmedPipeline Take(const PackedPipelineState &packedState);
+
+        /**
+         * @return The amount of pipelines that have been processed by pre-warming and the total amount of pipelines queued for pre-warming
+         */
+        std::pair<size_t, size_t> GetPrewarmProgress() const;
+    };
+}
@@ -0,0 +1,172 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#include <gpu/interconnect/command_executor.h>
+#include <gpu/buffer_manager.h>
+#include <soc/gm20b/channel.h>
+#include "queries.h"
+
+namespace skyline::gpu::interconnect::maxwell3d {
+    Queries::Queries(GPU &gpu) {
+        auto createPool{[&](Counter counter, vk::QueryType type, vk::QueryPipelineStatisticFlags statistics, vk::QueryControlFlags controlFlags) {
+            auto &state{GetCounter(counter)};
+            state.pool.emplace(gpu.vkDevice, vk::QueryPoolCreateInfo{
+                .queryType = type,
+                .queryCount = QueryPoolSize,
+                .pipelineStatistics = statistics,
+            });
+            state.controlFlags = controlFlags;
+        }};
+
+        createPool(Counter::SamplesPassed, vk::QueryType::eOcclusion, {}, gpu.traits.supportsOcclusionQueryPrecise ? vk::QueryControlFlagBits::ePrecise : vk::QueryControlFlags{});
+
+        // Primitives reaching the clipper are those output from the last pre-rasterization stage
+        if (gpu.traits.supportsPipelineStatisticsQuery)
+            createPool(Counter::PrimitivesGenerated, vk::QueryType::ePipelineStatistics, vk::QueryPipelineStatisticFlagBits::eClippingInvocations, {});
+    }
+
+    void Queries::UpdateExecutorQueryState(InterconnectContext &ctx) {
+        ctx.executor.queryActive = std::any_of(counters.begin(), counters.end(), [](const CounterState &state) { return state.activeQuery.has_value(); });
+    }
+
+    void Queries::BeginQuery(InterconnectContext &ctx, CounterState &state) {
+        u32 index{state.nextQuery};
+        state.nextQuery = (state.nextQuery + 1) % QueryPoolSize;
+        state.activeQuery = index;
+        state.pendingBegin = false;
+
+        ctx.executor.AddOutsideRpCommand([pool = **state.pool, index, controlFlags = state.controlFlags](vk::raii::CommandBuffer &commandBuffer, const IntrusivePtr<FenceCycle> &, GPU &) {
+            commandBuffer.resetQueryPool(pool, index, 1);
+            commandBuffer.beginQuery(pool, index, controlFlags);
+        });
+        UpdateExecutorQueryState(ctx);
+    }
+
+    void Queries::EndQuery(InterconnectContext &ctx, CounterState &state) {
+        if (!state.activeQuery)
+            return;
+
+        u32 index{*state.activeQuery};
+        ctx.executor.AddOutsideRpCommand([pool = **state.pool, index](vk::raii::CommandBuffer &commandBuffer, const IntrusivePtr<FenceCycle> &, GPU &) {
+            commandBuffer.endQuery(pool, index);
+        });
+
+        state.endedQueries.push_back(EndedQuery{index, ctx.executor.executionNumber});
+        state.activeQuery.reset();
+        UpdateExecutorQueryState(ctx);
+    }
+
+    void Queries::Reset(InterconnectContext &ctx, Counter counter) {
+        auto &state{GetCounter(counter)};
+        if (!state.pool)
+            return;
+
+        // The results of any prior queries are irrelevant after a reset, an active query is ended lazily on the next draw as a new query is begun then
+        if (state.activeQuery) {
+            EndQuery(ctx, state);
+            state.pendingBegin = state.enabled;
+        }
+
+        state.endedQueries.clear();
+        state.resolvedValue = 0;
+    }
+
+    void Queries::SetEnabled(InterconnectContext &ctx, Counter counter, bool enabled) {
+        auto &state{GetCounter(counter)};
+        if (!state.pool || state.enabled == enabled)
+            return;
+
+        state.enabled = enabled;
+        if (enabled)
+            state.pendingBegin = true;
+        else if (state.activeQuery)
+            EndQuery(ctx, state);
+        else
+            state.pendingBegin = false;
+    }
+
+    void Queries::PrepareDraw(InterconnectContext &ctx) {
+        for (auto &state : counters)
+            if (state.pendingBegin)
+                BeginQuery(ctx, state);
+    }
+
+    void Queries::EndExecution(InterconnectContext &ctx) {
+        for (auto &state : counters) {
+            if (state.activeQuery) {
+                EndQuery(ctx, state);
+                state.pendingBegin = true;
+            }
+        }
+    }
+
+    bool Queries::Report(InterconnectContext &ctx, Counter counter, u64 address, bool fourWords, u64 timestamp) {
+        auto &state{GetCounter(counter)};
+        if (!state.pool)
+            return false;
+
+        // The query can't be left active as its results would be unavailable, a new query is begun on the next draw to continue counting
+        if (state.activeQuery) {
+            EndQuery(ctx, state);
+            state.pendingBegin = true;
+        }
+
+        // Only a single query covering the entire period since the last reset can be copied directly into guest memory
+        if (state.endedQueries.size() != 1 || state.resolvedValue || state.endedQueries.front().executionNumber != ctx.executor.executionNumber)
+            return false;
+
+        vk::DeviceSize size{fourWords ? sizeof(u64) * 2 : sizeof(u32)};
+        auto mappings{ctx.channelCtx.asCtx->gmmu.TranslateRange(address, size)};
+        if (mappings.size() != 1 || mappings.front().size() != size)
+            return false;
+
+        auto dstBuf{ctx.gpu.buffer.FindOrCreate(mappings.front(), ctx.executor.tag, [&ctx](std::shared_ptr<Buffer> buffer, ContextLock<Buffer> &&lock) {
+            ctx.executor.AttachLockedBuffer(buffer, std::move(lock));
+        })};
+        ContextLock dstBufLock{ctx.executor.tag, dstBuf};
+        ctx.executor.AttachLockedBufferView(dstBuf, std::move(dstBufLock));
+
+        // The buffer contents are written on the GPU so any CPU accesses must first wait on it
+        dstBuf.GetBuffer()->BlockAllCpuBackingWrites();
+        dstBuf.GetBuffer()->MarkGpuDirty();
+
+        u32 index{state.endedQueries.front().index};
+        ctx.executor.AddTransferCommand([pool = **state.pool, index, dstBuf, fourWords, timestamp](vk::raii::CommandBuffer &commandBuffer, const IntrusivePtr<FenceCycle> &, GPU &) {
+            vk::Buffer buffer{dstBuf.GetBuffer()->GetBacking()};
+            vk::DeviceSize offset{dstBuf.GetOffset()};
+
+            // The values are written in the same order as the hardware to ensure that the timestamp is never newer than the value
+            commandBuffer.copyQueryPoolResults(pool, index, 1, buffer, offset, fourWords ? sizeof(u64) : sizeof(u32), vk::QueryResultFlagBits::eWait | (fourWords ? vk::QueryResultFlagBits::e64 : vk::QueryResultFlags{}));
+            if (fourWords)
+                commandBuffer.updateBuffer<u64>(buffer, offset + sizeof(u64), timestamp);
+        }, {ResourceAccess::Of(dstBuf, true)});
+
+        return true;
+    }
+
+    u64 Queries::Resolve(InterconnectContext &ctx, Counter counter) {
+        auto &state{GetCounter(counter)};
+        if (!state.pool)
+            return 0;
+
+        if (state.activeQuery) {
+            EndQuery(ctx, state);
+            state.pendingBegin = true;
+        }
+
+        // Queries can only be waited on after they've been submitted, prior executions have already been submitted so waiting on them doesn't require a flush
+        if (std::any_of(state.endedQueries.begin(), state.endedQueries.end(), [&](const EndedQuery &query) { return query.executionNumber == ctx.executor.executionNumber; }))
+            ctx.executor.Submit();
+
+        for (const auto &query : state.endedQueries) {
+            auto [result, value]{state.pool->getResult<u64>(query.index, 1, sizeof(u64), vk::QueryResultFlagBits::e64 | vk::QueryResultFlagBits::eWait)};
+            if (result != vk::Result::eSuccess)
+                Logger::Warn("Failed to get query result: {}", vk::to_string(result));
+            else
+                state.resolvedValue += value;
+        }
+        state.endedQueries.clear();
+
+        return state.resolvedValue;
+    }
+}
@@ -0,0 +1,102 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#pragma once
+
+#include "common.h"
+
+namespace skyline::gpu::interconnect::maxwell3d {
+    /**
+     * @brief Emulates Maxwell 3D report counters using host queries, allowing their values to be written into guest memory on the GPU without waiting on it
+     * @note Host queries are begun outside of render passes and cover all work recorded until the counter is reported, disabled or the execution is submitted, counters that are covered by more than a single query are resolved on the CPU by summing the results of all their queries
+     */
+    class Queries {
+      public:
+        enum class Counter {
+            SamplesPassed, //!< The amount of samples that passed the depth and stencil tests
+            PrimitivesGenerated, //!< The amount of primitives that were output from the last pre-rasterization stage
+            Count,
+        };
+
+      private:
+        static constexpr u32 QueryPoolSize{0x1000}; //!< The amount of queries in the pool for each counter, these are allocated in a ring and as such this bounds the amount of queries that can be in-flight
+
+        /**
+         * @brief A query that has been ended but has yet to be accumulated into the resolved value of the counter
+         */
+        struct EndedQuery {
+            u32 index;
+            u32 executionNumber; //!< The executor execution that the query was recorded in
+        };
+
+        struct CounterState {
+            std::optional<vk::raii::QueryPool> pool; //!< The host query pool backing the counter, this is empty if the counter is unsupported on the host
+            vk::QueryControlFlags controlFlags;
+            u32 nextQuery{}; //!< The index of the next query in the pool to be allocated
+            std::optional<u32> activeQuery; //!< The index of the query that was begun in the current execution, if any
+            std::vector<EndedQuery> endedQueries; //!< Queries ended since the counter was last reset or resolved
+            u64 resolvedValue{}; //!< The value that the counter had accumulated from queries which have already been resolved on the CPU
+            bool enabled{}; //!< If the counter is incrementing
+            bool pendingBegin{}; //!< If a query needs to be begun prior to the next draw
+        };
+
+        std::array<CounterState, static_cast<size_t>(Counter::Count)> counters;
+
+        CounterState &GetCounter(Counter counter) {
+            return counters[static_cast<size_t>(counter)];
+        }
+
+        /**
+         * @brief Updates if the executor has any query active so that it can avoid recording render passes in a way that doesn't support them
+         */
+        void UpdateExecutorQueryState(InterconnectContext &ctx);
+
+        void BeginQuery(InterconnectContext &ctx, CounterState &state);
+
+        void EndQuery(InterconnectContext &ctx, CounterState &state);
+
+      public:
+        Queries(GPU &gpu);
+
+        /**
+         * @return If the supplied counter is emulated with host queries
+         */
+        bool IsSupported(Counter counter) {
+            return GetCounter(counter).pool.has_value();
+        }
+
+        /**
+         * @brief Resets the value of the counter to zero
+         */
+        void Reset(InterconnectContext &ctx, Counter counter);
+
+        /**
+         * @brief Sets if the counter should increment for any following work
+         */
+        void SetEnabled(InterconnectContext &ctx, Counter counter, bool enabled);
+
+        /**
+         * @brief Begins queries for any enabled counters which aren't currently active, this must be called prior to recording any draws
+         */
+        void PrepareDraw(InterconnectContext &ctx);
+
+        /**
+         * @brief Ends all active queries as they cannot straddle command buffers, they'll be begun again in the next execution on the next draw
+         * @note This must be called prior to submitting the executor and after all draws have been recorded
+         */
+        void EndExecution(InterconnectContext &ctx);
+
+        /**
+         * @brief Records writing the current value of the counter into guest memory on the GPU in the Maxwell semaphore layout
+         * @param timestamp The timestamp to write alongside the value for four word semaphores
+         * @return If the value could be written on the GPU, Resolve must be used to get the value on the CPU instead if this is false
+         */
+        bool Report(InterconnectContext &ctx, Counter counter, u64 address, bool fourWords, u64 timestamp);
+
+        /**
+         * @brief Waits on all queries of the counter and returns its current value
+         * @note The executor will be submitted if any of the queries were recorded in the current execution
+         */
+        u64 Resolve(InterconnectContext &ctx, Counter counter);
+    };
+}
@@ -3,6 +3,7 @@
 // Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
 
 #include <gpu/buffer_manager.h>
+#include <gpu/texture_manager.h>
 #include <soc/gm20b/gmmu.h>
 #include <soc/gm20b/channel.h>
 #include "maxwell_dma.h"
@@ -40,22 +41,89 @@ namespace skyline::gpu::interconnect {
             srcBuf.GetBuffer()->BlockAllCpuBackingWrites();
             dstBuf.GetBuffer()->BlockAllCpuBackingWrites();
 
-            executor.AddOutsideRpCommand([srcBuf, dstBuf](vk::raii::CommandBuffer &commandBuffer, const std::shared_ptr<FenceCycle> &, GPU &) {
-                commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eAllCommands, vk::PipelineStageFlagBits::eTransfer, {}, vk::MemoryBarrier{
-                    .srcAccessMask = vk::AccessFlagBits::eMemoryRead,
-                    .dstAccessMask = vk::AccessFlagBits::eTransferRead | vk::AccessFlagBits::eTransferWrite
-                }, {}, {});
+            executor.AddTransferCommand([srcBuf, dstBuf](vk::raii::CommandBuffer &commandBuffer, const IntrusivePtr<FenceCycle> &, GPU &) {
                 vk::BufferCopy copyRegion{
                     .size = srcBuf.size,
                     .srcOffset = srcBuf.GetOffset(),
                     .dstOffset = dstBuf.GetOffset()
                 };
                 commandBuffer.copyBuffer(srcBuf.GetBuffer()->GetBacking(), dstBuf.GetBuffer()->GetBacking(), copyRegion);
-                commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eAllCommands, {}, vk::MemoryBarrier{
-                    .srcAccessMask = vk::AccessFlagBits::eTransferWrite,
-                    .dstAccessMask = vk::AccessFlagBits::eMemoryRead | vk::AccessFlagBits::eMemoryWrite,
-                }, {}, {});
-            });
+            }, {ResourceAccess::Of(srcBuf, false), ResourceAccess::Of(dstBuf, true)}, TimestampCategory::Dma);
         });
     }
+
+    bool MaxwellDma::CopyPitchTexture(IOVA pitchAddress, IOVA blockLinearAddress, texture::Dimensions surfaceDimensions, u32 lineCount, u32 bytesPerPixel, size_t blockHeight, size_t blockDepth, size_t layerSize, bool toTexture) {
+        // Buffer offsets in buffer-image copies must be a multiple of the texel size, buffers always start at page-aligned addresses so this only depends on the guest address
+        if (pitchAddress % bytesPerPixel)
+            return false;
+
+        auto textureMappings{channelCtx.asCtx->gmmu.TranslateRange(blockLinearAddress, layerSize)};
+        if (textureMappings.size() != 1 || !textureMappings.front().valid())
+            return false;
+
+        auto texture{gpu.texture.Lookup(textureMappings.front())};
+        if (!texture)
+            return false;
+
+        // The texture must have the exact layout of the DMA surface and store the raw guest data without any host conversions for the copy to be a plain copy of texels
+        const auto &guest{*texture->guest};
+        if (guest.tileConfig.mode != texture::TileMode::Block || guest.tileConfig.blockHeight != blockHeight || guest.tileConfig.blockDepth != blockDepth ||
+            guest.dimensions.width != surfaceDimensions.width || guest.dimensions.height != surfaceDimensions.height || guest.dimensions.depth != 1 ||
+            guest.format->IsCompressed() || guest.format->bpb != bytesPerPixel || texture->format->vkFormat != guest.format->vkFormat ||
+            !(guest.format->vkAspect & vk::ImageAspectFlagBits::eColor) || texture->IsScaled() || lineCount > surfaceDimensions.height)
+            return false;
+
+        auto pitchMappings{channelCtx.asCtx->gmmu.TranslateRange(pitchAddress, static_cast<size_t>(surfaceDimensions.width) * lineCount * bytesPerPixel)};
+        if (pitchMappings.size() != 1 || !pitchMappings.front().valid())
+            return false;
+
+        auto pitchBuf{gpu.buffer.FindOrCreate(pitchMappings.front(), executor.tag, [this](std::shared_ptr<Buffer> buffer, ContextLock<Buffer> &&lock) {
+            executor.AttachLockedBuffer(buffer, std::move(lock));
+        })};
+        ContextLock pitchBufLock{executor.tag, pitchBuf};
+        executor.AttachLockedBufferView(pitchBuf, std::move(pitchBufLock));
+
+        auto textureView{texture->GetView(vk::ImageViewType::e2D, vk::ImageSubresourceRange{
+            .aspectMask = vk::ImageAspectFlagBits::eColor,
+            .levelCount = 1,
+            .layerCount = 1,
+        })};
+        executor.AttachDependency(textureView);
+        executor.AttachTexture(textureView.get());
+
+        if (toTexture) {
+            pitchBuf.GetBuffer()->BlockSequencedCpuBackingWrites();
+        } else {
+            // This will prevent any CPU accesses to backing for the duration of the usage
+            pitchBuf.GetBuffer()->BlockAllCpuBackingWrites();
+            pitchBuf.GetBuffer()->MarkGpuDirty();
+        }
+
+        vk::BufferImageCopy region{
+            .imageSubresource = {
+                .aspectMask = vk::ImageAspectFlagBits::eColor,
+                .layerCount = 1,
+            },
+            .imageExtent = {surfaceDimensions.width, lineCount, 1},
+        };
+
+        executor.AddTransferCommand([pitchBuf, textureView, region, toTexture](vk::raii::CommandBuffer &commandBuffer, const IntrusivePtr<FenceCycle> &, GPU &) mutable {
+            region.bufferOffset = pitchBuf.GetOffset();
+            // All attached textures are kept in the general layout during executions
+            if (toTexture)
+                commandBuffer.copyBufferToImage(pitchBuf.GetBuffer()->GetBacking(), textureView->texture->GetBacking(), vk::ImageLayout::eGeneral, region);
+            else
+                commandBuffer.copyImageToBuffer(textureView->texture->GetBacking(), vk::ImageLayout::eGeneral, pitchBuf.GetBuffer()->GetBacking(), region);
+        }, {ResourceAccess::Of(pitchBuf, !toTexture), ResourceAccess::Of(texture.get(), toTexture)}, TimestampCategory::Dma);
+
+        return true;
+    }
+
+    bool MaxwellDma::CopyPitchToBlockLinear(IOVA src, IOVA dst, texture::Dimensions dstDimensions, u32 lineCount, u32 bytesPerPixel, size_t blockHeight, size_t blockDepth, size_t layerSize) {
+        return CopyPitchTexture(src, dst, dstDimensions, lineCount, bytesPerPixel, blockHeight, blockDepth, layerSize, true);
+    }
+
+    bool MaxwellDma::CopyBlockLinearToPitch(IOVA src, IOVA dst, texture::Dimensions srcDimensions, u32 lineCount, u32 bytesPerPixel, size_t blockHeight, size_t blockDepth, size_t layerSize) {
+        return CopyPitchTexture(dst, src, srcDimensions, lineCount, bytesPerPixel, blockHeight, blockDepth, layerSize, false);
+    }
 }
@@ -5,6 +5,7 @@
 #pragma once
 
 #include <soc/gm20b/gmmu.h>
+#include <gpu/texture/texture.h>
 
 namespace skyline::gpu {
     class GPU;
@@ -28,9 +29,28 @@ namespace skyline::gpu::interconnect {
         soc::gm20b::ChannelContext &channelCtx;
         gpu::interconnect::CommandExecutor &executor;
 
+        /**
+         * @brief Copies between a pitch linear region of guest memory and a block linear texture that's resident on the host
+         * @param toTexture If the copy is from the pitch linear region into the texture rather than the other way around
+         * @return If the copy was recorded, this is false if there's no matching host texture or the copy can't be represented on the GPU
+         */
+        bool CopyPitchTexture(IOVA pitchAddress, IOVA blockLinearAddress, texture::Dimensions surfaceDimensions, u32 lineCount, u32 bytesPerPixel, size_t blockHeight, size_t blockDepth, size_t layerSize, bool toTexture);
+
       public:
         MaxwellDma(GPU &gpu, soc::gm20b::ChannelContext &channelCtx);
 
         void Copy(IOVA dst, IOVA src, size_t size);
+
+        /**
+         * @brief Copies a pitch linear region of guest memory into the first layer of a host texture on the GPU
+         * @return If the copy was recorded, the caller is expected to perform the copy on the CPU otherwise
+         */
+        bool CopyPitchToBlockLinear(IOVA src, IOVA dst, texture::Dimensions dstDimensions, u32 lineCount, u32 bytesPerPixel, size_t blockHeight, size_t blockDepth, size_t layerSize);
+
+        /**
+         * @brief Copies the first layer of a host texture into a pitch linear region of guest memory on the GPU
+         * @return If the copy was recorded, the caller is expected to perform the copy on the CPU otherwise
+         */
+        bool CopyBlockLinearToPitch(IOVA src, IOVA dst, texture::Dimensions srcDimensions, u32 lineCount, u32 bytesPerPixel, size_t blockHeight, size_t blockDepth, size_t layerSize);
     };
 }
@@ -2,68 +2,78 @@
 // Copyright © 2021 Skyline Team and Contributors (https://github.com/skyline-emu/)
 
 #include <gpu.h>
+#include <common/trace.h>
 #include "megabuffer.h"
 
 namespace skyline::gpu {
-    MegaBufferChunk::MegaBufferChunk(GPU &gpu) : backing{gpu.memory.AllocateBuffer(MegaBufferChunkSize)}, freeRegion{backing.subspan(PAGE_SIZE)} {}
+    MegaBufferAllocator::MegaBufferAllocator(GPU &gpu) : gpu{gpu}, backing{gpu.memory.AllocateBuffer(MegaBufferRingSize, MemoryCategory::MegaBuffer)}, head{PAGE_SIZE} {}
 
-    bool MegaBufferChunk::TryReset() {
-        if (cycle && cycle->Poll(true)) {
-            freeRegion = backing.subspan(PAGE_SIZE);
-            cycle = nullptr;
-            return true;
-        }
+    bool MegaBufferAllocator::ReleaseSegment(const IntrusivePtr<FenceCycle> &cycle) {
+        auto &segment{segments.front()};
+        if (segment.cycle == cycle)
+            return false;
 
-        return cycle == nullptr;
-    }
+        if (!segment.cycle->Poll(true)) {
+            TRACE_EVENT("gpu", "MegaBufferAllocator::WaitOnFence");
+            segment.cycle->Wait();
+        }
 
-    vk::Buffer MegaBufferChunk::GetBacking() const {
-        return backing.vkBuffer;
+        segments.pop_front();
+        return true;
     }
 
-    std::pair<vk::DeviceSize, span<u8>> MegaBufferChunk::Allocate(const std::shared_ptr<FenceCycle> &newCycle, vk::DeviceSize size, bool pageAlign) {
-        if (pageAlign) {
-            // If page aligned data was requested then align the free
-            auto alignedFreeBase{util::AlignUp(static_cast<size_t>(freeRegion.data() - backing.data()), PAGE_SIZE)};
-            freeRegion = backing.subspan(alignedFreeBase);
+    MegaBufferAllocator::Allocation MegaBufferAllocator::Allocate(const IntrusivePtr<FenceCycle> &cycle, vk::DeviceSize size, bool pageAlign) {
+        auto allocateStandalone{[&]() -> Allocation {
+            // The first page is skipped so that the offset of the allocation is never zero, matching allocations within the ring
+            Logger::Debug("Megabuffer ring exhausted, allocating standalone buffer for size: 0x{:X}", size);
+            auto buffer{std::make_shared<memory::Buffer>(gpu.memory.AllocateBuffer(PAGE_SIZE + size, MemoryCategory::MegaBuffer))};
+            cycle->AttachObject(buffer);
+            return {buffer->vkBuffer, PAGE_SIZE, buffer->subspan(PAGE_SIZE, size)};
+        }};
+
+        if (size > MegaBufferRingSize - PAGE_SIZE) [[unlikely]]
+            return allocateStandalone();
+
+        if (!size)
+            return {backing.vkBuffer, head, {}};
+
+        vk::DeviceSize start{head}, offset{pageAlign ? util::AlignUp(head, PAGE_SIZE) : head};
+        if (offset + size > MegaBufferRingSize) {
+            // Wrap around to the start of the ring, any segments from the previous lap past the head are skipped over and need to be released first
+            while (!segments.empty() && segments.front().begin >= head)
+                if (!ReleaseSegment(cycle))
+                    return allocateStandalone();
+            start = offset = PAGE_SIZE;
         }
 
-        if (size > freeRegion.size())
-            return {0, {}};
-
-        if (cycle != newCycle) {
-            newCycle->ChainCycle(cycle);
-            cycle = newCycle;
+        // Release any segments from the previous lap which overlap the allocation or any padding before it, these are always the oldest segments
+        while (!segments.empty() && segments.front().begin < offset + size && segments.front().end > start)
+            if (!ReleaseSegment(cycle))
+                return allocateStandalone();
+
+        if (!segments.empty() && segments.back().cycle == cycle && offset >= segments.back().end) {
+            segments.back().end = offset + size;
+        } else {
+            // Chaining the previous cycle ensures that segments are always signalled in the order they were allocated in
+            if (!segments.empty())
+                cycle->ChainCycle(segments.back().cycle);
+            segments.push_back({cycle, offset, offset + size});
         }
 
-        // Allocate space for data from the free region
-        auto resultSpan{freeRegion.subspan(0, size)};
-
-        // Move the free region along
-        freeRegion = freeRegion.subspan(size);
-
-        return {static_cast<vk::DeviceSize>(resultSpan.data() - backing.data()), resultSpan};
+        head = offset + size;
+        return {backing.vkBuffer, offset, backing.subspan(offset, size)};
     }
 
-    MegaBufferAllocator::MegaBufferAllocator(GPU &gpu) : gpu{gpu}, activeChunk{chunks.emplace(chunks.end(), gpu)} {}
-
-    MegaBufferAllocator::Allocation MegaBufferAllocator::Allocate(const std::shared_ptr<FenceCycle> &cycle, vk::DeviceSize size, bool pageAlign) {
-        if (auto allocation{activeChunk->Allocate(cycle, size, pageAlign)}; allocation.first)
-            return {activeChunk->GetBacking(), allocation.first, allocation.second};
-
-        activeChunk = ranges::find_if(chunks, [&](auto &chunk) { return chunk.TryReset(); });
-        if (activeChunk == chunks.end()) // If there are no chunks available, allocate a new one
-            activeChunk = chunks.emplace(chunks.end(), gpu);
-
-        if (auto allocation{activeChunk->Allocate(cycle, size, pageAlign)}; allocation.first)
-            return {activeChunk->GetBacking(), allocation.first, allocation.second};
-        else
-            throw exception("Failed to to allocate megabuffer space for size: 0x{:X}", size);
-    }
-
-    MegaBufferAllocator::Allocation MegaBufferAllocator::Push(const std::shared_ptr<FenceCycle> &cycle, span<u8> data, bool pageAlign) {
+    MegaBufferAllocator::Allocation MegaBufferAllocator::Push(const IntrusivePtr<FenceCycle> &cycle, span<u8> data, bool pageAlign) {
         auto allocation{Allocate(cycle, data.size(), pageAlign)};
         allocation.region.copy_from(data);
+        gpu.syncTraffic.Record(SyncTrafficSource::MegaBufferPush, data.size());
         return allocation;
     }
+
+    void MegaBufferAllocator::Trim() {
+        // Segments are signalled in allocation order as their cycles are chained, so the first unsignalled segment bounds the ones that can be released
+        while (!segments.empty() && segments.front().cycle->Poll(false, true))
+            segments.pop_front();
+    }
 }
@@ -3,56 +3,48 @@
 
 #pragma once
 
+#include <deque>
 #include "memory_manager.h"
 
 namespace skyline::gpu {
-    constexpr static vk::DeviceSize MegaBufferChunkSize{25 * 1024 * 1024}; //!< Size in bytes of a single megabuffer chunk (25MiB)
+    constexpr static vk::DeviceSize MegaBufferMaxAllocationSize{25 * 1024 * 1024}; //!< Size in bytes of the largest allocation that should be made in the megabuffer (25MiB), larger allocations are possible but may not be backed by the ring
+    constexpr static vk::DeviceSize MegaBufferRingSize{4 * MegaBufferMaxAllocationSize}; //!< Size in bytes of the persistently mapped ring backing the megabuffer (100MiB)
 
     /**
-      * @brief A simple linearly allocated GPU-side buffer used to temporarily store buffer modifications allowing them to be replayed in-sequence on the GPU
-      * @note This class is **not** thread-safe and any calls must be externally synchronized
-      */
-    class MegaBufferChunk {
+     * @brief A linearly allocated GPU-side ring buffer used to temporarily store buffer modifications allowing them to be replayed in-sequence on the GPU
+     * @note The ring is split into segments which are each tracked by the fence cycle that last allocated in them, space is only reused after the segment's cycle has been signalled which bounds the memory footprint to the ring's size
+     * @note This class is not thread-safe and any calls must be externally synchronized
+     */
+    class MegaBufferAllocator {
       private:
-        std::shared_ptr<FenceCycle> cycle; //!< Latest cycle this chunk has had allocations in
-        memory::Buffer backing; //!< The GPU buffer as the backing storage for the chunk
-        span<u8> freeRegion; //!< The unallocated space in the chunk
-
-      public:
-        MegaBufferChunk(GPU &gpu);
-
         /**
-         * @brief If the chunk's cycle is is signalled, resets the free region of the megabuffer to its initial state, if it's not signalled the chunk must not be used
-         * @returns True if the chunk can be reused, false otherwise
+         * @brief A contiguous region of the ring which has been allocated in by a single fence cycle
          */
-        bool TryReset();
+        struct Segment {
+            IntrusivePtr<FenceCycle> cycle;
+            vk::DeviceSize begin; //!< The offset of the first byte in the ring
+            vk::DeviceSize end; //!< The offset one past the last allocated byte in the ring
+        };
+
+        GPU &gpu;
+        memory::Buffer backing; //!< The persistently mapped GPU buffer backing the ring
+        vk::DeviceSize head; //!< The offset in the ring at which the next allocation will be made
+        std::deque<Segment> segments; //!< All segments which are in use by the GPU, in allocation order with the oldest at the front
 
         /**
-         * @brief Returns the underlying Vulkan buffer for the chunk
+         * @brief Waits on the oldest segment's cycle and removes it from the ring
+         * @return If the segment could be released, this is false if the segment's cycle is the supplied cycle as waiting on it would deadlock
          */
-        vk::Buffer GetBacking() const;
-
-        std::pair<vk::DeviceSize, span<u8>> Allocate(const std::shared_ptr<FenceCycle> &newCycle, vk::DeviceSize size, bool pageAlign = false);
-    };
-
-    /**
-     * @brief Allocator for megabuffer chunks that takes the usage of resources on the GPU into account
-     * @note This class is not thread-safe and any calls must be externally synchronized
-     */
-    class MegaBufferAllocator {
-      private:
-        GPU &gpu;
-        std::list<MegaBufferChunk> chunks; //!< A pool of all allocated megabuffer chunks, these are dynamically utilized
-        decltype(chunks)::iterator activeChunk; //!< Currently active chunk of the megabuffer which is being allocated into
+        bool ReleaseSegment(const IntrusivePtr<FenceCycle> &cycle);
 
       public:
         /**
-         * @brief A megabuffer chunk allocation
+         * @brief A megabuffer allocation
          */
         struct Allocation {
-            vk::Buffer buffer; //!< The megabuffer chunk backing hat the allocation was made within
-            vk::DeviceSize offset; //!< The offset of the allocation in the chunk
-            span<u8> region; //!< The CPU mapped region of the allocation in the chunk
+            vk::Buffer buffer; //!< The buffer backing that the allocation was made within
+            vk::DeviceSize offset; //!< The offset of the allocation in the buffer
+            span<u8> region; //!< The CPU mapped region of the allocation in the buffer
 
             operator bool() const {
                 return offset != 0;
@@ -62,17 +54,24 @@ namespace skyline::gpu {
         MegaBufferAllocator(GPU &gpu);
 
         /**
-          * @brief Allocates data in a megabuffer chunk and returns an structure describing the allocation
+          * @brief Allocates data in the megabuffer and returns an structure describing the allocation
           * @param pageAlign Whether the pushed data should be page aligned in the megabuffer
+          * @note If the ring is exhausted by allocations from the supplied cycle, a standalone buffer tied to the cycle is allocated instead
           * @note The allocator *MUST* be locked before calling this function
           */
-        Allocation Allocate(const std::shared_ptr<FenceCycle> &cycle, vk::DeviceSize size, bool pageAlign = false);
+        Allocation Allocate(const IntrusivePtr<FenceCycle> &cycle, vk::DeviceSize size, bool pageAlign = false);
 
         /**
-         * @brief Pushes data to a megabuffer chunk and returns an structure describing the allocation
+         * @brief Pushes data to the megabuffer and returns an structure describing the allocation
          * @param pageAlign Whether the pushed data should be page aligned in the megabuffer
          * @note The allocator *MUST* be locked before calling this function
          */
-        Allocation Push(const std::shared_ptr<FenceCycle> &cycle, span<u8> data, bool pageAlign = false);
+        Allocation Push(const IntrusivePtr<FenceCycle> &cycle, span<u8> data, bool pageAlign = false);
+
+        /**
+         * @brief Releases all segments with signalled cycles alongside the dependencies of those cycles, this doesn't wait on any cycles
+         * @note The allocator *MUST* be locked before calling this function
+         */
+        void Trim();
     };
 }
@@ -1,6 +1,7 @@
 // SPDX-License-Identifier: MPL-2.0
 // Copyright © 2021 Skyline Team and Contributors (https://github.com/skyline-emu/)
 
+#include <bit>
 #include <gpu.h>
 #include "memory_manager.h"
 
@@ -9,13 +10,19 @@ namespace skyline::gpu::memory {
      * @brief If the result isn't VK_SUCCESS then an exception is thrown
      */
     void ThrowOnFail(VkResult result, const char *function = __builtin_FUNCTION()) {
-        if (result != VK_SUCCESS)
+        if (result != VK_SUCCESS) {
+            if (result == VK_ERROR_OUT_OF_DEVICE_MEMORY || result == VK_ERROR_OUT_OF_HOST_MEMORY)
+                GetMemoryAccounting().Log("Out of memory"); // This is logged prior to throwing as it's likely to be the last chance to see what was using the memory
+
             vk::throwResultException(vk::Result(result), function);
+        }
     }
 
     Buffer::~Buffer() {
-        if (vmaAllocator && vmaAllocation && vkBuffer)
+        if (vmaAllocator && vmaAllocation && vkBuffer) {
             vmaDestroyBuffer(vmaAllocator, vkBuffer, vmaAllocation);
+            GetMemoryAccounting().Free(category, allocationSize);
+        }
     }
 
     Image::~Image() {
@@ -23,6 +30,7 @@ namespace skyline::gpu::memory {
             if (pointer)
                 vmaUnmapMemory(vmaAllocator, vmaAllocation);
             vmaDestroyImage(vmaAllocator, vkImage, vmaAllocation);
+            GetMemoryAccounting().Free(MemoryCategory::Image, allocationSize);
         }
     }
 
@@ -71,13 +79,20 @@ namespace skyline::gpu::memory {
     }
 
     MemoryManager::~MemoryManager() {
+        {
+            std::scoped_lock lock{stagingPool->mutex};
+            stagingPool->destroyed = true;
+            for (auto &freeBuffers : stagingPool->freeBuffers)
+                freeBuffers.clear();
+        }
+
         vmaDestroyAllocator(vmaAllocator);
     }
 
-    std::shared_ptr<StagingBuffer> MemoryManager::AllocateStagingBuffer(vk::DeviceSize size) {
+    std::unique_ptr<StagingBuffer> MemoryManager::CreateStagingBuffer(vk::DeviceSize size, vk::BufferUsageFlags usage) {
         vk::BufferCreateInfo bufferCreateInfo{
             .size = size,
-            .usage = vk::BufferUsageFlagBits::eTransferSrc | vk::BufferUsageFlagBits::eTransferDst,
+            .usage = usage,
             .sharingMode = vk::SharingMode::eExclusive,
             .queueFamilyIndexCount = 1,
             .pQueueFamilyIndices = &gpu.vkQueueFamilyIndex,
@@ -92,13 +107,54 @@ namespace skyline::gpu::memory {
         VmaAllocationInfo allocationInfo;
         ThrowOnFail(vmaCreateBuffer(vmaAllocator, &static_cast<const VkBufferCreateInfo &>(bufferCreateInfo), &allocationCreateInfo, &buffer, &allocation, &allocationInfo));
 
-        return std::make_shared<memory::StagingBuffer>(reinterpret_cast<u8 *>(allocationInfo.pMappedData), size, vmaAllocator, buffer, allocation);
+        GetMemoryAccounting().Allocate(MemoryCategory::StagingBuffer, allocationInfo.size);
+        return std::make_unique<memory::StagingBuffer>(reinterpret_cast<u8 *>(allocationInfo.pMappedData), size, vmaAllocator, buffer, allocation, MemoryCategory::StagingBuffer, allocationInfo.size);
+    }
+
+    void MemoryManager::ReleaseStagingBuffer(const std::shared_ptr<StagingPool> &pool, size_t sizeClass, StagingBuffer *buffer) {
+        std::unique_ptr<StagingBuffer> ownedBuffer{buffer};
+        vk::DeviceSize classSize{1ULL << (StagingSizeClassMinimumBits + sizeClass)};
+
+        std::scoped_lock lock{pool->mutex};
+        if (!pool->destroyed && pool->freeBytes + classSize <= StagingPoolRetentionLimit) {
+            pool->freeBuffers[sizeClass].push_back(std::move(ownedBuffer));
+            pool->freeBytes += classSize;
+        }
+    }
+
+    std::shared_ptr<StagingBuffer> MemoryManager::AllocateStagingBuffer(vk::DeviceSize size, vk::BufferUsageFlags additionalUsage) {
+        gpu.syncTraffic.Record(SyncTrafficSource::StagingAllocation, size);
+
+        size_t sizeClass{static_cast<size_t>(std::bit_width(std::max<vk::DeviceSize>(size, 1) - 1))};
+        sizeClass = sizeClass > StagingSizeClassMinimumBits ? sizeClass - StagingSizeClassMinimumBits : 0;
+        if (sizeClass >= StagingSizeClassCount || (additionalUsage & ~PooledStagingUsage))
+            return CreateStagingBuffer(size, vk::BufferUsageFlagBits::eTransferSrc | vk::BufferUsageFlagBits::eTransferDst | additionalUsage);
+
+        std::unique_ptr<StagingBuffer> buffer;
+        {
+            std::scoped_lock lock{stagingPool->mutex};
+            auto &freeBuffers{stagingPool->freeBuffers[sizeClass]};
+            if (!freeBuffers.empty()) {
+                buffer = std::move(freeBuffers.back());
+                freeBuffers.pop_back();
+                stagingPool->freeBytes -= 1ULL << (StagingSizeClassMinimumBits + sizeClass);
+            }
+        }
+
+        if (!buffer)
+            buffer = CreateStagingBuffer(1ULL << (StagingSizeClassMinimumBits + sizeClass), PooledStagingUsage);
+
+        // The buffer is exposed with the requested size as users depend on it to determine how much data was staged, the allocation always starts at the same address
+        static_cast<span<u8> &>(*buffer) = span<u8>{buffer->data(), static_cast<size_t>(size)};
+        return std::shared_ptr<StagingBuffer>{buffer.release(), [pool = stagingPool, sizeClass](StagingBuffer *pBuffer) {
+            ReleaseStagingBuffer(pool, sizeClass, pBuffer);
+        }};
     }
 
-    Buffer MemoryManager::AllocateBuffer(vk::DeviceSize size) {
+    Buffer MemoryManager::AllocateBuffer(vk::DeviceSize size, MemoryCategory category) {
         vk::BufferCreateInfo bufferCreateInfo{
             .size = size,
-            .usage = vk::BufferUsageFlagBits::eTransferSrc | vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eUniformTexelBuffer | vk::BufferUsageFlagBits::eStorageTexelBuffer | vk::BufferUsageFlagBits::eUniformBuffer | vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eIndexBuffer | vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eIndirectBuffer | vk::BufferUsageFlagBits::eTransformFeedbackBufferEXT,
+            .usage = vk::BufferUsageFlagBits::eTransferSrc | vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eUniformTexelBuffer | vk::BufferUsageFlagBits::eStorageTexelBuffer | vk::BufferUsageFlagBits::eUniformBuffer | vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eIndexBuffer | vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eIndirectBuffer | vk::BufferUsageFlagBits::eTransformFeedbackBufferEXT | (gpu.traits.supportsTransformFeedback ? vk::BufferUsageFlagBits::eTransformFeedbackCounterBufferEXT : vk::BufferUsageFlags{}) | (gpu.traits.supportsConditionalRendering ? vk::BufferUsageFlagBits::eConditionalRenderingEXT : vk::BufferUsageFlags{}),
             .sharingMode = vk::SharingMode::eExclusive,
             .queueFamilyIndexCount = 1,
             .pQueueFamilyIndices = &gpu.vkQueueFamilyIndex,
@@ -114,7 +170,8 @@ namespace skyline::gpu::memory {
         VmaAllocationInfo allocationInfo;
         ThrowOnFail(vmaCreateBuffer(vmaAllocator, &static_cast<const VkBufferCreateInfo &>(bufferCreateInfo), &allocationCreateInfo, &buffer, &allocation, &allocationInfo));
 
-        return Buffer(reinterpret_cast<u8 *>(allocationInfo.pMappedData), size, vmaAllocator, buffer, allocation);
+        GetMemoryAccounting().Allocate(category, allocationInfo.size);
+        return Buffer(reinterpret_cast<u8 *>(allocationInfo.pMappedData), size, vmaAllocator, buffer, allocation, category, allocationInfo.size);
     }
 
     Image MemoryManager::AllocateImage(const vk::ImageCreateInfo &createInfo) {
@@ -127,7 +184,8 @@ namespace skyline::gpu::memory {
         VmaAllocationInfo allocationInfo;
         ThrowOnFail(vmaCreateImage(vmaAllocator, &static_cast<const VkImageCreateInfo &>(createInfo), &allocationCreateInfo, &image, &allocation, &allocationInfo));
 
-        return Image(vmaAllocator, image, allocation);
+        GetMemoryAccounting().Allocate(MemoryCategory::Image, allocationInfo.size);
+        return Image(vmaAllocator, image, allocation, allocationInfo.size);
     }
 
     Image MemoryManager::AllocateMappedImage(const vk::ImageCreateInfo &createInfo) {
@@ -141,6 +199,7 @@ namespace skyline::gpu::memory {
         VmaAllocationInfo allocationInfo;
         ThrowOnFail(vmaCreateImage(vmaAllocator, &static_cast<const VkImageCreateInfo &>(createInfo), &allocationCreateInfo, &image, &allocation, &allocationInfo));
 
-        return Image(vmaAllocator, image, allocation);
+        GetMemoryAccounting().Allocate(MemoryCategory::Image, allocationInfo.size);
+        return Image(vmaAllocator, image, allocation, allocationInfo.size);
     }
 }
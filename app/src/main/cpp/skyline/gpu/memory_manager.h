@@ -4,6 +4,7 @@
 #pragma once
 
 #include <vk_mem_alloc.h>
+#include <common/memory_accounting.h>
 #include "fence_cycle.h"
 
 namespace skyline::gpu::memory {
@@ -15,11 +16,15 @@ namespace skyline::gpu::memory {
         VmaAllocator vmaAllocator;
         VmaAllocation vmaAllocation;
         vk::Buffer vkBuffer;
+        MemoryCategory category; //!< The category the allocation is accounted to
+        vk::DeviceSize allocationSize; //!< The size of the underlying allocation, this may be larger than the buffer
 
-        constexpr Buffer(u8 *pointer, size_t size, VmaAllocator vmaAllocator, vk::Buffer vkBuffer, VmaAllocation vmaAllocation)
+        constexpr Buffer(u8 *pointer, size_t size, VmaAllocator vmaAllocator, vk::Buffer vkBuffer, VmaAllocation vmaAllocation, MemoryCategory category, vk::DeviceSize allocationSize)
             : vmaAllocator(vmaAllocator),
               vkBuffer(vkBuffer),
               vmaAllocation(vmaAllocation),
+              category(category),
+              allocationSize(allocationSize),
               span(pointer, size) {}
 
         Buffer(const Buffer &) = delete;
@@ -28,11 +33,24 @@ namespace skyline::gpu::memory {
             : vmaAllocator(std::exchange(other.vmaAllocator, nullptr)),
               vmaAllocation(std::exchange(other.vmaAllocation, nullptr)),
               vkBuffer(std::exchange(other.vkBuffer, {})),
+              category(other.category),
+              allocationSize(std::exchange(other.allocationSize, 0)),
               span(other) {}
 
         Buffer &operator=(const Buffer &) = delete;
 
-        Buffer &operator=(Buffer &&) = default;
+        /**
+         * @note The allocations are swapped so that the prior allocation of this buffer is freed alongside the other buffer
+         */
+        Buffer &operator=(Buffer &&other) {
+            std::swap(vmaAllocator, other.vmaAllocator);
+            std::swap(vmaAllocation, other.vmaAllocation);
+            std::swap(vkBuffer, other.vkBuffer);
+            std::swap(category, other.category);
+            std::swap(allocationSize, other.allocationSize);
+            std::swap(static_cast<span<u8> &>(*this), static_cast<span<u8> &>(other));
+            return *this;
+        }
 
         ~Buffer();
     };
@@ -56,17 +74,20 @@ namespace skyline::gpu::memory {
         VmaAllocator vmaAllocator;
         VmaAllocation vmaAllocation;
         vk::Image vkImage;
+        vk::DeviceSize allocationSize; //!< The size of the underlying allocation, this is accounted to MemoryCategory::Image
 
-        constexpr Image(VmaAllocator vmaAllocator, vk::Image vkImage, VmaAllocation vmaAllocation)
+        constexpr Image(VmaAllocator vmaAllocator, vk::Image vkImage, VmaAllocation vmaAllocation, vk::DeviceSize allocationSize)
             : vmaAllocator(vmaAllocator),
               vkImage(vkImage),
-              vmaAllocation(vmaAllocation) {}
+              vmaAllocation(vmaAllocation),
+              allocationSize(allocationSize) {}
 
-        constexpr Image(u8 *pointer, VmaAllocator vmaAllocator, vk::Image vkImage, VmaAllocation vmaAllocation)
+        constexpr Image(u8 *pointer, VmaAllocator vmaAllocator, vk::Image vkImage, VmaAllocation vmaAllocation, vk::DeviceSize allocationSize)
             : pointer(pointer),
               vmaAllocator(vmaAllocator),
               vkImage(vkImage),
-              vmaAllocation(vmaAllocation) {}
+              vmaAllocation(vmaAllocation),
+              allocationSize(allocationSize) {}
 
         Image(const Image &) = delete;
 
@@ -74,11 +95,22 @@ namespace skyline::gpu::memory {
             : pointer(std::exchange(other.pointer, nullptr)),
               vmaAllocator(std::exchange(other.vmaAllocator, nullptr)),
               vmaAllocation(std::exchange(other.vmaAllocation, nullptr)),
-              vkImage(std::exchange(other.vkImage, {})) {}
+              vkImage(std::exchange(other.vkImage, {})),
+              allocationSize(std::exchange(other.allocationSize, 0)) {}
 
         Image &operator=(const Image &) = delete;
 
-        Image &operator=(Image &&) = default;
+        /**
+         * @note The allocations are swapped so that the prior allocation of this image is freed alongside the other image
+         */
+        Image &operator=(Image &&other) {
+            std::swap(pointer, other.pointer);
+            std::swap(vmaAllocator, other.vmaAllocator);
+            std::swap(vmaAllocation, other.vmaAllocation);
+            std::swap(vkImage, other.vkImage);
+            std::swap(allocationSize, other.allocationSize);
+            return *this;
+        }
 
         ~Image();
 
@@ -97,6 +129,30 @@ namespace skyline::gpu::memory {
         const GPU &gpu;
         VmaAllocator vmaAllocator{VK_NULL_HANDLE};
 
+        static constexpr size_t StagingSizeClassMinimumBits{12}; //!< The size of the smallest staging size class as a power of two (4KiB)
+        static constexpr size_t StagingSizeClassCount{15}; //!< The amount of power of two staging size classes, allocations larger than the largest class (64MiB) aren't pooled
+        static constexpr vk::DeviceSize StagingPoolRetentionLimit{64 * 1024 * 1024}; //!< The maximum combined size of free staging buffers retained by the pool, any buffers released past this are freed
+        static constexpr vk::BufferUsageFlags PooledStagingUsage{vk::BufferUsageFlagBits::eTransferSrc | vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eStorageBuffer}; //!< The usage of all pooled staging buffers, this covers all usages that staging buffers are requested with
+
+        /**
+         * @brief Free staging buffers of every size class which can be reused without allocating
+         * @note This is shared with all pooled staging buffers so that any released after the manager is destroyed are freed rather than pooled
+         */
+        struct StagingPool {
+            std::mutex mutex;
+            std::array<std::vector<std::unique_ptr<StagingBuffer>>, StagingSizeClassCount> freeBuffers;
+            vk::DeviceSize freeBytes{}; //!< The combined size of all free buffers
+            bool destroyed{}; //!< If the manager has been destroyed and released buffers must not be retained
+        };
+        std::shared_ptr<StagingPool> stagingPool{std::make_shared<StagingPool>()};
+
+        std::unique_ptr<StagingBuffer> CreateStagingBuffer(vk::DeviceSize size, vk::BufferUsageFlags usage);
+
+        /**
+         * @brief Returns a pooled staging buffer to its pool once the last reference to it has been dropped, this implies any fence cycles using it have been signalled
+         */
+        static void ReleaseStagingBuffer(const std::shared_ptr<StagingPool> &pool, size_t sizeClass, StagingBuffer *buffer);
+
       public:
         MemoryManager(const GPU &gpu);
 
@@ -104,13 +160,15 @@ namespace skyline::gpu::memory {
 
         /**
          * @brief Creates a buffer which is optimized for staging (Transfer Source)
+         * @param additionalUsage Any usages of the buffer in addition to it being a transfer source/destination
+         * @note Buffers are recycled through power of two size classes once released, the contents of a returned buffer are undefined and it may be larger than requested
          */
-        std::shared_ptr<StagingBuffer> AllocateStagingBuffer(vk::DeviceSize size);
+        std::shared_ptr<StagingBuffer> AllocateStagingBuffer(vk::DeviceSize size, vk::BufferUsageFlags additionalUsage = {});
 
         /**
          * @brief Creates a buffer with a CPU mapping and all usage flags
          */
-        Buffer AllocateBuffer(vk::DeviceSize size);
+        Buffer AllocateBuffer(vk::DeviceSize size, MemoryCategory category = MemoryCategory::Buffer);
 
         /**
          * @brief Creates an image which is allocated and deallocated using RAII
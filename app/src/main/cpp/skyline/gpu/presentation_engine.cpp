@@ -5,6 +5,9 @@
 #include <android/choreographer.h>
 #include <common/settings.h>
 #include <common/signal.h>
+#include <common/performance_statistics.h>
+#include <common/boot_profile.h>
+#include <common/frame_telemetry.h>
 #include <jvm.h>
 #include <gpu.h>
 #include <soc.h>
@@ -91,6 +94,31 @@ namespace skyline::gpu {
         }
     }
 
+    i64 PresentationEngine::GetPacedTimestamp(const PresentableFrame &frame, i64 timestamp, i64 now) {
+        // These are written by the Choreographer thread, they're only read once to retain a consistent view
+        i64 refreshCycle{refreshCycleDuration}, vsyncPhase{lastChoreographerTime};
+
+        // The swap interval is in terms of 60Hz refreshes while the host display may have any refresh rate, a title that consistently takes longer than its swap interval is paced to its measured frametime instead
+        constexpr i64 GuestRefreshCycle{constant::NsInSecond / 60};
+        i64 frameInterval{std::max(frame.swapInterval * GuestRefreshCycle, averageFrametimeNs)};
+
+        // A quarter of a refresh cycle of tolerance is allowed to prevent slight deviations from the interval doubling the amount of refreshes
+        i64 cycleCount{std::max<i64>(util::DivideCeil(frameInterval - (refreshCycle / 4), refreshCycle), 1)};
+
+        i64 target{lastPacedVsync ? lastPacedVsync + (cycleCount * refreshCycle) : now};
+        // If the frame arrived too late to make its target refresh then cadence is re-established from the next refresh rather than trying to catch up
+        target = std::max({target, now + (refreshCycle / 2), timestamp});
+
+        // The target is snapped to the nearest predicted refresh, these are extrapolated from the last Choreographer callback
+        i64 vsync{vsyncPhase + (util::DivideCeil(target - vsyncPhase - (refreshCycle / 2), refreshCycle) * refreshCycle)};
+        lastPacedVsync = vsync;
+
+        TRACE_EVENT_INSTANT("gpu", "PacedPresent", presentationTrack, "CycleCount", cycleCount, "TargetVsync", vsync);
+
+        // The compositor displays a buffer on the first refresh after its timestamp, it's set to halfway through the prior refresh cycle so that small errors in the prediction don't cause the frame to be displayed a refresh early or late
+        return vsync - (refreshCycle / 2);
+    }
+
     void PresentationEngine::PresentFrame(const PresentableFrame &frame) {
         std::unique_lock lock(mutex);
         surfaceCondition.wait(lock, [this]() { return vkSurface.has_value(); });
@@ -100,14 +128,27 @@ namespace skyline::gpu {
         std::scoped_lock textureLock(*frame.textureView);
 
         auto texture{frame.textureView->texture};
-        if (frame.textureView->format != swapchainFormat || texture->dimensions != swapchainExtent)
-            UpdateSwapchain(frame.textureView->format, texture->dimensions);
+
+        // Frames rendered below the guest resolution can be upscaled back to it, sRGB frames are excluded as they can't be written without re-encoding into the storage image
+        auto format{frame.textureView->format};
+        bool upscale{*state.settings->presentUpscaling && upscalingSupported && texture->guest && texture->resolutionScale < 1.0f &&
+                     format->vkFormat != vk::Format::eR8G8B8A8Srgb && format->vkFormat != vk::Format::eB8G8R8A8Srgb && format->vkFormat != vk::Format::eA8B8G8R8SrgbPack32};
+        auto extent{upscale ? texture->guest->dimensions : texture->dimensions};
+        if (format != swapchainFormat || extent != swapchainExtent || upscale != swapchainUpscaling)
+            UpdateSwapchain(format, extent, upscale);
+
+        // The crop is in guest coordinates while the swapchain has the dimensions of the host image, which differ for render targets with resolution scaling unless they're upscaled
+        auto crop{frame.crop};
+        if (crop && texture->IsScaled() && !upscale) {
+            auto scaleCoordinate{[scale = texture->resolutionScale](u32 value) { return static_cast<u32>(std::lround(static_cast<float>(value) * scale)); }};
+            crop = {scaleCoordinate(crop.left), scaleCoordinate(crop.top), scaleCoordinate(crop.right), scaleCoordinate(crop.bottom)};
+        }
 
         int result;
-        if (frame.crop && frame.crop != windowCrop) {
-            if ((result = window->perform(window, NATIVE_WINDOW_SET_CROP, &frame.crop)))
-                throw exception("Setting the layer crop to ({}-{})x({}-{}) failed with {}", frame.crop.left, frame.crop.right, frame.crop.top, frame.crop.bottom, result);
-            windowCrop = frame.crop;
+        if (crop && crop != windowCrop) {
+            if ((result = window->perform(window, NATIVE_WINDOW_SET_CROP, &crop)))
+                throw exception("Setting the layer crop to ({}-{})x({}-{}) failed with {}", crop.left, crop.right, crop.top, crop.bottom, result);
+            windowCrop = crop;
         }
 
         if (frame.scalingMode != NativeWindowScalingMode::Freeze && windowScalingMode != frame.scalingMode) {
@@ -120,6 +161,9 @@ namespace skyline::gpu {
             throw exception("Setting the buffer transform to '{}' failed with {}", ToString(frame.transform), result);
         windowTransform = frame.transform;
 
+        // The texture is synchronized prior to acquiring a swapchain image so that the image is held for as little time as possible
+        texture->SynchronizeHost();
+
         auto &acquireSemaphore{acquireSemaphores[frameIndex]};
         auto &frameFence{frameFences[frameIndex]};
         if (frameFence)
@@ -138,12 +182,14 @@ namespace skyline::gpu {
         auto &nextImageTexture{images.at(nextImage.second)};
         auto &presentSemaphore{presentSemaphores[nextImage.second]};
 
-        texture->SynchronizeHost();
-        nextImageTexture->CopyFrom(texture, *acquireSemaphore, *presentSemaphore, swapchainFormat, vk::ImageSubresourceRange{
-            .aspectMask = vk::ImageAspectFlagBits::eColor,
-            .levelCount = 1,
-            .layerCount = 1,
-        });
+        if (upscale)
+            nextImageTexture->UpscaleFrom(frame.textureView, *acquireSemaphore, *presentSemaphore);
+        else
+            nextImageTexture->CopyFrom(texture, *acquireSemaphore, *presentSemaphore, swapchainFormat, vk::ImageSubresourceRange{
+                .aspectMask = vk::ImageAspectFlagBits::eColor,
+                .levelCount = 1,
+                .layerCount = 1,
+            });
 
         frameFence = nextImageTexture->cycle;
 
@@ -167,7 +213,11 @@ namespace skyline::gpu {
             }
         }
 
-        if (frame.swapInterval) {
+        if (frame.swapInterval && *state.settings->framePacing && !*state.settings->lowLatencyPresentation && refreshCycleDuration && !*state.settings->disableFrameThrottling) {
+            timestamp = GetPacedTimestamp(frame, timestamp, getMonotonicNsNow());
+        } else if (frame.swapInterval) {
+            lastPacedVsync = 0;
+
             // If we have a swap interval, we have to adjust the timestamp to emulate the swap interval
             i64 lastFramePresentTime{util::AlignUpNpot(windowLastTimestamp, refreshCycleDuration)};
             if (lastFramePresentTime > lastChoreographerTime)
@@ -201,6 +251,8 @@ namespace skyline::gpu {
             }); // We don't care about suboptimal images as they are caused by not respecting the transform hint, we handle transformations externally
         }
 
+        gpu.syncTraffic.EmitFrameCounters();
+
         timestamp = (timestamp && !*state.settings->disableFrameThrottling) ? timestamp : getMonotonicNsNow(); // We tie FPS to the submission time rather than presentation timestamp, if we don't have the presentation timestamp available or if frame throttling is disabled as we want the maximum measured FPS to not be restricted to the refresh rate
         if (frameTimestamp) {
             i64 sampleWeight{Fps ? Fps : 1}; //!< The weight of each sample in calculating the average, we want to roughly average the past second
@@ -210,6 +262,7 @@ namespace skyline::gpu {
             }}; //!< Modified moving average (https://en.wikipedia.org/wiki/Moving_average#Modified_moving_average)
 
             i64 currentFrametime{timestamp - frameTimestamp};
+            GetFrameTelemetry().RecordFrame(frame.id, currentFrametime, averageFrametimeNs, util::GetTimeNs() - frame.queueTime);
             averageFrametimeNs = weightedAverage(sampleWeight, averageFrametimeNs, currentFrametime);
             AverageFrametimeMs = static_cast<jfloat>(averageFrametimeNs) / constant::NsInMillisecond;
 
@@ -221,9 +274,16 @@ namespace skyline::gpu {
 
             TRACE_EVENT_INSTANT("gpu", "Present", presentationTrack, "FrameTimeNs", timestamp - frameTimestamp, "Fps", Fps);
 
+            auto &statistics{GetPerformanceStatistics()};
+            statistics.fps.store(static_cast<u64>(Fps), std::memory_order_relaxed);
+            statistics.averageFrametimeNs.store(static_cast<u64>(averageFrametimeNs), std::memory_order_relaxed);
+            statistics.averageFrametimeDeviationNs.store(static_cast<u64>(averageFrametimeDeviationNs), std::memory_order_relaxed);
+            statistics.frameCount.fetch_add(1, std::memory_order_relaxed);
+
             frameTimestamp = timestamp;
         } else {
             frameTimestamp = timestamp;
+            GetBootProfile().Finish(state.os->publicAppFilesPath); // This is the first frame to be presented
         }
     }
 
@@ -235,6 +295,14 @@ namespace skyline::gpu {
             signal::SetSignalHandler({SIGINT, SIGILL, SIGTRAP, SIGBUS, SIGFPE, SIGSEGV}, signal::ExceptionalSignalHandler);
 
             presentQueue.Process([this](const PresentableFrame &frame) {
+                if (*state.settings->lowLatencyPresentation && !presentQueue.IsNewest(frame)) {
+                    // A newer frame has already been queued, presenting this one would only delay it
+                    frame.fence.Wait(state.soc->host1x);
+                    TRACE_EVENT_INSTANT("gpu", "DroppedFrame", presentationTrack, "FrameId", frame.id);
+                    frame.presentCallback();
+                    return;
+                }
+
                 PresentFrame(frame);
                 frame.presentCallback(); // We're calling the callback here as it's outside of all the locks in PresentFrame
             }, [] {});
@@ -276,7 +344,7 @@ namespace skyline::gpu {
         }
     }
 
-    void PresentationEngine::UpdateSwapchain(texture::Format format, texture::Dimensions extent) {
+    void PresentationEngine::UpdateSwapchain(texture::Format format, texture::Dimensions extent, bool upscaling) {
         auto minImageCount{std::max(vkSurfaceCapabilities.minImageCount, *state.settings->forceTripleBuffering ? 3U : 2U)};
         if (minImageCount > MaxSwapchainImageCount)
             throw exception("Requesting swapchain with higher image count ({}) than maximum slot count ({})", minImageCount, MaxSwapchainImageCount);
@@ -289,7 +357,9 @@ namespace skyline::gpu {
 
         vk::Format vkFormat{*format};
         texture::Format underlyingFormat{format};
-        if (swapchainFormat != format) {
+        if (upscaling) {
+            underlyingFormat = format::R8G8B8A8Unorm;
+        } else if (swapchainFormat != format || swapchainUpscaling) {
             auto formats{gpu.vkPhysicalDevice.getSurfaceFormatsKHR(**vkSurface)};
             if (std::find(formats.begin(), formats.end(), vk::SurfaceFormatKHR{vkFormat, vk::ColorSpaceKHR::eSrgbNonlinear}) == formats.end()) {
                 Logger::Debug("Surface doesn't support requested image format '{}' with colorspace '{}'", vk::to_string(vkFormat), vk::to_string(vk::ColorSpaceKHR::eSrgbNonlinear));
@@ -297,13 +367,25 @@ namespace skyline::gpu {
             }
         }
 
-        constexpr vk::ImageUsageFlags presentUsage{vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eTransferSrc | vk::ImageUsageFlagBits::eTransferDst};
+        vk::ImageUsageFlags presentUsage{vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eTransferSrc | vk::ImageUsageFlagBits::eTransferDst};
+        if (upscaling)
+            presentUsage |= vk::ImageUsageFlagBits::eStorage;
         if ((capabilities.supportedUsageFlags & presentUsage) != presentUsage)
             throw exception("Swapchain doesn't support image usage '{}': {}", vk::to_string(presentUsage), vk::to_string(capabilities.supportedUsageFlags));
 
-        auto requestedMode{*state.settings->disableFrameThrottling ? vk::PresentModeKHR::eMailbox : vk::PresentModeKHR::eFifo};
         auto modes{gpu.vkPhysicalDevice.getSurfacePresentModesKHR(**vkSurface)};
-        if (std::find(modes.begin(), modes.end(), requestedMode) == modes.end())
+        auto isModeSupported{[&modes](vk::PresentModeKHR mode) { return std::find(modes.begin(), modes.end(), mode) != modes.end(); }};
+
+        auto requestedMode{*state.settings->disableFrameThrottling ? vk::PresentModeKHR::eMailbox : vk::PresentModeKHR::eFifo};
+        if (*state.settings->lowLatencyPresentation && !*state.settings->disableFrameThrottling) {
+            // A present mode which doesn't block on a display refresh is preferred, mailbox is used over immediate as it avoids tearing, FIFO is always supported as a fallback
+            if (isModeSupported(vk::PresentModeKHR::eMailbox))
+                requestedMode = vk::PresentModeKHR::eMailbox;
+            else if (isModeSupported(vk::PresentModeKHR::eImmediate))
+                requestedMode = vk::PresentModeKHR::eImmediate;
+        }
+
+        if (!isModeSupported(requestedMode))
             throw exception("Swapchain doesn't support present mode: {}", vk::to_string(requestedMode));
 
         vkSwapchain.emplace(gpu.vkDevice, vk::SwapchainCreateInfoKHR{
@@ -335,6 +417,7 @@ namespace skyline::gpu {
 
         swapchainFormat = format;
         swapchainExtent = extent;
+        swapchainUpscaling = upscaling;
         swapchainImageCount = vkImages.size();
     }
 
@@ -360,8 +443,12 @@ namespace skyline::gpu {
                 throw exception("Vulkan Queue doesn't support presentation with surface");
             vkSurfaceCapabilities = gpu.vkPhysicalDevice.getSurfaceCapabilitiesKHR(**vkSurface);
 
+            auto formats{gpu.vkPhysicalDevice.getSurfaceFormatsKHR(**vkSurface)};
+            upscalingSupported = (vkSurfaceCapabilities.supportedUsageFlags & vk::ImageUsageFlagBits::eStorage) &&
+                std::find(formats.begin(), formats.end(), vk::SurfaceFormatKHR{SpatialUpscaleHelperShader::OutputFormat, vk::ColorSpaceKHR::eSrgbNonlinear}) != formats.end();
+
             if (swapchainExtent && swapchainFormat)
-                UpdateSwapchain(swapchainFormat, swapchainExtent);
+                UpdateSwapchain(swapchainFormat, swapchainExtent, swapchainUpscaling && upscalingSupported);
 
             if (window->common.magic != AndroidNativeWindowMagic)
                 throw exception("ANativeWindow* has unexpected magic: {} instead of {}", span(&window->common.magic, 1).as_string(true), span<const u8>(reinterpret_cast<const u8 *>(&AndroidNativeWindowMagic), sizeof(u32)).as_string(true));
@@ -404,7 +491,8 @@ namespace skyline::gpu {
             nextFrameId,
             crop,
             scalingMode,
-            transform
+            transform,
+            util::GetTimeNs()
         });
 
         return nextFrameId++;
@@ -30,19 +30,22 @@ namespace skyline::gpu {
         service::hosbinder::NativeWindowScalingMode windowScalingMode{service::hosbinder::NativeWindowScalingMode::ScaleToWindow}; //!< The mode in which the cropped image is scaled up to the surface
         service::hosbinder::NativeWindowTransform windowTransform{}; //!< The transformation performed on the image prior to presentation
         i64 windowLastTimestamp{}; //!< The last timestamp submitted to the window, 0 or CLOCK_MONOTONIC value
+        i64 lastPacedVsync{}; //!< The predicted display refresh (in CLOCK_MONOTONIC) that the last frame was paced to be presented at, 0 if the last frame wasn't paced
 
         std::optional<vk::raii::SurfaceKHR> vkSurface; //!< The Vulkan Surface object that is backed by ANativeWindow
         vk::SurfaceCapabilitiesKHR vkSurfaceCapabilities{}; //!< The capabilities of the current Vulkan Surface
+        bool upscalingSupported{}; //!< If the current surface supports swapchain images with the storage usage and format required for upscaling frames
 
         std::optional<vk::raii::SwapchainKHR> vkSwapchain; //!< The Vulkan swapchain and the properties associated with it
         texture::Format swapchainFormat{}; //!< The image format of the textures in the current swapchain
         texture::Dimensions swapchainExtent{}; //!< The extent of images in the current swapchain
+        bool swapchainUpscaling{}; //!< If the images in the current swapchain are upscaled into rather than copied into
 
         static constexpr size_t MaxSwapchainImageCount{10}; //!< The maximum amount of swapchain textures, this affects the amount of images that can be in the swapchain
         std::array<std::shared_ptr<Texture>, MaxSwapchainImageCount> images; //!< All the swapchain textures in the same order as supplied by the host swapchain
         std::array<vk::raii::Semaphore, MaxSwapchainImageCount> presentSemaphores; //!< Array of semaphores used to signal that swapchain images are ready to be completed, indexed by Vulkan swapchain index
         std::array<vk::raii::Semaphore, MaxSwapchainImageCount> acquireSemaphores; //!< Array of semaphores used to wait on the GPU for swapchain images to be acquired, indexed by `frameIndex`
-        std::array<std::shared_ptr<FenceCycle>, MaxSwapchainImageCount> frameFences{}; //!< Array of fences used to wait on the GPU for copying of swapchain images to be completed, indexed by `frameIndex`
+        std::array<IntrusivePtr<FenceCycle>, MaxSwapchainImageCount> frameFences{}; //!< Array of fences used to wait on the GPU for copying of swapchain images to be completed, indexed by `frameIndex`
         size_t frameIndex{}; //!< The index of the next semaphore/fence to be used for acquiring swapchain images
         size_t swapchainImageCount{}; //!< The number of images in the current swapchain
 
@@ -72,12 +75,13 @@ namespace skyline::gpu {
             service::hosbinder::AndroidRect crop{};
             service::hosbinder::NativeWindowScalingMode scalingMode{};
             service::hosbinder::NativeWindowTransform transform{};
+            i64 queueTime{}; //!< The time at which the frame was queued for presentation by the guest
         };
 
         std::thread presentationThread; //!< A thread for asynchronously presenting queued frames after their corresponded fences are signalled
         static constexpr size_t PresentQueueFrameCount{5}; //!< The amount of frames the presentation queue can hold
         CircularQueue<PresentableFrame> presentQueue{PresentQueueFrameCount}; //!< A circular queue containing all the frames that we can present
-        size_t nextFrameId{1}; //!< The frame ID to use for the next frame
+        std::atomic<size_t> nextFrameId{1}; //!< The frame ID to use for the next frame, this is atomic as it's read from other threads
 
         /**
          * @url https://developer.android.com/ndk/reference/group/choreographer#achoreographer_postframecallback64
@@ -89,8 +93,19 @@ namespace skyline::gpu {
          */
         void ChoreographerThread();
 
+        /**
+         * @brief Determines the presentation timestamp of a frame so that it's displayed at a predicted display refresh, with a constant amount of refreshes between frames
+         * @param timestamp The earliest timestamp (in CLOCK_MONOTONIC) that the frame can be presented at, 0 if there isn't one
+         * @param now The current time in CLOCK_MONOTONIC
+         * @return The timestamp (in CLOCK_MONOTONIC) to present the frame at
+         * @note The amount of refreshes between frames is derived from the frame's swap interval or the measured frametime if the title can't keep up with its swap interval, this avoids judder from frames being displayed for an inconsistent amount of refreshes such as with 30 FPS titles on 90Hz or 120Hz displays
+         */
+        i64 GetPacedTimestamp(const PresentableFrame &frame, i64 timestamp, i64 now);
+
         /**
          * @brief Submits a single frame to the host API for presentation with the appropriate waits and copies
+         * @note Frames are always copied into a swapchain image rather than being presented directly, guest buffers are backed by guest memory which textures must stay synchronized with while swapchain images are allocated and owned by the host swapchain, the copy is a plain image copy rather than a blit when the format and extent match the swapchain
+         * @note Frames rendered below the guest resolution are upscaled into the swapchain image with SpatialUpscaleHelperShader instead when presentUpscaling is enabled and the surface supports storage images
          */
         void PresentFrame(const PresentableFrame& frame);
 
@@ -100,9 +115,10 @@ namespace skyline::gpu {
         void PresentationThread();
 
         /**
+         * @param upscaling If frames will be upscaled into the swapchain images, this requires the swapchain to use a storage-capable format which is used instead of the supplied one
          * @note 'PresentationEngine::mutex' **must** be locked prior to calling this
          */
-        void UpdateSwapchain(texture::Format format, texture::Dimensions extent);
+        void UpdateSwapchain(texture::Format format, texture::Dimensions extent, bool upscaling);
 
       public:
         PresentationEngine(const DeviceState &state, GPU &gpu);
@@ -128,6 +144,13 @@ namespace skyline::gpu {
          */
         u64 Present(const std::shared_ptr<TextureView> &texture, i64 timestamp, i64 swapInterval, service::hosbinder::AndroidRect crop, service::hosbinder::NativeWindowScalingMode scalingMode, service::hosbinder::NativeWindowTransform transform, skyline::service::hosbinder::AndroidFence fence, const std::function<void()>& presentCallback);
 
+        /**
+         * @return The ID that will be assigned to the next presented frame, this can be used to determine which frame is currently being rendered
+         */
+        size_t GetFrameId() const {
+            return nextFrameId.load(std::memory_order_relaxed);
+        }
+
         /**
          * @return A transform that the application should render with to elide costly transforms later
          */
@@ -3,6 +3,7 @@
 
 #include <range/v3/algorithm.hpp>
 #include <boost/functional/hash.hpp>
+#include <common/performance_statistics.h>
 #include <gpu.h>
 #include <shader_compiler/common/settings.h>
 #include <shader_compiler/common/log.h>
@@ -83,6 +84,33 @@ namespace skyline::gpu {
         };
     }
 
+    ShaderManager::ConstantBufferRead ShaderManager::EnvironmentRecord::Record(u32 stage, ConstantBufferRead read) {
+        return [this, stage, read = std::move(read)](u32 index, u32 offset) {
+            u32 value{read(index, offset)};
+            ConstantBufferValue record{stage, index, offset, value};
+            if (std::find(constantBufferReads.begin(), constantBufferReads.end(), record) == constantBufferReads.end())
+                constantBufferReads.push_back(record);
+            return value;
+        };
+    }
+
+    ShaderManager::GetTextureType ShaderManager::EnvironmentRecord::Record(u32 stage, GetTextureType getType) {
+        return [this, stage, getType = std::move(getType)](u32 handle) {
+            auto type{getType(handle)};
+            TextureTypeValue record{stage, handle, type};
+            if (std::find(textureTypes.begin(), textureTypes.end(), record) == textureTypes.end())
+                textureTypes.push_back(record);
+            return type;
+        };
+    }
+
+    ShaderManager::GetViewportTransformState ShaderManager::EnvironmentRecord::Record(GetViewportTransformState getState) {
+        return [this, getState = std::move(getState)]() {
+            viewportTransformState = getState();
+            return viewportTransformState;
+        };
+    }
+
     /**
      * @brief A shader environment for all graphics pipeline stages
      */
@@ -91,7 +119,7 @@ namespace skyline::gpu {
         span<u8> binary;
         u32 baseOffset;
         u32 textureBufferIndex;
-        bool viewportTransformEnabled;
+        ShaderManager::GetViewportTransformState getViewportTransformState;
         ShaderManager::ConstantBufferRead constantBufferRead;
         ShaderManager::GetTextureType getTextureType;
 
@@ -100,11 +128,11 @@ namespace skyline::gpu {
                             Shader::Stage pStage,
                             span<u8> pBinary, u32 baseOffset,
                             u32 textureBufferIndex,
-                            bool viewportTransformEnabled,
+                            ShaderManager::GetViewportTransformState getViewportTransformState,
                             ShaderManager::ConstantBufferRead constantBufferRead, ShaderManager::GetTextureType getTextureType)
             : binary{pBinary}, baseOffset{baseOffset},
               textureBufferIndex{textureBufferIndex},
-              viewportTransformEnabled{viewportTransformEnabled},
+              getViewportTransformState{std::move(getViewportTransformState)},
               constantBufferRead{std::move(constantBufferRead)}, getTextureType{std::move(getTextureType)} {
             gp_passthrough_mask = postVtgShaderAttributeSkipMask;
             stage = pStage;
@@ -132,7 +160,7 @@ namespace skyline::gpu {
         }
 
         [[nodiscard]] u32 ReadViewportTransformState() final {
-            return viewportTransformEnabled ? 1 : 0; // Only relevant for graphics shaders
+            return getViewportTransformState(); // The state is part of the cache key as practically all shader sets read it, recording it also guards the disk cache against stale entries
         }
 
         [[nodiscard]] u32 TextureBoundBuffer() const final {
@@ -279,60 +307,301 @@ namespace skyline::gpu {
         void Dump(u64 hash) final {}
     };
 
-    Shader::IR::Program ShaderManager::ParseGraphicsShader(const std::array<u32, 8> &postVtgShaderAttributeSkipMask,
+    Shader::IR::Program ShaderManager::ParseGraphicsShader(Pools &pools, const std::array<u32, 8> &postVtgShaderAttributeSkipMask,
                                                            Shader::Stage stage,
-                                                           span<u8> binary, u32 baseOffset,
+                                                           span<u8> binary, u64 binaryHash, u32 baseOffset,
                                                            u32 textureConstantBufferIndex,
-                                                           bool viewportTransformEnabled,
+                                                           const GetViewportTransformState &getViewportTransformState,
                                                            const ConstantBufferRead &constantBufferRead, const GetTextureType &getTextureType) {
-        std::scoped_lock lock{poolMutex};
+        using Phase = cache::ShaderCompileStatistics::Phase;
+        GraphicsEnvironment environment{postVtgShaderAttributeSkipMask, stage, binary, baseOffset, textureConstantBufferIndex, getViewportTransformState, constantBufferRead, getTextureType};
+        std::optional<Shader::Maxwell::Flow::CFG> cfg;
+        {
+            cache::ShaderCompileStatistics::ScopedPhase phase{gpu.shaderCompileStatistics, binaryHash, Phase::Decode};
+            cfg.emplace(environment, pools.flowBlockPool, Shader::Maxwell::Location{static_cast<u32>(baseOffset + sizeof(Shader::ProgramHeader))});
+        }
 
-        GraphicsEnvironment environment{postVtgShaderAttributeSkipMask, stage, binary, baseOffset, textureConstantBufferIndex, viewportTransformEnabled, constantBufferRead, getTextureType};
-        Shader::Maxwell::Flow::CFG cfg{environment, flowBlockPool, Shader::Maxwell::Location{static_cast<u32>(baseOffset + sizeof(Shader::ProgramHeader))}};
-        return  Shader::Maxwell::TranslateProgram(instructionPool, blockPool, environment, cfg, hostTranslateInfo);
+        cache::ShaderCompileStatistics::ScopedPhase phase{gpu.shaderCompileStatistics, binaryHash, Phase::Translate};
+        return Shader::Maxwell::TranslateProgram(pools.instructionPool, pools.blockPool, environment, *cfg, hostTranslateInfo);
     }
 
-    Shader::IR::Program ShaderManager::CombineVertexShaders(Shader::IR::Program &vertexA, Shader::IR::Program &vertexB, span<u8> vertexBBinary) {
-        std::scoped_lock lock{poolMutex};
-
+    Shader::IR::Program ShaderManager::CombineVertexShaders(Shader::IR::Program &vertexA, Shader::IR::Program &vertexB, span<u8> vertexBBinary, u64 vertexBHash) {
+        cache::ShaderCompileStatistics::ScopedPhase phase{gpu.shaderCompileStatistics, vertexBHash, cache::ShaderCompileStatistics::Phase::Translate};
         VertexBEnvironment env{vertexBBinary};
         return Shader::Maxwell::MergeDualVertexPrograms(vertexA, vertexB, env);
     }
 
-    Shader::IR::Program ShaderManager::ParseComputeShader(span<u8> binary, u32 baseOffset,
+    Shader::IR::Program ShaderManager::ParseComputeShader(Pools &pools, span<u8> binary, u64 binaryHash, u32 baseOffset,
                                                           u32 textureConstantBufferIndex,
                                                           u32 localMemorySize, u32 sharedMemorySize,
                                                           std::array<u32, 3> workgroupDimensions,
                                                           const ConstantBufferRead &constantBufferRead, const GetTextureType &getTextureType) {
-        std::scoped_lock lock{poolMutex};
-
+        using Phase = cache::ShaderCompileStatistics::Phase;
         ComputeEnvironment environment{binary, baseOffset, textureConstantBufferIndex, localMemorySize, sharedMemorySize, workgroupDimensions, constantBufferRead, getTextureType};
-        Shader::Maxwell::Flow::CFG cfg{environment, flowBlockPool, Shader::Maxwell::Location{static_cast<u32>(baseOffset)}};
-        return  Shader::Maxwell::TranslateProgram(instructionPool, blockPool, environment, cfg, hostTranslateInfo);
-    }
+        std::optional<Shader::Maxwell::Flow::CFG> cfg;
+        {
+            cache::ShaderCompileStatistics::ScopedPhase phase{gpu.shaderCompileStatistics, binaryHash, Phase::Decode};
+            cfg.emplace(environment, pools.flowBlockPool, Shader::Maxwell::Location{static_cast<u32>(baseOffset)});
+        }
 
+        cache::ShaderCompileStatistics::ScopedPhase phase{gpu.shaderCompileStatistics, binaryHash, Phase::Translate};
+        return Shader::Maxwell::TranslateProgram(pools.instructionPool, pools.blockPool, environment, *cfg, hostTranslateInfo);
+    }
 
-    vk::ShaderModule ShaderManager::CompileShader(const Shader::RuntimeInfo &runtimeInfo, Shader::IR::Program &program, Shader::Backend::Bindings &bindings) {
-        std::scoped_lock lock{poolMutex};
 
+    std::vector<u32> ShaderManager::EmitShader(const Shader::RuntimeInfo &runtimeInfo, Shader::IR::Program &program, Shader::Backend::Bindings &bindings, u64 binaryHash) {
+        cache::ShaderCompileStatistics::ScopedPhase phase{gpu.shaderCompileStatistics, binaryHash, cache::ShaderCompileStatistics::Phase::Emit};
         if (program.info.loads.Legacy() || program.info.stores.Legacy())
             Shader::Maxwell::ConvertLegacyToGeneric(program, runtimeInfo);
 
-        auto spirv{Shader::Backend::SPIRV::EmitSPIRV(profile, runtimeInfo, program, bindings)};
+        return Shader::Backend::SPIRV::EmitSPIRV(profile, runtimeInfo, program, bindings);
+    }
+
+    vk::ShaderModule ShaderManager::CreateShaderModule(span<const u32> spirv, u64 binaryHash) {
+        u64 hash{XXH64(spirv.data(), spirv.size_bytes(), 0)};
+
+        std::scoped_lock lock{shaderModuleMutex};
+        auto it{shaderModules.find(hash)};
+        if (it != shaderModules.end())
+            return it->second;
 
         vk::ShaderModuleCreateInfo createInfo{
             .pCode = spirv.data(),
-            .codeSize = spirv.size() * sizeof(u32),
+            .codeSize = spirv.size_bytes(),
+        };
+
+        i64 createStartTime{util::GetTimeNs()};
+        auto shaderModule{(*gpu.vkDevice).createShaderModule(createInfo, nullptr, *gpu.vkDevice.getDispatcher())};
+        gpu.shaderCompileStatistics.RecordPhase(binaryHash, cache::ShaderCompileStatistics::Phase::Module, static_cast<u64>(util::GetTimeNs() - createStartTime));
+        shaderModules.emplace(hash, shaderModule);
+        GetMemoryAccounting().Allocate(MemoryCategory::ShaderModule, spirv.size_bytes()); // Shader modules are never destroyed so this is never freed
+        return shaderModule;
+    }
+
+    vk::ShaderModule ShaderManager::CompileShader(const Shader::RuntimeInfo &runtimeInfo, Shader::IR::Program &program, Shader::Backend::Bindings &bindings, u64 binaryHash) {
+        auto spirv{EmitShader(runtimeInfo, program, bindings, binaryHash)};
+        GetPerformanceStatistics().shaderCompileCount.fetch_add(1, std::memory_order_relaxed);
+        return CreateShaderModule(spirv, binaryHash);
+    }
+
+    namespace {
+        /**
+         * @brief Serializes trivially copyable objects into a byte buffer for the on-disk shader cache
+         */
+        class CacheWriter {
+          public:
+            std::vector<u8> buffer;
+
+            template<typename T> requires std::is_trivially_copyable_v<T>
+            void Write(const T &object) {
+                auto bytes{reinterpret_cast<const u8 *>(&object)};
+                buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+            }
+
+            template<typename Container>
+            void WriteContainer(const Container &container) {
+                static_assert(std::is_trivially_copyable_v<typename Container::value_type>);
+                Write(static_cast<u32>(container.size()));
+                for (const auto &element : container)
+                    Write(element);
+            }
+        };
+
+        /**
+         * @brief Deserializes objects written by CacheWriter with bounds checking
+         */
+        class CacheReader {
+          private:
+            span<const u8> data;
+            size_t offset{};
+
+          public:
+            CacheReader(span<const u8> data) : data{data} {}
+
+            template<typename T> requires std::is_trivially_copyable_v<T>
+            T Read() {
+                if (offset + sizeof(T) > data.size())
+                    throw exception("Shader cache entry is truncated: 0x{:X} + 0x{:X} > 0x{:X}", offset, sizeof(T), data.size());
+
+                T object;
+                std::memcpy(&object, data.data() + offset, sizeof(T));
+                offset += sizeof(T);
+                return object;
+            }
+
+            template<typename Container>
+            void ReadContainer(Container &container) {
+                auto count{Read<u32>()};
+                container.clear();
+                for (u32 i{}; i < count; i++)
+                    container.push_back(Read<typename Container::value_type>());
+            }
+        };
+
+        void SerializeCachedShaders(CacheWriter &writer, const ShaderManager::CachedShaders &shaders) {
+            writer.WriteContainer(shaders.environment.constantBufferReads);
+            writer.WriteContainer(shaders.environment.textureTypes);
+            writer.Write(shaders.environment.viewportTransformState);
+
+            writer.Write(static_cast<u32>(shaders.stages.size()));
+            for (const auto &stage : shaders.stages) {
+                writer.Write(stage.stage);
+                writer.WriteContainer(stage.spirv);
+
+                // Only the subset of the shader info that's used for binding resources is serialized
+                const auto &info{stage.info};
+                writer.WriteContainer(info.constant_buffer_descriptors);
+                writer.WriteContainer(info.storage_buffers_descriptors);
+                writer.WriteContainer(info.texture_buffer_descriptors);
+                writer.WriteContainer(info.image_buffer_descriptors);
+                writer.WriteContainer(info.texture_descriptors);
+                writer.WriteContainer(info.image_descriptors);
+                writer.Write(info.constant_buffer_used_sizes);
+                writer.Write(info.loads);
+            }
+        }
+
+        ShaderManager::CachedShaders DeserializeCachedShaders(CacheReader &reader) {
+            ShaderManager::CachedShaders shaders;
+            reader.ReadContainer(shaders.environment.constantBufferReads);
+            reader.ReadContainer(shaders.environment.textureTypes);
+            shaders.environment.viewportTransformState = reader.Read<u32>();
+
+            auto stageCount{reader.Read<u32>()};
+            for (u32 i{}; i < stageCount; i++) {
+                auto &stage{shaders.stages.emplace_back()};
+                stage.stage = reader.Read<u32>();
+                reader.ReadContainer(stage.spirv);
+
+                auto &info{stage.info};
+                reader.ReadContainer(info.constant_buffer_descriptors);
+                reader.ReadContainer(info.storage_buffers_descriptors);
+                reader.ReadContainer(info.texture_buffer_descriptors);
+                reader.ReadContainer(info.image_buffer_descriptors);
+                reader.ReadContainer(info.texture_descriptors);
+                reader.ReadContainer(info.image_descriptors);
+                info.constant_buffer_used_sizes = reader.Read<decltype(info.constant_buffer_used_sizes)>();
+                info.loads = reader.Read<decltype(info.loads)>();
+            }
+
+            return shaders;
+        }
+    }
+
+    constexpr std::string_view DiskCacheFileName{"shaders/spirv.bin"}; //!< The path of the file in the cache filesystem that holds the SPIR-V cache
+
+    void ShaderManager::LoadDiskCache(const std::shared_ptr<vfs::FileSystem> &cacheFileSystem, std::string_view driverLabel) {
+        auto properties{gpu.vkPhysicalDevice.getProperties()};
+        DiskCacheHeader expectedHeader{
+            .vendorId = properties.vendorID,
+            .deviceId = properties.deviceID,
+            .driverVersion = properties.driverVersion,
+            .driverLabelHash = XXH64(driverLabel.data(), driverLabel.size(), 0),
         };
 
-        return (*gpu.vkDevice).createShaderModule(createInfo, nullptr, *gpu.vkDevice.getDispatcher());
+        std::scoped_lock lock{diskCacheMutex};
+        std::string fileName{DiskCacheFileName};
+        try {
+            if (!cacheFileSystem->FileExists(fileName) && !cacheFileSystem->CreateFile(fileName, 0))
+                throw exception("Failed to create shader cache file");
+
+            diskCacheBacking = cacheFileSystem->OpenFile(fileName, {true, true, true});
+
+            size_t validSize{};
+            if (diskCacheBacking->size >= sizeof(DiskCacheHeader) && diskCacheBacking->Read<DiskCacheHeader>() == expectedHeader) {
+                std::vector<u8> data(diskCacheBacking->size);
+                diskCacheBacking->Read(span{data});
+
+                // Entries are parsed until the first invalid one, anything after it is likely from an interrupted write and is discarded
+                size_t offset{sizeof(DiskCacheHeader)};
+                while (offset + sizeof(DiskCacheEntryHeader) <= data.size()) {
+                    DiskCacheEntryHeader entryHeader;
+                    std::memcpy(&entryHeader, data.data() + offset, sizeof(DiskCacheEntryHeader));
+
+                    size_t entryOffset{offset + sizeof(DiskCacheEntryHeader)};
+                    if (entryHeader.size > data.size() - entryOffset || XXH64(data.data() + entryOffset, entryHeader.size, 0) != entryHeader.hash)
+                        break;
+
+                    try {
+                        CacheReader reader{span<const u8>{data.data() + entryOffset, entryHeader.size}};
+                        diskCache.insert_or_assign(entryHeader.key, std::make_shared<const CachedShaders>(DeserializeCachedShaders(reader)));
+                    } catch (const std::exception &e) {
+                        Logger::Warn("Failed to deserialize shader cache entry 0x{:016X}: {}", entryHeader.key, e.what());
+                        break;
+                    }
+
+                    offset = entryOffset + entryHeader.size;
+                }
+
+                validSize = offset;
+                Logger::Info("Loaded {} shader cache entries", diskCache.size());
+            }
+
+            if (validSize != diskCacheBacking->size) {
+                if (!validSize) {
+                    diskCacheBacking->Resize(0);
+                    diskCacheBacking->Write(span<DiskCacheHeader>{expectedHeader}.cast<u8>());
+                } else {
+                    diskCacheBacking->Resize(validSize);
+                }
+            }
+        } catch (const std::exception &e) {
+            Logger::Warn("Failed to load shader cache: {}", e.what());
+            diskCache.clear();
+            diskCacheBacking = nullptr;
+        }
+    }
+
+    std::shared_ptr<const ShaderManager::CachedShaders> ShaderManager::LookupCachedShaders(u64 key) {
+        std::scoped_lock lock{diskCacheMutex};
+        auto it{diskCache.find(key)};
+        return it != diskCache.end() ? it->second : nullptr;
     }
 
-    void ShaderManager::ResetPools() {
-        std::scoped_lock lock{poolMutex};
+    void ShaderManager::StoreCachedShaders(u64 key, CachedShaders &&shaders) {
+        std::scoped_lock lock{diskCacheMutex};
+        if (!diskCacheBacking)
+            return; // There's no point in caching shaders in-memory when the pipelines themselves are cached
+
+        CacheWriter writer;
+        DiskCacheEntryHeader entryHeader{.key = key};
+        writer.Write(entryHeader);
+        SerializeCachedShaders(writer, shaders);
+
+        auto &header{*reinterpret_cast<DiskCacheEntryHeader *>(writer.buffer.data())};
+        header.size = writer.buffer.size() - sizeof(DiskCacheEntryHeader);
+        header.hash = XXH64(writer.buffer.data() + sizeof(DiskCacheEntryHeader), header.size, 0);
+
+        try {
+            diskCacheBacking->Write(span{writer.buffer}, diskCacheBacking->size);
+        } catch (const std::exception &e) {
+            Logger::Warn("Failed to write to shader cache, disabling it: {}", e.what());
+            diskCacheBacking = nullptr;
+        }
+
+        diskCache.insert_or_assign(key, std::make_shared<const CachedShaders>(std::move(shaders)));
+    }
+
+    std::shared_ptr<ShaderManager::Pools> ShaderManager::AcquirePools() {
+        std::unique_ptr<Pools> pools;
+        {
+            std::scoped_lock lock{poolMutex};
+            if (!freePools.empty()) {
+                pools = std::move(freePools.back());
+                freePools.pop_back();
+            }
+        }
+
+        if (!pools)
+            pools = std::make_unique<Pools>();
+
+        return std::shared_ptr<Pools>{pools.release(), [this](Pools *pools) {
+            pools->instructionPool.ReleaseContents();
+            pools->blockPool.ReleaseContents();
+            pools->flowBlockPool.ReleaseContents();
 
-        instructionPool.ReleaseContents();
-        blockPool.ReleaseContents();
-        flowBlockPool.ReleaseContents();
+            std::scoped_lock lock{poolMutex};
+            freePools.emplace_back(pools);
+        }};
     }
 }
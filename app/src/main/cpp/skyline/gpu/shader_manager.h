@@ -14,6 +14,7 @@
 #include <shader_compiler/runtime_info.h>
 #include <shader_compiler/backend/bindings.h>
 #include <common.h>
+#include <vfs/filesystem.h>
 
 namespace skyline::gpu {
     /**
@@ -24,32 +25,175 @@ namespace skyline::gpu {
         GPU &gpu;
         Shader::HostTranslateInfo hostTranslateInfo;
         Shader::Profile profile;
-        Shader::ObjectPool<Shader::Maxwell::Flow::Block> flowBlockPool;
-        Shader::ObjectPool<Shader::IR::Inst> instructionPool;
-        Shader::ObjectPool<Shader::IR::Block> blockPool;
-        std::mutex poolMutex;
+
+      public:
+        /**
+         * @brief A set of object pools which back the IR of translated shader programs
+         * @note Programs are only valid for as long as the pools they were translated with, each set of pools must only be used by a single thread at a time
+         */
+        struct Pools {
+            Shader::ObjectPool<Shader::Maxwell::Flow::Block> flowBlockPool;
+            Shader::ObjectPool<Shader::IR::Inst> instructionPool;
+            Shader::ObjectPool<Shader::IR::Block> blockPool;
+        };
+
+      private:
+        std::mutex poolMutex; //!< Synchronizes access to the free pools
+        std::vector<std::unique_ptr<Pools>> freePools; //!< Pools which have been released and can be reused, reusing them avoids reallocating their underlying chunks
 
       public:
         using ConstantBufferRead = std::function<u32(u32 index, u32 offset)>; //!< A function which reads a constant buffer at the specified offset and returns the value
         using GetTextureType = std::function<Shader::TextureType(u32 handle)>; //!< A function which determines the type of a texture from its handle by checking the corresponding TIC
+        using GetViewportTransformState = std::function<u32()>; //!< A function which returns 1 if the viewport transform is enabled and 0 otherwise
+
+        /**
+         * @brief All guest state that was read during the translation of a set of shaders, any cached SPIR-V is only valid while this state remains the same
+         * @note The stage of each record is an arbitrary index defined by the user of the cache
+         */
+        struct EnvironmentRecord {
+            struct ConstantBufferValue {
+                u32 stage;
+                u32 index;
+                u32 offset;
+                u32 value;
+
+                bool operator==(const ConstantBufferValue &) const = default;
+            };
+
+            struct TextureTypeValue {
+                u32 stage;
+                u32 handle;
+                Shader::TextureType type;
+
+                bool operator==(const TextureTypeValue &) const = default;
+            };
+
+            std::vector<ConstantBufferValue> constantBufferReads;
+            std::vector<TextureTypeValue> textureTypes;
+
+            static constexpr u32 UnreadViewportTransformState{~0U}; //!< The viewport transform state wasn't read by any stage, shaders are valid regardless of it
+            u32 viewportTransformState{UnreadViewportTransformState};
+
+            /**
+             * @brief Wraps a constant buffer read function to record all values that are read through it
+             */
+            ConstantBufferRead Record(u32 stage, ConstantBufferRead read);
+
+            /**
+             * @brief Wraps a texture type lookup function to record all types that are looked up through it
+             */
+            GetTextureType Record(u32 stage, GetTextureType getType);
+
+            /**
+             * @brief Wraps a viewport transform state lookup function to record the state if any stage depends on it
+             */
+            GetViewportTransformState Record(GetViewportTransformState getState);
+        };
+
+        /**
+         * @brief A single stage of cached SPIR-V alongside the subset of the shader info that is required to bind resources to it
+         */
+        struct CachedShaderStage {
+            u32 stage; //!< An arbitrary index defined by the user of the cache
+            std::vector<u32> spirv;
+            Shader::Info info;
+        };
+
+        /**
+         * @brief A set of shader stages that were compiled together and the guest state they were compiled with
+         */
+        struct CachedShaders {
+            EnvironmentRecord environment;
+            std::vector<CachedShaderStage> stages;
+        };
+
+      private:
+        /**
+         * @brief The header at the start of the on-disk shader cache, any mismatch results in the cache being discarded
+         */
+        struct DiskCacheHeader {
+            static constexpr u32 Magic{util::MakeMagic<u32>("SSPV")}; //!< "Skyline SPIR-V"
+            static constexpr u32 Version{2}; //!< The version of the format, this must be incremented on any change to the format or to the shader compiler which affects codegen
+
+            u32 magic{Magic};
+            u32 version{Version};
+            u32 vendorId;
+            u32 deviceId;
+            u32 driverVersion;
+            u32 _pad_{};
+            u64 driverLabelHash; //!< A hash of the label of the custom GPU driver in use, the profile we compile for depends on the driver
+
+            bool operator==(const DiskCacheHeader &) const = default;
+        };
+        static_assert(sizeof(DiskCacheHeader) == 0x20);
+
+        /**
+         * @brief The header of each entry in the on-disk shader cache, entries are appended to the file as they are compiled
+         */
+        struct DiskCacheEntryHeader {
+            u64 key;
+            u64 size; //!< The size of the serialized entry following the header
+            u64 hash; //!< An XXH64 hash of the serialized entry
+        };
+
+        std::mutex diskCacheMutex; //!< Synchronizes access to the on-disk cache and the in-memory copy of it
+        std::shared_ptr<vfs::Backing> diskCacheBacking; //!< The file backing the on-disk cache, this is null if no disk cache is in use
+        std::unordered_map<u64, std::shared_ptr<const CachedShaders>> diskCache; //!< An in-memory copy of all entries in the on-disk cache, entries are reference counted as they may be replaced while in use by another thread
 
+        std::mutex shaderModuleMutex; //!< Synchronizes access to the shader module map
+        std::unordered_map<u64, vk::ShaderModule> shaderModules; //!< All created shader modules keyed by a hash of their SPIR-V, identical shaders share a module so that pipeline libraries built from them can be reused
+
+      public:
         ShaderManager(const DeviceState &state, GPU &gpu);
 
+        /**
+         * @brief Loads all entries from the on-disk shader cache in the supplied filesystem, any shaders stored after this will be persisted to it
+         * @param driverLabel The label of the custom GPU driver in use, this should be empty for the system driver
+         */
+        void LoadDiskCache(const std::shared_ptr<vfs::FileSystem> &cacheFileSystem, std::string_view driverLabel);
+
+        /**
+         * @return The cached shaders corresponding to the key or nullptr if there are none
+         * @note The environment of the cached shaders must be validated against the current guest state by the caller
+         */
+        std::shared_ptr<const CachedShaders> LookupCachedShaders(u64 key);
+
+        /**
+         * @brief Stores a set of shaders in the cache and appends it to the on-disk cache if there is one, this replaces any shaders with the same key
+         */
+        void StoreCachedShaders(u64 key, CachedShaders &&shaders);
+
+        /**
+         * @return A set of pools that can be used for translating shaders, they'll be reset and returned to the manager for reuse once the last reference is dropped
+         * @note Any programs translated using the pools must be destroyed prior to the pools
+         */
+        std::shared_ptr<Pools> AcquirePools();
+
         /**
          * @return A shader program that corresponds to all the supplied state including the current state of the constant buffers
          */
-        Shader::IR::Program ParseGraphicsShader(const std::array<u32, 8> &postVtgShaderAttributeSkipMask, Shader::Stage stage, span<u8> binary, u32 baseOffset, u32 textureConstantBufferIndex, bool viewportTransformEnabled, const ConstantBufferRead &constantBufferRead, const GetTextureType &getTextureType);
+        Shader::IR::Program ParseGraphicsShader(Pools &pools, const std::array<u32, 8> &postVtgShaderAttributeSkipMask, Shader::Stage stage, span<u8> binary, u64 binaryHash, u32 baseOffset, u32 textureConstantBufferIndex, const GetViewportTransformState &getViewportTransformState, const ConstantBufferRead &constantBufferRead, const GetTextureType &getTextureType);
 
         /**
          * @brief Combines the VertexA and VertexB shader programs into a single program
          * @note VertexA/VertexB shader programs must be SingleShaderProgram and not DualVertexShaderProgram
          */
-        Shader::IR::Program CombineVertexShaders(Shader::IR::Program &vertexA, Shader::IR::Program &vertexB, span<u8> vertexBBinary);
+        Shader::IR::Program CombineVertexShaders(Shader::IR::Program &vertexA, Shader::IR::Program &vertexB, span<u8> vertexBBinary, u64 vertexBHash);
+
+        Shader::IR::Program ParseComputeShader(Pools &pools, span<u8> binary, u64 binaryHash, u32 baseOffset, u32 textureConstantBufferIndex, u32 localMemorySize, u32 sharedMemorySize, std::array<u32, 3> workgroupDimensions, const ConstantBufferRead &constantBufferRead, const GetTextureType &getTextureType);
 
-        Shader::IR::Program ParseComputeShader(span<u8> binary, u32 baseOffset, u32 textureConstantBufferIndex, u32 localMemorySize, u32 sharedMemorySize, std::array<u32, 3> workgroupDimensions, const ConstantBufferRead &constantBufferRead, const GetTextureType &getTextureType);
+        /**
+         * @return The SPIR-V for the supplied program
+         * @note This is thread-safe and may be called concurrently for programs in different pools
+         */
+        std::vector<u32> EmitShader(const Shader::RuntimeInfo &runtimeInfo, Shader::IR::Program &program, Shader::Backend::Bindings &bindings, u64 binaryHash);
 
-        vk::ShaderModule CompileShader(const Shader::RuntimeInfo &runtimeInfo, Shader::IR::Program &program, Shader::Backend::Bindings &bindings);
+        /**
+         * @return A shader module for the supplied SPIR-V, this will be an existing module if one was created with identical SPIR-V before
+         * @param binaryHash The hash of the guest shader binary the SPIR-V was emitted from, this is only used to attribute the creation time in the shader compile statistics
+         */
+        vk::ShaderModule CreateShaderModule(span<const u32> spirv, u64 binaryHash);
 
-        void ResetPools();
+        vk::ShaderModule CompileShader(const Shader::RuntimeInfo &runtimeInfo, Shader::IR::Program &program, Shader::Backend::Bindings &bindings, u64 binaryHash);
     };
 }
@@ -136,6 +136,8 @@ namespace skyline::gpu {
             .scissorCount = 1
         };
 
+        std::array<cache::GraphicsPipelineCache::AttachmentMetadata, 1> colorAttachmentMetadata{colorAttachment};
+
         return gpu.graphicsPipelineCache.GetCompiledPipeline(cache::GraphicsPipelineCache::PipelineState{
             .shaderStages = shaderStages,
             .vertexState = vertexState,
@@ -147,8 +149,8 @@ namespace skyline::gpu {
             .depthStencilState = depthStencilState,
             .colorBlendState = blendState,
             .dynamicState = {},
-            .colorAttachments = span<TextureView *>{colorAttachment},
-            .depthStencilAttachment = depthStencilAttachment,
+            .colorAttachments = colorAttachmentMetadata,
+            .depthStencilAttachment = depthStencilAttachment ? std::optional<cache::GraphicsPipelineCache::AttachmentMetadata>{depthStencilAttachment} : std::nullopt,
         }, layoutBindings, pushConstantRanges, true);
     }
 
@@ -226,7 +228,7 @@ namespace skyline::gpu {
                                 float dstSrcScaleFactorX, float dstSrcScaleFactorY,
                                 bool bilinearFilter,
                                 TextureView *srcImageView, TextureView *dstImageView,
-                                std::function<void(std::function<void(vk::raii::CommandBuffer &, const std::shared_ptr<FenceCycle> &, GPU &, vk::RenderPass, u32)> &&)> &&recordCb) {
+                                std::function<void(std::function<void(vk::raii::CommandBuffer &, const IntrusivePtr<FenceCycle> &, GPU &, vk::RenderPass, u32)> &&)> &&recordCb) {
         struct DrawState {
             blit::VertexPushConstantLayout vertexPushConstants;
             blit::FragmentPushConstantLayout fragmentPushConstants;
@@ -273,7 +275,7 @@ namespace skyline::gpu {
 
         gpu.vkDevice.updateDescriptorSets(writes, nullptr);
 
-        recordCb([drawState = std::move(drawState)](vk::raii::CommandBuffer &commandBuffer, const std::shared_ptr<FenceCycle> &cycle, GPU &gpu, vk::RenderPass, u32) {
+        recordCb([drawState = std::move(drawState)](vk::raii::CommandBuffer &commandBuffer, const IntrusivePtr<FenceCycle> &cycle, GPU &gpu, vk::RenderPass, u32) {
             cycle->AttachObject(drawState);
             commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, drawState->pipeline.pipeline);
             commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, drawState->pipeline.pipelineLayout, 0, *drawState->descriptorSet, nullptr);
@@ -306,7 +308,7 @@ namespace skyline::gpu {
         : SimpleSingleRtShader{gpu, shaderFileSystem->OpenFile("shaders/clear.vert.spv"), shaderFileSystem->OpenFile("shaders/clear.frag.spv")} {}
 
     void ClearHelperShader::Clear(GPU &gpu, vk::ImageAspectFlags mask, vk::ColorComponentFlags components, vk::ClearValue value, TextureView *dstImageView,
-                                 std::function<void(std::function<void(vk::raii::CommandBuffer &, const std::shared_ptr<FenceCycle> &, GPU &, vk::RenderPass, u32)> &&)> &&recordCb) {
+                                 std::function<void(std::function<void(vk::raii::CommandBuffer &, const IntrusivePtr<FenceCycle> &, GPU &, vk::RenderPass, u32)> &&)> &&recordCb) {
         struct DrawState {
             clear::FragmentPushConstantLayout fragmentPushConstants;
             cache::GraphicsPipelineCache::CompiledPipeline pipeline;
@@ -332,7 +334,7 @@ namespace skyline::gpu {
             GetPipeline(gpu, writeColor ? dstImageView : nullptr, (writeDepth || writeStencil) ? dstImageView : nullptr, writeDepth, writeStencil, value.depthStencil.stencil, components, {}, clear::PushConstantRanges))
         };
 
-        recordCb([drawState = std::move(drawState)](vk::raii::CommandBuffer &commandBuffer, const std::shared_ptr<FenceCycle> &cycle, GPU &gpu, vk::RenderPass, u32) {
+        recordCb([drawState = std::move(drawState)](vk::raii::CommandBuffer &commandBuffer, const IntrusivePtr<FenceCycle> &cycle, GPU &gpu, vk::RenderPass, u32) {
             cycle->AttachObject(drawState);
             commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, drawState->pipeline.pipeline);
             commandBuffer.pushConstants(drawState->pipeline.pipelineLayout, vk::ShaderStageFlagBits::eFragment, 0,
@@ -341,8 +343,783 @@ namespace skyline::gpu {
         });
     }
 
+    namespace bcn_decode {
+        struct PushConstantLayout {
+            u32 format;
+            u32 width;
+            u32 height;
+            u32 inputOffset; //!< The offset of the compressed data in words
+            u32 outputOffset; //!< The offset of the decoded data in words
+            u32 outputWordCount;
+        };
+
+        constexpr static vk::PushConstantRange PushConstantRange{
+            .stageFlags = vk::ShaderStageFlagBits::eCompute,
+            .size = sizeof(PushConstantLayout),
+            .offset = 0
+        };
+
+        constexpr static vk::DescriptorSetLayoutBinding BufferLayoutBinding{
+            .binding = 0,
+            .descriptorType = vk::DescriptorType::eStorageBuffer,
+            .descriptorCount = 1,
+            .stageFlags = vk::ShaderStageFlagBits::eCompute
+        };
+
+        constexpr static u32 WorkgroupSize{64}; //!< The amount of output words written by a single workgroup, this must match the shader
+        constexpr static u32 MaxWorkgroupCountX{65535}; //!< The minimum value of maxComputeWorkGroupCount[0] guaranteed by the Vulkan specification, larger dispatches are split over the Y dimension
+    }
+
+    BcnDecodeJob::BcnDecodeJob(BcnDecodeFormat format, DescriptorAllocator::ActiveDescriptorSet &&descriptorSet, span<const Level> levels)
+        : format{format},
+          descriptorSet{std::move(descriptorSet)},
+          levels{levels.begin(), levels.end()} {}
+
+    BcnDecodeHelperShader::BcnDecodeHelperShader(GPU &gpu, std::shared_ptr<vfs::FileSystem> shaderFileSystem)
+        : shaderModule{CreateShaderModule(gpu, *shaderFileSystem->OpenFile("shaders/bcn_decode.comp.spv"))},
+          descriptorSetLayout{gpu.vkDevice, vk::DescriptorSetLayoutCreateInfo{
+              .pBindings = &bcn_decode::BufferLayoutBinding,
+              .bindingCount = 1,
+          }},
+          pipelineLayout{gpu.vkDevice, vk::PipelineLayoutCreateInfo{
+              .pSetLayouts = &*descriptorSetLayout,
+              .setLayoutCount = 1,
+              .pPushConstantRanges = &bcn_decode::PushConstantRange,
+              .pushConstantRangeCount = 1,
+          }},
+          pipeline{gpu.vkDevice, nullptr, vk::ComputePipelineCreateInfo{
+              .stage = {
+                  .stage = vk::ShaderStageFlagBits::eCompute,
+                  .module = *shaderModule,
+                  .pName = "main",
+              },
+              .layout = *pipelineLayout,
+          }} {}
+
+    std::optional<BcnDecodeFormat> BcnDecodeHelperShader::GetDecodeFormat(vk::Format format) {
+        switch (format) {
+            case vk::Format::eBc1RgbaUnormBlock:
+            case vk::Format::eBc1RgbaSrgbBlock:
+                return BcnDecodeFormat::Bc1;
+
+            case vk::Format::eBc2UnormBlock:
+            case vk::Format::eBc2SrgbBlock:
+                return BcnDecodeFormat::Bc2;
+
+            case vk::Format::eBc3UnormBlock:
+            case vk::Format::eBc3SrgbBlock:
+                return BcnDecodeFormat::Bc3;
+
+            case vk::Format::eBc4UnormBlock:
+                return BcnDecodeFormat::Bc4Unorm;
+            case vk::Format::eBc4SnormBlock:
+                return BcnDecodeFormat::Bc4Snorm;
+
+            case vk::Format::eBc5UnormBlock:
+                return BcnDecodeFormat::Bc5Unorm;
+            case vk::Format::eBc5SnormBlock:
+                return BcnDecodeFormat::Bc5Snorm;
+
+            default:
+                return std::nullopt; // BC6H and BC7 are always decoded on the CPU
+        }
+    }
+
+    std::shared_ptr<BcnDecodeJob> BcnDecodeHelperShader::Prepare(GPU &gpu, BcnDecodeFormat format, vk::Buffer buffer, span<const BcnDecodeJob::Level> levels) {
+        auto job{std::make_shared<BcnDecodeJob>(format, gpu.descriptor.AllocateSet(*descriptorSetLayout), levels)};
+
+        vk::DescriptorBufferInfo bufferInfo{
+            .buffer = buffer,
+            .offset = 0,
+            .range = VK_WHOLE_SIZE,
+        };
+
+        gpu.vkDevice.updateDescriptorSets(vk::WriteDescriptorSet{
+            .dstSet = *job->descriptorSet,
+            .dstBinding = 0,
+            .descriptorType = vk::DescriptorType::eStorageBuffer,
+            .descriptorCount = 1,
+            .pBufferInfo = &bufferInfo,
+        }, nullptr);
+
+        return job;
+    }
+
+    void BcnDecodeHelperShader::Record(const vk::raii::CommandBuffer &commandBuffer, const BcnDecodeJob &job) {
+        commandBuffer.bindPipeline(vk::PipelineBindPoint::eCompute, *pipeline);
+        commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eCompute, *pipelineLayout, 0, *job.descriptorSet, nullptr);
+
+        for (const auto &level : job.levels) {
+            bcn_decode::PushConstantLayout pushConstants{
+                .format = static_cast<u32>(job.format),
+                .width = level.width,
+                .height = level.height,
+                .inputOffset = static_cast<u32>(level.inputOffset / sizeof(u32)),
+                .outputOffset = static_cast<u32>(level.outputOffset / sizeof(u32)),
+                .outputWordCount = static_cast<u32>(util::DivideCeil<vk::DeviceSize>(level.outputSize, sizeof(u32))),
+            };
+            if (!pushConstants.outputWordCount)
+                continue;
+
+            commandBuffer.pushConstants(*pipelineLayout, vk::ShaderStageFlagBits::eCompute, 0, vk::ArrayProxy<const bcn_decode::PushConstantLayout>{pushConstants});
+
+            u32 workgroupCount{util::DivideCeil(pushConstants.outputWordCount, bcn_decode::WorkgroupSize)};
+            u32 workgroupCountX{std::min(workgroupCount, bcn_decode::MaxWorkgroupCountX)};
+            commandBuffer.dispatch(workgroupCountX, util::DivideCeil(workgroupCount, workgroupCountX), 1);
+        }
+
+        commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eTransfer, {}, vk::MemoryBarrier{
+            .srcAccessMask = vk::AccessFlagBits::eShaderWrite,
+            .dstAccessMask = vk::AccessFlagBits::eTransferRead,
+        }, {}, {});
+    }
+
+    namespace block_linear {
+        struct PushConstantLayout {
+            u32 linearOffset; //!< The offset of the linear data in words
+            u32 linearLayerStride; //!< The stride between layers of linear data in words
+            u32 blockLinearOffset; //!< The offset of the block-linear data in words
+            u32 blockLinearLayerStride; //!< The stride between layers of block-linear data in words
+            u32 rowWordCount;
+            u32 lineCount;
+            u32 widthInGobs;
+            u32 gobBlockHeightLog2;
+            u32 toBlockLinear;
+        };
+
+        constexpr static vk::PushConstantRange PushConstantRange{
+            .stageFlags = vk::ShaderStageFlagBits::eCompute,
+            .size = sizeof(PushConstantLayout),
+            .offset = 0
+        };
+
+        constexpr static u32 GobWidth{64}; //!< The width of a GOB in bytes
+        constexpr static u32 WorkgroupSize{64}; //!< The amount of words moved by a single workgroup, this must match the shader
+    }
+
+    BlockLinearJob::BlockLinearJob(bool toBlockLinear, DescriptorAllocator::ActiveDescriptorSet &&descriptorSet, span<const Level> levels)
+        : toBlockLinear{toBlockLinear},
+          descriptorSet{std::move(descriptorSet)},
+          levels{levels.begin(), levels.end()} {}
+
+    BlockLinearHelperShader::BlockLinearHelperShader(GPU &gpu, std::shared_ptr<vfs::FileSystem> shaderFileSystem)
+        : shaderModule{CreateShaderModule(gpu, *shaderFileSystem->OpenFile("shaders/block_linear.comp.spv"))},
+          descriptorSetLayout{gpu.vkDevice, vk::DescriptorSetLayoutCreateInfo{
+              .pBindings = &bcn_decode::BufferLayoutBinding,
+              .bindingCount = 1,
+          }},
+          pipelineLayout{gpu.vkDevice, vk::PipelineLayoutCreateInfo{
+              .pSetLayouts = &*descriptorSetLayout,
+              .setLayoutCount = 1,
+              .pPushConstantRanges = &block_linear::PushConstantRange,
+              .pushConstantRangeCount = 1,
+          }},
+          pipeline{gpu.vkDevice, nullptr, vk::ComputePipelineCreateInfo{
+              .stage = {
+                  .stage = vk::ShaderStageFlagBits::eCompute,
+                  .module = *shaderModule,
+                  .pName = "main",
+              },
+              .layout = *pipelineLayout,
+          }} {}
+
+    std::shared_ptr<BlockLinearJob> BlockLinearHelperShader::Prepare(GPU &gpu, bool toBlockLinear, vk::Buffer buffer, span<const BlockLinearJob::Level> levels) {
+        auto job{std::make_shared<BlockLinearJob>(toBlockLinear, gpu.descriptor.AllocateSet(*descriptorSetLayout), levels)};
+
+        vk::DescriptorBufferInfo bufferInfo{
+            .buffer = buffer,
+            .offset = 0,
+            .range = VK_WHOLE_SIZE,
+        };
+
+        gpu.vkDevice.updateDescriptorSets(vk::WriteDescriptorSet{
+            .dstSet = *job->descriptorSet,
+            .dstBinding = 0,
+            .descriptorType = vk::DescriptorType::eStorageBuffer,
+            .descriptorCount = 1,
+            .pBufferInfo = &bufferInfo,
+        }, nullptr);
+
+        return job;
+    }
+
+    void BlockLinearHelperShader::Record(const vk::raii::CommandBuffer &commandBuffer, const BlockLinearJob &job) {
+        commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eHost | vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eComputeShader, {}, vk::MemoryBarrier{
+            .srcAccessMask = vk::AccessFlagBits::eHostWrite | vk::AccessFlagBits::eTransferWrite,
+            .dstAccessMask = vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite,
+        }, {}, {});
+
+        commandBuffer.bindPipeline(vk::PipelineBindPoint::eCompute, *pipeline);
+        commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eCompute, *pipelineLayout, 0, *job.descriptorSet, nullptr);
+
+        for (const auto &level : job.levels) {
+            block_linear::PushConstantLayout pushConstants{
+                .linearOffset = static_cast<u32>(level.linearOffset / sizeof(u32)),
+                .linearLayerStride = static_cast<u32>(level.linearLayerStride / sizeof(u32)),
+                .blockLinearOffset = static_cast<u32>(level.blockLinearOffset / sizeof(u32)),
+                .blockLinearLayerStride = static_cast<u32>(level.blockLinearLayerStride / sizeof(u32)),
+                .rowWordCount = level.rowSize / static_cast<u32>(sizeof(u32)),
+                .lineCount = level.lineCount,
+                .widthInGobs = util::DivideCeil(level.rowSize, block_linear::GobWidth),
+                .gobBlockHeightLog2 = static_cast<u32>(std::countr_zero(level.gobBlockHeight)),
+                .toBlockLinear = job.toBlockLinear,
+            };
+
+            u32 wordCount{pushConstants.rowWordCount * pushConstants.lineCount};
+            if (!wordCount || !level.layerCount)
+                continue;
+
+            commandBuffer.pushConstants(*pipelineLayout, vk::ShaderStageFlagBits::eCompute, 0, vk::ArrayProxy<const block_linear::PushConstantLayout>{pushConstants});
+
+            u32 workgroupCount{util::DivideCeil(wordCount, block_linear::WorkgroupSize)};
+            u32 workgroupCountX{std::min(workgroupCount, bcn_decode::MaxWorkgroupCountX)};
+            commandBuffer.dispatch(workgroupCountX, util::DivideCeil(workgroupCount, workgroupCountX), level.layerCount);
+        }
+
+        commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eTransfer | vk::PipelineStageFlagBits::eComputeShader | vk::PipelineStageFlagBits::eHost, {}, vk::MemoryBarrier{
+            .srcAccessMask = vk::AccessFlagBits::eShaderWrite,
+            .dstAccessMask = vk::AccessFlagBits::eTransferRead | vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eHostRead,
+        }, {}, {});
+    }
+
+    namespace format_conversion {
+        struct PushConstantLayout {
+            u32 conversion;
+            u32 texelCount;
+            u32 inputOffset; //!< The offset of the source texels in words
+            u32 outputOffset; //!< The offset of the converted texels in words
+            u32 outputWordCount;
+            u32 alphaOne;
+        };
+
+        constexpr static vk::PushConstantRange PushConstantRange{
+            .stageFlags = vk::ShaderStageFlagBits::eCompute,
+            .size = sizeof(PushConstantLayout),
+            .offset = 0
+        };
+
+        constexpr static u32 WorkgroupSize{64}; //!< The amount of output words written by a single workgroup, this must match the shader
+
+        /**
+         * @return The size of a single converted texel in bytes
+         */
+        constexpr u32 GetOutputTexelSize(FormatConversion conversion) {
+            switch (conversion) {
+                case FormatConversion::SwapR5B5:
+                case FormatConversion::B5G5R5A1ToA1R5G5B5:
+                case FormatConversion::A1R5G5B5ToB5G5R5A1:
+                    return 2;
+
+                case FormatConversion::R16G16B16A16ToR16G16B16:
+                    return 6;
+
+                case FormatConversion::R16G16B16A16ToB10G11R11:
+                    return 4;
+
+                case FormatConversion::R16G16B16ToR16G16B16A16:
+                case FormatConversion::B10G11R11ToR16G16B16A16:
+                    break;
+            }
+            return 8;
+        }
+
+        /**
+         * @return The encoding of an alpha value of one in the supplied format, this is only required for formats that an alpha channel can be added to
+         */
+        constexpr u32 GetAlphaOne(vk::Format format) {
+            switch (format) {
+                case vk::Format::eR16G16B16A16Unorm:
+                    return 0xFFFF;
+                case vk::Format::eR16G16B16A16Snorm:
+                    return 0x7FFF;
+                case vk::Format::eR16G16B16A16Uint:
+                case vk::Format::eR16G16B16A16Sint:
+                    return 1;
+                case vk::Format::eR16G16B16A16Sfloat:
+                    return 0x3C00; // 1.0 as a half float
+
+                default:
+                    return 0;
+            }
+        }
+
+        /**
+         * @return The 4-component variant of a 3-component 16-bit format, or vk::Format::eUndefined if there isn't one
+         */
+        constexpr vk::Format GetR16G16B16A16Variant(vk::Format format) {
+            switch (format) {
+                case vk::Format::eR16G16B16Unorm:
+                    return vk::Format::eR16G16B16A16Unorm;
+                case vk::Format::eR16G16B16Snorm:
+                    return vk::Format::eR16G16B16A16Snorm;
+                case vk::Format::eR16G16B16Uint:
+                    return vk::Format::eR16G16B16A16Uint;
+                case vk::Format::eR16G16B16Sint:
+                    return vk::Format::eR16G16B16A16Sint;
+                case vk::Format::eR16G16B16Sfloat:
+                    return vk::Format::eR16G16B16A16Sfloat;
+
+                default:
+                    return vk::Format::eUndefined;
+            }
+        }
+    }
+
+    FormatConversionJob::FormatConversionJob(FormatConversion conversion, u32 alphaOne, u32 texelCount, vk::DeviceSize inputOffset, vk::DeviceSize outputOffset, DescriptorAllocator::ActiveDescriptorSet &&descriptorSet)
+        : conversion{conversion},
+          alphaOne{alphaOne},
+          texelCount{texelCount},
+          inputOffset{inputOffset},
+          outputOffset{outputOffset},
+          descriptorSet{std::move(descriptorSet)} {}
+
+    FormatConversionHelperShader::FormatConversionHelperShader(GPU &gpu, std::shared_ptr<vfs::FileSystem> shaderFileSystem)
+        : shaderModule{CreateShaderModule(gpu, *shaderFileSystem->OpenFile("shaders/format_conversion.comp.spv"))},
+          descriptorSetLayout{gpu.vkDevice, vk::DescriptorSetLayoutCreateInfo{
+              .pBindings = &bcn_decode::BufferLayoutBinding,
+              .bindingCount = 1,
+          }},
+          pipelineLayout{gpu.vkDevice, vk::PipelineLayoutCreateInfo{
+              .pSetLayouts = &*descriptorSetLayout,
+              .setLayoutCount = 1,
+              .pPushConstantRanges = &format_conversion::PushConstantRange,
+              .pushConstantRangeCount = 1,
+          }},
+          pipeline{gpu.vkDevice, nullptr, vk::ComputePipelineCreateInfo{
+              .stage = {
+                  .stage = vk::ShaderStageFlagBits::eCompute,
+                  .module = *shaderModule,
+                  .pName = "main",
+              },
+              .layout = *pipelineLayout,
+          }} {}
+
+    std::optional<FormatConversion> FormatConversionHelperShader::GetConversion(vk::Format source, vk::Format destination) {
+        if ((source == vk::Format::eB5G6R5UnormPack16 && destination == vk::Format::eR5G6B5UnormPack16) || (source == vk::Format::eR5G6B5UnormPack16 && destination == vk::Format::eB5G6R5UnormPack16))
+            return FormatConversion::SwapR5B5;
+
+        if (source == vk::Format::eB5G5R5A1UnormPack16 && destination == vk::Format::eA1R5G5B5UnormPack16)
+            return FormatConversion::B5G5R5A1ToA1R5G5B5;
+        if (source == vk::Format::eA1R5G5B5UnormPack16 && destination == vk::Format::eB5G5R5A1UnormPack16)
+            return FormatConversion::A1R5G5B5ToB5G5R5A1;
+
+        if (format_conversion::GetR16G16B16A16Variant(source) == destination && destination != vk::Format::eUndefined)
+            return FormatConversion::R16G16B16ToR16G16B16A16;
+        if (format_conversion::GetR16G16B16A16Variant(destination) == source && source != vk::Format::eUndefined)
+            return FormatConversion::R16G16B16A16ToR16G16B16;
+
+        if (source == vk::Format::eB10G11R11UfloatPack32 && destination == vk::Format::eR16G16B16A16Sfloat)
+            return FormatConversion::B10G11R11ToR16G16B16A16;
+        if (source == vk::Format::eR16G16B16A16Sfloat && destination == vk::Format::eB10G11R11UfloatPack32)
+            return FormatConversion::R16G16B16A16ToB10G11R11;
+
+        return std::nullopt;
+    }
+
+    std::shared_ptr<FormatConversionJob> FormatConversionHelperShader::Prepare(GPU &gpu, vk::Format source, vk::Format destination, vk::Buffer buffer, u32 texelCount, vk::DeviceSize inputOffset, vk::DeviceSize outputOffset) {
+        auto job{std::make_shared<FormatConversionJob>(*GetConversion(source, destination), format_conversion::GetAlphaOne(destination), texelCount, inputOffset, outputOffset, gpu.descriptor.AllocateSet(*descriptorSetLayout))};
+
+        vk::DescriptorBufferInfo bufferInfo{
+            .buffer = buffer,
+            .offset = 0,
+            .range = VK_WHOLE_SIZE,
+        };
+
+        gpu.vkDevice.updateDescriptorSets(vk::WriteDescriptorSet{
+            .dstSet = *job->descriptorSet,
+            .dstBinding = 0,
+            .descriptorType = vk::DescriptorType::eStorageBuffer,
+            .descriptorCount = 1,
+            .pBufferInfo = &bufferInfo,
+        }, nullptr);
+
+        return job;
+    }
+
+    void FormatConversionHelperShader::Record(const vk::raii::CommandBuffer &commandBuffer, const FormatConversionJob &job) {
+        format_conversion::PushConstantLayout pushConstants{
+            .conversion = static_cast<u32>(job.conversion),
+            .texelCount = job.texelCount,
+            .inputOffset = static_cast<u32>(job.inputOffset / sizeof(u32)),
+            .outputOffset = static_cast<u32>(job.outputOffset / sizeof(u32)),
+            .outputWordCount = static_cast<u32>(util::DivideCeil<vk::DeviceSize>(static_cast<vk::DeviceSize>(job.texelCount) * format_conversion::GetOutputTexelSize(job.conversion), sizeof(u32))),
+            .alphaOne = job.alphaOne,
+        };
+        if (!pushConstants.outputWordCount)
+            return;
+
+        commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eHost | vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eComputeShader, {}, vk::MemoryBarrier{
+            .srcAccessMask = vk::AccessFlagBits::eHostWrite | vk::AccessFlagBits::eTransferWrite,
+            .dstAccessMask = vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite,
+        }, {}, {});
+
+        commandBuffer.bindPipeline(vk::PipelineBindPoint::eCompute, *pipeline);
+        commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eCompute, *pipelineLayout, 0, *job.descriptorSet, nullptr);
+        commandBuffer.pushConstants(*pipelineLayout, vk::ShaderStageFlagBits::eCompute, 0, vk::ArrayProxy<const format_conversion::PushConstantLayout>{pushConstants});
+
+        u32 workgroupCount{util::DivideCeil(pushConstants.outputWordCount, format_conversion::WorkgroupSize)};
+        u32 workgroupCountX{std::min(workgroupCount, bcn_decode::MaxWorkgroupCountX)};
+        commandBuffer.dispatch(workgroupCountX, util::DivideCeil(workgroupCount, workgroupCountX), 1);
+
+        commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eTransfer | vk::PipelineStageFlagBits::eComputeShader | vk::PipelineStageFlagBits::eHost, {}, vk::MemoryBarrier{
+            .srcAccessMask = vk::AccessFlagBits::eShaderWrite,
+            .dstAccessMask = vk::AccessFlagBits::eTransferRead | vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eHostRead,
+        }, {}, {});
+    }
+
+    namespace quad_conversion {
+        struct PushConstantLayout {
+            u32 sourceOffset; //!< The offset of the source indices in bytes
+            u32 indexSizeLog2;
+            u32 destinationOffset; //!< The offset of the converted indices in words
+            u32 quadCount;
+        };
+
+        constexpr static vk::PushConstantRange PushConstantRange{
+            .stageFlags = vk::ShaderStageFlagBits::eCompute,
+            .size = sizeof(PushConstantLayout),
+            .offset = 0
+        };
+
+        constexpr static std::array<vk::DescriptorSetLayoutBinding, 2> BufferLayoutBindings{
+            vk::DescriptorSetLayoutBinding{
+                .binding = 0,
+                .descriptorType = vk::DescriptorType::eStorageBuffer,
+                .descriptorCount = 1,
+                .stageFlags = vk::ShaderStageFlagBits::eCompute
+            },
+            vk::DescriptorSetLayoutBinding{
+                .binding = 1,
+                .descriptorType = vk::DescriptorType::eStorageBuffer,
+                .descriptorCount = 1,
+                .stageFlags = vk::ShaderStageFlagBits::eCompute
+            }
+        };
+
+        constexpr static u32 WorkgroupSize{64}; //!< The amount of quads converted by a single workgroup, this must match the shader
+    }
+
+    QuadConversionJob::QuadConversionJob(DescriptorAllocator::ActiveDescriptorSet &&descriptorSet) : descriptorSet{std::move(descriptorSet)} {}
+
+    QuadConversionHelperShader::QuadConversionHelperShader(GPU &gpu, std::shared_ptr<vfs::FileSystem> shaderFileSystem)
+        : shaderModule{CreateShaderModule(gpu, *shaderFileSystem->OpenFile("shaders/quad_conversion.comp.spv"))},
+          descriptorSetLayout{gpu.vkDevice, vk::DescriptorSetLayoutCreateInfo{
+              .pBindings = quad_conversion::BufferLayoutBindings.data(),
+              .bindingCount = static_cast<u32>(quad_conversion::BufferLayoutBindings.size()),
+          }},
+          pipelineLayout{gpu.vkDevice, vk::PipelineLayoutCreateInfo{
+              .pSetLayouts = &*descriptorSetLayout,
+              .setLayoutCount = 1,
+              .pPushConstantRanges = &quad_conversion::PushConstantRange,
+              .pushConstantRangeCount = 1,
+          }},
+          pipeline{gpu.vkDevice, nullptr, vk::ComputePipelineCreateInfo{
+              .stage = {
+                  .stage = vk::ShaderStageFlagBits::eCompute,
+                  .module = *shaderModule,
+                  .pName = "main",
+              },
+              .layout = *pipelineLayout,
+          }} {}
+
+    vk::IndexType QuadConversionHelperShader::GetOutputIndexType(u32 indexSize) {
+        return indexSize == sizeof(u32) ? vk::IndexType::eUint32 : vk::IndexType::eUint16;
+    }
+
+    vk::DeviceSize QuadConversionHelperShader::GetOutputSize(u32 indexSize, u32 indexCount) {
+        return static_cast<vk::DeviceSize>(indexCount / 4) * 6 * (indexSize == sizeof(u32) ? sizeof(u32) : sizeof(u16));
+    }
+
+    std::shared_ptr<QuadConversionJob> QuadConversionHelperShader::Prepare(GPU &gpu) {
+        return std::make_shared<QuadConversionJob>(gpu.descriptor.AllocateSet(*descriptorSetLayout));
+    }
+
+    void QuadConversionHelperShader::Record(GPU &gpu, const vk::raii::CommandBuffer &commandBuffer, const QuadConversionJob &job,
+                                            vk::Buffer source, vk::DeviceSize sourceOffset, u32 indexSize, u32 indexCount,
+                                            vk::Buffer destination, vk::DeviceSize destinationOffset) {
+        u32 quadCount{indexCount / 4};
+        if (!quadCount)
+            return;
+
+        std::array<vk::DescriptorBufferInfo, 2> bufferInfos{
+            vk::DescriptorBufferInfo{
+                .buffer = source,
+                .offset = 0,
+                .range = VK_WHOLE_SIZE,
+            },
+            vk::DescriptorBufferInfo{
+                .buffer = destination,
+                .offset = 0,
+                .range = VK_WHOLE_SIZE,
+            }
+        };
+
+        gpu.vkDevice.updateDescriptorSets(vk::WriteDescriptorSet{
+            .dstSet = *job.descriptorSet,
+            .dstBinding = 0,
+            .descriptorType = vk::DescriptorType::eStorageBuffer,
+            .descriptorCount = static_cast<u32>(bufferInfos.size()),
+            .pBufferInfo = bufferInfos.data(),
+        }, nullptr);
+
+        commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eAllCommands, vk::PipelineStageFlagBits::eComputeShader, {}, vk::MemoryBarrier{
+            .srcAccessMask = vk::AccessFlagBits::eMemoryWrite,
+            .dstAccessMask = vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite,
+        }, {}, {});
+
+        commandBuffer.bindPipeline(vk::PipelineBindPoint::eCompute, *pipeline);
+        commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eCompute, *pipelineLayout, 0, *job.descriptorSet, nullptr);
+
+        quad_conversion::PushConstantLayout pushConstants{
+            .sourceOffset = static_cast<u32>(sourceOffset),
+            .indexSizeLog2 = static_cast<u32>(std::countr_zero(indexSize)),
+            .destinationOffset = static_cast<u32>(destinationOffset / sizeof(u32)),
+            .quadCount = quadCount,
+        };
+        commandBuffer.pushConstants(*pipelineLayout, vk::ShaderStageFlagBits::eCompute, 0, vk::ArrayProxy<const quad_conversion::PushConstantLayout>{pushConstants});
+
+        u32 workgroupCount{util::DivideCeil(quadCount, quad_conversion::WorkgroupSize)};
+        u32 workgroupCountX{std::min(workgroupCount, bcn_decode::MaxWorkgroupCountX)};
+        commandBuffer.dispatch(workgroupCountX, util::DivideCeil(workgroupCount, workgroupCountX), 1);
+
+        commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eVertexInput, {}, vk::MemoryBarrier{
+            .srcAccessMask = vk::AccessFlagBits::eShaderWrite,
+            .dstAccessMask = vk::AccessFlagBits::eIndexRead,
+        }, {}, {});
+    }
+
+    namespace spatial_upscale {
+        struct PushConstantLayout {
+            u32 sourceWidth;
+            u32 sourceHeight;
+            u32 destinationWidth;
+            u32 destinationHeight;
+            float sharpness; //!< The strength of the sharpening applied after upscaling, in the range [0, 1]
+        };
+
+        constexpr static vk::PushConstantRange PushConstantRange{
+            .stageFlags = vk::ShaderStageFlagBits::eCompute,
+            .size = sizeof(PushConstantLayout),
+            .offset = 0
+        };
+
+        constexpr static std::array<vk::DescriptorSetLayoutBinding, 2> ImageLayoutBindings{
+            vk::DescriptorSetLayoutBinding{
+                .binding = 0,
+                .descriptorType = vk::DescriptorType::eCombinedImageSampler,
+                .descriptorCount = 1,
+                .stageFlags = vk::ShaderStageFlagBits::eCompute
+            },
+            vk::DescriptorSetLayoutBinding{
+                .binding = 1,
+                .descriptorType = vk::DescriptorType::eStorageImage,
+                .descriptorCount = 1,
+                .stageFlags = vk::ShaderStageFlagBits::eCompute
+            }
+        };
+
+        constexpr static u32 WorkgroupDimension{8}; //!< The width and height of the block of texels written by a single workgroup, this must match the shader
+        constexpr static float Sharpness{0.5f}; //!< A moderate amount of sharpening which restores detail lost in upscaling without visibly haloing edges
+    }
+
+    SpatialUpscaleJob::SpatialUpscaleJob(DescriptorAllocator::ActiveDescriptorSet &&descriptorSet) : descriptorSet{std::move(descriptorSet)} {}
+
+    SpatialUpscaleHelperShader::SpatialUpscaleHelperShader(GPU &gpu, std::shared_ptr<vfs::FileSystem> shaderFileSystem)
+        : shaderModule{CreateShaderModule(gpu, *shaderFileSystem->OpenFile("shaders/spatial_upscale.comp.spv"))},
+          // Texels are only ever fetched at integer coordinates so the sampler doesn't require the format to support linear filtering
+          sampler{gpu.vkDevice.createSampler(
+              vk::SamplerCreateInfo{
+                  .addressModeU = vk::SamplerAddressMode::eClampToEdge,
+                  .addressModeV = vk::SamplerAddressMode::eClampToEdge,
+                  .addressModeW = vk::SamplerAddressMode::eClampToEdge,
+                  .anisotropyEnable = false,
+                  .compareEnable = false,
+                  .magFilter = vk::Filter::eNearest,
+                  .minFilter = vk::Filter::eNearest
+              })
+          },
+          descriptorSetLayout{gpu.vkDevice, vk::DescriptorSetLayoutCreateInfo{
+              .pBindings = spatial_upscale::ImageLayoutBindings.data(),
+              .bindingCount = static_cast<u32>(spatial_upscale::ImageLayoutBindings.size()),
+          }},
+          pipelineLayout{gpu.vkDevice, vk::PipelineLayoutCreateInfo{
+              .pSetLayouts = &*descriptorSetLayout,
+              .setLayoutCount = 1,
+              .pPushConstantRanges = &spatial_upscale::PushConstantRange,
+              .pushConstantRangeCount = 1,
+          }},
+          pipeline{gpu.vkDevice, nullptr, vk::ComputePipelineCreateInfo{
+              .stage = {
+                  .stage = vk::ShaderStageFlagBits::eCompute,
+                  .module = *shaderModule,
+                  .pName = "main",
+              },
+              .layout = *pipelineLayout,
+          }} {}
+
+    std::shared_ptr<SpatialUpscaleJob> SpatialUpscaleHelperShader::Prepare(GPU &gpu, vk::ImageView source, vk::ImageView destination) {
+        auto job{std::make_shared<SpatialUpscaleJob>(gpu.descriptor.AllocateSet(*descriptorSetLayout))};
+
+        vk::DescriptorImageInfo sourceInfo{
+            .sampler = *sampler,
+            .imageView = source,
+            .imageLayout = vk::ImageLayout::eGeneral,
+        };
+        vk::DescriptorImageInfo destinationInfo{
+            .imageView = destination,
+            .imageLayout = vk::ImageLayout::eGeneral,
+        };
+
+        std::array<vk::WriteDescriptorSet, 2> writes{
+            vk::WriteDescriptorSet{
+                .dstSet = *job->descriptorSet,
+                .dstBinding = 0,
+                .descriptorType = vk::DescriptorType::eCombinedImageSampler,
+                .descriptorCount = 1,
+                .pImageInfo = &sourceInfo,
+            },
+            vk::WriteDescriptorSet{
+                .dstSet = *job->descriptorSet,
+                .dstBinding = 1,
+                .descriptorType = vk::DescriptorType::eStorageImage,
+                .descriptorCount = 1,
+                .pImageInfo = &destinationInfo,
+            }
+        };
+        gpu.vkDevice.updateDescriptorSets(writes, nullptr);
+
+        return job;
+    }
+
+    void SpatialUpscaleHelperShader::Record(const vk::raii::CommandBuffer &commandBuffer, const SpatialUpscaleJob &job, vk::Extent2D sourceExtent, vk::Extent2D destinationExtent) {
+        commandBuffer.bindPipeline(vk::PipelineBindPoint::eCompute, *pipeline);
+        commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eCompute, *pipelineLayout, 0, *job.descriptorSet, nullptr);
+
+        spatial_upscale::PushConstantLayout pushConstants{
+            .sourceWidth = sourceExtent.width,
+            .sourceHeight = sourceExtent.height,
+            .destinationWidth = destinationExtent.width,
+            .destinationHeight = destinationExtent.height,
+            .sharpness = spatial_upscale::Sharpness,
+        };
+        commandBuffer.pushConstants(*pipelineLayout, vk::ShaderStageFlagBits::eCompute, 0, vk::ArrayProxy<const spatial_upscale::PushConstantLayout>{pushConstants});
+
+        commandBuffer.dispatch(util::DivideCeil(destinationExtent.width, spatial_upscale::WorkgroupDimension), util::DivideCeil(destinationExtent.height, spatial_upscale::WorkgroupDimension), 1);
+    }
+
+    namespace yuv_conversion {
+        struct PushConstantLayout {
+            u32 lumaOffset; //!< The offset of the luma plane in bytes
+            u32 lumaPitch;
+            u32 chromaOffset; //!< The offset of the chroma plane in bytes
+            u32 chromaPitch;
+            u32 sourceWidth;
+            u32 sourceHeight;
+            u32 destinationOffset; //!< The offset of the destination in words
+            u32 destinationPitch; //!< The stride between rows of the destination in words
+            u32 destinationWidth;
+            u32 destinationHeight;
+            u32 swapRedBlue;
+        };
+
+        constexpr static vk::PushConstantRange PushConstantRange{
+            .stageFlags = vk::ShaderStageFlagBits::eCompute,
+            .size = sizeof(PushConstantLayout),
+            .offset = 0
+        };
+
+        constexpr static u32 WorkgroupDimension{8}; //!< The width and height of the block of texels written by a single workgroup, this must match the shader
+    }
+
+    YuvConversionJob::YuvConversionJob(DescriptorAllocator::ActiveDescriptorSet &&descriptorSet, const Surfaces &surfaces)
+        : descriptorSet{std::move(descriptorSet)},
+          surfaces{surfaces} {}
+
+    YuvConversionHelperShader::YuvConversionHelperShader(GPU &gpu, std::shared_ptr<vfs::FileSystem> shaderFileSystem)
+        : shaderModule{CreateShaderModule(gpu, *shaderFileSystem->OpenFile("shaders/yuv_conversion.comp.spv"))},
+          descriptorSetLayout{gpu.vkDevice, vk::DescriptorSetLayoutCreateInfo{
+              .pBindings = &bcn_decode::BufferLayoutBinding,
+              .bindingCount = 1,
+          }},
+          pipelineLayout{gpu.vkDevice, vk::PipelineLayoutCreateInfo{
+              .pSetLayouts = &*descriptorSetLayout,
+              .setLayoutCount = 1,
+              .pPushConstantRanges = &yuv_conversion::PushConstantRange,
+              .pushConstantRangeCount = 1,
+          }},
+          pipeline{gpu.vkDevice, nullptr, vk::ComputePipelineCreateInfo{
+              .stage = {
+                  .stage = vk::ShaderStageFlagBits::eCompute,
+                  .module = *shaderModule,
+                  .pName = "main",
+              },
+              .layout = *pipelineLayout,
+          }} {}
+
+    std::shared_ptr<YuvConversionJob> YuvConversionHelperShader::Prepare(GPU &gpu, vk::Buffer buffer, const YuvConversionJob::Surfaces &surfaces) {
+        auto job{std::make_shared<YuvConversionJob>(gpu.descriptor.AllocateSet(*descriptorSetLayout), surfaces)};
+
+        vk::DescriptorBufferInfo bufferInfo{
+            .buffer = buffer,
+            .offset = 0,
+            .range = VK_WHOLE_SIZE,
+        };
+
+        gpu.vkDevice.updateDescriptorSets(vk::WriteDescriptorSet{
+            .dstSet = *job->descriptorSet,
+            .dstBinding = 0,
+            .descriptorType = vk::DescriptorType::eStorageBuffer,
+            .descriptorCount = 1,
+            .pBufferInfo = &bufferInfo,
+        }, nullptr);
+
+        return job;
+    }
+
+    void YuvConversionHelperShader::Record(const vk::raii::CommandBuffer &commandBuffer, const YuvConversionJob &job) {
+        const auto &surfaces{job.surfaces};
+        if (!surfaces.destinationWidth || !surfaces.destinationHeight || !surfaces.sourceWidth || !surfaces.sourceHeight)
+            return;
+
+        commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eHost | vk::PipelineStageFlagBits::eTransfer | vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eComputeShader, {}, vk::MemoryBarrier{
+            .srcAccessMask = vk::AccessFlagBits::eHostWrite | vk::AccessFlagBits::eTransferWrite | vk::AccessFlagBits::eShaderWrite,
+            .dstAccessMask = vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite,
+        }, {}, {});
+
+        commandBuffer.bindPipeline(vk::PipelineBindPoint::eCompute, *pipeline);
+        commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eCompute, *pipelineLayout, 0, *job.descriptorSet, nullptr);
+
+        yuv_conversion::PushConstantLayout pushConstants{
+            .lumaOffset = static_cast<u32>(surfaces.lumaOffset),
+            .lumaPitch = surfaces.lumaPitch,
+            .chromaOffset = static_cast<u32>(surfaces.chromaOffset),
+            .chromaPitch = surfaces.chromaPitch,
+            .sourceWidth = surfaces.sourceWidth,
+            .sourceHeight = surfaces.sourceHeight,
+            .destinationOffset = static_cast<u32>(surfaces.destinationOffset / sizeof(u32)),
+            .destinationPitch = surfaces.destinationPitch / static_cast<u32>(sizeof(u32)),
+            .destinationWidth = surfaces.destinationWidth,
+            .destinationHeight = surfaces.destinationHeight,
+            .swapRedBlue = surfaces.swapRedBlue,
+        };
+        commandBuffer.pushConstants(*pipelineLayout, vk::ShaderStageFlagBits::eCompute, 0, vk::ArrayProxy<const yuv_conversion::PushConstantLayout>{pushConstants});
+
+        commandBuffer.dispatch(util::DivideCeil(surfaces.destinationWidth, yuv_conversion::WorkgroupDimension), util::DivideCeil(surfaces.destinationHeight, yuv_conversion::WorkgroupDimension), 1);
+
+        commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eTransfer | vk::PipelineStageFlagBits::eComputeShader | vk::PipelineStageFlagBits::eHost, {}, vk::MemoryBarrier{
+            .srcAccessMask = vk::AccessFlagBits::eShaderWrite,
+            .dstAccessMask = vk::AccessFlagBits::eTransferRead | vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eHostRead,
+        }, {}, {});
+    }
+
     HelperShaders::HelperShaders(GPU &gpu, std::shared_ptr<vfs::FileSystem> shaderFileSystem)
         : blitHelperShader(gpu, shaderFileSystem),
-          clearHelperShader(gpu, shaderFileSystem) {}
+          clearHelperShader(gpu, shaderFileSystem),
+          bcnDecodeHelperShader(gpu, shaderFileSystem),
+          blockLinearHelperShader(gpu, shaderFileSystem),
+          formatConversionHelperShader(gpu, shaderFileSystem),
+          quadConversionHelperShader(gpu, shaderFileSystem),
+          spatialUpscaleHelperShader(gpu, shaderFileSystem),
+          yuvConversionHelperShader(gpu, shaderFileSystem) {}
 
 }
\ No newline at end of file
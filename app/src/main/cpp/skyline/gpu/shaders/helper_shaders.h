@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include <boost/container/small_vector.hpp>
 #include <vulkan/vulkan_raii.hpp>
 #include <gpu/descriptor_allocator.h>
 #include <gpu/cache/graphics_pipeline_cache.h>
@@ -72,7 +73,7 @@ namespace skyline::gpu {
                       float dstSrcScaleFactorX, float dstSrcScaleFactorY,
                       bool bilinearFilter,
                       TextureView *srcImageView, TextureView *dstImageView,
-                      std::function<void(std::function<void(vk::raii::CommandBuffer &, const std::shared_ptr<FenceCycle> &, GPU &, vk::RenderPass, u32)> &&)> &&recordCb);
+                      std::function<void(std::function<void(vk::raii::CommandBuffer &, const IntrusivePtr<FenceCycle> &, GPU &, vk::RenderPass, u32)> &&)> &&recordCb);
     };
 
     /**
@@ -90,7 +91,325 @@ namespace skyline::gpu {
          * @param recordCb Callback used to record the blit commands for sequenced execution on the GPU
          */
         void Clear(GPU &gpu, vk::ImageAspectFlags mask, vk::ColorComponentFlags components, vk::ClearValue value, TextureView *dstImageView,
-                  std::function<void(std::function<void(vk::raii::CommandBuffer &, const std::shared_ptr<FenceCycle> &, GPU &, vk::RenderPass, u32)> &&)> &&recordCb);
+                  std::function<void(std::function<void(vk::raii::CommandBuffer &, const IntrusivePtr<FenceCycle> &, GPU &, vk::RenderPass, u32)> &&)> &&recordCb);
+    };
+
+    /**
+     * @brief The BCn formats that can be decoded on the GPU, these values are directly passed to the shader
+     */
+    enum class BcnDecodeFormat : u32 {
+        Bc1, //!< Decoded to R8G8B8A8
+        Bc2, //!< Decoded to R8G8B8A8
+        Bc3, //!< Decoded to R8G8B8A8
+        Bc4Unorm, //!< Decoded to R8
+        Bc4Snorm, //!< Decoded to R8
+        Bc5Unorm, //!< Decoded to R8G8
+        Bc5Snorm, //!< Decoded to R8G8
+    };
+
+    /**
+     * @brief A prepared GPU decode of BCn compressed data within a buffer into an uncompressed region of the same buffer
+     * @note This holds the descriptor set used by the decode and must be kept alive until the decode has completed executing on the GPU
+     */
+    struct BcnDecodeJob {
+        /**
+         * @brief A single mip level to decode, all layers of the level are decoded as a single image with a height of all layers stacked together
+         */
+        struct Level {
+            u32 width; //!< The width of the level in texels
+            u32 height; //!< The height of the level in texels, this is the height of a single layer multiplied by the layer count
+            vk::DeviceSize inputOffset; //!< The offset of the compressed data in the buffer, this must be aligned to 4 bytes
+            vk::DeviceSize outputOffset; //!< The offset of the decoded data in the buffer, this must be aligned to 4 bytes
+            vk::DeviceSize outputSize; //!< The size of the decoded data, the region is padded to a multiple of 4 bytes which must not be used by anything else
+        };
+
+        BcnDecodeFormat format;
+        DescriptorAllocator::ActiveDescriptorSet descriptorSet;
+        boost::container::small_vector<Level, 16> levels; //!< All levels to decode in order of their mip level
+
+        BcnDecodeJob(BcnDecodeFormat format, DescriptorAllocator::ActiveDescriptorSet &&descriptorSet, span<const Level> levels);
+    };
+
+    /**
+     * @brief A compute shader for decoding BCn compressed textures on the GPU for hosts that lack support for them, this avoids costly decoding on CPU cores that are required by the guest
+     */
+    class BcnDecodeHelperShader {
+      private:
+        vk::raii::ShaderModule shaderModule;
+        vk::raii::DescriptorSetLayout descriptorSetLayout;
+        vk::raii::PipelineLayout pipelineLayout;
+        vk::raii::Pipeline pipeline;
+
+      public:
+        static constexpr vk::DeviceSize OutputAlignment{4}; //!< The required alignment of the offset and size of decoded levels
+
+        BcnDecodeHelperShader(GPU &gpu, std::shared_ptr<vfs::FileSystem> shaderFileSystem);
+
+        /**
+         * @return The GPU decode format for the supplied guest format, if it can be decoded on the GPU
+         */
+        static std::optional<BcnDecodeFormat> GetDecodeFormat(vk::Format format);
+
+        /**
+         * @brief Prepares a decode of compressed levels in the supplied buffer, the buffer must have been created with storage buffer usage
+         */
+        std::shared_ptr<BcnDecodeJob> Prepare(GPU &gpu, BcnDecodeFormat format, vk::Buffer buffer, span<const BcnDecodeJob::Level> levels);
+
+        /**
+         * @brief Records the supplied decode into the command buffer and a barrier which makes the decoded data available to transfer operations
+         */
+        void Record(const vk::raii::CommandBuffer &commandBuffer, const BcnDecodeJob &job);
+    };
+
+    /**
+     * @brief A prepared GPU conversion between block-linear and linear data within a single buffer
+     * @note This holds the descriptor set used by the conversion and must be kept alive until it has completed executing on the GPU
+     */
+    struct BlockLinearJob {
+        /**
+         * @brief A single mip level to convert across all of its layers, the level must be 2D with a GOB block depth of 1
+         */
+        struct Level {
+            u32 rowSize; //!< The size of a single line of the level in bytes, this must be a multiple of 4 bytes
+            u32 lineCount; //!< The height of the level in lines of format blocks
+            u32 gobBlockHeight; //!< The height of a block in GOBs, this must be a power of 2
+            u32 layerCount;
+            vk::DeviceSize linearOffset; //!< The offset of the first layer's linear data in the buffer, this must be aligned to 4 bytes
+            vk::DeviceSize linearLayerStride; //!< The stride between layers of linear data, this must be aligned to 4 bytes
+            vk::DeviceSize blockLinearOffset; //!< The offset of the first layer's block-linear data in the buffer, this must be aligned to 4 bytes
+            vk::DeviceSize blockLinearLayerStride; //!< The stride between layers of block-linear data, this must be aligned to 4 bytes
+        };
+
+        bool toBlockLinear; //!< If linear data is converted into block-linear data rather than the inverse
+        DescriptorAllocator::ActiveDescriptorSet descriptorSet;
+        boost::container::small_vector<Level, 16> levels;
+
+        BlockLinearJob(bool toBlockLinear, DescriptorAllocator::ActiveDescriptorSet &&descriptorSet, span<const Level> levels);
+    };
+
+    /**
+     * @brief A compute shader for converting textures between the guest's block-linear layout and a linear layout on the GPU, this avoids (de)swizzling on the CPU for textures copied through a staging buffer
+     */
+    class BlockLinearHelperShader {
+      private:
+        vk::raii::ShaderModule shaderModule;
+        vk::raii::DescriptorSetLayout descriptorSetLayout;
+        vk::raii::PipelineLayout pipelineLayout;
+        vk::raii::Pipeline pipeline;
+
+      public:
+        static constexpr vk::DeviceSize Alignment{4}; //!< The required alignment of all offsets, strides and row sizes
+
+        BlockLinearHelperShader(GPU &gpu, std::shared_ptr<vfs::FileSystem> shaderFileSystem);
+
+        /**
+         * @brief Prepares a conversion between regions of the supplied buffer, the buffer must have been created with storage buffer usage
+         */
+        std::shared_ptr<BlockLinearJob> Prepare(GPU &gpu, bool toBlockLinear, vk::Buffer buffer, span<const BlockLinearJob::Level> levels);
+
+        /**
+         * @brief Records the supplied conversion into the command buffer alongside barriers which order it after prior transfer and host writes, and make its output available to subsequent transfer, compute and host reads
+         */
+        void Record(const vk::raii::CommandBuffer &commandBuffer, const BlockLinearJob &job);
+    };
+
+    /**
+     * @brief The conversions between guest formats and host formats with a differing encoding of the same data that can be performed on the GPU, these values are directly passed to the shader
+     */
+    enum class FormatConversion : u32 {
+        SwapR5B5, //!< B5G6R5 <-> R5G6B5, this is its own inverse
+        B5G5R5A1ToA1R5G5B5,
+        A1R5G5B5ToB5G5R5A1,
+        R16G16B16ToR16G16B16A16, //!< The alpha channel is filled with a value of one in the destination format
+        R16G16B16A16ToR16G16B16,
+        B10G11R11ToR16G16B16A16, //!< Unsigned 11-bit and 10-bit floats are widened to half floats losslessly
+        R16G16B16A16ToB10G11R11, //!< Half floats are narrowed with their mantissa truncated and negative values clamped to zero
+    };
+
+    /**
+     * @brief A prepared GPU conversion of tightly packed texels within a buffer into another region of the same buffer
+     * @note All levels and layers of a texture are converted as a single run of texels as the conversion of a texel doesn't depend on its position
+     * @note This holds the descriptor set used by the conversion and must be kept alive until it has completed executing on the GPU
+     */
+    struct FormatConversionJob {
+        FormatConversion conversion;
+        u32 alphaOne; //!< The encoding of an alpha value of one in the destination format
+        u32 texelCount;
+        vk::DeviceSize inputOffset; //!< The offset of the source texels in the buffer, this must be aligned to 4 bytes
+        vk::DeviceSize outputOffset; //!< The offset of the converted texels in the buffer, this must be aligned to 4 bytes and the region is padded to a multiple of 4 bytes which must not be used by anything else
+        DescriptorAllocator::ActiveDescriptorSet descriptorSet;
+
+        FormatConversionJob(FormatConversion conversion, u32 alphaOne, u32 texelCount, vk::DeviceSize inputOffset, vk::DeviceSize outputOffset, DescriptorAllocator::ActiveDescriptorSet &&descriptorSet);
+    };
+
+    /**
+     * @brief A compute shader for converting texels between guest formats that the host lacks support for and the host formats that are used in their place, this keeps uploads and readbacks of such textures on the GPU
+     */
+    class FormatConversionHelperShader {
+      private:
+        vk::raii::ShaderModule shaderModule;
+        vk::raii::DescriptorSetLayout descriptorSetLayout;
+        vk::raii::PipelineLayout pipelineLayout;
+        vk::raii::Pipeline pipeline;
+
+      public:
+        static constexpr vk::DeviceSize Alignment{4}; //!< The required alignment of the input and output offsets
+
+        FormatConversionHelperShader(GPU &gpu, std::shared_ptr<vfs::FileSystem> shaderFileSystem);
+
+        /**
+         * @return The GPU conversion from texels in the source format into the destination format, if one exists
+         */
+        static std::optional<FormatConversion> GetConversion(vk::Format source, vk::Format destination);
+
+        /**
+         * @brief Prepares a conversion between regions of the supplied buffer, the buffer must have been created with storage buffer usage
+         * @note GetConversion must return a conversion for the supplied formats
+         */
+        std::shared_ptr<FormatConversionJob> Prepare(GPU &gpu, vk::Format source, vk::Format destination, vk::Buffer buffer, u32 texelCount, vk::DeviceSize inputOffset, vk::DeviceSize outputOffset);
+
+        /**
+         * @brief Records the supplied conversion into the command buffer alongside barriers which order it after prior transfer and host writes, and make its output available to subsequent transfer, compute and host reads
+         */
+        void Record(const vk::raii::CommandBuffer &commandBuffer, const FormatConversionJob &job);
+    };
+
+    /**
+     * @brief A prepared GPU expansion of a quad list index buffer into a triangle list index buffer
+     * @note This holds the descriptor set used by the conversion and must be kept alive until it has completed executing on the GPU
+     */
+    struct QuadConversionJob {
+        DescriptorAllocator::ActiveDescriptorSet descriptorSet;
+
+        QuadConversionJob(DescriptorAllocator::ActiveDescriptorSet &&descriptorSet);
+    };
+
+    /**
+     * @brief A compute shader for converting indexed quad lists into triangle lists on the GPU, this avoids reading and rewriting large index buffers on the CPU for every draw
+     */
+    class QuadConversionHelperShader {
+      private:
+        vk::raii::ShaderModule shaderModule;
+        vk::raii::DescriptorSetLayout descriptorSetLayout;
+        vk::raii::PipelineLayout pipelineLayout;
+        vk::raii::Pipeline pipeline;
+
+      public:
+        static constexpr vk::DeviceSize OutputAlignment{4}; //!< The required alignment of the offset of the converted indices
+
+        QuadConversionHelperShader(GPU &gpu, std::shared_ptr<vfs::FileSystem> shaderFileSystem);
+
+        /**
+         * @return The type of the converted indices for source indices of the supplied size in bytes, 8-bit indices are widened to 16-bit
+         */
+        static vk::IndexType GetOutputIndexType(u32 indexSize);
+
+        /**
+         * @return The size of the converted indices for the supplied amount of source indices of the supplied size in bytes
+         */
+        static vk::DeviceSize GetOutputSize(u32 indexSize, u32 indexCount);
+
+        std::shared_ptr<QuadConversionJob> Prepare(GPU &gpu);
+
+        /**
+         * @brief Records the conversion of the supplied range of source indices alongside barriers which order it after any prior writes and make its output available to index reads
+         * @note The descriptor set is written here rather than in Prepare as the backings of guest buffers can only be resolved during recording, both buffers must have been created with storage buffer usage
+         * @param sourceOffset The offset of the first source index in bytes, this must be aligned to the index size
+         * @param destinationOffset The offset of the converted indices in bytes, this must be aligned to OutputAlignment
+         */
+        void Record(GPU &gpu, const vk::raii::CommandBuffer &commandBuffer, const QuadConversionJob &job,
+                    vk::Buffer source, vk::DeviceSize sourceOffset, u32 indexSize, u32 indexCount,
+                    vk::Buffer destination, vk::DeviceSize destinationOffset);
+    };
+
+    /**
+     * @brief A prepared GPU upscale of a sampled image into a storage image
+     * @note This holds the descriptor set used by the upscale and must be kept alive until it has completed executing on the GPU
+     */
+    struct SpatialUpscaleJob {
+        DescriptorAllocator::ActiveDescriptorSet descriptorSet;
+
+        SpatialUpscaleJob(DescriptorAllocator::ActiveDescriptorSet &&descriptorSet);
+    };
+
+    /**
+     * @brief A compute shader for upscaling frames at presentation with an edge-adaptive filter followed by contrast-adaptive sharpening, this allows titles to be rendered at a lower resolution than the guest with less blurring than a bilinear blit
+     */
+    class SpatialUpscaleHelperShader {
+      private:
+        vk::raii::ShaderModule shaderModule;
+        vk::raii::Sampler sampler;
+        vk::raii::DescriptorSetLayout descriptorSetLayout;
+        vk::raii::PipelineLayout pipelineLayout;
+        vk::raii::Pipeline pipeline;
+
+      public:
+        static constexpr vk::Format OutputFormat{vk::Format::eR8G8B8A8Unorm}; //!< The format of the storage image written by the shader, this must match the shader
+
+        SpatialUpscaleHelperShader(GPU &gpu, std::shared_ptr<vfs::FileSystem> shaderFileSystem);
+
+        /**
+         * @brief Prepares an upscale of the supplied source view into the destination view, the destination must be a storage image view with the format OutputFormat
+         * @note Both views must be in the eGeneral layout when the upscale is executed
+         */
+        std::shared_ptr<SpatialUpscaleJob> Prepare(GPU &gpu, vk::ImageView source, vk::ImageView destination);
+
+        /**
+         * @brief Records the supplied upscale into the command buffer, any barriers on the source and destination must be recorded by the caller
+         */
+        void Record(const vk::raii::CommandBuffer &commandBuffer, const SpatialUpscaleJob &job, vk::Extent2D sourceExtent, vk::Extent2D destinationExtent);
+    };
+
+    /**
+     * @brief A prepared GPU conversion of a linear semi-planar YUV 4:2:0 image into a linear RGBA8 image within a single buffer
+     * @note This holds the descriptor set used by the conversion and must be kept alive until it has completed executing on the GPU
+     */
+    struct YuvConversionJob {
+        /**
+         * @brief The layout of the source and destination images in the buffer, all offsets must be aligned to 4 bytes
+         */
+        struct Surfaces {
+            vk::DeviceSize lumaOffset;
+            u32 lumaPitch; //!< The stride between rows of the luma plane in bytes
+            vk::DeviceSize chromaOffset; //!< The offset of the interleaved UV plane
+            u32 chromaPitch; //!< The stride between rows of the chroma plane in bytes
+            u32 sourceWidth; //!< The width of the luma plane in texels, the chroma plane is half the luma plane's dimensions rounded up
+            u32 sourceHeight;
+            vk::DeviceSize destinationOffset;
+            u32 destinationPitch; //!< The stride between rows of the destination in bytes, this must be a multiple of 4 bytes
+            u32 destinationWidth; //!< The width of the destination in texels, the source is scaled to the destination's dimensions
+            u32 destinationHeight;
+            bool swapRedBlue; //!< If the destination is written in BGRA order rather than RGBA
+        };
+
+        DescriptorAllocator::ActiveDescriptorSet descriptorSet;
+        Surfaces surfaces;
+
+        YuvConversionJob(DescriptorAllocator::ActiveDescriptorSet &&descriptorSet, const Surfaces &surfaces);
+    };
+
+    /**
+     * @brief A compute shader for converting and scaling decoded video frames into RGBA on the GPU, this is used to emulate the colour conversion performed by the VIC
+     */
+    class YuvConversionHelperShader {
+      private:
+        vk::raii::ShaderModule shaderModule;
+        vk::raii::DescriptorSetLayout descriptorSetLayout;
+        vk::raii::PipelineLayout pipelineLayout;
+        vk::raii::Pipeline pipeline;
+
+      public:
+        YuvConversionHelperShader(GPU &gpu, std::shared_ptr<vfs::FileSystem> shaderFileSystem);
+
+        /**
+         * @brief Prepares a conversion between regions of the supplied buffer, the buffer must have been created with storage buffer usage
+         */
+        std::shared_ptr<YuvConversionJob> Prepare(GPU &gpu, vk::Buffer buffer, const YuvConversionJob::Surfaces &surfaces);
+
+        /**
+         * @brief Records the supplied conversion into the command buffer alongside barriers which order it after prior compute, transfer and host writes, and make its output available to subsequent transfer, compute and host reads
+         */
+        void Record(const vk::raii::CommandBuffer &commandBuffer, const YuvConversionJob &job);
     };
 
     /**
@@ -99,6 +418,12 @@ namespace skyline::gpu {
     struct HelperShaders {
         BlitHelperShader blitHelperShader;
         ClearHelperShader clearHelperShader;
+        BcnDecodeHelperShader bcnDecodeHelperShader;
+        BlockLinearHelperShader blockLinearHelperShader;
+        FormatConversionHelperShader formatConversionHelperShader;
+        QuadConversionHelperShader quadConversionHelperShader;
+        SpatialUpscaleHelperShader spatialUpscaleHelperShader;
+        YuvConversionHelperShader yuvConversionHelperShader;
 
         HelperShaders(GPU &gpu, std::shared_ptr<vfs::FileSystem> shaderFileSystem);
     };
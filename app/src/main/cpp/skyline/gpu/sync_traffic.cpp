@@ -0,0 +1,22 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2023 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#include <common/trace.h>
+#include "sync_traffic.h"
+
+namespace skyline::gpu {
+    namespace {
+        constexpr std::array<const char *, SyncTrafficSourceCount> ByteTracks{"Buffer Upload Bytes", "Buffer Readback Bytes", "Texture Upload Bytes", "Texture Readback Bytes", "Megabuffer Push Bytes", "Staging Allocation Bytes"};
+        constexpr std::array<const char *, SyncTrafficSourceCount> OperationTracks{"Buffer Uploads", "Buffer Readbacks", "Texture Uploads", "Texture Readbacks", "Megabuffer Pushes", "Staging Allocations"};
+    }
+
+    void SyncTraffic::EmitFrameCounters() {
+        for (size_t i{}; i < SyncTrafficSourceCount; i++) {
+            // The counters are reset regardless of tracing so that enabling it mid-emulation doesn't report everything accumulated prior
+            u64 bytes{counters[i].bytes.exchange(0, std::memory_order_relaxed)};
+            u64 operations{counters[i].operations.exchange(0, std::memory_order_relaxed)};
+            TRACE_COUNTER("gpu", perfetto::CounterTrack(ByteTracks[i]), bytes);
+            TRACE_COUNTER("gpu", perfetto::CounterTrack(OperationTracks[i]), operations);
+        }
+    }
+}
@@ -0,0 +1,48 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2023 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#pragma once
+
+#include <atomic>
+#include <common.h>
+
+namespace skyline::gpu {
+    /**
+     * @brief The kinds of transfers between guest memory and the host GPU that are tracked
+     */
+    enum class SyncTrafficSource : u8 {
+        BufferUpload, //!< Dirty pages of a guest buffer copied into its host backing by Buffer::SynchronizeHost
+        BufferReadback, //!< A host buffer backing copied into guest memory by Buffer::SynchronizeGuest
+        TextureUpload, //!< A guest texture copied into a staging buffer or a linear host image by Texture::SynchronizeHost
+        TextureReadback, //!< A host texture copied into guest memory by Texture::SynchronizeGuest or an asynchronous readback
+        MegaBufferPush, //!< Data pushed into the megabuffer ring, this includes inline buffer updates
+        StagingAllocation, //!< The size of staging buffers allocated by the memory manager
+    };
+    static constexpr size_t SyncTrafficSourceCount{6};
+
+    /**
+     * @brief Counts the bytes and operations of every kind of CPU <-> GPU transfer, these are reported as Perfetto counters once per presented frame
+     * @note Recording is lock-free as it happens on every synchronization
+     */
+    class SyncTraffic {
+      private:
+        struct Counter {
+            std::atomic<u64> bytes;
+            std::atomic<u64> operations;
+        };
+
+        mutable std::array<Counter, SyncTrafficSourceCount> counters{}; //!< The traffic since the last frame was presented, this is mutable so that allocators which only hold a const GPU can record into it
+
+      public:
+        void Record(SyncTrafficSource source, u64 bytes) const {
+            auto &counter{counters[static_cast<size_t>(source)]};
+            counter.bytes.fetch_add(bytes, std::memory_order_relaxed);
+            counter.operations.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Emits the traffic since the prior call as counters and resets it, this should be called once for every presented frame
+         */
+        void EmitFrameCounters();
+    };
+}
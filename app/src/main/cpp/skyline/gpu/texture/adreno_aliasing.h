@@ -11,7 +11,7 @@ namespace skyline::gpu::texture {
     /**
      * @return If a particular format is compatible to alias views of without VK_IMAGE_CREATE_MUTABLE_FORMAT_BIT on Adreno GPUs
      */
-    bool IsAdrenoAliasCompatible(vk::Format lhs, vk::Format rhs) {
+    inline bool IsAdrenoAliasCompatible(vk::Format lhs, vk::Format rhs) {
         if (lhs <= vk::Format::eUndefined || lhs >= vk::Format::eB10G11R11UfloatPack32 ||
             rhs <= vk::Format::eUndefined || rhs >= vk::Format::eB10G11R11UfloatPack32)
             return false; // Any complex (compressed/multi-planar/etc) formats cannot be properly aliased
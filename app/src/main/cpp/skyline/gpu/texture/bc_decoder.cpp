@@ -8,6 +8,9 @@
 
 #include <fmt/printf.h>
 #include <common.h>
+#ifdef __ARM_NEON
+#include <arm_neon.h>
+#endif
 
 #ifdef NDEBUG
 #define ASSERT(condition)
@@ -28,6 +31,39 @@ namespace {
 
     struct BC_color {
         void decode(uint8_t *dst, size_t x, size_t y, size_t dstW, size_t dstH, size_t dstPitch, size_t dstBpp, bool hasAlphaChannel, bool hasSeparateAlpha) const {
+            unsigned int palette[4];
+            getPalette(palette, hasAlphaChannel, hasSeparateAlpha);
+
+            for (int j = 0; j < BlockHeight && (y + j) < dstH; j++) {
+                size_t dstOffset = j * dstPitch;
+                size_t idxOffset = j * BlockHeight;
+                for (size_t i = 0; i < BlockWidth && (x + i) < dstW; i++, idxOffset++, dstOffset += dstBpp) {
+                    *reinterpret_cast<unsigned int *>(dst + dstOffset) = palette[getIdx(idxOffset)];
+                }
+            }
+        }
+
+#ifdef __ARM_NEON
+        // Decodes an entire block into four rows of four R8G8B8A8 texels, the palette is shared with the scalar path so the results are bit-identical
+        void decodeNeon(uint8x16_t rows[BlockHeight], bool hasAlphaChannel, bool hasSeparateAlpha) const {
+            unsigned int palette[4];
+            getPalette(palette, hasAlphaChannel, hasSeparateAlpha);
+            uint8x16_t table = vreinterpretq_u8_u32(vld1q_u32(palette));
+
+            static constexpr int32_t TexelShifts[4] = {0, -2, -4, -6};
+            int32x4_t shifts = vld1q_s32(TexelShifts);
+            uint32x4_t indices = vdupq_n_u32(idx);
+            for (int j = 0; j < BlockHeight; j++, shifts = vsubq_s32(shifts, vdupq_n_s32(8))) {
+                // Every texel's palette index is expanded into the byte offsets of its palette entry within the table
+                uint32x4_t texelIndices = vandq_u32(vshlq_u32(indices, shifts), vdupq_n_u32(0x3));
+                uint32x4_t byteOffsets = vmlaq_n_u32(vdupq_n_u32(0x03020100), texelIndices, 0x04040404);
+                rows[j] = vqtbl1q_u8(table, vreinterpretq_u8_u32(byteOffsets));
+            }
+        }
+#endif
+
+      private:
+        void getPalette(unsigned int palette[4], bool hasAlphaChannel, bool hasSeparateAlpha) const {
             Color c[4];
             c[0].extract565(c0);
             c[1].extract565(c1);
@@ -41,16 +77,11 @@ namespace {
                 }
             }
 
-            for (int j = 0; j < BlockHeight && (y + j) < dstH; j++) {
-                size_t dstOffset = j * dstPitch;
-                size_t idxOffset = j * BlockHeight;
-                for (size_t i = 0; i < BlockWidth && (x + i) < dstW; i++, idxOffset++, dstOffset += dstBpp) {
-                    *reinterpret_cast<unsigned int *>(dst + dstOffset) = c[getIdx(idxOffset)].pack8888();
-                }
+            for (int i = 0; i < 4; ++i) {
+                palette[i] = c[i].pack8888();
             }
         }
 
-      private:
         struct Color {
             Color() {
                 c[0] = c[1] = c[2] = 0;
@@ -121,7 +152,45 @@ namespace {
     struct BC_channel {
         void decode(uint8_t *dst, size_t x, size_t y, size_t dstW, size_t dstH, size_t dstPitch, size_t dstBpp, size_t channel, bool isSigned) const {
             int c[8] = {0};
+            getPalette(c, isSigned);
+
+            for (size_t j = 0; j < BlockHeight && (y + j) < dstH; j++) {
+                for (size_t i = 0; i < BlockWidth && (x + i) < dstW; i++) {
+                    dst[channel + (i * dstBpp) + (j * dstPitch)] = static_cast<uint8_t>(c[getIdx((j * BlockHeight) + i)]);
+                }
+            }
+        }
+
+#ifdef __ARM_NEON
+        // Decodes an entire block into the 16 channel values of its texels in row-major order, the palette is shared with the scalar path so the results are bit-identical
+        uint8x16_t decodeNeon(bool isSigned) const {
+            int c[8] = {0};
+            getPalette(c, isSigned);
+
+            uint8_t palette[16] = {0};
+            for (int i = 0; i < 8; ++i) {
+                palette[i] = static_cast<uint8_t>(c[i]);
+            }
+
+            // The 48 index bits are split into two halves of 8 texels which are each expanded into 3-bit indices
+            static constexpr int32_t LowShifts[4] = {0, -3, -6, -9};
+            static constexpr int32_t HighShifts[4] = {-12, -15, -18, -21};
+            int32x4_t lowShifts = vld1q_s32(LowShifts), highShifts = vld1q_s32(HighShifts);
+            uint32x4_t mask = vdupq_n_u32(0x7);
+
+            auto expandIndices = [&](uint32_t bits) {
+                uint32x4_t packed = vdupq_n_u32(bits);
+                return vcombine_u16(vmovn_u32(vandq_u32(vshlq_u32(packed, lowShifts), mask)), vmovn_u32(vandq_u32(vshlq_u32(packed, highShifts), mask)));
+            };
 
+            uint64_t indexBits = data >> 16;
+            uint8x16_t indices = vcombine_u8(vmovn_u16(expandIndices(indexBits & 0xFFFFFF)), vmovn_u16(expandIndices((indexBits >> 24) & 0xFFFFFF)));
+            return vqtbl1q_u8(vld1q_u8(palette), indices);
+        }
+#endif
+
+      private:
+        void getPalette(int c[8], bool isSigned) const {
             if (isSigned) {
                 c[0] = static_cast<signed char>(data & 0xFF);
                 c[1] = static_cast<signed char>((data & 0xFF00) >> 8);
@@ -141,15 +210,8 @@ namespace {
                 c[6] = isSigned ? -128 : 0;
                 c[7] = isSigned ? 127 : 255;
             }
-
-            for (size_t j = 0; j < BlockHeight && (y + j) < dstH; j++) {
-                for (size_t i = 0; i < BlockWidth && (x + i) < dstW; i++) {
-                    dst[channel + (i * dstBpp) + (j * dstPitch)] = static_cast<uint8_t>(c[getIdx((j * BlockHeight) + i)]);
-                }
-            }
         }
 
-      private:
         uint8_t getIdx(int i) const {
             int offset = i * 3 + 16;
             return static_cast<uint8_t>((data & (0x7ull << offset)) >> offset);
@@ -170,6 +232,16 @@ namespace {
             }
         }
 
+#ifdef __ARM_NEON
+        // Decodes an entire block into the 16 alpha values of its texels in row-major order
+        uint8x16_t decodeNeon() const {
+            uint8x8_t packed = vcreate_u8(data);
+            uint8x8_t even = vand_u8(packed, vdup_n_u8(0xF)), odd = vshr_n_u8(packed, 4);
+            uint8x16_t alpha = vcombine_u8(vzip1_u8(even, odd), vzip2_u8(even, odd));
+            return vorrq_u8(alpha, vshlq_n_u8(alpha, 4));
+        }
+#endif
+
       private:
         uint8_t getAlpha(int i) const {
             int offset = i << 2;
@@ -1497,13 +1569,50 @@ namespace bcn {
     constexpr size_t R8g8b8a8Bpp{4}; //!< The amount of bytes per pixel in R8G8B8A8
     constexpr size_t R16g16b16a16Bpp{8}; //!< The amount of bytes per pixel in R16G16B16
 
+    #ifdef __ARM_NEON
+    // Advanced SIMD is mandatory on ARMv8-A so the NEON paths are selected at compile-time, they are only used for blocks entirely within the bounds of the image while the scalar path handles any partial blocks at the edges
+
+    /**
+     * @return If the block at the supplied coordinates lies entirely within the image
+     */
+    inline bool IsFullBlock(size_t x, size_t y, size_t width, size_t height) {
+        return x + BlockWidth <= width && y + BlockHeight <= height;
+    }
+
+    /**
+     * @brief Replaces the alpha channel of four rows of R8G8B8A8 texels with the supplied row-major alpha values
+     */
+    inline void InsertAlphaNeon(uint8x16_t rows[BlockHeight], uint8x16_t alpha) {
+        static constexpr uint32_t AlphaTexelOffsets[4]{0x00FFFFFF, 0x01FFFFFF, 0x02FFFFFF, 0x03FFFFFF}; // Out of range table indices result in zero, this moves the alpha of each texel into its most significant byte
+        uint32x4_t offsets{vld1q_u32(AlphaTexelOffsets)};
+        uint8x16_t colorMask{vreinterpretq_u8_u32(vdupq_n_u32(0x00FFFFFF))};
+        for (size_t j{}; j < BlockHeight; j++, offsets = vaddq_u32(offsets, vdupq_n_u32(0x04000000)))
+            rows[j] = vorrq_u8(vandq_u8(rows[j], colorMask), vqtbl1q_u8(alpha, vreinterpretq_u8_u32(offsets)));
+    }
+
+    inline void StoreRowsNeon(uint8_t *dst, size_t pitch, const uint8x16_t rows[BlockHeight]) {
+        for (size_t j{}; j < BlockHeight; j++, dst += pitch)
+            vst1q_u8(dst, rows[j]);
+    }
+    #endif
+
     void DecodeBc1(const uint8_t *src, uint8_t *dst, size_t width, size_t height, bool hasAlphaChannel) {
         const auto *color{reinterpret_cast<const BC_color *>(src)};
         size_t pitch{R8g8b8a8Bpp * width};
         for (size_t y{}; y < height; y += BlockHeight, dst += BlockHeight * pitch) {
             uint8_t *dstRow{dst};
-            for (size_t x{}; x < width; x += BlockWidth, ++color, dstRow += BlockWidth * R8g8b8a8Bpp)
+            for (size_t x{}; x < width; x += BlockWidth, ++color, dstRow += BlockWidth * R8g8b8a8Bpp) {
+                #ifdef __ARM_NEON
+                if (IsFullBlock(x, y, width, height)) {
+                    uint8x16_t rows[BlockHeight];
+                    color->decodeNeon(rows, hasAlphaChannel, false);
+                    StoreRowsNeon(dstRow, pitch, rows);
+                    continue;
+                }
+                #endif
+
                 [[clang::always_inline]] color->decode(dstRow, x, y, width, height, pitch, R8g8b8a8Bpp, hasAlphaChannel, false);
+            }
         }
     }
 
@@ -1514,6 +1623,16 @@ namespace bcn {
         for (size_t y{}; y < height; y += BlockHeight, dst += BlockHeight * pitch) {
             uint8_t *dstRow{dst};
             for (size_t x{}; x < width; x += BlockWidth, alpha += 2, color += 2, dstRow += BlockWidth * R8g8b8a8Bpp) {
+                #ifdef __ARM_NEON
+                if (IsFullBlock(x, y, width, height)) {
+                    uint8x16_t rows[BlockHeight];
+                    color->decodeNeon(rows, false, true);
+                    InsertAlphaNeon(rows, alpha->decodeNeon());
+                    StoreRowsNeon(dstRow, pitch, rows);
+                    continue;
+                }
+                #endif
+
                 [[clang::always_inline]] color->decode(dstRow, x, y, width, height, pitch, R8g8b8a8Bpp, false, true);
                 [[clang::always_inline]] alpha->decode(dstRow, x, y, width, height, pitch, R8g8b8a8Bpp);
             }
@@ -1527,6 +1646,16 @@ namespace bcn {
         for (size_t y{}; y < height; y += BlockHeight, dst += BlockHeight * pitch) {
             uint8_t *dstRow{dst};
             for (size_t x{}; x < width; x += BlockWidth, alpha += 2, color += 2, dstRow += BlockWidth * R8g8b8a8Bpp) {
+                #ifdef __ARM_NEON
+                if (IsFullBlock(x, y, width, height)) {
+                    uint8x16_t rows[BlockHeight];
+                    color->decodeNeon(rows, false, true);
+                    InsertAlphaNeon(rows, alpha->decodeNeon(false));
+                    StoreRowsNeon(dstRow, pitch, rows);
+                    continue;
+                }
+                #endif
+
                 [[clang::always_inline]] color->decode(dstRow, x, y, width, height, pitch, R8g8b8a8Bpp, false, true);
                 [[clang::always_inline]] alpha->decode(dstRow, x, y, width, height, pitch, R8g8b8a8Bpp, 3, false);
             }
@@ -1538,8 +1667,21 @@ namespace bcn {
         size_t pitch{R8Bpp * width};
         for (size_t y{}; y < height; y += BlockHeight, dst += BlockHeight * pitch) {
             uint8_t *dstRow{dst};
-            for (size_t x{}; x < width; x += BlockWidth, ++red, dstRow += BlockWidth * R8Bpp)
+            for (size_t x{}; x < width; x += BlockWidth, ++red, dstRow += BlockWidth * R8Bpp) {
+                #ifdef __ARM_NEON
+                if (IsFullBlock(x, y, width, height)) {
+                    // Every row of the block is a single 32-bit lane of the decoded values
+                    uint32x4_t values{vreinterpretq_u32_u8(red->decodeNeon(isSigned))};
+                    vst1q_lane_u32(reinterpret_cast<uint32_t *>(dstRow), values, 0);
+                    vst1q_lane_u32(reinterpret_cast<uint32_t *>(dstRow + pitch), values, 1);
+                    vst1q_lane_u32(reinterpret_cast<uint32_t *>(dstRow + 2 * pitch), values, 2);
+                    vst1q_lane_u32(reinterpret_cast<uint32_t *>(dstRow + 3 * pitch), values, 3);
+                    continue;
+                }
+                #endif
+
                 [[clang::always_inline]] red->decode(dstRow, x, y, width, height, pitch, R8Bpp, 0, isSigned);
+            }
         }
     }
 
@@ -1550,6 +1692,19 @@ namespace bcn {
         for (size_t y{}; y < height; y += BlockHeight, dst += BlockHeight * pitch) {
             uint8_t *dstRow{dst};
             for (size_t x{}; x < width; x += BlockWidth, red += 2, green += 2, dstRow += BlockWidth * R8g8Bpp) {
+                #ifdef __ARM_NEON
+                if (IsFullBlock(x, y, width, height)) {
+                    // Interleaving the channels results in the first and last two rows of R8G8 texels
+                    uint8x16_t redValues{red->decodeNeon(isSigned)}, greenValues{green->decodeNeon(isSigned)};
+                    uint8x16_t firstRows{vzip1q_u8(redValues, greenValues)}, lastRows{vzip2q_u8(redValues, greenValues)};
+                    vst1_u8(dstRow, vget_low_u8(firstRows));
+                    vst1_u8(dstRow + pitch, vget_high_u8(firstRows));
+                    vst1_u8(dstRow + 2 * pitch, vget_low_u8(lastRows));
+                    vst1_u8(dstRow + 3 * pitch, vget_high_u8(lastRows));
+                    continue;
+                }
+                #endif
+
                 [[clang::always_inline]] red->decode(dstRow, x, y, width, height, pitch, R8g8Bpp, 0, isSigned);
                 [[clang::always_inline]] green->decode(dstRow, x, y, width, height, pitch, R8g8Bpp, 1, isSigned);
             }
@@ -1,6 +1,9 @@
 // SPDX-License-Identifier: MPL-2.0
 // Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
 
+#ifdef __ARM_NEON
+#include <arm_neon.h>
+#endif
 #include "layout.h"
 
 namespace skyline::gpu::texture {
@@ -88,15 +91,37 @@ namespace skyline::gpu::texture {
         return mipLevels;
     }
 
+    /**
+     * @brief Copies a single sector worth of bytes, this is a single 128-bit load and store on NEON
+     */
+    __attribute__((always_inline)) inline void CopySector(u8 *destination, const u8 *source) {
+        #ifdef __ARM_NEON
+        vst1q_u8(destination, vld1q_u8(source));
+        #else
+        std::memcpy(destination, source, SectorWidth);
+        #endif
+    }
+
     /**
      * @brief Copies pixel data between a linear and blocklinear texture
      * @tparam BlockLinearToLinear Whether to copy from a blocklinear texture to a linear texture or a linear texture to a blocklinear texture
+     * @tparam FormatBpb The bytes per block of the format if known at compile-time, this is 0 if the runtime value should be used
+     * @tparam GobBlockHeight The height of a block in GOBs if known at compile-time, this is 0 if the runtime value should be used
+     * @param robBegin The index of the first ROB to copy, the pointers are always to the start of the surface
+     * @param robEnd The index after the last ROB to copy, this is clamped to the amount of ROBs in the surface
      */
-    template<bool BlockLinearToLinear>
+    template<bool BlockLinearToLinear, size_t FormatBpb = 0, size_t GobBlockHeight = 0>
     void CopyBlockLinearInternal(Dimensions dimensions,
                                  size_t formatBlockWidth, size_t formatBlockHeight, size_t formatBpb,
                                  size_t gobBlockHeight, size_t gobBlockDepth,
-                                 u8 *blockLinear, u8 *linear) {
+                                 u8 *blockLinear, u8 *linear,
+                                 size_t robBegin, size_t robEnd) {
+        // Overwriting the runtime values with the compile-time ones allows the compiler to fully unroll the per-pixel and per-GOB loops
+        if constexpr (FormatBpb != 0)
+            formatBpb = FormatBpb;
+        if constexpr (GobBlockHeight != 0)
+            gobBlockHeight = GobBlockHeight;
+
         size_t robWidthUnalignedBytes{util::DivideCeil<size_t>(dimensions.width, formatBlockWidth) * formatBpb};
         size_t robWidthBytes{util::AlignUp(robWidthUnalignedBytes, GobWidth)};
         size_t robWidthBlocks{robWidthUnalignedBytes / GobWidth};
@@ -116,7 +141,9 @@ namespace skyline::gpu::texture {
         size_t gobYOffset{robWidthUnalignedBytes * GobHeight};
         size_t gobZOffset{robWidthUnalignedBytes * surfaceHeightLines};
 
-        u8 *sector{blockLinear};
+        size_t robSectorBytes{(robWidthBytes / GobWidth) * ((GobWidth * GobHeight * blockHeight * blockDepth) + blockPaddingZ)}; //!< The amount of blocklinear bytes traversed by a single non-padding ROB
+
+        u8 *sector{blockLinear + (robBegin * robSectorBytes)};
 
         auto deswizzleRob{[&](u8 *linearRob, auto isLastRob, size_t blockPaddingY = 0, size_t blockExtentY = 0) {
             auto deswizzleBlock{[&](u8 *linearBlock, auto copySector) __attribute__((always_inline)) {
@@ -150,9 +177,9 @@ namespace skyline::gpu::texture {
             for (size_t block{}; block < robWidthBlocks; block++) { // Every ROB contains `surfaceWidthBlocks` blocks (excl. padding block)
                 deswizzleBlock(linearRob, [&](u8 *linearSector, size_t) __attribute__((always_inline)) {
                     if constexpr (BlockLinearToLinear)
-                        std::memcpy(linearSector, sector, SectorWidth);
+                        CopySector(linearSector, sector);
                     else
-                        std::memcpy(sector, linearSector, SectorWidth);
+                        CopySector(sector, linearSector);
                     sector += SectorWidth; // `sectorWidth` bytes are of sequential image data
                 });
 
@@ -163,6 +190,16 @@ namespace skyline::gpu::texture {
 
             if (hasPaddingBlock)
                 deswizzleBlock(linearRob, [&](u8 *linearSector, size_t xT) __attribute__((always_inline)) {
+                    if (xT + SectorWidth <= blockPaddingOffset) {
+                        // Sectors which are entirely before the padding can be copied as a whole
+                        if constexpr (BlockLinearToLinear)
+                            CopySector(linearSector, sector);
+                        else
+                            CopySector(sector, linearSector);
+                        sector += SectorWidth;
+                        return;
+                    }
+
                     #pragma clang loop unroll_count(4)
                     for (size_t pixelOffset{}; pixelOffset < SectorWidth; pixelOffset += formatBpb) {
                         if (xT < blockPaddingOffset)
@@ -177,13 +214,13 @@ namespace skyline::gpu::texture {
                 });
         }};
 
-        u8 *linearRob{linear};
-        for (size_t rob{}; rob < surfaceHeightRobs; rob++) { // Every Surface contains `surfaceHeightRobs` ROBs (excl. padding ROB)
+        u8 *linearRob{linear + (robBegin * robBytes)};
+        for (size_t rob{robBegin}; rob < std::min(robEnd, surfaceHeightRobs); rob++) { // Every Surface contains `surfaceHeightRobs` ROBs (excl. padding ROB)
             deswizzleRob(linearRob, std::false_type{});
             linearRob += robBytes; // Increment the linear ROB to the next ROB
         }
 
-        if (surfaceHeightLines % robHeight != 0) {
+        if (surfaceHeightLines % robHeight != 0 && robEnd > surfaceHeightRobs) {
             blockHeight = (util::AlignUp(surfaceHeightLines, GobHeight) - (surfaceHeightRobs * robHeight)) / GobHeight; // Calculate the amount of Y GOBs which aren't padding
 
             size_t alignedSurfaceLines{util::DivideCeil<size_t>(dimensions.height, formatBlockHeight)};
@@ -196,17 +233,72 @@ namespace skyline::gpu::texture {
         }
     }
 
-    void CopyBlockLinearToLinear(Dimensions dimensions, size_t formatBlockWidth, size_t formatBlockHeight, size_t formatBpb, size_t gobBlockHeight, size_t gobBlockDepth, u8 *blockLinear, u8 *linear) {
-        CopyBlockLinearInternal<true>(
+    template<bool BlockLinearToLinear, size_t FormatBpb>
+    void CopyBlockLinearGobHeightDispatch(Dimensions dimensions,
+                                          size_t formatBlockWidth, size_t formatBlockHeight, size_t formatBpb,
+                                          size_t gobBlockHeight, size_t gobBlockDepth,
+                                          u8 *blockLinear, u8 *linear,
+                                          size_t robBegin, size_t robEnd) {
+        #define GOB_HEIGHT_CASE(height) \
+            case height:                \
+                return CopyBlockLinearInternal<BlockLinearToLinear, FormatBpb, height>(dimensions, formatBlockWidth, formatBlockHeight, formatBpb, gobBlockHeight, gobBlockDepth, blockLinear, linear, robBegin, robEnd)
+
+        switch (gobBlockHeight) {
+            GOB_HEIGHT_CASE(1);
+            GOB_HEIGHT_CASE(2);
+            GOB_HEIGHT_CASE(4);
+            GOB_HEIGHT_CASE(8);
+            GOB_HEIGHT_CASE(16);
+            GOB_HEIGHT_CASE(32);
+            default:
+                return CopyBlockLinearInternal<BlockLinearToLinear, FormatBpb, 0>(dimensions, formatBlockWidth, formatBlockHeight, formatBpb, gobBlockHeight, gobBlockDepth, blockLinear, linear, robBegin, robEnd);
+        }
+
+        #undef GOB_HEIGHT_CASE
+    }
+
+    /**
+     * @brief Dispatches a copy to a variant of CopyBlockLinearInternal specialized for the format's bytes per block and the GOB height of blocks, any other values use the generic variant
+     */
+    template<bool BlockLinearToLinear>
+    void CopyBlockLinearDispatch(Dimensions dimensions,
+                                 size_t formatBlockWidth, size_t formatBlockHeight, size_t formatBpb,
+                                 size_t gobBlockHeight, size_t gobBlockDepth,
+                                 u8 *blockLinear, u8 *linear,
+                                 size_t robBegin = 0, size_t robEnd = std::numeric_limits<size_t>::max()) {
+        #define BPB_CASE(bpb) \
+            case bpb:         \
+                return CopyBlockLinearGobHeightDispatch<BlockLinearToLinear, bpb>(dimensions, formatBlockWidth, formatBlockHeight, formatBpb, gobBlockHeight, gobBlockDepth, blockLinear, linear, robBegin, robEnd)
+
+        switch (formatBpb) {
+            BPB_CASE(1);
+            BPB_CASE(2);
+            BPB_CASE(4);
+            BPB_CASE(8);
+            BPB_CASE(16);
+            default:
+                return CopyBlockLinearInternal<BlockLinearToLinear>(dimensions, formatBlockWidth, formatBlockHeight, formatBpb, gobBlockHeight, gobBlockDepth, blockLinear, linear, robBegin, robEnd);
+        }
+
+        #undef BPB_CASE
+    }
+
+    size_t GetBlockLinearRobCount(Dimensions dimensions, size_t formatBlockHeight, size_t gobBlockHeight) {
+        return util::DivideCeil<size_t>(util::DivideCeil<size_t>(dimensions.height, formatBlockHeight), GobHeight * gobBlockHeight);
+    }
+
+    void CopyBlockLinearToLinear(Dimensions dimensions, size_t formatBlockWidth, size_t formatBlockHeight, size_t formatBpb, size_t gobBlockHeight, size_t gobBlockDepth, u8 *blockLinear, u8 *linear, size_t robBegin, size_t robEnd) {
+        CopyBlockLinearDispatch<true>(
             dimensions,
             formatBlockWidth, formatBlockHeight, formatBpb,
             gobBlockHeight, gobBlockDepth,
-            blockLinear, linear
+            blockLinear, linear,
+            robBegin, robEnd
         );
     }
 
     void CopyBlockLinearToLinear(const GuestTexture &guest, u8 *blockLinear, u8 *linear) {
-        CopyBlockLinearInternal<true>(
+        CopyBlockLinearDispatch<true>(
             guest.dimensions,
             guest.format->blockWidth, guest.format->blockHeight, guest.format->bpb,
             guest.tileConfig.blockHeight, guest.tileConfig.blockDepth,
@@ -215,7 +307,7 @@ namespace skyline::gpu::texture {
     }
 
     void CopyLinearToBlockLinear(Dimensions dimensions, size_t formatBlockWidth, size_t formatBlockHeight, size_t formatBpb, size_t gobBlockHeight, size_t gobBlockDepth, u8 *linear, u8 *blockLinear) {
-        CopyBlockLinearInternal<false>(
+        CopyBlockLinearDispatch<false>(
             dimensions,
             formatBlockWidth, formatBlockHeight, formatBpb,
             gobBlockHeight, gobBlockDepth,
@@ -224,7 +316,7 @@ namespace skyline::gpu::texture {
     }
 
     void CopyLinearToBlockLinear(const GuestTexture &guest, u8 *linear, u8 *blockLinear) {
-        CopyBlockLinearInternal<false>(
+        CopyBlockLinearDispatch<false>(
             guest.dimensions,
             guest.format->blockWidth, guest.format->blockHeight, guest.format->bpb,
             guest.tileConfig.blockHeight, guest.tileConfig.blockDepth,
@@ -32,13 +32,23 @@ namespace skyline::gpu::texture {
                                                         size_t gobBlockHeight, size_t gobBlockDepth,
                                                         size_t levelCount);
 
+    /**
+     * @return The amount of ROBs (Rows Of Blocks) in the specified block-linear surface including any partial ROB at the end of it
+     * @note Every ROB can be copied independently of the others as they occupy disjoint ranges of both the block-linear and linear surface
+     */
+    size_t GetBlockLinearRobCount(Dimensions dimensions, size_t formatBlockHeight, size_t gobBlockHeight);
+
     /**
      * @brief Copies the contents of a blocklinear texture to a linear output buffer
+     * @param robBegin The index of the first ROB to copy, this allows splitting up the copy of a large surface across threads
+     * @param robEnd The index after the last ROB to copy, this is clamped to the amount of ROBs in the surface
+     * @note The supplied pointers are always to the start of the surface regardless of the ROB range being copied
      */
     void CopyBlockLinearToLinear(Dimensions dimensions,
                                  size_t formatBlockWidth, size_t formatBlockHeight, size_t formatBpb,
                                  size_t gobBlockHeight, size_t gobBlockDepth,
-                                 u8 *blockLinear, u8 *linear);
+                                 u8 *blockLinear, u8 *linear,
+                                 size_t robBegin = 0, size_t robEnd = std::numeric_limits<size_t>::max());
 
     /**
      * @brief Copies the contents of a blocklinear guest texture to a linear output buffer
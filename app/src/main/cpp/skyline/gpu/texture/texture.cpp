@@ -6,6 +6,7 @@
 #include <kernel/types/KProcess.h>
 #include <common/trace.h>
 #include <common/settings.h>
+#include <common/performance_statistics.h>
 #include "texture.h"
 #include "layout.h"
 #include "adreno_aliasing.h"
@@ -13,6 +14,9 @@
 #include "format.h"
 
 namespace skyline::gpu {
+    constexpr size_t ParallelUploadThreshold{1024 * 1024}; //!< The minimum size of a surface in bytes for its deswizzling and decoding to be split across the texture decode pool
+    constexpr size_t ParallelUploadSliceSize{256 * 1024}; //!< The approximate amount of linear bytes produced by a single slice of a parallel upload
+
     u32 GuestTexture::GetLayerStride() {
         if (layerStride)
             return layerStride;
@@ -155,7 +159,7 @@ namespace skyline::gpu {
 
         // We can't just capture `this` in the lambda since the lambda could exceed the lifetime of the buffer
         std::weak_ptr<Texture> weakThis{weak_from_this()};
-        trapHandle = gpu.state.nce->CreateTrap(mappings, [weakThis] {
+        trapHandle = gpu.state.nce->CreateTrap(nce::TrapResource::Texture, mappings, [weakThis] {
             auto texture{weakThis.lock()};
             if (!texture)
                 return;
@@ -165,7 +169,7 @@ namespace skyline::gpu {
                 stateLock.unlock(); // If the lock isn't unlocked, a deadlock from threads waiting on the other lock can occur
 
                 // If this mutex would cause other callbacks to be blocked then we should block on this mutex in advance
-                std::shared_ptr<FenceCycle> waitCycle{};
+                IntrusivePtr<FenceCycle> waitCycle{};
                 do {
                     // We need to do a loop here since we can't wait with the texture locked but not doing so means that the texture could have it's cycle changed which we wouldn't wait on, loop until we are sure the cycle hasn't changed to avoid that
                     if (waitCycle) {
@@ -242,19 +246,108 @@ namespace skyline::gpu {
         });
     }
 
-    std::shared_ptr<memory::StagingBuffer> Texture::SynchronizeHostImpl() {
-        if (guest->dimensions != dimensions)
+    /**
+     * @brief Determines the levels of a guest texture for conversion between block-linear and linear layouts on the GPU, the linear data is laid out in the same way as in staging buffers
+     * @param blockLinearOffset The offset of the raw guest data in the staging buffer
+     * @param blockLinearSize Set to the size of the raw guest data which must be copied into the staging buffer
+     * @return The levels to convert, this is empty if the texture cannot be converted on the GPU
+     */
+    boost::container::small_vector<BlockLinearJob::Level, 16> GetGpuBlockLinearLevels(GuestTexture &guest, const std::vector<texture::MipLevelLayout> &mipLayouts, u32 layerCount, vk::DeviceSize blockLinearOffset, vk::DeviceSize &blockLinearSize) {
+        boost::container::small_vector<BlockLinearJob::Level, 16> levels;
+        auto guestLayerStride{guest.GetLayerStride()};
+        if (guest.tileConfig.mode != texture::TileMode::Block || !util::IsAligned(guestLayerStride, BlockLinearHelperShader::Alignment) || !util::IsAligned(blockLinearOffset, BlockLinearHelperShader::Alignment))
+            return levels;
+
+        vk::DeviceSize linearOffset{}, levelBlockLinearOffset{blockLinearOffset};
+        for (const auto &level : mipLayouts) {
+            // The shader doesn't handle 3D textures or rows that aren't word-aligned, these are rare enough to always be left to the CPU
+            auto rowSize{static_cast<u32>(guest.format->GetSize(level.dimensions.width, 1))};
+            if (level.dimensions.depth != 1 || level.blockDepth != 1 || !util::IsAligned(rowSize, BlockLinearHelperShader::Alignment) || !std::has_single_bit(level.blockHeight))
+                return {};
+
+            levels.push_back(BlockLinearJob::Level{
+                .rowSize = rowSize,
+                .lineCount = util::DivideCeil<u32>(level.dimensions.height, guest.format->blockHeight),
+                .gobBlockHeight = static_cast<u32>(level.blockHeight),
+                .layerCount = layerCount,
+                .linearOffset = linearOffset,
+                .linearLayerStride = level.linearSize,
+                .blockLinearOffset = levelBlockLinearOffset,
+                .blockLinearLayerStride = guestLayerStride,
+            });
+
+            linearOffset += level.linearSize * layerCount;
+            levelBlockLinearOffset += level.blockLinearSize;
+        }
+
+        blockLinearSize = (guestLayerStride * (layerCount - 1)) + (levelBlockLinearOffset - blockLinearOffset);
+        return levels;
+    }
+
+    std::shared_ptr<memory::StagingBuffer> Texture::SynchronizeHostImpl(StagingBufferJobs &jobs) {
+        if (IsScaled())
+            AllocateUnscaledImage();
+        else if (guest->dimensions != dimensions)
             throw exception("Guest and host dimensions being different is not supported currently");
 
         auto pointer{mirror.data()};
 
         WaitOnBacking();
 
+        // Guest formats that are replaced by a host format with a differing encoding can only be converted on the GPU, this requires a staging buffer even for linear textures
+        std::optional<FormatConversion> gpuConversion;
+        if (guest->format != format)
+            gpuConversion = FormatConversionHelperShader::GetConversion(guest->format->vkFormat, format->vkFormat);
+
+        bool useStagingBuffer{tiling == vk::ImageTiling::eOptimal || !std::holds_alternative<memory::Image>(backing) || gpuConversion};
+
+        // Compressed guest formats that are uploaded through a staging buffer can be decoded on the GPU, the compressed data is deswizzled into the start of the staging buffer and decoded into the region following it
+        std::optional<BcnDecodeFormat> gpuDecodeFormat;
+        boost::container::small_vector<BcnDecodeJob::Level, 16> gpuDecodeLevels;
+        vk::DeviceSize stagingBufferSize{surfaceSize};
+        if (useStagingBuffer && guest->format != format && *gpu.state.settings->gpuTextureDecoding)
+            gpuDecodeFormat = BcnDecodeHelperShader::GetDecodeFormat(guest->format->vkFormat);
+
+        if (gpuDecodeFormat) {
+            vk::DeviceSize inputOffset{}, outputOffset{util::AlignUp(deswizzledSurfaceSize, BcnDecodeHelperShader::OutputAlignment)};
+            for (const auto &level : mipLayouts) {
+                gpuDecodeLevels.push_back(BcnDecodeJob::Level{
+                    .width = level.dimensions.width,
+                    .height = level.dimensions.height * layerCount,
+                    .inputOffset = inputOffset,
+                    .outputOffset = outputOffset,
+                    .outputSize = level.targetLinearSize * layerCount,
+                });
+
+                inputOffset += level.linearSize * layerCount;
+                outputOffset = util::AlignUp(outputOffset + level.targetLinearSize * layerCount, BcnDecodeHelperShader::OutputAlignment);
+            }
+            stagingBufferSize = outputOffset;
+        }
+
+        // Converted texels are written after the deswizzled guest data, the output is aligned to the host texel size as it's copied into the image like any other staging buffer
+        vk::DeviceSize conversionOffset{};
+        if (gpuConversion) {
+            conversionOffset = util::AlignUp(deswizzledSurfaceSize, std::max<vk::DeviceSize>(FormatConversionHelperShader::Alignment, format->bpb));
+            stagingBufferSize = util::AlignUp(conversionOffset + surfaceSize, FormatConversionHelperShader::Alignment);
+        }
+
+        // Block-linear guest data uploaded through a staging buffer can be deswizzled on the GPU, the raw guest data is copied after all other data in the staging buffer and deswizzled into the linear region at its start
+        // Note: This isn't possible when decoding on the CPU as the decoder requires the deswizzled data
+        boost::container::small_vector<BlockLinearJob::Level, 16> gpuDeswizzleLevels;
+        vk::DeviceSize blockLinearOffset{}, blockLinearSize{};
+        if (useStagingBuffer && (guest->format == format || gpuDecodeFormat || gpuConversion) && *gpu.state.settings->gpuTextureDeswizzling) {
+            blockLinearOffset = util::AlignUp(stagingBufferSize, BlockLinearHelperShader::Alignment);
+            gpuDeswizzleLevels = GetGpuBlockLinearLevels(*guest, mipLayouts, layerCount, blockLinearOffset, blockLinearSize);
+            if (!gpuDeswizzleLevels.empty())
+                stagingBufferSize = blockLinearOffset + blockLinearSize;
+        }
+
         u8 *bufferData;
         auto stagingBuffer{[&]() -> std::shared_ptr<memory::StagingBuffer> {
-            if (tiling == vk::ImageTiling::eOptimal || !std::holds_alternative<memory::Image>(backing)) {
+            if (useStagingBuffer) {
                 // We need a staging buffer for all optimal copies (since we aren't aware of the host optimal layout) and linear textures which we cannot map on the CPU since we do not have access to their backing VkDeviceMemory
-                auto stagingBuffer{gpu.memory.AllocateStagingBuffer(surfaceSize)};
+                auto stagingBuffer{gpu.memory.AllocateStagingBuffer(stagingBufferSize, (gpuDecodeFormat || gpuConversion || !gpuDeswizzleLevels.empty()) ? vk::BufferUsageFlagBits::eStorageBuffer : vk::BufferUsageFlags{})};
                 bufferData = stagingBuffer->data();
                 return stagingBuffer;
             } else if (tiling == vk::ImageTiling::eLinear) {
@@ -271,23 +364,63 @@ namespace skyline::gpu {
 
         std::vector<u8> deswizzleBuffer;
         u8 *deswizzleOutput;
-        if (guest->format != format) {
+        if (guest->format != format && !gpuDecodeFormat && !gpuConversion) {
             deswizzleBuffer.resize(deswizzledSurfaceSize);
             deswizzleOutput = deswizzleBuffer.data();
         } else [[likely]] {
             deswizzleOutput = bufferData;
         }
 
+        // Large surfaces are split into slices which are deswizzled and decoded in parallel, smaller ones aren't worth the overhead of distributing them across threads
+        bool parallelUpload{surfaceSize >= ParallelUploadThreshold};
+        boost::container::small_vector<std::function<void()>, 32> slices;
+        auto addSlice{[&](std::function<void()> &&slice) {
+            if (parallelUpload)
+                slices.emplace_back(std::move(slice));
+            else
+                slice();
+        }};
+
+        auto runSlices{[&]() {
+            gpu.textureDecodePool.ParallelFor(slices.size(), [&](size_t index) {
+                slices[index]();
+            });
+            slices.clear();
+        }};
+
+        auto addBlockLinearSlices{[&](texture::Dimensions levelDimensions, size_t blockHeight, size_t blockDepth, u8 *input, u8 *output, size_t linearSize) {
+            // Every ROB of a block-linear surface can be deswizzled independently, multiple ROBs are grouped into a slice to amortize the cost of dispatching it
+            size_t robCount{texture::GetBlockLinearRobCount(levelDimensions, guest->format->blockHeight, blockHeight)};
+            size_t robsPerSlice{parallelUpload ? std::max<size_t>((robCount * ParallelUploadSliceSize) / std::max<size_t>(linearSize, 1), 1) : robCount};
+            for (size_t rob{}; rob < robCount; rob += robsPerSlice)
+                addSlice([guestFormat = guest->format, levelDimensions, blockHeight, blockDepth, input, output, rob, robsPerSlice] {
+                    texture::CopyBlockLinearToLinear(
+                        levelDimensions,
+                        guestFormat->blockWidth, guestFormat->blockHeight, guestFormat->bpb,
+                        blockHeight, blockDepth,
+                        input, output,
+                        rob, rob + robsPerSlice
+                    );
+                });
+        }};
+
         auto guestLayerStride{guest->GetLayerStride()};
-        if (levelCount == 1) {
+        if (!gpuDeswizzleLevels.empty()) {
+            // Only a linear copy of the raw guest data is required on the CPU
+            size_t sliceSize{parallelUpload ? ParallelUploadSliceSize : blockLinearSize};
+            for (size_t offset{}; offset < blockLinearSize; offset += sliceSize)
+                addSlice([input = pointer + offset, output = bufferData + blockLinearOffset + offset, size = std::min<size_t>(sliceSize, blockLinearSize - offset)] {
+                    std::memcpy(output, input, size);
+                });
+        } else if (levelCount == 1) {
             auto outputLayer{deswizzleOutput};
             for (size_t layer{}; layer < layerCount; layer++) {
                 if (guest->tileConfig.mode == texture::TileMode::Block)
-                    texture::CopyBlockLinearToLinear(*guest, pointer, outputLayer);
+                    addBlockLinearSlices(guest->dimensions, guest->tileConfig.blockHeight, guest->tileConfig.blockDepth, pointer, outputLayer, mipLayouts.front().linearSize);
                 else if (guest->tileConfig.mode == texture::TileMode::Pitch)
-                    texture::CopyPitchLinearToLinear(*guest, pointer, outputLayer);
+                    addSlice([this, pointer, outputLayer] { texture::CopyPitchLinearToLinear(*guest, pointer, outputLayer); });
                 else if (guest->tileConfig.mode == texture::TileMode::Linear)
-                    std::memcpy(outputLayer, pointer, surfaceSize);
+                    addSlice([this, pointer, outputLayer] { std::memcpy(outputLayer, pointer, surfaceSize); });
                 pointer += guestLayerStride;
                 outputLayer += deswizzledLayerStride;
             }
@@ -296,11 +429,11 @@ namespace skyline::gpu {
             for (size_t layer{}; layer < layerCount; layer++) {
                 auto inputLevel{pointer}, outputLevel{deswizzleOutput};
                 for (const auto &level : mipLayouts) {
-                    texture::CopyBlockLinearToLinear(
+                    addBlockLinearSlices(
                         level.dimensions,
-                        guest->format->blockWidth, guest->format->blockHeight, guest->format->bpb,
                         level.blockHeight, level.blockDepth,
-                        inputLevel, outputLevel + (layer * level.linearSize) // Offset into the current layer relative to the start of the current mip level
+                        inputLevel, outputLevel + (layer * level.linearSize), // Offset into the current layer relative to the start of the current mip level
+                        level.linearSize
                     );
 
                     inputLevel += level.blockLinearSize; // Skip over the current mip level as we've deswizzled it
@@ -313,58 +446,85 @@ namespace skyline::gpu {
             throw exception("Mipmapped textures with tiling mode '{}' aren't supported", static_cast<int>(tiling));
         }
 
-        if (!deswizzleBuffer.empty()) {
-            for (const auto &level : mipLayouts) {
-                size_t levelHeight{level.dimensions.height * layerCount}; //!< The height of an image representing all layers in the entire level
-                switch (guest->format->vkFormat) {
+        // All slices must be deswizzled prior to decoding as the decoder consumes the entirety of the deswizzled output
+        runSlices();
+
+        if (!gpuDeswizzleLevels.empty())
+            jobs.deswizzleJob = gpu.helperShaders.blockLinearHelperShader.Prepare(gpu, false, stagingBuffer->vkBuffer, gpuDeswizzleLevels);
+
+        if (gpuDecodeFormat) {
+            jobs.decodeJob = gpu.helperShaders.bcnDecodeHelperShader.Prepare(gpu, *gpuDecodeFormat, stagingBuffer->vkBuffer, gpuDecodeLevels);
+        } else if (gpuConversion) {
+            jobs.conversionJob = gpu.helperShaders.formatConversionHelperShader.Prepare(gpu, guest->format->vkFormat, format->vkFormat, stagingBuffer->vkBuffer, static_cast<u32>(deswizzledSurfaceSize / guest->format->bpb), 0, conversionOffset);
+        } else if (!deswizzleBuffer.empty()) {
+            auto decode{[guestFormat = guest->format](const u8 *input, u8 *output, size_t width, size_t height) {
+                switch (guestFormat->vkFormat) {
                     case vk::Format::eBc1RgbaUnormBlock:
                     case vk::Format::eBc1RgbaSrgbBlock:
-                        bcn::DecodeBc1(deswizzleOutput, bufferData, level.dimensions.width, levelHeight, true);
+                        bcn::DecodeBc1(input, output, width, height, true);
                         break;
 
                     case vk::Format::eBc2UnormBlock:
                     case vk::Format::eBc2SrgbBlock:
-                        bcn::DecodeBc2(deswizzleOutput, bufferData, level.dimensions.width, levelHeight);
+                        bcn::DecodeBc2(input, output, width, height);
                         break;
 
                     case vk::Format::eBc3UnormBlock:
                     case vk::Format::eBc3SrgbBlock:
-                        bcn::DecodeBc3(deswizzleOutput, bufferData, level.dimensions.width, levelHeight);
+                        bcn::DecodeBc3(input, output, width, height);
                         break;
 
                     case vk::Format::eBc4UnormBlock:
-                        bcn::DecodeBc4(deswizzleOutput, bufferData, level.dimensions.width, levelHeight, false);
+                        bcn::DecodeBc4(input, output, width, height, false);
                         break;
                     case vk::Format::eBc4SnormBlock:
-                        bcn::DecodeBc4(deswizzleOutput, bufferData, level.dimensions.width, levelHeight, true);
+                        bcn::DecodeBc4(input, output, width, height, true);
                         break;
 
                     case vk::Format::eBc5UnormBlock:
-                        bcn::DecodeBc5(deswizzleOutput, bufferData, level.dimensions.width, levelHeight, false);
+                        bcn::DecodeBc5(input, output, width, height, false);
                         break;
                     case vk::Format::eBc5SnormBlock:
-                        bcn::DecodeBc5(deswizzleOutput, bufferData, level.dimensions.width, levelHeight, true);
+                        bcn::DecodeBc5(input, output, width, height, true);
                         break;
 
                     case vk::Format::eBc6HUfloatBlock:
-                        bcn::DecodeBc6(deswizzleOutput, bufferData, level.dimensions.width, levelHeight, false);
+                        bcn::DecodeBc6(input, output, width, height, false);
                         break;
                     case vk::Format::eBc6HSfloatBlock:
-                        bcn::DecodeBc6(deswizzleOutput, bufferData, level.dimensions.width, levelHeight, true);
+                        bcn::DecodeBc6(input, output, width, height, true);
                         break;
 
                     case vk::Format::eBc7UnormBlock:
                     case vk::Format::eBc7SrgbBlock:
-                        bcn::DecodeBc7(deswizzleOutput, bufferData, level.dimensions.width, levelHeight);
+                        bcn::DecodeBc7(input, output, width, height);
                         break;
 
                     default:
-                        throw exception("Unsupported guest format '{}'", vk::to_string(guest->format->vkFormat));
+                        throw exception("Unsupported guest format '{}'", vk::to_string(guestFormat->vkFormat));
+                }
+            }};
+
+            for (const auto &level : mipLayouts) {
+                size_t levelHeight{level.dimensions.height * layerCount}; //!< The height of an image representing all layers in the entire level
+
+                // Every row of blocks is decoded independently, the decoders write to the output sequentially so a range of rows can be decoded by offsetting both pointers
+                size_t blockHeight{guest->format->blockHeight};
+                size_t blockRows{util::DivideCeil(levelHeight, blockHeight)};
+                size_t inputRowSize{guest->format->GetSize(level.dimensions.width, guest->format->blockHeight)}, outputRowSize{format->GetSize(level.dimensions.width, guest->format->blockHeight)};
+                size_t rowsPerSlice{parallelUpload ? std::max<size_t>(ParallelUploadSliceSize / std::max<size_t>(outputRowSize, 1), 1) : blockRows};
+                for (size_t row{}; row < blockRows; row += rowsPerSlice) {
+                    size_t sliceHeight{std::min(rowsPerSlice * blockHeight, levelHeight - (row * blockHeight))};
+                    addSlice([decode, input = deswizzleOutput + (row * inputRowSize), output = bufferData + (row * outputRowSize), width = level.dimensions.width, sliceHeight] {
+                        decode(input, output, width, sliceHeight);
+                    });
                 }
 
                 deswizzleOutput += level.linearSize * layerCount;
                 bufferData += level.targetLinearSize * layerCount;
             }
+
+            runSlices();
         }
 
         return stagingBuffer;
@@ -402,7 +562,7 @@ namespace skyline::gpu {
         return bufferImageCopies;
     }
 
-    void Texture::CopyFromStagingBuffer(const vk::raii::CommandBuffer &commandBuffer, const std::shared_ptr<memory::StagingBuffer> &stagingBuffer) {
+    void Texture::CopyFromStagingBuffer(const vk::raii::CommandBuffer &commandBuffer, const std::shared_ptr<memory::StagingBuffer> &stagingBuffer, const StagingBufferJobs *jobs) {
         auto image{GetBacking()};
         if (layout == vk::ImageLayout::eUndefined)
             commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eHost, vk::PipelineStageFlagBits::eTransfer, {}, {}, {}, vk::ImageMemoryBarrier{
@@ -420,29 +580,79 @@ namespace skyline::gpu {
                 },
             });
 
+        // Scaled textures are copied into the unscaled image first which is then upscaled into the backing, this is required as the staging buffer always contains data with the guest dimensions
+        auto copyImage{image};
+        if (IsScaled()) {
+            copyImage = unscaledImage->vkImage;
+            commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eTransfer, {}, {}, {}, vk::ImageMemoryBarrier{
+                .image = copyImage,
+                .srcAccessMask = vk::AccessFlagBits::eTransferRead | vk::AccessFlagBits::eTransferWrite,
+                .dstAccessMask = vk::AccessFlagBits::eTransferWrite,
+                .oldLayout = std::exchange(unscaledImageLayout, vk::ImageLayout::eGeneral),
+                .newLayout = vk::ImageLayout::eGeneral,
+                .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .subresourceRange = {
+                    .aspectMask = format->vkAspect,
+                    .levelCount = 1,
+                    .layerCount = layerCount,
+                },
+            });
+        }
+
         auto bufferImageCopies{GetBufferImageCopies()};
-        commandBuffer.copyBufferToImage(stagingBuffer->vkBuffer, image, layout, vk::ArrayProxy(static_cast<u32>(bufferImageCopies.size()), bufferImageCopies.data()));
+        if (jobs && jobs->deswizzleJob)
+            gpu.helperShaders.blockLinearHelperShader.Record(commandBuffer, *jobs->deswizzleJob);
+
+        if (jobs && jobs->decodeJob) {
+            gpu.helperShaders.bcnDecodeHelperShader.Record(commandBuffer, *jobs->decodeJob);
+
+            // The decoded data for each level is at an aligned offset after the compressed data rather than tightly packed from the start of the buffer, decodable formats only have a color aspect so there's a single copy per level
+            for (size_t i{}; i < bufferImageCopies.size(); i++)
+                bufferImageCopies[i].bufferOffset = jobs->decodeJob->levels[i].outputOffset;
+        } else if (jobs && jobs->conversionJob) {
+            gpu.helperShaders.formatConversionHelperShader.Record(commandBuffer, *jobs->conversionJob);
+
+            // The converted data is tightly packed in the same manner as an unconverted staging buffer, it's only offset by the start of the converted region
+            for (auto &bufferImageCopy : bufferImageCopies)
+                bufferImageCopy.bufferOffset += jobs->conversionJob->outputOffset;
+        }
+
+        commandBuffer.copyBufferToImage(stagingBuffer->vkBuffer, copyImage, IsScaled() ? unscaledImageLayout : layout, vk::ArrayProxy(static_cast<u32>(bufferImageCopies.size()), bufferImageCopies.data()));
+
+        if (IsScaled())
+            RecordUnscaledImageBlit(commandBuffer, true);
     }
 
     void Texture::CopyIntoStagingBuffer(const vk::raii::CommandBuffer &commandBuffer, const std::shared_ptr<memory::StagingBuffer> &stagingBuffer) {
         auto image{GetBacking()};
+        auto imageLayout{layout};
+        u32 imageLevelCount{levelCount};
+        if (IsScaled()) {
+            // Scaled textures are downscaled into the unscaled image first, so the staging buffer always contains data with the guest dimensions
+            RecordUnscaledImageBlit(commandBuffer, false);
+            image = unscaledImage->vkImage;
+            imageLayout = unscaledImageLayout;
+            imageLevelCount = 1;
+        }
+
         commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eBottomOfPipe, vk::PipelineStageFlagBits::eTransfer, {}, {}, {}, vk::ImageMemoryBarrier{
             .image = image,
             .srcAccessMask = vk::AccessFlagBits::eMemoryWrite,
             .dstAccessMask = vk::AccessFlagBits::eTransferRead,
-            .oldLayout = layout,
-            .newLayout = layout,
+            .oldLayout = imageLayout,
+            .newLayout = imageLayout,
             .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
             .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
             .subresourceRange = {
                 .aspectMask = format->vkAspect,
-                .levelCount = levelCount,
+                .levelCount = imageLevelCount,
                 .layerCount = layerCount,
             },
         });
 
         auto bufferImageCopies{GetBufferImageCopies()};
-        commandBuffer.copyImageToBuffer(image, layout, stagingBuffer->vkBuffer, vk::ArrayProxy(static_cast<u32>(bufferImageCopies.size()), bufferImageCopies.data()));
+        commandBuffer.copyImageToBuffer(image, imageLayout, stagingBuffer->vkBuffer, vk::ArrayProxy(static_cast<u32>(bufferImageCopies.size()), bufferImageCopies.data()));
 
         commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eHost, {}, {}, vk::BufferMemoryBarrier{
             .srcAccessMask = vk::AccessFlagBits::eTransferWrite,
@@ -468,7 +678,7 @@ namespace skyline::gpu {
                 else if (guest->tileConfig.mode == texture::TileMode::Linear)
                     std::memcpy(hostBuffer, guestOutput, layerStride);
                 guestOutput += guestLayerStride;
-                hostBuffer += layerStride;
+                hostBuffer += deswizzledLayerStride; // The host buffer is always in the guest format, which may have been converted from the host format
             }
         } else if (levelCount > 1 && guest->tileConfig.mode == texture::TileMode::Block) {
             // We need to copy into the Tegra X1 layout holds all mip levels for a given layer while the input buffer has all layers for a given mip level
@@ -509,7 +719,8 @@ namespace skyline::gpu {
 
     texture::Format ConvertHostCompatibleFormat(texture::Format format, const TraitManager &traits) {
         auto bcnSupport{traits.bcnSupport};
-        if (bcnSupport.all())
+        auto colorFormatSupport{traits.colorFormatSupport};
+        if (bcnSupport.all() && colorFormatSupport.all())
             return format;
 
         switch (format->vkFormat) {
@@ -547,6 +758,27 @@ namespace skyline::gpu {
             case vk::Format::eBc7SrgbBlock:
                 return bcnSupport[6] ? format : format::R8G8B8A8Srgb;
 
+            // The following formats are converted on the GPU into a host format with the same components (FormatConversionHelperShader)
+            case vk::Format::eB5G6R5UnormPack16:
+                return colorFormatSupport[0] ? format : format::R5G6B5Unorm;
+
+            case vk::Format::eB5G5R5A1UnormPack16:
+                return colorFormatSupport[1] ? format : format::A1R5G5B5Unorm;
+
+            case vk::Format::eR16G16B16Unorm:
+                return colorFormatSupport[2] ? format : format::R16G16B16A16Unorm;
+            case vk::Format::eR16G16B16Snorm:
+                return colorFormatSupport[2] ? format : format::R16G16B16A16Snorm;
+            case vk::Format::eR16G16B16Uint:
+                return colorFormatSupport[2] ? format : format::R16G16B16A16Uint;
+            case vk::Format::eR16G16B16Sint:
+                return colorFormatSupport[2] ? format : format::R16G16B16A16Sint;
+            case vk::Format::eR16G16B16Sfloat:
+                return colorFormatSupport[2] ? format : format::R16G16B16A16Float;
+
+            case vk::Format::eB10G11R11UfloatPack32:
+                return colorFormatSupport[3] ? format : format::R16G16B16A16Float;
+
             default:
                 return format;
         }
@@ -566,16 +798,30 @@ namespace skyline::gpu {
         return surfaceSize;
     }
 
-    Texture::Texture(GPU &pGpu, GuestTexture pGuest)
+    /**
+     * @return The dimensions of the guest texture scaled by the supplied factor, these are rounded to the nearest integer and are always at least 1
+     */
+    static texture::Dimensions ScaleDimensions(texture::Dimensions dimensions, float scale) {
+        if (scale == 1.0f)
+            return dimensions;
+
+        auto scaleDimension{[scale](u32 value) {
+            return std::max(static_cast<u32>(std::lround(static_cast<float>(value) * scale)), 1U);
+        }};
+        return texture::Dimensions{scaleDimension(dimensions.width), scaleDimension(dimensions.height), dimensions.depth};
+    }
+
+    Texture::Texture(GPU &pGpu, GuestTexture pGuest, float pResolutionScale)
         : gpu(pGpu),
           guest(std::move(pGuest)),
-          dimensions(guest->dimensions),
+          dimensions(ScaleDimensions(guest->dimensions, pResolutionScale)),
+          resolutionScale(pResolutionScale),
           format(ConvertHostCompatibleFormat(guest->format, gpu.traits)),
           layout(vk::ImageLayout::eUndefined),
           tiling(vk::ImageTiling::eOptimal), // Force Optimal due to not adhering to host subresource layout during Linear synchronization
           layerCount(guest->layerCount),
-          deswizzledLayerStride(static_cast<u32>(guest->format->GetSize(dimensions))),
-          layerStride(format == guest->format ? deswizzledLayerStride : static_cast<u32>(format->GetSize(dimensions))),
+          deswizzledLayerStride(static_cast<u32>(guest->format->GetSize(guest->dimensions))),
+          layerStride(format == guest->format ? deswizzledLayerStride : static_cast<u32>(format->GetSize(guest->dimensions))),
           levelCount(guest->mipLevelCount),
           mipLayouts(
               texture::GetBlockLinearMipLayout(
@@ -740,14 +986,23 @@ namespace skyline::gpu {
 
         // From this point on Clean -> CPU dirty state transitions can occur, GPU dirty -> * transitions will always require the full lock to be held and thus won't occur
 
-        auto stagingBuffer{SynchronizeHostImpl()};
+        StagingBufferJobs jobs;
+        auto stagingBuffer{SynchronizeHostImpl(jobs)};
+        gpu.syncTraffic.Record(SyncTrafficSource::TextureUpload, mirror.size());
         if (stagingBuffer) {
+            GetPerformanceStatistics().textureUploadBytes.fetch_add(stagingBuffer->size(), std::memory_order_relaxed);
             if (cycle)
                 cycle->WaitSubmit();
             auto lCycle{gpu.scheduler.Submit([&](vk::raii::CommandBuffer &commandBuffer) {
-                CopyFromStagingBuffer(commandBuffer, stagingBuffer);
+                CopyFromStagingBuffer(commandBuffer, stagingBuffer, &jobs);
             })};
             lCycle->AttachObjects(stagingBuffer, shared_from_this());
+            if (jobs.deswizzleJob)
+                lCycle->AttachObject(jobs.deswizzleJob);
+            if (jobs.decodeJob)
+                lCycle->AttachObject(jobs.decodeJob);
+            if (jobs.conversionJob)
+                lCycle->AttachObject(jobs.conversionJob);
             lCycle->ChainCycle(cycle);
             cycle = lCycle;
         }
@@ -760,7 +1015,7 @@ namespace skyline::gpu {
         }
     }
 
-    void Texture::SynchronizeHostInline(const vk::raii::CommandBuffer &commandBuffer, const std::shared_ptr<FenceCycle> &pCycle, bool gpuDirty) {
+    void Texture::SynchronizeHostInline(const vk::raii::CommandBuffer &commandBuffer, const IntrusivePtr<FenceCycle> &pCycle, bool gpuDirty) {
         if (!guest)
             return;
 
@@ -781,10 +1036,19 @@ namespace skyline::gpu {
             gpu.state.nce->TrapRegions(*trapHandle, !gpuDirty); // Trap any future CPU reads (optionally) + writes to this texture
         }
 
-        auto stagingBuffer{SynchronizeHostImpl()};
+        StagingBufferJobs jobs;
+        auto stagingBuffer{SynchronizeHostImpl(jobs)};
+        gpu.syncTraffic.Record(SyncTrafficSource::TextureUpload, mirror.size());
         if (stagingBuffer) {
-            CopyFromStagingBuffer(commandBuffer, stagingBuffer);
+            GetPerformanceStatistics().textureUploadBytes.fetch_add(stagingBuffer->size(), std::memory_order_relaxed);
+            CopyFromStagingBuffer(commandBuffer, stagingBuffer, &jobs);
             pCycle->AttachObjects(stagingBuffer, shared_from_this());
+            if (jobs.deswizzleJob)
+                pCycle->AttachObject(jobs.deswizzleJob);
+            if (jobs.decodeJob)
+                pCycle->AttachObject(jobs.decodeJob);
+            if (jobs.conversionJob)
+                pCycle->AttachObject(jobs.conversionJob);
             pCycle->ChainCycle(cycle);
             cycle = pCycle;
         }
@@ -797,6 +1061,211 @@ namespace skyline::gpu {
         }
     }
 
+    void Texture::AllocateUnscaledImage() {
+        if (unscaledImage)
+            return;
+
+        unscaledImage.emplace(gpu.memory.AllocateImage(vk::ImageCreateInfo{
+            .imageType = vk::ImageType::e2D,
+            .format = *format,
+            .extent = guest->dimensions,
+            .mipLevels = 1,
+            .arrayLayers = layerCount,
+            .samples = vk::SampleCountFlagBits::e1,
+            .tiling = vk::ImageTiling::eOptimal,
+            .usage = vk::ImageUsageFlagBits::eTransferSrc | vk::ImageUsageFlagBits::eTransferDst,
+            .sharingMode = vk::SharingMode::eExclusive,
+            .queueFamilyIndexCount = 1,
+            .pQueueFamilyIndices = &gpu.vkQueueFamilyIndex,
+            .initialLayout = vk::ImageLayout::eUndefined,
+        }));
+
+        // Formats which can't be linearly filtered (such as depth and integer formats) are scaled with nearest filtering instead
+        auto formatFeatures{gpu.vkPhysicalDevice.getFormatProperties(*format).optimalTilingFeatures};
+        unscaledImageFilter = (formatFeatures & vk::FormatFeatureFlagBits::eSampledImageFilterLinear) ? vk::Filter::eLinear : vk::Filter::eNearest;
+    }
+
+    void Texture::RecordUnscaledImageBlit(const vk::raii::CommandBuffer &commandBuffer, bool toBacking) {
+        auto backingImage{GetBacking()};
+        vk::ImageSubresourceRange subresourceRange{
+            .aspectMask = format->vkAspect,
+            .levelCount = 1,
+            .layerCount = layerCount,
+        };
+
+        // The unscaled image is only used for transfers so it's kept in the general layout after its first usage
+        std::array<vk::ImageMemoryBarrier, 2> preBarriers{
+            vk::ImageMemoryBarrier{
+                .image = backingImage,
+                .srcAccessMask = vk::AccessFlagBits::eMemoryWrite,
+                .dstAccessMask = toBacking ? vk::AccessFlagBits::eTransferWrite : vk::AccessFlagBits::eTransferRead,
+                .oldLayout = layout,
+                .newLayout = layout,
+                .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .subresourceRange = subresourceRange,
+            },
+            vk::ImageMemoryBarrier{
+                .image = unscaledImage->vkImage,
+                .srcAccessMask = vk::AccessFlagBits::eTransferRead | vk::AccessFlagBits::eTransferWrite,
+                .dstAccessMask = toBacking ? vk::AccessFlagBits::eTransferRead : vk::AccessFlagBits::eTransferWrite,
+                .oldLayout = std::exchange(unscaledImageLayout, vk::ImageLayout::eGeneral),
+                .newLayout = vk::ImageLayout::eGeneral,
+                .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .subresourceRange = subresourceRange,
+            },
+        };
+        commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eAllCommands, vk::PipelineStageFlagBits::eTransfer, {}, {}, {}, preBarriers);
+
+        vk::ImageSubresourceLayers subresourceLayers{
+            .aspectMask = format->vkAspect,
+            .layerCount = layerCount,
+        };
+        std::array<vk::Offset3D, 2> scaledOffsets{vk::Offset3D{}, vk::Offset3D{static_cast<i32>(dimensions.width), static_cast<i32>(dimensions.height), 1}};
+        std::array<vk::Offset3D, 2> unscaledOffsets{vk::Offset3D{}, vk::Offset3D{static_cast<i32>(guest->dimensions.width), static_cast<i32>(guest->dimensions.height), 1}};
+        if (toBacking)
+            commandBuffer.blitImage(unscaledImage->vkImage, unscaledImageLayout, backingImage, layout, vk::ImageBlit{
+                .srcSubresource = subresourceLayers,
+                .srcOffsets = unscaledOffsets,
+                .dstSubresource = subresourceLayers,
+                .dstOffsets = scaledOffsets,
+            }, unscaledImageFilter);
+        else
+            commandBuffer.blitImage(backingImage, layout, unscaledImage->vkImage, unscaledImageLayout, vk::ImageBlit{
+                .srcSubresource = subresourceLayers,
+                .srcOffsets = scaledOffsets,
+                .dstSubresource = subresourceLayers,
+                .dstOffsets = unscaledOffsets,
+            }, unscaledImageFilter);
+
+        commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eAllCommands, {}, {}, {}, vk::ImageMemoryBarrier{
+            .image = toBacking ? backingImage : unscaledImage->vkImage,
+            .srcAccessMask = vk::AccessFlagBits::eTransferWrite,
+            .dstAccessMask = vk::AccessFlagBits::eMemoryRead | vk::AccessFlagBits::eMemoryWrite,
+            .oldLayout = toBacking ? layout : unscaledImageLayout,
+            .newLayout = toBacking ? layout : unscaledImageLayout,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .subresourceRange = subresourceRange,
+        });
+    }
+
+    bool Texture::IsGuestReadbackSupported() {
+        return format == guest->format || FormatConversionHelperShader::GetConversion(format->vkFormat, guest->format->vkFormat);
+    }
+
+    vk::DeviceSize Texture::GetReadbackLinearOffset() {
+        return format == guest->format ? 0 : util::AlignUp(surfaceSize, FormatConversionHelperShader::Alignment);
+    }
+
+    std::shared_ptr<BlockLinearJob> Texture::PrepareReadback(vk::DeviceSize &blockLinearSize, std::shared_ptr<FormatConversionJob> &conversionJob) {
+        if (IsScaled())
+            AllocateUnscaledImage();
+
+        // Host data in a differing format is converted into the guest format on the GPU, the converted data follows the host data and is then handled like unconverted linear data
+        bool convert{format != guest->format};
+        vk::DeviceSize linearOffset{GetReadbackLinearOffset()};
+
+        // Block-linear textures can be swizzled on the GPU into a region following the linear data in the staging buffer, which then only needs a linear copy into guest memory
+        boost::container::small_vector<BlockLinearJob::Level, 16> gpuSwizzleLevels;
+        vk::DeviceSize blockLinearOffset{util::AlignUp(linearOffset + deswizzledSurfaceSize, BlockLinearHelperShader::Alignment)};
+        blockLinearSize = 0;
+        if (*gpu.state.settings->gpuTextureDeswizzling) {
+            gpuSwizzleLevels = GetGpuBlockLinearLevels(*guest, mipLayouts, layerCount, blockLinearOffset, blockLinearSize);
+            for (auto &level : gpuSwizzleLevels)
+                level.linearOffset += linearOffset;
+        }
+
+        if (!downloadStagingBuffer) {
+            if (!gpuSwizzleLevels.empty())
+                downloadStagingBuffer = gpu.memory.AllocateStagingBuffer(blockLinearOffset + blockLinearSize, vk::BufferUsageFlagBits::eStorageBuffer);
+            else if (convert)
+                downloadStagingBuffer = gpu.memory.AllocateStagingBuffer(util::AlignUp(linearOffset + deswizzledSurfaceSize, FormatConversionHelperShader::Alignment), vk::BufferUsageFlagBits::eStorageBuffer);
+            else
+                downloadStagingBuffer = gpu.memory.AllocateStagingBuffer(surfaceSize);
+        }
+
+        conversionJob = convert ? gpu.helperShaders.formatConversionHelperShader.Prepare(gpu, format->vkFormat, guest->format->vkFormat, downloadStagingBuffer->vkBuffer, static_cast<u32>(surfaceSize / format->bpb), 0, linearOffset) : nullptr;
+
+        // The staging buffer is only large enough for swizzling if it was allocated while swizzling on the GPU was possible
+        if (gpuSwizzleLevels.empty() || downloadStagingBuffer->size() < blockLinearOffset + blockLinearSize) {
+            blockLinearSize = 0;
+            return nullptr;
+        }
+
+        // The shader doesn't write to any padding between blocks so the block-linear region is initialized with the current guest data to preserve it
+        std::memcpy(downloadStagingBuffer->data() + blockLinearOffset, mirror.data(), blockLinearSize);
+        return gpu.helperShaders.blockLinearHelperShader.Prepare(gpu, true, downloadStagingBuffer->vkBuffer, gpuSwizzleLevels);
+    }
+
+    void Texture::CompleteReadback(vk::DeviceSize blockLinearSize) {
+        gpu.syncTraffic.Record(SyncTrafficSource::TextureReadback, mirror.size());
+        vk::DeviceSize linearOffset{GetReadbackLinearOffset()};
+        if (blockLinearSize) {
+            vk::DeviceSize blockLinearOffset{util::AlignUp(linearOffset + deswizzledSurfaceSize, BlockLinearHelperShader::Alignment)};
+            std::memcpy(mirror.data(), downloadStagingBuffer->data() + blockLinearOffset, blockLinearSize);
+        } else {
+            CopyToGuest(downloadStagingBuffer->data() + linearOffset);
+        }
+    }
+
+    void Texture::CompleteAsyncReadback(FenceCycle *pReadbackCycle) {
+        std::unique_lock stateLock{stateMutex, std::try_to_lock};
+        if (!stateLock)
+            return;
+
+        // If the texture is locked then it's either being used by the GPU or will be synchronized by the owner of the lock, the readback will be consumed during the next guest synchronization in either case
+        std::unique_lock lock{*this, std::try_to_lock};
+        if (!lock || readbackCycle.get() != pReadbackCycle || dirtyState != DirtyState::GpuDirty)
+            return;
+
+        TRACE_EVENT("gpu", "Texture::CompleteAsyncReadback");
+
+        readbackCycle = {};
+        CompleteReadback(readbackBlockLinearSize);
+        dirtyState = DirtyState::Clean;
+        gpu.state.nce->TrapRegions(*trapHandle, true); // Trap any future CPU writes to this texture
+    }
+
+    std::function<void(const vk::raii::CommandBuffer &)> Texture::ScheduleReadback(const IntrusivePtr<FenceCycle> &pCycle) {
+        if (!guest || guestReadbackCount < AsyncReadbackThreshold || tiling != vk::ImageTiling::eOptimal || !IsGuestReadbackSupported() || layout == vk::ImageLayout::eUndefined)
+            return {};
+
+        {
+            std::scoped_lock lock{stateMutex};
+            if (dirtyState != DirtyState::GpuDirty)
+                return {};
+        }
+
+        std::shared_ptr<FormatConversionJob> conversionJob;
+        auto swizzleJob{PrepareReadback(readbackBlockLinearSize, conversionJob)};
+        if (swizzleJob)
+            pCycle->AttachObject(swizzleJob);
+        if (conversionJob)
+            pCycle->AttachObject(conversionJob);
+
+        readbackCycle = pCycle;
+
+        // The readback is completed on the CPU as soon as the cycle is signalled, so that a subsequent guest access doesn't need to wait on it at all
+        pCycle->AttachCallback([weakThis = weak_from_this(), pReadbackCycle = pCycle.get()] {
+            if (auto texture{weakThis.lock()})
+                texture->CompleteAsyncReadback(pReadbackCycle);
+        });
+
+        return [texture = shared_from_this(), stagingBuffer = downloadStagingBuffer, swizzleJob = std::move(swizzleJob), conversionJob = std::move(conversionJob)](const vk::raii::CommandBuffer &commandBuffer) {
+            texture->CopyIntoStagingBuffer(commandBuffer, stagingBuffer);
+            if (conversionJob)
+                texture->gpu.helperShaders.formatConversionHelperShader.Record(commandBuffer, *conversionJob);
+            if (swizzleJob)
+                texture->gpu.helperShaders.blockLinearHelperShader.Record(commandBuffer, *swizzleJob);
+        };
+    }
+
+    void Texture::InvalidateReadback() {
+        readbackCycle = {};
+    }
+
     void Texture::SynchronizeGuest(bool cpuDirty, bool skipTrap) {
         if (!guest)
             return;
@@ -817,28 +1286,42 @@ namespace skyline::gpu {
             dirtyState = cpuDirty ? DirtyState::CpuDirty : DirtyState::Clean;
         }
 
-        if (layout == vk::ImageLayout::eUndefined || format != guest->format)
+        if (layout == vk::ImageLayout::eUndefined || !IsGuestReadbackSupported())
             // If the state of the host texture is undefined then so can the guest
-            // If the texture has differing formats on the guest and host, we don't support converting back in that case as it may involve recompression of a decompressed texture
+            // If the texture has differing formats on the guest and host, we only support converting back when it's possible on the GPU as it may otherwise involve recompression of a decompressed texture
             return;
 
         WaitOnBacking();
 
-        if (tiling == vk::ImageTiling::eOptimal || !std::holds_alternative<memory::Image>(backing)) {
-            if (!downloadStagingBuffer)
-                downloadStagingBuffer = gpu.memory.AllocateStagingBuffer(surfaceSize);
-
-            WaitOnFence();
-            auto lCycle{gpu.scheduler.Submit([&](vk::raii::CommandBuffer &commandBuffer) {
-                CopyIntoStagingBuffer(commandBuffer, downloadStagingBuffer);
-            })};
-            lCycle->Wait(); // We block till the copy is complete
+        if (tiling == vk::ImageTiling::eOptimal || !std::holds_alternative<memory::Image>(backing) || format != guest->format) {
+            if (readbackCycle) {
+                // An asynchronous readback was already recorded after the last GPU usage of the texture, so we only need to wait for it rather than submitting a new one
+                auto lReadbackCycle{std::move(readbackCycle)};
+                lReadbackCycle->Wait();
+                CompleteReadback(readbackBlockLinearSize);
+            } else {
+                WaitOnFence();
 
-            CopyToGuest(downloadStagingBuffer->data());
+                vk::DeviceSize blockLinearSize;
+                std::shared_ptr<FormatConversionJob> conversionJob;
+                auto swizzleJob{PrepareReadback(blockLinearSize, conversionJob)};
+                auto lCycle{gpu.scheduler.Submit([&](vk::raii::CommandBuffer &commandBuffer) {
+                    CopyIntoStagingBuffer(commandBuffer, downloadStagingBuffer);
+                    if (conversionJob)
+                        gpu.helperShaders.formatConversionHelperShader.Record(commandBuffer, *conversionJob);
+                    if (swizzleJob)
+                        gpu.helperShaders.blockLinearHelperShader.Record(commandBuffer, *swizzleJob);
+                })};
+                lCycle->Wait(); // We block till the copy is complete
+
+                CompleteReadback(blockLinearSize);
+                guestReadbackCount++;
+            }
         } else if (tiling == vk::ImageTiling::eLinear) {
             // We can optimize linear texture sync on a UMA by mapping the texture onto the CPU and copying directly from it rather than using a staging buffer
             WaitOnFence();
             CopyToGuest(std::get<memory::Image>(backing).data());
+            gpu.syncTraffic.Record(SyncTrafficSource::TextureReadback, mirror.size());
         } else {
             throw exception("Host -> Guest synchronization of images tiled as '{}' isn't implemented", vk::to_string(tiling));
         }
@@ -850,14 +1333,21 @@ namespace skyline::gpu {
                 gpu.state.nce->TrapRegions(*trapHandle, true); // Trap any future CPU writes to this texture
     }
 
+    bool Texture::IsViewFormatCompatible(texture::Format pFormat) {
+        if (!pFormat || pFormat == guest->format || pFormat->vkFormat == format->vkFormat || (flags & vk::ImageCreateFlagBits::eMutableFormat))
+            return true;
+
+        // Adreno can alias views of formats with identical component bit layouts without the image being created with a mutable format, which is costly on it
+        return gpu.traits.quirks.adrenoRelaxedFormatAliasing && texture::IsAdrenoAliasCompatible(pFormat->vkFormat, format->vkFormat);
+    }
+
     std::shared_ptr<TextureView> Texture::GetView(vk::ImageViewType type, vk::ImageSubresourceRange range, texture::Format pFormat, vk::ComponentMapping mapping) {
+        if (!IsViewFormatCompatible(pFormat))
+            Logger::Warn("Creating a view of a texture with a different format without mutable format: {} - {}", vk::to_string(pFormat->vkFormat), vk::to_string(format->vkFormat));
+
         if (!pFormat || pFormat == guest->format)
             pFormat = format; // We want to use the texture's format if it isn't supplied or if the requested format matches the guest format then we want to use the host format just in case it is host incompatible and the host format differs from the guest format
 
-        auto viewFormat{pFormat->vkFormat}, textureFormat{format->vkFormat};
-        if (gpu.traits.quirks.vkImageMutableFormatCostly && viewFormat != textureFormat && (!gpu.traits.quirks.adrenoRelaxedFormatAliasing || !texture::IsAdrenoAliasCompatible(viewFormat, textureFormat)))
-            Logger::Warn("Creating a view of a texture with a different format without mutable format: {} - {}", vk::to_string(viewFormat), vk::to_string(textureFormat));
-
         if ((pFormat->vkAspect & format->vkAspect) == vk::ImageAspectFlagBits{}) {
             pFormat = format; // If the requested format doesn't share any aspects then fallback to the texture's format in the hope it's more likely to function
             range.aspectMask = format->Aspect(mapping.r == vk::ComponentSwizzle::eR);
@@ -873,6 +1363,35 @@ namespace skyline::gpu {
         return std::make_shared<TextureView>(shared_from_this(), type, range, pFormat, mapping);
     }
 
+    void Texture::SubmitWithSource(const std::shared_ptr<Texture> &source, vk::Semaphore waitSemaphore, vk::Semaphore signalSemaphore, const std::function<void(vk::raii::CommandBuffer &)> &recordFunction) {
+        auto submitFunc{[&](vk::Semaphore extraWaitSemaphore, u64 extraWaitValue){
+            boost::container::small_vector<vk::Semaphore, 2> waitSemaphores;
+            boost::container::small_vector<u64, 2> waitValues;
+            if (waitSemaphore) {
+                waitSemaphores.push_back(waitSemaphore);
+                waitValues.push_back(0);
+            }
+
+            if (extraWaitSemaphore) {
+                waitSemaphores.push_back(extraWaitSemaphore);
+                waitValues.push_back(extraWaitValue);
+            }
+
+            return gpu.scheduler.Submit([&](vk::raii::CommandBuffer &commandBuffer) {
+                recordFunction(commandBuffer);
+            }, waitSemaphores, span<vk::Semaphore>{signalSemaphore}, waitValues);
+        }};
+
+        auto newCycle{[&]{
+            if (source->cycle)
+                return source->cycle->RecordSemaphoreWaitUsage(std::move(submitFunc));
+            else
+                return submitFunc({}, 0);
+        }()};
+        newCycle->AttachObjects(source, shared_from_this());
+        cycle = newCycle;
+    }
+
     void Texture::CopyFrom(std::shared_ptr<Texture> source, vk::Semaphore waitSemaphore, vk::Semaphore signalSemaphore, texture::Format srcFormat, const vk::ImageSubresourceRange &subresource) {
         if (cycle)
             cycle->WaitSubmit();
@@ -885,118 +1404,173 @@ namespace skyline::gpu {
 
         if (source->layout == vk::ImageLayout::eUndefined)
             throw exception("Cannot copy from image with undefined layout");
-        else if (source->dimensions != dimensions)
-            throw exception("Cannot copy from image with different dimensions");
+        else if (source->dimensions.depth != dimensions.depth)
+            throw exception("Cannot copy from image with different depth");
 
         TRACE_EVENT("gpu", "Texture::CopyFrom");
 
-        auto submitFunc{[&](vk::Semaphore extraWaitSemaphore){
-            boost::container::small_vector<vk::Semaphore, 2> waitSemaphores;
-            if (waitSemaphore)
-                waitSemaphores.push_back(waitSemaphore);
-
-            if (extraWaitSemaphore)
-                waitSemaphores.push_back(extraWaitSemaphore);
+        SubmitWithSource(source, waitSemaphore, signalSemaphore, [&](vk::raii::CommandBuffer &commandBuffer) {
+            auto sourceBacking{source->GetBacking()};
+            if (source->layout != vk::ImageLayout::eTransferSrcOptimal) {
+                commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTopOfPipe, vk::PipelineStageFlagBits::eTransfer, {}, {}, {}, vk::ImageMemoryBarrier{
+                    .image = sourceBacking,
+                    .srcAccessMask = vk::AccessFlagBits::eMemoryWrite,
+                    .dstAccessMask = vk::AccessFlagBits::eTransferRead,
+                    .oldLayout = source->layout,
+                    .newLayout = vk::ImageLayout::eTransferSrcOptimal,
+                    .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                    .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                    .subresourceRange = subresource,
+                    });
+            }
 
-            return gpu.scheduler.Submit([&](vk::raii::CommandBuffer &commandBuffer) {
-                auto sourceBacking{source->GetBacking()};
-                if (source->layout != vk::ImageLayout::eTransferSrcOptimal) {
-                    commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTopOfPipe, vk::PipelineStageFlagBits::eTransfer, {}, {}, {}, vk::ImageMemoryBarrier{
-                        .image = sourceBacking,
-                        .srcAccessMask = vk::AccessFlagBits::eMemoryWrite,
-                        .dstAccessMask = vk::AccessFlagBits::eTransferRead,
-                        .oldLayout = source->layout,
-                        .newLayout = vk::ImageLayout::eTransferSrcOptimal,
-                        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-                        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-                        .subresourceRange = subresource,
-                        });
-                }
+            auto destinationBacking{GetBacking()};
+            if (layout != vk::ImageLayout::eTransferDstOptimal) {
+                commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eAllCommands, vk::PipelineStageFlagBits::eAllCommands, {}, {}, {}, vk::ImageMemoryBarrier{
+                    .image = destinationBacking,
+                    .srcAccessMask = vk::AccessFlagBits::eMemoryRead,
+                    .dstAccessMask = vk::AccessFlagBits::eTransferWrite,
+                    .oldLayout = layout,
+                    .newLayout = vk::ImageLayout::eTransferDstOptimal,
+                    .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                    .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                    .subresourceRange = subresource,
+                    });
 
-                auto destinationBacking{GetBacking()};
-                if (layout != vk::ImageLayout::eTransferDstOptimal) {
-                    commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eAllCommands, vk::PipelineStageFlagBits::eAllCommands, {}, {}, {}, vk::ImageMemoryBarrier{
-                        .image = destinationBacking,
-                        .srcAccessMask = vk::AccessFlagBits::eMemoryRead,
-                        .dstAccessMask = vk::AccessFlagBits::eTransferWrite,
-                        .oldLayout = layout,
-                        .newLayout = vk::ImageLayout::eTransferDstOptimal,
-                        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-                        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-                        .subresourceRange = subresource,
-                        });
-
-                    if (layout == vk::ImageLayout::eUndefined)
-                        layout = vk::ImageLayout::eTransferDstOptimal;
-                }
+                if (layout == vk::ImageLayout::eUndefined)
+                    layout = vk::ImageLayout::eTransferDstOptimal;
+            }
 
-                vk::ImageSubresourceLayers subresourceLayers{
-                    .aspectMask = subresource.aspectMask,
-                    .mipLevel = subresource.baseMipLevel,
-                    .baseArrayLayer = subresource.baseArrayLayer,
-                    .layerCount = subresource.layerCount == VK_REMAINING_ARRAY_LAYERS ? layerCount - subresource.baseArrayLayer : subresource.layerCount,
-                    };
-                for (; subresourceLayers.mipLevel < (subresource.levelCount == VK_REMAINING_MIP_LEVELS ? levelCount - subresource.baseMipLevel : subresource.levelCount); subresourceLayers.mipLevel++) {
-                    if (srcFormat != format) {
-                        commandBuffer.blitImage(sourceBacking, vk::ImageLayout::eTransferSrcOptimal, destinationBacking, vk::ImageLayout::eTransferDstOptimal, vk::ImageBlit{
-                                .srcSubresource = subresourceLayers,
-                                .srcOffsets = std::array<vk::Offset3D, 2>{
-                                    vk::Offset3D{0, 0, 0},
-                                    vk::Offset3D{static_cast<i32>(dimensions.width),
-                                                 static_cast<i32>(dimensions.height),
-                                                 static_cast<i32>(subresourceLayers.layerCount)}
-                                },
-                                .dstSubresource = subresourceLayers,
-                                .dstOffsets = std::array<vk::Offset3D, 2>{
-                                    vk::Offset3D{0, 0, 0},
-                                    vk::Offset3D{static_cast<i32>(dimensions.width),
-                                                 static_cast<i32>(dimensions.height),
-                                                 static_cast<i32>(subresourceLayers.layerCount)}
-                                }
-                            }, vk::Filter::eLinear);
-                    } else {
-                        commandBuffer.copyImage(sourceBacking, vk::ImageLayout::eTransferSrcOptimal, destinationBacking, vk::ImageLayout::eTransferDstOptimal, vk::ImageCopy{
+            vk::ImageSubresourceLayers subresourceLayers{
+                .aspectMask = subresource.aspectMask,
+                .mipLevel = subresource.baseMipLevel,
+                .baseArrayLayer = subresource.baseArrayLayer,
+                .layerCount = subresource.layerCount == VK_REMAINING_ARRAY_LAYERS ? layerCount - subresource.baseArrayLayer : subresource.layerCount,
+                };
+            for (; subresourceLayers.mipLevel < (subresource.levelCount == VK_REMAINING_MIP_LEVELS ? levelCount - subresource.baseMipLevel : subresource.levelCount); subresourceLayers.mipLevel++) {
+                // Images with differing dimensions (due to resolution scaling) are blitted which scales them to the destination's dimensions
+                if (srcFormat != format || source->dimensions != dimensions) {
+                    commandBuffer.blitImage(sourceBacking, vk::ImageLayout::eTransferSrcOptimal, destinationBacking, vk::ImageLayout::eTransferDstOptimal, vk::ImageBlit{
                             .srcSubresource = subresourceLayers,
+                            .srcOffsets = std::array<vk::Offset3D, 2>{
+                                vk::Offset3D{0, 0, 0},
+                                vk::Offset3D{static_cast<i32>(source->dimensions.width),
+                                             static_cast<i32>(source->dimensions.height),
+                                             static_cast<i32>(subresourceLayers.layerCount)}
+                            },
                             .dstSubresource = subresourceLayers,
-                            .extent = dimensions,
-                        });
-                    }
+                            .dstOffsets = std::array<vk::Offset3D, 2>{
+                                vk::Offset3D{0, 0, 0},
+                                vk::Offset3D{static_cast<i32>(dimensions.width),
+                                             static_cast<i32>(dimensions.height),
+                                             static_cast<i32>(subresourceLayers.layerCount)}
+                            }
+                        }, vk::Filter::eLinear);
+                } else {
+                    commandBuffer.copyImage(sourceBacking, vk::ImageLayout::eTransferSrcOptimal, destinationBacking, vk::ImageLayout::eTransferDstOptimal, vk::ImageCopy{
+                        .srcSubresource = subresourceLayers,
+                        .dstSubresource = subresourceLayers,
+                        .extent = dimensions,
+                    });
                 }
+            }
 
-                if (layout != vk::ImageLayout::eTransferDstOptimal)
-                    commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eAllCommands, vk::PipelineStageFlagBits::eAllCommands, {}, {}, {}, vk::ImageMemoryBarrier{
-                        .image = destinationBacking,
-                        .srcAccessMask = vk::AccessFlagBits::eTransferWrite,
-                        .dstAccessMask = vk::AccessFlagBits::eMemoryRead,
-                        .oldLayout = vk::ImageLayout::eTransferDstOptimal,
-                        .newLayout = layout,
-                        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-                        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-                        .subresourceRange = subresource,
-                        });
-
-                if (source->layout != vk::ImageLayout::eTransferSrcOptimal)
-                    commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eAllCommands, vk::PipelineStageFlagBits::eAllCommands, {}, {}, {}, vk::ImageMemoryBarrier{
-                        .image = sourceBacking,
-                        .srcAccessMask = vk::AccessFlagBits::eTransferRead,
-                        .dstAccessMask = vk::AccessFlagBits::eMemoryWrite,
-                        .oldLayout = vk::ImageLayout::eTransferSrcOptimal,
-                        .newLayout = source->layout,
-                        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-                        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-                        .subresourceRange = subresource,
-                        });
-            }, waitSemaphores, span<vk::Semaphore>{signalSemaphore});
-        }};
+            if (layout != vk::ImageLayout::eTransferDstOptimal)
+                commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eAllCommands, vk::PipelineStageFlagBits::eAllCommands, {}, {}, {}, vk::ImageMemoryBarrier{
+                    .image = destinationBacking,
+                    .srcAccessMask = vk::AccessFlagBits::eTransferWrite,
+                    .dstAccessMask = vk::AccessFlagBits::eMemoryRead,
+                    .oldLayout = vk::ImageLayout::eTransferDstOptimal,
+                    .newLayout = layout,
+                    .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                    .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                    .subresourceRange = subresource,
+                    });
+
+            if (source->layout != vk::ImageLayout::eTransferSrcOptimal)
+                commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eAllCommands, vk::PipelineStageFlagBits::eAllCommands, {}, {}, {}, vk::ImageMemoryBarrier{
+                    .image = sourceBacking,
+                    .srcAccessMask = vk::AccessFlagBits::eTransferRead,
+                    .dstAccessMask = vk::AccessFlagBits::eMemoryWrite,
+                    .oldLayout = vk::ImageLayout::eTransferSrcOptimal,
+                    .newLayout = source->layout,
+                    .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                    .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                    .subresourceRange = subresource,
+                    });
+        });
+    }
 
-        auto newCycle{[&]{
-            if (source->cycle)
-                return source->cycle->RecordSemaphoreWaitUsage(std::move(submitFunc));
-            else
-                return submitFunc({});
-        }()};
-        newCycle->AttachObjects(std::move(source), shared_from_this());
-        cycle = newCycle;
+    void Texture::UpscaleFrom(const std::shared_ptr<TextureView> &source, vk::Semaphore waitSemaphore, vk::Semaphore signalSemaphore) {
+        auto sourceTexture{source->texture};
+        if (cycle)
+            cycle->WaitSubmit();
+        if (sourceTexture->cycle)
+            sourceTexture->cycle->WaitSubmit();
+
+        WaitOnBacking();
+        sourceTexture->WaitOnBacking();
+        WaitOnFence();
+
+        if (sourceTexture->layout == vk::ImageLayout::eUndefined)
+            throw exception("Cannot upscale from image with undefined layout");
+
+        TRACE_EVENT("gpu", "Texture::UpscaleFrom");
+
+        constexpr vk::ImageSubresourceRange subresource{
+            .aspectMask = vk::ImageAspectFlagBits::eColor,
+            .levelCount = 1,
+            .layerCount = 1,
+        };
+        auto destination{GetView(vk::ImageViewType::e2D, subresource)};
+        auto job{gpu.helperShaders.spatialUpscaleHelperShader.Prepare(gpu, source->GetView(), destination->GetView())};
+
+        SubmitWithSource(sourceTexture, waitSemaphore, signalSemaphore, [&](vk::raii::CommandBuffer &commandBuffer) {
+            // Both images are used in the general layout as the source is sampled while the destination is written as a storage image
+            auto sourceBacking{sourceTexture->GetBacking()};
+            auto destinationBacking{GetBacking()};
+            std::array<vk::ImageMemoryBarrier, 2> barriers{
+                vk::ImageMemoryBarrier{
+                    .image = sourceBacking,
+                    .srcAccessMask = vk::AccessFlagBits::eMemoryWrite,
+                    .dstAccessMask = vk::AccessFlagBits::eShaderRead,
+                    .oldLayout = sourceTexture->layout,
+                    .newLayout = vk::ImageLayout::eGeneral,
+                    .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                    .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                    .subresourceRange = subresource,
+                },
+                vk::ImageMemoryBarrier{
+                    .image = destinationBacking,
+                    .srcAccessMask = vk::AccessFlagBits::eMemoryRead,
+                    .dstAccessMask = vk::AccessFlagBits::eShaderWrite,
+                    .oldLayout = vk::ImageLayout::eUndefined,
+                    .newLayout = vk::ImageLayout::eGeneral,
+                    .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                    .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                    .subresourceRange = subresource,
+                },
+            };
+            commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eAllCommands, vk::PipelineStageFlagBits::eComputeShader, {}, {}, {}, barriers);
+
+            gpu.helperShaders.spatialUpscaleHelperShader.Record(commandBuffer, *job,
+                                                                {sourceTexture->dimensions.width, sourceTexture->dimensions.height},
+                                                                {dimensions.width, dimensions.height});
+
+            barriers[0].srcAccessMask = vk::AccessFlagBits::eShaderRead;
+            barriers[0].dstAccessMask = vk::AccessFlagBits::eMemoryWrite;
+            barriers[0].oldLayout = vk::ImageLayout::eGeneral;
+            barriers[0].newLayout = sourceTexture->layout;
+            barriers[1].srcAccessMask = vk::AccessFlagBits::eShaderWrite;
+            barriers[1].dstAccessMask = vk::AccessFlagBits::eMemoryRead;
+            barriers[1].oldLayout = vk::ImageLayout::eGeneral;
+            barriers[1].newLayout = layout == vk::ImageLayout::eUndefined ? vk::ImageLayout::eGeneral : layout;
+            commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eAllCommands, {}, {}, {}, barriers);
+
+            if (layout == vk::ImageLayout::eUndefined)
+                layout = vk::ImageLayout::eGeneral;
+        });
+        cycle->AttachObject(job);
     }
 
     bool Texture::ValidateRenderPassUsage(u32 renderPassIndex, texture::RenderPassUsage renderPassUsage) {
@@ -1006,5 +1580,17 @@ namespace skyline::gpu {
     void Texture::UpdateRenderPassUsage(u32 renderPassIndex, texture::RenderPassUsage renderPassUsage) {
         lastRenderPassUsage = renderPassUsage;
         lastRenderPassIndex = renderPassIndex;
+        attachCountSinceRenderPassUsage = 0;
+    }
+
+    void Texture::RecordAttachment() {
+        attachCountSinceRenderPassUsage++;
+    }
+
+    std::optional<u32> Texture::GetOverwrittenRenderPass() {
+        // The only attachment allowed since the last render target usage is the one for the upcoming usage itself
+        if (lastRenderPassUsage == texture::RenderPassUsage::RenderTarget && attachCountSinceRenderPassUsage <= 1)
+            return lastRenderPassIndex;
+        return std::nullopt;
     }
 }
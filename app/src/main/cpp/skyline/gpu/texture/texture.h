@@ -12,6 +12,10 @@
 #include <gpu/memory_manager.h>
 
 namespace skyline::gpu {
+    struct BcnDecodeJob;
+    struct FormatConversionJob;
+    struct BlockLinearJob;
+
     namespace texture {
         enum class RenderPassUsage : u8 {
             None,
@@ -406,10 +410,26 @@ namespace skyline::gpu {
 
         std::vector<TextureViewStorage> views;
 
+        std::optional<memory::Image> unscaledImage; //!< An image with the dimensions of the guest texture that data is copied through for scaled textures, this is allocated on the first synchronization
+        vk::ImageLayout unscaledImageLayout{vk::ImageLayout::eUndefined};
+        vk::Filter unscaledImageFilter{vk::Filter::eNearest}; //!< The filter used for blits between the backing and the unscaled image
+
         std::shared_ptr<memory::StagingBuffer> downloadStagingBuffer{};
+        IntrusivePtr<FenceCycle> readbackCycle; //!< The cycle of an asynchronous readback into the download staging buffer which hasn't been copied into guest memory yet, this is reset when the texture is used by the GPU after the readback was recorded
+        vk::DeviceSize readbackBlockLinearSize{}; //!< The size of the block-linear data swizzled on the GPU by the pending asynchronous readback, this is 0 if the data must be copied into guest memory on the CPU
+
+        /**
+         * @brief GPU work that must be recorded prior to the copy out of a staging buffer, all jobs must be kept alive until the copy has completed
+         */
+        struct StagingBufferJobs {
+            std::shared_ptr<BlockLinearJob> deswizzleJob; //!< A deswizzle of raw guest data at the end of the staging buffer into the linear region at its start, this is recorded prior to any decode
+            std::shared_ptr<BcnDecodeJob> decodeJob; //!< A decode of compressed data in the linear region of the staging buffer, the decoded data follows it
+            std::shared_ptr<FormatConversionJob> conversionJob; //!< A conversion of the linear region of the staging buffer into the host format, the converted data follows it
+        };
 
         u32 lastRenderPassIndex{}; //!< The index of the last render pass that used this texture
         texture::RenderPassUsage lastRenderPassUsage{texture::RenderPassUsage::None}; //!< The type of usage in the last render pass
+        u32 attachCountSinceRenderPassUsage{}; //!< The amount of times this texture has been attached to an execution since its render pass usage was last updated, any attachment may read the texture outside of a render pass
 
         friend TextureManager;
         friend TextureView;
@@ -421,14 +441,16 @@ namespace skyline::gpu {
 
         /**
          * @brief An implementation function for guest -> host texture synchronization, it allocates and copies data into a staging buffer or directly into a linear host texture
+         * @param jobs Set to any GPU jobs required to deswizzle or decode the data in the staging buffer, these must be supplied to CopyFromStagingBuffer and kept alive until the copy has completed
          * @return If a staging buffer was required for the texture sync, it's returned filled with guest texture data and must be copied to the host texture by the callee
          */
-        std::shared_ptr<memory::StagingBuffer> SynchronizeHostImpl();
+        std::shared_ptr<memory::StagingBuffer> SynchronizeHostImpl(StagingBufferJobs &jobs);
 
         /**
          * @brief Records commands for copying data from a staging buffer to the texture's backing into the supplied command buffer
+         * @param jobs The GPU jobs returned by SynchronizeHostImpl alongside the staging buffer, if any
          */
-        void CopyFromStagingBuffer(const vk::raii::CommandBuffer &commandBuffer, const std::shared_ptr<memory::StagingBuffer> &stagingBuffer);
+        void CopyFromStagingBuffer(const vk::raii::CommandBuffer &commandBuffer, const std::shared_ptr<memory::StagingBuffer> &stagingBuffer, const StagingBufferJobs *jobs = nullptr);
 
         /**
          * @brief Records commands for copying data from the texture's backing to a staging buffer into the supplied command buffer
@@ -442,6 +464,54 @@ namespace skyline::gpu {
          */
         void CopyToGuest(u8 *hostBuffer);
 
+        /**
+         * @brief Allocates the unscaled image of a scaled texture if it hasn't been already
+         */
+        void AllocateUnscaledImage();
+
+        /**
+         * @brief Records a blit between the backing and the unscaled image of a scaled texture, which rescales the data between guest and host dimensions
+         * @param toBacking If the unscaled image is blitted into the backing rather than the other way around
+         * @note The backing **must** be in the eGeneral layout and the unscaled image must have been allocated
+         */
+        void RecordUnscaledImageBlit(const vk::raii::CommandBuffer &commandBuffer, bool toBacking);
+
+        /**
+         * @brief Submits commands recorded by the supplied function which read from the source texture and write into this texture, the submission is ordered after any prior GPU work on the source texture
+         * @param waitSemaphore A semaphore that the GPU waits on prior to executing the commands, this may be null
+         * @param signalSemaphore A semaphore that the GPU signals after executing the commands
+         */
+        void SubmitWithSource(const std::shared_ptr<Texture> &source, vk::Semaphore waitSemaphore, vk::Semaphore signalSemaphore, const std::function<void(vk::raii::CommandBuffer &)> &recordFunction);
+
+        /**
+         * @return If the contents of the texture can be written back to the guest, this isn't possible for host formats that the guest format was decoded into
+         */
+        bool IsGuestReadbackSupported();
+
+        /**
+         * @return The offset of the linear data in the guest format within the download staging buffer, this follows the host data when it must be converted on the GPU
+         */
+        vk::DeviceSize GetReadbackLinearOffset();
+
+        /**
+         * @brief Prepares a readback of the texture into the download staging buffer, allocating it if necessary
+         * @param blockLinearSize Set to the size of the block-linear data written by the returned job, this is 0 if no job is returned
+         * @param conversionJob Set to a job converting the host data into the guest format on the GPU which must be recorded after the copy into the staging buffer and prior to the returned job, this is null if the formats match
+         * @return A job swizzling the data on the GPU which must be recorded after the copy into the staging buffer, this is null if the data must be copied into guest memory on the CPU
+         */
+        std::shared_ptr<BlockLinearJob> PrepareReadback(vk::DeviceSize &blockLinearSize, std::shared_ptr<FormatConversionJob> &conversionJob);
+
+        /**
+         * @brief Copies the contents of the download staging buffer into guest memory after a readback has completed
+         * @param blockLinearSize The size of the block-linear data written by the job returned from PrepareReadback
+         */
+        void CompleteReadback(vk::DeviceSize blockLinearSize);
+
+        /**
+         * @brief Completes a pending asynchronous readback from a callback of its cycle, this is a no-op if the texture was used by the GPU since or is locked by another thread which will consume the readback instead
+         */
+        void CompleteAsyncReadback(FenceCycle *pReadbackCycle);
+
         /**
          * @return A vector of all the buffer image copies that need to be done for every aspect of every level of every layer of the texture
          */
@@ -455,10 +525,14 @@ namespace skyline::gpu {
         size_t accumulatedGuestWaitCounter{}; //!< Total number of times the texture has been waited on
         std::chrono::nanoseconds accumulatedGuestWaitTime{}; //!< Amount of time the texture has been waited on for since the `SkipReadbackHackWaitCountThreshold`th wait on it by the guest
 
+        static constexpr size_t AsyncReadbackThreshold{2}; //!< Threshold for the number of synchronous readbacks of a texture after which it's considered likely to be read by the guest again and is read back asynchronously after every execution that uses it
+        size_t guestReadbackCount{}; //!< Total number of times the texture has been synchronously read back into guest memory through a staging buffer
+
       public:
-        std::shared_ptr<FenceCycle> cycle; //!< A fence cycle for when any host operation mutating the texture has completed, it must be waited on prior to any mutations to the backing
+        IntrusivePtr<FenceCycle> cycle; //!< A fence cycle for when any host operation mutating the texture has completed, it must be waited on prior to any mutations to the backing
         std::optional<GuestTexture> guest;
         texture::Dimensions dimensions;
+        float resolutionScale{1.0f}; //!< The factor the dimensions of the host image are scaled by relative to the guest texture, this is only not 1 for render targets created while resolution scaling was enabled
         texture::Format format;
         vk::ImageLayout layout;
         vk::ImageTiling tiling;
@@ -473,6 +547,8 @@ namespace skyline::gpu {
         size_t surfaceSize{}; //!< The size of the entire surface given linear tiling, this contains all mip levels and layers
         vk::SampleCountFlagBits sampleCount;
         bool replaced{};
+        bool evicted{}; //!< If the texture was evicted from the texture manager to stay within the texture memory budget, this implies replaced
+        std::atomic<u64> lastUsedExecution{}; //!< The texture manager's execution count at the last use of this texture, textures that haven't been used for the longest are evicted first
 
         /**
          * @brief Creates a texture object wrapping the supplied backing with the supplied attributes
@@ -482,12 +558,20 @@ namespace skyline::gpu {
 
         /**
          * @brief Creates a texture object wrapping the guest texture with a backing that can represent the guest texture data
+         * @param resolutionScale The factor to scale the dimensions of the host image by, this must be 1 unless the texture is a single level 2D render target
          * @note The guest mappings will not be setup until SetupGuestMappings() is called
          */
-        Texture(GPU &gpu, GuestTexture guest);
+        Texture(GPU &gpu, GuestTexture guest, float resolutionScale = 1.0f);
 
         ~Texture();
 
+        /**
+         * @return If the host image has different dimensions to the guest texture due to resolution scaling
+         */
+        bool IsScaled() const {
+            return resolutionScale != 1.0f;
+        }
+
         /**
          * @note The handle returned is nullable and the appropriate precautions should be taken
          */
@@ -564,7 +648,7 @@ namespace skyline::gpu {
          * @note It is more efficient to call SynchronizeHost than allocating a command buffer purely for this function as it may conditionally not record any commands
          * @note The texture **must** be locked prior to calling this
          */
-        void SynchronizeHostInline(const vk::raii::CommandBuffer &commandBuffer, const std::shared_ptr<FenceCycle> &cycle, bool gpuDirty = false);
+        void SynchronizeHostInline(const vk::raii::CommandBuffer &commandBuffer, const IntrusivePtr<FenceCycle> &cycle, bool gpuDirty = false);
 
         /**
          * @brief Synchronizes the guest texture with the host texture after it has been modified
@@ -575,6 +659,24 @@ namespace skyline::gpu {
          */
         void SynchronizeGuest(bool cpuDirty = false, bool skipTrap = false);
 
+        /**
+         * @brief Schedules an asynchronous readback of the texture at the end of the supplied cycle if it's GPU dirty and likely to be read by the guest, the readback is copied into guest memory as soon as the cycle is signalled
+         * @return A function recording the copy into a staging buffer which must be recorded into the cycle's command buffer after all other usages of the texture, this is empty if no readback was scheduled
+         * @note The texture **must** be locked prior to calling this
+         */
+        std::function<void(const vk::raii::CommandBuffer &)> ScheduleReadback(const IntrusivePtr<FenceCycle> &cycle);
+
+        /**
+         * @brief Discards any pending asynchronous readback as the texture is about to be used by the GPU again
+         * @note The texture **must** be locked prior to calling this
+         */
+        void InvalidateReadback();
+
+        /**
+         * @return If a view of this texture can reinterpret it with the supplied guest format, this is always true for textures created with VK_IMAGE_CREATE_MUTABLE_FORMAT_BIT and otherwise requires the formats to match or be alias compatible on Adreno
+         */
+        bool IsViewFormatCompatible(texture::Format pFormat);
+
         /**
          * @return A cached or newly created view into this texture with the supplied attributes
          */
@@ -589,6 +691,12 @@ namespace skyline::gpu {
             .layerCount = VK_REMAINING_ARRAY_LAYERS,
         });
 
+        /**
+         * @brief Upscales the contents of the supplied source view into the first level and layer of the current texture with an edge-adaptive spatial filter
+         * @note The texture must have been created with storage usage and a format of R8G8B8A8Unorm, the source view must be a sampled 2D view
+         */
+        void UpscaleFrom(const std::shared_ptr<TextureView> &source, vk::Semaphore waitSemaphore, vk::Semaphore signalSemaphore);
+
         /**
          * @return If the texture is frequently locked by threads using non-ContextLocks
          */
@@ -606,5 +714,17 @@ namespace skyline::gpu {
          * @brief Updates renderpass usage tracking information
          */
         void UpdateRenderPassUsage(u32 renderPassIndex, texture::RenderPassUsage renderPassUsage);
+
+        /**
+         * @brief Records an attachment of the texture to an execution for render pass usage tracking
+         */
+        void RecordAttachment();
+
+        /**
+         * @brief Determines the render pass of which the contents written to this texture will be fully overwritten by the upcoming usage of it
+         * @return The index of the last render pass that used this texture as a render target, if it is known to not have been used in any other way since
+         * @note This must be called after the texture has been attached for the upcoming usage and prior to its render pass usage being updated
+         */
+        std::optional<u32> GetOverwrittenRenderPass();
     };
 }
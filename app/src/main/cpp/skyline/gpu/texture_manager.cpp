@@ -1,18 +1,130 @@
 // SPDX-License-Identifier: MPL-2.0
 // Copyright © 2021 Skyline Team and Contributors (https://github.com/skyline-emu/)
 
+#include <gpu.h>
+#include <common/settings.h>
+#include <common/trace.h>
 #include "texture_manager.h"
 
 namespace skyline::gpu {
     TextureManager::TextureManager(GPU &gpu) : gpu(gpu) {}
 
-    std::shared_ptr<TextureView> TextureManager::FindOrCreate(const GuestTexture &guestTexture, ContextTag tag) {
+    void TextureManager::InsertMapping(const std::shared_ptr<Texture> &texture, GuestTexture::Mappings::iterator iterator) {
+        if (iterator->empty())
+            return;
+
+        u64 bucketBegin{reinterpret_cast<u64>(iterator->data()) >> BucketGranularityBits}, bucketEnd{(reinterpret_cast<u64>(iterator->end().base()) - 1) >> BucketGranularityBits};
+        for (u64 bucket{bucketBegin}; bucket <= bucketEnd; bucket++)
+            textureTable[bucket].emplace_back(texture, iterator, *iterator);
+    }
+
+    void TextureManager::RemoveMappings(const std::shared_ptr<Texture> &texture) {
+        for (const auto &mapping : texture->guest->mappings) {
+            if (mapping.empty())
+                continue;
+
+            u64 bucketBegin{reinterpret_cast<u64>(mapping.data()) >> BucketGranularityBits}, bucketEnd{(reinterpret_cast<u64>(mapping.end().base()) - 1) >> BucketGranularityBits};
+            for (u64 bucket{bucketBegin}; bucket <= bucketEnd; bucket++) {
+                auto it{textureTable.find(bucket)};
+                if (it == textureTable.end())
+                    continue;
+
+                auto &bucketMappings{it.value()};
+                bucketMappings.erase(std::remove_if(bucketMappings.begin(), bucketMappings.end(), [&](const TextureMapping &bucketMapping) {
+                    return bucketMapping.texture == texture;
+                }), bucketMappings.end());
+                if (bucketMappings.empty())
+                    textureTable.erase(it);
+            }
+        }
+    }
+
+    void TextureManager::EnforceBudget(const std::shared_ptr<Texture> &newTexture) {
+        size_t budget{static_cast<size_t>(*gpu.state.settings->textureMemoryBudget) * 1024 * 1024};
+        if (!budget || residentSize <= budget)
+            return;
+
+        TRACE_EVENT("gpu", "TextureManager::EnforceBudget");
+
+        // We evict down to below the budget to avoid needing to evict again on every subsequent texture creation
+        size_t targetSize{budget - (budget / 8)};
+        u64 currentExecution{executionCount.load(std::memory_order_relaxed)};
+
+        struct Candidate {
+            std::shared_ptr<Texture> *texture;
+            u32 priority; //!< Lower priorities are evicted first: replaced textures, then textures that don't need to be written back and finally GPU dirty textures
+            u64 lastUsedExecution;
+        };
+        std::vector<Candidate> candidates;
+        for (auto &texture : residentTextures) {
+            u64 lastUsedExecution{texture->lastUsedExecution.load(std::memory_order_relaxed)};
+            if (texture == newTexture || currentExecution - std::min(lastUsedExecution, currentExecution) < EvictionMinimumAge)
+                continue;
+
+            u32 priority;
+            {
+                std::scoped_lock lock{texture->stateMutex};
+                priority = texture->replaced ? 0 : (texture->dirtyState != Texture::DirtyState::GpuDirty ? 1 : 2);
+            }
+            candidates.push_back({&texture, priority, lastUsedExecution});
+        }
+
+        std::sort(candidates.begin(), candidates.end(), [](const Candidate &lhs, const Candidate &rhs) {
+            return lhs.priority != rhs.priority ? lhs.priority < rhs.priority : lhs.lastUsedExecution < rhs.lastUsedExecution;
+        });
+
+        size_t evictedCount{}, evictedSize{};
+        for (const auto &candidate : candidates) {
+            if (residentSize <= targetSize)
+                break;
+
+            auto &texture{*candidate.texture};
+            std::unique_lock textureLock{*texture, std::try_to_lock};
+            if (!textureLock)
+                continue; // The texture is in use by an executor and cannot be evicted
+
+            {
+                std::scoped_lock lock{texture->stateMutex};
+                if (texture->dirtyState == Texture::DirtyState::GpuDirty) {
+                    // GPU dirty textures are written back prior to eviction as the texture recreated in their place is synchronized from guest memory, this isn't possible if the host format differs and can't be converted back
+                    if (!texture->IsGuestReadbackSupported())
+                        continue;
+                    texture->SynchronizeGuest(true);
+                }
+            }
+
+            RemoveMappings(texture);
+            texture->replaced = true;
+            texture->evicted = true;
+            residentSize -= texture->surfaceSize;
+            evictedSize += texture->surfaceSize;
+            evictedCount++;
+        }
+
+        if (!evictedCount)
+            return;
+
+        std::erase_if(residentTextures, [](const std::shared_ptr<Texture> &texture) { return texture->evicted; });
+        evictionGeneration.fetch_add(1, std::memory_order_relaxed);
+        Logger::Debug("Evicted {} textures ({} KiB) to stay within the texture memory budget", evictedCount, evictedSize / 1024);
+    }
+
+    /**
+     * @return If a render target can be created with a resolution scale, this is limited to single level 2D textures that don't require any conversions on the GPU
+     */
+    static bool IsScalableRenderTarget(const GuestTexture &guestTexture) {
+        return guestTexture.mipLevelCount == 1 && guestTexture.dimensions.depth == 1 && guestTexture.tileConfig.mode == texture::TileMode::Block && !guestTexture.format->IsCompressed() &&
+            (guestTexture.viewType == vk::ImageViewType::e2D || guestTexture.viewType == vk::ImageViewType::e2DArray);
+    }
+
+    std::shared_ptr<TextureView> TextureManager::FindOrCreate(const GuestTexture &guestTexture, ContextTag tag, bool renderTarget) {
         auto guestMapping{guestTexture.mappings.front()};
 
         /*
          * Iterate over all textures that overlap with the first mapping of the guest texture and compare the mappings:
          * 1) All mappings match up perfectly, we check that the rest of the supplied mappings correspond to mappings in the texture
          * 1.1) If they match as well, we check for format/dimensions/tiling config matching the texture and return or move onto (3)
+         *      The format matches if a view of the texture can reinterpret it as the guest format, on hosts where mutable formats are costly this relies on the formats being alias compatible
          * 2) Only a contiguous range of mappings match, we check for if the overlap is meaningful with layout math, it can go two ways:
          * 2.1) If there is a meaningful overlap, we check for format/dimensions/tiling config compatibility and return or move onto (3)
          * 2.2) If there isn't, we move onto (3)
@@ -25,18 +137,25 @@ namespace skyline::gpu {
 
         std::shared_ptr<Texture> match{};
         boost::container::small_vector<std::shared_ptr<Texture>, 4> matches{};
-        auto mappingEnd{std::upper_bound(textures.begin(), textures.end(), guestMapping, [guestMapping](const auto &value, const auto &element) {
-            return guestMapping.end() < element.end();
-        })}, hostMapping{std::lower_bound(mappingEnd, textures.end(), guestMapping, [guestMapping](const auto &value, const auto &element) {
-            return guestMapping.begin() < element.end();
-        })};
+
+        // Any mapping containing the guest mapping must overlap its first byte and as such will be in the bucket of it
+        boost::container::small_vector<TextureMapping *, 8> candidates;
+        if (auto bucket{textureTable.find(reinterpret_cast<u64>(guestMapping.data()) >> BucketGranularityBits)}; bucket != textureTable.end())
+            for (auto &mapping : bucket.value() | ranges::views::reverse)
+                if (mapping.end() > guestMapping.begin())
+                    candidates.push_back(&mapping);
+
+        // The matching below depends on the order candidates are visited in, they are visited in descending order of their end with the most recently inserted mapping first on ties
+        std::stable_sort(candidates.begin(), candidates.end(), [](const TextureMapping *lhs, const TextureMapping *rhs) {
+            return lhs->end() > rhs->end();
+        });
 
         std::shared_ptr<Texture> fullMatch{};
         std::shared_ptr<Texture> layerMipMatch{};
         u32 matchLevel{};
         u32 matchLayer{};
 
-        while (hostMapping != textures.begin() && (--hostMapping)->end() > guestMapping.begin()) {
+        for (auto *hostMapping : candidates) {
             auto &hostMappings{hostMapping->texture->guest->mappings};
             if (!hostMapping->contains(guestMapping) || hostMapping->texture->replaced)
                 continue;
@@ -55,7 +174,7 @@ namespace skyline::gpu {
             if (firstHostMapping == hostMappings.begin() && firstHostMapping->begin() == guestMapping.begin() && mappingMatch && lastHostMapping == hostMappings.end() && lastGuestMapping.end() == std::prev(lastHostMapping)->end()) {
                 // We've gotten a perfect 1:1 match for *all* mappings from the start to end, we just need to check for compatibility aside from this
                 auto &matchGuestTexture{*hostMapping->texture->guest};
-                if (matchGuestTexture.format->IsCompatible(*guestTexture.format) &&
+                if (matchGuestTexture.format->IsCompatible(*guestTexture.format) && hostMapping->texture->IsViewFormatCompatible(guestTexture.format) &&
                     ((((matchGuestTexture.dimensions.width == guestTexture.dimensions.width &&
                         matchGuestTexture.dimensions.height == guestTexture.dimensions.height) || matchGuestTexture.CalculateLayerSize() == guestTexture.CalculateLayerSize()) &&
                         matchGuestTexture.GetViewDepth() <= guestTexture.GetViewDepth())
@@ -67,7 +186,7 @@ namespace skyline::gpu {
                 }
             } else {
                 auto &matchGuestTexture{*hostMapping->texture->guest};
-                if (matchGuestTexture.format->IsCompatible(*guestTexture.format) && matchGuestTexture.tileConfig == guestTexture.tileConfig &&
+                if (matchGuestTexture.format->IsCompatible(*guestTexture.format) && hostMapping->texture->IsViewFormatCompatible(guestTexture.format) && matchGuestTexture.tileConfig == guestTexture.tileConfig &&
                         (!layerMipMatch || (matchGuestTexture.GetViewLayerCount() >= layerMipMatch->guest->GetViewLayerCount() && matchGuestTexture.mipLevelCount >= layerMipMatch->guest->mipLevelCount))) {
                     size_t memOffset{static_cast<size_t>(guestMapping.data() - hostMapping->texture->guest->mappings.front().data())};
                     size_t layerMemOffset{};
@@ -108,6 +227,7 @@ namespace skyline::gpu {
          }
 
         if (layerMipMatch) {
+            MarkUsed(*layerMipMatch);
             ContextLock textureLock{tag, *layerMipMatch};
             return layerMipMatch->GetView(guestTexture.viewType, vk::ImageSubresourceRange{
                 .aspectMask = guestTexture.aspect,
@@ -117,6 +237,7 @@ namespace skyline::gpu {
                 .layerCount = guestTexture.GetViewLayerCount(),
             }, guestTexture.format, guestTexture.swizzle);
         } else if (fullMatch) {
+            MarkUsed(*fullMatch);
             ContextLock textureLock{tag, *fullMatch};
             return fullMatch->GetView(guestTexture.viewType, vk::ImageSubresourceRange{
                 .aspectMask = guestTexture.aspect,
@@ -131,17 +252,21 @@ namespace skyline::gpu {
             texture->SynchronizeGuest(false, true);
 
         // Create a texture as we cannot find one that matches
-        auto texture{std::make_shared<Texture>(gpu, guestTexture)};
+        float resolutionScale{1.0f};
+        if (renderTarget && IsScalableRenderTarget(guestTexture))
+            resolutionScale = static_cast<float>(*gpu.state.settings->resolutionScale) / 100.0f;
+
+        auto texture{std::make_shared<Texture>(gpu, guestTexture, resolutionScale)};
         texture->SetupGuestMappings();
         texture->TransitionLayout(vk::ImageLayout::eGeneral);
-        auto it{texture->guest->mappings.begin()};
-        textures.emplace(mappingEnd, TextureMapping{texture, it, guestMapping});
-        while ((++it) != texture->guest->mappings.end()) {
-            guestMapping = *it;
-            auto mapping{std::upper_bound(textures.begin(), textures.end(), guestMapping)};
-            // TODO: Delete overlapping textures that aren't in texture pool
-            textures.emplace(mapping, TextureMapping{texture, it, guestMapping});
-        }
+        // TODO: Delete overlapping textures that aren't in texture pool
+        for (auto it{texture->guest->mappings.begin()}; it != texture->guest->mappings.end(); it++)
+            InsertMapping(texture, it);
+
+        MarkUsed(*texture);
+        residentTextures.push_back(texture);
+        residentSize += texture->surfaceSize;
+        EnforceBudget(texture);
 
         return texture->GetView(guestTexture.viewType, vk::ImageSubresourceRange{
             .aspectMask = guestTexture.aspect,
@@ -151,4 +276,47 @@ namespace skyline::gpu {
             .layerCount = guestTexture.GetViewLayerCount(),
         }, guestTexture.format, guestTexture.swizzle);
     }
+
+    std::shared_ptr<Texture> TextureManager::Lookup(span<u8> mapping) {
+        auto bucket{textureTable.find(reinterpret_cast<u64>(mapping.data()) >> BucketGranularityBits)};
+        if (bucket == textureTable.end())
+            return nullptr;
+
+        for (auto &hostMapping : bucket.value() | ranges::views::reverse)
+            if (hostMapping.begin() == mapping.begin() && hostMapping.contains(mapping) && hostMapping.iterator == hostMapping.texture->guest->mappings.begin() && !hostMapping.texture->replaced)
+                return hostMapping.texture;
+
+        return nullptr;
+    }
+
+    void TextureManager::Trim() {
+        TRACE_EVENT("gpu", "TextureManager::Trim");
+
+        size_t evictedCount{}, evictedSize{};
+        for (auto &texture : residentTextures) {
+            std::unique_lock textureLock{*texture, std::try_to_lock};
+            if (!textureLock)
+                continue;
+
+            {
+                std::scoped_lock lock{texture->stateMutex};
+                if (texture->dirtyState == Texture::DirtyState::GpuDirty)
+                    continue; // These would need to be written back to the guest which isn't worth stalling suspension on
+            }
+
+            RemoveMappings(texture);
+            texture->replaced = true;
+            texture->evicted = true;
+            residentSize -= texture->surfaceSize;
+            evictedSize += texture->surfaceSize;
+            evictedCount++;
+        }
+
+        if (!evictedCount)
+            return;
+
+        std::erase_if(residentTextures, [](const std::shared_ptr<Texture> &texture) { return texture->evicted; });
+        evictionGeneration.fetch_add(1, std::memory_order_relaxed);
+        Logger::Info("Trimmed {} clean textures ({} KiB)", evictedCount, evictedSize / 1024);
+    }
 }
@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include <tsl/robin_map.h>
 #include "texture/texture.h"
 
 namespace skyline::gpu {
@@ -25,16 +26,76 @@ namespace skyline::gpu {
                   iterator(iterator) {}
         };
 
+        static constexpr size_t BucketGranularityBits{20}; //!< The amount of AS (in bytes) covered by a single bucket of the texture table (1 MiB == 1 << 20)
+
+        static constexpr u64 EvictionMinimumAge{256}; //!< The minimum amount of executions since a texture was last used for it to be evicted, this avoids evicting textures from the current working set
+
         GPU &gpu;
-        std::vector<TextureMapping> textures; //!< A sorted vector of all texture mappings
+        tsl::robin_map<u64, boost::container::small_vector<TextureMapping, 4>> textureTable; //!< A table of buckets containing all texture mappings overlapping the bucket's region in insertion order, a mapping is inserted into every bucket it overlaps
+        std::vector<std::shared_ptr<Texture>> residentTextures; //!< All textures in the texture table, these are candidates for eviction
+        size_t residentSize{}; //!< The combined host size of all resident textures in bytes
+        std::atomic<u64> executionCount{}; //!< The amount of executions submitted across all channels, this is used as a timestamp for texture usage
+        std::atomic<u32> evictionGeneration{}; //!< Incremented whenever any textures are evicted
+
+        /**
+         * @brief Inserts the supplied mapping of a texture into all buckets it overlaps
+         */
+        void InsertMapping(const std::shared_ptr<Texture> &texture, GuestTexture::Mappings::iterator iterator);
+
+        /**
+         * @brief Removes all mappings of the supplied texture from the texture table
+         */
+        void RemoveMappings(const std::shared_ptr<Texture> &texture);
+
+        /**
+         * @brief Evicts the least recently used textures until the resident size is below the texture memory budget, textures which don't require a writeback to the guest are evicted first
+         * @param newTexture A newly created texture which must not be evicted
+         * @note Evicted textures are removed from the texture table and marked as replaced, they are destroyed once all references to them are released and recreated from guest memory on their next lookup
+         */
+        void EnforceBudget(const std::shared_ptr<Texture> &newTexture);
 
       public:
         TextureManager(GPU &gpu);
 
         /**
+         * @param renderTarget If the texture is being used as a render target, newly created render targets are scaled by the resolution scale setting
          * @return A pre-existing or newly created Texture object which matches the specified criteria
          * @note The texture manager **must** be locked prior to calling this
          */
-        std::shared_ptr<TextureView> FindOrCreate(const GuestTexture &guestTexture, ContextTag tag = {});
+        std::shared_ptr<TextureView> FindOrCreate(const GuestTexture &guestTexture, ContextTag tag = {}, bool renderTarget = false);
+
+        /**
+         * @return The most recently created texture with a first mapping starting at and entirely containing the supplied mapping, or nullptr if there is no such texture
+         * @note Unlike FindOrCreate, this never creates or replaces any textures and is intended for routing copies to textures that are already resident on the host
+         * @note The texture manager **must** be locked prior to calling this
+         */
+        std::shared_ptr<Texture> Lookup(span<u8> mapping);
+
+        /**
+         * @brief Evicts all resident textures which don't require a writeback to the guest regardless of when they were last used, this is used to release host memory while emulation is suspended
+         * @note The texture manager **must** be locked prior to calling this
+         */
+        void Trim();
+
+        /**
+         * @brief Timestamps the supplied texture as being used by the current execution
+         */
+        void MarkUsed(Texture &texture) {
+            texture.lastUsedExecution.store(executionCount.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Advances the execution count used for timestamping texture usage, this should be called on every executor submission
+         */
+        void OnExecutionSubmitted() {
+            executionCount.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        /**
+         * @return A counter which is incremented whenever textures are evicted, holders of long-lived texture references should drop any references to evicted textures when this changes
+         */
+        u32 GetEvictionGeneration() const {
+            return evictionGeneration.load(std::memory_order_relaxed);
+        }
     };
 }
@@ -0,0 +1,127 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2023 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#include <gpu.h>
+#include "timestamp_profiler.h"
+
+namespace skyline::gpu {
+    TimestampProfiler::Batch::Batch(GPU &gpu) : pool{gpu.vkDevice, vk::QueryPoolCreateInfo{
+        .queryType = vk::QueryType::eTimestamp,
+        .queryCount = MaxRegionCount * 2,
+    }} {}
+
+    perfetto::Track TimestampProfiler::GetTrack(TimestampCategory category) {
+        return perfetto::Track{static_cast<u64>(trace::TrackIds::GpuRenderPasses) - static_cast<u64>(category), perfetto::ProcessTrack::Current()};
+    }
+
+    TimestampProfiler::TimestampProfiler(GPU &gpu) : gpu{gpu} {
+        u32 validBits{gpu.vkPhysicalDevice.getQueueFamilyProperties()[gpu.vkQueueFamilyIndex].timestampValidBits};
+        if (!validBits) {
+            Logger::Info("GPU timestamp profiling is unsupported as the queue doesn't support timestamps");
+            return;
+        }
+
+        supported = true;
+        timestampPeriod = static_cast<double>(gpu.vkPhysicalDevice.getProperties().limits.timestampPeriod);
+        timestampMask = validBits >= 64 ? std::numeric_limits<u64>::max() : (1ULL << validBits) - 1;
+
+        for (u8 category{}; category < TrackNames.size(); category++) {
+            auto track{GetTrack(static_cast<TimestampCategory>(category))};
+            auto desc{track.Serialize()};
+            desc.set_name(TrackNames[category]);
+            perfetto::TrackEvent::SetTrackDescriptor(track, desc);
+        }
+    }
+
+    bool TimestampProfiler::IsEnabled() const {
+        return supported && TRACE_EVENT_CATEGORY_ENABLED("gpu_timestamps");
+    }
+
+    std::unique_ptr<TimestampProfiler::Batch> TimestampProfiler::AcquireBatch(vk::raii::CommandBuffer &commandBuffer) {
+        std::unique_ptr<Batch> batch;
+        {
+            std::scoped_lock lock{mutex};
+            if (!freeBatches.empty()) {
+                batch = std::move(freeBatches.back());
+                freeBatches.pop_back();
+            }
+        }
+
+        if (!batch)
+            batch = std::make_unique<Batch>(gpu);
+
+        batch->regions.clear();
+        batch->regionOpen = false;
+        commandBuffer.resetQueryPool(*batch->pool, 0, MaxRegionCount * 2);
+        return batch;
+    }
+
+    void TimestampProfiler::BeginRegion(Batch &batch, vk::raii::CommandBuffer &commandBuffer, TimestampCategory category) {
+        if (batch.regionOpen || batch.regions.size() >= MaxRegionCount)
+            return;
+
+        commandBuffer.writeTimestamp(vk::PipelineStageFlagBits::eTopOfPipe, *batch.pool, static_cast<u32>(batch.regions.size() * 2));
+        batch.regions.push_back(category);
+        batch.regionOpen = true;
+    }
+
+    void TimestampProfiler::EndRegion(Batch &batch, vk::raii::CommandBuffer &commandBuffer) {
+        if (!batch.regionOpen)
+            return;
+
+        commandBuffer.writeTimestamp(vk::PipelineStageFlagBits::eBottomOfPipe, *batch.pool, static_cast<u32>(batch.regions.size() * 2 - 1));
+        batch.regionOpen = false;
+    }
+
+    void TimestampProfiler::Resolve(Batch &batch, u32 executionNumber) {
+        if (batch.regionOpen)
+            batch.regions.pop_back(); // A region that was never ended has no valid end timestamp
+
+        if (batch.regions.empty())
+            return;
+
+        u32 queryCount{static_cast<u32>(batch.regions.size() * 2)};
+        // The cycle may have been cancelled rather than signalled, in which case the queries aren't available and nothing is emitted
+        auto [result, timestamps]{batch.pool.getResults<u64>(0, queryCount, queryCount * sizeof(u64), sizeof(u64), vk::QueryResultFlagBits::e64)};
+        if (result != vk::Result::eSuccess)
+            return;
+
+        auto toNs{[this](u64 timestamp) {
+            return static_cast<i64>(static_cast<double>(timestamp & timestampMask) * timestampPeriod);
+        }};
+
+        i64 latestNs{};
+        for (u64 timestamp : timestamps)
+            latestNs = std::max(latestNs, toNs(timestamp));
+
+        std::scoped_lock lock{mutex};
+        i64 offsetNs{static_cast<i64>(perfetto::TrackEvent::GetTraceTimeNs()) - latestNs};
+        if (!clockOffsetNs || offsetNs < *clockOffsetNs)
+            clockOffsetNs = offsetNs;
+
+        for (size_t i{}; i < batch.regions.size(); i++) {
+            auto category{batch.regions[i]};
+            auto track{GetTrack(category)};
+            i64 startNs{toNs(timestamps[i * 2])}, endNs{std::max(toNs(timestamps[i * 2 + 1]), startNs)};
+            TRACE_EVENT_BEGIN("gpu_timestamps", perfetto::StaticString{CategoryNames[static_cast<u8>(category)]}, track, static_cast<u64>(startNs + *clockOffsetNs), "execution", executionNumber);
+            TRACE_EVENT_END("gpu_timestamps", track, static_cast<u64>(endNs + *clockOffsetNs));
+        }
+    }
+
+    void TimestampProfiler::Submit(std::unique_ptr<Batch> batch, const IntrusivePtr<FenceCycle> &cycle, u32 executionNumber) {
+        if (batch->regions.empty()) {
+            std::scoped_lock lock{mutex};
+            freeBatches.push_back(std::move(batch));
+            return;
+        }
+
+        // The batch is only reused after being resolved, which prevents its queries from being reset while the GPU could still write them
+        cycle->AttachCallback([this, batch = batch.release(), executionNumber] {
+            std::unique_ptr<Batch> owned{batch};
+            Resolve(*owned, executionNumber);
+
+            std::scoped_lock lock{mutex};
+            freeBatches.push_back(std::move(owned));
+        });
+    }
+}
@@ -0,0 +1,99 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2023 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#pragma once
+
+#include <common/trace.h>
+#include "fence_cycle.h"
+
+namespace skyline::gpu {
+    class GPU;
+
+    /**
+     * @brief The kind of GPU work a profiled region contains, every category is emitted on its own track
+     */
+    enum class TimestampCategory : u8 {
+        RenderPass,
+        Compute,
+        Blit,
+        Dma,
+        None, //!< The work isn't profiled
+    };
+
+    /**
+     * @brief Measures the GPU execution time of render passes and compute, blit and DMA commands with timestamp queries, these are resolved after the submission completes and emitted as slices on dedicated Perfetto tracks
+     * @note Profiling is only active while the "gpu_timestamps" trace category is enabled, GPU timestamps are correlated with the trace clock by anchoring the latest timestamp of a submission to the time at which its completion was observed, so slices may appear slightly later than they executed
+     */
+    class TimestampProfiler {
+      public:
+        static constexpr u32 MaxRegionCount{512}; //!< The maximum amount of regions profiled in a single submission, any further regions in it are ignored
+        static constexpr std::array<const char *, 4> CategoryNames{
+            "Render Pass",
+            "Compute",
+            "Blit",
+            "DMA",
+        };
+        static constexpr std::array<const char *, 4> TrackNames{
+            "GPU Render Passes",
+            "GPU Compute",
+            "GPU Blits",
+            "GPU DMA",
+        };
+
+        /**
+         * @brief The timestamp queries of a single submission, every region occupies two consecutive queries for its start and end
+         */
+        struct Batch {
+            vk::raii::QueryPool pool;
+            std::vector<TimestampCategory> regions;
+            bool regionOpen{}; //!< If the start of the last region has been written but not its end
+
+            Batch(GPU &gpu);
+        };
+
+      private:
+        GPU &gpu;
+        bool supported{}; //!< If the queue supports timestamps, profiling is disabled otherwise
+        double timestampPeriod{}; //!< The amount of nanoseconds per timestamp tick
+        u64 timestampMask{}; //!< A mask of the valid bits in a timestamp
+        std::mutex mutex; //!< Synchronizes access to the free batches, the clock offset and emitting slices
+        std::vector<std::unique_ptr<Batch>> freeBatches;
+        std::optional<i64> clockOffsetNs; //!< The offset from GPU time to the trace clock, this is the minimum of all observations as each one can only be later than the true offset
+
+        static perfetto::Track GetTrack(TimestampCategory category);
+
+        /**
+         * @brief Reads back the timestamps of a completed batch and emits slices for all of its regions
+         */
+        void Resolve(Batch &batch, u32 executionNumber);
+
+      public:
+        TimestampProfiler(GPU &gpu);
+
+        /**
+         * @return If GPU work should be profiled currently
+         */
+        bool IsEnabled() const;
+
+        /**
+         * @brief Acquires a batch for a submission and records a reset of its queries, this must be recorded outside of a render pass before any region
+         */
+        std::unique_ptr<Batch> AcquireBatch(vk::raii::CommandBuffer &commandBuffer);
+
+        /**
+         * @brief Writes the start timestamp of a region, this is a no-op if the batch is full
+         */
+        void BeginRegion(Batch &batch, vk::raii::CommandBuffer &commandBuffer, TimestampCategory category);
+
+        /**
+         * @brief Writes the end timestamp of the open region, this is a no-op if there's no open region
+         */
+        void EndRegion(Batch &batch, vk::raii::CommandBuffer &commandBuffer);
+
+        /**
+         * @brief Resolves the batch once the cycle of the submission it was recorded into has been signalled, after which it's reused
+         * @param executionNumber The execution number of the submission, this is attached to all slices for correlation with the GPFIFO
+         */
+        void Submit(std::unique_ptr<Batch> batch, const IntrusivePtr<FenceCycle> &cycle, u32 executionNumber);
+    };
+}
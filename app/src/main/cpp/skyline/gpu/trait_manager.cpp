@@ -6,7 +6,7 @@
 
 namespace skyline::gpu {
     TraitManager::TraitManager(const DeviceFeatures2 &deviceFeatures2, DeviceFeatures2 &enabledFeatures2, const std::vector<vk::ExtensionProperties> &deviceExtensions, std::vector<std::array<char, VK_MAX_EXTENSION_NAME_SIZE>> &enabledExtensions, const DeviceProperties2 &deviceProperties2, const vk::raii::PhysicalDevice &physicalDevice) : quirks(deviceProperties2.get<vk::PhysicalDeviceProperties2>().properties, deviceProperties2.get<vk::PhysicalDeviceDriverProperties>()) {
-        bool hasCustomBorderColorExt{}, hasShaderAtomicInt64Ext{}, hasShaderFloat16Int8Ext{}, hasShaderDemoteToHelperExt{}, hasVertexAttributeDivisorExt{}, hasProvokingVertexExt{}, hasPrimitiveTopologyListRestartExt{}, hasImagelessFramebuffersExt{}, hasTransformFeedbackExt{}, hasUint8IndicesExt{}, hasExtendedDynamicStateExt{}, hasRobustness2Ext{};
+        bool hasCustomBorderColorExt{}, hasShaderAtomicInt64Ext{}, hasShaderFloat16Int8Ext{}, hasShaderDemoteToHelperExt{}, hasVertexAttributeDivisorExt{}, hasProvokingVertexExt{}, hasPrimitiveTopologyListRestartExt{}, hasImagelessFramebuffersExt{}, hasTransformFeedbackExt{}, hasUint8IndicesExt{}, hasExtendedDynamicStateExt{}, hasExtendedDynamicState2Ext{}, hasRobustness2Ext{}, hasPipelineLibraryExt{}, hasGraphicsPipelineLibraryExt{}, hasTimelineSemaphoreExt{}, hasConditionalRenderingExt{}, hasDescriptorIndexingExt{}, hasDynamicRenderingExt{};
         bool supportsUniformBufferStandardLayout{}; // We require VK_KHR_uniform_buffer_standard_layout but assume it is implicitly supported even when not present
 
         for (auto &extension : deviceExtensions) {
@@ -58,7 +58,17 @@ namespace skyline::gpu {
                 EXT_SET("VK_EXT_primitive_topology_list_restart", hasPrimitiveTopologyListRestartExt);
                 EXT_SET("VK_EXT_transform_feedback", hasTransformFeedbackExt);
                 EXT_SET("VK_EXT_extended_dynamic_state", hasExtendedDynamicStateExt);
+                EXT_SET("VK_EXT_extended_dynamic_state2", hasExtendedDynamicState2Ext);
                 EXT_SET("VK_EXT_robustness2", hasRobustness2Ext);
+                EXT_SET("VK_KHR_pipeline_library", hasPipelineLibraryExt);
+                EXT_SET("VK_EXT_graphics_pipeline_library", hasGraphicsPipelineLibraryExt);
+                EXT_SET("VK_KHR_timeline_semaphore", hasTimelineSemaphoreExt);
+                EXT_SET("VK_EXT_conditional_rendering", hasConditionalRenderingExt);
+                case util::Hash("VK_EXT_descriptor_indexing"):
+                    if (extensionName == "VK_EXT_descriptor_indexing")
+                        hasDescriptorIndexingExt = true; // This is only detected and not enabled as nothing uses it yet
+                    break;
+                EXT_SET("VK_KHR_dynamic_rendering", hasDynamicRenderingExt);
             }
 
             #undef EXT_SET
@@ -76,6 +86,11 @@ namespace skyline::gpu {
         FEAT_SET(vk::PhysicalDeviceFeatures2, features.samplerAnisotropy, supportsAnisotropicFiltering)
         FEAT_SET(vk::PhysicalDeviceFeatures2, features.logicOp, supportsLogicOp)
         FEAT_SET(vk::PhysicalDeviceFeatures2, features.multiViewport, supportsMultipleViewports)
+        FEAT_SET(vk::PhysicalDeviceFeatures2, features.multiDrawIndirect, supportsMultiDrawIndirect)
+        FEAT_SET(vk::PhysicalDeviceFeatures2, features.drawIndirectFirstInstance, supportsDrawIndirectFirstInstance)
+        FEAT_SET(vk::PhysicalDeviceFeatures2, features.occlusionQueryPrecise, supportsOcclusionQueryPrecise)
+        FEAT_SET(vk::PhysicalDeviceFeatures2, features.pipelineStatisticsQuery, supportsPipelineStatisticsQuery)
+        FEAT_SET(vk::PhysicalDeviceFeatures2, features.inheritedQueries, supportsInheritedQueries)
         FEAT_SET(vk::PhysicalDeviceFeatures2, features.shaderInt16, supportsInt16)
         FEAT_SET(vk::PhysicalDeviceFeatures2, features.shaderInt64, supportsInt64)
         FEAT_SET(vk::PhysicalDeviceFeatures2, features.shaderStorageImageReadWithoutFormat, supportsImageReadWithoutFormat)
@@ -91,6 +106,12 @@ namespace skyline::gpu {
         else
             enabledFeatures2.unlink<vk::PhysicalDeviceExtendedDynamicStateFeaturesEXT>();
 
+        // The second revision of extended dynamic state is only used alongside the first as all dynamic pipeline state is derived from it
+        if (hasExtendedDynamicState2Ext && supportsExtendedDynamicState)
+            FEAT_SET(vk::PhysicalDeviceExtendedDynamicState2FeaturesEXT, extendedDynamicState2, supportsExtendedDynamicState2)
+        else
+            enabledFeatures2.unlink<vk::PhysicalDeviceExtendedDynamicState2FeaturesEXT>();
+
         if (hasRobustness2Ext) {
             FEAT_SET(vk::PhysicalDeviceRobustness2FeaturesEXT, nullDescriptor, supportsNullDescriptor)
             FEAT_SET(vk::PhysicalDeviceFeatures2, features.robustBufferAccess, std::ignore)
@@ -173,6 +194,41 @@ namespace skyline::gpu {
             enabledFeatures2.unlink<vk::PhysicalDeviceTransformFeedbackFeaturesEXT>();
         }
 
+        if (hasPipelineLibraryExt && hasGraphicsPipelineLibraryExt) {
+            bool hasGraphicsPipelineLibraryFeat{};
+            FEAT_SET(vk::PhysicalDeviceGraphicsPipelineLibraryFeaturesEXT, graphicsPipelineLibrary, hasGraphicsPipelineLibraryFeat)
+
+            // Libraries are only beneficial when linking them is significantly cheaper than compiling a full pipeline
+            auto graphicsPipelineLibraryProperties{deviceProperties2.get<vk::PhysicalDeviceGraphicsPipelineLibraryPropertiesEXT>()};
+            if (hasGraphicsPipelineLibraryFeat && graphicsPipelineLibraryProperties.graphicsPipelineLibraryFastLinking)
+                supportsGraphicsPipelineLibrary = true;
+        } else {
+            enabledFeatures2.unlink<vk::PhysicalDeviceGraphicsPipelineLibraryFeaturesEXT>();
+        }
+
+        if (hasTimelineSemaphoreExt)
+            FEAT_SET(vk::PhysicalDeviceTimelineSemaphoreFeatures, timelineSemaphore, supportsTimelineSemaphores)
+        else
+            enabledFeatures2.unlink<vk::PhysicalDeviceTimelineSemaphoreFeatures>();
+
+        if (hasConditionalRenderingExt)
+            FEAT_SET(vk::PhysicalDeviceConditionalRenderingFeaturesEXT, conditionalRendering, supportsConditionalRendering)
+        else
+            enabledFeatures2.unlink<vk::PhysicalDeviceConditionalRenderingFeaturesEXT>();
+
+        if (hasDynamicRenderingExt)
+            FEAT_SET(vk::PhysicalDeviceDynamicRenderingFeatures, dynamicRendering, supportsDynamicRendering)
+        else
+            enabledFeatures2.unlink<vk::PhysicalDeviceDynamicRenderingFeatures>();
+
+        // Descriptor indexing is only detected for a future bindless texture path, its features are left disabled as nothing requires them yet
+        auto &descriptorIndexingFeatures{deviceFeatures2.get<vk::PhysicalDeviceDescriptorIndexingFeatures>()};
+        if (hasDescriptorIndexingExt && descriptorIndexingFeatures.runtimeDescriptorArray && descriptorIndexingFeatures.shaderSampledImageArrayNonUniformIndexing && descriptorIndexingFeatures.descriptorBindingPartiallyBound && descriptorIndexingFeatures.descriptorBindingSampledImageUpdateAfterBind && descriptorIndexingFeatures.descriptorBindingUpdateUnusedWhilePending) {
+            supportsDescriptorIndexing = true;
+            maxDescriptorIndexingSampledImages = deviceProperties2.get<vk::PhysicalDeviceDescriptorIndexingProperties>().maxDescriptorSetUpdateAfterBindSampledImages;
+        }
+        enabledFeatures2.unlink<vk::PhysicalDeviceDescriptorIndexingFeatures>();
+
         FEAT_SET(vk::PhysicalDeviceFeatures2, features.geometryShader, supportsGeometryShaders)
         FEAT_SET(vk::PhysicalDeviceFeatures2, features.vertexPipelineStoresAndAtomics, supportsVertexPipelineStoresAndAtomics)
         FEAT_SET(vk::PhysicalDeviceFeatures2, features.fragmentStoresAndAtomics, supportsFragmentStoresAndAtomics)
@@ -204,12 +260,22 @@ namespace skyline::gpu {
         bcnSupport[4] = isFormatSupported(vk::Format::eBc5UnormBlock) && isFormatSupported(vk::Format::eBc5SnormBlock);
         bcnSupport[5] = isFormatSupported(vk::Format::eBc6HSfloatBlock) && isFormatSupported(vk::Format::eBc6HUfloatBlock);
         bcnSupport[6] = isFormatSupported(vk::Format::eBc7UnormBlock) && isFormatSupported(vk::Format::eBc7SrgbBlock);
+
+        // Uncompressed formats are commonly supported as vertex buffers without being sampleable, so unlike BCn formats they're only considered supported with optimal tiling sampling
+        auto isSampledFormatSupported{[&physicalDevice](vk::Format format) {
+            return static_cast<bool>(physicalDevice.getFormatProperties(format).optimalTilingFeatures & vk::FormatFeatureFlagBits::eSampledImage);
+        }};
+
+        colorFormatSupport[0] = isSampledFormatSupported(vk::Format::eB5G6R5UnormPack16);
+        colorFormatSupport[1] = isSampledFormatSupported(vk::Format::eB5G5R5A1UnormPack16);
+        colorFormatSupport[2] = isSampledFormatSupported(vk::Format::eR16G16B16Unorm) && isSampledFormatSupported(vk::Format::eR16G16B16Snorm) && isSampledFormatSupported(vk::Format::eR16G16B16Uint) && isSampledFormatSupported(vk::Format::eR16G16B16Sint) && isSampledFormatSupported(vk::Format::eR16G16B16Sfloat);
+        colorFormatSupport[3] = isSampledFormatSupported(vk::Format::eB10G11R11UfloatPack32);
     }
 
     std::string TraitManager::Summary() {
         return fmt::format(
-            "\n* Supports U8 Indices: {}\n* Supports Sampler Mirror Clamp To Edge: {}\n* Supports Sampler Reduction Mode: {}\n* Supports Custom Border Color (Without Format): {}\n* Supports Anisotropic Filtering: {}\n* Supports Last Provoking Vertex: {}\n* Supports Logical Operations: {}\n* Supports Vertex Attribute Divisor: {}\n* Supports Vertex Attribute Zero Divisor: {}\n* Supports Push Descriptors: {}\n* Supports Imageless Framebuffers: {}\n* Supports Global Priority: {}\n* Supports Multiple Viewports: {}\n* Supports Shader Viewport Index: {}\n* Supports SPIR-V 1.4: {}\n* Supports Shader Invocation Demotion: {}\n* Supports 16-bit FP: {}\n* Supports 8-bit Integers: {}\n* Supports 16-bit Integers: {}\n* Supports 64-bit Integers: {}\n* Supports Atomic 64-bit Integers: {}\n* Supports Floating Point Behavior Control: {}\n* Supports Image Read Without Format: {}\n* Supports List Primitive Topology Restart: {}\n* Supports Patch List Primitive Topology Restart: {}\n* Supports Transform Feedback: {}\n* Supports Geometry Shaders: {}\n*  Supports Vertex Pipeline Stores and Atomics: {}\n* Supports Fragment Stores and Atomics: {}\n* Supports Shader Storage Image Write Without Format: {}\n*Supports Subgroup Vote: {}\n* Subgroup Size: {}\n* BCn Support: {}",
-            supportsUint8Indices, supportsSamplerMirrorClampToEdge, supportsSamplerReductionMode, supportsCustomBorderColor, supportsAnisotropicFiltering, supportsLastProvokingVertex, supportsLogicOp, supportsVertexAttributeDivisor, supportsVertexAttributeZeroDivisor, supportsPushDescriptors, supportsImagelessFramebuffers, supportsGlobalPriority, supportsMultipleViewports, supportsShaderViewportIndexLayer, supportsSpirv14, supportsShaderDemoteToHelper, supportsFloat16, supportsInt8, supportsInt16, supportsInt64, supportsAtomicInt64, supportsFloatControls, supportsImageReadWithoutFormat, supportsTopologyListRestart, supportsTopologyPatchListRestart, supportsTransformFeedback, supportsGeometryShaders, supportsVertexPipelineStoresAndAtomics, supportsFragmentStoresAndAtomics, supportsShaderStorageImageWriteWithoutFormat, supportsSubgroupVote, subgroupSize, bcnSupport.to_string()
+            "\n* Supports U8 Indices: {}\n* Supports Sampler Mirror Clamp To Edge: {}\n* Supports Sampler Reduction Mode: {}\n* Supports Custom Border Color (Without Format): {}\n* Supports Anisotropic Filtering: {}\n* Supports Last Provoking Vertex: {}\n* Supports Logical Operations: {}\n* Supports Vertex Attribute Divisor: {}\n* Supports Vertex Attribute Zero Divisor: {}\n* Supports Push Descriptors: {}\n* Supports Imageless Framebuffers: {}\n* Supports Global Priority: {}\n* Supports Multiple Viewports: {}\n* Supports Multi-Draw Indirect: {}\n* Supports Draw Indirect First Instance: {}\n* Supports Precise Occlusion Queries: {}\n* Supports Pipeline Statistics Queries: {}\n* Supports Inherited Queries: {}\n* Supports Shader Viewport Index: {}\n* Supports SPIR-V 1.4: {}\n* Supports Shader Invocation Demotion: {}\n* Supports 16-bit FP: {}\n* Supports 8-bit Integers: {}\n* Supports 16-bit Integers: {}\n* Supports 64-bit Integers: {}\n* Supports Atomic 64-bit Integers: {}\n* Supports Floating Point Behavior Control: {}\n* Supports Image Read Without Format: {}\n* Supports List Primitive Topology Restart: {}\n* Supports Patch List Primitive Topology Restart: {}\n* Supports Transform Feedback: {}\n* Supports Geometry Shaders: {}\n*  Supports Vertex Pipeline Stores and Atomics: {}\n* Supports Fragment Stores and Atomics: {}\n* Supports Shader Storage Image Write Without Format: {}\n*Supports Subgroup Vote: {}\n* Supports Graphics Pipeline Library: {}\n* Supports Timeline Semaphores: {}\n* Supports Conditional Rendering: {}\n* Supports Descriptor Indexing: {} (Max Sampled Images: {})\n* Supports Dynamic Rendering: {}\n* Subgroup Size: {}\n* BCn Support: {}\n* Color Format Support: {}",
+            supportsUint8Indices, supportsSamplerMirrorClampToEdge, supportsSamplerReductionMode, supportsCustomBorderColor, supportsAnisotropicFiltering, supportsLastProvokingVertex, supportsLogicOp, supportsVertexAttributeDivisor, supportsVertexAttributeZeroDivisor, supportsPushDescriptors, supportsImagelessFramebuffers, supportsGlobalPriority, supportsMultipleViewports, supportsMultiDrawIndirect, supportsDrawIndirectFirstInstance, supportsOcclusionQueryPrecise, supportsPipelineStatisticsQuery, supportsInheritedQueries, supportsShaderViewportIndexLayer, supportsSpirv14, supportsShaderDemoteToHelper, supportsFloat16, supportsInt8, supportsInt16, supportsInt64, supportsAtomicInt64, supportsFloatControls, supportsImageReadWithoutFormat, supportsTopologyListRestart, supportsTopologyPatchListRestart, supportsTransformFeedback, supportsGeometryShaders, supportsVertexPipelineStoresAndAtomics, supportsFragmentStoresAndAtomics, supportsShaderStorageImageWriteWithoutFormat, supportsSubgroupVote, supportsGraphicsPipelineLibrary, supportsTimelineSemaphores, supportsConditionalRendering, supportsDescriptorIndexing, maxDescriptorIndexingSampledImages, supportsDynamicRendering, subgroupSize, bcnSupport.to_string(), colorFormatSupport.to_string()
         );
     }
 
@@ -25,6 +25,12 @@ namespace skyline::gpu {
         bool supportsImagelessFramebuffers{}; //!< If the device supports imageless framebuffers (with VK_KHR_imageless_framebuffer)
         bool supportsGlobalPriority{}; //!< If the device supports global priorities for queues (with VK_EXT_global_priority)
         bool supportsMultipleViewports{}; //!< If the device supports more than one viewport
+        bool supportsMultiDrawIndirect{}; //!< If the device supports more than a single draw in an indirect draw command
+        bool supportsDrawIndirectFirstInstance{}; //!< If the device supports a non-zero first instance in indirect draw commands
+        bool supportsOcclusionQueryPrecise{}; //!< If the device supports occlusion queries returning the exact amount of samples passed
+        bool supportsPipelineStatisticsQuery{}; //!< If the device supports pipeline statistics queries
+        bool supportsInheritedQueries{}; //!< If queries can be active while executing secondary command buffers
+        bool supportsConditionalRendering{}; //!< If draws can be predicated on a value in a buffer (with VK_EXT_conditional_rendering)
         bool supportsShaderViewportIndexLayer{}; //!< If the device supports retrieving the viewport index in shaders (with VK_EXT_shader_viewport_index_layer)
         bool supportsSpirv14{}; //!< If SPIR-V 1.4 is supported (with VK_KHR_spirv_1_4)
         bool supportsShaderDemoteToHelper{}; //!< If a shader invocation can be demoted to a helper invocation (with VK_EXT_shader_demote_to_helper_invocation)
@@ -47,10 +53,17 @@ namespace skyline::gpu {
         bool supportsWideLines{}; //!< If the device supports the 'wideLines' Vulkan feature
         bool supportsDepthClamp{}; //!< If the device supports the 'depthClamp' Vulkan feature
         bool supportsExtendedDynamicState{}; //!< If the device supports the 'VK_EXT_extended_dynamic_state' Vulkan extension
+        bool supportsExtendedDynamicState2{}; //!< If the device supports the 'VK_EXT_extended_dynamic_state2' Vulkan extension
         bool supportsNullDescriptor{}; //!< If the device supports the null descriptor feature in the 'VK_EXT_robustness2' Vulkan extension
+        bool supportsGraphicsPipelineLibrary{}; //!< If the device supports building graphics pipelines from separately compiled libraries which can be linked quickly (with VK_EXT_graphics_pipeline_library)
+        bool supportsTimelineSemaphores{}; //!< If the device supports semaphores with a monotonically increasing counter value (with VK_KHR_timeline_semaphore)
+        bool supportsDescriptorIndexing{}; //!< If the device supports partially bound, update-after-bind and non-uniformly indexed runtime arrays of sampled images (with VK_EXT_descriptor_indexing), this is only detected and neither the extension nor its features are enabled
+        bool supportsDynamicRendering{}; //!< If the device supports rendering without render pass and framebuffer objects (with VK_KHR_dynamic_rendering), render passes are begun with vkCmdBeginRenderingKHR and pipelines are only created against their attachment formats when this is used
+        u32 maxDescriptorIndexingSampledImages{}; //!< The maximum amount of sampled images that can be in an update-after-bind descriptor set, this is zero when descriptor indexing is unsupported
         u32 subgroupSize{}; //!< Size of a subgroup on the host GPU
 
         std::bitset<7> bcnSupport{}; //!< Bitmask of BCn texture formats supported, it is ordered as BC1, BC2, BC3, BC4, BC5, BC6H and BC7
+        std::bitset<4> colorFormatSupport{}; //!< Bitmask of optional uncompressed guest formats that can be sampled, it is ordered as B5G6R5, B5G5R5A1, R16G16B16 and B10G11R11, unsupported formats are converted into another format on the GPU
 
         /**
          * @brief Manages a list of any vendor/device-specific errata in the host GPU
@@ -86,7 +99,9 @@ namespace skyline::gpu {
             vk::PhysicalDeviceDriverProperties,
             vk::PhysicalDeviceFloatControlsProperties,
             vk::PhysicalDeviceTransformFeedbackPropertiesEXT,
-            vk::PhysicalDeviceSubgroupProperties>;
+            vk::PhysicalDeviceSubgroupProperties,
+            vk::PhysicalDeviceGraphicsPipelineLibraryPropertiesEXT,
+            vk::PhysicalDeviceDescriptorIndexingProperties>;
 
         using DeviceFeatures2 = vk::StructureChain<
             vk::PhysicalDeviceFeatures2,
@@ -103,7 +118,13 @@ namespace skyline::gpu {
             vk::PhysicalDeviceTransformFeedbackFeaturesEXT,
             vk::PhysicalDeviceIndexTypeUint8FeaturesEXT,
             vk::PhysicalDeviceExtendedDynamicStateFeaturesEXT,
-            vk::PhysicalDeviceRobustness2FeaturesEXT>;
+            vk::PhysicalDeviceExtendedDynamicState2FeaturesEXT,
+            vk::PhysicalDeviceRobustness2FeaturesEXT,
+            vk::PhysicalDeviceGraphicsPipelineLibraryFeaturesEXT,
+            vk::PhysicalDeviceTimelineSemaphoreFeatures,
+            vk::PhysicalDeviceConditionalRenderingFeaturesEXT,
+            vk::PhysicalDeviceDescriptorIndexingFeatures,
+            vk::PhysicalDeviceDynamicRenderingFeatures>;
 
         TraitManager(const DeviceFeatures2 &deviceFeatures2, DeviceFeatures2 &enabledFeatures2, const std::vector<vk::ExtensionProperties> &deviceExtensions, std::vector<std::array<char, VK_MAX_EXTENSION_NAME_SIZE>> &enabledExtensions, const DeviceProperties2 &deviceProperties2, const vk::raii::PhysicalDevice& physicalDevice);
 
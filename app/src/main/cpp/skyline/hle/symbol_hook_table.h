@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include <cstring>
 #include "symbol_hooks.h"
 
 namespace skyline::hle {
@@ -13,5 +14,14 @@ namespace skyline::hle {
         HookTableEntry(std::string_view name, HookType hook) : name{name}, hook{std::move(hook)} {}
     };
 
-    static std::array<HookTableEntry, 0> HookedSymbols{};
+    /**
+     * @note The guest libc functions are replaced with their host counterparts as those are tuned for the host CPU, they don't touch TLS and any faults in them on trapped guest memory are handled the same as if they were in guest code
+     * @note nn::os synchronization primitives aren't replaced as their layout is private to each SDK version and their uncontended paths are already atomics that run natively
+     */
+    static std::array<HookTableEntry, 4> HookedSymbols{
+        HookTableEntry{"memcpy", DirectHook{static_cast<void *(*)(void *, const void *, size_t)>(&memcpy)}},
+        HookTableEntry{"memmove", DirectHook{static_cast<void *(*)(void *, const void *, size_t)>(&memmove)}},
+        HookTableEntry{"memset", DirectHook{static_cast<void *(*)(void *, int, size_t)>(&memset)}},
+        HookTableEntry{"strlen", DirectHook{static_cast<size_t (*)(const char *)>(&strlen)}},
+    };
 }
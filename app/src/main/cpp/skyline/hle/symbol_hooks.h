@@ -17,7 +17,18 @@ namespace skyline::hle {
         HookFunction exit; //!< The hook to be called when the function is exited
     };
 
-    using HookType = std::variant<OverrideHook, EntryExitHook>;
+    /**
+     * @brief A host function that is branched to directly in place of the hooked function, skipping the context switch to the host entirely
+     * @note The function must use the same calling convention as the hooked function and run correctly on a guest thread context, it cannot access host TLS or block
+     */
+    struct DirectHook {
+        u64 function; //!< The address of the host function
+
+        template<typename Function>
+        DirectHook(Function *function) : function{reinterpret_cast<u64>(function)} {}
+    };
+
+    using HookType = std::variant<OverrideHook, EntryExitHook, DirectHook>;
 
     struct HookedSymbol {
         std::string name; //!< The name of the symbol
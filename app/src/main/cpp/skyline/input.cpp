@@ -13,8 +13,17 @@ namespace skyline::input {
           hid{reinterpret_cast<HidSharedMemory *>(kHid->host.data())},
           npad{state, hid},
           touch{state, hid},
+          motion{npad},
           updateThread{&Input::UpdateThread, this} {}
 
+    void Input::RequestUpdate() {
+        {
+            std::scoped_lock lock{updateMutex};
+            updatePending = true;
+        }
+        updateCondition.notify_one();
+    }
+
     void Input::UpdateThread() {
         if (int result{pthread_setname_np(pthread_self(), "Sky-Input")})
             Logger::Warn("Failed to set the thread name: {}", strerror(result));
@@ -22,43 +31,20 @@ namespace skyline::input {
         try {
             signal::SetSignalHandler({SIGINT, SIGILL, SIGTRAP, SIGBUS, SIGFPE, SIGSEGV}, signal::ExceptionalSignalHandler);
 
-            struct UpdateCallback {
-                std::chrono::milliseconds period;
-                std::chrono::steady_clock::time_point next;
-                std::function<void(UpdateCallback &)> callback;
-
-                UpdateCallback(std::chrono::milliseconds period, std::function<void(UpdateCallback &)> callback)
-                    : period{period}, next{std::chrono::steady_clock::now() + period}, callback{std::move(callback)} {}
-
-                void operator()() {
-                    callback(*this);
-                    next += period;
-                }
-            };
-
-            constexpr std::chrono::milliseconds NPadUpdatePeriod{4}; //!< The period at which a Joy-Con is updated (250Hz)
-            constexpr std::chrono::milliseconds TouchUpdatePeriod{4}; //!< The period at which the touch screen is updated (250Hz)
-
-            std::array<UpdateCallback, 2> updateCallbacks{
-                UpdateCallback{NPadUpdatePeriod, [&](UpdateCallback &callback) {
-                    for (auto &pad : npad.npads)
-                        pad.UpdateSharedMemory();
-                }},
-                UpdateCallback{TouchUpdatePeriod, [&](UpdateCallback &callback) {
-                    touch.UpdateSharedMemory();
-                }},
-            };
+            // The shared memory is still updated periodically when idle as the guest expects the sampling numbers of every entry to keep advancing
+            constexpr std::chrono::milliseconds KeepAlivePeriod{16};
 
+            std::unique_lock lock{updateMutex};
             while (true) {
-                auto now{std::chrono::steady_clock::now()}, next{updateCallbacks[0].next};
-                for (auto &callback : updateCallbacks) {
-                    if (now >= callback.next)
-                        callback();
+                updateCondition.wait_for(lock, KeepAlivePeriod, [this] { return updatePending; });
+                updatePending = false;
+                lock.unlock();
+
+                for (auto &pad : npad.npads)
+                    pad.UpdateSharedMemory();
+                touch.UpdateSharedMemory();
 
-                    if (callback.next < next)
-                        next = callback.next;
-                }
-                std::this_thread::sleep_until(next);
+                lock.lock();
             }
         } catch (const signal::SignalException &e) {
             Logger::Error("{}\nStack Trace:{}", e.what(), state.loader->GetStackTrace(e.frames));
@@ -8,6 +8,7 @@
 #include "input/shared_mem.h"
 #include "input/npad.h"
 #include "input/touch.h"
+#include "input/motion.h"
 
 namespace skyline::input {
     /**
@@ -23,11 +24,21 @@ namespace skyline::input {
 
         NpadManager npad;
         TouchManager touch;
+        MotionSensor motion;
 
         Input(const DeviceState &state);
 
+        /**
+         * @brief Wakes the update thread to write the current input state into HID shared memory, this should be called after any host input changes
+         * @note Multiple requests made before the update thread wakes up are coalesced into a single update
+         */
+        void RequestUpdate();
+
       private:
-        std::thread updateThread; //!< A thread that handles delivering HID shared memory updates at a fixed rate
+        std::mutex updateMutex; //!< Synchronizes accesses to updatePending
+        std::condition_variable updateCondition; //!< Signalled when an update is requested
+        bool updatePending{}; //!< If the input state has changed since the last update
+        std::thread updateThread; //!< A thread that delivers HID shared memory updates as soon as input changes and at a low rate otherwise
 
         /**
          * @brief The entry point for the update thread, this handles timing and delegation to the shared memory managers
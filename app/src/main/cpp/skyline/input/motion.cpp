@@ -0,0 +1,158 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2023 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#include <numbers>
+#include "motion.h"
+
+namespace skyline::input {
+    MotionSensor::MotionSensor(NpadManager &npad) : npad{npad} {
+        sensorManager = ASensorManager_getInstanceForPackage(nullptr);
+        if (sensorManager) {
+            accelerometer = ASensorManager_getDefaultSensor(sensorManager, ASENSOR_TYPE_ACCELEROMETER);
+            gyroscope = ASensorManager_getDefaultSensor(sensorManager, ASENSOR_TYPE_GYROSCOPE);
+        }
+
+        if (!accelerometer || !gyroscope) {
+            Logger::Info("Motion controls are unavailable as the device lacks an accelerometer or gyroscope");
+            return;
+        }
+
+        std::promise<void> ready;
+        auto readyFuture{ready.get_future()};
+        sensorThread = std::thread{&MotionSensor::SensorThread, this, std::move(ready)};
+        readyFuture.wait();
+    }
+
+    MotionSensor::~MotionSensor() {
+        if (sensorThread.joinable()) {
+            running = false;
+            ALooper_wake(looper);
+            sensorThread.join();
+        }
+    }
+
+    void MotionSensor::Start() {
+        std::scoped_lock lock{activationMutex};
+        if (!eventQueue || activeCount++)
+            return;
+
+        for (auto sensor : {accelerometer, gyroscope})
+            if (ASensorEventQueue_registerSensor(eventQueue, sensor, std::max(SamplingPeriod, ASensor_getMinDelay(sensor)), 0))
+                Logger::Warn("Failed to enable the {} sensor", ASensor_getName(sensor));
+    }
+
+    void MotionSensor::Stop() {
+        std::scoped_lock lock{activationMutex};
+        if (!eventQueue || !activeCount || --activeCount)
+            return;
+
+        for (auto sensor : {accelerometer, gyroscope})
+            ASensorEventQueue_disableSensor(eventQueue, sensor);
+    }
+
+    void MotionSensor::SensorThread(std::promise<void> ready) {
+        if (int result{pthread_setname_np(pthread_self(), "Sky-Motion")})
+            Logger::Warn("Failed to set the thread name: {}", strerror(result));
+
+        looper = ALooper_prepare(0);
+        eventQueue = ASensorManager_createEventQueue(sensorManager, looper, EventQueueIdentifier, nullptr, nullptr);
+        ready.set_value();
+
+        std::array<ASensorEvent, 0x10> events;
+        while (running) {
+            if (ALooper_pollOnce(-1, nullptr, nullptr, nullptr) != EventQueueIdentifier)
+                continue;
+
+            // Shared memory is written while holding the manager's mutex as controllers may be reconnected with a different style at any time
+            std::scoped_lock lock{npad.mutex};
+            ssize_t count;
+            while ((count = ASensorEventQueue_getEvents(eventQueue, events.data(), events.size())) > 0)
+                for (const auto &event : span(events).first(static_cast<size_t>(count)))
+                    ProcessEvent(event);
+        }
+
+        std::scoped_lock lock{activationMutex};
+        ASensorManager_destroyEventQueue(sensorManager, eventQueue);
+        eventQueue = nullptr;
+    }
+
+    SixAxisVector MotionSensor::ToGuestAxes(const float *values, float scale) const {
+        auto [x, y, z]{std::array<float, 3>{values[0] * scale, values[1] * scale, values[2] * scale}};
+        switch (displayRotation.load(std::memory_order_relaxed)) {
+            case 1: // ROTATION_90
+                return {-y, x, z};
+            case 2: // ROTATION_180
+                return {-x, -y, z};
+            case 3: // ROTATION_270
+                return {y, -x, z};
+            default:
+                return {x, y, z};
+        }
+    }
+
+    void MotionSensor::IntegrateOrientation(const SixAxisVector &velocity, float interval) {
+        float magnitude{std::sqrt(velocity.x * velocity.x + velocity.y * velocity.y + velocity.z * velocity.z)};
+        float angle{magnitude * 2.0f * std::numbers::pi_v<float> * interval};
+        if (angle == 0.0f)
+            return;
+
+        // Every basis vector is rotated around the axis of the angular velocity with Rodrigues' rotation formula
+        SixAxisVector axis{velocity.x / magnitude, velocity.y / magnitude, velocity.z / magnitude};
+        float sin{std::sin(angle)}, cos{std::cos(angle)};
+        for (auto &basis : orientation) {
+            float dot{axis.x * basis.x + axis.y * basis.y + axis.z * basis.z};
+            SixAxisVector cross{axis.y * basis.z - axis.z * basis.y, axis.z * basis.x - axis.x * basis.z, axis.x * basis.y - axis.y * basis.x};
+            basis = {
+                basis.x * cos + cross.x * sin + axis.x * dot * (1.0f - cos),
+                basis.y * cos + cross.y * sin + axis.y * dot * (1.0f - cos),
+                basis.z * cos + cross.z * sin + axis.z * dot * (1.0f - cos),
+            };
+        }
+
+        // The basis is reorthonormalized with Gram-Schmidt to prevent floating-point error from accumulating over time
+        auto normalize{[](SixAxisVector &vector) {
+            float length{std::sqrt(vector.x * vector.x + vector.y * vector.y + vector.z * vector.z)};
+            vector = {vector.x / length, vector.y / length, vector.z / length};
+        }};
+        auto &[xBasis, yBasis, zBasis]{orientation};
+        normalize(xBasis);
+        float projection{xBasis.x * yBasis.x + xBasis.y * yBasis.y + xBasis.z * yBasis.z};
+        yBasis = {yBasis.x - xBasis.x * projection, yBasis.y - xBasis.y * projection, yBasis.z - xBasis.z * projection};
+        normalize(yBasis);
+        zBasis = {xBasis.y * yBasis.z - xBasis.z * yBasis.y, xBasis.z * yBasis.x - xBasis.x * yBasis.z, xBasis.x * yBasis.y - xBasis.y * yBasis.x};
+    }
+
+    void MotionSensor::ProcessEvent(const ASensorEvent &event) {
+        switch (event.type) {
+            case ASENSOR_TYPE_ACCELEROMETER:
+                // Android reports the force opposing gravity in m/s² while the guest expects the acceleration in G
+                acceleration = ToGuestAxes(event.data, -1.0f / ASENSOR_STANDARD_GRAVITY);
+                break;
+
+            case ASENSOR_TYPE_GYROSCOPE: {
+                constexpr i64 MaxSampleInterval{100'000'000}; //!< The maximum interval between samples that's integrated, any longer gap is from the sensors being disabled
+                auto velocity{ToGuestAxes(event.data, 1.0f / (2.0f * std::numbers::pi_v<float>))};
+
+                i64 elapsed{event.timestamp - lastGyroscopeTimestamp};
+                float interval{lastGyroscopeTimestamp && elapsed > 0 && elapsed < MaxSampleInterval ? static_cast<float>(elapsed) / 1'000'000'000.0f : 0.0f};
+                lastGyroscopeTimestamp = event.timestamp;
+
+                rotation = {rotation.x + velocity.x * interval, rotation.y + velocity.y * interval, rotation.z + velocity.z * interval};
+                IntegrateOrientation(velocity, interval);
+
+                NpadSixAxisState state{
+                    .accelerometer = acceleration,
+                    .gyroscope = velocity,
+                    .rotation = rotation,
+                    .orientation = orientation,
+                };
+                for (auto &device : npad.npads)
+                    device.WriteSixAxisEntry(state);
+                break;
+            }
+
+            default:
+                break;
+        }
+    }
+}
@@ -0,0 +1,75 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2023 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#pragma once
+
+#include <future>
+#include <android/sensor.h>
+#include <android/looper.h>
+#include "npad.h"
+
+namespace skyline::input {
+    /**
+     * @brief The MotionSensor class streams the host accelerometer and gyroscope into the six-axis entries of all connected controllers
+     * @note Sensor events are read from a native event queue on a dedicated looper thread and written directly into HID shared memory, they never go through Java
+     */
+    class MotionSensor {
+      private:
+        static constexpr int EventQueueIdentifier{1}; //!< The identifier ALooper_pollOnce returns when the event queue has events
+        static constexpr i32 SamplingPeriod{5000}; //!< The period sensors are sampled at in microseconds, this is the 200Hz rate of the IMU in Joy-Cons unless the host sensor is slower
+
+        NpadManager &npad;
+        ASensorManager *sensorManager{};
+        const ASensor *accelerometer{};
+        const ASensor *gyroscope{};
+        ALooper *looper{};
+        ASensorEventQueue *eventQueue{};
+        std::atomic<bool> running{true};
+        std::thread sensorThread;
+
+        std::mutex activationMutex; //!< Synchronizes enabling and disabling the sensors
+        size_t activeCount{}; //!< The amount of six-axis sensors started by the guest, the host sensors are only enabled while this is non-zero
+
+        std::atomic<i32> displayRotation{}; //!< The rotation of the display as a Surface.ROTATION_* constant, this determines how host axes map onto the screen
+
+        /* All state below is only accessed by the sensor thread */
+        SixAxisVector acceleration{0.0f, 0.0f, -1.0f}; //!< The latest accelerometer sample in G
+        SixAxisVector rotation{}; //!< The accumulated rotation around every axis in revolutions
+        std::array<SixAxisVector, 3> orientation{{{1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}, {0.0f, 0.0f, 1.0f}}}; //!< The basis of the orientation integrated from the gyroscope
+        i64 lastGyroscopeTimestamp{}; //!< The timestamp of the previous gyroscope sample in nanoseconds
+
+        void SensorThread(std::promise<void> ready);
+
+        /**
+         * @brief Converts a host sensor vector into the guest's coordinate space relative to the screen (X right, Y up, Z out of the screen)
+         */
+        SixAxisVector ToGuestAxes(const float *values, float scale) const;
+
+        /**
+         * @brief Rotates the orientation basis by the supplied angular velocity over a period of time
+         * @param velocity The angular velocity in revolutions per second
+         */
+        void IntegrateOrientation(const SixAxisVector &velocity, float interval);
+
+        void ProcessEvent(const ASensorEvent &event);
+
+      public:
+        MotionSensor(NpadManager &npad);
+
+        ~MotionSensor();
+
+        /**
+         * @brief Enables the host sensors if this is the first active guest sensor
+         */
+        void Start();
+
+        /**
+         * @brief Disables the host sensors if this was the last active guest sensor
+         */
+        void Stop();
+
+        void SetDisplayRotation(i32 rotation) {
+            displayRotation.store(rotation, std::memory_order_relaxed);
+        }
+    };
+}
@@ -74,6 +74,27 @@ namespace skyline::input {
         }
     }
 
+    void NpadManager::ApplyInputEvents(span<const NpadInputEvent> events) {
+        std::scoped_lock lock{mutex};
+        for (const auto &event : events) {
+            if (event.index < 0 || static_cast<size_t>(event.index) >= controllers.size())
+                continue;
+
+            auto device{controllers[static_cast<size_t>(event.index)].device};
+            if (!device)
+                continue;
+
+            switch (event.type) {
+                case NpadInputEvent::Type::Button:
+                    device->SetButtonState(NpadButton{.raw = static_cast<u64>(event.id)}, event.value != 0);
+                    break;
+                case NpadInputEvent::Type::Axis:
+                    device->SetAxisValue(static_cast<NpadAxisId>(event.id), static_cast<i32>(event.value));
+                    break;
+            }
+        }
+    }
+
     void NpadManager::Activate() {
         std::scoped_lock guard{mutex};
         if (!activated) {
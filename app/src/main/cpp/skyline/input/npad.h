@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include <jni.h>
 #include <range/v3/algorithm.hpp>
 #include "npad_device.h"
 
@@ -16,6 +17,20 @@ namespace skyline::input {
         NpadDevice *device{nullptr}; //!< A pointer to the NpadDevice that all events from this are redirected to
     };
 
+    /**
+     * @brief A single button or axis change on a host controller, these are batched on the Kotlin side to be applied together
+     * @note All members are jlong as it's treated as a jlong array in Kotlin
+     */
+    struct NpadInputEvent {
+        enum class Type : jlong {
+            Button = 0, //!< The id is a mask of buttons and the value is if they're pressed
+            Axis = 1, //!< The id is an NpadAxisId and the value is the value of the axis
+        } type;
+        jlong index; //!< The index of the GuestController the event is directed at
+        jlong id;
+        jlong value;
+    };
+
     /**
      * @brief All NPad devices and their allocations to Player objects are managed by this class
      */
@@ -107,6 +122,12 @@ namespace skyline::input {
          */
         void Update();
 
+        /**
+         * @brief Applies a batch of host input events to the devices their controllers are mapped to while holding the mutex once for the entire batch
+         * @note Events directed at unmapped or invalid controllers are ignored
+         */
+        void ApplyInputEvents(span<const NpadInputEvent> events);
+
         /**
          * @brief Activates the mapping between guest controllers -> players, a call to this is required for function
          */
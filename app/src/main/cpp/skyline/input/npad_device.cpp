@@ -252,6 +252,47 @@ namespace skyline::input {
         globalTimestamp++;
     }
 
+    void NpadDevice::WriteSixAxisEntry(NpadSixAxisState state) {
+        if (!connectionState.connected)
+            return;
+
+        auto writeEntry{[&](NpadSixAxisInfo &info) {
+            auto &lastEntry{info.state.at(info.header.currentEntry)};
+
+            info.header.timestamp = util::GetTimeTicks();
+            info.header.entryCount = std::min(static_cast<u8>(info.header.entryCount + 1), constant::HidEntryCount);
+            info.header.maxEntry = info.header.entryCount - 1;
+            info.header.currentEntry = (info.header.currentEntry < info.header.maxEntry) ? info.header.currentEntry + 1 : 0;
+
+            auto &nextEntry{info.state.at(info.header.currentEntry)};
+            nextEntry = state;
+            nextEntry.globalTimestamp = lastEntry.globalTimestamp + 1;
+            nextEntry.localTimestamp = lastEntry.localTimestamp + 1;
+            nextEntry._unk2_ = 1;
+        }};
+
+        switch (type) {
+            case NpadControllerType::ProController:
+                writeEntry(section.fullKeySixAxis);
+                break;
+            case NpadControllerType::Handheld:
+                writeEntry(section.handheldSixAxis);
+                break;
+            case NpadControllerType::JoyconDual:
+                writeEntry(section.dualLeftSixAxis);
+                writeEntry(section.dualRightSixAxis);
+                break;
+            case NpadControllerType::JoyconLeft:
+                writeEntry(section.leftSixAxis);
+                break;
+            case NpadControllerType::JoyconRight:
+                writeEntry(section.rightSixAxis);
+                break;
+            default:
+                break;
+        }
+    }
+
     void NpadDevice::SetButtonState(NpadButton mask, bool pressed) {
         if (pressed)
             controllerState.buttons.raw |= mask.raw;
@@ -401,18 +442,18 @@ namespace skyline::input {
     };
 
     template<size_t Size>
-    void VibrateDevice(const std::shared_ptr<JvmManager> &jvm, i8 deviceIndex, std::array<VibrationInfo, Size> vibrations) {
+    NpadHostVibration GetHostVibration(i8 deviceIndex, std::array<VibrationInfo, Size> vibrations) {
+        NpadHostVibration hostVibration{.deviceIndex = deviceIndex};
+
         jint totalAmplitude{};
         for (const auto &vibration : vibrations)
             totalAmplitude += vibration.amplitude;
-        if (totalAmplitude == 0) {
-            jvm->ClearVibrationDevice(deviceIndex); // If a null vibration was submitted then we just clear vibrations on the device
-            return;
-        }
+        if (totalAmplitude == 0)
+            return hostVibration; // If a null vibration was submitted then we just clear vibrations on the device
 
-        // We output an approximation of the combined + linearized vibration data into these arrays, larger arrays would allow for more accurate reproduction of data
-        std::array<jlong, 50> timings;
-        std::array<jint, 50> amplitudes;
+        // We output an approximation of the combined + linearized vibration data into these arrays
+        auto &timings{hostVibration.timings};
+        auto &amplitudes{hostVibration.amplitudes};
 
         // We are essentially unrolling the bands into a linear sequence, due to the data not being always linearizable there will be inaccuracies at the ends unless there's a pattern that's repeatable which will happen when all band's frequencies are factors of each other
         jint currentAmplitude{}; //!< The accumulated amplitude from adding up and subtracting the amplitude of individual bands
@@ -451,15 +492,28 @@ namespace skyline::input {
             amplitudes[index] = std::min(currentAmplitude, AmplitudeMax);
         }
 
-        jvm->VibrateDevice(deviceIndex, span(timings.begin(), timings.begin() + index), span(amplitudes.begin(), amplitudes.begin() + index));
+        hostVibration.stepCount = index;
+        return hostVibration;
     }
 
-    void VibrateDevice(const std::shared_ptr<JvmManager> &jvm, i8 index, const NpadVibrationValue &value) {
+    NpadHostVibration GetHostVibration(i8 index, const NpadVibrationValue &value) {
         std::array<VibrationInfo, 2> vibrations{
             VibrationInfo{value.frequencyLow, value.amplitudeLow * (AmplitudeMax / 2)},
             VibrationInfo{value.frequencyHigh, value.amplitudeHigh * (AmplitudeMax / 2)},
         };
-        VibrateDevice(jvm, index, vibrations);
+        return GetHostVibration(index, vibrations);
+    }
+
+    void NpadDevice::SendHostVibration(std::optional<NpadHostVibration> &lastVibration, const NpadHostVibration &vibration) {
+        if (lastVibration == vibration)
+            return;
+        lastVibration = vibration;
+
+        auto &jvm{manager.state.jvm};
+        if (vibration.stepCount)
+            jvm->VibrateDevice(vibration.deviceIndex, span(vibration.timings.data(), vibration.stepCount), span(vibration.amplitudes.data(), vibration.stepCount));
+        else
+            jvm->ClearVibrationDevice(vibration.deviceIndex);
     }
 
     void NpadDevice::Vibrate(const NpadVibrationValue &left, const NpadVibrationValue &right) {
@@ -476,10 +530,10 @@ namespace skyline::input {
                 VibrationInfo{right.frequencyLow, right.amplitudeLow * (AmplitudeMax / 4)},
                 VibrationInfo{right.frequencyHigh, right.amplitudeHigh * (AmplitudeMax / 4)},
             };
-            VibrateDevice(manager.state.jvm, index, vibrations);
+            SendHostVibration(hostVibration, GetHostVibration(index, vibrations));
         } else {
-            VibrateDevice(manager.state.jvm, index, left);
-            VibrateDevice(manager.state.jvm, partnerIndex, right);
+            SendHostVibration(hostVibration, GetHostVibration(index, left));
+            SendHostVibration(partnerHostVibration, GetHostVibration(partnerIndex, right));
         }
     }
 
@@ -497,6 +551,6 @@ namespace skyline::input {
         if (vibrationRight)
             Vibrate(vibrationLeft, *vibrationRight);
         else
-            VibrateDevice(manager.state.jvm, index, value);
+            SendHostVibration(hostVibration, GetHostVibration(index, value));
     }
 }
@@ -125,6 +125,23 @@ namespace skyline::input {
     };
     static_assert(sizeof(NpadVibrationValue) == 0x10);
 
+    /**
+     * @brief A waveform for a host vibrator in the form that's supplied to the Android Vibration APIs, a waveform without any steps clears vibration on the device
+     */
+    struct NpadHostVibration {
+        static constexpr size_t MaxSteps{50}; //!< Larger waveforms would allow for a more accurate reproduction of the vibration
+        i8 deviceIndex; //!< The index of the host device the waveform is for
+        size_t stepCount{};
+        std::array<i64, MaxSteps> timings; //!< The duration of each step in milliseconds
+        std::array<i32, MaxSteps> amplitudes;
+
+        bool operator==(const NpadHostVibration &other) const {
+            return deviceIndex == other.deviceIndex && stepCount == other.stepCount &&
+                std::equal(timings.begin(), timings.begin() + stepCount, other.timings.begin()) &&
+                std::equal(amplitudes.begin(), amplitudes.begin() + stepCount, other.amplitudes.begin());
+        }
+    };
+
     class NpadManager;
 
     /**
@@ -160,6 +177,14 @@ namespace skyline::input {
          */
         NpadControllerInfo &GetControllerInfo();
 
+        std::optional<NpadHostVibration> hostVibration, partnerHostVibration; //!< The waveforms that were last sent to the host for the device and its partner
+
+        /**
+         * @brief Sends a waveform to the host unless it's identical to the last one sent through the supplied slot
+         * @note Guests update vibration values every frame with minor variations that generally quantize to the same waveform, skipping these avoids a JNI call for each of them
+         */
+        void SendHostVibration(std::optional<NpadHostVibration> &lastVibration, const NpadHostVibration &vibration);
+
       public:
         NpadId id;
         static constexpr i8 NullIndex{-1}; //!< The placeholder index value when there is no device present
@@ -196,6 +221,12 @@ namespace skyline::input {
          */
         void UpdateSharedMemory();
 
+        /**
+         * @brief Writes a sample from the motion sensors into the six-axis entries of the controller's current style in HID shared memory
+         * @param state The sample to write, the timestamps are filled in by this
+         */
+        void WriteSixAxisEntry(NpadSixAxisState state);
+
         /**
          * @brief Changes the state of buttons to the specified state
          * @param mask A bit-field mask of all the buttons to change
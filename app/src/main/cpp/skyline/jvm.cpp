@@ -93,7 +93,7 @@ namespace skyline {
         env->CallVoidMethod(instance, initializeControllersId);
     }
 
-    void JvmManager::VibrateDevice(jint index, const span<jlong> &timings, const span<jint> &amplitudes) {
+    void JvmManager::VibrateDevice(jint index, span<const jlong> timings, span<const jint> amplitudes) {
         auto jTimings{env->NewLongArray(static_cast<jsize>(timings.size()))};
         env->SetLongArrayRegion(jTimings, 0, static_cast<jsize>(timings.size()), timings.data());
         auto jAmplitudes{env->NewIntArray(static_cast<jsize>(amplitudes.size()))};
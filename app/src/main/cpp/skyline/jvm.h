@@ -149,7 +149,7 @@ namespace skyline {
         /**
          * @brief A call to EmulationActivity.vibrateDevice in Kotlin
          */
-        void VibrateDevice(jint index, const span<jlong> &timings, const span<jint> &amplitudes);
+        void VibrateDevice(jint index, span<const jlong> timings, span<const jint> amplitudes);
 
         /**
          * @brief A call to EmulationActivity.clearVibrationDevice in Kotlin
@@ -119,6 +119,15 @@ namespace skyline::kernel::ipc {
             }
         }
 
+        // Buffers are validated once here so that services can read from and write to guest memory through them directly
+        auto validateBuffers{[&](const auto &buffers) {
+            for (const auto &buffer : buffers)
+                if (!state.process->memory.AddressSpaceContains(buffer))
+                    throw exception("IPC buffer isn't inside the guest address space: 0x{:X} - 0x{:X}", buffer.data(), buffer.end().base());
+        }};
+        validateBuffers(inputBuf);
+        validateBuffers(outputBuf);
+
         if (header->type == CommandType::Request || header->type == CommandType::RequestWithContext) {
             Logger::Verbose("Header: Input No: {}, Output No: {}, Raw Size: {}", inputBuf.size(), outputBuf.size(), static_cast<u64>(cmdArgSz));
             if (header->handleDesc)
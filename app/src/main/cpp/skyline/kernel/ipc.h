@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include <boost/container/static_vector.hpp>
 #include <common.h>
 #include "types/KSession.h"
 #include "types/KProcess.h"
@@ -11,6 +12,9 @@ namespace skyline {
     namespace constant {
         constexpr u8 IpcPaddingSum{0x10}; // The sum of the padding surrounding the data payload
         constexpr u16 TlsIpcSize{0x100}; // The size of the IPC command buffer in a TLS slot
+        constexpr u8 IpcMaxHandles{0xF}; // The maximum amount of copy or move handles in an IPC message, limited by the 4-bit counts in the handle descriptor
+        constexpr u8 IpcMaxBuffers{0xF}; // The maximum amount of descriptors of a single buffer type (X/A/B/W) in an IPC message, limited by the 4-bit counts in the command header
+        constexpr u8 IpcMaxBuffersC{0xD}; // The maximum amount of C buffer descriptors in an IPC message, the 4-bit C flag encodes the count offset by 2
     }
 
     namespace kernel::ipc {
@@ -202,11 +206,11 @@ namespace skyline {
             PayloadHeader *payload{};
             u8 *cmdArg{}; //!< A pointer to the data payload
             u64 cmdArgSz{}; //!< The size of the data payload
-            boost::container::small_vector<KHandle, 2> copyHandles; //!< The handles that should be copied from the server to the client process (The difference is just to match application expectations, there is no real difference b/w copying and moving handles)
-            boost::container::small_vector<KHandle, 2> moveHandles; //!< The handles that should be moved from the server to the client process rather than copied
+            boost::container::static_vector<KHandle, constant::IpcMaxHandles> copyHandles; //!< The handles that should be copied from the server to the client process (The difference is just to match application expectations, there is no real difference b/w copying and moving handles)
+            boost::container::static_vector<KHandle, constant::IpcMaxHandles> moveHandles; //!< The handles that should be moved from the server to the client process rather than copied
             boost::container::small_vector<KHandle, 2> domainObjects;
-            boost::container::small_vector<span<u8>, 3> inputBuf;
-            boost::container::small_vector<span<u8>, 3> outputBuf;
+            boost::container::static_vector<span<u8>, constant::IpcMaxBuffers * 2> inputBuf; //!< X and A buffers
+            boost::container::static_vector<span<u8>, (constant::IpcMaxBuffers * 3) + constant::IpcMaxBuffersC> outputBuf; //!< B, W (Twice) and C buffers
 
             IpcRequest(bool isDomain, const DeviceState &state);
 
@@ -242,7 +246,7 @@ namespace skyline {
             std::shared_ptr<ServiceType> PopService(u32 id, type::KSession &session) {
                 std::shared_ptr<service::BaseService> serviceObject;
                 if (session.isDomain)
-                    serviceObject = session.domains.at(domainObjects.at(id));
+                    serviceObject = session.GetDomainObject(domainObjects.at(id));
                 else
                     serviceObject = session.state.process->GetHandle<kernel::type::KSession>(moveHandles.at(id))->serviceObject;
 
@@ -265,12 +269,12 @@ namespace skyline {
         class IpcResponse {
           private:
             const DeviceState &state;
-            std::vector<u8> payload; //!< The contents to be pushed to the data payload
+            boost::container::static_vector<u8, constant::TlsIpcSize> payload; //!< The contents to be pushed to the data payload, this can never exceed the size of the IPC command buffer
 
           public:
             Result errorCode{}; //!< The error code to respond with, it's 0 (Success) by default
-            boost::container::small_vector<KHandle, 2> copyHandles;
-            boost::container::small_vector<KHandle, 2> moveHandles;
+            boost::container::static_vector<KHandle, constant::IpcMaxHandles> copyHandles;
+            boost::container::static_vector<KHandle, constant::IpcMaxHandles> moveHandles;
             boost::container::small_vector<KHandle, 2> domainObjects;
 
             IpcResponse(const DeviceState &state);
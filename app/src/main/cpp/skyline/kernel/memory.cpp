@@ -3,6 +3,7 @@
 
 #include <asm-generic/unistd.h>
 #include <fcntl.h>
+#include <common/settings.h>
 #include "memory.h"
 #include "types/KProcess.h"
 
@@ -90,7 +91,7 @@ namespace skyline::kernel {
         if (type != memory::AddressSpaceType::AddressSpace36Bit) {
             std::tie(base, memoryFd) = AllocateMappedRange(baseSize, RegionAlignment, KgslReservedRegionSize, addressSpace.size(), false);
 
-            chunks = {
+            for (const auto &chunk : std::initializer_list<ChunkDescriptor>{
                 ChunkDescriptor{
                     .ptr = addressSpace.data(),
                     .size = static_cast<size_t>(base.data() - addressSpace.data()),
@@ -105,7 +106,8 @@ namespace skyline::kernel {
                     .ptr = base.end().base(),
                     .size = addressSpace.size() - reinterpret_cast<u64>(base.end().base()),
                     .state = memory::states::Reserved,
-                }};
+                }})
+                chunks.emplace_hint(chunks.end(), chunk.ptr, chunk);
 
             code = base;
 
@@ -113,7 +115,7 @@ namespace skyline::kernel {
             std::tie(base, memoryFd) = AllocateMappedRange(baseSize, 1ULL << 36, KgslReservedRegionSize, addressSpace.size(), false);
             std::tie(codeBase36Bit, code36BitFd) = AllocateMappedRange(0x32000000, RegionAlignment, 0xC000000, 0x78000000ULL + reinterpret_cast<size_t>(addressSpace.data()), true);
 
-            chunks = {
+            for (const auto &chunk : std::initializer_list<ChunkDescriptor>{
                 ChunkDescriptor{
                     .ptr = addressSpace.data(),
                     .size = static_cast<size_t>(codeBase36Bit.data() - addressSpace.data()),
@@ -138,9 +140,12 @@ namespace skyline::kernel {
                     .ptr = base.end().base(),
                     .size = addressSpace.size() - reinterpret_cast<u64>(base.end().base()),
                     .state = memory::states::Reserved,
-                }};
+                }})
+                chunks.emplace_hint(chunks.end(), chunk.ptr, chunk);
             code = codeBase36Bit;
         }
+
+        chunkGeneration = nextChunkGeneration.fetch_add(1, std::memory_order_relaxed);
     }
 
     void MemoryManager::InitializeRegions(span<u8> codeRegion) {
@@ -180,9 +185,66 @@ namespace skyline::kernel {
         if (codeRegion.size() > code.size())
             throw exception("Code region ({}) is smaller than mapped code size ({})", code.size(), codeRegion.size());
 
+        if (*state.settings->hugePageMemory) {
+            // Shared memory is only backed by huge pages on madvise if the kernel's shmem THP policy is 'advise' (or more permissive), we don't use hugetlb memfds as they can't be reprotected or freed at a page granularity
+            std::ifstream shmemPolicyFile{"/sys/kernel/mm/transparent_hugepage/shmem_enabled"};
+            std::string shmemPolicy((std::istreambuf_iterator<char>(shmemPolicyFile)), std::istreambuf_iterator<char>());
+            if (shmemPolicy.find("[never]") != std::string::npos || shmemPolicy.find("[deny]") != std::string::npos)
+                Logger::Info("Huge pages for guest memory were requested but the kernel's shmem THP policy disallows them");
+
+            hugePages = true;
+            AdviseHugePages(code, code);
+            AdviseHugePages(heap, heap);
+        }
+
         Logger::Debug("Region Map:\nVMM Base: 0x{:X}\nCode Region: 0x{:X} - 0x{:X} (Size: 0x{:X})\nAlias Region: 0x{:X} - 0x{:X} (Size: 0x{:X})\nHeap Region: 0x{:X} - 0x{:X} (Size: 0x{:X})\nStack Region: 0x{:X} - 0x{:X} (Size: 0x{:X})\nTLS/IO Region: 0x{:X} - 0x{:X} (Size: 0x{:X})", base.data(), code.data(), code.end().base(), code.size(), alias.data(), alias.end().base(), alias.size(), heap.data(), heap.end().base(), heap.size(), stack.data(), stack.end().base(), stack.size(), tlsIo.data(), tlsIo.end().base(), tlsIo.size());
     }
 
+    std::pair<int, off_t> MemoryManager::GetNativeBacking(u8 *ptr) {
+        if (codeBase36Bit.valid() && codeBase36Bit.contains(ptr))
+            return {code36BitFd, static_cast<off_t>(ptr - codeBase36Bit.data())};
+        return {memoryFd, static_cast<off_t>(ptr - base.data())};
+    }
+
+    bool MemoryManager::IsAliased(span<u8> mapping) {
+        auto alias{aliases.lower_bound(mapping.end().base())};
+        return alias != aliases.begin() && (--alias)->first + alias->second.size > mapping.data();
+    }
+
+    template<typename Function>
+    void MemoryManager::ForEachBacking(span<u8> mapping, Function function) {
+        auto ptr{mapping.data()}, end{mapping.end().base()};
+        auto alias{aliases.upper_bound(ptr)};
+        if (alias != aliases.begin())
+            alias--;
+
+        while (ptr < end) {
+            while (alias != aliases.end() && alias->first + alias->second.size <= ptr)
+                alias++;
+
+            u8 *pieceEnd;
+            std::pair<int, off_t> backing;
+            if (alias != aliases.end() && alias->first <= ptr) {
+                pieceEnd = std::min(end, alias->first + alias->second.size);
+                backing = GetNativeBacking(alias->second.source + (ptr - alias->first));
+            } else {
+                pieceEnd = (alias != aliases.end()) ? std::min(end, alias->first) : end;
+                backing = GetNativeBacking(ptr);
+            }
+
+            function(span<u8>{ptr, static_cast<size_t>(pieceEnd - ptr)}, backing.first, backing.second);
+            ptr = pieceEnd;
+        }
+    }
+
+    void MemoryManager::MapBacking(u8 *target, span<u8> mapping, int protection) {
+        ForEachBacking(mapping, [&](span<u8> piece, int fd, off_t offset) {
+            auto pieceTarget{target + (piece.data() - mapping.data())};
+            if (mmap(pieceTarget, piece.size(), protection, MAP_SHARED | MAP_FIXED, fd, offset) == MAP_FAILED)
+                throw exception("Failed to map backing of 0x{:X}-0x{:X} (0x{:X}) at 0x{:X}: {}", piece.data(), piece.end().base(), offset, pieceTarget, strerror(errno));
+        });
+    }
+
     span<u8> MemoryManager::CreateMirror(span<u8> mapping) {
         if (!base.contains(mapping))
             throw exception("Mapping is outside of VMM base: 0x{:X} - 0x{:X}", mapping.data(), mapping.end().base());
@@ -191,9 +253,21 @@ namespace skyline::kernel {
         if (!util::IsPageAligned(offset) || !util::IsPageAligned(mapping.size()))
             throw exception("Mapping is not aligned to a page: 0x{:X}-0x{:X} (0x{:X})", mapping.data(), mapping.end().base(), offset);
 
-        auto mirror{mmap(nullptr, mapping.size(), PROT_READ | PROT_WRITE | PROT_EXEC, MAP_SHARED, memoryFd, static_cast<off_t>(offset))};
-        if (mirror == MAP_FAILED)
-            throw exception("Failed to create mirror mapping at 0x{:X}-0x{:X} (0x{:X}): {}", mapping.data(), mapping.end().base(), offset, strerror(errno));
+        std::shared_lock lock{mutex};
+        void *mirror;
+        if (!IsAliased(mapping)) {
+            mirror = mmap(nullptr, mapping.size(), PROT_READ | PROT_WRITE | PROT_EXEC, MAP_SHARED, memoryFd, static_cast<off_t>(offset));
+            if (mirror == MAP_FAILED)
+                throw exception("Failed to create mirror mapping at 0x{:X}-0x{:X} (0x{:X}): {}", mapping.data(), mapping.end().base(), offset, strerror(errno));
+        } else {
+            mirror = mmap(nullptr, mapping.size(), PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0); // Reserve address space for the pieces of the mirror
+            if (mirror == MAP_FAILED)
+                throw exception("Failed to create mirror base: {} (0x{:X} bytes)", strerror(errno), mapping.size());
+
+            MapBacking(reinterpret_cast<u8 *>(mirror), mapping, PROT_READ | PROT_WRITE | PROT_EXEC);
+        }
+
+        AdviseHugePages(span<u8>{reinterpret_cast<u8 *>(mirror), mapping.size()}, mapping);
 
         return span<u8>{reinterpret_cast<u8 *>(mirror), mapping.size()};
     }
@@ -207,6 +281,7 @@ namespace skyline::kernel {
         if (mirrorBase == MAP_FAILED)
             throw exception("Failed to create mirror base: {} (0x{:X} bytes)", strerror(errno), totalSize);
 
+        std::shared_lock lock{mutex};
         size_t mirrorOffset{};
         for (const auto &region : regions) {
             if (!base.contains(region))
@@ -216,9 +291,10 @@ namespace skyline::kernel {
             if (!util::IsPageAligned(offset) || !util::IsPageAligned(region.size()))
                 throw exception("Mapping is not aligned to a page: 0x{:X}-0x{:X} (0x{:X})", region.data(), region.end().base(), offset);
 
-            auto mirror{mmap(reinterpret_cast<u8 *>(mirrorBase) + mirrorOffset, region.size(), PROT_READ | PROT_WRITE | PROT_EXEC, MAP_SHARED | MAP_FIXED, memoryFd, static_cast<off_t>(offset))};
-            if (mirror == MAP_FAILED)
-                throw exception("Failed to create mirror mapping at 0x{:X}-0x{:X} (0x{:X}): {}", region.data(), region.end().base(), offset, strerror(errno));
+            auto mirror{reinterpret_cast<u8 *>(mirrorBase) + mirrorOffset};
+            MapBacking(mirror, region, PROT_READ | PROT_WRITE | PROT_EXEC);
+
+            AdviseHugePages(span<u8>{mirror, region.size()}, region);
 
             mirrorOffset += region.size();
         }
@@ -229,6 +305,55 @@ namespace skyline::kernel {
         return span<u8>{reinterpret_cast<u8 *>(mirrorBase), totalSize};
     }
 
+    void MemoryManager::AliasMemory(span<u8> destination, u8 *source, memory::Permission permission) {
+        if (!util::IsPageAligned(destination.data()) || !util::IsPageAligned(source) || !util::IsPageAligned(destination.size()))
+            throw exception("Aliased mapping is not aligned to a page: 0x{:X}-0x{:X} (Source: 0x{:X})", destination.data(), destination.end().base(), source);
+
+        std::unique_lock lock{mutex};
+        if (IsAliased(destination))
+            throw exception("Aliasing an already aliased mapping: 0x{:X}-0x{:X}", destination.data(), destination.end().base());
+
+        MapBacking(destination.data(), span<u8>{source, destination.size()}, permission.Get());
+        aliases.emplace(destination.data(), MemoryAlias{destination.size(), source});
+    }
+
+    void MemoryManager::UnaliasMemory(span<u8> destination) {
+        std::unique_lock lock{mutex};
+
+        // Any aliases which partially overlap the range are trimmed to the parts outside of it
+        auto alias{aliases.upper_bound(destination.data())};
+        if (alias != aliases.begin())
+            alias--;
+        while (alias != aliases.end() && alias->first < destination.end().base()) {
+            auto aliasStart{alias->first};
+            auto aliasEnd{aliasStart + alias->second.size};
+            auto source{alias->second.source};
+            if (aliasEnd <= destination.data()) {
+                alias++;
+                continue;
+            }
+
+            alias = aliases.erase(alias);
+            if (aliasStart < destination.data())
+                aliases.emplace(aliasStart, MemoryAlias{static_cast<size_t>(destination.data() - aliasStart), source});
+            if (aliasEnd > destination.end().base())
+                aliases.emplace(destination.end().base(), MemoryAlias{static_cast<size_t>(aliasEnd - destination.end().base()), source + (destination.end().base() - aliasStart)});
+        }
+
+        auto [fd, offset]{GetNativeBacking(destination.data())};
+        if (mmap(destination.data(), destination.size(), PROT_NONE, MAP_SHARED | MAP_FIXED, fd, offset) == MAP_FAILED)
+            throw exception("Failed to restore backing of 0x{:X}-0x{:X} (0x{:X}): {}", destination.data(), destination.end().base(), offset, strerror(errno));
+    }
+
+    void MemoryManager::AdviseHugePages(span<u8> mapping, span<u8> guestMapping) {
+        if (!hugePages || !(code.contains(guestMapping) || heap.contains(guestMapping)))
+            return;
+
+        // Huge pages can only be used for the huge page aligned portion of the mapping, the kernel silently ignores the rest
+        if (madvise(mapping.data(), mapping.size(), MADV_HUGEPAGE) == -1)
+            Logger::Warn("Failed to advise huge pages for 0x{:X} - 0x{:X}: {}", mapping.data(), mapping.end().base(), strerror(errno));
+    }
+
     void MemoryManager::FreeMemory(span<u8> memory) {
         if (!base.contains(memory))
             throw exception("Mapping is outside of VMM base: 0x{:X} - 0x{:X}", memory.data(), memory.end().base());
@@ -237,71 +362,88 @@ namespace skyline::kernel {
         if (!util::IsPageAligned(offset) || !util::IsPageAligned(memory.size()))
             throw exception("Mapping is not aligned to a page: 0x{:X}-0x{:X} (0x{:X})", memory.data(), memory.end().base(), offset);
 
-        // We need to use fallocate(FALLOC_FL_PUNCH_HOLE) to free the backing memory rather than madvise(MADV_REMOVE) as the latter fails when the memory doesn't have write permissions, we generally need to free memory after reprotecting it to disallow accesses between the two calls which would cause UB
-        if (fallocate(*memoryFd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, static_cast<off_t>(offset), static_cast<off_t>(memory.size())) != 0)
-            throw exception("Failed to free memory at 0x{:X}-0x{:X} (0x{:X}): {}", memory.data(), memory.end().base(), offset, strerror(errno));
+        std::shared_lock lock{mutex};
+        ForEachBacking(memory, [&](span<u8> piece, int fd, off_t pieceOffset) {
+            // We need to use fallocate(FALLOC_FL_PUNCH_HOLE) to free the backing memory rather than madvise(MADV_REMOVE) as the latter fails when the memory doesn't have write permissions, we generally need to free memory after reprotecting it to disallow accesses between the two calls which would cause UB
+            if (fallocate(fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, pieceOffset, static_cast<off_t>(piece.size())) != 0)
+                throw exception("Failed to free memory at 0x{:X}-0x{:X} (0x{:X}): {}", piece.data(), piece.end().base(), pieceOffset, strerror(errno));
+        });
+    }
+
+    std::map<u8 *, ChunkDescriptor>::iterator MemoryManager::SplitChunk(u8 *ptr) {
+        auto upper{chunks.upper_bound(ptr)};
+        if (upper == chunks.begin())
+            return upper;
+
+        auto &lower{std::prev(upper)->second};
+        if (lower.ptr == ptr)
+            return std::prev(upper);
+        else if (lower.ptr + lower.size <= ptr)
+            return upper;
+
+        auto extension{lower};
+        extension.ptr = ptr;
+        extension.size = static_cast<size_t>((lower.ptr + lower.size) - ptr);
+        lower.size = static_cast<size_t>(ptr - lower.ptr);
+        return chunks.emplace_hint(upper, ptr, extension);
     }
 
     void MemoryManager::InsertChunk(const ChunkDescriptor &chunk) {
         std::unique_lock lock(mutex);
 
-        auto upper{std::upper_bound(chunks.begin(), chunks.end(), chunk.ptr, [](const u8 *ptr, const ChunkDescriptor &chunk) -> bool { return ptr < chunk.ptr; })};
-        if (upper == chunks.begin())
-            throw exception("InsertChunk: Chunk inserted outside address space: 0x{:X} - 0x{:X} and 0x{:X} - 0x{:X}", upper->ptr, upper->ptr + upper->size, chunk.ptr, chunk.ptr + chunk.size);
+        if (chunks.empty() || chunk.ptr < chunks.begin()->first)
+            throw exception("InsertChunk: Chunk inserted outside address space: 0x{:X} - 0x{:X}", chunk.ptr, chunk.ptr + chunk.size);
 
-        upper = chunks.erase(upper, std::upper_bound(upper, chunks.end(), chunk.ptr + chunk.size, [](const u8 *ptr, const ChunkDescriptor &chunk) -> bool { return ptr < chunk.ptr + chunk.size; }));
-        if (upper != chunks.end() && upper->ptr < chunk.ptr + chunk.size) {
-            auto end{upper->ptr + upper->size};
-            upper->ptr = chunk.ptr + chunk.size;
-            upper->size = static_cast<size_t>(end - upper->ptr);
+        // Any chunks which partially overlap the inserted chunk are split at its boundaries, the chunks fully covered by it are then replaced with it
+        auto first{SplitChunk(chunk.ptr)};
+        auto last{SplitChunk(chunk.ptr + chunk.size)};
+        auto it{chunks.emplace_hint(chunks.erase(first, last), chunk.ptr, chunk)};
+
+        auto next{std::next(it)};
+        if (next != chunks.end() && chunk.IsCompatible(next->second) && next->first == chunk.ptr + chunk.size) {
+            it->second.size += next->second.size;
+            chunks.erase(next);
         }
 
-        auto lower{std::prev(upper)};
-        if (lower->ptr == chunk.ptr && lower->size == chunk.size) {
-            lower->state = chunk.state;
-            lower->permission = chunk.permission;
-            lower->attributes = chunk.attributes;
-            lower->memory = chunk.memory;
-        } else if (lower->ptr + lower->size > chunk.ptr + chunk.size) {
-            auto lowerExtension{*lower};
-            lowerExtension.ptr = chunk.ptr + chunk.size;
-            lowerExtension.size = static_cast<size_t>((lower->ptr + lower->size) - lowerExtension.ptr);
-
-            lower->size = static_cast<size_t>(chunk.ptr - lower->ptr);
-            if (lower->size) {
-                upper = chunks.insert(upper, lowerExtension);
-                chunks.insert(upper, chunk);
-            } else {
-                auto lower2{std::prev(lower)};
-                if (chunk.IsCompatible(*lower2) && lower2->ptr + lower2->size >= chunk.ptr) {
-                    lower2->size = static_cast<size_t>(chunk.ptr + chunk.size - lower2->ptr);
-                    upper = chunks.erase(lower);
-                } else {
-                    *lower = chunk;
-                }
-                upper = chunks.insert(upper, lowerExtension);
-            }
-        } else if (chunk.IsCompatible(*lower) && lower->ptr + lower->size >= chunk.ptr) {
-            lower->size = static_cast<size_t>(chunk.ptr + chunk.size - lower->ptr);
-        } else {
-            if (lower->ptr + lower->size > chunk.ptr)
-                lower->size = static_cast<size_t>(chunk.ptr - lower->ptr);
-            if (upper != chunks.end() && chunk.IsCompatible(*upper) && chunk.ptr + chunk.size >= upper->ptr) {
-                upper->ptr = chunk.ptr;
-                upper->size = chunk.size + upper->size;
-            } else {
-                chunks.insert(upper, chunk);
+        if (it != chunks.begin()) {
+            auto &previous{std::prev(it)->second};
+            if (chunk.IsCompatible(previous) && previous.ptr + previous.size == chunk.ptr) {
+                previous.size += it->second.size;
+                chunks.erase(it);
             }
         }
+
+        chunkGeneration = nextChunkGeneration.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    namespace {
+        /**
+         * @brief An entry in the per-thread cache of chunk lookups, it is only valid while the generation matches that of the manager
+         */
+        struct ChunkCacheEntry {
+            u64 generation;
+            ChunkDescriptor chunk;
+        };
+
+        constexpr size_t ChunkCacheSize{0x40}; //!< The amount of entries in the chunk lookup cache, a direct-mapped slot is selected by the page number of the address
+        thread_local std::array<ChunkCacheEntry, ChunkCacheSize> chunkCache{};
     }
 
     std::optional<ChunkDescriptor> MemoryManager::Get(void *ptr) {
         std::shared_lock lock(mutex);
 
-        auto chunk{std::upper_bound(chunks.begin(), chunks.end(), reinterpret_cast<u8 *>(ptr), [](const u8 *ptr, const ChunkDescriptor &chunk) -> bool { return ptr < chunk.ptr; })};
-        if (chunk-- != chunks.begin())
-            if ((chunk->ptr + chunk->size) > ptr)
-                return std::make_optional(*chunk);
+        auto address{reinterpret_cast<u8 *>(ptr)};
+        auto &entry{chunkCache[(reinterpret_cast<uintptr_t>(ptr) / constant::PageSize) % ChunkCacheSize]};
+        if (entry.generation == chunkGeneration && entry.chunk.ptr <= address && address < entry.chunk.ptr + entry.chunk.size)
+            return entry.chunk;
+
+        auto chunk{chunks.upper_bound(address)};
+        if (chunk-- != chunks.begin()) {
+            if ((chunk->second.ptr + chunk->second.size) > address) {
+                entry = {chunkGeneration, chunk->second};
+                return std::make_optional(chunk->second);
+            }
+        }
 
         return std::nullopt;
     }
@@ -309,7 +451,7 @@ namespace skyline::kernel {
     size_t MemoryManager::GetUserMemoryUsage() {
         std::shared_lock lock(mutex);
         size_t size{};
-        for (const auto &chunk : chunks)
+        for (const auto &[ptr, chunk] : chunks)
             if (chunk.state == memory::states::Heap)
                 size += chunk.size;
         return size + code.size() + state.process->mainThreadStack->guest.size();
@@ -212,7 +212,54 @@ namespace skyline {
         class MemoryManager {
           private:
             const DeviceState &state;
-            std::vector<ChunkDescriptor> chunks;
+            std::map<u8 *, ChunkDescriptor> chunks; //!< A map from the base address of chunks to their descriptor, these are contiguous and cover the entire address space
+            u64 chunkGeneration{}; //!< A globally unique value for the current state of 'chunks', cached lookups from Get are only valid for the generation they were made in
+            static inline std::atomic<u64> nextChunkGeneration{1}; //!< The source of values for 'chunkGeneration', this is shared across all managers so a stale lookup cannot match another manager
+
+            /**
+             * @brief Splits the chunk containing the supplied address so that a chunk starts at it
+             * @return An iterator to the chunk starting at the address, or the first chunk after it if the address isn't covered by any chunk
+             * @note The mutex must be locked exclusively when calling this
+             */
+            std::map<u8 *, ChunkDescriptor>::iterator SplitChunk(u8 *ptr);
+
+            bool hugePages{}; //!< If the code and heap regions (and any mirrors of them) are advised to be backed by transparent huge pages
+
+            /**
+             * @brief Advises the kernel to back a mapping of guest memory with transparent huge pages if it's inside the code or heap regions
+             */
+            void AdviseHugePages(span<u8> mapping, span<u8> guestMapping);
+
+            struct MemoryAlias {
+                size_t size;
+                u8 *source; //!< The start of the range whose backing memory is mapped in place of the aliasing range's own
+            };
+            std::map<u8 *, MemoryAlias> aliases; //!< Non-overlapping guest ranges which are mapped to the backing memory of another range, keyed by the start of the aliasing range
+
+            /**
+             * @return The file descriptor and offset of the backing memory that's mapped at the supplied guest address when it isn't aliased
+             */
+            std::pair<int, off_t> GetNativeBacking(u8 *ptr);
+
+            /**
+             * @return If any part of the supplied range is aliased
+             * @note The mutex must be locked when calling this
+             */
+            bool IsAliased(span<u8> mapping);
+
+            /**
+             * @brief Calls the supplied function with the file descriptor and offset of the backing memory for every piece of a range of guest memory, pieces are split at the boundaries of aliased ranges
+             * @note The mutex must be locked when calling this
+             */
+            template<typename Function>
+            void ForEachBacking(span<u8> mapping, Function function);
+
+            /**
+             * @brief Maps the backing memory for a page-aligned range of guest memory at the target in the host address space, accounting for any aliased parts of it
+             * @param protection The host protection of the new mapping
+             * @note The mutex must be locked when calling this
+             */
+            void MapBacking(u8 *target, span<u8> mapping, int protection);
 
           public:
             memory::AddressSpaceType addressSpaceType{};
@@ -257,6 +304,18 @@ namespace skyline {
              */
             span<u8> CreateMirrors(const std::vector<span<u8>> &regions);
 
+            /**
+             * @brief Maps the backing memory of a page-aligned range starting at the source in place of the destination's own, accesses to either range are then coherent without any copies
+             * @param permission The permission of the source range, the destination is mapped with it
+             * @note This is used for svcMapMemory which aliases the same physical memory on HOS, the source range must not be aliased itself
+             */
+            void AliasMemory(span<u8> destination, u8 *source, memory::Permission permission);
+
+            /**
+             * @brief Restores the backing memory of a page-aligned range which was aliased with AliasMemory to its own, the range is left inaccessible
+             */
+            void UnaliasMemory(span<u8> destination);
+
             /**
              * @brief Frees the underlying physical memory for a page-aligned mapping in the guest address space
              * @note All subsequent accesses to freed memory will return 0s
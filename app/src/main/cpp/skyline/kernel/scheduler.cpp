@@ -2,15 +2,201 @@
 // Copyright © 2020 Skyline Team and Contributors (https://github.com/skyline-emu/)
 
 #include <unistd.h>
+#include <fstream>
+#include <common/settings.h>
 #include <common/signal.h>
 #include <common/trace.h>
+#include <common/performance_statistics.h>
 #include "types/KThread.h"
 #include "scheduler.h"
 
 namespace skyline::kernel {
-    Scheduler::CoreContext::CoreContext(u8 id, i8 preemptionPriority) : id(id), preemptionPriority(preemptionPriority) {}
+    namespace {
+        constexpr std::array<const char *, constant::CoreCount> CoreUtilisationTracks{"C0 Utilisation", "C1 Utilisation", "C2 Utilisation", "C3 Utilisation"};
+
+        /**
+         * @return The maximum frequency in kHz of every host CPU indexed by its number, CPUs which don't report a frequency have a frequency of 0
+         */
+        std::vector<u32> GetHostCpuFrequencies() {
+            std::vector<u32> frequencies(static_cast<size_t>(std::max(sysconf(_SC_NPROCESSORS_CONF), 0L)));
+            for (size_t cpu{}; cpu < frequencies.size() && cpu < CPU_SETSIZE; cpu++) {
+                std::ifstream file{util::Format("/sys/devices/system/cpu/cpu{}/cpufreq/cpuinfo_max_freq", cpu)};
+                if (file)
+                    file >> frequencies[cpu];
+            }
+            return frequencies;
+        }
+    }
+
+    void ThreadQueue::PushBack(type::KThread &thread) {
+        auto priority{thread.priority.load()};
+        thread.queuedPriority = priority;
+        thread.queuedTimestamp = util::GetTimeTicks();
+        levels[static_cast<size_t>(priority)].push_back(thread);
+        presentLevels |= 1ULL << priority;
+        waitingCount.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void ThreadQueue::Unlink(type::KThread &thread) {
+        auto &level{levels[static_cast<size_t>(thread.queuedPriority)]};
+        level.erase(level.iterator_to(thread));
+        if (level.empty())
+            presentLevels &= ~(1ULL << thread.queuedPriority);
+        waitingCount.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    type::KThread *ThreadQueue::PopNext() {
+        if (!presentLevels)
+            return nullptr;
+
+        auto &thread{levels[static_cast<size_t>(std::countr_zero(presentLevels))].front()};
+        Unlink(thread);
+        return &thread;
+    }
+
+    type::KThread *ThreadQueue::Next() {
+        if (!presentLevels)
+            return nullptr;
+        return &levels[static_cast<size_t>(std::countr_zero(presentLevels))].front();
+    }
+
+    template<typename Function>
+    void ThreadQueue::ForEachUpTo(i8 priority, Function function) const {
+        u64 mask{presentLevels & (std::numeric_limits<u64>::max() >> (std::numeric_limits<u64>::digits - 1 - priority))};
+        while (mask) {
+            for (const auto &thread : levels[static_cast<size_t>(std::countr_zero(mask))])
+                function(thread);
+            mask &= mask - 1;
+        }
+    }
+
+    template<typename Predicate>
+    type::KThread *ThreadQueue::FindNext(Predicate predicate) {
+        for (u64 mask{presentLevels}; mask; mask &= mask - 1)
+            for (auto &thread : levels[static_cast<size_t>(std::countr_zero(mask))])
+                if (predicate(thread))
+                    return &thread;
+        return nullptr;
+    }
+
+    bool ThreadQueue::Contains(const type::KThread &thread) const {
+        // A thread can only be in the queue of its resident core, so being linked into any priority level implies being in this queue
+        return front == &thread || thread.ThreadQueueHook::is_linked();
+    }
+
+    void ThreadQueue::Insert(type::KThread &thread) {
+        if (!front) {
+            thread.queuedTimestamp = util::GetTimeTicks();
+            front = &thread;
+        } else {
+            PushBack(thread);
+        }
+    }
+
+    type::KThread *ThreadQueue::InsertFront(type::KThread &thread) {
+        auto previousFront{front};
+        PushBack(*previousFront);
+        thread.queuedTimestamp = util::GetTimeTicks();
+        front = &thread;
+        return previousFront;
+    }
+
+    void ThreadQueue::Rotate() {
+        PushBack(*front);
+        front = PopNext();
+    }
+
+    bool ThreadQueue::Erase(type::KThread &thread) {
+        if (front == &thread) {
+            front = PopNext();
+            return true;
+        }
+
+        Unlink(thread);
+        return false;
+    }
+
+    void ThreadQueue::Requeue(type::KThread &thread) {
+        Unlink(thread);
+        PushBack(thread);
+    }
+
+    Scheduler::CoreContext::CoreContext(u8 id, i8 preemptionPriority) : id(id), preemptionPriority(preemptionPriority) {
+        CPU_ZERO(&hostCpus);
+    }
+
+    Scheduler::Scheduler(const DeviceState &state) : state(state) {
+        // On hosts with heterogeneous CPUs, the application cores are pinned to all CPUs faster than the slowest cluster while the system core is pinned to the slowest cluster
+        // The system core only runs threads from sysmodules and services which are low priority and shouldn't take time away from the application on the faster CPUs
+        auto frequencies{GetHostCpuFrequencies()};
+        u32 minFrequency{std::numeric_limits<u32>::max()}, maxFrequency{};
+        for (auto frequency : frequencies) {
+            if (frequency) {
+                minFrequency = std::min(minFrequency, frequency);
+                maxFrequency = std::max(maxFrequency, frequency);
+            }
+        }
+
+        if (!maxFrequency || minFrequency == maxFrequency) {
+            Logger::Info("Host CPUs are homogeneous, guest cores won't be pinned");
+            return;
+        }
+
+        cpu_set_t fastCpus, slowCpus;
+        CPU_ZERO(&fastCpus);
+        CPU_ZERO(&slowCpus);
+        for (size_t cpu{}; cpu < frequencies.size(); cpu++)
+            if (frequencies[cpu])
+                CPU_SET(cpu, frequencies[cpu] == minFrequency ? &slowCpus : &fastCpus);
+
+        for (auto &core : cores)
+            core.hostCpus = core.id == constant::CoreCount - 1 ? slowCpus : fastCpus;
+
+        Logger::Info("Pinning application cores to {} host CPUs and the system core to {} host CPUs ({} - {} kHz)", CPU_COUNT(&fastCpus), CPU_COUNT(&slowCpus), minFrequency, maxFrequency);
+    }
+
+    void Scheduler::UpdateHostAffinity(type::KThread &thread, CoreContext &core) {
+        if (thread.hostAffinityCoreId == core.id || !CPU_COUNT(&core.hostCpus))
+            return;
+
+        if (sched_setaffinity(0, sizeof(cpu_set_t), &core.hostCpus))
+            Logger::Warn("Failed to pin T{} to the host CPUs of C{}: {}", thread.id, core.id, strerror(errno));
+        thread.hostAffinityCoreId = core.id; // We don't retry on failure as it'd just fail again on every schedule
+    }
+
+    void Scheduler::AccountTimeslice(CoreContext &core, type::KThread &thread, u64 timeslice) {
+        constexpr u64 UtilisationWindowsPerSecond{10};
+
+        thread.statistics.runTicks += timeslice;
+        core.busyTicks += timeslice;
+        GetPerformanceStatistics().guestCoreBusyNs[core.id].fetch_add(static_cast<u64>(util::TicksToNs(timeslice)), std::memory_order_relaxed);
+        u64 now{util::GetTimeTicks()}, windowDuration{now - core.utilisationWindowStart};
+        if (windowDuration >= util::ClockFrequency / UtilisationWindowsPerSecond) {
+            // A timeslice which started in a prior window is entirely accounted towards the current one, this is clamped to avoid reporting more than full utilisation
+            float utilisation{std::min(static_cast<float>(core.busyTicks) / static_cast<float>(windowDuration), 1.0f)};
+            core.utilisation.store(utilisation, std::memory_order_relaxed);
+            TRACE_COUNTER("scheduler", perfetto::CounterTrack(CoreUtilisationTracks[core.id]), utilisation * 100.0f);
+
+            core.busyTicks = 0;
+            core.utilisationWindowStart = now;
+        }
+    }
+
+    void Scheduler::StartTimeslice(type::KThread &thread, CoreContext &core) {
+        if (thread.priority == core.preemptionPriority) {
+            // If the thread needs to be preempted then arm its preemption timer
+            UpdatePreemptiveTimeslice(thread, core);
+            ArmPreemptionTimer(thread, core);
+        }
 
-    Scheduler::Scheduler(const DeviceState &state) : state(state) {}
+        UpdateHostAffinity(thread, core);
+
+        thread.timesliceStart = util::GetTimeTicks();
+        u64 readyTicks{thread.timesliceStart - thread.queuedTimestamp};
+        thread.statistics.readyTicks += readyTicks;
+        thread.statistics.scheduleCount++;
+        TRACE_EVENT_INSTANT("scheduler", "Run", "core", core.id, "readyUs", (readyTicks * 1'000'000) / util::ClockFrequency);
+    }
 
     void Scheduler::SignalHandler(int signal, siginfo *info, ucontext *ctx, void **tls) {
         if (*tls) {
@@ -33,7 +219,7 @@ namespace skyline::kernel {
     Scheduler::CoreContext &Scheduler::GetOptimalCoreForThread(const std::shared_ptr<type::KThread> &thread) {
         auto *currentCore{&cores.at(thread->coreId)};
 
-        if (!currentCore->queue.empty() && thread->affinityMask.count() != 1) {
+        if (!currentCore->queue.Empty() && thread->affinityMask.count() != 1) {
             // Select core where the current thread will be scheduled the earliest based off average timeslice durations for resident threads
             // There's a preference for the current core as migration isn't free
             size_t minTimeslice{};
@@ -42,12 +228,10 @@ namespace skyline::kernel {
                 if (thread->affinityMask.test(candidateCore.id)) {
                     u64 timeslice{};
 
-                    if (!candidateCore.queue.empty()) {
+                    if (!candidateCore.queue.Empty()) {
                         std::scoped_lock coreLock{candidateCore.mutex};
 
-                        auto threadIterator{candidateCore.queue.cbegin()};
-                        if (threadIterator != candidateCore.queue.cend()) {
-                            const auto &runningThread{*threadIterator};
+                        if (auto runningThread{candidateCore.queue.Front()}) {
                             timeslice += [&]() {
                                 if (runningThread->averageTimeslice)
                                     return std::min(runningThread->averageTimeslice - (util::GetTimeTicks() - runningThread->timesliceStart), 1UL);
@@ -57,11 +241,9 @@ namespace skyline::kernel {
                                     return 1UL;
                             }();
 
-                            while (++threadIterator != candidateCore.queue.cend()) {
-                                const auto &residentThread{*threadIterator};
-                                if (residentThread->priority <= thread->priority)
-                                    timeslice += residentThread->averageTimeslice ? residentThread->averageTimeslice : 1UL;
-                            }
+                            candidateCore.queue.ForEachUpTo(thread->priority, [&](const type::KThread &residentThread) {
+                                timeslice += residentThread.averageTimeslice ? residentThread.averageTimeslice : 1UL;
+                            });
                         }
                     }
 
@@ -85,6 +267,69 @@ namespace skyline::kernel {
         return *currentCore;
     }
 
+    void Scheduler::StealThread(CoreContext &idleCore) {
+        CoreContext *busiestCore{};
+        u32 maxWaitingCount{};
+        for (auto &core : cores) {
+            auto waitingCount{core.queue.WaitingCount()};
+            if (&core != &idleCore && waitingCount > maxWaitingCount) {
+                busiestCore = &core;
+                maxWaitingCount = waitingCount;
+            }
+        }
+
+        if (!busiestCore)
+            return;
+
+        std::scoped_lock coreLock{busiestCore->mutex, idleCore.mutex};
+        if (!idleCore.queue.Empty())
+            return; // A thread could've been inserted into the idle core while it was unlocked
+
+        // Threads which were yielded but are still running or are paused can't be migrated, the former will be handled when they rotate
+        auto thread{busiestCore->queue.FindNext([&](const type::KThread &candidate) {
+            return candidate.affinityMask.test(idleCore.id) && !candidate.forceYield && !candidate.pendingYield && !candidate.isPaused;
+        })};
+        if (!thread || !thread->coreMigrationMutex.try_lock())
+            return; // We cannot block on the migration mutex while holding the core mutexes, the thread is skipped if it's contended
+        std::lock_guard migrationLock{thread->coreMigrationMutex, std::adopt_lock};
+
+        Logger::Debug("Work Stealing T{}: C{} -> C{}", thread->id, busiestCore->id, idleCore.id);
+
+        busiestCore->queue.Erase(*thread);
+        thread->coreId = idleCore.id;
+        idleCore.queue.Insert(*thread);
+        thread->scheduleCondition.notify_one(); // The thread will follow its new core when it's woken up
+    }
+
+    void Scheduler::UpdatePreemptiveTimeslice(type::KThread &thread, CoreContext &core) {
+        constexpr std::chrono::milliseconds MinimumTimeslice{1};
+        constexpr u64 StarvationFactor{2}; //!< The multiple of the configured timeslice that a thread must wait beyond to be considered starved
+
+        std::chrono::nanoseconds configuredTimeslice{std::chrono::milliseconds{*state.settings->preemptionTimeslice}};
+        if (!*state.settings->adaptivePreemption || !core.preemptiveTimeslice.count() || core.preemptiveTimeslice > configuredTimeslice) {
+            core.preemptiveTimeslice = configuredTimeslice;
+            if (!*state.settings->adaptivePreemption)
+                return;
+        }
+
+        u64 waitedTicks{util::GetTimeTicks() - thread.queuedTimestamp};
+        u64 starvationTicks{(static_cast<u64>(configuredTimeslice.count()) * StarvationFactor * util::ClockFrequency) / constant::NsInSecond};
+        if (waitedTicks > starvationTicks)
+            core.preemptiveTimeslice = std::max<std::chrono::nanoseconds>(core.preemptiveTimeslice / 2, MinimumTimeslice);
+        else
+            core.preemptiveTimeslice = std::min(core.preemptiveTimeslice + (configuredTimeslice / 8), configuredTimeslice);
+    }
+
+    void Scheduler::ArmPreemptionTimer(type::KThread &thread, CoreContext &core) {
+        if (*state.settings->adaptivePreemption) {
+            auto nextThread{core.queue.Next()};
+            if (!nextThread || nextThread->priority != thread.priority)
+                return;
+        }
+
+        thread.ArmPreemptionTimer(core.preemptiveTimeslice.count() ? core.preemptiveTimeslice : std::chrono::milliseconds{*state.settings->preemptionTimeslice});
+    }
+
     void Scheduler::InsertThread(const std::shared_ptr<type::KThread> &thread) {
         auto &core{cores.at(thread->coreId)};
         std::unique_lock lock(core.mutex);
@@ -95,23 +340,21 @@ namespace skyline::kernel {
             thread->scheduleCondition.wait(lock, [&]() { return !thread->isPaused; });
         }
 
-        auto nextThread{std::upper_bound(core.queue.begin(), core.queue.end(), thread->priority.load(), type::KThread::IsHigherPriority)};
-        if (nextThread == core.queue.begin()) {
-            if (nextThread != core.queue.end()) {
+        auto currentFront{core.queue.Front()};
+        if (!currentFront || thread->priority < currentFront->priority) {
+            if (currentFront) {
                 // If the inserted thread has a higher priority than the currently running thread (and the queue isn't empty)
-                // We can yield the thread which is currently scheduled on the core by sending it a signal
-                // It is optimized to avoid waiting for the thread to yield on receiving the signal which serializes the entire pipeline
-                auto front{core.queue.front()};
+                // We can yield the thread which is currently scheduled on the core by requesting it to yield
+                // It is optimized to avoid waiting for the thread to yield on receiving the request which serializes the entire pipeline
+                auto front{core.queue.InsertFront(*thread)};
                 front->forceYield = true;
-                core.queue.splice(std::upper_bound(core.queue.begin(), core.queue.end(), front->priority.load(), type::KThread::IsHigherPriority), core.queue, core.queue.begin());
-                core.queue.push_front(thread);
 
-                if (state.thread != front) {
-                    // If the calling thread isn't at the front, we need to send it an OS signal to yield
+                if (state.thread.get() != front) {
+                    // If the calling thread isn't at the front, we need to request it to yield
                     if (!front->pendingYield) {
                         // We only want to yield the thread if it hasn't already been sent a signal to yield in the past
                         // Not doing this can lead to races and deadlocks but is also slower as it prevents redundant signals
-                        front->SendSignal(YieldSignal);
+                        front->RequestYield();
                         front->pendingYield = true;
                     }
                 } else {
@@ -120,25 +363,26 @@ namespace skyline::kernel {
                     YieldPending = true;
                 }
             } else {
-                core.queue.push_front(thread);
+                core.queue.Insert(*thread);
             }
             if (thread != state.thread)
                 thread->scheduleCondition.notify_one(); // We only want to trigger the conditional variable if the current thread isn't inserting itself
         } else {
-            core.queue.insert(nextThread, thread);
+            core.queue.Insert(*thread);
+
+            // A preemptive thread at the front of the core won't have its preemption timer armed in adaptive mode if it had no competition when it was scheduled
+            if (currentFront->priority == core.preemptionPriority && thread->priority == currentFront->priority && !currentFront->isPreempted)
+                ArmPreemptionTimer(*currentFront, core);
         }
     }
 
     void Scheduler::MigrateToCore(const std::shared_ptr<type::KThread> &thread, CoreContext *&currentCore, CoreContext *targetCore, std::unique_lock<std::mutex> &lock) {
         // We need to check if the thread was in its resident core's queue
         // If it was, we need to remove it from the queue
-        auto it{std::find(currentCore->queue.begin(), currentCore->queue.end(), thread)};
-        bool wasInserted{it != currentCore->queue.end()};
-        if (wasInserted) {
-            it = currentCore->queue.erase(it);
-            if (it == currentCore->queue.begin() && it != currentCore->queue.end())
-                (*it)->scheduleCondition.notify_one();
-        }
+        bool wasInserted{currentCore->queue.Contains(*thread)};
+        if (wasInserted && currentCore->queue.Erase(*thread))
+            if (auto front{currentCore->queue.Front()})
+                front->scheduleCondition.notify_one();
         lock.unlock();
 
         thread->coreId = targetCore->id;
@@ -156,6 +400,13 @@ namespace skyline::kernel {
         std::unique_lock lock(core->mutex);
 
         auto wakeFunction{[&]() {
+            if (thread->coreId != core->id) [[unlikely]] {
+                // The thread was stolen by another core while it was waiting, we need to wait on that core instead
+                lock.unlock();
+                core = &cores.at(thread->coreId);
+                lock = std::unique_lock(core->mutex);
+            }
+
             if (!thread->affinityMask.test(thread->coreId)) [[unlikely]] {
                 lock.unlock(); // If the core migration mutex is locked by a thread seeking the core mutex, it'll result in a deadlock
                 std::scoped_lock migrationLock{thread->coreMigrationMutex};
@@ -163,12 +414,12 @@ namespace skyline::kernel {
                 if (!thread->affinityMask.test(thread->coreId)) // We need to retest in case the thread was migrated while the core was unlocked
                     MigrateToCore(thread, core, &cores.at(thread->idealCore), lock);
             }
-            return !core->queue.empty() && core->queue.front() == thread;
+            return core->queue.Front() == thread.get();
         }};
 
         TRACE_EVENT("scheduler", "WaitSchedule");
         if (loadBalance) {
-            std::chrono::milliseconds loadBalanceThreshold{PreemptiveTimeslice * 2}; //!< The amount of time that needs to pass unscheduled for a thread to attempt load balancing
+            std::chrono::milliseconds loadBalanceThreshold{*state.settings->preemptionTimeslice * 2}; //!< The amount of time that needs to pass unscheduled for a thread to attempt load balancing
             while (!thread->scheduleCondition.wait_for(lock, loadBalanceThreshold, wakeFunction)) {
                 lock.unlock(); // We cannot call GetOptimalCoreForThread without relinquishing the core mutex
                 std::scoped_lock migrationLock{thread->coreMigrationMutex};
@@ -183,11 +434,7 @@ namespace skyline::kernel {
             thread->scheduleCondition.wait(lock, wakeFunction);
         }
 
-        if (thread->priority == core->preemptionPriority)
-            // If the thread needs to be preempted then arm its preemption timer
-            thread->ArmPreemptionTimer(PreemptiveTimeslice);
-
-        thread->timesliceStart = util::GetTimeTicks();
+        StartTimeslice(*thread, *core);
     }
 
     bool Scheduler::TimedWaitSchedule(std::chrono::nanoseconds timeout) {
@@ -197,17 +444,19 @@ namespace skyline::kernel {
         TRACE_EVENT("scheduler", "TimedWaitSchedule");
         std::unique_lock lock(core->mutex);
         if (thread->scheduleCondition.wait_for(lock, timeout, [&]() {
+            if (thread->coreId != core->id) [[unlikely]] {
+                lock.unlock();
+                core = &cores.at(thread->coreId);
+                lock = std::unique_lock(core->mutex);
+            }
+
             if (!thread->affinityMask.test(thread->coreId)) [[unlikely]] {
                 std::scoped_lock migrationLock{thread->coreMigrationMutex};
                 MigrateToCore(thread, core, &cores.at(thread->idealCore), lock);
             }
-            return !core->queue.empty() && core->queue.front() == thread;
+            return core->queue.Front() == thread.get();
         })) {
-            if (thread->priority == core->preemptionPriority)
-                thread->ArmPreemptionTimer(PreemptiveTimeslice);
-
-            thread->timesliceStart = util::GetTimeTicks();
-
+            StartTimeslice(*thread, *core);
             return true;
         } else {
             return false;
@@ -220,47 +469,62 @@ namespace skyline::kernel {
 
         std::unique_lock lock(core.mutex);
 
-        if (core.queue.front() == thread) {
+        if (core.queue.Front() == thread.get()) {
             // If this thread is at the front of the thread queue then we need to rotate the thread
             // In the case where this thread was forcefully yielded, we don't need to do this as it's done by the thread which yielded to this thread
-            // Splice the linked element from the beginning of the queue to where its priority is present
-            core.queue.splice(std::upper_bound(core.queue.begin(), core.queue.end(), thread->priority.load(), type::KThread::IsHigherPriority), core.queue, core.queue.begin());
+            // The thread is moved behind all other threads with the same priority and the highest priority thread is brought to the front
+            core.queue.Rotate();
 
-            auto &front{core.queue.front()};
-            if (front != thread)
+            auto front{core.queue.Front()};
+            if (front != thread.get())
                 front->scheduleCondition.notify_one(); // If we aren't at the front of the queue, only then should we wake the thread at the front up
         } else if (!thread->forceYield) {
             throw exception("T{} called Rotate while not being in C{}'s queue", thread->id, thread->coreId);
         }
 
         thread->averageTimeslice = (thread->averageTimeslice / 4) + (3 * (util::GetTimeTicks() - thread->timesliceStart / 4));
+        if (thread->timesliceStart)
+            AccountTimeslice(core, *thread, util::GetTimeTicks() - thread->timesliceStart);
+
+        thread->statistics.yieldCount++;
+        TRACE_EVENT_INSTANT("scheduler", "Yield", "forced", thread->forceYield, "waiting", core.queue.WaitingCount());
 
         thread->DisarmPreemptionTimer(); // If a preemptive thread did a cooperative yield then we need to disarm the preemptive timer
         thread->pendingYield = false;
+        thread->ctx.yieldPending.store(false, std::memory_order_relaxed);
         thread->forceYield = false;
     }
 
     void Scheduler::RemoveThread() {
         auto &thread{state.thread};
         auto &core{cores.at(thread->coreId)};
+        bool coreIdle{};
         {
             std::unique_lock lock(core.mutex);
-            auto it{std::find(core.queue.begin(), core.queue.end(), thread)};
-            if (it != core.queue.end()) {
-                it = core.queue.erase(it);
-                if (it == core.queue.begin()) {
-                    // We need to update the averageTimeslice accordingly, if we've been unscheduled by this
-                    if (thread->timesliceStart)
-                        thread->averageTimeslice = (thread->averageTimeslice / 4) + (3 * (util::GetTimeTicks() - thread->timesliceStart / 4));
-
-                    if (it != core.queue.end())
-                        (*it)->scheduleCondition.notify_one(); // We need to wake the thread at the front of the queue, if we were at the front previously
+            if (core.queue.Contains(*thread) && core.queue.Erase(*thread)) {
+                // We need to update the averageTimeslice accordingly, if we've been unscheduled by this
+                if (thread->timesliceStart) {
+                    thread->averageTimeslice = (thread->averageTimeslice / 4) + (3 * (util::GetTimeTicks() - thread->timesliceStart / 4));
+                    AccountTimeslice(core, *thread, util::GetTimeTicks() - thread->timesliceStart);
                 }
+
+                thread->statistics.blockCount++;
+                TRACE_EVENT_INSTANT("scheduler", "Block", "core", core.id);
+
+                if (auto front{core.queue.Front()})
+                    front->scheduleCondition.notify_one(); // We need to wake the thread at the front of the queue, if we were at the front previously
+                else
+                    coreIdle = true;
             }
         }
 
+        if (coreIdle)
+            // If the core has nothing left to run then we can pull a waiting thread from another core onto it
+            StealThread(core);
+
         thread->DisarmPreemptionTimer();
         thread->pendingYield = false;
+        thread->ctx.yieldPending.store(false, std::memory_order_relaxed);
         thread->forceYield = false;
         YieldPending = false;
     }
@@ -270,37 +534,32 @@ namespace skyline::kernel {
         auto *core{&cores.at(thread->coreId)};
         std::unique_lock coreLock(core->mutex);
 
-        auto currentIt{std::find(core->queue.begin(), core->queue.end(), thread)}, nextIt{std::next(currentIt)};
-        if (currentIt == core->queue.end()) {
+        if (!core->queue.Contains(*thread)) {
             return;
-        } else if (currentIt == core->queue.begin()) {
+        } else if (core->queue.Front() == thread.get()) {
             // Alternatively, if it's currently running then we'd just want to yield if there's a higher priority thread to run instead
-            if (nextIt != core->queue.end() && (*nextIt)->priority < thread->priority) {
+            auto nextThread{core->queue.Next()};
+            if (nextThread && nextThread->priority < thread->priority) {
                 if (!thread->pendingYield) {
-                    thread->SendSignal(YieldSignal);
+                    thread->RequestYield();
                     thread->pendingYield = true;
                 }
             } else if (!thread->isPreempted && thread->priority == core->preemptionPriority) {
                 // If the thread needs to be preempted due to its new priority then arm its preemption timer
-                thread->ArmPreemptionTimer(PreemptiveTimeslice);
+                ArmPreemptionTimer(*thread, *core);
             } else if (thread->isPreempted && thread->priority != core->preemptionPriority) {
                 // If the thread no longer needs to be preempted due to its new priority then disarm its preemption timer
                 thread->DisarmPreemptionTimer();
             }
-        } else if (thread->priority < (*std::prev(currentIt))->priority || (nextIt != core->queue.end() && thread->priority > (*nextIt)->priority)) {
-            // If the thread is in the queue and it's position is affected by the priority change then need to remove and re-insert the thread
-            core->queue.erase(currentIt);
-
-            auto targetIt{std::upper_bound(core->queue.begin(), core->queue.end(), thread->priority.load(), type::KThread::IsHigherPriority)};
-            if (targetIt == core->queue.begin() && targetIt != core->queue.end()) {
-                core->queue.insert(std::next(core->queue.begin()), thread);
-                auto front{core->queue.front()};
-                if (!front->pendingYield) {
-                    front->SendSignal(YieldSignal);
-                    front->pendingYield = true;
-                }
-            } else {
-                core->queue.insert(targetIt, thread);
+        } else if (thread->priority != thread->queuedPriority) {
+            // If the thread is in the queue and its priority level has changed then it needs to be moved to the new level
+            core->queue.Requeue(*thread);
+
+            // The front thread retains its position but it should yield if the thread now has a higher priority than it
+            auto front{core->queue.Front()};
+            if (thread->priority < front->priority && !front->pendingYield) {
+                front->RequestYield();
+                front->pendingYield = true;
             }
         }
     }
@@ -308,8 +567,8 @@ namespace skyline::kernel {
     void Scheduler::UpdateCore(const std::shared_ptr<type::KThread> &thread) {
         auto *core{&cores.at(thread->coreId)};
         std::scoped_lock coreLock{core->mutex};
-        if (core->queue.front() == thread)
-            thread->SendSignal(YieldSignal);
+        if (core->queue.Front() == thread.get())
+            thread->RequestYield();
         else
             thread->scheduleCondition.notify_one();
     }
@@ -322,13 +581,19 @@ namespace skyline::kernel {
         auto originalCoreId{thread->coreId};
         thread->coreId = constant::ParkedCoreId;
         for (auto &core : cores)
-            if (originalCoreId != core.id && thread->affinityMask.test(core.id) && (core.queue.empty() || core.queue.front()->priority > thread->priority))
+            if (originalCoreId != core.id && thread->affinityMask.test(core.id) && (core.queue.Empty() || core.queue.Front()->priority > thread->priority))
                 thread->coreId = core.id;
 
         if (thread->coreId == constant::ParkedCoreId) {
+            TRACE_EVENT("scheduler", "Parked");
+            u64 parkStart{util::GetTimeTicks()};
+
             std::unique_lock lock(parkedMutex);
             parkedQueue.insert(std::upper_bound(parkedQueue.begin(), parkedQueue.end(), thread->priority.load(), type::KThread::IsHigherPriority), thread);
             thread->scheduleCondition.wait(lock, [&]() { return parkedQueue.front() == thread && thread->coreId != constant::ParkedCoreId; });
+
+            thread->statistics.parkTicks += util::GetTimeTicks() - parkStart;
+            thread->statistics.parkCount++;
         }
 
         InsertThread(thread);
@@ -340,8 +605,9 @@ namespace skyline::kernel {
             auto &thread{state.thread};
             auto &core{cores.at(thread->coreId)};
             std::unique_lock coreLock(core.mutex);
-            auto nextThread{core.queue.size() > 1 ? *std::next(core.queue.begin()) : nullptr};
-            nextThread = nextThread->priority == thread->priority ? nextThread : nullptr; // If the next thread doesn't have the same priority then it won't be scheduled next
+            auto nextThread{core.queue.Next()};
+            if (nextThread && nextThread->priority != thread->priority)
+                nextThread = nullptr; // If the next thread doesn't have the same priority then it won't be scheduled next
             auto parkedThread{parkedQueue.front()};
 
             // We need to be conservative about waking up a parked thread, it should only be done if its priority is higher than the current thread
@@ -360,19 +626,19 @@ namespace skyline::kernel {
 
         thread->isPaused = true;
 
-        auto it{std::find(core->queue.begin(), core->queue.end(), thread)};
-        if (it != core->queue.end()) {
+        if (core->queue.Contains(*thread)) {
             thread->insertThreadOnResume = true; // If we're handling removing the thread then we need to be responsible for inserting it back inside ResumeThread
 
-            it = core->queue.erase(it);
-            if (it == core->queue.begin() && it != core->queue.end())
-                (*it)->scheduleCondition.notify_one();
+            if (core->queue.Erase(*thread)) {
+                if (auto front{core->queue.Front()})
+                    front->scheduleCondition.notify_one();
 
-            if (it == core->queue.begin() && !thread->pendingYield) {
-                // We need to send a yield signal to the thread if it's currently running
-                thread->SendSignal(YieldSignal);
-                thread->pendingYield = true;
-                thread->forceYield = true;
+                if (!thread->pendingYield) {
+                    // We need to request the thread to yield if it's currently running
+                    thread->RequestYield();
+                    thread->pendingYield = true;
+                    thread->forceYield = true;
+                }
             }
         } else {
             // If removal of the thread was performed by a lock/sleep/etc then we don't need to handle inserting it back ourselves inside ResumeThread
@@ -3,6 +3,8 @@
 
 #pragma once
 
+#include <sched.h>
+#include <boost/intrusive/list.hpp>
 #include <common.h>
 #include <condition_variable>
 
@@ -35,6 +37,112 @@ namespace skyline {
             }
         };
 
+        /**
+         * @brief The intrusive hook of a thread in a scheduler queue, this avoids any allocations when threads are inserted or moved in a queue
+         */
+        struct ThreadQueueHook : public boost::intrusive::list_base_hook<> {
+            i8 queuedPriority{}; //!< The priority level which the thread is queued at, this can differ from its current priority till the queue has been updated
+            u64 queuedTimestamp{}; //!< A timestamp in host CNTVCT ticks of when the thread was last inserted into a queue, this is used to determine how long it waited to be scheduled
+        };
+
+        /**
+         * @brief A queue of threads which are running or to be run on a single core, it has a FIFO for every priority level with a bitmap of the non-empty levels which allows for O(1) insertion and selection of the next thread
+         * @note The front of the queue is the thread which is scheduled on the core, it's tracked separately from the priority levels as it retains its position while it's being yielded even if a higher priority thread has been inserted
+         * @note Threads aren't owned by the queue, they're required to remove themselves from it prior to being destroyed
+         */
+        class ThreadQueue {
+          private:
+            using LevelList = boost::intrusive::list<type::KThread, boost::intrusive::base_hook<boost::intrusive::list_base_hook<>>, boost::intrusive::constant_time_size<false>>;
+
+            std::array<LevelList, std::numeric_limits<u64>::digits> levels; //!< A FIFO of threads for every priority level, excluding the front thread
+            u64 presentLevels{}; //!< A bitmap of all priority levels that contain at least a single thread
+            std::atomic<u32> waitingCount{}; //!< The amount of threads behind the front thread, this can be read without locking the queue as a hint
+            type::KThread *front{}; //!< The thread at the front of the queue
+
+            /**
+             * @brief Inserts the thread at the back of the FIFO for its current priority
+             */
+            void PushBack(type::KThread &thread);
+
+            /**
+             * @brief Removes the thread from the FIFO of the priority it was queued at
+             */
+            void Unlink(type::KThread &thread);
+
+            /**
+             * @brief Removes the first thread of the highest priority level from its FIFO
+             * @return The removed thread or nullptr if all levels are empty
+             */
+            type::KThread *PopNext();
+
+          public:
+            bool Empty() const {
+                return front == nullptr;
+            }
+
+            /**
+             * @return The thread at the front of the queue or nullptr if the queue is empty
+             */
+            type::KThread *Front() const {
+                return front;
+            }
+
+            /**
+             * @return The highest priority thread behind the front thread, this is the thread that'll be scheduled next or nullptr if there is none
+             */
+            type::KThread *Next();
+
+            /**
+             * @return The amount of threads behind the front thread
+             */
+            u32 WaitingCount() const {
+                return waitingCount.load(std::memory_order_relaxed);
+            }
+
+            bool Contains(const type::KThread &thread) const;
+
+            /**
+             * @return The highest priority thread behind the front thread for which the supplied predicate returns true or nullptr if there is none
+             * @note This is defined in the scheduler's translation unit for the same reason as ForEachUpTo
+             */
+            template<typename Predicate>
+            type::KThread *FindNext(Predicate predicate);
+
+            /**
+             * @brief Inserts the thread at the front of the queue if it's empty, otherwise behind all other threads with the same priority
+             */
+            void Insert(type::KThread &thread);
+
+            /**
+             * @brief Inserts the thread at the front of the queue, the prior front thread is moved behind all other threads with the same priority
+             * @return The prior front thread, the queue must not be empty
+             */
+            type::KThread *InsertFront(type::KThread &thread);
+
+            /**
+             * @brief Moves the front thread behind all other threads with the same priority and brings the highest priority thread to the front
+             */
+            void Rotate();
+
+            /**
+             * @brief Removes the thread from the queue, if it was at the front then the highest priority thread is brought to the front
+             * @return If the thread was at the front of the queue
+             */
+            bool Erase(type::KThread &thread);
+
+            /**
+             * @brief Moves a queued thread that isn't at the front behind all other threads with its current priority
+             */
+            void Requeue(type::KThread &thread);
+
+            /**
+             * @brief Calls the supplied function on every thread behind the front thread with a priority higher than or equal to the supplied one
+             * @note This is defined in the scheduler's translation unit as it's the only user and KThread is incomplete here
+             */
+            template<typename Function>
+            void ForEachUpTo(i8 priority, Function function) const;
+        };
+
         /**
          * @brief The Scheduler is responsible for determining which threads should run on which virtual cores and when they should be scheduled
          * @note We tend to stray a lot from HOS in our scheduler design as we've designed it around our 1 host thread per guest thread which leads to scheduling from the perspective of threads while the HOS scheduler deals with scheduling from the perspective of cores, not doing this would lead to missing out on key optimizations and serialization of scheduling
@@ -47,7 +155,14 @@ namespace skyline {
                 u8 id;
                 i8 preemptionPriority; //!< The priority at which this core becomes preemptive as opposed to cooperative
                 std::mutex mutex; //!< Synchronizes all operations on the queue
-                std::list<std::shared_ptr<type::KThread>> queue; //!< A queue of threads which are running or to be run on this core
+                ThreadQueue queue; //!< A queue of threads which are running or to be run on this core
+                cpu_set_t hostCpus; //!< The set of host CPUs that the host threads of guest threads scheduled on this core are pinned to, this is empty if no pinning should occur
+
+                u64 busyTicks{}; //!< The amount of ticks that threads have been scheduled on this core for during the current utilisation window
+                u64 utilisationWindowStart{}; //!< A timestamp in host CNTVCT ticks of when the current utilisation window started
+                std::atomic<float> utilisation{}; //!< The fraction of time that threads were scheduled on this core during the last utilisation window
+
+                std::chrono::nanoseconds preemptiveTimeslice{}; //!< The duration of time a preemptive thread can run on this core before yielding, this is only adjusted in adaptive mode
 
                 CoreContext(u8 id, i8 preemptionPriority);
             };
@@ -64,14 +179,59 @@ namespace skyline {
              */
             void MigrateToCore(const std::shared_ptr<type::KThread> &thread, CoreContext *&currentCore, CoreContext *targetCore, std::unique_lock<std::mutex> &lock);
 
+            /**
+             * @brief Pins the host thread of the calling thread to the host CPUs of the supplied core, if it isn't already pinned to them
+             * @note This must be called by the thread itself after it has been scheduled on the core
+             */
+            void UpdateHostAffinity(type::KThread &thread, CoreContext &core);
+
+            /**
+             * @brief Accounts a timeslice which has ended towards the utilisation of the core and the statistics of the thread, utilisation is reported as a trace counter for every utilisation window
+             * @note 'CoreContext::mutex' **must** be locked by the calling thread prior to calling this
+             */
+            void AccountTimeslice(CoreContext &core, type::KThread &thread, u64 timeslice);
+
+            /**
+             * @brief Starts the timeslice of a thread which was just scheduled on the core by arming its preemption timer and pinning it to the core's host CPUs
+             * @note 'CoreContext::mutex' **must** be locked by the calling thread prior to calling this
+             */
+            void StartTimeslice(type::KThread &thread, CoreContext &core);
+
+            /**
+             * @brief Migrates the highest priority waiting thread that can run on the supplied idle core from the core with the most waiting threads to it
+             * @note No core mutexes should be held by the calling thread
+             * @note This is used to avoid leaving a core idle while threads are waiting on other cores, rather than waiting for them to be load balanced after their timeout
+             */
+            void StealThread(CoreContext &idleCore);
+
+            /**
+             * @brief Adjusts the preemptive timeslice of the core in adaptive mode based on how long the supplied preemptive thread waited to be scheduled
+             * @note The timeslice is shortened when the thread was starved by other threads and is gradually restored to the configured timeslice otherwise
+             * @note 'CoreContext::mutex' **must** be locked by the calling thread prior to calling this
+             */
+            void UpdatePreemptiveTimeslice(type::KThread &thread, CoreContext &core);
+
+            /**
+             * @brief Arms the preemption timer of a preemptive thread at the front of the core with the core's preemptive timeslice
+             * @note In adaptive mode, the timer isn't armed if there are no other threads with the same priority on the core as preemption would just reschedule the same thread, it's armed by InsertThread once there is competition instead
+             * @note 'CoreContext::mutex' **must** be locked by the calling thread prior to calling this
+             */
+            void ArmPreemptionTimer(type::KThread &thread, CoreContext &core);
+
           public:
-            static constexpr std::chrono::milliseconds PreemptiveTimeslice{10}; //!< The duration of time a preemptive thread can run before yielding
             inline static int YieldSignal{SIGRTMIN}; //!< The signal used to cause a non-cooperative yield in running threads
             inline static int PreemptionSignal{SIGRTMIN + 1}; //!< The signal used to cause a preemptive yield in running threads
             inline static thread_local bool YieldPending{}; //!< A flag denoting if a yield is pending on this thread, it's checked prior to entering guest code as signals cannot interrupt host code
 
             Scheduler(const DeviceState &state);
 
+            /**
+             * @return The fraction of time that threads were scheduled on the supplied core during the last utilisation window
+             */
+            float GetCoreUtilisation(u8 coreId) {
+                return cores.at(coreId).utilisation.load(std::memory_order_relaxed);
+            }
+
             /**
              * @brief A signal handler designed to cause a non-cooperative yield for preemption and higher priority threads being inserted
              */
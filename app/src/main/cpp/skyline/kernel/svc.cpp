@@ -115,7 +115,7 @@ namespace skyline::kernel::svc {
         }
 
         state.process->NewHandle<type::KPrivateMemory>(span<u8>{destination, size}, chunk->permission, memory::states::Stack);
-        std::memcpy(destination, source, size);
+        state.process->memory.AliasMemory(span<u8>{destination, size}, source, chunk->permission); // The source's memory is mapped at the destination rather than being copied to it, as on HOS both ranges share the same physical memory
 
         auto object{state.process->GetMemoryObject(source)};
         if (!object)
@@ -170,7 +170,7 @@ namespace skyline::kernel::svc {
 
         destObject->item->UpdatePermission(span<u8>{destination, size}, sourceChunk->permission);
 
-        std::memcpy(source, destination, size);
+        state.process->memory.UnaliasMemory(span<u8>{source, size}); // Any writes to the stack mapping were done directly to the memory of the original mapping, so there's nothing to copy back
 
         auto sourceObject{state.process->GetMemoryObject(source)};
         if (!sourceObject)
@@ -607,26 +607,25 @@ namespace skyline::kernel::svc {
     }
 
     void WaitSynchronization(const DeviceState &state) {
-        constexpr u8 maxSyncHandles{0x40}; // The total amount of handles that can be passed to WaitSynchronization
-
         u32 numHandles{state.ctx->gpr.w2};
-        if (numHandles > maxSyncHandles) {
+        if (numHandles > constant::MaxSyncHandles) {
             state.ctx->gpr.w0 = result::OutOfRange;
             return;
         }
 
         span waitHandles(reinterpret_cast<KHandle *>(state.ctx->gpr.x1), numHandles);
-        std::vector<std::shared_ptr<type::KSyncObject>> objectTable;
-        objectTable.reserve(numHandles);
+        std::array<std::shared_ptr<type::KSyncObject>, constant::MaxSyncHandles> objectStorage; // References to the objects are held on the stack to avoid allocating a vector for every wait
+        span objectTable{objectStorage.data(), numHandles};
 
-        for (const auto &handle : waitHandles) {
+        for (size_t index{}; index < numHandles; index++) {
+            auto handle{waitHandles[index]};
             auto object{state.process->GetHandle(handle)};
             switch (object->objectType) {
                 case type::KType::KProcess:
                 case type::KType::KThread:
                 case type::KType::KEvent:
                 case type::KType::KSession:
-                    objectTable.push_back(std::static_pointer_cast<type::KSyncObject>(object));
+                    objectTable[index] = std::static_pointer_cast<type::KSyncObject>(object);
                     break;
 
                 default: {
@@ -647,11 +646,13 @@ namespace skyline::kernel::svc {
             Logger::Debug("Waiting on handles:\n{}Timeout: {}ns", handleString, timeout);
         }
 
-        TRACE_EVENT_FMT("kernel", waitHandles.size() == 1 ? "WaitSynchronization 0x{:X}" : "WaitSynchronizationMultiple 0x{:X}", waitHandles[0]);
+        std::string traceHandles;
+        if (TRACE_EVENT_CATEGORY_ENABLED("kernel"))
+            for (const auto &handle : waitHandles)
+                traceHandles += fmt::format("0x{:X} ", handle);
+        TRACE_EVENT("kernel", perfetto::StaticString{waitHandles.size() == 1 ? "WaitSynchronization" : "WaitSynchronizationMultiple"}, "handles", traceHandles, "timeout", timeout);
 
-        std::unique_lock lock(type::KSyncObject::syncObjectMutex);
-        if (state.thread->cancelSync) {
-            state.thread->cancelSync = false;
+        if (state.thread->cancelSync.exchange(false)) {
             state.ctx->gpr.w0 = result::Cancelled;
             return;
         }
@@ -673,51 +674,81 @@ namespace skyline::kernel::svc {
             return;
         }
 
+        // The thread is removed from its core prior to being made cancellable as any thread that wakes it up will insert it back
+        state.thread->wakeObject = nullptr;
+        state.scheduler->RemoveThread();
+
+        // Each object has one of the thread's waiters linked into its list, this doesn't require any allocations and allows unlinking them in constant time
         auto priority{state.thread->priority.load()};
-        for (const auto &object : objectTable)
-            object->syncObjectWaiters.insert(std::upper_bound(object->syncObjectWaiters.begin(), object->syncObjectWaiters.end(), priority, type::KThread::IsHigherPriority), state.thread);
+        span waiters{state.thread->syncWaiters.data(), numHandles};
+        for (index = 0; index < numHandles; index++) {
+            auto &waiter{waiters[index]};
+            auto &object{objectTable[index]};
+            waiter.thread = state.thread.get();
+            waiter.object = object.get();
+
+            std::scoped_lock lock{object->syncObjectMutex};
+            auto &objectWaiters{object->syncObjectWaiters};
+            objectWaiters.insert(std::find_if(objectWaiters.begin(), objectWaiters.end(), [priority](const type::KSyncWaiter &it) {
+                return priority < it.thread->priority;
+            }), waiter);
+        }
 
         state.thread->isCancellable = true;
-        state.thread->wakeObject = nullptr;
-        state.scheduler->RemoveThread();
 
-        lock.unlock();
-        if (timeout > 0)
-            state.scheduler->TimedWaitSchedule(std::chrono::nanoseconds(timeout));
-        else
+        // Any signal or cancellation that occurred prior to the thread being made cancellable wouldn't have woken it up, so we need to check for them again and wake ourselves up
+        type::KSyncObject *signalledObject{};
+        for (const auto &object : objectTable) {
+            if (object->signalled) {
+                signalledObject = object.get();
+                break;
+            }
+        }
+
+        if (signalledObject || state.thread->cancelSync) {
+            bool cancellable{true};
+            if (state.thread->isCancellable.compare_exchange_strong(cancellable, false)) {
+                state.thread->wakeObject = signalledObject;
+                state.scheduler->InsertThread(state.thread);
+            }
+        }
+
+        bool timedOut{};
+        if (timeout > 0 && !state.scheduler->TimedWaitSchedule(std::chrono::nanoseconds(timeout))) {
+            // If the thread has been woken up concurrently with the timeout expiring then it's inserted back by the waking thread, we need to wait for that to happen
+            bool cancellable{true};
+            timedOut = state.thread->isCancellable.compare_exchange_strong(cancellable, false);
+            if (!timedOut)
+                state.scheduler->WaitSchedule(false);
+        } else if (timeout < 0) {
             state.scheduler->WaitSchedule(false);
-        lock.lock();
+        }
 
-        state.thread->isCancellable = false;
         auto wakeObject{state.thread->wakeObject};
 
         u32 wakeIndex{};
-        index = 0;
-        for (const auto &object : objectTable) {
-            if (object.get() == wakeObject)
+        for (index = 0; index < numHandles; index++) {
+            auto &waiter{waiters[index]};
+            if (waiter.object == wakeObject)
                 wakeIndex = index;
 
-            auto it{std::find(object->syncObjectWaiters.begin(), object->syncObjectWaiters.end(), state.thread)};
-            if (it != object->syncObjectWaiters.end())
-                object->syncObjectWaiters.erase(it);
-            else
+            std::scoped_lock lock{waiter.object->syncObjectMutex};
+            if (!waiter.is_linked())
                 throw exception("svcWaitSynchronization: An object (0x{:X}) has been removed from the syncObjectWaiters queue incorrectly", waitHandles[index]);
-
-            index++;
+            waiter.object->syncObjectWaiters.erase(waiter.object->syncObjectWaiters.iterator_to(waiter));
         }
 
         if (wakeObject) {
             Logger::Debug("Signalled 0x{:X}", waitHandles[wakeIndex]);
             state.ctx->gpr.w0 = Result{};
             state.ctx->gpr.w1 = wakeIndex;
-        } else if (state.thread->cancelSync) {
+        } else if (!timedOut) {
             state.thread->cancelSync = false;
             Logger::Debug("Wait has been cancelled");
             state.ctx->gpr.w0 = result::Cancelled;
         } else {
             Logger::Debug("Wait has timed out");
             state.ctx->gpr.w0 = result::TimedOut;
-            lock.unlock();
             state.scheduler->InsertThread(state.thread);
             state.scheduler->WaitSchedule();
         }
@@ -725,13 +756,13 @@ namespace skyline::kernel::svc {
 
     void CancelSynchronization(const DeviceState &state) {
         try {
-            std::unique_lock lock(type::KSyncObject::syncObjectMutex);
             auto thread{state.process->GetHandle<type::KThread>(state.ctx->gpr.w0)};
             thread->cancelSync = true;
-            if (thread->isCancellable) {
-                thread->isCancellable = false;
+
+            // This pairs with the thread checking for a cancellation after it has been made cancellable, at least one of the two will observe the other
+            bool cancellable{true};
+            if (thread->isCancellable.compare_exchange_strong(cancellable, false))
                 state.scheduler->InsertThread(thread);
-            }
             state.ctx->gpr.w0 = Result{};
         } catch (const std::out_of_range &) {
             Logger::Warn("'handle' invalid: 0x{:X}", static_cast<u32>(state.ctx->gpr.w0));
@@ -841,6 +872,8 @@ namespace skyline::kernel::svc {
     }
 
     void SendSyncRequest(const DeviceState &state) {
+        // The calling thread is removed from the scheduler for the duration of the request so other guest threads can run on its core while a service is handling it, this has the same effect as HOS blocking the client thread on the server session
+        // Services are handled on the calling host thread rather than a worker as handlers depend on the thread-local DeviceState (the calling thread, its context and TLS) of the client
         SchedulerScopedLock schedulerLock(state);
         state.os->serviceManager.SyncRequestHandler(static_cast<KHandle>(state.ctx->gpr.x0));
         state.ctx->gpr.w0 = Result{};
@@ -1065,6 +1098,7 @@ namespace skyline::kernel::svc {
 
         Logger::Debug("Unmapped physical memory at 0x{:X} - 0x{:X} (0x{:X})", pointer, pointer + size, size);
 
+        span<u8> unmapped{pointer, size};
         auto end{pointer + size};
         while (pointer < end) {
             auto chunk{state.process->memory.Get(pointer)};
@@ -1095,6 +1129,9 @@ namespace skyline::kernel::svc {
             }
         }
 
+        // The backing memory is released so the host footprint shrinks with the guest's, it'll be committed again on first touch and read as zeroes if the range is mapped again
+        state.process->memory.FreeMemory(unmapped);
+
         state.ctx->gpr.w0 = Result{};
     }
 
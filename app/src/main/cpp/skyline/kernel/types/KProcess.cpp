@@ -1,10 +1,16 @@
 // SPDX-License-Identifier: MPL-2.0
 // Copyright © 2020 Skyline Team and Contributors (https://github.com/skyline-emu/)
 
+#include <numeric>
+#include <linux/futex.h>
+#include <sys/syscall.h>
 #include <nce.h>
 #include <os.h>
 #include <common/trace.h>
+#include <common/boot_profile.h>
 #include <kernel/results.h>
+#include <kernel/svc.h>
+#include <kernel/scheduler.h>
 #include "KProcess.h"
 
 namespace skyline::kernel::type {
@@ -39,6 +45,7 @@ namespace skyline::kernel::type {
         std::scoped_lock guard{threadMutex};
         if (disableCreation)
             disableThreadCreation = true;
+        ResumeSuspendedThreads(); // Suspended threads can't be scheduled to handle being killed
         if (all) {
             for (const auto &thread : threads)
                 thread->Kill(join);
@@ -47,7 +54,75 @@ namespace skyline::kernel::type {
         }
     }
 
+    void KProcess::Suspend() {
+        std::scoped_lock guard{threadMutex};
+        if (suspended)
+            return;
+        suspended = true;
+
+        for (const auto &thread : threads) {
+            std::scoped_lock migrationLock{thread->coreMigrationMutex};
+            if (thread->running && !thread->isPaused) {
+                state.scheduler->PauseThread(thread);
+                suspendedThreads.push_back(thread);
+            }
+        }
+
+        Logger::Info("Suspended {} guest threads", suspendedThreads.size());
+    }
+
+    void KProcess::ResumeSuspendedThreads() {
+        if (!suspended)
+            return;
+        suspended = false;
+
+        for (const auto &thread : suspendedThreads) {
+            std::scoped_lock migrationLock{thread->coreMigrationMutex};
+            if (thread->isPaused)
+                state.scheduler->ResumeThread(thread);
+        }
+        suspendedThreads.clear();
+    }
+
+    void KProcess::Resume() {
+        std::scoped_lock guard{threadMutex};
+        ResumeSuspendedThreads();
+    }
+
+    void KProcess::SvcStatistics::Record(u64 ticks) {
+        count.fetch_add(1, std::memory_order_relaxed);
+        totalTicks.fetch_add(ticks, std::memory_order_relaxed);
+
+        u64 max{maxTicks.load(std::memory_order_relaxed)};
+        while (ticks > max && !maxTicks.compare_exchange_weak(max, ticks, std::memory_order_relaxed));
+    }
+
+    void KProcess::LogSvcStatistics() {
+        static_assert(svc::SvcTable.size() == SvcCount);
+        constexpr size_t LoggedSvcCount{16}; //!< The amount of SVCs with the highest total duration to log
+
+        std::array<u8, SvcCount> order;
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&](u8 a, u8 b) { return svcStatistics[a].totalTicks > svcStatistics[b].totalTicks; });
+
+        auto toUs{[](u64 ticks) { return (ticks * 1'000'000) / util::ClockFrequency; }};
+        std::string statistics;
+        for (u8 id : span(order).first(LoggedSvcCount)) {
+            auto &entry{svcStatistics[id]};
+            u64 count{entry.count.load(std::memory_order_relaxed)};
+            if (!count)
+                break;
+
+            u64 totalTicks{entry.totalTicks.load(std::memory_order_relaxed)};
+            statistics += fmt::format("\n* {} (0x{:X}): {} calls, {}us total, {}us average, {}us max", svc::SvcTable[id].name, id, count, toUs(totalTicks), toUs(totalTicks / count), toUs(entry.maxTicks.load(std::memory_order_relaxed)));
+        }
+
+        if (!statistics.empty())
+            Logger::Info("SVC statistics:{}", statistics);
+    }
+
     void KProcess::InitializeHeapTls() {
+        ScopedBootPhase bootPhase{BootProfile::Phase::MemorySetup};
         constexpr size_t DefaultHeapSize{0x200000};
         heap = std::make_shared<KPrivateMemory>(state, 0, span<u8>{state.process->memory.heap.data(), DefaultHeapSize}, memory::Permission{true, true, false}, memory::states::Heap);
         InsertItem(heap); // Insert it into the handle table so GetMemoryObject will contain it
@@ -57,6 +132,13 @@ namespace skyline::kernel::type {
     u8 *KProcess::AllocateTlsSlot() {
         std::scoped_lock lock{tlsMutex};
         u8 *slot;
+        if (!freeTlsSlots.empty()) {
+            slot = freeTlsSlots.back();
+            freeTlsSlots.pop_back();
+            std::memset(slot, 0, constant::TlsSlotSize); // Slots must be zeroed on reuse to match freshly reserved ones
+            return slot;
+        }
+
         for (auto &tlsPage : tlsPages)
             if ((slot = tlsPage->ReserveSlot()))
                 return slot;
@@ -67,6 +149,11 @@ namespace skyline::kernel::type {
         return tlsPage->ReserveSlot();
     }
 
+    void KProcess::FreeTlsSlot(u8 *slot) {
+        std::scoped_lock lock{tlsMutex};
+        freeTlsSlots.push_back(slot);
+    }
+
     std::shared_ptr<KThread> KProcess::CreateThread(void *entry, u64 argument, void *stackTop, std::optional<i8> priority, std::optional<u8> idealCore) {
         std::scoped_lock guard{threadMutex};
         if (disableThreadCreation)
@@ -75,24 +162,71 @@ namespace skyline::kernel::type {
             mainThreadStack = std::make_shared<KPrivateMemory>(state, 0, span<u8>{state.process->memory.stack.data(), state.process->npdm.meta.mainThreadStackSize}, memory::Permission{true, true, false}, memory::states::Stack);
             stackTop = mainThreadStack->guest.end().base();
         }
-        auto thread{NewHandle<KThread>(this, threads.size(), entry, argument, stackTop, priority ? *priority : state.process->npdm.meta.mainThreadPriority, idealCore ? *idealCore : state.process->npdm.meta.idealCore).item};
+
+        // Threads which have exited and are only referenced by us can't be used by the guest anymore, they're released here so their host resources aren't retained for the lifetime of the process
+        // The main thread is never released as it's used to identify the process for killing it
+        if (!threads.empty())
+            threads.erase(std::remove_if(std::next(threads.begin()), threads.end(), [](const std::shared_ptr<KThread> &thread) {
+                std::scoped_lock lock{thread->statusMutex};
+                return thread.use_count() == 1 && !thread->running;
+            }), threads.end());
+
+        auto thread{NewHandle<KThread>(this, nextThreadId++, entry, argument, stackTop, priority ? *priority : state.process->npdm.meta.mainThreadPriority, idealCore ? *idealCore : state.process->npdm.meta.idealCore).item};
         threads.push_back(thread);
         return thread;
     }
 
+    KHandle KProcess::ReserveHandle(KType objectType) {
+        KHandle index;
+        if (handleFreeHead != NoFreeHandle) {
+            index = handleFreeHead;
+            handleFreeHead = handles[index].nextFree;
+        } else if (handleCount < handles.size()) {
+            index = handleCount++;
+        } else {
+            throw exception("The handle table is full with {} handles", handles.size());
+        }
+
+        auto &entry{handles[index]};
+        entry.objectType = objectType;
+        entry.generation = static_cast<u16>((entry.generation % HandleGenerationMask) + 1);
+        return static_cast<KHandle>((static_cast<KHandle>(entry.generation) << HandleIndexBits) | index);
+    }
+
+    void KProcess::ReleaseReservedHandle(KHandle handle) {
+        // The generation was already advanced when reserving the slot, so the handle that was returned is stale from here on
+        auto index{static_cast<u16>(handle & HandleIndexMask)};
+        handles[index].nextFree = handleFreeHead;
+        handleFreeHead = index;
+    }
+
+    void KProcess::CloseHandle(KHandle handle) {
+        std::shared_ptr<KObject> object;
+        {
+            std::unique_lock lock(handleMutex);
+            auto &entry{GetHandleEntry(handle)};
+            if (!entry.object)
+                throw std::out_of_range(fmt::format("CloseHandle was called with a closed handle: 0x{:X}", handle));
+
+            object = std::move(entry.object); // The object is destroyed after the lock is released as its destructor might access the handle table
+            entry.nextFree = handleFreeHead;
+            handleFreeHead = static_cast<u16>(handle & HandleIndexMask);
+        }
+    }
+
     std::optional<KProcess::HandleOut<KMemory>> KProcess::GetMemoryObject(u8 *ptr) {
         std::shared_lock lock(handleMutex);
 
-        for (KHandle index{}; index < handles.size(); index++) {
-            auto &object{handles[index]};
-            if (object) {
-                switch (object->objectType) {
+        for (KHandle index{}; index < handleCount; index++) {
+            auto &entry{handles[index]};
+            if (entry.object) {
+                switch (entry.objectType) {
                     case type::KType::KPrivateMemory:
                     case type::KType::KSharedMemory:
                     case type::KType::KTransferMemory: {
-                        auto mem{std::static_pointer_cast<type::KMemory>(object)};
+                        auto mem{std::static_pointer_cast<type::KMemory>(entry.object)};
                         if (mem->guest.contains(ptr))
-                            return std::make_optional<KProcess::HandleOut<KMemory>>({mem, constant::BaseHandleIndex + index});
+                            return std::make_optional<KProcess::HandleOut<KMemory>>({mem, (static_cast<KHandle>(entry.generation) << HandleIndexBits) | index});
                     }
 
                     default:
@@ -104,11 +238,15 @@ namespace skyline::kernel::type {
     }
 
     void KProcess::ClearHandleTable() {
-        std::shared_lock lock(handleMutex);
-        handles.clear();
+        std::unique_lock lock(handleMutex);
+        for (auto &entry : span(handles).first(handleCount))
+            entry.object = nullptr;
+        handleCount = 0;
+        handleFreeHead = NoFreeHandle;
     }
 
     constexpr u32 HandleWaitersBit{1UL << 30}; //!< A bit which denotes if a mutex psuedo-handle has waiters or not
+    constexpr i64 MutexFutexTimeoutNs{50'000}; //!< The maximum duration to wait on a contended mutex with a host futex before blocking in the scheduler, this covers the short critical sections that most mutexes guard
 
     Result KProcess::MutexLock(u32 *mutex, KHandle ownerHandle, KHandle tag) {
         TRACE_EVENT_FMT("kernel", "MutexLock 0x{:X}", mutex);
@@ -123,6 +261,32 @@ namespace skyline::kernel::type {
             return result::InvalidHandle;
         }
 
+        if (owner->coreId != state.thread->coreId) {
+            // (Fast Path) The owner is likely running on another core and will release the mutex shortly, we wait on the mutex word directly with a host futex for a brief duration
+            // If the mutex is released while no threads are waiting on it in the kernel then it's cleared and can be acquired without involving the scheduler or priority inheritance
+            // This isn't done when the owner is on the same core as it can't run till the calling thread yields the core
+            u32 expected{ownerHandle | HandleWaitersBit}, value;
+            i64 deadline{util::GetTimeNs() + MutexFutexTimeoutNs};
+
+            mutexFutexWaiters.fetch_add(1); // This is sequentially consistent with the unlocking thread's store to the mutex, so either we observe the store or it observes us and wakes the futex
+            while ((value = __atomic_load_n(mutex, __ATOMIC_SEQ_CST)) == expected) {
+                i64 remaining{deadline - util::GetTimeNs()};
+                if (remaining <= 0)
+                    break;
+
+                timespec timeout{.tv_sec = 0, .tv_nsec = remaining};
+                syscall(SYS_futex, mutex, FUTEX_WAIT_PRIVATE, expected, &timeout, nullptr, 0);
+            }
+            mutexFutexWaiters.fetch_sub(1);
+
+            if (value != expected) {
+                // The guest will retry locking the mutex with its new owner if we couldn't acquire it here
+                if (value == 0 && __atomic_compare_exchange_n(mutex, &value, tag, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST))
+                    return {};
+                return result::InvalidCurrentMemory;
+            }
+        }
+
         bool isHighestPriority;
         {
             std::scoped_lock lock{owner->waiterMutex, state.thread->waiterMutex}; // We need to lock both mutexes at the same time as we mutate the owner and the current thread, the ordering of locks **must** match MutexUnlock to avoid deadlocks
@@ -213,6 +377,10 @@ namespace skyline::kernel::type {
         } else {
             __atomic_store_n(mutex, 0, __ATOMIC_SEQ_CST);
         }
+
+        if (mutexFutexWaiters.load())
+            // Any threads waiting on the mutex with a futex need to recheck it regardless of if it's been released or handed off
+            syscall(SYS_futex, mutex, FUTEX_WAKE_PRIVATE, std::numeric_limits<i32>::max(), nullptr, nullptr, 0);
     }
 
     Result KProcess::ConditionalVariableWait(u32 *key, u32 *mutex, KHandle tag, i64 timeout) {
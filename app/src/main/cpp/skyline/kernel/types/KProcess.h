@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include <common/pool_allocator.h>
 #include <vfs/npdm.h>
 #include "KThread.h"
 #include "KTransferMemory.h"
@@ -13,7 +14,7 @@ namespace skyline {
     namespace constant {
         constexpr u16 TlsSlotSize{0x200}; //!< The size of a single TLS slot
         constexpr u8 TlsSlots{constant::PageSize / TlsSlotSize}; //!< The amount of TLS slots in a single page
-        constexpr KHandle BaseHandleIndex{0xD000}; //!< The index of the base handle
+        constexpr size_t HandleTableCapacity{0x1000}; //!< The maximum amount of handles that can be open in a process at once, HOS limits this to 1024 but HLE memory mappings consume handles as well
     }
 
     namespace kernel::type {
@@ -28,12 +29,40 @@ namespace skyline {
             std::mutex threadMutex; //!< Synchronizes thread creation to prevent a race between thread creation and thread killing
             bool disableThreadCreation{}; //!< Whether to disable thread creation, we use this to prevent thread creation after all threads have been killed
             std::atomic_bool alreadyKilled{}; //!< If the process has already been killed prior so there's no need to redundantly kill it again
-            std::vector<std::shared_ptr<KThread>> threads;
+            std::vector<std::shared_ptr<KThread>> threads; //!< The main thread followed by all other threads which haven't both exited and been released by the guest
+            size_t nextThreadId{}; //!< The ID of the next thread to be created, these are never reused as threads are removed from 'threads' when they're released
+            std::vector<std::shared_ptr<KThread>> suspendedThreads; //!< The threads which were paused by Suspend and are resumed by Resume, threads paused by the guest are excluded so they stay paused
+            bool suspended{}; //!< If the process is currently suspended by the host
+
+            /**
+             * @brief Resumes all threads paused by Suspend if the process is suspended
+             * @note 'threadMutex' **must** be locked by the calling thread prior to calling this
+             */
+            void ResumeSuspendedThreads();
 
             using SyncWaiters = std::multimap<void *, std::shared_ptr<KThread>>;
             std::mutex syncWaiterMutex; //!< Synchronizes all mutations to the map to prevent races
             SyncWaiters syncWaiters; //!< All threads waiting on process-wide synchronization primitives (Atomic keys + Address Arbiter)
 
+            std::atomic<u32> mutexFutexWaiters{}; //!< The amount of threads briefly waiting on a mutex with a host futex prior to blocking in the scheduler, this allows unlocks to skip waking the futex
+
+          public:
+            /**
+             * @brief Aggregated counters for calls to a single SVC from all threads in the process, durations are in host CNTVCT ticks
+             */
+            struct SvcStatistics {
+                std::atomic<u64> count;
+                std::atomic<u64> totalTicks;
+                std::atomic<u64> maxTicks;
+
+                void Record(u64 ticks);
+            };
+
+            static constexpr size_t SvcCount{0x80}; //!< The amount of entries in svc::SvcTable
+            std::array<SvcStatistics, SvcCount> svcStatistics{};
+
+          private:
+
             /**
             * @brief The status of a single TLS page (A page is 4096 bytes on ARMv8)
             * Each TLS page has 8 slots, each 0x200 (512) bytes in size
@@ -57,13 +86,79 @@ namespace skyline {
             u8 *tlsExceptionContext{}; //!< A pointer to the TLS exception handling context slot
             std::mutex tlsMutex; //!< A mutex to synchronize allocation of TLS pages to prevent extra pages from being created
             std::vector<std::shared_ptr<TlsPage>> tlsPages; //!< All TLS pages allocated by this process
+            std::vector<u8 *> freeTlsSlots; //!< TLS slots which were released by exited threads, these are reused prior to reserving new slots from TLS pages
             std::shared_ptr<KPrivateMemory> mainThreadStack; //!< The stack memory of the main thread stack is owned by the KProcess itself
             std::shared_ptr<KPrivateMemory> heap;
             vfs::NPDM npdm;
 
           private:
+            /**
+             * @brief A single slot in the handle table, a handle encodes the index of its slot alongside the generation of the slot at the time the handle was created
+             * @note The generation is incremented whenever a slot is reused so that closed handles can't be used to access an object in the same slot later
+             */
+            struct HandleEntry {
+                std::shared_ptr<KObject> object;
+                KType objectType; //!< A copy of the type of the object, this avoids dereferencing it for type checks
+                u16 generation; //!< The generation of the slot, this is never 0 for a slot that has been used
+                u16 nextFree; //!< The index of the next slot in the free list, this is only valid while the slot is free
+            };
+
+            static constexpr u8 HandleIndexBits{15};
+            static constexpr KHandle HandleIndexMask{(1U << HandleIndexBits) - 1};
+            static constexpr u16 HandleGenerationMask{0x7FFF}; //!< Generations are 15-bit so bit 30 remains clear, it's used as the waiters bit in mutex handles
+            static constexpr u16 NoFreeHandle{std::numeric_limits<u16>::max()};
+            static_assert(constant::HandleTableCapacity <= HandleIndexMask);
+
             std::shared_mutex handleMutex;
-            std::vector<std::shared_ptr<KObject>> handles;
+            std::array<HandleEntry, constant::HandleTableCapacity> handles{};
+            u16 handleCount{}; //!< The amount of slots at the start of the table which have been used at least once, slots beyond this are free but aren't in the free list
+            u16 handleFreeHead{NoFreeHandle}; //!< The index of the first slot in the free list
+
+            /**
+             * @brief Reserves a free slot in the handle table for an object of the supplied type and returns the handle to it
+             * @note 'handleMutex' **must** be locked exclusively by the calling thread prior to calling this
+             */
+            KHandle ReserveHandle(KType objectType);
+
+            /**
+             * @brief Returns a slot reserved with ReserveHandle to the free list without an object ever being inserted into it, this is used if constructing the object failed
+             * @note 'handleMutex' **must** be locked exclusively by the calling thread prior to calling this
+             */
+            void ReleaseReservedHandle(KHandle handle);
+
+            /**
+             * @return The slot in the handle table that the handle refers to, the slot may be empty if the handle is stale
+             * @note 'handleMutex' **must** be locked by the calling thread prior to calling this
+             */
+            HandleEntry &GetHandleEntry(KHandle handle) {
+                KHandle index{handle & HandleIndexMask};
+                if (index >= handleCount || handles[index].generation != (handle >> HandleIndexBits)) [[unlikely]]
+                    throw std::out_of_range(fmt::format("GetHandle was called with an invalid handle: 0x{:X}", handle));
+                return handles[index];
+            }
+
+            /**
+             * @return The type of kernel object that the class corresponds to
+             */
+            template<typename objectClass>
+            static constexpr KType GetObjectType() {
+                if constexpr (std::is_same<objectClass, KThread>())
+                    return KType::KThread;
+                else if constexpr (std::is_same<objectClass, KProcess>())
+                    return KType::KProcess;
+                else if constexpr (std::is_same<objectClass, KSharedMemory>())
+                    return KType::KSharedMemory;
+                else if constexpr (std::is_same<objectClass, KTransferMemory>())
+                    return KType::KTransferMemory;
+                else if constexpr (std::is_same<objectClass, KPrivateMemory>())
+                    return KType::KPrivateMemory;
+                else if constexpr (std::is_same<objectClass, KSession>())
+                    return KType::KSession;
+                else if constexpr (std::is_same<objectClass, KEvent>())
+                    return KType::KEvent;
+                else
+                    static_assert(!sizeof(objectClass), "KProcess::GetObjectType couldn't determine object type");
+            }
 
           public:
             KProcess(const DeviceState &state);
@@ -80,6 +175,23 @@ namespace skyline {
              */
             void Kill(bool join, bool all = false, bool disableCreation = false);
 
+            /**
+             * @brief Pauses all running threads in the process till a corresponding call to Resume, this is used to stop the guest while the app is in the background
+             * @note This returns once all threads have been removed from their core's queue, threads that are running guest code yield asynchronously
+             */
+            void Suspend();
+
+            /**
+             * @brief Resumes all threads which were paused by a prior call to Suspend
+             */
+            void Resume();
+
+            /**
+             * @brief Logs the SVCs that the process spent the most time in alongside their call counts and latencies
+             * @note This is intended to be called at the end of the session, after all threads have exited
+             */
+            void LogSvcStatistics();
+
             /**
              * @brief This initializes the process heap and TLS Error Context slot pointer, it should be called prior to creating the first thread
              * @note This requires VMM regions to be initialized, it will map heap at an arbitrary location otherwise
@@ -91,6 +203,11 @@ namespace skyline {
              */
             u8 *AllocateTlsSlot();
 
+            /**
+             * @brief Releases a TLS slot allocated by AllocateTlsSlot for reuse by future threads
+             */
+            void FreeTlsSlot(u8 *slot);
+
             /**
              * @return A shared pointer to a KThread initialized with the specified values or nullptr, if thread creation has been disabled
              * @note The default values are for the main thread and will use values from the NPDM
@@ -116,13 +233,21 @@ namespace skyline {
             HandleOut<objectClass> NewHandle(objectArgs... args) {
                 std::unique_lock lock(handleMutex);
 
+                KHandle handle{ReserveHandle(GetObjectType<objectClass>())};
                 std::shared_ptr<objectClass> item;
-                if constexpr (std::is_same<objectClass, KThread>() || std::is_same<objectClass, KPrivateMemory>())
-                    item = std::make_shared<objectClass>(state, constant::BaseHandleIndex + handles.size(), args...);
-                else
-                    item = std::make_shared<objectClass>(state, args...);
-                handles.push_back(std::static_pointer_cast<KObject>(item));
-                return {item, static_cast<KHandle>((constant::BaseHandleIndex + handles.size()) - 1)};
+                // The handle is reserved prior to construction as some objects require it, the slot must be released if construction throws so it isn't leaked
+                try {
+                    // Kernel objects are allocated from per-size free lists as objects such as threads and events are frequently created and destroyed by titles
+                    if constexpr (std::is_same<objectClass, KThread>() || std::is_same<objectClass, KPrivateMemory>())
+                        item = std::allocate_shared<objectClass>(PoolAllocator<objectClass>{}, state, handle, args...);
+                    else
+                        item = std::allocate_shared<objectClass>(PoolAllocator<objectClass>{}, state, args...);
+                } catch (...) {
+                    ReleaseReservedHandle(handle);
+                    throw;
+                }
+                handles[handle & HandleIndexMask].object = item;
+                return {item, handle};
             }
 
             /**
@@ -133,59 +258,40 @@ namespace skyline {
             KHandle InsertItem(std::shared_ptr<objectClass> &item) {
                 std::unique_lock lock(handleMutex);
 
-                handles.push_back(std::static_pointer_cast<KObject>(item));
-                return static_cast<KHandle>((constant::BaseHandleIndex + handles.size()) - 1);
+                KHandle handle{ReserveHandle(item->objectType)};
+                handles[handle & HandleIndexMask].object = item;
+                return handle;
             }
 
+            /**
+             * @brief Retrieves the object that a handle refers to, this is checked to be of the requested type unless it's KObject
+             * @note std::out_of_range is thrown for invalid or closed handles
+             */
             template<typename objectClass = KObject>
             std::shared_ptr<objectClass> GetHandle(KHandle handle) {
-                std::shared_lock lock(handleMutex);
-
-                KType objectType;
                 if constexpr(std::is_same<objectClass, KThread>()) {
                     constexpr KHandle threadSelf{0xFFFF8000}; // The handle used by threads to refer to themselves
                     if (handle == threadSelf)
                         return state.thread;
-                    objectType = KType::KThread;
                 } else if constexpr(std::is_same<objectClass, KProcess>()) {
                     constexpr KHandle processSelf{0xFFFF8001}; // The handle used by threads in a process to refer to the process
                     if (handle == processSelf)
                         return state.process;
-                    objectType = KType::KProcess;
-                } else if constexpr(std::is_same<objectClass, KSharedMemory>()) {
-                    objectType = KType::KSharedMemory;
-                } else if constexpr(std::is_same<objectClass, KTransferMemory>()) {
-                    objectType = KType::KTransferMemory;
-                } else if constexpr(std::is_same<objectClass, KPrivateMemory>()) {
-                    objectType = KType::KPrivateMemory;
-                } else if constexpr(std::is_same<objectClass, KSession>()) {
-                    objectType = KType::KSession;
-                } else if constexpr(std::is_same<objectClass, KEvent>()) {
-                    objectType = KType::KEvent;
-                } else {
-                    throw exception("KProcess::GetHandle couldn't determine object type");
-                }
-                try {
-                    auto &item{handles.at(handle - constant::BaseHandleIndex)};
-                    if (item != nullptr && item->objectType == objectType)
-                        return std::static_pointer_cast<objectClass>(item);
-                    else if (item == nullptr)
-                        throw exception("GetHandle was called with a deleted handle: 0x{:X}", handle);
-                    else
-                        throw exception("Tried to get kernel object (0x{:X}) with different type: {} when object is {}", handle, objectType, item->objectType);
-                } catch (const std::out_of_range &) {
-                    throw std::out_of_range(fmt::format("GetHandle was called with an invalid handle: 0x{:X}", handle));
                 }
-            }
 
-            template<>
-            std::shared_ptr<KObject> GetHandle<KObject>(KHandle handle) {
                 std::shared_lock lock(handleMutex);
-                auto &item{handles.at(handle - constant::BaseHandleIndex)};
-                if (item != nullptr)
-                    return item;
-                else
-                    throw std::out_of_range(fmt::format("GetHandle was called with a deleted handle: 0x{:X}", handle));
+                auto &entry{GetHandleEntry(handle)};
+                if (!entry.object) [[unlikely]]
+                    throw std::out_of_range(fmt::format("GetHandle was called with a closed handle: 0x{:X}", handle));
+
+                if constexpr (std::is_same<objectClass, KObject>()) {
+                    return entry.object;
+                } else {
+                    constexpr KType objectType{GetObjectType<objectClass>()};
+                    if (entry.objectType != objectType) [[unlikely]]
+                        throw exception("Tried to get kernel object (0x{:X}) with different type: {} when object is {}", handle, objectType, entry.objectType);
+                    return std::static_pointer_cast<objectClass>(entry.object);
+                }
             }
 
             /**
@@ -196,11 +302,10 @@ namespace skyline {
             std::optional<HandleOut<KMemory>> GetMemoryObject(u8 *ptr);
 
             /**
-             * @brief Closes a handle in the handle table
+             * @brief Closes a handle in the handle table, its slot is reused by future handles
+             * @note std::out_of_range is thrown for invalid or already closed handles
              */
-            void CloseHandle(KHandle handle) {
-                handles.at(handle - constant::BaseHandleIndex) = nullptr;
-            }
+            void CloseHandle(KHandle handle);
 
             /**
              * @brief Clear the process handle table
@@ -16,8 +16,8 @@ namespace skyline::kernel::type {
     class KSession : public KSyncObject {
       public:
         std::shared_ptr<service::BaseService> serviceObject;
-        std::vector<std::shared_ptr<service::BaseService>> domains; //!< A vector of services that correspond to virtual handles
-        KHandle handleIndex{}; //!< The currently allocated handle index
+        std::mutex domainMutex; //!< Synchronizes accesses to the domain object table as requests on a single session can be made from multiple guest threads
+        std::vector<std::shared_ptr<service::BaseService>> domains; //!< The services in this domain indexed by their virtual handle, closed objects are left as nullptr so virtual handles are never reused
         bool isOpen{true}; //!< If the session is open or not
         bool isDomain{}; //!< If this is a domain session or not
 
@@ -33,8 +33,34 @@ namespace skyline::kernel::type {
          */
         KHandle ConvertDomain() {
             isDomain = true;
-            domains.push_back(serviceObject);
-            return handleIndex++;
+            return AddDomainObject(serviceObject);
+        }
+
+        /**
+         * @return The virtual handle of the service object in this domain
+         */
+        KHandle AddDomainObject(std::shared_ptr<service::BaseService> object) {
+            std::scoped_lock lock{domainMutex};
+            domains.push_back(std::move(object));
+            return static_cast<KHandle>(domains.size() - 1);
+        }
+
+        /**
+         * @return The service object corresponding to a virtual handle in this domain, this is nullptr if the object was closed
+         * @note std::out_of_range is thrown for virtual handles which were never allocated
+         */
+        std::shared_ptr<service::BaseService> GetDomainObject(KHandle id) {
+            std::scoped_lock lock{domainMutex};
+            return domains.at(id);
+        }
+
+        /**
+         * @brief Closes a virtual handle in this domain
+         * @return The service object that the virtual handle corresponded to
+         */
+        std::shared_ptr<service::BaseService> CloseDomainObject(KHandle id) {
+            std::scoped_lock lock{domainMutex};
+            return std::exchange(domains.at(id), nullptr);
         }
     };
 }
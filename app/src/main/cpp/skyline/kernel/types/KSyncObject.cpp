@@ -9,20 +9,17 @@ namespace skyline::kernel::type {
         std::scoped_lock lock{syncObjectMutex};
         signalled = true;
         for (auto &waiter : syncObjectWaiters) {
-            if (waiter->isCancellable) {
-                waiter->isCancellable = false;
-                waiter->wakeObject = this;
-                state.scheduler->InsertThread(waiter);
+            // A thread can be waiting on multiple objects which are signalled concurrently, only the first one to clear the flag wakes it
+            auto thread{waiter.thread};
+            bool cancellable{true};
+            if (thread->isCancellable.compare_exchange_strong(cancellable, false)) {
+                thread->wakeObject = this;
+                state.scheduler->InsertThread(thread->shared_from_this());
             }
         }
     }
 
     bool KSyncObject::ResetSignal() {
-        std::scoped_lock lock{syncObjectMutex};
-        if (signalled) [[likely]] {
-            signalled = false;
-            return true;
-        }
-        return false;
+        return signalled.exchange(false);
     }
 }
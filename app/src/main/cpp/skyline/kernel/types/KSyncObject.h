@@ -3,35 +3,53 @@
 
 #pragma once
 
+#include <boost/intrusive/list.hpp>
 #include "KObject.h"
 
-namespace skyline::kernel::type {
-    /**
-     * @brief KSyncObject is an abstract class which holds everything necessary for an object to be synchronizable
-     * @note This abstraction is roughly equivalent to KSynchronizationObject on HOS
-     */
-    class KSyncObject : public KObject {
-      public:
-        inline static std::mutex syncObjectMutex; //!< A global lock used for locking all signalling to avoid races
-        std::list<std::shared_ptr<KThread>> syncObjectWaiters; //!< A list of threads waiting on this object to be signalled
-        bool signalled; //!< If the current object is signalled (An object stays signalled till the signal has been explicitly reset)
+namespace skyline {
+    namespace constant {
+        constexpr u8 MaxSyncHandles{0x40}; //!< The total amount of handles that can be passed to WaitSynchronization
+    }
 
-        /**
-         * @param presignalled If this object should be signalled initially or not
-         */
-        KSyncObject(const DeviceState &state, skyline::kernel::type::KType type, bool presignalled = false) : KObject(state, type), signalled(presignalled) {};
+    namespace kernel::type {
+        class KSyncObject;
 
         /**
-         * @brief Wakes up any waiters on this object and flips the 'signalled' flag
+         * @brief A link between a waiting thread and one of the objects it's waiting on, every thread owns one of these for each handle it can wait on
+         * @note This is roughly equivalent to the entries of KThread::WaitObject on HOS, a wait links them into the objects in-place rather than allocating list nodes
          */
-        void Signal();
+        struct KSyncWaiter : public boost::intrusive::list_base_hook<> {
+            KThread *thread{}; //!< The thread which owns this waiter
+            KSyncObject *object{}; //!< The object being waited on, the waiting thread holds a reference to it for the duration of the wait
+        };
 
         /**
-         * @brief Resets the object to an unsignalled state
-         * @return If the signal was reset or not
+         * @brief KSyncObject is an abstract class which holds everything necessary for an object to be synchronizable
+         * @note This abstraction is roughly equivalent to KSynchronizationObject on HOS
          */
-        bool ResetSignal();
+        class KSyncObject : public KObject {
+          public:
+            std::mutex syncObjectMutex; //!< Synchronizes signalling of this object with mutation of its waiters, waking a thread is arbitrated by atomically clearing its 'isCancellable' flag rather than by a lock
+            boost::intrusive::list<KSyncWaiter, boost::intrusive::constant_time_size<false>> syncObjectWaiters; //!< An intrusive list of threads waiting on this object to be signalled sorted by priority
+            std::atomic<bool> signalled; //!< If the current object is signalled (An object stays signalled till the signal has been explicitly reset)
+
+            /**
+             * @param presignalled If this object should be signalled initially or not
+             */
+            KSyncObject(const DeviceState &state, skyline::kernel::type::KType type, bool presignalled = false) : KObject(state, type), signalled(presignalled) {};
+
+            /**
+             * @brief Wakes up any waiters on this object and flips the 'signalled' flag
+             */
+            void Signal();
+
+            /**
+             * @brief Resets the object to an unsignalled state
+             * @return If the signal was reset or not
+             */
+            bool ResetSignal();
 
-        virtual ~KSyncObject() = default;
-    };
+            virtual ~KSyncObject() = default;
+        };
+    }
 }
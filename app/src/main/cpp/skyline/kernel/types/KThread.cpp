@@ -48,12 +48,23 @@ namespace skyline::kernel::type {
             ctx.tpidrroEl0 = parent->AllocateTlsSlot();
 
         ctx.state = &state;
+        ctx.coreId = &coreId;
+        ctx.threadId = id;
         state.ctx = &ctx;
         state.thread = shared_from_this();
 
         if (setjmp(originalCtx)) { // Returns 1 if it's returning from guest, 0 otherwise
             state.scheduler->RemoveThread();
 
+            auto toUs{[](u64 ticks) { return (ticks * 1'000'000) / util::ClockFrequency; }};
+            Logger::Debug("Scheduling statistics: Ran for {}us over {} timeslices, Ready for {}us, Parked for {}us over {} parks, {} yields, {} blocks, {} SVCs taking {}us",
+                          toUs(statistics.runTicks), statistics.scheduleCount, toUs(statistics.readyTicks), toUs(statistics.parkTicks), statistics.parkCount,
+                          statistics.yieldCount, statistics.blockCount, statistics.svcCount, toUs(statistics.svcTicks));
+
+            // The guest can't run on this thread anymore so its TLS slot can be reused by threads created after this, this must be done prior to the thread being marked as not running as the process can be destroyed after that
+            parent->FreeTlsSlot(ctx.tpidrroEl0);
+            ctx.tpidrroEl0 = nullptr;
+
             {
                 std::scoped_lock lock{statusMutex};
                 running = false;
@@ -246,6 +257,31 @@ namespace skyline::kernel::type {
             pthread_kill(pthread, signal);
     }
 
+    void KThread::RequestYield() {
+        if (!state.nce->cooperativeYield) {
+            SendSignal(Scheduler::YieldSignal);
+            return;
+        }
+
+        ctx.yieldPending.store(true, std::memory_order_relaxed);
+
+        std::unique_lock lock(statusMutex);
+        statusCondition.wait(lock, [this]() { return ready || killed; });
+        if (!killed && running) {
+            // The preemption timer is only rearmed if it wouldn't fire sooner by itself
+            struct itimerspec current{};
+            timer_gettime(preemptionTimer, &current);
+            std::chrono::nanoseconds remaining{std::chrono::seconds{current.it_value.tv_sec} + std::chrono::nanoseconds{current.it_value.tv_nsec}};
+            if (!isPreempted || !remaining.count() || remaining > CooperativeYieldTimeout) {
+                struct itimerspec spec{.it_value = {
+                    .tv_nsec = std::chrono::duration_cast<std::chrono::nanoseconds>(CooperativeYieldTimeout).count(),
+                }};
+                timer_settime(preemptionTimer, 0, &spec, nullptr);
+                isPreempted = true;
+            }
+        }
+    }
+
     void KThread::ArmPreemptionTimer(std::chrono::nanoseconds timeToFire) {
         std::unique_lock lock(statusMutex);
         statusCondition.wait(lock, [this]() { return ready || killed; });
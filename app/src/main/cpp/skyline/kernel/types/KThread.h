@@ -16,12 +16,13 @@ namespace skyline {
         /**
          * @brief KThread manages a single thread of execution which is responsible for running guest code and kernel code which is invoked by the guest
          */
-        class KThread : public KSyncObject, public std::enable_shared_from_this<KThread> {
+        class KThread : public KSyncObject, public std::enable_shared_from_this<KThread>, public ThreadQueueHook {
           private:
             KProcess *parent;
             std::thread thread; //!< If this KThread is backed by a host thread then this'll hold it
             pthread_t pthread{}; //!< The pthread_t for the host thread running this guest thread
             timer_t preemptionTimer{}; //!< A kernel timer used for preemption interrupts
+            static constexpr std::chrono::milliseconds CooperativeYieldTimeout{1}; //!< The amount of CPU time a thread can run for after a cooperative yield request before being signalled
 
             /**
              * @brief Entry function any guest threads, sets up necessary context and jumps into guest code from the calling thread
@@ -37,7 +38,7 @@ namespace skyline {
             bool killed{false}; //!< If this thread was previously running and has been killed
 
             KHandle handle;
-            size_t id; //!< Index of thread in parent process's KThread vector
+            size_t id; //!< A process-unique ID of the thread, these are assigned sequentially in creation order
 
             nce::ThreadContext ctx{}; //!< The context of the guest thread during the last SVC
             jmp_buf originalCtx; //!< The context of the host thread prior to jumping into guest code
@@ -53,11 +54,28 @@ namespace skyline {
             std::mutex coreMigrationMutex; //!< Synchronizes operations which depend on which core the thread is running on
             u8 idealCore; //!< The ideal CPU core for this thread to run on
             u8 coreId; //!< The CPU core on which this thread is running
+            u8 hostAffinityCoreId{constant::ParkedCoreId}; //!< The CPU core whose host CPUs the host thread was last pinned to
             CoreMask affinityMask{}; //!< A mask of CPU cores this thread is allowed to run on
 
             u64 timesliceStart{}; //!< A timestamp in host CNTVCT ticks of when the thread's current timeslice started
             u64 averageTimeslice{}; //!< A weighted average of the timeslice duration for this thread
 
+            /**
+             * @brief Counters for the scheduling behaviour of the thread which are logged when it exits, all durations are in host CNTVCT ticks
+             * @note These are only mutated by the thread itself
+             */
+            struct SchedulingStatistics {
+                u64 runTicks; //!< The total duration the thread was scheduled on a core
+                u64 readyTicks; //!< The total duration the thread spent in a core's queue waiting to be scheduled
+                u64 parkTicks; //!< The total duration the thread spent parked
+                u64 svcTicks; //!< The total duration spent handling SVCs
+                u32 scheduleCount; //!< The amount of times the thread was scheduled
+                u32 yieldCount; //!< The amount of times the thread was rotated behind other threads on its core
+                u32 blockCount; //!< The amount of times the thread was removed from the scheduler to block
+                u32 parkCount;
+                u32 svcCount;
+            } statistics{};
+
             bool isPreempted{}; //!< If the preemption timer has been armed and will fire
             bool pendingYield{}; //!< If the thread has been yielded and hasn't been acted upon it yet
             bool forceYield{}; //!< If the thread has been forcefully yielded by another thread
@@ -68,9 +86,10 @@ namespace skyline {
             std::shared_ptr<KThread> waitThread; //!< The thread which this thread is waiting on
             std::list<std::shared_ptr<type::KThread>> waiters; //!< A queue of threads waiting on this thread sorted by priority
 
-            bool isCancellable{false}; //!< If the thread is currently in a position where it's cancellable
-            bool cancelSync{false}; //!< Whether to cancel the SvcWaitSynchronization call this thread currently is in/the next one it joins
+            std::atomic<bool> isCancellable{false}; //!< If the thread is currently in a position where it's cancellable, whichever thread atomically clears this is responsible for inserting it back into the scheduler
+            std::atomic<bool> cancelSync{false}; //!< Whether to cancel the SvcWaitSynchronization call this thread currently is in/the next one it joins
             type::KSyncObject *wakeObject{}; //!< A pointer to the synchronization object responsible for waking this thread up
+            std::array<KSyncWaiter, constant::MaxSyncHandles> syncWaiters{}; //!< The links into waiter lists of objects used by SvcWaitSynchronization, the first N are linked while waiting on N objects
 
             bool isPaused{false}; //!< If the thread is currently paused and not runnable
             bool insertThreadOnResume{false}; //!< If the thread should be inserted into the scheduler when it resumes (used for pausing threads during sleep/sync)
@@ -96,6 +115,12 @@ namespace skyline {
              */
             void SendSignal(int signal);
 
+            /**
+             * @brief Requests the thread to yield if it's running guest code, this is done with a signal unless safepoints are patched into guest code (NCE::cooperativeYield)
+             * @note A cooperative request arms the preemption timer to fire within CooperativeYieldTimeout of CPU time, this forces a yield in guest code that doesn't pass through any safepoints
+             */
+            void RequestYield();
+
             /**
              * @brief Arms the preemption kernel timer to fire in the specified amount of time
              */
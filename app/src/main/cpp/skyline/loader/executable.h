@@ -3,7 +3,7 @@
 
 #pragma once
 
-#include <common.h>
+#include <nce.h>
 
 namespace skyline::loader {
     /**
@@ -51,5 +51,9 @@ namespace skyline::loader {
 
         RelativeSegment dynsym; //!< The .dynsym segment relative to .rodata
         RelativeSegment dynstr; //!< The .dynstr segment relative to .rodata
+
+        std::array<u8, 0x20> buildId{}; //!< The build ID of the executable, this is zeroed if it is unknown
+
+        std::optional<nce::NCE::PatchData> patch; //!< The patch data for .text if it was already analyzed while decoding the executable, otherwise it is analyzed while loading
     };
 }
@@ -0,0 +1,86 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2023 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#include <kernel/types/KProcess.h>
+#include <kernel/ipc.h>
+#include "kernel_benchmark.h"
+
+extern "C" char KernelBenchmarkGuestStart[];
+extern "C" char KernelBenchmarkGuestEnd[];
+
+namespace skyline::loader {
+    constexpr size_t GuestSegmentSize{constant::PageSize}; //!< The size of every segment of the guest program, this must match SegmentSize in kernel_benchmark_guest.S
+
+    void *KernelBenchmarkLoader::LoadProcessData(const std::shared_ptr<kernel::type::KProcess> &process, const DeviceState &state) {
+        Executable executable{};
+
+        size_t textSize{static_cast<size_t>(KernelBenchmarkGuestEnd - KernelBenchmarkGuestStart)};
+        if (textSize > GuestSegmentSize)
+            throw exception("Kernel benchmark guest program is larger than a segment: 0x{:X}", textSize);
+        executable.text.contents.resize(GuestSegmentSize);
+        std::memcpy(executable.text.contents.data(), KernelBenchmarkGuestStart, textSize);
+        executable.text.offset = 0;
+
+        // The guest copies this request into TLS prior to every SendSyncRequest as the response overwrites it
+        executable.ro.contents.resize(GuestSegmentSize);
+        executable.ro.offset = GuestSegmentSize;
+        {
+            constexpr size_t MessageOffset{0x10};
+            std::memcpy(executable.ro.contents.data(), "sm:", 4);
+
+            auto message{executable.ro.contents.data() + MessageOffset};
+            *reinterpret_cast<kernel::ipc::CommandHeader *>(message) = {
+                .type = kernel::ipc::CommandType::Request,
+                .rawSize = 8, // Padding, the payload header and the reserved u64 argument of sm:Initialize
+            };
+            // The payload header follows the command header after padding it to 16 bytes from the start of TLS
+            *reinterpret_cast<kernel::ipc::PayloadHeader *>(message + util::AlignUp(sizeof(kernel::ipc::CommandHeader), constant::IpcPaddingSum)) = {
+                .magic = util::MakeMagic<u32>("SFCI"),
+                .value = 0, // sm:Initialize
+            };
+        }
+
+        GuestData data{
+            .iterations = Iterations,
+            .repetitions = Repetitions,
+        };
+        executable.data.contents.resize(GuestSegmentSize);
+        executable.data.offset = GuestSegmentSize * 2;
+        std::memcpy(executable.data.contents.data(), &data, sizeof(GuestData));
+        executable.bssSize = 0;
+
+        state.process->memory.InitializeVmm(memory::AddressSpaceType::AddressSpace39Bit);
+        auto loadInfo{LoadExecutable(process, state, executable, 0, "kernel_benchmark")};
+        state.process->memory.InitializeRegions(span<u8>{loadInfo.base, loadInfo.size});
+
+        guestData = reinterpret_cast<GuestData *>(reinterpret_cast<u8 *>(loadInfo.entry) + executable.data.offset);
+        Logger::Info("Running the kernel benchmark with {} repetitions of {} iterations", Repetitions, Iterations);
+        return loadInfo.entry;
+    }
+
+    void KernelBenchmarkLoader::WriteReport(const std::shared_ptr<vfs::FileSystem> &fileSystem) {
+        if (!guestData)
+            return;
+
+        std::string json{"{\n  \"benchmarks\": ["};
+        for (size_t index{}; index < BenchmarkNames.size(); index++) {
+            std::array<double, Repetitions> times;
+            for (size_t repetition{}; repetition < Repetitions; repetition++)
+                times[repetition] = static_cast<double>(guestData->ticks[repetition][index]) * constant::NsInSecond / static_cast<double>(util::ClockFrequency) / Iterations;
+            std::sort(times.begin(), times.end());
+
+            Logger::Info("{}: {:.1f}ns per call (min {:.1f}ns, max {:.1f}ns)", BenchmarkNames[index], times[Repetitions / 2], times.front(), times.back());
+            json += util::Format("{}\n    {{\"name\": \"{}\", \"iterations\": {}, \"median_ns\": {:.3f}, \"min_ns\": {:.3f}, \"max_ns\": {:.3f}, \"bytes_per_second\": 0}}",
+                                 index ? "," : "", BenchmarkNames[index], Iterations, times[Repetitions / 2], times.front(), times.back());
+        }
+        json += "\n  ]\n}\n";
+
+        std::string fileName{"kernel.json"};
+        if (!fileSystem->FileExists(fileName) && !fileSystem->CreateFile(fileName, 0))
+            throw exception("Failed to create the kernel benchmark report");
+
+        auto backing{fileSystem->OpenFile(fileName, {true, true, false})};
+        backing->Resize(json.size());
+        backing->Write(span{json}.cast<u8>());
+    }
+}
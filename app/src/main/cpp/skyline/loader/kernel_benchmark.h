@@ -0,0 +1,48 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2023 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#pragma once
+
+#include <vfs/filesystem.h>
+#include "loader.h"
+
+namespace skyline::loader {
+    /**
+     * @brief A loader for a synthetic guest process which measures the round-trip time of SVCs and IPC through NCE rather than loading a ROM
+     * @note The guest program is in kernel_benchmark_guest.S, it times loops of GetSystemTick, WaitSynchronization, ArbitrateLock and SendSyncRequest (sm:Initialize) then exits the process
+     */
+    class KernelBenchmarkLoader : public Loader {
+      public:
+        static constexpr size_t Iterations{0x4000}; //!< The amount of calls in every timed loop
+        static constexpr size_t Repetitions{5}; //!< The amount of times every loop is timed, the median of these is reported
+        static constexpr std::array<std::string_view, 4> BenchmarkNames{
+            "kernel/GetSystemTick",
+            "kernel/WaitSynchronization",
+            "kernel/ArbitrateLock",
+            "kernel/SendSyncRequest",
+        }; //!< The names of the timed loops in the order they're run by the guest
+
+      private:
+        /**
+         * @brief The layout of the .data segment of the guest program, this must match the offsets in kernel_benchmark_guest.S
+         */
+        struct GuestData {
+            u64 iterations;
+            u64 repetitions;
+            KHandle waitHandle;
+            u32 mutex;
+            std::array<std::array<u64, BenchmarkNames.size()>, Repetitions> ticks; //!< The counter ticks spent in every loop, written by the guest
+        };
+        static_assert(offsetof(GuestData, ticks) == 0x18);
+
+        GuestData *guestData{}; //!< The .data segment of the loaded guest program
+
+      public:
+        void *LoadProcessData(const std::shared_ptr<kernel::type::KProcess> &process, const DeviceState &state) override;
+
+        /**
+         * @brief Writes the results of the guest program as JSON ("kernel.json") to the supplied filesystem and into the log, this must be called after the guest process has exited
+         */
+        void WriteReport(const std::shared_ptr<vfs::FileSystem> &fileSystem);
+    };
+}
@@ -3,6 +3,7 @@
 
 #include <dlfcn.h>
 #include <cxxabi.h>
+#include <sys/resource.h>
 #include <nce.h>
 #include <os.h>
 #include <kernel/types/KProcess.h>
@@ -11,6 +12,41 @@
 #include "loader.h"
 
 namespace skyline::loader {
+    Loader::~Loader() {
+        if (verificationThread.joinable()) {
+            verificationCancelled = true;
+            verificationThread.join();
+        }
+    }
+
+    void Loader::StartIntegrityVerification() {
+        auto verifier{GetIntegrityVerifier()};
+        if (!verifier)
+            return;
+
+        verificationThread = std::thread{[this, verifier{std::move(verifier)}]() {
+            if (int result{pthread_setname_np(pthread_self(), "Sky-Verify")})
+                Logger::Warn("Failed to set the thread name: {}", strerror(result));
+
+            // Verification reads and hashes the entire ROM, it's done at the highest niceness so it only uses CPU time that emulation doesn't
+            constexpr int BackgroundPriority{19};
+            if (setpriority(PRIO_PROCESS, static_cast<id_t>(gettid()), BackgroundPriority) == -1)
+                Logger::Warn("Failed to set the integrity verification thread priority: {}", strerror(errno));
+
+            try {
+                bool valid{verifier(verificationCancelled)};
+                if (verificationCancelled)
+                    Logger::Info("Integrity verification was cancelled");
+                else if (valid)
+                    Logger::Info("Integrity verification succeeded");
+                else
+                    Logger::Error("Integrity verification found corrupted data, the title may misbehave");
+            } catch (const std::exception &e) {
+                Logger::Error("Integrity verification failed: {}", e.what());
+            }
+        }};
+    }
+
     Loader::ExecutableLoadInfo Loader::LoadExecutable(const std::shared_ptr<kernel::type::KProcess> &process, const DeviceState &state, Executable &executable, size_t offset, const std::string &name, bool dynamicallyLinked) {
         u8 *base{reinterpret_cast<u8 *>(process->memory.code.data() + offset)};
 
@@ -27,7 +63,7 @@ namespace skyline::loader {
         if (!util::IsPageAligned(executable.text.offset) || !util::IsPageAligned(executable.ro.offset) || !util::IsPageAligned(executable.data.offset))
             throw exception("Section offsets are not aligned with page size: 0x{:X}, 0x{:X}, 0x{:X}", executable.text.offset, executable.ro.offset, executable.data.offset);
 
-        auto patch{state.nce->GetPatchData(executable.text.contents)};
+        auto patch{executable.patch ? std::move(*executable.patch) : state.nce->GetPatchData(executable.text.contents, executable.buildId)};
 
         span dynsym{reinterpret_cast<Elf64_Sym *>(executable.ro.contents.data() + executable.dynsym.offset), executable.dynsym.size / sizeof(Elf64_Sym)};
         span dynstr{reinterpret_cast<char *>(executable.ro.contents.data() + executable.dynstr.offset), executable.dynstr.size};
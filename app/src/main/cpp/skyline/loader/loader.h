@@ -66,7 +66,16 @@ namespace skyline::loader {
 
         std::vector<ExecutableSymbolicInfo> executables;
 
+        std::thread verificationThread;
+        std::atomic<bool> verificationCancelled{}; //!< Set on destruction to stop integrity verification early
+
       public:
+        /**
+         * @brief A function which verifies the integrity of a ROM's contents and returns if no corruption was found, it's passed a flag that's set when verification should be stopped early
+         * @note This must own all the data it accesses as it can outlive the loader's derived class during destruction
+         */
+        using IntegrityVerifier = std::function<bool(const std::atomic<bool> &)>;
+
         /**
          * @brief Information about the placement of an executable in memory
          */
@@ -87,7 +96,7 @@ namespace skyline::loader {
         std::optional<vfs::NACP> nacp;
         std::shared_ptr<vfs::Backing> romFs;
 
-        virtual ~Loader() = default;
+        virtual ~Loader();
 
         virtual std::vector<u8> GetIcon(language::ApplicationLanguage language) {
             return std::vector<u8>();
@@ -98,6 +107,19 @@ namespace skyline::loader {
          */
         virtual void *LoadProcessData(const std::shared_ptr<kernel::type::KProcess> &process, const DeviceState &state) = 0;
 
+        /**
+         * @return A verifier for the hashes in the ROM, or an empty function if the format has no hashes that can be verified
+         */
+        virtual IntegrityVerifier GetIntegrityVerifier() {
+            return {};
+        }
+
+        /**
+         * @brief Verifies the integrity of the ROM on a background thread at the lowest priority so it doesn't compete with emulation, corruption is reported in the log
+         * @note This must only be called once
+         */
+        void StartIntegrityVerification();
+
         /**
          * @note The lifetime of the data contained within is tied to the lifetime of the Loader class it was obtained from (as this points to symbols from the executables loaded into memory directly)
          */
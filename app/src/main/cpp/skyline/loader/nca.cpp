@@ -7,6 +7,8 @@
 #include "nca.h"
 
 namespace skyline::loader {
+    constexpr std::array<const char *, 10> ExeFsModules{"main", "subsdk0", "subsdk1", "subsdk2", "subsdk3", "subsdk4", "subsdk5", "subsdk6", "subsdk7", "sdk"}; //!< All NSOs that are loaded from an ExeFS after rtld in the order they're loaded
+
     NcaLoader::NcaLoader(std::shared_ptr<vfs::Backing> backing, std::shared_ptr<crypto::KeyStore> keyStore) : nca(std::move(backing), std::move(keyStore)) {
         if (nca.exeFs == nullptr)
             throw exception("Only NCAs with an ExeFS can be loaded directly");
@@ -19,25 +21,30 @@ namespace skyline::loader {
         if (!exeFs->FileExists("rtld"))
             throw exception("Cannot load an ExeFS that doesn't contain rtld");
 
-        auto nsoFile{exeFs->OpenFile("rtld")};
+        // All NSOs are decoded together prior to loading any of them so they can all be decompressed in parallel, loading itself is serial as every NSO is placed after the previous one
+        std::vector<std::string> names{"rtld"};
+        std::vector<std::shared_ptr<vfs::Backing>> nsoFiles{exeFs->OpenFile("rtld")};
+        for (const auto &nso : ExeFsModules) {
+            if (exeFs->FileExists(nso)) {
+                names.emplace_back(nso);
+                nsoFiles.push_back(exeFs->OpenFile(nso));
+            }
+        }
+
+        auto executables{NsoLoader::DecodeNsos(nsoFiles, state)};
 
         state.process->memory.InitializeVmm(process->npdm.meta.flags.type);
 
-        auto loadInfo{NsoLoader::LoadNso(loader, nsoFile, process, state, 0, "rtld.nso")};
+        auto loadInfo{loader->LoadExecutable(process, state, executables.front(), 0, "rtld.nso")};
         u64 offset{loadInfo.size};
         u8 *base{loadInfo.base};
         void *entry{loadInfo.entry};
 
         Logger::Info("Loaded 'rtld.nso' at 0x{:X} (.text @ 0x{:X})", base, entry);
 
-        for (const auto &nso : {"main", "subsdk0", "subsdk1", "subsdk2", "subsdk3", "subsdk4", "subsdk5", "subsdk6", "subsdk7", "sdk"}) {
-            if (exeFs->FileExists(nso))
-                nsoFile = exeFs->OpenFile(nso);
-            else
-                continue;
-
-            loadInfo = NsoLoader::LoadNso(loader, nsoFile, process, state, offset, nso + std::string(".nso"), true);
-            Logger::Info("Loaded '{}.nso' at 0x{:X} (.text @ 0x{:X})", nso, base + offset, loadInfo.entry);
+        for (size_t i{1}; i < executables.size(); i++) {
+            loadInfo = loader->LoadExecutable(process, state, executables[i], offset, names[i] + ".nso", true);
+            Logger::Info("Loaded '{}.nso' at 0x{:X} (.text @ 0x{:X})", names[i], base + offset, loadInfo.entry);
             offset += loadInfo.size;
         }
 
@@ -50,4 +57,29 @@ namespace skyline::loader {
         process->npdm = vfs::NPDM(nca.exeFs->OpenFile("main.npdm"));
         return LoadExeFs(this, nca.exeFs, process, state);
     }
+
+    bool NcaLoader::VerifyProgramNca(vfs::NCA &nca, const std::atomic<bool> &cancel) {
+        bool valid{nca.VerifyIntegrity(cancel)};
+
+        // The NSO hashes are checked after the NCA as they cover the decompressed contents which aren't covered by the NCA's own hashes
+        if (nca.exeFs) {
+            if (nca.exeFs->FileExists("rtld") && !cancel)
+                valid &= NsoLoader::VerifyNso(nca.exeFs->OpenFile("rtld"), "rtld.nso");
+
+            for (const auto &nso : ExeFsModules) {
+                if (cancel)
+                    break;
+                if (nca.exeFs->FileExists(nso))
+                    valid &= NsoLoader::VerifyNso(nca.exeFs->OpenFile(nso), fmt::format("{}.nso", nso));
+            }
+        }
+
+        return valid;
+    }
+
+    Loader::IntegrityVerifier NcaLoader::GetIntegrityVerifier() {
+        return [nca{nca}](const std::atomic<bool> &cancel) mutable {
+            return VerifyProgramNca(nca, cancel);
+        };
+    }
 }
@@ -24,6 +24,14 @@ namespace skyline::loader {
          */
         static void *LoadExeFs(Loader *loader, const std::shared_ptr<vfs::FileSystem> &exefs, const std::shared_ptr<kernel::type::KProcess> &process, const DeviceState &state);
 
+        /**
+         * @brief Verifies an NCA along with the hashes of the NSOs in its ExeFS
+         * @note This reads the entire NCA, it's intended to be called by an IntegrityVerifier
+         */
+        static bool VerifyProgramNca(vfs::NCA &nca, const std::atomic<bool> &cancel);
+
         void *LoadProcessData(const std::shared_ptr<kernel::type::KProcess> &process, const DeviceState &state) override;
+
+        IntegrityVerifier GetIntegrityVerifier() override;
     };
 }
@@ -57,6 +57,7 @@ namespace skyline::loader {
         executable.data.offset = header.text.size + header.ro.size;
 
         executable.bssSize = header.bssSize;
+        std::memcpy(executable.buildId.data(), header.buildId.data(), executable.buildId.size());
 
         if (header.dynsym.offset > header.ro.offset && header.dynsym.offset + header.dynsym.size < header.ro.offset + header.ro.size && header.dynstr.offset > header.ro.offset && header.dynstr.offset + header.dynstr.size < header.ro.offset + header.ro.size) {
             executable.dynsym = {header.dynsym.offset, header.dynsym.size};
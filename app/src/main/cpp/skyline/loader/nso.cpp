@@ -3,6 +3,9 @@
 
 #include <lz4.h>
 #include <nce.h>
+#include <common/thread_pool.h>
+#include <common/boot_profile.h>
+#include <crypto/sha256.h>
 #include <kernel/types/KProcess.h>
 #include "nso.h"
 
@@ -18,10 +21,16 @@ namespace skyline::loader {
         std::vector<u8> outputBuffer(segment.decompressedSize);
 
         if (compressedSize) {
-            std::vector<u8> compressedBuffer(compressedSize);
-            backing->Read(compressedBuffer, segment.fileOffset);
-
-            LZ4_decompress_safe(reinterpret_cast<char *>(compressedBuffer.data()), reinterpret_cast<char *>(outputBuffer.data()), static_cast<int>(compressedSize), static_cast<int>(segment.decompressedSize));
+            // Segments are decompressed directly from the backing when it can provide a view of them
+            std::vector<u8> compressedBuffer;
+            span<u8> compressed{backing->View(segment.fileOffset, compressedSize)};
+            if (!compressed.valid()) {
+                compressedBuffer.resize(compressedSize);
+                backing->Read(compressedBuffer, segment.fileOffset);
+                compressed = compressedBuffer;
+            }
+
+            LZ4_decompress_safe(reinterpret_cast<char *>(compressed.data()), reinterpret_cast<char *>(outputBuffer.data()), static_cast<int>(compressedSize), static_cast<int>(segment.decompressedSize));
         } else {
             backing->Read(outputBuffer, segment.fileOffset);
         }
@@ -29,34 +38,93 @@ namespace skyline::loader {
         return outputBuffer;
     }
 
-    Loader::ExecutableLoadInfo NsoLoader::LoadNso(Loader *loader, const std::shared_ptr<vfs::Backing> &backing, const std::shared_ptr<kernel::type::KProcess> &process, const DeviceState &state, size_t offset, const std::string &name, bool dynamicallyLinked) {
-        auto header{backing->Read<NsoHeader>()};
-
-        if (header.magic != util::MakeMagic<u32>("NSO0"))
-            throw exception("Invalid NSO magic! 0x{0:X}", header.magic);
-
-        Executable executable{};
-
-        executable.text.contents = GetSegment(backing, header.text, header.flags.textCompressed ? header.textCompressedSize : 0);
-        executable.text.contents.resize(util::AlignUp(executable.text.contents.size(), constant::PageSize));
-        executable.text.offset = header.text.memoryOffset;
+    std::vector<Executable> NsoLoader::DecodeNsos(span<const std::shared_ptr<vfs::Backing>> backings, const DeviceState &state) {
+        ScopedBootPhase bootPhase{BootProfile::Phase::NsoDecompression};
+        std::vector<NsoHeader> headers;
+        std::vector<Executable> executables(backings.size());
+        for (size_t i{}; i < backings.size(); i++) {
+            auto &header{headers.emplace_back(backings[i]->Read<NsoHeader>())};
+            if (header.magic != util::MakeMagic<u32>("NSO0"))
+                throw exception("Invalid NSO magic! 0x{0:X}", header.magic);
+
+            auto &executable{executables[i]};
+            executable.text.offset = header.text.memoryOffset;
+            executable.ro.offset = header.ro.memoryOffset;
+            executable.data.offset = header.data.memoryOffset;
+            std::memcpy(executable.buildId.data(), header.buildId.data(), executable.buildId.size());
+
+            if (header.dynsym.offset + header.dynsym.size <= header.ro.decompressedSize && header.dynstr.offset + header.dynstr.size <= header.ro.decompressedSize) {
+                executable.dynsym = {header.dynsym.offset, header.dynsym.size};
+                executable.dynstr = {header.dynstr.offset, header.dynstr.size};
+            }
+        }
 
-        executable.ro.contents = GetSegment(backing, header.ro, header.flags.roCompressed ? header.roCompressedSize : 0);
-        executable.ro.contents.resize(util::AlignUp(executable.ro.contents.size(), constant::PageSize));
-        executable.ro.offset = header.ro.memoryOffset;
+        constexpr size_t SegmentCount{3}; //!< .text, .rodata and .data are decoded as separate tasks
+
+        // The pool only lives for the duration of decoding as executables are loaded in a burst at boot
+        ThreadPool pool{std::max(std::thread::hardware_concurrency(), 2U) - 1, "NsoDecode"};
+        pool.ParallelFor(backings.size() * SegmentCount, [&](size_t index) {
+            auto &backing{backings[index / SegmentCount]};
+            auto &header{headers[index / SegmentCount]};
+            auto &executable{executables[index / SegmentCount]};
+
+            switch (index % SegmentCount) {
+                case 0:
+                    executable.text.contents = GetSegment(backing, header.text, header.flags.textCompressed ? header.textCompressedSize : 0);
+                    executable.text.contents.resize(util::AlignUp(executable.text.contents.size(), constant::PageSize));
+                    executable.patch = state.nce->GetPatchData(executable.text.contents, executable.buildId);
+                    break;
+
+                case 1:
+                    executable.ro.contents = GetSegment(backing, header.ro, header.flags.roCompressed ? header.roCompressedSize : 0);
+                    executable.ro.contents.resize(util::AlignUp(executable.ro.contents.size(), constant::PageSize));
+                    break;
+
+                case 2:
+                    executable.data.contents = GetSegment(backing, header.data, header.flags.dataCompressed ? header.dataCompressedSize : 0);
+                    // Data and BSS are aligned together
+                    executable.bssSize = util::AlignUp(executable.data.contents.size() + header.bssSize, constant::PageSize) - executable.data.contents.size();
+                    break;
+            }
+        });
+
+        return executables;
+    }
 
-        executable.data.contents = GetSegment(backing, header.data, header.flags.dataCompressed ? header.dataCompressedSize : 0);
-        executable.data.offset = header.data.memoryOffset;
+    Loader::ExecutableLoadInfo NsoLoader::LoadNso(Loader *loader, const std::shared_ptr<vfs::Backing> &backing, const std::shared_ptr<kernel::type::KProcess> &process, const DeviceState &state, size_t offset, const std::string &name, bool dynamicallyLinked) {
+        auto executables{DecodeNsos(span{&backing, 1}, state)};
+        return loader->LoadExecutable(process, state, executables.front(), offset, name, dynamicallyLinked);
+    }
 
-        // Data and BSS are aligned together
-        executable.bssSize = util::AlignUp(executable.data.contents.size() + header.bssSize, constant::PageSize) - executable.data.contents.size();
+    bool NsoLoader::VerifyNso(const std::shared_ptr<vfs::Backing> &backing, std::string_view name) {
+        auto header{backing->Read<NsoHeader>()};
 
-        if (header.dynsym.offset + header.dynsym.size <= header.ro.decompressedSize && header.dynstr.offset + header.dynstr.size <= header.ro.decompressedSize) {
-            executable.dynsym = {header.dynsym.offset, header.dynsym.size};
-            executable.dynstr = {header.dynstr.offset, header.dynstr.size};
+        struct SegmentHashInfo {
+            std::string_view name;
+            const NsoSegmentHeader &segment;
+            u32 compressedSize;
+            bool hashed;
+        };
+        std::array<SegmentHashInfo, 3> segments{{
+            {".text", header.text, header.flags.textCompressed ? header.textCompressedSize : 0, header.flags.textHash},
+            {".rodata", header.ro, header.flags.roCompressed ? header.roCompressedSize : 0, header.flags.roHash},
+            {".data", header.data, header.flags.dataCompressed ? header.dataCompressedSize : 0, header.flags.dataHash},
+        }};
+
+        bool valid{true};
+        for (size_t i{}; i < segments.size(); i++) {
+            auto &segment{segments[i]};
+            if (!segment.hashed)
+                continue;
+
+            auto digest{crypto::Sha256::Hash(GetSegment(backing, segment.segment, segment.compressedSize))};
+            if (std::memcmp(digest.data(), header.segmentHashes[i].data(), digest.size()) != 0) {
+                Logger::Error("{}: {} doesn't match its hash", name, segment.name);
+                valid = false;
+            }
         }
 
-        return loader->LoadExecutable(process, state, executable, offset, name, dynamicallyLinked);
+        return valid;
     }
 
     void *NsoLoader::LoadProcessData(const std::shared_ptr<kernel::type::KProcess> &process, const DeviceState &state) {
@@ -65,4 +133,10 @@ namespace skyline::loader {
         state.process->memory.InitializeRegions(span<u8>{loadInfo.base, loadInfo.size});
         return loadInfo.entry;
     }
+
+    Loader::IntegrityVerifier NsoLoader::GetIntegrityVerifier() {
+        return [backing{backing}](const std::atomic<bool> &) {
+            return VerifyNso(backing, "NSO");
+        };
+    }
 }
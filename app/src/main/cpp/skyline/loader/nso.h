@@ -80,6 +80,13 @@ namespace skyline::loader {
       public:
         NsoLoader(std::shared_ptr<vfs::Backing> backing);
 
+        /**
+         * @brief Reads and decompresses the segments of multiple NSOs and analyzes their .text for patching
+         * @note The segments of all NSOs are decompressed in parallel, the .text of an NSO is analyzed on the thread that decompressed it so analysis overlaps with the decompression of other segments
+         * @return The executables of the NSOs in the same order as the supplied backings
+         */
+        static std::vector<Executable> DecodeNsos(span<const std::shared_ptr<vfs::Backing>> backings, const DeviceState &state);
+
         /**
          * @brief Loads an NSO into memory, offset by the given amount
          * @param backing The backing that the NSO is contained within
@@ -89,6 +96,15 @@ namespace skyline::loader {
          */
         static ExecutableLoadInfo LoadNso(Loader *loader, const std::shared_ptr<vfs::Backing> &backing, const std::shared_ptr<kernel::type::KProcess> &process, const DeviceState &state, size_t offset = 0, const std::string &name = {}, bool dynamicallyLinked = false);
 
+        /**
+         * @brief Decompresses the segments of an NSO and compares them against the hashes in its header, segments without the corresponding hash flag are skipped
+         * @param name The name of the NSO used when logging mismatches
+         * @return If all hashed segments match their hashes
+         */
+        static bool VerifyNso(const std::shared_ptr<vfs::Backing> &backing, std::string_view name);
+
         void *LoadProcessData(const std::shared_ptr<kernel::type::KProcess> &process, const DeviceState &state) override;
+
+        IntegrityVerifier GetIntegrityVerifier() override;
     };
 }
@@ -57,6 +57,14 @@ namespace skyline::loader {
         return NcaLoader::LoadExeFs(this, programNca->exeFs, process, state);
     }
 
+    Loader::IntegrityVerifier NspLoader::GetIntegrityVerifier() {
+        return [programNca{*programNca}, controlNca{*controlNca}](const std::atomic<bool> &cancel) mutable {
+            bool valid{NcaLoader::VerifyProgramNca(programNca, cancel)};
+            valid &= controlNca.VerifyIntegrity(cancel);
+            return valid;
+        };
+    }
+
     std::vector<u8> NspLoader::GetIcon(language::ApplicationLanguage language) {
         if (controlRomFs == nullptr)
             return std::vector<u8>();
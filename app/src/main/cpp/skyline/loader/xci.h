@@ -120,5 +120,7 @@ namespace skyline::loader {
         std::vector<u8> GetIcon(language::ApplicationLanguage language) override;
 
         void *LoadProcessData(const std::shared_ptr<kernel::type::KProcess> &process, const DeviceState &state) override;
+
+        IntegrityVerifier GetIntegrityVerifier() override;
     };
 }
@@ -3,8 +3,12 @@
 
 #include <cxxabi.h>
 #include <unistd.h>
+#include "common/settings.h"
 #include "common/signal.h"
 #include "common/trace.h"
+#include "common/boot_profile.h"
+#include "common/performance_statistics.h"
+#include "vfs/os_filesystem.h"
 #include "os.h"
 #include "jvm.h"
 #include "kernel/types/KProcess.h"
@@ -27,12 +31,21 @@ namespace skyline::nce {
         auto svc{kernel::svc::SvcTable[svcId]};
         try {
             if (svc) [[likely]] {
-                TRACE_EVENT("kernel", perfetto::StaticString{svc.name});
+                TRACE_EVENT("kernel", perfetto::StaticString{svc.name}, "id", svcId);
+                u64 start{util::GetTimeTicks()};
                 (svc.function)(state);
+
+                u64 duration{util::GetTimeTicks() - start};
+                state.process->svcStatistics[svcId].Record(duration);
+                state.thread->statistics.svcTicks += duration;
+                state.thread->statistics.svcCount++;
             } else {
                 throw exception("Unimplemented SVC 0x{:X}", svcId);
             }
 
+            if (ctx->yieldPending.load(std::memory_order_relaxed)) [[unlikely]]
+                kernel::Scheduler::YieldPending = true; // A cooperative yield that was requested during the SVC is handled here rather than at the next safepoint
+
             while (kernel::Scheduler::YieldPending) [[unlikely]] {
                 state.scheduler->Rotate(false);
                 kernel::Scheduler::YieldPending = false;
@@ -114,8 +127,12 @@ namespace skyline::nce {
                         TRACE_EVENT_END("hook");
                     }
                 },
+                [](const hle::DirectHook &) {}, // Direct hooks branch to the host function without going through the hook handler
             }, hookedSymbol.hook);
 
+            if (ctx->yieldPending.load(std::memory_order_relaxed)) [[unlikely]]
+                kernel::Scheduler::YieldPending = true;
+
             while (kernel::Scheduler::YieldPending) [[unlikely]] {
                 state.scheduler->Rotate(false);
                 kernel::Scheduler::YieldPending = false;
@@ -153,6 +170,56 @@ namespace skyline::nce {
         }
     }
 
+    void NCE::SafepointHandler(u64, ThreadContext *ctx) {
+        TRACE_EVENT_END("guest");
+
+        const auto &state{*ctx->state};
+        try {
+            TRACE_EVENT("scheduler", "Safepoint Yield");
+            do {
+                state.scheduler->Rotate(false);
+                kernel::Scheduler::YieldPending = false;
+                state.scheduler->WaitSchedule();
+            } while (kernel::Scheduler::YieldPending);
+        } catch (const signal::SignalException &e) {
+            if (e.signal != SIGINT) {
+                Logger::ErrorNoPrefix("{} (Safepoint)\nStack Trace:{}", e.what(), state.loader->GetStackTrace(e.frames));
+                Logger::EmulationContext.Flush();
+
+                if (state.thread->id) {
+                    signal::BlockSignal({SIGINT});
+                    state.process->Kill(false);
+                }
+            } else {
+                Logger::EmulationContext.Flush();
+            }
+
+            abi::__cxa_end_catch();
+            std::longjmp(state.thread->originalCtx, true);
+        } catch (const ExitException &e) {
+            if (e.killAllThreads && state.thread->id) {
+                signal::BlockSignal({SIGINT});
+                state.process->Kill(false);
+            }
+
+            abi::__cxa_end_catch();
+            std::longjmp(state.thread->originalCtx, true);
+        } catch (const std::exception &e) {
+            Logger::ErrorNoPrefix("{} (Safepoint)\nStack Trace:{}", e.what(), state.loader->GetStackTrace());
+            Logger::EmulationContext.Flush();
+
+            if (state.thread->id) {
+                signal::BlockSignal({SIGINT});
+                state.process->Kill(false);
+            }
+
+            abi::__cxa_end_catch();
+            std::longjmp(state.thread->originalCtx, true);
+        }
+
+        TRACE_EVENT_BEGIN("guest", "Guest");
+    }
+
     void NCE::SignalHandler(int signal, siginfo *info, ucontext *ctx, void **tls) {
         if (*tls) { // If TLS was restored then this occurred in guest code
             auto &mctx{ctx->uc_mcontext};
@@ -160,7 +227,7 @@ namespace skyline::nce {
 
             if (signal == SIGSEGV)
                 // If we get a guest access violation then we want to handle any accesses that may be from a trapped region
-                if (state.nce->TrapHandler(reinterpret_cast<u8 *>(info->si_addr), true))
+                if (state.nce->TrapHandler(reinterpret_cast<u8 *>(info->si_addr), true, reinterpret_cast<void *>(mctx.pc)))
                     return;
 
             if (signal != SIGINT) {
@@ -198,7 +265,7 @@ namespace skyline::nce {
 
     void NCE::HostSignalHandler(int signal, siginfo *info, ucontext *ctx) {
         if (signal == SIGSEGV) {
-            if (staticNce && staticNce->TrapHandler(reinterpret_cast<u8 *>(info->si_addr), true))
+            if (staticNce && staticNce->TrapHandler(reinterpret_cast<u8 *>(info->si_addr), true, reinterpret_cast<void *>(ctx->uc_mcontext.pc)))
                 return;
 
             bool runningUnderDebugger{[]() {
@@ -247,9 +314,17 @@ namespace skyline::nce {
         return threadCtx;
     }
 
-    NCE::NCE(const DeviceState &state) : state(state) {
+    NCE::NCE(const DeviceState &state) : state(state), cooperativeYield(*state.settings->cooperativeYield) {
         signal::SetTlsRestorer(&NceTlsRestorer);
         staticNce = this;
+
+        if (*state.settings->userfaultWriteTracking) {
+            try {
+                writeProtector = std::make_unique<UserfaultWriteProtector>([this](u8 *address) { UserfaultHandler(address); });
+            } catch (const exception &e) {
+                Logger::Warn("Falling back to mprotect for write tracking: {}", e.what());
+            }
+        }
     }
 
     NCE::~NCE() {
@@ -341,6 +416,112 @@ namespace skyline::nce {
         return code;
     }
 
+    constexpr size_t SafepointSize{13}; //!< The size of the Safepoint function in 32-bit ARMv8 instructions
+    constexpr size_t SafepointPollSize{8}; //!< The size of the inline safepoint poll in 32-bit ARMv8 instructions
+
+    /**
+     * @brief Writes a function that saves the guest context alongside the condition flags and calls the safepoint trampoline
+     * @note The inline poll must have pushed X0 and LR onto the stack in a single 16B allocation prior to calling this, they're restored by the poll afterwards
+     */
+    u32 *WriteSafepoint(u32 *code, u32 *saveCtx, u32 *trampoline, u32 *loadCtx) {
+        /* Reserve 32B of stack for LR, the SaveCtx scratch and NZCV */
+        *code++ = 0xD10083FF; // SUB SP, SP, #32
+        *code++ = 0xF90003FE; // STR LR, [SP]
+
+        /* Save the condition flags as loops can branch back with them live */
+        *code++ = 0xD53B4200; // MRS X0, NZCV
+        *code++ = 0xF9000BE0; // STR X0, [SP, #16]
+        *code++ = 0xF94013E0; // LDR X0, [SP, #32] (X0 pushed by the poll)
+
+        /* Save Context, Jump to the trampoline and Restore Context */
+        *code = instructions::BL(static_cast<i32>(saveCtx - code)).raw;
+        code++;
+        *code = instructions::BL(static_cast<i32>(trampoline - code)).raw;
+        code++;
+        *code = instructions::BL(static_cast<i32>(loadCtx - code)).raw;
+        code++;
+
+        /* Restore the condition flags, LR and Return */
+        *code++ = 0xF9400BE0; // LDR X0, [SP, #16]
+        *code++ = 0xD51B4200; // MSR NZCV, X0
+        *code++ = 0xF94003FE; // LDR LR, [SP]
+        *code++ = 0x910083FF; // ADD SP, SP, #32
+        *code++ = 0xD65F03C0; // RET
+
+        return code;
+    }
+
+    /**
+     * @brief Writes instructions that poll ThreadContext::yieldPending and call the Safepoint function if it's set
+     * @note All registers and the condition flags are preserved, this must be followed by a branch to the original target
+     */
+    u32 *WriteSafepointPoll(u32 *code, u32 *safepoint) {
+        /* Allocate Scratch Register and load the flag */
+        *code++ = 0xF81F0FE0; // STR X0, [SP, #-16]!
+        *code++ = 0xD53BD040; // MRS X0, TPIDR_EL0
+        *code++ = 0xB942D000; // LDR W0, [X0, #0x2D0] (ThreadContext::yieldPending)
+
+        /* Call Safepoint if a yield is pending */
+        *code++ = 0x34000080; // CBZ W0, #16
+        *code++ = 0xF90007FE; // STR LR, [SP, #8]
+        *code = instructions::BL(static_cast<i32>(safepoint - code)).raw;
+        code++;
+        *code++ = 0xF94007FE; // LDR LR, [SP, #8]
+
+        /* Restore Scratch Register */
+        *code++ = 0xF84107E0; // LDR X0, [SP], #16
+
+        return code;
+    }
+
+    /**
+     * @return The offset in instructions of a direct branch to itself or backwards, these are assumed to be loop back-edges
+     * @param conditional If the branch is conditional, in which case the condition needs to be evaluated prior to polling
+     */
+    std::optional<i32> GetBackEdgeOffset(const u32 *instruction, bool &conditional) {
+        auto branch{*reinterpret_cast<const instructions::B *>(instruction)};
+        auto conditionalBranch{*reinterpret_cast<const instructions::BCond *>(instruction)};
+        auto compareBranch{*reinterpret_cast<const instructions::CompareBranch *>(instruction)};
+        auto testBranch{*reinterpret_cast<const instructions::TestBranch *>(instruction)};
+
+        i32 offset;
+        if (branch.Verify())
+            offset = branch.offset;
+        else if (conditionalBranch.Verify())
+            offset = conditionalBranch.offset;
+        else if (compareBranch.Verify())
+            offset = compareBranch.offset;
+        else if (testBranch.Verify())
+            offset = testBranch.offset;
+        else
+            return std::nullopt;
+
+        conditional = !branch.Verify();
+        if (offset <= 0)
+            return offset;
+        return std::nullopt;
+    }
+
+    /**
+     * @return A copy of a conditional branch with its offset replaced by the supplied one
+     */
+    u32 RetargetConditionalBranch(const u32 *instruction, i32 offset) {
+        auto conditionalBranch{*reinterpret_cast<const instructions::BCond *>(instruction)};
+        auto compareBranch{*reinterpret_cast<const instructions::CompareBranch *>(instruction)};
+        auto testBranch{*reinterpret_cast<const instructions::TestBranch *>(instruction)};
+
+        if (conditionalBranch.Verify()) {
+            conditionalBranch.offset = offset;
+            return conditionalBranch.raw;
+        } else if (compareBranch.Verify()) {
+            compareBranch.offset = offset;
+            return compareBranch.raw;
+        } else {
+            testBranch.offset = offset;
+            return testBranch.raw;
+        }
+    }
+
     constexpr u32 TpidrEl0{0x5E82};         // ID of TPIDR_EL0 in MRS
     constexpr u32 TpidrroEl0{0x5E83};       // ID of TPIDRRO_EL0 in MRS
     constexpr u32 CntfrqEl0{0x5F00};        // ID of CNTFRQ_EL0 in MRS
@@ -348,45 +529,227 @@ namespace skyline::nce {
     constexpr u32 CntvctEl0{0x5F02};        // ID of CNTVCT_EL0 in MRS
     constexpr u32 TegraX1Freq{19200000};    // The clock frequency of the Tegra X1 (19.2 MHz)
 
-    NCE::PatchData NCE::GetPatchData(const std::vector<u8> &text) {
-        size_t size{guest::SaveCtxSize + guest::LoadCtxSize + TrampolineSize};
-        std::vector<size_t> offsets;
+    /**
+     * @return The size of the emulation of an MRS instruction inside a trampoline in 32-bit ARMv8 instructions excluding the branch back, this is 0 for any MRS that isn't emulated inside a trampoline
+     */
+    constexpr size_t GetMrsEmulationSize(instructions::Mrs mrs, bool rescaleClock) {
+        if (!mrs.Verify())
+            return 0;
+        else if (mrs.srcReg == TpidrroEl0 || mrs.srcReg == TpidrEl0)
+            return (mrs.destReg != registers::X0) ? 5 : 2;
+        else if (rescaleClock && mrs.srcReg == CntpctEl0)
+            return RescaleClockSize + 2;
+        else if (rescaleClock && mrs.srcReg == CntfrqEl0)
+            return 2;
+        return 0;
+    }
 
+    /**
+     * @brief Writes instructions that emulate an MRS instruction which has a non-zero GetMrsEmulationSize, the result is written to the destination register of the MRS with no other registers being modified
+     */
+    u32 *WriteMrsEmulation(u32 *code, instructions::Mrs mrs) {
+        if (mrs.srcReg == TpidrroEl0 || mrs.srcReg == TpidrEl0) {
+            /* Emulated TLS Register Load */
+            /* Allocate Scratch Register */
+            if (mrs.destReg != registers::X0)
+                *code++ = 0xF81F0FE0; // STR X0, [SP, #-16]!
+
+            /* Retrieve emulated TLS register from ThreadContext */
+            *code++ = 0xD53BD040; // MRS X0, TPIDR_EL0
+            if (mrs.srcReg == TpidrroEl0)
+                *code++ = 0xF9415800; // LDR X0, [X0, #0x2B0] (ThreadContext::tpidrroEl0)
+            else
+                *code++ = 0xF9415C00; // LDR X0, [X0, #0x2B8] (ThreadContext::tpidrEl0)
+
+            /* Restore Scratch Register */
+            if (mrs.destReg != registers::X0) {
+                *code++ = instructions::Mov(registers::X(mrs.destReg), registers::X0).raw;
+                *code++ = 0xF84107E0; // LDR X0, [SP], #16
+            }
+        } else if (mrs.srcReg == CntpctEl0) {
+            /* Physical Counter Load Emulation (With Rescaling) */
+            /* Rescale host clock */
+            code = WriteRescaleClock(code);
+
+            /* Load result from stack into destination register */
+            instructions::Ldr ldr(0xF94003E0); // LDR XOUT, [SP]
+            ldr.destReg = mrs.destReg;
+            *code++ = ldr.raw;
+
+            /* Free 32B stack allocation by RescaleClock */
+            *code++ = 0x910083FF; // ADD SP, SP, #32
+        } else if (mrs.srcReg == CntfrqEl0) {
+            /* Physical Counter Frequency Load Emulation */
+            /* Write back Tegra X1 Counter Frequency */
+            for (const auto &mov : instructions::MoveRegister(registers::X(mrs.destReg), TegraX1Freq))
+                *code++ = mov;
+        }
+        return code;
+    }
+
+    /**
+     * @return If the instruction following a trampoline-emulated MRS is another one which can be fused into the same trampoline, sequences such as reading the counter alongside its frequency or reading both TLS registers are common in timing and threading code
+     * @note The fused instruction is still patched by itself as it might be the target of a branch, the fused trampoline just returns past it
+     */
+    bool IsFusableMrs(span<const u32> text, size_t offset, bool rescaleClock) {
+        return offset + 1 < text.size() && GetMrsEmulationSize(*reinterpret_cast<const instructions::Mrs *>(&text[offset + 1]), rescaleClock);
+    }
+
+    constexpr u16 SvcGetCurrentProcessorNumber{0x10}; // SVCs which are serviced by inline stubs in guest code rather than by the SVC handler
+    constexpr u16 SvcGetSystemTick{0x1E};
+    constexpr u16 SvcGetThreadId{0x25};
+
+    NCE::PatchData NCE::ScanPatchRange(span<const u32> text, size_t begin, size_t end) {
+        PatchData data{};
         bool rescaleClock{util::ClockFrequency != TegraX1Freq};
 
-        auto start{reinterpret_cast<const u32 *>(text.data())}, end{reinterpret_cast<const u32 *>(text.data() + text.size())};
-        for (const u32 *instruction{start}; instruction < end; instruction++) {
+        for (const u32 *instruction{text.data() + begin}; instruction < text.data() + end; instruction++) {
             auto svc{*reinterpret_cast<const instructions::Svc *>(instruction)};
             auto mrs{*reinterpret_cast<const instructions::Mrs *>(instruction)};
             auto msr{*reinterpret_cast<const instructions::Msr *>(instruction)};
-            auto instructionOffset{static_cast<size_t>(instruction - start)};
+            auto instructionOffset{static_cast<size_t>(instruction - text.data())};
 
             if (svc.Verify()) {
-                size += 7;
-                offsets.push_back(instructionOffset);
+                if (svc.value == SvcGetSystemTick)
+                    data.size += rescaleClock ? RescaleClockSize + 3 : 0;
+                else if (svc.value == SvcGetCurrentProcessorNumber)
+                    data.size += 4;
+                else if (svc.value == SvcGetThreadId)
+                    data.size += 6 + 7;
+                else
+                    data.size += 7;
+                data.offsets.push_back(instructionOffset);
             } else if (mrs.Verify()) {
-                if (mrs.srcReg == TpidrroEl0 || mrs.srcReg == TpidrEl0) {
-                    size += ((mrs.destReg != registers::X0) ? 6 : 3);
-                    offsets.push_back(instructionOffset);
-                } else {
-                    if (rescaleClock) {
-                        if (mrs.srcReg == CntpctEl0) {
-                            size += RescaleClockSize + 3;
-                            offsets.push_back(instructionOffset);
-                        } else if (mrs.srcReg == CntfrqEl0) {
-                            size += 3;
-                            offsets.push_back(instructionOffset);
+                if (auto emulationSize{GetMrsEmulationSize(mrs, rescaleClock)}) {
+                    data.size += emulationSize + 1;
+                    if (IsFusableMrs(text, instructionOffset, rescaleClock))
+                        data.size += GetMrsEmulationSize(*reinterpret_cast<const instructions::Mrs *>(instruction + 1), rescaleClock);
+                    data.offsets.push_back(instructionOffset);
+                } else if (!rescaleClock && mrs.srcReg == CntpctEl0) {
+                    data.offsets.push_back(instructionOffset);
+                }
+            } else if (msr.Verify() && msr.destReg == TpidrEl0) {
+                data.size += 6;
+                data.offsets.push_back(instructionOffset);
+            } else if (cooperativeYield) {
+                bool conditional;
+                auto backEdgeOffset{GetBackEdgeOffset(instruction, conditional)};
+                if (backEdgeOffset && static_cast<i64>(instructionOffset) + *backEdgeOffset >= 0) {
+                    data.size += SafepointPollSize + (conditional ? 3 : 1);
+                    data.offsets.push_back(instructionOffset);
+                }
+            }
+        }
+        return data;
+    }
+
+    /**
+     * @brief The header of an on-disk cache of the patch data for an executable, the offsets follow it as 32-bit instruction indices
+     */
+    struct PatchCacheHeader {
+        static constexpr u32 Magic{util::MakeMagic<u32>("NCEP")};
+        static constexpr u32 Version{3}; //!< The version of the cache, this must be incremented whenever the patching logic changes
+
+        u32 magic{Magic};
+        u32 version{Version};
+        u64 textHash; //!< A hash of the unpatched .text, the build ID alone isn't sufficient as it's retained by exefs patches
+        u32 textSize;
+        u32 rescaleClock : 1;
+        u32 cooperativeYield : 1;
+        u32 _pad_ : 30{};
+        u64 patchSize{};
+        u64 offsetCount{};
+
+        bool IsCompatible(const PatchCacheHeader &other) const {
+            return magic == other.magic && version == other.version && textHash == other.textHash && textSize == other.textSize && rescaleClock == other.rescaleClock && cooperativeYield == other.cooperativeYield;
+        }
+    };
+
+    NCE::PatchData NCE::GetPatchData(const std::vector<u8> &text, span<u8> buildId) {
+        TRACE_EVENT("host", "NCE::GetPatchData", "size", text.size());
+        ScopedBootPhase bootPhase{BootProfile::Phase::NcePatchAnalysis};
+
+        PatchCacheHeader expectedHeader{
+            .textHash = XXH64(text.data(), text.size(), 0),
+            .textSize = static_cast<u32>(text.size()),
+            .rescaleClock = util::ClockFrequency != TegraX1Freq,
+            .cooperativeYield = cooperativeYield,
+        };
+
+        std::shared_ptr<vfs::FileSystem> cacheFileSystem;
+        std::string cacheFileName;
+        if (!buildId.empty() && state.os && std::any_of(buildId.begin(), buildId.end(), [](u8 value) { return value != 0; })) {
+            try {
+                cacheFileSystem = std::make_shared<vfs::OsFileSystem>(state.os->publicAppFilesPath + "cache/nce/");
+                cacheFileName = util::HexDump(buildId) + ".bin";
+
+                if (cacheFileSystem->FileExists(cacheFileName)) {
+                    auto backing{cacheFileSystem->OpenFile(cacheFileName)};
+                    if (backing->size >= sizeof(PatchCacheHeader)) {
+                        auto header{backing->Read<PatchCacheHeader>()};
+                        if (header.IsCompatible(expectedHeader) && backing->size == sizeof(PatchCacheHeader) + header.offsetCount * sizeof(u32)) {
+                            std::vector<u32> cachedOffsets(header.offsetCount);
+                            backing->Read(span{cachedOffsets}, sizeof(PatchCacheHeader));
+                            Logger::Debug("Loaded {} patch offsets from the cache for {}", header.offsetCount, cacheFileName);
+                            return {header.patchSize, std::vector<size_t>(cachedOffsets.begin(), cachedOffsets.end())};
                         }
-                    } else if (mrs.srcReg == CntpctEl0) {
-                        offsets.push_back(instructionOffset);
                     }
                 }
-            } else if (msr.Verify() && msr.destReg == TpidrEl0) {
-                size += 6;
-                offsets.push_back(instructionOffset);
+            } catch (const std::exception &e) {
+                Logger::Warn("Failed to read the patch cache: {}", e.what());
             }
         }
-        return {util::AlignUp(size * sizeof(u32), constant::PageSize), offsets};
+
+        size_t size{guest::SaveCtxSize + guest::LoadCtxSize + TrampolineSize};
+        if (cooperativeYield)
+            size += TrampolineSize + SafepointSize;
+
+        // Scanning is split into contiguous ranges for large executables, the ranges are scanned concurrently and concatenated in order so the result is identical to a serial scan
+        constexpr size_t ParallelScanThreshold{0x400000}; //!< The size of .text in bytes after which it's scanned on multiple threads
+        span<const u32> instructions{reinterpret_cast<const u32 *>(text.data()), text.size() / sizeof(u32)};
+        size_t workerCount{text.size() >= ParallelScanThreshold ? std::max(std::thread::hardware_concurrency(), 1U) : 1};
+        size_t rangeSize{util::DivideCeil(instructions.size(), workerCount)};
+
+        std::vector<PatchData> ranges(workerCount);
+        std::vector<std::thread> workers;
+        for (size_t i{1}; i < workerCount; i++)
+            workers.emplace_back([&, i] {
+                ranges[i] = ScanPatchRange(instructions, std::min(i * rangeSize, instructions.size()), std::min((i + 1) * rangeSize, instructions.size()));
+            });
+        ranges[0] = ScanPatchRange(instructions, 0, std::min(rangeSize, instructions.size()));
+        for (auto &worker : workers)
+            worker.join();
+
+        std::vector<size_t> offsets;
+        offsets.reserve(std::accumulate(ranges.begin(), ranges.end(), size_t{}, [](size_t count, const PatchData &range) { return count + range.offsets.size(); }));
+        for (const auto &range : ranges) {
+            size += range.size;
+            offsets.insert(offsets.end(), range.offsets.begin(), range.offsets.end());
+        }
+
+        PatchData data{util::AlignUp(size * sizeof(u32), constant::PageSize), std::move(offsets)};
+
+        if (cacheFileSystem) {
+            try {
+                PatchCacheHeader header{expectedHeader};
+                header.patchSize = data.size;
+                header.offsetCount = data.offsets.size();
+
+                std::vector<u32> cachedOffsets(data.offsets.begin(), data.offsets.end());
+                if (cacheFileSystem->FileExists(cacheFileName))
+                    cacheFileSystem->DeleteFile(cacheFileName);
+                if (!cacheFileSystem->CreateFile(cacheFileName, sizeof(PatchCacheHeader) + cachedOffsets.size() * sizeof(u32)))
+                    throw exception("Failed to create the cache file");
+
+                auto backing{cacheFileSystem->OpenFile(cacheFileName, {true, true, false})};
+                backing->WriteObject(header);
+                backing->Write(span{cachedOffsets}.cast<u8>(), sizeof(PatchCacheHeader));
+            } catch (const std::exception &e) {
+                Logger::Warn("Failed to write the patch cache: {}", e.what());
+            }
+        }
+
+        return data;
     }
 
     void NCE::PatchCode(std::vector<u8> &text, u32 *patch, size_t patchSize, const std::vector<size_t> &offsets, size_t textOffset) {
@@ -398,10 +761,21 @@ namespace skyline::nce {
 
         patch = WriteTrampoline(patch, reinterpret_cast<u64>(&NCE::SvcHandler));
 
+        u32 *loadCtx{patch};
         std::memcpy(patch, reinterpret_cast<void *>(&guest::LoadCtx), guest::LoadCtxSize * sizeof(u32));
         patch += guest::LoadCtxSize;
 
+        u32 *safepoint{};
+        if (cooperativeYield) {
+            u32 *safepointTrampoline{patch};
+            patch = WriteTrampoline(patch, reinterpret_cast<u64>(&NCE::SafepointHandler));
+
+            safepoint = patch;
+            patch = WriteSafepoint(patch, start, safepointTrampoline, loadCtx);
+        }
+
         bool rescaleClock{util::ClockFrequency != TegraX1Freq};
+        span<const u32> textInstructions{reinterpret_cast<const u32 *>(text.data()), text.size() / sizeof(u32)};
 
         for (auto offset : offsets) {
             u32 *instruction{reinterpret_cast<u32 *>(text.data()) + offset};
@@ -412,85 +786,90 @@ namespace skyline::nce {
             auto startOffset{[&] { return static_cast<size_t>(start - patch); }};
 
             if (svc.Verify()) {
-                /* Per-SVC Trampoline */
-                /* Rewrite SVC with B to trampoline */
-                *instruction = instructions::B(static_cast<i32>(endOffset() + offset), true).raw;
+                auto writeSvcTrampoline{[&] {
+                    /* Save Context */
+                    *patch++ = 0xF81F0FFE; // STR LR, [SP, #-16]!
+                    *patch = instructions::BL(static_cast<i32>(startOffset())).raw;
+                    patch++;
 
-                /* Save Context */
-                *patch++ = 0xF81F0FFE; // STR LR, [SP, #-16]!
-                *patch = instructions::BL(static_cast<i32>(startOffset())).raw;
-                patch++;
+                    /* Jump to main SVC trampoline */
+                    *patch++ = instructions::Movz(registers::W0, static_cast<u16>(svc.value)).raw;
+                    *patch = instructions::BL(static_cast<i32>(startOffset() + guest::SaveCtxSize)).raw;
+                    patch++;
 
-                /* Jump to main SVC trampoline */
-                *patch++ = instructions::Movz(registers::W0, static_cast<u16>(svc.value)).raw;
-                *patch = instructions::BL(static_cast<i32>(startOffset() + guest::SaveCtxSize)).raw;
-                patch++;
+                    /* Restore Context and Return */
+                    *patch = instructions::BL(static_cast<i32>(startOffset() + guest::SaveCtxSize + TrampolineSize)).raw;
+                    patch++;
+                    *patch++ = 0xF84107FE; // LDR LR, [SP], #16
+                    *patch = instructions::B(static_cast<i32>(endOffset() + offset + 1)).raw;
+                    patch++;
+                }};
 
-                /* Restore Context and Return */
-                *patch = instructions::BL(static_cast<i32>(startOffset() + guest::SaveCtxSize + TrampolineSize)).raw;
-                patch++;
-                *patch++ = 0xF84107FE; // LDR LR, [SP], #16
-                *patch = instructions::B(static_cast<i32>(endOffset() + offset + 1)).raw;
-                patch++;
-            } else if (mrs.Verify()) {
-                if (mrs.srcReg == TpidrroEl0 || mrs.srcReg == TpidrEl0) {
-                    /* Emulated TLS Register Load */
-                    /* Rewrite MRS with B to trampoline */
+                // Trivial SVCs are serviced inline without saving the context or leaving guest code, only registers which are outputs of the SVC are clobbered
+                if (svc.value == SvcGetSystemTick) {
+                    if (rescaleClock) {
+                        /* Inline GetSystemTick (With Rescaling) */
+                        *instruction = instructions::B(static_cast<i32>(endOffset() + offset), true).raw;
+
+                        patch = WriteRescaleClock(patch);
+                        *patch++ = 0xF94003E0; // LDR X0, [SP]
+                        *patch++ = 0x910083FF; // ADD SP, SP, #32
+                        *patch = instructions::B(static_cast<i32>(endOffset() + offset + 1)).raw;
+                        patch++;
+                    } else {
+                        /* Inline GetSystemTick (Without Rescaling) */
+                        // The host counter runs at the same frequency as the Tegra X1 counter, so the SVC can be replaced with a read of it
+                        *instruction = instructions::Mrs(CntvctEl0, registers::X0).raw;
+                    }
+                } else if (svc.value == SvcGetCurrentProcessorNumber) {
+                    /* Inline GetCurrentProcessorNumber */
                     *instruction = instructions::B(static_cast<i32>(endOffset() + offset), true).raw;
 
-                    /* Allocate Scratch Register */
-                    if (mrs.destReg != registers::X0)
-                        *patch++ = 0xF81F0FE0; // STR X0, [SP, #-16]!
+                    *patch++ = 0xD53BD040; // MRS X0, TPIDR_EL0
+                    *patch++ = 0xF9416C00; // LDR X0, [X0, #0x2D8] (ThreadContext::coreId)
+                    *patch++ = 0x39400000; // LDRB W0, [X0]
+                    *patch = instructions::B(static_cast<i32>(endOffset() + offset + 1)).raw;
+                    patch++;
+                } else if (svc.value == SvcGetThreadId) {
+                    /* Inline GetThreadId for the current thread's pseudo-handle */
+                    *instruction = instructions::B(static_cast<i32>(endOffset() + offset), true).raw;
 
-                    /* Retrieve emulated TLS register from ThreadContext */
+                    // W0 is an output of the SVC so it can be used as a scratch register, the comparison is done without modifying NZCV as the SVC preserves it
+                    *patch++ = 0x11402020; // ADD W0, W1, #0x8, LSL #12 (W0 is zero if W1 is 0xFFFF8000)
+                    *patch++ = 0x350000A0; // CBNZ W0, #20 (Fall back to the SVC handler for any other handle)
                     *patch++ = 0xD53BD040; // MRS X0, TPIDR_EL0
-                    if (mrs.srcReg == TpidrroEl0)
-                        *patch++ = 0xF9415800; // LDR X0, [X0, #0x2B0] (ThreadContext::tpidrroEl0)
-                    else
-                        *patch++ = 0xF9415C00; // LDR X0, [X0, #0x2B8] (ThreadContext::tpidrEl0)
-
-                    /* Restore Scratch Register and Return */
-                    if (mrs.destReg != registers::X0) {
-                        *patch++ = instructions::Mov(registers::X(mrs.destReg), registers::X0).raw;
-                        *patch++ = 0xF84107E0; // LDR X0, [SP], #16
-                    }
+                    *patch++ = 0xF9417001; // LDR X1, [X0, #0x2E0] (ThreadContext::threadId)
+                    *patch++ = 0x2A1F03E0; // MOV W0, WZR
                     *patch = instructions::B(static_cast<i32>(endOffset() + offset + 1)).raw;
                     patch++;
+
+                    writeSvcTrampoline();
                 } else {
-                    if (rescaleClock) {
-                        if (mrs.srcReg == CntpctEl0) {
-                            /* Physical Counter Load Emulation (With Rescaling) */
-                            /* Rewrite MRS with B to trampoline */
-                            *instruction = instructions::B(static_cast<i32>(endOffset() + offset), true).raw;
-
-                            /* Rescale host clock */
-                            patch = WriteRescaleClock(patch);
-
-                            /* Load result from stack into destination register */
-                            instructions::Ldr ldr(0xF94003E0); // LDR XOUT, [SP]
-                            ldr.destReg = mrs.destReg;
-                            *patch++ = ldr.raw;
-
-                            /* Free 32B stack allocation by RescaleClock and Return */
-                            *patch++ = {0x910083FF}; // ADD SP, SP, #32
-                            *patch = instructions::B(static_cast<i32>(endOffset() + offset + 1)).raw;
-                            patch++;
-                        } else if (mrs.srcReg == CntfrqEl0) {
-                            /* Physical Counter Frequency Load Emulation */
-                            /* Rewrite MRS with B to trampoline */
-                            *instruction = instructions::B(static_cast<i32>(endOffset() + offset), true).raw;
-
-                            /* Write back Tegra X1 Counter Frequency and Return */
-                            for (const auto &mov : instructions::MoveRegister(registers::X(mrs.destReg), TegraX1Freq))
-                                *patch++ = mov;
-                            *patch = instructions::B(static_cast<i32>(endOffset() + offset + 1)).raw;
-                            patch++;
-                        }
-                    } else if (mrs.srcReg == CntpctEl0) {
-                        /* Physical Counter Load Emulation (Without Rescaling) */
-                        // We just convert CNTPCT_EL0 -> CNTVCT_EL0 as Linux doesn't allow access to the physical counter
-                        *instruction = instructions::Mrs(CntvctEl0, registers::X(mrs.destReg)).raw;
+                    /* Per-SVC Trampoline */
+                    /* Rewrite SVC with B to trampoline */
+                    *instruction = instructions::B(static_cast<i32>(endOffset() + offset), true).raw;
+                    writeSvcTrampoline();
+                }
+            } else if (mrs.Verify()) {
+                if (GetMrsEmulationSize(mrs, rescaleClock)) {
+                    /* Emulated System Register Load */
+                    /* Rewrite MRS with B to trampoline */
+                    *instruction = instructions::B(static_cast<i32>(endOffset() + offset), true).raw;
+
+                    patch = WriteMrsEmulation(patch, mrs);
+
+                    /* Fuse an adjacent emulated MRS into the trampoline and Return past it */
+                    if (IsFusableMrs(textInstructions, offset, rescaleClock)) {
+                        patch = WriteMrsEmulation(patch, *reinterpret_cast<instructions::Mrs *>(instruction + 1));
+                        *patch = instructions::B(static_cast<i32>(endOffset() + offset + 2)).raw;
+                    } else {
+                        *patch = instructions::B(static_cast<i32>(endOffset() + offset + 1)).raw;
                     }
+                    patch++;
+                } else if (!rescaleClock && mrs.srcReg == CntpctEl0) {
+                    /* Physical Counter Load Emulation (Without Rescaling) */
+                    // We just convert CNTPCT_EL0 -> CNTVCT_EL0 as Linux doesn't allow access to the physical counter
+                    *instruction = instructions::Mrs(CntvctEl0, registers::X(mrs.destReg)).raw;
                 }
             } else if (msr.Verify() && msr.destReg == TpidrEl0) {
                 /* Emulated TLS Register Store */
@@ -510,6 +889,28 @@ namespace skyline::nce {
                 *patch++ = x0x1 ? 0xA8C107E0 : 0xA8C10FE2; // LDP X(0/2), X(1/3), [SP], #16
                 *patch = instructions::B(static_cast<i32>(endOffset() + offset + 1)).raw;
                 patch++;
+            } else if (cooperativeYield) {
+                bool conditional;
+                auto backEdgeOffset{GetBackEdgeOffset(instruction, conditional)};
+                if (!backEdgeOffset)
+                    continue;
+
+                /* Loop Back-Edge Safepoint */
+                /* Rewrite branch with B to trampoline */
+                u32 original{*instruction};
+                *instruction = instructions::B(static_cast<i32>(endOffset() + offset), true).raw;
+
+                if (conditional) {
+                    /* Evaluate the condition and Return if it isn't met */
+                    *patch++ = RetargetConditionalBranch(&original, 2);
+                    *patch = instructions::B(static_cast<i32>(endOffset() + offset + 1)).raw;
+                    patch++;
+                }
+
+                /* Poll for a pending yield and Branch to the original target */
+                patch = WriteSafepointPoll(patch, safepoint);
+                *patch = instructions::B(static_cast<i32>(static_cast<i64>(endOffset() + offset) + *backEdgeOffset)).raw;
+                patch++;
             }
         }
     }
@@ -522,6 +923,8 @@ namespace skyline::nce {
                 size += EmitTrampolineSize + 1;
             else if (std::holds_alternative<hle::EntryExitHook>(entry.hook))
                 size += 4 + EmitTrampolineSize + 1 + EmitTrampolineSize + 4 + 1;
+            else if (std::holds_alternative<hle::DirectHook>(entry.hook))
+                size += 4 + 1 + 1;
         }
         return size * sizeof(u32);
     }
@@ -594,6 +997,12 @@ namespace skyline::nce {
                 *hook++ = 0xF841043E; // LDR LR, [X1], #16
                 *hook++ = 0xF9015401; // STR X1, [X0, #0x2A8] (ThreadContext::hostSp)
                 *hook++ = 0xA8C107E0; // LDP X0, X1, [SP], #16
+            } else if (auto directHook{std::get_if<hle::DirectHook>(&entry.hook)}) {
+                /* Tail Call Host Function */
+                for (const auto &mov : instructions::MoveRegister(registers::X16, directHook->function))
+                    if (mov)
+                        *hook++ = mov;
+                *hook++ = 0xD61F0200; // BR X16
             }
 
             *hook++ = 0xD65F03C0; // RET
@@ -603,15 +1012,109 @@ namespace skyline::nce {
         }
     }
 
-    NCE::CallbackEntry::CallbackEntry(TrapProtection protection, LockCallback lockCallback, TrapCallback readCallback, TrapCallback writeCallback) : protection{protection}, lockCallback{std::move(lockCallback)}, readCallback{std::move(readCallback)}, writeCallback{std::move(writeCallback)} {}
+    NCE::CallbackEntry::CallbackEntry(TrapProtection protection, LockCallback lockCallback, TrapCallback readCallback, TrapCallback writeCallback, PageTrapCallback pageWriteCallback) : protection{protection}, lockCallback{std::move(lockCallback)}, readCallback{std::move(readCallback)}, writeCallback{std::move(writeCallback)}, pageWriteCallback{std::move(pageWriteCallback)} {}
+
+    NCE::CallbackEntry::CallbackEntry(CallbackEntry &&other) : protection{other.protection.load()}, lockCallback{std::move(other.lockCallback)}, readCallback{std::move(other.readCallback)}, writeCallback{std::move(other.writeCallback)}, pageWriteCallback{std::move(other.pageWriteCallback)}, resource{other.resource}, resourceAddress{other.resourceAddress}, resourceSize{other.resourceSize} {}
+
+    void NCE::CallbackEntry::SetResource(TrapResource pResource, span<span<u8>> regions) {
+        resource = pResource;
+        resourceAddress = regions.empty() ? nullptr : regions.front().data();
+        resourceSize = 0;
+        for (const auto &region : regions)
+            resourceSize += region.size();
+    }
+
+    /**
+     * @brief Merges reprotections of contiguous or overlapping regions with identical protection into a single call
+     * @note Any pending reprotection is done when this is destroyed
+     */
+    class NCE::ProtectionCoalescer {
+      private:
+        NCE &nce;
+        u8 *start{}, *end{};
+        int protection{};
+
+      public:
+        ProtectionCoalescer(NCE &nce) : nce{nce} {}
+
+        void Protect(u8 *regionStart, u8 *regionEnd, int regionProtection) {
+            if (start != end && regionProtection == protection && regionStart >= start && regionStart <= end) {
+                end = std::max(end, regionEnd);
+                nce.coalescedReprotections.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+
+            Flush();
+            start = regionStart;
+            end = regionEnd;
+            protection = regionProtection;
+        }
+
+        void Flush() {
+            if (start != end)
+                nce.ApplyProtection(start, end, protection);
+            start = end = nullptr;
+        }
+
+        ~ProtectionCoalescer() {
+            Flush();
+        }
+    };
+
+    void NCE::ApplyProtection(u8 *start, u8 *end, int protection) {
+        if (writeProtector && protection != PROT_NONE) {
+            if (!writeProtectorRegistered) {
+                // The guest address space is only registered once it's in use as it doesn't exist yet when the NCE is created
+                auto &memory{state.process->memory};
+                if (memory.codeBase36Bit.valid() && !memory.codeBase36Bit.empty())
+                    writeProtector->Register(memory.codeBase36Bit);
+                writeProtector->Register(memory.base);
+                writeProtectorRegistered = true;
+            }
+
+            // Write-only protection is done with userfaultfd while the memory itself stays writable, write faults are then resolved without a signal
+            mprotect(start, static_cast<size_t>(end - start), PROT_READ | PROT_WRITE | PROT_EXEC);
+            bool protect{!(protection & PROT_WRITE)};
+            if (writeProtector->WriteProtect(start, end, protect))
+                return;
+
+            // Remapping memory (such as for svcMapMemory aliases) replaces the VMA and drops its registration, so the range is registered again before retrying
+            try {
+                writeProtector->Register(span<u8>{start, end});
+                if (writeProtector->WriteProtect(start, end, protect))
+                    return;
+            } catch (const std::exception &e) {
+                Logger::Debug("Falling back to mprotect for 0x{:X} - 0x{:X}: {}", start, end, e.what());
+            }
+        }
+
+        mprotect(start, static_cast<size_t>(end - start), protection);
+    }
+
+    void NCE::UserfaultHandler(u8 *address) {
+        if (!TrapHandler(address, true, nullptr)) { // The faulting thread isn't known as the write is reported through userfaultfd
+            // There's no trap on the page anymore, the protection is stale and has to be cleared to avoid the thread faulting on it indefinitely
+            std::scoped_lock lock{trapMutex};
+            u8 *page{util::AlignDown(address, constant::PageSize)};
+            if (!writeProtector->WriteProtect(page, page + constant::PageSize, false))
+                mprotect(page, constant::PageSize, PROT_READ | PROT_WRITE | PROT_EXEC); // The page is no longer registered so it can't be write-protected by userfaultfd either
+        }
+    }
 
-    void NCE::ReprotectIntervals(const std::vector<TrapMap::Interval> &intervals, TrapProtection protection) {
+    void NCE::ReprotectIntervals(const std::vector<TrapMap::Interval> &intervals, TrapProtection protection, bool deferrable) {
         TRACE_EVENT("host", "NCE::ReprotectIntervals");
 
-        auto reprotectIntervalsWithFunction = [&intervals](auto getProtection) {
+        if (protection == TrapProtection::None && deferrable && trapBatchDepth) {
+            // The protection of deferred intervals is only determined when they're flushed, so any traps that were added on them in the meantime are still respected
+            deferredIntervals.insert(deferredIntervals.end(), intervals.begin(), intervals.end());
+            return;
+        }
+
+        auto reprotectIntervalsWithFunction = [&intervals, this](auto getProtection) {
+            ProtectionCoalescer coalescer{*this};
             for (auto region : intervals) {
                 region = region.Align(constant::PageSize);
-                mprotect(region.start, region.Size(), getProtection(region));
+                coalescer.Protect(region.start, region.end, getProtection(region));
             }
         };
 
@@ -622,7 +1125,7 @@ namespace skyline::nce {
 
                 TrapProtection lowestProtection{TrapProtection::None};
                 for (const auto &entry : entries) {
-                    auto entryProtection{entry.get().protection};
+                    auto entryProtection{entry.get().protection.load()};
                     if (entryProtection > lowestProtection) {
                         lowestProtection = entryProtection;
                         if (entryProtection == TrapProtection::ReadWrite)
@@ -653,10 +1156,38 @@ namespace skyline::nce {
                 return PROT_NONE; // No checks are needed as this is already the highest level of protection
             });
         }
+
+        TRACE_COUNTER("host", "NCE Coalesced Reprotections", coalescedReprotections.load(std::memory_order_relaxed));
     }
 
-    bool NCE::TrapHandler(u8 *address, bool write) {
+    void NCE::FlushDeferredIntervals() {
+        if (deferredIntervals.empty())
+            return;
+
+        TRACE_EVENT("host", "NCE::FlushDeferredIntervals");
+
+        // Sorting the intervals allows neighbouring ones from separate traps to be coalesced into a single reprotection
+        std::sort(deferredIntervals.begin(), deferredIntervals.end(), [](const TrapMap::Interval &a, const TrapMap::Interval &b) { return a.start < b.start; });
+        auto intervals{std::move(deferredIntervals)};
+        deferredIntervals.clear();
+        ReprotectIntervals(intervals, TrapProtection::None, false);
+    }
+
+    bool NCE::TrapHandler(u8 *address, bool write, void *pc) {
         TRACE_EVENT("host", "NCE::TrapHandler");
+        trapStatistics.RecordFault(util::AlignDown(address, constant::PageSize), pc);
+        GetPerformanceStatistics().trapFaults.fetch_add(1, std::memory_order_relaxed);
+
+        {
+            // When multiple threads fault on the same trap, all but the first one will find it already resolved by the time they can lookup the page, they only need to retry the access
+            // This can only be determined for pages with a single entry as the protection of pages shared by multiple entries depends on all of them, and it's skipped while deferred reprotections are pending as they don't reflect the protection of entries
+            std::shared_lock lock{trapMutex};
+            if (deferredIntervals.empty()) {
+                auto entry{trapMap.GetExclusive<constant::PageSize>(address)};
+                if (entry && entry->protection.load(std::memory_order_acquire) <= (write ? TrapProtection::None : TrapProtection::WriteOnly))
+                    return true;
+            }
+        }
 
         LockCallback lockCallback{};
         while (true) {
@@ -666,31 +1197,70 @@ namespace skyline::nce {
                 lockCallback = {};
             }
 
-            std::scoped_lock lock(trapMutex);
+            // The trap map is only locked in shared mode as it isn't modified here, faults on unrelated traps are handled concurrently with them being serialized by the locks of the entries instead
+            std::shared_lock lock{trapMutex};
 
             // Retrieve any callbacks for the page that was faulted
             auto[entries, intervals]{trapMap.GetAlignedRecursiveRange<constant::PageSize>(address)};
-            if (entries.empty())
-                return false; // There's no callbacks associated with this page
+            if (entries.empty()) {
+                lock.unlock();
+                std::scoped_lock exclusiveLock{trapMutex};
+
+                // The page might still be protected due to a deferred removal of protection, flushing the batch early will resolve the fault
+                u8 *page{util::AlignDown(address, constant::PageSize)};
+                if (std::any_of(deferredIntervals.begin(), deferredIntervals.end(), [&](const TrapMap::Interval &interval) { return util::AlignDown(interval.start, constant::PageSize) <= page && page < interval.end; })) {
+                    FlushDeferredIntervals();
+                    return true;
+                }
+
+                // The trap might have been inserted while the map was unlocked, the access is retried in that case
+                return !trapMap.GetRange({page, page + constant::PageSize}).empty();
+            }
 
             // Do callbacks for every entry in the intervals
+            boost::container::small_vector<std::unique_lock<std::mutex>, 4> entryLocks;
             if (write) {
+                // If any entries track writes at page granularity, we can only unprotect the faulting page and therefore only need to do callbacks for the entries on it
+                u8 *page{util::AlignDown(address, constant::PageSize)};
+                bool pageGranular{std::any_of(entries.begin(), entries.end(), [](const CallbackEntry &entry) { return static_cast<bool>(entry.pageWriteCallback); })};
+                if (pageGranular)
+                    entries = trapMap.GetRange({page, page + constant::PageSize});
+
+                entryLocks = LockEntries(entries);
                 for (auto entryRef : entries) {
                     auto &entry{entryRef.get()};
                     if (entry.protection == TrapProtection::None)
                         // We don't need to do the callback if the entry doesn't require any protection already
                         continue;
 
+                    if (entry.pageWriteCallback) {
+                        if (!entry.pageWriteCallback(page)) {
+                            lockCallback = entry.lockCallback;
+                            break;
+                        }
+                        entry.protection = TrapProtection::WriteOnly; // Writes to all other pages of this entry still need to be trapped
+                        trapStatistics.RecordResourceFault(entry.resource, entry.resourceAddress, entry.resourceSize);
+                        continue;
+                    }
+
                     if (!entry.writeCallback()) {
                         lockCallback = entry.lockCallback;
                         break;
                     }
                     entry.protection = TrapProtection::None; // We don't need to protect this entry anymore
+                    trapStatistics.RecordResourceFault(entry.resource, entry.resourceAddress, entry.resourceSize);
                 }
                 if (lockCallback)
                     continue; // We need to retry the loop because a callback was blocking
+
+                if (pageGranular) {
+                    // Any other pages of non-granular entries will be unprotected on their next access without any callbacks as their protection is now none
+                    ApplyProtection(page, page + constant::PageSize, PROT_READ | PROT_WRITE | PROT_EXEC);
+                    return true;
+                }
             } else {
                 bool allNone{true}; // If all entries require no protection, we can protect to allow all accesses
+                entryLocks = LockEntries(entries);
                 for (auto entryRef : entries) {
                     auto &entry{entryRef.get()};
                     if (entry.protection < TrapProtection::ReadWrite) {
@@ -704,6 +1274,7 @@ namespace skyline::nce {
                         break;
                     }
                     entry.protection = TrapProtection::WriteOnly; // We only need to trap writes to this entry
+                    trapStatistics.RecordResourceFault(entry.resource, entry.resourceAddress, entry.resourceSize);
                 }
                 if (lockCallback)
                     continue; // We need to retry the loop because a callback was blocking
@@ -711,20 +1282,42 @@ namespace skyline::nce {
             }
 
             int permission{PROT_READ | (write ? PROT_WRITE : 0) | PROT_EXEC};
+            ProtectionCoalescer coalescer{*this};
             for (const auto &interval : intervals)
                 // Reprotect the interval to the lowest protection level that the callbacks performed allow
-                mprotect(interval.start, interval.Size(), permission);
+                coalescer.Protect(interval.start, interval.end, permission);
 
             return true;
         }
     }
 
+    boost::container::small_vector<std::unique_lock<std::mutex>, 4> NCE::LockEntries(const std::vector<std::reference_wrapper<CallbackEntry>> &entries) {
+        boost::container::small_vector<CallbackEntry *, 4> sortedEntries;
+        for (auto entry : entries)
+            sortedEntries.push_back(&entry.get());
+        std::sort(sortedEntries.begin(), sortedEntries.end());
+
+        boost::container::small_vector<std::unique_lock<std::mutex>, 4> locks;
+        for (auto entry : sortedEntries)
+            locks.emplace_back(entry->mutex);
+        return locks;
+    }
+
     constexpr NCE::TrapHandle::TrapHandle(const TrapMap::GroupHandle &handle) : TrapMap::GroupHandle(handle) {}
 
-    NCE::TrapHandle NCE::CreateTrap(span<span<u8>> regions, const LockCallback &lockCallback, const TrapCallback &readCallback, const TrapCallback &writeCallback) {
+    NCE::TrapHandle NCE::CreateTrap(TrapResource resource, span<span<u8>> regions, const LockCallback &lockCallback, const TrapCallback &readCallback, const TrapCallback &writeCallback) {
         TRACE_EVENT("host", "NCE::CreateTrap");
         std::scoped_lock lock{trapMutex};
         TrapHandle handle{trapMap.Insert(regions, CallbackEntry{TrapProtection::None, lockCallback, readCallback, writeCallback})};
+        handle->value.SetResource(resource, regions);
+        return handle;
+    }
+
+    NCE::TrapHandle NCE::CreatePageTrap(TrapResource resource, span<span<u8>> regions, const LockCallback &lockCallback, const TrapCallback &readCallback, const PageTrapCallback &writeCallback) {
+        TRACE_EVENT("host", "NCE::CreatePageTrap");
+        std::scoped_lock lock{trapMutex};
+        TrapHandle handle{trapMap.Insert(regions, CallbackEntry{TrapProtection::None, lockCallback, readCallback, {}, writeCallback})};
+        handle->value.SetResource(resource, regions);
         return handle;
     }
 
@@ -763,4 +1356,49 @@ namespace skyline::nce {
         ReprotectIntervals(handle->intervals, TrapProtection::None);
         trapMap.Remove(handle);
     }
+
+    void NCE::LogTrapStatistics() {
+        constexpr size_t LoggedOffenderCount{8}; //!< The amount of resources, pages and PCs with the most faults to log
+
+        auto report{trapStatistics.GetReport(LoggedOffenderCount)};
+        if (!report.totalFaults)
+            return;
+
+        std::string statistics{fmt::format("\n{} faults in total", report.totalFaults)};
+        for (size_t type{}; type < TrapResourceNames.size(); type++)
+            statistics += fmt::format(", {} on {}s", report.typeFaults[type], TrapResourceNames[type]);
+
+        statistics += "\nResources:";
+        for (const auto &resource : report.resources)
+            statistics += fmt::format("\n* {} @ 0x{:X} (0x{:X} bytes): {} faults", TrapResourceNames[static_cast<u8>(resource.type)], reinterpret_cast<uintptr_t>(resource.address), resource.size, resource.faults);
+
+        statistics += "\nPages:";
+        for (const auto &page : report.pages)
+            statistics += fmt::format("\n* 0x{:X}: {} faults", reinterpret_cast<uintptr_t>(page.key), page.faults);
+
+        statistics += "\nPCs:";
+        for (const auto &pc : report.pcs) {
+            if (!pc.key) {
+                statistics += fmt::format("\n* Unknown (userfaultfd): {} faults", pc.faults);
+                continue;
+            }
+
+            auto symbol{state.loader ? state.loader->ResolveSymbol(pc.key) : loader::Loader::SymbolInfo{}};
+            std::string_view location{symbol.name ? std::string_view{symbol.name} : symbol.executableName.empty() ? std::string_view{"host"} : symbol.executableName};
+            statistics += fmt::format("\n* 0x{:X} ({}): {} faults", reinterpret_cast<uintptr_t>(pc.key), location, pc.faults);
+        }
+
+        Logger::Info("NCE trap statistics:{}", statistics);
+    }
+
+    NCE::ScopedTrapBatch::ScopedTrapBatch(NCE &nce) : nce{nce} {
+        std::scoped_lock lock{nce.trapMutex};
+        nce.trapBatchDepth++;
+    }
+
+    NCE::ScopedTrapBatch::~ScopedTrapBatch() {
+        std::scoped_lock lock{nce.trapMutex};
+        if (--nce.trapBatchDepth == 0)
+            nce.FlushDeferredIntervals();
+    }
 }
@@ -8,6 +8,8 @@
 #include "common.h"
 #include "hle/symbol_hooks.h"
 #include "common/interval_map.h"
+#include "nce/userfault.h"
+#include "nce/trap_statistics.h"
 
 namespace skyline::nce {
     /**
@@ -29,26 +31,73 @@ namespace skyline::nce {
         };
 
         using TrapCallback = std::function<bool()>;
+        using PageTrapCallback = std::function<bool(u8 *page)>;
         using LockCallback = std::function<void()>;
 
         struct CallbackEntry {
-            TrapProtection protection; //!< The least restrictive protection that this callback needs to have
+            std::mutex mutex; //!< Synchronizes trap handlers with each other when they're handling faults on this entry concurrently, this must be locked with LockEntries
+            std::atomic<TrapProtection> protection; //!< The least restrictive protection that this callback needs to have
             LockCallback lockCallback;
             TrapCallback readCallback, writeCallback;
+            PageTrapCallback pageWriteCallback; //!< If set, writes are trapped at page granularity and this is called instead of `writeCallback` with only the faulting page being unprotected
+            TrapResource resource{}; //!< The kind of resource this entry traps memory for, this is only used for statistics
+            u8 *resourceAddress{}; //!< The start of the first region of the trap
+            size_t resourceSize{}; //!< The total size of all regions of the trap
 
-            CallbackEntry(TrapProtection protection, LockCallback lockCallback, TrapCallback readCallback, TrapCallback writeCallback);
+            CallbackEntry(TrapProtection protection, LockCallback lockCallback, TrapCallback readCallback, TrapCallback writeCallback, PageTrapCallback pageWriteCallback = {});
+
+            CallbackEntry(CallbackEntry &&other);
+
+            /**
+             * @brief Sets the resource this entry is attributed to in the trap statistics from the regions it traps
+             */
+            void SetResource(TrapResource resource, span<span<u8>> regions);
         };
 
-        std::mutex trapMutex; //!< Synchronizes the accesses to the trap map
+        std::shared_mutex trapMutex; //!< Synchronizes the accesses to the trap map, trap handlers only lock it in shared mode and lock the entries they're handling instead
         using TrapMap = IntervalMap<u8*, CallbackEntry>;
         TrapMap trapMap; //!< A map of all intervals and corresponding callbacks that have been registered
+        u32 trapBatchDepth{}; //!< The amount of active ScopedTrapBatch instances, reprotections that remove protection are deferred while this is non-zero
+        std::vector<TrapMap::Interval> deferredIntervals; //!< Intervals with a deferred removal of protection, their protection is determined when the batch is flushed
+        std::atomic<u64> coalescedReprotections{}; //!< The total amount of mprotect calls that have been avoided by coalescing or batching reprotections
+        std::unique_ptr<UserfaultWriteProtector> writeProtector; //!< If set, write-only protection is applied with userfaultfd rather than mprotect
+        bool writeProtectorRegistered{}; //!< If the guest address space has been registered with the write protector, this is done lazily on the first reprotection
+        TrapStatistics trapStatistics;
+
+        class ProtectionCoalescer;
+
+        /**
+         * @brief Applies the supplied mprotect protection to a page-aligned region, write-only protection is applied with the userfaultfd write protector when it's available
+         * @note The trap mutex must be locked when calling this
+         */
+        void ApplyProtection(u8 *start, u8 *end, int protection);
+
+        /**
+         * @brief Handles a write fault reported by the userfaultfd write protector on its thread
+         */
+        void UserfaultHandler(u8 *address);
 
         /**
          * @brief Reprotects the intervals to the least restrictive protection given the supplied protection
+         * @param deferrable If a removal of protection can be deferred until the end of the active batch, if there is one
+         */
+        void ReprotectIntervals(const std::vector<TrapMap::Interval>& intervals, TrapProtection protection, bool deferrable = true);
+
+        /**
+         * @brief Reprotects all deferred intervals with adjacent intervals of the same protection being coalesced
+         * @note The trap mutex must be locked when calling this
+         */
+        void FlushDeferredIntervals();
+
+        /**
+         * @brief Locks all supplied entries in a consistent order to prevent deadlocks between concurrent trap handlers
          */
-        void ReprotectIntervals(const std::vector<TrapMap::Interval>& intervals, TrapProtection protection);
+        static boost::container::small_vector<std::unique_lock<std::mutex>, 4> LockEntries(const std::vector<std::reference_wrapper<CallbackEntry>> &entries);
 
-        bool TrapHandler(u8* address, bool write);
+        /**
+         * @param pc The PC of the faulting instruction, this is only used for statistics and may be nullptr if it's unknown
+         */
+        bool TrapHandler(u8* address, bool write, void *pc);
 
         static void SvcHandler(u16 svcId, ThreadContext *ctx);
 
@@ -69,7 +118,15 @@ namespace skyline::nce {
 
         static void HookHandler(HookId hookId, ThreadContext *ctx);
 
+        /**
+         * @brief Yields the calling thread when it reaches a safepoint in guest code with a yield pending on it
+         * @note The first argument is unused, it's only present to share the calling convention of the trampoline with the other handlers
+         */
+        static void SafepointHandler(u64, ThreadContext *ctx);
+
       public:
+        const bool cooperativeYield; //!< If loop back-edges in guest code are patched into safepoints which poll ThreadContext::yieldPending, yields are requested using the flag rather than a signal when this is set
+
         /**
          * @brief An exception which causes the throwing thread to exit alongside all threads optionally
          * @note Exiting must not be performed directly as it could leak temporary objects on the stack by not calling their destructors
@@ -105,14 +162,27 @@ namespace skyline::nce {
             std::vector<size_t> offsets; //!< Offsets in .text of instructions that need to be patched
         };
 
-        static PatchData GetPatchData(const std::vector<u8> &text);
+      private:
+        /**
+         * @brief Scans a range of instructions in .text for ones that need to be patched
+         * @param begin The index of the first instruction in the range
+         * @param end The index of the instruction after the last one in the range
+         * @return The patch data for the range, its size is the amount of instructions in the .patch section it requires rather than being in bytes
+         */
+        PatchData ScanPatchRange(span<const u32> text, size_t begin, size_t end);
+
+      public:
+        /**
+         * @param buildId The build ID of the executable, if supplied the patch data is cached on disk by it and loaded from the cache on subsequent calls
+         */
+        PatchData GetPatchData(const std::vector<u8> &text, span<u8> buildId = {});
 
         /**
          * @brief Writes the .patch section and mutates the code accordingly
          * @param patch A pointer to the .patch section which should be exactly patchSize in size and located before the .text section
          * @param textOffset The offset of the .text section, this must be page-aligned
          */
-        static void PatchCode(std::vector<u8> &text, u32 *patch, size_t patchSize, const std::vector<size_t> &offsets, size_t textOffset = 0);
+        void PatchCode(std::vector<u8> &text, u32 *patch, size_t patchSize, const std::vector<size_t> &offsets, size_t textOffset = 0);
 
         struct HookedSymbolEntry : hle::HookedSymbol {
             Elf64_Addr* offset{}; //!< A pointer to the hooked function's offset (st_value) in the ELF's dynsym, this is set by the loader and is used to resolve/update the address of the function
@@ -135,6 +205,7 @@ namespace skyline::nce {
 
         /**
          * @brief Creates a region of guest memory that can be trapped with a callback for when an access to it has been made
+         * @param resource The kind of resource the region is trapped for, faults are attributed to it in the trap statistics
          * @param lockCallback A callback to lock the resource that is being trapped, it must block until the resource is locked but unlock it prior to returning
          * @param readCallback A callback for read accesses to the trapped region, it must not block and return a boolean if it would block
          * @param writeCallback A callback for write accesses to the trapped region, it must not block and return a boolean if it would block
@@ -142,7 +213,14 @@ namespace skyline::nce {
          * @note It is UB to supply a region of host memory rather than guest memory
          * @note This doesn't trap the region in itself, any trapping must be done via TrapRegions(...)
          */
-        TrapHandle CreateTrap(span<span<u8>> regions, const LockCallback& lockCallback, const TrapCallback& readCallback, const TrapCallback& writeCallback);
+        TrapHandle CreateTrap(TrapResource resource, span<span<u8>> regions, const LockCallback& lockCallback, const TrapCallback& readCallback, const TrapCallback& writeCallback);
+
+        /**
+         * @brief Creates a region of guest memory that can be trapped with writes being tracked at page granularity, a write will only unprotect the page it occurred in rather than all regions
+         * @param writeCallback A callback for write accesses to a page of the trapped region which is supplied the page-aligned address, it must not block and return a boolean if it would block
+         * @note All other semantics are identical to CreateTrap(...)
+         */
+        TrapHandle CreatePageTrap(TrapResource resource, span<span<u8>> regions, const LockCallback& lockCallback, const TrapCallback& readCallback, const PageTrapCallback& writeCallback);
 
         /**
          * @brief Re-traps a region of memory after protections were removed
@@ -166,5 +244,24 @@ namespace skyline::nce {
          * @brief Deletes a trap handle and removes the protection from the region
          */
         void DeleteTrap(TrapHandle handle);
+
+        /**
+         * @brief Logs the trapped resources, guest pages and PCs with the most faults since the NCE instance was created
+         */
+        void LogTrapStatistics();
+
+        /**
+         * @brief Batches all removals of trap protection that occur during its lifetime into coalesced reprotections when it's destroyed
+         * @note Adding protection is never deferred as callers rely on it being in effect before they access the memory, an access to memory with a deferred removal flushes the batch
+         */
+        class ScopedTrapBatch {
+          private:
+            NCE &nce;
+
+          public:
+            ScopedTrapBatch(NCE &nce);
+
+            ~ScopedTrapBatch();
+        };
     };
 }
@@ -100,8 +100,20 @@ namespace skyline {
             u8 *tpidrEl0; //!< Emulated HOS TPIDR_EL0
             const DeviceState *state;
             u64 magic{constant::SkyTlsMagic};
+            std::atomic<u32> yieldPending{}; //!< If the thread should yield at the next safepoint in guest code, this is polled by patched code rather than delivering a signal
+            const u8 *coreId{}; //!< A pointer to the ID of the core the thread is running on (KThread::coreId), this is read by the inline GetCurrentProcessorNumber SVC stub
+            u64 threadId{}; //!< The ID of the thread (KThread::id), this is read by the inline GetThreadId SVC stub
         };
 
+        // Patched guest code and the trampolines in nce.cpp access these members with hard-coded offsets
+        static_assert(offsetof(ThreadContext, hostTpidrEl0) == 0x2A0);
+        static_assert(offsetof(ThreadContext, hostSp) == 0x2A8);
+        static_assert(offsetof(ThreadContext, tpidrroEl0) == 0x2B0);
+        static_assert(offsetof(ThreadContext, tpidrEl0) == 0x2B8);
+        static_assert(offsetof(ThreadContext, yieldPending) == 0x2D0);
+        static_assert(offsetof(ThreadContext, coreId) == 0x2D8);
+        static_assert(offsetof(ThreadContext, threadId) == 0x2E0);
+
         namespace guest {
             constexpr size_t SaveCtxSize{34}; //!< The size of the SaveCtx function in 32-bit ARMv8 instructions
             constexpr size_t LoadCtxSize{34}; //!< The size of the LoadCtx function in 32-bit ARMv8 instructions
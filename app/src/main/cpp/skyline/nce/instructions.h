@@ -155,6 +155,71 @@ namespace skyline::nce {
         };
         static_assert(sizeof(BL) == sizeof(u32));
 
+        /**
+         * @url https://developer.arm.com/documentation/ddi0596/2021-12/Base-Instructions/B-cond--Branch-conditionally-
+         */
+        struct BCond {
+            constexpr bool Verify() {
+                return (sig0 == 0x0) && (sig1 == 0x54);
+            }
+
+            union {
+                struct __attribute__((packed)) {
+                    u8 cond : 4; //!< 4-bit condition code
+                    u8 sig0 : 1; //!< 1-bit signature (0x0)
+                    i32 offset : 19; //!< 19-bit branch offset
+                    u8 sig1 : 8; //!< 8-bit signature (0x54)
+                };
+                u32 raw{};
+            };
+        };
+        static_assert(sizeof(BCond) == sizeof(u32));
+
+        /**
+         * @brief A CBZ or CBNZ instruction
+         * @url https://developer.arm.com/documentation/ddi0596/2021-12/Base-Instructions/CBZ--Compare-and-Branch-on-Zero-
+         */
+        struct CompareBranch {
+            constexpr bool Verify() {
+                return (sig == 0x1A);
+            }
+
+            union {
+                struct __attribute__((packed)) {
+                    u8 reg : 5; //!< 5-bit register which is compared against zero
+                    i32 offset : 19; //!< 19-bit branch offset
+                    u8 nonZero : 1; //!< If the branch is taken when the register is non-zero (CBNZ)
+                    u8 sig : 6; //!< 6-bit signature (0x1A)
+                    u8 sf : 1; //!< 1-bit register type
+                };
+                u32 raw{};
+            };
+        };
+        static_assert(sizeof(CompareBranch) == sizeof(u32));
+
+        /**
+         * @brief A TBZ or TBNZ instruction
+         * @url https://developer.arm.com/documentation/ddi0596/2021-12/Base-Instructions/TBZ--Test-bit-and-Branch-if-Zero-
+         */
+        struct TestBranch {
+            constexpr bool Verify() {
+                return (sig == 0x1B);
+            }
+
+            union {
+                struct __attribute__((packed)) {
+                    u8 reg : 5; //!< 5-bit register which contains the tested bit
+                    i32 offset : 14; //!< 14-bit branch offset
+                    u8 bitLower : 5; //!< The lower 5 bits of the index of the tested bit
+                    u8 nonZero : 1; //!< If the branch is taken when the bit is set (TBNZ)
+                    u8 sig : 6; //!< 6-bit signature (0x1B)
+                    u8 bitUpper : 1; //!< The upper bit of the index of the tested bit
+                };
+                u32 raw{};
+            };
+        };
+        static_assert(sizeof(TestBranch) == sizeof(u32));
+
         /**
          * @url https://developer.arm.com/docs/ddi0596/e/base-instructions-alphabetic-order/movz-move-wide-with-zero
          */
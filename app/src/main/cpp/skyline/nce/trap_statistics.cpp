@@ -0,0 +1,50 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2023 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#include "trap_statistics.h"
+
+namespace skyline::nce {
+    void TrapStatistics::RecordFault(u8 *page, void *pc) {
+        std::scoped_lock lock{mutex};
+        totalFaults++;
+        pageFaults[page]++;
+        pcFaults[pc]++;
+    }
+
+    void TrapStatistics::RecordResourceFault(TrapResource type, u8 *address, size_t size) {
+        std::scoped_lock lock{mutex};
+        typeFaults[static_cast<u8>(type)]++;
+
+        auto &resource{resourceFaults.try_emplace(address, ResourceFaults{type, address, size, 0}).first.value()};
+        resource.type = type;
+        resource.size = size;
+        resource.faults++;
+    }
+
+    /**
+     * @return The entries of the map with the most faults in descending order
+     */
+    template<typename MapType, typename Transformation>
+    static auto GetTopOffenders(const MapType &map, size_t count, Transformation transformation) {
+        std::vector<decltype(transformation(*map.begin()))> offenders;
+        offenders.reserve(map.size());
+        for (const auto &entry : map)
+            offenders.push_back(transformation(entry));
+
+        count = std::min(count, offenders.size());
+        std::partial_sort(offenders.begin(), offenders.begin() + static_cast<ssize_t>(count), offenders.end(), [](const auto &a, const auto &b) { return a.faults > b.faults; });
+        offenders.resize(count);
+        return offenders;
+    }
+
+    TrapStatistics::Report TrapStatistics::GetReport(size_t count) {
+        std::scoped_lock lock{mutex};
+        return Report{
+            .totalFaults = totalFaults,
+            .typeFaults = typeFaults,
+            .resources = GetTopOffenders(resourceFaults, count, [](const auto &entry) { return entry.second; }),
+            .pages = GetTopOffenders(pageFaults, count, [](const auto &entry) { return Offender<u8 *>{entry.first, entry.second}; }),
+            .pcs = GetTopOffenders(pcFaults, count, [](const auto &entry) { return Offender<void *>{entry.first, entry.second}; }),
+        };
+    }
+}
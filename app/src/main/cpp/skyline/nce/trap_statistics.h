@@ -0,0 +1,79 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2023 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#pragma once
+
+#include <tsl/robin_map.h>
+#include <common.h>
+
+namespace skyline::nce {
+    /**
+     * @brief The kind of host resource that a trap tracks guest memory for
+     */
+    enum class TrapResource : u8 {
+        Buffer,
+        Texture,
+        Shader,
+    };
+
+    constexpr std::array<const char *, 3> TrapResourceNames{
+        "Buffer",
+        "Texture",
+        "Shader",
+    };
+
+    /**
+     * @brief Counts the faults handled by NCE::TrapHandler per trapped resource, per guest page and per faulting PC, this is used to find the resources and code responsible for trap storms
+     */
+    class TrapStatistics {
+      public:
+        struct ResourceFaults {
+            TrapResource type;
+            u8 *address; //!< The start of the first region of the resource, this identifies it across recreations of its trap
+            size_t size; //!< The total size of all regions of the resource
+            u64 faults;
+        };
+
+        template<typename KeyType>
+        struct Offender {
+            KeyType key;
+            u64 faults;
+        };
+
+        /**
+         * @brief A snapshot of the statistics with only the offenders with the most faults
+         */
+        struct Report {
+            u64 totalFaults;
+            std::array<u64, TrapResourceNames.size()> typeFaults;
+            std::vector<ResourceFaults> resources;
+            std::vector<Offender<u8 *>> pages;
+            std::vector<Offender<void *>> pcs;
+        };
+
+      private:
+        std::mutex mutex;
+        u64 totalFaults{};
+        std::array<u64, TrapResourceNames.size()> typeFaults{};
+        tsl::robin_map<u8 *, ResourceFaults> resourceFaults; //!< A map from the address of a resource to its faults
+        tsl::robin_map<u8 *, u64> pageFaults; //!< A map from a guest page to the faults on it
+        tsl::robin_map<void *, u64> pcFaults; //!< A map from the PC of faulting code to its faults, host code is included as it may access trapped guest memory
+
+      public:
+        /**
+         * @brief Records a fault on the supplied page, this must be called once for every fault
+         * @param pc The PC of the faulting instruction or nullptr if it's unknown
+         */
+        void RecordFault(u8 *page, void *pc);
+
+        /**
+         * @brief Records a fault on a resource that had a callback done for it, this may be called for every resource on the faulting page
+         */
+        void RecordResourceFault(TrapResource type, u8 *address, size_t size);
+
+        /**
+         * @param count The maximum amount of offenders of every kind to report
+         */
+        Report GetReport(size_t count);
+    };
+}
@@ -0,0 +1,112 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2023 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/userfaultfd.h>
+#include "userfault.h"
+
+namespace skyline::nce {
+    UserfaultWriteProtector::UserfaultWriteProtector(FaultCallback faultCallback) : faultCallback{std::move(faultCallback)} {
+        // Guest code can only fault in usermode, restricting the userfaultfd to usermode faults also allows creating it without any privileges
+        uffd = static_cast<int>(syscall(__NR_userfaultfd, O_CLOEXEC | O_NONBLOCK | UFFD_USER_MODE_ONLY));
+        if (uffd == -1)
+            throw exception("Failed to create userfaultfd: {}", strerror(errno));
+
+        uffdio_api api{
+            .api = UFFD_API,
+            .features = UFFD_FEATURE_PAGEFAULT_FLAG_WP | UFFD_FEATURE_WP_HUGETLBFS_SHMEM,
+        };
+        if (ioctl(uffd, UFFDIO_API, &api) == -1)
+            throw exception("Kernel doesn't support userfaultfd write-protection of shared memory: {}", strerror(errno));
+
+        exitEvent = eventfd(0, EFD_CLOEXEC);
+        if (exitEvent == -1)
+            throw exception("Failed to create eventfd: {}", strerror(errno));
+
+        faultThread = std::thread{&UserfaultWriteProtector::FaultThread, this};
+    }
+
+    UserfaultWriteProtector::~UserfaultWriteProtector() {
+        u64 value{1};
+        if (write(exitEvent, &value, sizeof(value)) == sizeof(value) && faultThread.joinable())
+            faultThread.join();
+        else
+            faultThread.detach();
+    }
+
+    void UserfaultWriteProtector::FaultThread() {
+        if (int result{pthread_setname_np(pthread_self(), "Sky-Userfault")})
+            Logger::Warn("Failed to set the thread name: {}", strerror(result));
+
+        std::array<pollfd, 2> fds{
+            pollfd{.fd = uffd, .events = POLLIN},
+            pollfd{.fd = exitEvent, .events = POLLIN},
+        };
+
+        while (true) {
+            if (poll(fds.data(), fds.size(), -1) == -1) {
+                if (errno == EINTR)
+                    continue;
+                Logger::Error("Failed to poll userfaultfd: {}", strerror(errno));
+                return;
+            }
+
+            if (fds[1].revents)
+                return;
+
+            uffd_msg message;
+            while (read(uffd, &message, sizeof(message)) == sizeof(message)) {
+                if (message.event != UFFD_EVENT_PAGEFAULT || !(message.arg.pagefault.flags & UFFD_PAGEFAULT_FLAG_WP))
+                    continue;
+
+                auto address{reinterpret_cast<u8 *>(message.arg.pagefault.address)};
+                try {
+                    faultCallback(address);
+                } catch (const std::exception &e) {
+                    Logger::Error("Userfault write callback failed: {}", e.what());
+                }
+
+                // The callback might not have cleared protection on the page, the faulting thread would fault again in that case rather than being blocked indefinitely
+                Wake(util::AlignDown(address, constant::PageSize));
+            }
+        }
+    }
+
+    void UserfaultWriteProtector::Register(span<u8> region) {
+        uffdio_register registration{
+            .range = {
+                .start = reinterpret_cast<u64>(region.data()),
+                .len = region.size(),
+            },
+            .mode = UFFDIO_REGISTER_MODE_WP,
+        };
+        if (ioctl(uffd, UFFDIO_REGISTER, &registration) == -1)
+            throw exception("Failed to register 0x{:X} - 0x{:X} with userfaultfd: {}", region.data(), region.end().base(), strerror(errno));
+
+        if (!(registration.ioctls & (1ULL << _UFFDIO_WRITEPROTECT)))
+            throw exception("Kernel doesn't support userfaultfd write-protection for 0x{:X} - 0x{:X}", region.data(), region.end().base());
+    }
+
+    bool UserfaultWriteProtector::WriteProtect(u8 *start, u8 *end, bool protect) {
+        uffdio_writeprotect writeProtect{
+            .range = {
+                .start = reinterpret_cast<u64>(start),
+                .len = static_cast<u64>(end - start),
+            },
+            .mode = protect ? UFFDIO_WRITEPROTECT_MODE_WP : 0,
+        };
+        return ioctl(uffd, UFFDIO_WRITEPROTECT, &writeProtect) != -1;
+    }
+
+    void UserfaultWriteProtector::Wake(u8 *page) {
+        uffdio_range range{
+            .start = reinterpret_cast<u64>(page),
+            .len = constant::PageSize,
+        };
+        ioctl(uffd, UFFDIO_WAKE, &range);
+    }
+}
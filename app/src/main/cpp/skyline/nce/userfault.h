@@ -0,0 +1,48 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2023 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#pragma once
+
+#include <common.h>
+#include <common/file_descriptor.h>
+
+namespace skyline::nce {
+    /**
+     * @brief A backend for write-protecting memory with userfaultfd, write faults are resolved by a dedicated thread rather than by delivering a SIGSEGV to the faulting thread
+     * @note Write-protection of shmem-backed memory (which all guest memory is) requires Linux 5.19 or newer, construction throws an exception if the kernel doesn't support it
+     */
+    class UserfaultWriteProtector {
+      public:
+        using FaultCallback = std::function<void(u8 *address)>;
+
+      private:
+        FileDescriptor uffd; //!< The userfaultfd which all write-protected memory is registered with
+        FileDescriptor exitEvent; //!< An eventfd which is signalled to stop the fault thread
+        FaultCallback faultCallback; //!< Called on the fault thread for every write to protected memory, the faulting thread is woken after it returns
+        std::thread faultThread;
+
+        void FaultThread();
+
+      public:
+        UserfaultWriteProtector(FaultCallback faultCallback);
+
+        ~UserfaultWriteProtector();
+
+        /**
+         * @brief Registers a page-aligned region of memory for write-protection, this doesn't protect the region in itself
+         */
+        void Register(span<u8> region);
+
+        /**
+         * @brief Sets or clears write-protection on a page-aligned region of registered memory
+         * @return If the protection was applied, this fails if any part of the region isn't registered (such as after it was replaced by a new mapping) with `errno` set accordingly
+         * @note Any threads blocked on a write fault inside the region are woken when protection is cleared
+         */
+        bool WriteProtect(u8 *start, u8 *end, bool protect);
+
+        /**
+         * @brief Wakes any threads blocked on a write fault to the supplied page, they'll fault again if the page is still write-protected
+         */
+        void Wake(u8 *page);
+    };
+}
@@ -5,11 +5,17 @@
 #include "nce/guest.h"
 #include "kernel/types/KProcess.h"
 #include "vfs/os_backing.h"
+#include "vfs/os_filesystem.h"
+#include "common/boot_profile.h"
+#include "common/memory_accounting.h"
+#include "common/title_profile.h"
 #include "loader/nro.h"
 #include "loader/nso.h"
 #include "loader/nca.h"
 #include "loader/nsp.h"
 #include "loader/xci.h"
+#include "loader/kernel_benchmark.h"
+#include "gpu.h"
 #include "os.h"
 
 namespace skyline::kernel {
@@ -31,9 +37,16 @@ namespace skyline::kernel {
 
     void OS::Execute(int romFd, loader::RomFormat romType) {
         auto romFile{std::make_shared<vfs::OsBacking>(romFd)};
-        auto keyStore{std::make_shared<crypto::KeyStore>(privateAppFilesPath + "keys/")};
+        auto keyStore{[&]() {
+            ScopedBootPhase bootPhase{BootProfile::Phase::KeyLoading};
+            return std::make_shared<crypto::KeyStore>(privateAppFilesPath + "keys/");
+        }()};
 
         state.loader = [&]() -> std::shared_ptr<loader::Loader> {
+            ScopedBootPhase bootPhase{BootProfile::Phase::ContainerParsing};
+            if (*state.settings->kernelBenchmark)
+                return std::make_shared<loader::KernelBenchmarkLoader>(); // The ROM is ignored entirely as the benchmark is a synthetic guest
+
             switch (romType) {
                 case loader::RomFormat::NRO:
                     return std::make_shared<loader::NroLoader>(std::move(romFile));
@@ -54,6 +67,13 @@ namespace skyline::kernel {
         process = std::make_shared<kernel::type::KProcess>(state);
 
         auto entry{state.loader->LoadProcessData(process, state)};
+        if (auto profile{TitleProfile::Load(publicAppFilesPath, process->npdm.aci0.programId)}) {
+            Logger::Info("Applying the performance profile for {:016X}", profile->titleId);
+            state.settings->SetTitleProfile(std::move(profile));
+        }
+        if (*state.settings->verifyIntegrity)
+            state.loader->StartIntegrityVerification();
+        state.gpu->LoadTitleCaches(process->npdm.aci0.programId);
         auto &nacp{state.loader->nacp};
         if (nacp) {
             std::string name{nacp->GetApplicationName(language::ApplicationLanguage::AmericanEnglish)}, publisher{nacp->GetApplicationPublisher(language::ApplicationLanguage::AmericanEnglish)};
@@ -71,6 +91,19 @@ namespace skyline::kernel {
             Logger::EmulationContext.Flush();
             thread->Start(true);
             process->Kill(true, true, true);
+            process->LogSvcStatistics();
+            state.nce->LogTrapStatistics();
+            GetMemoryAccounting().Sample(MemoryCategory::GuestMemory, process->memory.GetUserMemoryUsage());
+            GetMemoryAccounting().Log("Process exit");
+            serviceManager.LogCommandStatistics();
+
+            if (auto benchmark{std::dynamic_pointer_cast<loader::KernelBenchmarkLoader>(state.loader)}) {
+                try {
+                    benchmark->WriteReport(std::make_shared<vfs::OsFileSystem>(publicAppFilesPath + "benchmarks/"));
+                } catch (const std::exception &e) {
+                    Logger::Warn("Failed to write the kernel benchmark report: {}", e.what());
+                }
+            }
         }
     }
 }
@@ -32,7 +32,15 @@ namespace skyline::service::am {
         i64 size{request.Pop<i64>()};
         if (size < 0)
             throw exception("Cannot create an IStorage with a negative size");
-        manager.RegisterService(SRVREG(TransferMemoryIStorage, state.process->GetHandle<kernel::type::KTransferMemory>(request.copyHandles.at(0)), writable), session, response);
+        manager.RegisterService(SRVREG(TransferMemoryIStorage, state.process->GetHandle<kernel::type::KTransferMemory>(request.copyHandles.at(0)), static_cast<size_t>(size), writable), session, response);
+        return {};
+    }
+
+    Result ILibraryAppletCreator::CreateHandleStorage(type::KSession &session, ipc::IpcRequest &request, ipc::IpcResponse &response) {
+        i64 size{request.Pop<i64>()};
+        if (size < 0)
+            throw exception("Cannot create an IStorage with a negative size");
+        manager.RegisterService(SRVREG(TransferMemoryIStorage, state.process->GetHandle<kernel::type::KTransferMemory>(request.copyHandles.at(0)), static_cast<size_t>(size), true), session, response);
         return {};
     }
 }
@@ -31,10 +31,18 @@ namespace skyline::service::am {
          */
         Result CreateTransferMemoryStorage(type::KSession &session, ipc::IpcRequest &request, ipc::IpcResponse &response);
 
+        /**
+         * @brief Creates an IStorage that can be used by the application, backed by the supplied transfer memory handle
+         * @note The storage directly shares the transfer memory rather than copying its contents
+         * @url https://switchbrew.org/wiki/Applet_Manager_services#CreateHandleStorage
+         */
+        Result CreateHandleStorage(type::KSession &session, ipc::IpcRequest &request, ipc::IpcResponse &response);
+
         SERVICE_DECL(
             SFUNC(0x0, ILibraryAppletCreator, CreateLibraryApplet),
             SFUNC(0xA, ILibraryAppletCreator, CreateStorage),
-            SFUNC(0xB, ILibraryAppletCreator, CreateTransferMemoryStorage)
+            SFUNC(0xB, ILibraryAppletCreator, CreateTransferMemoryStorage),
+            SFUNC(0xC, ILibraryAppletCreator, CreateHandleStorage)
         )
     };
 }
@@ -6,10 +6,10 @@
 #include <utility>
 
 namespace skyline::service::am {
-    TransferMemoryIStorage::TransferMemoryIStorage(const DeviceState &state, ServiceManager &manager, std::shared_ptr<kernel::type::KTransferMemory> transferMemory, bool writable) : transferMemory(std::move(transferMemory)), IStorage(state, manager, writable) {}
+    TransferMemoryIStorage::TransferMemoryIStorage(const DeviceState &state, ServiceManager &manager, std::shared_ptr<kernel::type::KTransferMemory> transferMemory, size_t size, bool writable) : transferMemory(std::move(transferMemory)), size(size), IStorage(state, manager, writable) {}
 
     span<u8> TransferMemoryIStorage::GetSpan() {
-        return transferMemory->host;
+        return transferMemory->host.first(std::min(size, transferMemory->host.size()));
     }
 
     TransferMemoryIStorage::~TransferMemoryIStorage() = default;
@@ -10,14 +10,16 @@
 namespace skyline::service::am {
     /**
      * @brief An IStorage backed by a transfer memory supplied by the guest
+     * @note The contents are never copied, reads and writes through the storage directly access the transfer memory
      */
     class TransferMemoryIStorage : public IStorage {
       private:
         std::shared_ptr<kernel::type::KTransferMemory> transferMemory;
+        size_t size; //!< The size of the storage, this may be smaller than the transfer memory
 
       public:
 
-        TransferMemoryIStorage(const DeviceState &state, ServiceManager &manager, std::shared_ptr<kernel::type::KTransferMemory> transferMemory, bool writable);
+        TransferMemoryIStorage(const DeviceState &state, ServiceManager &manager, std::shared_ptr<kernel::type::KTransferMemory> transferMemory, size_t size, bool writable);
 
         ~TransferMemoryIStorage() override;
 
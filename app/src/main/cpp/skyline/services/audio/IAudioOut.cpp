@@ -18,7 +18,7 @@ namespace skyline::service::audio {
     }
 
     Result IAudioOut::GetAudioOutState(type::KSession &session, ipc::IpcRequest &request, ipc::IpcResponse &response) {
-        response.Push(static_cast<u32>(track->playbackState));
+        response.Push(static_cast<u32>(track->playbackState.load()));
         return {};
     }
 
@@ -48,8 +48,9 @@ namespace skyline::service::audio {
 
         span samples(data.sampleBuffer, data.sampleSize / sizeof(i16));
         if (sampleRate != constant::SampleRate) {
-            auto resampledBuffer{resampler.ResampleBuffer(samples, static_cast<double>(sampleRate) / constant::SampleRate, channelCount)};
-            track->AppendBuffer(tag, resampledBuffer);
+            auto ratio{static_cast<double>(sampleRate) / constant::SampleRate};
+            resampledBuffer.resize(skyline::audio::Resampler::GetMaxOutputSize(samples.size(), ratio, channelCount));
+            track->AppendBuffer(tag, span(resampledBuffer).first(resampler.Resample(samples, resampledBuffer, ratio, channelCount)));
         } else {
             track->AppendBuffer(tag, samples);
         }
@@ -83,4 +84,20 @@ namespace skyline::service::audio {
         response.Push(static_cast<u32>(track->ContainsBuffer(tag)));
         return {};
     }
+
+    Result IAudioOut::SetAudioOutVolume(type::KSession &session, ipc::IpcRequest &request, ipc::IpcResponse &response) {
+        auto volume{request.Pop<float>()};
+        if (!std::isfinite(volume) || volume < 0.0f) {
+            Logger::Warn("Ignoring invalid volume: {}", volume);
+            return {};
+        }
+
+        track->volume.store(volume, std::memory_order_relaxed);
+        return {};
+    }
+
+    Result IAudioOut::GetAudioOutVolume(type::KSession &session, ipc::IpcRequest &request, ipc::IpcResponse &response) {
+        response.Push(track->volume.load(std::memory_order_relaxed));
+        return {};
+    }
 }
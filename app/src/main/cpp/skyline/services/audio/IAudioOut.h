@@ -15,6 +15,7 @@ namespace skyline::service::audio {
     class IAudioOut : public BaseService {
       private:
         skyline::audio::Resampler resampler; //!< The audio resampler object used to resample audio
+        std::vector<i16> resampledBuffer; //!< A buffer for the output of the resampler which is reused across appended buffers
         std::shared_ptr<skyline::audio::AudioTrack> track; //!< The audio track associated with the audio out
         std::shared_ptr<type::KEvent> releaseEvent; //!< The KEvent that is signalled when a buffer has been released
 
@@ -75,6 +76,17 @@ namespace skyline::service::audio {
          */
         Result ContainsAudioOutBuffer(type::KSession &session, ipc::IpcRequest &request, ipc::IpcResponse &response);
 
+        /**
+         * @brief Sets the volume the samples of the audio output are scaled by
+         * @url https://switchbrew.org/wiki/Audio_services#SetAudioOutVolume
+         */
+        Result SetAudioOutVolume(type::KSession &session, ipc::IpcRequest &request, ipc::IpcResponse &response);
+
+        /**
+         * @url https://switchbrew.org/wiki/Audio_services#GetAudioOutVolume
+         */
+        Result GetAudioOutVolume(type::KSession &session, ipc::IpcRequest &request, ipc::IpcResponse &response);
+
         SERVICE_DECL(
             SFUNC(0x0, IAudioOut, GetAudioOutState),
             SFUNC(0x1, IAudioOut, StartAudioOut),
@@ -84,7 +96,9 @@ namespace skyline::service::audio {
             SFUNC(0x5, IAudioOut, GetReleasedAudioOutBuffer),
             SFUNC(0x6, IAudioOut, ContainsAudioOutBuffer),
             SFUNC(0x7, IAudioOut, AppendAudioOutBuffer),
-            SFUNC(0x8, IAudioOut, GetReleasedAudioOutBuffer)
+            SFUNC(0x8, IAudioOut, GetReleasedAudioOutBuffer),
+            SFUNC(0xC, IAudioOut, SetAudioOutVolume),
+            SFUNC(0xD, IAudioOut, GetAudioOutVolume)
         )
     };
 }
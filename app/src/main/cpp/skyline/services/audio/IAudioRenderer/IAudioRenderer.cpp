@@ -1,28 +1,80 @@
 // SPDX-License-Identifier: MPL-2.0
 // Copyright © 2020 Skyline Team and Contributors (https://github.com/skyline-emu/)
 
+#include <sys/resource.h>
 #include <common/settings.h>
+#include <common/thread_pool.h>
 #include <kernel/types/KProcess.h>
+#include <audio/mixer.h>
 #include "IAudioRenderer.h"
 
 namespace skyline::service::audio::IAudioRenderer {
     IAudioRenderer::IAudioRenderer(const DeviceState &state, ServiceManager &manager, AudioRendererParameters &parameters)
         : systemEvent(std::make_shared<type::KEvent>(state, true)), parameters(parameters), BaseService(state, manager) {
-        track = state.audio->OpenTrack(constant::StereoChannelCount, constant::SampleRate, [&]() { systemEvent->Signal(); });
+        track = state.audio->OpenTrack(constant::StereoChannelCount, constant::SampleRate, [this]() {
+            {
+                std::scoped_lock lock{renderSignalMutex};
+                renderPending = true;
+            }
+            renderCondition.notify_one();
+        });
         track->Start();
 
         memoryPools.resize(parameters.effectCount + parameters.voiceCount * 4);
         effects.resize(parameters.effectCount);
         voices.resize(parameters.voiceCount, Voice(state));
+        mixes.resize(parameters.subMixCount + 1);
+        splitters.resize(parameters.splitterCount);
+        splitterDestinations.resize(parameters.splitterDestinationDataCount);
+        GenerateCommands();
 
         // Fill track with empty samples that we will triple buffer
         track->AppendBuffer(0);
         track->AppendBuffer(1);
         track->AppendBuffer(2);
+
+        renderThread = std::thread(&IAudioRenderer::RenderThread, this);
     }
 
     IAudioRenderer::~IAudioRenderer() {
-        state.audio->CloseTrack(track);
+        state.audio->CloseTrack(track); // The track must be closed first as it could otherwise wake the render thread after it has exited
+
+        {
+            std::scoped_lock lock{renderSignalMutex};
+            renderExit = true;
+        }
+        renderCondition.notify_one();
+        renderThread.join();
+    }
+
+    void IAudioRenderer::RenderThread() {
+        if (int result{pthread_setname_np(pthread_self(), "Sky-AudRen")})
+            Logger::Warn("Failed to set the thread name: {}", strerror(result));
+
+        // Mixing has to keep up with playback regardless of emulation load, so it runs at the same niceness as Android's own audio threads (ANDROID_PRIORITY_AUDIO)
+        constexpr int AudioPriority{-16};
+        if (setpriority(PRIO_PROCESS, static_cast<id_t>(gettid()), AudioPriority) == -1)
+            Logger::Warn("Failed to set the audio renderer thread priority: {}", strerror(errno));
+
+        while (true) {
+            {
+                std::unique_lock lock{renderSignalMutex};
+                renderCondition.wait(lock, [this] { return renderPending || renderExit; });
+                if (renderExit)
+                    return;
+                renderPending = false;
+            }
+
+            try {
+                std::scoped_lock lock{renderMutex};
+                if (!*state.settings->isAudioOutputDisabled)
+                    UpdateAudio();
+            } catch (const std::exception &e) {
+                Logger::Error("Failed to render audio: {}", e.what());
+            }
+
+            systemEvent->Signal();
+        }
     }
 
     Result IAudioRenderer::GetSampleRate(type::KSession &session, ipc::IpcRequest &request, ipc::IpcResponse &response) {
@@ -46,7 +98,9 @@ namespace skyline::service::audio::IAudioRenderer {
     }
 
     Result IAudioRenderer::RequestUpdate(type::KSession &session, ipc::IpcRequest &request, ipc::IpcResponse &response) {
-        auto input{request.inputBuf.at(0).data()};
+        std::scoped_lock lock{renderMutex};
+        auto inputBuffer{request.inputBuf.at(0)};
+        auto input{inputBuffer.data()};
 
         auto inputHeader{*reinterpret_cast<UpdateDataHeader *>(input)};
         revisionInfo.SetUserRevision(inputHeader.revision);
@@ -58,6 +112,8 @@ namespace skyline::service::audio::IAudioRenderer {
         for (size_t i{}; i < memoryPools.size(); i++)
             memoryPools[i].ProcessInput(memoryPoolsIn[i]);
 
+        span voiceChannelResourcesIn(reinterpret_cast<VoiceChannelResourceIn *>(input), inputHeader.voiceResourceSize / sizeof(VoiceChannelResourceIn));
+        voiceChannelResources.assign(voiceChannelResourcesIn.begin(), voiceChannelResourcesIn.end());
         input += inputHeader.voiceResourceSize;
 
         span voicesIn(reinterpret_cast<VoiceIn *>(input), parameters.voiceCount);
@@ -66,11 +122,24 @@ namespace skyline::service::audio::IAudioRenderer {
             voices[i].ProcessInput(voicesIn[i]);
 
         span effectsIn(reinterpret_cast<EffectIn *>(input), parameters.effectCount);
+        input += inputHeader.effectSize;
         for (u32 i{}; i < effectsIn.size(); i++)
             effects[i].ProcessInput(effectsIn[i]);
 
-        if (!*state.settings->isAudioOutputDisabled)
-            UpdateAudio();
+        submixGraphValid = true;
+        if (revisionInfo.SplitterSupported() && !splitters.empty() && !splitterDestinations.empty()) {
+            size_t splitterOffset{static_cast<size_t>(input - inputBuffer.data())};
+            auto splitterSize{splitterOffset <= inputBuffer.size() ? ProcessSplitterInput(inputBuffer.subspan(splitterOffset)) : std::nullopt};
+            if (splitterSize)
+                input += *splitterSize;
+            else
+                submixGraphValid = false; // The mix section can't be located without knowing the size of the splitter section
+        }
+
+        if (submixGraphValid)
+            submixGraphValid = ProcessMixInput(span(input, inputHeader.mixSize));
+
+        GenerateCommands();
 
         UpdateDataHeader outputHeader{
             .revision = constant::RevMagic,
@@ -128,39 +197,308 @@ namespace skyline::service::audio::IAudioRenderer {
         }
     }
 
-    void IAudioRenderer::MixFinalBuffer() {
-        u32 writtenSamples{};
+    std::optional<size_t> IAudioRenderer::ProcessSplitterInput(span<u8> input) {
+        if (input.size() < sizeof(SplitterHeader)) {
+            Logger::Warn("Splitter header is out of bounds: 0x{:X} bytes remaining", input.size());
+            return std::nullopt;
+        }
 
-        for (auto &voice : voices) {
-            if (!voice.Playable())
-                continue;
+        auto &header{input.as<SplitterHeader>()};
+        if (header.magic != constant::SplitterHeaderMagic) {
+            Logger::Warn("Invalid splitter header magic: 0x{:X}", header.magic);
+            return std::nullopt;
+        }
 
-            u32 bufferOffset{};
-            u32 pendingSamples{constant::MixBufferSize};
+        // All counts are guest-controlled, every entry is bounds-checked against the remaining input before being accessed
+        auto position{input.subspan(sizeof(SplitterHeader))};
+        for (u32 i{}; i < header.infoCount; i++) {
+            if (position.size() < sizeof(SplitterInfoIn)) {
+                Logger::Warn("Splitter info {}/{} is out of bounds", i, header.infoCount);
+                return std::nullopt;
+            }
 
-            while (pendingSamples > 0) {
-                u32 voiceBufferOffset{};
-                u32 voiceBufferSize{};
-                auto &voiceSamples{voice.GetBufferData(pendingSamples, voiceBufferOffset, voiceBufferSize)};
+            auto &info{position.as<SplitterInfoIn>()};
+            if (info.magic != constant::SplitterInfoMagic) {
+                Logger::Warn("Invalid splitter info magic: 0x{:X}", info.magic);
+                return std::nullopt;
+            }
 
-                if (voiceBufferSize == 0)
-                    break;
+            position = position.subspan(sizeof(SplitterInfoIn));
+            if (info.destinationCount > position.size() / sizeof(i32)) {
+                Logger::Warn("Splitter info {}/{} destination IDs are out of bounds: {}", i, header.infoCount, info.destinationCount);
+                return std::nullopt;
+            }
+
+            span destinationIds(reinterpret_cast<i32 *>(position.data()), info.destinationCount);
+            position = position.subspan(destinationIds.size_bytes());
+
+            if (info.id >= 0 && static_cast<size_t>(info.id) < splitters.size())
+                splitters[static_cast<size_t>(info.id)].destinationIds.assign(destinationIds.begin(), destinationIds.begin() + std::min(destinationIds.size(), splitterDestinations.size()));
+        }
+
+        for (u32 i{}; i < header.destinationCount; i++) {
+            if (position.size() < sizeof(SplitterDestinationIn)) {
+                Logger::Warn("Splitter destination {}/{} is out of bounds", i, header.destinationCount);
+                return std::nullopt;
+            }
+
+            auto &destination{position.as<SplitterDestinationIn>()};
+            if (destination.magic != constant::SplitterDestinationMagic) {
+                Logger::Warn("Invalid splitter destination magic: 0x{:X}", destination.magic);
+                return std::nullopt;
+            }
+
+            position = position.subspan(sizeof(SplitterDestinationIn));
+            if (destination.id >= 0 && static_cast<size_t>(destination.id) < splitterDestinations.size())
+                splitterDestinations[static_cast<size_t>(destination.id)] = destination;
+        }
+
+        return util::AlignUp(static_cast<size_t>(position.data() - input.data()), 0x10);
+    }
+
+    bool IAudioRenderer::ProcessMixInput(span<u8> input) {
+        bool dirtyOnly{revisionInfo.MixInParameterDirtyOnlyUpdateSupported()};
+        size_t mixCount{mixes.size()};
+        if (dirtyOnly) {
+            if (input.size() < sizeof(MixInDirtyHeader))
+                return false;
 
-                pendingSamples -= voiceBufferSize / constant::StereoChannelCount;
+            mixCount = input.as<MixInDirtyHeader>().mixCount;
+            input = input.subspan(sizeof(MixInDirtyHeader));
+        }
 
-                for (auto index{voiceBufferOffset}; index < voiceBufferOffset + voiceBufferSize; index++) {
-                    if (writtenSamples == bufferOffset) {
-                        sampleBuffer[bufferOffset] = skyline::audio::Saturate<i16, i32>(voiceSamples[index] * voice.volume);
+        span mixesIn{input.cast<MixIn, std::dynamic_extent, true>()};
+        for (size_t i{}; i < std::min(mixCount, mixesIn.size()); i++) {
+            // Dirty mixes are identified by their ID as only a subset of them is supplied
+            size_t index{dirtyOnly ? static_cast<size_t>(mixesIn[i].mixId) : i};
+            if (index < mixes.size())
+                mixes[index].parameters = mixesIn[i];
+        }
 
-                        writtenSamples++;
-                    } else {
-                        sampleBuffer[bufferOffset] = skyline::audio::Saturate<i16, i32>(sampleBuffer[bufferOffset] + (voiceSamples[index] * voice.volume));
+        return mixes.front().parameters.inUse;
+    }
+
+    void IAudioRenderer::GenerateCommands() {
+        commands.clear();
+
+        auto pushVoiceSends{[&](u32 voiceIndex, u32 channel, const Mix &mix, span<const float> volumes) {
+            for (u32 buffer{}; buffer < std::min<u32>(static_cast<u32>(std::max<i16>(mix.parameters.bufferCount, 0)), constant::MaxMixBuffers); buffer++)
+                if (volumes[buffer] != 0.0f)
+                    commands.push_back(Command{CommandType::MixVoice, voiceIndex, channel, mix.bufferOffset + buffer, volumes[buffer]});
+        }};
+
+        if (!submixGraphValid) {
+            // Voices are output directly as stereo if the graph isn't available, this matches how they were mixed prior to the graph being implemented
+            mixBuffers.assign(constant::StereoChannelCount * constant::MixBufferSize, 0);
+            finalMixBufferOffset = 0;
+            finalMixBufferCount = constant::StereoChannelCount;
+            finalMixVolume = 1.0f;
+
+            for (u32 index{}; index < voices.size(); index++) {
+                commands.push_back(Command{CommandType::RenderVoice, index});
+                commands.push_back(Command{CommandType::MixVoice, index, 0, 0, 1.0f});
+                commands.push_back(Command{CommandType::MixVoice, index, voices[index].GetRoutedChannelCount() > 1 ? 1U : 0U, 1, 1.0f});
+            }
+            return;
+        }
+
+        auto getMix{[&](i32 id) -> Mix * {
+            if (id < 0 || static_cast<size_t>(id) >= mixes.size() || !mixes[static_cast<size_t>(id)].parameters.inUse)
+                return nullptr;
+            return &mixes[static_cast<size_t>(id)];
+        }};
+
+        auto getSplitter{[&](i32 id) -> Splitter * {
+            if (!revisionInfo.SplitterSupported() || id < 0 || static_cast<size_t>(id) >= splitters.size())
+                return nullptr;
+            return &splitters[static_cast<size_t>(id)];
+        }};
+
+        auto getDestination{[&](const Splitter &splitter, size_t index) -> SplitterDestinationIn * {
+            if (index >= splitter.destinationIds.size())
+                return nullptr;
+            i32 id{splitter.destinationIds[index]};
+            if (id < 0 || static_cast<size_t>(id) >= splitterDestinations.size() || !splitterDestinations[static_cast<size_t>(id)].inUse)
+                return nullptr;
+            return &splitterDestinations[static_cast<size_t>(id)];
+        }};
+
+        u32 bufferCount{};
+        for (auto &mix : mixes) {
+            mix.bufferOffset = bufferCount;
+            if (mix.parameters.inUse)
+                bufferCount += std::min<u32>(static_cast<u32>(std::max<i16>(mix.parameters.bufferCount, 0)), constant::MaxMixBuffers);
+        }
+        mixBuffers.assign(static_cast<size_t>(bufferCount) * constant::MixBufferSize, 0);
+
+        for (u32 index{}; index < voices.size(); index++) {
+            auto &voice{voices[index]};
+            u8 channelCount{voice.GetRoutedChannelCount()};
+            commands.push_back(Command{CommandType::RenderVoice, index});
+
+            if (auto splitter{getSplitter(voice.splitterId)}) {
+                for (size_t group{}; group < splitter->destinationIds.size(); group += channelCount) {
+                    for (u32 channel{}; channel < channelCount; channel++) {
+                        auto destination{getDestination(*splitter, group + channel)};
+                        if (!destination)
+                            continue;
+                        if (auto mix{getMix(destination->mixId)})
+                            pushVoiceSends(index, channel, *mix, destination->mixVolumes);
                     }
+                }
+            } else if (auto mix{getMix(voice.mixId)}) {
+                for (u32 channel{}; channel < channelCount; channel++) {
+                    u32 resourceId{voice.channelResourceIds[channel]};
+                    if (resourceId < voiceChannelResources.size())
+                        pushVoiceSends(index, channel, *mix, voiceChannelResources[resourceId].mixVolumes);
+                }
+            }
+        }
 
-                    bufferOffset++;
+        // Mixes must be processed after every mix that's output to them, this is done by processing them in order of decreasing distance from the final mix
+        std::vector<i32> depths(mixes.size(), -1);
+        std::function<i32(i32, size_t)> getDepth{[&](i32 id, size_t recursion) -> i32 {
+            auto mix{getMix(id)};
+            if (!mix || recursion > mixes.size())
+                return -1; // Unused mixes and cycles in the graph are treated as not reaching the final mix
+            if (id == constant::FinalMixId)
+                return 0;
+            if (depths[static_cast<size_t>(id)] >= 0)
+                return depths[static_cast<size_t>(id)];
+
+            i32 depth{getDepth(mix->parameters.destinationMixId, recursion + 1)};
+            if (auto splitter{getSplitter(mix->parameters.destinationSplitterId)})
+                for (size_t i{}; i < splitter->destinationIds.size(); i++)
+                    if (auto destination{getDestination(*splitter, i)})
+                        depth = std::max(depth, getDepth(destination->mixId, recursion + 1));
+
+            return depths[static_cast<size_t>(id)] = (depth >= 0) ? depth + 1 : -1;
+        }};
+
+        std::vector<i32> order;
+        for (i32 id{1}; id < static_cast<i32>(mixes.size()); id++)
+            if (getDepth(id, 0) > 0)
+                order.push_back(id);
+        std::stable_sort(order.begin(), order.end(), [&](i32 a, i32 b) { return depths[static_cast<size_t>(a)] > depths[static_cast<size_t>(b)]; });
+        order.push_back(constant::FinalMixId);
+
+        std::vector<u32> mixEffects;
+        for (i32 id : order) {
+            auto &mix{mixes[static_cast<size_t>(id)]};
+            u32 mixBufferCount{std::min<u32>(static_cast<u32>(std::max<i16>(mix.parameters.bufferCount, 0)), constant::MaxMixBuffers)};
+
+            mixEffects.clear();
+            for (u32 index{}; index < effects.size(); index++)
+                if (effects[index].parameters.type != EffectType::Invalid && effects[index].parameters.mixId == id)
+                    mixEffects.push_back(index);
+            std::stable_sort(mixEffects.begin(), mixEffects.end(), [&](u32 a, u32 b) { return effects[a].parameters.processOrder < effects[b].parameters.processOrder; });
+            for (u32 index : mixEffects)
+                commands.push_back(Command{CommandType::ApplyEffect, index, mix.bufferOffset, mixBufferCount});
+
+            if (id == constant::FinalMixId)
+                break;
+
+            if (auto splitter{getSplitter(mix.parameters.destinationSplitterId)}) {
+                for (size_t group{}; group < splitter->destinationIds.size(); group += std::max<u32>(mixBufferCount, 1)) {
+                    for (u32 buffer{}; buffer < mixBufferCount; buffer++) {
+                        auto destination{getDestination(*splitter, group + buffer)};
+                        auto destinationMix{destination ? getMix(destination->mixId) : nullptr};
+                        if (!destinationMix)
+                            continue;
+
+                        for (u32 destinationBuffer{}; destinationBuffer < std::min<u32>(static_cast<u32>(std::max<i16>(destinationMix->parameters.bufferCount, 0)), constant::MaxMixBuffers); destinationBuffer++)
+                            if (float volume{mix.parameters.volume * destination->mixVolumes[destinationBuffer]}; volume != 0.0f)
+                                commands.push_back(Command{CommandType::MixBuffer, 0, mix.bufferOffset + buffer, destinationMix->bufferOffset + destinationBuffer, volume});
+                    }
                 }
+            } else if (auto destinationMix{getMix(mix.parameters.destinationMixId)}) {
+                for (u32 buffer{}; buffer < mixBufferCount; buffer++)
+                    for (u32 destinationBuffer{}; destinationBuffer < std::min<u32>(static_cast<u32>(std::max<i16>(destinationMix->parameters.bufferCount, 0)), constant::MaxMixBuffers); destinationBuffer++)
+                        if (float volume{mix.parameters.volume * mix.parameters.mixVolumes[buffer][destinationBuffer]}; volume != 0.0f)
+                            commands.push_back(Command{CommandType::MixBuffer, 0, mix.bufferOffset + buffer, destinationMix->bufferOffset + destinationBuffer, volume});
             }
         }
+
+        auto &finalMix{mixes.front()};
+        finalMixBufferOffset = finalMix.bufferOffset;
+        finalMixBufferCount = std::min<u32>(static_cast<u32>(std::max<i16>(finalMix.parameters.bufferCount, 0)), constant::MaxMixBuffers);
+        finalMixVolume = finalMix.parameters.volume;
+    }
+
+    /**
+     * @return The pool used to decode the wave buffers of voices, this is shared by all renderers
+     */
+    static ThreadPool &GetVoiceDecodePool() {
+        static ThreadPool pool{2, "VoiceDec"};
+        return pool;
+    }
+
+    void IAudioRenderer::MixFinalBuffer() {
+        // All voices starting a new wave buffer are decoded in a single batch across the pool rather than one by one as they're rendered
+        auto pendingVoices{std::count_if(voices.begin(), voices.end(), [](const Voice &voice) { return voice.BuffersPending(); })};
+        if (pendingVoices > 1)
+            GetVoiceDecodePool().ParallelFor(voices.size(), [this](size_t index) { voices[index].PrepareBuffers(); });
+
+        std::fill(mixBuffers.begin(), mixBuffers.end(), 0.0f);
+        auto getBuffer{[&](u32 index) { return span(mixBuffers).subspan(static_cast<size_t>(index) * constant::MixBufferSize, constant::MixBufferSize); }};
+
+        bool voicePlaying{};
+        for (const auto &command : commands) {
+            switch (command.type) {
+                case CommandType::RenderVoice: {
+                    auto &voice{voices[command.index]};
+                    voicePlaying = voice.Playable();
+                    if (voicePlaying)
+                        voice.Render(voiceBuffers[0], voiceBuffers[1]);
+                    break;
+                }
+
+                case CommandType::MixVoice:
+                    if (voicePlaying)
+                        skyline::audio::MixSamples(getBuffer(command.destination), voiceBuffers[command.source], command.volume);
+                    break;
+
+                case CommandType::ApplyEffect:
+                    effects[command.index].Process(span(mixBuffers).subspan(static_cast<size_t>(command.source) * constant::MixBufferSize, static_cast<size_t>(command.destination) * constant::MixBufferSize), command.destination, state);
+                    break;
+
+                case CommandType::MixBuffer:
+                    skyline::audio::MixSamples(getBuffer(command.destination), getBuffer(command.source), command.volume);
+                    break;
+            }
+        }
+
+        // The voice buffers are free at this point and are reused to hold the stereo output of the final mix
+        auto &[left, right]{voiceBuffers};
+        if (finalMixBufferCount >= constant::SurroundChannelCount) {
+            // The final mix is downmixed with the same coefficients as skyline::audio::DownMix but on planar buffers
+            std::array<span<float>, constant::SurroundChannelCount> channels;
+            for (u32 i{}; i < channels.size(); i++)
+                channels[i] = getBuffer(finalMixBufferOffset + i);
+            auto &[frontLeft, frontRight, centre, lowFrequency, backLeft, backRight]{channels};
+
+            std::copy(frontLeft.begin(), frontLeft.end(), left.begin());
+            std::copy(frontRight.begin(), frontRight.end(), right.begin());
+            for (auto &output : voiceBuffers) {
+                skyline::audio::MixSamples(output, centre, 0.707f);
+                skyline::audio::MixSamples(output, lowFrequency, 0.251f);
+            }
+            skyline::audio::MixSamples(left, backLeft, 0.501f);
+            skyline::audio::MixSamples(right, backRight, 0.501f);
+        } else if (finalMixBufferCount >= constant::StereoChannelCount) {
+            auto frontLeft{getBuffer(finalMixBufferOffset)}, frontRight{getBuffer(finalMixBufferOffset + 1)};
+            std::copy(frontLeft.begin(), frontLeft.end(), left.begin());
+            std::copy(frontRight.begin(), frontRight.end(), right.begin());
+        } else if (finalMixBufferCount == 1) {
+            auto mono{getBuffer(finalMixBufferOffset)};
+            std::copy(mono.begin(), mono.end(), left.begin());
+            std::copy(mono.begin(), mono.end(), right.begin());
+        } else {
+            left.fill(0);
+            right.fill(0);
+        }
+
+        skyline::audio::InterleaveSamples(sampleBuffer, left, right, finalMixVolume);
     }
 
     Result IAudioRenderer::Start(type::KSession &session, ipc::IpcRequest &request, ipc::IpcResponse &response) {
@@ -8,6 +8,8 @@
 #include "memory_pool.h"
 #include "effect.h"
 #include "voice.h"
+#include "mix.h"
+#include "splitter.h"
 #include "revision_info.h"
 
 namespace skyline {
@@ -69,12 +71,66 @@ namespace skyline {
             std::vector<MemoryPool> memoryPools;
             std::vector<Effect> effects;
             std::vector<Voice> voices;
+            std::vector<VoiceChannelResourceIn> voiceChannelResources;
+            std::vector<Mix> mixes; //!< All mixes indexed by their ID, the first mix is the final mix
+            std::vector<Splitter> splitters;
+            std::vector<SplitterDestinationIn> splitterDestinations;
+            bool submixGraphValid{}; //!< If the submix graph could be parsed from the last update, voices are output directly if it couldn't be
+
+            enum class CommandType : u8 {
+                RenderVoice, //!< Renders the voice at 'index' into the voice buffers
+                MixVoice, //!< Mixes the voice buffer at 'source' into the mix buffer at 'destination'
+                ApplyEffect, //!< Applies the effect at 'index' to the 'destination' mix buffers starting at 'source'
+                MixBuffer, //!< Mixes the mix buffer at 'source' into the mix buffer at 'destination'
+            };
+
+            /**
+             * @brief A single step of rendering a mix buffer, the command list is generated from the graph on every update and executed in a single pass for every rendered buffer
+             */
+            struct Command {
+                CommandType type;
+                u32 index;
+                u32 source;
+                u32 destination;
+                float volume;
+            };
+
+            std::vector<Command> commands;
+            std::vector<float> mixBuffers; //!< The planar buffers of all mixes, every buffer consists of constant::MixBufferSize samples
+            u32 finalMixBufferOffset{}; //!< The index of the first mix buffer of the final mix
+            u32 finalMixBufferCount{};
+            float finalMixVolume{};
+            std::array<std::array<float, constant::MixBufferSize>, constant::StereoChannelCount> voiceBuffers{}; //!< The planar buffers a single voice is rendered into prior to being mixed into its destinations
             std::array<i16, constant::MixBufferSize * constant::StereoChannelCount> sampleBuffer{}; //!< The final output data that is appended to the stream
             skyline::audio::AudioOutState playbackState{skyline::audio::AudioOutState::Stopped};
 
+            std::mutex renderMutex; //!< Synchronizes the renderer state between RequestUpdate and the render thread
+            std::mutex renderSignalMutex; //!< Synchronizes the render thread wakeup flags, this is separate from renderMutex as the track calls back into the renderer with its own lock held
+            std::condition_variable renderCondition; //!< Signalled when the track releases a buffer or the render thread should exit
+            bool renderPending{}; //!< If the track has released buffers that haven't been rendered yet
+            bool renderExit{};
+            std::thread renderThread; //!< A dedicated high-priority thread which mixes voices into released buffers, this keeps mixing off the guest thread calling RequestUpdate
+
+            /**
+             * @brief Parses the splitter section of an update
+             * @param input The remainder of the update buffer, starting at the splitter section
+             * @return The size of the splitter section or std::nullopt if it couldn't be parsed or exceeds the input
+             */
+            std::optional<size_t> ProcessSplitterInput(span<u8> input);
+
+            /**
+             * @brief Parses the mix section of an update
+             * @return If the mix section could be parsed
+             */
+            bool ProcessMixInput(span<u8> input);
+
+            /**
+             * @brief Generates the command list from the voices and the submix graph
+             */
+            void GenerateCommands();
+
             /**
-             * @brief Obtains new sample data from voices and mixes it together into the sample buffer
-             * @return The amount of samples present in the buffer
+             * @brief Executes the command list to render the voices through the submix graph into the sample buffer
              */
             void MixFinalBuffer();
 
@@ -83,6 +139,11 @@ namespace skyline {
              */
             void UpdateAudio();
 
+            /**
+             * @brief The entry point of the render thread, it renders all released buffers and signals the system event whenever it's woken by the track
+             */
+            void RenderThread();
+
           public:
             /**
              * @param parameters The parameters to use for rendering
@@ -90,7 +151,7 @@ namespace skyline {
             IAudioRenderer(const DeviceState &state, ServiceManager &manager, AudioRendererParameters &parameters);
 
             /**
-             * @brief Closes the audio track
+             * @brief Closes the audio track and stops the render thread
              */
             ~IAudioRenderer();
 
@@ -0,0 +1,279 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2023 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#include <kernel/types/KProcess.h>
+#include "effect.h"
+
+namespace skyline::service::audio::IAudioRenderer {
+    constexpr float FixedPointScale{1.0f / (1 << 14)}; //!< The scale of Q18.14 fixed-point effect parameters
+    constexpr size_t SamplesPerMillisecond{constant::SampleRate / 1000};
+    constexpr size_t MaxDelayTime{2000}; //!< The maximum delay time in milliseconds that delay lines are allocated for, this bounds allocations made from guest controlled parameters
+
+    /**
+     * @brief The state of an aux ring buffer shared with the guest
+     */
+    struct AuxInfoDsp {
+        u32 readOffset;
+        u32 writeOffset;
+        u32 lostSampleCount;
+        u32 totalSampleCount;
+        u32 _pad0_[12];
+    };
+    static_assert(sizeof(AuxInfoDsp) == 0x40);
+
+    void Effect::ProcessInput(const EffectIn &input) {
+        if (input.isNew)
+            output.state = EffectState::New;
+
+        parameters = input;
+
+        bool reset{input.isNew != 0};
+        switch (input.type) {
+            case EffectType::Delay: {
+                auto &delay{parameters.delay};
+                size_t channelCount{std::min<size_t>(delay.channelCountMax, MaxEffectChannels)};
+                size_t lineSize{std::min<size_t>(delay.delayTimeMax, MaxDelayTime) * SamplesPerMillisecond};
+                if (reset || delay.state == EffectParameterState::Initialized || delayLines.size() != channelCount || (channelCount && delayLines.front().samples.size() != std::max<size_t>(lineSize, 1))) {
+                    delayLines.resize(channelCount);
+                    for (auto &line : delayLines)
+                        line.Resize(lineSize);
+                }
+                break;
+            }
+
+            case EffectType::Reverb: {
+                auto &reverb{parameters.reverb};
+                size_t channelCount{std::min<size_t>(reverb.channelCountMax, MaxEffectChannels)};
+                if (reset || reverb.state == EffectParameterState::Initialized || reverbChannels.size() != channelCount) {
+                    // The comb and allpass lengths are the mutually prime lengths used by Freeverb at 44.1 kHz, every channel is offset slightly to decorrelate them
+                    constexpr std::array<size_t, 4> CombLengths{1116, 1188, 1277, 1356};
+                    constexpr std::array<size_t, 2> AllPassLengths{556, 441};
+                    constexpr size_t ChannelSpread{23};
+                    constexpr size_t MaxPreDelay{350}; //!< The maximum pre-delay in milliseconds
+
+                    reverbChannels.resize(channelCount);
+                    for (size_t channel{}; channel < channelCount; channel++) {
+                        auto &state{reverbChannels[channel]};
+                        state.preDelay.Resize(MaxPreDelay * SamplesPerMillisecond);
+                        for (size_t i{}; i < CombLengths.size(); i++)
+                            state.combs[i].Resize(((CombLengths[i] + channel * ChannelSpread) * constant::SampleRate) / 44100);
+                        for (size_t i{}; i < AllPassLengths.size(); i++)
+                            state.allPasses[i].Resize(((AllPassLengths[i] + channel * ChannelSpread) * constant::SampleRate) / 44100);
+                    }
+                }
+                break;
+            }
+
+            case EffectType::BiquadFilter:
+                if (reset || parameters.biquadFilter.state == EffectParameterState::Initialized)
+                    biquadStates = {};
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    void Effect::CopyThrough(span<float> buffers, u32 bufferCount, span<const i8> inputs, span<const i8> outputs) {
+        for (size_t i{}; i < inputs.size(); i++) {
+            i8 input{inputs[i]}, output{outputs[i]};
+            if (input == output || input < 0 || output < 0 || static_cast<u32>(input) >= bufferCount || static_cast<u32>(output) >= bufferCount)
+                continue;
+
+            std::memcpy(buffers.data() + static_cast<size_t>(output) * constant::MixBufferSize, buffers.data() + static_cast<size_t>(input) * constant::MixBufferSize, constant::MixBufferSize * sizeof(float));
+        }
+    }
+
+    void Effect::ProcessBufferMixer(span<float> buffers, u32 bufferCount) {
+        auto &mixer{parameters.bufferMixer};
+        for (size_t i{}; i < std::min<size_t>(mixer.mixCount, constant::MaxMixBuffers); i++) {
+            i8 input{mixer.inputs[i]}, output{mixer.outputs[i]};
+            if (input < 0 || output < 0 || static_cast<u32>(input) >= bufferCount || static_cast<u32>(output) >= bufferCount)
+                continue;
+
+            skyline::audio::MixSamples(buffers.subspan(static_cast<size_t>(output) * constant::MixBufferSize, constant::MixBufferSize), buffers.subspan(static_cast<size_t>(input) * constant::MixBufferSize, constant::MixBufferSize), mixer.volumes[i]);
+        }
+    }
+
+    void Effect::ProcessAux(span<float> buffers, u32 bufferCount, const DeviceState &state) {
+        auto &aux{parameters.aux};
+        u32 channelCount{std::min<u32>(aux.mixBufferCount, constant::MaxMixBuffers)};
+        if (!channelCount)
+            return;
+        span<const i8> inputs{span(aux.inputs).first(channelCount)}, outputs{span(aux.outputs).first(channelCount)};
+
+        // The DSP side of the ring buffer state follows the CPU side, every channel is written contiguously after the previous one and the offsets are advanced once for all channels
+        auto sendInfo{reinterpret_cast<AuxInfoDsp *>(aux.sendBufferInfoAddress + sizeof(AuxInfoDsp))};
+        auto returnInfo{reinterpret_cast<AuxInfoDsp *>(aux.returnBufferInfoAddress + sizeof(AuxInfoDsp))};
+        span<i32> sendBuffer{reinterpret_cast<i32 *>(aux.sendBufferAddress), aux.countMax};
+        span<i32> returnBuffer{reinterpret_cast<i32 *>(aux.returnBufferAddress), aux.countMax};
+
+        auto &memory{state.process->memory};
+        if (aux.countMax < constant::MixBufferSize * channelCount ||
+            !memory.AddressSpaceContains(span<u8>{reinterpret_cast<u8 *>(sendInfo), sizeof(AuxInfoDsp)}) ||
+            !memory.AddressSpaceContains(span<u8>{reinterpret_cast<u8 *>(returnInfo), sizeof(AuxInfoDsp)}) ||
+            !memory.AddressSpaceContains(sendBuffer.cast<u8>()) || !memory.AddressSpaceContains(returnBuffer.cast<u8>())) {
+            CopyThrough(buffers, bufferCount, inputs, outputs);
+            return;
+        }
+
+        for (u32 channel{}; channel < channelCount; channel++) {
+            i8 input{inputs[channel]}, output{outputs[channel]};
+            if (input < 0 || output < 0 || static_cast<u32>(input) >= bufferCount || static_cast<u32>(output) >= bufferCount)
+                continue;
+
+            auto inputBuffer{buffers.subspan(static_cast<size_t>(input) * constant::MixBufferSize, constant::MixBufferSize)};
+            auto outputBuffer{buffers.subspan(static_cast<size_t>(output) * constant::MixBufferSize, constant::MixBufferSize)};
+
+            size_t writeOffset{(sendInfo->writeOffset + channel * constant::MixBufferSize) % aux.countMax};
+            for (float sample : inputBuffer) {
+                sendBuffer[writeOffset] = static_cast<i32>(sample);
+                writeOffset = (writeOffset + 1) % aux.countMax;
+            }
+
+            size_t readOffset{(returnInfo->readOffset + channel * constant::MixBufferSize) % aux.countMax};
+            for (float &sample : outputBuffer) {
+                sample = static_cast<float>(returnBuffer[readOffset]);
+                readOffset = (readOffset + 1) % aux.countMax;
+            }
+        }
+
+        u32 advance{constant::MixBufferSize * channelCount};
+        sendInfo->writeOffset = (sendInfo->writeOffset + advance) % aux.countMax;
+        sendInfo->totalSampleCount += advance;
+        returnInfo->readOffset = (returnInfo->readOffset + advance) % aux.countMax;
+        returnInfo->totalSampleCount += advance;
+    }
+
+    void Effect::ProcessDelay(span<float> buffers, u32 bufferCount) {
+        auto &delay{parameters.delay};
+        size_t delaySamples{std::min<size_t>(delay.delayTime, MaxDelayTime) * SamplesPerMillisecond};
+        float inGain{delay.inGain * FixedPointScale}, feedbackGain{delay.feedbackGain * FixedPointScale};
+        float wetGain{delay.wetGain * FixedPointScale}, dryGain{delay.dryGain * FixedPointScale};
+        float lowPassAmount{std::clamp(delay.lowPassAmount * FixedPointScale, 0.0f, 1.0f)};
+
+        for (size_t channel{}; channel < std::min<size_t>(delay.channelCount, delayLines.size()); channel++) {
+            i8 input{delay.inputs[channel]}, output{delay.outputs[channel]};
+            if (input < 0 || output < 0 || static_cast<u32>(input) >= bufferCount || static_cast<u32>(output) >= bufferCount)
+                continue;
+
+            auto inputBuffer{buffers.subspan(static_cast<size_t>(input) * constant::MixBufferSize, constant::MixBufferSize)};
+            auto outputBuffer{buffers.subspan(static_cast<size_t>(output) * constant::MixBufferSize, constant::MixBufferSize)};
+            auto &line{delayLines[channel]};
+            for (size_t i{}; i < constant::MixBufferSize; i++) {
+                float sample{inputBuffer[i]};
+                float delayed{line.Tap(delaySamples)};
+                line.lowPassState = delayed * (1.0f - lowPassAmount) + line.lowPassState * lowPassAmount;
+                line.Push(sample * inGain + line.lowPassState * feedbackGain);
+                outputBuffer[i] = sample * dryGain + delayed * wetGain;
+            }
+        }
+    }
+
+    void Effect::ProcessReverb(span<float> buffers, u32 bufferCount) {
+        auto &reverb{parameters.reverb};
+        constexpr float AllPassFeedback{0.5f};
+
+        float decayTime{std::max(reverb.decayTime * FixedPointScale, 0.1f)};
+        float damping{1.0f - std::clamp(reverb.highFrequencyDecayRatio * FixedPointScale, 0.0f, 1.0f)};
+        float baseGain{reverb.baseGain * FixedPointScale}, earlyGain{reverb.earlyGain * FixedPointScale}, lateGain{reverb.lateGain * FixedPointScale};
+        float wetGain{reverb.wetGain * FixedPointScale}, dryGain{reverb.dryGain * FixedPointScale};
+        size_t preDelaySamples{static_cast<size_t>(std::max(reverb.preDelay, 0)) * SamplesPerMillisecond};
+
+        for (size_t channel{}; channel < std::min<size_t>(reverb.channelCount, reverbChannels.size()); channel++) {
+            i8 input{reverb.inputs[channel]}, output{reverb.outputs[channel]};
+            if (input < 0 || output < 0 || static_cast<u32>(input) >= bufferCount || static_cast<u32>(output) >= bufferCount)
+                continue;
+
+            auto &state{reverbChannels[channel]};
+
+            // The feedback of every comb is derived from its length so that all of them decay by 60 dB over the decay time
+            std::array<float, 4> combFeedback;
+            for (size_t i{}; i < combFeedback.size(); i++)
+                combFeedback[i] = std::pow(10.0f, -3.0f * static_cast<float>(state.combs[i].samples.size()) / (decayTime * constant::SampleRate));
+
+            auto inputBuffer{buffers.subspan(static_cast<size_t>(input) * constant::MixBufferSize, constant::MixBufferSize)};
+            auto outputBuffer{buffers.subspan(static_cast<size_t>(output) * constant::MixBufferSize, constant::MixBufferSize)};
+            for (size_t i{}; i < constant::MixBufferSize; i++) {
+                float sample{inputBuffer[i]};
+                state.preDelay.Push(sample * baseGain);
+                float early{state.preDelay.Tap(preDelaySamples)};
+
+                float late{};
+                for (size_t comb{}; comb < state.combs.size(); comb++) {
+                    auto &line{state.combs[comb]};
+                    float delayed{line.Tap(line.samples.size() - 1)};
+                    line.lowPassState = delayed * (1.0f - damping) + line.lowPassState * damping;
+                    line.Push(early + line.lowPassState * combFeedback[comb]);
+                    late += delayed;
+                }
+                late /= static_cast<float>(state.combs.size());
+
+                for (auto &line : state.allPasses) {
+                    float delayed{line.Tap(line.samples.size() - 1)};
+                    line.Push(late + delayed * AllPassFeedback);
+                    late = delayed - late * AllPassFeedback;
+                }
+
+                outputBuffer[i] = sample * dryGain + (early * earlyGain + late * lateGain) * wetGain;
+            }
+        }
+    }
+
+    void Effect::ProcessBiquadFilter(span<float> buffers, u32 bufferCount) {
+        auto &filter{parameters.biquadFilter};
+        for (size_t channel{}; channel < std::min<size_t>(static_cast<size_t>(std::max<i8>(filter.channelCount, 0)), MaxEffectChannels); channel++) {
+            i8 input{filter.inputs[channel]}, output{filter.outputs[channel]};
+            if (input < 0 || output < 0 || static_cast<u32>(input) >= bufferCount || static_cast<u32>(output) >= bufferCount)
+                continue;
+
+            skyline::audio::ApplyBiquadFilter(buffers.subspan(static_cast<size_t>(output) * constant::MixBufferSize, constant::MixBufferSize), buffers.subspan(static_cast<size_t>(input) * constant::MixBufferSize, constant::MixBufferSize), filter.coefficients, biquadStates[channel]);
+        }
+    }
+
+    void Effect::Process(span<float> buffers, u32 bufferCount, const DeviceState &state) {
+        auto copyThrough{[&](const auto &effect, size_t channelCount) {
+            channelCount = std::min(channelCount, effect.inputs.size());
+            CopyThrough(buffers, bufferCount, span(effect.inputs).first(channelCount), span(effect.outputs).first(channelCount));
+        }};
+
+        switch (parameters.type) {
+            case EffectType::BufferMixer:
+                if (parameters.enabled)
+                    ProcessBufferMixer(buffers, bufferCount);
+                break;
+
+            case EffectType::Aux:
+                if (parameters.enabled)
+                    ProcessAux(buffers, bufferCount, state);
+                else
+                    copyThrough(parameters.aux, parameters.aux.mixBufferCount);
+                break;
+
+            case EffectType::Delay:
+                if (parameters.enabled)
+                    ProcessDelay(buffers, bufferCount);
+                else
+                    copyThrough(parameters.delay, parameters.delay.channelCount);
+                break;
+
+            case EffectType::Reverb:
+                if (parameters.enabled)
+                    ProcessReverb(buffers, bufferCount);
+                else
+                    copyThrough(parameters.reverb, parameters.reverb.channelCount);
+                break;
+
+            case EffectType::BiquadFilter:
+                if (parameters.enabled)
+                    ProcessBiquadFilter(buffers, bufferCount);
+                else
+                    copyThrough(parameters.biquadFilter, static_cast<size_t>(std::max<i8>(parameters.biquadFilter.channelCount, 0)));
+                break;
+
+            default:
+                // Any other effects are unimplemented and leave the buffers untouched, this is equivalent to them passing their inputs through to the same outputs
+                break;
+        }
+    }
+}
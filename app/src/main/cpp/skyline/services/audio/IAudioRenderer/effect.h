@@ -4,6 +4,8 @@
 #pragma once
 
 #include <common.h>
+#include <audio/mixer.h>
+#include "mix.h"
 
 namespace skyline::service::audio::IAudioRenderer {
     enum class EffectState : u8 {
@@ -11,13 +13,126 @@ namespace skyline::service::audio::IAudioRenderer {
         New = 1,
     };
 
+    enum class EffectType : u8 {
+        Invalid = 0,
+        BufferMixer = 1,
+        Aux = 2,
+        Delay = 3,
+        Reverb = 4,
+        I3dl2Reverb = 5,
+        BiquadFilter = 6,
+        LightLimiter = 7,
+        Capture = 8,
+        Compressor = 9,
+    };
+
+    /**
+     * @brief The state of the parameters of an effect as set by the guest
+     */
+    enum class EffectParameterState : u8 {
+        Initialized = 0, //!< The parameters have been (re)initialized and any processing state should be reset
+        Updating = 1,
+        Updated = 2,
+    };
+
+    constexpr u8 MaxEffectChannels{6}; //!< The maximum amount of channels most effects can process
+
+    struct BufferMixerParameters {
+        std::array<i8, constant::MaxMixBuffers> inputs;
+        std::array<i8, constant::MaxMixBuffers> outputs;
+        std::array<float, constant::MaxMixBuffers> volumes;
+        u32 mixCount;
+    };
+
+    struct AuxParameters {
+        std::array<i8, constant::MaxMixBuffers> inputs;
+        std::array<i8, constant::MaxMixBuffers> outputs;
+        u32 mixBufferCount;
+        u32 sampleRate;
+        u32 countMax; //!< The size of the send and return ring buffers in samples
+        u32 mixBufferCountMax;
+        u64 sendBufferInfoAddress;
+        u64 sendBufferAddress;
+        u64 returnBufferInfoAddress;
+        u64 returnBufferAddress;
+        u32 mixBufferSampleSize;
+        u32 sampleCount;
+        u32 mixBufferSampleCount;
+    };
+
+    /**
+     * @note All gains are in Q18.14 fixed-point and all times are in milliseconds
+     */
+    struct DelayParameters {
+        std::array<i8, MaxEffectChannels> inputs;
+        std::array<i8, MaxEffectChannels> outputs;
+        u16 channelCountMax;
+        u16 channelCount;
+        u32 delayTimeMax;
+        u32 delayTime;
+        i32 sampleRate;
+        i32 inGain;
+        i32 feedbackGain;
+        i32 wetGain;
+        i32 dryGain;
+        i32 channelSpread;
+        i32 lowPassAmount;
+        EffectParameterState state;
+    };
+
+    /**
+     * @note All gains and ratios are in Q18.14 fixed-point, the decay time is in Q18.14 seconds and the pre-delay is in milliseconds
+     */
+    struct ReverbParameters {
+        std::array<i8, MaxEffectChannels> inputs;
+        std::array<i8, MaxEffectChannels> outputs;
+        u16 channelCountMax;
+        u16 channelCount;
+        u32 _unk0_;
+        u32 sampleRate;
+        u32 earlyMode;
+        i32 earlyGain;
+        i32 preDelay;
+        u32 lateMode;
+        i32 lateGain;
+        i32 decayTime;
+        i32 highFrequencyDecayRatio;
+        i32 colouration;
+        i32 baseGain;
+        i32 wetGain;
+        i32 dryGain;
+        EffectParameterState state;
+    };
+
+    struct BiquadFilterParameters {
+        std::array<i8, MaxEffectChannels> inputs;
+        std::array<i8, MaxEffectChannels> outputs;
+        skyline::audio::BiquadCoefficients coefficients;
+        i8 channelCount;
+        EffectParameterState state;
+    };
+
     /**
      * @brief Input containing information on what effects to use on an audio stream
      */
     struct EffectIn {
-        u8 _unk0_;
+        EffectType type;
         u8 isNew; //!< Whether the effect was used in the previous samples
-        u8 _unk1_[0xBE];
+        u8 enabled;
+        u8 _pad0_;
+        i32 mixId; //!< The ID of the mix the effect is applied to
+        u64 workBuffer;
+        u64 workBufferSize;
+        u32 processOrder; //!< The order the effect is applied in relative to other effects on the same mix
+        u32 _pad1_;
+        union {
+            BufferMixerParameters bufferMixer;
+            AuxParameters aux;
+            DelayParameters delay;
+            ReverbParameters reverb;
+            BiquadFilterParameters biquadFilter;
+            std::array<u8, 0xA0> raw;
+        };
     };
     static_assert(sizeof(EffectIn) == 0xC0);
 
@@ -31,15 +146,76 @@ namespace skyline::service::audio::IAudioRenderer {
     static_assert(sizeof(EffectOut) == 0x10);
 
     /**
-     * @brief The Effect class stores the state of audio post processing effects
+     * @brief The Effect class stores the state of audio post processing effects and applies them to the buffers of a mix
+     * @note The work buffers supplied by the guest are unused, all processing state is allocated on the host instead
      */
     class Effect {
+      private:
+        /**
+         * @brief A circular buffer of past samples with an optional one-pole low-pass filter on its feedback
+         */
+        struct DelayLine {
+            std::vector<float> samples;
+            size_t position{};
+            float lowPassState{};
+
+            void Resize(size_t size) {
+                samples.assign(std::max<size_t>(size, 1), 0);
+                position = 0;
+                lowPassState = 0;
+            }
+
+            /**
+             * @return The sample that was written the supplied amount of samples ago
+             */
+            float Tap(size_t delay) const {
+                return samples[(position + samples.size() - std::min(delay, samples.size() - 1) - 1) % samples.size()];
+            }
+
+            void Push(float sample) {
+                samples[position] = sample;
+                position = (position + 1) % samples.size();
+            }
+        };
+
+        /**
+         * @brief The state of the reverb for a single channel, this is a Schroeder-Moorer reverberator with damped feedback combs followed by allpass diffusers
+         */
+        struct ReverbChannel {
+            DelayLine preDelay;
+            std::array<DelayLine, 4> combs;
+            std::array<DelayLine, 2> allPasses;
+        };
+
+        std::array<std::array<float, 2>, MaxEffectChannels> biquadStates{};
+        std::vector<DelayLine> delayLines; //!< The delay line of every channel of a delay effect
+        std::vector<ReverbChannel> reverbChannels;
+
+        void ProcessBufferMixer(span<float> buffers, u32 bufferCount);
+
+        void ProcessAux(span<float> buffers, u32 bufferCount, const DeviceState &state);
+
+        void ProcessDelay(span<float> buffers, u32 bufferCount);
+
+        void ProcessReverb(span<float> buffers, u32 bufferCount);
+
+        void ProcessBiquadFilter(span<float> buffers, u32 bufferCount);
+
+        /**
+         * @brief Copies all inputs of the effect to their corresponding outputs, this is done by any effect that's disabled
+         */
+        void CopyThrough(span<float> buffers, u32 bufferCount, span<const i8> inputs, span<const i8> outputs);
+
       public:
+        EffectIn parameters{};
         EffectOut output{};
 
-        void ProcessInput(const EffectIn &input) {
-            if (input.isNew)
-                output.state = EffectState::New;
-        }
+        void ProcessInput(const EffectIn &input);
+
+        /**
+         * @brief Applies the effect to the buffers of the mix it's attached to
+         * @param buffers The planar buffers of the mix, each buffer consists of constant::MixBufferSize samples
+         */
+        void Process(span<float> buffers, u32 bufferCount, const DeviceState &state);
     };
 }
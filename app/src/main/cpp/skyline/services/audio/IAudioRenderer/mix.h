@@ -0,0 +1,55 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2023 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#pragma once
+
+#include <common.h>
+
+namespace skyline {
+    namespace constant {
+        constexpr u8 MaxMixBuffers{24}; //!< The maximum amount of buffers a single mix can have
+        constexpr i32 FinalMixId{0}; //!< The ID of the final mix, which is output to the sink
+        constexpr i32 UnusedMixId{std::numeric_limits<i32>::max()}; //!< The mix ID used for a voice or mix that has no mix destination
+        constexpr i32 UnusedSplitterId{-1}; //!< The splitter ID used for a voice or mix that has no splitter destination
+    }
+
+    namespace service::audio::IAudioRenderer {
+        /**
+         * @brief Input containing the parameters of a single mix, a node of the submix graph that voices and other mixes are mixed into
+         */
+        struct MixIn {
+            float volume;
+            u32 sampleRate;
+            i16 bufferCount;
+            bool inUse;
+            bool isDirty;
+            i32 mixId;
+            u32 _unk0_;
+            i32 nodeId;
+            u32 _unk1_[2];
+            std::array<std::array<float, constant::MaxMixBuffers>, constant::MaxMixBuffers> mixVolumes; //!< The volumes to mix each buffer of this mix into each buffer of the destination mix with
+            i32 destinationMixId;
+            i32 destinationSplitterId;
+            u32 _unk2_[2];
+        };
+        static_assert(sizeof(MixIn) == 0x930);
+
+        /**
+         * @brief The header of the mix section when only dirty mixes are supplied
+         */
+        struct MixInDirtyHeader {
+            u32 magic;
+            u32 mixCount; //!< The amount of dirty mixes following the header
+            u32 _pad0_[6];
+        };
+        static_assert(sizeof(MixInDirtyHeader) == 0x20);
+
+        /**
+         * @brief The state of a mix which is retained across updates
+         */
+        struct Mix {
+            MixIn parameters{};
+            u32 bufferOffset{}; //!< The index of the first buffer of this mix in the mix buffers, this is assigned every update
+        };
+    }
+}
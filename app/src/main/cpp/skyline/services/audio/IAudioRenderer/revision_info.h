@@ -17,6 +17,7 @@ namespace skyline {
             constexpr u32 PerformanceMetricsDataFormatV2{5}; //!< The revision a new performance metrics format is used
             constexpr u32 VaradicCommandBufferSize{5}; //!< The revision support for varying command buffer sizes was added
             constexpr u32 ElapsedFrameCount{5}; //!< The revision support for counting elapsed frames was added
+            constexpr u32 MixInParameterDirtyOnlyUpdate{7}; //!< The revision mixes started being updated with only the dirty mixes being supplied
         }
     }
 
@@ -83,6 +84,13 @@ namespace skyline {
             bool ElapsedFrameCountSupported() {
                 return userRevision >= constant::supportTags::ElapsedFrameCount;
             }
+
+            /**
+             * @return Whether only dirty mixes are supplied in an update
+             */
+            bool MixInParameterDirtyOnlyUpdateSupported() {
+                return userRevision >= constant::supportTags::MixInParameterDirtyOnlyUpdate;
+            }
         };
     }
 }
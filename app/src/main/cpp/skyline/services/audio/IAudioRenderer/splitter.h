@@ -0,0 +1,60 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2023 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#pragma once
+
+#include <common.h>
+#include "mix.h"
+
+namespace skyline {
+    namespace constant {
+        constexpr u32 SplitterHeaderMagic{util::MakeMagic<u32>("SNDH")};
+        constexpr u32 SplitterInfoMagic{util::MakeMagic<u32>("SNDI")};
+        constexpr u32 SplitterDestinationMagic{util::MakeMagic<u32>("SNDD")};
+    }
+
+    namespace service::audio::IAudioRenderer {
+        /**
+         * @brief The header of the splitter section
+         */
+        struct SplitterHeader {
+            u32 magic; //!< SNDH
+            u32 infoCount;
+            u32 destinationCount;
+            u32 _pad0_[5];
+        };
+        static_assert(sizeof(SplitterHeader) == 0x20);
+
+        /**
+         * @brief Input containing the parameters of a splitter, this is followed by the IDs of its destinations
+         */
+        struct SplitterInfoIn {
+            u32 magic; //!< SNDI
+            i32 id;
+            u32 sampleRate;
+            u32 destinationCount;
+        };
+        static_assert(sizeof(SplitterInfoIn) == 0x10);
+
+        /**
+         * @brief Input containing the parameters of a single destination of a splitter
+         */
+        struct SplitterDestinationIn {
+            u32 magic; //!< SNDD
+            i32 id;
+            std::array<float, constant::MaxMixBuffers> mixVolumes; //!< The volumes to mix the source channel into each buffer of the destination mix with
+            i32 mixId;
+            bool inUse;
+            u8 _pad0_[3];
+        };
+        static_assert(sizeof(SplitterDestinationIn) == 0x70);
+
+        /**
+         * @brief A splitter which sends each channel of its source to several destinations
+         * @note Destinations are laid out in groups of the source's channel count, a group sends each source channel to the same mix
+         */
+        struct Splitter {
+            std::vector<i32> destinationIds;
+        };
+    }
+}
@@ -19,6 +19,7 @@ namespace skyline::service::audio::IAudioRenderer {
             bufferReload = true;
             bufferIndex = 0;
             sampleOffset = 0;
+            mixVolume = 0;
 
             output.playedSamplesCount = 0;
             output.playedWaveBuffersCount = 0;
@@ -50,11 +51,17 @@ namespace skyline::service::audio::IAudioRenderer {
             }
 
             SetWaveBufferIndex(static_cast<u8>(input.baseWaveBufferIndex));
+            biquadStates = {};
+            resampler.Reset();
         }
 
         waveBuffers = input.waveBuffers;
         volume = input.volume;
         playbackState = input.playbackState;
+        mixId = input.mixId;
+        splitterId = input.splitterId;
+        channelResourceIds = input.voiceChannelResourceIds;
+        biquadFilters = input.biquadFilters;
     }
 
     void Voice::UpdateBuffers() {
@@ -70,15 +77,20 @@ namespace skyline::service::audio::IAudioRenderer {
                 span(samples).copy_from(buffer);
                 break;
             case skyline::audio::AudioFormat::ADPCM: {
-                samples = adpcmDecoder->Decode(buffer);
+                adpcmDecoder->Decode(buffer, samples);
                 break;
             }
             default:
                 throw exception("Unsupported PCM format used by Voice: {}", format);
         }
 
-        if (sampleRate != constant::SampleRate)
-            samples = resampler.ResampleBuffer(samples, static_cast<double>(sampleRate) / constant::SampleRate, channelCount);
+        if (sampleRate != constant::SampleRate) {
+            // The resampled samples are swapped with the source samples so the capacity of both buffers is reused by subsequent wave buffers
+            auto ratio{static_cast<double>(sampleRate) / constant::SampleRate};
+            resampledSamples.resize(skyline::audio::Resampler::GetMaxOutputSize(samples.size(), ratio, channelCount));
+            resampledSamples.resize(resampler.Resample(samples, resampledSamples, ratio, channelCount));
+            std::swap(samples, resampledSamples);
+        }
 
         if (channelCount == 1 && constant::StereoChannelCount != channelCount) {
             auto originalSize{samples.size()};
@@ -92,8 +104,16 @@ namespace skyline::service::audio::IAudioRenderer {
         }
 
         if (channelCount == constant::SurroundChannelCount) {
-            span(samples).copy_from(span(skyline::audio::DownMix(span(samples).cast<skyline::audio::Surround51Sample>())));
-            samples.resize((samples.size() / constant::SurroundChannelCount) * constant::StereoChannelCount);
+            auto surroundSamples{span(samples).cast<skyline::audio::Surround51Sample>()};
+            skyline::audio::DownMix(surroundSamples, span(samples).cast<skyline::audio::StereoSample>().first(surroundSamples.size()));
+            samples.resize(surroundSamples.size() * constant::StereoChannelCount);
+        }
+    }
+
+    void Voice::PrepareBuffers() {
+        if (BuffersPending()) {
+            bufferReload = false;
+            UpdateBuffers();
         }
     }
 
@@ -105,10 +125,7 @@ namespace skyline::service::audio::IAudioRenderer {
             return samples;
         }
 
-        if (bufferReload) {
-            bufferReload = false;
-            UpdateBuffers();
-        }
+        PrepareBuffers();
 
         outOffset = sampleOffset;
         outSize = std::min(maxSamples * constant::StereoChannelCount, static_cast<u32>(samples.size() - sampleOffset));
@@ -130,4 +147,40 @@ namespace skyline::service::audio::IAudioRenderer {
 
         return samples;
     }
+
+    void Voice::Render(span<float> left, span<float> right) {
+        std::fill(left.begin(), left.end(), 0.0f);
+        std::fill(right.begin(), right.end(), 0.0f);
+
+        // The volume is ramped across the entire mix buffer, regardless of how many samples the voice has
+        float frameVolume{mixVolume};
+        float volumeStep{(volume - mixVolume) / constant::MixBufferSize};
+
+        u32 frameOffset{};
+        u32 pendingFrames{constant::MixBufferSize};
+        while (pendingFrames > 0) {
+            u32 bufferOffset{};
+            u32 bufferSize{};
+            auto &bufferSamples{GetBufferData(pendingFrames, bufferOffset, bufferSize)};
+            if (bufferSize == 0)
+                break;
+
+            u32 frameCount{bufferSize / constant::StereoChannelCount};
+            skyline::audio::DeinterleaveSamples(span(bufferSamples).subspan(bufferOffset, bufferSize), left.subspan(frameOffset), right.subspan(frameOffset), frameVolume, volumeStep);
+
+            frameVolume += volumeStep * static_cast<float>(frameCount);
+            frameOffset += frameCount;
+            pendingFrames -= frameCount;
+        }
+
+        mixVolume = volume;
+
+        for (size_t filter{}; filter < biquadFilters.size(); filter++) {
+            if (!biquadFilters[filter].enable)
+                continue;
+
+            skyline::audio::ApplyBiquadFilter(left, left, biquadFilters[filter].coefficients, biquadStates[filter][0]);
+            skyline::audio::ApplyBiquadFilter(right, right, biquadFilters[filter].coefficients, biquadStates[filter][1]);
+        }
+    }
 }
@@ -5,17 +5,15 @@
 
 #include <audio/resampler.h>
 #include <audio/adpcm_decoder.h>
+#include <audio/mixer.h>
 #include <audio.h>
+#include "mix.h"
 
 namespace skyline::service::audio::IAudioRenderer {
     struct BiquadFilter {
         u8 enable;
         u8 _pad0_;
-        u16 b0;
-        u16 b1;
-        u16 b2;
-        u16 a1;
-        u16 a2;
+        skyline::audio::BiquadCoefficients coefficients;
     };
     static_assert(sizeof(BiquadFilter) == 0xC);
 
@@ -53,8 +51,8 @@ namespace skyline::service::audio::IAudioRenderer {
         u32 _unk1_;
         u32 *adpcmCoeffs;
         u64 adpcmCoeffsSize;
-        u32 destination;
-        u32 _pad0_;
+        i32 mixId; //!< The ID of the mix the voice is output to
+        i32 splitterId; //!< The ID of the splitter the voice is output to, this takes precedence over the mix
         std::array<WaveBuffer, 4> waveBuffers;
         std::array<u32, 6> voiceChannelResourceIds;
         u32 _pad1_[6];
@@ -62,6 +60,17 @@ namespace skyline::service::audio::IAudioRenderer {
     static_assert(sizeof(VoiceIn) == 0x170);
 
 
+    /**
+     * @brief Input containing the volumes to mix a single channel of a voice into each buffer of its destination mix with
+     */
+    struct VoiceChannelResourceIn {
+        u32 id;
+        std::array<float, constant::MaxMixBuffers> mixVolumes;
+        bool inUse;
+        u8 _pad0_[11];
+    };
+    static_assert(sizeof(VoiceChannelResourceIn) == 0x70);
+
     struct VoiceOut {
         u64 playedSamplesCount;
         u32 playedWaveBuffersCount;
@@ -78,6 +87,7 @@ namespace skyline::service::audio::IAudioRenderer {
         std::array<WaveBuffer, 4> waveBuffers;
         std::vector<i16> samples; //!< A vector containing processed sample data
         skyline::audio::Resampler resampler; //!< The resampler object used for changing the sample rate of a wave buffer's stream
+        std::vector<i16> resampledSamples; //!< A scratch buffer for the output of the resampler
         std::optional<skyline::audio::AdpcmDecoder> adpcmDecoder;
 
         bool acquired{false}; //!< If the voice is in use
@@ -88,6 +98,8 @@ namespace skyline::service::audio::IAudioRenderer {
         u8 channelCount{};
         skyline::audio::AudioOutState playbackState{skyline::audio::AudioOutState::Stopped};
         skyline::audio::AudioFormat format{skyline::audio::AudioFormat::Invalid};
+        std::array<BiquadFilter, 2> biquadFilters{};
+        std::array<std::array<std::array<float, 2>, constant::StereoChannelCount>, 2> biquadStates{}; //!< The state of each biquad filter for each output channel
 
         /**
          * @brief Updates the sample buffer with data from the current wave buffer and processes it
@@ -103,6 +115,10 @@ namespace skyline::service::audio::IAudioRenderer {
       public:
         VoiceOut output{};
         float volume{};
+        float mixVolume{}; //!< The volume the voice was last mixed at, mixing ramps from this to the current volume to avoid discontinuities from abrupt volume changes
+        i32 mixId{constant::UnusedMixId};
+        i32 splitterId{constant::UnusedSplitterId};
+        std::array<u32, constant::SurroundChannelCount> channelResourceIds{}; //!< The IDs of the channel resources holding the mix volumes of every channel
 
         Voice(const DeviceState &state);
 
@@ -112,6 +128,19 @@ namespace skyline::service::audio::IAudioRenderer {
          */
         void ProcessInput(const VoiceIn &input);
 
+        /**
+         * @return If the current wave buffer of a playing voice still has to be decoded
+         */
+        bool BuffersPending() const {
+            return bufferReload && acquired && playbackState == skyline::audio::AudioOutState::Started;
+        }
+
+        /**
+         * @brief Decodes the current wave buffer ahead of rendering if it hasn't been already
+         * @note This only touches the state of this voice so it can be called for multiple voices concurrently
+         */
+        void PrepareBuffers();
+
         /**
          * @brief Obtains the voices audio sample data, updating it if required
          * @param maxSamples The maximum amount of samples the output buffer should contain
@@ -119,6 +148,19 @@ namespace skyline::service::audio::IAudioRenderer {
          */
         std::vector<i16> &GetBufferData(u32 maxSamples, u32 &outOffset, u32 &outSize);
 
+        /**
+         * @brief Renders a mix buffer worth of samples from the voice into a pair of planar buffers, ramping the volume and applying the biquad filters
+         * @note Voices are always rendered as stereo, mono voices are replicated into both channels while surround voices are downmixed
+         */
+        void Render(span<float> left, span<float> right);
+
+        /**
+         * @return The amount of source channels that should be routed to the voice's destination, this is one for mono voices as both rendered channels are identical
+         */
+        u8 GetRoutedChannelCount() const {
+            return channelCount == 1 ? 1 : constant::StereoChannelCount;
+        }
+
         /**
          * @return If the voice is currently playable
          */
@@ -3,6 +3,7 @@
 
 #include <cxxabi.h>
 #include <common/trace.h>
+#include "serviceman.h"
 #include "base_service.h"
 
 namespace skyline::service {
@@ -25,14 +26,24 @@ namespace skyline::service {
 
         try {
             function = GetServiceFunction(functionId, request.isTipc);
-            Logger::DebugNoPrefix("Service: {}", function.name);
+            Logger::DebugNoPrefix("Service: {}", Logger::StaticString{function.name});
         } catch (const std::out_of_range &) {
             Logger::Warn("Cannot find {0} function in service '{1}': 0x{2:X} ({2})", request.isTipc ? "TIPC" : "HIPC", GetName(), static_cast<u32>(functionId));
             return {};
         }
-        TRACE_EVENT("service", perfetto::StaticString{function.name});
+        TRACE_EVENT("service", perfetto::StaticString{function.name}, "id", functionId);
+
+        u64 bytes{request.cmdArgSz};
+        for (const auto &buffer : request.inputBuf)
+            bytes += buffer.size();
+        for (const auto &buffer : request.outputBuf)
+            bytes += buffer.size();
+
+        u64 startTicks{util::GetTimeTicks()};
         try {
-            return function(session, request, response);
+            Result result{function(session, request, response)};
+            manager.RecordCommand(function.name, functionId, util::GetTimeTicks() - startTicks, bytes);
+            return result;
         } catch (exception &e) {
             // We need to forward any skyline::exception objects without modification even though they inherit from std::exception
             std::rethrow_exception(std::current_exception());
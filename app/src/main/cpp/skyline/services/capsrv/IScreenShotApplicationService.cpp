@@ -5,4 +5,14 @@
 
 namespace skyline::service::capsrv {
     IScreenShotApplicationService::IScreenShotApplicationService(const DeviceState &state, ServiceManager &manager) : BaseService(state, manager) {}
-}
\ No newline at end of file
+
+    Result IScreenShotApplicationService::SetShimLibraryVersion(type::KSession &session, ipc::IpcRequest &request, ipc::IpcResponse &response) {
+        return {};
+    }
+
+    Result IScreenShotApplicationService::SaveScreenShotEx0(type::KSession &session, ipc::IpcRequest &request, ipc::IpcResponse &response) {
+        constexpr size_t ApplicationAlbumEntrySize{0x20};
+        response.Push(std::array<u8, ApplicationAlbumEntrySize>{}); // An empty entry signifies that the screenshot doesn't exist in the album
+        return {};
+    }
+}
@@ -13,5 +13,22 @@ namespace skyline::service::capsrv {
     class IScreenShotApplicationService : public BaseService {
       public:
         IScreenShotApplicationService(const DeviceState &state, ServiceManager &manager);
+
+        /**
+         * @url https://switchbrew.org/wiki/Capture_services#SetShimLibraryVersion
+         */
+        Result SetShimLibraryVersion(type::KSession &session, ipc::IpcRequest &request, ipc::IpcResponse &response);
+
+        /**
+         * @brief Saves an application supplied screenshot to the album
+         * @note Screenshots aren't stored as there's no album, this returns immediately without encoding the supplied image
+         * @url https://switchbrew.org/wiki/Capture_services#SaveScreenShotEx0
+         */
+        Result SaveScreenShotEx0(type::KSession &session, ipc::IpcRequest &request, ipc::IpcResponse &response);
+
+        SERVICE_DECL(
+            SFUNC(0x20, IScreenShotApplicationService, SetShimLibraryVersion),
+            SFUNC(0xCB, IScreenShotApplicationService, SaveScreenShotEx0)
+        )
     };
-}
\ No newline at end of file
+}
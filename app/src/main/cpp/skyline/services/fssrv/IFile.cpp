@@ -1,13 +1,14 @@
 // SPDX-License-Identifier: MPL-2.0
 // Copyright © 2020 Skyline Team and Contributors (https://github.com/skyline-emu/)
 
+#include <vfs/readahead_backing.h>
 #include "results.h"
 #include "IFile.h"
 
 namespace skyline::service::fssrv {
     IFile::IFile(std::shared_ptr<vfs::Backing> backing, const DeviceState &state, ServiceManager &manager)
         : BaseService(state, manager),
-          backing(std::move(backing)) {}
+          backing((backing->mode.write || backing->mode.append) ? std::move(backing) : std::make_shared<vfs::ReadaheadBacking>(std::move(backing))) {}
 
     Result IFile::Read(type::KSession &session, ipc::IpcRequest &request, ipc::IpcResponse &response) {
         auto readOption{request.Pop<u32>()};
@@ -59,6 +60,7 @@ namespace skyline::service::fssrv {
     }
 
     Result IFile::Flush(type::KSession &session, ipc::IpcRequest &request, ipc::IpcResponse &response) {
+        backing->Flush();
         return {};
     }
 
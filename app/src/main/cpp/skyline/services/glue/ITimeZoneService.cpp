@@ -53,10 +53,12 @@ namespace skyline::service::glue {
 
     Result ITimeZoneService::LoadTimeZoneRule(type::KSession &session, ipc::IpcRequest &request, ipc::IpcResponse &response) {
         auto locationName{span(request.Pop<timesrv::LocationName>()).as_string(true)};
-        auto timeZoneBinaryFile{state.os->assetFileSystem->OpenFile(fmt::format("tzdata/zoneinfo/{}", locationName))};
-        std::vector<u8> timeZoneBinaryBuffer(timeZoneBinaryFile->size);
-        timeZoneBinaryFile->Read(timeZoneBinaryBuffer);
-        return core->ParseTimeZoneBinary(timeZoneBinaryBuffer, request.outputBuf.at(0));
+        return timesrvCore.timeZoneManager.LoadTimeZoneRule(locationName, request.outputBuf.at(0), [&] {
+            auto timeZoneBinaryFile{state.os->assetFileSystem->OpenFile(fmt::format("tzdata/zoneinfo/{}", locationName))};
+            std::vector<u8> timeZoneBinaryBuffer(timeZoneBinaryFile->size);
+            timeZoneBinaryFile->Read(timeZoneBinaryBuffer);
+            return timeZoneBinaryBuffer;
+        });
     }
 
     Result ITimeZoneService::GetTimeZoneRuleVersion(type::KSession &session, ipc::IpcRequest &request, ipc::IpcResponse &response) {
@@ -34,10 +34,12 @@ namespace skyline::service::hid {
     }
 
     Result IHidServer::StartSixAxisSensor(type::KSession &session, ipc::IpcRequest &request, ipc::IpcResponse &response) {
+        state.input->motion.Start();
         return {};
     }
 
     Result IHidServer::StopSixAxisSensor(type::KSession &session, ipc::IpcRequest &request, ipc::IpcResponse &response) {
+        state.input->motion.Stop();
         return {};
     }
 
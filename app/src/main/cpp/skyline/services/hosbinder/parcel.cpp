@@ -12,11 +12,12 @@ namespace skyline::service::hosbinder {
 
         constexpr u8 tokenLength{0x50}; // The length of the token on BufferQueue parcels
 
-        data.resize(header.dataSize - (hasToken ? tokenLength : 0));
-        std::memcpy(data.data(), buffer.data() + header.dataOffset + (hasToken ? tokenLength : 0), header.dataSize - (hasToken ? tokenLength : 0));
+        if (static_cast<u64>(header.dataOffset) + header.dataSize > buffer.size() || static_cast<u64>(header.objectsOffset) + header.objectsSize > buffer.size() || (hasToken && header.dataSize < tokenLength))
+            throw exception("The parcel's data (0x{:X} + 0x{:X}) or objects (0x{:X} + 0x{:X}) exceed the size of the buffer (0x{:X})", header.dataOffset, header.dataSize, header.objectsOffset, header.objectsSize, buffer.size());
 
-        objects.resize(header.objectsSize);
-        std::memcpy(objects.data(), buffer.data() + header.objectsOffset, header.objectsSize);
+        // The IPC buffer has been validated to be in guest memory and the parcel is only used for the duration of the transaction, so it's read in-place without copying it
+        inputData = buffer.subspan(header.dataOffset + (hasToken ? tokenLength : 0), header.dataSize - (hasToken ? tokenLength : 0));
+        inputObjects = buffer.subspan(header.objectsOffset, header.objectsSize);
     }
 
     Parcel::Parcel(const DeviceState &state) : state(state) {}
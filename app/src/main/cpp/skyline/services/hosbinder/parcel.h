@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include <boost/container/small_vector.hpp>
 #include <kernel/ipc.h>
 
 namespace skyline::service::hosbinder {
@@ -22,14 +23,19 @@ namespace skyline::service::hosbinder {
 
         const DeviceState &state;
 
+        static constexpr size_t InlineDataSize{0x200}; //!< The size of the inline storage for the data of a parcel, this fits the largest data of any GraphicBufferProducer transaction so that BufferQueue transactions every frame don't require any heap allocations
+        static constexpr size_t InlineObjectsSize{0x10}; //!< The size of the inline storage for the objects of a parcel, parcels from BufferQueue transactions contain at most a single object
+
       public:
-        std::vector<u8> data;
-        std::vector<u8> objects;
+        boost::container::small_vector<u8, InlineDataSize> data; //!< The data written to the parcel
+        boost::container::small_vector<u8, InlineObjectsSize> objects; //!< The objects written to the parcel
+        span<u8> inputData{}; //!< A view of the data of a parcel read from an IPC buffer, this directly references guest memory rather than a copy of it
+        span<u8> inputObjects{}; //!< A view of the objects of a parcel read from an IPC buffer
         size_t dataOffset{}; //!< The offset of the data read from the parcel
 
         /**
-         * @brief This constructor fills in the Parcel object with data from a IPC buffer
-         * @param buffer The buffer that contains the parcel
+         * @brief This constructor creates a Parcel object which reads from an IPC buffer in-place
+         * @param buffer The buffer that contains the parcel, it must outlive the parcel
          * @param hasToken If the parcel starts with a token, it's skipped if this flag is true
          */
         Parcel(span<u8> buffer, const DeviceState &state, bool hasToken = false);
@@ -44,7 +50,9 @@ namespace skyline::service::hosbinder {
          */
         template<typename ValueType>
         ValueType &Pop() {
-            ValueType &value{*reinterpret_cast<ValueType *>(data.data() + dataOffset)};
+            if (dataOffset + sizeof(ValueType) > inputData.size())
+                throw exception("Popping 0x{:X} bytes at 0x{:X} from a parcel with 0x{:X} bytes of data", sizeof(ValueType), dataOffset, inputData.size());
+            ValueType &value{*reinterpret_cast<ValueType *>(inputData.data() + dataOffset)};
             dataOffset += sizeof(ValueType);
             return value;
         }
@@ -75,7 +83,7 @@ namespace skyline::service::hosbinder {
         template<typename ValueType>
         void Push(const ValueType &value) {
             auto offset{data.size()};
-            data.resize(offset + sizeof(ValueType));
+            data.resize(offset + sizeof(ValueType), boost::container::default_init);
             std::memcpy(data.data() + offset, &value, sizeof(ValueType));
         }
 
@@ -105,7 +113,7 @@ namespace skyline::service::hosbinder {
         template<typename ObjectType>
         void PushObject(const ObjectType &object) {
             auto offset{objects.size()};
-            objects.resize(offset + sizeof(ObjectType));
+            objects.resize(offset + sizeof(ObjectType), boost::container::default_init);
             std::memcpy(objects.data() + offset, &object, sizeof(ObjectType));
         }
 
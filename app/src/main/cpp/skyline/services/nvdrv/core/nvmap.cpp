@@ -59,9 +59,10 @@ namespace skyline::service::nvdrv::core {
     NvMap::NvMap(const DeviceState &state) : state(state), smmuAllocator(soc::SmmuPageSize) {}
 
     void NvMap::AddHandle(std::shared_ptr<Handle> handleDesc) {
-        std::scoped_lock lock(handlesLock);
+        auto &shard{GetHandleShard(handleDesc->id)};
+        std::scoped_lock lock(shard.mutex);
 
-        handles.emplace(handleDesc->id, std::move(handleDesc));
+        shard.handles.emplace(handleDesc->id, std::move(handleDesc));
     }
 
     void NvMap::UnmapHandle(Handle &handleDesc) {
@@ -77,15 +78,28 @@ namespace skyline::service::nvdrv::core {
         handleDesc.pinVirtAddress = 0;
     }
 
+    bool NvMap::UnmapQueuedHandle() {
+        for (auto freeHandleDesc : unmapQueue) { // A copy of the reference is required as UnmapHandle erases the queue entry
+            // Handles in the unmap queue are guaranteed not to be pinned so don't bother checking if they are before unmapping
+            std::unique_lock freeLock(freeHandleDesc->mutex, std::try_to_lock);
+            if (freeLock) {
+                UnmapHandle(*freeHandleDesc);
+                return true;
+            }
+        }
+
+        return false;
+    }
 
     bool NvMap::TryRemoveHandle(const Handle &handleDesc) {
         // No dupes left, we can remove from handle map
         if (handleDesc.dupes == 0 && handleDesc.internalDupes == 0) {
-            std::scoped_lock lock(handlesLock);
+            auto &shard{GetHandleShard(handleDesc.id)};
+            std::scoped_lock lock(shard.mutex);
 
-            auto it{handles.find(handleDesc.id)};
-            if (it != handles.end())
-                handles.erase(it);
+            auto it{shard.handles.find(handleDesc.id)};
+            if (it != shard.handles.end())
+                shard.handles.erase(it);
 
             return true;
         } else {
@@ -105,13 +119,11 @@ namespace skyline::service::nvdrv::core {
     }
 
     std::shared_ptr<NvMap::Handle> NvMap::GetHandle(Handle::Id handle) {
-        std::scoped_lock lock(handlesLock);
+        auto &shard{GetHandleShard(handle)};
+        std::scoped_lock lock(shard.mutex);
 
-        try {
-            return handles.at(handle);
-        } catch (std::out_of_range &e) {
-            return nullptr;
-        }
+        auto it{shard.handles.find(handle)};
+        return it != shard.handles.end() ? it->second : nullptr;
     }
 
     u32 NvMap::PinHandle(NvMap::Handle::Id handle) {
@@ -122,30 +134,28 @@ namespace skyline::service::nvdrv::core {
         std::scoped_lock lock(handleDesc->mutex);
         if (!handleDesc->pins) {
             // If we're in the unmap queue we can just remove ourselves and return since we're already mapped
-            {
-                // Lock now to prevent our queue entry from being removed for allocation in-between the following check and erase
+            // The queue entry can only be removed while holding the handle's mutex so it's safe to check without locking the queue
+            if (handleDesc->unmapQueueEntry) {
                 std::scoped_lock queueLock(unmapQueueLock);
-                if (handleDesc->unmapQueueEntry) {
-                    unmapQueue.erase(*handleDesc->unmapQueueEntry);
-                    handleDesc->unmapQueueEntry.reset();
+                unmapQueue.erase(*handleDesc->unmapQueueEntry);
+                handleDesc->unmapQueueEntry.reset();
 
-                    handleDesc->pins++;
-                    return handleDesc->pinVirtAddress;
-                }
+                handleDesc->pins++;
+                return handleDesc->pinVirtAddress;
             }
 
             // If not then allocate some space and map it
             u32 address{};
             while (!(address = smmuAllocator.Allocate(static_cast<u32>(handleDesc->alignedSize)))) {
-                // Free handles until the allocation succeeds
-                std::scoped_lock queueLock(unmapQueueLock);
-                if (auto freeHandleDesc{unmapQueue.front()}) {
-                    // Handles in the unmap queue are guaranteed not to be pinned so don't bother checking if they are before unmapping
-                    std::scoped_lock freeLock(freeHandleDesc->mutex);
-                    if (handleDesc->pinVirtAddress)
-                        UnmapHandle(*freeHandleDesc);
-                } else {
+                // Lazily free handles from the unmap queue until the allocation succeeds
+                std::unique_lock queueLock(unmapQueueLock);
+                if (unmapQueue.empty())
                     throw exception("Ran out of SMMU address space!");
+
+                if (!UnmapQueuedHandle()) {
+                    // Every queued handle is locked by a thread that may be waiting on the queue, let it make progress before retrying
+                    queueLock.unlock();
+                    std::this_thread::yield();
                 }
             }
 
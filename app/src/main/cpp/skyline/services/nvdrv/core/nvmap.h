@@ -82,12 +82,28 @@ namespace skyline::service::nvdrv::core {
         std::list<std::shared_ptr<Handle>> unmapQueue;
         std::mutex unmapQueueLock; //!< Protects access to `unmapQueue`
 
-        std::unordered_map<Handle::Id, std::shared_ptr<Handle>> handles; //!< Main owning map of handles
-        std::mutex handlesLock; //!< Protects access to `handles`
-
         static constexpr u32 HandleIdIncrement{4}; //!< Each new handle ID is an increment of 4 from the previous
         std::atomic<u32> nextHandleId{HandleIdIncrement};
 
+        /**
+         * @brief A shard of the owning map of handles with its own lock, handles are distributed across shards by their ID so that lookups from different threads rarely contend
+         */
+        struct HandleShard {
+            std::mutex mutex; //!< Protects access to `handles`
+            std::unordered_map<Handle::Id, std::shared_ptr<Handle>> handles;
+        };
+
+        static constexpr size_t HandleShardCount{16}; //!< The amount of shards handles are striped across, this must be a power of two
+        std::array<HandleShard, HandleShardCount> handleShards;
+
+        /**
+         * @return The shard that a handle with the supplied ID is stored in
+         */
+        HandleShard &GetHandleShard(Handle::Id id) {
+            // Consecutive IDs are mapped to consecutive shards as they're all multiples of the increment
+            return handleShards[(id / HandleIdIncrement) & (HandleShardCount - 1)];
+        }
+
         void AddHandle(std::shared_ptr<Handle> handle);
 
         /**
@@ -96,6 +112,13 @@ namespace skyline::service::nvdrv::core {
          */
         void UnmapHandle(Handle &handleDesc);
 
+        /**
+         * @brief Unmaps the least recently unpinned handle in the unmap queue to free up SMMU address space
+         * @note `unmapQueueLock` MUST be locked when calling this, handles which are locked by other threads are skipped as their locks can't be acquired in order
+         * @return If a handle was unmapped, a handle may not be unmapped despite the queue not being empty if all handles in it were locked
+         */
+        bool UnmapQueuedHandle();
+
         /**
          * @brief Removes a handle from the map taking its dupes into account
          * @note handleDesc.mutex MUST be locked when calling this
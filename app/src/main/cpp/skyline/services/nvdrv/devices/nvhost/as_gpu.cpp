@@ -2,7 +2,10 @@
 // Copyright © 2021 Skyline Team and Contributors (https://github.com/skyline-emu/)
 
 #include <common/address_space.inc>
+#include <common/settings.h>
+#include <vfs/os_filesystem.h>
 #include <soc.h>
+#include <os.h>
 #include <soc/gm20b/gmmu.h>
 #include <services/nvdrv/driver.h>
 #include <services/nvdrv/devices/deserialisation/deserialisation.h>
@@ -76,7 +79,7 @@ namespace skyline::service::nvdrv::device::nvhost {
         u64 size{static_cast<u64>(pages) * pageSize};
 
         if (flags.sparse)
-            asCtx->gmmu.Map(offset, GMMU::SparsePlaceholderAddress(), size, {true});
+            asCtx->Map(offset, GMMU::SparsePlaceholderAddress(), size, {true});
 
         allocationMap[offset] = {
             .size = size,
@@ -100,9 +103,9 @@ namespace skyline::service::nvdrv::device::nvhost {
         // Sparse mappings shouldn't be fully unmapped, just returned to their sparse state
         // Only FreeSpace can unmap them fully
         if (mapping->sparseAlloc)
-            asCtx->gmmu.Map(offset, GMMU::SparsePlaceholderAddress(), mapping->size, {true});
+            asCtx->Map(offset, GMMU::SparsePlaceholderAddress(), mapping->size, {true});
         else
-            asCtx->gmmu.Unmap(offset, mapping->size);
+            asCtx->Unmap(offset, mapping->size);
 
         mappingMap.erase(offset);
     }
@@ -126,7 +129,7 @@ namespace skyline::service::nvdrv::device::nvhost {
 
             // Unset sparse flag if required
             if (allocation.sparse)
-                asCtx->gmmu.Unmap(offset, allocation.size);
+                asCtx->Unmap(offset, allocation.size);
 
             auto &allocator{pageSize == VM::PageSize ? *vm.smallPageAllocator : *vm.bigPageAllocator};
             u32 pageSizeBits{pageSize == VM::PageSize ? VM::PageSizeBits : vm.bigPageSizeBits};
@@ -181,7 +184,7 @@ namespace skyline::service::nvdrv::device::nvhost {
                 u64 gpuAddress{offset + bufferOffset};
                 u8 *cpuPtr{mapping->ptr + bufferOffset};
 
-                asCtx->gmmu.Map(gpuAddress, cpuPtr, mappingSize);
+                asCtx->Map(gpuAddress, cpuPtr, mappingSize);
 
                 return PosixResult::Success;
             } catch (const std::out_of_range &e) {
@@ -203,7 +206,7 @@ namespace skyline::service::nvdrv::device::nvhost {
             if (alloc-- == allocationMap.begin() || (offset - alloc->first) + size > alloc->second.size)
                 throw exception("Cannot perform a fixed mapping into an unallocated region!");
 
-            asCtx->gmmu.Map(offset, cpuPtr, size);
+            asCtx->Map(offset, cpuPtr, size);
 
             auto mapping{std::make_shared<Mapping>(cpuPtr, offset, size, true, false, alloc->second.sparse)};
             alloc->second.mappings.push_back(mapping);
@@ -226,7 +229,7 @@ namespace skyline::service::nvdrv::device::nvhost {
             if (!offset)
                 throw exception("Failed to allocate free space in the GPU AS!");
 
-            asCtx->gmmu.Map(offset, cpuPtr, size);
+            asCtx->Map(offset, cpuPtr, size);
 
             auto mapping{std::make_shared<Mapping>(cpuPtr, offset, size, false, bigPage, false)};
             mappingMap[offset] = mapping;
@@ -309,6 +312,15 @@ namespace skyline::service::nvdrv::device::nvhost {
         vm.bigPageAllocator = std::make_unique<VM::Allocator>(startBigPages, endBigPages);
 
         asCtx = std::make_shared<soc::gm20b::AddressSpaceContext>();
+        if (*state.settings->gpfifoCapture) {
+            static std::atomic<u32> captureIndex{}; //!< Every AS is captured into a separate file as they're replayed independently
+            try {
+                auto captureFileSystem{std::make_shared<vfs::OsFileSystem>(state.os->publicAppFilesPath + "gpfifo_captures/")};
+                asCtx->capture = std::make_unique<soc::gm20b::GpfifoCapture>(captureFileSystem, util::Format("as_{}.gpcap", captureIndex++));
+            } catch (const std::exception &e) {
+                Logger::Warn("Failed to start GPFIFO capture: {}", e.what());
+            }
+        }
         vm.initialised = true;
 
         return PosixResult::Success;
@@ -320,6 +332,9 @@ namespace skyline::service::nvdrv::device::nvhost {
         if (!vm.initialised)
             return PosixResult::InvalidArgument;
 
+        // All entries are validated before any are applied so that an invalid entry doesn't leave the batch partially mapped
+        std::vector<GMMU::BatchMapping> mappings;
+        mappings.reserve(entries.size());
         for (const auto &entry : entries) {
             u64 virtAddr{static_cast<u64>(entry.asOffsetBigPages) << vm.bigPageSizeBits};
             u64 size{static_cast<u64>(entry.bigPages) << vm.bigPageSizeBits};
@@ -336,19 +351,29 @@ namespace skyline::service::nvdrv::device::nvhost {
                 return PosixResult::InvalidArgument;
             }
 
-            if (!entry.handle) {
-                asCtx->gmmu.Map(virtAddr, GMMU::SparsePlaceholderAddress(), size, {true});
-            } else {
+            bool sparse{!entry.handle};
+            u8 *cpuPtr{GMMU::SparsePlaceholderAddress()};
+            if (!sparse) {
                 auto h{core.nvMap.GetHandle(entry.handle)};
                 if (!h)
                     return PosixResult::InvalidArgument;
 
-                u8 *cpuPtr{reinterpret_cast<u8 *>(h->address + (static_cast<u64>(entry.handleOffsetBigPages) << vm.bigPageSizeBits))};
+                cpuPtr = reinterpret_cast<u8 *>(h->address + (static_cast<u64>(entry.handleOffsetBigPages) << vm.bigPageSizeBits));
+            }
 
-                asCtx->gmmu.Map(virtAddr, cpuPtr, size);
+            // Entries that continue the previous one in both the GPU and CPU AS are merged into it, this is common for sparse textures where consecutive tiles are backed by consecutive memory
+            if (!mappings.empty()) {
+                auto &last{mappings.back()};
+                if (last.virt + last.size == virtAddr && last.extraInfo.sparseMapped == sparse && (sparse || last.phys + last.size == cpuPtr)) {
+                    last.size += size;
+                    continue;
+                }
             }
+
+            mappings.push_back({virtAddr, cpuPtr, size, {sparse}});
         }
 
+        asCtx->MapBatch(mappings);
         return PosixResult::Success;
     }
 
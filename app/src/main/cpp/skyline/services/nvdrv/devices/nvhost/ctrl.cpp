@@ -7,7 +7,7 @@
 #include "ctrl.h"
 
 namespace skyline::service::nvdrv::device::nvhost {
-    Ctrl::SyncpointEvent::SyncpointEvent(const DeviceState &state) : event(std::make_shared<type::KEvent>(state, false)) {}
+    Ctrl::SyncpointEvent::SyncpointEvent(const DeviceState &state) : waiter([this] { Signal(); }), event(std::make_shared<type::KEvent>(state, false)) {}
 
     void Ctrl::SyncpointEvent::Signal() {
         // We should only signal the KEvent if the event is actively being waited on
@@ -18,14 +18,13 @@ namespace skyline::service::nvdrv::device::nvhost {
     }
 
     void Ctrl::SyncpointEvent::Cancel(soc::host1x::Host1x &host1x) {
-        host1x.syncpoints.at(fence.id).DeregisterWaiter(waiterHandle);
-        waiterHandle = {};
+        host1x.syncpoints.at(fence.id).DeregisterWaiter(waiter);
     }
 
     void Ctrl::SyncpointEvent::RegisterWaiter(soc::host1x::Host1x &host1x, const Fence &pFence) {
         fence = pFence;
         state = State::Waiting;
-        waiterHandle = host1x.syncpoints.at(fence.id).RegisterWaiter(fence.threshold, [this] { Signal(); });
+        host1x.syncpoints.at(fence.id).RegisterWaiter(waiter, fence.threshold);
     }
 
     bool Ctrl::SyncpointEvent::IsInUse() {
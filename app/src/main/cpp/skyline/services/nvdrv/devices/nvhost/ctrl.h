@@ -39,7 +39,7 @@ namespace skyline::service::nvdrv::device::nvhost {
          */
         class SyncpointEvent {
           private:
-            soc::host1x::Syncpoint::WaiterHandle waiterHandle{};
+            soc::host1x::Syncpoint::Waiter waiter; //!< The waiter which signals the event, this is reused for every wait on the event
 
             void Signal();
 
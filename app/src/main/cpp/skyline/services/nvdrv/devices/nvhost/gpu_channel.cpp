@@ -191,7 +191,7 @@ namespace skyline::service::nvdrv::device::nvhost {
             throw exception("Failed to allocate channel pushbuffer!");
 
         // Map onto the GPU
-        asCtx->gmmu.Map(pushBufferAddr, reinterpret_cast<u8 *>(pushBufferMemory.data()), pushBufferSize);
+        asCtx->Map(pushBufferAddr, reinterpret_cast<u8 *>(pushBufferMemory.data()), pushBufferSize);
 
         return PosixResult::Success;
     }
@@ -103,37 +103,35 @@ namespace skyline::service::nvdrv {
         }
     }
 
+    device::NvDevice &Driver::GetDevice(FileDescriptor fd, std::string_view caller) {
+        auto it{devices.find(fd)};
+        if (it == devices.end()) [[unlikely]]
+            throw exception("{} was called with invalid fd: {}", caller, fd);
+        return *it->second;
+    }
+
     NvResult Driver::Ioctl(FileDescriptor fd, IoctlDescriptor cmd, span<u8> buffer) {
-        try {
-            std::shared_lock lock(deviceMutex);
-            Logger::Debug("fd: {}, cmd: 0x{:X}, device: {}", fd, cmd.raw, devices.at(fd)->GetName());
-            TRACE_EVENT("service", "Ioctl", "fd", fd, "cmd", cmd.raw);
-            return ConvertResult(LogIoctlResult(devices.at(fd)->Ioctl(cmd, buffer), cmd.raw));
-        } catch (const std::out_of_range &) {
-            throw exception("Ioctl was called with invalid fd: {}", fd);
-        }
+        std::shared_lock lock(deviceMutex);
+        auto &device{GetDevice(fd, "Ioctl")};
+        Logger::Debug("fd: {}, cmd: 0x{:X}, device: {}", fd, cmd.raw, device.GetName());
+        TRACE_EVENT("service", "Ioctl", "fd", fd, "cmd", cmd.raw);
+        return ConvertResult(LogIoctlResult(device.Ioctl(cmd, buffer), cmd.raw));
     }
 
     NvResult Driver::Ioctl2(FileDescriptor fd, IoctlDescriptor cmd, span<u8> buffer, span<u8> inlineBuffer) {
-        try {
-            std::shared_lock lock(deviceMutex);
-            Logger::Debug("fd: {}, cmd: 0x{:X}, device: {}", fd, cmd.raw, devices.at(fd)->GetName());
-            TRACE_EVENT("service", "Ioctl", "fd", fd, "cmd", cmd.raw);
-            return ConvertResult(LogIoctlResult(devices.at(fd)->Ioctl2(cmd, buffer, inlineBuffer), cmd.raw));
-        } catch (const std::out_of_range &) {
-            throw exception("Ioctl2 was called with invalid fd: {}", fd);
-        }
+        std::shared_lock lock(deviceMutex);
+        auto &device{GetDevice(fd, "Ioctl2")};
+        Logger::Debug("fd: {}, cmd: 0x{:X}, device: {}", fd, cmd.raw, device.GetName());
+        TRACE_EVENT("service", "Ioctl", "fd", fd, "cmd", cmd.raw);
+        return ConvertResult(LogIoctlResult(device.Ioctl2(cmd, buffer, inlineBuffer), cmd.raw));
     }
 
     NvResult Driver::Ioctl3(FileDescriptor fd, IoctlDescriptor cmd, span<u8> buffer, span<u8> inlineBuffer) {
-        try {
-            std::shared_lock lock(deviceMutex);
-            Logger::Debug("fd: {}, cmd: 0x{:X}, device: {}", fd, cmd.raw, devices.at(fd)->GetName());
-            TRACE_EVENT("service", "Ioctl", "fd", fd, "cmd", cmd.raw);
-            return ConvertResult(LogIoctlResult(devices.at(fd)->Ioctl3(cmd, buffer, inlineBuffer), cmd.raw));
-        } catch (const std::out_of_range &) {
-            throw exception("Ioctl3 was called with invalid fd: {}", fd);
-        }
+        std::shared_lock lock(deviceMutex);
+        auto &device{GetDevice(fd, "Ioctl3")};
+        Logger::Debug("fd: {}, cmd: 0x{:X}, device: {}", fd, cmd.raw, device.GetName());
+        TRACE_EVENT("service", "Ioctl", "fd", fd, "cmd", cmd.raw);
+        return ConvertResult(LogIoctlResult(device.Ioctl3(cmd, buffer, inlineBuffer), cmd.raw));
     }
 
     void Driver::CloseDevice(FileDescriptor fd) {
@@ -25,6 +25,12 @@ namespace skyline::service::nvdrv {
 
         friend device::nvhost::AsGpu; // For channel address space binding
 
+        /**
+         * @return The device corresponding to the supplied fd, this is looked up once per call and must be done with deviceMutex locked
+         * @param caller The name of the calling function, this is used for the exception thrown on an invalid fd
+         */
+        device::NvDevice &GetDevice(FileDescriptor fd, std::string_view caller);
+
       public:
         Core core; //!< The core global state object of nvdrv that is accessed by devices
 
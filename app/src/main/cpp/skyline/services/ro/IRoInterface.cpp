@@ -26,43 +26,55 @@ namespace skyline::service::ro {
         auto data{span{reinterpret_cast<u8 *>(nroAddress), nroSize}};
         auto &header{data.as<loader::NroHeader>()};
 
-        std::array<u8, 0x20> hash{};
-        mbedtls_sha256_ret(data.data(), data.size(), hash.data(), 0);
-
-        if (!loadedNros.emplace(hash).second)
-            return result::AlreadyLoaded;
-
         // We don't handle NRRs here since they're purely used for signature verification which we will never do
         if (bssSize != header.bssSize)
             return result::InvalidNro;
 
-        loader::Executable executable{};
-
-        executable.text.offset = 0;
-        executable.text.contents.resize(header.text.size);
-        span(executable.text.contents).copy_from(data.subspan(header.text.offset, header.text.size));
-
-        executable.ro.offset = header.text.size;
-        executable.ro.contents.resize(header.ro.size);
-        span(executable.ro.contents).copy_from(data.subspan(header.ro.offset, header.ro.size));
-
-        executable.data.offset = header.text.size + header.ro.size;
-        executable.data.contents.resize(header.data.size);
-        span(executable.data.contents).copy_from(data.subspan(header.data.offset, header.data.size));
-
-        executable.bssSize = header.bssSize;
+        // Hashing the entire NRO is independent of copying its sections and analyzing them for patching, so it's done concurrently with those
+        // In the rare case of the NRO already being loaded this work is discarded
+        std::array<u8, 0x20> hash{};
+        std::thread hashThread{[&] {
+            mbedtls_sha256_ret(data.data(), data.size(), hash.data(), 0);
+        }};
 
-        if (header.dynsym.offset > header.ro.offset && header.dynsym.offset + header.dynsym.size < header.ro.offset + header.ro.size && header.dynstr.offset > header.ro.offset && header.dynstr.offset + header.dynstr.size < header.ro.offset + header.ro.size) {
-            executable.dynsym = {header.dynsym.offset, header.dynsym.size};
-            executable.dynstr = {header.dynstr.offset, header.dynstr.size};
+        loader::Executable executable{};
+        u64 size{};
+        try {
+            executable.text.offset = 0;
+            executable.text.contents.resize(header.text.size);
+            span(executable.text.contents).copy_from(data.subspan(header.text.offset, header.text.size));
+
+            executable.ro.offset = header.text.size;
+            executable.ro.contents.resize(header.ro.size);
+            span(executable.ro.contents).copy_from(data.subspan(header.ro.offset, header.ro.size));
+
+            executable.data.offset = header.text.size + header.ro.size;
+            executable.data.contents.resize(header.data.size);
+            span(executable.data.contents).copy_from(data.subspan(header.data.offset, header.data.size));
+
+            executable.bssSize = header.bssSize;
+            std::memcpy(executable.buildId.data(), header.buildId.data(), executable.buildId.size());
+
+            if (header.dynsym.offset > header.ro.offset && header.dynsym.offset + header.dynsym.size < header.ro.offset + header.ro.size && header.dynstr.offset > header.ro.offset && header.dynstr.offset + header.dynstr.size < header.ro.offset + header.ro.size) {
+                executable.dynsym = {header.dynsym.offset, header.dynsym.size};
+                executable.dynstr = {header.dynstr.offset, header.dynstr.size};
+            }
+
+            u64 textSize{executable.text.contents.size()};
+            u64 roSize{executable.ro.contents.size()};
+            u64 dataSize{executable.data.contents.size() + executable.bssSize};
+
+            // The patch data is passed to the loader so .text isn't analyzed a second time while loading
+            executable.patch = state.nce->GetPatchData(executable.text.contents, executable.buildId);
+            size = executable.patch->size + textSize + roSize + dataSize;
+        } catch (...) {
+            hashThread.join();
+            throw;
         }
 
-        u64 textSize{executable.text.contents.size()};
-        u64 roSize{executable.ro.contents.size()};
-        u64 dataSize{executable.data.contents.size() + executable.bssSize};
-
-        auto patch{state.nce->GetPatchData(executable.text.contents)};
-        auto size{patch.size + textSize + roSize + dataSize};
+        hashThread.join();
+        if (!loadedNros.emplace(hash).second)
+            return result::AlreadyLoaded;
 
         u8 *ptr{};
         do {
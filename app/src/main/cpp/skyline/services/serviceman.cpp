@@ -1,6 +1,7 @@
 // SPDX-License-Identifier: MPL-2.0
 // Copyright © 2020 Skyline Team and Contributors (https://github.com/skyline-emu/)
 
+#include <cmath>
 #include <kernel/types/KProcess.h>
 #include <common/trace.h>
 #include "sm/IUserInterface.h"
@@ -60,6 +61,7 @@
     case util::MakeMagic<ServiceName>(name): { \
             std::shared_ptr<BaseService> serviceObject{std::make_shared<class>(state, *this, ##__VA_ARGS__)}; \
             serviceMap[util::MakeMagic<ServiceName>(name)] = serviceObject; \
+            serviceNames[serviceObject.get()] = util::MakeMagic<ServiceName>(name); \
             return serviceObject; \
         }
 
@@ -76,6 +78,7 @@ namespace skyline::service {
     ServiceManager::ServiceManager(const DeviceState &state) : state(state), smUserInterface(std::make_shared<sm::IUserInterface>(state, *this)), globalServiceState(std::make_shared<GlobalServiceState>(state)) {}
 
     std::shared_ptr<BaseService> ServiceManager::CreateOrGetService(ServiceName name) {
+        std::scoped_lock serviceGuard{mutex};
         auto serviceIter{serviceMap.find(name)};
         if (serviceIter != serviceMap.end())
             return (*serviceIter).second;
@@ -143,14 +146,21 @@ namespace skyline::service {
         }
     }
 
-    std::shared_ptr<BaseService> ServiceManager::NewService(ServiceName name, type::KSession &session, ipc::IpcResponse &response) {
+    void ServiceManager::ReleaseService(const std::shared_ptr<BaseService> &service) {
         std::scoped_lock serviceGuard{mutex};
+        auto nameIter{serviceNames.find(service.get())};
+        if (nameIter != serviceNames.end()) {
+            serviceMap.erase(nameIter->second);
+            serviceNames.erase(nameIter);
+        }
+    }
+
+    std::shared_ptr<BaseService> ServiceManager::NewService(ServiceName name, type::KSession &session, ipc::IpcResponse &response) {
         auto serviceObject{CreateOrGetService(name)};
         KHandle handle{};
         if (session.isDomain) {
-            session.domains.push_back(serviceObject);
-            response.domainObjects.push_back(session.handleIndex);
-            handle = session.handleIndex++;
+            handle = session.AddDomainObject(serviceObject);
+            response.domainObjects.push_back(handle);
         } else {
             handle = state.process->NewHandle<type::KSession>(serviceObject).handle;
             response.moveHandles.push_back(handle);
@@ -160,13 +170,11 @@ namespace skyline::service {
     }
 
     void ServiceManager::RegisterService(std::shared_ptr<BaseService> serviceObject, type::KSession &session, ipc::IpcResponse &response) { // NOLINT(performance-unnecessary-value-param)
-        std::scoped_lock serviceGuard{mutex};
         KHandle handle{};
 
         if (session.isDomain) {
-            session.domains.push_back(serviceObject);
-            response.domainObjects.push_back(session.handleIndex);
-            handle = session.handleIndex++;
+            handle = session.AddDomainObject(serviceObject);
+            response.domainObjects.push_back(handle);
         } else {
             handle = state.process->NewHandle<type::KSession>(serviceObject).handle;
             response.moveHandles.push_back(handle);
@@ -176,18 +184,15 @@ namespace skyline::service {
     }
 
     void ServiceManager::CloseSession(KHandle handle) {
-        std::scoped_lock serviceGuard{mutex};
         auto session{state.process->GetHandle<type::KSession>(handle)};
+        std::scoped_lock sessionGuard{session->domainMutex};
         if (session->isOpen) {
             if (session->isDomain) {
                 for (const auto &domainService : session->domains)
-                    std::erase_if(serviceMap, [domainService](const auto &entry) {
-                        return entry.second == domainService;
-                    });
+                    if (domainService)
+                        ReleaseService(domainService);
             } else {
-                std::erase_if(serviceMap, [session](const auto &entry) {
-                    return entry.second == session->serviceObject;
-                });
+                ReleaseService(session->serviceObject);
             }
             session->isOpen = false;
         }
@@ -208,20 +213,22 @@ namespace skyline::service {
                 case ipc::CommandType::RequestWithContext:
                     if (session->isDomain) {
                         try {
-                            auto service{session->domains.at(request.domain->objectId)};
-                            if (service == nullptr)
-                                throw exception("Domain request used an expired handle");
                             switch (request.domain->command) {
-                                case ipc::DomainCommand::SendMessage:
+                                case ipc::DomainCommand::SendMessage: {
+                                    auto service{session->GetDomainObject(request.domain->objectId)};
+                                    if (service == nullptr)
+                                        throw exception("Domain request used an expired handle");
                                     response.errorCode = service->HandleRequest(*session, request, response);
                                     break;
+                                }
 
-                                case ipc::DomainCommand::CloseVHandle:
-                                    std::erase_if(serviceMap, [service](const auto &entry) {
-                                        return entry.second == service;
-                                    });
-                                    session->domains.at(request.domain->objectId).reset();
+                                case ipc::DomainCommand::CloseVHandle: {
+                                    auto service{session->CloseDomainObject(request.domain->objectId)};
+                                    if (service == nullptr)
+                                        throw exception("Domain request used an expired handle");
+                                    ReleaseService(service);
                                     break;
+                                }
                             }
                         } catch (std::out_of_range &) {
                             throw exception("Invalid object ID was used with domain request");
@@ -274,4 +281,61 @@ namespace skyline::service {
         }
         Logger::Verbose("====IPC End====");
     }
+
+    void ServiceManager::CommandStatistics::Record(u64 ticks, u64 requestBytes) {
+        count.fetch_add(1, std::memory_order_relaxed);
+        totalTicks.fetch_add(ticks, std::memory_order_relaxed);
+        bytes.fetch_add(requestBytes, std::memory_order_relaxed);
+        histogram[std::bit_width(ticks)].fetch_add(1, std::memory_order_relaxed);
+
+        u64 max{maxTicks.load(std::memory_order_relaxed)};
+        while (ticks > max && !maxTicks.compare_exchange_weak(max, ticks, std::memory_order_relaxed));
+    }
+
+    u64 ServiceManager::CommandStatistics::Percentile(double fraction) const {
+        u64 target{static_cast<u64>(std::ceil(static_cast<double>(count.load(std::memory_order_relaxed)) * fraction))}, accumulated{};
+        for (size_t bucket{}; bucket < histogram.size(); bucket++) {
+            accumulated += histogram[bucket].load(std::memory_order_relaxed);
+            if (accumulated >= target)
+                return bucket ? (1ULL << (bucket - 1)) * 2 - 1 : 0; // The largest value in the bucket, written to avoid overflowing the shift for the last bucket
+        }
+        return maxTicks.load(std::memory_order_relaxed);
+    }
+
+    void ServiceManager::RecordCommand(const char *name, u32 id, u64 ticks, u64 bytes) {
+        {
+            std::shared_lock lock{commandStatisticsMutex};
+            auto it{commandStatistics.find(name)};
+            if (it != commandStatistics.end()) {
+                it->second.Record(ticks, bytes);
+                return;
+            }
+        }
+
+        std::unique_lock lock{commandStatisticsMutex};
+        auto it{commandStatistics.try_emplace(name, id).first};
+        it->second.Record(ticks, bytes);
+    }
+
+    void ServiceManager::LogCommandStatistics() {
+        constexpr size_t LoggedCommandCount{16}; //!< The amount of commands with the highest total duration to log
+
+        std::shared_lock lock{commandStatisticsMutex};
+        std::vector<std::pair<const char *, const CommandStatistics *>> order;
+        order.reserve(commandStatistics.size());
+        for (const auto &[name, entry] : commandStatistics)
+            order.emplace_back(name, &entry);
+        std::sort(order.begin(), order.end(), [](const auto &a, const auto &b) { return a.second->totalTicks > b.second->totalTicks; });
+
+        auto toUs{[](u64 ticks) { return (ticks * 1'000'000) / util::ClockFrequency; }};
+        std::string statistics;
+        for (const auto &[name, entry] : span(order).first(std::min(order.size(), LoggedCommandCount))) {
+            u64 count{entry->count.load(std::memory_order_relaxed)};
+            u64 totalTicks{entry->totalTicks.load(std::memory_order_relaxed)};
+            statistics += fmt::format("\n* {} ({}): {} calls, {}us total, {}us p50, {}us p99, {}us max, {} bytes", name, entry->id, count, toUs(totalTicks), toUs(entry->Percentile(0.5)), toUs(entry->Percentile(0.99)), toUs(entry->maxTicks.load(std::memory_order_relaxed)), entry->bytes.load(std::memory_order_relaxed));
+        }
+
+        if (!statistics.empty())
+            Logger::Info("Service command statistics:{}", statistics);
+    }
 }
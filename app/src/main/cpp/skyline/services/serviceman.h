@@ -19,7 +19,37 @@ namespace skyline::service {
       private:
         const DeviceState &state;
         std::unordered_map<ServiceName, std::shared_ptr<BaseService>> serviceMap; //!< A mapping from a Service to the underlying object
-        std::mutex mutex; //!< Synchronizes concurrent access to services to prevent crashes
+        std::unordered_map<BaseService *, ServiceName> serviceNames; //!< The reverse of serviceMap, this allows releasing a named service from a closed session without scanning the map
+        std::recursive_mutex mutex; //!< Synchronizes creation of services and mutation of the maps, it's recursive as services can create other services in their constructor, this isn't held while handling requests
+
+        /**
+         * @brief Aggregate statistics of every request handled by a single service command
+         */
+        struct CommandStatistics {
+            u32 id; //!< The command ID, this is only used for logging as the descriptor name is what identifies the command
+            std::atomic<u64> count{};
+            std::atomic<u64> totalTicks{};
+            std::atomic<u64> maxTicks{};
+            std::atomic<u64> bytes{}; //!< The sum of the sizes of the data payload and all buffers supplied to the command
+            std::array<std::atomic<u32>, std::numeric_limits<u64>::digits + 1> histogram{}; //!< A histogram of request durations, bucket N counts requests which took [2^(N-1), 2^N) ticks
+
+            CommandStatistics(u32 id) : id{id} {}
+
+            void Record(u64 ticks, u64 requestBytes);
+
+            /**
+             * @return An upper bound on the duration in ticks of the supplied fraction of requests, this is only precise to a power of two
+             */
+            u64 Percentile(double fraction) const;
+        };
+
+        std::unordered_map<const char *, CommandStatistics> commandStatistics; //!< A mapping from the name of a command's descriptor to its statistics, names are static strings so pointer identity is sufficient
+        std::shared_mutex commandStatisticsMutex; //!< Synchronizes insertion into commandStatistics, the entries themselves are updated atomically under a shared lock
+
+        /**
+         * @brief Removes a service from the named service map if it's in there, a subsequent CreateOrGetService will create a new instance of it
+         */
+        void ReleaseService(const std::shared_ptr<BaseService> &service);
 
       public:
         std::shared_ptr<BaseService> smUserInterface; //!< Used by applications to open connections to services
@@ -69,5 +99,17 @@ namespace skyline::service {
          * @param handle The handle of the object
          */
         void SyncRequestHandler(KHandle handle);
+
+        /**
+         * @brief Records the duration of a handled request in the statistics of the command it invoked
+         * @param name The name of the service function descriptor of the command
+         * @param bytes The amount of bytes supplied to the command in its payload and buffers
+         */
+        void RecordCommand(const char *name, u32 id, u64 ticks, u64 bytes);
+
+        /**
+         * @brief Logs the count, latency percentiles and transferred bytes of the service commands with the highest total duration
+         */
+        void LogCommandStatistics();
     };
 }
@@ -16,10 +16,37 @@ namespace skyline::service::socket {
     }
 
     Result IClient::Select(type::KSession &session, ipc::IpcRequest &request, ipc::IpcResponse &response) {
+        // No sockets are ever backed by a host socket so none of them can become ready, this is reported as an immediate timeout rather than blocking the guest thread
+        for (auto &set : request.outputBuf)
+            std::memset(set.data(), 0, set.size());
+
+        response.Push<i32>(0);
+        response.Push<u32>(0);
         return {};
     }
 
     Result IClient::Poll(type::KSession &session, ipc::IpcRequest &request, ipc::IpcResponse &response) {
+        struct PollFd {
+            i32 fd;
+            i16 events;
+            i16 revents;
+        };
+
+        i32 nfds{request.Pop<i32>()};
+
+        // See Select
+        if (nfds > 0 && !request.inputBuf.empty() && !request.outputBuf.empty()) {
+            // Only the supplied amount of descriptors is copied, either buffer may be larger than that or not a multiple of the entry size
+            auto input{request.inputBuf.at(0)}, output{request.outputBuf.at(0)};
+            size_t count{std::min(static_cast<size_t>(nfds), std::min(input.size(), output.size()) / sizeof(PollFd))};
+            auto pollFds{output.subspan(0, count * sizeof(PollFd))};
+            pollFds.copy_from(input.subspan(0, count * sizeof(PollFd)));
+            for (auto &pollFd : pollFds.cast<PollFd>())
+                pollFd.revents = 0;
+        }
+
+        response.Push<i32>(0);
+        response.Push<u32>(0);
         return {};
     }
 
@@ -51,13 +51,15 @@ namespace skyline::service::timesrv::core {
     }
 
     TimeSpanType StandardSteadyClockCore::GetRawTimePoint() {
-        std::scoped_lock lock{mutex};
+        auto timePoint{TimeSpanType::FromNanoseconds(util::GetTimeNs()) + rtcOffset.load(std::memory_order_relaxed)};
 
-        auto timePoint{TimeSpanType::FromNanoseconds(util::GetTimeNs()) + rtcOffset};
-        if (timePoint > cachedValue)
-            cachedValue = timePoint;
+        // If another thread has already returned a later timepoint then that is returned instead so time never appears to go backwards
+        auto cached{cachedValue.load(std::memory_order_relaxed)};
+        while (timePoint > cached)
+            if (cachedValue.compare_exchange_weak(cached, timePoint, std::memory_order_relaxed))
+                return timePoint;
 
-        return timePoint;
+        return cached;
     }
 
     ResultValue<SteadyClockTimePoint> TickBasedSteadyClockCore::GetTimePoint() {
@@ -100,11 +100,10 @@ namespace skyline::service::timesrv::core {
      */
     class StandardSteadyClockCore : public SteadyClockCore {
       private:
-        std::mutex mutex; //!< Protects accesses to cachedValue
         TimeSpanType testOffset{};
         TimeSpanType internalOffset{};
-        TimeSpanType rtcOffset{}; //!< The offset between the RTC timepoint and the raw timepoints of this clock
-        TimeSpanType cachedValue{}; //!< Stores the cached time value, used to prevent time ever decreasing
+        std::atomic<TimeSpanType> rtcOffset{}; //!< The offset between the RTC timepoint and the raw timepoints of this clock
+        std::atomic<TimeSpanType> cachedValue{}; //!< Stores the latest time value returned by the clock, used to prevent time ever decreasing without requiring a lock
         UUID rtcId{}; //!< UUID of the RTC this is calibrated against
 
       public:
@@ -5,6 +5,14 @@
 #include "timezone_manager.h"
 
 namespace skyline::service::timesrv::core {
+    TimeZoneManager::RuleHandle TimeZoneManager::AllocateRule(span<u8> binary) {
+        auto ruleObj{tz_tzalloc(binary.data(), static_cast<long>(binary.size()))};
+        if (!ruleObj)
+            return nullptr;
+
+        return RuleHandle{ruleObj, tz_tzfree};
+    }
+
     Result TimeZoneManager::Setup(std::string_view pLocationName, const SteadyClockTimePoint &pUpdateTime, int pLocationCount, std::array<u8, 0x10> pBinaryVersion, span<u8> binary) {
         SetNewLocation(pLocationName, binary);
         SetUpdateTime(pUpdateTime);
@@ -27,10 +35,12 @@ namespace skyline::service::timesrv::core {
     Result TimeZoneManager::SetNewLocation(std::string_view pLocationName, span<u8> binary) {
         std::scoped_lock lock{mutex};
 
-        rule = tz_tzalloc(binary.data(), static_cast<long>(binary.size()));
-        if (!rule)
+        auto newRule{AllocateRule(binary)};
+        if (!newRule)
             return result::RuleConversionFailed;
 
+        rule = std::move(newRule); // The previous rule is freed here unless it's still referenced by the cache
+
         span(locationName).copy_from(pLocationName);
 
         return {};
@@ -88,6 +98,30 @@ namespace skyline::service::timesrv::core {
         return {};
     }
 
+    Result TimeZoneManager::LoadTimeZoneRule(std::string_view pLocationName, span<u8> ruleOut, const std::function<std::vector<u8>()> &readBinary) {
+        RuleHandle locationRule;
+        {
+            std::scoped_lock lock{ruleCacheMutex};
+            auto it{ruleCache.find(std::string{pLocationName})};
+            if (it != ruleCache.end())
+                locationRule = it->second;
+        }
+
+        if (!locationRule) {
+            // The cache lock isn't held while parsing, if another thread parses the same location concurrently then the first rule to be inserted is used
+            auto binary{readBinary()};
+            locationRule = AllocateRule(binary);
+            if (!locationRule)
+                return result::RuleConversionFailed;
+
+            std::scoped_lock lock{ruleCacheMutex};
+            locationRule = ruleCache.try_emplace(std::string{pLocationName}, std::move(locationRule)).first->second;
+        }
+
+        std::memcpy(ruleOut.data(), locationRule.get(), ruleOut.size_bytes());
+        return {};
+    }
+
     ResultValue<FullCalendarTime> TimeZoneManager::ToCalendarTime(tz_timezone_t pRule, PosixTime posixTime) {
         struct tm tmp{};
         auto posixCalendarTime{tz_localtime_rz(pRule, &posixTime, &tmp)};
@@ -13,14 +13,24 @@ namespace skyline::service::timesrv::core {
      */
     class TimeZoneManager {
       private:
+        using RuleHandle = std::shared_ptr<std::remove_pointer_t<tz_timezone_t>>; //!< An owning handle to a rule, this frees the rule when the last reference is dropped
+
         bool initialized{};
         std::mutex mutex;
-        tz_timezone_t rule{}; //!< Rule corresponding to the timezone that is currently in use
+        RuleHandle rule; //!< Rule corresponding to the timezone that is currently in use
         SteadyClockTimePoint updateTime{}; //!< Time when the rule was last updated
         int locationCount{}; //!< The number of possible timezone binary locations
         std::array<u8, 0x10> binaryVersion{}; //!< The version of the tzdata package
         LocationName locationName{}; //!< Name of the currently selected location
 
+        std::mutex ruleCacheMutex;
+        std::unordered_map<std::string, RuleHandle> ruleCache; //!< Rules that have already been parsed from the tzdata of a location, keyed by the location name
+
+        /**
+         * @return A handle to the rule parsed from the supplied binary or nullptr if it's invalid
+         */
+        static RuleHandle AllocateRule(span<u8> binary);
+
         void MarkInitialized() {
             initialized = true;
         }
@@ -59,6 +69,12 @@ namespace skyline::service::timesrv::core {
          */
         static Result ParseTimeZoneBinary(span<u8> binary, span<u8> ruleOut);
 
+        /**
+         * @brief Writes the rule of a location into ruleOut, the location's tzdata is only read and parsed the first time its rule is requested
+         * @param readBinary A function that reads the raw TZIF2 file of the location, this is only called if the rule isn't cached
+         */
+        Result LoadTimeZoneRule(std::string_view pLocationName, span<u8> ruleOut, const std::function<std::vector<u8>()> &readBinary);
+
         /**
          * @brief Converts a POSIX time to a calendar time using the given rule
          */
@@ -68,7 +84,7 @@ namespace skyline::service::timesrv::core {
          * @brief Converts a POSIX to a calendar time using the current location's rule
          */
         ResultValue<FullCalendarTime> ToCalendarTimeWithMyRule(PosixTime posixTime) {
-            return ToCalendarTime(rule, posixTime);
+            return ToCalendarTime(rule.get(), posixTime);
         }
 
         /**
@@ -80,7 +96,7 @@ namespace skyline::service::timesrv::core {
          * @brief Converts a calendar time to a POSIX time using the current location's rule
          */
         ResultValue<PosixTime> ToPosixTimeWithMyRule(CalendarTime calendarTime) {
-            return ToPosixTime(rule, calendarTime);
+            return ToPosixTime(rule.get(), calendarTime);
         }
     };
 }
\ No newline at end of file
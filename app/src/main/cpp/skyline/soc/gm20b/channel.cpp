@@ -13,7 +13,8 @@ namespace skyline::soc::gm20b {
           keplerCompute{state, *this},
           inline2Memory{state, *this},
           gpfifo{state, *this, numEntries},
-          globalChannelLock{state.gpu->channelLock} {
+          globalChannelLock{state.gpu->channelLock},
+          globalChannelLockWaiters{state.gpu->channelLockWaiters} {
         executor.AddFlushCallback([this] {
             channelSequenceNumber++;
         });
@@ -31,15 +31,27 @@ namespace skyline::soc::gm20b {
         engine::Inline2Memory inline2Memory;
         ChannelGpfifo gpfifo;
         std::mutex &globalChannelLock;
+        std::atomic<u32> &globalChannelLockWaiters;
         size_t channelSequenceNumber{};
 
         ChannelContext(const DeviceState &state, std::shared_ptr<AddressSpaceContext> asCtx, size_t numEntries);
 
         void Lock() {
-            globalChannelLock.lock();
+            if (!globalChannelLock.try_lock()) {
+                globalChannelLockWaiters++;
+                globalChannelLock.lock();
+                globalChannelLockWaiters--;
+            }
             executor.LockPreserve();
         }
 
+        /**
+         * @return If any other channel is waiting to acquire the global channel lock
+         */
+        bool IsLockContended() const {
+            return globalChannelLockWaiters.load(std::memory_order_relaxed) != 0;
+        }
+
         void Unlock() {
             executor.UnlockPreserve();
             globalChannelLock.unlock();
@@ -114,6 +114,23 @@ namespace skyline::soc::gm20b::engine {
             throw exception("DrawIndexedInstanced is not implemented for this engine");
         }
 
+        /**
+         * @brief Performs a series of draws with the arguments sourced from guest memory by the host GPU, avoiding the need to read them back on the CPU
+         * @param indirectBufferAddress The GPU VA of the first draw's arguments, these are laid out as VkDrawIndirectCommand or VkDrawIndexedIndirectCommand depending on `indexed`
+         * @return If the draws were performed, the caller is expected to fall back to DrawInstanced/DrawIndexedInstanced with CPU-read arguments otherwise
+         */
+        virtual bool DrawIndirect(u32 drawTopology, bool indexed, u64 indirectBufferAddress, u32 drawCount, u32 stride) {
+            return false;
+        }
+
+        /**
+         * @brief Draws the vertices written to a stream out buffer by the last transform feedback draw with the vertex count derived from its byte count by the host GPU, avoiding a readback of the byte count
+         * @return If the draw was performed, the caller is expected to fall back to DrawInstanced with a CPU-read byte count otherwise
+         */
+        virtual bool DrawTransformFeedback(u32 drawTopology, u32 bufferIndex, u32 stride, u32 instanceCount, u32 globalBaseInstanceIndex) {
+            return false;
+        }
+
         /**
          * @brief Handles a call to a method in the MME space
          * @param macroMethodOffset The target offset from EngineMethodsEnd
@@ -834,6 +834,47 @@ namespace skyline::soc::gm20b::engine::maxwell3d::type {
     };
     static_assert(sizeof(SemaphoreInfo) == sizeof(u32));
 
+    /**
+     * @brief Controls if draws are performed, this allows for predicating draws on the values of counters written by semaphores
+     */
+    struct RenderEnable {
+        enum class Mode : u32 {
+            False = 0, //!< Draws are never performed
+            True = 1, //!< Draws are always performed
+            Conditional = 2, //!< Draws are performed if the semaphore value at the address is non-zero
+            IfEqual = 3, //!< Draws are performed if the semaphore values at the address and the address + 0x10 are equal
+            IfNotEqual = 4, //!< Draws are performed if the semaphore values at the address and the address + 0x10 differ
+        };
+
+        Address address;
+        Mode mode;
+    };
+    static_assert(sizeof(RenderEnable) == sizeof(u32) * 3);
+
+    /**
+     * @brief The counters that can be reset by writing to the counter reset register
+     */
+    enum class CounterReset : u32 {
+        SamplesPassed = 0x01,
+        ZcullStats = 0x02,
+        TransformFeedbackPrimitivesNeededMinusSucceeded = 0x03,
+        AlphaBetaClocks = 0x04,
+        TransformFeedbackPrimitivesSucceeded = 0x10,
+        TransformFeedbackPrimitivesNeeded = 0x11,
+        VerticesGenerated = 0x12,
+        PrimitivesGenerated = 0x13,
+        VertexShaderInvocations = 0x15,
+        TessControlShaderInvocations = 0x16,
+        TessEvaluationShaderInvocations = 0x17,
+        TessEvaluationShaderPrimitives = 0x18,
+        GeometryShaderInvocations = 0x1A,
+        GeometryShaderPrimitives = 0x1B,
+        ClipperInputPrimitives = 0x1C,
+        ClipperOutputPrimitives = 0x1D,
+        FragmentShaderInvocations = 0x1E,
+        VtgPrimitivesOut = 0x1F,
+    };
+
     constexpr static size_t ShaderStageCount{5}; //!< Amount of pipeline stages on Maxwell 3D
 
     /**
@@ -52,11 +52,55 @@ namespace skyline::soc::gm20b::engine::maxwell3d {
             .constantBufferSelectorRegisters = {*registers.constantBufferSelector},
             .samplerPoolRegisters = {*registers.texSamplerPool, *registers.texHeaderPool},
             .samplerBinding = *registers.samplerBinding,
-            .texturePoolRegisters = {*registers.texHeaderPool}
+            .texturePoolRegisters = {*registers.texHeaderPool},
+            .renderEnable = *registers.renderEnable
         };
     }
     #undef REGTYPE
 
+    /**
+     * @brief A table of methods which have side effects beyond being written to the register file and marking their dirty handles, these must always be dispatched through HandleMethod
+     * @note This must be kept in sync with the cases in HandleMethod, methods that are only handled during an active batch are omitted as batched writes fall back to HandleMethod in that case
+     */
+    static constexpr auto MethodSideEffectTable{[]() {
+        using Registers = Maxwell3D::Registers;
+        std::array<bool, EngineMethodsEnd> table{};
+        auto set{[&](size_t offset, size_t count = 1) {
+            for (size_t i{}; i < count; i++)
+                table[offset + i] = true;
+        }};
+
+        set(ENGINE_STRUCT_OFFSET(mme, shadowRamControl));
+        set(ENGINE_STRUCT_OFFSET(mme, instructionRamLoad));
+        set(ENGINE_STRUCT_OFFSET(mme, startAddressRamLoad));
+        set(ENGINE_STRUCT_OFFSET(i2m, launchDma));
+        set(ENGINE_STRUCT_OFFSET(i2m, loadInlineData));
+        set(ENGINE_OFFSET(syncpointAction));
+        set(ENGINE_OFFSET(clearSurface));
+        set(ENGINE_OFFSET(begin));
+        set(ENGINE_STRUCT_OFFSET(drawVertexArray, count));
+        set(ENGINE_OFFSET(drawVertexArrayBeginEndInstanceFirst));
+        set(ENGINE_OFFSET(drawVertexArrayBeginEndInstanceSubsequent));
+        set(ENGINE_STRUCT_OFFSET(drawInlineIndex4X8, index0));
+        set(ENGINE_STRUCT_OFFSET(drawInlineIndex2X16, even));
+        set(ENGINE_STRUCT_OFFSET(drawIndexBuffer, count));
+        set(ENGINE_OFFSET(drawIndexBuffer32BeginEndInstanceFirst));
+        set(ENGINE_OFFSET(drawIndexBuffer16BeginEndInstanceFirst));
+        set(ENGINE_OFFSET(drawIndexBuffer8BeginEndInstanceFirst));
+        set(ENGINE_OFFSET(drawIndexBuffer32BeginEndInstanceSubsequent));
+        set(ENGINE_OFFSET(drawIndexBuffer16BeginEndInstanceSubsequent));
+        set(ENGINE_OFFSET(drawIndexBuffer8BeginEndInstanceSubsequent));
+        set(ENGINE_OFFSET(sampleCounterEnable));
+        set(ENGINE_OFFSET(counterReset));
+        set(ENGINE_STRUCT_OFFSET(semaphore, info));
+        set(ENGINE_ARRAY_OFFSET(firmwareCall, 4));
+        set(ENGINE_STRUCT_OFFSET(loadConstantBuffer, data), 16);
+        for (size_t i{}; i < type::ShaderStageCount; i++)
+            set(ENGINE_ARRAY_STRUCT_OFFSET(bindGroups, i, constantBuffer));
+
+        return table;
+    }()};
+
     type::DrawTopology Maxwell3D::ApplyTopologyOverride(type::DrawTopology beginMethodTopology) {
         return registers.primitiveTopologyControl->override == type::PrimitiveTopologyControl::Override::UseTopologyInBeginMethods ?
                beginMethodTopology : type::ConvertPrimitiveTopologyToDrawTopology(*registers.primitiveTopology);
@@ -69,7 +113,10 @@ namespace skyline::soc::gm20b::engine::maxwell3d {
           dirtyManager{registers},
           interconnect{*state.gpu, channelCtx, *state.nce, state.process->memory, dirtyManager, MakeEngineRegisters(registers)},
           channelCtx{channelCtx} {
-        channelCtx.executor.AddFlushCallback([this]() { FlushEngineState(); });
+        channelCtx.executor.AddFlushCallback([this]() {
+            FlushEngineState();
+            interconnect.EndQueries(); // Any deferred draws must be flushed before queries are ended so they're covered by them
+        });
         InitializeRegisters();
     }
 
@@ -114,7 +161,6 @@ namespace skyline::soc::gm20b::engine::maxwell3d {
                     default:
                         // When a method other than constant buffer update is called submit our submit the previously built-up update as a batch
                         registers.raw[method] = origRegisterValue;
-                        interconnect.DisableQuickConstantBufferBind();
                         interconnect.LoadConstantBuffer(batchLoadConstantBuffer.buffer, batchLoadConstantBuffer.startOffset);
                         batchEnableState.constantBufferActive = false;
                         batchLoadConstantBuffer.Reset();
@@ -332,6 +378,27 @@ namespace skyline::soc::gm20b::engine::maxwell3d {
                 batchEnableState.drawActive = true;
             })
 
+            ENGINE_CASE(sampleCounterEnable, {
+                interconnect.SetCounterEnabled(gpu::interconnect::maxwell3d::Queries::Counter::SamplesPassed, sampleCounterEnable != 0);
+            })
+
+            ENGINE_CASE(counterReset, {
+                switch (counterReset) {
+                    case type::CounterReset::SamplesPassed:
+                        interconnect.ResetCounter(gpu::interconnect::maxwell3d::Queries::Counter::SamplesPassed);
+                        break;
+
+                    case type::CounterReset::PrimitivesGenerated:
+                        // There's no separate enable for this counter so it's enabled once it's first reset
+                        interconnect.ResetCounter(gpu::interconnect::maxwell3d::Queries::Counter::PrimitivesGenerated);
+                        interconnect.SetCounterEnabled(gpu::interconnect::maxwell3d::Queries::Counter::PrimitivesGenerated, true);
+                        break;
+
+                    default:
+                        break;
+                }
+            })
+
             ENGINE_STRUCT_CASE(semaphore, info, {
                 if (info.reductionEnable)
                     Logger::Warn("Semaphore reduction is unimplemented!");
@@ -348,6 +415,14 @@ namespace skyline::soc::gm20b::engine::maxwell3d {
                                 WriteSemaphoreResult(registers.semaphore->payload);
                                 break;
 
+                            case type::SemaphoreInfo::CounterType::SamplesPassed:
+                                ReportCounter(gpu::interconnect::maxwell3d::Queries::Counter::SamplesPassed);
+                                break;
+
+                            case type::SemaphoreInfo::CounterType::PrimitivesGenerated:
+                                ReportCounter(gpu::interconnect::maxwell3d::Queries::Counter::PrimitivesGenerated);
+                                break;
+
                             default:
                                 //Logger::Warn("Unsupported semaphore counter type: 0x{:X}", static_cast<u8>(info.counterType));
                                 break;
@@ -411,6 +486,14 @@ namespace skyline::soc::gm20b::engine::maxwell3d {
         }
     }
 
+    void Maxwell3D::ReportCounter(gpu::interconnect::maxwell3d::Queries::Counter counter) {
+        // Unsupported counters are left unwritten as there's no meaningful value that could be written for them
+        if (!interconnect.IsCounterSupported(counter))
+            return;
+
+        interconnect.ReportCounter(counter, registers.semaphore->address, registers.semaphore->info.structureSize == type::SemaphoreInfo::StructureSize::FourWords, GetGpuTimeTicks());
+    }
+
     void Maxwell3D::FlushEngineState() {
         FlushDeferredDraw();
 
@@ -438,10 +521,52 @@ namespace skyline::soc::gm20b::engine::maxwell3d {
                 break;
         }
 
+        // Repeated writes to a register without side effects are equivalent to a single write of the final value
+        if (!arguments.empty() && !batchEnableState.raw && shadowRegisters.mme->shadowRamControl == type::MmeShadowRamControl::MethodPassthrough && !MethodSideEffectTable[method]) {
+            HandleMethod(method, arguments.back());
+            return;
+        }
+
         for (u32 argument : arguments)
             HandleMethod(method, argument);
     }
 
+    void Maxwell3D::WriteRegisterRun(u32 method, span<u32> arguments) {
+        for (size_t i{}; i < arguments.size();) {
+            if (registers.raw[method + i] == arguments[i]) {
+                i++;
+                continue;
+            }
+
+            // Find the extent of the run of modified registers so they can be copied and marked dirty together
+            size_t end{i + 1};
+            while (end < arguments.size() && registers.raw[method + end] != arguments[end])
+                end++;
+
+            std::memcpy(&registers.raw[method + i], &arguments[i], (end - i) * sizeof(u32));
+            dirtyManager.MarkDirty(method + i, end - i);
+            i = end;
+        }
+    }
+
+    void Maxwell3D::CallMethodBatchInc(u32 method, span<u32> arguments) {
+        for (u32 i{}; i < arguments.size();) {
+            // Any active batches or shadow RAM usage require per-method handling
+            if (batchEnableState.raw || shadowRegisters.mme->shadowRamControl != type::MmeShadowRamControl::MethodPassthrough || MethodSideEffectTable[method + i]) {
+                HandleMethod(method + i, arguments[i]);
+                i++;
+                continue;
+            }
+
+            u32 end{i + 1};
+            while (end < arguments.size() && !MethodSideEffectTable[method + end])
+                end++;
+
+            WriteRegisterRun(method + i, arguments.subspan(i, end - i));
+            i = end;
+        }
+    }
+
     void Maxwell3D::CallMethodFromMacro(u32 method, u32 argument) {
         HandleMethod(method, argument);
     }
@@ -474,4 +599,17 @@ namespace skyline::soc::gm20b::engine::maxwell3d {
 
         interconnect.Draw(topology, *registers.streamOutputEnable, true, indexBufferCount, indexBufferFirst, instanceCount, globalBaseVertexIndex, globalBaseInstanceIndex);
     }
+
+    bool Maxwell3D::DrawIndirect(u32 drawTopology, bool indexed, u64 indirectBufferAddress, u32 drawCount, u32 stride) {
+        u32 indexBufferCapacity{};
+        if (indexed && registers.indexBuffer->limit >= registers.indexBuffer->address)
+            // The index size enum values are the log2 of the index size in bytes
+            indexBufferCapacity = static_cast<u32>((registers.indexBuffer->limit - registers.indexBuffer->address + 1) >> static_cast<u32>(registers.indexBuffer->indexSize));
+
+        return interconnect.DrawIndirect(static_cast<type::DrawTopology>(drawTopology), *registers.streamOutputEnable, indexed, indirectBufferAddress, drawCount, stride, indexBufferCapacity);
+    }
+
+    bool Maxwell3D::DrawTransformFeedback(u32 drawTopology, u32 bufferIndex, u32 stride, u32 instanceCount, u32 globalBaseInstanceIndex) {
+        return interconnect.DrawTransformFeedback(static_cast<type::DrawTopology>(drawTopology), *registers.streamOutputEnable, bufferIndex, stride, instanceCount, globalBaseInstanceIndex);
+    }
 }
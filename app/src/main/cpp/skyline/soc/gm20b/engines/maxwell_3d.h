@@ -78,12 +78,22 @@ namespace skyline::soc::gm20b::engine::maxwell3d {
          */
         void HandleMethod(u32 method, u32 argument);
 
+        /**
+         * @brief Writes a run of arguments to consecutive registers without side effects, only registers that were modified are marked dirty
+         */
+        void WriteRegisterRun(u32 method, span<u32> arguments);
+
         /**
          * @brief Writes back a semaphore result to the guest with an auto-generated timestamp (if required)
          * @note If the semaphore is OneWord then the result will be downcasted to a 32-bit unsigned integer
          */
         void WriteSemaphoreResult(u64 result);
 
+        /**
+         * @brief Writes back the value of a host emulated counter to the semaphore address
+         */
+        void ReportCounter(gpu::interconnect::maxwell3d::Queries::Counter counter);
+
       public:
         /**
          * @url https://github.com/devkitPro/deko3d/blob/master/source/maxwell/engine_3d.def
@@ -261,11 +271,14 @@ namespace skyline::soc::gm20b::engine::maxwell3d {
             Register<0x547, u32> zCullStatCountersEnable;
             Register<0x548, u32> pointSpriteEnable;
             Register<0x54A, u32> shaderExceptions;
+            Register<0x54C, type::CounterReset> counterReset;
             Register<0x54D, u32> multisampleEnable;
             Register<0x54E, type::ZtSelect> ztSelect;
 
             Register<0x54F, type::MultisampleControl> multisampleControl;
 
+            Register<0x554, type::RenderEnable> renderEnable;
+
             Register<0x557, TexSamplerPool> texSamplerPool;
 
             Register<0x55B, float> slopeScaleDepthBias;
@@ -442,6 +455,11 @@ namespace skyline::soc::gm20b::engine::maxwell3d {
 
         void CallMethodBatchNonInc(u32 method, span<u32> arguments);
 
+        /**
+         * @brief Calls a sequence of consecutive methods, runs of registers without side effects are written directly to the register file
+         */
+        void CallMethodBatchInc(u32 method, span<u32> arguments);
+
         void CallMethodFromMacro(u32 method, u32 argument) override;
 
         u32 ReadMethodFromMacro(u32 method) override;
@@ -449,5 +467,9 @@ namespace skyline::soc::gm20b::engine::maxwell3d {
         void DrawInstanced(bool setRegs, u32 drawTopology, u32 vertexArrayCount, u32 instanceCount, u32 vertexArrayStart, u32 globalBaseInstanceIndex) override;
 
         void DrawIndexedInstanced(bool setRegs, u32 drawTopology, u32 indexBufferCount, u32 instanceCount, u32 globalBaseVertexIndex, u32 indexBufferFirst, u32 globalBaseInstanceIndex) override;
+
+        bool DrawIndirect(u32 drawTopology, bool indexed, u64 indirectBufferAddress, u32 drawCount, u32 stride) override;
+
+        bool DrawTransformFeedback(u32 drawTopology, u32 bufferIndex, u32 stride, u32 instanceCount, u32 globalBaseInstanceIndex) override;
     };
 }
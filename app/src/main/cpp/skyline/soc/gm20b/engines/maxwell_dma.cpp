@@ -39,7 +39,6 @@ namespace skyline::soc::gm20b::engine {
         }
 
         if (registers.launchDma->multiLineEnable) {
-            channelCtx.executor.Submit();
             if (registers.launchDma->srcMemoryLayout == Registers::LaunchDma::MemoryLayout::Pitch &&
                 registers.launchDma->dstMemoryLayout == Registers::LaunchDma::MemoryLayout::BlockLinear)
                 CopyPitchToBlockLinear();
@@ -131,6 +130,11 @@ namespace skyline::soc::gm20b::engine {
 
         Logger::Debug("{}x{}@0x{:X} -> {}x{}@0x{:X}", srcDimensions.width, srcDimensions.height, u64{*registers.offsetIn}, dstDimensions.width, dstDimensions.height, dstLayerAddress);
 
+        // Copy on the GPU if the destination is resident on the host as a texture, this avoids synchronizing the texture to and from the guest
+        if (!registers.dstSurface->layer && interconnect.CopyPitchToBlockLinear(u64{*registers.offsetIn}, dstLayerAddress, dstDimensions, *registers.lineCount, bytesPerPixel, dstBlockHeight, dstBlockDepth, dstLayerStride))
+            return;
+
+        channelCtx.executor.Submit();
         gpu::texture::CopyLinearToBlockLinear(
             dstDimensions,
             1, 1, bytesPerPixel,
@@ -186,6 +190,11 @@ namespace skyline::soc::gm20b::engine {
 
         Logger::Debug("{}x{}@0x{:X} -> {}x{}@0x{:X}", srcDimensions.width, srcDimensions.height, u64{*registers.offsetIn}, dstDimensions.width, dstDimensions.height, u64{*registers.offsetOut});
 
+        // Copy on the GPU if the source is resident on the host as a texture, this avoids a readback of the texture to the guest
+        if (!registers.srcSurface->layer && interconnect.CopyBlockLinearToPitch(u64{*registers.offsetIn}, u64{*registers.offsetOut}, srcDimensions, *registers.lineCount, bytesPerPixel, srcBlockHeight, srcBlockDepth, srcStride))
+            return;
+
+        channelCtx.executor.Submit();
         gpu::texture::CopyBlockLinearToLinear(
             srcDimensions,
             1, 1, bytesPerPixel,
@@ -5,6 +5,7 @@
 
 #include <bit>
 #include <common/address_space.h>
+#include "gpfifo_capture.h"
 
 namespace skyline::soc::gm20b {
     static constexpr u8 GmmuAddressSpaceBits{40}; //!< The size of the GMMU AS in bits
@@ -23,6 +24,32 @@ namespace skyline::soc::gm20b {
 
     struct AddressSpaceContext {
         GMMU gmmu;
+        std::unique_ptr<GpfifoCapture> capture; //!< Records all mappings and submissions in the AS when GPFIFO capture is enabled
+
+        /**
+         * @brief Maps a region into the GMMU and records it into the capture
+         */
+        void Map(u64 virt, u8 *phys, u64 size, MemoryManagerBlockInfo extraInfo = {}) {
+            gmmu.Map(virt, phys, size, extraInfo);
+            if (capture)
+                capture->RecordMap(virt, size, extraInfo.sparseMapped);
+        }
+
+        void Unmap(u64 virt, u64 size) {
+            gmmu.Unmap(virt, size);
+            if (capture)
+                capture->RecordUnmap(virt, size);
+        }
+
+        /**
+         * @brief Maps a batch of regions into the GMMU as a single transaction and records them into the capture
+         */
+        void MapBatch(span<const GMMU::BatchMapping> mappings) {
+            gmmu.MapBatch(mappings);
+            if (capture)
+                for (const auto &mapping : mappings)
+                    capture->RecordMap(mapping.virt, mapping.size, mapping.extraInfo.sparseMapped);
+        }
     };
 
     /**
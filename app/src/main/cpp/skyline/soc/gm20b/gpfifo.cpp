@@ -2,6 +2,7 @@
 // Copyright © 2020 Skyline Team and Contributors (https://github.com/skyline-emu/)
 
 #include <common/signal.h>
+#include <common/performance_statistics.h>
 #include <loader/loader.h>
 #include <kernel/types/KProcess.h>
 #include <soc.h>
@@ -84,7 +85,11 @@ namespace skyline::soc::gm20b {
         gpfifoEngine(state.soc->host1x.syncpoints, channelCtx),
         channelCtx(channelCtx),
         gpEntries(numEntries),
-        thread(std::thread(&ChannelGpfifo::Run, this)) {}
+        thread(std::thread(&ChannelGpfifo::Run, this)),
+        decoderThread(std::thread(&ChannelGpfifo::RunDecoder, this)) {
+        if (auto &capture{channelCtx.asCtx->capture})
+            captureChannel = capture->RegisterChannel();
+    }
 
     void ChannelGpfifo::SendFull(u32 method, u32 argument, SubchannelId subChannel, bool lastCall) {
         if (method < engine::GPFIFO::RegisterCount) {
@@ -153,218 +158,264 @@ namespace skyline::soc::gm20b {
         }
     }
 
-    void ChannelGpfifo::Process(GpEntry gpEntry) {
-        // Submit if required by the GpEntry, this is needed as some games dynamically generate pushbuffer contents
-        if (gpEntry.sync == GpEntry::Sync::Wait)
-            channelCtx.executor.Submit();
-
-        if (!gpEntry.size) {
-            // This is a GPFIFO control entry, all control entries have a zero length and contain no pushbuffers
-            switch (gpEntry.opcode) {
-                case GpEntry::Opcode::Nop:
-                    return;
-                default:
-                    Logger::Warn("Unsupported GpEntry control opcode used: {}", static_cast<u8>(gpEntry.opcode));
-                    return;
-            }
+    void ChannelGpfifo::SendPureBatchInc(u32 method, span<u32> arguments, SubchannelId subChannel) {
+        if (subChannel == SubchannelId::ThreeD) [[likely]] {
+            channelCtx.maxwell3D.CallMethodBatchInc(method, arguments);
+            return;
         }
 
-        auto pushBufferMappedRanges{channelCtx.asCtx->gmmu.TranslateRange(gpEntry.Address(), gpEntry.size * sizeof(u32))};
-        auto pushBuffer{[&]() -> span<u32> {
-            if (pushBufferMappedRanges.size() == 1) {
-                return pushBufferMappedRanges.front().cast<u32>();
+        for (u32 i{}; i < arguments.size(); i++)
+            SendPure(method + i, arguments[i], subChannel);
+    }
+
+    void ChannelGpfifo::Decode(DecodedPushBuffer &pushBuffer) {
+        pushBuffer.methods.clear();
+        pushBuffer.data = {};
+        pushBuffer.exception = {};
+
+        auto gpEntry{pushBuffer.gpEntry};
+        if (!gpEntry.size)
+            return; // GPFIFO control entries contain no pushbuffers and are handled during execution
+
+        try {
+            // Adjacent blocks which are contiguous in host memory are coalesced during translation, so most pushbuffers are a single range that can be parsed in-place
+            auto pushBufferMappedRanges{channelCtx.asCtx->gmmu.TranslateRange(gpEntry.Address(), gpEntry.size * sizeof(u32))};
+            for (const auto &range : pushBufferMappedRanges)
+                if (!range.valid())
+                    throw exception("Pushbuffer at 0x{:X} with size 0x{:X} is not fully mapped", gpEntry.Address(), gpEntry.size * sizeof(u32));
+
+            if (pushBufferMappedRanges.size() == 1) [[likely]] {
+                pushBuffer.data = pushBufferMappedRanges.front().cast<u32>();
             } else {
-                // Create an intermediate copy of pushbuffer data if it's split across multiple mappings
-                pushBufferData.resize(gpEntry.size);
-                channelCtx.asCtx->gmmu.Read<u32>(pushBufferData, gpEntry.Address());
-                return span(pushBufferData);
+                // Create an intermediate copy of pushbuffer data if it's split across multiple mappings, this is done directly from the translated ranges to avoid walking the GMMU blocks again
+                pushBuffer.copy.resize(gpEntry.size);
+                auto destination{span(pushBuffer.copy).cast<u8>()};
+                for (const auto &range : pushBufferMappedRanges) {
+                    destination.copy_from(range);
+                    destination = destination.subspan(range.size());
+                }
+                pushBuffer.data = span(pushBuffer.copy);
             }
-        }()};
 
-        // There will be at least one entry here
-        auto entry{pushBuffer.begin()};
+            auto &data{pushBuffer.data};
+            auto &methods{pushBuffer.methods};
+            u32 index{};
 
-        // Executes the current split method, returning once execution is finished or the current GpEntry has reached its end
-        auto resumeSplitMethod{[&](){
-            switch (resumeState.state) {
-                case MethodResumeState::State::Inc:
-                    while (entry != pushBuffer.end() && resumeState.remaining)
-                        SendFull(resumeState.address++, *(entry++), resumeState.subChannel, --resumeState.remaining == 0);
+            /**
+             * @brief Emits a run of calls starting at the current word and advances past their arguments
+             * @return The amount of calls emitted, this may be less than the requested amount if the GpEntry ends prior to all arguments
+             */
+            auto emitMethod{[&](u32 address, u32 count, SubchannelId subChannel, DecodedMethod::Type type) -> u32 {
+                u32 available{std::min(count, static_cast<u32>(data.size()) - index)};
+                if (!available)
+                    return 0;
+
+                u32 end{address + (type == DecodedMethod::Type::Inc ? available : (type == DecodedMethod::Type::OneInc ? 1U : 0U))};
+                methods.push_back(DecodedMethod{
+                    .address = address,
+                    .argumentOffset = index,
+                    .argumentCount = available,
+                    .subChannel = subChannel,
+                    .type = type,
+                    .pure = end < engine::EngineMethodsEnd && address >= engine::GPFIFO::RegisterCount,
+                    .methodEnd = available == count,
+                });
+
+                index += available;
+                return available;
+            }};
 
-                    break;
-                case MethodResumeState::State::OneInc:
-                    SendFull(resumeState.address++, *(entry++), resumeState.subChannel, --resumeState.remaining == 0);
+            // Stores the state for a method split across multiple GpEntries after `consumed` of its calls were emitted
+            auto storeResumeState{[&](u32 remaining, u32 address, SubchannelId subChannel, MethodResumeState::State state, u32 consumed) {
+                if (state == MethodResumeState::State::Inc) {
+                    address += consumed;
+                } else if (state == MethodResumeState::State::OneInc && consumed) {
+                    // After the first increment OneInc methods work the same as a NonInc method
+                    address++;
+                    state = MethodResumeState::State::NonInc;
+                }
 
-                    // After the first increment OneInc methods work the same as a NonInc method, this is needed so they can resume correctly if they are broken up by multiple GpEntries
-                    resumeState.state = MethodResumeState::State::NonInc;
-                    [[fallthrough]];
-                case MethodResumeState::State::NonInc:
-                    while (entry != pushBuffer.end() && resumeState.remaining)
-                        SendFull(resumeState.address, *(entry++), resumeState.subChannel, --resumeState.remaining == 0);
+                resumeState = {
+                    .remaining = remaining - consumed,
+                    .address = address,
+                    .subChannel = subChannel,
+                    .state = state,
+                };
+            }};
 
-                    break;
+            auto toMethodType{[](MethodResumeState::State state) {
+                switch (state) {
+                    case MethodResumeState::State::NonInc:
+                        return DecodedMethod::Type::NonInc;
+                    case MethodResumeState::State::Inc:
+                        return DecodedMethod::Type::Inc;
+                    default:
+                        return DecodedMethod::Type::OneInc;
+                }
+            }};
+
+            // We've a method from a previous GpEntry that needs resuming
+            if (resumeState.remaining) {
+                auto resumed{resumeState};
+                u32 consumed{emitMethod(resumed.address, resumed.remaining, resumed.subChannel, toMethodType(resumed.state))};
+                storeResumeState(resumed.remaining, resumed.address, resumed.subChannel, resumed.state, consumed);
             }
-        }};
 
-        // We've a method from a previous GpEntry that needs resuming
-        if (resumeState.remaining)
-            resumeSplitMethod();
+            while (index < data.size()) {
+                // Entries containing all zeroes is a NOP, skip over them
+                if (data[index] == 0) {
+                    index++;
+                    continue;
+                }
 
-        // Process more methods if the entries are still not all used up after handling resuming
-        for (; entry != pushBuffer.end(); entry++) {
-            if (entry >= pushBuffer.end()) [[unlikely]]
-                throw exception("GPFIFO buffer overflow!"); // This should never happen
+                PushBufferMethodHeader methodHeader{.raw = data[index++]};
 
-            // Entries containing all zeroes is a NOP, skip over them
-            for (; *entry == 0; entry++)
-                if (entry == std::prev(pushBuffer.end()))
-                    return;
+                auto decodeMethod{[&](MethodResumeState::State state) -> bool {
+                    u32 consumed{emitMethod(methodHeader.methodAddress, methodHeader.methodCount, methodHeader.methodSubChannel, toMethodType(state))};
+                    if (consumed == methodHeader.methodCount)
+                        return false;
 
-            PushBufferMethodHeader methodHeader{.raw = *entry};
+                    // Handles storing state for methods that are split across multiple GpEntries
+                    storeResumeState(methodHeader.methodCount, methodHeader.methodAddress, methodHeader.methodSubChannel, state, consumed);
+                    return true;
+                }};
 
-            // Needed in order to check for methods split across multiple GpEntries
-            ssize_t remainingEntries{std::distance(entry, pushBuffer.end()) - 1};
+                bool hitEnd{[&]() {
+                    switch (methodHeader.secOp) {
+                        case PushBufferMethodHeader::SecOp::IncMethod:
+                            return decodeMethod(MethodResumeState::State::Inc);
+                        case PushBufferMethodHeader::SecOp::OneInc:
+                            return decodeMethod(MethodResumeState::State::OneInc);
+                        case PushBufferMethodHeader::SecOp::NonIncMethod:
+                            return decodeMethod(MethodResumeState::State::NonInc);
+                        case PushBufferMethodHeader::SecOp::ImmdDataMethod:
+                            methods.push_back(DecodedMethod{
+                                .address = methodHeader.methodAddress,
+                                .immediate = methodHeader.immdData,
+                                .argumentCount = 1,
+                                .subChannel = methodHeader.methodSubChannel,
+                                .type = DecodedMethod::Type::Immediate,
+                                .pure = methodHeader.Pure(),
+                                .methodEnd = true,
+                            });
+                            return false;
+                        case PushBufferMethodHeader::SecOp::EndPbSegment:
+                            return true;
+                        case PushBufferMethodHeader::SecOp::Grp0UseTert:
+                            if (methodHeader.tertOp == PushBufferMethodHeader::TertOp::Grp0SetSubDevMask)
+                                return false;
 
-            // Handles storing state and initial execution for methods that are split across multiple GpEntries
-            auto startSplitMethod{[&](auto methodState) {
-                resumeState = {
-                    .remaining = methodHeader.methodCount,
-                    .address = methodHeader.methodAddress,
-                    .subChannel = methodHeader.methodSubChannel,
-                    .state = methodState
-                };
+                            throw exception("Unsupported pushbuffer method TertOp: {}", static_cast<u8>(methodHeader.tertOp));
+                        default:
+                            throw exception("Unsupported pushbuffer method SecOp: {}", static_cast<u8>(methodHeader.secOp));
+                    }
+                }()};
 
-                // Skip over method header as `resumeSplitMethod` doesn't expect it to be there
-                entry++;
+                if (hitEnd)
+                    break;
+            }
+        } catch (const signal::SignalException &e) {
+            if (e.signal == SIGINT)
+                throw; // SIGINT is used to stop the decoder thread and must not be deferred
 
-                resumeSplitMethod();
-            }};
+            pushBuffer.exception = std::current_exception();
+        } catch (...) {
+            pushBuffer.exception = std::current_exception();
+        }
+    }
 
-            /**
-             * @brief Handles execution of a specific method type as specified by the State template parameter
-             */
-            auto dispatchCalls{[&]<MethodResumeState::State State> () {
-                /**
-                 * @brief Gets the offset to apply to the method address for a given dispatch loop index
-                 */
-                auto methodOffset{[] (u32 i) -> u32 {
-                    if constexpr(State == MethodResumeState::State::Inc)
-                        return i;
-                    else if constexpr (State == MethodResumeState::State::OneInc)
-                        return i ? 1 : 0;
-                    else
-                        return 0;
-                }};
+    void ChannelGpfifo::Execute(DecodedPushBuffer &pushBuffer) {
+        auto gpEntry{pushBuffer.gpEntry};
 
-                constexpr u32 BatchCutoff{4}; //!< Cutoff needed to send method calls in a batch which is espcially important for UBO updates. This helps to avoid the extra overhead batching for small packets.
-                // TODO: Only batch for specific target methods like UBO updates, since normal dispatch is generally cheaper
+        // Submit if required by the GpEntry, this is needed as some games dynamically generate pushbuffer contents
+        if (gpEntry.sync == GpEntry::Sync::Wait)
+            channelCtx.executor.Submit();
+        else
+            channelCtx.executor.SubmitIfIdle(); // Avoid leaving the GPU idle while the remaining pushbuffers are processed
 
-                if (remainingEntries >= methodHeader.methodCount) { [[likely]]
-                    if (methodHeader.Pure()) [[likely]] {
-                        if constexpr (State == MethodResumeState::State::NonInc) {
-                            // For pure noninc methods we can send all method calls as a span in one go
-                            if (methodHeader.methodCount > BatchCutoff) [[unlikely]] {
-                                SendPureBatchNonInc(methodHeader.methodAddress, span(&(*++entry), methodHeader.methodCount), methodHeader.methodSubChannel);
+        if (!gpEntry.size) {
+            // This is a GPFIFO control entry, all control entries have a zero length and contain no pushbuffers
+            switch (gpEntry.opcode) {
+                case GpEntry::Opcode::Nop:
+                    return;
+                default:
+                    Logger::Warn("Unsupported GpEntry control opcode used: {}", static_cast<u8>(gpEntry.opcode));
+                    return;
+            }
+        }
 
-                                entry += methodHeader.methodCount - 1;
-                                return false;
-                            }
-                        } else if constexpr (State == MethodResumeState::State::OneInc) {
-                            // For pure oneinc methods we can send the initial method then send the rest as a span in one go
-                            if (methodHeader.methodCount > (BatchCutoff + 1)) [[unlikely]] {
-                                SendPure(methodHeader.methodAddress, *++entry, methodHeader.methodSubChannel);
-                                SendPureBatchNonInc(methodHeader.methodAddress + 1, span(&(*++entry) ,methodHeader.methodCount - 1), methodHeader.methodSubChannel);
-
-                                entry += methodHeader.methodCount - 2;
-                                return false;
-                            }
-                        }
-
-                        #pragma unroll(2)
-                        for (u32 i{}; i < methodHeader.methodCount; i++)
-                            SendPure(methodHeader.methodAddress + methodOffset(i), *++entry, methodHeader.methodSubChannel);
-                    } else {
-                        // Slow path for methods that touch GPFIFO or macros
-                        for (u32 i{}; i < methodHeader.methodCount; i++)
-                            SendFull(methodHeader.methodAddress + methodOffset(i), *++entry, methodHeader.methodSubChannel, i == methodHeader.methodCount - 1);
-                    }
-                } else {
-                    startSplitMethod(State);
-                    return true;
-                }
+        if (pushBuffer.deferred)
+            Decode(pushBuffer);
 
-                return false;
-            }};
+        constexpr u32 BatchCutoff{4}; //!< Cutoff needed to send method calls in a batch which is espcially important for UBO updates. This helps to avoid the extra overhead batching for small packets.
+        // TODO: Only batch for specific target methods like UBO updates, since normal dispatch is generally cheaper
+
+        for (const auto &method : pushBuffer.methods) {
+            if (method.subChannel != SubchannelId::ThreeD) [[unlikely]]
+                channelCtx.maxwell3D.FlushEngineState(); // Flush the 3D engine state when doing any calls to other engines
+
+            if (method.type == DecodedMethod::Type::Immediate) {
+                if (method.pure)
+                    SendPure(method.address, method.immediate, method.subChannel);
+                else
+                    SendFull(method.address, method.immediate, method.subChannel, true);
+                continue;
+            }
+
+            auto arguments{pushBuffer.data.subspan(method.argumentOffset, method.argumentCount)};
 
             /**
-             * @brief Handles execution of a single method
-             * @return If the this was the final method in the current GpEntry
+             * @brief Gets the offset to apply to the method address for a given call index
              */
-            auto processMethod{[&] () -> bool {
-                if (methodHeader.secOp == PushBufferMethodHeader::SecOp::IncMethod)  [[likely]] {
-                    return dispatchCalls.operator()<MethodResumeState::State::Inc>();
-                } else if (methodHeader.secOp == PushBufferMethodHeader::SecOp::OneInc) [[likely]] {
-                    return dispatchCalls.operator()<MethodResumeState::State::OneInc>();
-                } else if (methodHeader.secOp == PushBufferMethodHeader::SecOp::ImmdDataMethod) {
-                    if (methodHeader.Pure())
-                        SendPure(methodHeader.methodAddress, methodHeader.immdData, methodHeader.methodSubChannel);
-                    else
-                        SendFull(methodHeader.methodAddress, methodHeader.immdData, methodHeader.methodSubChannel, true);
-
-                    return false;
-                } else if (methodHeader.secOp == PushBufferMethodHeader::SecOp::NonIncMethod) [[unlikely]] {
-                    return dispatchCalls.operator()<MethodResumeState::State::NonInc>();
-                } else if (methodHeader.secOp == PushBufferMethodHeader::SecOp::EndPbSegment) [[unlikely]] {
-                    return true;
-                } else if (methodHeader.secOp == PushBufferMethodHeader::SecOp::Grp0UseTert) {
-                    if (methodHeader.tertOp == PushBufferMethodHeader::TertOp::Grp0SetSubDevMask)
-                        return false;
-
-                    throw exception("Unsupported pushbuffer method TertOp: {}", static_cast<u8>(methodHeader.tertOp));
-                } else {
-                    throw exception("Unsupported pushbuffer method SecOp: {}", static_cast<u8>(methodHeader.secOp));
-                }
+            auto methodOffset{[type = method.type](u32 i) -> u32 {
+                if (type == DecodedMethod::Type::Inc)
+                    return i;
+                else if (type == DecodedMethod::Type::OneInc)
+                    return i ? 1 : 0;
+                else
+                    return 0;
             }};
 
-            bool hitEnd{[&]() {
-                if (methodHeader.methodSubChannel != SubchannelId::ThreeD) [[unlikely]]
-                    channelCtx.maxwell3D.FlushEngineState(); // Flush the 3D engine state when doing any calls to other engines
-                return processMethod();
-            }()};
+            if (method.pure) [[likely]] {
+                if (method.type == DecodedMethod::Type::NonInc && method.argumentCount > BatchCutoff) [[unlikely]] {
+                    // For pure noninc methods we can send all method calls as a span in one go
+                    SendPureBatchNonInc(method.address, arguments, method.subChannel);
+                    continue;
+                } else if (method.type == DecodedMethod::Type::Inc && method.argumentCount > BatchCutoff) {
+                    // Pure inc methods can be sent as a span to allow for register runs without side effects to be written in bulk
+                    SendPureBatchInc(method.address, arguments, method.subChannel);
+                    continue;
+                } else if (method.type == DecodedMethod::Type::OneInc && method.argumentCount > (BatchCutoff + 1)) [[unlikely]] {
+                    // For pure oneinc methods we can send the initial method then send the rest as a span in one go
+                    SendPure(method.address, arguments[0], method.subChannel);
+                    SendPureBatchNonInc(method.address + 1, arguments.subspan(1), method.subChannel);
+                    continue;
+                }
 
-            if (hitEnd)
-                break;
+                #pragma unroll(2)
+                for (u32 i{}; i < method.argumentCount; i++)
+                    SendPure(method.address + methodOffset(i), arguments[i], method.subChannel);
+            } else {
+                // Slow path for methods that touch GPFIFO or macros
+                for (u32 i{}; i < method.argumentCount; i++)
+                    SendFull(method.address + methodOffset(i), arguments[i], method.subChannel, method.methodEnd && i == method.argumentCount - 1);
+            }
         }
+
+        if (pushBuffer.exception)
+            std::rethrow_exception(pushBuffer.exception);
     }
 
-    void ChannelGpfifo::Run() {
-        if (int result{pthread_setname_np(pthread_self(), "GPFIFO")})
+    template<typename Function>
+    void ChannelGpfifo::RunThread(const char *name, Function &&function) {
+        if (int result{pthread_setname_np(pthread_self(), name)})
             Logger::Warn("Failed to set the thread name: {}", strerror(result));
 
         try {
             signal::SetSignalHandler({SIGINT, SIGILL, SIGTRAP, SIGBUS, SIGFPE}, signal::ExceptionalSignalHandler);
             signal::SetSignalHandler({SIGSEGV}, nce::NCE::HostSignalHandler); // We may access NCE trapped memory
 
-            bool channelLocked{};
-
-            gpEntries.Process([this, &channelLocked](GpEntry gpEntry) {
-                Logger::Debug("Processing pushbuffer: 0x{:X}, Size: 0x{:X}", gpEntry.Address(), +gpEntry.size);
-
-                if (!channelLocked) {
-                    channelCtx.Lock();
-                    channelLocked = true;
-                }
-
-                Process(gpEntry);
-            }, [this, &channelLocked]() {
-                // If we run out of GpEntries to process ensure we submit any remaining GPU work before waiting for more to arrive
-                Logger::Debug("Finished processing pushbuffer batch");
-                if (channelLocked) {
-                    channelCtx.executor.Submit();
-                    channelCtx.Unlock();
-                    channelLocked = false;
-                }
-            });
+            function();
         } catch (const signal::SignalException &e) {
             if (e.signal != SIGINT) {
                 Logger::Error("{}\nStack Trace:{}", e.what(), state.loader->GetStackTrace(e.frames));
@@ -385,15 +436,116 @@ namespace skyline::soc::gm20b {
         }
     }
 
+    void ChannelGpfifo::RunDecoder() {
+        RunThread("GPFIFO-Decode", [this]() {
+            gpEntries.Process([this](GpEntry gpEntry) {
+                TRACE_EVENT("soc", "ChannelGpfifo::Decode");
+
+                std::unique_lock lock{pipelineMutex};
+                decoderIdle = false;
+                decodeCondition.wait(lock, [this]() { return decodedCount - executedCount < PipelineDepth; });
+                size_t index{decodedCount};
+                lock.unlock();
+
+                auto &pushBuffer{decodedPushBuffers[index % PipelineDepth]};
+                pushBuffer.gpEntry = gpEntry;
+                pushBuffer.deferred = gpEntry.sync == GpEntry::Sync::Wait;
+                if (!pushBuffer.deferred)
+                    Decode(pushBuffer);
+
+                lock.lock();
+                decodedCount++;
+                executeCondition.notify_one();
+
+                // Deferred entries are decoded by the executing thread which requires exclusive access to the resume state, we wait for it to be done prior to decoding any further entries
+                if (pushBuffer.deferred)
+                    decodeCondition.wait(lock, [this, index]() { return executedCount > index; });
+            }, [this]() {
+                std::scoped_lock lock{pipelineMutex};
+                decoderIdle = true;
+                executeCondition.notify_one();
+            });
+        });
+    }
+
+    void ChannelGpfifo::Run() {
+        RunThread("GPFIFO", [this]() {
+            bool channelLocked{};
+
+            while (true) {
+                std::unique_lock lock{pipelineMutex};
+                if (executedCount == decodedCount) {
+                    if (decoderIdle && channelLocked) {
+                        lock.unlock();
+
+                        // If we run out of GpEntries to process ensure we submit any remaining GPU work before waiting for more to arrive
+                        Logger::Debug("Finished processing pushbuffer batch");
+                        channelCtx.executor.Submit();
+                        channelCtx.Unlock();
+                        channelLocked = false;
+                        continue;
+                    }
+
+                    executeCondition.wait(lock, [&]() { return executedCount != decodedCount || (decoderIdle && channelLocked); });
+                    continue;
+                }
+
+                auto &pushBuffer{decodedPushBuffers[executedCount % PipelineDepth]};
+                lock.unlock();
+
+                Logger::Debug("Processing pushbuffer: 0x{:X}, Size: 0x{:X}", pushBuffer.gpEntry.Address(), +pushBuffer.gpEntry.size);
+
+                if (!channelLocked) {
+                    channelCtx.Lock();
+                    channelLocked = true;
+                }
+
+                auto executeStart{util::GetTimeNs()};
+                Execute(pushBuffer);
+                GetPerformanceStatistics().gpfifoBusyNs.fetch_add(static_cast<u64>(util::GetTimeNs() - executeStart), std::memory_order_relaxed);
+
+                // Hand the global channel lock over to any waiting channels at submission boundaries (such as syncpoint increments) as they would otherwise be blocked until this channel runs out of work, this allows independent channels to interleave their work
+                if (channelCtx.IsLockContended() && channelCtx.executor.IsExecutionEmpty()) {
+                    channelCtx.executor.Submit();
+                    channelCtx.Unlock();
+                    channelLocked = false;
+                    std::this_thread::yield();
+                }
+
+                lock.lock();
+                executedCount++;
+                decodeCondition.notify_one();
+                if (executedCount == pushedCount.load(std::memory_order_acquire))
+                    idleCondition.notify_all();
+            }
+        });
+    }
+
     void ChannelGpfifo::Push(span<GpEntry> entries) {
+        if (auto &capture{channelCtx.asCtx->capture})
+            capture->RecordGpEntries(*channelCtx.asCtx, captureChannel, entries);
+        pushedCount.fetch_add(entries.size(), std::memory_order_release);
         gpEntries.Append(entries);
     }
 
     void ChannelGpfifo::Push(GpEntry entry) {
+        if (auto &capture{channelCtx.asCtx->capture})
+            capture->RecordGpEntries(*channelCtx.asCtx, captureChannel, span<const GpEntry>{&entry, 1});
+        pushedCount.fetch_add(1, std::memory_order_release);
         gpEntries.Push(entry);
     }
 
+    void ChannelGpfifo::WaitIdle() {
+        std::unique_lock lock{pipelineMutex};
+        idleCondition.wait(lock, [this]() { return executedCount == pushedCount.load(std::memory_order_acquire); });
+    }
+
     ChannelGpfifo::~ChannelGpfifo() {
+        if (decoderThread.joinable()) {
+            pthread_kill(decoderThread.native_handle(), SIGINT);
+            decoderThread.join();
+        }
+
         if (thread.joinable()) {
             pthread_kill(thread.native_handle(), SIGINT);
             thread.join();
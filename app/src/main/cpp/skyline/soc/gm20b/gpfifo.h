@@ -106,10 +106,9 @@ namespace skyline::soc::gm20b {
         ChannelContext &channelCtx;
         engine::GPFIFO gpfifoEngine; //!< The engine for processing GPFIFO method calls
         CircularQueue<GpEntry> gpEntries;
-        std::vector<u32> pushBufferData; //!< Persistent vector storing pushbuffer data to avoid constant reallocations
 
         /**
-         * @brief Holds the required state in order to resume a method started from one call to `Process` in another
+         * @brief Holds the required state in order to resume a method started from one call to `Decode` in another
          * @note This is needed as games (especially OpenGL ones) can split method entries over multiple GpEntries
          */
         struct MethodResumeState {
@@ -125,9 +124,56 @@ namespace skyline::soc::gm20b {
                 Inc,
                 OneInc //!< Will be switched to NonInc after the first call
             } state; //!< The type of method to resume
-        } resumeState{};
+        } resumeState{}; //!< The resume state of the decoder, this is only accessed by the thread decoding pushbuffers at any point in time
 
-        std::thread thread; //!< The thread that manages processing of pushbuffers
+        /**
+         * @brief A run of method calls decoded from a pushbuffer, all targeting the same subchannel
+         */
+        struct DecodedMethod {
+            u32 address; //!< The method address of the first call
+            union {
+                u32 argumentOffset; //!< The offset of the first argument in the pushbuffer data in words
+                u32 immediate; //!< The argument of an immediate method, this is used when `type` is Immediate
+            };
+            u32 argumentCount;
+            SubchannelId subChannel;
+
+            enum class Type : u8 {
+                NonInc,
+                Inc,
+                OneInc, //!< The first call targets `address` and all subsequent ones target `address + 1`
+                Immediate,
+            } type;
+            bool pure; //!< If none of the calls touch macro or GPFIFO methods
+            bool methodEnd; //!< If the last call is the final one of the method, this is false for methods split across multiple GpEntries
+        };
+
+        /**
+         * @brief A GpEntry alongside its pushbuffer contents and the methods decoded from them
+         */
+        struct DecodedPushBuffer {
+            GpEntry gpEntry{0, 0};
+            bool deferred{}; //!< If decoding was deferred to the executing thread, this is done for entries that require a submit prior to fetching the pushbuffer as its contents may be generated by prior work
+            span<u32> data; //!< The pushbuffer contents, this is directly mapped guest memory when the pushbuffer is contiguous or `copy` otherwise
+            std::vector<u32> copy; //!< Persistent vector storing an intermediate copy of pushbuffer data split across multiple mappings to avoid constant reallocations
+            std::vector<DecodedMethod> methods; //!< Persistent vector of the methods to execute in order
+            std::exception_ptr exception; //!< An exception that was thrown during decoding, this is rethrown after all methods prior to it have been executed
+        };
+
+        static constexpr size_t PipelineDepth{4}; //!< The maximum amount of pushbuffers that can be decoded ahead of the one being executed
+        std::array<DecodedPushBuffer, PipelineDepth> decodedPushBuffers; //!< A ring of decoded pushbuffers, indexed by decode/execute counters modulo the depth
+        std::mutex pipelineMutex; //!< Synchronizes accesses to the pipeline counters and flags
+        std::condition_variable decodeCondition; //!< Signalled when a pushbuffer has been executed and its slot is free for decoding
+        std::condition_variable executeCondition; //!< Signalled when a pushbuffer has been decoded or the decoder is idle
+        size_t decodedCount{}; //!< The total amount of pushbuffers that have been decoded
+        size_t executedCount{}; //!< The total amount of pushbuffers that have been executed
+        bool decoderIdle{true}; //!< If the decoder has run out of GpEntries and is waiting for more to arrive
+        std::atomic<size_t> pushedCount{}; //!< The total amount of GpEntries that have been pushed, this is incremented prior to them being queued
+        std::condition_variable idleCondition; //!< Signalled when all pushed GpEntries have been executed
+        u32 captureChannel{}; //!< The index of the channel in the capture of its AS, this is only used when the AS is being captured
+
+        std::thread thread; //!< The thread that executes decoded pushbuffers
+        std::thread decoderThread; //!< The thread that fetches and decodes pushbuffers ahead of execution
 
         /**
          * @brief Sends a method call to the appropriate subchannel and handles macro and GPFIFO methods
@@ -145,12 +191,34 @@ namespace skyline::soc::gm20b {
         void SendPureBatchNonInc(u32 method, span<u32> arguments, SubchannelId subChannel);
 
         /**
-         * @brief Processes the pushbuffer contained within the given GpEntry, calling methods as needed
+         * @brief Sends a batch of method calls to consecutive methods to the appropriate subchannel, macro and GPFIFO methods are not handled
+         */
+        void SendPureBatchInc(u32 method, span<u32> arguments, SubchannelId subChannel);
+
+        /**
+         * @brief Fetches the pushbuffer of the supplied GpEntry and decodes it into a sequence of method calls
+         * @note Any exceptions thrown during decoding are stored in the pushbuffer rather than propagated
+         */
+        void Decode(DecodedPushBuffer &pushBuffer);
+
+        /**
+         * @brief Executes all method calls of a decoded pushbuffer
+         */
+        void Execute(DecodedPushBuffer &pushBuffer);
+
+        /**
+         * @brief Runs the supplied function with signal handlers set up for accessing guest memory, terminating the guest on any exceptions
+         */
+        template<typename Function>
+        void RunThread(const char *name, Function &&function);
+
+        /**
+         * @brief Decodes all pending entries in the FIFO and polls for more
          */
-        void Process(GpEntry gpEntry);
+        void RunDecoder();
 
         /**
-         * @brief Executes all pending entries in the FIFO and polls for more
+         * @brief Executes all decoded pushbuffers and polls for more
          */
         void Run();
 
@@ -171,5 +239,10 @@ namespace skyline::soc::gm20b {
          * @brief Pushes a single entry to the FIFO, these commands will be executed on calls to 'Process'
          */
         void Push(GpEntry entries);
+
+        /**
+         * @brief Blocks till all GpEntries pushed prior to this have been executed
+         */
+        void WaitIdle();
     };
 }
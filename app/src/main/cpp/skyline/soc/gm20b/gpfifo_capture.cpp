@@ -0,0 +1,237 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2023 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#include <sys/mman.h>
+#include <common/performance_statistics.h>
+#include <gpu.h>
+#include "channel.h"
+#include "gmmu.h"
+#include "gpfifo_capture.h"
+
+namespace skyline::soc::gm20b {
+    GpfifoCapture::GpfifoCapture(const std::shared_ptr<vfs::FileSystem> &fileSystem, const std::string &fileName) {
+        if (!fileSystem->FileExists(fileName) && !fileSystem->CreateFile(fileName, 0))
+            throw exception("Failed to create GPFIFO capture file: {}", fileName);
+
+        backing = fileSystem->OpenFile(fileName, {true, true, true});
+        backing->Resize(0);
+
+        capture::FileHeader header{};
+        buffer.insert(buffer.end(), reinterpret_cast<u8 *>(&header), reinterpret_cast<u8 *>(&header) + sizeof(header));
+        Logger::Info("Capturing GPFIFO submissions to {}", fileName);
+    }
+
+    GpfifoCapture::~GpfifoCapture() {
+        std::scoped_lock lock{mutex};
+        try {
+            FlushBuffer();
+            backing->Flush();
+        } catch (const std::exception &e) {
+            Logger::Warn("Failed to write out GPFIFO capture: {}", e.what());
+        }
+    }
+
+    void GpfifoCapture::WriteRecord(const capture::RecordHeader &header, span<const u8> contents) {
+        buffer.insert(buffer.end(), reinterpret_cast<const u8 *>(&header), reinterpret_cast<const u8 *>(&header) + sizeof(header));
+        buffer.insert(buffer.end(), contents.begin(), contents.end());
+    }
+
+    void GpfifoCapture::WriteMemory(AddressSpaceContext &asCtx, u64 address, u64 size) {
+        size_t offset{buffer.size()};
+        buffer.resize(offset + size);
+        for (auto range : asCtx.gmmu.TranslateRange(address, size)) {
+            if (range.data())
+                std::memcpy(buffer.data() + offset, range.data(), range.size());
+            else
+                std::memset(buffer.data() + offset, 0, range.size());
+            offset += range.size();
+        }
+    }
+
+    void GpfifoCapture::FlushBuffer() {
+        if (buffer.empty())
+            return;
+
+        backing->Write(span{buffer}, fileOffset);
+        fileOffset += buffer.size();
+        buffer.clear();
+    }
+
+    u32 GpfifoCapture::RegisterChannel() {
+        std::scoped_lock lock{mutex};
+        return channelCount++;
+    }
+
+    void GpfifoCapture::RecordMap(u64 address, u64 size, bool sparse) {
+        std::scoped_lock lock{mutex};
+        WriteRecord({
+            .type = capture::RecordType::Map,
+            .sparse = sparse,
+            .address = address,
+            .size = size,
+        });
+
+        if (!sparse)
+            pendingSnapshots.emplace_back(address, size);
+    }
+
+    void GpfifoCapture::RecordUnmap(u64 address, u64 size) {
+        std::scoped_lock lock{mutex};
+        WriteRecord({
+            .type = capture::RecordType::Unmap,
+            .address = address,
+            .size = size,
+        });
+    }
+
+    void GpfifoCapture::RecordGpEntries(AddressSpaceContext &asCtx, u32 channel, span<const GpEntry> entries) {
+        std::scoped_lock lock{mutex};
+
+        // Mappings are snapshotted lazily as their contents usually aren't written by the guest till after they've been mapped, any part of them that has been unmapped since is skipped
+        for (auto [address, size] : pendingSnapshots) {
+            for (auto range : asCtx.gmmu.TranslateRange(address, size)) {
+                if (range.data()) {
+                    WriteRecord({
+                        .type = capture::RecordType::Memory,
+                        .address = address,
+                        .size = range.size(),
+                    }, range);
+                }
+                address += range.size();
+            }
+        }
+        pendingSnapshots.clear();
+
+        WriteRecord({
+            .type = capture::RecordType::GpEntries,
+            .channel = channel,
+            .size = entries.size(),
+        }, entries.cast<const u8>());
+
+        // Pushbuffers are recorded alongside every submission as they're usually rewritten by the guest for every frame
+        for (const auto &entry : entries)
+            if (entry.size)
+                WriteMemory(asCtx, entry.Address(), entry.size * sizeof(u32));
+
+        if (buffer.size() >= FlushThreshold)
+            FlushBuffer();
+    }
+
+    GpfifoReplayer::GpfifoReplayer(const DeviceState &state, std::shared_ptr<vfs::Backing> pBacking) : state{state}, backing{std::move(pBacking)}, asCtx{std::make_shared<AddressSpaceContext>()} {
+        auto header{backing->Read<capture::FileHeader>()};
+        if (header.magic != capture::Magic)
+            throw exception("Invalid GPFIFO capture magic: 0x{:X}", header.magic);
+        if (header.version != capture::Version)
+            throw exception("Unsupported GPFIFO capture version: {}", header.version);
+    }
+
+    GpfifoReplayer::~GpfifoReplayer() = default;
+
+    ChannelContext &GpfifoReplayer::GetChannel(u32 index) {
+        constexpr size_t ReplayGpEntryCount{0x800}; //!< The size of the GpEntry FIFO of replayed channels, this matches the size commonly allocated by titles
+
+        while (channels.size() <= index)
+            channels.emplace_back(std::make_unique<ChannelContext>(state, asCtx, ReplayGpEntryCount));
+        return *channels[index];
+    }
+
+    void GpfifoReplayer::WaitIdle() {
+        for (auto &channel : channels)
+            channel->gpfifo.WaitIdle();
+    }
+
+    GpfifoReplayer::Statistics GpfifoReplayer::Replay() {
+        auto &statistics{GetPerformanceStatistics()};
+        u64 gpfifoBusyStart{statistics.gpfifoBusyNs.load(std::memory_order_relaxed)}, gpuBusyStart{statistics.gpuBusyNs.load(std::memory_order_relaxed)};
+        auto replayStart{util::GetTimeNs()};
+
+        size_t offset{sizeof(capture::FileHeader)}, gpEntryCount{};
+        std::vector<u8> contents, current;
+        std::vector<GpEntry> entries;
+        while (offset + sizeof(capture::RecordHeader) <= backing->size) {
+            auto header{backing->Read<capture::RecordHeader>(offset)};
+            offset += sizeof(capture::RecordHeader);
+
+            // Any memory that's modified by a record could still be read by prior submissions, so they need to be complete prior to the record being applied
+            switch (header.type) {
+                case capture::RecordType::Map:
+                    WaitIdle();
+                    if (header.sparse) {
+                        asCtx->gmmu.Map(header.address, GMMU::SparsePlaceholderAddress(), header.size, {true});
+                    } else {
+                        // The memory is never unmapped from the host as textures and buffers created from it can outlive the replay, similar to guest memory in the emulator
+                        void *memory{mmap(nullptr, util::AlignUp(header.size, constant::PageSize), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0)};
+                        if (memory == MAP_FAILED)
+                            throw exception("Failed to allocate 0x{:X} bytes of memory for a replayed mapping: {}", header.size, strerror(errno));
+                        asCtx->gmmu.Map(header.address, static_cast<u8 *>(memory), header.size);
+                    }
+                    break;
+
+                case capture::RecordType::Unmap:
+                    WaitIdle();
+                    asCtx->gmmu.Unmap(header.address, header.size);
+                    break;
+
+                case capture::RecordType::Memory:
+                    WaitIdle();
+                    contents.resize(header.size);
+                    backing->Read(span{contents}, offset);
+                    offset += header.size;
+                    asCtx->gmmu.Write(header.address, contents.data(), header.size);
+                    break;
+
+                case capture::RecordType::GpEntries: {
+                    entries.resize(header.size, GpEntry{0, 0});
+                    backing->Read(span{entries}, offset);
+                    offset += header.size * sizeof(GpEntry);
+
+                    // Pushbuffers which are identical to the contents already in memory are common for static command lists, they're left alone to avoid waiting on the channels
+                    bool waited{};
+                    for (const auto &entry : entries) {
+                        if (!entry.size)
+                            continue;
+
+                        size_t size{entry.size * sizeof(u32)};
+                        contents.resize(size);
+                        current.resize(size);
+                        backing->Read(span{contents}, offset);
+                        offset += size;
+
+                        asCtx->gmmu.Read(current.data(), entry.Address(), size);
+                        if (contents != current) {
+                            if (!waited) {
+                                WaitIdle();
+                                waited = true;
+                            }
+                            asCtx->gmmu.Write(entry.Address(), contents.data(), size);
+                        }
+                    }
+
+                    GetChannel(header.channel).gpfifo.Push(span{entries});
+                    gpEntryCount += entries.size();
+                    break;
+                }
+
+                default:
+                    throw exception("Unknown GPFIFO capture record type: {}", static_cast<u32>(header.type));
+            }
+        }
+
+        WaitIdle();
+        for (auto &channel : channels) {
+            channel->Lock();
+            channel->executor.Submit();
+            channel->Unlock();
+        }
+        state.gpu->scheduler.WaitIdle();
+
+        Statistics result{
+            .wallNs = static_cast<u64>(util::GetTimeNs() - replayStart),
+            .gpfifoBusyNs = statistics.gpfifoBusyNs.load(std::memory_order_relaxed) - gpfifoBusyStart,
+            .gpuBusyNs = statistics.gpuBusyNs.load(std::memory_order_relaxed) - gpuBusyStart,
+            .gpEntryCount = gpEntryCount,
+        };
+        Logger::Info("Replayed {} GpEntries on {} channels in {}ms (GPFIFO: {}ms, GPU: {}ms)", result.gpEntryCount, channels.size(), result.wallNs / constant::NsInMillisecond, result.gpfifoBusyNs / constant::NsInMillisecond, result.gpuBusyNs / constant::NsInMillisecond);
+        return result;
+    }
+}
@@ -0,0 +1,124 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2023 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#pragma once
+
+#include <vfs/filesystem.h>
+#include <common.h>
+
+namespace skyline::soc::gm20b {
+    struct AddressSpaceContext;
+    struct ChannelContext;
+    struct GpEntry;
+
+    namespace capture {
+        constexpr u32 Magic{util::MakeMagic<u32>("GPCP")};
+        constexpr u32 Version{1};
+
+        struct FileHeader {
+            u32 magic{Magic};
+            u32 version{Version};
+        };
+        static_assert(sizeof(FileHeader) == 0x8);
+
+        enum class RecordType : u32 {
+            Map, //!< `size` bytes at `address` were mapped, `sparse` mappings read as zeroes and are never snapshotted
+            Unmap, //!< `size` bytes at `address` were unmapped
+            Memory, //!< A snapshot of `size` bytes of memory at `address`, the contents directly follow the header
+            GpEntries, //!< `size` GpEntries were pushed to `channel`, they directly follow the header and are followed by the pushbuffer words of every entry in order
+        };
+
+        /**
+         * @brief The header of a single record in a capture, records are written in the order they occurred in
+         */
+        struct RecordHeader {
+            RecordType type;
+            u32 channel : 31; //!< The index of the channel in the AS, this is only used by GpEntries records
+            bool sparse : 1; //!< If the mapping is sparse, this is only used by Map records
+            u64 address;
+            u64 size;
+        };
+        static_assert(sizeof(RecordHeader) == 0x18);
+    }
+
+    /**
+     * @brief Records all GPU AS mappings and GPFIFO submissions of an AS into a file, so they can be replayed by GpfifoReplayer without the guest
+     * @note Mapped memory is snapshotted at the first submission after it was mapped, CPU writes after that point aren't captured
+     */
+    class GpfifoCapture {
+      private:
+        static constexpr size_t FlushThreshold{0x100000}; //!< The size of buffered records at which they're written out to the file
+
+        std::mutex mutex; //!< Synchronizes recording from multiple channels and the AS
+        std::shared_ptr<vfs::Backing> backing;
+        size_t fileOffset{}; //!< The offset in the file the buffer will be written to
+        std::vector<u8> buffer; //!< Records which haven't been written out yet, this avoids a syscall for every record
+        std::vector<std::pair<u64, u64>> pendingSnapshots; //!< Non-sparse mappings which are yet to be snapshotted as {address, size}
+        u32 channelCount{};
+
+        void WriteRecord(const capture::RecordHeader &header, span<const u8> contents = {});
+
+        /**
+         * @brief Appends the contents of a range of the AS to the buffer, unmapped regions are written as zeroes
+         */
+        void WriteMemory(AddressSpaceContext &asCtx, u64 address, u64 size);
+
+        void FlushBuffer();
+
+      public:
+        GpfifoCapture(const std::shared_ptr<vfs::FileSystem> &fileSystem, const std::string &fileName);
+
+        ~GpfifoCapture();
+
+        /**
+         * @return The index of a newly created channel in the AS
+         */
+        u32 RegisterChannel();
+
+        void RecordMap(u64 address, u64 size, bool sparse);
+
+        void RecordUnmap(u64 address, u64 size);
+
+        /**
+         * @brief Records GpEntries alongside their pushbuffers and snapshots of any memory mapped since the last submission
+         */
+        void RecordGpEntries(AddressSpaceContext &asCtx, u32 channel, span<const GpEntry> entries);
+    };
+
+    /**
+     * @brief Replays a capture written by GpfifoCapture through freshly created channels in a private AS, this allows measuring the cost of the GPU pipeline reproducibly
+     * @note The capture should be replayed in a process which hasn't run any GPU work, syncpoint waits in pushbuffers rely on syncpoints starting at the same values as they did during the capture
+     */
+    class GpfifoReplayer {
+      private:
+        const DeviceState &state;
+        std::shared_ptr<vfs::Backing> backing;
+        std::shared_ptr<AddressSpaceContext> asCtx;
+        std::vector<std::unique_ptr<ChannelContext>> channels;
+        std::vector<span<u8>> allocations; //!< Host memory backing the mappings, these are only freed on destruction as the GPU could still reference them
+
+        ChannelContext &GetChannel(u32 index);
+
+        /**
+         * @brief Waits for all channels to finish executing pushed GpEntries, this is required prior to modifying any memory they could read
+         */
+        void WaitIdle();
+
+      public:
+        struct Statistics {
+            u64 wallNs; //!< The time taken to replay the capture and wait for the GPU to finish its work
+            u64 gpfifoBusyNs; //!< The time GPFIFO threads spent executing pushbuffers
+            u64 gpuBusyNs; //!< The time the host GPU was busy executing submitted work
+            size_t gpEntryCount;
+        };
+
+        GpfifoReplayer(const DeviceState &state, std::shared_ptr<vfs::Backing> backing);
+
+        ~GpfifoReplayer();
+
+        /**
+         * @brief Replays all records in the capture and waits for the GPU to finish executing them
+         */
+        Statistics Replay();
+    };
+}
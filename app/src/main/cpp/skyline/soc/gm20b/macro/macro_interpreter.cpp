@@ -1,123 +1,205 @@
 // SPDX-License-Identifier: MPL-2.0
 // Copyright © 2020 Skyline Team and Contributors (https://github.com/skyline-emu/)
 
+#include <common/trace.h>
 #include "soc/gm20b/engines/engine.h"
 #include "macro_interpreter.h"
 
 namespace skyline::soc::gm20b::engine {
     MacroInterpreter::MacroInterpreter(span<u32> macroCode) : macroCode(macroCode) {}
 
-    void MacroInterpreter::Execute(size_t offset, span<u32> args, MacroEngineBase *targetEngine) {
-        // Reset the interpreter state
-        engine = targetEngine;
-        opcode = reinterpret_cast<Opcode *>(&macroCode[offset]);
-        registers = {};
-        argument = args.data();
-        methodAddress.raw = 0;
-        carryFlag = false;
+    template<MacroInterpreter::Opcode::Operation Operation>
+    MacroInterpreter::CompiledInstruction::Function MacroInterpreter::SelectFunction(Opcode::AssignmentOperation assignment) {
+        #define ASSIGNMENT_CASE(name) case Opcode::AssignmentOperation::name: return &ExecuteInstruction<Operation, Opcode::AssignmentOperation::name>
+
+        switch (assignment) {
+            ASSIGNMENT_CASE(IgnoreAndFetch);
+            ASSIGNMENT_CASE(Move);
+            ASSIGNMENT_CASE(MoveAndSetMethod);
+            ASSIGNMENT_CASE(FetchAndSend);
+            ASSIGNMENT_CASE(MoveAndSend);
+            ASSIGNMENT_CASE(FetchAndSetMethod);
+            ASSIGNMENT_CASE(MoveAndSetMethodThenFetchAndSend);
+            ASSIGNMENT_CASE(MoveAndSetMethodThenSendHigh);
+        }
 
-        // The first argument is stored in register 1
-        registers[1] = *argument++;
+        #undef ASSIGNMENT_CASE
 
-        while (Step());
+        __builtin_unreachable();
     }
 
-    __attribute__((always_inline)) bool MacroInterpreter::Step(Opcode *delayedOpcode) {
-        switch (opcode->operation) {
-            case Opcode::Operation::AluRegister: {
-                u32 result{HandleAlu(opcode->aluOperation, registers[opcode->srcA], registers[opcode->srcB])};
+    MacroInterpreter::CompiledInstruction MacroInterpreter::CompileInstruction(Opcode opcode, size_t index, size_t base, size_t count) {
+        CompiledInstruction instruction{
+            .dest = opcode.dest,
+            .srcA = opcode.srcA,
+            .srcB = opcode.srcB,
+            .aluOperation = opcode.aluOperation,
+            .immediate = opcode.immediate,
+            .srcBit = opcode.bitfield.srcBit,
+            .destBit = opcode.bitfield.destBit,
+            .mask = opcode.bitfield.GetMask(),
+            .exit = static_cast<bool>(opcode.exit),
+        };
+
+        switch (opcode.operation) {
+            case Opcode::Operation::AluRegister:
+                instruction.function = SelectFunction<Opcode::Operation::AluRegister>(opcode.assignmentOperation);
+                break;
+            case Opcode::Operation::AddImmediate:
+                instruction.function = SelectFunction<Opcode::Operation::AddImmediate>(opcode.assignmentOperation);
+                break;
+            case Opcode::Operation::BitfieldReplace:
+                instruction.function = SelectFunction<Opcode::Operation::BitfieldReplace>(opcode.assignmentOperation);
+                break;
+            case Opcode::Operation::BitfieldExtractShiftLeftImmediate:
+                instruction.function = SelectFunction<Opcode::Operation::BitfieldExtractShiftLeftImmediate>(opcode.assignmentOperation);
+                break;
+            case Opcode::Operation::BitfieldExtractShiftLeftRegister:
+                instruction.function = SelectFunction<Opcode::Operation::BitfieldExtractShiftLeftRegister>(opcode.assignmentOperation);
+                break;
+            case Opcode::Operation::ReadImmediate:
+                instruction.function = SelectFunction<Opcode::Operation::ReadImmediate>(opcode.assignmentOperation);
+                break;
 
-                HandleAssignment(opcode->assignmentOperation, opcode->dest, result);
+            case Opcode::Operation::Branch: {
+                instruction.isBranch = true;
+                instruction.branchOnZero = opcode.branchCondition == Opcode::BranchCondition::Zero;
+                instruction.noDelay = opcode.noDelay;
+
+                // Any targets outside of the compiled range are outside of macro memory, these are redirected to the sentinel instruction
+                i64 target{static_cast<i64>(index) + opcode.immediate};
+                if (target >= static_cast<i64>(base) && target < static_cast<i64>(base + count))
+                    instruction.branchTarget = static_cast<u32>(target - static_cast<i64>(base));
+                else
+                    instruction.branchTarget = static_cast<u32>(count);
                 break;
             }
 
-            case Opcode::Operation::AddImmediate:
-                HandleAssignment(opcode->assignmentOperation, opcode->dest,
-                                 static_cast<u32>(static_cast<i32>(registers[opcode->srcA]) + opcode->immediate));
+            default:
+                // Unknown opcodes are only an error if they're executed, we retain the raw operation in the immediate to report it
+                instruction.immediate = static_cast<i32>(opcode.operation);
+                instruction.function = [](MacroInterpreter &, const CompiledInstruction &instruction) {
+                    throw exception("Unknown MME opcode encountered: 0x{:X}", static_cast<u8>(instruction.immediate));
+                };
                 break;
+        }
 
-            case Opcode::Operation::BitfieldReplace: {
-                u32 src{registers[opcode->srcB]};
-                u32 dest{registers[opcode->srcA]};
+        return instruction;
+    }
 
-                // Extract the source region
-                src = (src >> opcode->bitfield.srcBit) & opcode->bitfield.GetMask();
+    const MacroInterpreter::CompiledMacro &MacroInterpreter::Compile(size_t offset) {
+        if (offset >= macroCode.size())
+            throw exception("Macro entry point is outside of macro memory: 0x{:X}", offset);
+
+        // Find the range of all instructions reachable from the entry point by following every possible control flow path
+        enum class Reachability : u8 {
+            Unreachable,
+            ExitDelaySlot, //!< The instruction is only executed as the delay slot of an exit, nothing after it is executed
+            Sequential, //!< Execution can continue past the instruction
+        };
+        std::vector<Reachability> reachable(macroCode.size());
+        std::vector<size_t> pending{offset};
+        reachable[offset] = Reachability::Sequential;
+        size_t lowest{offset}, highest{offset};
+
+        auto enqueue{[&](i64 index, Reachability reachability) {
+            if (index < 0 || index >= static_cast<i64>(macroCode.size()) || reachable[static_cast<size_t>(index)] >= reachability)
+                return;
+
+            reachable[static_cast<size_t>(index)] = reachability;
+            pending.push_back(static_cast<size_t>(index));
+            lowest = std::min(lowest, static_cast<size_t>(index));
+            highest = std::max(highest, static_cast<size_t>(index));
+        }};
+
+        while (!pending.empty()) {
+            size_t index{pending.back()};
+            pending.pop_back();
+
+            // Delay slots can't branch and any exit flag on them is ignored, so the delay slot of an exit ends its path
+            if (reachable[index] == Reachability::ExitDelaySlot)
+                continue;
+
+            Opcode opcode{.raw = macroCode[index]};
+            if (opcode.operation == Opcode::Operation::Branch)
+                enqueue(static_cast<i64>(index) + opcode.immediate, Reachability::Sequential);
+
+            // The next instruction is either executed sequentially or as the delay slot of a branch or exit
+            enqueue(static_cast<i64>(index) + 1, opcode.exit ? Reachability::ExitDelaySlot : Reachability::Sequential);
+        }
 
-                // Mask out the bits that we will replace
-                dest &= ~(opcode->bitfield.GetMask() << opcode->bitfield.destBit);
+        size_t count{highest - lowest + 1};
+        u32 entry{static_cast<u32>(offset - lowest)};
+        u64 hash{XXH64(&macroCode[lowest], count * sizeof(u32), entry)};
 
-                // Replace the bitfield region in the destination with the region from the source
-                dest |= src << opcode->bitfield.destBit;
+        if (auto it{compiledMacros.find(hash)}; it != compiledMacros.end())
+            return it->second;
 
-                HandleAssignment(opcode->assignmentOperation, opcode->dest, dest);
-                break;
-            }
+        TRACE_EVENT("soc", "MacroInterpreter::Compile");
 
-            case Opcode::Operation::BitfieldExtractShiftLeftImmediate: {
-                u32 src{registers[opcode->srcB]};
-                u32 dest{registers[opcode->srcA]};
+        CompiledMacro macro{.entry = entry};
+        macro.instructions.reserve(count + 1);
+        for (size_t index{lowest}; index <= highest; index++)
+            macro.instructions.push_back(CompileInstruction(Opcode{.raw = macroCode[index]}, index, lowest, count));
 
-                u32 result{((src >> dest) & opcode->bitfield.GetMask()) << opcode->bitfield.destBit};
+        // A sentinel instruction for execution running past the end of macro memory, this has no valid successor as it always throws
+        macro.instructions.push_back(CompiledInstruction{
+            .function = [](MacroInterpreter &, const CompiledInstruction &) {
+                throw exception("Macro execution ran outside of macro memory");
+            },
+        });
 
-                HandleAssignment(opcode->assignmentOperation, opcode->dest, result);
-                break;
-            }
-
-            case Opcode::Operation::BitfieldExtractShiftLeftRegister: {
-                u32 src{registers[opcode->srcB]};
-                u32 dest{registers[opcode->srcA]};
+        return compiledMacros.emplace(hash, std::move(macro)).first->second;
+    }
 
-                u32 result{((src >> opcode->bitfield.srcBit) & opcode->bitfield.GetMask()) << dest};
+    void MacroInterpreter::Invalidate() {
+        if (compiledMacros.size() > MaxCachedMacroCount)
+            compiledMacros.clear();
+    }
 
-                HandleAssignment(opcode->assignmentOperation, opcode->dest, result);
-                break;
-            }
+    void MacroInterpreter::Execute(const CompiledMacro &macro, span<u32> args, MacroEngineBase *targetEngine) {
+        // Reset the interpreter state
+        engine = targetEngine;
+        registers = {};
+        argument = args.data();
+        methodAddress.raw = 0;
+        carryFlag = false;
 
-            case Opcode::Operation::ReadImmediate: {
-                u32 result{engine->ReadMethodFromMacro(static_cast<u32>(static_cast<i32>(registers[opcode->srcA]) + opcode->immediate))};
-                HandleAssignment(opcode->assignmentOperation, opcode->dest, result);
-                break;
-            }
+        // The first argument is stored in register 1
+        registers[1] = *argument++;
 
-            case Opcode::Operation::Branch: {
-                if (delayedOpcode != nullptr)
-                    throw exception("Cannot branch while inside a delay slot");
-
-                u32 value{registers[opcode->srcA]};
-                bool branch{(opcode->branchCondition == Opcode::BranchCondition::Zero) ? (value == 0) : (value != 0)};
-
-                if (branch) {
-                    if (opcode->noDelay) {
-                        opcode += opcode->immediate;
-                        return true;
-                    } else {
-                        Opcode *targetOpcode{opcode + opcode->immediate};
-
-                        // Step into delay slot
-                        opcode++;
-                        return Step(targetOpcode);
-                    }
+        // Every instruction is followed by another in the compiled macro due to the sentinel, so delay slots can always be accessed
+        const CompiledInstruction *instruction{&macro.instructions[macro.entry]};
+        while (true) {
+            if (instruction->isBranch) {
+                u32 value{registers[instruction->srcA]};
+                if ((value == 0) == instruction->branchOnZero) {
+                    const CompiledInstruction *target{&macro.instructions[instruction->branchTarget]};
+                    if (!instruction->noDelay)
+                        ExecuteDelaySlot(instruction[1]);
+                    instruction = target;
+                    continue;
                 }
-                break;
+            } else {
+                instruction->function(*this, *instruction);
             }
 
-            default:
-                throw exception("Unknown MME opcode encountered: 0x{:X}", static_cast<u8>(opcode->operation));
-        }
+            if (instruction->exit) {
+                // Exit has a delay slot
+                ExecuteDelaySlot(instruction[1]);
+                return;
+            }
 
-        if (opcode->exit && (delayedOpcode == nullptr)) {
-            // Exit has a delay slot
-            opcode++;
-            Step(opcode);
-            return false;
+            instruction++;
         }
+    }
 
-        if (delayedOpcode != nullptr)
-            opcode = delayedOpcode;
-        else
-            opcode++;
+    void MacroInterpreter::ExecuteDelaySlot(const CompiledInstruction &instruction) {
+        if (instruction.isBranch)
+            throw exception("Cannot branch while inside a delay slot");
 
-        return true;
+        // Any exit flag on the delay slot is ignored as we're already exiting or branching
+        instruction.function(*this, instruction);
     }
 
     __attribute__((always_inline)) u32 MacroInterpreter::HandleAlu(Opcode::AluOperation operation, u32 srcA, u32 srcB) {
@@ -208,4 +290,28 @@ namespace skyline::soc::gm20b::engine {
 
         registers[reg] = value;
     }
+
+    template<MacroInterpreter::Opcode::Operation Operation, MacroInterpreter::Opcode::AssignmentOperation Assignment>
+    void MacroInterpreter::ExecuteInstruction(MacroInterpreter &interpreter, const CompiledInstruction &instruction) {
+        auto &registers{interpreter.registers};
+        u32 result;
+
+        if constexpr (Operation == Opcode::Operation::AluRegister) {
+            result = interpreter.HandleAlu(instruction.aluOperation, registers[instruction.srcA], registers[instruction.srcB]);
+        } else if constexpr (Operation == Opcode::Operation::AddImmediate) {
+            result = static_cast<u32>(static_cast<i32>(registers[instruction.srcA]) + instruction.immediate);
+        } else if constexpr (Operation == Opcode::Operation::BitfieldReplace) {
+            // Extract the source region and replace the bitfield region in the destination with it
+            u32 src{(registers[instruction.srcB] >> instruction.srcBit) & instruction.mask};
+            result = (registers[instruction.srcA] & ~(instruction.mask << instruction.destBit)) | (src << instruction.destBit);
+        } else if constexpr (Operation == Opcode::Operation::BitfieldExtractShiftLeftImmediate) {
+            result = ((registers[instruction.srcB] >> registers[instruction.srcA]) & instruction.mask) << instruction.destBit;
+        } else if constexpr (Operation == Opcode::Operation::BitfieldExtractShiftLeftRegister) {
+            result = ((registers[instruction.srcB] >> instruction.srcBit) & instruction.mask) << registers[instruction.srcA];
+        } else if constexpr (Operation == Opcode::Operation::ReadImmediate) {
+            result = interpreter.engine->ReadMethodFromMacro(static_cast<u32>(static_cast<i32>(registers[instruction.srcA]) + instruction.immediate));
+        }
+
+        interpreter.HandleAssignment(Assignment, instruction.dest, result);
+    }
 }
@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include <unordered_map>
 #include <common.h>
 
 namespace skyline::soc::gm20b::engine {
@@ -10,6 +11,7 @@ namespace skyline::soc::gm20b::engine {
 
     /**
      * @brief The MacroInterpreter class handles interpreting macros. Macros are small programs that run on the GPU and are used for things like instanced rendering
+     * @note Macros are compiled into threaded code once and cached by their hash so that the opcode decoding cost isn't paid on every invocation
      */
     class MacroInterpreter {
       private:
@@ -104,20 +106,67 @@ namespace skyline::soc::gm20b::engine {
         static_assert(sizeof(MethodAddress) == sizeof(u32));
         #pragma pack(pop)
 
+      public:
+        /**
+         * @brief A single pre-decoded macro instruction in threaded code form, all decoding is done during compilation so execution is reduced to a call through the function pointer
+         */
+        struct CompiledInstruction {
+            using Function = void (*)(MacroInterpreter &interpreter, const CompiledInstruction &instruction);
+
+            Function function; //!< The function performing the operation and assignment of the instruction, this is null for branches
+            u8 dest;
+            u8 srcA;
+            u8 srcB;
+            Opcode::AluOperation aluOperation;
+            i32 immediate;
+            u8 srcBit;
+            u8 destBit;
+            u32 mask; //!< The bitfield mask of the instruction
+            bool isBranch;
+            bool branchOnZero;
+            bool noDelay;
+            bool exit;
+            u32 branchTarget; //!< The index of the branch target in the compiled instructions
+        };
+
+        /**
+         * @brief A macro compiled into position-independent threaded code, this covers all instructions that are reachable from its entry point
+         */
+        struct CompiledMacro {
+            std::vector<CompiledInstruction> instructions; //!< A dense copy of all instructions between the lowest and highest reachable ones, followed by a sentinel that throws if execution runs off the end of macro memory
+            u32 entry; //!< The index of the first instruction to execute
+        };
+
+      private:
+        static constexpr size_t MaxCachedMacroCount{0x400}; //!< The maximum amount of compiled macros cached before the cache is cleared on invalidation
+
         span<u32> macroCode; //!< Span pointing to the global macro code memory
+        std::unordered_map<u64, CompiledMacro> compiledMacros; //!< A cache of compiled macros keyed by a hash of their code, identical macros are commonly reuploaded by titles
 
         MacroEngineBase *engine; //!< Pointer to the target engine
-        Opcode *opcode{}; //!< A pointer to the instruction that is currently being executed
         std::array<u32, 8> registers{}; //!< The state of all the general-purpose registers in the macro interpreter
         const u32 *argument{}; //!< A pointer to the argument buffer for the program, it is read from sequentially
         MethodAddress methodAddress{};
         bool carryFlag{}; //!< A flag representing if an arithmetic operation has set the most significant bit
 
+        template<Opcode::Operation Operation, Opcode::AssignmentOperation Assignment>
+        static void ExecuteInstruction(MacroInterpreter &interpreter, const CompiledInstruction &instruction);
+
         /**
-         * @brief Steps forward one macro instruction, including delay slots
-         * @param delayedOpcode The target opcode to be jumped to after executing the instruction
+         * @return The specialized instruction function for the supplied operation and assignment
          */
-        bool Step(Opcode *delayedOpcode = nullptr);
+        template<Opcode::Operation Operation>
+        static CompiledInstruction::Function SelectFunction(Opcode::AssignmentOperation assignment);
+
+        /**
+         * @brief Decodes a single opcode into its threaded code form, branch targets are relative to the supplied base
+         */
+        static CompiledInstruction CompileInstruction(Opcode opcode, size_t index, size_t base, size_t count);
+
+        /**
+         * @brief Executes the instruction in the delay slot of a branch or an exit
+         */
+        void ExecuteDelaySlot(const CompiledInstruction &instruction);
 
         /**
          * @brief Performs an ALU operation on the given source values and returns the result as a u32
@@ -143,8 +192,19 @@ namespace skyline::soc::gm20b::engine {
         MacroInterpreter(span<u32> macroCode);
 
         /**
-         * @brief Executes a GPU macro from macro memory with the given arguments targeting the specified engine
+         * @brief Compiles the macro at the supplied offset in macro memory, if an identical macro has already been compiled then it is reused
+         * @note The returned reference is valid until the next call to Invalidate
+         */
+        const CompiledMacro &Compile(size_t offset);
+
+        /**
+         * @brief Discards any cached compiled macros if the cache has grown too large, this must only be called when no references from Compile are retained
+         */
+        void Invalidate();
+
+        /**
+         * @brief Executes a compiled GPU macro with the given arguments targeting the specified engine
          */
-        void Execute(size_t offset, span<u32> args, MacroEngineBase *targetEngine);
+        void Execute(const CompiledMacro &macro, span<u32> args, MacroEngineBase *targetEngine);
     };
 }
@@ -37,6 +37,10 @@ namespace skyline::soc::gm20b {
             u32 hash;
         };
 
+        /**
+         * @brief The HLE replacements for known driver macros, these are looked up by the XXH32 hash of the first 'size' words of the macro
+         * @note Entries with the same size share a single hash computation so entries should be grouped by size
+         */
         constexpr std::array<HleFunctionInfo, 0x3> functions{{
             {DrawInstanced, 0x12, 0x6F0DD310},
             {DrawIndexedInstanced, 0x17, 0x2764C4F},
@@ -44,13 +48,19 @@ namespace skyline::soc::gm20b {
         }};
 
         static Function LookupFunction(span<u32> code) {
+            u64 hashedSize{};
+            u32 hash{};
             for (const auto &function : functions) {
                 if (function.size > code.size())
                     continue;
 
-                auto macro{code.subspan(0, function.size)};
+                if (function.size != hashedSize) {
+                    auto macro{code.subspan(0, function.size)};
+                    hash = XXH32(macro.data(), macro.size_bytes(), 0);
+                    hashedSize = function.size;
+                }
 
-                if (XXH32(code.data(), code.size_bytes(), 0) == function.hash)
+                if (hash == function.hash)
                     return function.function;
             }
 
@@ -67,6 +77,8 @@ namespace skyline::soc::gm20b {
 
         if (invalidatePending) {
             macroHleFunctions.fill({});
+            compiledMacros.fill(nullptr);
+            macroInterpreter.Invalidate();
             invalidatePending = false;
         }
 
@@ -77,9 +89,14 @@ namespace skyline::soc::gm20b {
             hleEntry.valid = true;
         }
 
-        if (macroHleFunctions[position].function)
+        if (macroHleFunctions[position].function) {
             macroHleFunctions[position].function(offset, args, targetEngine);
-        else
-            macroInterpreter.Execute(offset, args, targetEngine);
+        } else {
+            auto &compiledMacro{compiledMacros[position]};
+            if (!compiledMacro)
+                compiledMacro = &macroInterpreter.Compile(offset);
+
+            macroInterpreter.Execute(*compiledMacro, args, targetEngine);
+        }
     }
 }
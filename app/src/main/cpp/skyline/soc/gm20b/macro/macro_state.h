@@ -24,6 +24,7 @@ namespace skyline::soc::gm20b {
         std::array<u32, 0x2000> macroCode{}; //!< Stores GPU macros, writes to it will wraparound on overflow
         std::array<size_t, 0x80> macroPositions{}; //!< The positions of each individual macro in macro code memory, there can be a maximum of 0x80 macros at any one time
         std::array<MacroHleEntry, 0x80> macroHleFunctions{}; //!< The HLE functions for each macro position, used to optionally override the interpreter
+        std::array<const engine::MacroInterpreter::CompiledMacro *, 0x80> compiledMacros{}; //!< The compiled macro for each macro position, this is null if the macro hasn't been compiled since the last invalidation
         bool invalidatePending{};
 
         MacroState() : macroInterpreter(macroCode) {}
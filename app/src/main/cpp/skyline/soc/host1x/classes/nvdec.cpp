@@ -1,13 +1,119 @@
 // SPDX-License-Identifier: MPL-2.0
 // Copyright © 2021 Skyline Team and Contributors (https://github.com/skyline-emu/)
 
+#include <common/trace.h>
+#include <soc.h>
+#include "nvdec/h264.h"
 #include "nvdec.h"
 
 namespace skyline::soc::host1x {
-    NvDecClass::NvDecClass(std::function<void()> opDoneCallback)
-        : opDoneCallback(std::move(opDoneCallback)) {}
+    namespace nvdec {
+        /**
+         * @note These are the method addresses in words, as set by THI Method0
+         */
+        enum class Method : u32 {
+            SetCodecId = 0x80,
+            Execute = 0xC0,
+            SetPictureInfoOffset = 0x100,
+            SetBitstreamOffset = 0x101,
+            SetSurfaceLumaOffset = 0x10B, //!< The first of the luma offsets for all output surfaces
+            SetSurfaceChromaOffset = 0x11C, //!< The first of the chroma offsets for all output surfaces
+        };
+
+        constexpr u32 SurfaceOffsetShift{8}; //!< The amount of bits that surface and structure offsets are shifted right by
+        constexpr u32 MacroblockSize{16}; //!< The width and height of a H.264 macroblock in texels
+        constexpr u32 PitchAlignment{0x100}; //!< The alignment of the pitch of pitch-linear surfaces in bytes, this matches VIC
+        constexpr u32 MaxBitstreamSize{0x2000000}; //!< The largest bitstream that'll be read for a single frame, this is far beyond the size of any real frame and bounds allocations driven by the guest-supplied length
+    }
+
+    NvDecClass::NvDecClass(const DeviceState &state, std::function<void()> opDoneCallback)
+        : state(state),
+          opDoneCallback(std::move(opDoneCallback)) {}
+
+    void NvDecClass::DecodeH264() {
+        using namespace nvdec;
+        TRACE_EVENT("gpu", "NvDecClass::DecodeH264");
+
+        auto &smmu{state.soc->smmu};
+        auto info{smmu.Read<h264::PictureInfo>(static_cast<u32>(pictureInfoOffset))};
+        const auto &params{info.parameterSet};
+
+        if (params.currentPictureIndex >= SurfaceCount) {
+            Logger::Warn("H.264 frame has an invalid output surface index: {}", static_cast<u32>(params.currentPictureIndex));
+            return;
+        }
+
+        if (info.streamLength > MaxBitstreamSize) {
+            Logger::Warn("H.264 frame has an invalid bitstream length: 0x{:X}", info.streamLength);
+            return;
+        }
+
+        bitstream.resize(info.streamLength);
+        smmu.Read(bitstream.data(), static_cast<u32>(bitstreamOffset), info.streamLength);
+        h264::ComposeFrame(info, bitstream, frame);
+
+        u32 width{params.picWidthInMbs * MacroblockSize}, height{params.frameHeightInMbs * MacroblockSize};
+        OutputSurface surface{
+            .lumaOffset = surfaceLumaOffsets[params.currentPictureIndex],
+            .chromaOffset = surfaceChromaOffsets[params.currentPictureIndex],
+            .width = width,
+            .height = height,
+            .blockLinear = params.tileFormat != 0,
+            .gobBlockHeight = 1U << params.gobHeightLog2,
+            .lumaPitch = params.pitchLuma ? params.pitchLuma : util::AlignUp(width, PitchAlignment),
+            .chromaPitch = params.pitchChroma ? params.pitchChroma : util::AlignUp(width, PitchAlignment),
+        };
+
+        if (!h264Decoder)
+            h264Decoder.emplace(state, "video/avc");
+        h264Decoder->Decode(frame, width, height, surface);
+    }
+
+    void NvDecClass::Execute() {
+        switch (codec) {
+            case Codec::H264:
+                DecodeH264();
+                break;
+            default:
+                // VP9 and VP8 frames require reconstructing their uncompressed headers and probability tables which isn't implemented
+                if (!warnedUnsupportedCodec) {
+                    Logger::Warn("Unsupported NVDEC codec: 0x{:X}", static_cast<u32>(codec));
+                    warnedUnsupportedCodec = true;
+                }
+                break;
+        }
+    }
 
     void NvDecClass::CallMethod(u32 method, u32 argument) {
-        Logger::Warn("Unknown NVDEC class method called: 0x{:X} argument: 0x{:X}", method, argument);
+        using namespace nvdec;
+        u64 offset{static_cast<u64>(argument) << SurfaceOffsetShift};
+
+        if (method >= static_cast<u32>(Method::SetSurfaceLumaOffset) && method < static_cast<u32>(Method::SetSurfaceLumaOffset) + SurfaceCount) {
+            surfaceLumaOffsets[method - static_cast<u32>(Method::SetSurfaceLumaOffset)] = offset;
+            return;
+        } else if (method >= static_cast<u32>(Method::SetSurfaceChromaOffset) && method < static_cast<u32>(Method::SetSurfaceChromaOffset) + SurfaceCount) {
+            surfaceChromaOffsets[method - static_cast<u32>(Method::SetSurfaceChromaOffset)] = offset;
+            return;
+        }
+
+        switch (static_cast<Method>(method)) {
+            case Method::SetCodecId:
+                codec = static_cast<Codec>(argument);
+                warnedUnsupportedCodec = false;
+                break;
+            case Method::Execute:
+                Execute();
+                opDoneCallback();
+                break;
+            case Method::SetPictureInfoOffset:
+                pictureInfoOffset = offset;
+                break;
+            case Method::SetBitstreamOffset:
+                bitstreamOffset = offset;
+                break;
+            default:
+                Logger::Debug("Unknown NVDEC class method called: 0x{:X} argument: 0x{:X}", method, argument);
+                break;
+        }
     }
 }
@@ -4,17 +4,50 @@
 #pragma once
 
 #include <common.h>
+#include "nvdec/media_codec.h"
 
 namespace skyline::soc::host1x {
     /**
      * @brief The NVDEC Host1x class implements hardware accelerated video decoding for the VP9/VP8/H264/VC1 codecs
+     * @note Only H.264 is supported, frames are decoded by the host's hardware decoder through MediaCodec and written into the guest output surfaces which VIC consumes
      */
     class NvDecClass {
       private:
+        const DeviceState &state;
         std::function<void()> opDoneCallback;
 
+        static constexpr size_t SurfaceCount{17}; //!< The amount of output surfaces that can be bound, this is the maximum size of the H.264 DPB with the current frame
+
+        /**
+         * @brief The codecs which NVDEC can decode, as set by the SetCodecId method
+         */
+        enum class Codec : u32 {
+            None = 0x0,
+            H264 = 0x3,
+            Vp8 = 0x5,
+            Vp9 = 0x9,
+        };
+
+        Codec codec{Codec::None};
+        u64 pictureInfoOffset{}; //!< The SMMU address of the codec-specific structure describing the frame to be decoded
+        u64 bitstreamOffset{}; //!< The SMMU address of the frame's bitstream
+        std::array<u64, SurfaceCount> surfaceLumaOffsets{};
+        std::array<u64, SurfaceCount> surfaceChromaOffsets{};
+
+        std::optional<nvdec::MediaCodecDecoder> h264Decoder; //!< The host decoder for H.264 streams, this is created lazily
+        std::vector<u8> bitstream; //!< A scratch buffer for the guest bitstream of a frame
+        std::vector<u8> frame; //!< A scratch buffer for the host bitstream of a frame
+        bool warnedUnsupportedCodec{}; //!< If a warning about the current codec being unsupported has been logged, this avoids logging for every frame
+
+        /**
+         * @brief Decodes the frame described by the picture info structure
+         */
+        void Execute();
+
+        void DecodeH264();
+
       public:
-        NvDecClass(std::function<void()> opDoneCallback);
+        NvDecClass(const DeviceState &state, std::function<void()> opDoneCallback);
 
         void CallMethod(u32 method, u32 argument);
     };
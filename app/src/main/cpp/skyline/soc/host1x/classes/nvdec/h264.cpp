@@ -0,0 +1,178 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#include "h264.h"
+
+namespace skyline::soc::host1x::nvdec::h264 {
+    namespace {
+        constexpr std::array<u8, 16> ZigZagScan4x4{0, 1, 4, 8, 5, 2, 3, 6, 9, 12, 13, 10, 7, 11, 14, 15}; //!< Maps the zig-zag order of a 4x4 scaling list to its raster order
+        constexpr std::array<u8, 64> ZigZagScan8x8{
+            0, 1, 8, 16, 9, 2, 3, 10, 17, 24, 32, 25, 18, 11, 4, 5,
+            12, 19, 26, 33, 40, 48, 41, 34, 27, 20, 13, 6, 7, 14, 21, 28,
+            35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23, 30, 37, 44, 51,
+            58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63,
+        };
+
+        constexpr u8 ProfileIdcHigh{100}; //!< The High profile is a superset of all profiles NVN can encode streams for
+        constexpr u8 LevelIdc{41}; //!< Level 4.1 covers 1080p streams and is supported by practically all host decoders
+        constexpr u32 MaxNumRefFrames{16}; //!< The amount of reference frames isn't passed to NVDEC, the maximum ensures any stream can be decoded
+
+        /**
+         * @brief Writes the RBSP of a NAL unit with emulation prevention, preceded by a start code and the NAL header
+         */
+        class NalWriter {
+          private:
+            std::vector<u8> &output;
+            u32 bitBuffer{}; //!< The bits which have yet to be written into the output, these are right-aligned
+            u8 bitCount{}; //!< The amount of valid bits in the bit buffer
+            u8 zeroCount{}; //!< The amount of consecutive zero bytes at the end of the output, used to insert emulation prevention bytes
+
+            void PushByte(u8 byte) {
+                if (zeroCount == 2 && byte <= 3) {
+                    output.push_back(3);
+                    zeroCount = 0;
+                }
+                output.push_back(byte);
+                zeroCount = byte ? 0 : static_cast<u8>(zeroCount + 1);
+            }
+
+          public:
+            NalWriter(std::vector<u8> &output, u8 nalRefIdc, u8 nalUnitType) : output{output} {
+                constexpr std::array<u8, 4> StartCode{0, 0, 0, 1};
+                output.insert(output.end(), StartCode.begin(), StartCode.end());
+                output.push_back(static_cast<u8>((nalRefIdc << 5) | nalUnitType));
+            }
+
+            /**
+             * @brief Writes the lowest `count` bits of the value with the most significant bit first, count must be 24 or less
+             */
+            void WriteBits(u32 value, u8 count) {
+                bitBuffer = (bitBuffer << count) | (value & ((1U << count) - 1));
+                bitCount += count;
+                while (bitCount >= 8) {
+                    bitCount -= 8;
+                    PushByte(static_cast<u8>(bitBuffer >> bitCount));
+                }
+            }
+
+            void WriteBit(bool value) {
+                WriteBits(value ? 1 : 0, 1);
+            }
+
+            /**
+             * @brief Writes an unsigned Exp-Golomb code (ue(v))
+             */
+            void WriteUe(u32 value) {
+                u32 codeNum{value + 1};
+                u8 length{static_cast<u8>(std::bit_width(codeNum))};
+                WriteBits(0, static_cast<u8>(length - 1));
+                WriteBits(codeNum, length);
+            }
+
+            /**
+             * @brief Writes a signed Exp-Golomb code (se(v))
+             */
+            void WriteSe(i32 value) {
+                WriteUe(value > 0 ? static_cast<u32>(value) * 2 - 1 : static_cast<u32>(-value) * 2);
+            }
+
+            /**
+             * @brief Writes a scaling list from its raster order contents, every entry is delta coded against the previous one in zig-zag order
+             */
+            void WriteScalingList(span<const u8> list, span<const u8> scan) {
+                WriteBit(true); // scaling_list_present_flag
+                u8 lastScale{8};
+                for (u8 index : scan) {
+                    u8 scale{list[index]};
+                    WriteSe(static_cast<i8>(scale - lastScale));
+                    lastScale = scale;
+                }
+            }
+
+            /**
+             * @brief Writes the RBSP trailing bits, this must be called after everything else has been written
+             */
+            void Finish() {
+                WriteBit(true);
+                if (bitCount)
+                    WriteBits(0, static_cast<u8>(8 - bitCount));
+            }
+        };
+    }
+
+    void ComposeFrame(const PictureInfo &info, span<const u8> bitstream, std::vector<u8> &output) {
+        const auto &params{info.parameterSet};
+        output.clear();
+
+        {
+            NalWriter sps{output, 3, 7};
+            sps.WriteBits(ProfileIdcHigh, 8);
+            sps.WriteBits(0, 8); // constraint_set_flags and reserved_zero_2bits
+            sps.WriteBits(LevelIdc, 8);
+            sps.WriteUe(0); // seq_parameter_set_id
+            sps.WriteUe(static_cast<u32>(params.chromaFormatIdc));
+            if (params.chromaFormatIdc == 3)
+                sps.WriteBit(false); // separate_colour_plane_flag
+            sps.WriteUe(0); // bit_depth_luma_minus8
+            sps.WriteUe(0); // bit_depth_chroma_minus8
+            sps.WriteBit(false); // qpprime_y_zero_transform_bypass_flag
+            sps.WriteBit(false); // seq_scaling_matrix_present_flag, the scaling lists are always supplied in the PPS
+            sps.WriteUe(static_cast<u32>(params.log2MaxFrameNumMinus4));
+            sps.WriteUe(static_cast<u32>(params.picOrderCntType));
+            if (params.picOrderCntType == 0) {
+                sps.WriteUe(static_cast<u32>(params.log2MaxPicOrderCntLsbMinus4));
+            } else if (params.picOrderCntType == 1) {
+                // NVN doesn't support encoding streams with a POC type of 1, the offsets are unavailable and zeroed
+                sps.WriteBit(params.deltaPicOrderAlwaysZeroFlag != 0);
+                sps.WriteSe(0); // offset_for_non_ref_pic
+                sps.WriteSe(0); // offset_for_top_to_bottom_field
+                sps.WriteUe(0); // num_ref_frames_in_pic_order_cnt_cycle
+            }
+            sps.WriteUe(MaxNumRefFrames);
+            sps.WriteBit(false); // gaps_in_frame_num_value_allowed_flag
+            sps.WriteUe(params.picWidthInMbs - 1);
+            sps.WriteUe((params.frameHeightInMbs / (params.frameMbsOnlyFlag ? 1 : 2)) - 1); // pic_height_in_map_units_minus1
+            sps.WriteBit(params.frameMbsOnlyFlag != 0);
+            if (!params.frameMbsOnlyFlag)
+                sps.WriteBit(params.mbaffFrameFlag);
+            sps.WriteBit(params.direct8x8InferenceFlag);
+            sps.WriteBit(false); // frame_cropping_flag, the output surfaces are always macroblock aligned and cropping is performed by VIC
+            sps.WriteBit(false); // vui_parameters_present_flag
+            sps.Finish();
+        }
+
+        {
+            NalWriter pps{output, 3, 8};
+            pps.WriteUe(0); // pic_parameter_set_id
+            pps.WriteUe(0); // seq_parameter_set_id
+            pps.WriteBit(params.entropyCodingModeFlag != 0);
+            pps.WriteBit(params.picOrderPresentFlag != 0);
+            pps.WriteUe(0); // num_slice_groups_minus1
+            pps.WriteUe(static_cast<u32>(params.numRefIdxL0DefaultActive - 1));
+            pps.WriteUe(static_cast<u32>(params.numRefIdxL1DefaultActive - 1));
+            pps.WriteBit(params.weightedPredFlag);
+            pps.WriteBits(static_cast<u32>(params.weightedBipredIdc), 2);
+            pps.WriteSe(static_cast<i32>(params.picInitQpMinus26));
+            pps.WriteSe(0); // pic_init_qs_minus26, this only applies to SP/SI slices which aren't supported by the High profile
+            pps.WriteSe(static_cast<i32>(params.chromaQpIndexOffset));
+            pps.WriteBit(params.deblockingFilterControlPresentFlag != 0);
+            pps.WriteBit(params.constrainedIntraPredFlag);
+            pps.WriteBit(params.redundantPicCntPresentFlag != 0);
+            pps.WriteBit(params.transform8x8ModeFlag != 0);
+
+            // The scaling lists are always written as NVDEC receives the final lists regardless of how they were signalled in the original stream
+            pps.WriteBit(true); // pic_scaling_matrix_present_flag
+            for (size_t list{}; list < 6; list++)
+                pps.WriteScalingList(span<const u8>{info.weightScale4x4}.subspan(list * ZigZagScan4x4.size(), ZigZagScan4x4.size()), ZigZagScan4x4);
+            if (params.transform8x8ModeFlag)
+                for (size_t list{}; list < 2; list++)
+                    pps.WriteScalingList(span<const u8>{info.weightScale8x8}.subspan(list * ZigZagScan8x8.size(), ZigZagScan8x8.size()), ZigZagScan8x8);
+
+            pps.WriteSe(static_cast<i32>(params.secondChromaQpIndexOffset));
+            pps.Finish();
+        }
+
+        // The slice data already contains start codes for every slice so it can be appended directly
+        output.insert(output.end(), bitstream.begin(), bitstream.end());
+    }
+}
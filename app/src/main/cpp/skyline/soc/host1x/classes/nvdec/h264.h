@@ -0,0 +1,83 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#pragma once
+
+#include <common.h>
+
+namespace skyline::soc::host1x::nvdec::h264 {
+    /**
+     * @brief The subset of the SPS and PPS of an H.264 stream that NVDEC consumes along with the layout of the output surface
+     * @note NVN parses the parameter sets on the CPU and only passes their contents to NVDEC, the slice data of a frame is passed as-is
+     */
+    struct ParameterSet {
+        i32 log2MaxPicOrderCntLsbMinus4;
+        i32 deltaPicOrderAlwaysZeroFlag;
+        i32 frameMbsOnlyFlag;
+        u32 picWidthInMbs;
+        u32 frameHeightInMbs; //!< The height of a frame in macroblocks, this is twice the height in map units for field coded streams
+        u32 tileFormat : 2; //!< 0 for pitch-linear output surfaces, block-linear otherwise
+        u32 gobHeightLog2 : 3; //!< The log2 of the height of a block in GOBs for block-linear output surfaces
+        u32 _pad0_ : 27;
+        u32 entropyCodingModeFlag;
+        i32 picOrderPresentFlag; //!< The bottom_field_pic_order_in_frame_present_flag of the PPS
+        i32 numRefIdxL0DefaultActive;
+        i32 numRefIdxL1DefaultActive;
+        i32 deblockingFilterControlPresentFlag;
+        i32 redundantPicCntPresentFlag;
+        u32 transform8x8ModeFlag;
+        u32 pitchLuma; //!< The pitch of the luma plane of pitch-linear output surfaces in bytes
+        u32 pitchChroma;
+        u32 lumaTopOffset;
+        u32 lumaBottomOffset;
+        u32 lumaFrameOffset;
+        u32 chromaTopOffset;
+        u32 chromaBottomOffset;
+        u32 chromaFrameOffset;
+        u32 histBufferSize;
+        u64 mbaffFrameFlag : 1;
+        u64 direct8x8InferenceFlag : 1;
+        u64 weightedPredFlag : 1;
+        u64 constrainedIntraPredFlag : 1;
+        u64 refPicFlag : 1;
+        u64 fieldPicFlag : 1;
+        u64 bottomFieldFlag : 1;
+        u64 secondFieldFlag : 1;
+        u64 log2MaxFrameNumMinus4 : 4;
+        u64 chromaFormatIdc : 2;
+        u64 picOrderCntType : 2;
+        i64 picInitQpMinus26 : 6;
+        i64 chromaQpIndexOffset : 5;
+        i64 secondChromaQpIndexOffset : 5;
+        u64 weightedBipredIdc : 2;
+        u64 currentPictureIndex : 7; //!< The index of the surface which the frame is decoded into
+        u64 currentColocatedIndex : 5;
+        u64 frameNumber : 16;
+        u64 frameSurfaces : 1;
+        u64 outputMemoryLayout : 1;
+    };
+    static_assert(sizeof(ParameterSet) == 0x60);
+
+    /**
+     * @brief The structure at the picture info offset which describes the H.264 frame to be decoded
+     */
+    struct PictureInfo {
+        u32 _pad0_[18];
+        u32 streamLength; //!< The size of the frame's bitstream in bytes
+        u32 _pad1_[3];
+        ParameterSet parameterSet;
+        u32 _pad2_[66];
+        std::array<u8, 0x60> weightScale4x4; //!< The six 4x4 scaling lists in raster order
+        std::array<u8, 0x80> weightScale8x8; //!< The two 8x8 scaling lists in raster order
+    };
+    static_assert(offsetof(PictureInfo, parameterSet) == 0x58);
+    static_assert(offsetof(PictureInfo, weightScale4x4) == 0x1C0);
+    static_assert(sizeof(PictureInfo) == 0x2A0);
+
+    /**
+     * @brief Reconstructs an Annex B access unit from the picture info and slice data of a frame, this is what a regular H.264 decoder consumes
+     * @param output The vector to write the access unit into, it's reused across frames to avoid allocations
+     * @note The SPS and PPS are written in front of every frame as NVDEC has no concept of them, every set uses an ID of 0 and overwrites the previous one
+     */
+    void ComposeFrame(const PictureInfo &info, span<const u8> bitstream, std::vector<u8> &output);
+}
@@ -0,0 +1,219 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#include <media/NdkMediaCodec.h>
+#include <common/trace.h>
+#include <gpu/texture/layout.h>
+#include <soc.h>
+#include "media_codec.h"
+
+namespace skyline::soc::host1x::nvdec {
+    namespace {
+        /**
+         * @brief The subset of MediaCodecInfo.CodecCapabilities colour formats which have a well-defined layout in ByteBuffer output mode
+         */
+        enum class ColorFormat : i32 {
+            Yuv420Planar = 19, //!< I420
+            Yuv420SemiPlanar = 21, //!< NV12
+            Yuv420Flexible = 0x7F420888, //!< The layout is implementation-defined, practically all decoders use NV12 for this in ByteBuffer mode
+        };
+
+        constexpr const char *LowLatencyKey{"low-latency"}; //!< AMEDIAFORMAT_KEY_LOW_LATENCY, this is only defined from API 30 onwards but older decoders ignore unknown keys
+    }
+
+    MediaCodecDecoder::MediaCodecDecoder(const DeviceState &state, const char *mimeType) : state{state}, mimeType{mimeType} {}
+
+    MediaCodecDecoder::~MediaCodecDecoder() {
+        Release();
+    }
+
+    void MediaCodecDecoder::Release() {
+        if (codec) {
+            AMediaCodec_stop(codec);
+            AMediaCodec_delete(codec);
+            codec = nullptr;
+        }
+        pendingFrames.clear();
+    }
+
+    void MediaCodecDecoder::Configure(u32 pWidth, u32 pHeight) {
+        Release();
+        width = pWidth;
+        height = pHeight;
+        failed = true;
+
+        codec = AMediaCodec_createDecoderByType(mimeType);
+        if (!codec) {
+            Logger::Error("Failed to create a host decoder for '{}'", mimeType);
+            return;
+        }
+
+        auto format{AMediaFormat_new()};
+        AMediaFormat_setString(format, AMEDIAFORMAT_KEY_MIME, mimeType);
+        AMediaFormat_setInt32(format, AMEDIAFORMAT_KEY_WIDTH, static_cast<i32>(width));
+        AMediaFormat_setInt32(format, AMEDIAFORMAT_KEY_HEIGHT, static_cast<i32>(height));
+        AMediaFormat_setInt32(format, AMEDIAFORMAT_KEY_COLOR_FORMAT, static_cast<i32>(ColorFormat::Yuv420SemiPlanar));
+        AMediaFormat_setInt32(format, LowLatencyKey, 1);
+
+        // No output surface is used as the frames need to end up in guest memory for VIC to consume them
+        auto result{AMediaCodec_configure(codec, format, nullptr, nullptr, 0)};
+        AMediaFormat_delete(format);
+        if (result != AMEDIA_OK || (result = AMediaCodec_start(codec)) != AMEDIA_OK) {
+            Logger::Error("Failed to start a host decoder for '{}' at {}x{}: {}", mimeType, width, height, static_cast<i32>(result));
+            AMediaCodec_delete(codec);
+            codec = nullptr;
+            return;
+        }
+
+        // These are the defaults until the decoder signals the actual output format
+        colorFormat = static_cast<i32>(ColorFormat::Yuv420SemiPlanar);
+        stride = static_cast<i32>(width);
+        sliceHeight = static_cast<i32>(height);
+        failed = false;
+    }
+
+    void MediaCodecDecoder::DrainOutput(bool block) {
+        AMediaCodecBufferInfo info;
+        while (true) {
+            ssize_t index{AMediaCodec_dequeueOutputBuffer(codec, &info, block ? OutputTimeoutUs : 0)};
+            if (index == AMEDIACODEC_INFO_OUTPUT_FORMAT_CHANGED) {
+                auto format{AMediaCodec_getOutputFormat(codec)};
+                AMediaFormat_getInt32(format, AMEDIAFORMAT_KEY_COLOR_FORMAT, &colorFormat);
+                if (!AMediaFormat_getInt32(format, AMEDIAFORMAT_KEY_STRIDE, &stride) || !stride)
+                    stride = static_cast<i32>(width);
+                if (!AMediaFormat_getInt32(format, AMEDIAFORMAT_KEY_SLICE_HEIGHT, &sliceHeight) || !sliceHeight)
+                    sliceHeight = static_cast<i32>(height);
+                AMediaFormat_delete(format);
+                continue;
+            } else if (index == AMEDIACODEC_INFO_OUTPUT_BUFFERS_CHANGED) {
+                continue;
+            } else if (index < 0) {
+                return; // AMEDIACODEC_INFO_TRY_AGAIN_LATER
+            }
+
+            auto pending{pendingFrames.find(info.presentationTimeUs)};
+            if (pending != pendingFrames.end()) {
+                size_t size;
+                u8 *buffer{AMediaCodec_getOutputBuffer(codec, static_cast<size_t>(index), &size)};
+                if (buffer && info.size > 0)
+                    WriteFrame(buffer + info.offset, static_cast<size_t>(info.size), pending->second);
+                pendingFrames.erase(pending);
+            }
+
+            AMediaCodec_releaseOutputBuffer(codec, static_cast<size_t>(index), false);
+            block = false;
+        }
+    }
+
+    void MediaCodecDecoder::WriteFrame(const u8 *data, size_t size, const OutputSurface &surface) {
+        TRACE_EVENT("gpu", "MediaCodecDecoder::WriteFrame");
+
+        bool planar;
+        switch (static_cast<ColorFormat>(colorFormat)) {
+            case ColorFormat::Yuv420Planar:
+                planar = true;
+                break;
+            case ColorFormat::Yuv420SemiPlanar:
+            case ColorFormat::Yuv420Flexible:
+                planar = false;
+                break;
+            default:
+                Logger::Warn("Unsupported host decoder output colour format: 0x{:X}", colorFormat);
+                return;
+        }
+
+        // The decoded frame is first converted into tightly packed NV12 with the dimensions of the surface
+        u32 copyWidth{std::min(surface.width, width)}, copyHeight{std::min(surface.height, height)};
+        size_t lumaSize{static_cast<size_t>(surface.width) * surface.height}, chromaLineCount{surface.height / 2U};
+        linearBuffer.resize(lumaSize + (static_cast<size_t>(surface.width) * chromaLineCount));
+
+        size_t lumaPlaneSize{static_cast<size_t>(stride) * static_cast<size_t>(sliceHeight)};
+        size_t chromaStride{planar ? static_cast<size_t>(stride) / 2 : static_cast<size_t>(stride)};
+        size_t requiredSize{lumaPlaneSize + (planar ? chromaStride * (static_cast<size_t>(sliceHeight) / 2) : 0) + (chromaStride * ((copyHeight / 2) - 1)) + (planar ? copyWidth / 2 : copyWidth)};
+        if (size < requiredSize) {
+            Logger::Warn("Host decoder output buffer is smaller than expected: 0x{:X} < 0x{:X}", size, requiredSize);
+            return;
+        }
+
+        for (u32 line{}; line < copyHeight; line++)
+            std::memcpy(linearBuffer.data() + (static_cast<size_t>(line) * surface.width), data + (static_cast<size_t>(line) * static_cast<size_t>(stride)), copyWidth);
+
+        u8 *chroma{linearBuffer.data() + lumaSize};
+        const u8 *chromaU{data + lumaPlaneSize};
+        const u8 *chromaV{chromaU + (chromaStride * (static_cast<size_t>(sliceHeight) / 2))};
+        for (u32 line{}; line < copyHeight / 2; line++) {
+            u8 *output{chroma + (static_cast<size_t>(line) * surface.width)};
+            size_t inputOffset{line * chromaStride};
+            if (planar) {
+                for (u32 texel{}; texel < copyWidth / 2; texel++) {
+                    output[texel * 2] = chromaU[inputOffset + texel];
+                    output[(texel * 2) + 1] = chromaV[inputOffset + texel];
+                }
+            } else {
+                std::memcpy(output, chromaU + inputOffset, copyWidth);
+            }
+        }
+
+        // Both planes are then written into guest memory in the layout of the surface, rows have the same size in bytes for both of them
+        auto writePlane{[&](u8 *linear, u32 lineCount, u64 offset, u32 pitch) {
+            if (surface.blockLinear) {
+                gpu::texture::Dimensions dimensions{surface.width, lineCount, 1};
+                guestBuffer.resize(gpu::texture::GetBlockLinearLayerSize(dimensions, 1, 1, 1, surface.gobBlockHeight, 1));
+                gpu::texture::CopyLinearToBlockLinear(dimensions, 1, 1, 1, surface.gobBlockHeight, 1, linear, guestBuffer.data());
+            } else {
+                guestBuffer.resize(static_cast<size_t>(pitch) * lineCount);
+                for (u32 line{}; line < lineCount; line++)
+                    std::memcpy(guestBuffer.data() + (static_cast<size_t>(line) * pitch), linear + (static_cast<size_t>(line) * surface.width), surface.width);
+            }
+
+            state.soc->smmu.Write(static_cast<u32>(offset), guestBuffer.data(), static_cast<u32>(guestBuffer.size()));
+        }};
+
+        writePlane(linearBuffer.data(), surface.height, surface.lumaOffset, surface.lumaPitch);
+        writePlane(chroma, static_cast<u32>(chromaLineCount), surface.chromaOffset, surface.chromaPitch);
+    }
+
+    void MediaCodecDecoder::Decode(span<const u8> frame, u32 pWidth, u32 pHeight, const OutputSurface &surface) {
+        TRACE_EVENT("gpu", "MediaCodecDecoder::Decode");
+
+        if (pWidth != width || pHeight != height)
+            Configure(pWidth, pHeight);
+        if (failed)
+            return;
+
+        ssize_t index{AMediaCodec_dequeueInputBuffer(codec, InputTimeoutUs)};
+        if (index < 0) {
+            // The decoder can only be starved of input buffers if it isn't returning output buffers, draining them should free one up
+            DrainOutput(true);
+            index = AMediaCodec_dequeueInputBuffer(codec, InputTimeoutUs);
+            if (index < 0) {
+                Logger::Warn("Host decoder has no input buffers available, dropping frame");
+                return;
+            }
+        }
+
+        size_t capacity;
+        u8 *buffer{AMediaCodec_getInputBuffer(codec, static_cast<size_t>(index), &capacity)};
+        if (!buffer || capacity < frame.size()) {
+            Logger::Warn("Host decoder input buffer is too small for frame: 0x{:X} < 0x{:X}", buffer ? capacity : 0, frame.size());
+            AMediaCodec_queueInputBuffer(codec, static_cast<size_t>(index), 0, 0, 0, 0);
+            return;
+        }
+
+        std::memcpy(buffer, frame.data(), frame.size());
+        i64 timestamp{nextTimestamp++};
+        pendingFrames.emplace(timestamp, surface);
+        AMediaCodec_queueInputBuffer(codec, static_cast<size_t>(index), 0, frame.size(), static_cast<u64>(timestamp), 0);
+
+        // NVDEC only signals completion once the frame is in its surface, so the decoder is waited on until it outputs this frame to avoid the guest reading a stale surface
+        // Decoders which reorder output may hold onto the frame until more input arrives, the wait is bounded for these and the frame is written whenever it's eventually output
+        auto deadline{util::GetTimeNs() + (FrameTimeoutUs * 1000)};
+        do {
+            DrainOutput(true);
+        } while (pendingFrames.contains(timestamp) && util::GetTimeNs() < deadline);
+
+        // Frames which the decoder dropped would otherwise never leave the pending set, the oldest ones are discarded once it grows too large
+        while (pendingFrames.size() > MaxPendingFrames)
+            pendingFrames.erase(std::min_element(pendingFrames.begin(), pendingFrames.end(), [](const auto &a, const auto &b) { return a.first < b.first; }));
+    }
+}
@@ -0,0 +1,81 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2022 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#pragma once
+
+#include <unordered_map>
+#include <common.h>
+
+struct AMediaCodec;
+
+namespace skyline::soc::host1x::nvdec {
+    /**
+     * @brief The layout of an NV12 output surface in SMMU memory which a decoded frame is written into
+     */
+    struct OutputSurface {
+        u64 lumaOffset;
+        u64 chromaOffset;
+        u32 width; //!< The width of the surface in texels, this is macroblock aligned
+        u32 height;
+        bool blockLinear;
+        u32 gobBlockHeight; //!< The height of a block in GOBs for block-linear surfaces
+        u32 lumaPitch; //!< The pitch of the luma plane in bytes for pitch-linear surfaces
+        u32 chromaPitch;
+    };
+
+    /**
+     * @brief A wrapper around an Android MediaCodec decoder that decodes frames on the host's hardware video decoder and writes the output into guest surfaces
+     * @note Decoding a frame waits for the decoder to output it into the corresponding guest surface, decoders that reorder output can only be waited on for a bounded time after which the frame is written once it's returned
+     */
+    class MediaCodecDecoder {
+      private:
+        const DeviceState &state;
+        const char *mimeType;
+        AMediaCodec *codec{};
+        u32 width{}, height{}; //!< The dimensions the decoder was configured with
+        bool failed{}; //!< If creating the decoder failed for the current dimensions, decoding is skipped rather than retried for every frame
+
+        i32 colorFormat{}; //!< The MediaCodec colour format of output buffers
+        i32 stride{}; //!< The stride of output buffers in bytes
+        i32 sliceHeight{}; //!< The amount of rows in the luma plane of output buffers, the chroma planes follow this
+
+        i64 nextTimestamp{}; //!< The presentation timestamp of the next frame, these are only used to match output buffers to their surfaces
+        std::unordered_map<i64, OutputSurface> pendingFrames; //!< The surfaces of frames that were submitted to the decoder but have yet to be output
+        std::vector<u8> linearBuffer; //!< A scratch buffer for a frame in tightly packed NV12
+        std::vector<u8> guestBuffer; //!< A scratch buffer for a single plane of a frame in its guest layout
+
+        static constexpr size_t MaxPendingFrames{16}; //!< The amount of frames that can be pending before the oldest ones are assumed to have been dropped by the decoder
+        static constexpr i64 InputTimeoutUs{100'000}; //!< The maximum time to wait for an input buffer to become available
+        static constexpr i64 OutputTimeoutUs{10'000}; //!< The maximum time to wait for a single output buffer
+        static constexpr i64 FrameTimeoutUs{50'000}; //!< The maximum time to wait for a submitted frame to be output before returning to the guest
+
+        /**
+         * @brief Creates and starts a decoder for streams of the supplied dimensions, releasing any prior decoder
+         */
+        void Configure(u32 width, u32 height);
+
+        void Release();
+
+        /**
+         * @brief Writes all output buffers which are available into their guest surfaces
+         * @param block If to wait for at least a single output buffer to become available
+         */
+        void DrainOutput(bool block);
+
+        /**
+         * @brief Converts a decoded frame to NV12 in the guest layout of the surface and writes it into guest memory
+         */
+        void WriteFrame(const u8 *data, size_t size, const OutputSurface &surface);
+
+      public:
+        MediaCodecDecoder(const DeviceState &state, const char *mimeType);
+
+        ~MediaCodecDecoder();
+
+        /**
+         * @brief Decodes a single access unit into the supplied surface, this blocks until the decoder outputs the frame or `FrameTimeoutUs` elapses
+         * @param width The width of the frame in texels, the decoder is reconfigured if this changes
+         */
+        void Decode(span<const u8> frame, u32 width, u32 height, const OutputSurface &surface);
+    };
+}
@@ -1,13 +1,291 @@
 // SPDX-License-Identifier: MPL-2.0
 // Copyright © 2021 Skyline Team and Contributors (https://github.com/skyline-emu/)
 
+#include <common/trace.h>
+#include <gpu.h>
+#include <gpu/texture/layout.h>
+#include <soc.h>
 #include "vic.h"
 
 namespace skyline::soc::host1x {
-    VicClass::VicClass(std::function<void()> opDoneCallback)
-        : opDoneCallback(std::move(opDoneCallback)) {}
+    namespace vic {
+        /**
+         * @note These are the method addresses in words, as set by THI Method0
+         */
+        enum class Method : u32 {
+            Execute = 0xC0,
+            SetSurface0Slot0LumaOffset = 0x100, //!< The first of the surface offsets for all slots, there are 8 surfaces of 3 planes for each slot
+            SetConfigStructOffset = 0x1C2,
+            SetOutputSurfaceLumaOffset = 0x1C8,
+            SetOutputSurfaceChromaUOffset = 0x1C9,
+            SetOutputSurfaceChromaVOffset = 0x1CA,
+        };
+
+        constexpr u32 SlotSurfaceMethodCount{0x18}; //!< The amount of methods for the surfaces of a single slot
+        constexpr u32 SurfaceOffsetShift{8}; //!< The amount of bits that surface and structure offsets are shifted right by
+
+        enum class PixelFormat : u8 {
+            A8B8G8R8 = 0x1F,
+            A8R8G8B8 = 0x20,
+            X8B8G8R8 = 0x23,
+            Y8_V8U8_N420 = 0x44, //!< Semi-planar YUV 4:2:0 with the U component in the lower byte of each chroma texel, this is the format NVDEC outputs
+        };
+
+        /**
+         * @brief The layout of an input or output surface, this is shared between the output surface configuration and the surface configuration of each slot
+         */
+        struct SurfaceConfig {
+            u64 pixelFormat : 7; //!< A PixelFormat
+            u64 chromaLocHoriz : 2;
+            u64 chromaLocVert : 2;
+            u64 blockKind : 4; //!< 0 for pitch-linear surfaces, block-linear otherwise
+            u64 blockHeightLog2 : 4; //!< The log2 of the height of a block in GOBs
+            u64 cacheWidth : 3;
+            u64 _pad0_ : 10;
+            u64 surfaceWidthMinus1 : 14; //!< The width of the visible region of the surface
+            u64 surfaceHeightMinus1 : 14;
+            u64 _pad1_ : 4;
+            u64 lumaWidthMinus1 : 14; //!< The width of the allocated luma (or RGB) plane, this may be larger than the surface
+            u64 lumaHeightMinus1 : 14;
+            u64 _pad2_ : 4;
+            u64 chromaWidthMinus1 : 14;
+            u64 chromaHeightMinus1 : 14;
+            u64 _pad3_ : 4;
+        };
+        static_assert(sizeof(SurfaceConfig) == 0x10);
+
+        constexpr u32 OutputSurfaceConfigOffset{0x20}; //!< The offset of the output SurfaceConfig in the configuration structure
+        constexpr u32 SlotStructOffset{0x90}; //!< The offset of the first slot's structure in the configuration structure
+        constexpr u32 SlotStructSize{0xB0};
+        constexpr u32 SlotSurfaceConfigOffset{0x40}; //!< The offset of the SurfaceConfig in a slot's structure, it's preceded by the slot configuration of which the lowest bit denotes if the slot is enabled
+
+        constexpr u32 PitchAlignment{0x100}; //!< The alignment of the pitch of pitch-linear surfaces in bytes
+        constexpr u32 MaxSurfaceDimension{4096}; //!< The largest width or height of a plane that'll be processed, this matches the largest frames NVDEC can decode and bounds the size of the staging buffer
+
+        /**
+         * @brief The layout of a single plane of a surface in guest memory and in the staging buffer
+         */
+        struct Plane {
+            u32 rowSize; //!< The size of a row of the linear plane in bytes, this is aligned to 4 bytes
+            u32 lineCount;
+            bool blockLinear;
+            u32 gobBlockHeight;
+            vk::DeviceSize guestOffset; //!< The offset of the plane in its guest layout in the staging buffer
+            vk::DeviceSize guestSize;
+            vk::DeviceSize linearOffset; //!< The offset of the linear plane in the staging buffer, this is the same as guestOffset for pitch-linear planes
+
+            /**
+             * @return The stride between rows of the linear plane in bytes
+             */
+            u32 GetPitch() const {
+                return blockLinear ? rowSize : util::AlignUp(rowSize, PitchAlignment);
+            }
+
+            gpu::BlockLinearJob::Level GetLevel() const {
+                return {
+                    .rowSize = rowSize,
+                    .lineCount = lineCount,
+                    .gobBlockHeight = gobBlockHeight,
+                    .layerCount = 1,
+                    .linearOffset = linearOffset,
+                    .linearLayerStride = static_cast<vk::DeviceSize>(rowSize) * lineCount,
+                    .blockLinearOffset = guestOffset,
+                    .blockLinearLayerStride = guestSize,
+                };
+            }
+        };
+    }
+
+    VicClass::VicClass(const DeviceState &state, std::function<void()> opDoneCallback)
+        : state(state),
+          opDoneCallback(std::move(opDoneCallback)) {}
+
+    void VicClass::Execute() {
+        using namespace vic;
+        TRACE_EVENT("gpu", "VicClass::Execute");
+
+        auto &smmu{state.soc->smmu};
+        auto outputConfig{smmu.Read<SurfaceConfig>(static_cast<u32>(configStructOffset + OutputSurfaceConfigOffset))};
+
+        // Only the first enabled slot is composited, blending multiple slots together isn't used for video playback
+        std::optional<size_t> slot;
+        for (size_t index{}; index < SlotCount; index++) {
+            if (smmu.Read<u64>(static_cast<u32>(configStructOffset + SlotStructOffset + (index * SlotStructSize))) & 1) {
+                slot = index;
+                break;
+            }
+        }
+
+        if (!slot) {
+            Logger::Warn("VIC execution without any enabled slots");
+            return;
+        }
+
+        auto inputConfig{smmu.Read<SurfaceConfig>(static_cast<u32>(configStructOffset + SlotStructOffset + (*slot * SlotStructSize) + SlotSurfaceConfigOffset))};
+        if (static_cast<PixelFormat>(inputConfig.pixelFormat) != PixelFormat::Y8_V8U8_N420) {
+            Logger::Warn("Unsupported VIC input pixel format: 0x{:X}", static_cast<u8>(inputConfig.pixelFormat));
+            return;
+        }
+
+        bool swapRedBlue;
+        switch (static_cast<PixelFormat>(outputConfig.pixelFormat)) {
+            case PixelFormat::A8B8G8R8:
+            case PixelFormat::X8B8G8R8:
+                swapRedBlue = false;
+                break;
+            case PixelFormat::A8R8G8B8:
+                swapRedBlue = true;
+                break;
+            default:
+                Logger::Warn("Unsupported VIC output pixel format: 0x{:X}", static_cast<u8>(outputConfig.pixelFormat));
+                return;
+        }
+
+        // The dimensions are validated as the conversion shader writes the entire destination region and the staging buffer is sized by the planes
+        auto validateConfig{[](const SurfaceConfig &config, const char *name) {
+            u32 surfaceWidth{static_cast<u32>(config.surfaceWidthMinus1 + 1)}, surfaceHeight{static_cast<u32>(config.surfaceHeightMinus1 + 1)};
+            u32 lumaWidth{static_cast<u32>(config.lumaWidthMinus1 + 1)}, lumaHeight{static_cast<u32>(config.lumaHeightMinus1 + 1)};
+            if (lumaWidth > MaxSurfaceDimension || lumaHeight > MaxSurfaceDimension || surfaceWidth > lumaWidth || surfaceHeight > lumaHeight) {
+                Logger::Warn("Invalid VIC {} surface dimensions: {}x{} (Plane: {}x{})", name, surfaceWidth, surfaceHeight, lumaWidth, lumaHeight);
+                return false;
+            }
+            return true;
+        }};
+
+        if (!validateConfig(inputConfig, "input") || !validateConfig(outputConfig, "output"))
+            return;
+
+        if ((inputConfig.chromaWidthMinus1 + 1) * 2 < inputConfig.surfaceWidthMinus1 + 1 || (inputConfig.chromaHeightMinus1 + 1) * 2 < inputConfig.surfaceHeightMinus1 + 1) {
+            Logger::Warn("Invalid VIC input chroma plane dimensions: {}x{}", static_cast<u32>(inputConfig.chromaWidthMinus1 + 1), static_cast<u32>(inputConfig.chromaHeightMinus1 + 1));
+            return;
+        }
+
+        // All planes are laid out in the staging buffer in their guest layout first followed by their linear layout if they're block-linear
+        vk::DeviceSize stagingSize{};
+        auto createPlane{[&](const SurfaceConfig &config, u32 widthBytes, u32 height) {
+            Plane plane{
+                .rowSize = util::AlignUp(widthBytes, sizeof(u32)),
+                .lineCount = height,
+                .blockLinear = config.blockKind != 0,
+                .gobBlockHeight = 1U << config.blockHeightLog2,
+            };
+
+            plane.guestOffset = stagingSize;
+            if (plane.blockLinear)
+                plane.guestSize = gpu::texture::GetBlockLinearLayerSize(gpu::texture::Dimensions{plane.rowSize, height, 1}, 1, 1, 1, plane.gobBlockHeight, 1);
+            else
+                plane.guestSize = static_cast<vk::DeviceSize>(plane.GetPitch()) * height;
+            stagingSize += util::AlignUp(plane.guestSize, sizeof(u32));
+
+            if (plane.blockLinear) {
+                plane.linearOffset = stagingSize;
+                stagingSize += static_cast<vk::DeviceSize>(plane.rowSize) * height;
+            } else {
+                plane.linearOffset = plane.guestOffset;
+            }
+
+            return plane;
+        }};
+
+        auto luma{createPlane(inputConfig, inputConfig.lumaWidthMinus1 + 1, inputConfig.lumaHeightMinus1 + 1)};
+        auto chroma{createPlane(inputConfig, (inputConfig.chromaWidthMinus1 + 1) * 2, inputConfig.chromaHeightMinus1 + 1)};
+        auto output{createPlane(outputConfig, (outputConfig.lumaWidthMinus1 + 1) * 4, outputConfig.lumaHeightMinus1 + 1)};
+
+        auto &gpu{*state.gpu};
+        auto stagingBuffer{gpu.memory.AllocateStagingBuffer(stagingSize, vk::BufferUsageFlagBits::eStorageBuffer)};
+
+        auto &slotSurface{slotSurfaces[*slot]};
+        smmu.Read(stagingBuffer->data() + luma.guestOffset, static_cast<u32>(slotSurface.luma), static_cast<u32>(luma.guestSize));
+        smmu.Read(stagingBuffer->data() + chroma.guestOffset, static_cast<u32>(slotSurface.chromaU), static_cast<u32>(chroma.guestSize));
+
+        // The conversion shader only writes the visible region of the output, the rest of the plane (including any pitch padding) has to retain its guest contents as the entire plane is written back
+        smmu.Read(stagingBuffer->data() + output.guestOffset, static_cast<u32>(outputSurface.luma), static_cast<u32>(output.guestSize));
+
+        // Deswizzling, colour conversion and swizzling are all performed on the GPU within the staging buffer, only the copies to and from guest memory are done on the CPU
+        std::shared_ptr<gpu::BlockLinearJob> deswizzleJob, swizzleJob;
+        boost::container::small_vector<gpu::BlockLinearJob::Level, 3> deswizzleLevels;
+        if (luma.blockLinear)
+            deswizzleLevels.push_back(luma.GetLevel());
+        if (chroma.blockLinear)
+            deswizzleLevels.push_back(chroma.GetLevel());
+        if (output.blockLinear)
+            deswizzleLevels.push_back(output.GetLevel());
+        if (!deswizzleLevels.empty())
+            deswizzleJob = gpu.helperShaders.blockLinearHelperShader.Prepare(gpu, false, stagingBuffer->vkBuffer, deswizzleLevels);
+
+        if (output.blockLinear) {
+            auto level{output.GetLevel()};
+            swizzleJob = gpu.helperShaders.blockLinearHelperShader.Prepare(gpu, true, stagingBuffer->vkBuffer, span<const gpu::BlockLinearJob::Level>{level});
+        }
+
+        auto conversionJob{gpu.helperShaders.yuvConversionHelperShader.Prepare(gpu, stagingBuffer->vkBuffer, gpu::YuvConversionJob::Surfaces{
+            .lumaOffset = luma.linearOffset,
+            .lumaPitch = luma.GetPitch(),
+            .chromaOffset = chroma.linearOffset,
+            .chromaPitch = chroma.GetPitch(),
+            .sourceWidth = static_cast<u32>(inputConfig.surfaceWidthMinus1 + 1),
+            .sourceHeight = static_cast<u32>(inputConfig.surfaceHeightMinus1 + 1),
+            .destinationOffset = output.linearOffset,
+            .destinationPitch = output.GetPitch(),
+            .destinationWidth = static_cast<u32>(outputConfig.surfaceWidthMinus1 + 1),
+            .destinationHeight = static_cast<u32>(outputConfig.surfaceHeightMinus1 + 1),
+            .swapRedBlue = swapRedBlue,
+        })};
+
+        gpu.scheduler.Submit([&](vk::raii::CommandBuffer &commandBuffer) {
+            if (deswizzleJob)
+                gpu.helperShaders.blockLinearHelperShader.Record(commandBuffer, *deswizzleJob);
+            gpu.helperShaders.yuvConversionHelperShader.Record(commandBuffer, *conversionJob);
+            if (swizzleJob)
+                gpu.helperShaders.blockLinearHelperShader.Record(commandBuffer, *swizzleJob);
+        })->Wait();
+
+        smmu.Write(static_cast<u32>(outputSurface.luma), stagingBuffer->data() + output.guestOffset, static_cast<u32>(output.guestSize));
+    }
 
     void VicClass::CallMethod(u32 method, u32 argument) {
-        Logger::Warn("Unknown VIC class method called: 0x{:X} argument: 0x{:X}", method, argument);
+        using namespace vic;
+        u64 offset{static_cast<u64>(argument) << SurfaceOffsetShift};
+
+        if (method >= static_cast<u32>(Method::SetSurface0Slot0LumaOffset) && method < static_cast<u32>(Method::SetSurface0Slot0LumaOffset) + (SlotCount * SlotSurfaceMethodCount)) {
+            u32 slotMethod{method - static_cast<u32>(Method::SetSurface0Slot0LumaOffset)};
+            auto &surface{slotSurfaces[slotMethod / SlotSurfaceMethodCount]};
+            switch (slotMethod % SlotSurfaceMethodCount) {
+                case 0:
+                    surface.luma = offset;
+                    break;
+                case 1:
+                    surface.chromaU = offset;
+                    break;
+                case 2:
+                    surface.chromaV = offset;
+                    break;
+                default:
+                    break; // Past and future surfaces are only used for deinterlacing which isn't emulated
+            }
+            return;
+        }
+
+        switch (static_cast<Method>(method)) {
+            case Method::Execute:
+                Execute();
+                opDoneCallback();
+                break;
+            case Method::SetConfigStructOffset:
+                configStructOffset = offset;
+                break;
+            case Method::SetOutputSurfaceLumaOffset:
+                outputSurface.luma = offset;
+                break;
+            case Method::SetOutputSurfaceChromaUOffset:
+                outputSurface.chromaU = offset;
+                break;
+            case Method::SetOutputSurfaceChromaVOffset:
+                outputSurface.chromaV = offset;
+                break;
+            default:
+                Logger::Warn("Unknown VIC class method called: 0x{:X} argument: 0x{:X}", method, argument);
+                break;
+        }
     }
 }
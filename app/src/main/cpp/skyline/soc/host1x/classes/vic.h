@@ -8,13 +8,35 @@
 namespace skyline::soc::host1x {
     /**
      * @brief The VIC Host1x class implements hardware accelerated image operations
+     * @note Only the colour conversion and scaling of a semi-planar YUV 4:2:0 surface in the first slot into an RGBA output surface is emulated, this covers compositing decoded video frames which is what the VIC is used for by the guest
      */
     class VicClass {
       private:
+        const DeviceState &state;
         std::function<void()> opDoneCallback;
 
+        static constexpr size_t SlotCount{8}; //!< The amount of input slots which can be composited together
+
+        /**
+         * @brief The SMMU addresses of the planes of a surface, these are written by the guest shifted right by 8 bits
+         */
+        struct SurfaceOffsets {
+            u64 luma;
+            u64 chromaU; //!< The address of the interleaved chroma plane for semi-planar surfaces
+            u64 chromaV; //!< Unused for semi-planar surfaces
+        };
+
+        u64 configStructOffset{}; //!< The SMMU address of the configuration structure describing the composition
+        SurfaceOffsets outputSurface{};
+        std::array<SurfaceOffsets, SlotCount> slotSurfaces{}; //!< The current (surface 0) input surface of each slot, past and future surfaces for deinterlacing are ignored
+
+        /**
+         * @brief Performs the composition described by the configuration structure
+         */
+        void Execute();
+
       public:
-        VicClass(std::function<void()> opDoneCallback);
+        VicClass(const DeviceState &state, std::function<void()> opDoneCallback);
 
         void CallMethod(u32 method, u32 argument);
     };
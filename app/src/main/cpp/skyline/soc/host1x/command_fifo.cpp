@@ -45,7 +45,7 @@ namespace skyline::soc::host1x {
     };
     static_assert(sizeof(ChannelCommandFifoMethodHeader) == sizeof(u32));
 
-    ChannelCommandFifo::ChannelCommandFifo(const DeviceState &state, SyncpointSet &syncpoints) : state(state), gatherQueue(GatherQueueSize), host1XClass(syncpoints), nvDecClass(syncpoints), vicClass(syncpoints) {}
+    ChannelCommandFifo::ChannelCommandFifo(const DeviceState &state, SyncpointSet &syncpoints) : state(state), gatherQueue(GatherQueueSize), host1XClass(syncpoints), nvDecClass(state, syncpoints), vicClass(state, syncpoints) {}
 
     void ChannelCommandFifo::Send(ClassId targetClass, u32 method, u32 argument) {
         Logger::Verbose("Calling method in class: 0x{:X}, method: 0x{:X}, argument: 0x{:X}", targetClass, method, argument);
@@ -66,6 +66,32 @@ namespace skyline::soc::host1x {
         }
     }
 
+    void ChannelCommandFifo::SendBatch(ClassId targetClass, u32 method, span<u32> arguments, bool increment) {
+        Logger::Verbose("Calling method batch in class: 0x{:X}, method: 0x{:X}, argument count: {}, incrementing: {}", targetClass, method, arguments.size(), increment);
+
+        switch (targetClass) {
+            case ClassId::Host1x:
+                for (u32 argument : arguments)
+                    host1XClass.CallMethod(increment ? method++ : method, argument);
+                break;
+            case ClassId::NvDec:
+                if (increment)
+                    nvDecClass.CallMethodBatchInc(method, arguments);
+                else
+                    nvDecClass.CallMethodBatchNonInc(method, arguments);
+                break;
+            case ClassId::VIC:
+                if (increment)
+                    vicClass.CallMethodBatchInc(method, arguments);
+                else
+                    vicClass.CallMethodBatchNonInc(method, arguments);
+                break;
+            default:
+                Logger::Error("Sending method batch to unimplemented class: 0x{:X}", targetClass);
+                break;
+        }
+    }
+
     void ChannelCommandFifo::Process(span<u32> gather) {
         ClassId targetClass{ClassId::Host1x};
 
@@ -82,15 +108,14 @@ namespace skyline::soc::host1x {
 
                     break;
                 case Host1xOpcode::Incr:
-                    for (u32 i{}; i < methodHeader.methodCount; i++)
-                        Send(targetClass, methodHeader.methodAddress + i, *++entry);
-
-                    break;
-                case Host1xOpcode::NonIncr:
-                    for (u32 i{}; i < methodHeader.methodCount; i++)
-                        Send(targetClass, methodHeader.methodAddress, *++entry);
+                case Host1xOpcode::NonIncr: {
+                    // Runs are dispatched with a single call rather than one per argument, the arguments directly follow the header
+                    span<u32> arguments{std::next(entry), methodHeader.methodCount};
+                    SendBatch(targetClass, methodHeader.methodAddress, arguments, methodHeader.opcode == Host1xOpcode::Incr);
+                    entry += methodHeader.methodCount;
 
                     break;
+                }
                 case Host1xOpcode::Mask:
                     for (u32 i{}; i < std::numeric_limits<u16>::digits; i++)
                         if (methodHeader.offsetMask & (1 << i))
@@ -35,6 +35,12 @@ namespace skyline::soc::host1x {
          */
         void Send(ClassId targetClass, u32 method, u32 argument);
 
+        /**
+         * @brief Sends a run of method calls to the target class with a single dispatch
+         * @param increment If the method address is incremented for each argument (Incr) or kept the same (NonIncr)
+         */
+        void SendBatch(ClassId targetClass, u32 method, span<u32> arguments, bool increment);
+
         /**
          * @brief Processes the pushbuffer contained within the given gather, calling methods as needed
          */
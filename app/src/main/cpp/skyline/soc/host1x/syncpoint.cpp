@@ -2,81 +2,95 @@
 // Copyright © 2020 Skyline Team and Contributors (https://github.com/skyline-emu/)
 // Copyright © 2020 Ryujinx Team and Contributors (https://github.com/Ryujinx/)
 
+#include <linux/futex.h>
+#include <sys/syscall.h>
 #include "syncpoint.h"
 
 namespace skyline::soc::host1x {
-    Syncpoint::WaiterHandle Syncpoint::RegisterWaiter(u32 threshold, const std::function<void()> &callback) {
+    bool Syncpoint::RegisterWaiter(Waiter &waiter, u32 threshold) {
         if (value.load(std::memory_order_acquire) >= threshold) {
             // (Fast path) We don't need to wait on the mutex and can just get away with atomics
-            callback();
-            return {};
+            waiter.callback();
+            return false;
         }
 
         std::scoped_lock lock(mutex);
-        if (value.load(std::memory_order_acquire) >= threshold) {
-            callback();
-            return {};
-        }
-
+        waiter.threshold = threshold;
         auto it{waiters.begin()};
         while (it != waiters.end() && threshold >= it->threshold)
             it++;
-        return waiters.emplace(it, threshold, callback);
+        waiters.insert(it, waiter);
+
+        // The flag must be visible before the value is rechecked, an increment that occurred prior to it being set won't have called the waiter
+        hasWaiters.store(true, std::memory_order_seq_cst);
+        if (value.load(std::memory_order_seq_cst) >= threshold) {
+            waiters.erase(waiters.iterator_to(waiter));
+            hasWaiters.store(!waiters.empty(), std::memory_order_relaxed);
+            waiter.callback();
+            return false;
+        }
+
+        return true;
     }
 
-    void Syncpoint::DeregisterWaiter(WaiterHandle waiter) {
+    void Syncpoint::DeregisterWaiter(Waiter &waiter) {
         std::scoped_lock lock(mutex);
-        // We want to ensure the iterator still exists prior to erasing it
-        // Otherwise, if an invalid iterator was passed in then it could lead to UB
-        // It is important to avoid UB in that case since the deregister isn't called from a locked context
-        for (auto it{waiters.begin()}; it != waiters.end(); it++) {
-            if (it == waiter) {
-                waiters.erase(it);
-                return;
-            }
+        // The waiter might've already been called and unlinked by an increment prior to the lock being acquired
+        if (waiter.is_linked()) {
+            waiters.erase(waiters.iterator_to(waiter));
+            hasWaiters.store(!waiters.empty(), std::memory_order_relaxed);
         }
     }
 
     u32 Syncpoint::Increment() {
-        auto readValue{value.fetch_add(1, std::memory_order_acq_rel) + 1}; // We don't want to constantly do redundant atomic loads
+        auto readValue{value.fetch_add(1, std::memory_order_seq_cst) + 1}; // We don't want to constantly do redundant atomic loads
 
-        std::scoped_lock lock(mutex);
-        bool signalCondition{};
-        auto it{waiters.begin()};
-        while (it != waiters.end() && readValue >= it->threshold) {
-            auto &waiter{*it};
-            if (waiter.callback)
-                waiter.callback();
-            else
-                signalCondition = true;
-            it++;
-        }
+        if (blockedCount.load(std::memory_order_seq_cst))
+            syscall(SYS_futex, reinterpret_cast<u32 *>(&value), FUTEX_WAKE_PRIVATE, std::numeric_limits<i32>::max(), nullptr, nullptr, 0);
 
-        waiters.erase(waiters.begin(), it);
+        if (!hasWaiters.load(std::memory_order_seq_cst))
+            return readValue;
 
-        if (signalCondition)
-            incrementCondition.notify_all();
+        std::scoped_lock lock(mutex);
+        while (!waiters.empty() && readValue >= waiters.front().threshold) {
+            auto &waiter{waiters.front()};
+            waiters.pop_front(); // The waiter is unlinked prior to its callback being called as the callback may reuse or free it
+            waiter.callback();
+        }
+        hasWaiters.store(!waiters.empty(), std::memory_order_relaxed);
 
         return readValue;
     }
 
     bool Syncpoint::Wait(u32 threshold, std::chrono::steady_clock::duration timeout) {
-        if (value.load(std::memory_order_acquire) >= threshold)
-            // (Fast Path) We don't need to wait on the mutex and can just get away with atomics
-            return {};
+        u32 current{value.load(std::memory_order_acquire)};
+        if (current >= threshold)
+            // (Fast Path) We don't need to wait on the futex and can just get away with atomics
+            return true;
 
-        std::unique_lock lock(mutex);
-        auto it{waiters.begin()};
-        while (it != waiters.end() && threshold >= it->threshold)
-            it++;
-        waiters.emplace(it, threshold, nullptr);
+        bool infinite{timeout == std::chrono::steady_clock::duration::max()};
+        auto deadline{infinite ? std::chrono::steady_clock::time_point::max() : std::chrono::steady_clock::now() + timeout};
 
-        if (timeout == std::chrono::steady_clock::duration::max()) {
-            incrementCondition.wait(lock, [&] { return value.load(std::memory_order_relaxed) >= threshold; });
-            return true;
-        } else {
-            return incrementCondition.wait_for(lock, timeout, [&] { return value.load(std::memory_order_relaxed) >= threshold; });
+        // The count must be visible before the value is rechecked, an increment that occurred prior to it being incremented won't have woken the futex
+        blockedCount.fetch_add(1, std::memory_order_seq_cst);
+        while ((current = value.load(std::memory_order_seq_cst)) < threshold) {
+            timespec remaining{}, *remainingPointer{};
+            if (!infinite) {
+                auto now{std::chrono::steady_clock::now()};
+                if (now >= deadline)
+                    break;
+
+                auto remainingNs{std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - now).count()};
+                remaining.tv_sec = static_cast<time_t>(remainingNs / constant::NsInSecond);
+                remaining.tv_nsec = static_cast<long>(remainingNs % constant::NsInSecond);
+                remainingPointer = &remaining;
+            }
+
+            // The futex will return immediately if the value has changed since it was loaded, spurious wakeups and signal interruptions are handled by rechecking the value
+            syscall(SYS_futex, reinterpret_cast<u32 *>(&value), FUTEX_WAIT_PRIVATE, current, remainingPointer, nullptr, 0);
         }
+        blockedCount.fetch_sub(1, std::memory_order_relaxed);
+
+        return current >= threshold;
     }
 }
-
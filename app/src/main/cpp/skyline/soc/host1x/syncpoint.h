@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <boost/intrusive/list.hpp>
 #include <common.h>
 
 namespace skyline::soc::host1x {
@@ -11,21 +12,32 @@ namespace skyline::soc::host1x {
 
     /**
      * @brief The Syncpoint class represents a single syncpoint in the GPU which is used for GPU -> CPU synchronisation
+     * @note Increments only lock the syncpoint when there are callback waiters registered and only wake blocking waiters when there are any, blocking waits are performed with a futex on the value itself
      */
     class Syncpoint {
-      private:
-        std::atomic<u32> value{}; //!< An atomically-incrementing counter at the core of a syncpoint
-
-        std::mutex mutex; //!< Synchronizes insertions and deletions of waiters alongside locking the increment condition
-        std::condition_variable incrementCondition; //!< Signalled on thresholds for waiters which are tied to Wait(...)
+      public:
+        /**
+         * @brief A waiter with a callback that's called when the syncpoint reaches a threshold, it's owned by the caller and linked into the syncpoint intrusively so registering it never allocates
+         * @note The waiter must be deregistered prior to being destroyed if it's still registered
+         */
+        class Waiter : public boost::intrusive::list_base_hook<> {
+          private:
+            friend Syncpoint;
 
-        struct Waiter {
-            u32 threshold; //!< The syncpoint value to wait on to be reached
-            std::function<void()> callback; //!< The callback to do after the wait has ended, refers to cvar signal when nullptr
+            u32 threshold{}; //!< The syncpoint value to wait on to be reached
+            std::function<void()> callback; //!< The callback to do after the wait has ended, this is called with the syncpoint locked
 
-            Waiter(u32 threshold, std::function<void()> callback) : threshold(threshold), callback(std::move(callback)) {}
+          public:
+            Waiter(std::function<void()> callback) : callback{std::move(callback)} {}
         };
-        std::list<Waiter> waiters; //!< A linked list of all waiters, it's sorted in ascending order by threshold
+
+      private:
+        std::atomic<u32> value{}; //!< An atomically-incrementing counter at the core of a syncpoint, this doubles as the futex word for blocking waits
+
+        std::mutex mutex; //!< Synchronizes insertions and deletions of waiters with the increments that call them
+        boost::intrusive::list<Waiter> waiters; //!< A list of all callback waiters, it's sorted in ascending order by threshold
+        std::atomic<bool> hasWaiters{}; //!< If there are any callback waiters, this allows increments to skip locking the mutex
+        std::atomic<u32> blockedCount{}; //!< The amount of threads blocked in Wait(...), this allows increments to skip waking the futex
 
       public:
         /**
@@ -35,19 +47,17 @@ namespace skyline::soc::host1x {
             return value.load(std::memory_order_acquire);
         }
 
-        using WaiterHandle = decltype(waiters)::iterator; //!< Aliasing an iterator to a Waiter as an opaque handle
-
         /**
-         * @brief Registers a new waiter with a callback that will be called when the syncpoint reaches the target threshold
+         * @brief Registers a waiter which will have its callback called when the syncpoint reaches the target threshold
          * @note The callback will be called immediately if the syncpoint has already reached the given threshold
-         * @return A handle that can be used to deregister the waiter, its boolean operator will evaluate to false if the threshold has already been reached
+         * @return If the waiter was registered, this is false if the threshold had already been reached
          */
-        WaiterHandle RegisterWaiter(u32 threshold, const std::function<void()> &callback);
+        bool RegisterWaiter(Waiter &waiter, u32 threshold);
 
         /**
-         * @note If the supplied handle is invalid then the function will do nothing
+         * @note If the supplied waiter isn't registered then the function will do nothing
          */
-        void DeregisterWaiter(WaiterHandle waiter);
+        void DeregisterWaiter(Waiter &waiter);
 
         /**
          * @return The new value of the syncpoint after the increment
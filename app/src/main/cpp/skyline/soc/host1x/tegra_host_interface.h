@@ -40,15 +40,15 @@ namespace skyline::soc::host1x {
             }
         }
 
+        static constexpr u32 Method0MethodId{0x10}; //!< Sets the method to be called on the device class upon a call to Method1, see TRM '15.5.6 NV_PVIC_THI_METHOD0'
+        static constexpr u32 Method1MethodId{0x11}; //!< Calls the method set by Method1 with the supplied argument, see TRM '15.5.7 NV_PVIC_THI_METHOD1"
+
       public:
-        TegraHostInterface(SyncpointSet &syncpoints)
-            : deviceClass([&] { SubmitPendingIncrs(); }),
+        TegraHostInterface(const DeviceState &state, SyncpointSet &syncpoints)
+            : deviceClass(state, [&] { SubmitPendingIncrs(); }),
               syncpoints(syncpoints) {}
 
         void CallMethod(u32 method, u32 argument)  {
-            constexpr u32 Method0MethodId{0x10}; //!< Sets the method to be called on the device class upon a call to Method1, see TRM '15.5.6 NV_PVIC_THI_METHOD0'
-            constexpr u32 Method1MethodId{0x11}; //!< Calls the method set by Method1 with the supplied argument, see TRM '15.5.7 NV_PVIC_THI_METHOD1"
-
             switch (method) {
                 case IncrementSyncpointMethodId: {
                     IncrementSyncpointMethod incrSyncpoint{.raw = argument};
@@ -80,5 +80,28 @@ namespace skyline::soc::host1x {
                     break;
             }
         }
+
+        /**
+         * @brief Calls a run of incrementing methods, this is equivalent to calling CallMethod for each argument with an incrementing method
+         */
+        void CallMethodBatchInc(u32 method, span<u32> arguments) {
+            for (u32 argument : arguments)
+                CallMethod(method++, argument);
+        }
+
+        /**
+         * @brief Calls a run of non-incrementing methods, this is equivalent to calling CallMethod for each argument with the same method
+         * @note Runs on Method1 are forwarded to the device class directly as they all call the same device method, this is how bulk register setups are usually written
+         */
+        void CallMethodBatchNonInc(u32 method, span<u32> arguments) {
+            if (method == Method1MethodId) [[likely]] {
+                for (u32 argument : arguments)
+                    deviceClass.CallMethod(storedMethod, argument);
+                return;
+            }
+
+            for (u32 argument : arguments)
+                CallMethod(method, argument);
+        }
     };
 }
@@ -2,22 +2,65 @@
 // Copyright © 2021 Skyline Team and Contributors (https://github.com/skyline-emu/)
 
 #include <unistd.h>
+#include <sys/mman.h>
 #include <android/asset_manager.h>
 #include "android_asset_backing.h"
 
 namespace skyline::vfs {
-    AndroidAssetBacking::AndroidAssetBacking(AAsset *asset, Mode mode) : Backing(mode), asset(asset) {
+    AndroidAssetBacking::AndroidAssetBacking(AAsset *pAsset, Mode mode) : Backing(mode), asset(pAsset) {
         if (mode.write || mode.append)
             throw exception("AndroidAssetBacking doesn't support writing");
 
         size = static_cast<size_t>(AAsset_getLength64(asset));
+
+        // Only assets which are stored uncompressed in the APK have a file descriptor, their data can be mapped directly from it
+        off64_t start, length;
+        int fd{AAsset_openFileDescriptor64(asset, &start, &length)};
+        if (fd >= 0) {
+            auto alignedStart{util::AlignDown(static_cast<size_t>(start), constant::PageSize)};
+            size_t startOffset{static_cast<size_t>(start) - alignedStart};
+            void *address{size ? mmap(nullptr, size + startOffset, PROT_READ, MAP_SHARED, fd, static_cast<off_t>(alignedStart)) : MAP_FAILED};
+            close(fd); // The mapping retains its own reference to the file
+
+            if (address != MAP_FAILED) {
+                mapping = span{static_cast<u8 *>(address), size + startOffset};
+                contents = mapping.subspan(startOffset, size);
+            }
+        } else if (auto data{AAsset_getBuffer(asset)}) {
+            // Compressed assets are decompressed in their entirety by the AAsset, a copy is retained so the asset doesn't need to be decompressed again
+            buffer = std::make_shared<std::vector<u8>>(static_cast<const u8 *>(data), static_cast<const u8 *>(data) + size);
+            contents = *buffer;
+        }
+
+        if (contents.valid() || !size) {
+            AAsset_close(asset);
+            asset = nullptr;
+        }
+    }
+
+    AndroidAssetBacking::AndroidAssetBacking(std::shared_ptr<std::vector<u8>> pBuffer, Mode mode) : Backing(mode, pBuffer->size()), buffer(std::move(pBuffer)), contents(*buffer) {
+        if (mode.write || mode.append)
+            throw exception("AndroidAssetBacking doesn't support writing");
     }
 
     AndroidAssetBacking::~AndroidAssetBacking() {
-        AAsset_close(asset);
+        if (mapping.valid())
+            munmap(mapping.data(), mapping.size());
+
+        if (asset)
+            AAsset_close(asset);
     }
 
     size_t AndroidAssetBacking::ReadImpl(span<u8> output, size_t offset) {
+        if (!asset) {
+            if (offset >= size)
+                return 0;
+
+            auto source{contents.subspan(offset, std::min(output.size(), size - offset))};
+            std::memcpy(output.data(), source.data(), source.size());
+            return source.size();
+        }
+
         if (AAsset_seek64(asset, static_cast<off64_t>(offset), SEEK_SET) != offset)
             throw exception("Failed to seek asset position");
 
@@ -27,4 +70,11 @@ namespace skyline::vfs {
 
         return static_cast<size_t>(result);
     }
+
+    span<u8> AndroidAssetBacking::ViewImpl(size_t offset, size_t size) {
+        if (!contents.valid())
+            return {};
+
+        return contents.subspan(offset, size);
+    }
 }
@@ -10,19 +10,37 @@ struct AAsset; //!< https://developer.android.com/ndk/reference/group/asset#aass
 namespace skyline::vfs {
     /**
      * @brief The AndroidAssetBacking class provides the backing abstractions for the AAsset Android API
-     * @note This is NOT thread safe NOR should it be shared across threads.
+     * @note Uncompressed assets are memory-mapped directly from the APK and compressed assets are decompressed into memory once, the contents of either can be viewed and read from any thread
+     * @note If neither is possible reads are streamed through the AAsset which is NOT thread safe
      * @note This will take ownership of the backing asset passed into it
      */
     class AndroidAssetBacking : public Backing {
       private:
-        AAsset *asset; //!< The NDK AAsset object we abstract
+        AAsset *asset{}; //!< The NDK AAsset object we abstract, this is only retained when reads are streamed through it
+        span<u8> mapping; //!< A page-aligned read-only mapping of the APK region containing the asset, this is invalid if the asset isn't mapped
+        std::shared_ptr<std::vector<u8>> buffer; //!< The decompressed contents of a compressed asset
+        span<u8> contents; //!< The entire contents of the asset in memory, this is invalid if reads are streamed
 
       protected:
         size_t ReadImpl(span<u8> output, size_t offset) override;
 
+        span<u8> ViewImpl(size_t offset, size_t size) override;
+
       public:
         AndroidAssetBacking(AAsset *asset, Mode mode = {true, false, false});
 
+        /**
+         * @brief Creates a backing over the previously decompressed contents of an asset
+         */
+        AndroidAssetBacking(std::shared_ptr<std::vector<u8>> buffer, Mode mode = {true, false, false});
+
         virtual ~AndroidAssetBacking();
+
+        /**
+         * @return The decompressed contents of the asset if it was compressed, these can be used to open the same asset again without decompression
+         */
+        std::shared_ptr<std::vector<u8>> GetDecompressedBuffer() {
+            return buffer;
+        }
     };
 }
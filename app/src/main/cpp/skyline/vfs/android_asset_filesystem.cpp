@@ -9,11 +9,23 @@ namespace skyline::vfs {
     AndroidAssetFileSystem::AndroidAssetFileSystem(AAssetManager *assetManager) : FileSystem(), assetManager(assetManager) {}
 
     std::shared_ptr<Backing> AndroidAssetFileSystem::OpenFileImpl(const std::string &path, Backing::Mode mode) {
-        auto file{AAssetManager_open(assetManager, path.c_str(), AASSET_MODE_RANDOM)};
+        {
+            std::scoped_lock lock{decompressedAssetsMutex};
+            auto decompressed{decompressedAssets.find(path)};
+            if (decompressed != decompressedAssets.end())
+                return std::make_shared<AndroidAssetBacking>(decompressed->second, mode);
+        }
+
+        auto file{AAssetManager_open(assetManager, path.c_str(), AASSET_MODE_BUFFER)};
         if (file == nullptr)
             return nullptr;
 
-        return file ? std::make_shared<AndroidAssetBacking>(file, mode) : nullptr;
+        auto backing{std::make_shared<AndroidAssetBacking>(file, mode)};
+        if (auto decompressed{backing->GetDecompressedBuffer()}) {
+            std::scoped_lock lock{decompressedAssetsMutex};
+            decompressedAssets.emplace(path, std::move(decompressed));
+        }
+        return backing;
     }
 
     std::optional<Directory::EntryType> AndroidAssetFileSystem::GetEntryTypeImpl(const std::string &path) {
@@ -14,6 +14,8 @@ namespace skyline::vfs {
     class AndroidAssetFileSystem : public FileSystem {
       private:
         AAssetManager *assetManager; //!< The NDK asset manager for the filesystem
+        std::mutex decompressedAssetsMutex;
+        std::unordered_map<std::string, std::shared_ptr<std::vector<u8>>> decompressedAssets; //!< The contents of all compressed assets that have been opened, these are bundled system archives that are reopened repeatedly so they're retained for the lifetime of the filesystem
 
       protected:
         std::shared_ptr<Backing> OpenFileImpl(const std::string &path, Backing::Mode mode) override;
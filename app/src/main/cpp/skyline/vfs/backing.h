@@ -22,6 +22,12 @@ namespace skyline::vfs {
             throw exception("This backing does not support being resized");
         }
 
+        virtual span<u8> ViewImpl(size_t offset, size_t size) {
+            return {};
+        }
+
+        virtual void FlushImpl() {}
+
       public:
         union Mode {
             struct {
@@ -80,6 +86,20 @@ namespace skyline::vfs {
             return size;
         };
 
+        /**
+         * @brief Retrieves a view of the data in a region of the backing without copying it, this is only supported by backings that store their data in memory in its final form
+         * @param offset The offset of the region in the backing
+         * @param size The size of the region, this must not extend past the end of the backing
+         * @return A span over the data of the region which is valid for the lifetime of the backing, or an empty span if the backing doesn't support views
+         * @note Views must not be written to
+         */
+        span<u8> View(size_t offset, size_t size) {
+            if (offset > this->size || (this->size - offset) < size)
+                throw exception("Trying to view past the end of a backing: 0x{:X}/0x{:X} (Offset: 0x{:X})", size, this->size, offset);
+
+            return ViewImpl(offset, size);
+        }
+
         /**
          * @brief Implicit casting for reading into spans of different types
          */
@@ -139,5 +159,12 @@ namespace skyline::vfs {
         void Resize(size_t pSize) {
             ResizeImpl(pSize);
         }
+
+        /**
+         * @brief Ensures all data written to the backing so far has been written out to its underlying storage
+         */
+        void Flush() {
+            FlushImpl();
+        }
     };
 }
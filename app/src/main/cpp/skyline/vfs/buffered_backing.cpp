@@ -0,0 +1,214 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2023 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "os_backing.h"
+#include "buffered_backing.h"
+
+namespace skyline::vfs {
+    static std::shared_ptr<Backing> OpenHostFile(const std::string &path) {
+        int fd{open(path.c_str(), O_RDWR)};
+        if (fd < 0)
+            throw exception("Failed to open file at '{}': {}", path, strerror(errno));
+
+        return std::make_shared<OsBacking>(fd, true, Backing::Mode{true, true, true});
+    }
+
+    BufferedBacking::BufferedBacking(std::string pPath, Mode mode) : Backing(mode), path{std::move(pPath)}, backing{OpenHostFile(path)} {
+        size = backing->size;
+        backingValidSize = size;
+    }
+
+    BufferedBacking::~BufferedBacking() {
+        try {
+            std::scoped_lock lock{mutex};
+            FlushLocked();
+        } catch (const std::exception &e) {
+            Logger::Error("Failed to flush '{}': {}", path, e.what());
+        }
+    }
+
+    size_t BufferedBacking::ReadBuffered(span<u8> output, size_t offset) {
+        if (offset >= size)
+            return 0;
+
+        size_t readSize{std::min(output.size(), size - offset)};
+        size_t backingReadSize{offset < backingValidSize ? std::min(readSize, backingValidSize - offset) : 0};
+        if (backingReadSize)
+            backing->Read(output.first(backingReadSize), offset);
+        std::memset(output.data() + backingReadSize, 0, readSize - backingReadSize);
+
+        auto extent{extents.upper_bound(offset)};
+        if (extent != extents.begin())
+            extent--;
+
+        for (; extent != extents.end() && extent->first < offset + readSize; extent++) {
+            size_t start{std::max(extent->first, offset)}, end{std::min(extent->first + extent->second.size(), offset + readSize)};
+            if (start < end)
+                std::memcpy(output.data() + (start - offset), extent->second.data() + (start - extent->first), end - start);
+        }
+
+        return readSize;
+    }
+
+    size_t BufferedBacking::ReadImpl(span<u8> output, size_t offset) {
+        std::scoped_lock lock{mutex};
+        return ReadBuffered(output, offset);
+    }
+
+    size_t BufferedBacking::WriteImpl(span<u8> input, size_t offset) {
+        std::scoped_lock lock{mutex};
+        if (discarded || input.empty())
+            return input.size();
+
+        size_t end{offset + input.size()};
+
+        // Find all extents that overlap or are adjacent to the write, these are merged with it into a single extent
+        auto first{extents.upper_bound(offset)};
+        if (first != extents.begin() && std::prev(first)->first + std::prev(first)->second.size() >= offset)
+            first--;
+
+        auto last{first};
+        size_t mergedEnd{end};
+        for (; last != extents.end() && last->first <= end; last++)
+            mergedEnd = std::max(mergedEnd, last->first + last->second.size());
+
+        if (first != last && first->first <= offset) {
+            // Extending the preceding extent in place avoids repeatedly copying it for sequences of small sequential writes
+            auto &data{first->second};
+            dirtySize -= data.size();
+            data.resize(mergedEnd - first->first);
+            for (auto extent{std::next(first)}; extent != last; extent++) {
+                std::memcpy(data.data() + (extent->first - first->first), extent->second.data(), extent->second.size());
+                dirtySize -= extent->second.size();
+            }
+            std::memcpy(data.data() + (offset - first->first), input.data(), input.size());
+            dirtySize += data.size();
+            extents.erase(std::next(first), last);
+        } else {
+            std::vector<u8> data(mergedEnd - offset);
+            for (auto extent{first}; extent != last; extent++) {
+                std::memcpy(data.data() + (extent->first - offset), extent->second.data(), extent->second.size());
+                dirtySize -= extent->second.size();
+            }
+            std::memcpy(data.data(), input.data(), input.size());
+            dirtySize += data.size();
+            extents.erase(first, last);
+            extents.emplace(offset, std::move(data));
+        }
+
+        size = std::max(size, end);
+
+        if (dirtySize >= MaxDirtySize)
+            FlushLocked();
+
+        return input.size();
+    }
+
+    void BufferedBacking::ResizeImpl(size_t pSize) {
+        std::scoped_lock lock{mutex};
+        if (pSize < size) {
+            extents.erase(extents.lower_bound(pSize), extents.end());
+            if (!extents.empty()) {
+                auto &[offset, data]{*extents.rbegin()};
+                if (offset + data.size() > pSize)
+                    data.resize(pSize - offset);
+            }
+
+            dirtySize = 0;
+            for (const auto &[offset, data] : extents)
+                dirtySize += data.size();
+
+            backingValidSize = std::min(backingValidSize, pSize);
+        }
+
+        size = pSize;
+        resized = true;
+    }
+
+    void BufferedBacking::ReplaceFile() {
+        auto tempPath{path + ".tmp"};
+        int fd{open(tempPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR)};
+        if (fd < 0)
+            throw exception("Failed to create temporary file '{}': {}", tempPath, strerror(errno));
+
+        try {
+            std::vector<u8> chunk(std::min(CopyChunkSize, size));
+            for (size_t offset{}; offset < size; offset += chunk.size()) {
+                span<u8> chunkData{chunk.data(), std::min(chunk.size(), size - offset)};
+                ReadBuffered(chunkData, offset);
+
+                for (size_t written{}; written < chunkData.size();) {
+                    auto ret{pwrite64(fd, chunkData.data() + written, chunkData.size() - written, static_cast<off64_t>(offset + written))};
+                    if (ret < 0)
+                        throw exception("Failed to write to temporary file '{}': {}", tempPath, strerror(errno));
+                    written += static_cast<size_t>(ret);
+                }
+            }
+
+            if (fsync(fd))
+                throw exception("Failed to sync temporary file '{}': {}", tempPath, strerror(errno));
+        } catch (...) {
+            close(fd);
+            unlink(tempPath.c_str());
+            throw;
+        }
+        close(fd);
+
+        if (rename(tempPath.c_str(), path.c_str())) {
+            unlink(tempPath.c_str());
+            throw exception("Failed to replace '{}': {}", path, strerror(errno));
+        }
+
+        // The rename itself is only durable once the directory containing the file has been synced
+        int directoryFd{open(path.substr(0, path.find_last_of('/')).c_str(), O_RDONLY | O_DIRECTORY)};
+        if (directoryFd >= 0) {
+            fsync(directoryFd);
+            close(directoryFd);
+        }
+
+        backing = OpenHostFile(path);
+    }
+
+    void BufferedBacking::WriteExtents() {
+        if (resized) {
+            // Any data past the valid size of the file is truncated first so it reads back as zeroes if the file was grown again after being shrunk
+            backing->Resize(backingValidSize);
+            backing->Resize(size);
+        }
+
+        for (auto &[offset, data] : extents)
+            backing->Write(data, offset);
+
+        backing->Flush();
+    }
+
+    void BufferedBacking::FlushLocked() {
+        if (discarded || (extents.empty() && !resized))
+            return;
+
+        if (size <= AtomicReplaceLimit)
+            ReplaceFile();
+        else
+            WriteExtents();
+
+        extents.clear();
+        dirtySize = 0;
+        resized = false;
+        backingValidSize = size;
+    }
+
+    void BufferedBacking::FlushImpl() {
+        std::scoped_lock lock{mutex};
+        FlushLocked();
+    }
+
+    void BufferedBacking::Discard() {
+        std::scoped_lock lock{mutex};
+        discarded = true;
+        extents.clear();
+        dirtySize = 0;
+    }
+}
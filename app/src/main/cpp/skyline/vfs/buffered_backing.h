@@ -0,0 +1,78 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2023 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#pragma once
+
+#include <map>
+#include "backing.h"
+
+namespace skyline::vfs {
+    /**
+     * @brief A write-back backing for a host file which coalesces writes in memory and only writes them out when flushed
+     * @note Small files are replaced atomically by writing their new contents to a temporary file and renaming it over the original, so a crash during a flush leaves either the old or the new file intact
+     */
+    class BufferedBacking : public Backing {
+      private:
+        static constexpr size_t MaxDirtySize{0x400000}; //!< The amount of buffered data after which a flush is done implicitly to bound memory usage
+        static constexpr size_t AtomicReplaceLimit{0x4000000}; //!< The maximum size of a file that is atomically replaced, larger files have their modified extents written in place to avoid rewriting them entirely
+        static constexpr size_t CopyChunkSize{0x100000}; //!< The size of the chunks a file is copied into its replacement in
+
+        std::string path; //!< The host path of the file
+        std::shared_ptr<Backing> backing; //!< A backing of the file as of the last flush
+        std::mutex mutex; //!< Synchronizes all accesses to the buffered state and the underlying backing
+        std::map<size_t, std::vector<u8>> extents; //!< Non-overlapping and non-adjacent extents of data written since the last flush, keyed by their offset
+        size_t dirtySize{}; //!< The total size of all extents
+        size_t backingValidSize; //!< The amount of data at the start of the underlying backing that's still part of the file, anything past this was truncated away and reads as zeroes
+        bool resized{}; //!< If the size of the file was changed since the last flush
+        bool discarded{}; //!< If buffered data should be dropped rather than flushed as the file was deleted
+
+        /**
+         * @brief Reads the data of the backing with any buffered extents applied on top of it
+         * @note The mutex must be locked when calling this
+         */
+        size_t ReadBuffered(span<u8> output, size_t offset);
+
+        /**
+         * @brief Writes the new contents of the file to a temporary file which is renamed over the original
+         * @note The mutex must be locked when calling this
+         */
+        void ReplaceFile();
+
+        /**
+         * @brief Writes all extents into the file in place
+         * @note The mutex must be locked when calling this
+         */
+        void WriteExtents();
+
+        /**
+         * @note The mutex must be locked when calling this
+         */
+        void FlushLocked();
+
+      protected:
+        size_t ReadImpl(span<u8> output, size_t offset) override;
+
+        size_t WriteImpl(span<u8> input, size_t offset) override;
+
+        void ResizeImpl(size_t pSize) override;
+
+        void FlushImpl() override;
+
+      public:
+        /**
+         * @param path The host path of an existing file
+         */
+        BufferedBacking(std::string path, Mode mode);
+
+        /**
+         * @note Any buffered data is flushed on destruction
+         */
+        ~BufferedBacking();
+
+        /**
+         * @brief Drops all buffered data and prevents anything from being written to the file in the future
+         * @note This is used when the file is deleted while the backing is still open
+         */
+        void Discard();
+    };
+}
@@ -1,58 +1,100 @@
 // SPDX-License-Identifier: MPL-2.0
 // Copyright © 2020 Skyline Team and Contributors (https://github.com/skyline-emu/)
 
+#include <common/thread_pool.h>
 #include "ctr_encrypted_backing.h"
 
 namespace skyline::vfs {
     constexpr size_t SectorSize{0x10};
 
-    CtrEncryptedBacking::CtrEncryptedBacking(crypto::KeyStore::Key128 ctr, crypto::KeyStore::Key128 key, std::shared_ptr<Backing> backing, size_t baseOffset) : Backing({true, false, false}, backing->size), ctr(ctr), cipher(key, MBEDTLS_CIPHER_AES_128_CTR), backing(std::move(backing)), baseOffset(baseOffset) {
+    /**
+     * @return The pool shared by all CTR backings for decrypting large reads, decryption is CPU-bound so this has a thread for every other core
+     */
+    static ThreadPool &GetDecryptPool() {
+        static ThreadPool pool{std::max(std::thread::hardware_concurrency(), 2U) - 1, "CtrDecrypt"};
+        return pool;
+    }
+
+    CtrEncryptedBacking::CtrEncryptedBacking(crypto::KeyStore::Key128 ctr, crypto::KeyStore::Key128 key, std::shared_ptr<Backing> backing, size_t baseOffset) : Backing({true, false, false}, backing->size), ctr(ctr), key(key), cipher(key, MBEDTLS_CIPHER_AES_128_CTR), backing(std::move(backing)), baseOffset(baseOffset), cacheId(PageCache::Get().AllocateId()) {
         if (mode.write || mode.append)
             throw exception("Cannot open a CtrEncryptedBacking as writable");
     }
 
-    void CtrEncryptedBacking::UpdateCtr(u64 offset) {
+    CtrEncryptedBacking::~CtrEncryptedBacking() {
+        PageCache::Get().Evict(cacheId);
+    }
+
+    crypto::KeyStore::Key128 CtrEncryptedBacking::GetCtr(u64 offset) const {
+        auto sectorCtr{ctr};
         offset >>= 4;
         size_t le{util::SwapEndianness(offset)};
-        std::memcpy(ctr.data() + 8, &le, 8);
-        cipher.SetIV(ctr);
+        std::memcpy(sectorCtr.data() + 8, &le, 8);
+        return sectorCtr;
     }
 
-    size_t CtrEncryptedBacking::ReadImpl(span<u8> output, size_t offset) {
-        size_t size{output.size()};
-        if (size == 0)
+    size_t CtrEncryptedBacking::ReadDecrypted(span<u8> output, size_t offset) {
+        size_t read{backing->ReadUnchecked(output, offset)};
+        if (read != output.size())
             return 0;
 
-        size_t sectorOffset{offset % SectorSize};
-        if (sectorOffset == 0) {
-            size_t read{backing->ReadUnchecked(output, offset)};
-            if (read != size)
-                return 0;
-            {
-                std::scoped_lock guard{mutex};
-                UpdateCtr(baseOffset + offset);
-                cipher.Decrypt(output);
-            }
-            return size;
+        if (output.size() >= ParallelDecryptThreshold) {
+            static_assert(ParallelDecryptChunkSize % SectorSize == 0);
+            GetDecryptPool().ParallelFor(util::DivideCeil(output.size(), ParallelDecryptChunkSize), [&](size_t index) {
+                size_t chunkOffset{index * ParallelDecryptChunkSize};
+                auto chunkKey{key};
+                crypto::AesCipher chunkCipher{chunkKey, MBEDTLS_CIPHER_AES_128_CTR}; // Ciphers are stateful so every chunk requires its own, their setup is negligible compared to decrypting a chunk
+                chunkCipher.SetIV(GetCtr(baseOffset + offset + chunkOffset));
+                chunkCipher.Decrypt(output.subspan(chunkOffset, std::min(ParallelDecryptChunkSize, output.size() - chunkOffset)));
+            });
+            return read;
         }
 
-        size_t sectorStart{offset - sectorOffset};
-        std::vector<u8> blockBuf(SectorSize);
-        size_t read{backing->ReadUnchecked(blockBuf, sectorStart)};
-        if (read != SectorSize)
-            return 0;
-        {
-            std::scoped_lock guard{mutex};
-            UpdateCtr(baseOffset + sectorStart);
-            cipher.Decrypt(blockBuf);
-        }
-        if (size + sectorOffset < SectorSize) {
-            std::memcpy(output.data(), blockBuf.data() + sectorOffset, size);
-            return size;
+        std::scoped_lock guard{mutex};
+        cipher.SetIV(GetCtr(baseOffset + offset));
+        cipher.Decrypt(output);
+        return read;
+    }
+
+    size_t CtrEncryptedBacking::ReadImpl(span<u8> output, size_t offset) {
+        static_assert(PageCache::BlockSize % SectorSize == 0);
+        auto &cache{PageCache::Get()};
+
+        size_t copied{};
+        while (copied < output.size()) {
+            size_t position{offset + copied};
+            if (position >= size)
+                break;
+
+            size_t index{position / PageCache::BlockSize}, blockOffset{position % PageCache::BlockSize};
+            size_t amount{std::min(output.size() - copied, PageCache::BlockSize - blockOffset)};
+
+            auto block{cache.Lookup(cacheId, index)};
+            if (!block) {
+                if (blockOffset == 0 && amount == PageCache::BlockSize) {
+                    // Blocks that are read in their entirety are decrypted directly into the output without being cached, these are from large streaming reads which are unlikely to be repeated and would otherwise flush the cache
+                    // All following uncached blocks that are read in their entirety are coalesced into a single read so they're decrypted in large chunks
+                    while (output.size() - copied - amount >= PageCache::BlockSize && position + amount + PageCache::BlockSize <= size && !cache.Lookup(cacheId, index + amount / PageCache::BlockSize))
+                        amount += PageCache::BlockSize;
+
+                    if (ReadDecrypted(output.subspan(copied, amount), position) != amount)
+                        break;
+                    copied += amount;
+                    continue;
+                }
+
+                size_t blockStart{index * PageCache::BlockSize};
+                auto data{std::make_shared<std::vector<u8>>(std::min(PageCache::BlockSize, size - blockStart))};
+                if (ReadDecrypted(*data, blockStart) != data->size())
+                    break;
+                cache.Insert(cacheId, index, data);
+                block = std::move(data);
+            }
+
+            amount = std::min(amount, block->size() - blockOffset);
+            std::memcpy(output.data() + copied, block->data() + blockOffset, amount);
+            copied += amount;
         }
 
-        size_t readInBlock{SectorSize - sectorOffset};
-        std::memcpy(output.data(), blockBuf.data() + sectorOffset, readInBlock);
-        return readInBlock + ReadUnchecked(output.subspan(readInBlock), offset + readInBlock);
+        return copied;
     }
 }
@@ -5,6 +5,7 @@
 
 #include <crypto/aes_cipher.h>
 #include <crypto/key_store.h>
+#include "page_cache.h"
 #include "backing.h"
 
 namespace skyline::vfs {
@@ -13,21 +14,35 @@ namespace skyline::vfs {
      */
     class CtrEncryptedBacking : public Backing {
       private:
+        static constexpr size_t ParallelDecryptThreshold{0x200000}; //!< The size of a read after which it's decrypted in chunks on multiple threads
+        static constexpr size_t ParallelDecryptChunkSize{0x80000}; //!< The size of the chunks a parallel decryption is split into, this must be a multiple of the AES sector size
+
         crypto::KeyStore::Key128 ctr;
+        crypto::KeyStore::Key128 key; //!< The key is retained to create additional ciphers for parallel decryption
         crypto::AesCipher cipher;
         std::shared_ptr<Backing> backing;
         std::mutex mutex; //!< Synchronize all AES-CTR cipher state modifications
         size_t baseOffset; //!< The offset of the backing into the file is used to calculate the IV
+        u64 cacheId; //!< The ID of this backing in the PageCache
 
         /**
-         * @brief Calculates IV based on the offset
+         * @brief Calculates the IV for the sector at the supplied offset, the counter is entirely derived from it so any sector can be decrypted independently
          */
-        void UpdateCtr(u64 offset);
+        crypto::KeyStore::Key128 GetCtr(u64 offset) const;
+
+        /**
+         * @brief Reads and decrypts data from the underlying backing directly into the output without going through the cache
+         * @param offset The offset to read from, this must be aligned to the AES sector size
+         * @note Large reads are decrypted in parallel with a separate cipher for each chunk
+         */
+        size_t ReadDecrypted(span<u8> output, size_t offset);
 
       protected:
         size_t ReadImpl(span<u8> output, size_t offset) override;
 
       public:
         CtrEncryptedBacking(crypto::KeyStore::Key128 ctr, crypto::KeyStore::Key128 key, std::shared_ptr<Backing> backing, size_t baseOffset);
+
+        ~CtrEncryptedBacking();
     };
 }
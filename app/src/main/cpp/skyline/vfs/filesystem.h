@@ -32,6 +32,8 @@ namespace skyline::vfs {
             throw exception("This filesystem does not support opening directories");
         };
 
+        virtual void CommitImpl() {}
+
       public:
         FileSystem() = default;
 
@@ -56,6 +58,13 @@ namespace skyline::vfs {
             DeleteFileImpl(path);
         }
 
+        /**
+         * @brief Writes out all pending changes to files in the filesystem
+         */
+        void Commit() {
+            CommitImpl();
+        }
+
         /**
          * @brief Creates a directory in the filesystem
          * @param path The path to where the directory should be created
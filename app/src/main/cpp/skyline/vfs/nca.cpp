@@ -2,6 +2,7 @@
 // Copyright © 2020 Skyline Team and Contributors (https://github.com/skyline-emu/)
 
 #include <crypto/aes_cipher.h>
+#include <crypto/sha256.h>
 #include <loader/loader.h>
 
 #include "ctr_encrypted_backing.h"
@@ -69,6 +70,120 @@ namespace skyline::vfs {
         romFs = CreateBacking(sectionHeader, std::make_shared<RegionBacking>(backing, offset, size), offset);
     }
 
+    bool NCA::VerifyIntegrity(const std::atomic<bool> &cancel) {
+        bool valid{true};
+        for (size_t i{}; i < header.sectionHeaders.size() && !cancel; i++) {
+            auto &sectionHeader{header.sectionHeaders[i]};
+            auto &entry{header.fsEntries[i]};
+            if (entry.endOffset <= entry.startOffset)
+                continue; // The section is unused
+
+            if (crypto::Sha256::Hash(span<const u8>{reinterpret_cast<const u8 *>(&sectionHeader), sizeof(NcaSectionHeader)}) != header.sectionHashes[i]) {
+                Logger::Error("NCA {:016X}: Header of section {} doesn't match its hash", header.programId, i);
+                valid = false;
+                continue;
+            }
+
+            size_t offset{static_cast<size_t>(entry.startOffset) * constant::MediaUnitSize};
+            size_t size{constant::MediaUnitSize * static_cast<size_t>(entry.endOffset - entry.startOffset)};
+            auto section{CreateBacking(sectionHeader, std::make_shared<RegionBacking>(backing, offset, size), offset)};
+            if (!section)
+                continue; // Sections with an unsupported encryption type can't be decrypted and as such can't be verified
+
+            bool sectionValid{true};
+            if (sectionHeader.fsType == NcaSectionFsType::PFS0 && sectionHeader.hashType == NcaSectionHashType::HierarchicalSha256)
+                sectionValid = VerifyHierarchicalSha256(sectionHeader.sha256HashInfo, *section, cancel);
+            else if (sectionHeader.fsType == NcaSectionFsType::RomFs && sectionHeader.hashType == NcaSectionHashType::HierarchicalIntegrity)
+                sectionValid = VerifyHierarchicalIntegrity(sectionHeader.integrityHashInfo, *section, cancel);
+
+            if (!sectionValid) {
+                Logger::Error("NCA {:016X}: Contents of section {} don't match their hashes", header.programId, i);
+                valid = false;
+            }
+        }
+
+        return valid;
+    }
+
+    /**
+     * @brief Hashes consecutive blocks of a region and compares them against a table of SHA-256 hashes
+     * @param padLastBlock If a trailing partial block is hashed as if it were zero-padded to the block size rather than as-is
+     * @return If all blocks match their hashes or verification was cancelled
+     */
+    static bool VerifyBlocks(Backing &backing, size_t offset, size_t size, size_t blockSize, span<const u8> hashes, bool padLastBlock, const std::atomic<bool> &cancel) {
+        constexpr size_t HashSize{sizeof(crypto::Sha256::Digest)};
+        constexpr size_t ReadSize{0x100000}; //!< The amount of data read at once when the backing can't provide a view, this amortizes the per-read overhead of decryption across blocks
+
+        if (blockSize == 0 || hashes.size() < util::DivideCeil(size, blockSize) * HashSize)
+            return false;
+
+        std::vector<u8> buffer;
+        std::vector<u8> padding;
+        size_t chunkSize{std::max(util::AlignDown(ReadSize, blockSize), blockSize)};
+        for (size_t chunkOffset{}, block{}; chunkOffset < size; chunkOffset += chunkSize) {
+            if (cancel)
+                return true;
+
+            size_t readSize{std::min(chunkSize, size - chunkOffset)};
+            span<u8> chunk{backing.View(offset + chunkOffset, readSize)};
+            if (!chunk.valid()) {
+                buffer.resize(readSize);
+                backing.Read(buffer, offset + chunkOffset);
+                chunk = buffer;
+            }
+
+            for (size_t blockOffset{}; blockOffset < readSize; blockOffset += blockSize, block++) {
+                size_t dataSize{std::min(blockSize, readSize - blockOffset)};
+
+                crypto::Sha256 hasher;
+                hasher.Update(chunk.subspan(blockOffset, dataSize));
+                if (padLastBlock && dataSize != blockSize) {
+                    padding.resize(blockSize - dataSize);
+                    hasher.Update(padding);
+                }
+
+                auto digest{hasher.Finalize()};
+                if (std::memcmp(digest.data(), hashes.data() + block * HashSize, HashSize) != 0)
+                    return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool NCA::VerifyHierarchicalSha256(const HierarchicalSha256HashInfo &hashInfo, Backing &section, const std::atomic<bool> &cancel) {
+        std::vector<u8> hashTable(hashInfo.hashTableSize);
+        section.Read(hashTable, hashInfo.hashTableOffset);
+        if (crypto::Sha256::Hash(hashTable) != hashInfo.hashTableHash)
+            return false;
+
+        return VerifyBlocks(section, hashInfo.pfs0Offset, hashInfo.pfs0Size, hashInfo.blockSize, hashTable, false, cancel);
+    }
+
+    bool NCA::VerifyHierarchicalIntegrity(const HierarchicalIntegrityHashInfo &hashInfo, Backing &section, const std::atomic<bool> &cancel) {
+        // The level count includes the master hash which isn't stored as a level
+        if (hashInfo.numLevels < 2 || hashInfo.masterHashSize > hashInfo.masterHash.size())
+            return false;
+        size_t levelCount{std::min<size_t>(hashInfo.numLevels - 1, hashInfo.levels.size())};
+
+        std::vector<u8> hashes(hashInfo.masterHash.begin(), hashInfo.masterHash.begin() + hashInfo.masterHashSize);
+        for (size_t i{}; i < levelCount && !cancel; i++) {
+            auto &level{hashInfo.levels[i]};
+            if (level.blockSize >= 32)
+                return false;
+            if (!VerifyBlocks(section, level.offset, level.size, size_t{1} << level.blockSize, hashes, true, cancel))
+                return false;
+
+            // The data level is the last one and isn't read in its entirety as it holds no hashes
+            if (i + 1 != levelCount) {
+                hashes.resize(level.size);
+                section.Read(hashes, level.offset);
+            }
+        }
+
+        return true;
+    }
+
     std::shared_ptr<Backing> NCA::CreateBacking(const NcaSectionHeader &sectionHeader, std::shared_ptr<Backing> rawBacking, size_t offset) {
         if (!encrypted)
             return rawBacking;
@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <crypto/key_store.h>
 #include <crypto/aes_cipher.h>
 #include "filesystem.h"
@@ -181,6 +182,17 @@ namespace skyline {
 
             std::shared_ptr<Backing> CreateBacking(const NcaSectionHeader &sectionHeader, std::shared_ptr<Backing> rawBacking, size_t offset);
 
+            /**
+             * @brief Verifies the PFS0 region of a section against its hash table, which is in turn verified against the hash in the section header
+             * @param section The decrypted backing of the entire section
+             */
+            static bool VerifyHierarchicalSha256(const HierarchicalSha256HashInfo &hashInfo, Backing &section, const std::atomic<bool> &cancel);
+
+            /**
+             * @brief Verifies every level of an IVFC hash tree starting from the master hash, each level holds the hashes of the blocks of the next level
+             */
+            static bool VerifyHierarchicalIntegrity(const HierarchicalIntegrityHashInfo &hashInfo, Backing &section, const std::atomic<bool> &cancel);
+
             u8 GetKeyGeneration();
 
             crypto::KeyStore::Key128 GetTitleKey();
@@ -195,6 +207,14 @@ namespace skyline {
             NcaContentType contentType; //!< The content type of the NCA
 
             NCA(std::shared_ptr<vfs::Backing> backing, std::shared_ptr<crypto::KeyStore> keyStore, bool useKeyArea = false);
+
+            /**
+             * @brief Verifies the section headers against the hashes in the NCA header and the contents of all PFS0 and RomFS sections against their hash trees
+             * @param cancel Verification stops early when this is set, any data that wasn't reached is treated as valid
+             * @return If no hash mismatches were found, mismatches are logged as they're found
+             * @note This reads the entire NCA and as such shouldn't be done on any latency-sensitive thread
+             */
+            bool VerifyIntegrity(const std::atomic<bool> &cancel);
         };
     }
 }
@@ -3,6 +3,7 @@
 
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
 #include <unistd.h>
 #include "os_backing.h"
 
@@ -13,14 +14,42 @@ namespace skyline::vfs {
             throw exception("Failed to stat fd: {}", strerror(errno));
 
         size = static_cast<size_t>(fileInfo.st_size);
+
+        // Writable files aren't mapped as the size of the mapping would need to track the size of the file
+        if (!mode.write && !mode.append && size) {
+            void *address{mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0)};
+            if (address != MAP_FAILED)
+                mapping = span{static_cast<u8 *>(address), size};
+            else
+                Logger::Debug("Failed to map fd, falling back to pread: {}", strerror(errno)); // Not all FDs can be mapped (e.g. pipes from content providers)
+        }
     }
 
     OsBacking::~OsBacking() {
+        if (mapping.valid())
+            munmap(mapping.data(), mapping.size());
+
         if (closable)
             close(fd);
     }
 
     size_t OsBacking::ReadImpl(span<u8> output, size_t offset) {
+        if (mapping.valid()) {
+            if (offset >= mapping.size())
+                return 0;
+
+            auto source{mapping.subspan(offset, std::min(output.size(), mapping.size() - offset))};
+            if (source.size() >= WillNeedThreshold) {
+                // Large reads are paged in by the kernel asynchronously rather than faulting on every page as they are copied
+                auto alignedStart{util::AlignDown(reinterpret_cast<uintptr_t>(source.data()), constant::PageSize)};
+                madvise(reinterpret_cast<void *>(alignedStart), reinterpret_cast<uintptr_t>(source.data() + source.size()) - alignedStart, MADV_WILLNEED);
+            }
+
+            // Unlike pread, faults on the output from copying into a trapped region go through the signal handlers so no intermediate buffer is required
+            std::memcpy(output.data(), source.data(), source.size());
+            return source.size();
+        }
+
         size_t bytesRead{};
         while (bytesRead < output.size()) {
             auto ret{pread64(fd, output.data() + bytesRead, output.size() - bytesRead, static_cast<off64_t>(offset + bytesRead))};
@@ -47,6 +76,14 @@ namespace skyline::vfs {
         return output.size();
     }
 
+    span<u8> OsBacking::ViewImpl(size_t offset, size_t size) {
+        if (!mapping.valid())
+            return {};
+
+        // The mapping is never resized as the file is read-only so the view remains valid for the lifetime of the backing
+        return mapping.subspan(offset, size);
+    }
+
     size_t OsBacking::WriteImpl(span<u8> input, size_t offset) {
         auto ret{pwrite64(fd, input.data(), input.size(), static_cast<off64_t>(offset))};
         if (ret < 0)
@@ -62,4 +99,9 @@ namespace skyline::vfs {
 
         size = pSize;
     }
+
+    void OsBacking::FlushImpl() {
+        if ((mode.write || mode.append) && fdatasync(fd))
+            throw exception("Failed to sync file: {}", strerror(errno));
+    }
 }
@@ -8,11 +8,15 @@
 namespace skyline::vfs {
     /**
      * @brief The OsBacking class provides the backing abstractions for a physical linux file
+     * @note Read-only files are memory-mapped when possible so reads don't require any syscalls and views of them can be provided
      */
     class OsBacking : public Backing {
       private:
+        static constexpr size_t WillNeedThreshold{0x10000}; //!< The minimum size of a read from a mapping for the kernel to be asked to page in the entire range upfront
+
         int fd; //!< An FD to the backing
         bool closable; //!< Whether the FD can be closed when the backing is destroyed
+        span<u8> mapping; //!< A read-only shared mapping of the entire file, this is invalid if the file couldn't be mapped
 
       protected:
         size_t ReadImpl(span<u8> output, size_t offset) override;
@@ -21,6 +25,10 @@ namespace skyline::vfs {
 
         void ResizeImpl(size_t size) override;
 
+        span<u8> ViewImpl(size_t offset, size_t size) override;
+
+        void FlushImpl() override;
+
       public:
         /**
          * @param fd The file descriptor of the backing
@@ -6,10 +6,49 @@
 #include <dirent.h>
 #include <unistd.h>
 #include "os_backing.h"
+#include "buffered_backing.h"
 #include "os_filesystem.h"
 
 namespace skyline::vfs {
-    OsFileSystem::OsFileSystem(const std::string &basePath) : FileSystem(), basePath(basePath.ends_with('/') ? basePath : basePath + '/') {
+    /**
+     * @brief The buffered backings of all files that are currently open for writing by their host path, all opens of a file share one so every handle sees buffered writes
+     */
+    struct BufferedBackingRegistry {
+        std::mutex mutex;
+        std::unordered_map<std::string, std::weak_ptr<BufferedBacking>> backings;
+
+        /**
+         * @return The live buffered backing for the supplied path, if any
+         * @note The mutex must be locked when calling this
+         */
+        std::shared_ptr<BufferedBacking> Find(const std::string &path) {
+            auto it{backings.find(path)};
+            if (it == backings.end())
+                return nullptr;
+
+            auto backing{it->second.lock()};
+            if (!backing)
+                backings.erase(it);
+            return backing;
+        }
+
+        /**
+         * @brief Drops any buffered data of the file at the supplied path, this is done when the file is deleted or recreated
+         */
+        void Discard(const std::string &path) {
+            std::scoped_lock lock{mutex};
+            if (auto backing{Find(path)})
+                backing->Discard();
+            backings.erase(path);
+        }
+    };
+
+    static BufferedBackingRegistry &GetBufferedBackings() {
+        static BufferedBackingRegistry registry;
+        return registry;
+    }
+
+    OsFileSystem::OsFileSystem(const std::string &basePath, bool bufferWrites) : FileSystem(), basePath(basePath.ends_with('/') ? basePath : basePath + '/'), bufferWrites(bufferWrites) {
         if (!DirectoryExists(""))
             if (!CreateDirectory("", true))
                 throw exception("Error creating the OS filesystem backing directory");
@@ -17,6 +56,8 @@ namespace skyline::vfs {
 
     bool OsFileSystem::CreateFileImpl(const std::string &path, size_t size) {
         auto fullPath{basePath + path};
+        if (bufferWrites)
+            GetBufferedBackings().Discard(fullPath);
 
         // Create a directory that will hold the file
         CreateDirectory(path.substr(0, path.find_last_of('/')), true);
@@ -40,6 +81,8 @@ namespace skyline::vfs {
 
     void OsFileSystem::DeleteFileImpl(const std::string &path) {
         auto fullPath{basePath + path};
+        if (bufferWrites)
+            GetBufferedBackings().Discard(fullPath);
         remove(fullPath.c_str());
     }
 
@@ -66,6 +109,20 @@ namespace skyline::vfs {
     }
 
     std::shared_ptr<Backing> OsFileSystem::OpenFileImpl(const std::string &path, Backing::Mode mode) {
+        if (bufferWrites) {
+            auto fullPath{basePath + path};
+            auto &registry{GetBufferedBackings()};
+            std::scoped_lock lock{registry.mutex};
+            if (auto backing{registry.Find(fullPath)})
+                return backing; // Reads of a file with buffered writes must go through the buffer to observe them
+
+            if (mode.write || mode.append) {
+                auto backing{std::make_shared<BufferedBacking>(fullPath, mode)};
+                registry.backings[fullPath] = backing;
+                return backing;
+            }
+        }
+
         int fd{open((basePath + path).c_str(), (mode.read && mode.write) ? O_RDWR : (mode.write ? O_WRONLY : O_RDONLY))};
         if (fd < 0)
             throw exception("Failed to open file at '{}': {}", path, strerror(errno));
@@ -73,6 +130,24 @@ namespace skyline::vfs {
         return std::make_shared<OsBacking>(fd, true, mode);
     }
 
+    void OsFileSystem::CommitImpl() {
+        if (!bufferWrites)
+            return;
+
+        std::vector<std::shared_ptr<BufferedBacking>> backings;
+        {
+            auto &registry{GetBufferedBackings()};
+            std::scoped_lock lock{registry.mutex};
+            for (const auto &[path, weakBacking] : registry.backings)
+                if (path.starts_with(basePath))
+                    if (auto backing{weakBacking.lock()})
+                        backings.push_back(std::move(backing));
+        }
+
+        for (const auto &backing : backings)
+            backing->Flush();
+    }
+
     std::optional<Directory::EntryType> OsFileSystem::GetEntryTypeImpl(const std::string &path) {
         auto fullPath{basePath + path};
 
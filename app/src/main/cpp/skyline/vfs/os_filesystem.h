@@ -12,6 +12,7 @@ namespace skyline::vfs {
     class OsFileSystem : public FileSystem {
       private:
         std::string basePath; //!< The base path for filesystem operations
+        bool bufferWrites; //!< If files opened for writing are wrapped in a BufferedBacking
 
       protected:
         bool CreateFileImpl(const std::string &path, size_t size) override;
@@ -26,8 +27,13 @@ namespace skyline::vfs {
 
         std::shared_ptr<Directory> OpenDirectoryImpl(const std::string &path, Directory::ListMode listMode) override;
 
+        void CommitImpl() override;
+
       public:
-        OsFileSystem(const std::string &basePath);
+        /**
+         * @param bufferWrites If writes should be coalesced in memory and only written out on flushes, commits or when a file is closed, this is intended for save data where guests often do many small writes
+         */
+        OsFileSystem(const std::string &basePath, bool bufferWrites = false);
     };
 
     /**
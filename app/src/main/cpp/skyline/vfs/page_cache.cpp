@@ -0,0 +1,49 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2023 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#include "page_cache.h"
+
+namespace skyline::vfs {
+    PageCache &PageCache::Get() {
+        static PageCache cache;
+        return cache;
+    }
+
+    PageCache::BlockData PageCache::Lookup(u64 id, size_t index) {
+        std::scoped_lock lock{mutex};
+        auto it{blocks.find(Key{id, index})};
+        if (it == blocks.end())
+            return nullptr;
+
+        lru.splice(lru.begin(), lru, it->second);
+        return it->second->data;
+    }
+
+    void PageCache::Insert(u64 id, size_t index, BlockData data) {
+        std::scoped_lock lock{mutex};
+        Key key{id, index};
+        if (blocks.contains(key))
+            return; // Another thread decoded the same block concurrently, the data is identical so the existing block is kept
+
+        while (!lru.empty() && cachedSize + data->size() > Capacity) {
+            auto &block{lru.back()};
+            cachedSize -= block.data->size();
+            blocks.erase(block.key);
+            lru.pop_back();
+        }
+
+        cachedSize += data->size();
+        lru.push_front(Block{key, std::move(data)});
+        blocks.emplace(key, lru.begin());
+    }
+
+    void PageCache::Evict(u64 id) {
+        std::scoped_lock lock{mutex};
+        auto it{blocks.lower_bound(Key{id, 0})};
+        while (it != blocks.end() && it->first.first == id) {
+            cachedSize -= it->second->data->size();
+            lru.erase(it->second);
+            it = blocks.erase(it);
+        }
+    }
+}
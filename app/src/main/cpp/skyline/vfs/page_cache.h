@@ -0,0 +1,59 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2023 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#pragma once
+
+#include <common.h>
+
+namespace skyline::vfs {
+    /**
+     * @brief A global size-bounded LRU cache of fixed-size blocks of decoded backing data, this avoids decoding the same data again when titles repeatedly read the same files
+     * @note Backings are identified by an ID allocated from the cache rather than their address so a new backing allocated at the same address can never hit stale blocks
+     */
+    class PageCache {
+      public:
+        static constexpr size_t BlockSize{0x40000}; //!< The size of a single cached block, this is a multiple of the AES sector size so blocks can be decrypted independently
+        static constexpr size_t Capacity{0x4000000}; //!< The maximum total size of all cached blocks
+
+        using BlockData = std::shared_ptr<const std::vector<u8>>; //!< Blocks are shared so they can be copied from without holding the cache lock
+
+      private:
+        using Key = std::pair<u64, size_t>; //!< The ID of the backing and the index of the block within it
+
+        struct Block {
+            Key key;
+            BlockData data;
+        };
+
+        std::mutex mutex;
+        std::list<Block> lru; //!< All cached blocks ordered from most to least recently used
+        std::map<Key, std::list<Block>::iterator> blocks; //!< An ordered map so all blocks of a single backing are contiguous
+        size_t cachedSize{}; //!< The total size of the data in all cached blocks
+        std::atomic<u64> nextId{1};
+
+      public:
+        static PageCache &Get();
+
+        /**
+         * @return A unique ID to identify the blocks of a backing with
+         */
+        u64 AllocateId() {
+            return nextId.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        /**
+         * @return The data of the block if it's cached, otherwise nullptr
+         */
+        BlockData Lookup(u64 id, size_t index);
+
+        /**
+         * @brief Inserts a block into the cache, evicting the least recently used blocks until it fits
+         */
+        void Insert(u64 id, size_t index, BlockData data);
+
+        /**
+         * @brief Evicts all blocks of a backing, this should be called when it's destroyed as its blocks can never be hit again
+         */
+        void Evict(u64 id);
+    };
+}
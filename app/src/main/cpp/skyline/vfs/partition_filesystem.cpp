@@ -19,25 +19,43 @@ namespace skyline::vfs {
         size_t stringTableOffset{sizeof(FsHeader) + (header.numFiles * entrySize)};
         fileDataOffset = stringTableOffset + header.stringTableSize;
 
-        std::vector<char> stringTable(header.stringTableSize + 1);
-        backing->Read(span(stringTable).first(header.stringTableSize), stringTableOffset);
-        stringTable[header.stringTableSize] = 0;
+        // The string table is used directly from the backing when it's memory-mapped, otherwise it's read into a buffer
+        std::vector<u8> stringTableBuffer;
+        span<u8> stringTable{backing->View(stringTableOffset, header.stringTableSize)};
+        if (!stringTable.valid()) {
+            stringTableBuffer.resize(header.stringTableSize);
+            backing->Read(stringTableBuffer, stringTableOffset);
+            stringTable = stringTableBuffer;
+        }
 
         for (u32 entryOffset{sizeof(FsHeader)}; entryOffset < header.numFiles * entrySize; entryOffset += entrySize) {
             auto entry{backing->Read<PartitionFileEntry>(entryOffset)};
+            if (entry.stringTableOffset >= stringTable.size())
+                throw exception("Partition file entry name is outside the string table: 0x{:X}/0x{:X}", entry.stringTableOffset, stringTable.size());
 
-            std::string name(&stringTable[entry.stringTableOffset]);
+            std::string name{stringTable.subspan(entry.stringTableOffset).as_string(true)};
             fileMap.emplace(name, entry);
         }
     }
 
     std::shared_ptr<Backing> PartitionFileSystem::OpenFileImpl(const std::string &path, Backing::Mode mode) {
-        try {
-            auto &entry{fileMap.at(path)};
-            return std::make_shared<RegionBacking>(backing, fileDataOffset + entry.offset, entry.size, mode);
-        } catch (std::out_of_range &e) {
+        auto entry{fileMap.find(path)};
+        if (entry == fileMap.end())
             return nullptr;
-        }
+
+        std::scoped_lock lock{openFilesMutex};
+        // Entries for files which have since been closed would otherwise accumulate for every path that was ever opened
+        std::erase_if(openFiles, [](const auto &openFile) { return openFile.second.expired(); });
+
+        // Only the flag bits of the mode are used for the key as the remaining bits of the union aren't guaranteed to be initialized
+        u32 modeFlags{static_cast<u32>(mode.read) | (static_cast<u32>(mode.write) << 1) | (static_cast<u32>(mode.append) << 2)};
+        auto &openFile{openFiles[{path, modeFlags}]};
+        if (auto file{openFile.lock()})
+            return file;
+
+        auto file{std::make_shared<RegionBacking>(backing, fileDataOffset + entry->second.offset, entry->second.size, mode)};
+        openFile = file;
+        return file;
     }
 
     std::optional<Directory::EntryType> PartitionFileSystem::GetEntryTypeImpl(const std::string &path) {
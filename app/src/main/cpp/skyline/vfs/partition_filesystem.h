@@ -38,6 +38,8 @@ namespace skyline::vfs {
         size_t fileDataOffset; //!< The offset from the backing to the base of the file data
         std::shared_ptr<Backing> backing; //!< The backing file of the filesystem
         std::unordered_map<std::string, PartitionFileEntry> fileMap; //!< A map that maps file names to their corresponding entry
+        std::mutex openFilesMutex;
+        std::map<std::pair<std::string, u32>, std::weak_ptr<Backing>> openFiles; //!< The backings of files that are currently open keyed by their path and mode, these are shared by all opens of a file with the same mode as they're read-only
 
       protected:
         std::shared_ptr<Backing> OpenFileImpl(const std::string &path, Backing::Mode mode) override;
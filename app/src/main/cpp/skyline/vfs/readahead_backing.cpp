@@ -0,0 +1,101 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2023 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#include <common/thread_pool.h>
+#include "readahead_backing.h"
+
+namespace skyline::vfs {
+    /**
+     * @return The pool shared by all readahead backings, reads are I/O-bound so a couple of threads suffices to keep several files streaming
+     */
+    static ThreadPool &GetReadaheadPool() {
+        static ThreadPool pool{2, "Readahead"};
+        return pool;
+    }
+
+    ReadaheadBacking::ReadaheadBacking(std::shared_ptr<Backing> pBacking) : Backing({true, false, false}, pBacking->size), backing{std::move(pBacking)} {
+        if (backing->mode.write || backing->mode.append)
+            throw exception("Cannot wrap a writable backing with a ReadaheadBacking");
+    }
+
+    void ReadaheadBacking::ReadAhead() {
+        // Skip past the chain of windows covering the read position, every pass can only advance past a single window as they aren't sorted
+        size_t aheadOffset{nextOffset};
+        for (size_t pass{}; pass < WindowCount; pass++)
+            for (const auto &window : windows)
+                if (window && window->offset <= aheadOffset && aheadOffset < window->offset + window->size)
+                    aheadOffset = window->offset + window->size;
+
+        if (aheadOffset >= size || aheadOffset >= nextOffset + WindowSize)
+            return; // There's already a window's worth of data past the read position being read ahead
+
+        // Any window outside the chain is stale and can be replaced, this can only fail to find one if every window is in the chain which the check above excludes
+        auto slot{std::find_if(windows.begin(), windows.end(), [&](const auto &window) {
+            return !window || window->offset + window->size <= nextOffset || window->offset > aheadOffset;
+        })};
+        if (slot == windows.end())
+            slot = windows.begin();
+
+        auto window{std::make_shared<Window>(aheadOffset, std::min(WindowSize, size - aheadOffset))};
+        *slot = window;
+
+        GetReadaheadPool().Submit([backing = backing, window] {
+            std::vector<u8> data(window->size);
+            size_t read{};
+            try {
+                read = backing->ReadUnchecked(data, window->offset);
+            } catch (const std::exception &e) {
+                Logger::Warn("Failed to read ahead 0x{:X} bytes at 0x{:X}: {}", window->size, window->offset, e.what());
+            }
+            data.resize(read);
+
+            {
+                std::scoped_lock lock{window->mutex};
+                window->data = std::move(data);
+                window->ready = true;
+            }
+            window->condition.notify_all();
+        });
+    }
+
+    size_t ReadaheadBacking::ReadImpl(span<u8> output, size_t offset) {
+        std::array<std::shared_ptr<Window>, WindowCount> currentWindows;
+        {
+            std::scoped_lock lock{mutex};
+            sequentialReads = (offset == nextOffset) ? sequentialReads + 1 : 0;
+            nextOffset = offset + output.size();
+
+            // A copy of the windows is taken prior to reading ahead as it may replace a window this read still needs
+            currentWindows = windows;
+            if (sequentialReads >= SequentialReadThreshold)
+                ReadAhead();
+        }
+
+        // Copy out as much of the read as possible from the windows, a window that's still being read is waited on as that's cheaper than reading the same data again
+        size_t copied{};
+        while (copied < output.size()) {
+            size_t position{offset + copied};
+            auto it{std::find_if(currentWindows.begin(), currentWindows.end(), [position](const auto &window) {
+                return window && window->offset <= position && position < window->offset + window->size;
+            })};
+            if (it == currentWindows.end())
+                break;
+
+            auto &window{**it};
+            std::unique_lock lock{window.mutex};
+            window.condition.wait(lock, [&window] { return window.ready; });
+
+            size_t windowOffset{position - window.offset};
+            if (windowOffset >= window.data.size())
+                break; // The window was read short, the remainder is read directly to determine the actual amount that can be read
+
+            size_t amount{std::min(output.size() - copied, window.data.size() - windowOffset)};
+            std::memcpy(output.data() + copied, window.data.data() + windowOffset, amount);
+            copied += amount;
+        }
+
+        if (copied < output.size())
+            copied += backing->ReadUnchecked(output.subspan(copied), offset + copied);
+        return copied;
+    }
+}
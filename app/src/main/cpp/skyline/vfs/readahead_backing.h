@@ -0,0 +1,55 @@
+// SPDX-License-Identifier: MPL-2.0
+// Copyright © 2023 Skyline Team and Contributors (https://github.com/skyline-emu/)
+
+#pragma once
+
+#include "backing.h"
+
+namespace skyline::vfs {
+    /**
+     * @brief A read-only backing which detects sequential access to an underlying backing and asynchronously reads ahead of it into a small cache of windows
+     * @note Readahead goes through the entire underlying backing chain, so any decryption is done in the background as well
+     */
+    class ReadaheadBacking : public Backing {
+      private:
+        static constexpr size_t WindowSize{0x40000}; //!< The size of a single readahead window, this covers several of the 64 KiB reads commonly used for streaming assets
+        static constexpr size_t WindowCount{2}; //!< The amount of windows, one is consumed by reads while the next one is read ahead
+        static constexpr size_t SequentialReadThreshold{2}; //!< The amount of consecutive sequential reads after which readahead is started
+
+        /**
+         * @brief A contiguous region of the backing that is read asynchronously
+         */
+        struct Window {
+            size_t offset; //!< The offset of the window in the backing
+            size_t size; //!< The size of the region requested to be read, this can be larger than the data actually read
+            std::vector<u8> data; //!< The data that was read, this must only be accessed after the window is ready
+            bool ready{}; //!< If the read has completed, this is set even if the read failed
+            std::mutex mutex;
+            std::condition_variable condition; //!< Signalled when the read has completed
+
+            Window(size_t offset, size_t size) : offset{offset}, size{size} {}
+        };
+
+        std::shared_ptr<Backing> backing;
+        std::mutex mutex; //!< Synchronizes the sequential access state and the windows
+        size_t nextOffset{}; //!< The offset a read would start at if it sequentially followed the last read
+        size_t sequentialReads{}; //!< The amount of consecutive reads that have followed the one before them
+        std::array<std::shared_ptr<Window>, WindowCount> windows; //!< The windows are shared with the readahead tasks filling them, which allows them to be dropped at any point
+
+        /**
+         * @brief Queues a read of the next window after the current read position if one isn't already present
+         * @note The mutex must be locked when calling this
+         */
+        void ReadAhead();
+
+      protected:
+        size_t ReadImpl(span<u8> output, size_t offset) override;
+
+        span<u8> ViewImpl(size_t offset, size_t size) override {
+            return backing->View(offset, size);
+        }
+
+      public:
+        ReadaheadBacking(std::shared_ptr<Backing> backing);
+    };
+}
@@ -8,6 +8,7 @@
 namespace skyline::vfs {
     /**
      * @brief The RegionBacking class provides a way to create a new, smaller backing from a region of an existing backing
+     * @note Regions of regions are flattened into a single region of the outermost non-region backing, so nested containers don't add a layer of indirection for every level
      */
     class RegionBacking : public Backing {
       private:
@@ -19,15 +20,24 @@ namespace skyline::vfs {
             return backing->ReadUnchecked(output, baseOffset + offset);
         }
 
+        span<u8> ViewImpl(size_t offset, size_t size) override {
+            return backing->View(baseOffset + offset, size);
+        }
+
       public:
         /**
          * @param file The backing to create the RegionBacking from
          * @param offset The offset of the region start within the parent backing
          * @param size The size of the region in the parent backing
          */
-        RegionBacking(const std::shared_ptr<vfs::Backing> &backing, size_t offset, size_t size, Mode mode = {true, false, false}) : Backing(mode, size), backing(backing), baseOffset(offset) {
+        RegionBacking(const std::shared_ptr<vfs::Backing> &pBacking, size_t offset, size_t size, Mode mode = {true, false, false}) : Backing(mode, size), backing(pBacking), baseOffset(offset) {
             if (mode.write || mode.append)
                 throw exception("Cannot open a RegionBacking as writable");
+
+            if (auto parent{std::dynamic_pointer_cast<RegionBacking>(pBacking)}) {
+                backing = parent->backing;
+                baseOffset += parent->baseOffset;
+            }
         };
     };
 }
@@ -7,73 +7,138 @@
 namespace skyline::vfs {
     RomFileSystem::RomFileSystem(std::shared_ptr<Backing> pBacking) : FileSystem(), backing(std::move(pBacking)) {
         header = backing->Read<RomFsHeader>();
-        TraverseDirectory(0, "");
     }
 
-    void RomFileSystem::TraverseFiles(u32 offset, const std::string &path) {
-        RomFsFileEntry entry;
-        do {
-            entry = backing->Read<RomFsFileEntry>(header.fileMetaTableOffset + offset);
-
-            if (entry.nameSize) {
-                std::vector<char> name(entry.nameSize);
-                backing->Read(span(name), header.fileMetaTableOffset + offset + sizeof(RomFsFileEntry));
+    void RomFileSystem::LoadTables() {
+        std::call_once(tablesFlag, [this] {
+            auto loadTable{[this](u64 offset, u64 size, std::vector<u8> &buffer) -> span<u8> {
+                auto view{backing->View(offset, size)};
+                if (view.valid())
+                    return view;
+
+                buffer.resize(size);
+                backing->Read(buffer, offset);
+                return buffer;
+            }};
+
+            dirHashTable = loadTable(header.dirHashTableOffset, header.dirHashTableSize, tableBuffers[0]);
+            dirMetaTable = loadTable(header.dirMetaTableOffset, header.dirMetaTableSize, tableBuffers[1]);
+            fileHashTable = loadTable(header.fileHashTableOffset, header.fileHashTableSize, tableBuffers[2]);
+            fileMetaTable = loadTable(header.fileMetaTableOffset, header.fileMetaTableSize, tableBuffers[3]);
+        });
+    }
 
-                std::string fullPath{path + (path.empty() ? "" : "/") + std::string(name.data(), entry.nameSize)};
-                fileMap.emplace(fullPath, entry);
-            }
+    /**
+     * @return The entry at the supplied offset in a metadata table and its name, if it's entirely within the table
+     */
+    template<typename EntryType>
+    static std::optional<std::pair<EntryType, std::string_view>> GetEntry(span<u8> metaTable, u32 offset) {
+        if (offset > metaTable.size() || metaTable.size() - offset < sizeof(EntryType))
+            return std::nullopt;
+
+        EntryType entry;
+        std::memcpy(&entry, metaTable.data() + offset, sizeof(EntryType)); // Entries are only 4-byte aligned while file entries contain 8-byte fields
+        size_t nameOffset{offset + sizeof(EntryType)};
+        if (metaTable.size() - nameOffset < entry.nameSize)
+            return std::nullopt;
+
+        return std::pair{entry, std::string_view{reinterpret_cast<const char *>(metaTable.data() + nameOffset), entry.nameSize}};
+    }
 
-            offset = entry.siblingOffset;
-        } while (offset != constant::RomFsEmptyEntry);
+    /**
+     * @brief Hashes the name of an entry with the offset of its parent directory in the same way the hash tables of a RomFS image are built
+     */
+    static u32 HashEntryName(u32 parentOffset, std::string_view name) {
+        u32 hash{parentOffset ^ 123456789};
+        for (char character : name)
+            hash = ((hash >> 5) | (hash << 27)) ^ static_cast<u8>(character);
+        return hash;
     }
 
-    void RomFileSystem::TraverseDirectory(u32 offset, const std::string &path) {
-        auto entry{backing->Read<RomFsDirectoryEntry>(header.dirMetaTableOffset + offset)};
+    template<typename EntryType>
+    std::optional<u32> RomFileSystem::FindEntry(span<u8> hashTable, span<u8> metaTable, u32 parentOffset, std::string_view name) {
+        auto buckets{hashTable.cast<u32, std::dynamic_extent, true>()};
+        if (buckets.empty())
+            return std::nullopt;
+
+        u32 offset{buckets[HashEntryName(parentOffset, name) % buckets.size()]};
+        size_t remainingEntries{metaTable.size() / sizeof(EntryType)}; // A bound on the chain length prevents looping forever on a malformed image
+        while (offset != constant::RomFsEmptyEntry && remainingEntries--) {
+            auto entry{GetEntry<EntryType>(metaTable, offset)};
+            if (!entry)
+                return std::nullopt;
+
+            if (entry->first.parentOffset == parentOffset && entry->second == name)
+                return offset;
+
+            offset = entry->first.hashSiblingOffset;
+        }
+
+        return std::nullopt;
+    }
 
-        std::string childPath(path);
-        if (entry.nameSize) {
-            std::vector<char> name(entry.nameSize);
-            backing->Read(span(name), header.dirMetaTableOffset + offset + sizeof(RomFsDirectoryEntry));
-            childPath = path + (path.empty() ? "" : "/") + std::string(name.data(), entry.nameSize);
+    std::optional<u32> RomFileSystem::FindDirectory(std::string_view path) {
+        u32 offset{}; // The root directory is always the first entry
+        while (!path.empty()) {
+            auto separator{path.find('/')};
+            auto name{path.substr(0, separator)};
+            path = (separator == std::string_view::npos) ? std::string_view{} : path.substr(separator + 1);
+            if (name.empty())
+                continue; // Leading, trailing and repeated separators are ignored
+
+            auto child{FindEntry<RomFsDirectoryEntry>(dirHashTable, dirMetaTable, offset, name)};
+            if (!child)
+                return std::nullopt;
+            offset = *child;
         }
 
-        directoryMap.emplace(childPath, entry);
+        return offset;
+    }
 
-        if (entry.fileOffset != constant::RomFsEmptyEntry)
-            TraverseFiles(entry.fileOffset, childPath);
+    std::optional<u32> RomFileSystem::FindFile(std::string_view path) {
+        auto separator{path.rfind('/')};
+        auto name{(separator == std::string_view::npos) ? path : path.substr(separator + 1)};
+        if (name.empty())
+            return std::nullopt;
 
-        if (entry.childOffset != constant::RomFsEmptyEntry)
-            TraverseDirectory(entry.childOffset, childPath);
+        auto parent{FindDirectory((separator == std::string_view::npos) ? std::string_view{} : path.substr(0, separator))};
+        if (!parent)
+            return std::nullopt;
 
-        if (entry.siblingOffset != constant::RomFsEmptyEntry)
-            TraverseDirectory(entry.siblingOffset, path);
+        return FindEntry<RomFsFileEntry>(fileHashTable, fileMetaTable, *parent, name);
     }
 
     std::shared_ptr<Backing> RomFileSystem::OpenFileImpl(const std::string &path, Backing::Mode mode) {
-        try {
-            const auto &entry{fileMap.at(path)};
-            return std::make_shared<RegionBacking>(backing, header.dataOffset + entry.offset, entry.size, mode);
-        } catch (std::out_of_range &e) {
+        LoadTables();
+        auto offset{FindFile(path)};
+        if (!offset)
             return nullptr;
-        }
+
+        auto entry{GetEntry<RomFsFileEntry>(fileMetaTable, *offset)};
+        return std::make_shared<RegionBacking>(backing, header.dataOffset + entry->first.offset, entry->first.size, mode);
     }
 
     std::optional<Directory::EntryType> RomFileSystem::GetEntryTypeImpl(const std::string &path) {
-        if (fileMap.count(path))
+        LoadTables();
+        if (FindFile(path))
             return Directory::EntryType::File;
-        else if (directoryMap.count(path))
+        else if (FindDirectory(path))
             return Directory::EntryType::Directory;
 
         return std::nullopt;
     }
 
     std::shared_ptr<Directory> RomFileSystem::OpenDirectoryImpl(const std::string &path, Directory::ListMode listMode) {
-        try {
-            auto &entry{directoryMap.at(path)};
-            return std::make_shared<RomFileSystemDirectory>(backing, header, entry, listMode);
-        } catch (std::out_of_range &e) {
+        LoadTables();
+        auto offset{FindDirectory(path)};
+        if (!offset)
             return nullptr;
-        }
+
+        auto entry{GetEntry<RomFsDirectoryEntry>(dirMetaTable, *offset)};
+        if (!entry)
+            return nullptr; // The root directory entry is only validated here as lookups of it don't touch the metadata table
+
+        return std::make_shared<RomFileSystemDirectory>(backing, header, entry->first, listMode);
     }
 
     RomFileSystemDirectory::RomFileSystemDirectory(std::shared_ptr<Backing> backing, const RomFileSystem::RomFsHeader &header, const RomFileSystem::RomFsDirectoryEntry &ownEntry, ListMode listMode) : Directory(listMode), backing(std::move(backing)), header(header), ownEntry(ownEntry) {}
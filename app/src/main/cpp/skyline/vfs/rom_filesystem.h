@@ -13,24 +13,41 @@ namespace skyline {
     namespace vfs {
         /**
          * @brief The RomFileSystem class abstracts access to a RomFS image using the vfs::FileSystem api
+         * @note Paths are resolved with the hash tables in the RomFS image itself, these are loaded on the first lookup rather than traversing the entire tree upfront
          */
         class RomFileSystem : public FileSystem {
           private:
             std::shared_ptr<Backing> backing;
 
+            std::once_flag tablesFlag; //!< Ensures the metadata tables are only loaded once
+            std::array<std::vector<u8>, 4> tableBuffers; //!< The buffers the metadata tables are read into if the backing can't provide a view of them
+            span<u8> dirHashTable;
+            span<u8> dirMetaTable;
+            span<u8> fileHashTable;
+            span<u8> fileMetaTable;
+
+            /**
+             * @brief Loads all hash and metadata tables from the backing if they haven't been loaded already
+             */
+            void LoadTables();
+
             /**
-             * @brief Traverses the sibling files of the given file and adds them to the file map
-             * @param offset The offset of the file entry to traverses the siblings of
-             * @param path The path to the parent directory of the supplied file entry
+             * @brief Looks up the entry with the supplied name in a directory using a hash table
+             * @param parentOffset The offset of the entry of the directory in the directory metadata table
+             * @return The offset of the entry in the metadata table, if found
              */
-            void TraverseFiles(u32 offset, const std::string &path);
+            template<typename EntryType>
+            std::optional<u32> FindEntry(span<u8> hashTable, span<u8> metaTable, u32 parentOffset, std::string_view name);
 
             /**
-             * @brief Traverses the directories within the given directory, adds them to the directory map and calls TraverseFiles on them
-             * @param offset The offset of the directory entry to traverses the directories in
-             * @param path The path to the supplied directory entry
+             * @return The offset of the entry of the directory at the supplied path in the directory metadata table, if found
              */
-            void TraverseDirectory(u32 offset, const std::string &path);
+            std::optional<u32> FindDirectory(std::string_view path);
+
+            /**
+             * @return The offset of the entry of the file at the supplied path in the file metadata table, if found
+             */
+            std::optional<u32> FindFile(std::string_view path);
 
           protected:
             std::shared_ptr<Backing> OpenFileImpl(const std::string &path, Backing::Mode mode) override;
@@ -59,7 +76,7 @@ namespace skyline {
                 u32 siblingOffset; //!< The offset from the directory metadata base of a sibling directory
                 u32 childOffset; //!< The offset from the directory metadata base of a child directory
                 u32 fileOffset; //!< The offset from the file metadata base of a child file
-                u32 hash; //!< The hash of the directory
+                u32 hashSiblingOffset; //!< The offset from the directory metadata base of the next directory in the same hash table bucket
                 u32 nameSize; //!< The size of the directory's name in bytes
             };
 
@@ -68,13 +85,10 @@ namespace skyline {
                 u32 siblingOffset; //!< The offset from the file metadata base of a sibling file
                 u64 offset; //!< The offset from the file data base of the file contents
                 u64 size; //!< The size of the file in bytes
-                u32 hash; //!< The hash of the file
+                u32 hashSiblingOffset; //!< The offset from the file metadata base of the next file in the same hash table bucket
                 u32 nameSize; //!< The size of the file's name in bytes
             };
 
-            std::unordered_map<std::string, RomFsFileEntry> fileMap; //!< A map that maps file names to their corresponding entry
-            std::unordered_map<std::string, RomFsDirectoryEntry> directoryMap; //!< A map that maps directory names to their corresponding entry
-
             RomFileSystem(std::shared_ptr<Backing> backing);
         };
 
@@ -31,6 +31,8 @@ import emu.skyline.loader.getRomFormat
 import emu.skyline.utils.ByteBufferSerializable
 import emu.skyline.utils.GpuDriverHelper
 import emu.skyline.utils.NativeSettings
+import emu.skyline.utils.FrameTelemetry
+import emu.skyline.utils.PerformanceStatistics
 import emu.skyline.utils.PreferenceSettings
 import java.nio.ByteBuffer
 import java.nio.ByteOrder
@@ -114,6 +116,16 @@ class EmulationActivity : AppCompatActivity(), SurfaceHolder.Callback, View.OnTo
      */
     private external fun changeAudioStatus(play : Boolean)
 
+    /**
+     * Pauses all guest threads and releases any GPU resources which can be recreated on demand, this is done while the activity isn't visible to reduce the chance of being killed to reclaim memory
+     */
+    private external fun suspendEmulation()
+
+    /**
+     * Resumes all guest threads paused by [suspendEmulation], any released resources are recreated lazily as the guest uses them
+     */
+    private external fun resumeEmulation()
+
     var fps : Int = 0
     var averageFrametime : Float = 0.0f
     var averageFrametimeDeviation : Float = 0.0f
@@ -123,12 +135,32 @@ class EmulationActivity : AppCompatActivity(), SurfaceHolder.Callback, View.OnTo
      */
     private external fun updatePerformanceStatistics()
 
+    /**
+     * @return A direct buffer over the native per-subsystem performance counters, see [PerformanceStatistics]
+     */
+    private external fun getPerformanceStatisticsBuffer() : ByteBuffer
+
+    /**
+     * @return A direct buffer over the native ring of records of the latest presented frames, see [FrameTelemetry]
+     */
+    private external fun getFrameTelemetryBuffer() : ByteBuffer
+
     /**
      * @see [InputHandler.initializeControllers]
      */
     @Suppress("unused")
     private fun initializeControllers() {
         inputHandler.initializeControllers()
+        updateMotionRotation()
+    }
+
+    /**
+     * Passes the current rotation of the display to libskyline so motion sensor data is mapped relative to the screen
+     */
+    private fun updateMotionRotation() {
+        @Suppress("DEPRECATION")
+        val display = if (Build.VERSION.SDK_INT >= Build.VERSION_CODES.R) display!! else windowManager.defaultDisplay
+        InputHandler.setMotionRotation(display.rotation)
     }
 
     /**
@@ -243,11 +275,31 @@ class EmulationActivity : AppCompatActivity(), SurfaceHolder.Callback, View.OnTo
             if (preferenceSettings.disableFrameThrottling)
                 binding.perfStats.setTextColor(getColor(R.color.colorPerfStatsSecondary))
 
+            val statistics = PerformanceStatistics(getPerformanceStatisticsBuffer())
+            val telemetry = FrameTelemetry(getFrameTelemetryBuffer())
             binding.perfStats.apply {
                 postDelayed(object : Runnable {
+                    var lastTime = SystemClock.elapsedRealtimeNanos()
+                    var lastGpuBusy = statistics.gpuBusyNs
+                    val lastCoreBusy = LongArray(PerformanceStatistics.GuestCoreCount) { statistics.guestCoreBusyNs(it) }
+
                     override fun run() {
                         updatePerformanceStatistics()
-                        text = "$fps FPS\n${"%.1f".format(averageFrametime)}±${"%.2f".format(averageFrametimeDeviation)}ms"
+
+                        // Utilisation is derived from the difference between the cumulative counters since the last refresh
+                        val time = SystemClock.elapsedRealtimeNanos()
+                        val elapsed = (time - lastTime).coerceAtLeast(1).toFloat()
+                        val gpuBusy = statistics.gpuBusyNs
+                        val coreUtilisation = (0 until PerformanceStatistics.GuestCoreCount).joinToString(" ") { core ->
+                            val coreBusy = statistics.guestCoreBusyNs(core)
+                            "%.0f".format(((coreBusy - lastCoreBusy[core]) / elapsed * 100).coerceAtMost(100f)).also { lastCoreBusy[core] = coreBusy }
+                        }
+
+                        text = "$fps FPS\n${"%.1f".format(averageFrametime)}±${"%.2f".format(averageFrametimeDeviation)}ms\n" +
+                                "GPU ${"%.0f".format(((gpuBusy - lastGpuBusy) / elapsed * 100).coerceAtMost(100f))}%\nCPU $coreUtilisation%" +
+                                if (telemetry.stutterCount != 0L) "\n${telemetry.stutterCount} stutters" else ""
+                        lastTime = time
+                        lastGpuBusy = gpuBusy
                         postDelayed(this, 250)
                     }
                 }, 250)
@@ -282,6 +334,18 @@ class EmulationActivity : AppCompatActivity(), SurfaceHolder.Callback, View.OnTo
         changeAudioStatus(false)
     }
 
+    override fun onStart() {
+        super.onStart()
+
+        resumeEmulation()
+    }
+
+    override fun onStop() {
+        super.onStop()
+
+        suspendEmulation()
+    }
+
     override fun onResume() {
         super.onResume()
 
@@ -488,8 +552,10 @@ class EmulationActivity : AppCompatActivity(), SurfaceHolder.Callback, View.OnTo
     override fun onDisplayChanged(displayId : Int) {
         @Suppress("DEPRECATION")
         val display = if (Build.VERSION.SDK_INT >= Build.VERSION_CODES.R) display!! else windowManager.defaultDisplay
-        if (display.displayId == displayId)
+        if (display.displayId == displayId) {
             force60HzRefreshRate(!preferenceSettings.maxRefreshRate)
+            updateMotionRotation()
+        }
     }
 
     override fun onDisplayAdded(displayId : Int) {}
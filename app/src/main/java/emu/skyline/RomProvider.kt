@@ -3,36 +3,126 @@ package emu.skyline
 import android.annotation.SuppressLint
 import android.content.Context
 import android.net.Uri
+import android.util.Log
 import androidx.documentfile.provider.DocumentFile
 import dagger.hilt.android.qualifiers.ApplicationContext
 import emu.skyline.loader.AppEntry
+import emu.skyline.loader.LoaderResult
 import emu.skyline.loader.RomFile
 import emu.skyline.loader.RomFormat
 import emu.skyline.loader.RomFormat.*
+import emu.skyline.utils.fromFile
+import emu.skyline.utils.toFile
+import java.io.File
+import java.io.Serializable
+import java.util.concurrent.Callable
+import java.util.concurrent.Executors
 import javax.inject.Inject
 import javax.inject.Singleton
 
+/**
+ * The metadata of a ROM along with the state of the file it was parsed from, this is used to avoid reparsing unchanged files
+ */
+private data class CachedRomEntry(
+    val size : Long,
+    val lastModified : Long,
+    val systemLanguage : Int,
+    val appEntry : AppEntry
+) : Serializable {
+    companion object {
+        private const val serialVersionUID : Long = 1L
+    }
+}
+
 @Singleton
 class RomProvider @Inject constructor(@ApplicationContext private val context : Context) {
+    companion object {
+        private val TAG = RomProvider::class.java.simpleName
+    }
+
+    private val cacheFile = File(context.filesDir.canonicalPath + "/rom_cache.bin")
+
     /**
-     * This adds all files in [directory] with [extension] as an entry using [RomFile] to load metadata
+     * This collects all files in [directory] with an extension in [fileFormats] along with their format
      */
     @SuppressLint("DefaultLocale")
-    private fun addEntries(fileFormats : Map<String, RomFormat>, directory : DocumentFile, entries : HashMap<RomFormat, ArrayList<AppEntry>>, systemLanguage : Int) {
+    private fun findRoms(fileFormats : Map<String, RomFormat>, directory : DocumentFile, roms : ArrayList<Pair<DocumentFile, RomFormat>>) {
         directory.listFiles().forEach { file ->
             if (file.isDirectory) {
-                addEntries(fileFormats, file, entries, systemLanguage)
+                findRoms(fileFormats, file, roms)
             } else {
-                fileFormats[file.name?.substringAfterLast(".")?.lowercase()]?.let { romFormat->
-                    entries.getOrPut(romFormat, { arrayListOf() }).add(RomFile(context, romFormat, file.uri, systemLanguage).appEntry)
+                fileFormats[file.name?.substringAfterLast(".")?.lowercase()]?.let { romFormat ->
+                    roms.add(file to romFormat)
                 }
             }
         }
     }
 
+    private fun loadCache() : HashMap<String, CachedRomEntry> {
+        if (cacheFile.exists()) {
+            try {
+                return fromFile(cacheFile)
+            } catch (e : Exception) {
+                Log.w(TAG, "Ran into exception while loading the ROM cache: ${e.message}")
+            }
+        }
+        return HashMap()
+    }
+
+    /**
+     * This loads the metadata of all ROMs in [searchLocation], files which haven't changed since they were last parsed are loaded from the cache while the rest are parsed in parallel
+     */
     fun loadRoms(searchLocation : Uri, systemLanguage : Int) = DocumentFile.fromTreeUri(context, searchLocation)!!.let { documentFile ->
+        val roms = arrayListOf<Pair<DocumentFile, RomFormat>>()
+        findRoms(mapOf("nro" to NRO, "nso" to NSO, "nca" to NCA, "nsp" to NSP, "xci" to XCI), documentFile, roms)
+
+        val cache = loadCache()
+        val updatedCache = HashMap<String, CachedRomEntry>()
+        val appEntries = arrayOfNulls<AppEntry>(roms.size)
+        val misses = arrayListOf<Int>()
+
+        roms.forEachIndexed { index, (file, _) ->
+            val cached = cache[file.uri.toString()]
+            if (cached != null && cached.size == file.length() && cached.lastModified == file.lastModified() && cached.systemLanguage == systemLanguage) {
+                appEntries[index] = cached.appEntry
+                updatedCache[file.uri.toString()] = cached
+            } else {
+                misses.add(index)
+            }
+        }
+
+        if (misses.isNotEmpty()) {
+            val executor = Executors.newFixedThreadPool(Runtime.getRuntime().availableProcessors().coerceAtMost(misses.size))
+            try {
+                executor.invokeAll(misses.map { index ->
+                    Callable {
+                        val (file, romFormat) = roms[index]
+                        val appEntry = RomFile(context, romFormat, file.uri, systemLanguage).appEntry
+                        appEntries[index] = appEntry
+
+                        // Entries that failed due to missing keys are reparsed on the next scan as the keys might have been imported since
+                        if (appEntry.loaderResult == LoaderResult.Success || appEntry.loaderResult == LoaderResult.ParsingError) {
+                            synchronized(updatedCache) {
+                                updatedCache[file.uri.toString()] = CachedRomEntry(file.length(), file.lastModified(), systemLanguage, appEntry)
+                            }
+                        }
+                    }
+                }).forEach { it.get() }
+            } finally {
+                executor.shutdown()
+            }
+        }
+
+        try {
+            updatedCache.toFile(cacheFile)
+        } catch (e : Exception) {
+            Log.w(TAG, "Ran into exception while saving the ROM cache: ${e.message}")
+        }
+
         hashMapOf<RomFormat, ArrayList<AppEntry>>().apply {
-            addEntries(mapOf("nro" to NRO, "nso" to NSO, "nca" to NCA, "nsp" to NSP, "xci" to XCI), documentFile, this, systemLanguage)
+            roms.forEachIndexed { index, (_, romFormat) ->
+                getOrPut(romFormat, { arrayListOf() }).add(appEntries[index]!!)
+            }
         }
     }
 }
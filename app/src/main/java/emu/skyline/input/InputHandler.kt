@@ -52,6 +52,25 @@ class InputHandler(private val inputManager : InputManager, private val preferen
          */
         external fun setAxisValue(index : Int, axis : Int, value : Int)
 
+        /**
+         * This applies a batch of button and axis changes at once, this avoids crossing JNI for every change from high-rate input sources
+         *
+         * @param events An array of skyline::input::NpadInputEvent in C++ represented as longs
+         * @param count The amount of events in the array that should be applied
+         */
+        external fun setInputStates(events : LongArray, count : Int)
+
+        private const val InputEventButton = 0L
+        private const val InputEventAxis = 1L
+        private const val InputEventSize = 4 // The amount of longs in a single skyline::input::NpadInputEvent
+
+        /**
+         * This sets the rotation of the display which the host motion sensors are mapped relative to
+         *
+         * @param rotation The rotation of the display as a Surface.ROTATION_* constant
+         */
+        external fun setMotionRotation(rotation : Int)
+
         /**
          * This sets the values of the points on the guest touch-screen
          *
@@ -119,6 +138,27 @@ class InputHandler(private val inputManager : InputManager, private val preferen
      */
     private val axesHistory = FloatArray(MotionHostEvent.axes.size)
 
+    /**
+     * The events generated while handling a single [MotionEvent], these are passed into libskyline together once all axes have been handled
+     */
+    private val eventBatch = LongArray(MotionHostEvent.axes.size * InputEventSize)
+    private var eventBatchCount = 0
+
+    private fun queueEvent(type : Long, index : Int, id : Long, value : Long) {
+        val offset = eventBatchCount++ * InputEventSize
+        eventBatch[offset] = type
+        eventBatch[offset + 1] = index.toLong()
+        eventBatch[offset + 2] = id
+        eventBatch[offset + 3] = value
+    }
+
+    private fun flushEvents() {
+        if (eventBatchCount != 0) {
+            setInputStates(eventBatch, eventBatchCount)
+            eventBatchCount = 0
+        }
+    }
+
     /**
      * Handles translating any [MotionHostEvent]s to a [GuestEvent] that is passed into libskyline
      */
@@ -154,14 +194,14 @@ class InputHandler(private val inputManager : InputManager, private val preferen
                         is ButtonGuestEvent -> {
                             val action = if (abs(value) >= guestEvent.threshold) ButtonState.Pressed.state else ButtonState.Released.state
                             if (guestEvent.button != ButtonId.Menu)
-                                setButtonState(guestEvent.id, guestEvent.button.value(), action)
+                                queueEvent(InputEventButton, guestEvent.id, guestEvent.button.value(), if (action) 1L else 0L)
                         }
 
                         is AxisGuestEvent -> {
                             value = guestEvent.value(value)
                             value = if (polarity) abs(value) else -abs(value)
                             value = if (guestEvent.axis == AxisId.LX || guestEvent.axis == AxisId.RX) value else -value
-                            setAxisValue(guestEvent.id, guestEvent.axis.ordinal, (value * Short.MAX_VALUE).toInt())
+                            queueEvent(InputEventAxis, guestEvent.id, guestEvent.axis.ordinal.toLong(), (value * Short.MAX_VALUE).toLong())
                         }
                     }
                 }
@@ -169,6 +209,7 @@ class InputHandler(private val inputManager : InputManager, private val preferen
                 axesHistory[axisItem.index] = value
             }
 
+            flushEvents()
             return true
         }
 
@@ -0,0 +1,62 @@
+/*
+ * SPDX-License-Identifier: MPL-2.0
+ * Copyright © 2023 Skyline Team and Contributors (https://github.com/skyline-emu/)
+ */
+
+package emu.skyline.utils
+
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+
+/**
+ * A view over the native ring of frame records, this mirrors the layout of `skyline::FrameRecordRing`
+ * @param buffer A direct buffer backed by the native ring, it's written by the presentation thread while being read
+ */
+class FrameTelemetry(buffer : ByteBuffer) {
+    companion object {
+        const val RecordCount = 256
+        private const val RecordFieldCount = 9
+        private const val HeaderFieldCount = 2
+    }
+
+    /**
+     * A snapshot of `skyline::FrameRecord`, the costs are the amount accrued since the prior frame was presented
+     */
+    data class Record(
+        val frameId : Long,
+        val presentTimeNs : Long,
+        val frameTimeNs : Long,
+        val gpuBusyNs : Long,
+        val presentLatencyNs : Long,
+        val pipelineCompileCount : Long,
+        val textureUploadBytes : Long,
+        val bufferSyncBytes : Long,
+        val trapFaults : Long
+    )
+
+    private val buffer = buffer.order(ByteOrder.nativeOrder())
+
+    private fun field(index : Int) = buffer.getLong(index * Long.SIZE_BYTES)
+
+    val recordCount get() = field(0)
+    val stutterCount get() = field(1)
+
+    /**
+     * @return The record with the supplied index in terms of [recordCount] or null if it was overwritten while being read
+     */
+    private fun readRecord(index : Long) : Record? {
+        val base = HeaderFieldCount + (index % RecordCount).toInt() * RecordFieldCount
+        val frameId = field(base)
+        val record = Record(frameId, field(base + 1), field(base + 2), field(base + 3), field(base + 4), field(base + 5), field(base + 6), field(base + 7), field(base + 8))
+        return if (frameId != 0L && field(base) == frameId) record else null
+    }
+
+    /**
+     * @return Up to [count] of the latest records from the oldest to the newest, records which were being written concurrently are skipped
+     */
+    fun latestRecords(count : Int = RecordCount) : List<Record> {
+        val end = recordCount
+        val start = maxOf(0L, end - minOf(count, RecordCount))
+        return (start until end).mapNotNull { readRecord(it) }
+    }
+}
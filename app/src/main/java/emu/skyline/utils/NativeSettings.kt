@@ -17,24 +17,45 @@ class NativeSettings(context : Context, pref : PreferenceSettings) {
     var usernameValue : String = pref.usernameValue
     var systemLanguage : Int = pref.systemLanguage
     var systemRegion : Int = pref.systemRegion
+    var preemptionTimeslice : Int = pref.preemptionTimeslice
+    var adaptivePreemption : Boolean = pref.adaptivePreemption
+    var cooperativeYield : Boolean = pref.cooperativeYield
+    var userfaultWriteTracking : Boolean = pref.userfaultWriteTracking
+    var hugePageMemory : Boolean = pref.hugePageMemory
+    var verifyIntegrity : Boolean = pref.verifyIntegrity
 
     // Display
     var forceTripleBuffering : Boolean = pref.forceTripleBuffering
     var disableFrameThrottling : Boolean = pref.disableFrameThrottling
+    var framePacing : Boolean = pref.framePacing
+    var lowLatencyPresentation : Boolean = pref.lowLatencyPresentation
 
     // GPU
     var gpuDriver : String = if (pref.gpuDriver == PreferenceSettings.SYSTEM_GPU_DRIVER) "" else pref.gpuDriver
     var gpuDriverLibraryName : String = if (pref.gpuDriver == PreferenceSettings.SYSTEM_GPU_DRIVER) "" else GpuDriverHelper.getLibraryName(context, pref.gpuDriver)
     var executorSlotCountScale : Int = pref.executorSlotCountScale
+    var asyncPipelineCompilation : Boolean = pref.asyncPipelineCompilation
+    var shaderHashValidation : Boolean = pref.shaderHashValidation
+    var gpuTextureDecoding : Boolean = pref.gpuTextureDecoding
+    var gpuTextureDeswizzling : Boolean = pref.gpuTextureDeswizzling
+    var textureMemoryBudget : Int = pref.textureMemoryBudget
+    var asyncTextureReadback : Boolean = pref.asyncTextureReadback
+    var resolutionScale : Int = pref.resolutionScale
+    var presentUpscaling : Boolean = pref.presentUpscaling
+    var parallelCommandRecording : Boolean = pref.parallelCommandRecording
 
     // Hacks
     var enableFastGpuReadbackHack : Boolean = pref.enableFastGpuReadbackHack
 
     // Audio
     var isAudioOutputDisabled : Boolean = pref.isAudioOutputDisabled
+    var adaptiveAudioLatency : Boolean = pref.adaptiveAudioLatency
 
     // Debug
     var validationLayer : Boolean = BuildConfig.BUILD_TYPE != "release" && pref.validationLayer
+    var exportPipelineStatistics : Boolean = pref.exportPipelineStatistics
+    var gpfifoCapture : Boolean = pref.gpfifoCapture
+    var kernelBenchmark : Boolean = pref.kernelBenchmark
 
     /**
      * Updates settings in libskyline during emulation
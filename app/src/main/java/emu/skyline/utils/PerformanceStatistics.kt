@@ -0,0 +1,38 @@
+/*
+ * SPDX-License-Identifier: MPL-2.0
+ * Copyright © 2023 Skyline Team and Contributors (https://github.com/skyline-emu/)
+ */
+
+package emu.skyline.utils
+
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+
+/**
+ * A view over the native performance counters, this mirrors the layout of `skyline::PerformanceStatistics`
+ * @param buffer A direct buffer backed by the native counters, reads from it are always up to date without any JNI calls
+ */
+class PerformanceStatistics(buffer : ByteBuffer) {
+    companion object {
+        const val GuestCoreCount = 4
+    }
+
+    private val buffer = buffer.order(ByteOrder.nativeOrder())
+
+    private fun counter(index : Int) = buffer.getLong(index * Long.SIZE_BYTES)
+
+    val fps get() = counter(0)
+    val averageFrametimeNs get() = counter(1)
+    val averageFrametimeDeviationNs get() = counter(2)
+    val frameCount get() = counter(3)
+    val gpuBusyNs get() = counter(4)
+    fun guestCoreBusyNs(core : Int) = counter(5 + core)
+    val gpfifoBusyNs get() = counter(5 + GuestCoreCount)
+    val commandRecordBusyNs get() = counter(6 + GuestCoreCount)
+    val pipelineCompileCount get() = counter(7 + GuestCoreCount)
+    val shaderCompileCount get() = counter(8 + GuestCoreCount)
+    val textureUploadBytes get() = counter(9 + GuestCoreCount)
+    val audioUnderruns get() = counter(10 + GuestCoreCount)
+    val bufferSyncBytes get() = counter(11 + GuestCoreCount)
+    val trapFaults get() = counter(12 + GuestCoreCount)
+}
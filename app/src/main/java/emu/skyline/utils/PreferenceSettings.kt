@@ -27,10 +27,18 @@ class PreferenceSettings @Inject constructor(@ApplicationContext private val con
     var usernameValue by sharedPreferences(context, context.getString(R.string.username_default))
     var systemLanguage by sharedPreferences(context, 1)
     var systemRegion by sharedPreferences(context, -1)
+    var preemptionTimeslice by sharedPreferences(context, 10)
+    var adaptivePreemption by sharedPreferences(context, false)
+    var cooperativeYield by sharedPreferences(context, false)
+    var userfaultWriteTracking by sharedPreferences(context, false)
+    var hugePageMemory by sharedPreferences(context, false)
+    var verifyIntegrity by sharedPreferences(context, false)
 
     // Display
     var forceTripleBuffering by sharedPreferences(context, true)
     var disableFrameThrottling by sharedPreferences(context, false)
+    var framePacing by sharedPreferences(context, false)
+    var lowLatencyPresentation by sharedPreferences(context, false)
     var maxRefreshRate by sharedPreferences(context, false)
     var aspectRatio by sharedPreferences(context, 0)
     var orientation by sharedPreferences(context, ActivityInfo.SCREEN_ORIENTATION_SENSOR_LANDSCAPE)
@@ -39,15 +47,28 @@ class PreferenceSettings @Inject constructor(@ApplicationContext private val con
     // GPU
     var gpuDriver by sharedPreferences(context, SYSTEM_GPU_DRIVER)
     var executorSlotCountScale by sharedPreferences(context, 6)
+    var asyncPipelineCompilation by sharedPreferences(context, false)
+    var shaderHashValidation by sharedPreferences(context, false)
+    var gpuTextureDecoding by sharedPreferences(context, false)
+    var gpuTextureDeswizzling by sharedPreferences(context, false)
+    var textureMemoryBudget by sharedPreferences(context, 0)
+    var asyncTextureReadback by sharedPreferences(context, false)
+    var resolutionScale by sharedPreferences(context, 100)
+    var presentUpscaling by sharedPreferences(context, false)
+    var parallelCommandRecording by sharedPreferences(context, false)
 
     // Hacks
     var enableFastGpuReadbackHack by sharedPreferences(context, false)
 
     // Audio
     var isAudioOutputDisabled by sharedPreferences(context, false)
+    var adaptiveAudioLatency by sharedPreferences(context, true)
 
     // Debug
     var validationLayer by sharedPreferences(context, false)
+    var exportPipelineStatistics by sharedPreferences(context, false)
+    var gpfifoCapture by sharedPreferences(context, false)
+    var kernelBenchmark by sharedPreferences(context, false)
 
     // Input
     var onScreenControl by sharedPreferences(context, true)